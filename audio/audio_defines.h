@@ -28,6 +28,10 @@ RETRO_BEGIN_DECLS
 
 #define AUDIO_MAX_RATIO                16
 
+/* audio_driver_flush() runs all of its stages on blocks of
+ * this many samples, so that they stay in cache between stages. */
+#define AUDIO_FLUSH_BLOCK_SAMPLES      512
+
 #define AUDIO_MIXER_MAX_STREAMS        16
 
 #define AUDIO_MIXER_MAX_SYSTEM_STREAMS (AUDIO_MIXER_MAX_STREAMS + 5)
@@ -21,6 +21,7 @@
 #include <rthreads/rthreads.h>
 
 #include "audio_thread_wrapper.h"
+#include "../performance_counters.h"
 #include "../verbosity.h"
 
 typedef struct audio_thread
@@ -57,6 +58,9 @@ static void audio_thread_loop(void *data)
    if (!thr)
       return;
 
+   perf_trace_set_thread_name("audio");
+   sthread_set_role(STHREAD_ROLE_AUDIO);
+
    thr->driver_data   = thr->driver->init(
          thr->device, thr->out_rate, thr->latency,
          thr->block_frames, thr->new_rate);
@@ -68,7 +72,10 @@ static void audio_thread_loop(void *data)
    slock_unlock(thr->lock);
 
    if (thr->inited < 0)
+   {
+      perf_trace_thread_exit();
       return;
+   }
 
    /* Wait until we start to avoid calling
     * stop immediately after initialization. */
@@ -106,10 +113,14 @@ static void audio_thread_loop(void *data)
       }
 
       slock_unlock(thr->lock);
+
+      perf_trace_begin("audio_callback");
       audio_driver_callback();
+      perf_trace_end("audio_callback");
    }
 
    thr->driver->free(thr->driver_data);
+   perf_trace_thread_exit();
 }
 
 static void audio_thread_block(audio_thread_t *thr)
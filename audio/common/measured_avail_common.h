@@ -0,0 +1,40 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MEASURED_AVAIL_COMMON_H
+#define _MEASURED_AVAIL_COMMON_H
+
+#include <stddef.h>
+
+#include <retro_atomic.h>
+#include <retro_inline.h>
+
+/* For the measured_write_avail() of pull drivers: records
+ * 'avail', the free space in the buffer right after the
+ * device callback drained 'drained' bytes from it, into
+ * 'measured'. The buffer is at its emptiest at that point
+ * and refills by about 'drained' bytes until the next
+ * callback, so the middle of that range is recorded
+ * > Smoothed over around 8 callbacks
+ * > Safe to call from a realtime thread */
+static INLINE void audio_measure_write_avail(
+      retro_atomic_int_t *measured, size_t avail, size_t drained)
+{
+   int sample   = (int)((avail > drained / 2) ? avail - drained / 2 : 0);
+   int previous = retro_atomic_load(measured);
+
+   retro_atomic_store(measured, previous + (sample - previous) / 8);
+}
+
+#endif
@@ -21,7 +21,7 @@
 #include <alsa/asoundlib.h>
 
 #include <rthreads/rthreads.h>
-#include <queues/fifo_queue.h>
+#include <queues/spsc_ring.h>
 #include <string/stdstring.h>
 
 #include "../../retroarch.h"
@@ -33,11 +33,12 @@
 typedef struct alsa_thread
 {
    snd_pcm_t *pcm;
-   fifo_buffer_t *buffer;
+   spsc_ring_t *buffer;
    sthread_t *worker_thread;
-   slock_t *fifo_lock;
+   /* Only used while a blocking write waits for room */
    scond_t *cond;
    slock_t *cond_lock;
+   retro_atomic_int_t writer_waiting;
    size_t buffer_size;
    size_t period_size;
    snd_pcm_uframes_t period_frames;
@@ -52,6 +53,8 @@ static void alsa_worker_thread(void *data)
    alsa_thread_t *alsa = (alsa_thread_t*)data;
    uint8_t        *buf = (uint8_t *)calloc(1, alsa->period_size);
 
+   sthread_set_role(STHREAD_ROLE_AUDIO);
+
    if (!buf)
    {
       RARCH_ERR("failed to allocate audio buffer");
@@ -60,15 +63,20 @@ static void alsa_worker_thread(void *data)
 
    while (!alsa->thread_dead)
    {
-      size_t avail;
       size_t fifo_size;
       snd_pcm_sframes_t frames;
-      slock_lock(alsa->fifo_lock);
-      avail     = FIFO_READ_AVAIL(alsa->buffer);
-      fifo_size = MIN(alsa->period_size, avail);
-      fifo_read(alsa->buffer, buf, fifo_size);
-      scond_signal(alsa->cond);
-      slock_unlock(alsa->fifo_lock);
+
+      fifo_size = spsc_ring_read(alsa->buffer, buf, alsa->period_size);
+
+      /* The writer flags itself before checking for
+       * room, so either it sees the space just freed
+       * or it is seen waiting here */
+      if (retro_atomic_load(&alsa->writer_waiting))
+      {
+         slock_lock(alsa->cond_lock);
+         scond_signal(alsa->cond);
+         slock_unlock(alsa->cond_lock);
+      }
 
       /* If underrun, fill rest with silence. */
       memset(buf + fifo_size, 0, alsa->period_size - fifo_size);
@@ -135,11 +143,9 @@ static void alsa_thread_free(void *data)
          sthread_join(alsa->worker_thread);
       }
       if (alsa->buffer)
-         fifo_free(alsa->buffer);
+         spsc_ring_free(alsa->buffer);
       if (alsa->cond)
          scond_free(alsa->cond);
-      if (alsa->fifo_lock)
-         slock_free(alsa->fifo_lock);
       if (alsa->cond_lock)
          slock_free(alsa->cond_lock);
       if (alsa->pcm)
@@ -213,11 +219,10 @@ static void *alsa_thread_init(const char *device,
    snd_pcm_hw_params_free(params);
    snd_pcm_sw_params_free(sw_params);
 
-   alsa->fifo_lock = slock_new();
    alsa->cond_lock = slock_new();
    alsa->cond = scond_new();
-   alsa->buffer = fifo_new(alsa->buffer_size);
-   if (!alsa->fifo_lock || !alsa->cond_lock || !alsa->cond || !alsa->buffer)
+   alsa->buffer = spsc_ring_new(alsa->buffer_size);
+   if (!alsa->cond_lock || !alsa->cond || !alsa->buffer)
       goto error;
 
    alsa->worker_thread = sthread_create(alsa_worker_thread, alsa);
@@ -250,44 +255,27 @@ static ssize_t alsa_thread_write(void *data, const void *buf, size_t size)
       return -1;
 
    if (alsa->nonblock)
-   {
-      size_t avail;
-      size_t write_amt;
-
-      slock_lock(alsa->fifo_lock);
-      avail           = FIFO_WRITE_AVAIL(alsa->buffer);
-      write_amt       = MIN(avail, size);
-
-      fifo_write(alsa->buffer, buf, write_amt);
-      slock_unlock(alsa->fifo_lock);
-
-      return write_amt;
-   }
+      return spsc_ring_write(alsa->buffer, buf, size);
    else
    {
       size_t written = 0;
       while (written < size && !alsa->thread_dead)
       {
-         size_t avail;
-         slock_lock(alsa->fifo_lock);
-         avail = FIFO_WRITE_AVAIL(alsa->buffer);
+         size_t write_amt = spsc_ring_write(alsa->buffer,
+               (const char*)buf + written, size - written);
 
-         if (avail == 0)
+         if (write_amt == 0)
          {
-            slock_unlock(alsa->fifo_lock);
             slock_lock(alsa->cond_lock);
-            if (!alsa->thread_dead)
+            retro_atomic_store(&alsa->writer_waiting, 1);
+            while (     !alsa->thread_dead
+                     && (spsc_ring_write_avail(alsa->buffer) == 0))
                scond_wait(alsa->cond, alsa->cond_lock);
+            retro_atomic_store(&alsa->writer_waiting, 0);
             slock_unlock(alsa->cond_lock);
          }
-         else
-         {
-            size_t write_amt = MIN(size - written, avail);
-            fifo_write(alsa->buffer,
-                  (const char*)buf + written, write_amt);
-            slock_unlock(alsa->fifo_lock);
-            written += write_amt;
-         }
+
+         written += write_amt;
       }
       return written;
    }
@@ -328,14 +316,10 @@ static bool alsa_thread_start(void *data, bool is_shutdown)
 static size_t alsa_thread_write_avail(void *data)
 {
    alsa_thread_t *alsa = (alsa_thread_t*)data;
-   size_t val;
 
    if (alsa->thread_dead)
       return 0;
-   slock_lock(alsa->fifo_lock);
-   val = FIFO_WRITE_AVAIL(alsa->buffer);
-   slock_unlock(alsa->fifo_lock);
-   return val;
+   return spsc_ring_write_avail(alsa->buffer);
 }
 
 static size_t alsa_thread_buffer_size(void *data)
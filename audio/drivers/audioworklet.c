@@ -0,0 +1,125 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2015 - Michael Lelli
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <boolean.h>
+
+#include "../../retroarch.h"
+#include "../../verbosity.h"
+
+/* forward declarations, see emscripten/library_audioworklet.js */
+unsigned AudioWorkletSampleRate(void);
+int AudioWorkletInit(unsigned latency);
+ssize_t AudioWorkletWrite(const void *buf, size_t size);
+bool AudioWorkletStop(void);
+bool AudioWorkletStart(void);
+void AudioWorkletSetNonblockState(bool state);
+void AudioWorkletFree(void);
+size_t AudioWorkletWriteAvail(void);
+size_t AudioWorkletBufferSize(void);
+
+typedef struct audioworklet
+{
+   bool is_paused;
+} audioworklet_t;
+
+static void audioworklet_free(void *data)
+{
+   AudioWorkletFree();
+   free(data);
+}
+
+static void *audioworklet_init(const char *device, unsigned rate,
+      unsigned latency, unsigned block_frames, unsigned *new_rate)
+{
+   audioworklet_t *aw = NULL;
+
+   /* Needs AudioWorklet and SharedArrayBuffer, the latter
+    * only being there when the page is cross-origin isolated */
+   if (!AudioWorkletInit(latency))
+   {
+      RARCH_ERR("[AudioWorklet] AudioWorklet or SharedArrayBuffer"
+            " unavailable, use the rwebaudio driver instead.\n");
+      return NULL;
+   }
+
+   aw = (audioworklet_t*)calloc(1, sizeof(*aw));
+   if (!aw)
+   {
+      AudioWorkletFree();
+      return NULL;
+   }
+
+   *new_rate = AudioWorkletSampleRate();
+   return aw;
+}
+
+static ssize_t audioworklet_write(void *data, const void *buf, size_t size)
+{
+   return AudioWorkletWrite(buf, size);
+}
+
+static bool audioworklet_stop(void *data)
+{
+   audioworklet_t *aw = (audioworklet_t*)data;
+   if (!aw)
+      return false;
+   aw->is_paused = true;
+   return AudioWorkletStop();
+}
+
+static void audioworklet_set_nonblock_state(void *data, bool state)
+{
+   AudioWorkletSetNonblockState(state);
+}
+
+static bool audioworklet_alive(void *data)
+{
+   audioworklet_t *aw = (audioworklet_t*)data;
+   if (!aw)
+      return false;
+   return !aw->is_paused;
+}
+
+static bool audioworklet_start(void *data, bool is_shutdown)
+{
+   audioworklet_t *aw = (audioworklet_t*)data;
+   if (!aw)
+      return false;
+   aw->is_paused = false;
+   return AudioWorkletStart();
+}
+
+static size_t audioworklet_write_avail(void *data) { return AudioWorkletWriteAvail(); }
+static size_t audioworklet_buffer_size(void *data) { return AudioWorkletBufferSize(); }
+static bool audioworklet_use_float(void *data) { return true; }
+
+audio_driver_t audio_audioworklet = {
+   audioworklet_init,
+   audioworklet_write,
+   audioworklet_stop,
+   audioworklet_start,
+   audioworklet_alive,
+   audioworklet_set_nonblock_state,
+   audioworklet_free,
+   audioworklet_use_float,
+   "audioworklet",
+   NULL,
+   NULL,
+   audioworklet_write_avail,
+   audioworklet_buffer_size,
+};
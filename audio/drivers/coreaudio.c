@@ -26,16 +26,20 @@
 #include <AudioUnit/AUComponent.h>
 
 #include <boolean.h>
-#include <queues/fifo_queue.h>
+#include <queues/spsc_ring.h>
 #include <rthreads/rthreads.h>
 #include <retro_endianness.h>
 #include <string/stdstring.h>
 
+#include "../common/measured_avail_common.h"
+
 #include "../../retroarch.h"
 #include "../../verbosity.h"
 
 typedef struct coreaudio
 {
+   /* Only used while a blocking write waits for room -
+    * the render callback never waits on the writer */
    slock_t *lock;
    scond_t *cond;
 #if (defined(__MACH__) && (defined(__ppc__) || defined(__ppc64__)))
@@ -43,8 +47,11 @@ typedef struct coreaudio
 #else
    AudioComponentInstance dev;
 #endif
-   fifo_buffer_t *buffer;
+   spsc_ring_t *buffer;
    size_t buffer_size;
+   retro_atomic_int_t writer_waiting;
+   /* See audio_measure_write_avail() */
+   retro_atomic_int_t measured_avail;
    bool dev_alive;
    bool is_paused;
    bool nonblock;
@@ -72,7 +79,7 @@ static void coreaudio_free(void *data)
    }
 
    if (dev->buffer)
-      fifo_free(dev->buffer);
+      spsc_ring_free(dev->buffer);
 
    slock_free(dev->lock);
    scond_free(dev->cond);
@@ -99,25 +106,30 @@ static OSStatus audio_write_cb(void *userdata,
    write_avail = io_data->mBuffers[0].mDataByteSize;
    outbuf      = io_data->mBuffers[0].mData;
 
-   slock_lock(dev->lock);
-
-   if (FIFO_READ_AVAIL(dev->buffer) < write_avail)
+   if (spsc_ring_read_avail(dev->buffer) < write_avail)
    {
       *action_flags = kAudioUnitRenderAction_OutputIsSilence;
 
       /* Seems to be needed. */
       memset(outbuf, 0, write_avail);
-
-      slock_unlock(dev->lock);
-
-      /* Technically possible to deadlock without. */
+   }
+   else
+      spsc_ring_read(dev->buffer, outbuf, write_avail);
+
+   audio_measure_write_avail(&dev->measured_avail,
+         spsc_ring_write_avail(dev->buffer), write_avail);
+
+   /* The writer flags itself before checking for
+    * room, so either it sees the space just freed
+    * or it is seen waiting here
+    * > Signal even on underrun - technically possible
+    *   to deadlock without */
+   if (retro_atomic_load(&dev->writer_waiting))
+   {
+      slock_lock(dev->lock);
       scond_signal(dev->cond);
-      return noErr;
+      slock_unlock(dev->lock);
    }
-
-   fifo_read(dev->buffer, outbuf, write_avail);
-   slock_unlock(dev->lock);
-   scond_signal(dev->cond);
    return noErr;
 }
 
@@ -320,10 +332,12 @@ static void *coreaudio_init(const char *device,
    fifo_size        *= 2 * sizeof(float);
    dev->buffer_size  = fifo_size;
 
-   dev->buffer       = fifo_new(fifo_size);
+   dev->buffer       = spsc_ring_new(fifo_size);
    if (!dev->buffer)
       goto error;
 
+   retro_atomic_store(&dev->measured_avail, (int)fifo_size);
+
    RARCH_LOG("[CoreAudio]: Using buffer size of %u bytes: (latency = %u ms)\n",
          (unsigned)fifo_size, latency);
 
@@ -350,33 +364,29 @@ static ssize_t coreaudio_write(void *data, const void *buf_, size_t size)
    while (size > 0)
 #endif
    {
-      size_t write_avail;
+      size_t write_avail = spsc_ring_write(dev->buffer, buf, size);
 
-      slock_lock(dev->lock);
-
-      write_avail = FIFO_WRITE_AVAIL(dev->buffer);
-      if (write_avail > size)
-         write_avail = size;
-
-      fifo_write(dev->buffer, buf, write_avail);
       buf     += write_avail;
       written += write_avail;
       size    -= write_avail;
 
       if (dev->nonblock)
-      {
-         slock_unlock(dev->lock);
          break;
-      }
 
+      if (write_avail > 0)
+         continue;
+
+      slock_lock(dev->lock);
+      retro_atomic_store(&dev->writer_waiting, 1);
 #if TARGET_OS_IOS
-      if (write_avail == 0 && !scond_wait_timeout(
-               dev->cond, dev->lock, 3000000))
+      if (     (spsc_ring_write_avail(dev->buffer) == 0)
+            && !scond_wait_timeout(dev->cond, dev->lock, 3000000))
          g_interrupted = true;
 #else
-      if (write_avail == 0)
+      if (spsc_ring_write_avail(dev->buffer) == 0)
          scond_wait(dev->cond, dev->lock);
 #endif
+      retro_atomic_store(&dev->writer_waiting, 0);
       slock_unlock(dev->lock);
    }
 
@@ -424,14 +434,14 @@ static bool coreaudio_use_float(void *data)
 
 static size_t coreaudio_write_avail(void *data)
 {
-   size_t avail;
    coreaudio_t *dev = (coreaudio_t*)data;
+   return spsc_ring_write_avail(dev->buffer);
+}
 
-   slock_lock(dev->lock);
-   avail = FIFO_WRITE_AVAIL(dev->buffer);
-   slock_unlock(dev->lock);
-
-   return avail;
+static size_t coreaudio_measured_write_avail(void *data)
+{
+   coreaudio_t *dev = (coreaudio_t*)data;
+   return (size_t)retro_atomic_load(&dev->measured_avail);
 }
 
 static size_t coreaudio_buffer_size(void *data)
@@ -465,4 +475,5 @@ audio_driver_t audio_coreaudio = {
    coreaudio_device_list_free,
    coreaudio_write_avail,
    coreaudio_buffer_size,
+   coreaudio_measured_write_avail,
 };
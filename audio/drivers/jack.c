@@ -23,8 +23,11 @@
 #include <jack/ringbuffer.h>
 
 #include <boolean.h>
+#include <retro_atomic.h>
 #include <rthreads/rthreads.h>
 
+#include "../common/measured_avail_common.h"
+
 #include "../../configuration.h"
 #include "../../retroarch.h"
 #include "../../verbosity.h"
@@ -41,6 +44,8 @@ typedef struct jack
    slock_t *cond_lock;
 #endif
    size_t buffer_size;
+   /* See audio_measure_write_avail() */
+   retro_atomic_int_t measured_avail;
    volatile bool shutdown;
    bool nonblock;
    bool is_paused;
@@ -96,6 +101,10 @@ static int process_cb(jack_nframes_t nframes, void *data)
       for (i = 0; i < 2; i++)
          dst[i][read] = 0.0f;
 
+   audio_measure_write_avail(&jd->measured_avail,
+         jack_ringbuffer_write_space(jd->buffer),
+         nframes * sizeof(float) * 2);
+
 #ifdef HAVE_THREADS
    scond_signal(jd->cond);
 #endif
@@ -220,6 +229,9 @@ static void *ja_init(const char *device,
       goto error;
    }
 
+   retro_atomic_store(&jd->measured_avail,
+         (int)jack_ringbuffer_write_space(jd->buffer));
+
    parsed = parse_ports(dest_ports, jports);
 
    if (jack_activate(jd->client) < 0)
@@ -362,6 +374,12 @@ static size_t ja_write_avail(void *data)
    return jack_ringbuffer_write_space(jd->buffer);
 }
 
+static size_t ja_measured_write_avail(void *data)
+{
+   jack_t *jd = (jack_t*)data;
+   return (size_t)retro_atomic_load(&jd->measured_avail);
+}
+
 static size_t ja_buffer_size(void *data)
 {
    jack_t *jd = (jack_t*)data;
@@ -382,4 +400,5 @@ audio_driver_t audio_jack = {
    NULL,
    ja_write_avail,
    ja_buffer_size,
+   ja_measured_write_avail,
 };
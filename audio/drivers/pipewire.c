@@ -0,0 +1,562 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2021 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <spa/param/audio/format-utils.h>
+#include <pipewire/pipewire.h>
+
+#include <boolean.h>
+#include <retro_atomic.h>
+#include <retro_miscellaneous.h>
+#include <rthreads/rthreads.h>
+#include <lists/string_list.h>
+#include <queues/spsc_ring.h>
+#include <string/stdstring.h>
+
+#include "../common/measured_avail_common.h"
+
+#include "../../retroarch.h"
+#include "../../verbosity.h"
+
+/* Interleaved stereo float */
+#define PIPEWIRE_CHANNELS   2
+#define PIPEWIRE_FRAME_SIZE (PIPEWIRE_CHANNELS * sizeof(float))
+
+/* Limits of the quantum (device period, in frames)
+ * requested from the graph */
+#define PIPEWIRE_MIN_QUANTUM 32
+#define PIPEWIRE_MAX_QUANTUM 8192
+
+typedef struct pipewire_audio
+{
+   struct pw_thread_loop *loop;
+   struct pw_stream *stream;
+   struct pw_stream_events stream_events;
+   /* Filled by the frontend, drained by the
+    * realtime thread of the stream */
+   spsc_ring_t *buffer;
+   /* Only used while a blocking write waits for room */
+   slock_t *cond_lock;
+   scond_t *cond;
+   size_t buffer_size;
+   retro_atomic_int_t writer_waiting;
+   /* See audio_measure_write_avail() */
+   retro_atomic_int_t measured_avail;
+   volatile bool error;
+   bool nonblock;
+   bool is_paused;
+} pipewire_audio_t;
+
+/* Wakes a blocking write, if there is one
+ * > The writer flags itself before checking for
+ *   room, so either it sees the space just freed
+ *   or it is seen waiting here */
+static void pipewire_wake_writer(pipewire_audio_t *pw)
+{
+   if (retro_atomic_load(&pw->writer_waiting))
+   {
+      slock_lock(pw->cond_lock);
+      scond_signal(pw->cond);
+      slock_unlock(pw->cond_lock);
+   }
+}
+
+/* Runs on the realtime thread of the stream - must
+ * not block */
+static void pipewire_process_cb(void *data)
+{
+   size_t size, read;
+   struct spa_data *spa_data = NULL;
+   uint8_t *dst              = NULL;
+   struct pw_buffer *b       = NULL;
+   pipewire_audio_t *pw      = (pipewire_audio_t*)data;
+
+   if (!(b = pw_stream_dequeue_buffer(pw->stream)))
+      return;
+
+   spa_data = &b->buffer->datas[0];
+
+   if (!(dst = (uint8_t*)spa_data->data))
+   {
+      pw_stream_queue_buffer(pw->stream, b);
+      return;
+   }
+
+   /* Only fill the quantum the graph is asking
+    * for, rather than the whole buffer */
+   size = spa_data->maxsize;
+#if PW_CHECK_VERSION(0, 3, 49)
+   if (b->requested && (b->requested * PIPEWIRE_FRAME_SIZE < size))
+      size = b->requested * PIPEWIRE_FRAME_SIZE;
+#endif
+   size -= size % PIPEWIRE_FRAME_SIZE;
+
+   read  = spsc_ring_read(pw->buffer, dst, size);
+
+   /* If underrun, fill rest with silence. */
+   if (read < size)
+      memset(dst + read, 0, size - read);
+
+   spa_data->chunk->offset = 0;
+   spa_data->chunk->stride = PIPEWIRE_FRAME_SIZE;
+   spa_data->chunk->size   = (uint32_t)size;
+
+   pw_stream_queue_buffer(pw->stream, b);
+
+   audio_measure_write_avail(&pw->measured_avail,
+         spsc_ring_write_avail(pw->buffer), size);
+   pipewire_wake_writer(pw);
+}
+
+static void pipewire_state_changed_cb(void *data,
+      enum pw_stream_state old, enum pw_stream_state state,
+      const char *error)
+{
+   pipewire_audio_t *pw = (pipewire_audio_t*)data;
+
+   if (state == PW_STREAM_STATE_ERROR)
+   {
+      RARCH_ERR("[PipeWire]: Stream error: %s.\n",
+            error ? error : "unknown");
+
+      slock_lock(pw->cond_lock);
+      pw->error = true;
+      scond_signal(pw->cond);
+      slock_unlock(pw->cond_lock);
+   }
+}
+
+static void pipewire_free(void *data)
+{
+   pipewire_audio_t *pw = (pipewire_audio_t*)data;
+
+   if (!pw)
+      return;
+
+   if (pw->loop)
+   {
+      pw_thread_loop_lock(pw->loop);
+      if (pw->stream)
+         pw_stream_destroy(pw->stream);
+      pw_thread_loop_unlock(pw->loop);
+
+      pw_thread_loop_stop(pw->loop);
+      pw_thread_loop_destroy(pw->loop);
+   }
+
+   if (pw->buffer)
+      spsc_ring_free(pw->buffer);
+   if (pw->cond)
+      scond_free(pw->cond);
+   if (pw->cond_lock)
+      slock_free(pw->cond_lock);
+
+   free(pw);
+
+   pw_deinit();
+}
+
+/* Largest power of two quantum that still leaves
+ * room for a few of them in the buffer */
+static unsigned pipewire_get_quantum(size_t buffer_frames)
+{
+   unsigned quantum = PIPEWIRE_MAX_QUANTUM;
+
+   while ((quantum > PIPEWIRE_MIN_QUANTUM) && (quantum * 4 > buffer_frames))
+      quantum >>= 1;
+
+   return quantum;
+}
+
+static void *pipewire_init(const char *device, unsigned rate,
+      unsigned latency,
+      unsigned block_frames,
+      unsigned *new_rate)
+{
+   uint8_t pod_buffer[1024];
+   struct spa_pod_builder builder;
+   struct spa_audio_info_raw info;
+   const struct spa_pod *params[1];
+   size_t buffer_frames;
+   unsigned quantum;
+   struct pw_properties *props = NULL;
+   pipewire_audio_t *pw        = (pipewire_audio_t*)
+      calloc(1, sizeof(*pw));
+
+   if (!pw)
+      return NULL;
+
+   pw_init(NULL, NULL);
+
+   buffer_frames   = ((size_t)latency * rate) / 1000;
+   quantum         = pipewire_get_quantum(buffer_frames);
+   pw->buffer_size = buffer_frames * PIPEWIRE_FRAME_SIZE;
+
+   pw->cond_lock   = slock_new();
+   pw->cond        = scond_new();
+   pw->buffer      = spsc_ring_new(pw->buffer_size);
+
+   if (!pw->cond_lock || !pw->cond || !pw->buffer)
+      goto error;
+
+   retro_atomic_store(&pw->measured_avail, (int)pw->buffer_size);
+
+   if (!(pw->loop = pw_thread_loop_new("retroarch-audio", NULL)))
+      goto error;
+
+   if (!(props = pw_properties_new(
+               PW_KEY_MEDIA_TYPE,     "Audio",
+               PW_KEY_MEDIA_CATEGORY, "Playback",
+               PW_KEY_MEDIA_ROLE,     "Game",
+               PW_KEY_NODE_NAME,      "RetroArch",
+               NULL)))
+      goto error;
+
+   /* Ask the graph for a quantum that fits the
+    * configured latency */
+   pw_properties_setf(props, PW_KEY_NODE_LATENCY, "%u/%u", quantum, rate);
+
+   if (!string_is_empty(device))
+#ifdef PW_KEY_TARGET_OBJECT
+      pw_properties_set(props, PW_KEY_TARGET_OBJECT, device);
+#else
+      pw_properties_set(props, PW_KEY_NODE_TARGET, device);
+#endif
+
+   pw->stream_events.version       = PW_VERSION_STREAM_EVENTS;
+   pw->stream_events.state_changed = pipewire_state_changed_cb;
+   pw->stream_events.process       = pipewire_process_cb;
+
+   memset(&info, 0, sizeof(info));
+   info.format      = SPA_AUDIO_FORMAT_F32;
+   info.rate        = rate;
+   info.channels    = PIPEWIRE_CHANNELS;
+   info.position[0] = SPA_AUDIO_CHANNEL_FL;
+   info.position[1] = SPA_AUDIO_CHANNEL_FR;
+
+   spa_pod_builder_init(&builder, pod_buffer, sizeof(pod_buffer));
+   params[0] = spa_format_audio_raw_build(&builder,
+         SPA_PARAM_EnumFormat, &info);
+
+   if (pw_thread_loop_start(pw->loop) < 0)
+   {
+      pw_properties_free(props);
+      goto error;
+   }
+
+   pw_thread_loop_lock(pw->loop);
+
+   /* Takes ownership of 'props' */
+   pw->stream = pw_stream_new_simple(
+         pw_thread_loop_get_loop(pw->loop),
+         "RetroArch", props, &pw->stream_events, pw);
+
+   if (!pw->stream || pw_stream_connect(pw->stream,
+            PW_DIRECTION_OUTPUT, PW_ID_ANY,
+            (enum pw_stream_flags)(PW_STREAM_FLAG_AUTOCONNECT
+             | PW_STREAM_FLAG_MAP_BUFFERS
+             | PW_STREAM_FLAG_RT_PROCESS),
+            params, 1) < 0)
+   {
+      pw_thread_loop_unlock(pw->loop);
+      goto error;
+   }
+
+   pw_thread_loop_unlock(pw->loop);
+
+   *new_rate = rate;
+
+   RARCH_LOG("[PipeWire]: Requested quantum of %u frames, buffer of %u frames.\n",
+         quantum, (unsigned)buffer_frames);
+
+   return pw;
+
+error:
+   RARCH_ERR("[PipeWire]: Failed to initialize driver ...\n");
+   pipewire_free(pw);
+   return NULL;
+}
+
+static ssize_t pipewire_write(void *data, const void *buf_, size_t size)
+{
+   pipewire_audio_t *pw = (pipewire_audio_t*)data;
+   const uint8_t *buf   = (const uint8_t*)buf_;
+   size_t written       = 0;
+
+   if (pw->error)
+      return -1;
+
+   while (size > 0 && !pw->error)
+   {
+      /* Only whole frames, so that the realtime
+       * thread never splits one */
+      size_t write_amt = MIN(size, spsc_ring_write_avail(pw->buffer));
+      write_amt       -= write_amt % PIPEWIRE_FRAME_SIZE;
+
+      if (write_amt > 0)
+      {
+         spsc_ring_write(pw->buffer, buf, write_amt);
+         buf     += write_amt;
+         size    -= write_amt;
+         written += write_amt;
+         continue;
+      }
+
+      if (pw->nonblock)
+         break;
+
+      slock_lock(pw->cond_lock);
+      retro_atomic_store(&pw->writer_waiting, 1);
+      if (     !pw->error
+            && (spsc_ring_write_avail(pw->buffer) < PIPEWIRE_FRAME_SIZE))
+         scond_wait(pw->cond, pw->cond_lock);
+      retro_atomic_store(&pw->writer_waiting, 0);
+      slock_unlock(pw->cond_lock);
+   }
+
+   return written;
+}
+
+static bool pipewire_set_active(pipewire_audio_t *pw, bool active)
+{
+   int ret;
+
+   pw_thread_loop_lock(pw->loop);
+   ret = pw_stream_set_active(pw->stream, active);
+   pw_thread_loop_unlock(pw->loop);
+
+   return (ret >= 0);
+}
+
+static bool pipewire_stop(void *data)
+{
+   pipewire_audio_t *pw = (pipewire_audio_t*)data;
+
+   if (!pw)
+      return false;
+   if (!pipewire_set_active(pw, false))
+      return false;
+
+   pw->is_paused = true;
+   return true;
+}
+
+static bool pipewire_start(void *data, bool is_shutdown)
+{
+   pipewire_audio_t *pw = (pipewire_audio_t*)data;
+
+   if (!pw)
+      return false;
+   if (!pipewire_set_active(pw, true))
+      return false;
+
+   pw->is_paused = false;
+   return true;
+}
+
+static bool pipewire_alive(void *data)
+{
+   pipewire_audio_t *pw = (pipewire_audio_t*)data;
+   if (!pw)
+      return false;
+   return !pw->is_paused;
+}
+
+static void pipewire_set_nonblock_state(void *data, bool state)
+{
+   pipewire_audio_t *pw = (pipewire_audio_t*)data;
+   if (pw)
+      pw->nonblock = state;
+}
+
+static bool pipewire_use_float(void *data)
+{
+   return true;
+}
+
+static size_t pipewire_write_avail(void *data)
+{
+   pipewire_audio_t *pw = (pipewire_audio_t*)data;
+   size_t avail         = spsc_ring_write_avail(pw->buffer);
+   return avail - (avail % PIPEWIRE_FRAME_SIZE);
+}
+
+static size_t pipewire_buffer_size(void *data)
+{
+   pipewire_audio_t *pw = (pipewire_audio_t*)data;
+   return pw->buffer_size;
+}
+
+static size_t pipewire_measured_write_avail(void *data)
+{
+   pipewire_audio_t *pw = (pipewire_audio_t*)data;
+   return (size_t)retro_atomic_load(&pw->measured_avail);
+}
+
+/* Sinks found by pipewire_device_list_new() */
+typedef struct
+{
+   struct pw_thread_loop *loop;
+   struct string_list *list;
+   int pending;
+   bool done;
+} pipewire_device_list_t;
+
+static void pipewire_registry_global_cb(void *data, uint32_t id,
+      uint32_t permissions, const char *type, uint32_t version,
+      const struct spa_dict *props)
+{
+   union string_list_elem_attr attr;
+   pipewire_device_list_t *devices = (pipewire_device_list_t*)data;
+   const char *media_class         = NULL;
+   const char *name                = NULL;
+
+   if (!props || !string_is_equal(type, PW_TYPE_INTERFACE_Node))
+      return;
+
+   media_class = spa_dict_lookup(props, PW_KEY_MEDIA_CLASS);
+   name        = spa_dict_lookup(props, PW_KEY_NODE_NAME);
+
+   if (!string_is_equal(media_class, "Audio/Sink") || string_is_empty(name))
+      return;
+
+   attr.i = 0;
+   string_list_append(devices->list, name, attr);
+}
+
+static void pipewire_core_done_cb(void *data, uint32_t id, int seq)
+{
+   pipewire_device_list_t *devices = (pipewire_device_list_t*)data;
+
+   if (id != PW_ID_CORE || seq != devices->pending)
+      return;
+
+   devices->done = true;
+   pw_thread_loop_signal(devices->loop, false);
+}
+
+static void pipewire_core_error_cb(void *data, uint32_t id, int seq,
+      int res, const char *message)
+{
+   pipewire_device_list_t *devices = (pipewire_device_list_t*)data;
+
+   RARCH_ERR("[PipeWire]: Failed to list devices: %s.\n", message);
+
+   devices->done = true;
+   pw_thread_loop_signal(devices->loop, false);
+}
+
+/* Lists the node names of all sinks, which
+ * pipewire_init() takes as its target device
+ * > Runs on the driver's loop, with a connection of
+ *   its own that only lives until the registry was
+ *   walked once */
+static void *pipewire_device_list_new(void *data)
+{
+   struct spa_hook core_listener;
+   struct spa_hook registry_listener;
+   struct pw_core_events core_events;
+   struct pw_registry_events registry_events;
+   pipewire_device_list_t devices;
+   pipewire_audio_t *pw          = (pipewire_audio_t*)data;
+   struct pw_context *context    = NULL;
+   struct pw_core *core          = NULL;
+   struct pw_registry *registry  = NULL;
+
+   if (!pw || !pw->loop)
+      return NULL;
+
+   memset(&devices, 0, sizeof(devices));
+   memset(&core_listener, 0, sizeof(core_listener));
+   memset(&registry_listener, 0, sizeof(registry_listener));
+   memset(&core_events, 0, sizeof(core_events));
+   memset(&registry_events, 0, sizeof(registry_events));
+
+   if (!(devices.list = string_list_new()))
+      return NULL;
+
+   devices.loop            = pw->loop;
+   core_events.version     = PW_VERSION_CORE_EVENTS;
+   core_events.done        = pipewire_core_done_cb;
+   core_events.error       = pipewire_core_error_cb;
+   registry_events.version = PW_VERSION_REGISTRY_EVENTS;
+   registry_events.global  = pipewire_registry_global_cb;
+
+   pw_thread_loop_lock(pw->loop);
+
+   if (     (context  = pw_context_new(
+               pw_thread_loop_get_loop(pw->loop), NULL, 0))
+         && (core     = pw_context_connect(context, NULL, 0))
+         && (registry = pw_core_get_registry(core,
+               PW_VERSION_REGISTRY, 0)))
+   {
+      pw_core_add_listener(core, &core_listener, &core_events, &devices);
+      pw_registry_add_listener(registry, &registry_listener,
+            &registry_events, &devices);
+
+      /* All globals are announced before the reply to this */
+      devices.pending = pw_core_sync(core, PW_ID_CORE, 0);
+
+      while (!devices.done)
+      {
+         if (pw_thread_loop_timed_wait(pw->loop, 2) != 0)
+            break;
+      }
+
+      spa_hook_remove(&registry_listener);
+      spa_hook_remove(&core_listener);
+   }
+
+   if (registry)
+      pw_proxy_destroy((struct pw_proxy*)registry);
+   if (core)
+      pw_core_disconnect(core);
+   if (context)
+      pw_context_destroy(context);
+
+   pw_thread_loop_unlock(pw->loop);
+
+   return devices.list;
+}
+
+static void pipewire_device_list_free(void *data, void *array_list_data)
+{
+   struct string_list *s = (struct string_list*)array_list_data;
+
+   if (!s)
+      return;
+
+   string_list_free(s);
+}
+
+audio_driver_t audio_pipewire = {
+   pipewire_init,
+   pipewire_write,
+   pipewire_stop,
+   pipewire_start,
+   pipewire_alive,
+   pipewire_set_nonblock_state,
+   pipewire_free,
+   pipewire_use_float,
+   "pipewire",
+   pipewire_device_list_new,
+   pipewire_device_list_free,
+   pipewire_write_avail,
+   pipewire_buffer_size,
+   pipewire_measured_write_avail,
+};
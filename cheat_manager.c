@@ -83,6 +83,8 @@ void cheat_manager_apply_cheats(void)
    if (!cheat_st->cheats)
       return;
 
+   cheat_st->write_plan_dirty = true;
+
    core_reset_cheat();
 
    for (i = 0; i < cheat_st->size; i++)
@@ -122,7 +124,8 @@ void cheat_manager_set_code(unsigned i, const char *str)
    if (!string_is_empty(str))
       strcpy(cheat_st->cheats[i].code, str);
 
-   cheat_st->cheats[i].state = true;
+   cheat_st->cheats[i].state  = true;
+   cheat_st->write_plan_dirty = true;
 }
 
 /**
@@ -277,6 +280,8 @@ bool cheat_manager_copy_working_to_idx(unsigned idx)
    memcpy(&cheat_st->cheats[idx], &cheat_st->working_cheat,
          sizeof(struct item_cheat));
 
+   cheat_st->write_plan_dirty = true;
+
    if (cheat_st->cheats[idx].desc)
       free(cheat_st->cheats[idx].desc);
 
@@ -320,6 +325,9 @@ static void cheat_manager_free(void)
    if (cheat_st->memory_size_list)
       free(cheat_st->memory_size_list);
 
+   if (cheat_st->write_plan)
+      free(cheat_st->write_plan);
+
    cheat_st->cheats                    = NULL;
    cheat_st->size                      = 0;
    cheat_st->buf_size                  = 0;
@@ -328,6 +336,9 @@ static void cheat_manager_free(void)
    cheat_st->memory_buf_list           = NULL;
    cheat_st->memory_size_list          = NULL;
    cheat_st->matches                   = NULL;
+   cheat_st->write_plan                = NULL;
+   cheat_st->write_plan_size           = 0;
+   cheat_st->write_plan_dirty          = false;
    cheat_st->num_memory_buffers        = 0;
    cheat_st->total_memory_size         = 0;
    cheat_st->memory_initialized        = false;
@@ -344,6 +355,7 @@ static void cheat_manager_new(unsigned size)
    cheat_st->buf_size          = size;
    cheat_st->size              = size;
    cheat_st->search_bit_size   = 3;
+   cheat_st->write_plan_dirty  = true;
    cheat_st->cheats            = (struct item_cheat*)
          calloc(cheat_st->buf_size, sizeof(struct item_cheat));
 
@@ -575,8 +587,10 @@ bool cheat_manager_realloc(unsigned new_size, unsigned default_handler)
       return false;
    }
 
-   cheat_st->buf_size = new_size;
-   cheat_st->size     = new_size;
+   cheat_st->buf_size         = new_size;
+   cheat_st->size             = new_size;
+   /* Callers may also move cheats around afterwards */
+   cheat_st->write_plan_dirty = true;
 
    for (i = orig_size; i < cheat_st->size; i++)
    {
@@ -620,7 +634,8 @@ void cheat_manager_toggle_index(bool apply_cheats_after_toggle,
    if (!cheat_st->cheats || cheat_st->size == 0)
       return;
 
-   cheat_st->cheats[i].state = !cheat_st->cheats[i].state;
+   cheat_st->cheats[i].state  = !cheat_st->cheats[i].state;
+   cheat_st->write_plan_dirty = true;
    cheat_manager_update(cheat_st, i);
 
    if (apply_cheats_after_toggle)
@@ -634,6 +649,7 @@ void cheat_manager_toggle(void)
       return;
 
    cheat_st->cheats[cheat_st->ptr].state ^= true;
+   cheat_st->write_plan_dirty             = true;
    cheat_manager_apply_cheats();
    cheat_manager_update(cheat_st, cheat_st->ptr);
 }
@@ -783,6 +799,7 @@ int cheat_manager_initialize_memory(rarch_setting_t *setting, size_t idx, bool w
    cheat_st->num_memory_buffers           = 0;
    cheat_st->total_memory_size            = 0;
    cheat_st->curr_memory_buf              = NULL;
+   cheat_st->write_plan_dirty             = true;
 
    if (cheat_st->memory_buf_list)
    {
@@ -993,6 +1010,120 @@ static void cheat_manager_setup_search_meta(
    }
 }
 
+/* Most addresses are ruled out after a search or two, so whole
+ * blocks of the match list are skipped while they are all zero */
+#define CHEAT_SEARCH_BLOCK 64
+
+static bool cheat_manager_matches_empty(const uint8_t *matches, unsigned len)
+{
+   uint64_t any = 0;
+
+   for (; len >= 8; len -= 8, matches += 8)
+   {
+      uint64_t v;
+      memcpy(&v, matches, sizeof(v));
+      any |= v;
+   }
+   for (; len > 0; len--, matches++)
+      any |= *matches;
+
+   return any == 0;
+}
+
+/* The compare is inlined into a branchless loop per search type,
+ * which the compiler can turn into SIMD code */
+#define CHEAT_SEARCH_8BIT_LOOP(cond) \
+   for (j = 0; j < n; j++) \
+   { \
+      unsigned c    = curr[j]; \
+      unsigned p    = prev[j]; \
+      uint8_t  keep = (cond) ? 0xFF : 0x00; \
+      dropped      += (m[j] != 0) & (keep == 0); \
+      m[j]         &= keep; \
+   }
+
+/* Narrows down the matches of a byte-sized search over one
+ * memory buffer, returns how many matches were dropped */
+static unsigned cheat_manager_search_8bit(
+      enum cheat_search_type search_type,
+      const uint8_t *curr, const uint8_t *prev, uint8_t *matches,
+      unsigned len)
+{
+   unsigned i, n;
+   unsigned dropped        = 0;
+   cheat_manager_t *cheat_st = &cheat_manager_state;
+   unsigned exact          = cheat_st->search_exact_value;
+   unsigned plus           = cheat_st->search_eqplus_value;
+   unsigned minus          = cheat_st->search_eqminus_value;
+
+   for (i = 0; i < len; i += n, curr += n, prev += n, matches += n)
+   {
+      unsigned j;
+      uint8_t *m = matches;
+
+      n = len - i;
+      if (n > CHEAT_SEARCH_BLOCK)
+         n = CHEAT_SEARCH_BLOCK;
+
+      if (cheat_manager_matches_empty(matches, n))
+         continue;
+
+      switch (search_type)
+      {
+         case CHEAT_SEARCH_TYPE_EXACT:
+            CHEAT_SEARCH_8BIT_LOOP(c == exact)
+            break;
+         case CHEAT_SEARCH_TYPE_LT:
+            CHEAT_SEARCH_8BIT_LOOP(c < p)
+            break;
+         case CHEAT_SEARCH_TYPE_GT:
+            CHEAT_SEARCH_8BIT_LOOP(c > p)
+            break;
+         case CHEAT_SEARCH_TYPE_LTE:
+            CHEAT_SEARCH_8BIT_LOOP(c <= p)
+            break;
+         case CHEAT_SEARCH_TYPE_GTE:
+            CHEAT_SEARCH_8BIT_LOOP(c >= p)
+            break;
+         case CHEAT_SEARCH_TYPE_EQ:
+            CHEAT_SEARCH_8BIT_LOOP(c == p)
+            break;
+         case CHEAT_SEARCH_TYPE_NEQ:
+            CHEAT_SEARCH_8BIT_LOOP(c != p)
+            break;
+         case CHEAT_SEARCH_TYPE_EQPLUS:
+            CHEAT_SEARCH_8BIT_LOOP(c == p + plus)
+            break;
+         case CHEAT_SEARCH_TYPE_EQMINUS:
+            CHEAT_SEARCH_8BIT_LOOP(c == p - minus)
+            break;
+      }
+   }
+
+   return dropped;
+}
+
+/* Skips ahead over addresses that can no longer match,
+ * 'idx' is left on the last item of a skipped block */
+static bool cheat_manager_skip_dead(unsigned *idx,
+      unsigned bytes_per_item)
+{
+   cheat_manager_t *cheat_st = &cheat_manager_state;
+   unsigned pos              = *idx;
+
+   if (   (pos % CHEAT_SEARCH_BLOCK) == 0
+         && pos + CHEAT_SEARCH_BLOCK <= cheat_st->total_memory_size
+         && cheat_manager_matches_empty(cheat_st->matches + pos,
+            CHEAT_SEARCH_BLOCK))
+   {
+      *idx = pos + CHEAT_SEARCH_BLOCK - bytes_per_item;
+      return true;
+   }
+
+   /* Sub-byte parts or all bytes of an item are cleared at once */
+   return cheat_st->matches[pos] == 0;
+}
+
 static int cheat_manager_search(enum cheat_search_type search_type)
 {
    char msg[100];
@@ -1017,11 +1148,35 @@ static int cheat_manager_search(enum cheat_search_type search_type)
 
    cheat_manager_setup_search_meta(cheat_st->search_bit_size, &bytes_per_item, &mask, &bits);
 
+   if (bytes_per_item == 1 && bits == 8)
+   {
+      unsigned dropped = 0;
+
+      for (i = 0; i < cheat_st->num_memory_buffers; i++)
+      {
+         dropped += cheat_manager_search_8bit(search_type,
+               cheat_st->memory_buf_list[i], prev + offset,
+               cheat_st->matches + offset, cheat_st->memory_size_list[i]);
+         offset  += cheat_st->memory_size_list[i];
+      }
+
+      if (dropped > cheat_st->num_matches)
+         cheat_st->num_matches  = 0;
+      else
+         cheat_st->num_matches -= dropped;
+
+      /* Skip the generic path below */
+      idx = cheat_st->total_memory_size;
+   }
+
    /* little endian FF000000 = 256 */
-   for (idx = 0; idx < cheat_st->total_memory_size; idx = idx + bytes_per_item)
+   for (; idx < cheat_st->total_memory_size; idx = idx + bytes_per_item)
    {
       unsigned byte_part;
 
+      if (cheat_manager_skip_dead(&idx, bytes_per_item))
+         continue;
+
       offset = translate_address(idx, &curr);
 
       switch (bytes_per_item)
@@ -1222,6 +1377,9 @@ int cheat_manager_add_matches(const char *path,
 
    for (idx = 0; idx < cheat_st->total_memory_size; idx = idx + bytes_per_item)
    {
+      if (cheat_manager_skip_dead(&idx, bytes_per_item))
+         continue;
+
       offset = translate_address(idx, &curr);
 
       switch (bytes_per_item)
@@ -1374,9 +1532,66 @@ void cheat_manager_apply_rumble(struct item_cheat *cheat, unsigned int curr_valu
       input_driver_set_rumble_state(cheat->rumble_port, RETRO_RUMBLE_WEAK, cheat->rumble_secondary_strength);
 }
 
-void cheat_manager_apply_retro_cheats(void)
+/* Collects the enabled RetroArch-handled cheats in order, so
+ * that each frame only has to go over those. Returns false
+ * if core memory couldn't be set up, for a retry next frame */
+static bool cheat_manager_build_write_plan(void)
 {
    unsigned i;
+   unsigned count            = 0;
+   cheat_manager_t *cheat_st = &cheat_manager_state;
+
+   cheat_st->write_plan_size = 0;
+
+   for (i = 0; i < cheat_st->size; i++)
+      if (     cheat_st->cheats[i].handler == CHEAT_HANDLER_TYPE_RETRO
+            && cheat_st->cheats[i].state)
+         count++;
+
+   if (count == 0)
+   {
+      cheat_st->write_plan_dirty = false;
+      return true;
+   }
+
+   if (!cheat_st->memory_initialized)
+      cheat_manager_initialize_memory(NULL, 0, false);
+
+   /* If we're still not initialized, something
+    * must have gone wrong - just bail */
+   if (!cheat_st->memory_initialized)
+      return false;
+
+   if (cheat_st->write_plan)
+      free(cheat_st->write_plan);
+
+   if (!(cheat_st->write_plan = (struct cheat_write*)
+            malloc(count * sizeof(*cheat_st->write_plan))))
+      return false;
+
+   for (i = 0; i < cheat_st->size; i++)
+   {
+      struct cheat_write *w = NULL;
+
+      if (     cheat_st->cheats[i].handler != CHEAT_HANDLER_TYPE_RETRO
+            || !cheat_st->cheats[i].state)
+         continue;
+
+      w         = &cheat_st->write_plan[cheat_st->write_plan_size++];
+      w->cheat  = i;
+      w->curr   = cheat_st->curr_memory_buf;
+      w->offset = translate_address(cheat_st->cheats[i].address, &w->curr);
+      cheat_manager_setup_search_meta(cheat_st->cheats[i].memory_search_size,
+            &w->bytes_per_item, &w->mask, &w->bits);
+   }
+
+   cheat_st->write_plan_dirty = false;
+   return true;
+}
+
+void cheat_manager_apply_retro_cheats(void)
+{
+   unsigned k, i;
    unsigned int offset;
    unsigned int mask           = 0;
    unsigned int bytes_per_item = 1;
@@ -1391,36 +1606,33 @@ void cheat_manager_apply_retro_cheats(void)
    if ((!cheat_st->cheats))
       return;
 
-   for (i = 0; i < cheat_st->size; i++)
+   if (cheat_st->write_plan_dirty && !cheat_manager_build_write_plan())
+      return;
+
+   for (k = 0; k < cheat_st->write_plan_size; k++)
    {
-      unsigned char *curr       = NULL;
-      bool set_value            = false;
-      unsigned int idx          = 0;
-      unsigned int value_to_set = 0;
-      unsigned int repeat_iter  = 0;
-      unsigned int address_mask = cheat_st->cheats[i].address_mask;
-
-      if (cheat_st->cheats[i].handler != CHEAT_HANDLER_TYPE_RETRO || !cheat_st->cheats[i].state)
-         continue;
-      if (!cheat_st->memory_initialized)
-         cheat_manager_initialize_memory(NULL, 0, false);
+      const struct cheat_write *w = &cheat_st->write_plan[k];
+      unsigned char *curr         = w->curr;
+      bool set_value              = false;
+      unsigned int idx            = 0;
+      unsigned int value_to_set   = 0;
+      unsigned int repeat_iter    = 0;
+      unsigned int address_mask   = 0;
 
-      /* If we're still not initialized, something
-       * must have gone wrong - just bail */
-      if (!cheat_st->memory_initialized)
-         return;
+      i              = w->cheat;
+      address_mask   = cheat_st->cheats[i].address_mask;
 
       if (!run_cheat)
       {
          run_cheat = true;
          continue;
       }
-      cheat_manager_setup_search_meta(cheat_st->cheats[i].memory_search_size, &bytes_per_item, &mask, &bits);
-
-      curr   = cheat_st->curr_memory_buf;
-      idx    = cheat_st->cheats[i].address;
 
-      offset = translate_address(idx, &curr);
+      bytes_per_item = w->bytes_per_item;
+      mask           = w->mask;
+      bits           = w->bits;
+      idx            = cheat_st->cheats[i].address;
+      offset         = w->offset;
 
       switch (bytes_per_item)
       {
@@ -1606,6 +1818,11 @@ void cheat_manager_match_action(enum cheat_match_action_type match_action, unsig
 
    for (idx = start_idx; idx < cheat_st->total_memory_size; idx = idx + bytes_per_item)
    {
+      if (     match_action != CHEAT_MATCH_ACTION_TYPE_BROWSE
+            && prev
+            && cheat_manager_skip_dead(&idx, bytes_per_item))
+         continue;
+
       offset = translate_address(idx, &curr);
 
       switch (bytes_per_item)
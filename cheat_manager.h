@@ -155,6 +155,18 @@ struct item_cheat
    bool big_endian;
 };
 
+/* One enabled RetroArch-handled cheat, with its
+ * size and location resolved once up front */
+struct cheat_write
+{
+   uint8_t *curr;
+   unsigned cheat;
+   unsigned offset;
+   unsigned bytes_per_item;
+   unsigned mask;
+   unsigned bits;
+};
+
 struct cheat_manager
 {
    struct item_cheat working_cheat; /* retro_time_t alignment */
@@ -164,6 +176,9 @@ struct cheat_manager
    uint8_t *matches;
    uint8_t **memory_buf_list;
    unsigned *memory_size_list;
+   /* Applied every frame, rebuilt whenever cheats
+    * or the memory map change */
+   struct cheat_write *write_plan;
    unsigned int delete_state;
    unsigned int loading_cheat_size;
    unsigned int loading_cheat_offset;
@@ -181,11 +196,13 @@ struct cheat_manager
    unsigned search_eqminus_value;
    unsigned num_matches;
    unsigned browse_address;
+   unsigned write_plan_size;
    char working_desc[CHEAT_DESC_SCRATCH_SIZE];
    char working_code[CHEAT_CODE_SCRATCH_SIZE];
    bool  big_endian;
    bool  memory_initialized;
    bool  memory_search_initialized;
+   bool  write_plan_dirty;
 };
 
 typedef struct cheat_manager cheat_manager_t;
@@ -58,6 +58,7 @@
 #include "../paths.h"
 #include "../command.h"
 #include "../configuration.h"
+#include "../content_hash_cache.h"
 #include "../performance_counters.h"
 #include "../msg_hash.h"
 #include "../retroarch.h"
@@ -67,6 +68,7 @@
 #include "../tasks/tasks_internal.h"
 
 #include "../deps/rcheevos/include/rc_runtime.h"
+#include "../deps/rcheevos/include/rc_runtime_types.h"
 #include "../deps/rcheevos/include/rc_url.h"
 #include "../deps/rcheevos/include/rc_hash.h"
 #include "../deps/rcheevos/src/rcheevos/rc_libretro.h"
@@ -93,10 +95,21 @@ static rcheevos_locals_t rcheevos_locals =
    {0},  /* runtime */
    {0},  /* patchdata */
    {{0}},/* memory */
+   {0},  /* memory_start */
+   0,    /* memory_last_region */
    NULL, /* task */
 #ifdef HAVE_THREADS
    NULL, /* task_lock */
    CMD_EVENT_NONE, /* queued_command */
+   NULL, /* eval_thread */
+   NULL, /* eval_lock */
+   NULL, /* eval_cond */
+   {0},  /* snapshot */
+   NULL, /* eval_events */
+   0,    /* eval_event_count */
+   0,    /* eval_event_capacity */
+   false,/* eval_pending */
+   false,/* eval_quit */
 #endif
    "",   /* username */
    "",   /* token */
@@ -134,6 +147,11 @@ rcheevos_locals_t* get_rcheevos_locals(void)
 
 /* Forward declaration */
 static void rcheevos_validate_memrefs(rcheevos_locals_t* locals);
+#ifdef HAVE_THREADS
+static void rcheevos_eval_wait(rcheevos_locals_t* locals);
+static void rcheevos_eval_sync(rcheevos_locals_t* locals);
+static void rcheevos_eval_stop(rcheevos_locals_t* locals);
+#endif
 
 /*****************************************************************************
 Supporting functions.
@@ -218,9 +236,44 @@ static int rcheevos_init_memory(rcheevos_locals_t* locals)
          rcheevos_get_core_memory_info, locals->patchdata.console_id);
 
    free(descriptors);
+
+   /* Resolve where each region starts once, rather than
+    * summing region sizes on every lookup */
+   locals->memory_last_region = 0;
+   for (i = 0; i < locals->memory.count; ++i)
+      locals->memory_start[i] = (i == 0) ? 0
+         : locals->memory_start[i - 1] + (unsigned)locals->memory.size[i - 1];
+
    return result;
 }
 
+/* Same as rc_libretro_memory_find, trying the region of
+ * the previous lookup first: memrefs tend to be clustered */
+static uint8_t* rcheevos_memory_find(rcheevos_locals_t* locals,
+      unsigned address)
+{
+   const rc_libretro_memory_regions_t* regions = &locals->memory;
+   unsigned i                                  = locals->memory_last_region;
+
+   if (i >= regions->count
+         || address - locals->memory_start[i] >= regions->size[i])
+   {
+      for (i = 0; i < regions->count; ++i)
+         if (address - locals->memory_start[i] < regions->size[i])
+            break;
+
+      if (i == regions->count)
+         return NULL;
+
+      locals->memory_last_region = i;
+   }
+
+   if (!regions->data[i])
+      return NULL;
+
+   return regions->data[i] + (address - locals->memory_start[i]);
+}
+
 uint8_t* rcheevos_patch_address(unsigned address)
 {
    if (rcheevos_locals.memory.count == 0)
@@ -229,12 +282,11 @@ uint8_t* rcheevos_patch_address(unsigned address)
       rcheevos_init_memory(&rcheevos_locals);
    }
 
-   return rc_libretro_memory_find(&rcheevos_locals.memory, address);
+   return rcheevos_memory_find(&rcheevos_locals, address);
 }
 
-static unsigned rcheevos_peek(unsigned address, unsigned num_bytes, void* ud)
+static unsigned rcheevos_peek_data(const uint8_t* data, unsigned num_bytes)
 {
-   uint8_t* data = rc_libretro_memory_find(&rcheevos_locals.memory, address);
    if (data)
    {
       switch (num_bytes)
@@ -254,6 +306,12 @@ static unsigned rcheevos_peek(unsigned address, unsigned num_bytes, void* ud)
    return 0;
 }
 
+static unsigned rcheevos_peek(unsigned address, unsigned num_bytes, void* ud)
+{
+   return rcheevos_peek_data(
+         rcheevos_memory_find(&rcheevos_locals, address), num_bytes);
+}
+
 static void rcheevos_activate_achievements(rcheevos_locals_t *locals,
       rcheevos_racheevo_t* cheevo, unsigned count, unsigned flags)
 {
@@ -663,7 +721,14 @@ static void rcheevos_challenge_ended(rcheevos_racheevo_t* cheevo, int value,
 
 int rcheevos_get_richpresence(char buffer[], int buffer_size)
 {
-   int ret = rc_runtime_get_richpresence(&rcheevos_locals.runtime, buffer, buffer_size, &rcheevos_peek, NULL, NULL);
+   int ret;
+
+#ifdef HAVE_THREADS
+   /* May be called from a task, so only wait */
+   rcheevos_eval_wait(&rcheevos_locals);
+#endif
+
+   ret     = rc_runtime_get_richpresence(&rcheevos_locals.runtime, buffer, buffer_size, &rcheevos_peek, NULL, NULL);
 
    if (ret <= 0 && rcheevos_locals.patchdata.title)
       ret = snprintf(buffer, buffer_size, "Playing %s", rcheevos_locals.patchdata.title);
@@ -673,6 +738,10 @@ int rcheevos_get_richpresence(char buffer[], int buffer_size)
 
 void rcheevos_reset_game(bool widgets_ready)
 {
+#ifdef HAVE_THREADS
+   rcheevos_eval_sync(&rcheevos_locals);
+#endif
+
 #if defined(HAVE_GFX_WIDGETS)
    /* Hide any visible trackers */
    if (widgets_ready)
@@ -701,6 +770,11 @@ void rcheevos_reset_game(bool widgets_ready)
     * make sure we update our pointers */
    if (rcheevos_locals.memory.total_size > 0)
       rcheevos_init_memory(&rcheevos_locals);
+
+#ifdef HAVE_THREADS
+   /* ...and so may the regions the snapshot covers */
+   rcheevos_locals.snapshot.built = false;
+#endif
 }
 
 bool rcheevos_hardcore_active(void)
@@ -738,6 +812,10 @@ bool rcheevos_unload(void)
 #endif
    }
 
+#ifdef HAVE_THREADS
+   rcheevos_eval_stop(&rcheevos_locals);
+#endif
+
    if (rcheevos_locals.memory.count > 0)
       rc_libretro_memory_destroy(&rcheevos_locals.memory);
 
@@ -840,6 +918,10 @@ void rcheevos_leaderboards_enabled_changed(void)
    const bool leaderboards_enabled      = rcheevos_locals.leaderboards_enabled;
    const bool leaderboard_trackers      = rcheevos_locals.leaderboard_trackers;
 
+#ifdef HAVE_THREADS
+   rcheevos_eval_sync(&rcheevos_locals);
+#endif
+
    rcheevos_locals.leaderboards_enabled = rcheevos_locals.hardcore_active;
 
    if (string_is_equal(settings->arrays.cheevos_leaderboards_enable, "true"))
@@ -900,6 +982,10 @@ static void rcheevos_toggle_hardcore_active(rcheevos_locals_t* locals)
    settings_t* settings = config_get_ptr();
    bool rewind_enable   = settings->bools.rewind_enable;
 
+#ifdef HAVE_THREADS
+   rcheevos_eval_sync(locals);
+#endif
+
    if (!locals->hardcore_active)
    {
       /* Activate hardcore */
@@ -1098,7 +1184,7 @@ static void rcheevos_runtime_event_handler(const rc_runtime_event_t* runtime_eve
 
 static int rcheevos_runtime_address_validator(unsigned address)
 {
-   return (rc_libretro_memory_find(&rcheevos_locals.memory, address) != NULL);
+   return (rcheevos_memory_find(&rcheevos_locals, address) != NULL);
 }
 
 static void rcheevos_validate_memrefs(rcheevos_locals_t* locals)
@@ -1107,6 +1193,413 @@ static void rcheevos_validate_memrefs(rcheevos_locals_t* locals)
          rcheevos_runtime_event_handler, rcheevos_runtime_address_validator);
 }
 
+#ifdef HAVE_THREADS
+/* With cheevos_threaded_eval, the main thread copies the memory
+ * the runtime references into a snapshot once per frame, and the
+ * worker runs the runtime against that copy while the core moves
+ * on. Events raised by the worker are handled on the main thread
+ * the next frame. Anything else touching the runtime on the main
+ * thread waits for the worker first (rcheevos_eval_sync). */
+
+/* Spans closer than this are copied as one */
+#define RCHEEVOS_SNAPSHOT_GAP 32
+/* Past this, copying costs more than it saves */
+#define RCHEEVOS_SNAPSHOT_MAX CHEEVOS_MB(4)
+
+/* Returns the first address past the memory region
+ * holding 'address', or 0 if no region holds it */
+static unsigned rcheevos_memory_region_end(
+      const rc_libretro_memory_regions_t* regions, unsigned address)
+{
+   unsigned i;
+   unsigned start = 0;
+
+   for (i = 0; i < regions->count; ++i)
+   {
+      const unsigned end = start + (unsigned)regions->size[i];
+
+      if (address < end)
+         return regions->data[i] ? end : 0;
+
+      start = end;
+   }
+
+   return 0;
+}
+
+/* Indirect memrefs are not in the runtime memref chain,
+ * and their addresses are only known while evaluating */
+static bool rcheevos_uses_indirection(const rcheevos_locals_t* locals)
+{
+   const rcheevos_rapatchdata_t* patchdata = &locals->patchdata;
+   unsigned i;
+
+   for (i = 0; i < patchdata->core_count; ++i)
+      if (patchdata->core[i].memaddr && strstr(patchdata->core[i].memaddr, "I:"))
+         return true;
+
+   for (i = 0; i < patchdata->unofficial_count; ++i)
+      if (patchdata->unofficial[i].memaddr && strstr(patchdata->unofficial[i].memaddr, "I:"))
+         return true;
+
+   for (i = 0; i < patchdata->lboard_count; ++i)
+      if (patchdata->lboards[i].mem && strstr(patchdata->lboards[i].mem, "I:"))
+         return true;
+
+   return (patchdata->richpresence_script
+         && strstr(patchdata->richpresence_script, "I:"));
+}
+
+static int rcheevos_snapshot_span_compare(const void* a, const void* b)
+{
+   const rcheevos_snapshot_span_t* span_a = (const rcheevos_snapshot_span_t*)a;
+   const rcheevos_snapshot_span_t* span_b = (const rcheevos_snapshot_span_t*)b;
+
+   if (span_a->address < span_b->address)
+      return -1;
+   return (span_a->address > span_b->address);
+}
+
+static void rcheevos_snapshot_free(rcheevos_snapshot_t* snapshot)
+{
+   CHEEVOS_FREE(snapshot->spans);
+   CHEEVOS_FREE(snapshot->data);
+   memset(snapshot, 0, sizeof(*snapshot));
+}
+
+static void rcheevos_snapshot_build(rcheevos_locals_t* locals)
+{
+   rcheevos_snapshot_t* snapshot               = &locals->snapshot;
+   const rc_libretro_memory_regions_t* regions = &locals->memory;
+   rcheevos_snapshot_span_t* spans             = NULL;
+   rc_memref_t* memref                         = NULL;
+   unsigned count                              = 0;
+   unsigned i, j;
+
+   rcheevos_snapshot_free(snapshot);
+
+   snapshot->built       = true;
+   snapshot->next_memref = locals->runtime.next_memref;
+
+   if (rcheevos_uses_indirection(locals))
+   {
+      /* Pointers may lead anywhere, copy all of memory */
+      unsigned address = 0;
+
+      spans = (rcheevos_snapshot_span_t*)malloc(
+            (regions->count + 1) * sizeof(*spans));
+      if (!spans)
+         return;
+
+      for (i = 0; i < regions->count; ++i)
+      {
+         if (regions->data[i] && regions->size[i])
+         {
+            spans[count].address = address;
+            spans[count].size    = (unsigned)regions->size[i];
+            count++;
+         }
+
+         address += (unsigned)regions->size[i];
+      }
+   }
+   else
+   {
+      for (memref = locals->runtime.memrefs; memref; memref = memref->next)
+         count++;
+
+      spans = (rcheevos_snapshot_span_t*)malloc(
+            (count + 1) * sizeof(*spans));
+      if (!spans)
+         return;
+
+      count = 0;
+      for (memref = locals->runtime.memrefs; memref; memref = memref->next)
+      {
+         unsigned size;
+         const unsigned end = rcheevos_memory_region_end(
+               regions, memref->address);
+
+         /* Never readable, peeks as 0 either way */
+         if (!end)
+            continue;
+
+         switch (memref->value.size)
+         {
+            case RC_MEMSIZE_16_BITS:
+               size = 2;
+               break;
+            case RC_MEMSIZE_24_BITS:
+            case RC_MEMSIZE_32_BITS:
+               size = 4;
+               break;
+            default:
+               size = 1;
+               break;
+         }
+
+         if (size > end - memref->address)
+            size = end - memref->address;
+
+         spans[count].address = memref->address;
+         spans[count].size    = size;
+         count++;
+      }
+
+      qsort(spans, count, sizeof(*spans), rcheevos_snapshot_span_compare);
+
+      /* Merge spans close enough to be copied as one,
+       * as long as they are in the same region */
+      for (i = 1, j = 0; i < count; ++i)
+      {
+         const unsigned end = spans[j].address + spans[j].size;
+
+         if (     spans[i].address <= end + RCHEEVOS_SNAPSHOT_GAP
+               && rcheevos_memory_region_end(regions, spans[i].address)
+               == rcheevos_memory_region_end(regions, spans[j].address))
+         {
+            if (spans[i].address + spans[i].size > end)
+               spans[j].size = spans[i].address + spans[i].size
+                  - spans[j].address;
+         }
+         else
+            spans[++j] = spans[i];
+      }
+
+      if (count > 0)
+         count = j + 1;
+   }
+
+   for (i = 0; i < count; ++i)
+   {
+      spans[i].offset       = snapshot->size;
+      snapshot->size       += spans[i].size;
+   }
+
+   snapshot->spans          = spans;
+   snapshot->span_count     = count;
+
+   if (snapshot->size > RCHEEVOS_SNAPSHOT_MAX)
+   {
+      CHEEVOS_LOG(RCHEEVOS_TAG "Referenced memory too large to snapshot (%u bytes), evaluating on the main thread\n",
+            snapshot->size);
+      return;
+   }
+
+   snapshot->data           = (uint8_t*)malloc(snapshot->size + 1);
+   snapshot->valid          = (snapshot->data != NULL);
+
+   CHEEVOS_LOG(RCHEEVOS_TAG "Memory snapshot of %u bytes in %u spans\n",
+         snapshot->size, snapshot->span_count);
+}
+
+static void rcheevos_snapshot_take(rcheevos_locals_t* locals)
+{
+   rcheevos_snapshot_t* snapshot = &locals->snapshot;
+   unsigned i;
+
+   for (i = 0; i < snapshot->span_count; ++i)
+   {
+      const rcheevos_snapshot_span_t* span = &snapshot->spans[i];
+      const uint8_t* src = rcheevos_memory_find(locals, span->address);
+
+      if (src)
+         memcpy(snapshot->data + span->offset, src, span->size);
+      else
+         memset(snapshot->data + span->offset, 0, span->size);
+   }
+}
+
+static unsigned rcheevos_snapshot_peek(unsigned address,
+      unsigned num_bytes, void* ud)
+{
+   const rcheevos_snapshot_t* snapshot = (const rcheevos_snapshot_t*)ud;
+   unsigned low                        = 0;
+   unsigned high                       = snapshot->span_count;
+
+   /* Find the last span starting at or before 'address' */
+   while (low < high)
+   {
+      const unsigned mid = (low + high) / 2;
+
+      if (snapshot->spans[mid].address <= address)
+         low  = mid + 1;
+      else
+         high = mid;
+   }
+
+   if (low > 0)
+   {
+      const rcheevos_snapshot_span_t* span = &snapshot->spans[low - 1];
+      const unsigned offset                = address - span->address;
+
+      if (offset + num_bytes <= span->size)
+         return rcheevos_peek_data(
+               snapshot->data + span->offset + offset, num_bytes);
+   }
+
+   return 0;
+}
+
+/* Called on the worker, queues the event for the main thread */
+static void rcheevos_eval_event_handler(const rc_runtime_event_t* runtime_event)
+{
+   rcheevos_locals_t* locals = &rcheevos_locals;
+
+   if (locals->eval_event_count == locals->eval_event_capacity)
+   {
+      const unsigned capacity    = locals->eval_event_capacity
+         ? locals->eval_event_capacity * 2 : 16;
+      rc_runtime_event_t* events = (rc_runtime_event_t*)realloc(
+            locals->eval_events, capacity * sizeof(*events));
+
+      if (!events)
+         return;
+
+      locals->eval_events         = events;
+      locals->eval_event_capacity = capacity;
+   }
+
+   memcpy(&locals->eval_events[locals->eval_event_count++],
+         runtime_event, sizeof(*runtime_event));
+}
+
+static void rcheevos_eval_thread(void* userdata)
+{
+   rcheevos_locals_t* locals = (rcheevos_locals_t*)userdata;
+
+   slock_lock(locals->eval_lock);
+
+   for (;;)
+   {
+      while (!locals->eval_pending && !locals->eval_quit)
+         scond_wait(locals->eval_cond, locals->eval_lock);
+
+      if (locals->eval_quit)
+         break;
+
+      slock_unlock(locals->eval_lock);
+
+      rc_runtime_do_frame(&locals->runtime, &rcheevos_eval_event_handler,
+            rcheevos_snapshot_peek, &locals->snapshot, 0);
+
+      slock_lock(locals->eval_lock);
+      locals->eval_pending = false;
+      scond_broadcast(locals->eval_cond);
+   }
+
+   slock_unlock(locals->eval_lock);
+}
+
+static bool rcheevos_eval_start(rcheevos_locals_t* locals)
+{
+   locals->eval_pending = false;
+   locals->eval_quit    = false;
+
+   if (     (locals->eval_lock   = slock_new())
+         && (locals->eval_cond   = scond_new())
+         && (locals->eval_thread = sthread_create(
+               rcheevos_eval_thread, locals)))
+   {
+      CHEEVOS_LOG(RCHEEVOS_TAG "Evaluating achievements on a worker thread\n");
+      return true;
+   }
+
+   rcheevos_eval_stop(locals);
+   return false;
+}
+
+/* Stops the worker, any events it queued are dropped */
+static void rcheevos_eval_stop(rcheevos_locals_t* locals)
+{
+   if (locals->eval_thread)
+   {
+      slock_lock(locals->eval_lock);
+      locals->eval_quit = true;
+      scond_broadcast(locals->eval_cond);
+      slock_unlock(locals->eval_lock);
+
+      sthread_join(locals->eval_thread);
+      locals->eval_thread = NULL;
+   }
+
+   if (locals->eval_cond)
+      scond_free(locals->eval_cond);
+   if (locals->eval_lock)
+      slock_free(locals->eval_lock);
+
+   locals->eval_cond           = NULL;
+   locals->eval_lock           = NULL;
+   locals->eval_pending        = false;
+
+   rcheevos_snapshot_free(&locals->snapshot);
+
+   CHEEVOS_FREE(locals->eval_events);
+   locals->eval_events         = NULL;
+   locals->eval_event_count    = 0;
+   locals->eval_event_capacity = 0;
+}
+
+/* Waits for the worker to be done with the runtime */
+static void rcheevos_eval_wait(rcheevos_locals_t* locals)
+{
+   if (!locals->eval_thread)
+      return;
+
+   slock_lock(locals->eval_lock);
+   while (locals->eval_pending)
+      scond_wait(locals->eval_cond, locals->eval_lock);
+   slock_unlock(locals->eval_lock);
+}
+
+/* Waits for the worker, then handles the events it queued.
+ * Main thread only */
+static void rcheevos_eval_sync(rcheevos_locals_t* locals)
+{
+   unsigned i;
+   unsigned count;
+
+   rcheevos_eval_wait(locals);
+
+   /* Handling an event may end up back in here */
+   count                    = locals->eval_event_count;
+   locals->eval_event_count = 0;
+
+   for (i = 0; i < count && locals->loaded && locals->eval_events; ++i)
+      rcheevos_runtime_event_handler(&locals->eval_events[i]);
+}
+
+/* Hands this frame to the worker, returns false if it
+ * has to be evaluated on the main thread instead */
+static bool rcheevos_eval_frame(rcheevos_locals_t* locals)
+{
+   if (!locals->eval_thread && !rcheevos_eval_start(locals))
+      return false;
+
+   rcheevos_eval_sync(locals);
+
+   if (!locals->loaded)
+      return true;
+
+   /* Activating achievements or leaderboards appends memrefs */
+   if (     !locals->snapshot.built
+         ||  locals->snapshot.next_memref != locals->runtime.next_memref)
+      rcheevos_snapshot_build(locals);
+
+   if (!locals->snapshot.valid)
+      return false;
+
+   rcheevos_snapshot_take(locals);
+
+   slock_lock(locals->eval_lock);
+   locals->eval_pending = true;
+   scond_broadcast(locals->eval_cond);
+   slock_unlock(locals->eval_lock);
+
+   return true;
+}
+#endif
+
 /*****************************************************************************
 Test all the achievements (call once per frame).
 *****************************************************************************/
@@ -1147,6 +1640,23 @@ void rcheevos_test(void)
       rcheevos_validate_memrefs(&rcheevos_locals);
    }
 
+#ifdef HAVE_THREADS
+   {
+      const settings_t* settings = config_get_ptr();
+
+      if (settings->bools.cheevos_threaded_eval)
+      {
+         if (rcheevos_eval_frame(&rcheevos_locals))
+            return;
+      }
+      else if (rcheevos_locals.eval_thread)
+      {
+         rcheevos_eval_sync(&rcheevos_locals);
+         rcheevos_eval_stop(&rcheevos_locals);
+      }
+   }
+#endif
+
    rc_runtime_do_frame(&rcheevos_locals.runtime, &rcheevos_runtime_event_handler, rcheevos_peek, NULL, 0);
 }
 
@@ -1154,6 +1664,9 @@ size_t rcheevos_get_serialize_size(void)
 {
    if (!rcheevos_locals.loaded)
       return 0;
+#ifdef HAVE_THREADS
+   rcheevos_eval_sync(&rcheevos_locals);
+#endif
    return rc_runtime_progress_size(&rcheevos_locals.runtime, NULL);
 }
 
@@ -1161,6 +1674,9 @@ bool rcheevos_get_serialized_data(void* buffer)
 {
    if (!rcheevos_locals.loaded)
       return false;
+#ifdef HAVE_THREADS
+   rcheevos_eval_sync(&rcheevos_locals);
+#endif
    return (rc_runtime_serialize_progress(buffer, &rcheevos_locals.runtime, NULL) == RC_OK);
 }
 
@@ -1168,6 +1684,10 @@ bool rcheevos_set_serialized_data(void* buffer)
 {
    if (rcheevos_locals.loaded)
    {
+#ifdef HAVE_THREADS
+      rcheevos_eval_sync(&rcheevos_locals);
+#endif
+
       if (buffer && rc_runtime_deserialize_progress(&rcheevos_locals.runtime, (const unsigned char*)buffer, NULL) == RC_OK)
          return true;
 
@@ -1198,6 +1718,9 @@ static void rcheevos_unlock_cb(unsigned id, void* userdata)
    if (cheevo)
    {
       unsigned mode = *(unsigned*)userdata;
+#ifdef HAVE_THREADS
+      rcheevos_eval_wait(&rcheevos_locals);
+#endif
 #ifndef CHEEVOS_DONT_DEACTIVATE
       cheevo->active &= ~mode;
 #endif
@@ -1269,6 +1792,41 @@ enum
    RCHEEVOS_DELAY        = -8
 };
 
+/* Hashes of cue sheets, playlists and the like come from
+ * the files they list, and are not kept in the hash cache */
+static bool rcheevos_hash_depends_on_other_files(const char *path)
+{
+   const char *ext = path_get_extension(path);
+
+   return   string_is_equal_noncase(ext, "cue")
+         || string_is_equal_noncase(ext, "gdi")
+         || string_is_equal_noncase(ext, "m3u")
+         || string_is_equal_noncase(ext, "ccd")
+         || string_is_equal_noncase(ext, "toc")
+         || path_contains_compressed_file(path);
+}
+
+static bool rcheevos_hash_cache_get(const char *path, char *hash)
+{
+   content_hash_entry_t entry;
+
+   if (     !content_hash_cache_get(path, &entry)
+         || !(entry.flags & CONTENT_HASH_RCHEEVOS))
+      return false;
+
+   strlcpy(hash, entry.rcheevos, sizeof(entry.rcheevos));
+   return true;
+}
+
+static void rcheevos_hash_cache_put(const char *path, const char *hash)
+{
+   content_hash_entry_t entry;
+
+   entry.flags = CONTENT_HASH_RCHEEVOS;
+   strlcpy(entry.rcheevos, hash, sizeof(entry.rcheevos));
+   content_hash_cache_put(path, &entry);
+}
+
 static int rcheevos_iterate(rcheevos_coro_t* coro)
 {
    char buffer[2048];
@@ -1291,26 +1849,41 @@ static int rcheevos_iterate(rcheevos_coro_t* coro)
       rcheevos_locals.network_error = false;
       /* reset the identified game id */
       rcheevos_locals.patchdata.game_id = 0;
+      coro->gameid                      = 0;
+
+      /* try the hash the game was identified by last time, unless
+       * the file is a playlist or cue sheet whose tracks may have
+       * changed without it */
+      if (     !rcheevos_hash_depends_on_other_files(coro->path)
+            && rcheevos_hash_cache_get(coro->path, coro->hash))
+         CORO_GOSUB(RCHEEVOS_GET_GAMEID);
 
-      /* iterate over the possible hashes for the file being loaded */
-      rc_hash_initialize_iterator(&coro->iterator, coro->path, (uint8_t*)coro->data, coro->len);
+      if (coro->gameid == 0)
+      {
+         /* iterate over the possible hashes for the file being loaded */
+         rc_hash_initialize_iterator(&coro->iterator, coro->path, (uint8_t*)coro->data, coro->len);
 #ifdef CHEEVOS_TIME_HASH
-      start = cpu_features_get_time_usec();
+         start = cpu_features_get_time_usec();
 #endif
-      while (rc_hash_iterate(coro->hash, &coro->iterator))
-      {
+         while (rc_hash_iterate(coro->hash, &coro->iterator))
+         {
 #ifdef CHEEVOS_TIME_HASH
-         CHEEVOS_LOG(RCHEEVOS_TAG "hash generated in %ums\n", (cpu_features_get_time_usec() - start) / 1000);
+            CHEEVOS_LOG(RCHEEVOS_TAG "hash generated in %ums\n", (cpu_features_get_time_usec() - start) / 1000);
 #endif
-         CORO_GOSUB(RCHEEVOS_GET_GAMEID);
-         if (coro->gameid != 0)
-            break;
+            CORO_GOSUB(RCHEEVOS_GET_GAMEID);
+            if (coro->gameid != 0)
+               break;
 
 #ifdef CHEEVOS_TIME_HASH
-         start = cpu_features_get_time_usec();
+            start = cpu_features_get_time_usec();
 #endif
+         }
+         rc_hash_destroy_iterator(&coro->iterator);
+
+         if (     coro->gameid != 0
+               && !rcheevos_hash_depends_on_other_files(coro->path))
+            rcheevos_hash_cache_put(coro->path, coro->hash);
       }
-      rc_hash_destroy_iterator(&coro->iterator);
 
       /* if no match was found, bail */
       if (coro->gameid == 0)
@@ -121,16 +121,47 @@ void rcheevos_menu_reset_badges(void);
 
 #endif
 
+#ifdef HAVE_THREADS
+typedef struct rcheevos_snapshot_span_t
+{
+   unsigned address;                  /* first address covered */
+   unsigned size;                     /* number of bytes covered */
+   unsigned offset;                   /* position of the bytes in the snapshot */
+} rcheevos_snapshot_span_t;
+
+typedef struct rcheevos_snapshot_t
+{
+   rcheevos_snapshot_span_t* spans;   /* covered addresses, sorted */
+   uint8_t* data;                     /* copy of the covered memory */
+   rc_memref_t** next_memref;         /* runtime memref chain end when built */
+   unsigned span_count;               /* number of items in the spans array */
+   unsigned size;                     /* number of bytes in the data buffer */
+   bool built;                        /* spans match the runtime memrefs */
+   bool valid;                        /* false if too large to be copied every frame */
+} rcheevos_snapshot_t;
+#endif
+
 typedef struct rcheevos_locals_t
 {
    rc_runtime_t runtime;              /* rcheevos runtime state */
    rcheevos_rapatchdata_t patchdata;  /* achievement/leaderboard data from the server */
    rc_libretro_memory_regions_t memory;/* achievement addresses to core memory mappings */
+   unsigned memory_start[RC_LIBRETRO_MAX_MEMORY_REGIONS]; /* first achievement address of each memory region */
+   unsigned memory_last_region;       /* region the last address lookup landed in */
 
    retro_task_t* task;                /* load task */
 #ifdef HAVE_THREADS
    slock_t* task_lock;                /* mutex for starting/stopping load task */
    enum event_command queued_command; /* action queued by background thread to be run on main thread */
+   sthread_t* eval_thread;            /* worker evaluating the runtime against the snapshot */
+   slock_t* eval_lock;                /* mutex for eval_pending/eval_quit */
+   scond_t* eval_cond;                /* signaled when eval_pending/eval_quit change */
+   rcheevos_snapshot_t snapshot;      /* memory referenced by the runtime, as of the last frame */
+   rc_runtime_event_t* eval_events;   /* events raised by the worker, handled on the main thread */
+   unsigned eval_event_count;         /* current number of items in the eval_events array */
+   unsigned eval_event_capacity;      /* maximum number of items in the eval_events array */
+   bool eval_pending;                 /* worker has a snapshot to evaluate */
+   bool eval_quit;                    /* worker should exit */
 #endif
 
    char username[32];                 /* case-corrected username */
@@ -59,8 +59,9 @@ static bool command_get_arg(const char *tok,
       if (str == tok)
       {
          const char *argument = str + strlen(action_map[i].str);
+         /* May be a longer command sharing this prefix */
          if (*argument != ' ' && *argument != '\0')
-            return false;
+            continue;
 
          if (arg)
             *arg = argument + 1;
@@ -119,6 +120,9 @@ typedef struct
    struct sockaddr_storage cmd_source;
    /* Size of the previous structure in use */
    socklen_t cmd_source_len;
+   /* Address memory subscriptions are pushed to */
+   struct sockaddr_storage sub_addr;
+   socklen_t sub_addr_len;
 } command_network_t;
 
 static void network_command_reply(
@@ -131,6 +135,22 @@ static void network_command_reply(
       (struct sockaddr*)&netcmd->cmd_source, netcmd->cmd_source_len);
 }
 
+static void network_command_subscribe(command_t *cmd)
+{
+   command_network_t *netcmd = (command_network_t*)cmd->userptr;
+   memcpy(&netcmd->sub_addr, &netcmd->cmd_source, sizeof(netcmd->sub_addr));
+   netcmd->sub_addr_len      = netcmd->cmd_source_len;
+}
+
+static void network_command_push(
+      command_t *cmd,
+      const char * data, size_t len)
+{
+   command_network_t *netcmd = (command_network_t*)cmd->userptr;
+   sendto(netcmd->net_fd, data, len, 0,
+      (struct sockaddr*)&netcmd->sub_addr, netcmd->sub_addr_len);
+}
+
 static void network_command_free(command_t *handle)
 {
    command_network_t *netcmd = (command_network_t*)handle->userptr;
@@ -201,6 +221,8 @@ command_t* command_network_new(uint16_t port)
    cmd->poll      = command_network_poll;
    cmd->replier   = network_command_reply;
    cmd->destroy   = network_command_free;
+   cmd->subscribe = network_command_subscribe;
+   cmd->push      = network_command_push;
 
    if (!socket_nonblock(netcmd->net_fd))
       goto error;
@@ -305,6 +327,7 @@ command_t* command_stdin_new(void)
    cmd->poll    = command_stdin_poll;
    cmd->replier = stdin_command_reply;
    cmd->destroy = stdin_command_free;
+   cmd->push    = stdin_command_reply;
 
    return cmd;
 }
@@ -321,6 +344,8 @@ typedef struct
    int userfd[MAX_USER_CONNECTIONS];
    /* Last received user socket */
    int last_fd;
+   /* User socket memory subscriptions are pushed to */
+   int sub_fd;
 } command_uds_t;
 
 static void uds_command_reply(
@@ -331,6 +356,21 @@ static void uds_command_reply(
    write(subcmd->last_fd, data, len);
 }
 
+static void uds_command_subscribe(command_t *cmd)
+{
+   command_uds_t *subcmd = (command_uds_t*)cmd->userptr;
+   subcmd->sub_fd        = subcmd->last_fd;
+}
+
+static void uds_command_push(
+      command_t *cmd,
+      const char * data, size_t len)
+{
+   command_uds_t *subcmd = (command_uds_t*)cmd->userptr;
+   if (subcmd->sub_fd >= 0)
+      write(subcmd->sub_fd, data, len);
+}
+
 static void uds_command_free(command_t *handle)
 {
    int i;
@@ -385,6 +425,12 @@ static void command_uds_poll(command_t *handle)
                break;   /* no more data */
             if (!ret)
             {
+               /* Subscriber went away */
+               if (udscmd->sub_fd == udscmd->userfd[i])
+               {
+                  udscmd->sub_fd          = -1;
+                  handle->subscribe_count = 0;
+               }
                socket_close(udscmd->userfd[i]);
                udscmd->userfd[i] = -1;
                break;
@@ -450,13 +496,16 @@ command_t* command_uds_new(void)
    subcmd          = (command_uds_t*)calloc(1, sizeof(command_uds_t));
    subcmd->sfd     = fd;
    subcmd->last_fd = -1;
+   subcmd->sub_fd  = -1;
    for (i = 0; i < MAX_USER_CONNECTIONS; i++)
       subcmd->userfd[i] = -1;
 
-   cmd->userptr = subcmd;
-   cmd->poll    = command_uds_poll;
-   cmd->replier = uds_command_reply;
-   cmd->destroy = uds_command_free;
+   cmd->userptr   = subcmd;
+   cmd->poll      = command_uds_poll;
+   cmd->replier   = uds_command_reply;
+   cmd->destroy   = uds_command_free;
+   cmd->subscribe = uds_command_subscribe;
+   cmd->push      = uds_command_push;
 
    return cmd;
 }
@@ -35,6 +35,13 @@ RETRO_BEGIN_DECLS
 #define MAX_CMD_DRIVERS              3
 #define DEFAULT_NETWORK_CMD_PORT 55355
 
+/* Most ranges a single READ_CORE_MEMORY_BIN or
+ * SUBSCRIBE_CORE_MEMORY command may ask for */
+#define COMMAND_MEMORY_RANGES_MAX 32
+/* Binary memory replies are kept small enough
+ * to fit in a single UDP datagram */
+#define COMMAND_MEMORY_REPLY_MAX  65000
+
 struct cmd_map
 {
    const char *str;
@@ -46,6 +53,13 @@ struct command_handler;
 typedef void (*command_poller_t)(struct command_handler *cmd);
 typedef void (*command_replier_t)(struct command_handler *cmd, const char * data, size_t len);
 typedef void (*command_destructor_t)(struct command_handler *cmd);
+typedef void (*command_subscriber_t)(struct command_handler *cmd);
+
+typedef struct command_memory_range
+{
+   unsigned address;
+   unsigned len;
+} command_memory_range_t;
 
 struct command_handler
 {
@@ -55,8 +69,19 @@ struct command_handler
    command_replier_t replier;
    /* Interface to delete the underlying command */
    command_destructor_t destroy;
+   /* Interface to make the sender of the current
+    * command the target of 'push' (optional) */
+   command_subscriber_t subscribe;
+   /* Interface to send to the subscriber,
+    * NULL if subscriptions are not supported */
+   command_replier_t push;
    /* Underlying command storage */
    void *userptr;
+   /* Memory ranges pushed every 'subscribe_interval' frames */
+   command_memory_range_t subscribe_ranges[COMMAND_MEMORY_RANGES_MAX];
+   uint64_t subscribe_last_frame;
+   unsigned subscribe_count;
+   unsigned subscribe_interval;
    /* State received */
    bool state[RARCH_BIND_LIST_END];
 };
@@ -145,6 +170,12 @@ enum event_command
    CMD_EVENT_VIDEO_APPLY_STATE_CHANGES,
    /* Set video blocking state. */
    CMD_EVENT_VIDEO_SET_BLOCKING_STATE,
+   /* Recreates the swapchain in place if the video
+    * driver can do so. */
+   CMD_EVENT_VIDEO_SWAPCHAIN_REINIT,
+   /* Swaps the video filter, reinitializing the
+    * drivers only if the new one doesn't fit. */
+   CMD_EVENT_VIDEO_FILTER_REINIT,
    /* Sets current aspect ratio index. */
    CMD_EVENT_VIDEO_SET_ASPECT_RATIO,
    /* Restarts RetroArch. */
@@ -228,10 +259,15 @@ enum event_command
    CMD_EVENT_DISCORD_UPDATE,
    CMD_EVENT_OSK_TOGGLE,
    CMD_EVENT_RECORDING_TOGGLE,
+   /* Saves the instant replay buffer of the recording */
+   CMD_EVENT_INSTANT_REPLAY_SAVE,
    CMD_EVENT_STREAMING_TOGGLE,
    CMD_EVENT_RUNAHEAD_TOGGLE,
    CMD_EVENT_AI_SERVICE_TOGGLE,
    CMD_EVENT_BSV_RECORDING_TOGGLE,
+   /* Seeks BSV movie playback, data is the target
+    * frame or time as a string */
+   CMD_EVENT_BSV_SEEK,
    CMD_EVENT_SHADER_NEXT,
    CMD_EVENT_SHADER_PREV,
    CMD_EVENT_CHEAT_INDEX_PLUS,
@@ -282,6 +318,14 @@ bool command_set_shader(command_t *cmd, const char *arg);
 #if defined(HAVE_COMMAND)
 bool command_version(command_t *cmd, const char* arg);
 bool command_get_status(command_t *cmd, const char* arg);
+bool command_get_frame_telemetry(command_t *cmd, const char* arg);
+bool command_dump_frame_telemetry(command_t *cmd, const char* arg);
+bool command_dump_shader_pass_timings(command_t *cmd, const char* arg);
+bool command_perf_trace(command_t *cmd, const char* arg);
+bool command_dump_perf_trace(command_t *cmd, const char* arg);
+#ifdef HAVE_BSV_MOVIE
+bool command_bsv_seek(command_t *cmd, const char* arg);
+#endif
 bool command_get_config_param(command_t *cmd, const char* arg);
 bool command_show_osd_msg(command_t *cmd, const char* arg);
 #ifdef HAVE_CHEEVOS
@@ -290,6 +334,8 @@ bool command_write_ram(command_t *cmd, const char *arg);
 #endif
 bool command_read_memory(command_t *cmd, const char *arg);
 bool command_write_memory(command_t *cmd, const char *arg);
+bool command_read_memory_bin(command_t *cmd, const char *arg);
+bool command_subscribe_memory(command_t *cmd, const char *arg);
 
 struct cmd_action_map
 {
@@ -304,6 +350,14 @@ static const struct cmd_action_map action_map[] = {
 #endif
    { "VERSION",          command_version,          "No argument"},
    { "GET_STATUS",       command_get_status,       "No argument" },
+   { "GET_FRAME_TELEMETRY",  command_get_frame_telemetry,  "[number of frames]" },
+   { "DUMP_FRAME_TELEMETRY", command_dump_frame_telemetry, "<csv path>" },
+   { "DUMP_SHADER_PASS_TIMINGS", command_dump_shader_pass_timings, "<csv path>" },
+   { "PERF_TRACE",           command_perf_trace,           "<0|1>" },
+   { "DUMP_PERF_TRACE",      command_dump_perf_trace,      "<json path>" },
+#ifdef HAVE_BSV_MOVIE
+   { "BSV_SEEK",             command_bsv_seek,             "<frame>" },
+#endif
    { "GET_CONFIG_PARAM", command_get_config_param, "<param name>" },
    { "SHOW_MSG",         command_show_osd_msg,     "No argument" },
 #if defined(HAVE_CHEEVOS)
@@ -314,6 +368,13 @@ static const struct cmd_action_map action_map[] = {
 #endif
    { "READ_CORE_MEMORY", command_read_memory,      "<address> <number of bytes>" },
    { "WRITE_CORE_MEMORY",command_write_memory,     "<address> <byte1> <byte2> ..." },
+   /* Binary replies: the command name and the number of ranges on
+    * one line, then per range its address and length as 32-bit
+    * little endian words followed by the raw bytes (length 0 if
+    * the range could not be read). Subscribed ranges are pushed
+    * the same way, named CORE_MEMORY_UPDATE */
+   { "READ_CORE_MEMORY_BIN",  command_read_memory_bin,  "<address> <number of bytes> ..." },
+   { "SUBSCRIBE_CORE_MEMORY", command_subscribe_memory, "<frames> [<address> <number of bytes> ...]" },
 };
 
 static const struct cmd_map map[] = {
@@ -365,6 +426,7 @@ static const struct cmd_map map[] = {
    { "MENU_A",                 RETRO_DEVICE_ID_JOYPAD_A },
    { "MENU_B",                 RETRO_DEVICE_ID_JOYPAD_B },
    { "AI_SERVICE",             RARCH_AI_SERVICE },
+   { "INSTANT_REPLAY_SAVE",    RARCH_INSTANT_REPLAY_SAVE },
 };
 #endif
 
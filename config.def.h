@@ -286,6 +286,15 @@
 /* Number of threads to use for video recording */
 #define DEFAULT_VIDEO_RECORD_THREADS 2
 
+/* Seconds of encoded video and audio a recording keeps
+ * in memory, written out on demand with the instant
+ * replay hotkey. 0 records to a file as usual. */
+#define DEFAULT_INSTANT_REPLAY_LENGTH 0
+
+/* Also write the stream to a file in the recording
+ * directory, reusing the encode of the stream. */
+#define DEFAULT_STREAMING_RECORD_COPY false
+
 #if defined(RARCH_CONSOLE) || defined(__APPLE__)
 #define DEFAULT_LOAD_DUMMY_ON_CORE_SHUTDOWN false
 #else
@@ -342,6 +351,20 @@
 #define DEFAULT_FRAME_DELAY 0
 #define MAXIMUM_FRAME_DELAY 19
 
+/* Lets the runloop pick the frame delay on its own, based on
+ * how long the core takes to produce a frame. video_frame_delay
+ * then acts as the upper bound (0: no bound besides MAXIMUM_FRAME_DELAY).
+ */
+#define DEFAULT_FRAME_DELAY_AUTO false
+
+/* Measures input latency: the first frame shown after a
+ * RetroPad button of user 1 is pressed gets a white square
+ * in its top left corner (for a photodiode), and the time
+ * of each stage up to presentation is added to the
+ * 'latency_*' performance counters.
+ */
+#define DEFAULT_LATENCY_TEST false
+
 /* Inserts black frame(s) inbetween frames.
  * Useful for Higher Hz monitors (set to multiples of 60 Hz) who want to play 60 Hz 
  * material with eliminated  ghosting. video_refresh_rate should still be configured
@@ -421,6 +444,11 @@
 
 #define DEFAULT_SHADER_DELAY 0
 
+/* GPU memory (in MB) the frontend tries to stay within by
+ * unloading cached thumbnails and loading wallpapers without
+ * mipmaps. 0 means no budget. */
+#define DEFAULT_VIDEO_GPU_MEMORY_BUDGET 0
+
 /* Only scale in integer steps.
  * The base size depends on system-reported geometry and aspect ratio.
  * If video_force_aspect is not set, X/Y will be integer scaled independently.
@@ -657,6 +685,10 @@ static const bool menu_savestate_resume     = false;
 
 #define DEFAULT_MENU_INSERT_DISK_RESUME true
 
+/* Wait for the menu to be opened before initialising
+ * it when content is launched from the command line */
+#define DEFAULT_MENU_DEFER_INIT false
+
 #define DEFAULT_QUIT_ON_CLOSE_CONTENT QUIT_ON_CLOSE_CONTENT_DISABLED
 
 /* While the menu is active, supported drivers
@@ -665,6 +697,11 @@ static const bool menu_savestate_resume     = false;
  * the screensaver */
 #define DEFAULT_MENU_SCREENSAVER_TIMEOUT 0
 
+/* When enabled, the menu stops redrawing and
+ * presenting frames while nothing on screen changes
+ * (no input, animations, messages or running tasks) */
+#define DEFAULT_MENU_SKIP_IDLE_FRAMES false
+
 #if defined(HAVE_MATERIALUI) || defined(HAVE_XMB) || defined(HAVE_OZONE)
 /* When menu screensaver is enabled, specifies
  * animation effect and animation speed */
@@ -785,6 +822,10 @@ static const bool default_savefiles_in_content_dir = false;
 static const bool default_systemfiles_in_content_dir = false;
 static const bool default_screenshots_in_content_dir = false;
 
+/* Trade PNG size for speed when saving screenshots,
+ * by using the fastest deflate level. */
+static const bool default_screenshot_fast_compression = false;
+
 #if defined(RS90) || defined(RETROFW)
 #define DEFAULT_MENU_TOGGLE_GAMEPAD_COMBO INPUT_TOGGLE_START_SELECT
 #elif defined(_XBOX1) || defined(__PS3__) || defined(_XBOX360) || defined(DINGUX)
@@ -880,6 +921,10 @@ static const float message_bgcolor_opacity = 1.0f;
 /* Record post-shaded GPU output instead of raw game footage if available. */
 #define DEFAULT_GPU_RECORD false
 
+/* Publish core frames to other local processes
+ * through a memory mapped file. */
+#define DEFAULT_VIDEO_FRAME_EXPORT false
+
 /* OSD-messages. */
 #define DEFAULT_FONT_ENABLE true
 
@@ -1027,6 +1072,11 @@ static const bool audio_enable_menu_bgm    = false;
  * is allowed to adjust input rate. */
 #define DEFAULT_RATE_CONTROL_DELTA  0.005
 
+/* Adds an integral term to rate control, which learns the
+ * clock drift between core and audio device, so that the
+ * audio buffer can be kept at a lower fill level. */
+#define DEFAULT_RATE_CONTROL_ADAPTIVE false
+
 /* Maximum timing skew. Defines how much adjust_system_rates
  * is allowed to adjust input rate. */
 #define DEFAULT_MAX_TIMING_SKEW  0.05
@@ -1096,6 +1146,11 @@ static const bool audio_enable_menu_bgm    = false;
 /* How many frames to rewind at a time. */
 #define DEFAULT_REWIND_GRANULARITY 1
 #endif
+
+/* Tiered rewind: seconds between the full-state checkpoints
+ * kept of older history, so that rewind reaches back further
+ * than the buffer would hold at full granularity. 0 disables. */
+#define DEFAULT_REWIND_CHECKPOINT_INTERVAL 0
 /* Pause gameplay when gameplay loses focus. */
 #if defined(EMSCRIPTEN) || defined(WEBOS)
 #define DEFAULT_PAUSE_NONACTIVE false
@@ -1134,9 +1189,17 @@ static const bool netplay_client_swap_input = true;
 
 static const bool netplay_nat_traversal = false;
 
+/* Also send netplay input over UDP, so that it doesn't
+ * wait on TCP retransmissions. Used only if both sides
+ * allow it; TCP still carries everything. */
+static const bool netplay_udp_input = true;
+
 static const unsigned netplay_delay_frames = 16;
 
-static const int netplay_check_frames = 600;
+/* Compare the host's and clients' state CRCs every second
+ * or so. A check costs one (hardware accelerated) CRC32
+ * of the savestate. */
+static const int netplay_check_frames = 60;
 
 static const bool netplay_use_mitm_server = false;
 
@@ -1167,6 +1230,17 @@ static const bool savestate_auto_index = false;
  *   savestates will be deleted in this case) */
 #define DEFAULT_SAVESTATE_MAX_KEEP 0
 
+/* Number of recently saved or loaded states kept
+ * in RAM, so that loading them again needs no disk
+ * access or decompression. Writes to disk are done
+ * in the background either way. With 0, a state is
+ * only kept until it has been written out. */
+#if defined(RARCH_CONSOLE) || defined(RARCH_MOBILE)
+#define DEFAULT_SAVESTATE_CACHE_SLOTS 1
+#else
+#define DEFAULT_SAVESTATE_CACHE_SLOTS 4
+#endif
+
 /* Automatically saves a savestate at the end of RetroArch's lifetime.
  * The path is $SRAM_PATH.auto.
  * RetroArch will automatically load any savestate with this path on
@@ -1195,6 +1269,26 @@ static const bool savestate_thumbnail_enable = false;
 /* Maximum fast forward ratio. */
 #define DEFAULT_FASTFORWARD_RATIO 0.0
 
+/* Only present some of the frames while fast-forwarding:
+ * every Nth frame, or with an interval of 0 at most one
+ * per display refresh. */
+#define DEFAULT_FASTFORWARD_FRAMESKIP false
+#define DEFAULT_FASTFORWARD_FRAMESKIP_INTERVAL 0
+
+/* Priority given to the main, video, audio and task
+ * threads. See enum thread_priority_profile. */
+#define DEFAULT_THREAD_PRIORITY_PROFILE THREAD_PRIORITY_PROFILE_DEFAULT
+
+/* On CPUs with cores of different speed, keep the main,
+ * video and audio threads on the fast ones and task
+ * threads on the others. */
+#define DEFAULT_THREAD_AFFINITY_FAST_CORES false
+
+/* Pre-fault and lock the rewind and runahead state
+ * buffers in memory, so that they never page fault
+ * or get swapped out. */
+#define DEFAULT_STATE_BUFFERS_LOCKED false
+
 /* Enable runloop for variable refresh rate screens. Force x1 speed while handling fast forward too. */
 #define DEFAULT_VRR_RUNLOOP_ENABLE false
 
@@ -1207,6 +1301,11 @@ static const bool savestate_thumbnail_enable = false;
 /* Hide warning messages when using the Run Ahead feature. */
 #define DEFAULT_RUN_AHEAD_HIDE_WARNINGS false
 
+/* Measure the lag frames of the running content on input
+ * changes, then set Run Ahead to match and store the result
+ * in the game override. */
+#define DEFAULT_RUN_AHEAD_AUTO_DETECT false
+
 /* Enable stdin/network command interface. */
 static const bool network_cmd_enable = false;
 static const uint16_t network_cmd_port = 55355;
@@ -1231,6 +1330,10 @@ static const uint16_t network_remote_base_port = 55400;
  * a new one) */
 #define DEFAULT_CORE_UPDATER_AUTO_BACKUP_HISTORY_SIZE 1
 
+/* Number of cores downloaded at once when
+ * updating all installed cores */
+#define DEFAULT_CORE_UPDATER_DOWNLOAD_MAX 4
+
 #if defined(ANDROID) || defined(__APPLE__)
 #define DEFAULT_NETWORK_ON_DEMAND_THUMBNAILS true
 #else
@@ -1282,6 +1385,12 @@ static const int default_content_favorites_size = 200;
 
 #define DEFAULT_PLAYLIST_FUZZY_ARCHIVE_MATCH false
 
+/* Reads the content and core of the hovered playlist
+ * entry ahead of time, once the selection has stayed
+ * on it for PLAYLIST_PREFETCH_DELAY ms */
+#define DEFAULT_PLAYLIST_PREFETCH false
+#define PLAYLIST_PREFETCH_DELAY 500
+
 #define DEFAULT_PLAYLIST_PORTABLE_PATHS false
 
 /* Show Menu start-up screen on boot. */
@@ -1378,6 +1487,19 @@ static const unsigned menu_left_thumbnails_default = 0;
 
 static const unsigned gfx_thumbnail_upscale_threshold = 0;
 
+/* GPU memory in MB that thumbnail textures are
+ * kept in after scrolling off screen (0 = disabled) */
+static const unsigned gfx_thumbnail_cache_size = 32;
+
+/* Generate a pre-decoded thumbnail pack per thumbnail
+ * directory when downloading playlist thumbnails, and
+ * load thumbnails from packs when available */
+static const bool gfx_thumbnail_pack_enable = false;
+
+/* Maximum number of thumbnails downloaded at once
+ * when downloading the thumbnails of a playlist */
+static const unsigned gfx_thumbnail_download_max = 4;
+
 #ifdef HAVE_MENU
 #if defined(RS90)
 /* The RS-90 has a hardware clock that is neither
@@ -72,6 +72,17 @@ enum crt_switch_type
    CRT_SWITCH_INI
 };
 
+enum thread_priority_profile
+{
+   /* Leave priorities to the OS */
+   THREAD_PRIORITY_PROFILE_DEFAULT = 0,
+   /* Raise emulation, video and audio, lower task workers */
+   THREAD_PRIORITY_PROFILE_EMULATION,
+   /* As above, with realtime scheduling for audio */
+   THREAD_PRIORITY_PROFILE_REALTIME_AUDIO,
+   THREAD_PRIORITY_PROFILE_LAST
+};
+
 enum override_type
 {
    OVERRIDE_NONE = 0,
@@ -163,6 +174,7 @@ typedef struct settings
       unsigned input_menu_toggle_gamepad_combo;
       unsigned input_keyboard_gamepad_mapping_type;
       unsigned input_poll_type_behavior;
+      unsigned thread_priority_profile;
       unsigned input_dingux_rumble_gain;
       unsigned input_auto_game_focus;
 
@@ -177,9 +189,12 @@ typedef struct settings
       unsigned frontend_log_level;
       unsigned libretro_log_level;
       unsigned rewind_granularity;
+      unsigned rewind_checkpoint_interval;
+      unsigned fastforward_frameskip_interval;
       unsigned rewind_buffer_size_step;
       unsigned autosave_interval;
       unsigned savestate_max_keep;
+      unsigned savestate_cache_slots;
       unsigned network_cmd_port;
       unsigned network_remote_base_port;
       unsigned keymapper_port;
@@ -218,6 +233,7 @@ typedef struct settings
       unsigned video_overscan_correction_bottom;
 #endif
       unsigned video_shader_delay;
+      unsigned video_gpu_memory_budget;
 #ifdef HAVE_SCREENSHOTS
       unsigned notification_show_screenshot_duration;
       unsigned notification_show_screenshot_flash;
@@ -231,6 +247,8 @@ typedef struct settings
       unsigned gfx_thumbnails;
       unsigned menu_left_thumbnails;
       unsigned gfx_thumbnail_upscale_threshold;
+      unsigned gfx_thumbnail_cache_size;
+      unsigned gfx_thumbnail_download_max;
       unsigned menu_rgui_thumbnail_downscaler;
       unsigned menu_rgui_thumbnail_delay;
       unsigned menu_rgui_color_theme;
@@ -286,6 +304,7 @@ typedef struct settings
       unsigned window_auto_height_max;
 
       unsigned video_record_threads;
+      unsigned instant_replay_length;
 
       unsigned libnx_overclock;
       unsigned ai_service_mode;
@@ -293,6 +312,7 @@ typedef struct settings
       unsigned ai_service_source_lang;
 
       unsigned core_updater_auto_backup_history_size;
+      unsigned core_updater_download_max;
       unsigned video_black_frame_insertion;
       unsigned quit_on_close_content;
 
@@ -492,6 +512,8 @@ typedef struct settings
       bool video_vsync;
       bool video_adaptive_vsync;
       bool video_hard_sync;
+      bool video_frame_delay_auto;
+      bool video_latency_test;
       bool video_vfilter;
       bool video_smooth;
       bool video_ctx_scaling;
@@ -510,6 +532,8 @@ typedef struct settings
       bool video_disable_composition;
       bool video_post_filter_record;
       bool video_gpu_record;
+      bool streaming_record_copy;
+      bool video_frame_export;
       bool video_gpu_screenshot;
       bool video_allow_rotate;
       bool video_shared_context;
@@ -537,6 +561,7 @@ typedef struct settings
       bool audio_enable_menu_bgm;
       bool audio_sync;
       bool audio_rate_control;
+      bool audio_rate_control_adaptive;
       bool audio_wasapi_exclusive_mode;
       bool audio_wasapi_float_format;
       bool audio_fastforward_mute;
@@ -589,6 +614,7 @@ typedef struct settings
       bool menu_pause_libretro;
       bool menu_savestate_resume;
       bool menu_insert_disk_resume;
+      bool menu_defer_init;
       bool menu_timedate_enable;
       bool menu_battery_level_enable;
       bool menu_core_enable;
@@ -601,6 +627,7 @@ typedef struct settings
       bool menu_navigation_browser_filter_supported_extensions_enable;
       bool menu_show_advanced_settings;
       bool menu_throttle_framerate;
+      bool menu_skip_idle_frames;
       bool menu_linear_filter;
       bool menu_horizontal_animation;
       bool menu_scroll_fast;
@@ -621,6 +648,7 @@ typedef struct settings
       bool menu_show_rewind;
       bool menu_show_overlays;
       bool menu_show_legacy_thumbnail_updater;
+      bool gfx_thumbnail_pack_enable;
 #ifdef HAVE_VIDEO_LAYOUT
       bool menu_show_video_layout;
 #endif
@@ -713,6 +741,7 @@ typedef struct settings
       bool netplay_require_slaves;
       bool netplay_stateless_mode;
       bool netplay_nat_traversal;
+      bool netplay_udp_input;
       bool netplay_use_mitm_server;
       bool netplay_request_devices[MAX_USERS];
 
@@ -741,6 +770,7 @@ typedef struct settings
       bool cheevos_start_active;
       bool cheevos_unlock_sound_enable;
       bool cheevos_challenge_indicators;
+      bool cheevos_threaded_eval;
 
       /* Camera */
       bool camera_allow;
@@ -775,11 +805,15 @@ typedef struct settings
       bool playlist_entry_rename;
       bool rewind_enable;
       bool vrr_runloop_enable;
+      bool thread_affinity_fast_cores;
+      bool state_buffers_locked;
+      bool fastforward_frameskip;
       bool apply_cheats_after_toggle;
       bool apply_cheats_after_load;
       bool run_ahead_enabled;
       bool run_ahead_secondary_instance;
       bool run_ahead_hide_warnings;
+      bool run_ahead_auto_detect;
       bool pause_nonactive;
       bool block_sram_overwrite;
       bool savestate_auto_index;
@@ -819,6 +853,7 @@ typedef struct settings
       bool savefiles_in_content_dir;
       bool savestates_in_content_dir;
       bool screenshots_in_content_dir;
+      bool screenshot_fast_compression;
       bool systemfiles_in_content_dir;
       bool ssh_enable;
       bool samba_enable;
@@ -839,6 +874,7 @@ typedef struct settings
       bool playlist_show_sublabels;
       bool playlist_show_entry_idx;
       bool playlist_fuzzy_archive_match;
+      bool playlist_prefetch;
       bool playlist_portable_paths;
 
       bool quit_press_twice;
@@ -1001,9 +1037,13 @@ bool config_save_autoconf_profile(const char *device_name, unsigned user);
  * config_save_file:
  * @path            : Path that shall be written to.
  *
- * Writes a config file to disk.
+ * Writes a config file to disk, if any setting differs
+ * from what is stored there. The write itself happens on
+ * a task shortly afterwards (see task_push_config_save()),
+ * so task_config_save_flush() must be called before exiting.
  *
- * Returns: true (1) on success, otherwise returns false (0).
+ * Returns: false (0) if the config cannot be saved, otherwise
+ * true (1). A failed write is reported later on by the task.
  **/
 bool config_save_file(const char *path);
 
@@ -1017,6 +1057,19 @@ bool config_save_file(const char *path);
  **/
 bool config_save_overrides(enum override_type type, void *data);
 
+/**
+ * config_get_game_override_path:
+ * @data            : system info of the running core.
+ * @s               : filled with the path.
+ * @len             : size of @s.
+ *
+ * Gets the path of the game override of the running content,
+ * whether or not the file exists.
+ *
+ * Returns: false if no core or content is loaded.
+ **/
+bool config_get_game_override_path(void *data, char *s, size_t len);
+
 /* Replaces currently loaded configuration file with
  * another one. Will load a dummy core to flush state
  * properly. */
@@ -60,12 +60,40 @@ bool content_serialize_state(void* buffer, size_t buffer_size);
 /* Deserializes the current state. */
 bool content_deserialize_state(const void* serialized_data, size_t serialized_size);
 
+/* Limits of the thumbnail embedded in save state files */
+#define CONTENT_STATE_THUMBNAIL_MAX_WIDTH  160
+#define CONTENT_STATE_THUMBNAIL_MAX_HEIGHT 120
+
+typedef struct content_state_info
+{
+   /* RGB565, or NULL if the state has no thumbnail */
+   uint16_t *thumbnail;
+   /* Seconds since the epoch */
+   int64_t timestamp;
+   uint32_t content_crc;
+   unsigned thumbnail_width;
+   unsigned thumbnail_height;
+   char core_name[64];
+} content_state_info_t;
+
+/* Reads the information block at the start of the
+ * save state file at 'path', without decoding the
+ * state itself. The thumbnail is only read if
+ * 'load_thumbnail' is true, and must be free()'d.
+ * Returns false if the state has no information block */
+bool content_read_state_info(const char *path,
+      content_state_info_t *info, bool load_thumbnail);
+
 /* Waits for any in-progress save state tasks to finish */
 void content_wait_for_save_state_task(void);
 
 /* Copy a save state. */
 bool content_rename_state(const char *origin, const char *dest);
 
+/* Drops the copy of the state at 'path' kept in RAM,
+ * for when the file is deleted */
+void content_forget_state(const char *path);
+
 /* Undoes the last load state operation that was done */
 bool content_undo_load_state(void);
 
@@ -0,0 +1,483 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Content hash cache
+ * > Hashes of content files (whole file CRC, disc track
+ *   CRC, serial, RetroAchievements hash) are kept per path,
+ *   together with the size and modification time the file
+ *   had when they were computed. Scanning, content loading
+ *   and achievements all look here before reading a file
+ * > The cache file (FILE_PATH_CONTENT_HASH_CACHE in the
+ *   cache directory) is a log: each store appends the full
+ *   entry for a path, and the last record for a path wins.
+ *   It is rewritten without the superseded records once
+ *   these outnumber the live ones
+ * > Layout, native endian:
+ *   - header: magic, version
+ *   - records: u32 payload size, u32 payload crc32, payload
+ *   - payload: u64 size, i64 mtime, u32 flags, u32 crc,
+ *     u32 track crc, then path, serial and rcheevos hash,
+ *     each stored as a u32 length followed by the bytes */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <array/rhmap.h>
+#include <array/rbuf.h>
+#include <compat/strl.h>
+#include <encodings/crc32.h>
+#include <file/file_path.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+#include <retro_miscellaneous.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#if defined(_WIN32) && !defined(_XBOX)
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <encodings/utf.h>
+#define HAVE_CONTENT_HASH_STAT
+#elif defined(__linux__) || defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__) || defined(__HAIKU__)
+#include <sys/types.h>
+#include <sys/stat.h>
+#define HAVE_CONTENT_HASH_STAT
+#endif
+
+#include "content_hash_cache.h"
+#include "file_path_special.h"
+#include "verbosity.h"
+
+#define CONTENT_HASH_CACHE_MAGIC   0x43484352 /* "RCHC" */
+#define CONTENT_HASH_CACHE_VERSION 1
+
+/* Superseded records tolerated before the
+ * cache file is rewritten */
+#define CONTENT_HASH_CACHE_MIN_STALE 256
+
+typedef struct
+{
+   uint64_t size;
+   int64_t mtime;
+   content_hash_entry_t entry;
+} content_hash_record_t;
+
+typedef struct
+{
+   content_hash_record_t **map;
+#ifdef HAVE_THREADS
+   slock_t *lock;
+#endif
+   size_t records;
+   char path[PATH_MAX_LENGTH];
+   bool enabled;
+   bool loaded;
+} content_hash_cache_t;
+
+static content_hash_cache_t content_hash_st;
+
+#ifdef HAVE_THREADS
+#define CONTENT_HASH_LOCK()   slock_lock(content_hash_st.lock)
+#define CONTENT_HASH_UNLOCK() slock_unlock(content_hash_st.lock)
+#else
+#define CONTENT_HASH_LOCK()
+#define CONTENT_HASH_UNLOCK()
+#endif
+
+static bool content_hash_cache_stat(const char *path,
+      uint64_t *size, int64_t *mtime)
+{
+#if defined(HAVE_CONTENT_HASH_STAT) && defined(_WIN32)
+   struct _stat64 buf;
+   int ret;
+   wchar_t *path_w = utf8_to_utf16_string_alloc(path);
+
+   if (!path_w)
+      return false;
+   ret = _wstat64(path_w, &buf);
+   free(path_w);
+
+   if (ret != 0 || !(buf.st_mode & _S_IFREG))
+      return false;
+
+   *size  = (uint64_t)buf.st_size;
+   *mtime = (int64_t)buf.st_mtime;
+   return true;
+#elif defined(HAVE_CONTENT_HASH_STAT)
+   struct stat buf;
+
+   if (stat(path, &buf) != 0 || !S_ISREG(buf.st_mode))
+      return false;
+
+   *size  = (uint64_t)buf.st_size;
+   *mtime = (int64_t)buf.st_mtime;
+   return true;
+#else
+   return false;
+#endif
+}
+
+static void content_hash_cache_put_u32(uint8_t **buf, uint32_t val)
+{
+   size_t len = RBUF_LEN(*buf);
+   RBUF_RESIZE(*buf, len + sizeof(val));
+   memcpy(*buf + len, &val, sizeof(val));
+}
+
+static void content_hash_cache_put_data(uint8_t **buf,
+      const void *data, size_t size)
+{
+   size_t len = RBUF_LEN(*buf);
+   RBUF_RESIZE(*buf, len + size);
+   memcpy(*buf + len, data, size);
+}
+
+static void content_hash_cache_put_string(uint8_t **buf, const char *s)
+{
+   uint32_t len = (uint32_t)strlen(s);
+   content_hash_cache_put_u32(buf, len);
+   content_hash_cache_put_data(buf, s, len);
+}
+
+/* Appends the record for 'path' to 'buf' */
+static void content_hash_cache_serialize(uint8_t **buf,
+      const char *path, const content_hash_record_t *record)
+{
+   uint32_t payload_size;
+   size_t start = RBUF_LEN(*buf);
+
+   /* Size and CRC are filled in below */
+   content_hash_cache_put_u32(buf, 0);
+   content_hash_cache_put_u32(buf, 0);
+
+   content_hash_cache_put_data(buf, &record->size,  sizeof(record->size));
+   content_hash_cache_put_data(buf, &record->mtime, sizeof(record->mtime));
+   content_hash_cache_put_u32(buf, record->entry.flags);
+   content_hash_cache_put_u32(buf, record->entry.crc);
+   content_hash_cache_put_u32(buf, record->entry.track_crc);
+   content_hash_cache_put_string(buf, path);
+   content_hash_cache_put_string(buf, record->entry.serial);
+   content_hash_cache_put_string(buf, record->entry.rcheevos);
+
+   payload_size = (uint32_t)(RBUF_LEN(*buf) - start - 8);
+   memcpy(*buf + start, &payload_size, sizeof(payload_size));
+   payload_size = encoding_crc32(0, *buf + start + 8, payload_size);
+   memcpy(*buf + start + 4, &payload_size, sizeof(payload_size));
+}
+
+static bool content_hash_cache_get_data(const uint8_t **s,
+      const uint8_t *end, void *data, size_t size)
+{
+   if ((size_t)(end - *s) < size)
+      return false;
+   memcpy(data, *s, size);
+   *s += size;
+   return true;
+}
+
+static bool content_hash_cache_get_u32(const uint8_t **s,
+      const uint8_t *end, uint32_t *val)
+{
+   return content_hash_cache_get_data(s, end, val, sizeof(*val));
+}
+
+/* Reads a string of at most 'len - 1' bytes */
+static bool content_hash_cache_get_string(const uint8_t **s,
+      const uint8_t *end, char *str, size_t len)
+{
+   uint32_t str_len;
+
+   if (     !content_hash_cache_get_u32(s, end, &str_len)
+         || str_len >= len
+         || (size_t)(end - *s) < str_len)
+      return false;
+
+   memcpy(str, *s, str_len);
+   str[str_len] = '\0';
+   *s          += str_len;
+   return true;
+}
+
+static void content_hash_cache_set(const char *path,
+      const content_hash_record_t *record)
+{
+   content_hash_record_t *cur = RHMAP_GET_STR(content_hash_st.map, path);
+
+   if (!cur)
+   {
+      if (!(cur = (content_hash_record_t*)malloc(sizeof(*cur))))
+         return;
+      RHMAP_SET_STR(content_hash_st.map, path, cur);
+   }
+
+   *cur = *record;
+}
+
+static bool content_hash_cache_write_all(void)
+{
+   size_t i;
+   bool ret     = false;
+   uint8_t *buf = NULL;
+
+   content_hash_cache_put_u32(&buf, CONTENT_HASH_CACHE_MAGIC);
+   content_hash_cache_put_u32(&buf, CONTENT_HASH_CACHE_VERSION);
+
+   for (i = 0; i < RHMAP_CAP(content_hash_st.map); i++)
+   {
+      if (RHMAP_KEY(content_hash_st.map, i))
+         content_hash_cache_serialize(&buf,
+               RHMAP_KEY_STR(content_hash_st.map, i),
+               content_hash_st.map[i]);
+   }
+
+   if (buf)
+      ret = filestream_write_file(content_hash_st.path,
+            buf, (int64_t)RBUF_LEN(buf));
+
+   content_hash_st.records = RHMAP_LEN(content_hash_st.map);
+   RBUF_FREE(buf);
+   return ret;
+}
+
+/* Replays the cache file into the map */
+static void content_hash_cache_load(void)
+{
+   const uint8_t *s, *end;
+   uint32_t magic, version;
+   void *data      = NULL;
+   int64_t size    = 0;
+
+   content_hash_st.loaded = true;
+
+   if (     !path_is_valid(content_hash_st.path)
+         || !filestream_read_file(content_hash_st.path, &data, &size))
+      return;
+
+   s   = (const uint8_t*)data;
+   end = s + size;
+
+   if (     content_hash_cache_get_u32(&s, end, &magic)
+         && content_hash_cache_get_u32(&s, end, &version)
+         && magic   == CONTENT_HASH_CACHE_MAGIC
+         && version == CONTENT_HASH_CACHE_VERSION)
+   {
+      uint32_t payload_size, payload_crc;
+
+      while (     content_hash_cache_get_u32(&s, end, &payload_size)
+               && content_hash_cache_get_u32(&s, end, &payload_crc)
+               && (size_t)(end - s) >= payload_size)
+      {
+         char path[PATH_MAX_LENGTH];
+         content_hash_record_t record;
+         const uint8_t *payload_end = s + payload_size;
+
+         /* A record cut short by a crash ends the log */
+         if (encoding_crc32(0, s, payload_size) != payload_crc)
+            break;
+
+         memset(&record, 0, sizeof(record));
+
+         if (     content_hash_cache_get_data(&s, payload_end,
+                  &record.size, sizeof(record.size))
+               && content_hash_cache_get_data(&s, payload_end,
+                  &record.mtime, sizeof(record.mtime))
+               && content_hash_cache_get_u32(&s, payload_end,
+                  &record.entry.flags)
+               && content_hash_cache_get_u32(&s, payload_end,
+                  &record.entry.crc)
+               && content_hash_cache_get_u32(&s, payload_end,
+                  &record.entry.track_crc)
+               && content_hash_cache_get_string(&s, payload_end,
+                  path, sizeof(path))
+               && content_hash_cache_get_string(&s, payload_end,
+                  record.entry.serial, sizeof(record.entry.serial))
+               && content_hash_cache_get_string(&s, payload_end,
+                  record.entry.rcheevos, sizeof(record.entry.rcheevos))
+               && !string_is_empty(path))
+         {
+            content_hash_cache_set(path, &record);
+            content_hash_st.records++;
+         }
+
+         s = payload_end;
+      }
+   }
+
+   free(data);
+
+   if (content_hash_st.records > CONTENT_HASH_CACHE_MIN_STALE
+         + 2 * RHMAP_LEN(content_hash_st.map))
+   {
+      RARCH_LOG("[Content Hash]: Compacting \"%s\".\n",
+            content_hash_st.path);
+      content_hash_cache_write_all();
+   }
+}
+
+/* Appends the record for 'path' to the cache file */
+static void content_hash_cache_append(const char *path,
+      const content_hash_record_t *record)
+{
+   RFILE *file;
+   uint8_t *buf = NULL;
+
+   if (content_hash_st.records == 0 || !path_is_valid(content_hash_st.path))
+   {
+      content_hash_cache_write_all();
+      return;
+   }
+
+   content_hash_cache_serialize(&buf, path, record);
+
+   if ((file = filestream_open(content_hash_st.path,
+               RETRO_VFS_FILE_ACCESS_READ_WRITE
+               | RETRO_VFS_FILE_ACCESS_UPDATE_EXISTING,
+               RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+   {
+      if (     filestream_seek(file, 0, RETRO_VFS_SEEK_POSITION_END) == 0
+            && filestream_write(file, buf, (int64_t)RBUF_LEN(buf))
+               == (int64_t)RBUF_LEN(buf))
+         content_hash_st.records++;
+      filestream_close(file);
+   }
+
+   RBUF_FREE(buf);
+}
+
+void content_hash_cache_init(const char *dir)
+{
+   content_hash_cache_deinit();
+
+   if (string_is_empty(dir))
+      return;
+
+   fill_pathname_join(content_hash_st.path, dir,
+         FILE_PATH_CONTENT_HASH_CACHE, sizeof(content_hash_st.path));
+#ifdef HAVE_THREADS
+   if (!(content_hash_st.lock = slock_new()))
+      return;
+#endif
+   content_hash_st.enabled = true;
+}
+
+void content_hash_cache_deinit(void)
+{
+   size_t i;
+
+   for (i = 0; i < RHMAP_CAP(content_hash_st.map); i++)
+   {
+      if (RHMAP_KEY(content_hash_st.map, i))
+         free(content_hash_st.map[i]);
+   }
+   RHMAP_FREE(content_hash_st.map);
+
+#ifdef HAVE_THREADS
+   if (content_hash_st.lock)
+      slock_free(content_hash_st.lock);
+#endif
+
+   memset(&content_hash_st, 0, sizeof(content_hash_st));
+}
+
+bool content_hash_cache_get(const char *path, content_hash_entry_t *entry)
+{
+   uint64_t size;
+   int64_t mtime;
+   content_hash_record_t *record;
+   bool ret = false;
+
+   if (     !content_hash_st.enabled
+         || string_is_empty(path)
+         || !content_hash_cache_stat(path, &size, &mtime))
+      return false;
+
+   CONTENT_HASH_LOCK();
+
+   if (!content_hash_st.loaded)
+      content_hash_cache_load();
+
+   if (     (record = RHMAP_GET_STR(content_hash_st.map, path))
+         && record->size  == size
+         && record->mtime == mtime
+         && record->entry.flags)
+   {
+      *entry = record->entry;
+      ret    = true;
+   }
+
+   CONTENT_HASH_UNLOCK();
+
+   return ret;
+}
+
+void content_hash_cache_put(const char *path,
+      const content_hash_entry_t *entry)
+{
+   content_hash_record_t record;
+   content_hash_record_t *cur;
+   uint32_t flags = entry->flags;
+
+   /* Serials that don't fit are not cached */
+   if (     (flags & CONTENT_HASH_SERIAL)
+         && strlen(entry->serial) >= sizeof(record.entry.serial))
+      flags &= ~CONTENT_HASH_SERIAL;
+
+   if (     !content_hash_st.enabled
+         || string_is_empty(path)
+         || !flags
+         || !content_hash_cache_stat(path, &record.size, &record.mtime))
+      return;
+
+   /* A file modified within the same second as it was
+    * hashed could change again without its mtime telling */
+   if (record.mtime + 2 > (int64_t)time(NULL))
+      return;
+
+   CONTENT_HASH_LOCK();
+
+   if (!content_hash_st.loaded)
+      content_hash_cache_load();
+
+   /* Keep what is cached for the file as it is now */
+   if (     (cur = RHMAP_GET_STR(content_hash_st.map, path))
+         && cur->size  == record.size
+         && cur->mtime == record.mtime)
+      record.entry = cur->entry;
+   else
+      memset(&record.entry, 0, sizeof(record.entry));
+
+   record.entry.flags |= flags;
+   if (flags & CONTENT_HASH_CRC)
+      record.entry.crc = entry->crc;
+   if (flags & CONTENT_HASH_TRACK_CRC)
+      record.entry.track_crc = entry->track_crc;
+   if (flags & CONTENT_HASH_SERIAL)
+      strlcpy(record.entry.serial, entry->serial,
+            sizeof(record.entry.serial));
+   if (flags & CONTENT_HASH_RCHEEVOS)
+      strlcpy(record.entry.rcheevos, entry->rcheevos,
+            sizeof(record.entry.rcheevos));
+
+   if (!cur || memcmp(&cur->entry, &record.entry, sizeof(record.entry))
+         || cur->size != record.size || cur->mtime != record.mtime)
+   {
+      content_hash_cache_set(path, &record);
+      content_hash_cache_append(path, &record);
+   }
+
+   CONTENT_HASH_UNLOCK();
+}
@@ -0,0 +1,86 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CONTENT_HASH_CACHE_H
+#define __CONTENT_HASH_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* Which values of a content_hash_entry_t are set */
+enum content_hash_flags
+{
+   /* CRC32 of the whole file */
+   CONTENT_HASH_CRC       = (1 << 0),
+   /* CRC32 of the primary data track of a disc image */
+   CONTENT_HASH_TRACK_CRC = (1 << 1),
+   /* Serial, as read by the database scanner */
+   CONTENT_HASH_SERIAL    = (1 << 2),
+   /* RetroAchievements hash the game was identified by */
+   CONTENT_HASH_RCHEEVOS  = (1 << 3)
+};
+
+typedef struct content_hash_entry
+{
+   uint32_t flags;
+   uint32_t crc;
+   uint32_t track_crc;
+   char serial[64];
+   char rcheevos[33];
+} content_hash_entry_t;
+
+/**
+ * content_hash_cache_init:
+ * @dir                : directory the cache file is kept in.
+ *
+ * Sets up the cache. Nothing is read until the first
+ * lookup, and the cache stays disabled if @dir is empty.
+ **/
+void content_hash_cache_init(const char *dir);
+
+void content_hash_cache_deinit(void);
+
+/**
+ * content_hash_cache_get:
+ * @path               : path of the content file.
+ * @entry              : filled with the cached values.
+ *
+ * Entries only match while the size and modification
+ * time of @path are what they were when stored.
+ * Safe to call from any thread.
+ *
+ * Returns: true if any value is cached for @path.
+ **/
+bool content_hash_cache_get(const char *path, content_hash_entry_t *entry);
+
+/**
+ * content_hash_cache_put:
+ * @path               : path of the content file.
+ * @entry              : values to store, as given by entry->flags.
+ *
+ * Merges the values into what is already cached for @path
+ * and appends them to the cache file.
+ * Safe to call from any thread.
+ **/
+void content_hash_cache_put(const char *path,
+      const content_hash_entry_t *entry);
+
+RETRO_END_DECLS
+
+#endif
@@ -15,16 +15,25 @@
  *  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stddef.h>
+
 #include <retro_assert.h>
+#include <retro_endianness.h>
+#include <retro_miscellaneous.h>
 #include <compat/strl.h>
 #include <string/stdstring.h>
+#include <array/rbuf.h>
+#include <array/rhmap.h>
 #include <file/config_file.h>
 #include <file/file_path.h>
 #include <streams/file_stream.h>
-#include <streams/interface_stream.h>
-#include <formats/rjson.h>
 #include <lists/dir_list.h>
 #include <file/archive_file.h>
+#include <features/features_cpu.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/tpool.h>
+#endif
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -50,390 +59,98 @@
 
 #define CORE_INFO_CACHE_DEFAULT_CAPACITY 8
 
-/* TODO/FIXME: Apparently rzip compression is an issue on UWP */
-#if defined(HAVE_ZLIB) && !(defined(__WINRT__) || defined(WINAPI_FAMILY) && WINAPI_FAMILY == WINAPI_FAMILY_PHONE_APP)
-#define CORE_INFO_CACHE_COMPRESS
-#endif
+/* Cache file layout (all values little endian):
+ * - header: "RCIC", version, core count, firmware
+ *   count, extension count, string table size
+ * - core records
+ * - firmware records
+ * - extension table: the sorted, unique supported
+ *   extensions of all cached cores, used as the
+ *   core info list's 'all_ext' when the cache is
+ *   up to date
+ * - string table: NUL-terminated strings, each
+ *   stored once and referenced by byte offset
+ * All records are arrays of uint32_t */
+#define CORE_INFO_CACHE_MAGIC         "RCIC"
+#define CORE_INFO_CACHE_VERSION       2
+#define CORE_INFO_CACHE_HEADER_SIZE   6
+/* String offsets, core file id hash, first
+ * firmware record, firmware count, flags */
+#define CORE_INFO_CACHE_CORE_SIZE     (CORE_INFO_CACHE_STR_COUNT + 4)
+/* Path, desc, flags */
+#define CORE_INFO_CACHE_FIRMWARE_SIZE 3
+#define CORE_INFO_CACHE_NO_STRING     0xFFFFFFFF
+#define CORE_INFO_CACHE_NO_LIST       ((size_t)-1)
+
+enum core_info_cache_flags
+{
+   CORE_INFO_CACHE_FLAG_HAS_INFO                      = (1 << 0),
+   CORE_INFO_CACHE_FLAG_SUPPORTS_NO_GAME              = (1 << 1),
+   CORE_INFO_CACHE_FLAG_DATABASE_MATCH_ARCHIVE_MEMBER = (1 << 2),
+   CORE_INFO_CACHE_FLAG_IS_EXPERIMENTAL               = (1 << 3),
+   CORE_INFO_CACHE_FLAG_SUPPORTS_WARM_SWITCH          = (1 << 4)
+};
+
+#define CORE_INFO_CACHE_FIRMWARE_OPTIONAL (1 << 0)
 
 typedef struct
 {
    core_info_t *items;
+   char *all_ext;
    size_t length;
    size_t capacity;
    bool refresh;
 } core_info_cache_list_t;
 
+/* Cached string of core_info_t, and the
+ * string list that is split from it */
 typedef struct
 {
-   core_info_t *core_info;
-   core_info_cache_list_t *core_info_cache_list;
-   char **current_string_val;
-   struct string_list **current_string_list_val;
-   uint32_t *current_entry_uint_val;
-   bool *current_entry_bool_val;
-   unsigned array_depth;
-   unsigned object_depth;
-   bool to_core_file_id;
-   bool to_firmware;
-} CCJSONContext;
-
-/* Forward declarations */
-static void core_info_free(core_info_t* info);
-static uint32_t core_info_hash_string(const char *str);
-static core_info_cache_list_t *core_info_cache_list_new(void);
-static void core_info_cache_add(core_info_cache_list_t *list, core_info_t *info,
-      bool transfer);
-
-/* JSON Handlers START */
-
-static bool CCJSONObjectMemberHandler(void *context, const char *pValue, size_t length)
-{
-   CCJSONContext *pCtx = (CCJSONContext *)context;
-
-   if ((pCtx->object_depth == 2) && (pCtx->array_depth == 1) && length)
-   {
-      pCtx->current_string_val      = NULL;
-      pCtx->current_string_list_val = NULL;
-      pCtx->current_entry_uint_val  = NULL;
-      pCtx->current_entry_bool_val  = NULL;
-      pCtx->to_core_file_id         = false;
-      pCtx->to_firmware             = false;
-
-      switch (pValue[0])
-      {
-         case 'a':
-            if (string_is_equal(pValue,      "authors"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->authors;
-               pCtx->current_string_list_val = &pCtx->core_info->authors_list;
-            }
-            break;
-         case 'c':
-            if (string_is_equal(pValue,      "categories"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->categories;
-               pCtx->current_string_list_val = &pCtx->core_info->categories_list;
-            }
-            else if (string_is_equal(pValue, "core_name"))
-               pCtx->current_string_val      = &pCtx->core_info->core_name;
-            else if (string_is_equal(pValue, "core_file_id"))
-               pCtx->to_core_file_id         = true;
-            break;
-         case 'd':
-            if (string_is_equal(pValue,      "display_name"))
-               pCtx->current_string_val      = &pCtx->core_info->display_name;
-            else if (string_is_equal(pValue, "display_version"))
-               pCtx->current_string_val      = &pCtx->core_info->display_version;
-            else if (string_is_equal(pValue, "databases"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->databases;
-               pCtx->current_string_list_val = &pCtx->core_info->databases_list;
-            }
-            else if (string_is_equal(pValue, "description"))
-               pCtx->current_string_val      = &pCtx->core_info->description;
-            else if (string_is_equal(pValue, "database_match_archive_member"))
-               pCtx->current_entry_bool_val  = &pCtx->core_info->database_match_archive_member;
-            break;
-         case 'f':
-            if (string_is_equal(pValue,      "firmware"))
-               pCtx->to_firmware             = true;
-            break;
-         case 'h':
-            if (string_is_equal(pValue,      "has_info"))
-               pCtx->current_entry_bool_val  = &pCtx->core_info->has_info;
-            break;
-         case 'l':
-            if (string_is_equal(pValue,      "licenses"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->licenses;
-               pCtx->current_string_list_val = &pCtx->core_info->licenses_list;
-            }
-            else if (string_is_equal(pValue, "is_experimental"))
-               pCtx->current_entry_bool_val  = &pCtx->core_info->is_experimental;
-            break;
-         case 'n':
-            if (string_is_equal(pValue,      "notes"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->notes;
-               pCtx->current_string_list_val = &pCtx->core_info->note_list;
-            }
-            break;
-         case 'p':
-            if (string_is_equal(pValue,      "path"))
-               pCtx->current_string_val      = &pCtx->core_info->path;
-            else if (string_is_equal(pValue, "permissions"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->permissions;
-               pCtx->current_string_list_val = &pCtx->core_info->permissions_list;
-            }
-            break;
-         case 'r':
-            if (string_is_equal(pValue,      "required_hw_api"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->required_hw_api;
-               pCtx->current_string_list_val = &pCtx->core_info->required_hw_api_list;
-            }
-            break;
-         case 's':
-            if (string_is_equal(pValue,      "system_manufacturer"))
-               pCtx->current_string_val      = &pCtx->core_info->system_manufacturer;
-            else if (string_is_equal(pValue, "systemname"))
-               pCtx->current_string_val      = &pCtx->core_info->systemname;
-            else if (string_is_equal(pValue, "system_id"))
-               pCtx->current_string_val      = &pCtx->core_info->system_id;
-            else if (string_is_equal(pValue, "supported_extensions"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->supported_extensions;
-               pCtx->current_string_list_val = &pCtx->core_info->supported_extensions_list;
-            }
-            else if (string_is_equal(pValue, "supports_no_game"))
-               pCtx->current_entry_bool_val  = &pCtx->core_info->supports_no_game;
-            break;
-      }
-   }
-   else if ((pCtx->object_depth == 3) && (pCtx->array_depth == 1) && length)
-   {
-      pCtx->current_string_val      = NULL;
-      pCtx->current_entry_uint_val  = NULL;
-
-      if (pCtx->to_core_file_id)
-      {
-         if (string_is_equal(pValue,         "str"))
-            pCtx->current_string_val         = &pCtx->core_info->core_file_id.str;
-         else if (string_is_equal(pValue,    "hash"))
-            pCtx->current_entry_uint_val     = &pCtx->core_info->core_file_id.hash;
-      }
-   }
-   else if ((pCtx->object_depth == 3) && (pCtx->array_depth == 2) && length)
-   {
-      pCtx->current_string_val      = NULL;
-      pCtx->current_entry_bool_val  = NULL;
-
-      if (pCtx->to_firmware && (pCtx->core_info->firmware_count > 0))
-      {
-         size_t firmware_idx = pCtx->core_info->firmware_count - 1;
-
-         if (string_is_equal(pValue,         "path"))
-            pCtx->current_string_val         = &pCtx->core_info->firmware[firmware_idx].path;
-         else if (string_is_equal(pValue,    "desc"))
-            pCtx->current_string_val         = &pCtx->core_info->firmware[firmware_idx].desc;
-         else if (string_is_equal(pValue,    "optional"))
-            pCtx->current_entry_bool_val     = &pCtx->core_info->firmware[firmware_idx].optional;
-      }
-   }
-
-   return true;
-}
-
-static bool CCJSONStringHandler(void *context, const char *pValue, size_t length)
-{
-   CCJSONContext *pCtx = (CCJSONContext*)context;
-
-   if (pCtx->current_string_val && length && !string_is_empty(pValue))
-   {
-      if (*pCtx->current_string_val)
-         free(*pCtx->current_string_val);
-      *pCtx->current_string_val = strdup(pValue);
-
-      if (pCtx->current_string_list_val)
-      {
-         if (*pCtx->current_string_list_val)
-            string_list_free(*pCtx->current_string_list_val);
-         *pCtx->current_string_list_val = string_split(*pCtx->current_string_val, "|");
-      }
-   }
-
-   pCtx->current_string_val      = NULL;
-   pCtx->current_string_list_val = NULL;
-
-   return true;
-}
-
-static bool CCJSONNumberHandler(void *context, const char *pValue, size_t length)
-{
-   CCJSONContext *pCtx = (CCJSONContext*)context;
-
-   if (pCtx->current_entry_uint_val)
-      *pCtx->current_entry_uint_val = string_to_unsigned(pValue);
-
-   pCtx->current_entry_uint_val = NULL;
-
-   return true;
-}
-
-static bool CCJSONBoolHandler(void *context, bool value)
-{
-   CCJSONContext *pCtx = (CCJSONContext *)context;
-
-   if (pCtx->current_entry_bool_val)
-      *pCtx->current_entry_bool_val = value;
-
-   pCtx->current_entry_bool_val = NULL;
-
-   return true;
-}
-
-static bool CCJSONStartObjectHandler(void *context)
-{
-   CCJSONContext *pCtx = (CCJSONContext*)context;
-
-   pCtx->object_depth++;
-
-   if ((pCtx->object_depth == 1) && (pCtx->array_depth == 0))
-   {
-      if (pCtx->core_info_cache_list)
-         return false;
-
-      pCtx->core_info_cache_list = core_info_cache_list_new();
-      if (!pCtx->core_info_cache_list)
-         return false;
-   }
-   else if ((pCtx->object_depth == 2) && (pCtx->array_depth == 1))
-   {
-      if (pCtx->core_info)
-      {
-         core_info_free(pCtx->core_info);
-         free(pCtx->core_info);
-         pCtx->core_info = NULL;
-      }
-
-      pCtx->core_info = (core_info_t*)calloc(1, sizeof(core_info_t));
-      if (!pCtx->core_info)
-         return false;
-   }
-   else if ((pCtx->object_depth == 3) && (pCtx->array_depth == 2))
-   {
-      if (pCtx->to_firmware)
-      {
-         size_t new_idx                     = pCtx->core_info->firmware_count;
-         core_info_firmware_t *firmware_tmp = (core_info_firmware_t*)
-               realloc(pCtx->core_info->firmware,
-                     (pCtx->core_info->firmware_count + 1) * sizeof(core_info_firmware_t));
-
-         if (!firmware_tmp)
-            return false;
-
-         firmware_tmp[new_idx].path     = NULL;
-         firmware_tmp[new_idx].desc     = NULL;
-         firmware_tmp[new_idx].missing  = false;
-         firmware_tmp[new_idx].optional = false;
-
-         pCtx->core_info->firmware      = firmware_tmp;
-         pCtx->core_info->firmware_count++;
-      }
-   }
-
-   return true;
-}
-
-static bool CCJSONEndObjectHandler(void *context)
-{
-   CCJSONContext *pCtx = (CCJSONContext*)context;
-
-   if ((pCtx->object_depth == 2) && (pCtx->array_depth == 1) && pCtx->core_info)
-   {
-      core_info_cache_add(pCtx->core_info_cache_list, pCtx->core_info, true);
-      free(pCtx->core_info);
-      pCtx->core_info = NULL;
-   }
-   else if ((pCtx->object_depth == 3) && (pCtx->array_depth == 1))
-      pCtx->to_core_file_id = false;
-
-   retro_assert(pCtx->object_depth > 0);
-   pCtx->object_depth--;
-
-   return true;
-}
+   size_t str;
+   size_t list;
+} core_info_cache_field_t;
+
+static const core_info_cache_field_t core_info_cache_fields[] = {
+   { offsetof(core_info_t, path),                 CORE_INFO_CACHE_NO_LIST },
+   { offsetof(core_info_t, display_name),         CORE_INFO_CACHE_NO_LIST },
+   { offsetof(core_info_t, display_version),      CORE_INFO_CACHE_NO_LIST },
+   { offsetof(core_info_t, core_name),            CORE_INFO_CACHE_NO_LIST },
+   { offsetof(core_info_t, system_manufacturer),  CORE_INFO_CACHE_NO_LIST },
+   { offsetof(core_info_t, systemname),           CORE_INFO_CACHE_NO_LIST },
+   { offsetof(core_info_t, system_id),            CORE_INFO_CACHE_NO_LIST },
+   { offsetof(core_info_t, supported_extensions), offsetof(core_info_t, supported_extensions_list) },
+   { offsetof(core_info_t, authors),              offsetof(core_info_t, authors_list) },
+   { offsetof(core_info_t, permissions),          offsetof(core_info_t, permissions_list) },
+   { offsetof(core_info_t, licenses),             offsetof(core_info_t, licenses_list) },
+   { offsetof(core_info_t, categories),           offsetof(core_info_t, categories_list) },
+   { offsetof(core_info_t, databases),            offsetof(core_info_t, databases_list) },
+   { offsetof(core_info_t, notes),                offsetof(core_info_t, note_list) },
+   { offsetof(core_info_t, required_hw_api),      offsetof(core_info_t, required_hw_api_list) },
+   { offsetof(core_info_t, description),          CORE_INFO_CACHE_NO_LIST },
+   { offsetof(core_info_t, core_file_id.str),     CORE_INFO_CACHE_NO_LIST }
+};
 
-static bool CCJSONStartArrayHandler(void *context)
-{
-   CCJSONContext *pCtx = (CCJSONContext*)context;
-   pCtx->array_depth++;
-   return true;
-}
+#define CORE_INFO_CACHE_STR_COUNT ARRAY_SIZE(core_info_cache_fields)
 
-static bool CCJSONEndArrayHandler(void *context)
+/* String table under construction, and
+ * the offsets of the strings it contains */
+typedef struct
 {
-   CCJSONContext *pCtx = (CCJSONContext*)context;
-
-   if ((pCtx->object_depth == 2) && (pCtx->array_depth == 2))
-      pCtx->to_firmware = false;
+   char *data;
+   uint32_t *map;
+} core_info_cache_strings_t;
 
-   retro_assert(pCtx->array_depth > 0);
-   pCtx->array_depth--;
+#define CORE_INFO_CACHE_FIELD_STR(info, field) (*(char**)((uint8_t*)(info) + (field)->str))
+#define CORE_INFO_CACHE_FIELD_LIST(info, field) (*(struct string_list**)((uint8_t*)(info) + (field)->list))
 
-   return true;
-}
-
-/* JSON Handlers END */
+/* Forward declarations */
+static void core_info_free(core_info_t* info);
+static uint32_t core_info_hash_string(const char *str);
 
-/* Note: 'dst' must be zero initialised, or memory
+/* Transfers 'ownership' of internal objects/data
+ * structures from 'src' to 'dst'
+ * Note: 'dst' must be zero initialised, or memory
  * leaks will occur */
-static void core_info_copy(core_info_t *src, core_info_t *dst)
-{
-   dst->path                      = src->path                 ? strdup(src->path)                 : NULL;
-   dst->display_name              = src->display_name         ? strdup(src->display_name)         : NULL;
-   dst->display_version           = src->display_version      ? strdup(src->display_version)      : NULL;
-   dst->core_name                 = src->core_name            ? strdup(src->core_name)            : NULL;
-   dst->system_manufacturer       = src->system_manufacturer  ? strdup(src->system_manufacturer)  : NULL;
-   dst->systemname                = src->systemname           ? strdup(src->systemname)           : NULL;
-   dst->system_id                 = src->system_id            ? strdup(src->system_id)            : NULL;
-   dst->supported_extensions      = src->supported_extensions ? strdup(src->supported_extensions) : NULL;
-   dst->authors                   = src->authors              ? strdup(src->authors)              : NULL;
-   dst->permissions               = src->permissions          ? strdup(src->permissions)          : NULL;
-   dst->licenses                  = src->licenses             ? strdup(src->licenses)             : NULL;
-   dst->categories                = src->categories           ? strdup(src->categories)           : NULL;
-   dst->databases                 = src->databases            ? strdup(src->databases)            : NULL;
-   dst->notes                     = src->notes                ? strdup(src->notes)                : NULL;
-   dst->required_hw_api           = src->required_hw_api      ? strdup(src->required_hw_api)      : NULL;
-   dst->description               = src->description          ? strdup(src->description)          : NULL;
-
-   dst->categories_list           = src->categories_list           ? string_list_clone(src->categories_list)           : NULL;
-   dst->databases_list            = src->databases_list            ? string_list_clone(src->databases_list)            : NULL;
-   dst->note_list                 = src->note_list                 ? string_list_clone(src->note_list)                 : NULL;
-   dst->supported_extensions_list = src->supported_extensions_list ? string_list_clone(src->supported_extensions_list) : NULL;
-   dst->authors_list              = src->authors_list              ? string_list_clone(src->authors_list)              : NULL;
-   dst->permissions_list          = src->permissions_list          ? string_list_clone(src->permissions_list)          : NULL;
-   dst->licenses_list             = src->licenses_list             ? string_list_clone(src->licenses_list)             : NULL;
-   dst->required_hw_api_list      = src->required_hw_api_list      ? string_list_clone(src->required_hw_api_list)      : NULL;
-
-   if (src->firmware_count > 0)
-   {
-      dst->firmware = (core_info_firmware_t*)calloc(src->firmware_count,
-            sizeof(core_info_firmware_t));
-
-      if (dst->firmware)
-      {
-         size_t i;
-
-         dst->firmware_count = src->firmware_count;
-
-         for (i = 0; i < src->firmware_count; i++)
-         {
-            dst->firmware[i].path     = src->firmware[i].path ? strdup(src->firmware[i].path) : NULL;
-            dst->firmware[i].desc     = src->firmware[i].desc ? strdup(src->firmware[i].desc) : NULL;
-            dst->firmware[i].missing  = src->firmware[i].missing;
-            dst->firmware[i].optional = src->firmware[i].optional;
-         }
-      }
-      else
-         dst->firmware_count = 0;
-   }
-
-   dst->core_file_id.str  = src->core_file_id.str ? strdup(src->core_file_id.str) : NULL;
-   dst->core_file_id.hash = src->core_file_id.hash;
-
-   dst->has_info                      = src->has_info;
-   dst->supports_no_game              = src->supports_no_game;
-   dst->database_match_archive_member = src->database_match_archive_member;
-   dst->is_experimental               = src->is_experimental;
-   dst->is_locked                     = src->is_locked;
-   dst->is_installed                  = src->is_installed;
-}
-
-/* Like core_info_copy, but transfers 'ownership'
- * of internal objects/data structures from 'src'
- * to 'dst' */
 static void core_info_transfer(core_info_t *src, core_info_t *dst)
 {
    dst->path                      = src->path;
@@ -521,6 +238,7 @@ static void core_info_transfer(core_info_t *src, core_info_t *dst)
    dst->supports_no_game              = src->supports_no_game;
    dst->database_match_archive_member = src->database_match_archive_member;
    dst->is_experimental               = src->is_experimental;
+   dst->supports_warm_switch          = src->supports_warm_switch;
    dst->is_locked                     = src->is_locked;
    dst->is_installed                  = src->is_installed;
 }
@@ -539,6 +257,7 @@ static void core_info_cache_list_free(core_info_cache_list_t *core_info_cache_li
    }
 
    free(core_info_cache_list->items);
+   free(core_info_cache_list->all_ext);
    free(core_info_cache_list);
 }
 
@@ -550,8 +269,9 @@ static core_info_cache_list_t *core_info_cache_list_new(void)
    if (!core_info_cache_list)
       return NULL;
 
-   core_info_cache_list->length = 0;
-   core_info_cache_list->items  = (core_info_t *)calloc(CORE_INFO_CACHE_DEFAULT_CAPACITY,
+   core_info_cache_list->length  = 0;
+   core_info_cache_list->all_ext = NULL;
+   core_info_cache_list->items   = (core_info_t *)calloc(CORE_INFO_CACHE_DEFAULT_CAPACITY,
          sizeof(core_info_t));
 
    if (!core_info_cache_list->items)
@@ -595,48 +315,271 @@ static core_info_t *core_info_cache_find(core_info_cache_list_t *list, char *cor
    return NULL;
 }
 
-static void core_info_cache_add(core_info_cache_list_t *list, core_info_t *info,
-      bool transfer)
+static int core_info_extension_cmp(const void *a, const void *b)
 {
-   core_info_t *info_cache = NULL;
+   return strcmp(*(const char**)a, *(const char**)b);
+}
 
-   if (!list ||
-       !info ||
-       (info->core_file_id.hash == 0) ||
-       string_is_empty(info->core_file_id.str))
-      return;
+/* Returns the sorted, unique supported extensions
+ * of 'count' cores in 'infos' as an RBUF of pointers
+ * into the cores' extension lists */
+static const char **core_info_get_extensions(const core_info_t *infos,
+      size_t count)
+{
+   size_t i, j;
+   size_t len        = 0;
+   const char **exts = NULL;
+
+   for (i = 0; i < count; i++)
+   {
+      const struct string_list *list = infos[i].supported_extensions_list;
+
+      if (!list)
+         continue;
+
+      for (j = 0; j < list->size; j++)
+         RBUF_PUSH(exts, list->elems[j].data);
+   }
+
+   if (!exts)
+      return NULL;
+
+   qsort(exts, RBUF_LEN(exts), sizeof(*exts), core_info_extension_cmp);
 
-   if (list->length >= list->capacity)
+   for (i = 0; i < RBUF_LEN(exts); i++)
+      if (!len || !string_is_equal(exts[len - 1], exts[i]))
+         exts[len++] = exts[i];
+
+   RBUF_RESIZE(exts, len);
+   return exts;
+}
+
+/* Joins the sorted extensions 'exts' into a
+ * '|' delimited 'all_ext' string, appending
+ * supported archive formats */
+static char *core_info_join_extensions(const char **exts, size_t count)
+{
+   size_t i;
+   size_t pos    = 0;
+   size_t len    = STRLEN_CONST("7z|") + STRLEN_CONST("zip|") + 1;
+   char *all_ext = NULL;
+#if defined(HAVE_7ZIP) || defined(HAVE_ZLIB)
+   const char *archive;
+#endif
+
+   for (i = 0; i < count; i++)
+      len += strlen(exts[i]) + 1;
+
+   if (!(all_ext = (char*)malloc(len)))
+      return NULL;
+
+   for (i = 0; i < count; i++)
+   {
+      size_t ext_len = strlen(exts[i]);
+      memcpy(all_ext + pos, exts[i], ext_len);
+      pos               += ext_len;
+      all_ext[pos++]     = '|';
+   }
+   all_ext[pos] = '\0';
+
+#ifdef HAVE_7ZIP
+   archive = "7z";
+   if (!count || !bsearch(&archive, exts, count, sizeof(*exts),
+            core_info_extension_cmp))
+      pos += strlcpy(all_ext + pos, "7z|", len - pos);
+#endif
+#ifdef HAVE_ZLIB
+   archive = "zip";
+   if (!count || !bsearch(&archive, exts, count, sizeof(*exts),
+            core_info_extension_cmp))
+      strlcpy(all_ext + pos, "zip|", len - pos);
+#endif
+
+   return all_ext;
+}
+
+/* Fetches string table entry 'offset' (little endian)
+ * Returns false if the offset is out of bounds */
+static bool core_info_cache_get_string(const char *strings,
+      size_t strings_size, uint32_t offset, const char **s)
+{
+   offset = retro_le_to_cpu32(offset);
+
+   if (offset == CORE_INFO_CACHE_NO_STRING)
+   {
+      *s = NULL;
+      return true;
+   }
+
+   if (offset >= strings_size)
+      return false;
+
+   *s = strings + offset;
+   return true;
+}
+
+static bool core_info_cache_parse(core_info_cache_list_t *list,
+      const uint8_t *data, size_t len)
+{
+   size_t i, j;
+   size_t num_words;
+   const uint32_t *header = (const uint32_t*)data;
+   const uint32_t *cores  = NULL;
+   const uint32_t *fw     = NULL;
+   const uint32_t *exts   = NULL;
+   const char *strings    = NULL;
+   const char **ext_list  = NULL;
+   uint32_t core_count;
+   uint32_t fw_count;
+   uint32_t ext_count;
+   uint32_t strings_size;
+
+   if (len < CORE_INFO_CACHE_HEADER_SIZE * sizeof(uint32_t) ||
+       memcmp(data, CORE_INFO_CACHE_MAGIC, 4) ||
+       retro_le_to_cpu32(header[1]) != CORE_INFO_CACHE_VERSION)
+      return false;
+
+   core_count   = retro_le_to_cpu32(header[2]);
+   fw_count     = retro_le_to_cpu32(header[3]);
+   ext_count    = retro_le_to_cpu32(header[4]);
+   strings_size = retro_le_to_cpu32(header[5]);
+   num_words    = len / sizeof(uint32_t);
+
+   if (core_count > num_words / CORE_INFO_CACHE_CORE_SIZE ||
+       fw_count   > num_words / CORE_INFO_CACHE_FIRMWARE_SIZE ||
+       ext_count  > num_words)
+      return false;
+
+   /* String table must fill the rest of the file,
+    * and be terminated */
+   num_words = CORE_INFO_CACHE_HEADER_SIZE
+         + core_count * CORE_INFO_CACHE_CORE_SIZE
+         + fw_count   * CORE_INFO_CACHE_FIRMWARE_SIZE
+         + ext_count;
+
+   if (  strings_size == 0
+       || num_words > len / sizeof(uint32_t)
+       || len - num_words * sizeof(uint32_t) != strings_size
+       || data[len - 1] != '\0')
+      return false;
+
+   cores   = header + CORE_INFO_CACHE_HEADER_SIZE;
+   fw      = cores  + core_count * CORE_INFO_CACHE_CORE_SIZE;
+   exts    = fw     + fw_count   * CORE_INFO_CACHE_FIRMWARE_SIZE;
+   strings = (const char*)(exts + ext_count);
+
+   if (core_count > list->capacity)
    {
-      size_t prev_capacity   = list->capacity;
       core_info_t *items_tmp = (core_info_t*)realloc(list->items,
-            (list->capacity << 1) * sizeof(core_info_t));
+            core_count * sizeof(core_info_t));
 
       if (!items_tmp)
-         return;
+         return false;
 
-      list->capacity = list->capacity << 1;
+      memset(&items_tmp[list->capacity], 0,
+            (core_count - list->capacity) * sizeof(core_info_t));
       list->items    = items_tmp;
+      list->capacity = core_count;
+   }
+
+   for (i = 0; i < core_count; i++)
+   {
+      const uint32_t *record = cores + i * CORE_INFO_CACHE_CORE_SIZE;
+      core_info_t *info      = &list->items[list->length++];
+      uint32_t fw_first      = retro_le_to_cpu32(record[CORE_INFO_CACHE_STR_COUNT + 1]);
+      uint32_t fw_num        = retro_le_to_cpu32(record[CORE_INFO_CACHE_STR_COUNT + 2]);
+      uint32_t flags         = retro_le_to_cpu32(record[CORE_INFO_CACHE_STR_COUNT + 3]);
+
+      for (j = 0; j < CORE_INFO_CACHE_STR_COUNT; j++)
+      {
+         const core_info_cache_field_t *field = &core_info_cache_fields[j];
+         const char *str                      = NULL;
+
+         if (!core_info_cache_get_string(strings, strings_size,
+                  record[j], &str))
+            return false;
+
+         if (!str)
+            continue;
+
+         CORE_INFO_CACHE_FIELD_STR(info, field) = strdup(str);
 
-      memset(&list->items[prev_capacity], 0,
-            (list->capacity - prev_capacity) * sizeof(core_info_t));
+         if (     field->list != CORE_INFO_CACHE_NO_LIST
+               && !string_is_empty(str))
+            CORE_INFO_CACHE_FIELD_LIST(info, field) = string_split(str, "|");
+      }
+
+      info->core_file_id.hash             = retro_le_to_cpu32(
+            record[CORE_INFO_CACHE_STR_COUNT]);
+      info->has_info                      = (flags & CORE_INFO_CACHE_FLAG_HAS_INFO) != 0;
+      info->supports_no_game              = (flags & CORE_INFO_CACHE_FLAG_SUPPORTS_NO_GAME) != 0;
+      info->database_match_archive_member = (flags & CORE_INFO_CACHE_FLAG_DATABASE_MATCH_ARCHIVE_MEMBER) != 0;
+      info->is_experimental               = (flags & CORE_INFO_CACHE_FLAG_IS_EXPERIMENTAL) != 0;
+      info->supports_warm_switch          = (flags & CORE_INFO_CACHE_FLAG_SUPPORTS_WARM_SWITCH) != 0;
+
+      if (  string_is_empty(info->core_file_id.str)
+          || info->core_file_id.hash == 0
+          || fw_first > fw_count
+          || fw_num   > fw_count - fw_first)
+         return false;
+
+      if (fw_num > 0)
+      {
+         info->firmware = (core_info_firmware_t*)calloc(fw_num,
+               sizeof(core_info_firmware_t));
+
+         if (!info->firmware)
+            return false;
+
+         info->firmware_count = fw_num;
+
+         for (j = 0; j < fw_num; j++)
+         {
+            const uint32_t *fw_record = fw + (fw_first + j) * CORE_INFO_CACHE_FIRMWARE_SIZE;
+            const char *path          = NULL;
+            const char *desc          = NULL;
+
+            if (  !core_info_cache_get_string(strings, strings_size,
+                     fw_record[0], &path)
+                || !core_info_cache_get_string(strings, strings_size,
+                     fw_record[1], &desc))
+               return false;
+
+            info->firmware[j].path     = path ? strdup(path) : NULL;
+            info->firmware[j].desc     = desc ? strdup(desc) : NULL;
+            info->firmware[j].optional = (retro_le_to_cpu32(fw_record[2])
+                  & CORE_INFO_CACHE_FIRMWARE_OPTIONAL) != 0;
+         }
+      }
    }
 
-   info_cache = (core_info_t*)&list->items[list->length];
+   if (ext_count > 0)
+   {
+      if (!(ext_list = (const char**)malloc(ext_count * sizeof(*ext_list))))
+         return false;
 
-   if (transfer)
-      core_info_transfer(info, info_cache);
-   else
-      core_info_copy(info, info_cache);
+      for (i = 0; i < ext_count; i++)
+      {
+         if (  !core_info_cache_get_string(strings, strings_size,
+                  exts[i], &ext_list[i])
+             || !ext_list[i])
+         {
+            free(ext_list);
+            return false;
+         }
+      }
+   }
+
+   list->all_ext = core_info_join_extensions(ext_list, ext_count);
+   free(ext_list);
 
-   list->length++;
+   return true;
 }
 
 static core_info_cache_list_t *core_info_cache_read(const char *info_dir)
 {
-   intfstream_t *file                           = NULL;
-   rjson_t *parser                              = NULL;
-   CCJSONContext context                        = {0};
+   void *buf                                    = NULL;
+   int64_t len                                  = 0;
    core_info_cache_list_t *core_info_cache_list = NULL;
    char file_path[PATH_MAX_LENGTH];
 
@@ -662,81 +605,67 @@ static core_info_cache_list_t *core_info_cache_read(const char *info_dir)
       fill_pathname_join(file_path, info_dir, FILE_PATH_CORE_INFO_CACHE,
             sizeof(file_path));
 
-#if defined(HAVE_ZLIB)
-   file = intfstream_open_rzip_file(file_path,
-         RETRO_VFS_FILE_ACCESS_READ);
-#else
-   file = intfstream_open_file(file_path,
-         RETRO_VFS_FILE_ACCESS_READ,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE);
-#endif
-
-   if (!file)
-      return core_info_cache_list_new();
+   if (!(core_info_cache_list = core_info_cache_list_new()))
+      return NULL;
 
-   /* Parse info cache file */
-   parser = rjson_open_stream(file);
-   if (!parser)
-   {
-      RARCH_ERR("[Core Info] Failed to create JSON parser\n");
-      goto end;
-   }
+   /* Entire cache is loaded with a single read */
+   if (  !path_is_valid(file_path)
+       || !filestream_read_file(file_path, &buf, &len))
+      return core_info_cache_list;
 
-   rjson_set_options(parser,
-           RJSON_OPTION_ALLOW_UTF8BOM
-         | RJSON_OPTION_ALLOW_COMMENTS
-         | RJSON_OPTION_ALLOW_UNESCAPED_CONTROL_CHARACTERS
-         | RJSON_OPTION_REPLACE_INVALID_ENCODING);
-
-   if (rjson_parse(parser, &context,
-         CCJSONObjectMemberHandler,
-         CCJSONStringHandler,
-         CCJSONNumberHandler,
-         CCJSONStartObjectHandler,
-         CCJSONEndObjectHandler,
-         CCJSONStartArrayHandler,
-         CCJSONEndArrayHandler,
-         CCJSONBoolHandler,
-         NULL) /* Unused null handler */
-         != RJSON_DONE)
+   if (!core_info_cache_parse(core_info_cache_list,
+            (const uint8_t*)buf, (size_t)len))
    {
-      RARCH_WARN("[Core Info] Error parsing chunk:\n---snip---\n%.*s\n---snip---\n",
-            rjson_get_source_context_len(parser),
-            rjson_get_source_context_buf(parser));
-      RARCH_WARN("[Core Info] Error: Invalid JSON at line %d, column %d - %s.\n",
-            (int)rjson_get_source_line(parser),
-            (int)rjson_get_source_column(parser),
-            (*rjson_get_error(parser) ? rjson_get_error(parser) : "format error"));
+      RARCH_WARN("[Core Info] Invalid or outdated cache file: %s\n", file_path);
 
       /* Info cache is corrupt - discard it */
-      core_info_cache_list_free(context.core_info_cache_list);
+      core_info_cache_list_free(core_info_cache_list);
       core_info_cache_list = core_info_cache_list_new();
    }
-   else
-      core_info_cache_list = context.core_info_cache_list;
 
-   rjson_free(parser);
+   free(buf);
+   return core_info_cache_list;
+}
 
-   /* Clean up leftovers in the event of
-    * a parsing error */
-   if (context.core_info)
-   {
-      core_info_free(context.core_info);
-      free(context.core_info);
-   }
+/* Appends 's' to the string table unless
+ * already present, and returns its offset */
+static uint32_t core_info_cache_add_string(
+      core_info_cache_strings_t *strings, const char *s)
+{
+   size_t len;
+   size_t offset;
 
-end:
-   intfstream_close(file);
-   free(file);
+   if (!s)
+      return CORE_INFO_CACHE_NO_STRING;
 
-   return core_info_cache_list;
+   if (RHMAP_HAS_STR(strings->map, s))
+      return RHMAP_GET_STR(strings->map, s);
+
+   len    = strlen(s) + 1;
+   offset = RBUF_LEN(strings->data);
+
+   if (!RBUF_TRYFIT(strings->data, offset + len))
+      return CORE_INFO_CACHE_NO_STRING;
+
+   memcpy(strings->data + offset, s, len);
+   RBUF_RESIZE(strings->data, offset + len);
+   RHMAP_SET_STR(strings->map, s, (uint32_t)offset);
+
+   return (uint32_t)offset;
 }
 
-static bool core_info_cache_write(core_info_cache_list_t *list, const char *info_dir)
+static bool core_info_cache_write(core_info_list_t *list, const char *info_dir)
 {
-   intfstream_t *file    = NULL;
-   rjsonwriter_t *writer = NULL;
+   uint32_t *cores       = NULL;
+   uint32_t *fw          = NULL;
+   uint32_t *ext_offsets = NULL;
+   const char **exts     = NULL;
+   uint8_t *data         = NULL;
+   size_t core_count     = 0;
+   size_t data_size      = 0;
    bool success          = false;
+   core_info_cache_strings_t strings;
+   uint32_t header[CORE_INFO_CACHE_HEADER_SIZE];
    char file_path[PATH_MAX_LENGTH];
    size_t i, j;
 
@@ -745,329 +674,98 @@ static bool core_info_cache_write(core_info_cache_list_t *list, const char *info
    if (!list)
       return false;
 
-   /* Open info cache file */
-   if (string_is_empty(info_dir))
-      strlcpy(file_path, FILE_PATH_CORE_INFO_CACHE, sizeof(file_path));
-   else
-      fill_pathname_join(file_path, info_dir, FILE_PATH_CORE_INFO_CACHE,
-            sizeof(file_path));
+   strings.data = NULL;
+   strings.map  = NULL;
 
-#if defined(CORE_INFO_CACHE_COMPRESS)
-   file = intfstream_open_rzip_file(file_path,
-         RETRO_VFS_FILE_ACCESS_WRITE);
-#else
-   file = intfstream_open_file(file_path,
-         RETRO_VFS_FILE_ACCESS_WRITE,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE);
-#endif
+   /* Offset 0 is always the empty string */
+   core_info_cache_add_string(&strings, "");
 
-   if (!file)
+   for (i = 0; i < list->count; i++)
    {
-      RARCH_ERR("[Core Info] Failed to write to core info cache file: %s\n", file_path);
-      return false;
-   }
+      core_info_t* info = &list->list[i];
+      uint32_t flags    = 0;
 
-   /* Write info cache */
-   writer = rjsonwriter_open_stream(file);
-   if (!writer)
-   {
-      RARCH_ERR("[Core Info] Failed to create JSON writer\n");
-      goto end;
-   }
+      if (!info->is_installed)
+         continue;
 
-#if defined(CORE_INFO_CACHE_COMPRESS)
-   /* When compressing info cache, human readability
-    * is not a factor - can skip all indentation
-    * and new line characters */
-   rjsonwriter_set_options(writer, RJSONWRITER_OPTION_SKIP_WHITESPACE);
-#endif
+      for (j = 0; j < CORE_INFO_CACHE_STR_COUNT; j++)
+         RBUF_PUSH(cores, retro_cpu_to_le32(core_info_cache_add_string(
+               &strings,
+               CORE_INFO_CACHE_FIELD_STR(info, &core_info_cache_fields[j]))));
+
+      if (info->has_info)
+         flags |= CORE_INFO_CACHE_FLAG_HAS_INFO;
+      if (info->supports_no_game)
+         flags |= CORE_INFO_CACHE_FLAG_SUPPORTS_NO_GAME;
+      if (info->database_match_archive_member)
+         flags |= CORE_INFO_CACHE_FLAG_DATABASE_MATCH_ARCHIVE_MEMBER;
+      if (info->is_experimental)
+         flags |= CORE_INFO_CACHE_FLAG_IS_EXPERIMENTAL;
+      if (info->supports_warm_switch)
+         flags |= CORE_INFO_CACHE_FLAG_SUPPORTS_WARM_SWITCH;
+
+      RBUF_PUSH(cores, retro_cpu_to_le32(info->core_file_id.hash));
+      RBUF_PUSH(cores, retro_cpu_to_le32((uint32_t)(RBUF_LEN(fw)
+            / CORE_INFO_CACHE_FIRMWARE_SIZE)));
+      RBUF_PUSH(cores, retro_cpu_to_le32((uint32_t)info->firmware_count));
+      RBUF_PUSH(cores, retro_cpu_to_le32(flags));
+
+      for (j = 0; j < info->firmware_count; j++)
+      {
+         RBUF_PUSH(fw, retro_cpu_to_le32(core_info_cache_add_string(
+               &strings, info->firmware[j].path)));
+         RBUF_PUSH(fw, retro_cpu_to_le32(core_info_cache_add_string(
+               &strings, info->firmware[j].desc)));
+         RBUF_PUSH(fw, retro_cpu_to_le32(info->firmware[j].optional
+               ? CORE_INFO_CACHE_FIRMWARE_OPTIONAL : 0));
+      }
 
-   rjsonwriter_add_start_object(writer);
-   rjsonwriter_add_newline(writer);
-   rjsonwriter_add_spaces(writer, 2);
-   rjsonwriter_add_string(writer, "version");
-   rjsonwriter_add_colon(writer);
-   rjsonwriter_add_space(writer);
-   rjsonwriter_add_string(writer, "1.0");
-   rjsonwriter_add_comma(writer);
-   rjsonwriter_add_newline(writer);
-   rjsonwriter_add_spaces(writer, 2);
-   rjsonwriter_add_string(writer, "items");
-   rjsonwriter_add_colon(writer);
-   rjsonwriter_add_space(writer);
-   rjsonwriter_add_start_array(writer);
-   rjsonwriter_add_newline(writer);
+      core_count++;
+   }
 
-   for (i = 0; i < list->length; i++)
-   {
-      core_info_t* info = &list->items[i];
+   exts = core_info_get_extensions(list->list, list->count);
+   for (i = 0; i < RBUF_LEN(exts); i++)
+      RBUF_PUSH(ext_offsets, retro_cpu_to_le32(core_info_cache_add_string(
+            &strings, exts[i])));
 
-      if (!info || !info->is_installed)
-         continue;
+   /* Serialise the cache */
+   memcpy(&header[0], CORE_INFO_CACHE_MAGIC, 4);
+   header[1] = retro_cpu_to_le32(CORE_INFO_CACHE_VERSION);
+   header[2] = retro_cpu_to_le32((uint32_t)core_count);
+   header[3] = retro_cpu_to_le32((uint32_t)(RBUF_LEN(fw)
+         / CORE_INFO_CACHE_FIRMWARE_SIZE));
+   header[4] = retro_cpu_to_le32((uint32_t)RBUF_LEN(ext_offsets));
+   header[5] = retro_cpu_to_le32((uint32_t)RBUF_LEN(strings.data));
 
-      if (i > 0)
-      {
-         rjsonwriter_add_comma(writer);
-         rjsonwriter_add_newline(writer);
-      }
+   data_size = sizeof(header) + RBUF_SIZEOF(cores) + RBUF_SIZEOF(fw)
+         + RBUF_SIZEOF(ext_offsets) + RBUF_LEN(strings.data);
 
-      rjsonwriter_add_spaces(writer, 4);
-      rjsonwriter_add_start_object(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "path");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->path);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "display_name");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->display_name);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "display_version");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->display_version);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "core_name");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->core_name);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "system_manufacturer");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->system_manufacturer);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "systemname");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->systemname);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "system_id");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->system_id);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "supported_extensions");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->supported_extensions);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "authors");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->authors);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "permissions");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->permissions);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "licenses");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->licenses);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "categories");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->categories);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "databases");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->databases);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "notes");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->notes);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "required_hw_api");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->required_hw_api);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "description");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->description);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      if (info->firmware_count > 0)
-      {
-         rjsonwriter_add_spaces(writer, 6);
-         rjsonwriter_add_string(writer, "firmware");
-         rjsonwriter_add_colon(writer);
-         rjsonwriter_add_space(writer);
-         rjsonwriter_add_start_array(writer);
-         rjsonwriter_add_newline(writer);
-
-         for (j = 0; j < info->firmware_count; j++)
-         {
-            rjsonwriter_add_spaces(writer, 8);
-            rjsonwriter_add_start_object(writer);
-            rjsonwriter_add_newline(writer);
-            rjsonwriter_add_spaces(writer, 10);
-            rjsonwriter_add_string(writer, "path");
-            rjsonwriter_add_colon(writer);
-            rjsonwriter_add_space(writer);
-            rjsonwriter_add_string(writer, info->firmware[j].path);
-            rjsonwriter_add_comma(writer);
-            rjsonwriter_add_newline(writer);
-            rjsonwriter_add_spaces(writer, 10);
-            rjsonwriter_add_string(writer, "desc");
-            rjsonwriter_add_colon(writer);
-            rjsonwriter_add_space(writer);
-            rjsonwriter_add_string(writer, info->firmware[j].desc);
-            rjsonwriter_add_comma(writer);
-            rjsonwriter_add_newline(writer);
-            rjsonwriter_add_spaces(writer, 10);
-            rjsonwriter_add_string(writer, "optional");
-            rjsonwriter_add_colon(writer);
-            rjsonwriter_add_space(writer);
-            rjsonwriter_add_bool(writer, info->firmware[j].optional);
-            rjsonwriter_add_newline(writer);
-            rjsonwriter_add_spaces(writer, 8);
-            rjsonwriter_add_end_object(writer);
-
-            if (j < info->firmware_count - 1)
-               rjsonwriter_add_comma(writer);
-
-            rjsonwriter_add_newline(writer);
-         }
+   if (!(data = (uint8_t*)malloc(data_size)))
+      goto end;
 
-         rjsonwriter_add_spaces(writer, 6);
-         rjsonwriter_add_end_array(writer);
-         rjsonwriter_add_comma(writer);
-         rjsonwriter_add_newline(writer);
-      }
+   memcpy(data, header, sizeof(header));
+   i = sizeof(header);
+   memcpy(data + i, cores, RBUF_SIZEOF(cores));
+   i += RBUF_SIZEOF(cores);
+   memcpy(data + i, fw, RBUF_SIZEOF(fw));
+   i += RBUF_SIZEOF(fw);
+   memcpy(data + i, ext_offsets, RBUF_SIZEOF(ext_offsets));
+   i += RBUF_SIZEOF(ext_offsets);
+   memcpy(data + i, strings.data, RBUF_LEN(strings.data));
+
+   /* Write info cache file */
+   if (string_is_empty(info_dir))
+      strlcpy(file_path, FILE_PATH_CORE_INFO_CACHE, sizeof(file_path));
+   else
+      fill_pathname_join(file_path, info_dir, FILE_PATH_CORE_INFO_CACHE,
+            sizeof(file_path));
 
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "core_file_id");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_newline(writer);
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_start_object(writer);
-      rjsonwriter_add_newline(writer);
-      rjsonwriter_add_spaces(writer, 8);
-      rjsonwriter_add_string(writer, "str");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->core_file_id.str);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-      rjsonwriter_add_spaces(writer, 8);
-      rjsonwriter_add_string(writer, "hash");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_unsigned(writer, info->core_file_id.hash);
-      rjsonwriter_add_newline(writer);
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_end_object(writer);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "firmware_count");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_unsigned(writer, info->firmware_count);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "has_info");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_bool(writer, info->has_info);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "supports_no_game");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_bool(writer, info->supports_no_game);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "database_match_archive_member");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_bool(writer, info->database_match_archive_member);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "is_experimental");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_bool(writer, info->is_experimental);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 4);
-      rjsonwriter_add_end_object(writer);
+   if (!filestream_write_file(file_path, data, (int64_t)data_size))
+   {
+      RARCH_ERR("[Core Info] Failed to write to core info cache file: %s\n", file_path);
+      goto end;
    }
 
-   rjsonwriter_add_newline(writer);
-   rjsonwriter_add_spaces(writer, 2);
-   rjsonwriter_add_end_array(writer);
-   rjsonwriter_add_newline(writer);
-   rjsonwriter_add_end_object(writer);
-   rjsonwriter_add_newline(writer);
-   rjsonwriter_free(writer);
-
    RARCH_LOG("[Core Info] Wrote to cache file: %s\n", file_path);
    success = true;
 
@@ -1084,10 +782,14 @@ static bool core_info_cache_write(core_info_cache_list_t *list, const char *info
       filestream_delete(file_path);
 
 end:
-   intfstream_close(file);
-   free(file);
+   free(data);
+   RBUF_FREE(cores);
+   RBUF_FREE(fw);
+   RBUF_FREE(ext_offsets);
+   RBUF_FREE(exts);
+   RBUF_FREE(strings.data);
+   RHMAP_FREE(strings.map);
 
-   list->refresh = false;
    return success;
 }
 
@@ -1466,18 +1168,12 @@ static void core_info_resolve_firmware(
       entry = config_get_entry(conf, path_key);
 
       if (entry && !string_is_empty(entry->value))
-      {
-         firmware[i].path = entry->value;
-         entry->value     = NULL;
-      }
+         firmware[i].path = strdup(entry->value);
 
       entry = config_get_entry(conf, desc_key);
 
       if (entry && !string_is_empty(entry->value))
-      {
-         firmware[i].desc = entry->value;
-         entry->value     = NULL;
-      }
+         firmware[i].desc = strdup(entry->value);
 
       if (config_get_bool(conf, opt_key , &tmp_bool))
          firmware[i].optional = tmp_bool;
@@ -1508,8 +1204,7 @@ static config_file_t *core_info_get_config_file(
 }
 
 static void core_info_parse_config_file(
-      core_info_list_t *list, core_info_t *info,
-      config_file_t *conf)
+      core_info_t *info, config_file_t *conf)
 {
    struct config_entry_list *entry = NULL;
    bool tmp_bool                   = false;
@@ -1517,57 +1212,38 @@ static void core_info_parse_config_file(
    entry = config_get_entry(conf, "display_name");
 
    if (entry && !string_is_empty(entry->value))
-   {
-      info->display_name = entry->value;
-      entry->value       = NULL;
-   }
+      info->display_name = strdup(entry->value);
 
    entry = config_get_entry(conf, "display_version");
 
    if (entry && !string_is_empty(entry->value))
-   {
-      info->display_version = entry->value;
-      entry->value          = NULL;
-   }
+      info->display_version = strdup(entry->value);
 
    entry = config_get_entry(conf, "corename");
 
    if (entry && !string_is_empty(entry->value))
-   {
-      info->core_name = entry->value;
-      entry->value    = NULL;
-   }
+      info->core_name = strdup(entry->value);
 
    entry = config_get_entry(conf, "systemname");
 
    if (entry && !string_is_empty(entry->value))
-   {
-      info->systemname = entry->value;
-      entry->value     = NULL;
-   }
+      info->systemname = strdup(entry->value);
 
    entry = config_get_entry(conf, "systemid");
 
    if (entry && !string_is_empty(entry->value))
-   {
-      info->system_id = entry->value;
-      entry->value    = NULL;
-   }
+      info->system_id = strdup(entry->value);
 
    entry = config_get_entry(conf, "manufacturer");
 
    if (entry && !string_is_empty(entry->value))
-   {
-      info->system_manufacturer = entry->value;
-      entry->value              = NULL;
-   }
+      info->system_manufacturer = strdup(entry->value);
 
    entry = config_get_entry(conf, "supported_extensions");
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->supported_extensions      = entry->value;
-      entry->value                    = NULL;
+      info->supported_extensions      = strdup(entry->value);
 
       info->supported_extensions_list =
             string_split(info->supported_extensions, "|");
@@ -1577,8 +1253,7 @@ static void core_info_parse_config_file(
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->authors      = entry->value;
-      entry->value       = NULL;
+      info->authors      = strdup(entry->value);
 
       info->authors_list =
             string_split(info->authors, "|");
@@ -1588,8 +1263,7 @@ static void core_info_parse_config_file(
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->permissions      = entry->value;
-      entry->value           = NULL;
+      info->permissions      = strdup(entry->value);
 
       info->permissions_list =
             string_split(info->permissions, "|");
@@ -1599,8 +1273,7 @@ static void core_info_parse_config_file(
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->licenses      = entry->value;
-      entry->value        = NULL;
+      info->licenses      = strdup(entry->value);
 
       info->licenses_list =
             string_split(info->licenses, "|");
@@ -1610,8 +1283,7 @@ static void core_info_parse_config_file(
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->categories      = entry->value;
-      entry->value          = NULL;
+      info->categories      = strdup(entry->value);
 
       info->categories_list =
             string_split(info->categories, "|");
@@ -1621,8 +1293,7 @@ static void core_info_parse_config_file(
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->databases      = entry->value;
-      entry->value         = NULL;
+      info->databases      = strdup(entry->value);
 
       info->databases_list =
             string_split(info->databases, "|");
@@ -1632,8 +1303,7 @@ static void core_info_parse_config_file(
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->notes     = entry->value;
-      entry->value    = NULL;
+      info->notes     = strdup(entry->value);
 
       info->note_list =
             string_split(info->notes, "|");
@@ -1643,8 +1313,7 @@ static void core_info_parse_config_file(
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->required_hw_api      = entry->value;
-      entry->value               = NULL;
+      info->required_hw_api      = strdup(entry->value);
 
       info->required_hw_api_list =
             string_split(info->required_hw_api, "|");
@@ -1653,10 +1322,7 @@ static void core_info_parse_config_file(
    entry = config_get_entry(conf, "description");
 
    if (entry && !string_is_empty(entry->value))
-   {
-      info->description = entry->value;
-      entry->value      = NULL;
-   }
+      info->description = strdup(entry->value);
 
    if (config_get_bool(conf, "supports_no_game",
             &tmp_bool))
@@ -1670,50 +1336,218 @@ static void core_info_parse_config_file(
             &tmp_bool))
       info->is_experimental = tmp_bool;
 
+   if (config_get_bool(conf, "supports_warm_switch",
+            &tmp_bool))
+      info->supports_warm_switch = tmp_bool;
+
    core_info_resolve_firmware(info, conf);
 
    info->has_info = true;
-   list->info_count++;
 }
 
-static void core_info_list_resolve_all_extensions(
-      core_info_list_t *core_info_list)
+/* Parses the info file of a core whose path and
+ * file 'id' are already set
+ * > Only touches 'info', so may be called from
+ *   any thread */
+static void core_info_parse_core(core_info_t *info,
+      const char *info_dir)
 {
-   size_t i              = 0;
-   size_t all_ext_len    = 0;
-   char *all_ext         = NULL;
+   config_file_t *conf = core_info_get_config_file(
+         info->core_file_id.str, info_dir);
 
-   for (i = 0; i < core_info_list->count; i++)
+   if (conf)
    {
-      if (core_info_list->list[i].supported_extensions)
-         all_ext_len +=
-            (strlen(core_info_list->list[i].supported_extensions) + 2);
+      core_info_parse_config_file(info, conf);
+      config_file_free(conf);
    }
 
-   all_ext_len += STRLEN_CONST("7z|") + STRLEN_CONST("zip|");
+   /* Get fallback display name, if required */
+   if (!info->display_name)
+      info->display_name = strdup(
+            path_basename_nocompression(info->path));
+
+   info->is_installed = true;
+}
+
+#ifdef HAVE_THREADS
+#define CORE_INFO_PARSE_MAX_WORKERS 8
+
+typedef struct
+{
+   core_info_t *list;
+   const size_t *pending;
+   const char *info_dir;
+} core_info_parse_state_t;
+
+static void core_info_parse_job(void *data, unsigned index)
+{
+   core_info_parse_state_t *state = (core_info_parse_state_t*)data;
 
-   all_ext      = (char*)calloc(1, all_ext_len);
+   core_info_parse_core(&state->list[state->pending[index]],
+         state->info_dir);
+}
+#endif
 
-   if (!all_ext)
+/* Parses the info files of the 'num_pending' cores
+ * of 'list' at indices 'pending'
+ * > Info files may live on slow (e.g. network)
+ *   storage, so the work is spread over a thread
+ *   pool, with the calling thread joining in */
+static void core_info_parse_cores(core_info_t *list,
+      const size_t *pending, size_t num_pending, const char *info_dir)
+{
+   size_t i;
+#ifdef HAVE_THREADS
+   core_info_parse_state_t state;
+   unsigned max_workers = cpu_features_get_core_amount();
+
+   /* Parsing is mostly bound by file access latency */
+   if (max_workers < 4)
+      max_workers = 4;
+   if (max_workers > CORE_INFO_PARSE_MAX_WORKERS)
+      max_workers = CORE_INFO_PARSE_MAX_WORKERS;
+   /* Calling thread is a worker too */
+   if (max_workers > 0)
+      max_workers--;
+   if (max_workers > num_pending - 1)
+      max_workers = (unsigned)(num_pending - 1);
+
+   if (num_pending > 1 && max_workers > 0)
+   {
+      tpool_t *pool     = tpool_create(max_workers);
+
+      state.list        = list;
+      state.pending     = pending;
+      state.info_dir    = info_dir;
+
+      /* Without a pool, the cores are parsed in turn */
+      tpool_run_batch(pool, core_info_parse_job, &state,
+            (unsigned)num_pending);
+      tpool_destroy(pool);
       return;
+   }
+#endif
+
+   for (i = 0; i < num_pending; i++)
+      core_info_parse_core(&list[pending[i]], info_dir);
+}
 
-   core_info_list->all_ext = all_ext;
+static void core_info_list_resolve_all_extensions(
+      core_info_list_t *core_info_list)
+{
+   const char **exts = core_info_get_extensions(core_info_list->list,
+         core_info_list->count);
+
+   core_info_list->all_ext = core_info_join_extensions(exts, RBUF_LEN(exts));
+   RBUF_FREE(exts);
+}
+
+static int core_info_hash_cmp(const void *a, const void *b)
+{
+   uint32_t hash_a = *(const uint32_t*)a;
+   uint32_t hash_b = *(const uint32_t*)b;
+   return (hash_a > hash_b) - (hash_a < hash_b);
+}
+
+/* Sorts the core file id hashes in 'cores' and
+ * removes duplicates */
+static void core_info_sort_core_hashes(uint32_t *cores)
+{
+   size_t i;
+   size_t len = 0;
+
+   if (!cores)
+      return;
+
+   qsort(cores, RBUF_LEN(cores), sizeof(*cores), core_info_hash_cmp);
+
+   for (i = 0; i < RBUF_LEN(cores); i++)
+      if (!len || cores[len - 1] != cores[i])
+         cores[len++] = cores[i];
+
+   RBUF_RESIZE(cores, len);
+}
+
+/* Writes the extension index key of 'ext' to 's',
+ * i.e. the lowercase extension without leading '.' */
+static bool core_info_get_ext_key(const char *ext, char *s, size_t len)
+{
+   if (string_is_empty(ext))
+      return false;
+
+   if (*ext == '.')
+      ext++;
+
+   if (!*ext || strlcpy(s, ext, len) >= len)
+      return false;
+
+   string_to_lower(s);
+   return true;
+}
+
+static void core_info_list_build_ext_index(
+      core_info_list_t *core_info_list)
+{
+   size_t i, j, cap;
+   char key[256];
 
    for (i = 0; i < core_info_list->count; i++)
    {
-      if (!core_info_list->list[i].supported_extensions)
+      const core_info_t *info        = &core_info_list->list[i];
+      const struct string_list *exts = info->supported_extensions_list;
+
+      if (!exts)
          continue;
 
-      strlcat(core_info_list->all_ext,
-            core_info_list->list[i].supported_extensions, all_ext_len);
-      strlcat(core_info_list->all_ext, "|", all_ext_len);
+      for (j = 0; j < exts->size; j++)
+      {
+         ptrdiff_t idx;
+
+         if (!core_info_get_ext_key(exts->elems[j].data, key, sizeof(key)))
+            continue;
+
+         /* Note: RHMAP does not initialise new values */
+         idx = RHMAP_IDX_STR(core_info_list->ext_index, key);
+
+         if (idx == -1)
+         {
+            uint32_t *cores = NULL;
+            RBUF_PUSH(cores, info->core_file_id.hash);
+            RHMAP_SET_STR(core_info_list->ext_index, key, cores);
+         }
+         else
+            RBUF_PUSH(core_info_list->ext_index[idx], info->core_file_id.hash);
+      }
    }
-#ifdef HAVE_7ZIP
-   strlcat(core_info_list->all_ext, "7z|", all_ext_len);
-#endif
-#ifdef HAVE_ZLIB
-   strlcat(core_info_list->all_ext, "zip|", all_ext_len);
-#endif
+
+   cap = RHMAP_CAP(core_info_list->ext_index);
+
+   for (i = 0; i < cap; i++)
+      if (RHMAP_KEY(core_info_list->ext_index, i))
+         core_info_sort_core_hashes(core_info_list->ext_index[i]);
+}
+
+/* Returns the sorted core file id hashes (RBUF)
+ * of all cores supporting extension 'ext' */
+static const uint32_t *core_info_list_get_ext_cores(
+      const core_info_list_t *core_info_list, const char *ext)
+{
+   ptrdiff_t idx;
+   char key[256];
+
+   if (  !core_info_list->ext_index
+       || !core_info_get_ext_key(ext, key, sizeof(key)))
+      return NULL;
+
+   idx = RHMAP_IDX_STR(core_info_list->ext_index, key);
+   return (idx == -1) ? NULL : core_info_list->ext_index[idx];
+}
+
+static bool core_info_has_core_hash(const uint32_t *cores,
+      const core_info_t *info)
+{
+   return cores && bsearch(&info->core_file_id.hash, cores,
+         RBUF_LEN(cores), sizeof(*cores), core_info_hash_cmp);
 }
 
 static void core_info_free(core_info_t* info)
@@ -1768,6 +1602,17 @@ static void core_info_list_free(core_info_list_t *core_info_list)
       core_info_free(info);
    }
 
+   if (core_info_list->ext_index)
+   {
+      size_t cap = RHMAP_CAP(core_info_list->ext_index);
+
+      for (i = 0; i < cap; i++)
+         if (RHMAP_KEY(core_info_list->ext_index, i))
+            RBUF_FREE(core_info_list->ext_index[i]);
+
+      RHMAP_FREE(core_info_list->ext_index);
+   }
+
    free(core_info_list->all_ext);
    free(core_info_list->list);
    free(core_info_list);
@@ -1781,6 +1626,7 @@ static core_info_list_t *core_info_list_new(const char *path,
       bool *cache_supported)
 {
    size_t i;
+   size_t *pending                              = NULL;
    core_path_list_t *path_list                  = NULL;
    core_info_t *core_info                       = NULL;
    core_info_list_t *core_info_list             = NULL;
@@ -1800,6 +1646,7 @@ static core_info_list_t *core_info_list_new(const char *path,
    core_info_list->count      = 0;
    core_info_list->info_count = 0;
    core_info_list->all_ext    = NULL;
+   core_info_list->ext_index  = NULL;
 
    core_info = (core_info_t*)calloc(path_list->core_list->size,
          sizeof(*core_info));
@@ -1832,7 +1679,6 @@ static core_info_list_t *core_info_list_new(const char *path,
       core_file_path_t *core_file = &path_list->core_list->list[i];
       const char *base_path       = core_file->path;
       const char *core_filename   = core_file->filename;
-      config_file_t *conf         = NULL;
       char core_file_id[256];
 
       core_file_id[0] = '\0';
@@ -1850,17 +1696,14 @@ static core_info_list_t *core_info_list_new(const char *path,
 
          if (info_cache)
          {
-            core_info_copy(info_cache, info);
+            /* Cache entry is only needed once, and
+             * a refreshed cache is written from the
+             * core info list */
+            core_info_transfer(info_cache, info);
             /* Core lock status is 'dynamic', and
              * cannot be cached */
             info->is_locked = core_info_path_is_locked(path_list->lock_list,
                   core_filename);
-            /* 'info_count' is normally incremented inside
-             * core_info_parse_config_file(). If core entry
-             * is cached, must instead increment the value
-             * here */
-            if (info->has_info)
-               core_info_list->info_count++;
             continue;
          }
       }
@@ -1876,40 +1719,35 @@ static core_info_list_t *core_info_list_new(const char *path,
       info->core_file_id.str  = strdup(core_file_id);
       info->core_file_id.hash = core_info_hash_string(core_file_id);
 
-      /* Parse core info file */
-      conf = core_info_get_config_file(core_file_id, info_dir);
-
-      if (conf)
-      {
-         core_info_parse_config_file(core_info_list, info, conf);
-         config_file_free(conf);
-      }
-
-      /* Get fallback display name, if required */
-      if (!info->display_name)
-         info->display_name = strdup(core_filename);
-
-      info->is_installed = true;
+      /* Core info file is parsed below */
+      RBUF_PUSH(pending, i);
 
       /* If info cache is enabled and we reach this
        * point, current core is uncached
-       * > Add it to the list, and trigger a cache
-       *   refresh */
+       * > Trigger a cache refresh */
       if (core_info_cache_list)
-      {
-         core_info_cache_add(core_info_cache_list, info, false);
          core_info_cache_list->refresh = true;
-      }
    }
 
-   core_info_list_resolve_all_extensions(core_info_list);
+   /* Parse info files of all uncached cores */
+   if (pending)
+      core_info_parse_cores(core_info, pending, RBUF_LEN(pending),
+            info_dir);
+   RBUF_FREE(pending);
+
+   for (i = 0; i < core_info_list->count; i++)
+      if (core_info[i].has_info)
+         core_info_list->info_count++;
 
    /* If info cache is enabled
     * > Check whether any cached cores have been
     *   uninstalled since the last run (triggers
     *   a refresh)
     * > Write new cache to disk if updates are
-    *   required */
+    *   required
+    * > Otherwise the cached cores are exactly the
+    *   installed ones, and the cached extension
+    *   table can be used as is */
    *cache_supported = true;
    if (core_info_cache_list)
    {
@@ -1917,11 +1755,21 @@ static core_info_list_t *core_info_list_new(const char *path,
 
       if (core_info_cache_list->refresh)
          *cache_supported = core_info_cache_write(
-               core_info_cache_list, info_dir);
+               core_info_list, info_dir);
+      else
+      {
+         core_info_list->all_ext       = core_info_cache_list->all_ext;
+         core_info_cache_list->all_ext = NULL;
+      }
 
       core_info_cache_list_free(core_info_cache_list);
    }
 
+   if (!core_info_list->all_ext)
+      core_info_list_resolve_all_extensions(core_info_list);
+
+   core_info_list_build_ext_index(core_info_list);
+
    core_info_path_list_free(path_list);
    return core_info_list;
 
@@ -1982,6 +1830,27 @@ static bool core_info_does_support_file(
          core->supported_extensions_list, ".", path_get_extension(path));
 }
 
+/* Checks whether 'core' supports the content set
+ * up by core_info_list_get_supported_cores()
+ * > Only cores found in the extension index are
+ *   checked against their extension lists */
+static bool core_info_does_support_tmp_content(
+      const core_info_state_t *p_coreinfo, const core_info_t *core)
+{
+   if (!core_info_has_core_hash(p_coreinfo->tmp_cores, core))
+      return false;
+
+   if (core_info_does_support_file(core, p_coreinfo->tmp_path))
+      return true;
+
+#ifdef HAVE_COMPRESSION
+   if (core_info_does_support_any_file(core, p_coreinfo->tmp_list))
+      return true;
+#endif
+
+   return false;
+}
+
 /* qsort_r() is not in standard C, sadly. */
 
 static int core_info_qsort_cmp(const void *a_, const void *b_)
@@ -1989,16 +1858,10 @@ static int core_info_qsort_cmp(const void *a_, const void *b_)
    core_info_state_t *p_coreinfo = coreinfo_get_ptr();
    const core_info_t          *a = (const core_info_t*)a_;
    const core_info_t          *b = (const core_info_t*)b_;
-   int support_a                 = core_info_does_support_file(a,
-         p_coreinfo->tmp_path);
-   int support_b                 = core_info_does_support_file(b,
-         p_coreinfo->tmp_path);
-#ifdef HAVE_COMPRESSION
-   support_a            = support_a ||
-      core_info_does_support_any_file(a, p_coreinfo->tmp_list);
-   support_b            = support_b ||
-      core_info_does_support_any_file(b, p_coreinfo->tmp_list);
-#endif
+   int support_a                 = core_info_does_support_tmp_content(
+         p_coreinfo, a);
+   int support_b                 = core_info_does_support_tmp_content(
+         p_coreinfo, b);
 
    if (support_a != support_b)
       return support_b - support_a;
@@ -2058,6 +1921,7 @@ bool core_info_init_current_core(void)
    current->supports_no_game              = false;
    current->database_match_archive_member = false;
    current->is_experimental               = false;
+   current->supports_warm_switch          = false;
    current->is_locked                     = false;
    current->firmware_count                = 0;
    current->path                          = NULL;
@@ -2210,6 +2074,8 @@ void core_info_list_get_supported_cores(core_info_list_t *core_info_list,
 {
    size_t i;
    size_t supported              = 0;
+   uint32_t *cores               = NULL;
+   const uint32_t *ext_cores     = NULL;
 #ifdef HAVE_COMPRESSION
    struct string_list *list      = NULL;
 #endif
@@ -2220,36 +2086,53 @@ void core_info_list_get_supported_cores(core_info_list_t *core_info_list,
 
    p_coreinfo->tmp_path          = path;
 
+   /* Gather candidate cores from the extension index */
+   if (!string_is_empty(path))
+      ext_cores = core_info_list_get_ext_cores(core_info_list,
+            path_get_extension(path));
+   for (i = 0; i < RBUF_LEN(ext_cores); i++)
+      RBUF_PUSH(cores, ext_cores[i]);
+
 #ifdef HAVE_COMPRESSION
    if (path_is_compressed_file(path))
       list = file_archive_get_file_list(path, NULL);
    p_coreinfo->tmp_list = list;
+
+   if (list)
+   {
+      size_t j;
+
+      for (i = 0; i < list->size; i++)
+      {
+         ext_cores = core_info_list_get_ext_cores(core_info_list,
+               path_get_extension(list->elems[i].data));
+         for (j = 0; j < RBUF_LEN(ext_cores); j++)
+            RBUF_PUSH(cores, ext_cores[j]);
+      }
+
+      core_info_sort_core_hashes(cores);
+   }
 #endif
 
+   p_coreinfo->tmp_cores         = cores;
+
    /* Let supported core come first in list so we can return
     * a pointer to them. */
    qsort(core_info_list->list, core_info_list->count,
          sizeof(core_info_t), core_info_qsort_cmp);
 
    for (i = 0; i < core_info_list->count; i++, supported++)
-   {
-      const core_info_t *core = &core_info_list->list[i];
-
-      if (core_info_does_support_file(core, path))
-         continue;
-
-#ifdef HAVE_COMPRESSION
-      if (core_info_does_support_any_file(core, list))
-         continue;
-#endif
-
-      break;
-   }
+      if (!core_info_does_support_tmp_content(p_coreinfo,
+               &core_info_list->list[i]))
+         break;
 
 #ifdef HAVE_COMPRESSION
    if (list)
       string_list_free(list);
+   p_coreinfo->tmp_list  = NULL;
 #endif
+   RBUF_FREE(cores);
+   p_coreinfo->tmp_cores = NULL;
 
    *infos     = core_info_list->list;
    *num_infos = supported;
@@ -2340,11 +2223,16 @@ bool core_info_database_supports_content_path(
    if (p_coreinfo->curr_list)
    {
       size_t i;
+      const uint32_t *ext_cores = core_info_list_get_ext_cores(
+            p_coreinfo->curr_list, path_get_extension(path));
 
       for (i = 0; i < p_coreinfo->curr_list->count; i++)
       {
          const core_info_t *info = &p_coreinfo->curr_list->list[i];
 
+         if (!core_info_has_core_hash(ext_cores, info))
+            continue;
+
          if (!string_list_find_elem(info->supported_extensions_list,
                   path_get_extension(path)))
             continue;
@@ -2421,28 +2309,19 @@ core_updater_info_t *core_info_get_core_updater_info(const char *info_path)
    entry                     = config_get_entry(conf, "display_name");
 
    if (entry && !string_is_empty(entry->value))
-   {
-      info->display_name     = entry->value;
-      entry->value           = NULL;
-   }
+      info->display_name     = strdup(entry->value);
 
    /* > description */
    entry                     = config_get_entry(conf, "description");
 
    if (entry && !string_is_empty(entry->value))
-   {
-      info->description      = entry->value;
-      entry->value           = NULL;
-   }
+      info->description      = strdup(entry->value);
 
    /* > licenses */
    entry                     = config_get_entry(conf, "license");
 
    if (entry && !string_is_empty(entry->value))
-   {
-      info->licenses         = entry->value;
-      entry->value           = NULL;
-   }
+      info->licenses         = strdup(entry->value);
 
    /* Clean up */
    config_file_free(conf);
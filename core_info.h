@@ -88,6 +88,10 @@ typedef struct
    bool supports_no_game;
    bool database_match_archive_member;
    bool is_experimental;
+   /* Content can be switched with retro_unload_game()
+    * and retro_load_game() alone, without retro_deinit()
+    * and reloading the core in between */
+   bool supports_warm_switch;
    bool is_locked;
    bool is_installed;
 } core_info_t;
@@ -106,6 +110,10 @@ typedef struct
 {
    core_info_t *list;
    char *all_ext;
+   /* Hash map of lowercase extension to the sorted
+    * core file id hashes (RBUF) of all cores that
+    * support it */
+   uint32_t **ext_index;
    size_t count;
    size_t info_count;
 } core_info_list_t;
@@ -125,6 +133,7 @@ struct core_info_state
    const struct string_list *tmp_list;
 #endif
    const char *tmp_path;
+   const uint32_t *tmp_cores;
    core_info_t *current;
    core_info_list_t *curr_list;
 };
@@ -0,0 +1,343 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__) && !defined(ANDROID)
+#define CORE_MEMORY_DIRTY_SOFT_DIRTY
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "core_memory_dirty.h"
+#include "verbosity.h"
+
+/* Bit 55 of a /proc/self/pagemap entry, see the kernel's
+ * Documentation/admin-guide/mm/soft-dirty.rst */
+#define PAGEMAP_SOFT_DIRTY (UINT64_C(1) << 55)
+#define PAGEMAP_CHUNK      512
+
+typedef struct core_memory_dirty_region
+{
+   uintptr_t base;
+   size_t pages;
+   /* Epoch each page was last seen written in */
+   uint32_t *epochs;
+} core_memory_dirty_region_t;
+
+typedef struct core_memory_dirty_state
+{
+   core_memory_dirty_region_t *regions;
+   size_t num_regions;
+   size_t page_size;
+   uint32_t epoch;
+   int pagemap_fd;
+   int clear_refs_fd;
+   bool tracking;
+} core_memory_dirty_state_t;
+
+static core_memory_dirty_state_t core_memory_dirty_st = {
+   NULL, 0, 0, 0, -1, -1, false
+};
+
+static int core_memory_dirty_region_cmp(const void *a, const void *b)
+{
+   const core_memory_dirty_region_t *ra = (const core_memory_dirty_region_t*)a;
+   const core_memory_dirty_region_t *rb = (const core_memory_dirty_region_t*)b;
+
+   if (ra->base < rb->base)
+      return -1;
+   return ra->base > rb->base;
+}
+
+#ifdef CORE_MEMORY_DIRTY_SOFT_DIRTY
+/* Resets the soft-dirty bits of the whole process */
+static bool core_memory_dirty_clear(core_memory_dirty_state_t *st)
+{
+   return pwrite(st->clear_refs_fd, "4", 1, 0) == 1;
+}
+
+static bool core_memory_dirty_probe(core_memory_dirty_state_t *st)
+{
+   uint64_t entry         = 0;
+   uint8_t *block         = NULL;
+   volatile uint8_t *page = NULL;
+   bool ret               = false;
+
+   st->pagemap_fd    = open("/proc/self/pagemap", O_RDONLY);
+   st->clear_refs_fd = open("/proc/self/clear_refs", O_WRONLY);
+
+   if (st->pagemap_fd < 0 || st->clear_refs_fd < 0)
+      return false;
+
+   /* Older kernels accept the write but never set the bit */
+   if (!(block = (uint8_t*)calloc(2, st->page_size)))
+      return false;
+
+   page    = (volatile uint8_t*)(((uintptr_t)block + st->page_size - 1)
+         & ~(uintptr_t)(st->page_size - 1));
+   page[0] = 1;
+
+   if (core_memory_dirty_clear(st))
+   {
+      page[0] = 2;
+      if (pread(st->pagemap_fd, &entry, sizeof(entry),
+               ((uintptr_t)page / st->page_size) * sizeof(entry))
+            == sizeof(entry))
+         ret = (entry & PAGEMAP_SOFT_DIRTY) != 0;
+   }
+
+   free(block);
+   return ret;
+}
+
+/* Stamps every page written since the last sync with the
+ * current epoch, then starts a new one */
+static void core_memory_dirty_sync(core_memory_dirty_state_t *st)
+{
+   size_t i;
+   uint64_t entries[PAGEMAP_CHUNK];
+
+   for (i = 0; i < st->num_regions; i++)
+   {
+      size_t page;
+      core_memory_dirty_region_t *region = &st->regions[i];
+
+      for (page = 0; page < region->pages; page += PAGEMAP_CHUNK)
+      {
+         size_t j;
+         size_t count  = region->pages - page;
+         off_t  offset = (off_t)((region->base / st->page_size + page)
+               * sizeof(uint64_t));
+
+         if (count > PAGEMAP_CHUNK)
+            count = PAGEMAP_CHUNK;
+
+         /* Can't tell, so assume it was written */
+         if (pread(st->pagemap_fd, entries, count * sizeof(uint64_t),
+                  offset) != (ssize_t)(count * sizeof(uint64_t)))
+         {
+            for (j = 0; j < count; j++)
+               region->epochs[page + j] = st->epoch;
+            continue;
+         }
+
+         for (j = 0; j < count; j++)
+            if (entries[j] & PAGEMAP_SOFT_DIRTY)
+               region->epochs[page + j] = st->epoch;
+      }
+   }
+
+   if (!core_memory_dirty_clear(st))
+   {
+      RARCH_WARN("[Dirty]: Failed to reset soft-dirty bits, "
+            "reporting all memory as changed.\n");
+      st->tracking = false;
+   }
+
+   st->epoch++;
+}
+#endif
+
+bool core_memory_dirty_init(const rarch_memory_map_t *mmap)
+{
+   unsigned i;
+   size_t count                  = 0;
+   core_memory_dirty_state_t *st = &core_memory_dirty_st;
+
+   core_memory_dirty_deinit();
+
+   if (!mmap || !mmap->num_descriptors)
+      return false;
+
+#ifdef CORE_MEMORY_DIRTY_SOFT_DIRTY
+   st->page_size = (size_t)sysconf(_SC_PAGESIZE);
+#endif
+   if (!st->page_size)
+      st->page_size = 4096;
+
+   if (!(st->regions = (core_memory_dirty_region_t*)calloc(
+               mmap->num_descriptors, sizeof(*st->regions))))
+      return false;
+
+   /* Page ranges of everything the core may write to */
+   for (i = 0; i < mmap->num_descriptors; i++)
+   {
+      uintptr_t start, end;
+      const struct retro_memory_descriptor *desc =
+         &mmap->descriptors[i].core;
+
+      if (!desc->ptr || !desc->len || (desc->flags & RETRO_MEMDESC_CONST))
+         continue;
+
+      start = (uintptr_t)desc->ptr + desc->offset;
+      end   = start + desc->len;
+      start = start & ~(uintptr_t)(st->page_size - 1);
+      end   = (end + st->page_size - 1) & ~(uintptr_t)(st->page_size - 1);
+
+      st->regions[count].base  = start;
+      st->regions[count].pages = (end - start) / st->page_size;
+      count++;
+   }
+
+   /* Mirrors and overlapping descriptors share pages */
+   qsort(st->regions, count, sizeof(*st->regions),
+         core_memory_dirty_region_cmp);
+
+   for (i = 0; i < count; i++)
+   {
+      core_memory_dirty_region_t *last = st->num_regions
+         ? &st->regions[st->num_regions - 1] : NULL;
+      uintptr_t end = st->regions[i].base
+         + st->regions[i].pages * st->page_size;
+
+      if (last && st->regions[i].base <= last->base
+            + last->pages * st->page_size)
+      {
+         if (end > last->base + last->pages * st->page_size)
+            last->pages = (end - last->base) / st->page_size;
+         continue;
+      }
+
+      st->regions[st->num_regions++] = st->regions[i];
+   }
+
+   for (i = 0; i < st->num_regions; i++)
+   {
+      /* Epoch 0, i.e. written before any token was taken */
+      if (!(st->regions[i].epochs = (uint32_t*)calloc(
+                  st->regions[i].pages, sizeof(uint32_t))))
+      {
+         core_memory_dirty_deinit();
+         return false;
+      }
+   }
+
+   return st->num_regions > 0;
+}
+
+void core_memory_dirty_deinit(void)
+{
+   size_t i;
+   core_memory_dirty_state_t *st = &core_memory_dirty_st;
+
+   if (st->regions)
+      for (i = 0; i < st->num_regions; i++)
+         free(st->regions[i].epochs);
+   free(st->regions);
+
+#ifdef CORE_MEMORY_DIRTY_SOFT_DIRTY
+   if (st->pagemap_fd >= 0)
+      close(st->pagemap_fd);
+   if (st->clear_refs_fd >= 0)
+      close(st->clear_refs_fd);
+#endif
+
+   st->regions       = NULL;
+   st->num_regions   = 0;
+   st->epoch         = 0;
+   st->pagemap_fd    = -1;
+   st->clear_refs_fd = -1;
+   st->tracking      = false;
+}
+
+uint32_t core_memory_dirty_token(void)
+{
+   core_memory_dirty_state_t *st = &core_memory_dirty_st;
+
+   if (!st->num_regions)
+      return 0;
+
+   /* Resetting the soft-dirty bits makes the next write to
+    * every page of the process take a minor fault, so this
+    * is only started once somebody asks for it */
+   if (st->epoch == 0)
+   {
+      st->epoch = 1;
+#ifdef CORE_MEMORY_DIRTY_SOFT_DIRTY
+      st->tracking = core_memory_dirty_probe(st)
+         && core_memory_dirty_clear(st);
+#endif
+      RARCH_LOG("[Dirty]: Tracking writes to %u memory regions: %s.\n",
+            (unsigned)st->num_regions,
+            st->tracking ? "soft-dirty bits" : "unavailable");
+      return st->epoch;
+   }
+
+#ifdef CORE_MEMORY_DIRTY_SOFT_DIRTY
+   if (st->tracking)
+      core_memory_dirty_sync(st);
+#endif
+
+   return st->epoch;
+}
+
+size_t core_memory_dirty_changed(uint32_t token,
+      core_memory_dirty_range_t *ranges, size_t max)
+{
+   size_t i;
+   size_t count                  = 0;
+   core_memory_dirty_state_t *st = &core_memory_dirty_st;
+
+#ifdef CORE_MEMORY_DIRTY_SOFT_DIRTY
+   if (st->tracking)
+      core_memory_dirty_sync(st);
+#endif
+
+   for (i = 0; i < st->num_regions; i++)
+   {
+      size_t page;
+      core_memory_dirty_region_t *region = &st->regions[i];
+
+      if (!st->tracking || token == 0)
+      {
+         if (count < max)
+         {
+            ranges[count].ptr = (uint8_t*)region->base;
+            ranges[count].len = region->pages * st->page_size;
+         }
+         count++;
+         continue;
+      }
+
+      for (page = 0; page < region->pages; page++)
+      {
+         size_t run = 0;
+
+         while (     page + run < region->pages
+               && region->epochs[page + run] >= token)
+            run++;
+
+         if (!run)
+            continue;
+
+         if (count < max)
+         {
+            ranges[count].ptr = (uint8_t*)(region->base
+                  + page * st->page_size);
+            ranges[count].len = run * st->page_size;
+         }
+         count++;
+         page += run;
+      }
+   }
+
+   return count;
+}
+
+bool core_memory_dirty_is_tracking(void)
+{
+   return core_memory_dirty_st.tracking;
+}
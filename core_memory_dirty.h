@@ -0,0 +1,70 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CORE_MEMORY_DIRTY_H
+#define __CORE_MEMORY_DIRTY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <retro_common_api.h>
+#include <boolean.h>
+
+#include "core.h"
+
+RETRO_BEGIN_DECLS
+
+/* Tracks which pages of the memory a core exposes through
+ * RETRO_ENVIRONMENT_SET_MEMORY_MAPS have been written to.
+ *
+ * A consumer takes a token with core_memory_dirty_token()
+ * and later asks core_memory_dirty_changed() for the ranges
+ * written since. Tokens from different consumers don't
+ * interfere with each other.
+ *
+ * On Linux the kernel's soft-dirty page bits are used. Where
+ * they are not available every mapped range is reported as
+ * changed, so results are always safe to rely on. */
+
+typedef struct core_memory_dirty_range
+{
+   uint8_t *ptr;
+   size_t len;
+} core_memory_dirty_range_t;
+
+/* Collects the writable ranges of @mmap. Tracking itself
+ * only starts with the first token. */
+bool core_memory_dirty_init(const rarch_memory_map_t *mmap);
+
+void core_memory_dirty_deinit(void);
+
+/* Returns a token to pass to core_memory_dirty_changed().
+ * A token of 0 stands for "since the core was loaded". */
+uint32_t core_memory_dirty_token(void);
+
+/* Fills @ranges with up to @max page aligned ranges written
+ * since @token was taken. Returns the number of ranges there
+ * are, which can be more than @max. Asking again with the same
+ * token reports the same ranges plus whatever was written in
+ * between. */
+size_t core_memory_dirty_changed(uint32_t token,
+      core_memory_dirty_range_t *ranges, size_t max);
+
+/* Returns true if writes are really tracked, rather than
+ * everything being reported as changed. */
+bool core_memory_dirty_is_tracking(void);
+
+RETRO_END_DECLS
+
+#endif
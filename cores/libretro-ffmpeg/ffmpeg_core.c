@@ -109,6 +109,49 @@ static enum AVPixelFormat pix_fmt;
 static bool force_sw_decoder;
 #endif
 
+/* VAAPI surfaces can be handed to the GL context without
+ * a copy: they are exported as DRM PRIME buffers, imported
+ * as EGLImages and converted from YUV on the GPU. */
+#if ENABLE_HW_ACCEL && LIBAVUTIL_VERSION_MAJOR >= 56 && defined(HAVE_EGL) && defined(__linux__) && (defined(HAVE_OPENGL) || defined(HAVE_OPENGLES))
+#define ENABLE_HW_INTEROP 1
+#endif
+
+#ifdef ENABLE_HW_INTEROP
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <libavutil/hwcontext_drm.h>
+#ifdef __cplusplus
+}
+#endif
+
+#ifndef DRM_FORMAT_MOD_INVALID
+#define DRM_FORMAT_MOD_INVALID ((1ULL << 56) - 1)
+#endif
+
+typedef void (*ffmpeg_egl_image_target_texture_t)(GLenum target, void *image);
+
+static bool hw_interop_allowed;
+static volatile bool hw_interop_enabled;
+static bool hw_interop_modifiers;
+static EGLDisplay hw_interop_display;
+static PFNEGLCREATEIMAGEKHRPROC hw_interop_create_image;
+static PFNEGLDESTROYIMAGEKHRPROC hw_interop_destroy_image;
+static ffmpeg_egl_image_target_texture_t hw_interop_image_target;
+static GLuint hw_interop_prog;
+static GLuint hw_interop_fbo;
+static GLuint hw_interop_planes[2];
+static GLint hw_interop_vertex_loc;
+static GLint hw_interop_tex_loc;
+static GLint hw_interop_matrix_loc;
+static GLint hw_interop_offset_loc;
+/* The last surface drawn is kept until the next one is,
+ * so the decoder cannot reuse it while the GPU reads it. */
+static AVFrame *hw_interop_held;
+#endif
+
 #define MAX_STREAMS 8
 static AVCodecContext *actx[MAX_STREAMS];
 static AVCodecContext *sctx[MAX_STREAMS];
@@ -314,6 +357,9 @@ void CORE_PREFIX(retro_set_environment)(retro_environment_t cb)
 #if ENABLE_HW_ACCEL
       { "ffmpeg_hw_decoder", "Use Hardware decoder (restart); off|auto|"
          "cuda|d3d11va|drm|dxva2|mediacodec|opencl|qsv|vaapi|vdpau|videotoolbox" },
+#endif
+#ifdef ENABLE_HW_INTEROP
+      { "ffmpeg_hw_zero_copy", "Zero-copy HW frames (restart); enabled|disabled" },
 #endif
       { "ffmpeg_sw_decoder_threads", "Software decoder thread count (restart); auto|1|2|4|6|8|10|12|14|16" },
 #if defined(HAVE_OPENGL) || defined(HAVE_OPENGLES)
@@ -475,6 +521,15 @@ static void check_variables(bool firststart)
          else if (string_is_equal(hw_var.value, "videotoolbox"))
             hw_decoder = AV_HWDEVICE_TYPE_VIDEOTOOLBOX;
       }
+
+#ifdef ENABLE_HW_INTEROP
+      hw_var.key         = "ffmpeg_hw_zero_copy";
+      hw_var.value       = NULL;
+      hw_interop_allowed = true;
+
+      if (CORE_PREFIX(environ_cb)(RETRO_ENVIRONMENT_GET_VARIABLE, &hw_var) && hw_var.value)
+         hw_interop_allowed = !string_is_equal(hw_var.value, "disabled");
+#endif
    }
 #endif
 
@@ -604,6 +659,252 @@ static void seek_frame(int seek_frames)
    slock_unlock(fifo_lock);
 }
 
+#ifdef ENABLE_HW_INTEROP
+#ifndef EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT
+#define EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT 0x3443
+#define EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT 0x3444
+#define EGL_DMA_BUF_PLANE1_MODIFIER_LO_EXT 0x3445
+#define EGL_DMA_BUF_PLANE1_MODIFIER_HI_EXT 0x3446
+#define EGL_DMA_BUF_PLANE2_MODIFIER_LO_EXT 0x3447
+#define EGL_DMA_BUF_PLANE2_MODIFIER_HI_EXT 0x3448
+#endif
+
+static void hw_interop_release(void)
+{
+   if (hw_interop_held)
+      av_frame_free(&hw_interop_held);
+}
+
+/* Y'CbCr to RGB matrix (column major) and the offsets to
+ * subtract first, picked the same way as set_colorspace(). */
+static void hw_interop_yuv_matrix(AVFrame *frame,
+      GLfloat *matrix, GLfloat *offset)
+{
+   float kr, kb, kg, y_scale, c_scale;
+   enum AVColorSpace space = colorspace;
+   bool full_range         = av_frame_get_color_range(frame) == AVCOL_RANGE_JPEG;
+
+   if (space == AVCOL_SPC_UNSPECIFIED)
+   {
+      if (av_frame_get_colorspace(frame) != AVCOL_SPC_UNSPECIFIED)
+         space = av_frame_get_colorspace(frame);
+      else if (media.width >= 1280 || media.height > 576)
+         space = AVCOL_SPC_BT709;
+      else
+         space = AVCOL_SPC_BT470BG;
+   }
+
+   switch (space)
+   {
+      case AVCOL_SPC_BT709:
+         kr = 0.2126f;
+         kb = 0.0722f;
+         break;
+      case AVCOL_SPC_FCC:
+         kr = 0.30f;
+         kb = 0.11f;
+         break;
+      case AVCOL_SPC_SMPTE240M:
+         kr = 0.212f;
+         kb = 0.087f;
+         break;
+      case AVCOL_SPC_BT2020_NCL:
+      case AVCOL_SPC_BT2020_CL:
+         kr = 0.2627f;
+         kb = 0.0593f;
+         break;
+      default:
+         kr = 0.299f;
+         kb = 0.114f;
+         break;
+   }
+
+   kg        = 1.0f - kr - kb;
+   y_scale   = full_range ? 1.0f : 255.0f / 219.0f;
+   c_scale   = full_range ? 1.0f : 255.0f / 224.0f;
+
+   offset[0] = full_range ? 0.0f : 16.0f / 255.0f;
+   offset[1] = 128.0f / 255.0f;
+   offset[2] = 128.0f / 255.0f;
+
+   /* Y */
+   matrix[0] = y_scale;
+   matrix[1] = y_scale;
+   matrix[2] = y_scale;
+   /* Cb */
+   matrix[3] = 0.0f;
+   matrix[4] = -c_scale * 2.0f * kb * (1.0f - kb) / kg;
+   matrix[5] = c_scale * 2.0f * (1.0f - kb);
+   /* Cr */
+   matrix[6] = c_scale * 2.0f * (1.0f - kr);
+   matrix[7] = -c_scale * 2.0f * kr * (1.0f - kr) / kg;
+   matrix[8] = 0.0f;
+}
+
+static EGLImageKHR hw_interop_import_layer(const AVDRMFrameDescriptor *desc,
+      unsigned index, unsigned width, unsigned height)
+{
+   static const EGLint plane_attribs[3][5] = {
+      { EGL_DMA_BUF_PLANE0_FD_EXT, EGL_DMA_BUF_PLANE0_OFFSET_EXT,
+        EGL_DMA_BUF_PLANE0_PITCH_EXT, EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT,
+        EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT },
+      { EGL_DMA_BUF_PLANE1_FD_EXT, EGL_DMA_BUF_PLANE1_OFFSET_EXT,
+        EGL_DMA_BUF_PLANE1_PITCH_EXT, EGL_DMA_BUF_PLANE1_MODIFIER_LO_EXT,
+        EGL_DMA_BUF_PLANE1_MODIFIER_HI_EXT },
+      { EGL_DMA_BUF_PLANE2_FD_EXT, EGL_DMA_BUF_PLANE2_OFFSET_EXT,
+        EGL_DMA_BUF_PLANE2_PITCH_EXT, EGL_DMA_BUF_PLANE2_MODIFIER_LO_EXT,
+        EGL_DMA_BUF_PLANE2_MODIFIER_HI_EXT },
+   };
+   int i;
+   EGLint attribs[7 + 3 * 10 + 1];
+   unsigned n                        = 0;
+   const AVDRMLayerDescriptor *layer = &desc->layers[index];
+
+   if (layer->nb_planes < 1 || layer->nb_planes > 3)
+      return EGL_NO_IMAGE_KHR;
+
+   attribs[n++] = EGL_LINUX_DRM_FOURCC_EXT;
+   attribs[n++] = (EGLint)layer->format;
+   attribs[n++] = EGL_WIDTH;
+   attribs[n++] = (EGLint)width;
+   attribs[n++] = EGL_HEIGHT;
+   attribs[n++] = (EGLint)height;
+
+   for (i = 0; i < layer->nb_planes; i++)
+   {
+      const AVDRMPlaneDescriptor *plane = &layer->planes[i];
+      const AVDRMObjectDescriptor *obj  = &desc->objects[plane->object_index];
+
+      attribs[n++] = plane_attribs[i][0];
+      attribs[n++] = obj->fd;
+      attribs[n++] = plane_attribs[i][1];
+      attribs[n++] = (EGLint)plane->offset;
+      attribs[n++] = plane_attribs[i][2];
+      attribs[n++] = (EGLint)plane->pitch;
+
+      if (hw_interop_modifiers && obj->format_modifier != DRM_FORMAT_MOD_INVALID)
+      {
+         attribs[n++] = plane_attribs[i][3];
+         attribs[n++] = (EGLint)(obj->format_modifier & 0xffffffff);
+         attribs[n++] = plane_attribs[i][4];
+         attribs[n++] = (EGLint)(obj->format_modifier >> 32);
+      }
+   }
+
+   attribs[n++] = EGL_NONE;
+
+   return hw_interop_create_image(hw_interop_display, EGL_NO_CONTEXT,
+         EGL_LINUX_DMA_BUF_EXT, NULL, attribs);
+}
+
+/* Converts a VAAPI surface into 'tex' on the GPU. On failure
+ * the frame is dropped and later frames go through RAM. */
+static void hw_interop_render(AVFrame *source, GLuint tex)
+{
+   unsigned i;
+   GLfloat matrix[9];
+   GLfloat offset[3];
+   EGLImageKHR images[2]            = { EGL_NO_IMAGE_KHR, EGL_NO_IMAGE_KHR };
+   const AVDRMFrameDescriptor *desc = NULL;
+   AVFrame *mapped                  = av_frame_alloc();
+   bool ok                          = false;
+
+   /* The context went away since the frame was decoded */
+   if (!hw_interop_enabled)
+   {
+      av_frame_free(&mapped);
+      av_frame_unref(source);
+      return;
+   }
+
+   if (!mapped)
+      goto end;
+
+   mapped->format = AV_PIX_FMT_DRM_PRIME;
+   if (av_hwframe_map(mapped, source, AV_HWFRAME_MAP_READ) < 0)
+      goto end;
+
+   /* Luma and chroma are exported as separate layers */
+   desc = (const AVDRMFrameDescriptor*)mapped->data[0];
+   if (desc->nb_layers != 2)
+      goto end;
+
+   for (i = 0; i < 2; i++)
+   {
+      images[i] = hw_interop_import_layer(desc, i,
+            (source->width  + i) >> i,
+            (source->height + i) >> i);
+      if (images[i] == EGL_NO_IMAGE_KHR)
+         goto end;
+
+      glBindTexture(GL_TEXTURE_2D, hw_interop_planes[i]);
+      hw_interop_image_target(GL_TEXTURE_2D, images[i]);
+   }
+
+   glBindTexture(GL_TEXTURE_2D, tex);
+   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
+         media.width, media.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+   glBindTexture(GL_TEXTURE_2D, 0);
+
+   glBindFramebuffer(GL_FRAMEBUFFER, hw_interop_fbo);
+   glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+         GL_TEXTURE_2D, tex, 0);
+   glViewport(0, 0, media.width, media.height);
+   glUseProgram(hw_interop_prog);
+
+   hw_interop_yuv_matrix(source, matrix, offset);
+   glUniformMatrix3fv(hw_interop_matrix_loc, 1, GL_FALSE, matrix);
+   glUniform3fv(hw_interop_offset_loc, 1, offset);
+   glActiveTexture(GL_TEXTURE1);
+   glBindTexture(GL_TEXTURE_2D, hw_interop_planes[1]);
+   glActiveTexture(GL_TEXTURE0);
+   glBindTexture(GL_TEXTURE_2D, hw_interop_planes[0]);
+
+   glBindBuffer(GL_ARRAY_BUFFER, vbo);
+   glVertexAttribPointer(hw_interop_vertex_loc, 2, GL_FLOAT, GL_FALSE,
+         4 * sizeof(GLfloat), (const GLvoid*)(0 * sizeof(GLfloat)));
+   glVertexAttribPointer(hw_interop_tex_loc, 2, GL_FLOAT, GL_FALSE,
+         4 * sizeof(GLfloat), (const GLvoid*)(2 * sizeof(GLfloat)));
+   glEnableVertexAttribArray(hw_interop_vertex_loc);
+   glEnableVertexAttribArray(hw_interop_tex_loc);
+   glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+   glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+   glDisableVertexAttribArray(hw_interop_vertex_loc);
+   glDisableVertexAttribArray(hw_interop_tex_loc);
+
+   glUseProgram(0);
+   glActiveTexture(GL_TEXTURE1);
+   glBindTexture(GL_TEXTURE_2D, 0);
+   glActiveTexture(GL_TEXTURE0);
+   glBindTexture(GL_TEXTURE_2D, 0);
+   glBindFramebuffer(GL_FRAMEBUFFER, 0);
+   ok = true;
+
+end:
+   /* The textures keep the buffers alive */
+   for (i = 0; i < 2; i++)
+      if (images[i] != EGL_NO_IMAGE_KHR)
+         hw_interop_destroy_image(hw_interop_display, images[i]);
+   av_frame_free(&mapped);
+
+   if (ok)
+   {
+      hw_interop_release();
+      if ((hw_interop_held = av_frame_alloc()))
+         av_frame_move_ref(hw_interop_held, source);
+   }
+   else
+   {
+      log_cb(RETRO_LOG_ERROR, "[FFMPEG] Failed to import HW frame, "
+            "falling back to copying frames.\n");
+      hw_interop_enabled = false;
+   }
+
+   av_frame_unref(source);
+}
+#endif
+
 void CORE_PREFIX(retro_run)(void)
 {
    static bool last_left;
@@ -832,6 +1133,17 @@ void CORE_PREFIX(retro_run)(void)
                video_buffer_get_finished_slot(video_buffer, &ctx);
                pts                          = ctx->pts;
 
+#ifdef ENABLE_HW_INTEROP
+               /* Zero-copy frames still hold their surface */
+               if (ctx->source->format == AV_PIX_FMT_VAAPI)
+               {
+                  hw_interop_render(ctx->source, frames[1].tex);
+                  video_buffer_open_slot(video_buffer, ctx);
+                  frames[1].pts = av_q2d(fctx->streams[video_stream_index]->time_base) * pts;
+                  continue;
+               }
+#endif
+
 #ifdef HAVE_OPENGLES
                data                         = video_frame_temp_buffer;
 #else
@@ -1045,7 +1357,15 @@ exit:
          decoder_pix_fmt = AV_PIX_FMT_NONE;
       }
       else
+      {
          ctx->hw_device_ctx = av_buffer_ref(hw_device_ctx);
+#if defined(ENABLE_HW_INTEROP) && LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(58, 29, 100)
+         /* Zero-copy frames keep their surface while they wait in
+          * the video buffer, plus the one held by the GL side. */
+         if (hw_interop_allowed)
+            ctx->extra_hw_frames = 4 + 1;
+#endif
+      }
    }
 
    return decoder_pix_fmt;
@@ -1557,6 +1877,24 @@ static void decode_video(AVCodecContext *ctx, AVPacket *pkt, size_t frame_size)
          goto end;
       }
 
+#ifdef ENABLE_HW_INTEROP
+      /* The GL side imports the surface itself, no copy to
+       * RAM and no sws_scale. Subtitles are still blended
+       * on the CPU, so they keep the copying path. */
+      if (     hw_decoding_enabled
+            && hw_interop_enabled
+            && decoder_ctx->source->format == AV_PIX_FMT_VAAPI
+#ifdef HAVE_SSA
+            && !ass_track_active
+#endif
+         )
+      {
+         decoder_ctx->pts = decoder_ctx->source->best_effort_timestamp;
+         video_buffer_finish_slot(video_buffer, decoder_ctx);
+         continue;
+      }
+#endif
+
 #if ENABLE_HW_ACCEL
       if (hw_decoding_enabled)
          /* Copy data from VRAM to RAM */
@@ -1932,6 +2270,12 @@ static void decode_thread(void *data)
 #if defined(HAVE_OPENGL) || defined(HAVE_OPENGLES)
 static void context_destroy(void)
 {
+#ifdef ENABLE_HW_INTEROP
+   /* Frames decoded from now on are copied until the
+    * new context is set up. */
+   hw_interop_enabled = false;
+   hw_interop_release();
+#endif
 #ifdef HAVE_GL_FFT
    if (fft)
    {
@@ -1952,6 +2296,88 @@ static void context_destroy(void)
 #include "gl_shaders/ffmpeg.glsl.frag.h"
 #endif
 
+#ifdef ENABLE_HW_INTEROP
+#ifdef HAVE_OPENGLES
+#include "gl_shaders/ffmpeg_yuv_es.glsl.frag.h"
+#else
+#include "gl_shaders/ffmpeg_yuv.glsl.frag.h"
+#endif
+
+static void hw_interop_init(void)
+{
+   unsigned i;
+   GLuint vert, frag;
+   const char *extensions = NULL;
+
+   hw_interop_enabled     = false;
+
+   if (!hw_interop_allowed)
+      return;
+
+   /* Only EGL contexts can import dma-bufs */
+   hw_interop_display     = eglGetCurrentDisplay();
+   if (hw_interop_display == EGL_NO_DISPLAY)
+      return;
+
+   extensions             = eglQueryString(hw_interop_display, EGL_EXTENSIONS);
+   if (!extensions || !strstr(extensions, "EGL_EXT_image_dma_buf_import"))
+      return;
+
+   hw_interop_modifiers     = strstr(extensions,
+         "EGL_EXT_image_dma_buf_import_modifiers") != NULL;
+   hw_interop_create_image  = (PFNEGLCREATEIMAGEKHRPROC)
+      eglGetProcAddress("eglCreateImageKHR");
+   hw_interop_destroy_image = (PFNEGLDESTROYIMAGEKHRPROC)
+      eglGetProcAddress("eglDestroyImageKHR");
+   hw_interop_image_target  = (ffmpeg_egl_image_target_texture_t)
+      hw_render.get_proc_address("glEGLImageTargetTexture2DOES");
+
+   if (     !hw_interop_create_image
+         || !hw_interop_destroy_image
+         || !hw_interop_image_target)
+      return;
+
+   hw_interop_prog = glCreateProgram();
+   vert            = glCreateShader(GL_VERTEX_SHADER);
+   frag            = glCreateShader(GL_FRAGMENT_SHADER);
+
+   glShaderSource(vert, 1, &vertex_source, NULL);
+   glShaderSource(frag, 1, &yuv_fragment_source, NULL);
+   glCompileShader(vert);
+   glCompileShader(frag);
+   glAttachShader(hw_interop_prog, vert);
+   glAttachShader(hw_interop_prog, frag);
+   glLinkProgram(hw_interop_prog);
+
+   glUseProgram(hw_interop_prog);
+
+   glUniform1i(glGetUniformLocation(hw_interop_prog, "sLuma"), 0);
+   glUniform1i(glGetUniformLocation(hw_interop_prog, "sChroma"), 1);
+   hw_interop_vertex_loc = glGetAttribLocation(hw_interop_prog, "aVertex");
+   hw_interop_tex_loc    = glGetAttribLocation(hw_interop_prog, "aTexCoord");
+   hw_interop_matrix_loc = glGetUniformLocation(hw_interop_prog, "uYuvMatrix");
+   hw_interop_offset_loc = glGetUniformLocation(hw_interop_prog, "uYuvOffset");
+
+   glUseProgram(0);
+
+   glGenTextures(2, hw_interop_planes);
+   for (i = 0; i < 2; i++)
+   {
+      glBindTexture(GL_TEXTURE_2D, hw_interop_planes[i]);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+   }
+   glBindTexture(GL_TEXTURE_2D, 0);
+
+   glGenFramebuffers(1, &hw_interop_fbo);
+
+   hw_interop_enabled = true;
+   log_cb(RETRO_LOG_INFO, "[FFMPEG] Zero-copy HW frames enabled.\n");
+}
+#endif
+
 static void context_reset(void)
 {
    static const GLfloat vertex_data[] = {
@@ -2024,6 +2450,10 @@ static void context_reset(void)
 
    glBindBuffer(GL_ARRAY_BUFFER, 0);
    glBindTexture(GL_TEXTURE_2D, 0);
+
+#ifdef ENABLE_HW_INTEROP
+   hw_interop_init();
+#endif
 }
 #endif
 
@@ -2087,6 +2517,10 @@ void CORE_PREFIX(retro_unload_game)(void)
       actx[i] = NULL;
    }
 
+#ifdef ENABLE_HW_INTEROP
+   hw_interop_release();
+#endif
+
    if (vctx)
    {
       avcodec_close(vctx);
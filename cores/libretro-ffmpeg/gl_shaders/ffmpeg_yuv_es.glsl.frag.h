@@ -0,0 +1,14 @@
+#include "shaders_common.h"
+
+static const char *yuv_fragment_source = GLSL(
+      varying vec2 vTex;
+      uniform sampler2D sLuma;
+      uniform sampler2D sChroma;
+      uniform mat3 uYuvMatrix;
+      uniform vec3 uYuvOffset;
+
+      void main() {
+         vec3 yuv = vec3(texture2D(sLuma, vTex).r, texture2D(sChroma, vTex).rg) - uYuvOffset;
+         gl_FragColor = vec4((uYuvMatrix * yuv).bgr, 1.0);
+      }
+);
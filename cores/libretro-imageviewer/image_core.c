@@ -5,13 +5,19 @@
 #include <assert.h>
 
 #include <boolean.h>
+#include <retro_miscellaneous.h>
 #include <lists/dir_list.h>
 #include <file/file_path.h>
 #include <compat/strl.h>
+#include <string/stdstring.h>
 #include <retro_environment.h>
 
 #include <streams/file_stream.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #if defined(HAVE_RPNG) || defined(HAVE_RJPEG) || defined(HAVE_RTGA) || defined(HAVE_RBMP)
 #define PREFER_NON_STB_IMAGE
 #endif
@@ -53,17 +59,40 @@ static retro_input_state_t IMAGE_CORE_PREFIX(input_state_cb);
 static retro_audio_sample_batch_t IMAGE_CORE_PREFIX(audio_batch_cb);
 static retro_environment_t IMAGE_CORE_PREFIX(environ_cb);
 
+/* Decoded images: the one on screen, the one navigated to
+ * and its two neighbours, which are decoded ahead of time. */
+#define IMAGE_CACHE_SIZE 4
+
+struct imageviewer_image
+{
+   uint32_t *pixels; /* XRGB8888, NULL if decoding failed */
+   int index;        /* in image_file_list, -1 if the slot is free */
+   int width;
+   int height;
+};
+
 static bool      process_new_image;
 static uint32_t* image_buffer;
-#ifndef STB_IMAGE_IMPLEMENTATION
-static struct texture_image image_texture;
-#endif
 static int       image_width;
 static int       image_height;
 static bool      image_uploaded;
 static bool      slideshow_enable;
+static bool      image_supports_rgba;
 static struct string_list *image_file_list;
 
+/* Everything below is shared with the decode thread */
+static struct imageviewer_image image_cache[IMAGE_CACHE_SIZE];
+static int       image_wanted;
+static int       image_shown;
+static unsigned  image_max_width;
+static unsigned  image_max_height;
+#ifdef HAVE_THREADS
+static sthread_t *image_thread;
+static slock_t   *image_lock;
+static scond_t   *image_cond;
+static bool      image_thread_quit;
+#endif
+
 #if 0
 #define DUPE_TEST
 #endif
@@ -127,28 +156,34 @@ static void imageviewer_reset(void)
    image_height = 0;
 }
 
+static void imageviewer_free_image(void)
+{
+   unsigned i;
+
+   for (i = 0; i < IMAGE_CACHE_SIZE; i++)
+   {
+      if (image_cache[i].pixels)
+         free(image_cache[i].pixels);
+      image_cache[i].pixels = NULL;
+      image_cache[i].index  = -1;
+   }
+
+   image_buffer = NULL;
+   image_shown  = -1;
+}
+
 void IMAGE_CORE_PREFIX(retro_init)(void)
 {
    struct retro_log_callback log;
 
+   imageviewer_free_image();
+
    if (IMAGE_CORE_PREFIX(environ_cb)(RETRO_ENVIRONMENT_GET_LOG_INTERFACE, &log))
       IMAGE_CORE_PREFIX(log_cb) = log.log;
    else
       IMAGE_CORE_PREFIX(log_cb) = NULL;
 
    imageviewer_reset();
-
-}
-
-static void imageviewer_free_image(void)
-{
-#ifdef STB_IMAGE_IMPLEMENTATION
-   if (image_buffer)
-      free(image_buffer);
-#else
-   image_texture_free(&image_texture);
-#endif
-   image_buffer = NULL;
 }
 
 void IMAGE_CORE_PREFIX(retro_deinit)(void)
@@ -160,6 +195,7 @@ void IMAGE_CORE_PREFIX(retro_deinit)(void)
 void IMAGE_CORE_PREFIX(retro_set_environment)(retro_environment_t cb)
 {
    static const struct retro_variable vars[] = {
+      { "imageviewer_max_size", "Downscale larger images to; native|1280x720|1920x1080|2560x1440|3840x2160" },
       { NULL, NULL },
    };
 #ifndef RARCH_INTERNAL
@@ -237,54 +273,356 @@ void IMAGE_CORE_PREFIX(retro_cheat_set)(unsigned a, bool b, const char * c)
 {
 }
 
-static bool imageviewer_load(const char *path, int image_index)
+/* Averages factor x factor blocks, so the result never gets
+ * smaller than the requested size. */
+static uint32_t *imageviewer_downscale(uint32_t *src,
+      int *width, int *height, unsigned max_width, unsigned max_height)
+{
+   int x, y, i, j;
+   uint32_t *dst, *out;
+   int factor = 1;
+   int w      = *width;
+   int h      = *height;
+
+   if (max_width && max_height)
+      factor = MIN(w / (int)max_width, h / (int)max_height);
+   if (factor < 2)
+      return src;
+
+   if (!(dst = (uint32_t*)malloc((w / factor) * (h / factor) * sizeof(uint32_t))))
+      return src;
+
+   out = dst;
+   for (y = 0; y + factor <= h; y += factor)
+   {
+      for (x = 0; x + factor <= w; x += factor)
+      {
+         uint32_t r = 0, g = 0, b = 0;
+
+         for (j = 0; j < factor; j++)
+         {
+            const uint32_t *row = src + (y + j) * w + x;
+            for (i = 0; i < factor; i++)
+            {
+               r += (row[i] >> 16) & 0xff;
+               g += (row[i] >>  8) & 0xff;
+               b += (row[i] >>  0) & 0xff;
+            }
+         }
+
+         r /= factor * factor;
+         g /= factor * factor;
+         b /= factor * factor;
+         *out++ = r << 16 | g << 8 | b;
+      }
+   }
+
+   free(src);
+   *width  = w / factor;
+   *height = h / factor;
+   return dst;
+}
+
+/* Decodes to XRGB8888. Touches no shared state, so it is safe
+ * to run on the decode thread. */
+static bool imageviewer_decode(const char *path,
+      struct imageviewer_image *image, unsigned max_width, unsigned max_height)
 {
 #ifdef STB_IMAGE_IMPLEMENTATION
-   int comp;
+   int comp, x, y;
    RFILE* f;
-   size_t len;
+   int64_t len;
    void* buf;
-#endif
-#ifdef RARCH_INTERNAL
-   extern bool video_driver_supports_rgba(void);
+   uint32_t *pixels;
+#else
+   struct texture_image texture;
 #endif
 
-   imageviewer_free_image();
+   image->pixels = NULL;
+   image->width  = 0;
+   image->height = 0;
 
 #ifdef STB_IMAGE_IMPLEMENTATION
    f = filestream_open(path, RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+   if (!f)
+      return false;
    len = filestream_get_size(f);
    buf = malloc(len);
+   if (!buf)
+   {
+      filestream_close(f);
+      return false;
+   }
    filestream_read(f, buf, len);
    filestream_close(f);
 
-   image_buffer           = (uint32_t*)stbi_load_from_memory(
-         buf, len,
-         &image_width, &image_height,
+   image->pixels          = (uint32_t*)stbi_load_from_memory(
+         buf, (int)len,
+         &image->width, &image->height,
          &comp, 4);
    free(buf);
+
+   if (!image->pixels)
+      return false;
+
+   /* RGBA > XRGB8888 */
+   pixels = image->pixels;
+   for (y = 0; y < image->height; y++)
+   {
+      for (x = 0; x < image->width; x++, pixels++)
+      {
+         uint32_t pixel = *pixels;
+         uint32_t a = pixel >> 24;
+
+         if (a == 255)
+            *pixels = (pixel & 0x0000ff00) | ((pixel << 16) & 0x00ff0000) | ((pixel >> 16) & 0x000000ff);
+         else
+         {
+            uint32_t r = pixel & 0x0000ff;
+            uint32_t g = (pixel & 0x00ff00) >> 8;
+            uint32_t b = (pixel & 0xff0000) >> 16;
+            uint32_t bg = ((x & 8) ^ (y & 8)) ? 0x66 : 0x99;
+
+            r = a * r / 255 + (255 - a) * bg / 255;
+            g = a * g / 255 + (255 - a) * bg / 255;
+            b = a * b / 255 + (255 - a) * bg / 255;
+
+            *pixels = r << 16 | g << 8 | b;
+         }
+      }
+   }
 #else
-#ifdef RARCH_INTERNAL
-   image_texture.supports_rgba = video_driver_supports_rgba();
-#endif
-   if (!image_texture_load(&image_texture, path))
+   memset(&texture, 0, sizeof(texture));
+   texture.supports_rgba = image_supports_rgba;
+   if (!image_texture_load(&texture, path))
       return false;
-   image_buffer = (uint32_t*)image_texture.pixels;
-   image_width  = image_texture.width;
-   image_height = image_texture.height;
+   image->pixels = texture.pixels;
+   image->width  = texture.width;
+   image->height = texture.height;
 #endif
-   if (!image_buffer)
-      return false;
 
-   process_new_image = true;
+   image->pixels = imageviewer_downscale(image->pixels,
+         &image->width, &image->height, max_width, max_height);
 
-   return true;
+   return image->pixels != NULL;
+}
+
+static struct imageviewer_image *imageviewer_cache_find(int index)
+{
+   unsigned i;
+
+   for (i = 0; i < IMAGE_CACHE_SIZE; i++)
+      if (image_cache[i].index == index)
+         return &image_cache[i];
+
+   return NULL;
+}
+
+/* Next image worth decoding: the wanted one, then what
+ * comes after it, then what comes before it. */
+static int imageviewer_cache_missing(void)
+{
+   unsigned i;
+   int candidates[3];
+
+   if (!image_file_list)
+      return -1;
+
+   candidates[0] = image_wanted;
+   candidates[1] = image_wanted + 1;
+   candidates[2] = image_wanted - 1;
+
+   for (i = 0; i < 3; i++)
+   {
+      if (     candidates[i] < 0
+            || candidates[i] >= (int)image_file_list->size)
+         continue;
+      if (!imageviewer_cache_find(candidates[i]))
+         return candidates[i];
+   }
+
+   return -1;
+}
+
+/* Replaces the image furthest from the wanted one,
+ * never the one on screen. */
+static void imageviewer_cache_insert(struct imageviewer_image *image)
+{
+   unsigned i;
+   struct imageviewer_image *slot = NULL;
+   int distance                   = -1;
+
+   for (i = 0; i < IMAGE_CACHE_SIZE; i++)
+   {
+      int d;
+
+      if (image_cache[i].index == image_shown && image_shown != -1)
+         continue;
+      if (image_cache[i].index == -1)
+      {
+         slot = &image_cache[i];
+         break;
+      }
+
+      d = abs(image_cache[i].index - image_wanted);
+      if (d > distance)
+      {
+         distance = d;
+         slot     = &image_cache[i];
+      }
+   }
+
+   if (!slot)
+   {
+      free(image->pixels);
+      return;
+   }
+
+   if (slot->pixels)
+      free(slot->pixels);
+   *slot = *image;
+}
+
+#ifdef HAVE_THREADS
+static void imageviewer_thread(void *data)
+{
+   slock_lock(image_lock);
+
+   while (!image_thread_quit)
+   {
+      char path[PATH_MAX_LENGTH];
+      struct imageviewer_image image;
+      unsigned max_width, max_height;
+      int index = imageviewer_cache_missing();
+
+      if (index < 0)
+      {
+         scond_wait(image_cond, image_lock);
+         continue;
+      }
+
+      strlcpy(path, image_file_list->elems[index].data, sizeof(path));
+      max_width  = image_max_width;
+      max_height = image_max_height;
+      slock_unlock(image_lock);
+
+      /* Failures are cached too, so they aren't retried */
+      imageviewer_decode(path, &image, max_width, max_height);
+      image.index = index;
+
+      slock_lock(image_lock);
+      imageviewer_cache_insert(&image);
+   }
+
+   slock_unlock(image_lock);
+}
+#endif
+
+static void imageviewer_check_variables(void)
+{
+   struct retro_variable var = { "imageviewer_max_size", NULL };
+   unsigned max_width        = 0;
+   unsigned max_height       = 0;
+
+   if (     IMAGE_CORE_PREFIX(environ_cb)(RETRO_ENVIRONMENT_GET_VARIABLE, &var)
+         && var.value
+         && sscanf(var.value, "%ux%u", &max_width, &max_height) != 2)
+   {
+      max_width  = 0;
+      max_height = 0;
+   }
+
+#ifdef HAVE_THREADS
+   if (image_lock)
+      slock_lock(image_lock);
+#endif
+   if (max_width != image_max_width || max_height != image_max_height)
+   {
+      unsigned i;
+
+      image_max_width  = max_width;
+      image_max_height = max_height;
+
+      /* Decode what isn't on screen again at the new size */
+      for (i = 0; i < IMAGE_CACHE_SIZE; i++)
+      {
+         if (image_cache[i].index == image_shown)
+            continue;
+         if (image_cache[i].pixels)
+            free(image_cache[i].pixels);
+         image_cache[i].pixels = NULL;
+         image_cache[i].index  = -1;
+      }
+   }
+#ifdef HAVE_THREADS
+   if (image_lock)
+   {
+      scond_signal(image_cond);
+      slock_unlock(image_lock);
+   }
+#endif
+}
+
+/* Switches to the wanted image once it has been decoded,
+ * the current one stays up meanwhile. */
+static bool imageviewer_load(int image_index)
+{
+   struct imageviewer_image *image;
+
+#ifdef HAVE_THREADS
+   if (image_lock)
+   {
+      slock_lock(image_lock);
+      if (image_wanted != image_index)
+      {
+         image_wanted = image_index;
+         scond_signal(image_cond);
+      }
+   }
+   else
+#endif
+   {
+      image_wanted = image_index;
+      if (!imageviewer_cache_find(image_index))
+      {
+         struct imageviewer_image decoded;
+
+         imageviewer_decode(image_file_list->elems[image_index].data,
+               &decoded, image_max_width, image_max_height);
+         decoded.index = image_index;
+         imageviewer_cache_insert(&decoded);
+      }
+   }
+
+   if (image_shown != image_index && (image = imageviewer_cache_find(image_index)))
+   {
+      image_shown       = image_index;
+      image_buffer      = image->pixels;
+      image_width       = image->width;
+      image_height      = image->height;
+      process_new_image = true;
+   }
+
+#ifdef HAVE_THREADS
+   if (image_lock)
+      slock_unlock(image_lock);
+#endif
+
+   return image_shown != image_index || image_buffer;
 }
 
 bool IMAGE_CORE_PREFIX(retro_load_game)(const struct retro_game_info *info)
 {
    enum retro_pixel_format fmt = RETRO_PIXEL_FORMAT_XRGB8888;
    char *dir                   = strdup(info->path);
+   int image_index             = 0;
+   struct imageviewer_image image;
+   unsigned i;
+#ifdef RARCH_INTERNAL
+   extern bool video_driver_supports_rgba(void);
+
+   image_supports_rgba         = video_driver_supports_rgba();
+#endif
 
    slideshow_enable            = false;
 
@@ -292,8 +630,10 @@ bool IMAGE_CORE_PREFIX(retro_load_game)(const struct retro_game_info *info)
 
    image_file_list = dir_list_new(dir, IMAGE_CORE_PREFIX(valid_extensions),
          false,true,false,false);
-   dir_list_sort(image_file_list, false);
    free(dir);
+   if (!image_file_list)
+      return false;
+   dir_list_sort(image_file_list, false);
 
    if (!IMAGE_CORE_PREFIX(environ_cb)(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &fmt))
    {
@@ -302,8 +642,37 @@ bool IMAGE_CORE_PREFIX(retro_load_game)(const struct retro_game_info *info)
       return false;
    }
 
-   if (!imageviewer_load(info->path, 0))
+   imageviewer_check_variables();
+
+   /* Navigation starts from the loaded image */
+   for (i = 0; i < image_file_list->size; i++)
+   {
+      if (string_is_equal(image_file_list->elems[i].data, info->path))
+      {
+         image_index = i;
+         break;
+      }
+   }
+
+   /* The first image is decoded right away */
+   if (!imageviewer_decode(info->path, &image, image_max_width, image_max_height))
       return false;
+   image.index  = image_index;
+   imageviewer_cache_insert(&image);
+
+   image_wanted = image_index;
+   image_shown  = image_index;
+   image_buffer = image.pixels;
+   image_width  = image.width;
+   image_height = image.height;
+   process_new_image = true;
+
+#ifdef HAVE_THREADS
+   image_thread_quit = false;
+   image_lock        = slock_new();
+   image_cond        = scond_new();
+   image_thread      = sthread_create(imageviewer_thread, NULL);
+#endif
 
    return true;
 }
@@ -315,9 +684,31 @@ bool IMAGE_CORE_PREFIX(retro_load_game_special)(unsigned a, const struct retro_g
 
 void IMAGE_CORE_PREFIX(retro_unload_game)(void)
 {
+#ifdef HAVE_THREADS
+   if (image_thread)
+   {
+      slock_lock(image_lock);
+      image_thread_quit = true;
+      scond_signal(image_cond);
+      slock_unlock(image_lock);
+      sthread_join(image_thread);
+      image_thread = NULL;
+   }
+   if (image_cond)
+      scond_free(image_cond);
+   if (image_lock)
+      slock_free(image_lock);
+   image_cond = NULL;
+   image_lock = NULL;
+#endif
+
    imageviewer_free_image();
    image_width  = 0;
    image_height = 0;
+
+   if (image_file_list)
+      dir_list_free(image_file_list);
+   image_file_list = NULL;
 }
 
 unsigned IMAGE_CORE_PREFIX(retro_get_region)(void)
@@ -344,13 +735,17 @@ void IMAGE_CORE_PREFIX(retro_run)(void)
    bool load_image        = false;
    bool next_image        = false;
    bool prev_image        = false;
+   bool updated           = false;
    static int frames      = 0;
-   static int image_index = 0;
+   int image_index        = image_wanted;
    uint16_t input         = 0;
    static uint16_t previnput;
    uint16_t realinput     = 0;
    int i;
 
+   if (IMAGE_CORE_PREFIX(environ_cb)(RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE, &updated) && updated)
+      imageviewer_check_variables();
+
    IMAGE_CORE_PREFIX(input_poll_cb)();
 
    if (slideshow_enable)
@@ -431,9 +826,10 @@ void IMAGE_CORE_PREFIX(retro_run)(void)
       load_image  = true;
    }
 
-   if (load_image)
+   /* Also picks up an image the decode thread just finished */
+   if (load_image || image_shown != image_index)
    {
-      if (!imageviewer_load(image_file_list->elems[image_index].data, image_index))
+      if (!imageviewer_load(image_index))
       {
          IMAGE_CORE_PREFIX(environ_cb)(RETRO_ENVIRONMENT_SHUTDOWN, NULL);
       }
@@ -441,39 +837,8 @@ void IMAGE_CORE_PREFIX(retro_run)(void)
 
    if (process_new_image)
    {
-      /* RGBA > XRGB8888 */
       struct retro_system_av_info info;
 
-#ifdef STB_IMAGE_IMPLEMENTATION
-      int x, y;
-      uint32_t *buf = &image_buffer[0];
-
-      for (y = 0; y < image_height; y++)
-      {
-         for (x = 0; x < image_width; x++, buf++)
-         {
-            uint32_t pixel = *buf;
-            uint32_t a = pixel >> 24;
-
-            if (a == 255)
-               *buf = (pixel & 0x0000ff00) | ((pixel << 16) & 0x00ff0000) | ((pixel >> 16) & 0x000000ff);
-            else
-            {
-               uint32_t r = pixel & 0x0000ff;
-               uint32_t g = (pixel & 0x00ff00) >> 8;
-               uint32_t b = (pixel & 0xff0000) >> 16;
-               uint32_t bg = ((x & 8) ^ (y & 8)) ? 0x66 : 0x99;
-
-               r = a * r / 255 + (255 - a) * bg / 255;
-               g = a * g / 255 + (255 - a) * bg / 255;
-               b = a * b / 255 + (255 - a) * bg / 255;
-
-               *buf = r << 16 | g << 8 | b;
-            }
-         }
-      }
-#endif
-
       IMAGE_CORE_PREFIX(retro_get_system_av_info)(&info);
 
       IMAGE_CORE_PREFIX(environ_cb)(RETRO_ENVIRONMENT_SET_GEOMETRY, &info.geometry);
@@ -26,7 +26,7 @@
 
 #define LIBRARY_NAME		"V4L2"
 #define LIBRARY_VERSION		"0.0.2"
-#define VIDEO_BUFFERS_MAX   2
+#define VIDEO_BUFFERS_MAX   4
 #define AUDIO_SAMPLE_RATE	48000
 #define AUDIO_BUFSIZE		64
 #define ENVVAR_BUFLEN		1024
@@ -38,6 +38,8 @@
 #include <sys/mman.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -64,10 +66,20 @@
 
 #include <string/stdstring.h>
 
+#if defined(HAVE_OPENGL) || defined(HAVE_OPENGLES)
+#define VIDEOPROC_HAVE_GL
+#include <glsym/glsym.h>
+#ifdef HAVE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+#endif
+
 struct v4l2_capbuf
 {
    void   *start;
    size_t   len;
+   int      fd; /* exported DMABUF, -1 if none */
 };
 
 /*
@@ -94,6 +106,9 @@ static uint32_t video_out_height;
 static char     video_capture_mode[ENVVAR_BUFLEN];
 static char     video_output_mode[ENVVAR_BUFLEN];
 static char     video_frame_times[ENVVAR_BUFLEN];
+static char     video_capture_queue[ENVVAR_BUFLEN];
+static bool     video_low_latency;
+static bool     video_reloading;
 
 static uint8_t  *frame_cap;
 static uint32_t *frame_out;
@@ -103,6 +118,42 @@ static uint32_t *frame_prev2;
 static uint32_t *frame_prev3;
 static uint32_t *frame_curr;
 
+#ifdef VIDEOPROC_HAVE_GL
+/*
+ * GPU path: YUYV capture buffers are sampled straight from the
+ * capture card's memory (DMABUF) or uploaded as is, then converted
+ * and deinterlaced by a shader into the frontend's framebuffer.
+ */
+#ifdef HAVE_EGL
+typedef void (*videoproc_image_target_texture_t)(GLenum, GLeglImageOES);
+#endif
+
+static struct retro_hw_render_callback videoproc_hw_render;
+static bool   videoproc_gl_hw;      /* frontend accepted SET_HW_RENDER */
+static bool   videoproc_gl_context; /* GL context is alive */
+static bool   videoproc_gl_active;  /* current capture goes through the GPU */
+static bool   videoproc_gl_native;  /* YUYV comes straight from the driver */
+static bool   videoproc_gl_imported;
+static int    videoproc_gl_held = -1; /* buffer the GPU may still read */
+static GLuint videoproc_gl_prog;
+static GLuint videoproc_gl_vbo;
+static GLuint videoproc_gl_tex[VIDEO_BUFFERS_MAX];
+static GLint  videoproc_gl_vertex_loc;
+static GLint  videoproc_gl_tex_size_loc;
+static GLint  videoproc_gl_rgb_loc;
+static GLint  videoproc_gl_field_scale_loc;
+static GLint  videoproc_gl_parity_loc;
+static GLint  videoproc_gl_stride_loc;
+static GLint  videoproc_gl_field_lines_loc;
+#ifdef HAVE_EGL
+static EGLDisplay videoproc_gl_display = EGL_NO_DISPLAY;
+static EGLImageKHR videoproc_gl_image[VIDEO_BUFFERS_MAX];
+static PFNEGLCREATEIMAGEKHRPROC videoproc_gl_create_image;
+static PFNEGLDESTROYIMAGEKHRPROC videoproc_gl_destroy_image;
+static videoproc_image_target_texture_t videoproc_gl_image_target;
+#endif
+#endif
+
 /* Frametime debug messages */
 struct timeval ft_prevtime = { 0 }, ft_prevtime2 = { 0 };
 char *ft_info = NULL, *ft_info2 = NULL;
@@ -278,6 +329,10 @@ RETRO_API void VIDEOPROC_CORE_PREFIX(retro_set_environment)(retro_environment_t
       { "videoproc_capture_mode", "Capture mode; alternate|interlaced|top|bottom|alternate_hack" },
       { "videoproc_output_mode","Output mode; progressive|deinterlaced|interlaced" },
       { "videoproc_frame_times","Print frame times to terminal (v4l2 only); Off|On" },
+      { "videoproc_capture_queue", "Capture queue (v4l2 only); default|low_latency" },
+#ifdef VIDEOPROC_HAVE_GL
+      { "videoproc_gpu", "GPU conversion and deinterlacing (restart); disabled|enabled" },
+#endif
       { NULL, NULL }
    };
 
@@ -582,6 +637,62 @@ void v4l2_frame_times(struct v4l2_buffer buf) {
    ft_prevtime2 = buf.timestamp;
 }
 
+/* Dequeues a filled buffer. In low latency mode, any newer buffer
+ * already waiting replaces it, so we never show a stale frame.
+ */
+static int v4l2_dequeue_latest(struct v4l2_buffer *buf)
+{
+   struct pollfd pfd;
+   struct v4l2_buffer next;
+   int error;
+
+   memset(buf, 0, sizeof(*buf));
+   buf->type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+   buf->memory = V4L2_MEMORY_MMAP;
+   error       = v4l2_ioctl(video_device_fd, VIDIOC_DQBUF, buf);
+   if (error != 0 || !video_low_latency)
+      return error;
+
+   pfd.fd     = video_device_fd;
+   pfd.events = POLLIN;
+   while (poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN))
+   {
+      memset(&next, 0, sizeof(next));
+      next.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+      next.memory = V4L2_MEMORY_MMAP;
+      if (v4l2_ioctl(video_device_fd, VIDIOC_DQBUF, &next) != 0)
+         break;
+      /* Hand the stale one straight back to the driver */
+      v4l2_ioctl(video_device_fd, VIDIOC_QBUF, buf);
+      *buf = next;
+   }
+
+   return 0;
+}
+
+static bool v4l2_has_format(uint32_t pixelformat, bool *native)
+{
+   struct v4l2_fmtdesc desc;
+   uint32_t index;
+
+   for (index = 0; ; index++)
+   {
+      memset(&desc, 0, sizeof(desc));
+      desc.index = index;
+      desc.type  = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+      if (v4l2_ioctl(video_device_fd, VIDIOC_ENUM_FMT, &desc) != 0)
+         break;
+      if (desc.pixelformat == pixelformat)
+      {
+         /* libv4l2 converts emulated formats in its own buffers */
+         *native = !(desc.flags & V4L2_FMT_FLAG_EMULATED);
+         return true;
+      }
+   }
+
+   return false;
+}
+
 void source_dummy(int width, int height) {
    int i, triangpos, triangpos_t=0, triangpos_b=0, offset=0;
    bool field_ahead = false;
@@ -641,10 +752,7 @@ void source_v4l2_normal(int width, int height) {
    int error;
 
    /* Wait until v4l2 dequees a buffer */
-   memset(&video_buf, 0, sizeof(struct v4l2_buffer));
-   video_buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-   video_buf.memory = V4L2_MEMORY_MMAP;
-   error = v4l2_ioctl(video_device_fd, VIDIOC_DQBUF, &video_buf);
+   error = v4l2_dequeue_latest(&video_buf);
    if (error != 0)
    {
       printf("VIDIOC_DQBUF failed: %s\n", strerror(errno));
@@ -875,6 +983,358 @@ void processing_bgr_xrgb(uint8_t *src, uint32_t *dst, int width, int height) {
    }
 }
 
+#ifdef VIDEOPROC_HAVE_GL
+#ifdef HAVE_OPENGLES
+#define VIDEOPROC_GLSL_PRECISION \
+   "#ifdef GL_FRAGMENT_PRECISION_HIGH\n" \
+   "precision highp float;\n" \
+   "#else\n" \
+   "precision mediump float;\n" \
+   "#endif\n"
+#else
+#define VIDEOPROC_GLSL_PRECISION ""
+#endif
+
+/* DRM_FORMAT_ABGR8888, bytes R, G, B, A in memory */
+#define VIDEOPROC_DRM_FORMAT_ABGR8888 \
+   ((uint32_t)'A' | ((uint32_t)'B' << 8) | ((uint32_t)'2' << 16) | ((uint32_t)'4' << 24))
+
+static const char *videoproc_vertex_source =
+   "attribute vec2 aVertex;\n"
+   "void main() { gl_Position = vec4(aVertex, 0.0, 1.0); }\n";
+
+/* Packed YUYV is sampled as RGBA texels holding two pixels each
+ * (r = Y0, g = U, b = Y1, a = V), or an XRGB8888 frame as is.
+ * Output line l shows field line (l - parity) / field_scale,
+ * interpolated between the two nearest lines of the field (bob).
+ */
+static const char *videoproc_fragment_source =
+   VIDEOPROC_GLSL_PRECISION
+   "uniform sampler2D sTex;\n"
+   "uniform vec2 uTexSize;\n"
+   "uniform float uRgb;\n"
+   "uniform float uFieldScale;\n"
+   "uniform float uParity;\n"
+   "uniform float uStride;\n"
+   "uniform float uFieldLines;\n"
+   "vec3 fetch(float x, float line) {\n"
+   "   float row = line * uStride + uParity * (uStride - 1.0);\n"
+   "   vec4 c;\n"
+   "   float y;\n"
+   "   if (uRgb > 0.5)\n"
+   "      return texture2D(sTex, vec2((x + 0.5) / uTexSize.x, (row + 0.5) / uTexSize.y)).bgr;\n"
+   "   c = texture2D(sTex, vec2((floor(x * 0.5) + 0.5) / uTexSize.x, (row + 0.5) / uTexSize.y));\n"
+   "   y = 1.164 * (mix(c.r, c.b, mod(x, 2.0)) - 0.0625);\n"
+   "   return vec3(y + 1.596 * (c.a - 0.5),\n"
+   "               y - 0.392 * (c.g - 0.5) - 0.813 * (c.a - 0.5),\n"
+   "               y + 2.017 * (c.g - 0.5));\n"
+   "}\n"
+   "void main() {\n"
+   "   float x  = floor(gl_FragCoord.x);\n"
+   "   float f  = clamp((floor(gl_FragCoord.y) - uParity) / uFieldScale, 0.0, uFieldLines - 1.0);\n"
+   "   float f0 = floor(f);\n"
+   "   float f1 = min(f0 + 1.0, uFieldLines - 1.0);\n"
+   "   gl_FragColor = vec4(mix(fetch(x, f0), fetch(x, f1), f - f0), 1.0);\n"
+   "}\n";
+
+static void videoproc_gl_release_buffers(void)
+{
+#ifdef HAVE_EGL
+   unsigned i;
+
+   for (i = 0; i < VIDEO_BUFFERS_MAX; i++)
+   {
+      if (videoproc_gl_image[i] != EGL_NO_IMAGE_KHR)
+         videoproc_gl_destroy_image(videoproc_gl_display, videoproc_gl_image[i]);
+      videoproc_gl_image[i] = EGL_NO_IMAGE_KHR;
+   }
+#endif
+   videoproc_gl_imported = false;
+}
+
+/* Binds every capture buffer to its texture through EGL, so frames
+ * never touch the CPU. Falls back to uploading the mapped buffers.
+ */
+static void videoproc_gl_import_buffers(void)
+{
+#ifdef HAVE_EGL
+   size_t i;
+   EGLint pitch  = video_format.fmt.pix.bytesperline;
+#endif
+
+   videoproc_gl_release_buffers();
+
+   if (!videoproc_gl_active)
+      return;
+
+#ifdef HAVE_EGL
+   if (     videoproc_gl_native
+         && videoproc_gl_display != EGL_NO_DISPLAY
+         && videoproc_gl_create_image
+         && videoproc_gl_destroy_image
+         && videoproc_gl_image_target)
+   {
+      for (i = 0; i < v4l2_ncapbuf; i++)
+      {
+         EGLint attribs[] = {
+            EGL_WIDTH,                     pitch / 4,
+            EGL_HEIGHT,                    (EGLint)video_format.fmt.pix.height,
+            EGL_LINUX_DRM_FOURCC_EXT,      (EGLint)VIDEOPROC_DRM_FORMAT_ABGR8888,
+            EGL_DMA_BUF_PLANE0_FD_EXT,     v4l2_capbuf[i].fd,
+            EGL_DMA_BUF_PLANE0_OFFSET_EXT, 0,
+            EGL_DMA_BUF_PLANE0_PITCH_EXT,  pitch,
+            EGL_NONE
+         };
+
+         if (v4l2_capbuf[i].fd < 0)
+            break;
+
+         videoproc_gl_image[i] = videoproc_gl_create_image(videoproc_gl_display,
+               EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, NULL, attribs);
+         if (videoproc_gl_image[i] == EGL_NO_IMAGE_KHR)
+            break;
+
+         glBindTexture(GL_TEXTURE_2D, videoproc_gl_tex[i]);
+         videoproc_gl_image_target(GL_TEXTURE_2D, videoproc_gl_image[i]);
+      }
+      glBindTexture(GL_TEXTURE_2D, 0);
+
+      if (i == v4l2_ncapbuf)
+      {
+         videoproc_gl_imported = true;
+         printf("Sampling %" PRI_SIZET " DMABUF capture buffers directly\n", v4l2_ncapbuf);
+         return;
+      }
+
+      videoproc_gl_release_buffers();
+   }
+#endif
+
+   printf("Capture buffers can't be imported, uploading them instead\n");
+}
+
+static void videoproc_gl_context_destroy(void)
+{
+   videoproc_gl_release_buffers();
+   videoproc_gl_context = false;
+   videoproc_gl_prog    = 0;
+   videoproc_gl_vbo     = 0;
+   memset(videoproc_gl_tex, 0, sizeof(videoproc_gl_tex));
+}
+
+static void videoproc_gl_context_reset(void)
+{
+   static const GLfloat vertex_data[] = {
+      -1, -1,
+       1, -1,
+      -1,  1,
+       1,  1,
+   };
+   GLuint vert, frag;
+   GLint status = GL_FALSE;
+   unsigned i;
+
+   rglgen_resolve_symbols(videoproc_hw_render.get_proc_address);
+
+   videoproc_gl_prog = glCreateProgram();
+   vert              = glCreateShader(GL_VERTEX_SHADER);
+   frag              = glCreateShader(GL_FRAGMENT_SHADER);
+
+   glShaderSource(vert, 1, &videoproc_vertex_source, NULL);
+   glShaderSource(frag, 1, &videoproc_fragment_source, NULL);
+   glCompileShader(vert);
+   glCompileShader(frag);
+   glAttachShader(videoproc_gl_prog, vert);
+   glAttachShader(videoproc_gl_prog, frag);
+   glLinkProgram(videoproc_gl_prog);
+   glDeleteShader(vert);
+   glDeleteShader(frag);
+
+   glGetProgramiv(videoproc_gl_prog, GL_LINK_STATUS, &status);
+   if (status != GL_TRUE)
+      printf("Couldn't link the conversion shader\n");
+
+   glUseProgram(videoproc_gl_prog);
+
+   glUniform1i(glGetUniformLocation(videoproc_gl_prog, "sTex"), 0);
+   videoproc_gl_vertex_loc      = glGetAttribLocation(videoproc_gl_prog, "aVertex");
+   videoproc_gl_tex_size_loc    = glGetUniformLocation(videoproc_gl_prog, "uTexSize");
+   videoproc_gl_rgb_loc         = glGetUniformLocation(videoproc_gl_prog, "uRgb");
+   videoproc_gl_field_scale_loc = glGetUniformLocation(videoproc_gl_prog, "uFieldScale");
+   videoproc_gl_parity_loc      = glGetUniformLocation(videoproc_gl_prog, "uParity");
+   videoproc_gl_stride_loc      = glGetUniformLocation(videoproc_gl_prog, "uStride");
+   videoproc_gl_field_lines_loc = glGetUniformLocation(videoproc_gl_prog, "uFieldLines");
+
+   glUseProgram(0);
+
+   glGenTextures(VIDEO_BUFFERS_MAX, videoproc_gl_tex);
+   for (i = 0; i < VIDEO_BUFFERS_MAX; i++)
+   {
+      glBindTexture(GL_TEXTURE_2D, videoproc_gl_tex[i]);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+   }
+   glBindTexture(GL_TEXTURE_2D, 0);
+
+   glGenBuffers(1, &videoproc_gl_vbo);
+   glBindBuffer(GL_ARRAY_BUFFER, videoproc_gl_vbo);
+   glBufferData(GL_ARRAY_BUFFER, sizeof(vertex_data), vertex_data, GL_STATIC_DRAW);
+   glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+#ifdef HAVE_EGL
+   /* Only EGL contexts can import DMABUFs */
+   videoproc_gl_display = eglGetCurrentDisplay();
+   if (videoproc_gl_display != EGL_NO_DISPLAY)
+   {
+      const char *extensions = eglQueryString(videoproc_gl_display, EGL_EXTENSIONS);
+
+      if (extensions && strstr(extensions, "EGL_EXT_image_dma_buf_import"))
+      {
+         videoproc_gl_create_image  = (PFNEGLCREATEIMAGEKHRPROC)
+            eglGetProcAddress("eglCreateImageKHR");
+         videoproc_gl_destroy_image = (PFNEGLDESTROYIMAGEKHRPROC)
+            eglGetProcAddress("eglDestroyImageKHR");
+         videoproc_gl_image_target  = (videoproc_image_target_texture_t)
+            videoproc_hw_render.get_proc_address("glEGLImageTargetTexture2DOES");
+      }
+   }
+#endif
+
+   videoproc_gl_context = true;
+   videoproc_gl_import_buffers();
+}
+
+static void videoproc_gl_draw(GLuint tex, unsigned tex_width, unsigned tex_height,
+      bool rgb, float field_scale, float parity, float stride, float field_lines,
+      unsigned width, unsigned height)
+{
+   glBindFramebuffer(GL_FRAMEBUFFER, videoproc_hw_render.get_current_framebuffer());
+   glViewport(0, 0, width, height);
+
+   glUseProgram(videoproc_gl_prog);
+   glUniform2f(videoproc_gl_tex_size_loc, (GLfloat)tex_width, (GLfloat)tex_height);
+   glUniform1f(videoproc_gl_rgb_loc, rgb ? 1.0f : 0.0f);
+   glUniform1f(videoproc_gl_field_scale_loc, field_scale);
+   glUniform1f(videoproc_gl_parity_loc, parity);
+   glUniform1f(videoproc_gl_stride_loc, stride);
+   glUniform1f(videoproc_gl_field_lines_loc, field_lines);
+
+   glActiveTexture(GL_TEXTURE0);
+   glBindTexture(GL_TEXTURE_2D, tex);
+
+   glBindBuffer(GL_ARRAY_BUFFER, videoproc_gl_vbo);
+   glEnableVertexAttribArray(videoproc_gl_vertex_loc);
+   glVertexAttribPointer(videoproc_gl_vertex_loc, 2, GL_FLOAT, GL_FALSE, 0, NULL);
+
+   glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+   glDisableVertexAttribArray(videoproc_gl_vertex_loc);
+   glBindBuffer(GL_ARRAY_BUFFER, 0);
+   glBindTexture(GL_TEXTURE_2D, 0);
+   glUseProgram(0);
+
+   VIDEOPROC_CORE_PREFIX(video_refresh_cb)(RETRO_HW_FRAME_BUFFER_VALID,
+         width, height, 0);
+}
+
+void source_v4l2_gl(int width, int height) {
+   struct v4l2_buffer held;
+   int error;
+
+   error = v4l2_dequeue_latest(&video_buf);
+   if (error != 0)
+   {
+      /* Keep showing the buffer we still hold */
+      printf("VIDIOC_DQBUF failed: %s\n", strerror(errno));
+      return;
+   }
+
+   /* The previous buffer has been drawn a frame ago, the GPU is done with it */
+   if (videoproc_gl_held >= 0 && videoproc_gl_held != (int)video_buf.index)
+   {
+      memset(&held, 0, sizeof(held));
+      held.index  = videoproc_gl_held;
+      held.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+      held.memory = V4L2_MEMORY_MMAP;
+      error = v4l2_ioctl(video_device_fd, VIDIOC_QBUF, &held);
+      if (error != 0)
+         printf("VIDIOC_QBUF failed: %s\n", strerror(errno));
+   }
+   videoproc_gl_held = video_buf.index;
+
+   v4l2_frame_times(video_buf);
+}
+
+/* Same output as the CPU path: deinterlaced output bobs each field
+ * to full height, other modes show the buffer as captured.
+ */
+static void processing_gl(void)
+{
+   unsigned tex_width = video_format.fmt.pix.bytesperline / 4;
+   float field_scale  = (float)video_out_height / (float)video_cap_height;
+   float parity       = 0.0f;
+   float stride       = 1.0f;
+   float field_lines  = (float)video_cap_height;
+   int index          = videoproc_gl_held;
+
+   if (!videoproc_gl_context || index < 0)
+   {
+      VIDEOPROC_CORE_PREFIX(video_refresh_cb)(NULL, 0, 0, 0);
+      return;
+   }
+
+   if (!videoproc_gl_imported)
+   {
+      glBindTexture(GL_TEXTURE_2D, videoproc_gl_tex[index]);
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tex_width, video_cap_height, 0,
+            GL_RGBA, GL_UNSIGNED_BYTE, v4l2_capbuf[index].start);
+   }
+
+   if (strcmp(video_output_mode, "deinterlaced") == 0) {
+      if (strcmp(video_capture_mode, "interlaced") == 0) {
+         /* Both fields are in the buffer, one per retro_run call */
+         parity      = (video_half_feed_rate == 0) ? 0.0f : 1.0f;
+         stride      = 2.0f;
+         field_lines = (float)(video_cap_height / 2);
+         field_scale = 2.0f;
+      } else if (video_buf.field == V4L2_FIELD_BOTTOM) {
+         parity      = 1.0f;
+      }
+   }
+
+   videoproc_gl_draw(videoproc_gl_tex[index], tex_width, video_cap_height,
+         false, field_scale, parity, stride, field_lines,
+         video_cap_width, video_out_height);
+}
+#endif
+
+static void video_output(uint32_t *frame, unsigned width, unsigned height)
+{
+#ifdef VIDEOPROC_HAVE_GL
+   /* Software frames are ignored once a GL context is in use */
+   if (videoproc_gl_hw)
+   {
+      if (!videoproc_gl_context)
+      {
+         VIDEOPROC_CORE_PREFIX(video_refresh_cb)(NULL, 0, 0, 0);
+         return;
+      }
+
+      glBindTexture(GL_TEXTURE_2D, videoproc_gl_tex[0]);
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0,
+            GL_RGBA, GL_UNSIGNED_BYTE, frame);
+      videoproc_gl_draw(videoproc_gl_tex[0], width, height,
+            true, 1.0f, 0.0f, 1.0f, (float)height, width, height);
+      return;
+   }
+#endif
+
+   VIDEOPROC_CORE_PREFIX(video_refresh_cb)(frame, width,
+      height, width * sizeof(uint32_t));
+}
+
 RETRO_API void VIDEOPROC_CORE_PREFIX(retro_run)(void)
 {
    uint32_t *aux;
@@ -883,6 +1343,7 @@ RETRO_API void VIDEOPROC_CORE_PREFIX(retro_run)(void)
    struct retro_variable capturemode = { "videoproc_capture_mode", NULL };
    struct retro_variable outputmode  = { "videoproc_output_mode", NULL };
    struct retro_variable frametimes  = { "videoproc_frame_times", NULL };
+   struct retro_variable queue       = { "videoproc_capture_queue", NULL };
    bool updated = false;
 
    if (VIDEOPROC_CORE_PREFIX(environment_cb)(RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE, &updated) && updated) {
@@ -891,16 +1352,21 @@ RETRO_API void VIDEOPROC_CORE_PREFIX(retro_run)(void)
       VIDEOPROC_CORE_PREFIX(environment_cb)(RETRO_ENVIRONMENT_GET_VARIABLE, &capturemode);
       VIDEOPROC_CORE_PREFIX(environment_cb)(RETRO_ENVIRONMENT_GET_VARIABLE, &outputmode);
       VIDEOPROC_CORE_PREFIX(environment_cb)(RETRO_ENVIRONMENT_GET_VARIABLE, &frametimes);
+      VIDEOPROC_CORE_PREFIX(environment_cb)(RETRO_ENVIRONMENT_GET_VARIABLE, &queue);
       /* Video or Audio device(s) has(ve) been changed
        * TODO We may get away without reseting devices when changing output mode...
        */
       if ((videodev.value    && (strcmp(video_device, videodev.value) != 0)) ||\
           (audiodev.value    && (strcmp(audio_device, audiodev.value) != 0)) ||\
           (capturemode.value && (strcmp(video_capture_mode, capturemode.value) != 0)) ||\
-          (outputmode.value  && (strcmp(video_output_mode,  outputmode.value)  != 0))) {
+          (outputmode.value  && (strcmp(video_output_mode,  outputmode.value)  != 0)) ||\
+          (queue.value       && (strcmp(video_capture_queue, queue.value)      != 0))) {
+          /* Keeps the hardware context we already have */
+          video_reloading = true;
           VIDEOPROC_CORE_PREFIX(retro_unload_game)();
           /* This core does not cares for the retro_game_info * argument? */
           VIDEOPROC_CORE_PREFIX(retro_load_game)(NULL);
+          video_reloading = false;
       }
 
       if (frametimes.value != NULL) {
@@ -923,6 +1389,10 @@ RETRO_API void VIDEOPROC_CORE_PREFIX(retro_run)(void)
          if (strcmp(video_capture_mode, "alternate_hack") == 0) {
             source_v4l2_alternate_hack(video_cap_width, video_cap_height);
             processing_heal(frame_cap, video_cap_width, video_cap_height);
+#ifdef VIDEOPROC_HAVE_GL
+         } else if (videoproc_gl_active) {
+            source_v4l2_gl(video_cap_width, video_cap_height);
+#endif
          } else {
             source_v4l2_normal(video_cap_width, video_cap_height);
          }
@@ -934,6 +1404,13 @@ RETRO_API void VIDEOPROC_CORE_PREFIX(retro_run)(void)
       video_half_feed_rate = 0;
    }
 
+#ifdef VIDEOPROC_HAVE_GL
+   if (videoproc_gl_active) {
+      processing_gl();
+      return;
+   }
+#endif
+
    /* Converts from bgr to xrgb, deinterlacing, final copy to the outpuit buffer (frame_out)
     * Every frame except frame_cap shall be encoded in xrgb
     * Every frame except frame_out shall have the same height
@@ -963,8 +1440,7 @@ RETRO_API void VIDEOPROC_CORE_PREFIX(retro_run)(void)
       frame_prev1 = frame_curr;
       frame_curr = aux;
 
-      VIDEOPROC_CORE_PREFIX(video_refresh_cb)(frame_out, video_cap_width,
-         video_out_height, video_cap_width * sizeof(uint32_t));
+      video_output(frame_out, video_cap_width, video_out_height);
    } else if (strcmp(video_capture_mode, "alternate_hack") == 0) {
       /* Case where alternate_hack without deinterlacing would not generate previous frame for processing_heal */
       processing_bgr_xrgb(frame_cap, frame_curr, video_cap_width, video_cap_height);
@@ -977,15 +1453,13 @@ RETRO_API void VIDEOPROC_CORE_PREFIX(retro_run)(void)
       aux = frame_out;
       frame_out = frame_curr;
 
-      VIDEOPROC_CORE_PREFIX(video_refresh_cb)(frame_out, video_cap_width,
-         video_out_height, video_cap_width * sizeof(uint32_t));
+      video_output(frame_out, video_cap_width, video_out_height);
 
       frame_out = aux;
    } else {
       processing_bgr_xrgb(frame_cap, frame_out, video_cap_width, video_out_height);
 
-      VIDEOPROC_CORE_PREFIX(video_refresh_cb)(frame_out, video_cap_width,
-         video_out_height, video_cap_width * sizeof(uint32_t));
+      video_output(frame_out, video_cap_width, video_out_height);
    }
 }
 
@@ -1034,6 +1508,7 @@ RETRO_API bool VIDEOPROC_CORE_PREFIX(retro_load_game)(const struct retro_game_in
    struct retro_variable capture_mode = { "videoproc_capture_mode", NULL };
    struct retro_variable output_mode  = { "videoproc_output_mode", NULL };
    struct retro_variable frame_times  = { "videoproc_frame_times", NULL };
+   struct retro_variable queue        = { "videoproc_capture_queue", NULL };
    enum retro_pixel_format pixel_format;
    struct v4l2_standard std;
    struct v4l2_requestbuffers reqbufs;
@@ -1088,6 +1563,35 @@ RETRO_API bool VIDEOPROC_CORE_PREFIX(retro_load_game)(const struct retro_game_in
       strncpy(video_frame_times, frame_times.value, ENVVAR_BUFLEN-1);
    }
 
+   VIDEOPROC_CORE_PREFIX(environment_cb)(RETRO_ENVIRONMENT_GET_VARIABLE, &queue);
+   if (queue.value != NULL) {
+      strncpy(video_capture_queue, queue.value, ENVVAR_BUFLEN-1);
+   }
+   video_low_latency = strcmp(video_capture_queue, "low_latency") == 0;
+
+#ifdef VIDEOPROC_HAVE_GL
+   /* The context has to be requested here, reloads from retro_run keep it */
+   if (!video_reloading) {
+      struct retro_variable gpu = { "videoproc_gpu", NULL };
+
+      videoproc_gl_hw = false;
+      VIDEOPROC_CORE_PREFIX(environment_cb)(RETRO_ENVIRONMENT_GET_VARIABLE, &gpu);
+      if (gpu.value && strcmp(gpu.value, "enabled") == 0) {
+         memset(&videoproc_hw_render, 0, sizeof(videoproc_hw_render));
+#ifdef HAVE_OPENGLES
+         videoproc_hw_render.context_type    = RETRO_HW_CONTEXT_OPENGLES2;
+#else
+         videoproc_hw_render.context_type    = RETRO_HW_CONTEXT_OPENGL;
+#endif
+         videoproc_hw_render.context_reset   = videoproc_gl_context_reset;
+         videoproc_hw_render.context_destroy = videoproc_gl_context_destroy;
+         videoproc_gl_hw = VIDEOPROC_CORE_PREFIX(environment_cb)(RETRO_ENVIRONMENT_SET_HW_RENDER, &videoproc_hw_render);
+         if (!videoproc_gl_hw)
+            printf("Cannot initialize HW render, converting on the CPU\n");
+      }
+   }
+#endif
+
    if (strcmp(video_device, "dummy") == 0) {
       if (strcmp(video_capture_mode, "interlaced") == 0) {
           video_format.fmt.pix.height = 480;
@@ -1118,6 +1622,14 @@ RETRO_API bool VIDEOPROC_CORE_PREFIX(retro_load_game)(const struct retro_game_in
       }
 
       fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_BGR24;
+#ifdef VIDEOPROC_HAVE_GL
+      /* The GPU path takes YUYV, which most capture cards produce natively */
+      videoproc_gl_active = videoproc_gl_hw &&
+         strcmp(video_capture_mode, "alternate_hack") != 0 &&
+         v4l2_has_format(V4L2_PIX_FMT_YUYV, &videoproc_gl_native);
+      if (videoproc_gl_active)
+         fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_YUYV;
+#endif
       fmt.fmt.pix.colorspace = V4L2_COLORSPACE_REC709;
       fmt.fmt.pix.colorspace = V4L2_COLORSPACE_SRGB;
       fmt.fmt.pix.quantization = V4L2_QUANTIZATION_LIM_RANGE;
@@ -1157,6 +1669,43 @@ RETRO_API bool VIDEOPROC_CORE_PREFIX(retro_load_game)(const struct retro_game_in
          return false;
       }
 
+#ifdef VIDEOPROC_HAVE_GL
+      if (videoproc_gl_active && fmt.fmt.pix.pixelformat != V4L2_PIX_FMT_YUYV)
+      {
+         printf("Device refused YUYV, converting on the CPU\n");
+         videoproc_gl_active     = false;
+         fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_BGR24;
+         error = v4l2_ioctl(video_device_fd, VIDIOC_S_FMT, &fmt);
+         if (error != 0)
+         {
+            printf("VIDIOC_S_FMT failed: %s\n", strerror(errno));
+            return false;
+         }
+      }
+
+      /* One buffer stays with the GPU until the next frame is drawn */
+      if (videoproc_gl_active)
+         v4l2_ncapbuf_target++;
+#endif
+
+      /* Ask for the fewest buffers the driver can work with */
+      if (video_low_latency && strcmp(video_capture_mode, "alternate_hack") != 0)
+      {
+         struct v4l2_control ctrl;
+
+         memset(&ctrl, 0, sizeof(ctrl));
+         ctrl.id = V4L2_CID_MIN_BUFFERS_FOR_CAPTURE;
+         if (v4l2_ioctl(video_device_fd, VIDIOC_G_CTRL, &ctrl) == 0 && ctrl.value > 0)
+            v4l2_ncapbuf_target = MIN(ctrl.value, VIDEO_BUFFERS_MAX - 1);
+         else
+            v4l2_ncapbuf_target = 1;
+#ifdef VIDEOPROC_HAVE_GL
+         if (videoproc_gl_active)
+            v4l2_ncapbuf_target++;
+#endif
+         printf("Low latency capture, asking for %u buffers\n", (unsigned)v4l2_ncapbuf_target);
+      }
+
       error = v4l2_ioctl(video_device_fd, VIDIOC_G_STD, &std_id);
       if (error != 0)
       {
@@ -1197,7 +1746,7 @@ RETRO_API bool VIDEOPROC_CORE_PREFIX(retro_load_game)(const struct retro_game_in
          printf("VIDIOC_REQBUFS failed: %s\n", strerror(errno));
          return false;
       }
-      v4l2_ncapbuf = reqbufs.count;
+      v4l2_ncapbuf = MIN(reqbufs.count, VIDEO_BUFFERS_MAX);
       printf("GOT v4l2_ncapbuf=%" PRI_SIZET "\n", v4l2_ncapbuf);
 
       for (index = 0; index < v4l2_ncapbuf; index++)
@@ -1215,6 +1764,7 @@ RETRO_API bool VIDEOPROC_CORE_PREFIX(retro_load_game)(const struct retro_game_in
          }
 
          v4l2_capbuf[index].len = buf.length;
+         v4l2_capbuf[index].fd  = -1;
          v4l2_capbuf[index].start = v4l2_mmap(NULL, buf.length,
                PROT_READ|PROT_WRITE, MAP_SHARED, video_device_fd, buf.m.offset);
          if (v4l2_capbuf[index].start == MAP_FAILED)
@@ -1222,6 +1772,23 @@ RETRO_API bool VIDEOPROC_CORE_PREFIX(retro_load_game)(const struct retro_game_in
             printf("v4l2_mmap failed: %s\n", strerror(errno));
             return false;
          }
+
+#ifdef VIDEOPROC_HAVE_GL
+         /* Buffers libv4l2 converts in software can't be shared */
+         if (videoproc_gl_active && videoproc_gl_native)
+         {
+            struct v4l2_exportbuffer expbuf;
+
+            memset(&expbuf, 0, sizeof(expbuf));
+            expbuf.type  = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            expbuf.index = index;
+            expbuf.flags = O_RDONLY | O_CLOEXEC;
+            if (v4l2_ioctl(video_device_fd, VIDIOC_EXPBUF, &expbuf) == 0)
+               v4l2_capbuf[index].fd = expbuf.fd;
+            else
+               printf("VIDIOC_EXPBUF failed for %u: %s\n", index, strerror(errno));
+         }
+#endif
       }
 
       for (index = 0; index < v4l2_ncapbuf; index++)
@@ -1306,6 +1873,12 @@ RETRO_API bool VIDEOPROC_CORE_PREFIX(retro_load_game)(const struct retro_game_in
       return false;
    }
 
+#ifdef VIDEOPROC_HAVE_GL
+   /* Otherwise done once the context is up */
+   if (videoproc_gl_context)
+      videoproc_gl_import_buffers();
+#endif
+
    return true;
 }
 
@@ -1328,8 +1901,18 @@ RETRO_API void VIDEOPROC_CORE_PREFIX(retro_unload_game)(void)
       if (error != 0)
          printf("VIDIOC_STREAMOFF failed: %s\n", strerror(errno));
 
+#ifdef VIDEOPROC_HAVE_GL
+      videoproc_gl_release_buffers();
+      videoproc_gl_held = -1;
+#endif
+
       for (index = 0; index < v4l2_ncapbuf; index++)
+      {
          v4l2_munmap(v4l2_capbuf[index].start, v4l2_capbuf[index].len);
+         if (v4l2_capbuf[index].fd >= 0)
+            close(v4l2_capbuf[index].fd);
+         v4l2_capbuf[index].fd = -1;
+      }
 
       reqbufs.count = 0;
       reqbufs.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
@@ -1368,6 +1951,12 @@ RETRO_API void VIDEOPROC_CORE_PREFIX(retro_unload_game)(void)
       ft_info2 = NULL;
    }
 
+#ifdef VIDEOPROC_HAVE_GL
+   videoproc_gl_active = false;
+   if (!video_reloading)
+      videoproc_gl_hw  = false;
+#endif
+
    close_devices();
    video_device[0] = '\0';
    audio_device[0] = '\0';
@@ -17,18 +17,24 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 
+#include <array/rbuf.h>
 #include <compat/strl.h>
 #include <retro_endianness.h>
+#include <encodings/crc32.h>
 #include <file/file_path.h>
 #include <lists/string_list.h>
 #include <lists/dir_list.h>
+#include <streams/file_stream.h>
 #include <string/stdstring.h>
 
 #include "libretro-db/libretrodb.h"
+#include "libretro-db/rmsgpack.h"
 
 #include "core_info.h"
 #include "database_info.h"
+#include "verbosity.h"
 
 int database_info_build_query_enum(char *s, size_t len,
       enum database_query_type type,
@@ -142,172 +148,210 @@ char *bin_to_hex_alloc(const uint8_t *data, size_t len)
    return ret;
 }
 
-static int database_cursor_iterate(libretrodb_cursor_t *cur,
-      database_info_t *db_info)
+/* A key/value pair of a raw RDB record. The key is left
+ * empty if it is too long to be any field we know of */
+typedef struct
+{
+   struct rmsgpack_item_head value;
+   const uint8_t *data; /* contents of string and binary values */
+   char key[32];
+} database_info_field_t;
+
+/* Parses the head of a raw RDB record, returning its
+ * number of fields, or -1 if it isn't an entry */
+static int64_t database_info_get_field_count(const uint8_t *data,
+      size_t len, size_t *pos)
 {
-   unsigned i;
-   struct rmsgpack_dom_value item;
-   const char* str                = NULL;
+   struct rmsgpack_item_head head;
 
-   if (libretrodb_cursor_read_item(cur, &item) != 0)
+   if (     rmsgpack_parse_head(data, len, pos, &head) < 0
+         || head.type != RMSGPACK_ITEM_MAP)
       return -1;
 
-   if (item.type != RDT_MAP)
+   return (int64_t)head.len;
+}
+
+/* Parses the next key/value pair of a raw RDB record,
+ * without copying or allocating anything */
+static bool database_info_get_field(const uint8_t *data, size_t len,
+      size_t *pos, database_info_field_t *field)
+{
+   struct rmsgpack_item_head key;
+
+   if (rmsgpack_parse_head(data, len, pos, &key) < 0)
+      return false;
+
+   field->key[0] = '\0';
+
+   if (     key.type == RMSGPACK_ITEM_STRING
+         && key.len  <  sizeof(field->key)
+         && key.len  <= len - *pos)
    {
-      rmsgpack_dom_value_free(&item);
-      return 1;
+      memcpy(field->key, data + *pos, (size_t)key.len);
+      field->key[key.len] = '\0';
+   }
+
+   if (     rmsgpack_parse_skip(data, len, pos, &key) < 0
+         || rmsgpack_parse_head(data, len, pos, &field->value) < 0)
+      return false;
+
+   field->data = data + *pos;
+
+   return rmsgpack_parse_skip(data, len, pos, &field->value) >= 0;
+}
+
+/* NOTE: Allocates memory, empty strings are left out */
+static char *database_info_field_strdup(const database_info_field_t *field)
+{
+   char *s = NULL;
+
+   if (     field->value.type != RMSGPACK_ITEM_STRING
+         || !field->value.len)
+      return NULL;
+
+   if (!(s = (char*)malloc((size_t)field->value.len + 1)))
+      return NULL;
+
+   memcpy(s, field->data, (size_t)field->value.len);
+   s[field->value.len] = '\0';
+   return s;
+}
+
+/* NOTE: Allocates memory */
+static char *database_info_field_to_hex(const database_info_field_t *field)
+{
+   if (field->value.type != RMSGPACK_ITEM_BINARY)
+      return NULL;
+   return bin_to_hex_alloc(field->data, (size_t)field->value.len);
+}
+
+static uint32_t database_info_get_crc(const database_info_field_t *field)
+{
+   const uint8_t *crc = field->data;
+
+   if (field->value.type != RMSGPACK_ITEM_BINARY)
+      return 0;
+
+   switch (field->value.len)
+   {
+      case 1:
+         return crc[0];
+      case 2:
+         return ((uint32_t)crc[0] << 8) | crc[1];
+      case 4:
+         return ((uint32_t)crc[0] << 24) | ((uint32_t)crc[1] << 16)
+              | ((uint32_t)crc[2] <<  8) |  (uint32_t)crc[3];
+      default:
+         break;
    }
 
+   return 0;
+}
+
+static int database_cursor_iterate(libretrodb_cursor_t *cur,
+      database_info_t *db_info)
+{
+   int64_t i, count;
+   database_info_field_t field;
+   size_t len                     = 0;
+   size_t pos                     = 0;
+   const uint8_t *data            = NULL;
+   const char* str                = field.key;
+
+   /* Fields are picked straight out of the raw record,
+    * only what is kept gets allocated */
+   if (libretrodb_cursor_read_raw(cur, &data, &len) != 0)
+      return -1;
+
+   if ((count = database_info_get_field_count(data, len, &pos)) < 0)
+      return 1;
+
    db_info->analog_supported       = -1;
    db_info->rumble_supported       = -1;
    db_info->coop_supported         = -1;
 
-   for (i = 0; i < item.val.map.len; i++)
+   for (i = 0; i < count; i++)
    {
-      struct rmsgpack_dom_value *key = &item.val.map.items[i].key;
-      struct rmsgpack_dom_value *val = &item.val.map.items[i].value;
-      const char *val_string         = NULL;
+      unsigned val_uint;
 
-      if (!key || !val)
-         continue;
+      if (!database_info_get_field(data, len, &pos, &field))
+         break;
 
-      val_string                     = val->val.string.buff;
-      str                            = key->val.string.buff;
+      val_uint                       = (unsigned)field.value.val.uint_;
 
       if (string_is_equal(str, "publisher"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->publisher = strdup(val_string);
-      }
+         db_info->publisher = database_info_field_strdup(&field);
       else if (string_is_equal(str, "developer"))
       {
-         if (!string_is_empty(val_string))
+         char *val_string = database_info_field_strdup(&field);
+         if (val_string)
+         {
             db_info->developer = string_split(val_string, "|");
+            free(val_string);
+         }
       }
       else if (string_is_equal(str, "serial"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->serial = strdup(val_string);
-      }
+         db_info->serial = database_info_field_strdup(&field);
       else if (string_is_equal(str, "rom_name"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->rom_name = strdup(val_string);
-      }
+         db_info->rom_name = database_info_field_strdup(&field);
       else if (string_is_equal(str, "name"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->name = strdup(val_string);
-      }
+         db_info->name = database_info_field_strdup(&field);
       else if (string_is_equal(str, "description"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->description = strdup(val_string);
-      }
+         db_info->description = database_info_field_strdup(&field);
       else if (string_is_equal(str, "genre"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->genre = strdup(val_string);
-      }
+         db_info->genre = database_info_field_strdup(&field);
       else if (string_is_equal(str, "origin"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->origin = strdup(val_string);
-      }
+         db_info->origin = database_info_field_strdup(&field);
       else if (string_is_equal(str, "franchise"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->franchise = strdup(val_string);
-      }
+         db_info->franchise = database_info_field_strdup(&field);
       else if (string_ends_with_size(str, "_rating",
                strlen(str), STRLEN_CONST("_rating")))
       {
          if (string_is_equal(str, "bbfc_rating"))
-         {
-            if (!string_is_empty(val_string))
-               db_info->bbfc_rating = strdup(val_string);
-         }
+            db_info->bbfc_rating             = database_info_field_strdup(&field);
          else if (string_is_equal(str, "esrb_rating"))
-         {
-            if (!string_is_empty(val_string))
-               db_info->esrb_rating = strdup(val_string);
-         }
+            db_info->esrb_rating             = database_info_field_strdup(&field);
          else if (string_is_equal(str, "elspa_rating"))
-         {
-            if (!string_is_empty(val_string))
-               db_info->elspa_rating = strdup(val_string);
-         }
+            db_info->elspa_rating            = database_info_field_strdup(&field);
          else if (string_is_equal(str, "cero_rating"))
-         {
-            if (!string_is_empty(val_string))
-               db_info->cero_rating          = strdup(val_string);
-         }
+            db_info->cero_rating             = database_info_field_strdup(&field);
          else if (string_is_equal(str, "pegi_rating"))
-         {
-            if (!string_is_empty(val_string))
-               db_info->pegi_rating          = strdup(val_string);
-         }
+            db_info->pegi_rating             = database_info_field_strdup(&field);
          else if (string_is_equal(str, "edge_rating"))
-            db_info->edge_magazine_rating    = (unsigned)val->val.uint_;
+            db_info->edge_magazine_rating    = val_uint;
          else if (string_is_equal(str, "famitsu_rating"))
-            db_info->famitsu_magazine_rating = (unsigned)val->val.uint_;
+            db_info->famitsu_magazine_rating = val_uint;
          else if (string_is_equal(str, "tgdb_rating"))
-            db_info->tgdb_rating             = (unsigned)val->val.uint_;
+            db_info->tgdb_rating             = val_uint;
       }
       else if (string_is_equal(str, "enhancement_hw"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->enhancement_hw       = strdup(val_string);
-      }
+         db_info->enhancement_hw          = database_info_field_strdup(&field);
       else if (string_is_equal(str, "edge_review"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->edge_magazine_review = strdup(val_string);
-      }
+         db_info->edge_magazine_review    = database_info_field_strdup(&field);
       else if (string_is_equal(str, "edge_issue"))
-         db_info->edge_magazine_issue     = (unsigned)val->val.uint_;
+         db_info->edge_magazine_issue     = val_uint;
       else if (string_is_equal(str, "users"))
-         db_info->max_users               = (unsigned)val->val.uint_;
+         db_info->max_users               = val_uint;
       else if (string_is_equal(str, "releasemonth"))
-         db_info->releasemonth            = (unsigned)val->val.uint_;
+         db_info->releasemonth            = val_uint;
       else if (string_is_equal(str, "releaseyear"))
-         db_info->releaseyear             = (unsigned)val->val.uint_;
+         db_info->releaseyear             = val_uint;
       else if (string_is_equal(str, "rumble"))
-         db_info->rumble_supported        = (int)val->val.uint_;
+         db_info->rumble_supported        = (int)val_uint;
       else if (string_is_equal(str, "coop"))
-         db_info->coop_supported          = (int)val->val.uint_;
+         db_info->coop_supported          = (int)val_uint;
       else if (string_is_equal(str, "analog"))
-         db_info->analog_supported        = (int)val->val.uint_;
+         db_info->analog_supported        = (int)val_uint;
       else if (string_is_equal(str, "size"))
-         db_info->size                    = (unsigned)val->val.uint_;
+         db_info->size                    = val_uint;
       else if (string_is_equal(str, "crc"))
-      {
-         switch (val->val.binary.len)
-         {
-            case 1:
-               db_info->crc32 = *(uint8_t*)val->val.binary.buff;
-               break;
-            case 2:
-               db_info->crc32 = swap_if_little16(*(uint16_t*)val->val.binary.buff);
-               break;
-            case 4:
-               db_info->crc32 = swap_if_little32(*(uint32_t*)val->val.binary.buff);
-               break;
-            default:
-               db_info->crc32 = 0;
-               break;
-         }
-      }
+         db_info->crc32 = database_info_get_crc(&field);
       else if (string_is_equal(str, "sha1"))
-         db_info->sha1 = bin_to_hex_alloc(
-               (uint8_t*)val->val.binary.buff, val->val.binary.len);
+         db_info->sha1  = database_info_field_to_hex(&field);
       else if (string_is_equal(str, "md5"))
-         db_info->md5 = bin_to_hex_alloc(
-               (uint8_t*)val->val.binary.buff, val->val.binary.len);
+         db_info->md5   = database_info_field_to_hex(&field);
    }
 
-   rmsgpack_dom_value_free(&item);
-
    return 0;
 }
 
@@ -604,3 +648,566 @@ void database_info_list_free(database_info_list_t *database_info_list)
 
    free(database_info_list->list);
 }
+
+#define DATABASE_INDEX_MAGIC            0x49424452 /* "RDBI" */
+#define DATABASE_INDEX_VERSION          1
+#define DATABASE_INDEX_HEADER_SIZE      16
+#define DATABASE_INDEX_RECORD_SIZE      16
+#define DATABASE_INDEX_FINGERPRINT_SIZE (16 * 1024)
+
+/* Identifies the version of an RDB file */
+typedef struct
+{
+   uint64_t size;
+   uint32_t crc;
+} database_info_rdb_stamp_t;
+
+struct database_info_index
+{
+   database_info_index_record_t *records;
+   database_info_rdb_stamp_t *stamps;
+   struct string_list *rdbs;
+   libretrodb_t **dbs;
+   libretrodb_cursor_t **cursors;
+   uint8_t *data; /* contents of the cache file, which
+                     records point into when loaded */
+   size_t count;
+};
+
+/* Gets the size of an RDB, and the CRC of its modification
+ * time and its first and last bytes. This is much cheaper
+ * than checking the whole file, and changed databases will
+ * always have a new modification time. Where that is not
+ * available, the whole file is checksummed instead */
+static bool database_info_get_rdb_stamp(const char *path,
+      database_info_rdb_stamp_t *stamp)
+{
+   uint8_t buf[DATABASE_INDEX_FINGERPRINT_SIZE];
+   int64_t size;
+   int64_t len;
+   int64_t mtime  = 0;
+   bool has_mtime = path_get_mtime(path, &mtime);
+   RFILE *file    = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   if ((size = filestream_get_size(file)) < 0)
+      goto error;
+
+   stamp->size = (uint64_t)size;
+   stamp->crc  = 0;
+
+   if (has_mtime)
+   {
+      unsigned i;
+      uint8_t mtime_bytes[8];
+
+      for (i = 0; i < sizeof(mtime_bytes); i++)
+         mtime_bytes[i] = (uint8_t)((uint64_t)mtime >> (i * 8));
+      stamp->crc = encoding_crc32(stamp->crc,
+            mtime_bytes, sizeof(mtime_bytes));
+   }
+
+   if ((len = filestream_read(file, buf, sizeof(buf))) < 0)
+      goto error;
+   stamp->crc  = encoding_crc32(stamp->crc, buf, (size_t)len);
+
+   if (!has_mtime)
+   {
+      while ((len = filestream_read(file, buf, sizeof(buf))) > 0)
+         stamp->crc = encoding_crc32(stamp->crc, buf, (size_t)len);
+      if (len < 0)
+         goto error;
+   }
+   else
+   {
+      if (size > 2 * (int64_t)sizeof(buf))
+      {
+         if (filestream_seek(file, size - (int64_t)sizeof(buf),
+                  RETRO_VFS_SEEK_POSITION_START) != 0)
+            goto error;
+      }
+
+      if ((len = filestream_read(file, buf, sizeof(buf))) < 0)
+         goto error;
+      stamp->crc  = encoding_crc32(stamp->crc, buf, (size_t)len);
+   }
+
+   filestream_close(file);
+   return true;
+
+error:
+   filestream_close(file);
+   return false;
+}
+
+static int database_info_index_record_compare(const void *a, const void *b)
+{
+   const database_info_index_record_t *left  =
+      (const database_info_index_record_t*)a;
+   const database_info_index_record_t *right =
+      (const database_info_index_record_t*)b;
+
+   if (left->type != right->type)
+      return (left->type < right->type) ? -1 : 1;
+   if (left->key != right->key)
+      return (left->key < right->key) ? -1 : 1;
+   if (left->rdb != right->rdb)
+      return (left->rdb < right->rdb) ? -1 : 1;
+   if (left->offset != right->offset)
+      return (left->offset < right->offset) ? -1 : 1;
+   return 0;
+}
+
+static void database_info_index_add(database_info_index_record_t **records,
+      enum database_info_index_key type, uint32_t key,
+      size_t rdb, int64_t offset)
+{
+   database_info_index_record_t record;
+
+   record.offset = (uint64_t)offset;
+   record.key    = key;
+   record.rdb    = (uint16_t)rdb;
+   record.type   = (uint16_t)type;
+
+   RBUF_PUSH(*records, record);
+}
+
+/* Reads every RDB once, recording the location of each
+ * entry by all of its keys */
+static bool database_info_index_build(database_info_index_t *index)
+{
+   size_t i;
+   database_info_index_record_t *records = NULL;
+
+   for (i = 0; i < index->rdbs->size; i++)
+   {
+      libretrodb_t *db         = libretrodb_new();
+      libretrodb_cursor_t *cur = libretrodb_cursor_new();
+
+      if (      db
+            && cur
+            && (database_cursor_open(db, cur,
+                  index->rdbs->elems[i].data, NULL) == 0))
+      {
+         for (;;)
+         {
+            int64_t j, count;
+            database_info_field_t field;
+            size_t len          = 0;
+            size_t pos          = 0;
+            const uint8_t *data = NULL;
+            int64_t offset      = libretrodb_cursor_tell(cur);
+
+            if (     offset < 0
+                  || libretrodb_cursor_read_raw(cur, &data, &len) != 0)
+               break;
+
+            count = database_info_get_field_count(data, len, &pos);
+
+            for (j = 0; j < count; j++)
+            {
+               const char *str = field.key;
+
+               if (!database_info_get_field(data, len, &pos, &field))
+                  break;
+
+               if (string_is_equal(str, "crc"))
+               {
+                  uint32_t crc = database_info_get_crc(&field);
+                  if (crc)
+                     database_info_index_add(&records,
+                           DATABASE_INDEX_KEY_CRC, crc, i, offset);
+               }
+               else if (string_is_equal(str, "serial"))
+               {
+                  /* Same as database_info_index_get_serial_key() */
+                  if (     field.value.type == RMSGPACK_ITEM_STRING
+                        && field.value.len)
+                     database_info_index_add(&records,
+                           DATABASE_INDEX_KEY_SERIAL,
+                           encoding_crc32(0, field.data,
+                              (size_t)field.value.len), i, offset);
+               }
+               else if (string_is_equal(str, "md5"))
+               {
+                  const uint8_t *md5 = field.data;
+                  if (     field.value.type == RMSGPACK_ITEM_BINARY
+                        && field.value.len >= 4)
+                     database_info_index_add(&records,
+                           DATABASE_INDEX_KEY_MD5,
+                           ((uint32_t)md5[0] << 24) |
+                           ((uint32_t)md5[1] << 16) |
+                           ((uint32_t)md5[2] <<  8) |
+                           (uint32_t)md5[3], i, offset);
+               }
+            }
+         }
+
+         database_cursor_close(db, cur);
+      }
+
+      if (db)
+         libretrodb_free(db);
+      if (cur)
+         libretrodb_cursor_free(cur);
+   }
+
+   if (!(index->count = RBUF_LEN(records)))
+   {
+      RBUF_FREE(records);
+      return false;
+   }
+
+   qsort(records, index->count, sizeof(*records),
+         database_info_index_record_compare);
+
+   index->records = records;
+   return true;
+}
+
+static size_t database_info_index_get_table_size(
+      const database_info_index_t *index)
+{
+   size_t i;
+   size_t size = DATABASE_INDEX_HEADER_SIZE;
+
+   for (i = 0; i < index->rdbs->size; i++)
+      size += 16 + strlen(path_basename(index->rdbs->elems[i].data));
+
+   /* Records are aligned, so that they can be used in place */
+   return (size + 7) & ~(size_t)7;
+}
+
+static bool database_info_index_load(database_info_index_t *index,
+      const char *cache_path)
+{
+   size_t i;
+   size_t table_size;
+   void *buf       = NULL;
+   int64_t len     = 0;
+   uint8_t *data   = NULL;
+   const uint8_t *ptr;
+
+   if (!path_is_valid(cache_path))
+      return false;
+
+   if (!filestream_read_file(cache_path, &buf, &len))
+      return false;
+
+   data       = (uint8_t*)buf;
+   table_size = database_info_index_get_table_size(index);
+
+   if (     ((uint64_t)len < table_size)
+         || (retro_le_to_cpu32(*(uint32_t*)(data + 0))
+            != DATABASE_INDEX_MAGIC)
+         || (retro_le_to_cpu32(*(uint32_t*)(data + 4))
+            != DATABASE_INDEX_VERSION)
+         || (retro_le_to_cpu32(*(uint32_t*)(data + 8))
+            != index->rdbs->size))
+      goto error;
+
+   index->count = retro_le_to_cpu32(*(uint32_t*)(data + 12));
+
+   if ((uint64_t)len != table_size
+         + (uint64_t)index->count * DATABASE_INDEX_RECORD_SIZE)
+      goto error;
+
+   /* The index is only valid for the exact same databases */
+   ptr = data + DATABASE_INDEX_HEADER_SIZE;
+   for (i = 0; i < index->rdbs->size; i++)
+   {
+      const char *name = path_basename(index->rdbs->elems[i].data);
+      size_t name_len  = strlen(name);
+
+      if (     (retro_le_to_cpu64(*(uint64_t*)(ptr + 0))
+               != index->stamps[i].size)
+            || (retro_le_to_cpu32(*(uint32_t*)(ptr + 8))
+               != index->stamps[i].crc)
+            || (retro_le_to_cpu32(*(uint32_t*)(ptr + 12)) != name_len)
+            || memcmp(ptr + 16, name, name_len))
+         goto error;
+
+      ptr += 16 + name_len;
+   }
+
+   index->data    = data;
+   index->records = (database_info_index_record_t*)(data + table_size);
+
+#ifdef MSB_FIRST
+   for (i = 0; i < index->count; i++)
+   {
+      database_info_index_record_t *record = &index->records[i];
+      record->offset = retro_le_to_cpu64(record->offset);
+      record->key    = retro_le_to_cpu32(record->key);
+      record->rdb    = retro_le_to_cpu16(record->rdb);
+      record->type   = retro_le_to_cpu16(record->type);
+   }
+#endif
+
+   return true;
+
+error:
+   free(buf);
+   index->count = 0;
+   return false;
+}
+
+static void database_info_index_save(const database_info_index_t *index,
+      const char *cache_path)
+{
+   size_t i;
+   size_t table_size = database_info_index_get_table_size(index);
+   size_t size       = table_size
+      + index->count * DATABASE_INDEX_RECORD_SIZE;
+   uint8_t *data     = (uint8_t*)calloc(1, size);
+   uint8_t *ptr;
+
+   if (!data)
+      return;
+
+   *(uint32_t*)(data + 0)  = retro_cpu_to_le32(DATABASE_INDEX_MAGIC);
+   *(uint32_t*)(data + 4)  = retro_cpu_to_le32(DATABASE_INDEX_VERSION);
+   *(uint32_t*)(data + 8)  = retro_cpu_to_le32((uint32_t)index->rdbs->size);
+   *(uint32_t*)(data + 12) = retro_cpu_to_le32((uint32_t)index->count);
+
+   ptr = data + DATABASE_INDEX_HEADER_SIZE;
+   for (i = 0; i < index->rdbs->size; i++)
+   {
+      const char *name = path_basename(index->rdbs->elems[i].data);
+      size_t name_len  = strlen(name);
+
+      *(uint64_t*)(ptr + 0)  = retro_cpu_to_le64(index->stamps[i].size);
+      *(uint32_t*)(ptr + 8)  = retro_cpu_to_le32(index->stamps[i].crc);
+      *(uint32_t*)(ptr + 12) = retro_cpu_to_le32((uint32_t)name_len);
+      memcpy(ptr + 16, name, name_len);
+
+      ptr += 16 + name_len;
+   }
+
+   memcpy(data + table_size, index->records,
+         index->count * sizeof(*index->records));
+
+#ifdef MSB_FIRST
+   for (i = 0; i < index->count; i++)
+   {
+      database_info_index_record_t *record =
+         (database_info_index_record_t*)(data + table_size) + i;
+      record->offset = retro_cpu_to_le64(record->offset);
+      record->key    = retro_cpu_to_le32(record->key);
+      record->rdb    = retro_cpu_to_le16(record->rdb);
+      record->type   = retro_cpu_to_le16(record->type);
+   }
+#endif
+
+   if (!filestream_write_file(cache_path, data, (int64_t)size))
+      RARCH_WARN("[Database] Failed to write index: \"%s\".\n", cache_path);
+
+   free(data);
+}
+
+database_info_index_t *database_info_index_new(
+      const struct string_list *rdb_list, const char *cache_path)
+{
+   size_t i;
+   database_info_index_t *index = NULL;
+
+   /* Records store the RDB position in 16 bits */
+   if (!rdb_list || !rdb_list->size || rdb_list->size > 0xFFFF)
+      return NULL;
+
+   if (!(index = (database_info_index_t*)calloc(1, sizeof(*index))))
+      return NULL;
+
+   index->rdbs    = string_list_clone(rdb_list);
+   index->stamps  = (database_info_rdb_stamp_t*)
+      calloc(rdb_list->size, sizeof(*index->stamps));
+   index->dbs     = (libretrodb_t**)
+      calloc(rdb_list->size, sizeof(*index->dbs));
+   index->cursors = (libretrodb_cursor_t**)
+      calloc(rdb_list->size, sizeof(*index->cursors));
+
+   if (!index->rdbs || !index->stamps || !index->dbs || !index->cursors)
+      goto error;
+
+   for (i = 0; i < rdb_list->size; i++)
+      if (!database_info_get_rdb_stamp(rdb_list->elems[i].data,
+               &index->stamps[i]))
+         goto error;
+
+   if (!string_is_empty(cache_path)
+         && database_info_index_load(index, cache_path))
+      return index;
+
+   if (!database_info_index_build(index))
+      goto error;
+
+   if (!string_is_empty(cache_path))
+      database_info_index_save(index, cache_path);
+
+   return index;
+
+error:
+   database_info_index_free(index);
+   return NULL;
+}
+
+void database_info_index_free(database_info_index_t *index)
+{
+   size_t i;
+
+   if (!index)
+      return;
+
+   for (i = 0; index->rdbs && (i < index->rdbs->size); i++)
+   {
+      if (index->dbs && index->dbs[i])
+      {
+         database_cursor_close(index->dbs[i], index->cursors[i]);
+         libretrodb_free(index->dbs[i]);
+         libretrodb_cursor_free(index->cursors[i]);
+      }
+   }
+
+   /* Loaded records point into the cache file data */
+   if (index->data)
+      free(index->data);
+   else
+      RBUF_FREE(index->records);
+
+   if (index->rdbs)
+      string_list_free(index->rdbs);
+   if (index->stamps)
+      free(index->stamps);
+   if (index->dbs)
+      free(index->dbs);
+   if (index->cursors)
+      free(index->cursors);
+   free(index);
+}
+
+size_t database_info_index_find(const database_info_index_t *index,
+      enum database_info_index_key type, uint32_t key,
+      const database_info_index_record_t **records)
+{
+   size_t low  = 0;
+   size_t high;
+   size_t end;
+
+   if (!index)
+      return 0;
+
+   high = index->count;
+
+   /* Find the first record with this key */
+   while (low < high)
+   {
+      size_t mid                                  = low + (high - low) / 2;
+      const database_info_index_record_t *record = &index->records[mid];
+
+      if (     (record->type < type)
+            || ((record->type == type) && (record->key < key)))
+         low  = mid + 1;
+      else
+         high = mid;
+   }
+
+   for (end = low; end < index->count; end++)
+      if (     (index->records[end].type != type)
+            || (index->records[end].key  != key))
+         break;
+
+   *records = &index->records[low];
+   return end - low;
+}
+
+uint32_t database_info_index_get_serial_key(const char *serial)
+{
+   return encoding_crc32(0, (const uint8_t*)serial, strlen(serial));
+}
+
+bool database_info_index_read_entry(database_info_index_t *index,
+      const database_info_index_record_t *record,
+      database_info_index_entry_t *entry)
+{
+   int64_t i, count;
+   database_info_field_t field;
+   size_t len          = 0;
+   size_t pos          = 0;
+   const uint8_t *data = NULL;
+   size_t rdb          = record->rdb;
+
+   entry->name   = NULL;
+   entry->serial = NULL;
+   entry->crc32  = 0;
+
+   if (rdb >= index->rdbs->size)
+      return false;
+
+   /* Databases are only opened once a match is found */
+   if (!index->dbs[rdb])
+   {
+      libretrodb_t *db         = libretrodb_new();
+      libretrodb_cursor_t *cur = libretrodb_cursor_new();
+
+      if (     !db
+            || !cur
+            || (database_cursor_open(db, cur,
+                  index->rdbs->elems[rdb].data, NULL) != 0))
+      {
+         if (db)
+            libretrodb_free(db);
+         if (cur)
+            libretrodb_cursor_free(cur);
+         return false;
+      }
+
+      index->dbs[rdb]     = db;
+      index->cursors[rdb] = cur;
+   }
+
+   if (libretrodb_cursor_seek(index->cursors[rdb], record->offset) != 0)
+      return false;
+
+   if (libretrodb_cursor_read_raw(index->cursors[rdb], &data, &len) != 0)
+      return false;
+
+   if ((count = database_info_get_field_count(data, len, &pos)) < 0)
+      return false;
+
+   for (i = 0; i < count; i++)
+   {
+      const char *str = field.key;
+
+      if (!database_info_get_field(data, len, &pos, &field))
+         break;
+
+      if (string_is_equal(str, "name"))
+      {
+         if (!entry->name)
+            entry->name   = database_info_field_strdup(&field);
+      }
+      else if (string_is_equal(str, "serial"))
+      {
+         if (!entry->serial)
+            entry->serial = database_info_field_strdup(&field);
+      }
+      else if (string_is_equal(str, "crc"))
+         entry->crc32     = database_info_get_crc(&field);
+   }
+
+   return true;
+}
+
+void database_info_index_entry_free(database_info_index_entry_t *entry)
+{
+   if (entry->name)
+      free(entry->name);
+   if (entry->serial)
+      free(entry->serial);
+   entry->name   = NULL;
+   entry->serial = NULL;
+}
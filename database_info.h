@@ -124,6 +124,64 @@ database_info_list_t *database_info_list_new(const char *rdb_path,
 
 void database_info_list_free(database_info_list_t *list);
 
+typedef struct
+{
+   char *name;
+   char *serial;
+   uint32_t crc32;
+} database_info_index_entry_t;
+
+enum database_info_index_key
+{
+   DATABASE_INDEX_KEY_CRC = 0,
+   DATABASE_INDEX_KEY_SERIAL,
+   DATABASE_INDEX_KEY_MD5
+};
+
+/* Location of one entry, keyed by its CRC32, or by
+ * the CRC32 of its serial or the first bytes of its MD5 */
+typedef struct
+{
+   uint64_t offset; /* of the entry in its RDB */
+   uint32_t key;
+   uint16_t rdb;    /* position of the RDB in the index */
+   uint16_t type;   /* enum database_info_index_key */
+} database_info_index_record_t;
+
+/* Merged lookup index over a list of RDBs, so that content
+ * can be identified without querying every database file.
+ * The index is cached in FILE_PATH_RDB_INDEX_CACHE, next
+ * to the databases, and only rebuilt when one of them
+ * changes */
+typedef struct database_info_index database_info_index_t;
+
+/* Creates the index of RDBs 'rdb_list', loading it from
+ * 'cache_path' if still valid and updating it otherwise.
+ * If 'cache_path' is NULL, the index is only kept in memory */
+database_info_index_t *database_info_index_new(
+      const struct string_list *rdb_list, const char *cache_path);
+
+void database_info_index_free(database_info_index_t *index);
+
+/* Returns the number of records with the specified key
+ * and sets 'records' to the first of them. Records of
+ * the same RDB are in database order */
+size_t database_info_index_find(const database_info_index_t *index,
+      enum database_info_index_key type, uint32_t key,
+      const database_info_index_record_t **records);
+
+/* Returns the key of 'serial', for use with
+ * DATABASE_INDEX_KEY_SERIAL */
+uint32_t database_info_index_get_serial_key(const char *serial);
+
+/* Reads the entry of 'record' into 'entry', which
+ * must be freed with database_info_index_entry_free() */
+bool database_info_index_read_entry(database_info_index_t *index,
+      const database_info_index_record_t *record,
+      database_info_index_entry_t *entry);
+
+void database_info_index_entry_free(database_info_index_entry_t *entry);
+
 database_info_handle_t *database_info_dir_init(const char *dir,
       enum database_type type, retro_task_t *task,
       bool show_hidden_files);
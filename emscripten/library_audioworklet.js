@@ -0,0 +1,190 @@
+//"use strict";
+
+// Audio output through an AudioWorkletNode. Samples are handed over in a
+// SharedArrayBuffer ring: the first two Int32s are the write and read
+// positions (in frames, wrapping at 2^32), followed by interleaved stereo
+// floats. Only the main thread moves the write position and only the
+// worklet moves the read position, so no locking is needed. Like
+// rwebaudio, the entry points are proxied to the main thread in
+// PROXY_TO_PTHREAD builds.
+
+var LibraryAudioWorklet = {
+   $AW__deps: ['$Browser'],
+   $AW: {
+      WRITE: 0,
+      READ: 1,
+
+      context: null,
+      node: null,
+      indices: null,
+      ring: null,
+      frames: 0,
+      nonblock: false,
+
+      processor:
+         "class RetroArchProcessor extends AudioWorkletProcessor {\n" +
+         "   constructor(options) {\n" +
+         "      super();\n" +
+         "      var buffer = options.processorOptions.buffer;\n" +
+         "      this.indices = new Int32Array(buffer, 0, 2);\n" +
+         "      this.ring = new Float32Array(buffer, 8);\n" +
+         "      this.mask = (this.ring.length >> 1) - 1;\n" +
+         "   }\n" +
+         "   process(inputs, outputs) {\n" +
+         "      var left = outputs[0][0];\n" +
+         "      var right = outputs[0][1];\n" +
+         "      var read = Atomics.load(this.indices, 1);\n" +
+         "      var avail = (Atomics.load(this.indices, 0) - read) | 0;\n" +
+         "      var count = Math.min(left.length, avail);\n" +
+         "      var i;\n" +
+         "      for (i = 0; i < count; i++) {\n" +
+         "         var pos = ((read + i) & this.mask) << 1;\n" +
+         "         left[i] = this.ring[pos];\n" +
+         "         right[i] = this.ring[pos + 1];\n" +
+         "      }\n" +
+         "      for (; i < left.length; i++) left[i] = right[i] = 0;\n" +
+         "      Atomics.store(this.indices, 1, (read + count) | 0);\n" +
+         "      return true;\n" +
+         "   }\n" +
+         "}\n" +
+         "registerProcessor('retroarch-audio', RetroArchProcessor);\n",
+
+      used: function() {
+         return (Atomics.load(AW.indices, AW.WRITE) -
+               Atomics.load(AW.indices, AW.READ)) | 0;
+      },
+
+      // Until the worklet runs nothing drains the ring, so
+      // waiting for it to do so would never return.
+      running: function() {
+         return AW.node && AW.context.state === 'running';
+      }
+   },
+
+   AudioWorkletInit__proxy: 'sync',
+   AudioWorkletInit__sig: 'ii',
+   AudioWorkletInit: function(latency) {
+      var ac = window['AudioContext'] || window['webkitAudioContext'];
+
+      if (!ac || !window['AudioWorkletNode'] ||
+            typeof SharedArrayBuffer === 'undefined') return 0;
+
+      AW.context = new ac();
+      if (!AW.context['audioWorklet']) {
+         AW.context = null;
+         return 0;
+      }
+
+      var frames = ((latency * AW.context.sampleRate) / 1000)|0;
+      AW.frames = 256;
+      while (AW.frames < frames) AW.frames *= 2;
+
+      var buffer = new SharedArrayBuffer(8 + AW.frames * 8);
+      AW.indices = new Int32Array(buffer, 0, 2);
+      AW.ring = new Float32Array(buffer, 8);
+      AW.nonblock = false;
+      AW.node = null;
+
+      var url = URL.createObjectURL(
+            new Blob([AW.processor], {type: 'application/javascript'}));
+
+      // No main loop on this thread when it runs in a pthread
+      var mainloop = !!Browser.mainLoop.func;
+      if (mainloop) Module["pauseMainLoop"]();
+      AW.context['audioWorklet']['addModule'](url).then(function() {
+         AW.node = new AudioWorkletNode(AW.context, 'retroarch-audio', {
+            numberOfInputs: 0,
+            numberOfOutputs: 1,
+            outputChannelCount: [2],
+            processorOptions: {buffer: buffer}
+         });
+         AW.node.connect(AW.context.destination);
+      }).catch(function(err) {
+         console.error("[AudioWorklet] Failed to load processor: " + err);
+      }).then(function() {
+         URL.revokeObjectURL(url);
+         if (mainloop) Module["resumeMainLoop"]();
+      });
+      return 1;
+   },
+
+   AudioWorkletSampleRate__proxy: 'sync',
+   AudioWorkletSampleRate__sig: 'i',
+   AudioWorkletSampleRate: function() {
+      return AW.context.sampleRate;
+   },
+
+   AudioWorkletWrite__proxy: 'sync',
+   AudioWorkletWrite__sig: 'iii',
+   AudioWorkletWrite: function(buf, size) {
+      var frames = size / 8;
+      var count = 0;
+      var src = buf >> 2;
+
+      while (count < frames) {
+         var avail = AW.frames - AW.used();
+
+         if (!avail) {
+            if (AW.nonblock || !AW.running()) break;
+            continue;
+         }
+
+         var write = Atomics.load(AW.indices, AW.WRITE);
+         var pos = write & (AW.frames - 1);
+         var chunk = Math.min(frames - count, avail, AW.frames - pos);
+
+         AW.ring.set(HEAPF32.subarray(src + count * 2,
+               src + (count + chunk) * 2), pos * 2);
+         Atomics.store(AW.indices, AW.WRITE, (write + chunk) | 0);
+         count += chunk;
+      }
+
+      return count * 8;
+   },
+
+   AudioWorkletStop__proxy: 'sync',
+   AudioWorkletStop__sig: 'i',
+   AudioWorkletStop: function() {
+      AW.context.suspend();
+      return true;
+   },
+
+   AudioWorkletStart__proxy: 'sync',
+   AudioWorkletStart__sig: 'i',
+   AudioWorkletStart: function() {
+      AW.context.resume();
+      return true;
+   },
+
+   AudioWorkletSetNonblockState__proxy: 'sync',
+   AudioWorkletSetNonblockState__sig: 'vi',
+   AudioWorkletSetNonblockState: function(state) {
+      AW.nonblock = state;
+   },
+
+   AudioWorkletFree__proxy: 'sync',
+   AudioWorkletFree__sig: 'v',
+   AudioWorkletFree: function() {
+      if (AW.node) AW.node.disconnect();
+      AW.context.close();
+      AW.node = null;
+      AW.context = null;
+      AW.indices = null;
+      AW.ring = null;
+   },
+
+   AudioWorkletBufferSize__proxy: 'sync',
+   AudioWorkletBufferSize__sig: 'i',
+   AudioWorkletBufferSize: function() {
+      return AW.frames * 8;
+   },
+
+   AudioWorkletWriteAvail__proxy: 'sync',
+   AudioWorkletWriteAvail__sig: 'i',
+   AudioWorkletWriteAvail: function() {
+      return (AW.frames - AW.used()) * 8;
+   }
+};
+
+autoAddDeps(LibraryAudioWorklet, '$AW');
+mergeInto(LibraryManager.library, LibraryAudioWorklet);
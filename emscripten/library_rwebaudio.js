@@ -1,5 +1,9 @@
 //"use strict";
 
+// When the runloop runs in a pthread (PROXY_TO_PTHREAD), Web Audio is
+// still only reachable from the main thread, so the entry points are
+// proxied there.
+
 var LibraryRWebAudio = {
    $RA__deps: ['$Browser'],
    $RA: {
@@ -17,7 +21,7 @@ var LibraryRWebAudio = {
       setStartTime: function() {
          if (RA.context.currentTime) {
             RA.startTime = window['performance']['now']() - RA.context.currentTime * 1000;
-            Module["resumeMainLoop"]();
+            if (Browser.mainLoop.func) Module["resumeMainLoop"]();
          } else window['setTimeout'](RA.setStartTime, 0);
       },
 
@@ -78,6 +82,8 @@ var LibraryRWebAudio = {
       }
    },
 
+   RWebAudioInit__proxy: 'sync',
+   RWebAudioInit__sig: 'ii',
    RWebAudioInit: function(latency) {
       var ac = window['AudioContext'] || window['webkitAudioContext'];
 
@@ -98,14 +104,19 @@ var LibraryRWebAudio = {
       // chrome hack to get currentTime running
       RA.context.createGain();
       window['setTimeout'](RA.setStartTime, 0);
-      Module["pauseMainLoop"]();
+      // No main loop on this thread when it runs in a pthread
+      if (Browser.mainLoop.func) Module["pauseMainLoop"]();
       return 1;
    },
 
+   RWebAudioSampleRate__proxy: 'sync',
+   RWebAudioSampleRate__sig: 'i',
    RWebAudioSampleRate: function() {
       return RA.context.sampleRate;
    },
 
+   RWebAudioWrite__proxy: 'sync',
+   RWebAudioWrite__sig: 'iii',
    RWebAudioWrite: function (buf, size) {
       RA.process();
       var samples = size / 8;
@@ -130,34 +141,48 @@ var LibraryRWebAudio = {
       return count * 8;
    },
 
+   RWebAudioStop__proxy: 'sync',
+   RWebAudioStop__sig: 'i',
    RWebAudioStop: function() {
       RA.bufIndex = 0;
       RA.bufOffset = 0;
       return true;
    },
 
+   RWebAudioStart__proxy: 'sync',
+   RWebAudioStart__sig: 'i',
    RWebAudioStart: function() {
       return true;
    },
 
+   RWebAudioSetNonblockState__proxy: 'sync',
+   RWebAudioSetNonblockState__sig: 'vi',
    RWebAudioSetNonblockState: function(state) {
       RA.nonblock = state;
    },
 
+   RWebAudioFree__proxy: 'sync',
+   RWebAudioFree__sig: 'v',
    RWebAudioFree: function() {
       RA.bufIndex = 0;
       RA.bufOffset = 0;
    },
 
+   RWebAudioBufferSize__proxy: 'sync',
+   RWebAudioBufferSize__sig: 'i',
    RWebAudioBufferSize: function() {
       return RA.numBuffers * RA.BUFFER_SIZE * 8;
    },
 
+   RWebAudioWriteAvail__proxy: 'sync',
+   RWebAudioWriteAvail__sig: 'i',
    RWebAudioWriteAvail: function() {
       RA.process();
       return ((RA.numBuffers - RA.bufIndex) * RA.BUFFER_SIZE - RA.bufOffset) * 8;
    },
 
+   RWebAudioRecalibrateTime__proxy: 'async',
+   RWebAudioRecalibrateTime__sig: 'v',
    RWebAudioRecalibrateTime: function() {
       if (RA.startTime) {
          RA.startTime = window['performance']['now']() - RA.context.currentTime * 1000;
@@ -53,6 +53,7 @@
 #endif
 
 #ifdef ANDROID
+#include <dlfcn.h>
 #include <sys/system_properties.h>
 #endif
 
@@ -230,6 +231,176 @@ void android_dpi_get_density(char *s, size_t len)
    strlcpy(s, string2, len);
 }
 
+/* AChoreographer and ANativeWindow_setFrameRate are newer than
+ * the API level we build against, so they are looked up at runtime. */
+typedef void (*android_frame_cb_t)(long frame_nanos, void *data);
+typedef void (*android_frame_cb64_t)(int64_t frame_nanos, void *data);
+typedef void *(*pfn_AChoreographer_getInstance)(void);
+typedef void (*pfn_AChoreographer_postFrameCallback)(void *choreographer,
+      android_frame_cb_t cb, void *data);
+typedef void (*pfn_AChoreographer_postFrameCallback64)(void *choreographer,
+      android_frame_cb64_t cb, void *data);
+typedef int32_t (*pfn_ANativeWindow_setFrameRate)(ANativeWindow *window,
+      float frame_rate, int8_t compatibility);
+
+/* ANATIVEWINDOW_FRAME_RATE_COMPATIBILITY_FIXED_SOURCE */
+#define ANDROID_FRAME_RATE_FIXED_SOURCE 1
+
+static struct
+{
+   pfn_AChoreographer_postFrameCallback   post_frame_callback;
+   pfn_AChoreographer_postFrameCallback64 post_frame_callback64;
+   pfn_ANativeWindow_setFrameRate         set_frame_rate;
+   void *choreographer;
+   retro_time_t last_vsync;
+   retro_time_t interval;
+   retro_time_t last_present;
+   bool loaded;
+   bool running;
+} android_pacing;
+
+static void android_frame_pacing_post(void);
+
+static void android_frame_pacing_vsync(int64_t frame_nanos)
+{
+   /* Choreographer reports CLOCK_MONOTONIC,
+    * the same clock as cpu_features_get_time_usec() */
+   retro_time_t vsync = frame_nanos / 1000;
+   retro_time_t delta = vsync - android_pacing.last_vsync;
+
+   /* Longer gaps are missed callbacks, not a slower display */
+   if (     delta >= 4000
+         && delta <= 50000
+         && (   !android_pacing.interval
+             || delta < android_pacing.interval * 3 / 2))
+      android_pacing.interval = android_pacing.interval
+         ? (android_pacing.interval * 7 + delta) / 8
+         : delta;
+
+   android_pacing.last_vsync = vsync;
+
+   if (android_pacing.interval)
+      video_driver_set_present_timing(vsync, android_pacing.interval);
+
+   if (android_pacing.running)
+      android_frame_pacing_post();
+}
+
+static void android_frame_pacing_cb(long frame_nanos, void *data)
+{
+   android_frame_pacing_vsync(frame_nanos);
+}
+
+static void android_frame_pacing_cb64(int64_t frame_nanos, void *data)
+{
+   android_frame_pacing_vsync(frame_nanos);
+}
+
+static void android_frame_pacing_post(void)
+{
+   if (android_pacing.post_frame_callback64)
+      android_pacing.post_frame_callback64(android_pacing.choreographer,
+            android_frame_pacing_cb64, NULL);
+   else
+      android_pacing.post_frame_callback(android_pacing.choreographer,
+            android_frame_pacing_cb, NULL);
+}
+
+static void android_frame_pacing_load(void)
+{
+   pfn_AChoreographer_getInstance get_instance;
+
+   if (android_pacing.loaded)
+      return;
+   android_pacing.loaded                = true;
+
+   android_pacing.set_frame_rate        = (pfn_ANativeWindow_setFrameRate)
+      dlsym(RTLD_DEFAULT, "ANativeWindow_setFrameRate");
+   android_pacing.post_frame_callback64 = (pfn_AChoreographer_postFrameCallback64)
+      dlsym(RTLD_DEFAULT, "AChoreographer_postFrameCallback64");
+   /* The 'long' timestamp overflows on 32-bit targets */
+   if (sizeof(long) >= sizeof(int64_t))
+      android_pacing.post_frame_callback = (pfn_AChoreographer_postFrameCallback)
+         dlsym(RTLD_DEFAULT, "AChoreographer_postFrameCallback");
+
+   if (     !android_pacing.post_frame_callback64
+         && !android_pacing.post_frame_callback)
+      return;
+
+   if ((get_instance = (pfn_AChoreographer_getInstance)
+            dlsym(RTLD_DEFAULT, "AChoreographer_getInstance")))
+      android_pacing.choreographer = get_instance();
+}
+
+void android_frame_pacing_start(void)
+{
+   android_frame_pacing_load();
+
+   /* NULL when the calling thread has no looper,
+    * e.g. with threaded video */
+   if (!android_pacing.choreographer || android_pacing.running)
+      return;
+
+   android_pacing.running      = true;
+   android_pacing.last_vsync   = 0;
+   android_pacing.last_present = 0;
+   android_frame_pacing_post();
+   RARCH_LOG("[Android]: Using Choreographer for frame pacing.\n");
+}
+
+void android_frame_pacing_stop(void)
+{
+   /* The pending callback fires once more and is not reposted */
+   android_pacing.running  = false;
+   android_pacing.interval = 0;
+   video_driver_set_present_timing(0, 0);
+}
+
+void android_frame_pacing_set_frame_rate(ANativeWindow *window)
+{
+   struct retro_system_av_info *av_info = video_viewport_get_system_av_info();
+   float fps                            = 0.0f;
+
+   android_frame_pacing_load();
+
+   if (!android_pacing.set_frame_rate || !window)
+      return;
+
+   /* 0 leaves the choice to the system, e.g. in the menu */
+   if (av_info && av_info->timing.fps > 0.0)
+      fps = (float)av_info->timing.fps;
+
+   if (android_pacing.set_frame_rate(window, fps,
+            ANDROID_FRAME_RATE_FIXED_SOURCE) == 0)
+      RARCH_LOG("[Android]: Requested %.3f Hz display rate.\n", fps);
+}
+
+int64_t android_frame_pacing_present_time(unsigned swap_interval)
+{
+   retro_time_t now, next, target;
+   retro_time_t interval = android_pacing.interval;
+
+   if (!android_pacing.running || !interval || !swap_interval)
+      return 0;
+
+   now = cpu_features_get_time_usec();
+   if (now - android_pacing.last_vsync > 8 * interval)
+      return 0;
+
+   /* Keep frames swap_interval vsyncs apart, but never ask
+    * for a vsync that has already gone by */
+   next   = android_pacing.last_vsync
+      + ((now - android_pacing.last_vsync) / interval + 1) * interval;
+   target = android_pacing.last_present + swap_interval * interval;
+   if (target < next)
+      target = next;
+   android_pacing.last_present = target;
+
+   /* Half a vsync early, so the frame is latched
+    * for the target vsync rather than the one after */
+   return (target - interval / 2) * 1000;
+}
+
 void android_app_write_cmd(struct android_app *android_app, int8_t cmd)
 {
    if (!android_app)
@@ -360,6 +360,22 @@ void android_app_write_cmd(struct android_app *android_app, int8_t cmd);
 
 void android_dpi_get_density(char *s, size_t len);
 
+/* Frame pacing through AChoreographer (API 24+) and
+ * ANativeWindow_setFrameRate (API 30+), both resolved at runtime.
+ * Must be called from a thread with a looper. */
+void android_frame_pacing_start(void);
+
+void android_frame_pacing_stop(void);
+
+/* Asks the compositor for a display mode matching the content
+ * frame rate, e.g. 50Hz for PAL content on Android TV. */
+void android_frame_pacing_set_frame_rate(ANativeWindow *window);
+
+/* Returns the time (CLOCK_MONOTONIC, in nanoseconds) a frame
+ * should be presented at to stay swap_interval vsyncs after the
+ * previous one, or 0 if no vsync timing is known. */
+int64_t android_frame_pacing_present_time(unsigned swap_interval);
+
 extern struct android_app *g_android;
 #endif
 
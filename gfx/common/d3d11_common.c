@@ -166,14 +166,31 @@ void d3d11_update_texture(
       DXGI_FORMAT        format,
       const void*        data,
       d3d11_texture_t*   texture)
+{
+   if (!texture)
+      return;
+
+   d3d11_update_texture_staging(ctx, width, height, pitch,
+         format, data, texture, texture->staging);
+}
+
+void d3d11_update_texture_staging(
+      D3D11DeviceContext ctx,
+      unsigned           width,
+      unsigned           height,
+      unsigned           pitch,
+      DXGI_FORMAT        format,
+      const void*        data,
+      d3d11_texture_t*   texture,
+      D3D11Texture2D     staging)
 {
    D3D11_MAPPED_SUBRESOURCE mapped_texture;
    D3D11_BOX                frame_box = { 0, 0, 0, width, height, 1 };
 
-   if (!texture || !texture->staging)
+   if (!texture || !staging)
       return;
 
-   D3D11MapTexture2D(ctx, texture->staging,
+   D3D11MapTexture2D(ctx, staging,
          0, D3D11_MAP_WRITE, 0, &mapped_texture);
 
 #if 0
@@ -186,10 +203,10 @@ void d3d11_update_texture(
          mapped_texture.pData);
 #endif
 
-   D3D11UnmapTexture2D(ctx, texture->staging, 0);
+   D3D11UnmapTexture2D(ctx, staging, 0);
 
    D3D11CopyTexture2DSubresourceRegion(
-         ctx, texture->handle, 0, 0, 0, 0, texture->staging, 0, &frame_box);
+         ctx, texture->handle, 0, 0, 0, 0, staging, 0, &frame_box);
 
    if (texture->desc.MiscFlags & D3D11_RESOURCE_MISC_GENERATE_MIPS)
       D3D11GenerateMips(ctx, texture->view);
@@ -26,6 +26,7 @@
 #include <d3d11.h>
 
 #define D3D11_MAX_GPU_COUNT 16
+#define D3D11_FRAME_STAGING_COUNT 3
 
 typedef const ID3D11ShaderResourceView* D3D11ShaderResourceViewRef;
 typedef const ID3D11SamplerState*       D3D11SamplerStateRef;
@@ -2594,6 +2595,12 @@ typedef struct
    struct
    {
       d3d11_texture_t texture[GFX_MAX_FRAME_HISTORY + 1];
+      /* Core frames are written to these in turn, so that
+       * mapping one never waits for the GPU to finish
+       * copying the previous frame out of it */
+      D3D11Texture2D  staging[D3D11_FRAME_STAGING_COUNT];
+      D3D11_TEXTURE2D_DESC staging_desc[D3D11_FRAME_STAGING_COUNT];
+      unsigned        staging_index;
       D3D11Buffer     vbo;
       D3D11Buffer     ubo;
       D3D11_VIEWPORT  viewport;
@@ -2638,6 +2645,18 @@ void d3d11_update_texture(
       const void*        data,
       d3d11_texture_t*   texture);
 
+/* Same as d3d11_update_texture(), going through
+ * 'staging' rather than the texture's own */
+void d3d11_update_texture_staging(
+      D3D11DeviceContext ctx,
+      unsigned           width,
+      unsigned           height,
+      unsigned           pitch,
+      DXGI_FORMAT        format,
+      const void*        data,
+      d3d11_texture_t*   texture,
+      D3D11Texture2D     staging);
+
 DXGI_FORMAT d3d11_get_closest_match(
       D3D11Device device, DXGI_FORMAT desired_format, UINT desired_format_support);
 
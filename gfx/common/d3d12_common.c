@@ -317,7 +317,8 @@ bool d3d12_init_swapchain(d3d12_video_t* d3d12,
 #else
    desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
 #endif
-   desc.Flags      = DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING;
+   desc.Flags      = DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING
+      | DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
 
 #ifdef __WINRT__
    hr = DXGICreateSwapChainForCoreWindow(d3d12->factory, d3d12->queue.handle, corewindow, &desc, NULL, &d3d12->chain.handle);
@@ -334,6 +335,14 @@ bool d3d12_init_swapchain(d3d12_video_t* d3d12,
    DXGIMakeWindowAssociation(d3d12->factory, hwnd, DXGI_MWA_NO_ALT_ENTER);
 #endif
 
+   /* Let one frame wait to be shown at most, and have
+    * the runloop wait for it to go before running the
+    * core, rather than blocking in Present() */
+   DXGISetMaximumFrameLatency(d3d12->chain.handle, 1);
+   d3d12->chain.frame_latency_waitable =
+      DXGIGetFrameLatencyWaitableObject(d3d12->chain.handle);
+   d3d12->chain.frame_latency_waited   = false;
+
    d3d12->chain.frame_index = DXGIGetCurrentBackBufferIndex(d3d12->chain.handle);
 
    for (i = 0; i < countof(d3d12->chain.renderTargets); i++)
@@ -1389,8 +1389,14 @@ typedef struct
       D3D12_VIEWPORT              viewport;
       D3D12_RECT                  scissorRect;
       float                       clearcolor[4];
+      /* Signalled whenever the swap chain can take
+       * another frame */
+      HANDLE                      frame_latency_waitable;
       int                         frame_index;
       bool                        vsync;
+      /* Whether frame_latency_waitable has been waited
+       * on since the last present */
+      bool                        frame_latency_waited;
       unsigned                    swap_interval;
    } chain;
 
@@ -60,6 +60,7 @@ typedef struct gl1
    bool menu_size_changed;
    bool rgb32;
    bool supports_bgra;
+   bool supports_rgb565;
    bool keep_aspect;
    bool should_resize;
    bool menu_texture_enable;
@@ -187,8 +187,9 @@ struct gl
    GLuint hw_render_fbo[GFX_MAX_TEXTURES];
 
 #ifdef HAVE_VIDEO_LAYOUT
-   GLuint video_layout_fbo;
-   GLuint video_layout_fbo_texture;
+   /* One per layer, kept until the layer changes */
+   GLuint video_layout_fbo[VIDEO_LAYOUT_MAX_LAYERS];
+   GLuint video_layout_fbo_texture[VIDEO_LAYOUT_MAX_LAYERS];
    GLuint video_layout_white_texture;
 #endif
 
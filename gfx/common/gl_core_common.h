@@ -42,6 +42,8 @@ RETRO_BEGIN_DECLS
 #define GL_CORE_NUM_PBOS 4
 #define GL_CORE_NUM_VBOS 256
 #define GL_CORE_NUM_FENCES 8
+#define GL_CORE_NUM_TIMER_QUERIES 4
+#define GL_CORE_NUM_UPLOAD_SLOTS 3
 struct gl_core_streamed_texture
 {
    GLuint tex;
@@ -58,7 +60,18 @@ typedef struct gl_core
    float *overlay_vertex_coord;
    float *overlay_tex_coord;
    float *overlay_color_coord;
+   /* Per image x, y, w, h of its region in overlay_atlas */
+   float *overlay_atlas_rect;
    GLsync fences[GL_CORE_NUM_FENCES];
+   /* Signalled once the readback into the matching PBO is done */
+   GLsync pbo_readback_fences[GL_CORE_NUM_PBOS];
+   /* Signalled once the GPU is done reading the matching
+    * slot of the upload buffer */
+   GLsync upload_fences[GL_CORE_NUM_UPLOAD_SLOTS];
+   /* Persistently mapped upload buffer that CPU frames
+    * are copied into, one slot per frame in flight */
+   uint8_t *upload_map;
+   size_t upload_slot_size;
    void *readback_buffer_screenshot;
    struct scaler_ctx pbo_readback_scaler;
 
@@ -70,6 +83,14 @@ typedef struct gl_core
    GLuint vao;
    GLuint menu_texture;
    GLuint pbo_readback[GL_CORE_NUM_PBOS];
+   GLuint upload_buffer;
+   /* All overlay images packed into one texture, drawn
+    * with a single indexed draw through overlay_ibo */
+   GLuint overlay_atlas;
+   GLuint overlay_ibo;
+   /* GL_TIME_ELAPSED queries, one per frame in flight */
+   GLuint timer_queries[GL_CORE_NUM_TIMER_QUERIES];
+   retro_time_t gpu_time;
 
    struct
    {
@@ -102,6 +123,9 @@ typedef struct gl_core
    unsigned scratch_vbo_index;
    unsigned fence_count;
    unsigned pbo_readback_index;
+   unsigned upload_index;
+   unsigned timer_query_index;
+   unsigned timer_query_pending;
    unsigned hw_render_max_width;
    unsigned hw_render_max_height;
    GLuint scratch_vbos[GL_CORE_NUM_VBOS];
@@ -116,7 +140,10 @@ typedef struct gl_core
    math_matrix_4x4 mvp_no_rot_yflip;
 
    bool pbo_readback_valid[GL_CORE_NUM_PBOS];
+   bool timer_query_enable;
+   bool timer_query_active;
    bool pbo_readback_enable;
+   bool upload_buffer_enable;
    bool hw_render_bottom_left;
    bool hw_render_enable;
    bool use_shared_context;
@@ -318,6 +318,156 @@ uint32_t vulkan_find_memory_type_fallback(
          device_reqs, host_reqs_second, 0);
 }
 
+static void vulkan_memory_block_free(struct vk_memory_block *block)
+{
+   vkFreeMemory(block->device, block->memory, NULL);
+   free(block->free_chunks);
+   free(block);
+}
+
+static struct vk_memory_block *vulkan_memory_block_new(
+      VkDevice device, uint32_t type, unsigned chunk_shift)
+{
+   unsigned i;
+   VkMemoryAllocateInfo alloc     = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+   VkDeviceSize size              = (VkDeviceSize)32 << chunk_shift;
+   struct vk_memory_block *block  = (struct vk_memory_block*)
+      calloc(1, sizeof(*block));
+
+   if (!block)
+      return NULL;
+
+   /* At least 32 chunks, within the block size limits */
+   if (size < VULKAN_MEMORY_BLOCK_MIN_SIZE)
+      size = VULKAN_MEMORY_BLOCK_MIN_SIZE;
+   else if (size > VULKAN_MEMORY_BLOCK_MAX_SIZE)
+      size = VULKAN_MEMORY_BLOCK_MAX_SIZE;
+
+   block->device      = device;
+   block->memory_type = type;
+   block->chunk_shift = chunk_shift;
+   block->num_chunks  = (unsigned)(size >> chunk_shift);
+   block->num_free    = block->num_chunks;
+   block->free_chunks = (uint16_t*)malloc(
+         block->num_chunks * sizeof(*block->free_chunks));
+
+   alloc.allocationSize  = size;
+   alloc.memoryTypeIndex = type;
+
+   if (     !block->free_chunks
+         || vkAllocateMemory(device, &alloc, NULL, &block->memory)
+            != VK_SUCCESS)
+   {
+      free(block->free_chunks);
+      free(block);
+      return NULL;
+   }
+
+   /* Hand out the chunks front to back */
+   for (i = 0; i < block->num_chunks; i++)
+      block->free_chunks[i] = block->num_chunks - 1 - i;
+
+   return block;
+}
+
+bool vulkan_memory_alloc(struct vk_memory_pool *pool,
+      VkDevice device, const VkMemoryRequirements *reqs,
+      uint32_t type, struct vk_memory_block **block,
+      VkDeviceSize *offset)
+{
+   struct vk_memory_block *b = NULL;
+   unsigned chunk_shift      = VULKAN_MEMORY_CHUNK_MIN_SHIFT;
+   /* Chunks are aligned to their size */
+   VkDeviceSize size         = MAX(reqs->size, reqs->alignment);
+
+   while (((VkDeviceSize)1 << chunk_shift) < size)
+      if (++chunk_shift > VULKAN_MEMORY_CHUNK_MAX_SHIFT)
+         return false;
+
+   for (b = pool->blocks[type][chunk_shift - VULKAN_MEMORY_CHUNK_MIN_SHIFT];
+         b; b = b->next)
+      if (b->num_free)
+         break;
+
+   if (!b)
+   {
+      if (!(b = vulkan_memory_block_new(device, type, chunk_shift)))
+         return false;
+      b->pool = pool;
+      b->next = pool->blocks[type][chunk_shift - VULKAN_MEMORY_CHUNK_MIN_SHIFT];
+      pool->blocks[type][chunk_shift - VULKAN_MEMORY_CHUNK_MIN_SHIFT] = b;
+   }
+
+   *block  = b;
+   *offset = (VkDeviceSize)b->free_chunks[--b->num_free] << chunk_shift;
+   return true;
+}
+
+void vulkan_memory_free(struct vk_memory_block *block,
+      VkDeviceSize offset)
+{
+   struct vk_memory_block **list = NULL;
+   struct vk_memory_block *b     = NULL;
+
+   block->free_chunks[block->num_free++] =
+      (uint16_t)(offset >> block->chunk_shift);
+
+   if (block->num_free < block->num_chunks)
+      return;
+
+   if (!block->pool)
+   {
+      vulkan_memory_block_free(block);
+      return;
+   }
+
+   /* Keep one empty block around, so that loading and
+    * unloading the same kind of image doesn't allocate */
+   list = &block->pool->blocks[block->memory_type]
+      [block->chunk_shift - VULKAN_MEMORY_CHUNK_MIN_SHIFT];
+   for (b = *list; b; b = b->next)
+      if (b != block && b->num_free == b->num_chunks)
+         break;
+   if (!b)
+      return;
+
+   while (*list != block)
+      list = &(*list)->next;
+   *list = block->next;
+   vulkan_memory_block_free(block);
+}
+
+void vulkan_memory_pool_deinit(struct vk_memory_pool *pool)
+{
+   unsigned i, j;
+
+   for (i = 0; i < VK_MAX_MEMORY_TYPES; i++)
+   {
+      for (j = 0; j < VULKAN_MEMORY_CLASSES; j++)
+      {
+         struct vk_memory_block *b = pool->blocks[i][j];
+
+         while (b)
+         {
+            struct vk_memory_block *next = b->next;
+
+            if (b->num_free == b->num_chunks)
+               vulkan_memory_block_free(b);
+            else
+            {
+               RARCH_WARN("[Vulkan]: Memory block still in use on teardown.\n");
+               b->pool = NULL;
+               b->next = NULL;
+            }
+
+            b = next;
+         }
+
+         pool->blocks[i][j] = NULL;
+      }
+   }
+}
+
 #ifdef VULKAN_DEBUG_TEXTURE_ALLOC
 static VkImage vk_images[4 * 1024];
 static unsigned vk_count;
@@ -560,6 +710,7 @@ struct vk_texture vulkan_create_texture(vk_t *vk,
 
    /* We can pilfer the old memory and move it over to the new texture. */
    if (old &&
+         !old->memory_block &&
          old->memory_size >= mem_reqs.size &&
          old->memory_type == alloc.memoryTypeIndex)
    {
@@ -572,6 +723,17 @@ struct vk_texture vulkan_create_texture(vk_t *vk,
 
       old->memory     = VK_NULL_HANDLE;
    }
+   /* Optimal images never get mapped, so they can share
+    * blocks without any granularity concerns */
+   else if ((type == VULKAN_TEXTURE_STATIC || type == VULKAN_TEXTURE_DYNAMIC)
+         && vulkan_memory_alloc(&vk->context->memory_pool, device,
+            &mem_reqs, alloc.memoryTypeIndex,
+            &tex.memory_block, &tex.memory_offset))
+   {
+      tex.memory      = tex.memory_block->memory;
+      tex.memory_size = mem_reqs.size;
+      tex.memory_type = alloc.memoryTypeIndex;
+   }
    else
    {
       vkAllocateMemory(device, &alloc, NULL, &tex.memory);
@@ -581,13 +743,15 @@ struct vk_texture vulkan_create_texture(vk_t *vk,
 
    if (old)
    {
-      if (old->memory != VK_NULL_HANDLE)
+      if (old->memory_block)
+         vulkan_memory_free(old->memory_block, old->memory_offset);
+      else if (old->memory != VK_NULL_HANDLE)
          vkFreeMemory(device, old->memory, NULL);
       memset(old, 0, sizeof(*old));
    }
 
    if (tex.image)
-      vkBindImageMemory(device, tex.image, tex.memory, 0);
+      vkBindImageMemory(device, tex.image, tex.memory, tex.memory_offset);
    if (tex.buffer)
       vkBindBufferMemory(device, tex.buffer, tex.memory, 0);
 
@@ -830,7 +994,9 @@ void vulkan_destroy_texture(
       vkDestroyImage(device, tex->image, NULL);
    if (tex->buffer)
       vkDestroyBuffer(device, tex->buffer, NULL);
-   if (tex->memory)
+   if (tex->memory_block)
+      vulkan_memory_free(tex->memory_block, tex->memory_offset);
+   else if (tex->memory)
       vkFreeMemory(device, tex->memory, NULL);
 
 #ifdef VULKAN_DEBUG_TEXTURE_ALLOC
@@ -854,51 +1020,74 @@ void vulkan_destroy_texture(
    tex->buffer                        = VK_NULL_HANDLE;
    tex->format                        = VK_FORMAT_UNDEFINED;
    tex->memory_size                   = 0;
+   tex->memory_offset                 = 0;
+   tex->memory_block                  = NULL;
    tex->layout                        = VK_IMAGE_LAYOUT_UNDEFINED;
 }
 
-static void vulkan_write_quad_descriptors(
-      VkDevice device,
-      VkDescriptorSet set,
+/* Binds the UBO and texture of a quad or triangle draw.
+ * With push descriptors they go straight into the command
+ * buffer, otherwise into a freshly allocated set. */
+static void vulkan_bind_quad_descriptors(
+      vk_t *vk,
       VkBuffer buffer,
       VkDeviceSize offset,
       VkDeviceSize range,
       const struct vk_texture *texture,
       VkSampler sampler)
 {
-   VkWriteDescriptorSet write;
+   VkWriteDescriptorSet writes[2];
    VkDescriptorBufferInfo buffer_info;
+   VkDescriptorImageInfo image_info;
+   VkDescriptorSet set  = VK_NULL_HANDLE;
+   uint32_t num_writes  = 1;
+
+   if (!vk->context->push_descriptor_set)
+      set = vulkan_descriptor_manager_alloc(
+            vk->context->device,
+            &vk->chain->descriptor_manager);
 
    buffer_info.buffer              = buffer;
    buffer_info.offset              = offset;
    buffer_info.range               = range;
 
-   write.sType                     = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-   write.pNext                     = NULL;
-   write.dstSet                    = set;
-   write.dstBinding                = 0;
-   write.dstArrayElement           = 0;
-   write.descriptorCount           = 1;
-   write.descriptorType            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-   write.pImageInfo                = NULL;
-   write.pBufferInfo               = &buffer_info;
-   write.pTexelBufferView          = NULL;
-   vkUpdateDescriptorSets(device, 1, &write, 0, NULL);
+   writes[0].sType                 = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+   writes[0].pNext                 = NULL;
+   writes[0].dstSet                = set;
+   writes[0].dstBinding            = 0;
+   writes[0].dstArrayElement       = 0;
+   writes[0].descriptorCount       = 1;
+   writes[0].descriptorType        = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+   writes[0].pImageInfo            = NULL;
+   writes[0].pBufferInfo           = &buffer_info;
+   writes[0].pTexelBufferView      = NULL;
 
    if (texture)
    {
-      VkDescriptorImageInfo image_info;
+      image_info.sampler           = sampler;
+      image_info.imageView         = texture->view;
+      image_info.imageLayout       = texture->layout;
 
-      image_info.sampler              = sampler;
-      image_info.imageView            = texture->view;
-      image_info.imageLayout          = texture->layout;
+      writes[1]                    = writes[0];
+      writes[1].dstBinding         = 1;
+      writes[1].descriptorType     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+      writes[1].pImageInfo         = &image_info;
+      writes[1].pBufferInfo        = NULL;
+      num_writes                   = 2;
+   }
 
-      write.dstSet                    = set;
-      write.dstBinding                = 1;
-      write.descriptorCount           = 1;
-      write.descriptorType            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-      write.pImageInfo                = &image_info;
-      vkUpdateDescriptorSets(device, 1, &write, 0, NULL);
+   if (vk->context->push_descriptor_set)
+      vk->context->push_descriptor_set(vk->cmd,
+            VK_PIPELINE_BIND_POINT_GRAPHICS,
+            vk->pipelines.layout, 0, num_writes, writes);
+   else
+   {
+      vkUpdateDescriptorSets(vk->context->device,
+            num_writes, writes, 0, NULL);
+      vkCmdBindDescriptorSets(vk->cmd,
+            VK_PIPELINE_BIND_POINT_GRAPHICS,
+            vk->pipelines.layout, 0,
+            1, &set, 0, NULL);
    }
 }
 
@@ -975,7 +1164,6 @@ void vulkan_draw_triangles(vk_t *vk, const struct vk_draw_triangles *call)
 
    /* Upload descriptors */
    {
-      VkDescriptorSet set;
       /* Upload UBO */
       struct vk_buffer_range range;
       float *mvp_data_ptr          = NULL;
@@ -986,24 +1174,13 @@ void vulkan_draw_triangles(vk_t *vk, const struct vk_draw_triangles *call)
 
       memcpy(range.data, call->uniform, call->uniform_size);
 
-      set = vulkan_descriptor_manager_alloc(
-            vk->context->device,
-            &vk->chain->descriptor_manager);
-
-      vulkan_write_quad_descriptors(
-            vk->context->device,
-            set,
+      vulkan_bind_quad_descriptors(vk,
             range.buffer,
             range.offset,
             call->uniform_size,
             call->texture,
             call->sampler);
 
-      vkCmdBindDescriptorSets(vk->cmd,
-            VK_PIPELINE_BIND_POINT_GRAPHICS,
-            vk->pipelines.layout, 0,
-            1, &set, 0, NULL);
-
       vk->tracker.view    = VK_NULL_HANDLE;
       vk->tracker.sampler = VK_NULL_HANDLE;
       for (
@@ -1040,7 +1217,6 @@ void vulkan_draw_quad(vk_t *vk, const struct vk_draw_quad *quad)
 
    /* Upload descriptors */
    {
-      VkDescriptorSet set;
       struct vk_buffer_range range;
 
       if (!vulkan_buffer_chain_alloc(vk->context, &vk->chain->ubo,
@@ -1062,23 +1238,13 @@ void vulkan_draw_quad(vk_t *vk, const struct vk_draw_quad *quad)
 
          memcpy(range.data, quad->mvp, sizeof(*quad->mvp));
 
-         set = vulkan_descriptor_manager_alloc(
-               vk->context->device,
-               &vk->chain->descriptor_manager);
-
-         vulkan_write_quad_descriptors(
-               vk->context->device,
-               set,
+         vulkan_bind_quad_descriptors(vk,
                range.buffer,
                range.offset,
                sizeof(*quad->mvp),
                quad->texture,
                quad->sampler);
 
-         vkCmdBindDescriptorSets(vk->cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-               vk->pipelines.layout, 0,
-               1, &set, 0, NULL);
-
          vk->tracker.view    = quad->texture->view;
          vk->tracker.sampler = quad->sampler;
          vk->tracker.mvp     = *quad->mvp;
@@ -1466,6 +1632,16 @@ end:
    return ret;
 }
 
+static bool vulkan_has_extension(const char **exts, unsigned num_exts,
+      const char *ext)
+{
+   unsigned i;
+   for (i = 0; i < num_exts; i++)
+      if (string_is_equal(exts[i], ext))
+         return true;
+   return false;
+}
+
 static bool vulkan_find_device_extensions(VkPhysicalDevice gpu,
       const char **enabled, unsigned *enabled_count,
       const char **exts, unsigned num_exts,
@@ -1594,6 +1770,12 @@ static bool vulkan_context_init_device(gfx_ctx_vulkan_data_t *vk)
    VkPhysicalDeviceFeatures features  = { false };
    VkDeviceQueueCreateInfo queue_info = { VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO };
    VkDeviceCreateInfo device_info     = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+   VkPhysicalDevicePresentIdFeaturesKHR present_id_features     = {
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR };
+   VkPhysicalDevicePresentWaitFeaturesKHR present_wait_features = {
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR };
+   bool present_wait                  = false;
+   bool push_descriptor               = false;
 
    const char *enabled_device_extensions[8];
    unsigned enabled_device_extension_count = 0;
@@ -1604,6 +1786,9 @@ static bool vulkan_context_init_device(gfx_ctx_vulkan_data_t *vk)
 
    static const char *optional_device_extensions[] = {
       "VK_KHR_sampler_mirror_clamp_to_edge",
+      "VK_KHR_present_id",
+      "VK_KHR_present_wait",
+      "VK_KHR_push_descriptor",
    };
 
    struct retro_hw_render_context_negotiation_interface_vulkan *iface =
@@ -1800,10 +1985,30 @@ static bool vulkan_context_init_device(gfx_ctx_vulkan_data_t *vk)
       device_info.ppEnabledExtensionNames = enabled_device_extension_count ? enabled_device_extensions : NULL;
       device_info.pEnabledFeatures        = &features;
 
+      /* Both are needed to wait for presents */
+      present_wait = vulkan_has_extension(enabled_device_extensions,
+            enabled_device_extension_count, "VK_KHR_present_id")
+         && vulkan_has_extension(enabled_device_extensions,
+            enabled_device_extension_count, "VK_KHR_present_wait");
+
+      push_descriptor = vulkan_has_extension(enabled_device_extensions,
+            enabled_device_extension_count, "VK_KHR_push_descriptor");
+
+      if (present_wait)
+      {
+         present_id_features.pNext       = &present_wait_features;
+         present_id_features.presentId   = VK_TRUE;
+         present_wait_features.presentWait = VK_TRUE;
+         device_info.pNext               = &present_id_features;
+      }
+
       if (cached_device_vk)
       {
          vk->context.device = cached_device_vk;
          cached_device_vk   = NULL;
+         /* Can't know what it was created with */
+         present_wait       = false;
+         push_descriptor    = false;
 
          video_driver_set_video_cache_context_ack();
          RARCH_LOG("[Vulkan]: Using cached Vulkan context.\n");
@@ -1811,8 +2016,28 @@ static bool vulkan_context_init_device(gfx_ctx_vulkan_data_t *vk)
       else if (vkCreateDevice(vk->context.gpu, &device_info,
                NULL, &vk->context.device) != VK_SUCCESS)
       {
-         RARCH_ERR("[Vulkan]: Failed to create device.\n");
-         return false;
+         /* Extensions may be listed without their
+          * features being supported - try without */
+         if (present_wait)
+         {
+            unsigned j = 0;
+
+            for (i = 0; i < enabled_device_extension_count; i++)
+               if (     !string_is_equal(enabled_device_extensions[i], "VK_KHR_present_id")
+                     && !string_is_equal(enabled_device_extensions[i], "VK_KHR_present_wait"))
+                  enabled_device_extensions[j++] = enabled_device_extensions[i];
+
+            device_info.enabledExtensionCount = j;
+            device_info.pNext                 = NULL;
+            present_wait                      = false;
+         }
+
+         if (vkCreateDevice(vk->context.gpu, &device_info,
+                  NULL, &vk->context.device) != VK_SUCCESS)
+         {
+            RARCH_ERR("[Vulkan]: Failed to create device.\n");
+            return false;
+         }
       }
    }
 
@@ -1822,6 +2047,18 @@ static bool vulkan_context_init_device(gfx_ctx_vulkan_data_t *vk)
       return false;
    }
 
+   vk->context.wait_for_present = NULL;
+   if (     present_wait
+         && VULKAN_SYMBOL_WRAPPER_LOAD_DEVICE_SYMBOL(vk->context.device,
+            "vkWaitForPresentKHR", vk->context.wait_for_present))
+      RARCH_LOG("[Vulkan]: Using VK_KHR_present_wait for frame pacing.\n");
+
+   vk->context.push_descriptor_set = NULL;
+   if (     push_descriptor
+         && VULKAN_SYMBOL_WRAPPER_LOAD_DEVICE_SYMBOL(vk->context.device,
+            "vkCmdPushDescriptorSetKHR", vk->context.push_descriptor_set))
+      RARCH_LOG("[Vulkan]: Using VK_KHR_push_descriptor.\n");
+
    vkGetDeviceQueue(vk->context.device,
       vk->context.graphics_queue_index, 0, &vk->context.queue);
 
@@ -2485,6 +2722,7 @@ static void vulkan_destroy_swapchain(gfx_ctx_vulkan_data_t *vk)
    unsigned i;
 
    vulkan_emulated_mailbox_deinit(&vk->mailbox);
+   vk->context.present_swapchain = VK_NULL_HANDLE;
    if (vk->swapchain != VK_NULL_HANDLE)
    {
       vkDeviceWaitIdle(vk->context.device);
@@ -2526,9 +2764,23 @@ static void vulkan_destroy_swapchain(gfx_ctx_vulkan_data_t *vk)
    vk->context.num_recycled_acquire_semaphores = 0;
 }
 
+void vulkan_wait_for_present(vulkan_context_t *ctx)
+{
+   if (     !ctx->wait_for_present
+         ||  ctx->present_swapchain == VK_NULL_HANDLE)
+      return;
+
+   /* Bounded, so that a present which never completes
+    * (minimised window, ...) can't hang the runloop */
+   ctx->wait_for_present(ctx->device, ctx->present_swapchain,
+         ctx->present_id, 100000000);
+}
+
 void vulkan_present(gfx_ctx_vulkan_data_t *vk, unsigned index)
 {
    VkPresentInfoKHR present;
+   VkPresentIdKHR present_id;
+   uint64_t id                     = 0;
    VkResult result                 = VK_SUCCESS;
    VkResult err                    = VK_SUCCESS;
 
@@ -2541,12 +2793,32 @@ void vulkan_present(gfx_ctx_vulkan_data_t *vk, unsigned index)
    present.pImageIndices           = &index;
    present.pResults                = &result;
 
+   /* Emulated mailbox presents out of order with
+    * respect to the runloop, nothing to wait for */
+   if (vk->context.wait_for_present && !vk->emulating_mailbox)
+   {
+      id                           = vk->context.present_id + 1;
+      present_id.sType             = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+      present_id.pNext             = NULL;
+      present_id.swapchainCount    = 1;
+      present_id.pPresentIds       = &id;
+      present.pNext                = &present_id;
+   }
+
    /* Better hope QueuePresent doesn't block D: */
 #ifdef HAVE_THREADS
    slock_lock(vk->context.queue_lock);
 #endif
    err = vkQueuePresentKHR(vk->context.queue, &present);
 
+   if (id)
+   {
+      vk->context.present_id        = id;
+      vk->context.present_swapchain = vk->swapchain;
+   }
+   else
+      vk->context.present_swapchain = VK_NULL_HANDLE;
+
    /* VK_SUBOPTIMAL_KHR can be returned on 
     * Android 10 when prerotate is not dealt with.
     * This is not an error we need to care about, 
@@ -2581,6 +2853,7 @@ void vulkan_context_destroy(gfx_ctx_vulkan_data_t *vk,
       vkDeviceWaitIdle(vk->context.device);
 
    vulkan_destroy_swapchain(vk);
+   vulkan_memory_pool_deinit(&vk->context.memory_pool);
 
    if (destroy_surface && vk->vk_surface != VK_NULL_HANDLE)
    {
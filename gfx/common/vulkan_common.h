@@ -27,6 +27,16 @@
 #define VULKAN_MAX_DESCRIPTOR_POOL_SIZES        16
 #define VULKAN_BUFFER_BLOCK_SIZE                (64 * 1024)
 
+/* Device local images are placed in chunks of larger
+ * memory blocks, one power of two chunk size per block,
+ * from 4 KiB up to 2 MiB. Larger images get their own
+ * allocation. */
+#define VULKAN_MEMORY_CHUNK_MIN_SHIFT           12
+#define VULKAN_MEMORY_CHUNK_MAX_SHIFT           21
+#define VULKAN_MEMORY_CLASSES                   (VULKAN_MEMORY_CHUNK_MAX_SHIFT - VULKAN_MEMORY_CHUNK_MIN_SHIFT + 1)
+#define VULKAN_MEMORY_BLOCK_MIN_SIZE            (1024 * 1024)
+#define VULKAN_MEMORY_BLOCK_MAX_SIZE            (16 * 1024 * 1024)
+
 #define VULKAN_MAX_SWAPCHAIN_IMAGES             8
 
 #define VULKAN_DIRTY_DYNAMIC_BIT                0x0001
@@ -55,6 +65,41 @@
 
 RETRO_BEGIN_DECLS
 
+/* The bundled headers predate these extensions */
+#ifndef VK_KHR_present_id
+#define VK_KHR_present_id 1
+#define VK_STRUCTURE_TYPE_PRESENT_ID_KHR ((VkStructureType)1000294000)
+#define VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR ((VkStructureType)1000294001)
+typedef struct VkPresentIdKHR
+{
+   VkStructureType sType;
+   const void *pNext;
+   uint32_t swapchainCount;
+   const uint64_t *pPresentIds;
+} VkPresentIdKHR;
+
+typedef struct VkPhysicalDevicePresentIdFeaturesKHR
+{
+   VkStructureType sType;
+   void *pNext;
+   VkBool32 presentId;
+} VkPhysicalDevicePresentIdFeaturesKHR;
+#endif
+
+#ifndef VK_KHR_present_wait
+#define VK_KHR_present_wait 1
+#define VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR ((VkStructureType)1000248000)
+typedef struct VkPhysicalDevicePresentWaitFeaturesKHR
+{
+   VkStructureType sType;
+   void *pNext;
+   VkBool32 presentWait;
+} VkPhysicalDevicePresentWaitFeaturesKHR;
+
+typedef VkResult (VKAPI_PTR *PFN_vkWaitForPresentKHR)(VkDevice device,
+      VkSwapchainKHR swapchain, uint64_t presentId, uint64_t timeout);
+#endif
+
 enum vk_texture_type
 {
    /* We will use the texture as a sampled linear texture. */
@@ -90,18 +135,52 @@ enum vulkan_wsi_type
    VULKAN_WSI_MVK_IOS,
 };
 
+struct vk_memory_pool;
+
+struct vk_memory_block
+{
+   VkDevice device;
+   VkDeviceMemory memory;
+   struct vk_memory_pool *pool;  /* NULL once the pool is gone */
+   struct vk_memory_block *next;
+   /* Stack of the indices of the free chunks */
+   uint16_t *free_chunks;
+   uint32_t memory_type;
+   unsigned chunk_shift;
+   unsigned num_chunks;
+   unsigned num_free;
+};
+
+struct vk_memory_pool
+{
+   struct vk_memory_block *blocks[VK_MAX_MEMORY_TYPES][VULKAN_MEMORY_CLASSES];
+};
+
 typedef struct vulkan_context
 {
    slock_t *queue_lock;
    retro_vulkan_destroy_device_t destroy_device;   /* ptr alignment */
+   /* Set if VK_KHR_present_id and VK_KHR_present_wait
+    * are enabled. Presents are then numbered, and
+    * vulkan_wait_for_present() waits on the last one */
+   PFN_vkWaitForPresentKHR wait_for_present;
+   /* Set if VK_KHR_push_descriptor is enabled. Quads and
+    * triangles then push their descriptors instead of
+    * allocating and writing a set for every draw */
+   PFN_vkCmdPushDescriptorSetKHR push_descriptor_set;
 
    VkInstance instance;
    VkPhysicalDevice gpu;
    VkDevice device;
    VkQueue queue;
+   /* Swapchain that present_id was presented to, if
+    * it can still be waited on */
+   VkSwapchainKHR present_swapchain;
+   uint64_t present_id;
 
    VkPhysicalDeviceProperties gpu_properties;
    VkPhysicalDeviceMemoryProperties memory_properties;
+   struct vk_memory_pool memory_pool;
 
    VkImage swapchain_images[VULKAN_MAX_SWAPCHAIN_IMAGES];
    VkFence swapchain_fences[VULKAN_MAX_SWAPCHAIN_IMAGES];
@@ -202,8 +281,11 @@ struct vk_image
 struct vk_texture
 {
    VkDeviceSize memory_size;     /* uint64_t alignment */
+   VkDeviceSize memory_offset;   /* uint64_t alignment */
 
    void *mapped;
+   /* Set if 'memory' is shared with other textures */
+   struct vk_memory_block *memory_block;
    VkImage image;                /* ptr alignment */
    VkImageView view;             /* ptr alignment */
    VkBuffer buffer;              /* ptr alignment */
@@ -306,6 +388,11 @@ struct vk_draw_triangles
 typedef struct vk
 {
    void *filter_chain;
+   /* Pipeline cache used by the preset filter chain,
+    * persisted to disk between sessions. */
+   VkPipelineCache filter_chain_cache;
+   size_t filter_chain_cache_size;
+   char filter_chain_cache_path[PATH_MAX_LENGTH];
    vulkan_context_t *context;
    void *ctx_data;
    const gfx_ctx_driver_t *ctx_driver;
@@ -337,6 +424,16 @@ typedef struct vk
    /* Staging pool for doing buffer transfers on GPU. */
    VkCommandPool staging_pool;
 
+   /* Two timestamps per frame in flight, bracketing
+    * each frame's command buffer */
+   struct
+   {
+      VkQueryPool pool;
+      retro_time_t gpu_time;
+      int queue_depth;
+      bool written[VULKAN_MAX_SWAPCHAIN_IMAGES];
+   } timestamps;
+
    struct
    {
       struct scaler_ctx scaler_bgr;
@@ -406,9 +503,12 @@ typedef struct vk
       uint32_t num_semaphores;
       uint32_t num_cmd;
       uint32_t src_queue_family;
+      /* Last core image format checked for blitting */
+      VkFormat blit_format;
 
       bool enable;
       bool valid_semaphore;
+      bool blit_supported;
    } hw;
 
    struct
@@ -427,6 +527,8 @@ typedef struct vk
    bool fullscreen;
    bool quitting;
    bool should_resize;
+   /* The stock shader is in use, rather than a preset */
+   bool default_filter_chain;
 
 } vk_t;
 
@@ -601,6 +703,27 @@ struct vk_texture vulkan_create_texture(vk_t *vk,
 
 void vulkan_transition_texture(vk_t *vk, VkCommandBuffer cmd, struct vk_texture *texture);
 
+/**
+ * vulkan_memory_alloc:
+ *
+ * Places an allocation with requirements @reqs in a chunk
+ * of a shared block of memory type @type.
+ *
+ * Returns: false if it is too large to share a block,
+ * or no block could be allocated.
+ **/
+bool vulkan_memory_alloc(struct vk_memory_pool *pool,
+      VkDevice device, const VkMemoryRequirements *reqs,
+      uint32_t type, struct vk_memory_block **block,
+      VkDeviceSize *offset);
+
+void vulkan_memory_free(struct vk_memory_block *block,
+      VkDeviceSize offset);
+
+/* Releases the unused blocks. Blocks still in use are
+ * released along with their last chunk. */
+void vulkan_memory_pool_deinit(struct vk_memory_pool *pool);
+
 void vulkan_destroy_texture(
       VkDevice device,
       struct vk_texture *tex);
@@ -735,6 +858,10 @@ void vulkan_present(gfx_ctx_vulkan_data_t *vk, unsigned index);
 
 void vulkan_acquire_next_image(gfx_ctx_vulkan_data_t *vk);
 
+/* Blocks until the last present has reached the
+ * screen, if the device can tell */
+void vulkan_wait_for_present(vulkan_context_t *ctx);
+
 bool vulkan_create_swapchain(gfx_ctx_vulkan_data_t *vk,
       unsigned width, unsigned height,
       unsigned swap_interval);
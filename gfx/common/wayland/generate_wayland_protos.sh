@@ -60,6 +60,7 @@ XDG_SHELL_UNSTABLE='unstable/xdg-shell/xdg-shell-unstable-v6.xml'
 XDG_SHELL='stable/xdg-shell/xdg-shell.xml'
 XDG_DECORATION_UNSTABLE='unstable/xdg-decoration/xdg-decoration-unstable-v1.xml'
 IDLE_INHIBIT_UNSTABLE='unstable/idle-inhibit/idle-inhibit-unstable-v1.xml'
+PRESENTATION_TIME='stable/presentation-time/presentation-time.xml'
 
 #Generate xdg-shell_v6 header and .c files
 "$WAYSCAN" client-header "$WAYLAND_PROTOS/$XDG_SHELL_UNSTABLE" ./xdg-shell-unstable-v6.h
@@ -76,3 +77,7 @@ IDLE_INHIBIT_UNSTABLE='unstable/idle-inhibit/idle-inhibit-unstable-v1.xml'
 #Generate xdg-decoration header and .c files
 "$WAYSCAN" client-header "$WAYLAND_PROTOS/$XDG_DECORATION_UNSTABLE" ./xdg-decoration-unstable-v1.h
 "$WAYSCAN" $CODEGEN "$WAYLAND_PROTOS/$XDG_DECORATION_UNSTABLE" ./xdg-decoration-unstable-v1.c
+
+#Generate presentation-time header and .c files
+"$WAYSCAN" client-header "$WAYLAND_PROTOS/$PRESENTATION_TIME" ./presentation-time.h
+"$WAYSCAN" $CODEGEN "$WAYLAND_PROTOS/$PRESENTATION_TIME" ./presentation-time.c
@@ -34,6 +34,12 @@
 #include <X11/extensions/Xinerama.h>
 #endif
 
+#ifdef HAVE_XPRESENT
+#include <time.h>
+#include <X11/extensions/Xpresent.h>
+#include <features/features_cpu.h>
+#endif
+
 #include "x11_common.h"
 
 #include <X11/extensions/xf86vmode.h>
@@ -78,6 +84,14 @@ static Atom XA_NET_MOVERESIZE_WINDOW;
 static Atom g_x11_quit_atom;
 static XIM g_x11_xim;
 static XIC g_x11_xic;
+#ifdef HAVE_XPRESENT
+static XID g_x11_present_eid                = None;
+static int g_x11_present_opcode             = -1;
+static int g_x11_present_mode               = -1;
+static bool g_x11_present_fullscreen        = false;
+static uint64_t g_x11_present_last_ust      = 0;
+static uint64_t g_x11_present_last_msc      = 0;
+#endif
 
 static void x11_hide_mouse(Display *dpy, Window win)
 {
@@ -508,6 +522,72 @@ static void x11_handle_key_event(unsigned keycode, XEvent *event, XIC ic, bool f
             chars[i], mod, RETRO_DEVICE_KEYBOARD);
 }
 
+#ifdef HAVE_XPRESENT
+/* A compositing manager owns the _NET_WM_CM_Sn selection */
+static bool x11_compositor_active(Display *dpy)
+{
+   char name[32];
+   snprintf(name, sizeof(name), "_NET_WM_CM_S%d", DefaultScreen(dpy));
+   return XGetSelectionOwner(dpy,
+         XInternAtom(dpy, name, False)) != None;
+}
+
+static void x11_present_complete(XPresentCompleteNotifyEvent *ce)
+{
+   struct timespec now;
+   retro_time_t presented, current;
+   retro_time_t interval = 0;
+
+   /* Skipped presents never reached the screen */
+   if (     ce->window != g_x11_win
+         || ce->kind   != PresentCompleteKindPixmap
+         || ce->mode   == PresentCompleteModeSkip)
+      return;
+
+   if (ce->mode != g_x11_present_mode)
+   {
+      bool composited    = ce->mode != PresentCompleteModeFlip
+         && x11_compositor_active(g_x11_dpy);
+
+      g_x11_present_mode = ce->mode;
+
+      RARCH_LOG("[X11]: Frames are %s.\n",
+            ce->mode == PresentCompleteModeFlip ? "flipped"
+            : composited ? "copied to the compositor" : "copied");
+      if (composited && g_x11_present_fullscreen)
+         RARCH_WARN("[X11]: Compositor is not bypassed in fullscreen,"
+               " this adds a frame of latency.\n");
+
+      video_driver_set_present_composited(composited);
+   }
+
+   /* UST is only good for timing on a steady MSC */
+   if (     g_x11_present_last_msc
+         && ce->msc > g_x11_present_last_msc
+         && ce->ust > g_x11_present_last_ust)
+      interval = (retro_time_t)((ce->ust - g_x11_present_last_ust)
+            / (ce->msc - g_x11_present_last_msc));
+
+   g_x11_present_last_ust = ce->ust;
+   g_x11_present_last_msc = ce->msc;
+
+   if (!interval || clock_gettime(CLOCK_MONOTONIC, &now) != 0)
+      return;
+
+   /* UST is CLOCK_MONOTONIC on the server. Move it over to
+    * the clock of cpu_features_get_time_usec(), and drop it
+    * altogether for remote servers with an unrelated clock. */
+   current   = cpu_features_get_time_usec();
+   presented = (retro_time_t)ce->ust + current
+      - ((retro_time_t)now.tv_sec * 1000000 + now.tv_nsec / 1000);
+
+   if (presented > current || current - presented > 1000000)
+      return;
+
+   video_driver_set_present_timing(presented, interval);
+}
+#endif
+
 bool x11_alive(void *data)
 {
    while (XPending(g_x11_dpy))
@@ -519,6 +599,21 @@ bool x11_alive(void *data)
       /* Can get events from older windows. Check this. */
       XNextEvent(g_x11_dpy, &event);
 
+#ifdef HAVE_XPRESENT
+      if (     event.type == GenericEvent
+            && event.xcookie.extension == g_x11_present_opcode)
+      {
+         if (XGetEventData(g_x11_dpy, &event.xcookie))
+         {
+            if (event.xcookie.evtype == PresentCompleteNotify)
+               x11_present_complete(
+                     (XPresentCompleteNotifyEvent*)event.xcookie.data);
+            XFreeEventData(g_x11_dpy, &event.xcookie);
+         }
+         continue;
+      }
+#endif
+
       /* IMPORTANT - Get keycode before XFilterEvent
          because the event is localizated after the call */
       keycode = event.xkey.keycode;
@@ -736,8 +831,43 @@ void x11_input_ctx_destroy(void)
    x11_destroy_input_context(&g_x11_xim, &g_x11_xic);
 }
 
+void x11_present_init(Display *dpy, Window win, bool fullscreen)
+{
+#ifdef HAVE_XPRESENT
+   int event_base, error_base;
+
+   if (!XPresentQueryExtension(dpy,
+            &g_x11_present_opcode, &event_base, &error_base))
+   {
+      g_x11_present_opcode = -1;
+      RARCH_LOG("[X11]: XPresent not available.\n");
+      return;
+   }
+
+   /* Swaps by GLX/EGL (DRI3) and Vulkan WSI go through Present
+    * on this window, so their completions get reported here */
+   g_x11_present_eid        = XPresentSelectInput(dpy, win,
+         PresentCompleteNotifyMask);
+   g_x11_present_mode       = -1;
+   g_x11_present_fullscreen = fullscreen;
+   g_x11_present_last_ust   = 0;
+   g_x11_present_last_msc   = 0;
+#endif
+}
+
 void x11_window_destroy(bool fullscreen)
 {
+#ifdef HAVE_XPRESENT
+   if (g_x11_present_eid != None)
+   {
+      if (g_x11_win)
+         XPresentFreeInput(g_x11_dpy, g_x11_win, g_x11_present_eid);
+      g_x11_present_eid = None;
+      video_driver_set_present_timing(0, 0);
+      video_driver_set_present_composited(false);
+   }
+#endif
+
    if (g_x11_win)
       XUnmapWindow(g_x11_dpy, g_x11_win);
    if (!fullscreen)
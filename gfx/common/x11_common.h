@@ -67,6 +67,10 @@ bool x11_input_ctx_new(bool true_full);
 
 void x11_input_ctx_destroy(void);
 
+/* Asks XPresent for the completion of every swap on @win,
+ * which is then handed to video_driver_set_present_timing() */
+void x11_present_init(Display *dpy, Window win, bool fullscreen);
+
 void x11_window_destroy(bool fullscreen);
 
 void x11_colormap_destroy(void);
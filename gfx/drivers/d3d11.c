@@ -553,6 +553,8 @@ static void d3d11_gfx_free(void* data)
    d3d11_free_shader_preset(d3d11);
 
    d3d11_release_texture(&d3d11->frame.texture[0]);
+   for (i = 0; i < D3D11_FRAME_STAGING_COUNT; i++)
+      Release(d3d11->frame.staging[i]);
    Release(d3d11->frame.ubo);
    Release(d3d11->frame.vbo);
 
@@ -1362,6 +1364,42 @@ error:
 #endif
 }
 
+/* Returns the next staging texture of the ring,
+ * (re)created to match 'texture' if needed. Falls
+ * back to the texture's own staging on failure */
+static D3D11Texture2D d3d11_get_frame_staging(
+      d3d11_video_t *d3d11, const d3d11_texture_t *texture)
+{
+   unsigned i                 = d3d11->frame.staging_index;
+   D3D11_TEXTURE2D_DESC *desc = &d3d11->frame.staging_desc[i];
+
+   d3d11->frame.staging_index = (i + 1) % D3D11_FRAME_STAGING_COUNT;
+
+   if (     !d3d11->frame.staging[i]
+         || desc->Width  != texture->desc.Width
+         || desc->Height != texture->desc.Height
+         || desc->Format != texture->desc.Format)
+   {
+      Release(d3d11->frame.staging[i]);
+
+      *desc                = texture->desc;
+      desc->MipLevels      = 1;
+      desc->BindFlags      = 0;
+      desc->MiscFlags      = 0;
+      desc->Usage          = D3D11_USAGE_STAGING;
+      desc->CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+      if (FAILED(D3D11CreateTexture2D(d3d11->device, desc,
+                  NULL, &d3d11->frame.staging[i])))
+      {
+         d3d11->frame.staging[i] = NULL;
+         return texture->staging;
+      }
+   }
+
+   return d3d11->frame.staging[i];
+}
+
 static bool d3d11_gfx_frame(
       void*               data,
       const void*         frame,
@@ -1500,8 +1538,10 @@ static bool d3d11_gfx_frame(
           hw_texture = NULL;
       }
       else
-         d3d11_update_texture(
-               context, width, height, pitch, d3d11->format, frame, &d3d11->frame.texture[0]);
+         d3d11_update_texture_staging(
+               context, width, height, pitch, d3d11->format, frame,
+               &d3d11->frame.texture[0],
+               d3d11_get_frame_staging(d3d11, &d3d11->frame.texture[0]));
    }
 
    D3D11SetRasterizerState(context, d3d11->scissor_disabled);
@@ -286,9 +286,11 @@ static void d3d12_update_viewport(void* data, bool force_full)
    d3d12->frame.viewport.MaxDepth = 0.0f;
    d3d12->frame.viewport.MaxDepth = 1.0f;
 
-   /* having to add vp.x and vp.y here doesn't make any sense */
-   d3d12->frame.scissorRect.top    = 0;
-   d3d12->frame.scissorRect.left   = 0;
+   /* D3D12_RECT holds edges, not a size. Keeping it tight
+    * around the viewport leaves the borders (which are only
+    * cleared) out of the rasterizer's work. */
+   d3d12->frame.scissorRect.top    = d3d12->vp.y;
+   d3d12->frame.scissorRect.left   = d3d12->vp.x;
    d3d12->frame.scissorRect.right  = d3d12->vp.x + d3d12->vp.width;
    d3d12->frame.scissorRect.bottom = d3d12->vp.y + d3d12->vp.height;
 
@@ -871,6 +873,8 @@ static void d3d12_gfx_free(void* data)
    Release(d3d12->queue.fence);
    Release(d3d12->chain.renderTargets[0]);
    Release(d3d12->chain.renderTargets[1]);
+   if (d3d12->chain.frame_latency_waitable)
+      CloseHandle(d3d12->chain.frame_latency_waitable);
    Release(d3d12->chain.handle);
 
    Release(d3d12->queue.cmd);
@@ -1171,6 +1175,19 @@ error:
 #endif
 }
 
+static void d3d12_gfx_wait_frame_latency(void *data)
+{
+   d3d12_video_t *d3d12 = (d3d12_video_t*)data;
+
+   if (     !d3d12
+         || !d3d12->chain.frame_latency_waitable
+         ||  d3d12->chain.frame_latency_waited)
+      return;
+
+   WaitForSingleObjectEx(d3d12->chain.frame_latency_waitable, 1000, TRUE);
+   d3d12->chain.frame_latency_waited = true;
+}
+
 static bool d3d12_gfx_frame(
       void*               data,
       const void*         frame,
@@ -1205,7 +1222,9 @@ static bool d3d12_gfx_frame(
       for (i = 0; i < countof(d3d12->chain.renderTargets); i++)
          Release(d3d12->chain.renderTargets[i]);
 
-      DXGIResizeBuffers(d3d12->chain.handle, 0, 0, 0, DXGI_FORMAT_UNKNOWN, DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING);
+      DXGIResizeBuffers(d3d12->chain.handle, 0, 0, 0, DXGI_FORMAT_UNKNOWN,
+            DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING
+            | DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT);
 
       for (i = 0; i < countof(d3d12->chain.renderTargets); i++)
       {
@@ -1227,6 +1246,11 @@ static bool d3d12_gfx_frame(
       video_driver_set_size(video_width, video_height);
    }
 
+   /* Every present has to be matched by a wait - this
+    * one only blocks if the runloop didn't wait already
+    * (menu, threaded video, ...) */
+   d3d12_gfx_wait_frame_latency(d3d12);
+
    D3D12ResetCommandAllocator(d3d12->queue.allocator);
 
    D3D12ResetGraphicsCommandList(
@@ -1616,6 +1640,7 @@ static bool d3d12_gfx_frame(
 #endif
 #if 1
    DXGIPresent(d3d12->chain.handle, sync_interval, present_flags);
+   d3d12->chain.frame_latency_waited = false;
 #else
    DXGI_PRESENT_PARAMETERS pp = { 0 };
    DXGIPresent1(d3d12->swapchain, 0, 0, &pp);
@@ -1890,6 +1915,8 @@ static const video_poke_interface_t d3d12_poke_interface = {
    d3d12_gfx_get_current_shader,
    NULL, /* get_current_software_framebuffer */
    NULL, /* get_hw_render_interface */
+   NULL, /* get_gpu_timing */
+   d3d12_gfx_wait_frame_latency,
 };
 
 static void d3d12_gfx_get_poke_interface(void* data, const video_poke_interface_t** iface)
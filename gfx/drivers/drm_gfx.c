@@ -317,20 +317,27 @@ static void drm_surface_update(void *data, const void *frame,
       struct drm_surface *surface)
 {
    struct drm_video *_drmvars  = data;
-   struct drm_page       *page = NULL;
+   struct modeset_buf     *buf = &surface->pages[surface->flip_page].buf;
    /* Frame blitting */
    int line                    = 0;
    int src_offset              = 0;
    int dst_offset              = 0;
 
-   for (line = 0; line < surface->src_height; line++)
+   /* The core rendered straight into the buffer we
+    * are about to scan out, see
+    * drm_get_current_software_framebuffer() */
+   if (frame != buf->map)
    {
-      memcpy (
-            surface->pages[surface->flip_page].buf.map + dst_offset,
-            (uint8_t*)frame + src_offset,
-            surface->pitch);
-      src_offset += surface->total_pitch;
-      dst_offset += surface->pitch;
+      for (line = 0; line < surface->src_height; line++)
+      {
+         memcpy (
+               buf->map + dst_offset,
+               (uint8_t*)frame + src_offset,
+               surface->pitch);
+         src_offset += surface->total_pitch;
+         /* Dumb buffers may be padded past the visible width */
+         dst_offset += buf->stride;
+      }
    }
 
    /* Page flipping */
@@ -793,6 +800,10 @@ static bool drm_gfx_frame(void *data, const void *frame, unsigned width,
       drm_plane_setup(_drmvars->main_surface);
    }
 
+   /* Cores rendering into our own buffer pass its pitch,
+    * which can differ from the one they used before */
+   _drmvars->main_surface->total_pitch = pitch;
+
 #ifdef HAVE_MENU
    menu_driver_frame(menu_is_alive, video_info);
 #endif
@@ -935,6 +946,48 @@ static void drm_set_aspect_ratio (void *data, unsigned aspect_ratio_idx)
    }
 }
 
+/* Hands the core the dumb buffer of the page that will be
+ * flipped next, so that it is scanned out without a copy.
+ * The buffer only exists once the first frame of the current
+ * size went through drm_gfx_frame(). */
+static bool drm_get_current_software_framebuffer(void *data,
+      struct retro_framebuffer *framebuffer)
+{
+   struct drm_video *_drmvars  = data;
+   struct drm_surface *surface = NULL;
+   struct modeset_buf     *buf = NULL;
+
+   if (!_drmvars || !_drmvars->main_surface)
+      return false;
+
+   surface = _drmvars->main_surface;
+
+   if (     framebuffer->width  != (unsigned)surface->src_width
+         || framebuffer->height != (unsigned)surface->src_height)
+      return false;
+
+   /* The mapping is write-combined, reading it back is slow */
+   if (framebuffer->access_flags & RETRO_MEMORY_ACCESS_READ)
+      return false;
+
+   /* 0RGB1555 goes through the frontend's converter anyway */
+   if (video_driver_get_pixel_format() == RETRO_PIXEL_FORMAT_0RGB1555)
+      return false;
+
+   buf = &surface->pages[surface->flip_page].buf;
+
+   if (!buf->map || buf->map == MAP_FAILED)
+      return false;
+
+   framebuffer->data         = buf->map;
+   framebuffer->pitch        = buf->stride;
+   framebuffer->format       = _drmvars->rgb32
+      ? RETRO_PIXEL_FORMAT_XRGB8888 : RETRO_PIXEL_FORMAT_RGB565;
+   framebuffer->memory_flags = 0;
+
+   return true;
+}
+
 static const video_poke_interface_t drm_poke_interface = {
    NULL, /* get_flags */
    NULL,
@@ -955,7 +1008,7 @@ static const video_poke_interface_t drm_poke_interface = {
    NULL,                         /* drm_show_mouse */
    NULL,                         /* grab_mouse_toggle */
    NULL,                         /* get_current_shader */
-   NULL,                         /* get_current_software_framebuffer */
+   drm_get_current_software_framebuffer,
    NULL                          /* get_hw_render_interface */
 };
 
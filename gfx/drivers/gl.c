@@ -54,6 +54,7 @@
 #include "../../configuration.h"
 #include "../../dynamic.h"
 
+#include "../../performance_counters.h"
 #include "../../retroarch.h"
 #include "../../verbosity.h"
 #include "../common/gl_common.h"
@@ -163,6 +164,8 @@ typedef struct gl2_renderchain_data
 
 #ifdef HAVE_GL_SYNC
    GLsync fences[MAX_FENCES];
+   /* Signalled once the async readback into the matching PBO is done */
+   GLsync readback_fences[4];
 #endif
 
    GLuint vao;
@@ -1301,12 +1304,23 @@ static bool gl2_renderchain_read_viewport(
    if (gl->pbo_readback_enable)
    {
       const uint8_t *ptr  = NULL;
+#if defined(HAVE_GL_SYNC) && !defined(HAVE_OPENGLES)
+      GLsync fence        = ((gl2_renderchain_data_t*)
+            gl->renderchain_data)->readback_fences[gl->pbo_readback_index];
+#endif
 
       /* Don't readback if we're in menu mode.
        * We haven't buffered up enough frames yet, come back later. */
       if (!gl->pbo_readback_valid[gl->pbo_readback_index])
          goto error;
 
+#if defined(HAVE_GL_SYNC) && !defined(HAVE_OPENGLES)
+      /* Mapping a PBO the GPU hasn't finished copying into would
+       * block until it has. Skip the frame instead of stalling. */
+      if (fence && glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+         goto error;
+#endif
+
       gl->pbo_readback_valid[gl->pbo_readback_index] = false;
       glBindBuffer(GL_PIXEL_PACK_BUFFER,
             gl->pbo_readback[gl->pbo_readback_index]);
@@ -1317,16 +1331,10 @@ static bool gl2_renderchain_read_viewport(
             0, num_pixels * sizeof(uint32_t), GL_MAP_READ_BIT);
 
       if (ptr)
-      {
-         unsigned y;
-         for (y = 0; y < gl->vp.height; y++)
-         {
-            video_frame_convert_rgba_to_bgr(
-                  (const void*)ptr,
-                  buffer,
-                  gl->vp.width);
-         }
-      }
+         video_frame_convert_rgba_to_bgr(
+               (const void*)ptr,
+               buffer,
+               num_pixels);
 #else
       ptr = (const uint8_t*)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
       if (ptr)
@@ -2489,17 +2497,30 @@ static void gl2_pbo_async_readback(gl_t *gl)
    GLenum type = GL_UNSIGNED_INT_8_8_8_8_REV;
 #endif
 
-   gl2_renderchain_bind_pbo(
-         gl->pbo_readback[gl->pbo_readback_index++]);
-   gl->pbo_readback_index &= 3;
+   unsigned index = gl->pbo_readback_index++;
 
-   /* 4 frames back, we can readback. */
-   gl->pbo_readback_valid[gl->pbo_readback_index] = true;
+   gl2_renderchain_bind_pbo(gl->pbo_readback[index]);
+   gl->pbo_readback_index &= 3;
 
    gl2_renderchain_readback(gl, gl->renderchain_data,
          gl2_get_alignment(gl->vp.width * sizeof(uint32_t)),
          fmt, type, NULL);
    gl2_renderchain_unbind_pbo();
+
+#if defined(HAVE_GL_SYNC) && !defined(HAVE_OPENGLES)
+   {
+      gl2_renderchain_data_t *chain = (gl2_renderchain_data_t*)
+         gl->renderchain_data;
+
+      if (chain->readback_fences[index])
+         glDeleteSync(chain->readback_fences[index]);
+      chain->readback_fences[index] = glFenceSync(
+            GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+   }
+#endif
+
+   /* Read back 3 frames later, when this PBO is the oldest. */
+   gl->pbo_readback_valid[index] = true;
 }
 
 #ifdef HAVE_VIDEO_LAYOUT
@@ -2510,19 +2531,20 @@ static float video_layout_layer_tex_coord[] = {
    1.0f, 0.0f,
 };
 
-static void gl2_video_layout_fbo_init(gl_t *gl, unsigned width, unsigned height)
+static void gl2_video_layout_fbo_init(gl_t *gl,
+      unsigned index, unsigned width, unsigned height)
 {
-   glGenTextures(1, &gl->video_layout_fbo_texture);
-   glBindTexture(GL_TEXTURE_2D, gl->video_layout_fbo_texture);
+   glGenTextures(1, &gl->video_layout_fbo_texture[index]);
+   glBindTexture(GL_TEXTURE_2D, gl->video_layout_fbo_texture[index]);
 
    gl2_load_texture_image(GL_TEXTURE_2D, 0, RARCH_GL_INTERNAL_FORMAT32,
       width, height, 0, GL_RGBA, GL_FLOAT, NULL);
 
-   gl2_gen_fb(1, &gl->video_layout_fbo);
-   gl2_bind_fb(gl->video_layout_fbo);
+   gl2_gen_fb(1, &gl->video_layout_fbo[index]);
+   gl2_bind_fb(gl->video_layout_fbo[index]);
 
    gl2_fb_texture_2d(RARCH_GL_FRAMEBUFFER, RARCH_GL_COLOR_ATTACHMENT0,
-      GL_TEXTURE_2D, gl->video_layout_fbo_texture, 0);
+      GL_TEXTURE_2D, gl->video_layout_fbo_texture[index], 0);
 
    if (gl2_check_fb_status(RARCH_GL_FRAMEBUFFER) != 
          RARCH_GL_FRAMEBUFFER_COMPLETE)
@@ -2533,16 +2555,21 @@ static void gl2_video_layout_fbo_init(gl_t *gl, unsigned width, unsigned height)
 
 static void gl2_video_layout_fbo_free(gl_t *gl)
 {
-   if (gl->video_layout_fbo)
-   {
-      gl2_delete_fb(1, &gl->video_layout_fbo);
-      gl->video_layout_fbo = 0;
-   }
+   unsigned i;
 
-   if (gl->video_layout_fbo_texture)
+   for (i = 0; i < VIDEO_LAYOUT_MAX_LAYERS; i++)
    {
-      glDeleteTextures(1, &gl->video_layout_fbo_texture);
-      gl->video_layout_fbo_texture = 0;
+      if (gl->video_layout_fbo[i])
+      {
+         gl2_delete_fb(1, &gl->video_layout_fbo[i]);
+         gl->video_layout_fbo[i] = 0;
+      }
+
+      if (gl->video_layout_fbo_texture[i])
+      {
+         glDeleteTextures(1, &gl->video_layout_fbo_texture[i]);
+         gl->video_layout_fbo_texture[i] = 0;
+      }
    }
 }
 
@@ -2553,10 +2580,8 @@ static void gl2_video_layout_viewport(gl_t *gl)
 
    if (gl->video_layout_resize)
    {
-      if (gl->video_layout_fbo)
-         gl2_video_layout_fbo_free(gl);
-
-      gl2_video_layout_fbo_init(gl, gl->video_width, gl->video_height);
+      /* Layers get their FBO when they are first rendered */
+      gl2_video_layout_fbo_free(gl);
 
       video_layout_view_change();
 
@@ -2588,15 +2613,63 @@ static void gl2_video_layout_viewport(gl_t *gl)
 static void gl2_video_layout_render(gl_t *gl)
 {
    int i;
+   int layers_count;
 
    if (!video_layout_valid())
       return;
 
+   layers_count = MIN(video_layout_layer_count(), VIDEO_LAYOUT_MAX_LAYERS);
+
    glViewport(0, 0, gl->video_width, gl->video_height);
    glEnable(GL_BLEND);
 
-   for (i = 0; i < video_layout_layer_count(); ++i)
-      video_layout_layer_render(i);
+   for (i = 0; i < layers_count; ++i)
+   {
+      bool redraw = true;
+
+      /* Layers only get drawn again when their elements
+       * changed, composing them is all it takes otherwise */
+      if (!gl->video_layout_fbo[i])
+         gl2_video_layout_fbo_init(gl, i,
+               gl->video_width, gl->video_height);
+      else
+         redraw = video_layout_layer_changed(i);
+
+      if (redraw)
+      {
+         gl2_bind_fb(gl->video_layout_fbo[i]);
+         video_layout_layer_render(i);
+      }
+
+      switch (video_layout_layer_blend(i))
+      {
+         case VIDEO_LAYOUT_BLEND_ALPHA:
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            break;
+         case VIDEO_LAYOUT_BLEND_ADD:
+            glBlendFunc(GL_ONE, GL_ONE);
+            break;
+         case VIDEO_LAYOUT_BLEND_MOD:
+            glBlendFunc(GL_DST_COLOR, GL_ZERO);
+            break;
+      }
+
+      gl->shader->use(gl, gl->shader_data,
+         VIDEO_SHADER_STOCK_BLEND, true);
+
+      gl->coords.vertex    = gl->vertex_ptr;
+      gl->coords.tex_coord = video_layout_layer_tex_coord;
+      gl->coords.color     = gl->white_color_ptr;
+      gl->coords.vertices  = 4;
+
+      gl->shader->set_coords(gl->shader_data, &gl->coords);
+      gl->shader->set_mvp(gl->shader_data, &gl->mvp_no_rot);
+
+      glBindTexture(GL_TEXTURE_2D, gl->video_layout_fbo_texture[i]);
+      glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+   }
+
+   gl->coords.tex_coord = gl->tex_info.coord;
 
    glDisable(GL_BLEND);
 }
@@ -2655,8 +2728,7 @@ static void gl2_video_layout_layer_begin(const video_layout_render_info_t *info)
    gl_t *gl;
    gl = (gl_t*)info->video_driver_data;
 
-   gl2_bind_fb(gl->video_layout_fbo);
-
+   /* The layer's FBO is bound by gl2_video_layout_render() */
    glClearColor(0, 0, 0, 0);
    glClear(GL_COLOR_BUFFER_BIT);
 
@@ -2752,36 +2824,8 @@ static void gl2_video_layout_led_seg(const video_layout_render_info_t *info, vid
 
 static void gl2_video_layout_layer_end(const video_layout_render_info_t *info, video_layout_blend_t blend_type)
 {
-   gl_t *gl;
-   gl = (gl_t*)info->video_driver_data;
-
-   switch (blend_type)
-   {
-   case VIDEO_LAYOUT_BLEND_ALPHA:
-      glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-      break;
-   case VIDEO_LAYOUT_BLEND_ADD:
-      glBlendFunc(GL_ONE, GL_ONE);
-      break;
-   case VIDEO_LAYOUT_BLEND_MOD:
-      glBlendFunc(GL_DST_COLOR, GL_ZERO);
-      break;
-   }
-
+   /* Composed with blend_type by gl2_video_layout_render() */
    gl2_bind_fb(0);
-
-   gl->coords.vertex = gl->vertex_ptr;
-   gl->coords.tex_coord = video_layout_layer_tex_coord;
-   gl->coords.color = gl->white_color_ptr;
-   gl->coords.vertices = 4;
-
-   gl->shader->set_coords(gl->shader_data, &gl->coords);
-   gl->shader->set_mvp(gl->shader_data, &gl->mvp_no_rot);
-
-   glBindTexture(GL_TEXTURE_2D, gl->video_layout_fbo_texture);
-   glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
-   gl->coords.tex_coord = gl->tex_info.coord;
 }
 
 static video_layout_render_interface_t gl2_video_layout_render_interface =
@@ -3215,6 +3259,18 @@ static void gl2_free(void *data)
 
    if (gl->pbo_readback_enable)
    {
+#if defined(HAVE_GL_SYNC) && !defined(HAVE_OPENGLES)
+      unsigned i;
+      gl2_renderchain_data_t *chain = (gl2_renderchain_data_t*)
+         gl->renderchain_data;
+
+      for (i = 0; i < 4; i++)
+      {
+         if (chain->readback_fences[i])
+            glDeleteSync(chain->readback_fences[i]);
+         chain->readback_fences[i] = NULL;
+      }
+#endif
       glDeleteBuffers(4, gl->pbo_readback);
       scaler_ctx_gen_reset(&gl->pbo_readback_scaler);
    }
@@ -3848,11 +3904,14 @@ static void *gl2_init(const video_info_t *video,
 
    RARCH_LOG("[GL]: Default shader backend found: %s.\n", gl->shader->ident);
 
+   perf_boot_begin(PERF_BOOT_SHADERS);
    if (!gl2_shader_init(gl, ctx_driver, hwr))
    {
+      perf_boot_end(PERF_BOOT_SHADERS);
       RARCH_ERR("[GL]: Shader initialization failed.\n");
       goto error;
    }
+   perf_boot_end(PERF_BOOT_SHADERS);
 
    {
       unsigned texture_info_id = gl->shader->get_prev_textures(gl->shader_data);
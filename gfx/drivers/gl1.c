@@ -395,6 +395,11 @@ static void *gl1_gfx_init(const video_info_t *video,
 
    gl1->smooth        = video_smooth;
    gl1->supports_bgra = string_list_find_elem(gl1->extensions, "GL_EXT_bgra");
+#ifdef GL_UNSIGNED_SHORT_5_6_5
+   /* Packed pixel types are core since GL 1.2 */
+   gl1->supports_rgb565 = gl1->version_major > 1
+      || (gl1->version_major == 1 && gl1->version_minor >= 2);
+#endif
 
    glDisable(GL_BLEND);
    glDisable(GL_DEPTH_TEST);
@@ -550,11 +555,11 @@ void gl1_gfx_set_viewport(gl1_t *gl1,
 #endif
 }
 
-static void draw_tex(gl1_t *gl1, int pot_width, int pot_height, int width, int height, GLuint tex, const void *frame_to_copy)
+static void draw_tex(gl1_t *gl1, int pot_width, int pot_height, int width, int height, GLuint tex, const void *frame_to_copy, bool rgb565)
 {
    uint8_t *frame       = NULL;
    uint8_t *frame_rgba  = NULL;
-   /* FIXME: For now, everything is uploaded as BGRA8888, I could not get 444 or 555 to work, and there is no 565 support in GL 1.1 either. */
+   /* FIXME: Apart from RGB565 frames on GL 1.2+, everything is uploaded as BGRA8888, I could not get 444 or 555 to work, and there is no 565 support in GL 1.1 either. */
    GLint internalFormat = GL_RGB8;
    GLenum format        = gl1->supports_bgra ? GL_BGRA_EXT : GL_RGBA;
    GLenum type          = GL_UNSIGNED_BYTE;
@@ -601,8 +606,17 @@ static void draw_tex(gl1_t *gl1, int pot_width, int pot_height, int width, int h
 #endif
    glBindTexture(GL_TEXTURE_2D, tex);
 
+#ifdef GL_UNSIGNED_SHORT_5_6_5
+   if (rgb565)
+   {
+      internalFormat    = GL_RGB;
+      format            = GL_RGB;
+      type              = GL_UNSIGNED_SHORT_5_6_5;
+   }
+#endif
+
    frame = (uint8_t*)frame_to_copy;
-   if (!gl1->supports_bgra)
+   if (!rgb565 && !gl1->supports_bgra)
    {
       frame_rgba = (uint8_t*)malloc(pot_width * pot_height * 4);
       if (frame_rgba)
@@ -786,6 +800,13 @@ static bool gl1_gfx_frame(void *data, const void *frame,
          for (y = 0; y < height; y++)
             memcpy(gl1->video_buf + ((pot_width * (bits / 8)) * y), (const unsigned char*)frame + (pitch * y), width * (bits / 8));
       }
+      else if (bits == 16 && gl1->supports_rgb565)
+      {
+         unsigned y;
+         /* Uploaded as is, the GPU unpacks it */
+         for (y = 0; y < height; y++)
+            memcpy(gl1->video_buf + ((pot_width * sizeof(uint16_t)) * y), (const unsigned char*)frame + (pitch * y), width * sizeof(uint16_t));
+      }
       else if (bits == 16)
          conv_rgb565_argb8888(gl1->video_buf, frame, width, height, pot_width * sizeof(unsigned), pitch);
 
@@ -812,7 +833,8 @@ static bool gl1_gfx_frame(void *data, const void *frame,
    
       if (frame_to_copy)
          draw_tex(gl1, pot_width, pot_height,
-               width, height, gl1->tex, frame_to_copy);
+               width, height, gl1->tex, frame_to_copy,
+               bits == 16 && gl1->supports_rgb565);
    }
 
 #ifdef HAVE_MENU
@@ -854,12 +876,12 @@ static bool gl1_gfx_frame(void *data, const void *frame,
          {
             glViewport(0, 0, video_width, video_height);
             draw_tex(gl1, pot_width, pot_height,
-                  width, height, gl1->menu_tex, frame_to_copy);
+                  width, height, gl1->menu_tex, frame_to_copy, false);
             glViewport(gl1->vp.x, gl1->vp.y, gl1->vp.width, gl1->vp.height);
          }
          else
             draw_tex(gl1, pot_width, pot_height,
-                  width, height, gl1->menu_tex, frame_to_copy);
+                  width, height, gl1->menu_tex, frame_to_copy, false);
       }
    }
 
@@ -37,6 +37,7 @@
 #include "../../state_manager.h"
 #endif
 
+#include "../../performance_counters.h"
 #include "../../retroarch.h"
 #include "../../verbosity.h"
 
@@ -192,6 +193,68 @@ static void gl_core_deinit_fences(gl_core_t *gl)
    memset(gl->fences, 0, sizeof(gl->fences));
 }
 
+static void gl_core_init_timer_queries(gl_core_t *gl)
+{
+#ifndef HAVE_OPENGLES
+   /* GL_TIME_ELAPSED is core since 3.3 */
+   if (gl->version_major > 3 ||
+         (gl->version_major == 3 && gl->version_minor >= 3))
+   {
+      glGenQueries(GL_CORE_NUM_TIMER_QUERIES, gl->timer_queries);
+      gl->timer_query_enable = true;
+   }
+#endif
+}
+
+static void gl_core_deinit_timer_queries(gl_core_t *gl)
+{
+#ifndef HAVE_OPENGLES
+   if (gl->timer_query_enable)
+      glDeleteQueries(GL_CORE_NUM_TIMER_QUERIES, gl->timer_queries);
+#endif
+   gl->timer_query_enable  = false;
+   gl->timer_query_pending = 0;
+   memset(gl->timer_queries, 0, sizeof(gl->timer_queries));
+}
+
+#ifndef HAVE_OPENGLES
+/* Collects whichever earlier frames the GPU has finished,
+ * then starts timing this one, without ever stalling */
+static void gl_core_begin_timer_query(gl_core_t *gl)
+{
+   gl->timer_query_active = false;
+
+   while (gl->timer_query_pending > 0)
+   {
+      GLint available = 0;
+      GLuint64 elapsed = 0;
+      GLuint query     = gl->timer_queries[
+         (gl->timer_query_index - gl->timer_query_pending)
+         & (GL_CORE_NUM_TIMER_QUERIES - 1)];
+
+      glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+      if (!available)
+      {
+         /* Out of queries - skip timing this frame */
+         if (gl->timer_query_pending == GL_CORE_NUM_TIMER_QUERIES)
+            return;
+         break;
+      }
+
+      glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+      gl->gpu_time = (retro_time_t)(elapsed / 1000);
+      gl->timer_query_pending--;
+   }
+
+   glBeginQuery(GL_TIME_ELAPSED,
+         gl->timer_queries[gl->timer_query_index]);
+   gl->timer_query_index = (gl->timer_query_index + 1)
+      & (GL_CORE_NUM_TIMER_QUERIES - 1);
+   gl->timer_query_pending++;
+   gl->timer_query_active = true;
+}
+#endif
+
 static bool gl_core_init_pbo_readback(gl_core_t *gl)
 {
    unsigned i;
@@ -234,9 +297,15 @@ static void gl_core_deinit_pbo_readback(gl_core_t *gl)
 {
    unsigned i;
    for (i = 0; i < GL_CORE_NUM_PBOS; i++)
+   {
       if (gl->pbo_readback[i] != 0)
          glDeleteBuffers(1, &gl->pbo_readback[i]);
+      if (gl->pbo_readback_fences[i])
+         glDeleteSync(gl->pbo_readback_fences[i]);
+   }
    memset(gl->pbo_readback, 0, sizeof(gl->pbo_readback));
+   memset(gl->pbo_readback_fences, 0, sizeof(gl->pbo_readback_fences));
+   memset(gl->pbo_readback_valid, 0, sizeof(gl->pbo_readback_valid));
    scaler_ctx_gen_reset(&gl->pbo_readback_scaler);
 }
 
@@ -254,9 +323,127 @@ static void gl_core_slow_readback(gl_core_t *gl, void *buffer)
                 GL_RGBA, GL_UNSIGNED_BYTE, buffer);
 }
 
+#ifndef HAVE_OPENGLES
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#endif
+
+static void gl_core_deinit_upload_buffer(gl_core_t *gl)
+{
+   unsigned i;
+
+   if (gl->upload_buffer != 0)
+   {
+      if (gl->upload_map)
+      {
+         glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gl->upload_buffer);
+         glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+         glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      }
+      glDeleteBuffers(1, &gl->upload_buffer);
+   }
+
+   for (i = 0; i < GL_CORE_NUM_UPLOAD_SLOTS; i++)
+   {
+      if (gl->upload_fences[i])
+         glDeleteSync(gl->upload_fences[i]);
+   }
+
+   gl->upload_buffer    = 0;
+   gl->upload_map       = NULL;
+   gl->upload_slot_size = 0;
+   gl->upload_index     = 0;
+   memset(gl->upload_fences, 0, sizeof(gl->upload_fences));
+}
+
+/* (Re)creates the upload buffer with slots of at least
+ * 'size' bytes. Copying frames into it and sourcing
+ * glTexSubImage2D() from there lets the driver DMA them
+ * from the buffer, instead of having to copy client
+ * memory before glTexSubImage2D() returns */
+static bool gl_core_init_upload_buffer(gl_core_t *gl, size_t size)
+{
+#ifdef HAVE_OPENGLES
+   return false;
+#else
+   GLbitfield flags = GL_MAP_WRITE_BIT
+      | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+   gl_core_deinit_upload_buffer(gl);
+
+   /* Keep every slot suitably aligned for any format */
+   size             = (size + 255) & ~(size_t)255;
+
+   glGenBuffers(1, &gl->upload_buffer);
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gl->upload_buffer);
+   glBufferStorage(GL_PIXEL_UNPACK_BUFFER,
+         size * GL_CORE_NUM_UPLOAD_SLOTS, NULL, flags);
+   gl->upload_map   = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,
+         0, size * GL_CORE_NUM_UPLOAD_SLOTS, flags);
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+   if (!gl->upload_map)
+   {
+      RARCH_WARN("[GLCore]: Failed to map upload buffer, "
+            "falling back to client memory uploads.\n");
+      gl_core_deinit_upload_buffer(gl);
+      gl->upload_buffer_enable = false;
+      return false;
+   }
+
+   gl->upload_slot_size = size;
+   return true;
+#endif
+}
+
+/* Copies a CPU frame into the next slot of the upload
+ * buffer, which is left bound to GL_PIXEL_UNPACK_BUFFER.
+ * Returns the slot's offset into it, or NULL (with no
+ * buffer bound) if uploads have to go from 'frame' */
+static const void *gl_core_upload_buffer_copy(gl_core_t *gl,
+      const void *frame, unsigned height, unsigned pitch,
+      size_t row_size)
+{
+   unsigned index;
+   size_t size = (size_t)pitch * (height - 1) + row_size;
+
+   if (!gl->upload_buffer_enable || !frame || height == 0)
+      return NULL;
+
+   if (size > gl->upload_slot_size
+         && !gl_core_init_upload_buffer(gl, (size_t)pitch * height))
+      return NULL;
+
+   index = gl->upload_index;
+
+   /* The slot was last read GL_CORE_NUM_UPLOAD_SLOTS frames
+    * ago, so this should hardly ever have to wait */
+   if (gl->upload_fences[index])
+   {
+      glClientWaitSync(gl->upload_fences[index],
+            GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+      glDeleteSync(gl->upload_fences[index]);
+      gl->upload_fences[index] = NULL;
+   }
+
+   memcpy(gl->upload_map + index * gl->upload_slot_size, frame, size);
+
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gl->upload_buffer);
+   return (const void*)(uintptr_t)(index * gl->upload_slot_size);
+}
+
+/* Readbacks go round a ring of PBOs, and gl_core_read_viewport()
+ * maps the oldest one, so the copy it waits on was issued
+ * GL_CORE_NUM_PBOS - 1 frames ago. */
 static void gl_core_pbo_async_readback(gl_core_t *gl)
 {
-   glBindBuffer(GL_PIXEL_PACK_BUFFER, gl->pbo_readback[gl->pbo_readback_index++]);
+   unsigned index = gl->pbo_readback_index++;
+
+   glBindBuffer(GL_PIXEL_PACK_BUFFER, gl->pbo_readback[index]);
    glPixelStorei(GL_PACK_ALIGNMENT, 4);
    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
 #ifndef HAVE_OPENGLES
@@ -264,12 +451,17 @@ static void gl_core_pbo_async_readback(gl_core_t *gl)
 #endif
    if (gl->pbo_readback_index >= GL_CORE_NUM_PBOS)
       gl->pbo_readback_index = 0;
-   gl->pbo_readback_valid[gl->pbo_readback_index] = true;
 
    glReadPixels(gl->vp.x, gl->vp.y,
                 gl->vp.width, gl->vp.height,
                 GL_RGBA, GL_UNSIGNED_BYTE, NULL);
    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+   if (gl->pbo_readback_fences[index])
+      glDeleteSync(gl->pbo_readback_fences[index]);
+   gl->pbo_readback_fences[index] = glFenceSync(
+         GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+   gl->pbo_readback_valid[index]  = true;
 }
 
 static void gl_core_fence_iterate(gl_core_t *gl, unsigned hard_sync_frames)
@@ -400,15 +592,23 @@ static void gl_core_free_overlay(gl_core_t *gl)
 {
    if (gl->overlay_tex)
       glDeleteTextures(gl->overlays, gl->overlay_tex);
+   if (gl->overlay_atlas)
+      glDeleteTextures(1, &gl->overlay_atlas);
+   if (gl->overlay_ibo)
+      glDeleteBuffers(1, &gl->overlay_ibo);
 
    free(gl->overlay_tex);
    free(gl->overlay_vertex_coord);
    free(gl->overlay_tex_coord);
    free(gl->overlay_color_coord);
+   free(gl->overlay_atlas_rect);
    gl->overlay_tex          = NULL;
    gl->overlay_vertex_coord = NULL;
    gl->overlay_tex_coord    = NULL;
    gl->overlay_color_coord  = NULL;
+   gl->overlay_atlas_rect   = NULL;
+   gl->overlay_atlas        = 0;
+   gl->overlay_ibo          = 0;
    gl->overlays             = 0;
 }
 
@@ -466,6 +666,16 @@ static void gl_core_overlay_tex_geom(void *data,
 
    tex          = (GLfloat*)&gl->overlay_tex_coord[image * 8];
 
+   /* Coordinates are relative to the image, not the atlas */
+   if (gl->overlay_atlas_rect)
+   {
+      const float *rect = &gl->overlay_atlas_rect[image * 4];
+      x            = rect[0] + x * rect[2];
+      y            = rect[1] + y * rect[3];
+      w           *= rect[2];
+      h           *= rect[3];
+   }
+
    tex[0]       = x;
    tex[1]       = y;
    tex[2]       = x + w;
@@ -506,11 +716,22 @@ static void gl_core_render_overlay(gl_core_t *gl,
    gl_core_bind_scratch_vbo(gl, gl->overlay_color_coord, 16 * sizeof(float) * gl->overlays);
    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)(uintptr_t)0);
 
-   for (i = 0; i < gl->overlays; i++)
+   glActiveTexture(GL_TEXTURE1);
+   if (gl->overlay_atlas)
    {
-      glActiveTexture(GL_TEXTURE1);
-      glBindTexture(GL_TEXTURE_2D, gl->overlay_tex[i]);
-      glDrawArrays(GL_TRIANGLE_STRIP, 4 * i, 4);
+      glBindTexture(GL_TEXTURE_2D, gl->overlay_atlas);
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl->overlay_ibo);
+      glDrawElements(GL_TRIANGLES, 6 * gl->overlays,
+            GL_UNSIGNED_INT, (void *)(uintptr_t)0);
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+   }
+   else
+   {
+      for (i = 0; i < gl->overlays; i++)
+      {
+         glBindTexture(GL_TEXTURE_2D, gl->overlay_tex[i]);
+         glDrawArrays(GL_TRIANGLE_STRIP, 4 * i, 4);
+      }
    }
 
    glDisableVertexAttribArray(0);
@@ -592,7 +813,9 @@ static void gl_core_destroy_resources(gl_core_t *gl)
    gl_core_free_scratch_vbos(gl);
 #endif
    gl_core_deinit_fences(gl);
+   gl_core_deinit_timer_queries(gl);
    gl_core_deinit_pbo_readback(gl);
+   gl_core_deinit_upload_buffer(gl);
    gl_core_deinit_hw_render(gl);
 }
 
@@ -967,6 +1190,8 @@ static bool gl_core_init_default_filter_chain(gl_core_t *gl)
       return false;
    }
 
+   gl_core_filter_chain_set_pass_timing(gl->filter_chain,
+         gl->timer_query_enable);
    return true;
 }
 
@@ -984,6 +1209,8 @@ static bool gl_core_init_filter_chain_preset(gl_core_t *gl, const char *shader_p
       return false;
    }
 
+   gl_core_filter_chain_set_pass_timing(gl->filter_chain,
+         gl->timer_query_enable);
    return true;
 }
 
@@ -1316,11 +1543,18 @@ static void *gl_core_init(const video_info_t *video,
             input, input_data);
    }
 
+   /* Before the filter chain, which times its passes
+    * with the same kind of queries */
+   gl_core_init_timer_queries(gl);
+
+   perf_boot_begin(PERF_BOOT_SHADERS);
    if (!gl_core_init_filter_chain(gl))
    {
+      perf_boot_end(PERF_BOOT_SHADERS);
       RARCH_ERR("[GLCore]: Failed to init filter chain.\n");
       goto error;
    }
+   perf_boot_end(PERF_BOOT_SHADERS);
 
    if (video->font_enable)
    {
@@ -1338,6 +1572,18 @@ static void *gl_core_init(const video_info_t *video,
       RARCH_LOG("[GLCore]: Async PBO readback enabled.\n");
    }
 
+#ifndef HAVE_OPENGLES
+   /* Core frames are uploaded through a persistently
+    * mapped buffer where available (core since 4.4) */
+   gl->upload_buffer_enable = glBufferStorage
+      && (gl->version_major > 4
+            || (gl->version_major == 4 && gl->version_minor >= 4)
+            || gl_query_extension("ARB_buffer_storage"));
+
+   if (gl->upload_buffer_enable)
+      RARCH_LOG("[GLCore]: Using persistently mapped buffer for frame uploads.\n");
+#endif
+
    if (!gl_check_error(&error_string))
    {
       RARCH_ERR("%s\n", error_string);
@@ -1434,6 +1680,159 @@ static void video_texture_load_gl_core(
 }
 
 #ifdef HAVE_OVERLAY
+/* Packs the overlay images into shelves of one texture.
+ * Every image gets a one texel border copied from its edges,
+ * so linear filtering behaves as with GL_CLAMP_TO_EDGE. */
+static bool gl_core_overlay_load_atlas(gl_core_t *gl,
+      const struct texture_image *images, unsigned num_images)
+{
+   unsigned i, j, y;
+   unsigned width     = 0;
+   unsigned height    = 0;
+   unsigned shelf_x   = 0;
+   unsigned shelf_y   = 0;
+   unsigned shelf_h   = 0;
+   uint64_t area      = 0;
+   GLint max_size     = 0;
+   unsigned *order    = NULL;
+   unsigned *pos      = NULL;
+   uint32_t *pixels   = NULL;
+   GLuint *indices    = NULL;
+   bool ret           = false;
+
+   glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+
+   for (i = 0; i < num_images; i++)
+   {
+      if (!images[i].pixels || !images[i].width || !images[i].height)
+         return false;
+      area += (uint64_t)(images[i].width + 2) * (images[i].height + 2);
+      if (images[i].width + 2 > width)
+         width = images[i].width + 2;
+   }
+
+   while ((uint64_t)width * width < area)
+      width = next_pow2(width + 1);
+   if (width > (unsigned)max_size)
+      return false;
+
+   order = (unsigned*)malloc(num_images * sizeof(*order));
+   pos   = (unsigned*)malloc(2 * num_images * sizeof(*pos));
+   if (!order || !pos)
+      goto end;
+
+   /* Tallest first keeps the shelves tight */
+   for (i = 0; i < num_images; i++)
+   {
+      for (j = i; j > 0 && images[order[j - 1]].height < images[i].height; j--)
+         order[j] = order[j - 1];
+      order[j] = i;
+   }
+
+   for (i = 0; i < num_images; i++)
+   {
+      const struct texture_image *image = &images[order[i]];
+
+      if (shelf_x + image->width + 2 > width)
+      {
+         shelf_y += shelf_h;
+         shelf_x  = 0;
+         shelf_h  = 0;
+      }
+
+      pos[2 * order[i] + 0] = shelf_x;
+      pos[2 * order[i] + 1] = shelf_y;
+      shelf_x              += image->width + 2;
+      if (image->height + 2 > shelf_h)
+         shelf_h = image->height + 2;
+   }
+
+   height = shelf_y + shelf_h;
+   if (height > (unsigned)max_size)
+      goto end;
+
+   if (!(pixels = (uint32_t*)calloc(width * height, sizeof(*pixels))))
+      goto end;
+   if (!(gl->overlay_atlas_rect = (float*)
+            calloc(4 * num_images, sizeof(float))))
+      goto end;
+
+   for (i = 0; i < num_images; i++)
+   {
+      const struct texture_image *image = &images[i];
+      unsigned w                        = image->width;
+      unsigned h                        = image->height;
+      uint32_t *dst                     = pixels
+         + pos[2 * i + 1] * width + pos[2 * i + 0];
+
+      for (y = 0; y < h + 2; y++)
+      {
+         unsigned src_y       = y == 0 ? 0 : (y > h ? h - 1 : y - 1);
+         const uint32_t *src  = image->pixels + src_y * w;
+         uint32_t *row        = dst + y * width;
+
+         row[0]               = src[0];
+         memcpy(row + 1, src, w * sizeof(*src));
+         row[w + 1]           = src[w - 1];
+      }
+
+      gl->overlay_atlas_rect[4 * i + 0] = (pos[2 * i + 0] + 1) / (float)width;
+      gl->overlay_atlas_rect[4 * i + 1] = (pos[2 * i + 1] + 1) / (float)height;
+      gl->overlay_atlas_rect[4 * i + 2] = w / (float)width;
+      gl->overlay_atlas_rect[4 * i + 3] = h / (float)height;
+   }
+
+   /* Two triangles per image, same winding as the strips */
+   if (!(indices = (GLuint*)malloc(6 * num_images * sizeof(*indices))))
+      goto end;
+   for (i = 0; i < num_images; i++)
+   {
+      indices[6 * i + 0] = 4 * i + 0;
+      indices[6 * i + 1] = 4 * i + 1;
+      indices[6 * i + 2] = 4 * i + 2;
+      indices[6 * i + 3] = 4 * i + 2;
+      indices[6 * i + 4] = 4 * i + 1;
+      indices[6 * i + 5] = 4 * i + 3;
+   }
+
+   glGenBuffers(1, &gl->overlay_ibo);
+   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl->overlay_ibo);
+   glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+         6 * num_images * sizeof(*indices), indices, GL_STATIC_DRAW);
+   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+   glGenTextures(1, &gl->overlay_atlas);
+   glBindTexture(GL_TEXTURE_2D, gl->overlay_atlas);
+   glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+   glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+   glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height,
+         GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_BLUE);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+   glBindTexture(GL_TEXTURE_2D, 0);
+
+   RARCH_LOG("[GLCore]: Packed %u overlay images into a %ux%u atlas.\n",
+         num_images, width, height);
+   ret = true;
+
+end:
+   if (!ret)
+   {
+      free(gl->overlay_atlas_rect);
+      gl->overlay_atlas_rect = NULL;
+   }
+   free(indices);
+   free(pixels);
+   free(pos);
+   free(order);
+   return ret;
+}
+
 static bool gl_core_overlay_load(void *data,
       const void *image_data, unsigned num_images)
 {
@@ -1447,11 +1846,17 @@ static bool gl_core_overlay_load(void *data,
       return false;
 
    gl_core_free_overlay(gl);
-   gl->overlay_tex = (GLuint*)
-      calloc(num_images, sizeof(*gl->overlay_tex));
 
-   if (!gl->overlay_tex)
-      return false;
+   /* Fall back to one texture and one draw per image
+    * when the images don't fit into a single texture */
+   if (!gl_core_overlay_load_atlas(gl, images, num_images))
+   {
+      gl->overlay_tex = (GLuint*)
+         calloc(num_images, sizeof(*gl->overlay_tex));
+
+      if (!gl->overlay_tex)
+         return false;
+   }
 
    gl->overlay_vertex_coord = (GLfloat*)
       calloc(2 * 4 * num_images, sizeof(GLfloat));
@@ -1466,12 +1871,14 @@ static bool gl_core_overlay_load(void *data,
       return false;
 
    gl->overlays = num_images;
-   glGenTextures(num_images, gl->overlay_tex);
 
    for (i = 0; i < num_images; i++)
    {
-      video_texture_load_gl_core(&images[i], TEXTURE_FILTER_LINEAR, &id);
-      gl->overlay_tex[i] = id;
+      if (gl->overlay_tex)
+      {
+         video_texture_load_gl_core(&images[i], TEXTURE_FILTER_LINEAR, &id);
+         gl->overlay_tex[i] = id;
+      }
 
       /* Default. Stretch to whole screen. */
       gl_core_overlay_tex_geom(gl, i, 0, 0, 1, 1);
@@ -1696,16 +2103,24 @@ static bool gl_core_read_viewport(void *data, uint8_t *buffer, bool is_idle)
       const void *ptr = NULL;
       struct scaler_ctx *ctx = &gl->pbo_readback_scaler;
 
+      GLsync fence           = gl->pbo_readback_fences[gl->pbo_readback_index];
+
       /* Don't readback if we're in menu mode.
        * We haven't buffered up enough frames yet, come back later. */
       if (!gl->pbo_readback_valid[gl->pbo_readback_index])
          goto error;
 
+      /* Mapping a PBO the GPU hasn't finished copying into would
+       * block until it has. Skip the frame instead of stalling. */
+      if (fence && glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+         goto error;
+
       gl->pbo_readback_valid[gl->pbo_readback_index] = false;
       glBindBuffer(GL_PIXEL_PACK_BUFFER, gl->pbo_readback[gl->pbo_readback_index]);
 
       ptr = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, num_pixels * sizeof(uint32_t), GL_MAP_READ_BIT);
-      scaler_ctx_scale_direct(ctx, buffer, ptr);
+      if (ptr)
+         scaler_ctx_scale_direct(ctx, buffer, ptr);
       glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
       glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
    }
@@ -1752,6 +2167,8 @@ static void gl_core_update_cpu_texture(gl_core_t *gl,
                                        struct gl_core_streamed_texture *streamed,
                                        const void *frame, unsigned width, unsigned height, unsigned pitch)
 {
+   const void *pixels = NULL;
+
    if (width != streamed->width || height != streamed->height)
    {
       if (streamed->tex != 0)
@@ -1773,19 +2190,32 @@ static void gl_core_update_cpu_texture(gl_core_t *gl,
       glBindTexture(GL_TEXTURE_2D, streamed->tex);
 
    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+   pixels = gl_core_upload_buffer_copy(gl, frame, height, pitch,
+         width * (gl->video_info.rgb32 ? 4 : 2));
+   if (!pixels)
+      pixels = frame;
+
    if (gl->video_info.rgb32)
    {
       glPixelStorei(GL_UNPACK_ROW_LENGTH, pitch >> 2);
       glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
       glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0,
-                      width, height, GL_RGBA, GL_UNSIGNED_BYTE, frame);
+                      width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
    }
    else
    {
       glPixelStorei(GL_UNPACK_ROW_LENGTH, pitch >> 1);
       glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
       glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0,
-                      width, height, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, frame);
+                      width, height, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, pixels);
+   }
+
+   if (pixels != frame)
+   {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      gl->upload_fences[gl->upload_index] = glFenceSync(
+            GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      gl->upload_index = (gl->upload_index + 1) % GL_CORE_NUM_UPLOAD_SLOTS;
    }
 }
 
@@ -1871,6 +2301,11 @@ static bool gl_core_frame(void *data, const void *frame,
    gl_core_context_bind_hw_render(gl, false);
    glBindVertexArray(gl->vao);
 
+#ifndef HAVE_OPENGLES
+   if (gl->timer_query_enable)
+      gl_core_begin_timer_query(gl);
+#endif
+
    if (frame)
       gl->textures_index = (gl->textures_index + 1) & (GL_CORE_NUM_TEXTURES - 1);
 
@@ -1988,6 +2423,10 @@ static bool gl_core_frame(void *data, const void *frame,
          gl_core_pbo_async_readback(gl);
    }
 
+#ifndef HAVE_OPENGLES
+   if (gl->timer_query_active)
+      glEndQuery(GL_TIME_ELAPSED);
+#endif
 
    if (gl->ctx_driver->swap_buffers)
       gl->ctx_driver->swap_buffers(gl->ctx_data);
@@ -2265,6 +2704,41 @@ static retro_proc_address_t gl_core_get_proc_address(
    return NULL;
 }
 
+static bool gl_core_get_gpu_timing(void *data,
+      retro_time_t *gpu_time, int *queue_depth)
+{
+   gl_core_t *gl = (gl_core_t*)data;
+
+   if (!gl || !gl->timer_query_enable)
+      return false;
+
+   *gpu_time    = gl->gpu_time;
+   *queue_depth = (int)gl->timer_query_pending;
+   return true;
+}
+
+static unsigned gl_core_get_shader_pass_timings(void *data,
+      retro_time_t *pass_time, unsigned max_passes)
+{
+   gl_core_t *gl = (gl_core_t*)data;
+
+   if (!gl || !gl->filter_chain)
+      return 0;
+
+   return gl_core_filter_chain_get_pass_timings(gl->filter_chain,
+         pass_time, max_passes);
+}
+
+static size_t gl_core_get_shader_memory_usage(void *data)
+{
+   gl_core_t *gl = (gl_core_t*)data;
+
+   if (!gl || !gl->filter_chain)
+      return 0;
+
+   return gl_core_filter_chain_get_memory_usage(gl->filter_chain);
+}
+
 static const video_poke_interface_t gl_core_poke_interface = {
    gl_core_get_flags,
    gl_core_load_texture,
@@ -2287,6 +2761,11 @@ static const video_poke_interface_t gl_core_poke_interface = {
    gl_core_get_current_shader,
    NULL,
    NULL,
+   gl_core_get_gpu_timing,
+   NULL,                               /* wait_frame_latency */
+   NULL,                               /* reconfigure */
+   gl_core_get_shader_pass_timings,
+   gl_core_get_shader_memory_usage
 };
 
 static void gl_core_get_poke_interface(void *data,
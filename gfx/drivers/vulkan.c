@@ -27,6 +27,9 @@
 #include <retro_math.h>
 #include <retro_assert.h>
 #include <string/stdstring.h>
+#include <file/file_path.h>
+#include <streams/file_stream.h>
+#include <encodings/crc32.h>
 #include <libretro.h>
 
 #ifdef HAVE_CONFIG_H
@@ -50,6 +53,7 @@
 #include "../../state_manager.h"
 #endif
 
+#include "../../performance_counters.h"
 #include "../../retroarch.h"
 #include "../../verbosity.h"
 
@@ -202,6 +206,8 @@ static void vulkan_init_pipeline_layout(
 
    set_layout_info.bindingCount   = 2;
    set_layout_info.pBindings      = bindings;
+   if (vk->context->push_descriptor_set)
+      set_layout_info.flags       = VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
 
    vkCreateDescriptorSetLayout(vk->context->device,
          &set_layout_info, NULL, &vk->pipelines.set_layout);
@@ -631,6 +637,10 @@ static void vulkan_init_descriptor_pool(vk_t *vk)
       { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VULKAN_DESCRIPTOR_MANAGER_BLOCK_SETS },
    };
 
+   /* Sets can't be allocated from a push descriptor layout */
+   if (vk->context->push_descriptor_set)
+      return;
+
    for (i = 0; i < vk->num_swapchain_images; i++)
    {
       vk->swapchain[i].descriptor_manager =
@@ -643,6 +653,8 @@ static void vulkan_init_descriptor_pool(vk_t *vk)
 static void vulkan_deinit_descriptor_pool(vk_t *vk)
 {
    unsigned i;
+   if (vk->context->push_descriptor_set)
+      return;
    for (i = 0; i < vk->num_swapchain_images; i++)
       vulkan_destroy_descriptor_manager(
             vk->context->device,
@@ -799,17 +811,178 @@ static bool vulkan_init_default_filter_chain(vk_t *vk)
       return false;
    }
 
+   vk->default_filter_chain   = true;
    return true;
 }
 
+/* Builds the on-disk location of the pipeline cache for a preset.
+ * The name is keyed by the driver's pipeline cache UUID,
+ * the device ID and a hash of the preset, so a driver update,
+ * another GPU or an edited preset never picks up a stale blob. */
+static bool vulkan_filter_chain_cache_path(vk_t *vk,
+      const char *shader_path, char *s, size_t len)
+{
+   unsigned i;
+   char name[128];
+   char uuid[2 * VK_UUID_SIZE + 1];
+   int64_t preset_size                    = 0;
+   void *preset_data                      = NULL;
+   uint32_t hash                          = 0;
+   settings_t *settings                   = config_get_ptr();
+   const char *dir_cache                  = settings->paths.directory_cache;
+   const VkPhysicalDeviceProperties *prop = &vk->context->gpu_properties;
+
+   if (string_is_empty(dir_cache))
+      return false;
+
+   hash = encoding_crc32(0, (const uint8_t*)shader_path, strlen(shader_path));
+   if (filestream_read_file(shader_path, &preset_data, &preset_size))
+   {
+      hash = encoding_crc32(hash, (const uint8_t*)preset_data,
+            (size_t)preset_size);
+      free(preset_data);
+   }
+
+   for (i = 0; i < VK_UUID_SIZE; i++)
+      snprintf(uuid + 2 * i, 3, "%02x", prop->pipelineCacheUUID[i]);
+
+   snprintf(name, sizeof(name), "vulkan_%s_%08x_%08x.pcache",
+         uuid, (unsigned)prop->deviceID, (unsigned)hash);
+   fill_pathname_join(s, dir_cache, name, len);
+   return true;
+}
+
+/* Checks the VkPipelineCacheHeaderVersionOne header of a cache blob
+ * against the current device. Some drivers do not validate it
+ * themselves and misbehave when fed data from another device. */
+static bool vulkan_filter_chain_cache_valid(vk_t *vk,
+      const uint8_t *data, size_t size)
+{
+   uint32_t header_size, header_version, vendor_id, device_id;
+   const VkPhysicalDeviceProperties *prop = &vk->context->gpu_properties;
+
+   if (size < 16 + VK_UUID_SIZE)
+      return false;
+
+   memcpy(&header_size,    data +  0, sizeof(uint32_t));
+   memcpy(&header_version, data +  4, sizeof(uint32_t));
+   memcpy(&vendor_id,      data +  8, sizeof(uint32_t));
+   memcpy(&device_id,      data + 12, sizeof(uint32_t));
+
+   return header_size    >= 16 + VK_UUID_SIZE
+      && header_size     <= size
+      && header_version  == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+      && vendor_id       == prop->vendorID
+      && device_id       == prop->deviceID
+      && !memcmp(data + 16, prop->pipelineCacheUUID, VK_UUID_SIZE);
+}
+
+static void vulkan_init_filter_chain_cache(vk_t *vk, const char *shader_path)
+{
+   VkPipelineCacheCreateInfo cache = {
+      VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+   int64_t size                    = 0;
+   void *data                      = NULL;
+
+   vk->filter_chain_cache          = VK_NULL_HANDLE;
+   vk->filter_chain_cache_size     = 0;
+   vk->filter_chain_cache_path[0]  = '\0';
+
+   if (!vulkan_filter_chain_cache_path(vk, shader_path,
+            vk->filter_chain_cache_path,
+            sizeof(vk->filter_chain_cache_path)))
+      return;
+
+   if (path_is_valid(vk->filter_chain_cache_path)
+         && filestream_read_file(vk->filter_chain_cache_path, &data, &size))
+   {
+      if (vulkan_filter_chain_cache_valid(vk,
+               (const uint8_t*)data, (size_t)size))
+      {
+         cache.initialDataSize = (size_t)size;
+         cache.pInitialData    = data;
+      }
+      else
+         RARCH_WARN("[Vulkan]: Ignoring incompatible pipeline cache \"%s\".\n",
+               vk->filter_chain_cache_path);
+   }
+
+   if (vkCreatePipelineCache(vk->context->device,
+            &cache, NULL, &vk->filter_chain_cache) != VK_SUCCESS)
+   {
+      /* Retry without the seed in case the driver rejected it. */
+      cache.initialDataSize = 0;
+      cache.pInitialData    = NULL;
+      if (vkCreatePipelineCache(vk->context->device,
+               &cache, NULL, &vk->filter_chain_cache) != VK_SUCCESS)
+         vk->filter_chain_cache = VK_NULL_HANDLE;
+   }
+   else if (cache.pInitialData)
+   {
+      vk->filter_chain_cache_size = cache.initialDataSize;
+      RARCH_LOG("[Vulkan]: Loaded pipeline cache \"%s\".\n",
+            vk->filter_chain_cache_path);
+   }
+
+   free(data);
+}
+
+static void vulkan_deinit_filter_chain_cache(vk_t *vk)
+{
+   size_t size = 0;
+   void *data  = NULL;
+
+   if (vk->filter_chain_cache == VK_NULL_HANDLE)
+      return;
+
+   /* Only write back when the driver added something. */
+   if (     !string_is_empty(vk->filter_chain_cache_path)
+         && vkGetPipelineCacheData(vk->context->device,
+            vk->filter_chain_cache, &size, NULL) == VK_SUCCESS
+         && size != vk->filter_chain_cache_size
+         && (data = malloc(size)))
+   {
+      if (vkGetPipelineCacheData(vk->context->device,
+               vk->filter_chain_cache, &size, data) == VK_SUCCESS
+            && vulkan_filter_chain_cache_valid(vk,
+               (const uint8_t*)data, size))
+      {
+         if (filestream_write_file(vk->filter_chain_cache_path,
+                  data, (int64_t)size))
+            RARCH_LOG("[Vulkan]: Saved pipeline cache \"%s\".\n",
+                  vk->filter_chain_cache_path);
+      }
+      free(data);
+   }
+
+   vkDestroyPipelineCache(vk->context->device,
+         vk->filter_chain_cache, NULL);
+   vk->filter_chain_cache         = VK_NULL_HANDLE;
+   vk->filter_chain_cache_size    = 0;
+   vk->filter_chain_cache_path[0] = '\0';
+}
+
+static void vulkan_deinit_filter_chain(vk_t *vk)
+{
+   if (vk->filter_chain)
+      vulkan_filter_chain_free((vulkan_filter_chain_t*)vk->filter_chain);
+   vk->filter_chain = NULL;
+
+   vulkan_deinit_filter_chain_cache(vk);
+}
+
 static bool vulkan_init_filter_chain_preset(vk_t *vk, const char *shader_path)
 {
    struct vulkan_filter_chain_create_info info;
 
+   vulkan_init_filter_chain_cache(vk, shader_path);
+
    info.device                = vk->context->device;
    info.gpu                   = vk->context->gpu;
    info.memory_properties     = &vk->context->memory_properties;
-   info.pipeline_cache        = vk->pipelines.cache;
+   info.pipeline_cache        = vk->filter_chain_cache != VK_NULL_HANDLE
+      ? vk->filter_chain_cache
+      : vk->pipelines.cache;
    info.queue                 = vk->context->queue;
    info.command_pool          = vk->swapchain[vk->context->current_frame_index].cmd_pool;
    info.num_passes            = 0;
@@ -830,9 +1003,11 @@ static bool vulkan_init_filter_chain_preset(vk_t *vk, const char *shader_path)
    if (!vk->filter_chain)
    {
       RARCH_ERR("[Vulkan]: Failed to create preset: \"%s\".\n", shader_path);
+      vulkan_deinit_filter_chain_cache(vk);
       return false;
    }
 
+   vk->default_filter_chain   = false;
    return true;
 }
 
@@ -904,6 +1079,19 @@ static void vulkan_init_static_resources(vk_t *vk)
    vk->display.blank_texture = vulkan_create_texture(vk, NULL,
          4, 4, VK_FORMAT_B8G8R8A8_UNORM,
          blank, NULL, VULKAN_TEXTURE_STATIC);
+
+   if (vk->context->gpu_properties.limits.timestampComputeAndGraphics)
+   {
+      VkQueryPoolCreateInfo query_info = {
+         VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
+
+      query_info.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+      query_info.queryCount = VULKAN_MAX_SWAPCHAIN_IMAGES * 2;
+
+      if (vkCreateQueryPool(vk->context->device,
+               &query_info, NULL, &vk->timestamps.pool) != VK_SUCCESS)
+         vk->timestamps.pool = VK_NULL_HANDLE;
+   }
 }
 
 static void vulkan_deinit_static_resources(vk_t *vk)
@@ -917,6 +1105,11 @@ static void vulkan_deinit_static_resources(vk_t *vk)
 
    vkDestroyCommandPool(vk->context->device,
          vk->staging_pool, NULL);
+   if (vk->timestamps.pool != VK_NULL_HANDLE)
+      vkDestroyQueryPool(vk->context->device,
+            vk->timestamps.pool, NULL);
+   vk->timestamps.pool = VK_NULL_HANDLE;
+   memset(vk->timestamps.written, 0, sizeof(vk->timestamps.written));
    free(vk->hw.cmd);
    free(vk->hw.wait_dst_stages);
    free(vk->hw.semaphores);
@@ -928,6 +1121,37 @@ static void vulkan_deinit_static_resources(vk_t *vk)
                &vk->readback.staging[i]);
 }
 
+/* Called once the fence of frame_index has been waited on,
+ * so its own timestamps are ready; the other frames in
+ * flight that are not make up the queue depth */
+static void vulkan_update_gpu_timing(vk_t *vk, unsigned frame_index)
+{
+   unsigned i;
+   uint64_t ts[2];
+   int queue_depth = 0;
+
+   for (i = 0; i < VULKAN_MAX_SWAPCHAIN_IMAGES; i++)
+   {
+      VkResult res;
+
+      if (!vk->timestamps.written[i])
+         continue;
+
+      res = vkGetQueryPoolResults(vk->context->device,
+            vk->timestamps.pool, i * 2, 2, sizeof(ts), ts,
+            sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+
+      if (res == VK_NOT_READY)
+         queue_depth++;
+      else if (res == VK_SUCCESS && i == frame_index && ts[1] >= ts[0])
+         vk->timestamps.gpu_time = (retro_time_t)((double)(ts[1] - ts[0])
+               * vk->context->gpu_properties.limits.timestampPeriod
+               / 1000.0);
+   }
+
+   vk->timestamps.queue_depth = queue_depth;
+}
+
 static void vulkan_deinit_resources(vk_t *vk)
 {
    vulkan_deinit_pipelines(vk);
@@ -979,8 +1203,7 @@ static void vulkan_free(void *data)
       vulkan_overlay_free(vk);
 #endif
 
-      if (vk->filter_chain)
-         vulkan_filter_chain_free((vulkan_filter_chain_t*)vk->filter_chain);
+      vulkan_deinit_filter_chain(vk);
 
       if (vk->ctx_driver && vk->ctx_driver->destroy)
          vk->ctx_driver->destroy(vk->ctx_data);
@@ -1281,11 +1504,14 @@ static void *vulkan_init(const video_info_t *video,
    vulkan_init_static_resources(vk);
    vulkan_init_resources(vk);
 
+   perf_boot_begin(PERF_BOOT_SHADERS);
    if (!vulkan_init_filter_chain(vk))
    {
+      perf_boot_end(PERF_BOOT_SHADERS);
       RARCH_ERR("[Vulkan]: Failed to init filter chain.\n");
       goto error;
    }
+   perf_boot_end(PERF_BOOT_SHADERS);
 
    if (vk->ctx_driver->input_driver)
    {
@@ -1414,9 +1640,7 @@ static bool vulkan_set_shader(void *data,
    if (!vk)
       return false;
 
-   if (vk->filter_chain)
-      vulkan_filter_chain_free((vulkan_filter_chain_t*)vk->filter_chain);
-   vk->filter_chain = NULL;
+   vulkan_deinit_filter_chain(vk);
 
    if (!string_is_empty(path) && type != RARCH_SHADER_SLANG)
    {
@@ -1720,6 +1944,142 @@ static void vulkan_inject_black_frame(vk_t *vk, video_frame_info_t *video_info,
       vk->ctx_driver->swap_buffers(context_data);
 }
 
+/* Whether the core's image can be blitted into the swapchain,
+ * which then has to support that for the given format */
+static bool vulkan_hw_format_supports_blit(vk_t *vk, VkFormat format)
+{
+   VkFormatProperties src_props;
+   VkFormatProperties dst_props;
+   VkFormatFeatureFlags src_features = VK_FORMAT_FEATURE_BLIT_SRC_BIT;
+
+   if (format == vk->hw.blit_format)
+      return vk->hw.blit_supported;
+
+   if (vk->video.smooth)
+      src_features |= VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+   vkGetPhysicalDeviceFormatProperties(vk->context->gpu,
+         format, &src_props);
+   vkGetPhysicalDeviceFormatProperties(vk->context->gpu,
+         vk->context->swapchain_format, &dst_props);
+
+   vk->hw.blit_format    = format;
+   vk->hw.blit_supported =
+         ((src_props.optimalTilingFeatures & src_features) == src_features)
+      && (dst_props.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_DST_BIT);
+
+   return vk->hw.blit_supported;
+}
+
+/* The stock shader does nothing but scale the core's image
+ * into the viewport. With nothing drawn on top of it,
+ * a single blit does the same without a render pass,
+ * pipeline or descriptor set. */
+static bool vulkan_can_blit_hw_frame(vk_t *vk,
+      struct vk_image *backbuffer, bool draws_on_top)
+{
+   if (     !vk->hw.enable
+         || !vk->hw.image
+         || !vk->default_filter_chain
+         ||  draws_on_top
+         ||  vk->menu.enable
+         ||  vk->overlay.enable
+         ||  vk->rotation != 0
+         ||  vk->readback.pending
+         ||  vk->readback.streamed
+         ||  backbuffer->image == VK_NULL_HANDLE
+         || !vk->context->has_acquired_swapchain)
+      return false;
+
+   /* Unlike the viewport, a blit cannot reach
+    * outside of the swapchain image */
+   if (     vk->vp.x < 0
+         || vk->vp.y < 0
+         || vk->vp.width  == 0
+         || vk->vp.height == 0
+         || vk->vp.x + vk->vp.width  > vk->context->swapchain_width
+         || vk->vp.y + vk->vp.height > vk->context->swapchain_height)
+      return false;
+
+   return vulkan_hw_format_supports_blit(vk,
+         vk->hw.image->create_info.format);
+}
+
+static void vulkan_blit_hw_frame(vk_t *vk, struct vk_image *backbuffer)
+{
+   VkImageBlit blit;
+   const VkClearColorValue clear_color = {{ 0.0f, 0.0f, 0.0f, 0.0f }};
+   const VkImageSubresourceRange range = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+   VkImage image                       = vk->hw.image->create_info.image;
+   VkImageLayout layout                = vk->hw.image->image_layout;
+
+   VULKAN_IMAGE_LAYOUT_TRANSITION(vk->cmd, backbuffer->image,
+         VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+         0, VK_ACCESS_TRANSFER_WRITE_BIT,
+         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+         VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+   /* Only the borders around the viewport need clearing */
+   if (     vk->vp.width  != vk->context->swapchain_width
+         || vk->vp.height != vk->context->swapchain_height)
+   {
+      vkCmdClearColorImage(vk->cmd, backbuffer->image,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clear_color, 1, &range);
+
+      VULKAN_IMAGE_LAYOUT_TRANSITION(vk->cmd, backbuffer->image,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT);
+   }
+
+   /* Chains onto the semaphore wait, like sampling would */
+   VULKAN_IMAGE_LAYOUT_TRANSITION(vk->cmd, image,
+         layout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+         VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+         | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+         VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+   blit.srcSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+   blit.srcSubresource.mipLevel       = 0;
+   blit.srcSubresource.baseArrayLayer = 0;
+   blit.srcSubresource.layerCount     = 1;
+   blit.srcOffsets[0].x               = 0;
+   blit.srcOffsets[0].y               = 0;
+   blit.srcOffsets[0].z               = 0;
+   blit.srcOffsets[1].x               = vk->hw.last_width;
+   blit.srcOffsets[1].y               = vk->hw.last_height;
+   blit.srcOffsets[1].z               = 1;
+   blit.dstSubresource                = blit.srcSubresource;
+   blit.dstOffsets[0].x               = vk->vp.x;
+   blit.dstOffsets[0].y               = vk->vp.y;
+   blit.dstOffsets[0].z               = 0;
+   blit.dstOffsets[1].x               = vk->vp.x + vk->vp.width;
+   blit.dstOffsets[1].y               = vk->vp.y + vk->vp.height;
+   blit.dstOffsets[1].z               = 1;
+
+   vkCmdBlitImage(vk->cmd,
+         image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+         backbuffer->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+         1, &blit,
+         vk->video.smooth ? VK_FILTER_LINEAR : VK_FILTER_NEAREST);
+
+   /* Hand the image back to the core in the layout it gave us */
+   VULKAN_IMAGE_LAYOUT_TRANSITION(vk->cmd, image,
+         VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, layout,
+         0, 0,
+         VK_PIPELINE_STAGE_TRANSFER_BIT,
+         VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT);
+
+   VULKAN_IMAGE_LAYOUT_TRANSITION(vk->cmd, backbuffer->image,
+         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+         VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_MEMORY_READ_BIT,
+         VK_PIPELINE_STAGE_TRANSFER_BIT,
+         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+}
+
 static bool vulkan_frame(void *data, const void *frame,
       unsigned frame_width, unsigned frame_height,
       uint64_t frame_count,
@@ -1733,6 +2093,7 @@ static bool vulkan_frame(void *data, const void *frame,
    VkSemaphore signal_semaphores[2];
    vk_t *vk                                      = (vk_t*)data;
    bool waits_for_semaphores                     = false;
+   bool blit_hw_frame                            = false;
    unsigned width                                = video_info->width;
    unsigned height                               = video_info->height;
    bool statistics_show                          = video_info->statistics_show;
@@ -1784,6 +2145,15 @@ static bool vulkan_frame(void *data, const void *frame,
 
    vkBeginCommandBuffer(vk->cmd, &begin_info);
 
+   if (vk->timestamps.pool != VK_NULL_HANDLE)
+   {
+      vulkan_update_gpu_timing(vk, frame_index);
+      vkCmdResetQueryPool(vk->cmd, vk->timestamps.pool,
+            frame_index * 2, 2);
+      vkCmdWriteTimestamp(vk->cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+            vk->timestamps.pool, frame_index * 2);
+   }
+
    vk->tracker.dirty                 = 0;
    vk->tracker.scissor.offset.x      = 0;
    vk->tracker.scissor.offset.y      = 0;
@@ -1960,9 +2330,18 @@ static bool vulkan_frame(void *data, const void *frame,
 
    vulkan_set_viewport(vk, width, height, false, true);
 
-   vulkan_filter_chain_build_offscreen_passes(
-         (vulkan_filter_chain_t*)vk->filter_chain,
-         vk->cmd, &vk->vk_vp);
+   blit_hw_frame = vulkan_can_blit_hw_frame(vk, backbuffer,
+            statistics_show
+         || !string_is_empty(msg)
+#ifdef HAVE_GFX_WIDGETS
+         || widgets_active
+#endif
+         );
+
+   if (!blit_hw_frame)
+      vulkan_filter_chain_build_offscreen_passes(
+            (vulkan_filter_chain_t*)vk->filter_chain,
+            vk->cmd, &vk->vk_vp);
 
 #if defined(HAVE_MENU)
    /* Upload menu texture. */
@@ -1991,7 +2370,9 @@ static bool vulkan_frame(void *data, const void *frame,
 #endif
 
    /* Render to backbuffer. */
-   if (     (backbuffer->image != VK_NULL_HANDLE)
+   if (blit_hw_frame)
+      vulkan_blit_hw_frame(vk, backbuffer);
+   else if ((backbuffer->image != VK_NULL_HANDLE)
          && vk->context->has_acquired_swapchain)
    {
       rp_info.sType                    = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -2095,8 +2476,10 @@ static bool vulkan_frame(void *data, const void *frame,
     */
    vulkan_filter_chain_end_frame((vulkan_filter_chain_t*)vk->filter_chain, vk->cmd);
 
+   /* The blit already left the backbuffer ready to present */
    if ( 
-         backbuffer->image != VK_NULL_HANDLE
+         !blit_hw_frame
+         && backbuffer->image != VK_NULL_HANDLE
          && vk->context->has_acquired_swapchain
       )
    {
@@ -2164,6 +2547,13 @@ static bool vulkan_frame(void *data, const void *frame,
             vk->context->graphics_queue_index, vk->hw.src_queue_family);
    }
 
+   if (vk->timestamps.pool != VK_NULL_HANDLE)
+   {
+      vkCmdWriteTimestamp(vk->cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+            vk->timestamps.pool, frame_index * 2 + 1);
+      vk->timestamps.written[frame_index] = true;
+   }
+
    vkEndCommandBuffer(vk->cmd);
 
    /* Submit command buffers to GPU. */
@@ -2334,6 +2724,31 @@ static void vulkan_apply_state_changes(void *data)
       vk->should_resize = true;
 }
 
+static bool vulkan_reconfigure(void *data, unsigned flags)
+{
+   vk_t *vk = (vk_t*)data;
+
+   if (!vk || (flags & ~VIDEO_RECONFIGURE_SWAPCHAIN))
+      return false;
+
+   if (flags & VIDEO_RECONFIGURE_SWAPCHAIN)
+   {
+      if (!vk->ctx_driver->set_resize)
+         return false;
+
+      /* Marked invalid, the swapchain gets recreated even
+       * though its size is the same. Only the resources that
+       * depend on it are rebuilt, textures and shaders stay. */
+      vk->context->invalid_swapchain = true;
+      if (!vk->ctx_driver->set_resize(vk->ctx_data,
+               vk->video_width, vk->video_height))
+         return false;
+      vulkan_check_swapchain(vk);
+   }
+
+   return true;
+}
+
 static void vulkan_show_mouse(void *data, bool state)
 {
    vk_t                            *vk = (vk_t*)data;
@@ -2616,6 +3031,53 @@ static void vulkan_get_video_output_next(void *data)
    vk->ctx_driver->get_video_output_next(vk->ctx_data);
 }
 
+static bool vulkan_get_gpu_timing(void *data,
+      retro_time_t *gpu_time, int *queue_depth)
+{
+   vk_t *vk = (vk_t*)data;
+
+   if (!vk || vk->timestamps.pool == VK_NULL_HANDLE)
+      return false;
+
+   *gpu_time    = vk->timestamps.gpu_time;
+   *queue_depth = vk->timestamps.queue_depth;
+   return true;
+}
+
+static void vulkan_wait_frame_latency(void *data)
+{
+   vk_t *vk = (vk_t*)data;
+
+   /* The previous frame being on screen means the core
+    * can run (and poll input) as late as it ever could */
+   if (vk && vk->context)
+      vulkan_wait_for_present(vk->context);
+}
+
+static unsigned vulkan_get_shader_pass_timings(void *data,
+      retro_time_t *pass_time, unsigned max_passes)
+{
+   vk_t *vk = (vk_t*)data;
+
+   if (!vk || !vk->filter_chain)
+      return 0;
+
+   return vulkan_filter_chain_get_pass_timings(
+         (vulkan_filter_chain_t*)vk->filter_chain,
+         pass_time, max_passes);
+}
+
+static size_t vulkan_get_shader_memory_usage(void *data)
+{
+   vk_t *vk = (vk_t*)data;
+
+   if (!vk || !vk->filter_chain)
+      return 0;
+
+   return vulkan_filter_chain_get_memory_usage(
+         (vulkan_filter_chain_t*)vk->filter_chain);
+}
+
 static const video_poke_interface_t vulkan_poke_interface = {
    vulkan_get_flags,
    vulkan_load_texture,
@@ -2638,6 +3100,11 @@ static const video_poke_interface_t vulkan_poke_interface = {
    vulkan_get_current_shader,
    vulkan_get_current_sw_framebuffer,
    vulkan_get_hw_render_interface,
+   vulkan_get_gpu_timing,
+   vulkan_wait_frame_latency,
+   vulkan_reconfigure,
+   vulkan_get_shader_pass_timings,
+   vulkan_get_shader_memory_usage
 };
 
 static void vulkan_get_poke_interface(void *data,
@@ -2667,13 +3134,15 @@ static void vulkan_viewport_info(void *data, struct video_viewport *vp)
 
 static bool vulkan_read_viewport(void *data, uint8_t *buffer, bool is_idle)
 {
+   unsigned frame_index             = 0;
    struct vk_texture *staging       = NULL;
    vk_t *vk                         = (vk_t*)data;
 
    if (!vk)
       return false;
 
-   staging = &vk->readback.staging[vk->context->current_frame_index];
+   frame_index = vk->context->current_frame_index;
+   staging     = &vk->readback.staging[frame_index];
 
    if (vk->readback.streamed)
    {
@@ -2728,13 +3197,23 @@ static bool vulkan_read_viewport(void *data, uint8_t *buffer, bool is_idle)
       if (!is_idle)
          video_driver_cached_frame();
 
+      /* Only wait for the frame which did the copy rather
+       * than draining the whole queue. */
+      if (     vk->context->swapchain_fences_signalled[frame_index]
+            && vk->context->swapchain_fences[frame_index] != VK_NULL_HANDLE)
+         vkWaitForFences(vk->context->device, 1,
+               &vk->context->swapchain_fences[frame_index],
+               true, UINT64_MAX);
+      else
+      {
 #ifdef HAVE_THREADS
-      slock_lock(vk->context->queue_lock);
+         slock_lock(vk->context->queue_lock);
 #endif
-      vkQueueWaitIdle(vk->context->queue);
+         vkQueueWaitIdle(vk->context->queue);
 #ifdef HAVE_THREADS
-      slock_unlock(vk->context->queue_lock);
+         slock_unlock(vk->context->queue_lock);
 #endif
+      }
 
       if (!staging->mapped)
       {
@@ -14,6 +14,7 @@
  *  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <stdint.h>
+#include <string.h>
 
 #include <sys/system_properties.h>
 
@@ -44,10 +45,17 @@
 #endif
 #endif
 
+#ifdef HAVE_EGL
+/* EGL_ANDROID_presentation_time */
+typedef EGLBoolean (*pfn_eglPresentationTimeANDROID)(EGLDisplay dpy,
+      EGLSurface surface, int64_t time);
+#endif
+
 typedef struct
 {
 #ifdef HAVE_EGL
    egl_ctx_data_t egl;
+   pfn_eglPresentationTimeANDROID presentation_time;
 #endif
 } android_ctx_data_t;
 
@@ -64,6 +72,8 @@ static void android_gfx_ctx_destroy(void *data)
    if (!and)
       return;
 
+   android_frame_pacing_stop();
+
 #ifdef HAVE_EGL
    egl_destroy(&and->egl);
 #endif
@@ -128,6 +138,8 @@ static void *android_gfx_ctx_init(void *video_driver)
    ANativeWindow_setBuffersGeometry(android_app->window, 0, 0, format);
 
    slock_unlock(android_app->mutex);
+
+   android_frame_pacing_start();
    return and;
 
 error:
@@ -205,6 +217,15 @@ static bool android_gfx_ctx_set_video_mode(void *data,
 
          if (!egl_create_surface(&and->egl, android_app->window))
             return false;
+
+         {
+            const char *exts = eglQueryString(and->egl.dpy, EGL_EXTENSIONS);
+            if (exts && strstr(exts, "EGL_ANDROID_presentation_time"))
+               and->presentation_time = (pfn_eglPresentationTimeANDROID)
+                  egl_get_proc_address("eglPresentationTimeANDROID");
+         }
+
+         android_frame_pacing_set_frame_rate(android_app->window);
 #endif
          break;
 
@@ -311,6 +332,14 @@ static void android_gfx_ctx_swap_buffers(void *data)
    android_ctx_data_t *and  = (android_ctx_data_t*)data;
 
 #ifdef HAVE_EGL
+   if (and->presentation_time)
+   {
+      int64_t present = android_frame_pacing_present_time(
+            (unsigned)and->egl.interval);
+      if (present)
+         and->presentation_time(and->egl.dpy, and->egl.surf, present);
+   }
+
    egl_swap_buffers(&and->egl);
 #endif
 }
@@ -49,6 +49,7 @@ static void android_gfx_ctx_vk_destroy(void *data)
    if (!and)
       return;
 
+   android_frame_pacing_stop();
    vulkan_context_destroy(&and->vk, android_app->window);
 
    if (and->vk.context.queue_lock)
@@ -77,6 +78,8 @@ static void *android_gfx_ctx_vk_init(void *video_driver)
    }
 
    slock_unlock(android_app->mutex);
+
+   android_frame_pacing_start();
    return and;
 
 error:
@@ -170,6 +173,8 @@ static bool android_gfx_ctx_vk_set_video_mode(void *data,
       return false;
    }
 
+   android_frame_pacing_set_frame_rate(android_app->window);
+
    return true;
 }
 
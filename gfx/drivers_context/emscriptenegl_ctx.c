@@ -41,6 +41,9 @@ typedef struct
 {
 #ifdef HAVE_EGL
    egl_ctx_data_t egl;
+#endif
+#ifdef PROXY_TO_PTHREAD
+   EMSCRIPTEN_WEBGL_CONTEXT_HANDLE webgl;
 #endif
    int initial_width;
    int initial_height;
@@ -161,6 +164,10 @@ static void gfx_ctx_emscripten_destroy(void *data)
    if (!emscripten)
       return;
 
+#ifdef PROXY_TO_PTHREAD
+   if (emscripten->webgl > 0)
+      emscripten_webgl_destroy_context(emscripten->webgl);
+#endif
 #ifdef HAVE_EGL
    egl_destroy(&emscripten->egl);
 #endif
@@ -168,9 +175,50 @@ static void gfx_ctx_emscripten_destroy(void *data)
    free(data);
 }
 
+#ifdef PROXY_TO_PTHREAD
+/* The canvas is an OffscreenCanvas owned by this thread, which
+ * only the html5 WebGL API can create a context on. EGL is still
+ * what resolves GL symbols. */
+static bool gfx_ctx_emscripten_create_webgl(
+      emscripten_ctx_data_t *emscripten)
+{
+   int width, height;
+   EmscriptenWebGLContextAttributes attrs;
+
+   emscripten_webgl_init_context_attributes(&attrs);
+   attrs.alpha         = true;
+   attrs.depth         = true;
+   attrs.stencil       = false;
+   attrs.antialias     = false;
+   attrs.majorVersion  = 1;
+   attrs.minorVersion  = 0;
+
+   emscripten->webgl = emscripten_webgl_create_context("#canvas", &attrs);
+   if (emscripten->webgl <= 0)
+   {
+      RARCH_ERR("[EMSCRIPTEN/WEBGL]: Failed to create context: %d\n",
+            (int)emscripten->webgl);
+      return false;
+   }
+
+   if (emscripten_webgl_make_context_current(emscripten->webgl)
+         != EMSCRIPTEN_RESULT_SUCCESS)
+      return false;
+
+   emscripten_webgl_get_drawing_buffer_size(emscripten->webgl,
+         &width, &height);
+
+   emscripten->fb_width  = (unsigned)width;
+   emscripten->fb_height = (unsigned)height;
+   RARCH_LOG("[EMSCRIPTEN/WEBGL]: Dimensions: %ux%u\n",
+         emscripten->fb_width, emscripten->fb_height);
+   return true;
+}
+#endif
+
 static void *gfx_ctx_emscripten_init(void *video_driver)
 {
-#ifdef HAVE_EGL
+#if defined(HAVE_EGL) && !defined(PROXY_TO_PTHREAD)
    unsigned width, height;
    EGLint major, minor;
    EGLint n;
@@ -206,7 +254,10 @@ static void *gfx_ctx_emscripten_init(void *video_driver)
          &emscripten->initial_width,
          &emscripten->initial_height);
 
-#ifdef HAVE_EGL
+#ifdef PROXY_TO_PTHREAD
+   if (!gfx_ctx_emscripten_create_webgl(emscripten))
+      goto error;
+#elif defined(HAVE_EGL)
    if (g_egl_inited)
    {
       RARCH_LOG("[EMSCRIPTEN/EGL]: Attempted to re-initialize driver.\n");
@@ -200,6 +200,8 @@ static void gfx_ctx_wl_destroy_resources(gfx_ctx_wayland_data_t *wl)
       zxdg_decoration_manager_v1_destroy(wl->deco_manager);
    if (wl->idle_inhibitor)
       zwp_idle_inhibitor_v1_destroy(wl->idle_inhibitor);
+   if (wl->presentation)
+      wp_presentation_destroy(wl->presentation);
 
    if (wl->input.dpy)
    {
@@ -219,6 +221,7 @@ static void gfx_ctx_wl_destroy_resources(gfx_ctx_wayland_data_t *wl)
    wl->surface          = NULL;
    wl->xdg_toplevel     = NULL;
    wl->zxdg_toplevel    = NULL;
+   wl->presentation     = NULL;
 
    wl->width            = 0;
    wl->height           = 0;
@@ -841,6 +844,8 @@ static void gfx_ctx_wl_swap_buffers(void *data)
 {
    gfx_ctx_wayland_data_t *wl = (gfx_ctx_wayland_data_t*)data;
 
+   gfx_ctx_wl_request_presentation_feedback(wl);
+
 #ifdef HAVE_EGL
    egl_swap_buffers(&wl->egl);
 #endif
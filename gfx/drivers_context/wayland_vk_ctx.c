@@ -178,6 +178,8 @@ static void gfx_ctx_wl_destroy_resources(gfx_ctx_wayland_data_t *wl)
       zxdg_decoration_manager_v1_destroy(wl->deco_manager);
    if (wl->idle_inhibitor)
       zwp_idle_inhibitor_v1_destroy(wl->idle_inhibitor);
+   if (wl->presentation)
+      wp_presentation_destroy(wl->presentation);
 
    if (wl->input.dpy)
    {
@@ -194,6 +196,7 @@ static void gfx_ctx_wl_destroy_resources(gfx_ctx_wayland_data_t *wl)
    wl->surface          = NULL;
    wl->xdg_toplevel     = NULL;
    wl->zxdg_toplevel    = NULL;
+   wl->presentation     = NULL;
 
    wl->width            = 0;
    wl->height           = 0;
@@ -622,7 +625,10 @@ static void gfx_ctx_wl_swap_buffers(void *data)
          retro_sleep(10);
       }
       else
+      {
+         gfx_ctx_wl_request_presentation_feedback(wl);
          vulkan_present(&wl->vk, wl->vk.context.current_swapchain_index);
+      }
    }
    vulkan_acquire_next_image(&wl->vk);
    flush_wayland_fd(&wl->input);
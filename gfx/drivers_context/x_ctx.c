@@ -608,6 +608,7 @@ static bool gfx_ctx_x_set_video_mode(void *data,
    }
 
    x11_set_window_attr(g_x11_dpy, g_x11_win);
+   x11_present_init(g_x11_dpy, g_x11_win, fullscreen);
    x11_update_title(NULL);
 
    if (fullscreen)
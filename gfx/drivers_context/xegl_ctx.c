@@ -383,6 +383,7 @@ static bool gfx_ctx_xegl_set_video_mode(void *data,
       goto error;
 
    x11_set_window_attr(g_x11_dpy, g_x11_win);
+   x11_present_init(g_x11_dpy, g_x11_win, fullscreen);
    x11_update_title(NULL);
 
    if (fullscreen)
@@ -133,17 +133,20 @@ static void gfx_display_gl1_draw(gfx_display_ctx_draw_t *draw,
 #ifdef VITA
    {
       unsigned i;
-      static float *vertices3 = NULL;
+      float *vertices3 = (float*)gfx_display_frame_alloc(
+            sizeof(float) * 3 * draw->coords->vertices);
 
       if (vertices3)
-         free(vertices3);
-      vertices3 = (float*)malloc(sizeof(float) * 3 * draw->coords->vertices);
-      for (i = 0; i < draw->coords->vertices; i++)
       {
-         memcpy(&vertices3[i*3], &draw->coords->vertex[i*2], sizeof(float) * 2);
-         vertices3[i*3+2]  = 0.0f;
+         for (i = 0; i < draw->coords->vertices; i++)
+         {
+            memcpy(&vertices3[i*3], &draw->coords->vertex[i*2], sizeof(float) * 2);
+            vertices3[i*3+2]  = 0.0f;
+         }
+         glVertexPointer(3, GL_FLOAT, 0, vertices3);
       }
-      glVertexPointer(3, GL_FLOAT, 0, vertices3);   
+      else
+         glVertexPointer(2, GL_FLOAT, 0, draw->coords->vertex);
    }
 #else
    glVertexPointer(2, GL_FLOAT, 0, draw->coords->vertex);
@@ -23,6 +23,7 @@
 
 #include "../common/gl1_common.h"
 #include "../font_driver.h"
+#include "../gfx_display.h"
 #include "../../configuration.h"
 #include "../../verbosity.h"
 
@@ -245,7 +246,8 @@ static void gl1_raster_font_draw_vertices(gl1_raster_t *font,
       const video_coords_t *coords)
 {
 #ifdef VITA
-   static float *vertices3 = NULL;
+   float *vertices3 = (float*)gfx_display_frame_alloc(
+         sizeof(float) * 3 * coords->vertices);
 #endif
 
    if (font->atlas->dirty)
@@ -268,8 +270,6 @@ static void gl1_raster_font_draw_vertices(gl1_raster_t *font,
 
 #ifdef VITA
    if (vertices3)
-      free(vertices3);
-   vertices3 = (float*)malloc(sizeof(float) * 3 * coords->vertices);
    {
       int i;
       for (i = 0; i < coords->vertices; i++)
@@ -277,8 +277,10 @@ static void gl1_raster_font_draw_vertices(gl1_raster_t *font,
          memcpy(&vertices3[i*3], &coords->vertex[i*2], sizeof(float) * 2);
          vertices3[i*3+2] = 0.0f;
       }
+      glVertexPointer(3, GL_FLOAT, 0, vertices3);
    }
-   glVertexPointer(3, GL_FLOAT, 0, vertices3);   
+   else
+      glVertexPointer(2, GL_FLOAT, 0, coords->vertex);
 #else
    glVertexPointer(2, GL_FLOAT, 0, coords->vertex);
 #endif
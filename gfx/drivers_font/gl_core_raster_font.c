@@ -17,7 +17,6 @@
 
 #include <stdlib.h>
 
-#include <encodings/utf.h>
 #include <string/stdstring.h>
 #include <retro_math.h>
 #include <gfx/common/gl_core_common.h>
@@ -49,6 +48,7 @@ typedef struct
    const font_renderer_driver_t *font_driver;
    void *font_data;
    struct font_atlas *atlas;
+   font_layout_cache_t *layout_cache;
 
    video_font_raster_block_t *block;
 } gl_core_raster_t;
@@ -60,6 +60,8 @@ static void gl_core_raster_font_free_font(void *data,
    if (!font)
       return;
 
+   font_layout_cache_free(font->layout_cache);
+
    if (font->font_driver && font->font_data)
       font->font_driver->free(font->font_data);
 
@@ -97,6 +99,31 @@ static bool gl_core_raster_font_upload_atlas(gl_core_raster_t *font)
    return true;
 }
 
+/* Uploads only what changed since the last upload */
+static void gl_core_raster_font_update_atlas(gl_core_raster_t *font)
+{
+   const struct font_atlas *atlas = font->atlas;
+
+   if (atlas->dirty_x1 <= atlas->dirty_x0)
+   {
+      gl_core_raster_font_upload_atlas(font);
+      return;
+   }
+
+   glBindTexture(GL_TEXTURE_2D, font->tex);
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+   glPixelStorei(GL_UNPACK_ROW_LENGTH, atlas->width);
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+   glTexSubImage2D(GL_TEXTURE_2D, 0,
+         atlas->dirty_x0, atlas->dirty_y0,
+         atlas->dirty_x1 - atlas->dirty_x0,
+         atlas->dirty_y1 - atlas->dirty_y0,
+         GL_RED, GL_UNSIGNED_BYTE,
+         atlas->buffer + atlas->dirty_y0 * atlas->width + atlas->dirty_x0);
+   glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+   glBindTexture(GL_TEXTURE_2D, 0);
+}
+
 static void *gl_core_raster_font_init_font(void *data,
       const char *font_path, float font_size,
       bool is_threaded)
@@ -125,11 +152,14 @@ static void *gl_core_raster_font_init_font(void *data,
          font->gl->ctx_driver->make_current(false);
 
    font->atlas      = font->font_driver->get_atlas(font->font_data);
+   if (!(font->layout_cache = font_layout_cache_new(
+               font->font_driver, font->font_data)))
+      goto error;
 
    if (!gl_core_raster_font_upload_atlas(font))
       goto error;
 
-   font->atlas->dirty = false;
+   font_atlas_clear_dirty(font->atlas);
    return font;
 
 error:
@@ -140,31 +170,15 @@ error:
 static int gl_core_get_message_width(void *data, const char *msg,
       unsigned msg_len, float scale)
 {
-   gl_core_raster_t *font   = (gl_core_raster_t*)data;
-   const char* msg_end = msg + msg_len;
-   int delta_x         = 0;
+   const struct font_layout *layout = NULL;
+   gl_core_raster_t *font           = (gl_core_raster_t*)data;
 
    if (     !font
-         || !font->font_driver
-         || !font->font_driver->get_glyph
-         || !font->font_data )
+         || !(layout = font_layout_cache_get(
+               font->layout_cache, msg, msg_len)))
       return 0;
 
-   while (msg < msg_end)
-   {
-      unsigned code                  = utf8_walk(&msg);
-      const struct font_glyph *glyph = font->font_driver->get_glyph(
-            font->font_data, code);
-
-      if (!glyph) /* Do something smarter here ... */
-         glyph = font->font_driver->get_glyph(font->font_data, '?');
-      if (!glyph)
-         continue;
-
-      delta_x += glyph->advance_x;
-   }
-
-   return delta_x * scale;
+   return layout->width * scale;
 }
 
 static void gl_core_raster_font_draw_vertices(gl_core_raster_t *font,
@@ -172,8 +186,8 @@ static void gl_core_raster_font_draw_vertices(gl_core_raster_t *font,
 {
    if (font->atlas->dirty)
    {
-      gl_core_raster_font_upload_atlas(font);
-      font->atlas->dirty   = false;
+      gl_core_raster_font_update_atlas(font);
+      font_atlas_clear_dirty(font->atlas);
    }
 
    glActiveTexture(GL_TEXTURE1);
@@ -216,41 +230,40 @@ static void gl_core_raster_font_render_line(
    GLfloat font_vertex[2 * 6 * MAX_MSG_LEN_CHUNK];
    GLfloat font_color[4 * 6 * MAX_MSG_LEN_CHUNK];
    gl_core_t *gl        = font->gl;
-   const char* msg_end  = msg + msg_len;
+   const struct font_layout_glyph *g, *g_end;
+   const struct font_layout *layout = NULL;
    int x                = roundf(pos_x * gl->vp.width);
    int y                = roundf(pos_y * gl->vp.height);
-   int delta_x          = 0;
-   int delta_y          = 0;
    float inv_tex_size_x = 1.0f / font->atlas->width;
    float inv_tex_size_y = 1.0f / font->atlas->height;
    float inv_win_width  = 1.0f / font->gl->vp.width;
    float inv_win_height = 1.0f / font->gl->vp.height;
 
+   if (!(layout = font_layout_cache_get(font->layout_cache, msg, msg_len)))
+      return;
+
    switch (text_align)
    {
       case TEXT_ALIGN_RIGHT:
-         x -= gl_core_get_message_width(font, msg, msg_len, scale);
+         x -= (int)(layout->width * scale);
          break;
       case TEXT_ALIGN_CENTER:
-         x -= gl_core_get_message_width(font, msg, msg_len, scale) / 2.0;
+         x -= (int)(layout->width * scale) / 2.0;
          break;
    }
 
-   while (msg < msg_end)
+   g     = layout->glyphs;
+   g_end = g + layout->count;
+
+   while (g < g_end)
    {
       i = 0;
-      while ((i < MAX_MSG_LEN_CHUNK) && (msg < msg_end))
+      while ((i < MAX_MSG_LEN_CHUNK) && (g < g_end))
       {
          int off_x, off_y, tex_x, tex_y, width, height;
-         unsigned                  code = utf8_walk(&msg);
-         const struct font_glyph *glyph = font->font_driver->get_glyph(
-               font->font_data, code);
-
-         if (!glyph) /* Do something smarter here ... */
-            glyph = font->font_driver->get_glyph(font->font_data, '?');
-
-         if (!glyph)
-            continue;
+         const struct font_glyph *glyph = &g->glyph;
+         int delta_x                    = g->pen_x;
+         int delta_y                    = -g->pen_y;
 
          off_x  = glyph->draw_offset_x;
          off_y  = glyph->draw_offset_y;
@@ -268,9 +281,7 @@ static void gl_core_raster_font_render_line(
          GL_CORE_RASTER_FONT_EMIT(5, 1, 1); /* Bottom-right */
 
          i++;
-
-         delta_x += glyph->advance_x;
-         delta_y -= glyph->advance_y;
+         g++;
       }
 
       coords.tex_coord     = font_tex_coords;
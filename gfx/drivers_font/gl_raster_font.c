@@ -17,7 +17,6 @@
 
 #include <stdlib.h>
 
-#include <encodings/utf.h>
 #include <string/stdstring.h>
 #include <retro_math.h>
 
@@ -51,6 +50,7 @@ typedef struct
    const font_renderer_driver_t *font_driver;
    void *font_data;
    struct font_atlas *atlas;
+   font_layout_cache_t *layout_cache;
 
    video_font_raster_block_t *block;
 } gl_raster_t;
@@ -62,6 +62,8 @@ static void gl_raster_font_free_font(void *data,
    if (!font)
       return;
 
+   font_layout_cache_free(font->layout_cache);
+
    if (font->font_driver && font->font_data)
       font->font_driver->free(font->font_data);
 
@@ -118,6 +120,21 @@ static bool gl_raster_font_upload_atlas_components_4(gl_raster_t *font)
 }
 #endif
 
+/* Whether the atlas texture is GL_R8, rather
+ * than GL_LUMINANCE_ALPHA */
+static bool gl_raster_font_atlas_is_red(gl_raster_t *font)
+{
+#if defined(GL_VERSION_3_0)
+   struct retro_hw_render_callback *hwr = video_driver_get_hw_context();
+
+   if ((font->gl && font->gl->core_context_in_use) ||
+         (hwr->context_type == RETRO_HW_CONTEXT_OPENGL &&
+          hwr->version_major >= 3))
+      return true;
+#endif
+   return false;
+}
+
 static bool gl_raster_font_upload_atlas(gl_raster_t *font)
 {
    unsigned i, j;
@@ -126,11 +143,7 @@ static bool gl_raster_font_upload_atlas(gl_raster_t *font)
    size_t ncomponents                   = 2;
    uint8_t       *tmp                   = NULL;
 #if defined(GL_VERSION_3_0)
-   struct retro_hw_render_callback *hwr = video_driver_get_hw_context();
-
-   if ((font->gl && font->gl->core_context_in_use) ||
-         (hwr->context_type == RETRO_HW_CONTEXT_OPENGL &&
-          hwr->version_major >= 3))
+   if (gl_raster_font_atlas_is_red(font))
    {
       GLint swizzle[] = { GL_ONE, GL_ONE, GL_ONE, GL_RED };
       glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
@@ -178,6 +191,56 @@ static bool gl_raster_font_upload_atlas(gl_raster_t *font)
    return true;
 }
 
+/* Uploads only the rows that changed since the last
+ * upload (the font texture must be bound) */
+static void gl_raster_font_update_atlas(gl_raster_t *font)
+{
+   unsigned i;
+   const struct font_atlas *atlas = font->atlas;
+   unsigned y0                    = atlas->dirty_y0;
+   unsigned rows                  = atlas->dirty_y1 - atlas->dirty_y0;
+   const uint8_t *src             = atlas->buffer + y0 * atlas->width;
+   uint8_t *tmp                   = NULL;
+
+   if (atlas->dirty_x1 <= atlas->dirty_x0)
+   {
+      gl_raster_font_upload_atlas(font);
+      return;
+   }
+
+   /* Whole rows keep the source contiguous, as GLES2
+    * has no GL_UNPACK_ROW_LENGTH */
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+   if (gl_raster_font_atlas_is_red(font))
+   {
+#if defined(GL_VERSION_3_0)
+      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y0, atlas->width, rows,
+            GL_RED, GL_UNSIGNED_BYTE, src);
+#endif
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+      return;
+   }
+
+   if (!(tmp = (uint8_t*)malloc(rows * atlas->width * 2)))
+   {
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+      return;
+   }
+
+   for (i = 0; i < rows * atlas->width; i++)
+   {
+      tmp[i * 2 + 0] = 0xff;
+      tmp[i * 2 + 1] = src[i];
+   }
+
+   glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y0, atlas->width, rows,
+         GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, tmp);
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+   free(tmp);
+}
+
 static void *gl_raster_font_init_font(void *data,
       const char *font_path, float font_size,
       bool is_threaded)
@@ -213,10 +276,14 @@ static void *gl_raster_font_init_font(void *data,
    font->tex_width  = next_pow2(font->atlas->width);
    font->tex_height = next_pow2(font->atlas->height);
 
+   if (!(font->layout_cache = font_layout_cache_new(
+               font->font_driver, font->font_data)))
+      goto error;
+
    if (!gl_raster_font_upload_atlas(font))
       goto error;
 
-   font->atlas->dirty = false;
+   font_atlas_clear_dirty(font->atlas);
 
    if (font->gl)
       glBindTexture(GL_TEXTURE_2D, font->gl->texture[font->gl->tex_index]);
@@ -233,31 +300,15 @@ error:
 static int gl_get_message_width(void *data, const char *msg,
       unsigned msg_len, float scale)
 {
-   gl_raster_t *font   = (gl_raster_t*)data;
-   const char* msg_end = msg + msg_len;
-   int delta_x         = 0;
+   const struct font_layout *layout = NULL;
+   gl_raster_t *font                = (gl_raster_t*)data;
 
    if (     !font
-         || !font->font_driver
-         || !font->font_driver->get_glyph
-         || !font->font_data )
+         || !(layout = font_layout_cache_get(
+               font->layout_cache, msg, msg_len)))
       return 0;
 
-   while (msg < msg_end)
-   {
-      unsigned code                  = utf8_walk(&msg);
-      const struct font_glyph *glyph = font->font_driver->get_glyph(
-            font->font_data, code);
-
-      if (!glyph) /* Do something smarter here ... */
-         glyph = font->font_driver->get_glyph(font->font_data, '?');
-      if (!glyph)
-         continue;
-
-      delta_x += glyph->advance_x;
-   }
-
-   return delta_x * scale;
+   return layout->width * scale;
 }
 
 static void gl_raster_font_draw_vertices(gl_raster_t *font,
@@ -265,8 +316,8 @@ static void gl_raster_font_draw_vertices(gl_raster_t *font,
 {
    if (font->atlas->dirty)
    {
-      gl_raster_font_upload_atlas(font);
-      font->atlas->dirty   = false;
+      gl_raster_font_update_atlas(font);
+      font_atlas_clear_dirty(font->atlas);
    }
 
    if (font->gl && font->gl->shader)
@@ -291,41 +342,40 @@ static void gl_raster_font_render_line(
    GLfloat font_color[4 * 6 * MAX_MSG_LEN_CHUNK];
    GLfloat font_lut_tex_coord[2 * 6 * MAX_MSG_LEN_CHUNK];
    gl_t      *gl        = font->gl;
-   const char* msg_end  = msg + msg_len;
+   const struct font_layout_glyph *g, *g_end;
+   const struct font_layout *layout = NULL;
    int x                = roundf(pos_x * gl->vp.width);
    int y                = roundf(pos_y * gl->vp.height);
-   int delta_x          = 0;
-   int delta_y          = 0;
    float inv_tex_size_x = 1.0f / font->tex_width;
    float inv_tex_size_y = 1.0f / font->tex_height;
    float inv_win_width  = 1.0f / font->gl->vp.width;
    float inv_win_height = 1.0f / font->gl->vp.height;
 
+   if (!(layout = font_layout_cache_get(font->layout_cache, msg, msg_len)))
+      return;
+
    switch (text_align)
    {
       case TEXT_ALIGN_RIGHT:
-         x -= gl_get_message_width(font, msg, msg_len, scale);
+         x -= (int)(layout->width * scale);
          break;
       case TEXT_ALIGN_CENTER:
-         x -= gl_get_message_width(font, msg, msg_len, scale) / 2.0;
+         x -= (int)(layout->width * scale) / 2.0;
          break;
    }
 
-   while (msg < msg_end)
+   g     = layout->glyphs;
+   g_end = g + layout->count;
+
+   while (g < g_end)
    {
       i = 0;
-      while ((i < MAX_MSG_LEN_CHUNK) && (msg < msg_end))
+      while ((i < MAX_MSG_LEN_CHUNK) && (g < g_end))
       {
          int off_x, off_y, tex_x, tex_y, width, height;
-         unsigned                  code = utf8_walk(&msg);
-         const struct font_glyph *glyph = font->font_driver->get_glyph(
-               font->font_data, code);
-
-         if (!glyph) /* Do something smarter here ... */
-            glyph = font->font_driver->get_glyph(font->font_data, '?');
-
-         if (!glyph)
-            continue;
+         const struct font_glyph *glyph = &g->glyph;
+         int delta_x                    = g->pen_x;
+         int delta_y                    = -g->pen_y;
 
          off_x  = glyph->draw_offset_x;
          off_y  = glyph->draw_offset_y;
@@ -343,9 +393,7 @@ static void gl_raster_font_render_line(
          GL_RASTER_FONT_EMIT(5, 1, 1); /* Bottom-right */
 
          i++;
-
-         delta_x += glyph->advance_x;
-         delta_y -= glyph->advance_y;
+         g++;
       }
 
       coords.tex_coord     = font_tex_coords;
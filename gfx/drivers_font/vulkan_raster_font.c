@@ -15,7 +15,6 @@
 
 #include <string.h>
 
-#include <encodings/utf.h>
 #include <compat/strl.h>
 
 #include "../common/vulkan_common.h"
@@ -29,6 +28,7 @@ typedef struct
    vk_t *vk;
    void *font_data;
    struct font_atlas *atlas;
+   font_layout_cache_t *layout_cache;
    const font_renderer_driver_t *font_driver;
    struct vk_vertex *pv;
    struct vk_texture texture;
@@ -39,20 +39,34 @@ typedef struct
    bool needs_update;
 } vulkan_raster_t;
 
-static INLINE void vulkan_raster_font_update_glyph(
-      vulkan_raster_t *font, const struct font_glyph *glyph)
+static INLINE void vulkan_raster_font_update_atlas(vulkan_raster_t *font)
 {
-   if(font->atlas->dirty)
+   struct font_atlas *atlas = font->atlas;
+
+   if (atlas->dirty)
    {
       unsigned row;
-      for (row = glyph->atlas_offset_y; row < (glyph->atlas_offset_y + glyph->height); row++)
+      unsigned x0 = atlas->dirty_x0;
+      unsigned y0 = atlas->dirty_y0;
+      unsigned x1 = atlas->dirty_x1;
+      unsigned y1 = atlas->dirty_y1;
+
+      if (x1 <= x0)
       {
-         uint8_t *src = font->atlas->buffer + row * font->atlas->width + glyph->atlas_offset_x;
-         uint8_t *dst = (uint8_t*)font->texture.mapped + row * font->texture.stride + glyph->atlas_offset_x;
-         memcpy(dst, src, glyph->width);
+         x0 = 0;
+         y0 = 0;
+         x1 = atlas->width;
+         y1 = atlas->height;
       }
 
-      font->atlas->dirty = false;
+      for (row = y0; row < y1; row++)
+      {
+         uint8_t *src = atlas->buffer + row * atlas->width + x0;
+         uint8_t *dst = (uint8_t*)font->texture.mapped + row * font->texture.stride + x0;
+         memcpy(dst, src, x1 - x0);
+      }
+
+      font_atlas_clear_dirty(atlas);
       font->needs_update = true;
    }
 }
@@ -64,6 +78,8 @@ static void vulkan_raster_font_free_font(void *data, bool is_threaded)
    if (!font)
       return;
 
+   font_layout_cache_free(font->layout_cache);
+
    if (font->font_driver && font->font_data)
       font->font_driver->free(font->font_data);
 
@@ -107,6 +123,15 @@ static void *vulkan_raster_font_init_font(void *data,
    }
 
    font->atlas   = font->font_driver->get_atlas(font->font_data);
+
+   if (!(font->layout_cache = font_layout_cache_new(
+               font->font_driver, font->font_data)))
+   {
+      font->font_driver->free(font->font_data);
+      free(font);
+      return NULL;
+   }
+
    font->texture = vulkan_create_texture(font->vk, NULL,
          font->atlas->width, font->atlas->height, VK_FORMAT_R8_UNORM, font->atlas->buffer,
          NULL /*&swizzle*/, VULKAN_TEXTURE_STAGING);
@@ -128,33 +153,16 @@ static void *vulkan_raster_font_init_font(void *data,
 static int vulkan_get_message_width(void *data, const char *msg,
       unsigned msg_len, float scale)
 {
-   vulkan_raster_t *font = (vulkan_raster_t*)data;
-   const char* msg_end   = msg + msg_len;
-   int delta_x           = 0;
+   const struct font_layout *layout = NULL;
+   vulkan_raster_t *font            = (vulkan_raster_t*)data;
 
    if (     !font
-         || !font->font_driver
-         || !font->font_driver->get_glyph
-         || !font->font_data )
+         || !(layout = font_layout_cache_get(
+               font->layout_cache, msg, msg_len)))
       return 0;
 
-   while (msg < msg_end)
-   {
-      uint32_t code                  = utf8_walk(&msg);
-      const struct font_glyph *glyph = font->font_driver->get_glyph(
-            font->font_data, code);
-
-      if (!glyph) /* Do something smarter here ... */
-         glyph = font->font_driver->get_glyph(font->font_data, '?');
-
-      if (glyph)
-      {
-         vulkan_raster_font_update_glyph(font, glyph);
-         delta_x += glyph->advance_x;
-      }
-   }
-
-   return delta_x * scale;
+   vulkan_raster_font_update_atlas(font);
+   return layout->width * scale;
 }
 
 static void vulkan_raster_font_render_line(
@@ -163,12 +171,11 @@ static void vulkan_raster_font_render_line(
       float pos_y, unsigned text_align)
 {
    struct vk_color vk_color;
+   const struct font_layout_glyph *g, *g_end;
+   const struct font_layout *layout = NULL;
    vk_t *vk             = font->vk;
-   const char* msg_end  = msg + msg_len;
    int x                = roundf(pos_x * vk->vp.width);
    int y                = roundf((1.0f - pos_y) * vk->vp.height);
-   int delta_x          = 0;
-   int delta_y          = 0;
    float inv_tex_size_x = 1.0f / font->texture.width;
    float inv_tex_size_y = 1.0f / font->texture.height;
    float inv_win_width  = 1.0f / font->vk->vp.width;
@@ -179,29 +186,27 @@ static void vulkan_raster_font_render_line(
    vk_color.b           = color[2];
    vk_color.a           = color[3];
 
+   if (!(layout = font_layout_cache_get(font->layout_cache, msg, msg_len)))
+      return;
+
+   vulkan_raster_font_update_atlas(font);
+
    switch (text_align)
    {
       case TEXT_ALIGN_RIGHT:
-         x -= vulkan_get_message_width(font, msg, msg_len, scale);
+         x -= (int)(layout->width * scale);
          break;
       case TEXT_ALIGN_CENTER:
-         x -= vulkan_get_message_width(font, msg, msg_len, scale) / 2;
+         x -= (int)(layout->width * scale) / 2;
          break;
    }
 
-   while (msg < msg_end)
+   for (g = layout->glyphs, g_end = g + layout->count; g < g_end; g++)
    {
       int off_x, off_y, tex_x, tex_y, width, height;
-      unsigned code                  = utf8_walk(&msg);
-      const struct font_glyph *glyph =
-         font->font_driver->get_glyph(font->font_data, code);
-
-      if (!glyph) /* Do something smarter here ... */
-         glyph = font->font_driver->get_glyph(font->font_data, '?');
-      if (!glyph)
-         continue;
-
-      vulkan_raster_font_update_glyph(font, glyph);
+      const struct font_glyph *glyph = &g->glyph;
+      int delta_x                    = g->pen_x;
+      int delta_y                    = g->pen_y;
 
       off_x  = glyph->draw_offset_x;
       off_y  = glyph->draw_offset_y;
@@ -228,9 +233,6 @@ static void vulkan_raster_font_render_line(
       }
 
       font->vertices += 6;
-
-      delta_x        += glyph->advance_x;
-      delta_y        += glyph->advance_y;
    }
 }
 
@@ -464,7 +466,7 @@ static const struct font_glyph *vulkan_raster_font_get_glyph(
    glyph = font->font_driver->get_glyph((void*)font->font_driver, code);
 
    if(glyph)
-      vulkan_raster_font_update_glyph(font, glyph);
+      vulkan_raster_font_update_atlas(font);
 
    return glyph;
 }
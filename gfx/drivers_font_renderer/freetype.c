@@ -202,7 +202,9 @@ static const struct font_glyph *font_renderer_ft_get_glyph(
       }
    }
 
-   handle->atlas.dirty = true;
+   font_atlas_mark_dirty(&handle->atlas,
+         atlas_slot->glyph.atlas_offset_x, atlas_slot->glyph.atlas_offset_y,
+         handle->max_glyph_width, handle->max_glyph_height);
    atlas_slot->last_used = handle->usage_counter++;
    return &atlas_slot->glyph;
 }
@@ -14,6 +14,10 @@
  */
 
 #include <string/stdstring.h>
+#include <file/file_path.h>
+#include <retro_dirent.h>
+#include <streams/file_stream.h>
+#include <encodings/crc32.h>
 
 #include "glslang.hpp"
 
@@ -25,11 +29,14 @@
 #include <glslang/SPIRV/GlslangToSpv.h>
 #endif
 #include <vector>
+#include <algorithm>
 #include <iostream>
 #include <cstring>
 #include <cstdlib>
 #include <mutex>
+#include <unordered_map>
 
+#include "../../configuration.h"
 #include "../../verbosity.h"
 
 using namespace glslang;
@@ -45,25 +52,30 @@ struct SlangProcess
       TBuiltInResource Resources;
 };
 
-/* We don't use glslang from multiple threads, but to be sure.
- * Initializing TLS and freeing it for glslang works around 
- * a really bizarre issue where the TLS key is suddenly 
- * corrupted *somehow*.
+/* Preset passes are compiled on several threads at once.
+ * glslang keeps its own per-thread pools, but (re)initializing the
+ * process rebuilds shared keyword tables, so only the first holder
+ * initializes and only the last one finalizes. Freeing the TLS for
+ * glslang in between also works around a really bizarre issue where
+ * the TLS key is suddenly corrupted *somehow*.
  */
 static std::mutex glslang_global_lock;
+static unsigned glslang_process_users;
 
 struct SlangProcessHolder
 {
    SlangProcessHolder()
    {
-      glslang_global_lock.lock();
-      InitializeProcess();
+      std::lock_guard<std::mutex> holder{glslang_global_lock};
+      if (glslang_process_users++ == 0)
+         InitializeProcess();
    }
 
    ~SlangProcessHolder()
    {
-      FinalizeProcess();
-      glslang_global_lock.unlock();
+      std::lock_guard<std::mutex> holder{glslang_global_lock};
+      if (--glslang_process_users == 0)
+         FinalizeProcess();
    }
 };
 
@@ -388,8 +400,311 @@ SlangProcess::SlangProcess()
    }
 }
 
+/* Content-addressed SPIR-V cache.
+ *
+ * Compiled stages are keyed by a hash of the stage source
+ * (which already has #includes and #pragma stage resolved) and
+ * the stage itself. Results are kept in memory for the session
+ * and written to <cache dir>/slang so that every backend going
+ * through compile_spirv() - Vulkan, GL core, D3D10/11/12 and Metal -
+ * skips glslang entirely for shaders it has seen before.
+ *
+ * Both the key and the file header carry a tag of the glslang
+ * build and the options it is run with, so an upgraded compiler
+ * never picks up SPIR-V from an older one. Those files are no
+ * longer hit and age out once the directory outgrows its limit.
+ * Bump SPIRV_CACHE_VERSION when the built-in resource limits
+ * change. */
+
+#define SPIRV_CACHE_MAGIC         0x56505352 /* 'RSPV' */
+#define SPIRV_CACHE_VERSION       2
+#define SPIRV_CACHE_MAX_ENTRIES   512
+#define SPIRV_CACHE_MAX_DISK_SIZE (32 * 1024 * 1024)
+
+/* Options compile_spirv_uncached() passes to glslang */
+#define SPIRV_COMPILE_VERSION     100
+#define SPIRV_COMPILE_MESSAGES    (EShMsgDefault | EShMsgVulkanRules | EShMsgSpvRules)
+
+struct spirv_cache_header
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t tag;
+   uint32_t stage;
+   uint32_t source_size;
+   uint32_t source_crc;
+   uint32_t spirv_words;
+};
+
+struct spirv_cache_file
+{
+   string path;
+   int64_t mtime;
+   int32_t size;
+};
+
+static std::mutex spirv_cache_lock;
+static std::unordered_map<uint64_t, std::vector<uint32_t> > spirv_cache;
+
+/* Size of <cache dir>/slang, -1 until it has been scanned */
+static std::mutex spirv_cache_disk_lock;
+static int64_t spirv_cache_disk_size = -1;
+
+static uint32_t spirv_cache_compute_tag(void)
+{
+   char tag[256];
+
+   snprintf(tag, sizeof(tag), "%s %d %d %d %d",
+         GetGlslVersionString(), GetKhronosToolId(),
+         GetSpirvGeneratorVersion(),
+         SPIRV_COMPILE_VERSION, (int)SPIRV_COMPILE_MESSAGES);
+
+   return encoding_crc32(0, (const uint8_t*)tag, strlen(tag));
+}
+
+static uint32_t spirv_cache_tag(void)
+{
+   static const uint32_t tag = spirv_cache_compute_tag();
+   return tag;
+}
+
+static uint64_t spirv_cache_hash(const string &source, Stage stage)
+{
+   /* 64-bit FNV-1a */
+   size_t i;
+   uint64_t hash = 0xcbf29ce484222325ULL ^ (uint64_t)stage;
+
+   hash ^= spirv_cache_tag();
+   hash *= 0x100000001b3ULL;
+
+   for (i = 0; i < source.size(); i++)
+   {
+      hash ^= (uint8_t)source[i];
+      hash *= 0x100000001b3ULL;
+   }
+
+   return hash;
+}
+
+static bool spirv_cache_dir(char *s, size_t len)
+{
+   settings_t *settings = config_get_ptr();
+
+   if (!settings || string_is_empty(settings->paths.directory_cache))
+      return false;
+
+   fill_pathname_join(s, settings->paths.directory_cache,
+         "slang", len);
+   return path_is_directory(s) || path_mkdir(s);
+}
+
+static bool spirv_cache_path(uint64_t hash, char *s, size_t len)
+{
+   char dir[PATH_MAX_LENGTH];
+   char name[32];
+
+   if (!spirv_cache_dir(dir, sizeof(dir)))
+      return false;
+
+   snprintf(name, sizeof(name), "%016llx.spv", (unsigned long long)hash);
+   fill_pathname_join(s, dir, name, len);
+   return true;
+}
+
+/* Deletes the least recently written files until the
+ * directory is down to 3/4 of SPIRV_CACHE_MAX_DISK_SIZE,
+ * so that a full cache is not scanned again on every store.
+ * Returns the remaining size. */
+static int64_t spirv_cache_prune(const char *dir)
+{
+   size_t i;
+   int64_t total = 0;
+   std::vector<spirv_cache_file> files;
+   struct RDIR *entry = retro_opendir(dir);
+
+   if (!entry)
+      return 0;
+
+   while (retro_readdir(entry))
+   {
+      char path[PATH_MAX_LENGTH];
+      spirv_cache_file file;
+      const char *name = retro_dirent_get_name(entry);
+
+      if (     retro_dirent_is_dir(entry, NULL)
+            || !string_is_equal(path_get_extension(name), "spv"))
+         continue;
+
+      fill_pathname_join(path, dir, name, sizeof(path));
+      file.path  = path;
+      file.size  = path_get_size(path);
+      file.mtime = 0;
+      if (file.size < 0)
+         continue;
+      path_get_mtime(path, &file.mtime);
+
+      total     += file.size;
+      files.push_back(file);
+   }
+
+   retro_closedir(entry);
+
+   if (total <= SPIRV_CACHE_MAX_DISK_SIZE)
+      return total;
+
+   std::sort(files.begin(), files.end(),
+         [](const spirv_cache_file &a, const spirv_cache_file &b)
+         {
+            return a.mtime < b.mtime;
+         });
+
+   for (i = 0; i < files.size()
+         && total > SPIRV_CACHE_MAX_DISK_SIZE / 4 * 3; i++)
+   {
+      if (filestream_delete(files[i].path.c_str()) == 0)
+         total -= files[i].size;
+   }
+
+   RARCH_LOG("[slang]: Pruned SPIR-V cache \"%s\" to %lld bytes.\n",
+         dir, (long long)total);
+
+   return total;
+}
+
+/* Accounts for 'size' bytes just written to the on-disk
+ * cache, which gets pruned whenever it grows past its limit.
+ * The directory is scanned on the first store of a session. */
+static void spirv_cache_disk_add(int64_t size)
+{
+   char dir[PATH_MAX_LENGTH];
+   std::lock_guard<std::mutex> holder{spirv_cache_disk_lock};
+
+   if (spirv_cache_disk_size >= 0)
+   {
+      spirv_cache_disk_size += size;
+      if (spirv_cache_disk_size <= SPIRV_CACHE_MAX_DISK_SIZE)
+         return;
+   }
+
+   if (spirv_cache_dir(dir, sizeof(dir)))
+      spirv_cache_disk_size = spirv_cache_prune(dir);
+}
+
+static bool spirv_cache_load(uint64_t hash, const string &source,
+      Stage stage, std::vector<uint32_t> *spirv)
+{
+   char path[PATH_MAX_LENGTH];
+   struct spirv_cache_header header;
+   int64_t size = 0;
+   void *data   = NULL;
+   bool ret     = false;
+
+   {
+      std::lock_guard<std::mutex> holder{spirv_cache_lock};
+      auto itr = spirv_cache.find(hash);
+      if (itr != spirv_cache.end())
+      {
+         *spirv = itr->second;
+         return true;
+      }
+   }
+
+   if (!spirv_cache_path(hash, path, sizeof(path)) || !path_is_valid(path))
+      return false;
+   if (!filestream_read_file(path, &data, &size))
+      return false;
+
+   /* Reject anything that is not an exact match for this source,
+    * a hash collision would otherwise silently pick a wrong shader. */
+   if ((size_t)size >= sizeof(header))
+   {
+      memcpy(&header, data, sizeof(header));
+
+      if (     header.magic       == SPIRV_CACHE_MAGIC
+            && header.version     == SPIRV_CACHE_VERSION
+            && header.tag         == spirv_cache_tag()
+            && header.stage       == (uint32_t)stage
+            && header.source_size == (uint32_t)source.size()
+            && header.source_crc  == encoding_crc32(0,
+               (const uint8_t*)source.data(), source.size())
+            && header.spirv_words > 0
+            && (size_t)size == sizeof(header)
+               + header.spirv_words * sizeof(uint32_t))
+      {
+         const uint32_t *words = (const uint32_t*)
+            ((const uint8_t*)data + sizeof(header));
+         spirv->assign(words, words + header.spirv_words);
+         ret = true;
+      }
+   }
+
+   free(data);
+
+   if (ret)
+   {
+      std::lock_guard<std::mutex> holder{spirv_cache_lock};
+      if (spirv_cache.size() >= SPIRV_CACHE_MAX_ENTRIES)
+         spirv_cache.clear();
+      spirv_cache[hash] = *spirv;
+   }
+
+   return ret;
+}
+
+static void spirv_cache_store(uint64_t hash, const string &source,
+      Stage stage, const std::vector<uint32_t> &spirv)
+{
+   char path[PATH_MAX_LENGTH];
+   struct spirv_cache_header header;
+   std::vector<uint8_t> blob;
+
+   {
+      std::lock_guard<std::mutex> holder{spirv_cache_lock};
+      if (spirv_cache.size() >= SPIRV_CACHE_MAX_ENTRIES)
+         spirv_cache.clear();
+      spirv_cache[hash] = spirv;
+   }
+
+   if (spirv.empty() || !spirv_cache_path(hash, path, sizeof(path)))
+      return;
+
+   header.magic       = SPIRV_CACHE_MAGIC;
+   header.version     = SPIRV_CACHE_VERSION;
+   header.tag         = spirv_cache_tag();
+   header.stage       = (uint32_t)stage;
+   header.source_size = (uint32_t)source.size();
+   header.source_crc  = encoding_crc32(0,
+         (const uint8_t*)source.data(), source.size());
+   header.spirv_words = (uint32_t)spirv.size();
+
+   blob.resize(sizeof(header) + spirv.size() * sizeof(uint32_t));
+   memcpy(blob.data(), &header, sizeof(header));
+   memcpy(blob.data() + sizeof(header), spirv.data(),
+         spirv.size() * sizeof(uint32_t));
+
+   if (!filestream_write_file(path, blob.data(), (int64_t)blob.size()))
+      RARCH_WARN("[slang]: Failed to write SPIR-V cache \"%s\".\n", path);
+   else
+      spirv_cache_disk_add((int64_t)blob.size());
+}
+
 bool glslang::compile_spirv(const string &source, Stage stage,
       std::vector<uint32_t> *spirv)
+{
+   uint64_t hash = spirv_cache_hash(source, stage);
+
+   if (spirv_cache_load(hash, source, stage, spirv))
+      return true;
+
+   if (!compile_spirv_uncached(source, stage, spirv))
+      return false;
+
+   spirv_cache_store(hash, source, stage, *spirv);
+   return true;
+}
+
+bool glslang::compile_spirv_uncached(const string &source, Stage stage,
+      std::vector<uint32_t> *spirv)
 {
    string msg;
    static SlangProcess process;
@@ -425,20 +740,21 @@ bool glslang::compile_spirv(const string &source, Stage stage,
    const char *src = source.c_str();
    shader.setStrings(&src, 1);
 
-   EShMessages messages = static_cast<EShMessages>(EShMsgDefault | EShMsgVulkanRules | EShMsgSpvRules);
+   EShMessages messages = static_cast<EShMessages>(SPIRV_COMPILE_MESSAGES);
 
    glslang::TShader::ForbidIncluder forbid_include = 
       glslang::TShader::ForbidIncluder();
 
    if (!shader.preprocess(&process.GetResources(),
-            100, ENoProfile, false, false,
+            SPIRV_COMPILE_VERSION, ENoProfile, false, false,
             messages, &msg, forbid_include))
    {
       RARCH_ERR("%s\n", msg.c_str());
       return false;
    }
 
-   if (!shader.parse(&process.GetResources(), 100, false, messages))
+   if (!shader.parse(&process.GetResources(),
+            SPIRV_COMPILE_VERSION, false, messages))
    {
       RARCH_ERR("%s\n", shader.getInfoLog());
       RARCH_ERR("%s\n", shader.getInfoDebugLog());
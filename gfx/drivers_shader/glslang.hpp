@@ -17,7 +17,9 @@ namespace glslang
         StageCompute
     };
 
+    /* Goes through the SPIR-V cache; falls back to glslang on a miss. */
     bool compile_spirv(const std::string &source, Stage stage, std::vector<uint32_t> *spirv);
+    bool compile_spirv_uncached(const std::string &source, Stage stage, std::vector<uint32_t> *spirv);
 }
 
 #endif
@@ -131,6 +131,22 @@ enum slang_texture_semantic slang_name_to_texture_semantic_array(
 
 unsigned glslang_num_miplevels(unsigned width, unsigned height);
 
+/* Compiles both stages of a .slang file without creating
+ * any GPU objects, warming the SPIR-V cache. Safe to call
+ * from a worker thread. */
+bool glslang_precompile_shader(const char *shader_path);
+
+/* Precompiled shader bundles, see slang_bundle.cpp.
+ * The bundle of a preset lives next to it as "<name>.slangpb". */
+void slang_bundle_path(const char *preset_path, char *s, size_t len);
+
+/* Compiles every pass of the preset and writes its bundle. */
+bool slang_bundle_write(const char *preset_path);
+
+/* Returns true if the preset has a bundle that is up to date. */
+bool slang_bundle_check(const char *preset_path,
+      const struct video_shader *shader);
+
 RETRO_END_DECLS
 
 #endif
@@ -23,6 +23,11 @@
 #include <file/config_file.h>
 #include <streams/file_stream.h>
 #include <string/stdstring.h>
+#include <features/features_cpu.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#include <rthreads/tpool.h>
+#endif
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -218,6 +223,12 @@ bool glslang_parse_meta(const struct string_list *lines, glslang_meta *meta)
    return true;
 }
 
+bool glslang_precompile_shader(const char *shader_path)
+{
+   glslang_output output;
+   return glslang_compile_shader(shader_path, &output);
+}
+
 bool glslang_compile_shader(const char *shader_path, glslang_output *output)
 {
 #if defined(HAVE_GLSLANG)
@@ -258,3 +269,77 @@ error:
 
    return false;
 }
+
+#ifdef HAVE_THREADS
+#define GLSLANG_COMPILE_MAX_WORKERS 16
+
+typedef struct
+{
+   const char **shader_paths;
+   glslang_output *outputs;
+   slock_t *lock;
+   unsigned failed;
+} glslang_compile_state_t;
+
+static void glslang_compile_job(void *data, unsigned pos)
+{
+   glslang_compile_state_t *state = (glslang_compile_state_t*)data;
+   bool skip;
+
+   /* No point in compiling past a pass that failed */
+   slock_lock(state->lock);
+   skip = pos > state->failed;
+   slock_unlock(state->lock);
+
+   if (skip)
+      return;
+
+   if (!glslang_compile_shader(state->shader_paths[pos],
+            &state->outputs[pos]))
+   {
+      slock_lock(state->lock);
+      if (pos < state->failed)
+         state->failed = pos;
+      slock_unlock(state->lock);
+   }
+}
+#endif
+
+unsigned glslang_compile_shaders(const char **shader_paths,
+      glslang_output *outputs, unsigned count)
+{
+   unsigned i;
+#ifdef HAVE_THREADS
+   glslang_compile_state_t state;
+   unsigned max_workers = cpu_features_get_core_amount();
+
+   if (max_workers > GLSLANG_COMPILE_MAX_WORKERS)
+      max_workers = GLSLANG_COMPILE_MAX_WORKERS;
+   /* Calling thread is a worker too */
+   if (max_workers > 0)
+      max_workers--;
+   if (count > 0 && max_workers > count - 1)
+      max_workers = count - 1;
+
+   if (max_workers > 0 && (state.lock = slock_new()))
+   {
+      tpool_t *pool      = tpool_create(max_workers);
+
+      state.shader_paths = shader_paths;
+      state.outputs      = outputs;
+      state.failed       = count;
+
+      /* Without a pool, the passes are compiled in turn */
+      tpool_run_batch(pool, glslang_compile_job, &state, count);
+      tpool_destroy(pool);
+
+      slock_free(state.lock);
+      return state.failed;
+   }
+#endif
+
+   for (i = 0; i < count; i++)
+      if (!glslang_compile_shader(shader_paths[i], &outputs[i]))
+         return i;
+   return count;
+}
@@ -55,6 +55,19 @@ struct glslang_output
 
 bool glslang_compile_shader(const char *shader_path, glslang_output *output);
 
+/* Compiles the 'count' shaders of a preset into 'outputs',
+ * spread across worker threads with HAVE_THREADS.
+ * Returns the index of the first shader that failed to
+ * compile, or 'count' if all of them compiled. */
+unsigned glslang_compile_shaders(const char **shader_paths,
+      glslang_output *outputs, unsigned count);
+
+/* Fills 'outputs', one per pass of 'shader', from the preset's
+ * precompiled bundle. Returns false if there is no bundle or
+ * the preset or any pass source changed since it was built. */
+bool slang_bundle_load(const char *preset_path,
+      const struct video_shader *shader, glslang_output *outputs);
+
 /* Helpers for internal use. */
 bool glslang_parse_meta(const struct string_list *lines, glslang_meta *meta);
 
@@ -382,6 +382,39 @@ static GLenum convert_glslang_format(glslang_format fmt)
    return 0;
 }
 
+static unsigned gl_core_format_bytes(GLenum format)
+{
+   switch (format)
+   {
+      case GL_R8:
+      case GL_R8I:
+      case GL_R8UI:
+         return 1;
+      case GL_RG8:
+      case GL_RG8I:
+      case GL_RG8UI:
+      case GL_R16UI:
+      case GL_R16I:
+      case GL_R16F:
+         return 2;
+      case GL_RGBA16UI:
+      case GL_RGBA16I:
+      case GL_RGBA16F:
+      case GL_RG32UI:
+      case GL_RG32I:
+      case GL_RG32F:
+         return 8;
+      case GL_RGBA32UI:
+      case GL_RGBA32I:
+      case GL_RGBA32F:
+         return 16;
+      default:
+         break;
+   }
+
+   return 4;
+}
+
 class StaticTexture
 {
 public:
@@ -523,6 +556,8 @@ public:
 
    unsigned get_levels() const { return levels; }
 
+   size_t get_memory_size() const;
+
 private:
    GLuint image = 0;
    Size2D size;
@@ -636,6 +671,20 @@ void Framebuffer::init()
    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+/* Estimated, GL doesn't tell */
+size_t Framebuffer::get_memory_size() const
+{
+   unsigned i;
+   size_t total   = 0;
+   unsigned bytes = gl_core_format_bytes(format);
+
+   for (i = 0; i < levels; i++)
+      total += (size_t)MAX(size.width >> i, 1u)
+         * MAX(size.height >> i, 1u) * bytes;
+
+   return total;
+}
+
 Framebuffer::~Framebuffer()
 {
    if (framebuffer != 0)
@@ -649,6 +698,9 @@ class UBORing
 public:
    ~UBORing();
    std::vector<GLuint> buffers;
+   /* What each buffer was last filled with,
+    * empty until it was filled at all */
+   std::vector<std::vector<uint8_t>> contents;
    unsigned buffer_index = 0;
 };
 
@@ -679,6 +731,21 @@ public:
       return framebuffer_feedback.get();
    }
 
+   size_t get_memory_size() const
+   {
+      size_t size = 0;
+      if (framebuffer)
+         size += framebuffer->get_memory_size();
+      if (framebuffer_feedback)
+         size += framebuffer_feedback->get_memory_size();
+      return size;
+   }
+
+   void release_framebuffer()
+   {
+      framebuffer.reset();
+   }
+
    void set_pass_info(const gl_core_filter_chain_pass_info &info);
 
    void set_shader(GLenum stage,
@@ -821,9 +888,17 @@ private:
    std::vector<Parameter> parameters;
    std::vector<Parameter> filtered_parameters;
    std::vector<uint8_t> push_constant_buffer;
+   /* Last values set through the flat uniform arrays,
+    * which the program keeps */
+   std::vector<uint8_t> flat_uniforms;
+   std::vector<uint8_t> flat_push_constants;
    gl_core_buffer_locations locations = {};
    UBORing ubo_ring;
 
+   void upload_flat_uniforms(const std::vector<uint8_t> &data,
+         std::vector<uint8_t> &last, GLint vertex, GLint fragment);
+   void upload_ubo();
+
    void reflect_parameter(const std::string &name, slang_semantic_meta &meta);
    void reflect_parameter(const std::string &name, slang_texture_semantic_meta &meta);
    void reflect_parameter_array(const char *name, std::vector<slang_texture_semantic_meta> &meta);
@@ -986,6 +1061,7 @@ bool Pass::init_pipeline()
       unsigned count = 16;
 
       ubo_ring.buffers.resize(count);
+      ubo_ring.contents.resize(count);
       glGenBuffers(count, ubo_ring.buffers.data());
 
       for (i = 0; i < ubo_ring.buffers.size(); i++)
@@ -1454,6 +1530,13 @@ void Pass::build_semantics(uint8_t *buffer,
             SLANG_TEXTURE_SEMANTIC_ORIGINAL_HISTORY, i + 1,
             common->original_history[i]);
 
+   /* Sizes of frames no pass samples, and which aren't kept */
+   for (i = common->original_history.size() + 1; i < reflection.semantic_textures[
+         SLANG_TEXTURE_SEMANTIC_ORIGINAL_HISTORY].size(); i++)
+      build_semantic_texture_array_vec4(buffer,
+            SLANG_TEXTURE_SEMANTIC_ORIGINAL_HISTORY, i,
+            original.texture.width, original.texture.height);
+
    /* Previous passes. */
    for (i = 0; i < common->pass_outputs.size(); i++)
       build_semantic_texture_array(buffer,
@@ -1473,6 +1556,82 @@ void Pass::build_semantics(uint8_t *buffer,
             common->luts[i]->get_texture());
 }
 
+void Pass::upload_flat_uniforms(const std::vector<uint8_t> &data,
+      std::vector<uint8_t> &last, GLint vertex, GLint fragment)
+{
+   if (vertex < 0 && fragment < 0)
+      return;
+
+   /* The program keeps the values, so they only
+    * have to be set again once they changed */
+   if (last.size() == data.size() &&
+         !memcmp(last.data(), data.data(), data.size()))
+      return;
+
+   if (vertex >= 0)
+      glUniform4fv(vertex, GLsizei((data.size() + 15) / 16),
+                   reinterpret_cast<const float *>(data.data()));
+   if (fragment >= 0)
+      glUniform4fv(fragment, GLsizei((data.size() + 15) / 16),
+                   reinterpret_cast<const float *>(data.data()));
+
+   last = data;
+}
+
+void Pass::upload_ubo()
+{
+   size_t offset;
+   size_t len;
+   unsigned vertex_binding   = locations.buffer_index_ubo_vertex;
+   unsigned fragment_binding = locations.buffer_index_ubo_fragment;
+   size_t size               = reflection.ubo_size;
+   std::vector<uint8_t> *contents = NULL;
+
+   if (ubo_ring.buffers.empty())
+      return;
+
+   contents = &ubo_ring.contents[ubo_ring.buffer_index];
+
+   /* The last buffer written to is used again for as long
+    * as none of the uniforms change. Otherwise the next one
+    * in the ring gets the uniforms that changed since it was
+    * last written to, usually just FrameCount. */
+   if (     contents->size() != size
+         || memcmp(contents->data(), uniforms.data(), size))
+   {
+      ubo_ring.buffer_index++;
+      if (ubo_ring.buffer_index >= ubo_ring.buffers.size())
+         ubo_ring.buffer_index = 0;
+
+      contents = &ubo_ring.contents[ubo_ring.buffer_index];
+
+      glBindBuffer(GL_UNIFORM_BUFFER,
+            ubo_ring.buffers[ubo_ring.buffer_index]);
+
+      if (contents->size() != size)
+      {
+         glBufferSubData(GL_UNIFORM_BUFFER, 0, size, uniforms.data());
+         contents->assign(uniforms.begin(), uniforms.begin() + size);
+      }
+      else if (slang_changed_range(contents->data(), uniforms.data(),
+               size, &offset, &len))
+      {
+         glBufferSubData(GL_UNIFORM_BUFFER, offset, len,
+               uniforms.data() + offset);
+         memcpy(contents->data() + offset, uniforms.data() + offset, len);
+      }
+
+      glBindBuffer(GL_UNIFORM_BUFFER, 0);
+   }
+
+   if (vertex_binding != GL_INVALID_INDEX)
+      glBindBufferBase(GL_UNIFORM_BUFFER, vertex_binding,
+            ubo_ring.buffers[ubo_ring.buffer_index]);
+   if (fragment_binding != GL_INVALID_INDEX)
+      glBindBufferBase(GL_UNIFORM_BUFFER, fragment_binding,
+            ubo_ring.buffers[ubo_ring.buffer_index]);
+}
+
 void Pass::build_commands(
       const Texture &original,
       const Texture &source,
@@ -1495,48 +1654,14 @@ void Pass::build_commands(
 
    build_semantics(uniforms.data(), mvp, original, source);
 
-   if (locations.flat_ubo_vertex >= 0)
-      glUniform4fv(locations.flat_ubo_vertex,
-                   GLsizei((reflection.ubo_size + 15) / 16),
-                   reinterpret_cast<const float *>(uniforms.data()));
-
-   if (locations.flat_ubo_fragment >= 0)
-      glUniform4fv(locations.flat_ubo_fragment,
-                   GLsizei((reflection.ubo_size + 15) / 16),
-                   reinterpret_cast<const float *>(uniforms.data()));
-
-   if (locations.flat_push_vertex >= 0)
-      glUniform4fv(locations.flat_push_vertex,
-                   GLsizei((reflection.push_constant_size + 15) / 16),
-                   reinterpret_cast<const float *>(push_constant_buffer.data()));
-
-   if (locations.flat_push_fragment >= 0)
-      glUniform4fv(locations.flat_push_fragment,
-                   GLsizei((reflection.push_constant_size + 15) / 16),
-                   reinterpret_cast<const float *>(push_constant_buffer.data()));
+   upload_flat_uniforms(uniforms, flat_uniforms,
+         locations.flat_ubo_vertex, locations.flat_ubo_fragment);
+   upload_flat_uniforms(push_constant_buffer, flat_push_constants,
+         locations.flat_push_vertex, locations.flat_push_fragment);
 
    if (!(      locations.buffer_index_ubo_vertex   == GL_INVALID_INDEX 
             && locations.buffer_index_ubo_fragment == GL_INVALID_INDEX))
-   {
-      /* UBO Ring - update and bind */
-      unsigned vertex_binding   = locations.buffer_index_ubo_vertex;
-      unsigned fragment_binding = locations.buffer_index_ubo_fragment;
-      const void *data          = uniforms.data();
-      size_t size               = reflection.ubo_size;
-      GLuint id                 = ubo_ring.buffers[ubo_ring.buffer_index];
-
-      glBindBuffer(GL_UNIFORM_BUFFER, id);
-      glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
-      glBindBuffer(GL_UNIFORM_BUFFER, 0);
-      if (vertex_binding != GL_INVALID_INDEX)
-         glBindBufferBase(GL_UNIFORM_BUFFER, vertex_binding, id);
-      if (fragment_binding != GL_INVALID_INDEX)
-         glBindBufferBase(GL_UNIFORM_BUFFER, fragment_binding, id);
-
-      ubo_ring.buffer_index++;
-      if (ubo_ring.buffer_index >= ubo_ring.buffers.size())
-         ubo_ring.buffer_index = 0;
-   }
+      upload_ubo();
 
    /* The final pass is always executed inside
     * another render pass since the frontend will
@@ -1597,10 +1722,14 @@ void Pass::build_commands(
 
 }
 
+/* Frames whose pass timestamps can be in flight at once */
+#define GL_CORE_PASS_TIMING_FRAMES 4
+
 struct gl_core_filter_chain
 {
 public:
    gl_core_filter_chain(unsigned num_passes) { set_num_passes(num_passes); }
+   ~gl_core_filter_chain() { deinit_pass_timing(); }
 
    inline void set_shader_preset(std::unique_ptr<video_shader> shader)
    {
@@ -1628,14 +1757,23 @@ public:
    void set_frame_count_period(unsigned pass, unsigned period);
    void set_frame_direction(int32_t direction);
    void set_pass_name(unsigned pass, const char *name);
+   void set_pass_passthrough(unsigned pass, bool passthrough);
 
    void add_static_texture(std::unique_ptr<gl_core_shader::StaticTexture> texture);
    void add_parameter(unsigned pass, unsigned parameter_index, const std::string &id);
    void set_num_passes(unsigned passes);
 
+   void set_pass_timing(bool enable);
+   unsigned get_pass_timings(retro_time_t *times, unsigned max_passes);
+   size_t get_memory_usage();
+
 private:
    std::vector<std::unique_ptr<gl_core_shader::Pass>> passes;
    std::vector<gl_core_filter_chain_pass_info> pass_info;
+   /* Passes which only copy their source */
+   std::vector<bool> pass_passthrough;
+   /* Passes which aren't rendered, see init_skipped_passes() */
+   std::vector<bool> pass_skipped;
    std::vector<std::vector<std::function<void ()>>> deferred_calls;
    std::unique_ptr<gl_core_shader::Framebuffer> copy_framebuffer;
    gl_core_shader::CommonResources common;
@@ -1645,13 +1783,127 @@ private:
    bool init_history();
    bool init_feedback();
    bool init_alias();
+   void init_skipped_passes();
    std::vector<std::unique_ptr<gl_core_shader::Framebuffer>> original_history;
    bool require_clear = false;
    void clear_history_and_feedback();
    void update_feedback_info();
    void update_history_info();
+
+   /* A begin and end GL_TIMESTAMP query for every pass,
+    * for each of GL_CORE_PASS_TIMING_FRAMES frames */
+   std::vector<GLuint> timer_queries;
+   std::vector<bool> timer_written;
+   std::vector<retro_time_t> pass_time;
+   unsigned timer_frame = 0;
+   void deinit_pass_timing();
+   void collect_pass_timing();
+   void stamp_pass(unsigned pass, bool end);
 };
 
+void gl_core_filter_chain::set_pass_timing(bool enable)
+{
+   deinit_pass_timing();
+
+#ifndef HAVE_OPENGLES
+   if (!enable)
+      return;
+
+   timer_queries.resize(GL_CORE_PASS_TIMING_FRAMES * passes.size() * 2);
+   glGenQueries((GLsizei)timer_queries.size(), timer_queries.data());
+   timer_written.assign(GL_CORE_PASS_TIMING_FRAMES * passes.size(), false);
+   pass_time.assign(passes.size(), -1);
+   timer_frame = 0;
+#endif
+}
+
+void gl_core_filter_chain::deinit_pass_timing()
+{
+#ifndef HAVE_OPENGLES
+   if (!timer_queries.empty())
+      glDeleteQueries((GLsizei)timer_queries.size(), timer_queries.data());
+#endif
+   timer_queries.clear();
+   timer_written.clear();
+   pass_time.clear();
+}
+
+/* Reads back the frame that used this frame's queries
+ * GL_CORE_PASS_TIMING_FRAMES frames ago. Passes the GPU
+ * hasn't finished yet are skipped rather than waited for */
+void gl_core_filter_chain::collect_pass_timing()
+{
+#ifndef HAVE_OPENGLES
+   unsigned i;
+
+   for (i = 0; i < passes.size(); i++)
+   {
+      GLint available  = 0;
+      GLuint64 begin   = 0;
+      GLuint64 end     = 0;
+      unsigned slot    = timer_frame * passes.size() + i;
+
+      if (!timer_written[slot])
+         continue;
+      timer_written[slot] = false;
+
+      glGetQueryObjectiv(timer_queries[slot * 2 + 1],
+            GL_QUERY_RESULT_AVAILABLE, &available);
+      if (!available)
+         continue;
+
+      glGetQueryObjectui64v(timer_queries[slot * 2],
+            GL_QUERY_RESULT, &begin);
+      glGetQueryObjectui64v(timer_queries[slot * 2 + 1],
+            GL_QUERY_RESULT, &end);
+
+      if (end >= begin)
+         pass_time[i] = (retro_time_t)((end - begin) / 1000);
+   }
+#endif
+}
+
+void gl_core_filter_chain::stamp_pass(unsigned pass, bool end)
+{
+#ifndef HAVE_OPENGLES
+   unsigned slot = timer_frame * passes.size() + pass;
+
+   if (timer_queries.empty())
+      return;
+
+   glQueryCounter(timer_queries[slot * 2 + (end ? 1 : 0)], GL_TIMESTAMP);
+   if (end)
+      timer_written[slot] = true;
+#endif
+}
+
+unsigned gl_core_filter_chain::get_pass_timings(
+      retro_time_t *times, unsigned max_passes)
+{
+   unsigned i;
+
+   if (pass_time.empty())
+      return 0;
+
+   for (i = 0; i < pass_time.size() && i < max_passes; i++)
+      times[i] = pass_time[i];
+
+   return i;
+}
+
+size_t gl_core_filter_chain::get_memory_usage()
+{
+   unsigned i;
+   size_t size = 0;
+
+   for (i = 0; i < passes.size(); i++)
+      size += passes[i]->get_memory_size();
+   for (i = 0; i < original_history.size(); i++)
+      size += original_history[i]->get_memory_size();
+
+   return size;
+}
+
 
 void gl_core_filter_chain::update_history_info()
 {
@@ -1715,6 +1967,9 @@ void gl_core_filter_chain::build_offscreen_passes(const gl_core_viewport &vp)
    if (!common.framebuffer_feedback.empty())
       update_feedback_info();
 
+   if (!timer_queries.empty())
+      collect_pass_timing();
+
    const gl_core_shader::Texture original = {
          input_texture,
          passes.front()->get_source_filter(),
@@ -1725,13 +1980,22 @@ void gl_core_filter_chain::build_offscreen_passes(const gl_core_viewport &vp)
 
    for (i = 0; i < passes.size() - 1; i++)
    {
-      passes[i]->build_commands(original, source, vp, nullptr);
+      /* A skipped pass hands its own source on */
+      if (!pass_skipped[i])
+      {
+         stamp_pass(i, false);
+         passes[i]->build_commands(original, source, vp, nullptr);
+         stamp_pass(i, true);
+
+         const gl_core_shader::Framebuffer &fb   = passes[i]->get_framebuffer();
 
-      const gl_core_shader::Framebuffer &fb   = passes[i]->get_framebuffer();
+         source.texture.image             = fb.get_image();
+         source.texture.width             = fb.get_size().width;
+         source.texture.height            = fb.get_size().height;
+      }
+      else if (!pass_time.empty())
+         pass_time[i]                     = 0;
 
-      source.texture.image             = fb.get_image();
-      source.texture.width             = fb.get_size().width;
-      source.texture.height            = fb.get_size().height;
       source.filter                    = passes[i + 1]->get_source_filter();
       source.mip_filter                = passes[i + 1]->get_mip_filter();
       source.address                   = passes[i + 1]->get_address_mode();
@@ -1742,6 +2006,9 @@ void gl_core_filter_chain::build_offscreen_passes(const gl_core_viewport &vp)
 
 void gl_core_filter_chain::end_frame()
 {
+   if (!timer_queries.empty())
+      timer_frame = (timer_frame + 1) % GL_CORE_PASS_TIMING_FRAMES;
+
    /* If we need to keep old frames, copy it after fragment is complete.
     * TODO: We can improve pipelining by figuring out which
     * pass is the last that reads from
@@ -1804,18 +2071,11 @@ void gl_core_filter_chain::build_viewport_pass(
       };
    }
    else
-   {
-      const gl_core_shader::Framebuffer &fb = passes[passes.size() - 2]
-         ->get_framebuffer();
-      source.texture.image           = fb.get_image();
-      source.texture.width           = fb.get_size().width;
-      source.texture.height          = fb.get_size().height;
-      source.filter                  = passes.back()->get_source_filter();
-      source.mip_filter              = passes.back()->get_mip_filter();
-      source.address                 = passes.back()->get_address_mode();
-   }
+      source = common.pass_outputs[passes.size() - 2];
 
+   stamp_pass(passes.size() - 1, false);
    passes.back()->build_commands(original, source, vp, mvp);
+   stamp_pass(passes.size() - 1, true);
 
    /* For feedback FBOs, swap current and previous. */
    for (i = 0; i < passes.size(); i++)
@@ -1834,11 +2094,25 @@ bool gl_core_filter_chain::init_history()
    original_history.clear();
    common.original_history.clear();
 
+   /* Only keep as many frames as some pass samples.
+    * OriginalHistorySize# alone doesn't need a frame,
+    * as every frame has the size of the original. */
    for (i = 0; i < passes.size(); i++)
-      required_images =
-            std::max(required_images,
-                passes[i]->get_reflection().semantic_textures[
-                SLANG_TEXTURE_SEMANTIC_ORIGINAL_HISTORY].size());
+   {
+      size_t j;
+      const std::vector<slang_texture_semantic_meta> &history =
+         passes[i]->get_reflection().semantic_textures[
+         SLANG_TEXTURE_SEMANTIC_ORIGINAL_HISTORY];
+
+      for (j = history.size(); j > required_images; j--)
+      {
+         if (history[j - 1].texture)
+         {
+            required_images = j;
+            break;
+         }
+      }
+   }
 
    if (required_images < 2)
    {
@@ -1970,6 +2244,8 @@ void gl_core_filter_chain::set_num_passes(unsigned num_passes)
    unsigned i;
 
    pass_info.resize(num_passes);
+   pass_passthrough.resize(num_passes, false);
+   pass_skipped.resize(num_passes, false);
    passes.reserve(num_passes);
 
    for (i = 0; i < num_passes; i++)
@@ -2015,10 +2291,60 @@ bool gl_core_filter_chain::init()
       return false;
    if (!init_feedback())
       return false;
+   init_skipped_passes();
    common.pass_outputs.resize(passes.size());
    return true;
 }
 
+/* Passes whose output nothing reads, and passthrough passes
+ * which copy their source at 1x into the same format, aren't
+ * rendered, and their source is handed on to the next pass.
+ * The final pass always is, as it renders to the screen. */
+void gl_core_filter_chain::init_skipped_passes()
+{
+   unsigned i, j;
+
+   for (i = 0; i + 1 < passes.size(); i++)
+   {
+      const gl_core_filter_chain_pass_info &info = pass_info[i];
+      bool referenced                            = false;
+      GLenum source_format                       = i > 0
+         ? pass_info[i - 1].rt_format
+         : GL_RGBA8;
+
+      pass_skipped[i]                            = false;
+
+      for (j = 0; j < passes.size(); j++)
+      {
+         const slang_reflection &r = passes[j]->get_reflection();
+         if (     r.references_texture(SLANG_TEXTURE_SEMANTIC_PASS_OUTPUT, i)
+               || r.references_texture(SLANG_TEXTURE_SEMANTIC_PASS_FEEDBACK, i))
+            referenced = true;
+      }
+
+      if (referenced)
+         continue;
+
+      if (!passes[i + 1]->get_reflection().references_texture(
+               SLANG_TEXTURE_SEMANTIC_SOURCE, 0))
+         pass_skipped[i] = true;
+      else if (pass_passthrough[i]
+            && info.scale_type_x == GLSLANG_FILTER_CHAIN_SCALE_SOURCE
+            && info.scale_type_y == GLSLANG_FILTER_CHAIN_SCALE_SOURCE
+            && info.scale_x      == 1.0f
+            && info.scale_y      == 1.0f
+            && info.max_levels   <= 1
+            && info.rt_format    == source_format)
+         pass_skipped[i] = true;
+
+      if (pass_skipped[i])
+      {
+         passes[i]->release_framebuffer();
+         RARCH_LOG("[GLCore]: Skipping pass #%u, its output would be unused or unchanged.\n", i);
+      }
+   }
+}
+
 void gl_core_filter_chain::clear_history_and_feedback()
 {
    unsigned i;
@@ -2098,6 +2424,11 @@ void gl_core_filter_chain::set_pass_name(unsigned pass, const char *name)
    passes[pass]->set_name(name);
 }
 
+void gl_core_filter_chain::set_pass_passthrough(unsigned pass, bool passthrough)
+{
+   pass_passthrough[pass] = passthrough;
+}
+
 static std::unique_ptr<gl_core_shader::StaticTexture> gl_core_filter_chain_load_lut(
       gl_core_filter_chain *chain,
       const video_shader_lut *shader)
@@ -2207,6 +2538,7 @@ gl_core_filter_chain_t *gl_core_filter_chain_create_from_preset(
       return nullptr;
 
    bool last_pass_is_fbo = shader->pass[shader->passes - 1].fbo.valid;
+   std::vector<glslang_output> outputs(shader->passes);
 
    std::unique_ptr<gl_core_filter_chain> chain{ new gl_core_filter_chain(shader->passes + (last_pass_is_fbo ? 1 : 0)) };
    if (!chain)
@@ -2218,9 +2550,29 @@ gl_core_filter_chain_t *gl_core_filter_chain_create_from_preset(
 
    shader->num_parameters = 0;
 
+   if (!slang_bundle_load(path, shader.get(), outputs.data()))
+   {
+      /* Passes are independent until they are linked into
+       * the chain below, so compile all of them at once. */
+      const char *paths[GFX_MAX_SHADERS];
+      unsigned failed;
+
+      for (i = 0; i < shader->passes; i++)
+         paths[i] = shader->pass[i].source.path;
+
+      failed = glslang_compile_shaders(paths, outputs.data(),
+            shader->passes);
+      if (failed < shader->passes)
+      {
+         RARCH_ERR("[GLCore]: Failed to compile shader: \"%s\".\n",
+               paths[failed]);
+         return nullptr;
+      }
+   }
+
    for (i = 0; i < shader->passes; i++)
    {
-      glslang_output output;
+      glslang_output &output             = outputs[i];
       struct gl_core_filter_chain_pass_info pass_info;
       const video_shader_pass *pass      = &shader->pass[i];
       const video_shader_pass *next_pass =
@@ -2236,13 +2588,6 @@ gl_core_filter_chain_t *gl_core_filter_chain_create_from_preset(
       pass_info.address       = GLSLANG_FILTER_CHAIN_ADDRESS_REPEAT;
       pass_info.max_levels    = 0;
 
-      if (!glslang_compile_shader(pass->source.path, &output))
-      {
-         RARCH_ERR("[GLCore]: Failed to compile shader: \"%s\".\n",
-               pass->source.path);
-         return nullptr;
-      }
-
       for (auto &meta_param : output.meta.parameters)
       {
          if (shader->num_parameters >= GFX_MAX_PARAMETERS)
@@ -2298,6 +2643,8 @@ gl_core_filter_chain_t *gl_core_filter_chain_create_from_preset(
             output.fragment.size());
 
       chain->set_frame_count_period(i, pass->frame_count_mod);
+      chain->set_pass_passthrough(i,
+            video_shader_pass_is_passthrough(pass));
 
       if (!output.meta.name.empty())
          chain->set_pass_name(i, output.meta.name.c_str());
@@ -2539,3 +2886,24 @@ void gl_core_filter_chain_end_frame(gl_core_filter_chain_t *chain)
 {
    chain->end_frame();
 }
+
+void gl_core_filter_chain_set_pass_timing(
+      gl_core_filter_chain_t *chain,
+      bool enable)
+{
+   chain->set_pass_timing(enable);
+}
+
+unsigned gl_core_filter_chain_get_pass_timings(
+      gl_core_filter_chain_t *chain,
+      retro_time_t *pass_time,
+      unsigned max_passes)
+{
+   return chain->get_pass_timings(pass_time, max_passes);
+}
+
+size_t gl_core_filter_chain_get_memory_usage(
+      gl_core_filter_chain_t *chain)
+{
+   return chain->get_memory_usage();
+}
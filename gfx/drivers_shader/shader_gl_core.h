@@ -21,6 +21,7 @@
 
 #include <boolean.h>
 #include <retro_common_api.h>
+#include <libretro.h>
 #include <glsym/glsym.h>
 
 #include "glslang_util.h"
@@ -139,6 +140,25 @@ struct video_shader *gl_core_filter_chain_get_preset(
 
 void gl_core_filter_chain_end_frame(gl_core_filter_chain_t *chain);
 
+/* Brackets every pass with GL_TIMESTAMP queries,
+ * which needs GL 3.3 */
+void gl_core_filter_chain_set_pass_timing(
+      gl_core_filter_chain_t *chain,
+      bool enable);
+
+/* GPU time (in us) of each pass in the most recent frame
+ * the GPU finished, -1 for passes not timed yet. Returns
+ * the number of passes, or 0 if timing is disabled */
+unsigned gl_core_filter_chain_get_pass_timings(
+      gl_core_filter_chain_t *chain,
+      retro_time_t *pass_time,
+      unsigned max_passes);
+
+/* Bytes of GPU memory held by the chain's framebuffers,
+ * history and feedback included */
+size_t gl_core_filter_chain_get_memory_usage(
+      gl_core_filter_chain_t *chain);
+
 GLuint gl_core_cross_compile_program(
       const uint32_t *vertex,
       size_t vertex_size,
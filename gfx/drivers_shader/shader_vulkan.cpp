@@ -29,6 +29,11 @@
 #include <formats/image.h>
 #include <string/stdstring.h>
 #include <retro_miscellaneous.h>
+#include <features/features_cpu.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#include <rthreads/tpool.h>
+#endif
 
 #include "slang_reflection.h"
 #include "slang_reflection.hpp"
@@ -146,6 +151,7 @@ class Framebuffer
       VkRenderPass get_render_pass() const { return render_pass; }
 
       unsigned get_levels() const { return levels; }
+      size_t get_memory_size() const { return memory.size; }
 
    private:
       Size2D size;
@@ -218,6 +224,16 @@ class Pass
 
       const Framebuffer &get_framebuffer() const { return *framebuffer; }
       Framebuffer *get_feedback_framebuffer() { return fb_feedback.get(); }
+      size_t get_memory_size() const
+      {
+         size_t size = 0;
+         if (framebuffer)
+            size += framebuffer->get_memory_size();
+         if (fb_feedback)
+            size += fb_feedback->get_memory_size();
+         return size;
+      }
+      void release_framebuffer() { framebuffer.reset(); }
 
       Size2D set_pass_info(
             const Size2D &max_original,
@@ -335,6 +351,17 @@ class Pass
       size_t ubo_offset           = 0;
       std::string pass_name;
 
+      /* Uniforms are built here and only the ones which
+       * changed are written to the UBO of a sync index */
+      std::vector<uint8_t> uniforms;
+      /* What the UBO of each sync index holds, empty
+       * until it was written at all */
+      std::vector<std::vector<uint8_t>> ubo_contents;
+      /* Whether the descriptor set of each sync index
+       * points to its UBO yet */
+      std::vector<bool> ubo_bound;
+      void upload_ubo();
+
       struct Parameter
       {
          std::string id;
@@ -390,10 +417,13 @@ struct vulkan_filter_chain
       void set_frame_count_period(unsigned pass, unsigned period);
       void set_frame_direction(int32_t direction);
       void set_pass_name(unsigned pass, const char *name);
+      void set_pass_passthrough(unsigned pass, bool passthrough);
 
       void add_static_texture(std::unique_ptr<StaticTexture> texture);
       void add_parameter(unsigned pass, unsigned parameter_index, const std::string &id);
       void release_staging_buffers();
+      unsigned get_pass_timings(retro_time_t *times, unsigned max_passes);
+      size_t get_memory_usage();
 
    private:
       VkDevice device;
@@ -402,6 +432,10 @@ struct vulkan_filter_chain
       VkPipelineCache cache;
       std::vector<std::unique_ptr<Pass>> passes;
       std::vector<vulkan_filter_chain_pass_info> pass_info;
+      /* Passes which only copy their source */
+      std::vector<bool> pass_passthrough;
+      /* Passes which aren't rendered, see init_skipped_passes() */
+      std::vector<bool> pass_skipped;
       std::vector<std::vector<std::function<void ()>>> deferred_calls;
       CommonResources common;
       VkFormat original_format;
@@ -423,12 +457,27 @@ struct vulkan_filter_chain
       bool init_history();
       bool init_feedback();
       bool init_alias();
+      void init_skipped_passes();
       void update_history(DeferredDisposer &disposer, VkCommandBuffer cmd);
       std::vector<std::unique_ptr<Framebuffer>> original_history;
       bool require_clear = false;
       void clear_history_and_feedback(VkCommandBuffer cmd);
       void update_feedback_info();
       void update_history_info();
+
+      /* A timestamp before and after every pass,
+       * for each sync index */
+      VkQueryPool timestamp_pool = VK_NULL_HANDLE;
+      float timestamp_period     = 0.0f;
+      std::vector<bool> timestamps_written;
+      std::vector<retro_time_t> pass_time;
+      /* Set once this frame's queries have been reset, which
+       * has to happen outside of a render pass */
+      bool timestamps_reset      = false;
+      void init_pass_timing();
+      void deinit_pass_timing();
+      void collect_pass_timing();
+      void stamp_pass(VkCommandBuffer cmd, unsigned pass, bool end);
 };
 
 static uint32_t find_memory_type_fallback(
@@ -771,6 +820,113 @@ vulkan_filter_chain::vulkan_filter_chain(
 vulkan_filter_chain::~vulkan_filter_chain()
 {
    flush();
+   deinit_pass_timing();
+}
+
+void vulkan_filter_chain::init_pass_timing()
+{
+   VkPhysicalDeviceProperties props;
+   VkQueryPoolCreateInfo query_info = {
+      VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
+
+   deinit_pass_timing();
+
+   vkGetPhysicalDeviceProperties(gpu, &props);
+   if (!props.limits.timestampComputeAndGraphics)
+      return;
+
+   query_info.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+   query_info.queryCount = deferred_calls.size() * passes.size() * 2;
+
+   if (vkCreateQueryPool(device, &query_info,
+            NULL, &timestamp_pool) != VK_SUCCESS)
+   {
+      timestamp_pool = VK_NULL_HANDLE;
+      return;
+   }
+
+   timestamp_period = props.limits.timestampPeriod;
+   timestamps_written.assign(deferred_calls.size() * passes.size(), false);
+   pass_time.assign(passes.size(), -1);
+   timestamps_reset = false;
+}
+
+void vulkan_filter_chain::deinit_pass_timing()
+{
+   if (timestamp_pool != VK_NULL_HANDLE)
+      vkDestroyQueryPool(device, timestamp_pool, NULL);
+   timestamp_pool = VK_NULL_HANDLE;
+   timestamps_written.clear();
+   pass_time.clear();
+}
+
+/* Called once the fence of the current sync index has
+ * been waited on, so whatever it wrote is ready */
+void vulkan_filter_chain::collect_pass_timing()
+{
+   unsigned i;
+
+   for (i = 0; i < passes.size(); i++)
+   {
+      uint64_t ts[2];
+      unsigned slot = current_sync_index * passes.size() + i;
+
+      if (!timestamps_written[slot])
+         continue;
+      timestamps_written[slot] = false;
+
+      if (vkGetQueryPoolResults(device, timestamp_pool,
+               slot * 2, 2, sizeof(ts), ts,
+               sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+         continue;
+
+      if (ts[1] >= ts[0])
+         pass_time[i] = (retro_time_t)((double)(ts[1] - ts[0])
+               * timestamp_period / 1000.0);
+   }
+}
+
+void vulkan_filter_chain::stamp_pass(VkCommandBuffer cmd,
+      unsigned pass, bool end)
+{
+   unsigned slot = current_sync_index * passes.size() + pass;
+
+   if (!timestamps_reset)
+      return;
+
+   vkCmdWriteTimestamp(cmd, end
+         ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT
+         : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+         timestamp_pool, slot * 2 + (end ? 1 : 0));
+   if (end)
+      timestamps_written[slot] = true;
+}
+
+unsigned vulkan_filter_chain::get_pass_timings(
+      retro_time_t *times, unsigned max_passes)
+{
+   unsigned i;
+
+   if (timestamp_pool == VK_NULL_HANDLE)
+      return 0;
+
+   for (i = 0; i < pass_time.size() && i < max_passes; i++)
+      times[i] = pass_time[i];
+
+   return i;
+}
+
+size_t vulkan_filter_chain::get_memory_usage()
+{
+   unsigned i;
+   size_t size = 0;
+
+   for (i = 0; i < passes.size(); i++)
+      size += passes[i]->get_memory_size();
+   for (i = 0; i < original_history.size(); i++)
+      size += original_history[i]->get_memory_size();
+
+   return size;
 }
 
 void vulkan_filter_chain::set_swapchain_info(
@@ -798,6 +954,9 @@ void vulkan_filter_chain::notify_sync_index(unsigned index)
 
    for (i = 0; i < passes.size(); i++)
       passes[i]->notify_sync_index(index);
+
+   if (timestamp_pool != VK_NULL_HANDLE)
+      collect_pass_timing();
 }
 
 bool vulkan_filter_chain::update_swapchain_info(
@@ -899,6 +1058,14 @@ void vulkan_filter_chain::build_offscreen_passes(VkCommandBuffer cmd,
    update_history_info();
    update_feedback_info();
 
+   if (timestamp_pool != VK_NULL_HANDLE)
+   {
+      vkCmdResetQueryPool(cmd, timestamp_pool,
+            current_sync_index * passes.size() * 2,
+            passes.size() * 2);
+      timestamps_reset = true;
+   }
+
    DeferredDisposer disposer(deferred_calls[current_sync_index]);
    const Texture original = {
       input_texture,
@@ -911,15 +1078,24 @@ void vulkan_filter_chain::build_offscreen_passes(VkCommandBuffer cmd,
 
    for (i = 0; i < passes.size() - 1; i++)
    {
-      passes[i]->build_commands(disposer, cmd,
-            original, source, vp, nullptr);
+      /* A skipped pass hands its own source on */
+      if (!pass_skipped[i])
+      {
+         stamp_pass(cmd, i, false);
+         passes[i]->build_commands(disposer, cmd,
+               original, source, vp, nullptr);
+         stamp_pass(cmd, i, true);
 
-      const Framebuffer &fb   = passes[i]->get_framebuffer();
+         const Framebuffer &fb   = passes[i]->get_framebuffer();
+
+         source.texture.view     = fb.get_view();
+         source.texture.layout   = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+         source.texture.width    = fb.get_size().width;
+         source.texture.height   = fb.get_size().height;
+      }
+      else if (!pass_time.empty())
+         pass_time[i]            = 0;
 
-      source.texture.view     = fb.get_view();
-      source.texture.layout   = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-      source.texture.width    = fb.get_size().width;
-      source.texture.height   = fb.get_size().height;
       source.filter           = passes[i + 1]->get_source_filter();
       source.mip_filter       = passes[i + 1]->get_mip_filter();
       source.address          = passes[i + 1]->get_address_mode();
@@ -985,6 +1161,8 @@ void vulkan_filter_chain::update_history(DeferredDisposer &disposer,
 
 void vulkan_filter_chain::end_frame(VkCommandBuffer cmd)
 {
+   timestamps_reset = false;
+
    /* If we need to keep old frames, copy it after fragment is complete.
     * TODO: We can improve pipelining by figuring out which
     * pass is the last that reads from
@@ -1028,19 +1206,12 @@ void vulkan_filter_chain::build_viewport_pass(
       };
    }
    else
-   {
-      const Framebuffer &fb  = passes[passes.size() - 2]->get_framebuffer();
-      source.texture.view    = fb.get_view();
-      source.texture.layout  = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-      source.texture.width   = fb.get_size().width;
-      source.texture.height  = fb.get_size().height;
-      source.filter          = passes.back()->get_source_filter();
-      source.mip_filter      = passes.back()->get_mip_filter();
-      source.address         = passes.back()->get_address_mode();
-   }
+      source = common.pass_outputs[passes.size() - 2];
 
+   stamp_pass(cmd, passes.size() - 1, false);
    passes.back()->build_commands(disposer, cmd,
          original, source, vp, mvp);
+   stamp_pass(cmd, passes.size() - 1, true);
 
    /* For feedback FBOs, swap current and previous. */
    for (i = 0; i < passes.size(); i++)
@@ -1055,11 +1226,25 @@ bool vulkan_filter_chain::init_history()
    original_history.clear();
    common.original_history.clear();
 
+   /* Only keep as many frames as some pass samples.
+    * OriginalHistorySize# alone doesn't need a frame,
+    * as every frame has the size of the original. */
    for (i = 0; i < passes.size(); i++)
-      required_images =
-         std::max(required_images,
-               passes[i]->get_reflection().semantic_textures[
-               SLANG_TEXTURE_SEMANTIC_ORIGINAL_HISTORY].size());
+   {
+      size_t j;
+      const std::vector<slang_texture_semantic_meta> &history =
+         passes[i]->get_reflection().semantic_textures[
+         SLANG_TEXTURE_SEMANTIC_ORIGINAL_HISTORY];
+
+      for (j = history.size(); j > required_images; j--)
+      {
+         if (history[j - 1].texture)
+         {
+            required_images = j;
+            break;
+         }
+      }
+   }
 
    if (required_images < 2)
    {
@@ -1201,6 +1386,8 @@ void vulkan_filter_chain::set_num_passes(unsigned num_passes)
    unsigned i;
 
    pass_info.resize(num_passes);
+   pass_passthrough.resize(num_passes, false);
+   pass_skipped.resize(num_passes, false);
    passes.reserve(num_passes);
 
    for (i = 0; i < num_passes; i++)
@@ -1259,6 +1446,78 @@ bool vulkan_filter_chain::init_ubo()
    return true;
 }
 
+#ifdef HAVE_THREADS
+#define VULKAN_BUILD_PASSES_MAX_WORKERS 16
+
+typedef struct
+{
+   std::vector<std::unique_ptr<Pass>> *passes;
+   slock_t *lock;
+   bool failed;
+} vulkan_build_passes_state_t;
+
+static void vulkan_build_passes_job(void *data, unsigned pos)
+{
+   vulkan_build_passes_state_t *state = (vulkan_build_passes_state_t*)data;
+   bool skip;
+
+   slock_lock(state->lock);
+   skip = state->failed;
+   slock_unlock(state->lock);
+
+   if (skip)
+      return;
+
+   if (!(*state->passes)[pos]->build())
+   {
+      slock_lock(state->lock);
+      state->failed = true;
+      slock_unlock(state->lock);
+   }
+}
+#endif
+
+/* Reflection and pipeline creation of a pass only depend on
+ * its own shaders and pass info, and Vulkan object creation
+ * is free-threaded, so passes are built on a thread pool. */
+static bool vulkan_build_passes(std::vector<std::unique_ptr<Pass>> &passes)
+{
+   unsigned i;
+#ifdef HAVE_THREADS
+   vulkan_build_passes_state_t state;
+   unsigned max_workers = cpu_features_get_core_amount();
+
+   if (max_workers > VULKAN_BUILD_PASSES_MAX_WORKERS)
+      max_workers = VULKAN_BUILD_PASSES_MAX_WORKERS;
+   /* Calling thread is a worker too */
+   if (max_workers > 0)
+      max_workers--;
+   if (passes.size() > 0 && max_workers > passes.size() - 1)
+      max_workers = (unsigned)(passes.size() - 1);
+
+   if (max_workers > 0 && (state.lock = slock_new()))
+   {
+      tpool_t *pool = tpool_create(max_workers);
+
+      state.passes  = &passes;
+      state.failed  = false;
+
+      /* Without a pool, the passes are built in turn */
+      tpool_run_batch(pool, vulkan_build_passes_job, &state,
+            (unsigned)passes.size());
+      tpool_destroy(pool);
+
+      slock_free(state.lock);
+      return !state.failed;
+   }
+#endif
+
+   for (i = 0; i < passes.size(); i++)
+      if (!passes[i]->build())
+         return false;
+   return true;
+}
+
 bool vulkan_filter_chain::init()
 {
    unsigned i;
@@ -1267,6 +1526,7 @@ bool vulkan_filter_chain::init()
    if (!init_alias())
       return false;
 
+   /* Each pass's size depends on the one before it */
    for (i = 0; i < passes.size(); i++)
    {
 #ifdef VULKAN_DEBUG
@@ -1278,10 +1538,11 @@ bool vulkan_filter_chain::init()
 #endif
       source = passes[i]->set_pass_info(max_input_size,
             source, swapchain_info, pass_info[i]);
-      if (!passes[i]->build())
-         return false;
    }
 
+   if (!vulkan_build_passes(passes))
+      return false;
+
    require_clear = false;
    if (!init_ubo())
       return false;
@@ -1289,10 +1550,61 @@ bool vulkan_filter_chain::init()
       return false;
    if (!init_feedback())
       return false;
+   init_skipped_passes();
+   init_pass_timing();
    common.pass_outputs.resize(passes.size());
    return true;
 }
 
+/* Passes whose output nothing reads, and passthrough passes
+ * which copy their source at 1x into the same format, aren't
+ * rendered, and their source is handed on to the next pass.
+ * The final pass always is, as it renders to the screen. */
+void vulkan_filter_chain::init_skipped_passes()
+{
+   unsigned i, j;
+
+   for (i = 0; i + 1 < passes.size(); i++)
+   {
+      const vulkan_filter_chain_pass_info &info = pass_info[i];
+      bool referenced                           = false;
+      VkFormat source_format                    = i > 0
+         ? pass_info[i - 1].rt_format
+         : VK_FORMAT_R8G8B8A8_UNORM;
+
+      pass_skipped[i]                           = false;
+
+      for (j = 0; j < passes.size(); j++)
+      {
+         const slang_reflection &r = passes[j]->get_reflection();
+         if (     r.references_texture(SLANG_TEXTURE_SEMANTIC_PASS_OUTPUT, i)
+               || r.references_texture(SLANG_TEXTURE_SEMANTIC_PASS_FEEDBACK, i))
+            referenced = true;
+      }
+
+      if (referenced)
+         continue;
+
+      if (!passes[i + 1]->get_reflection().references_texture(
+               SLANG_TEXTURE_SEMANTIC_SOURCE, 0))
+         pass_skipped[i] = true;
+      else if (pass_passthrough[i]
+            && info.scale_type_x == GLSLANG_FILTER_CHAIN_SCALE_SOURCE
+            && info.scale_type_y == GLSLANG_FILTER_CHAIN_SCALE_SOURCE
+            && info.scale_x      == 1.0f
+            && info.scale_y      == 1.0f
+            && info.max_levels   <= 1
+            && info.rt_format    == source_format)
+         pass_skipped[i] = true;
+
+      if (pass_skipped[i])
+      {
+         passes[i]->release_framebuffer();
+         RARCH_LOG("[Vulkan filter chain]: Skipping pass #%u, its output would be unused or unchanged.\n", i);
+      }
+   }
+}
+
 void vulkan_filter_chain::clear_history_and_feedback(VkCommandBuffer cmd)
 {
    unsigned i;
@@ -1343,6 +1655,11 @@ void vulkan_filter_chain::set_pass_name(unsigned pass, const char *name)
    passes[pass]->set_name(name);
 }
 
+void vulkan_filter_chain::set_pass_passthrough(unsigned pass, bool passthrough)
+{
+   pass_passthrough[pass] = passthrough;
+}
+
 StaticTexture::StaticTexture(std::string id,
       VkDevice device,
       VkImage image,
@@ -1933,6 +2250,34 @@ void Pass::allocate_buffers()
       /* Allocate */
       common->ubo_offset += reflection.ubo_size;
    }
+
+   uniforms.assign(reflection.ubo_size, 0);
+   ubo_contents.assign(num_sync_indices, std::vector<uint8_t>());
+   ubo_bound.assign(num_sync_indices, false);
+}
+
+void Pass::upload_ubo()
+{
+   size_t offset;
+   size_t len;
+   size_t size                    = reflection.ubo_size;
+   uint8_t *mapped                = common->ubo_mapped + ubo_offset +
+      sync_index * common->ubo_sync_index_stride;
+   std::vector<uint8_t> &contents = ubo_contents[sync_index];
+
+   /* Parameters and sizes rarely change, so this
+    * usually comes down to writing FrameCount */
+   if (contents.size() != size)
+   {
+      memcpy(mapped, uniforms.data(), size);
+      contents = uniforms;
+   }
+   else if (slang_changed_range(contents.data(), uniforms.data(),
+            size, &offset, &len))
+   {
+      memcpy(mapped + offset, uniforms.data() + offset, len);
+      memcpy(contents.data() + offset, uniforms.data() + offset, len);
+   }
 }
 
 void Pass::end_frame()
@@ -2190,6 +2535,13 @@ void Pass::build_semantics(VkDescriptorSet set, uint8_t *buffer,
             SLANG_TEXTURE_SEMANTIC_ORIGINAL_HISTORY, i + 1,
             common->original_history[i]);
 
+   /* Sizes of frames no pass samples, and which aren't kept */
+   for (i = common->original_history.size() + 1; i < reflection.semantic_textures[
+         SLANG_TEXTURE_SEMANTIC_ORIGINAL_HISTORY].size(); i++)
+      build_semantic_texture_array_vec4(buffer,
+            SLANG_TEXTURE_SEMANTIC_ORIGINAL_HISTORY, i,
+            original.texture.width, original.texture.height);
+
    /* Previous passes. */
    for (i = 0; i < common->pass_outputs.size(); i++)
       build_semantic_texture_array(set, buffer,
@@ -2232,18 +2584,24 @@ void Pass::build_commands(
    current_framebuffer_size = size;
 
    if (reflection.ubo_stage_mask && common->ubo_mapped)
-      u = common->ubo_mapped + ubo_offset +
-         sync_index * common->ubo_sync_index_stride;
+      u = uniforms.data();
 
    build_semantics(sets[sync_index], u, mvp, original, source);
 
-   if (reflection.ubo_stage_mask)
+   if (u)
+      upload_ubo();
+
+   /* The UBO range of a sync index never moves */
+   if (reflection.ubo_stage_mask && !ubo_bound[sync_index])
+   {
       vulkan_set_uniform_buffer(device,
             sets[sync_index],
             reflection.ubo_binding,
             common->ubo->get_buffer(),
             ubo_offset + sync_index * common->ubo_sync_index_stride,
             reflection.ubo_size);
+      ubo_bound[sync_index] = true;
+   }
 
    /* The final pass is always executed inside
     * another render pass since the frontend will
@@ -2587,6 +2945,7 @@ vulkan_filter_chain_t *vulkan_filter_chain_create_from_preset(
    bool last_pass_is_fbo = shader->pass[shader->passes - 1].fbo.valid;
    auto tmpinfo          = *info;
    tmpinfo.num_passes    = shader->passes + (last_pass_is_fbo ? 1 : 0);
+   std::vector<glslang_output> outputs(shader->passes);
 
    std::unique_ptr<vulkan_filter_chain> chain{ new vulkan_filter_chain(tmpinfo) };
    if (!chain)
@@ -2597,9 +2956,29 @@ vulkan_filter_chain_t *vulkan_filter_chain_create_from_preset(
 
    shader->num_parameters = 0;
 
+   if (!slang_bundle_load(path, shader.get(), outputs.data()))
+   {
+      /* Passes are independent until they are linked into
+       * the chain below, so compile all of them at once. */
+      const char *paths[GFX_MAX_SHADERS];
+      unsigned failed;
+
+      for (i = 0; i < shader->passes; i++)
+         paths[i] = shader->pass[i].source.path;
+
+      failed = glslang_compile_shaders(paths, outputs.data(),
+            shader->passes);
+      if (failed < shader->passes)
+      {
+         RARCH_ERR("[Vulkan]: Failed to compile shader: \"%s\".\n",
+               paths[failed]);
+         goto error;
+      }
+   }
+
    for (i = 0; i < shader->passes; i++)
    {
-      glslang_output output;
+      glslang_output &output             = outputs[i];
       struct vulkan_filter_chain_pass_info pass_info;
       const video_shader_pass *pass      = &shader->pass[i];
       const video_shader_pass *next_pass =
@@ -2615,13 +2994,6 @@ vulkan_filter_chain_t *vulkan_filter_chain_create_from_preset(
       pass_info.address       = GLSLANG_FILTER_CHAIN_ADDRESS_REPEAT;
       pass_info.max_levels    = 0;
 
-      if (!glslang_compile_shader(pass->source.path, &output))
-      {
-         RARCH_ERR("[Vulkan]: Failed to compile shader: \"%s\".\n",
-               pass->source.path);
-         goto error;
-      }
-
       for (auto &meta_param : output.meta.parameters)
       {
          if (shader->num_parameters >= GFX_MAX_PARAMETERS)
@@ -2677,6 +3049,8 @@ vulkan_filter_chain_t *vulkan_filter_chain_create_from_preset(
             output.fragment.size());
 
       chain->set_frame_count_period(i, pass->frame_count_mod);
+      chain->set_pass_passthrough(i,
+            video_shader_pass_is_passthrough(pass));
 
       if (!output.meta.name.empty())
          chain->set_pass_name(i, output.meta.name.c_str());
@@ -2941,3 +3315,17 @@ void vulkan_filter_chain_end_frame(
 {
    chain->end_frame(cmd);
 }
+
+unsigned vulkan_filter_chain_get_pass_timings(
+      vulkan_filter_chain_t *chain,
+      retro_time_t *pass_time,
+      unsigned max_passes)
+{
+   return chain->get_pass_timings(pass_time, max_passes);
+}
+
+size_t vulkan_filter_chain_get_memory_usage(
+      vulkan_filter_chain_t *chain)
+{
+   return chain->get_memory_usage();
+}
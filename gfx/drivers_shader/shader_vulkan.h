@@ -22,6 +22,7 @@
 
 #include <boolean.h>
 #include <retro_common_api.h>
+#include <libretro.h>
 
 #include "glslang_util.h"
 
@@ -134,6 +135,19 @@ void vulkan_filter_chain_build_viewport_pass(vulkan_filter_chain_t *chain,
 void vulkan_filter_chain_end_frame(vulkan_filter_chain_t *chain,
       VkCommandBuffer cmd);
 
+/* GPU time (in us) of each pass in the most recent frame
+ * the GPU finished, -1 for passes not timed yet. Returns
+ * the number of passes, or 0 if the device can't time them */
+unsigned vulkan_filter_chain_get_pass_timings(
+      vulkan_filter_chain_t *chain,
+      retro_time_t *pass_time,
+      unsigned max_passes);
+
+/* Bytes of device memory held by the chain's framebuffers,
+ * history and feedback included */
+size_t vulkan_filter_chain_get_memory_usage(
+      vulkan_filter_chain_t *chain);
+
 vulkan_filter_chain_t *vulkan_filter_chain_create_default(
       const struct vulkan_filter_chain_create_info *info,
       enum glslang_filter_chain_filter filter);
@@ -0,0 +1,376 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Precompiled shader bundles.
+ *
+ * A bundle sits next to its preset ("foo.slangp" -> "foo.slangpb")
+ * and holds a copy of the preset plus the SPIR-V and metadata of
+ * every pass, so the slang chains can be built without glslang.
+ * A bundle is only used while the preset and every pass source,
+ * includes expanded, are byte for byte what it was built from.
+ *
+ * Layout, native endian like the SPIR-V cache:
+ *   slang_bundle_header
+ *   preset file contents
+ *   per pass:
+ *     u32 source size, u32 source CRC, u32 rt_format, str name,
+ *     u32 parameter count, per parameter: str id, str desc,
+ *        f32 initial, minimum, maximum, step
+ *     u32 vertex words, words, u32 fragment words, words
+ *   where str is a u32 length followed by the bytes.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <retro_miscellaneous.h>
+#include <file/file_path.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+#include <encodings/crc32.h>
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "glslang_util.h"
+#include "glslang_util_cxx.h"
+#include "../../verbosity.h"
+
+#define SLANG_BUNDLE_MAGIC   0x42505352 /* "RSPB" */
+#define SLANG_BUNDLE_VERSION 1
+
+struct slang_bundle_header
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t preset_size;
+   uint32_t passes;
+};
+
+struct slang_bundle_reader
+{
+   const uint8_t *data;
+   size_t size;
+   size_t pos;
+};
+
+static bool slang_bundle_read(slang_bundle_reader *r, void *s, size_t len)
+{
+   if (r->size - r->pos < len)
+      return false;
+   memcpy(s, r->data + r->pos, len);
+   r->pos += len;
+   return true;
+}
+
+static bool slang_bundle_read_u32(slang_bundle_reader *r, uint32_t *val)
+{
+   return slang_bundle_read(r, val, sizeof(*val));
+}
+
+static bool slang_bundle_read_string(slang_bundle_reader *r, std::string *s)
+{
+   uint32_t len;
+
+   if (     !slang_bundle_read_u32(r, &len)
+         || r->size - r->pos < len)
+      return false;
+
+   s->assign((const char*)r->data + r->pos, len);
+   r->pos += len;
+   return true;
+}
+
+static bool slang_bundle_read_words(slang_bundle_reader *r,
+      std::vector<uint32_t> *words)
+{
+   uint32_t count;
+
+   if (     !slang_bundle_read_u32(r, &count)
+         || count == 0
+         || (r->size - r->pos) / sizeof(uint32_t) < count)
+      return false;
+
+   words->resize(count);
+   return slang_bundle_read(r, words->data(), count * sizeof(uint32_t));
+}
+
+static void slang_bundle_write_data(std::vector<uint8_t> *blob,
+      const void *data, size_t len)
+{
+   const uint8_t *bytes = (const uint8_t*)data;
+   blob->insert(blob->end(), bytes, bytes + len);
+}
+
+static void slang_bundle_write_u32(std::vector<uint8_t> *blob, uint32_t val)
+{
+   slang_bundle_write_data(blob, &val, sizeof(val));
+}
+
+static void slang_bundle_write_string(std::vector<uint8_t> *blob,
+      const std::string &s)
+{
+   slang_bundle_write_u32(blob, (uint32_t)s.size());
+   slang_bundle_write_data(blob, s.data(), s.size());
+}
+
+static void slang_bundle_write_words(std::vector<uint8_t> *blob,
+      const std::vector<uint32_t> &words)
+{
+   slang_bundle_write_u32(blob, (uint32_t)words.size());
+   slang_bundle_write_data(blob, words.data(),
+         words.size() * sizeof(uint32_t));
+}
+
+/* Size and CRC of a pass source as glslang would see it,
+ * i.e. with all of its #includes expanded. */
+static bool slang_bundle_source_crc(const char *path,
+      uint32_t *size, uint32_t *crc)
+{
+   size_t i;
+   struct string_list lines;
+
+   if (!string_list_initialize(&lines))
+      return false;
+
+   if (!glslang_read_shader_file(path, &lines, true))
+   {
+      string_list_deinitialize(&lines);
+      return false;
+   }
+
+   *size = 0;
+   *crc  = 0;
+
+   for (i = 0; i < lines.size; i++)
+   {
+      size_t len = strlen(lines.elems[i].data);
+      *crc       = encoding_crc32(*crc,
+            (const uint8_t*)lines.elems[i].data, len);
+      *crc       = encoding_crc32(*crc, (const uint8_t*)"\n", 1);
+      *size     += (uint32_t)len + 1;
+   }
+
+   string_list_deinitialize(&lines);
+   return true;
+}
+
+void slang_bundle_path(const char *preset_path, char *s, size_t len)
+{
+   fill_pathname(s, preset_path, ".slangpb", len);
+}
+
+bool slang_bundle_load(const char *preset_path,
+      const struct video_shader *shader, glslang_output *outputs)
+{
+   unsigned i;
+   char path[PATH_MAX_LENGTH];
+   struct slang_bundle_header header;
+   slang_bundle_reader r;
+   void *data          = NULL;
+   void *preset        = NULL;
+   int64_t size        = 0;
+   int64_t preset_size = 0;
+   bool ret            = false;
+
+   if (string_is_empty(preset_path) || !shader || shader->passes == 0)
+      return false;
+
+   slang_bundle_path(preset_path, path, sizeof(path));
+   if (!path_is_valid(path) || !filestream_read_file(path, &data, &size))
+      return false;
+
+   r.data = (const uint8_t*)data;
+   r.size = (size_t)size;
+   r.pos  = 0;
+
+   if (     !slang_bundle_read(&r, &header, sizeof(header))
+         || header.magic   != SLANG_BUNDLE_MAGIC
+         || header.version != SLANG_BUNDLE_VERSION
+         || header.passes  != shader->passes
+         || r.size - r.pos  < header.preset_size)
+      goto end;
+
+   /* The preset itself must not have been edited since */
+   if (!filestream_read_file(preset_path, &preset, &preset_size))
+      goto end;
+   if (     (uint32_t)preset_size != header.preset_size
+         || memcmp(preset, r.data + r.pos, header.preset_size))
+      goto end;
+   r.pos += header.preset_size;
+
+   for (i = 0; i < shader->passes; i++)
+   {
+      uint32_t j;
+      uint32_t source_size, source_crc, cur_size, cur_crc;
+      uint32_t rt_format, num_parameters;
+      glslang_output *output = &outputs[i];
+
+      if (     !slang_bundle_read_u32(&r, &source_size)
+            || !slang_bundle_read_u32(&r, &source_crc)
+            || !slang_bundle_read_u32(&r, &rt_format)
+            || !slang_bundle_source_crc(shader->pass[i].source.path,
+               &cur_size, &cur_crc)
+            || cur_size != source_size
+            || cur_crc  != source_crc)
+         goto end;
+
+      output->meta           = glslang_meta{};
+      output->meta.rt_format = (glslang_format)rt_format;
+
+      if (     !slang_bundle_read_string(&r, &output->meta.name)
+            || !slang_bundle_read_u32(&r, &num_parameters))
+         goto end;
+
+      for (j = 0; j < num_parameters; j++)
+      {
+         glslang_parameter param;
+
+         if (     !slang_bundle_read_string(&r, &param.id)
+               || !slang_bundle_read_string(&r, &param.desc)
+               || !slang_bundle_read(&r, &param.initial, sizeof(float))
+               || !slang_bundle_read(&r, &param.minimum, sizeof(float))
+               || !slang_bundle_read(&r, &param.maximum, sizeof(float))
+               || !slang_bundle_read(&r, &param.step,    sizeof(float)))
+            goto end;
+
+         output->meta.parameters.push_back(param);
+      }
+
+      if (     !slang_bundle_read_words(&r, &output->vertex)
+            || !slang_bundle_read_words(&r, &output->fragment))
+         goto end;
+   }
+
+   ret = r.pos == r.size;
+   if (ret)
+      RARCH_LOG("[slang]: Using shader bundle \"%s\".\n", path);
+
+end:
+   if (!ret)
+      RARCH_LOG("[slang]: Shader bundle \"%s\" is stale, ignoring it.\n",
+            path);
+   free(preset);
+   free(data);
+   return ret;
+}
+
+bool slang_bundle_check(const char *preset_path,
+      const struct video_shader *shader)
+{
+   char path[PATH_MAX_LENGTH];
+   std::vector<glslang_output> outputs;
+
+   if (string_is_empty(preset_path) || !shader || shader->passes == 0)
+      return false;
+
+   slang_bundle_path(preset_path, path, sizeof(path));
+   if (!path_is_valid(path))
+      return false;
+
+   outputs.resize(shader->passes);
+   return slang_bundle_load(preset_path, shader, outputs.data());
+}
+
+bool slang_bundle_write(const char *preset_path)
+{
+   unsigned i;
+   char path[PATH_MAX_LENGTH];
+   const char *paths[GFX_MAX_SHADERS];
+   struct slang_bundle_header header;
+   std::vector<uint8_t> blob;
+   std::vector<glslang_output> outputs;
+   void *preset               = NULL;
+   int64_t preset_size        = 0;
+   struct video_shader *shader = NULL;
+   bool ret                   = false;
+
+   if (string_is_empty(preset_path))
+      return false;
+
+   if (!(shader = (struct video_shader*)calloc(1, sizeof(*shader))))
+      return false;
+
+   if (!video_shader_load_preset_into_shader(preset_path, shader)
+         || shader->passes == 0)
+   {
+      RARCH_ERR("[slang]: Failed to load preset \"%s\".\n", preset_path);
+      goto end;
+   }
+
+   if (!filestream_read_file(preset_path, &preset, &preset_size))
+      goto end;
+
+   for (i = 0; i < shader->passes; i++)
+      paths[i] = shader->pass[i].source.path;
+
+   outputs.resize(shader->passes);
+   if (glslang_compile_shaders(paths, outputs.data(), shader->passes)
+         < shader->passes)
+   {
+      RARCH_ERR("[slang]: Failed to compile \"%s\".\n", preset_path);
+      goto end;
+   }
+
+   header.magic       = SLANG_BUNDLE_MAGIC;
+   header.version     = SLANG_BUNDLE_VERSION;
+   header.preset_size = (uint32_t)preset_size;
+   header.passes      = shader->passes;
+
+   slang_bundle_write_data(&blob, &header, sizeof(header));
+   slang_bundle_write_data(&blob, preset, (size_t)preset_size);
+
+   for (i = 0; i < shader->passes; i++)
+   {
+      uint32_t source_size, source_crc;
+      const glslang_meta &meta = outputs[i].meta;
+
+      if (!slang_bundle_source_crc(paths[i], &source_size, &source_crc))
+         goto end;
+
+      slang_bundle_write_u32(&blob, source_size);
+      slang_bundle_write_u32(&blob, source_crc);
+      slang_bundle_write_u32(&blob, (uint32_t)meta.rt_format);
+      slang_bundle_write_string(&blob, meta.name);
+      slang_bundle_write_u32(&blob, (uint32_t)meta.parameters.size());
+
+      for (const glslang_parameter &param : meta.parameters)
+      {
+         slang_bundle_write_string(&blob, param.id);
+         slang_bundle_write_string(&blob, param.desc);
+         slang_bundle_write_data(&blob, &param.initial, sizeof(float));
+         slang_bundle_write_data(&blob, &param.minimum, sizeof(float));
+         slang_bundle_write_data(&blob, &param.maximum, sizeof(float));
+         slang_bundle_write_data(&blob, &param.step,    sizeof(float));
+      }
+
+      slang_bundle_write_words(&blob, outputs[i].vertex);
+      slang_bundle_write_words(&blob, outputs[i].fragment);
+   }
+
+   slang_bundle_path(preset_path, path, sizeof(path));
+   if (!(ret = filestream_write_file(path, blob.data(), (int64_t)blob.size())))
+      RARCH_ERR("[slang]: Failed to write shader bundle \"%s\".\n", path);
+   else
+      RARCH_LOG("[slang]: Wrote shader bundle \"%s\" (%u passes).\n",
+            path, shader->passes);
+
+end:
+   free(preset);
+   free(shader);
+   return ret;
+}
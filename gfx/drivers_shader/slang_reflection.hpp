@@ -19,6 +19,7 @@
 #include <string>
 #include <unordered_map>
 #include <stdint.h>
+#include <string.h>
 #include <spirv_cross.hpp>
 
 struct slang_semantic_location
@@ -77,6 +78,18 @@ struct slang_reflection
    const std::unordered_map<std::string, slang_texture_semantic_map> *texture_semantic_uniform_map = nullptr;
    const std::unordered_map<std::string, slang_semantic_map> *semantic_map = nullptr;
    unsigned pass_number = 0;
+
+   /* Whether a texture, or only its size, is used at all */
+   bool references_texture(slang_texture_semantic semantic,
+         unsigned index) const
+   {
+      const std::vector<slang_texture_semantic_meta> &meta =
+         semantic_textures[semantic];
+      return index < meta.size()
+         && (meta[index].texture
+            || meta[index].uniform
+            || meta[index].push_constant);
+   }
 };
 
 template <typename P>
@@ -91,6 +104,37 @@ static bool slang_set_unique_map(std::unordered_map<std::string, P> &m,
    return true;
 }
 
+/* Finds the part of the uniform data 'data' which differs
+ * from 'prev', in whole vec4s. Uniform data that doesn't
+ * change from frame to frame (parameters, sizes) then never
+ * has to be uploaded again - typically only FrameCount does.
+ * Returns false if there is no difference at all. */
+static inline bool slang_changed_range(const uint8_t *prev,
+      const uint8_t *data, size_t size, size_t *offset, size_t *len)
+{
+   size_t begin = 0;
+   size_t end   = size;
+
+   while (begin < size && !memcmp(prev + begin, data + begin,
+            (size - begin < 16) ? size - begin : 16))
+      begin += 16;
+
+   if (begin >= size)
+      return false;
+
+   while (end > begin)
+   {
+      size_t last = (end - 1) & ~size_t(15);
+      if (memcmp(prev + last, data + last, end - last))
+         break;
+      end = last;
+   }
+
+   *offset = begin;
+   *len    = end - begin;
+   return true;
+}
+
 bool slang_reflect_spirv(
       const std::vector<uint32_t> &vertex,
       const std::vector<uint32_t> &fragment,
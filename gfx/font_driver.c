@@ -15,8 +15,11 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
+#include <encodings/utf.h>
+
 #ifdef HAVE_CONFIG_H
 #include "../config.h"
 #endif
@@ -24,6 +27,7 @@
 #include "font_driver.h"
 #include "video_thread_wrapper.h"
 
+#include "../performance_counters.h"
 #include "../retroarch.h"
 #include "../verbosity.h"
 
@@ -48,6 +52,207 @@ static const font_renderer_driver_t *font_backends[] = {
 /* TODO/FIXME - global */
 static void *video_font_driver = NULL;
 
+void font_atlas_mark_dirty(struct font_atlas *atlas,
+      unsigned x, unsigned y, unsigned width, unsigned height)
+{
+   unsigned x1 = MIN(x + width,  atlas->width);
+   unsigned y1 = MIN(y + height, atlas->height);
+
+   if (x >= x1 || y >= y1)
+      return;
+
+   if (atlas->dirty_x1 <= atlas->dirty_x0)
+   {
+      atlas->dirty_x0 = x;
+      atlas->dirty_y0 = y;
+      atlas->dirty_x1 = x1;
+      atlas->dirty_y1 = y1;
+   }
+   else
+   {
+      atlas->dirty_x0 = MIN(atlas->dirty_x0, x);
+      atlas->dirty_y0 = MIN(atlas->dirty_y0, y);
+      atlas->dirty_x1 = MAX(atlas->dirty_x1, x1);
+      atlas->dirty_y1 = MAX(atlas->dirty_y1, y1);
+   }
+
+   atlas->dirty       = true;
+   atlas->generation++;
+}
+
+void font_atlas_clear_dirty(struct font_atlas *atlas)
+{
+   atlas->dirty_x0    = 0;
+   atlas->dirty_y0    = 0;
+   atlas->dirty_x1    = 0;
+   atlas->dirty_y1    = 0;
+   atlas->dirty       = false;
+}
+
+/* Lines are looked up in a set associative table,
+ * replacing the least recently used line of a set */
+#define FONT_LAYOUT_CACHE_SETS 128
+#define FONT_LAYOUT_CACHE_WAYS 4
+
+struct font_layout_cache
+{
+   const font_renderer_driver_t *font_driver;
+   void *font_data;
+   struct font_atlas *atlas;
+   unsigned usage_counter;
+   struct font_layout lines[FONT_LAYOUT_CACHE_SETS * FONT_LAYOUT_CACHE_WAYS];
+};
+
+font_layout_cache_t *font_layout_cache_new(
+      const font_renderer_driver_t *font_driver, void *font_data)
+{
+   font_layout_cache_t *cache = NULL;
+
+   if (!font_driver || !font_driver->get_glyph || !font_driver->get_atlas)
+      return NULL;
+
+   if (!(cache = (font_layout_cache_t*)calloc(1, sizeof(*cache))))
+      return NULL;
+
+   cache->font_driver = font_driver;
+   cache->font_data   = font_data;
+   cache->atlas       = font_driver->get_atlas(font_data);
+   return cache;
+}
+
+void font_layout_cache_free(font_layout_cache_t *cache)
+{
+   unsigned i;
+
+   if (!cache)
+      return;
+
+   for (i = 0; i < FONT_LAYOUT_CACHE_SETS * FONT_LAYOUT_CACHE_WAYS; i++)
+   {
+      free(cache->lines[i].msg);
+      free(cache->lines[i].glyphs);
+   }
+   free(cache);
+}
+
+static bool font_layout_build(font_layout_cache_t *cache,
+      struct font_layout *line, const char *msg, unsigned msg_len)
+{
+   const char *msg_end = msg + msg_len;
+   int pen_x           = 0;
+   int pen_y           = 0;
+
+   /* Never more glyphs than bytes */
+   if (msg_len > line->msg_len || !line->glyphs)
+   {
+      struct font_layout_glyph *glyphs = (struct font_layout_glyph*)
+         realloc(line->glyphs, (msg_len ? msg_len : 1) * sizeof(*glyphs));
+      char *str = (char*)realloc(line->msg, msg_len + 1);
+
+      if (glyphs)
+         line->glyphs = glyphs;
+      if (str)
+         line->msg    = str;
+      if (!glyphs || !str)
+         return false;
+   }
+
+   memcpy(line->msg, msg, msg_len);
+   line->msg[msg_len] = '\0';
+   line->msg_len      = msg_len;
+   line->count        = 0;
+
+   while (msg < msg_end)
+   {
+      uint32_t code                  = utf8_walk(&msg);
+      const struct font_glyph *glyph = cache->font_driver->get_glyph(
+            cache->font_data, code);
+
+      if (!glyph) /* Do something smarter here ... */
+         glyph = cache->font_driver->get_glyph(cache->font_data, '?');
+      if (!glyph)
+         continue;
+
+      line->glyphs[line->count].glyph = *glyph;
+      line->glyphs[line->count].pen_x = pen_x;
+      line->glyphs[line->count].pen_y = pen_y;
+      line->count++;
+
+      pen_x += glyph->advance_x;
+      pen_y += glyph->advance_y;
+   }
+
+   line->width = pen_x;
+   return true;
+}
+
+const struct font_layout *font_layout_cache_get(
+      font_layout_cache_t *cache, const char *msg, unsigned msg_len)
+{
+   unsigned i, generation;
+   struct font_layout *set, *line;
+   bool line_unused = false;
+   uint32_t hash    = 2166136261u;
+
+   if (!cache || !msg)
+      return NULL;
+
+   for (i = 0; i < msg_len; i++)
+      hash = (hash ^ (uint8_t)msg[i]) * 16777619u;
+
+   set  = cache->lines +
+      (hash % FONT_LAYOUT_CACHE_SETS) * FONT_LAYOUT_CACHE_WAYS;
+   line = set;
+
+   for (i = 0; i < FONT_LAYOUT_CACHE_WAYS; i++)
+   {
+      struct font_layout *way = &set[i];
+      if (     way->msg
+            && way->hash       == hash
+            && way->msg_len    == msg_len
+            && way->generation == cache->atlas->generation
+            && !memcmp(way->msg, msg, msg_len))
+      {
+         way->last_used = cache->usage_counter++;
+         return way;
+      }
+      /* Prefer empty lines and lines of an older atlas */
+      if (!way->msg || way->generation != cache->atlas->generation)
+      {
+         line        = way;
+         line_unused = true;
+      }
+      else if (!line_unused && (cache->usage_counter - way->last_used) >
+            (cache->usage_counter - line->last_used))
+         line = way;
+   }
+
+   /* Adding glyphs to the atlas may evict some the line
+    * already uses, so it's laid out again in that case.
+    * A line that changed the atlas even then records the
+    * old generation and gets laid out again next time. */
+   generation = cache->atlas->generation;
+   if (!font_layout_build(cache, line, msg, msg_len))
+      goto error;
+   if (cache->atlas->generation != generation)
+   {
+      generation = cache->atlas->generation;
+      if (!font_layout_build(cache, line, msg, msg_len))
+         goto error;
+   }
+
+   line->hash       = hash;
+   line->generation = generation;
+   line->last_used  = cache->usage_counter++;
+   return line;
+
+error:
+   free(line->msg);
+   free(line->glyphs);
+   memset(line, 0, sizeof(*line));
+   return NULL;
+}
+
 int font_renderer_create_default(
       const font_renderer_driver_t **drv,
       void **handle,
@@ -1278,8 +1483,10 @@ font_data_t *font_driver_init_first(
    const void *font_driver = NULL;
    void *font_handle       = NULL;
    bool ok                 = false;
-#ifdef HAVE_THREADS
 
+   perf_boot_begin(PERF_BOOT_ASSETS);
+
+#ifdef HAVE_THREADS
    if (     threading_hint
          && is_threaded
          && !video_driver_is_hw_context())
@@ -1291,6 +1498,8 @@ font_data_t *font_driver_init_first(
    ok = font_init_first(&font_driver, &font_handle,
          video_data, font_path, font_size, api, is_threaded);
 
+   perf_boot_end(PERF_BOOT_ASSETS);
+
    if (ok)
    {
       font_data_t *font   = (font_data_t*)malloc(sizeof(*font));
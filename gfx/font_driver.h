@@ -60,9 +60,46 @@ struct font_atlas
    uint8_t *buffer; /* Alpha channel. */
    unsigned width;
    unsigned height;
+   /* Bounds of what changed since the last upload,
+    * with dirty_x1/dirty_y1 exclusive. Renderers that
+    * don't track this leave it empty, in which case
+    * the whole atlas has to be uploaded again */
+   unsigned dirty_x0;
+   unsigned dirty_y0;
+   unsigned dirty_x1;
+   unsigned dirty_y1;
+   /* Goes up whenever glyphs are added to or evicted
+    * from the atlas, which invalidates laid out text */
+   unsigned generation;
    bool dirty;
 };
 
+/* A glyph of a laid out line, with the pen position
+ * (sum of the advances of the glyphs before it) */
+struct font_layout_glyph
+{
+   struct font_glyph glyph;
+   int pen_x;
+   int pen_y;
+};
+
+/* A line of text laid out with a font renderer driver,
+ * unscaled and relative to the start of the line */
+struct font_layout
+{
+   char *msg;
+   struct font_layout_glyph *glyphs;
+   uint32_t hash;
+   unsigned msg_len;
+   unsigned count;
+   unsigned generation;
+   unsigned last_used;
+   /* Sum of the horizontal advances of all glyphs */
+   int width;
+};
+
+typedef struct font_layout_cache font_layout_cache_t;
+
 struct font_params
 {
    /* Drop shadow offset.
@@ -135,6 +172,28 @@ typedef struct
    float size;
 } font_data_t;
 
+/* Flags a rectangle of the atlas as changed */
+void font_atlas_mark_dirty(struct font_atlas *atlas,
+      unsigned x, unsigned y, unsigned width, unsigned height);
+
+/* Forgets what changed, once the atlas was uploaded */
+void font_atlas_clear_dirty(struct font_atlas *atlas);
+
+/* Keeps the layout of recently drawn lines of a font,
+ * so lines drawn every frame skip UTF-8 decoding and
+ * glyph lookups */
+font_layout_cache_t *font_layout_cache_new(
+      const font_renderer_driver_t *font_driver, void *font_data);
+
+void font_layout_cache_free(font_layout_cache_t *cache);
+
+/* Returns the layout of the msg_len bytes at msg, valid
+ * until the next call. Any glyph the font driver had
+ * to add to the atlas leaves it dirty, as get_glyph()
+ * would. */
+const struct font_layout *font_layout_cache_get(
+      font_layout_cache_t *cache, const char *msg, unsigned msg_len);
+
 /* font_path can be NULL for default font. */
 int font_renderer_create_default(
       const font_renderer_driver_t **drv,
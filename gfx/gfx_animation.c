@@ -1126,11 +1126,55 @@ bool gfx_animation_push(gfx_animation_ctx_entry_t *entry)
    if (p_anim->in_update)
       RBUF_PUSH(p_anim->pending, t);
    else
+   {
+      size_t i;
+
+      /* Coalesce by tag: rather than piling up tweens
+       * that all drive the same subject (e.g. while
+       * scrolling quickly), retarget the existing one.
+       * Tweens with a callback are left alone, since
+       * it must still fire when they complete */
+      for (i = 0; (t.tag != (uintptr_t)-1) && (i < RBUF_LEN(p_anim->list)); i++)
+      {
+         struct tween *tween = &p_anim->list[i];
+
+         if (     (tween->subject != t.subject)
+               || (tween->tag     != t.tag)
+               || tween->cb
+               || tween->deleted)
+            continue;
+
+         *tween = t;
+         return true;
+      }
+
       RBUF_PUSH(p_anim->list, t);
+   }
 
    return true;
 }
 
+/* Removes deleted tweens from the animation list,
+ * keeping the others in order */
+static void gfx_animation_compact(gfx_animation_t *p_anim)
+{
+   size_t i;
+   size_t count = 0;
+   size_t len   = RBUF_LEN(p_anim->list);
+
+   for (i = 0; i < len; i++)
+   {
+      if (p_anim->list[i].deleted)
+         continue;
+      if (count != i)
+         p_anim->list[count] = p_anim->list[i];
+      count++;
+   }
+
+   if (count != len)
+      RBUF_RESIZE(p_anim->list, count);
+}
+
 bool gfx_animation_update(
       gfx_animation_t *p_anim,
       retro_time_t current_time,
@@ -1247,6 +1291,9 @@ bool gfx_animation_update(
    p_anim->in_update       = true;
    p_anim->pending_deletes = false;
 
+   /* Completed tweens are only flagged here (callbacks
+    * may kill others, which flags them as well), and
+    * all are removed in one pass afterwards */
    for (i = 0; i < RBUF_LEN(p_anim->list); i++)
    {
       struct tween *tween   = &p_anim->list[i];
@@ -1256,35 +1303,26 @@ bool gfx_animation_update(
 
       tween->running_since += p_anim->delta_time;
 
-      *tween->subject       = tween->easing(
-            tween->running_since,
-            tween->initial_value,
-            tween->target_value - tween->initial_value,
-            tween->duration);
-
       if (tween->running_since >= tween->duration)
       {
-         *tween->subject = tween->target_value;
+         *tween->subject         = tween->target_value;
+         tween->deleted          = true;
+         p_anim->pending_deletes = true;
 
          if (tween->cb)
             tween->cb(tween->userdata);
-
-         RBUF_REMOVE(p_anim->list, i);
-         i--;
       }
+      else
+         *tween->subject       = tween->easing(
+               tween->running_since,
+               tween->initial_value,
+               tween->target_value - tween->initial_value,
+               tween->duration);
    }
 
    if (p_anim->pending_deletes)
    {
-      for (i = 0; i < RBUF_LEN(p_anim->list); i++)
-      {
-         struct tween *tween = &p_anim->list[i];
-         if (tween->deleted)
-         {
-            RBUF_REMOVE(p_anim->list, i);
-            i--;
-         }
-      }
+      gfx_animation_compact(p_anim);
       p_anim->pending_deletes = false;
    }
 
@@ -2141,7 +2179,10 @@ bool gfx_animation_kill_by_tag(uintptr_t *tag)
    if (!tag || *tag == (uintptr_t)-1)
       return false;
 
-   /* Scan animation list */
+   /* Scan animation list
+    * > If we are currently inside gfx_animation_update(),
+    *   we are already looping over p_anim->list entries,
+    *   so deletes are done once that loop is complete */
    for (i = 0; i < RBUF_LEN(p_anim->list); ++i)
    {
       struct tween *t = &p_anim->list[i];
@@ -2149,21 +2190,14 @@ bool gfx_animation_kill_by_tag(uintptr_t *tag)
       if (t->tag != *tag)
          continue;
 
-      /* If we are currently inside gfx_animation_update(),
-       * we are already looping over p_anim->list entries
-       * > Cannot modify p_anim->list now, so schedule a
-       *   delete for when the gfx_animation_update() loop
-       *   is complete */
-      if (p_anim->in_update)
-      {
-         t->deleted              = true;
-         p_anim->pending_deletes = true;
-      }
-      else
-      {
-         RBUF_REMOVE(p_anim->list, i);
-         --i;
-      }
+      t->deleted              = true;
+      p_anim->pending_deletes = true;
+   }
+
+   if (!p_anim->in_update && p_anim->pending_deletes)
+   {
+      gfx_animation_compact(p_anim);
+      p_anim->pending_deletes = false;
    }
 
    /* If we are currently inside gfx_animation_update(),
@@ -407,6 +407,167 @@ float gfx_display_get_dpi_scale(
    return adjusted_scale;
 }
 
+/* Whether the backend draws arbitrary triangle lists
+ * with per-vertex colours, as batching needs */
+static bool gfx_display_batch_supported(
+      const gfx_display_ctx_driver_t *dispctx)
+{
+   switch (dispctx->type)
+   {
+      case GFX_VIDEO_DRIVER_OPENGL:
+      case GFX_VIDEO_DRIVER_OPENGL_CORE:
+      case GFX_VIDEO_DRIVER_VULKAN:
+         return true;
+      default:
+         break;
+   }
+
+   return false;
+}
+
+/* Expands a 4-vertex triangle strip (BL BR TL TR) into
+ * 6 triangle list vertices */
+static void gfx_display_strip_to_triangles(
+      float *vertex, float *tex_coord, float *color,
+      const float *strip_vertex, const float *strip_tex_coord,
+      const float *strip_color)
+{
+   static const unsigned indices[6] = { 0, 1, 2, 2, 1, 3 };
+   unsigned i;
+
+   for (i = 0; i < 6; i++)
+   {
+      unsigned j        = indices[i];
+
+      vertex[0]         = strip_vertex[j * 2 + 0];
+      vertex[1]         = strip_vertex[j * 2 + 1];
+      tex_coord[0]      = strip_tex_coord[j * 2 + 0];
+      tex_coord[1]      = strip_tex_coord[j * 2 + 1];
+      color[0]          = strip_color[j * 4 + 0];
+      color[1]          = strip_color[j * 4 + 1];
+      color[2]          = strip_color[j * 4 + 2];
+      color[3]          = strip_color[j * 4 + 3];
+
+      vertex           += 2;
+      tex_coord        += 2;
+      color            += 4;
+   }
+}
+
+static void gfx_display_batch_flush(gfx_display_t *p_disp)
+{
+   gfx_display_ctx_draw_t draw;
+   struct video_coords coords;
+   gfx_display_batch_t *batch        = &p_disp->batch;
+   gfx_display_ctx_driver_t *dispctx = p_disp->dispctx;
+
+   if (batch->quads == 0)
+      return;
+
+   coords.vertices      = batch->quads * 6;
+   coords.vertex        = batch->vertex;
+   coords.tex_coord     = batch->tex_coord;
+   coords.lut_tex_coord = batch->tex_coord;
+   coords.color         = batch->color;
+
+   draw.x               = 0;
+   draw.y               = 0;
+   draw.width           = batch->width;
+   draw.height          = batch->height;
+   draw.coords          = &coords;
+   draw.matrix_data     = NULL;
+   draw.texture         = gfx_display_white_texture;
+   draw.prim_type       = GFX_DISPLAY_PRIM_TRIANGLES;
+   draw.pipeline_id     = 0;
+   draw.scale_factor    = 1.0f;
+   draw.rotation        = 0.0f;
+
+   batch->quads         = 0;
+
+   if (dispctx->blend_begin)
+      dispctx->blend_begin(batch->userdata);
+   if (dispctx->draw)
+      dispctx->draw(&draw, batch->userdata,
+            batch->video_width, batch->video_height);
+   if (dispctx->blend_end)
+      dispctx->blend_end(batch->userdata);
+}
+
+void gfx_display_batch_begin(gfx_display_t *p_disp)
+{
+   if (!p_disp->dispctx || !gfx_display_batch_supported(p_disp->dispctx))
+      return;
+
+   p_disp->batch.quads  = 0;
+   p_disp->batch.active = true;
+}
+
+void gfx_display_batch_end(gfx_display_t *p_disp)
+{
+   if (!p_disp->batch.active)
+      return;
+
+   gfx_display_batch_flush(p_disp);
+   p_disp->batch.active = false;
+}
+
+/* Queues the quad, whose coordinates are in the same
+ * bottom-up pixel space as the viewport of a quad draw */
+static void gfx_display_batch_add_quad(gfx_display_t *p_disp,
+      void *userdata, unsigned video_width, unsigned video_height,
+      int x, int y, unsigned w, unsigned h,
+      unsigned width, unsigned height, const float *color)
+{
+   static const float white[16] = {
+      1.0f, 1.0f, 1.0f, 1.0f,
+      1.0f, 1.0f, 1.0f, 1.0f,
+      1.0f, 1.0f, 1.0f, 1.0f,
+      1.0f, 1.0f, 1.0f, 1.0f
+   };
+   static const float no_tex_coord[8] = { 0.0f };
+   float vertex[8];
+   gfx_display_batch_t *batch        = &p_disp->batch;
+   gfx_display_ctx_driver_t *dispctx = p_disp->dispctx;
+   const float *tex_coord            = dispctx->get_default_tex_coords
+      ? dispctx->get_default_tex_coords() : no_tex_coord;
+   float x0                          = x / (float)width;
+   float y0                          = y / (float)height;
+   float x1                          = (x + (int)w) / (float)width;
+   float y1                          = (y + (int)h) / (float)height;
+
+   if (     batch->quads == GFX_DISPLAY_BATCH_MAX_QUADS
+         || (batch->quads > 0
+            && (  batch->userdata     != userdata
+               || batch->video_width  != video_width
+               || batch->video_height != video_height
+               || batch->width        != width
+               || batch->height       != height)))
+      gfx_display_batch_flush(p_disp);
+
+   batch->userdata      = userdata;
+   batch->video_width   = video_width;
+   batch->video_height  = video_height;
+   batch->width         = width;
+   batch->height        = height;
+
+   vertex[0]            = x0;
+   vertex[1]            = y0;
+   vertex[2]            = x1;
+   vertex[3]            = y0;
+   vertex[4]            = x0;
+   vertex[5]            = y1;
+   vertex[6]            = x1;
+   vertex[7]            = y1;
+
+   gfx_display_strip_to_triangles(
+         batch->vertex    + batch->quads * 6 * 2,
+         batch->tex_coord + batch->quads * 6 * 2,
+         batch->color     + batch->quads * 6 * 4,
+         vertex, tex_coord, color ? color : white);
+
+   batch->quads++;
+}
+
 /* Begin scissoring operation */
 void gfx_display_scissor_begin(
       gfx_display_t *p_disp,
@@ -416,6 +577,9 @@ void gfx_display_scissor_begin(
       int x, int y, unsigned width, unsigned height)
 {
    gfx_display_ctx_driver_t *dispctx = p_disp->dispctx;
+
+   gfx_display_batch_flush(p_disp);
+
    if (dispctx && dispctx->scissor_begin)
    {
       if (y < 0)
@@ -545,6 +709,13 @@ void gfx_display_draw_quad(
    if (!dispctx)
       return;
 
+   if (p_disp->batch.active)
+   {
+      gfx_display_batch_add_quad(p_disp, data, video_width, video_height,
+            x, (int)height - y - (int)h, w, h, width, height, color);
+      return;
+   }
+
    coords.vertices      = 4;
    coords.vertex        = NULL;
    coords.tex_coord     = NULL;
@@ -593,6 +764,8 @@ void gfx_display_draw_polygon(
    if (!dispctx)
       return;
 
+   gfx_display_batch_flush(p_disp);
+
    vertex[0]             = x1 / (float)width;
    vertex[1]             = y1 / (float)height;
    vertex[2]             = x2 / (float)width;
@@ -656,6 +829,38 @@ static void gfx_display_draw_texture(
    dispctx->draw(draw, userdata, video_width, video_height);
 }
 
+/* The sections of a sliced texture, as one triangle list */
+typedef struct gfx_display_slice_batch
+{
+   float vertex[9 * 6 * 2];
+   float tex_coord[9 * 6 * 2];
+   float color[9 * 6 * 4];
+   unsigned sections;
+   bool enable;
+} gfx_display_slice_batch_t;
+
+static void gfx_display_draw_slice_section(
+      gfx_display_ctx_driver_t *dispctx,
+      gfx_display_ctx_draw_t *draw,
+      gfx_display_slice_batch_t *slice,
+      void *userdata, unsigned video_width, unsigned video_height)
+{
+   if (!slice->enable)
+   {
+      dispctx->draw(draw, userdata, video_width, video_height);
+      return;
+   }
+
+   gfx_display_strip_to_triangles(
+         slice->vertex    + slice->sections * 6 * 2,
+         slice->tex_coord + slice->sections * 6 * 2,
+         slice->color     + slice->sections * 6 * 4,
+         draw->coords->vertex,
+         draw->coords->tex_coord,
+         draw->coords->color);
+   slice->sections++;
+}
+
 /* Draw the texture split into 9 sections, without scaling the corners.
  * The middle sections will only scale in the X axis, and the side
  * sections will only scale in the Y axis. */
@@ -675,6 +880,7 @@ void gfx_display_draw_texture_slice(
    math_matrix_4x4 mymat;
    gfx_display_ctx_driver_t 
       *dispctx              = p_disp->dispctx;
+   gfx_display_slice_batch_t slice;
    float V_BL[2], V_BR[2], V_TL[2], V_TR[2], T_BL[2], T_BR[2], T_TL[2], T_TR[2];
    /* To prevent visible seams between the corners and
     * middle segments of the sliced texture, the texture
@@ -751,6 +957,11 @@ void gfx_display_draw_texture_slice(
    if (!dispctx || !dispctx->draw)
       return;
 
+   gfx_display_batch_flush(p_disp);
+
+   slice.sections = 0;
+   slice.enable   = gfx_display_batch_supported(dispctx);
+
    /* the four vertices of the top-left corner of the image,
     * used as a starting point for all the other sections */
    V_BL[0] = norm_x;
@@ -797,8 +1008,8 @@ void gfx_display_draw_texture_slice(
    /* vertex coords are specfied bottom-up in this order: BL BR TL TR */
    /* texture coords are specfied top-down in this order: BL BR TL TR */
 
-   /* If someone wants to change this to not draw several times, the
-    * coordinates will need to be modified because of the triangle strip usage. */
+   /* Each section is specified as a triangle strip; on backends
+    * that support it, they are expanded to a single triangle list. */
 
    /* top-left corner */
    vert_coord[0] = V_BL[0];
@@ -819,7 +1030,8 @@ void gfx_display_draw_texture_slice(
    tex_coord[6] = T_TR[0];
    tex_coord[7] = T_TR[1];
 
-   dispctx->draw(&draw, userdata, video_width, video_height);
+   gfx_display_draw_slice_section(dispctx, &draw, &slice,
+         userdata, video_width, video_height);
 
    /* top-middle section */
    vert_coord[0] = V_BL[0] + vert_woff;
@@ -840,7 +1052,8 @@ void gfx_display_draw_texture_slice(
    tex_coord[6] = T_TR[0] + tex_mid_width;
    tex_coord[7] = T_TR[1];
 
-   dispctx->draw(&draw, userdata, video_width, video_height);
+   gfx_display_draw_slice_section(dispctx, &draw, &slice,
+         userdata, video_width, video_height);
 
    /* top-right corner */
    vert_coord[0] = V_BL[0] + vert_woff + vert_scaled_mid_width;
@@ -861,7 +1074,8 @@ void gfx_display_draw_texture_slice(
    tex_coord[6] = T_TR[0] + tex_mid_width + tex_woff;
    tex_coord[7] = T_TR[1];
 
-   dispctx->draw(&draw, userdata, video_width, video_height);
+   gfx_display_draw_slice_section(dispctx, &draw, &slice,
+         userdata, video_width, video_height);
 
    /* middle-left section */
    vert_coord[0] = V_BL[0];
@@ -882,7 +1096,8 @@ void gfx_display_draw_texture_slice(
    tex_coord[6] = T_TR[0];
    tex_coord[7] = T_TR[1] + tex_hoff;
 
-   dispctx->draw(&draw, userdata, video_width, video_height);
+   gfx_display_draw_slice_section(dispctx, &draw, &slice,
+         userdata, video_width, video_height);
 
    /* center section */
    vert_coord[0] = V_BL[0] + vert_woff;
@@ -903,7 +1118,8 @@ void gfx_display_draw_texture_slice(
    tex_coord[6] = T_TR[0] + tex_mid_width;
    tex_coord[7] = T_TR[1] + tex_hoff;
 
-   dispctx->draw(&draw, userdata, video_width, video_height);
+   gfx_display_draw_slice_section(dispctx, &draw, &slice,
+         userdata, video_width, video_height);
 
    /* middle-right section */
    vert_coord[0] = V_BL[0] + vert_woff + vert_scaled_mid_width;
@@ -924,7 +1140,8 @@ void gfx_display_draw_texture_slice(
    tex_coord[6] = T_TR[0] + tex_woff + tex_mid_width;
    tex_coord[7] = T_TR[1] + tex_hoff;
 
-   dispctx->draw(&draw, userdata, video_width, video_height);
+   gfx_display_draw_slice_section(dispctx, &draw, &slice,
+         userdata, video_width, video_height);
 
    /* bottom-left corner */
    vert_coord[0] = V_BL[0];
@@ -945,7 +1162,8 @@ void gfx_display_draw_texture_slice(
    tex_coord[6] = T_TR[0];
    tex_coord[7] = T_TR[1] + tex_hoff + tex_mid_height;
 
-   dispctx->draw(&draw, userdata, video_width, video_height);
+   gfx_display_draw_slice_section(dispctx, &draw, &slice,
+         userdata, video_width, video_height);
 
    /* bottom-middle section */
    vert_coord[0] = V_BL[0] + vert_woff;
@@ -966,7 +1184,8 @@ void gfx_display_draw_texture_slice(
    tex_coord[6] = T_TR[0] + tex_mid_width;
    tex_coord[7] = T_TR[1] + tex_hoff + tex_mid_height;
 
-   dispctx->draw(&draw, userdata, video_width, video_height);
+   gfx_display_draw_slice_section(dispctx, &draw, &slice,
+         userdata, video_width, video_height);
 
    /* bottom-right corner */
    vert_coord[0] = V_BL[0] + vert_woff + vert_scaled_mid_width;
@@ -987,7 +1206,21 @@ void gfx_display_draw_texture_slice(
    tex_coord[6] = T_TR[0] + tex_woff + tex_mid_width;
    tex_coord[7] = T_TR[1] + tex_hoff + tex_mid_height;
 
-   dispctx->draw(&draw, userdata, video_width, video_height);
+   gfx_display_draw_slice_section(dispctx, &draw, &slice,
+         userdata, video_width, video_height);
+
+   /* All nine sections at once */
+   if (slice.enable)
+   {
+      coords.vertices      = slice.sections * 6;
+      coords.vertex        = slice.vertex;
+      coords.tex_coord     = slice.tex_coord;
+      coords.lut_tex_coord = slice.tex_coord;
+      coords.color         = slice.color;
+      draw.prim_type       = GFX_DISPLAY_PRIM_TRIANGLES;
+
+      dispctx->draw(&draw, userdata, video_width, video_height);
+   }
 }
 
 void gfx_display_rotate_z(gfx_display_t *p_disp,
@@ -1319,6 +1552,7 @@ void gfx_display_free(void)
 {
    gfx_display_t           *p_disp   = disp_get_ptr();
    video_coord_array_free(&p_disp->dispca);
+   video_frame_arena_free(&p_disp->frame_arena);
 
    p_disp->msg_force           = false;
    p_disp->header_height       = 0;
@@ -1338,6 +1572,18 @@ void gfx_display_init(void)
    p_dispca->allocated           =  0;
 }
 
+void *gfx_display_frame_alloc(size_t size)
+{
+   gfx_display_t *p_disp = disp_get_ptr();
+   return video_frame_arena_alloc(&p_disp->frame_arena, size);
+}
+
+void gfx_display_frame_reset(void)
+{
+   gfx_display_t *p_disp = disp_get_ptr();
+   video_frame_arena_reset(&p_disp->frame_arena);
+}
+
 bool gfx_display_driver_exists(const char *s)
 {
    unsigned i;
@@ -203,10 +203,33 @@ typedef struct gfx_display_ctx_powerstate
    bool charging;
 } gfx_display_ctx_powerstate_t;
 
+/* Up to this many quads are sent to the backend at once */
+#define GFX_DISPLAY_BATCH_MAX_QUADS 64
+
+/* Quads drawn by gfx_display_draw_quad() between
+ * gfx_display_batch_begin() and gfx_display_batch_end(),
+ * queued up as a single triangle list */
+typedef struct gfx_display_batch
+{
+   float vertex[GFX_DISPLAY_BATCH_MAX_QUADS * 6 * 2];
+   float tex_coord[GFX_DISPLAY_BATCH_MAX_QUADS * 6 * 2];
+   float color[GFX_DISPLAY_BATCH_MAX_QUADS * 6 * 4];
+   void *userdata;
+   unsigned quads;
+   unsigned video_width;
+   unsigned video_height;
+   unsigned width;
+   unsigned height;
+   bool active;
+} gfx_display_batch_t;
+
 struct gfx_display
 {
    gfx_display_ctx_driver_t *dispctx;
    video_coord_array_t dispca; /* ptr alignment */
+   gfx_display_batch_t batch;  /* ptr alignment */
+   /* Transient geometry, reset before every video frame */
+   video_frame_arena_t frame_arena; /* ptr alignment */
 
    /* Width, height and pitch of the display framebuffer */
    size_t   framebuf_pitch;
@@ -227,6 +250,13 @@ void gfx_display_free(void);
 
 void gfx_display_init(void);
 
+/* Memory for geometry that is only needed until the current
+ * frame has been drawn. Never needs to be freed. */
+void *gfx_display_frame_alloc(size_t size);
+
+/* Called on the rendering thread before each video frame */
+void gfx_display_frame_reset(void);
+
 void gfx_display_draw_cursor(
       gfx_display_t *p_disp,
       void *userdata,
@@ -258,6 +288,15 @@ void gfx_display_scissor_begin(
 
 void gfx_display_font_free(font_data_t *font);
 
+/* Queue up the quads drawn until gfx_display_batch_end(),
+ * on backends that can draw them as one triangle list.
+ * Nothing but gfx_display_draw_quad() and the other
+ * gfx_display_draw_*() functions (which flush the queue
+ * first) may draw in between - font rendering included */
+void gfx_display_batch_begin(gfx_display_t *p_disp);
+
+void gfx_display_batch_end(gfx_display_t *p_disp);
+
 void gfx_display_set_width(unsigned width);
 void gfx_display_get_fb_size(unsigned *fb_width, unsigned *fb_height,
       size_t *fb_pitch);
@@ -38,14 +38,45 @@
 #define DEFAULT_GFX_THUMBNAIL_STREAM_DELAY  83.333333f
 #define DEFAULT_GFX_THUMBNAIL_FADE_DURATION 166.66667f
 
+/* Maximum number of prefetched images that may be
+ * loading at any one time */
+#define GFX_THUMBNAIL_PREFETCH_MAX_PENDING 16
+
 /* Utility structure, sent as userdata when pushing
  * an image load */
 typedef struct
 {
    uint64_t list_id;
    gfx_thumbnail_t *thumbnail;
+   /* Set if the texture should be cached */
+   char *path;
+   unsigned upscale_threshold;
+   /* Only used by prefetch loads */
+   unsigned prefetch_id;
 } gfx_thumbnail_tag_t;
 
+/* Texture cache entry, keyed by image path and
+ * upscale threshold (which determines the size
+ * of the uploaded texture) */
+struct gfx_thumbnail_cache_entry
+{
+   gfx_thumbnail_cache_entry_t *prev;
+   gfx_thumbnail_cache_entry_t *next;
+   char *path;
+   /* Zero while a prefetch of the image is pending */
+   uintptr_t texture;
+   size_t size;
+   unsigned width;
+   unsigned height;
+   unsigned upscale_threshold;
+   /* Number of gfx_thumbnail_t currently
+    * displaying the texture */
+   unsigned refs;
+   /* Identifies the prefetch that created
+    * a pending entry */
+   unsigned prefetch_id;
+};
+
 /* Setters */
 
 /* When streaming thumbnails, sets time in ms that an
@@ -82,6 +113,405 @@ void gfx_thumbnail_set_fade_missing(bool fade_missing)
    p_gfx_thumb->fade_missing = fade_missing;
 }
 
+/* Sets the amount of GPU memory in bytes that
+ * cached thumbnail textures may use
+ * > If 'size' is zero, thumbnails are not cached */
+void gfx_thumbnail_set_cache_size(size_t size)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+
+   p_gfx_thumb->cache_budget = size;
+}
+
+/* Specifies whether thumbnails should be loaded
+ * from thumbnail packs when available */
+void gfx_thumbnail_set_pack_enable(bool enable)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+
+   if (!enable)
+      gfx_thumbnail_pack_reload();
+
+   p_gfx_thumb->pack_enable = enable;
+}
+
+/* Thumbnail packs */
+
+/* Closes all open thumbnail packs, so that they
+ * are re-read on next use
+ * > Must be called whenever a pack is (re)generated */
+void gfx_thumbnail_pack_reload(void)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+   size_t i;
+
+   for (i = 0; i < GFX_THUMBNAIL_PACK_SLOTS; i++)
+   {
+      if (p_gfx_thumb->packs[i].path)
+         free(p_gfx_thumb->packs[i].path);
+      gfx_thumbnail_pack_free(p_gfx_thumb->packs[i].pack);
+
+      p_gfx_thumb->packs[i].path = NULL;
+      p_gfx_thumb->packs[i].pack = NULL;
+   }
+
+   p_gfx_thumb->pack_next = 0;
+}
+
+/* Returns the pack entry of the image at 'thumbnail_path',
+ * or NULL if packs are disabled or the image is not
+ * packed. On success, 'pack_path' is set to the path
+ * of the pack file */
+static const gfx_thumbnail_pack_entry_t *gfx_thumbnail_pack_lookup(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      const char *thumbnail_path, const char **pack_path)
+{
+   char path[PATH_MAX_LENGTH];
+   size_t i;
+
+   if (!p_gfx_thumb->pack_enable)
+      return NULL;
+
+   if (!gfx_thumbnail_pack_get_path(thumbnail_path, path, sizeof(path)))
+      return NULL;
+
+   for (i = 0; i < GFX_THUMBNAIL_PACK_SLOTS; i++)
+      if (string_is_equal(p_gfx_thumb->packs[i].path, path))
+         break;
+
+   /* Not seen yet - replace the oldest slot */
+   if (i == GFX_THUMBNAIL_PACK_SLOTS)
+   {
+      i                      = p_gfx_thumb->pack_next;
+      p_gfx_thumb->pack_next = (i + 1) % GFX_THUMBNAIL_PACK_SLOTS;
+
+      if (p_gfx_thumb->packs[i].path)
+         free(p_gfx_thumb->packs[i].path);
+      gfx_thumbnail_pack_free(p_gfx_thumb->packs[i].pack);
+
+      p_gfx_thumb->packs[i].path = strdup(path);
+      p_gfx_thumb->packs[i].pack = gfx_thumbnail_pack_open(path);
+   }
+
+   if (!p_gfx_thumb->packs[i].pack)
+      return NULL;
+
+   *pack_path = p_gfx_thumb->packs[i].path;
+
+   return gfx_thumbnail_pack_find(p_gfx_thumb->packs[i].pack,
+         path_basename_nocompression(thumbnail_path));
+}
+
+/* Returns true if the image at 'thumbnail_path' is
+ * packed, or exists on disk */
+static bool gfx_thumbnail_image_exists(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      const char *thumbnail_path)
+{
+   const char *pack_path = NULL;
+
+   if (gfx_thumbnail_pack_lookup(p_gfx_thumb, thumbnail_path, &pack_path))
+      return true;
+
+   return path_is_valid(thumbnail_path);
+}
+
+/* Pushes an image load task for 'thumbnail_path',
+ * reading from a pack if the image is packed */
+static bool gfx_thumbnail_push_image_load(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      const char *thumbnail_path,
+      unsigned gfx_thumbnail_upscale_threshold,
+      enum task_priority priority,
+      retro_task_callback_t cb, gfx_thumbnail_tag_t *thumbnail_tag)
+{
+   unsigned width                          = 0;
+   unsigned height                         = 0;
+   const char *pack_path                   = NULL;
+   const gfx_thumbnail_pack_entry_t *entry = gfx_thumbnail_pack_lookup(
+         p_gfx_thumb, thumbnail_path, &pack_path);
+
+   if (entry)
+      return task_push_image_load_pack(pack_path, entry,
+            gfx_thumbnail_upscale_threshold, priority,
+            cb, thumbnail_tag);
+
+   /* Thumbnails are never drawn larger than the screen */
+   video_driver_get_size(&width, &height);
+
+   return task_push_image_load_priority(
+         thumbnail_path, video_driver_supports_rgba(),
+         gfx_thumbnail_upscale_threshold, width, height, priority,
+         cb, thumbnail_tag);
+}
+
+/* Texture cache */
+
+static void gfx_thumbnail_cache_unlink(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      gfx_thumbnail_cache_entry_t *entry)
+{
+   if (entry->prev)
+      entry->prev->next       = entry->next;
+   else
+      p_gfx_thumb->cache_head = entry->next;
+
+   if (entry->next)
+      entry->next->prev       = entry->prev;
+   else
+      p_gfx_thumb->cache_tail = entry->prev;
+
+   entry->prev = NULL;
+   entry->next = NULL;
+}
+
+static void gfx_thumbnail_cache_push_front(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      gfx_thumbnail_cache_entry_t *entry)
+{
+   entry->prev = NULL;
+   entry->next = p_gfx_thumb->cache_head;
+
+   if (p_gfx_thumb->cache_head)
+      p_gfx_thumb->cache_head->prev = entry;
+   else
+      p_gfx_thumb->cache_tail       = entry;
+
+   p_gfx_thumb->cache_head = entry;
+}
+
+static void gfx_thumbnail_cache_free_entry(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      gfx_thumbnail_cache_entry_t *entry)
+{
+   gfx_thumbnail_cache_unlink(p_gfx_thumb, entry);
+
+   if (entry->texture)
+      video_driver_texture_unload(&entry->texture);
+   else if (p_gfx_thumb->prefetch_pending > 0)
+      p_gfx_thumb->prefetch_pending--;
+
+   p_gfx_thumb->cache_size -= entry->size;
+
+   free(entry->path);
+   free(entry);
+}
+
+static gfx_thumbnail_cache_entry_t *gfx_thumbnail_cache_find(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      const char *path, unsigned upscale_threshold)
+{
+   gfx_thumbnail_cache_entry_t *entry = p_gfx_thumb->cache_head;
+
+   for (; entry; entry = entry->next)
+      if (     entry->upscale_threshold == upscale_threshold
+            && string_is_equal(entry->path, path))
+         return entry;
+
+   return NULL;
+}
+
+static gfx_thumbnail_cache_entry_t *gfx_thumbnail_cache_find_texture(
+      gfx_thumbnail_state_t *p_gfx_thumb, uintptr_t texture)
+{
+   gfx_thumbnail_cache_entry_t *entry = p_gfx_thumb->cache_head;
+
+   for (; entry; entry = entry->next)
+      if (entry->texture == texture)
+         return entry;
+
+   return NULL;
+}
+
+/* Estimated GPU memory used by a texture,
+ * including its mipmap chain */
+static size_t gfx_thumbnail_cache_texture_size(
+      unsigned width, unsigned height)
+{
+   return (size_t)width * height * sizeof(uint32_t) * 4 / 3;
+}
+
+static void gfx_thumbnail_cache_touch(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      gfx_thumbnail_cache_entry_t *entry)
+{
+   gfx_thumbnail_cache_unlink(p_gfx_thumb, entry);
+   gfx_thumbnail_cache_push_front(p_gfx_thumb, entry);
+}
+
+static gfx_thumbnail_cache_entry_t *gfx_thumbnail_cache_new_entry(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      const char *path, unsigned upscale_threshold)
+{
+   gfx_thumbnail_cache_entry_t *entry = (gfx_thumbnail_cache_entry_t*)
+         malloc(sizeof(*entry));
+
+   if (!entry)
+      return NULL;
+
+   if (!(entry->path = strdup(path)))
+   {
+      free(entry);
+      return NULL;
+   }
+
+   entry->texture           = 0;
+   entry->size              = 0;
+   entry->width             = 0;
+   entry->height            = 0;
+   entry->upscale_threshold = upscale_threshold;
+   entry->refs              = 0;
+   entry->prefetch_id       = p_gfx_thumb->prefetch_id;
+
+   gfx_thumbnail_cache_push_front(p_gfx_thumb, entry);
+   return entry;
+}
+
+/* Gives a pending entry the texture of a loaded image */
+static void gfx_thumbnail_cache_fill(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      gfx_thumbnail_cache_entry_t *entry,
+      uintptr_t texture, unsigned width, unsigned height, size_t size)
+{
+   if (p_gfx_thumb->prefetch_pending > 0)
+      p_gfx_thumb->prefetch_pending--;
+
+   entry->texture           = texture;
+   entry->width             = width;
+   entry->height            = height;
+   entry->size              = size;
+   p_gfx_thumb->cache_size += size;
+}
+
+/* Drops least recently used textures that are no
+ * longer displayed until the cache fits its budget */
+static void gfx_thumbnail_cache_evict(gfx_thumbnail_state_t *p_gfx_thumb)
+{
+   gfx_thumbnail_cache_entry_t *entry = p_gfx_thumb->cache_tail;
+
+   while (entry && (p_gfx_thumb->cache_size > p_gfx_thumb->cache_budget))
+   {
+      gfx_thumbnail_cache_entry_t *prev = entry->prev;
+
+      if (entry->refs == 0)
+         gfx_thumbnail_cache_free_entry(p_gfx_thumb, entry);
+
+      entry = prev;
+   }
+}
+
+/* Drops least recently used textures that are no
+ * longer displayed until @size bytes have been freed */
+void gfx_thumbnail_cache_trim(size_t size)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+   gfx_thumbnail_cache_entry_t *entry = p_gfx_thumb->cache_tail;
+   size_t target                      = (p_gfx_thumb->cache_size > size)
+      ? p_gfx_thumb->cache_size - size : 0;
+
+   while (entry && (p_gfx_thumb->cache_size > target))
+   {
+      gfx_thumbnail_cache_entry_t *prev = entry->prev;
+
+      if (entry->refs == 0)
+         gfx_thumbnail_cache_free_entry(p_gfx_thumb, entry);
+
+      entry = prev;
+   }
+}
+
+/* Hands a newly uploaded texture over to the cache.
+ * Returns false if the texture is not cached, in which
+ * case the thumbnail keeps sole ownership of it */
+static bool gfx_thumbnail_cache_insert(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      const char *path, unsigned upscale_threshold,
+      gfx_thumbnail_t *thumbnail)
+{
+   gfx_thumbnail_cache_entry_t *entry = NULL;
+   size_t size = gfx_thumbnail_cache_texture_size(
+         thumbnail->width, thumbnail->height);
+
+   if (string_is_empty(path) || (size > p_gfx_thumb->cache_budget))
+      return false;
+
+   if ((entry = gfx_thumbnail_cache_find(
+               p_gfx_thumb, path, upscale_threshold)))
+   {
+      /* Another thumbnail may have loaded the same
+       * image in the meantime - share its texture */
+      if (entry->texture)
+      {
+         video_driver_texture_unload(&thumbnail->texture);
+         thumbnail->texture = entry->texture;
+         thumbnail->width   = entry->width;
+         thumbnail->height  = entry->height;
+      }
+      /* Image is still being prefetched - the
+       * prefetch result will be discarded */
+      else
+         gfx_thumbnail_cache_fill(p_gfx_thumb, entry,
+               thumbnail->texture, thumbnail->width,
+               thumbnail->height, size);
+
+      entry->refs++;
+      gfx_thumbnail_cache_touch(p_gfx_thumb, entry);
+      gfx_thumbnail_cache_evict(p_gfx_thumb);
+      return true;
+   }
+
+   if (!(entry = gfx_thumbnail_cache_new_entry(
+               p_gfx_thumb, path, upscale_threshold)))
+      return false;
+
+   entry->texture           = thumbnail->texture;
+   entry->size              = size;
+   entry->width             = thumbnail->width;
+   entry->height            = thumbnail->height;
+   entry->refs              = 1;
+   p_gfx_thumb->cache_size += size;
+
+   gfx_thumbnail_cache_evict(p_gfx_thumb);
+   return true;
+}
+
+/* Drops all entries still waiting on a prefetch */
+static void gfx_thumbnail_cache_drop_pending(
+      gfx_thumbnail_state_t *p_gfx_thumb)
+{
+   gfx_thumbnail_cache_entry_t *entry = p_gfx_thumb->cache_head;
+
+   while (entry)
+   {
+      gfx_thumbnail_cache_entry_t *next = entry->next;
+
+      if (!entry->texture)
+         gfx_thumbnail_cache_free_entry(p_gfx_thumb, entry);
+
+      entry = next;
+   }
+}
+
+/* Unloads all cached thumbnail textures
+ * >> **MUST** only be called once every gfx_thumbnail_t
+ *    has been reset, i.e. after the menu driver's
+ *    context_destroy() */
+void gfx_thumbnail_cache_flush(void)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+
+   while (p_gfx_thumb->cache_head)
+      gfx_thumbnail_cache_free_entry(p_gfx_thumb,
+            p_gfx_thumb->cache_head);
+
+   p_gfx_thumb->cache_size       = 0;
+   p_gfx_thumb->prefetch_pending = 0;
+   /* Discard any prefetch still in flight */
+   p_gfx_thumb->prefetch_id++;
+
+   gfx_thumbnail_pack_reload();
+}
+
 /* Callbacks */
 
 /* Fade animation callback - simply resets thumbnail
@@ -134,6 +564,66 @@ static void gfx_thumbnail_init_fade(
    }
 }
 
+/* Used to process thumbnail data once its texture
+ * has been uploaded (or the upload has failed) */
+static void gfx_thumbnail_handle_texture(void *user_data,
+      void *image, uintptr_t texture, bool success)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+   struct texture_image *img          = (struct texture_image*)image;
+   gfx_thumbnail_tag_t *thumbnail_tag = (gfx_thumbnail_tag_t*)user_data;
+
+   /* Thumbnail may have been dropped while the
+    * upload was queued */
+   if (     (thumbnail_tag->list_id != p_gfx_thumb->list_id)
+         || (thumbnail_tag->thumbnail->status != GFX_THUMBNAIL_STATUS_PENDING))
+   {
+      if (success)
+         video_driver_texture_unload(&texture);
+      goto end;
+   }
+
+   /* Sanity check: if thumbnail already has a texture,
+    * we're in some kind of weird error state - in this
+    * case, the best course of action is to just reset
+    * the thumbnail... */
+   if (thumbnail_tag->thumbnail->texture)
+      gfx_thumbnail_reset(thumbnail_tag->thumbnail);
+
+   thumbnail_tag->thumbnail->status = GFX_THUMBNAIL_STATUS_MISSING;
+
+   if (success)
+   {
+      thumbnail_tag->thumbnail->texture = texture;
+      video_driver_texture_set_gpu_mem_type(texture,
+            VIDEO_GPU_MEM_THUMBNAILS);
+
+      /* Cache dimensions */
+      thumbnail_tag->thumbnail->width  = img->width;
+      thumbnail_tag->thumbnail->height = img->height;
+
+      /* Update thumbnail status */
+      thumbnail_tag->thumbnail->status = GFX_THUMBNAIL_STATUS_AVAILABLE;
+
+      /* Keep the texture around for when the entry
+       * scrolls back into view */
+      gfx_thumbnail_cache_insert(p_gfx_thumb,
+            thumbnail_tag->path, thumbnail_tag->upscale_threshold,
+            thumbnail_tag->thumbnail);
+   }
+
+   /* Trigger 'fade in' animation, if required */
+   gfx_thumbnail_init_fade(p_gfx_thumb, thumbnail_tag->thumbnail);
+
+end:
+   image_texture_free(img);
+   free(img);
+
+   if (thumbnail_tag->path)
+      free(thumbnail_tag->path);
+   free(thumbnail_tag);
+}
+
 /* Used to process thumbnail data following completion
  * of image load task */
 static void gfx_thumbnail_handle_upload(
@@ -157,6 +647,18 @@ static void gfx_thumbnail_handle_upload(
    if (thumbnail_tag->thumbnail->status != GFX_THUMBNAIL_STATUS_PENDING)
       goto end;
 
+   /* Check we have a valid image */
+   if (img && (img->width > 0) && (img->height > 0))
+   {
+      /* Upload texture to GPU along with everything
+       * else loaded this frame, rather than waiting
+       * for it here */
+      if (video_driver_texture_load_async(
+               img, TEXTURE_FILTER_MIPMAP_LINEAR,
+               gfx_thumbnail_handle_texture, thumbnail_tag))
+         return;
+   }
+
    /* Sanity check: if thumbnail already has a texture,
     * we're in some kind of weird error state - in this
     * case, the best course of action is to just reset
@@ -164,34 +666,80 @@ static void gfx_thumbnail_handle_upload(
    if (thumbnail_tag->thumbnail->texture)
       gfx_thumbnail_reset(thumbnail_tag->thumbnail);
 
-   /* Set thumbnail 'missing' status by default
-    * (saves a number of checks later) */
+   /* Thumbnail is missing - 'fade in' animations
+    * should still be applied (based on current
+    * thumbnail status and global configuration) */
    thumbnail_tag->thumbnail->status = GFX_THUMBNAIL_STATUS_MISSING;
+   fade_enabled                     = true;
 
-   /* If we reach this stage, thumbnail 'fade in'
-    * animations should be applied (based on current
-    * thumbnail status and global configuration) */
-   fade_enabled = true;
+end:
+   /* Clean up */
+   if (img)
+   {
+      image_texture_free(img);
+      free(img);
+   }
 
-   /* Check we have a valid image */
-   if (!img || (img->width < 1) || (img->height < 1))
+   if (thumbnail_tag)
+   {
+      /* Trigger 'fade in' animation, if required */
+      if (fade_enabled)
+         gfx_thumbnail_init_fade(p_gfx_thumb,
+               thumbnail_tag->thumbnail);
+
+      if (thumbnail_tag->path)
+         free(thumbnail_tag->path);
+      free(thumbnail_tag);
+   }
+}
+
+/* Used to process thumbnail data following completion
+ * of a prefetch image load task */
+static void gfx_thumbnail_handle_prefetch(
+      retro_task_t *task, void *task_data, void *user_data, const char *err)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+   struct texture_image *img          = (struct texture_image*)task_data;
+   gfx_thumbnail_tag_t *thumbnail_tag = (gfx_thumbnail_tag_t*)user_data;
+   gfx_thumbnail_cache_entry_t *entry = NULL;
+
+   if (!thumbnail_tag)
       goto end;
 
-   /* Upload texture to GPU */
-   if (!video_driver_texture_load(
-            img, TEXTURE_FILTER_MIPMAP_LINEAR,
-            &thumbnail_tag->thumbnail->texture))
+   /* Entry may have been filled by a regular load, or
+    * dropped (and possibly requested again) since */
+   entry = gfx_thumbnail_cache_find(p_gfx_thumb,
+         thumbnail_tag->path, thumbnail_tag->upscale_threshold);
+
+   if (     !entry
+         ||  entry->texture
+         || (entry->prefetch_id != thumbnail_tag->prefetch_id))
       goto end;
 
-   /* Cache dimensions */
-   thumbnail_tag->thumbnail->width  = img->width;
-   thumbnail_tag->thumbnail->height = img->height;
+   if (img && (img->width > 0) && (img->height > 0))
+   {
+      size_t size       = gfx_thumbnail_cache_texture_size(
+            img->width, img->height);
+      uintptr_t texture = 0;
+
+      /* Not worth the memory when it is short */
+      if (     (size <= p_gfx_thumb->cache_budget)
+            && !video_driver_gpu_mem_over_budget()
+            && video_driver_texture_load(
+               img, TEXTURE_FILTER_MIPMAP_LINEAR, &texture))
+      {
+         video_driver_texture_set_gpu_mem_type(texture,
+               VIDEO_GPU_MEM_THUMBNAILS);
+         gfx_thumbnail_cache_fill(p_gfx_thumb, entry,
+               texture, img->width, img->height, size);
+         gfx_thumbnail_cache_evict(p_gfx_thumb);
+         goto end;
+      }
+   }
 
-   /* Update thumbnail status */
-   thumbnail_tag->thumbnail->status = GFX_THUMBNAIL_STATUS_AVAILABLE;
+   gfx_thumbnail_cache_free_entry(p_gfx_thumb, entry);
 
 end:
-   /* Clean up */
    if (img)
    {
       image_texture_free(img);
@@ -200,17 +748,24 @@ end:
 
    if (thumbnail_tag)
    {
-      /* Trigger 'fade in' animation, if required */
-      if (fade_enabled)
-         gfx_thumbnail_init_fade(p_gfx_thumb,
-               thumbnail_tag->thumbnail);
-
+      free(thumbnail_tag->path);
       free(thumbnail_tag);
    }
 }
 
 /* Core interface */
 
+/* Cancels all pending thumbnail prefetches
+ * > Unlike gfx_thumbnail_cancel_pending_requests(),
+ *   on-screen thumbnail loads are unaffected */
+void gfx_thumbnail_cancel_prefetch(void)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+
+   p_gfx_thumb->prefetch_id++;
+   gfx_thumbnail_cache_drop_pending(p_gfx_thumb);
+}
+
 /* When called, prevents the handling of any pending
  * thumbnail load requests
  * >> **MUST** be called before deleting any gfx_thumbnail_t
@@ -266,7 +821,23 @@ void gfx_thumbnail_request(
    /* Load thumbnail, if required */
    if (has_thumbnail)
    {
-      if (path_is_valid(thumbnail_path))
+      gfx_thumbnail_cache_entry_t *entry = gfx_thumbnail_cache_find(
+            p_gfx_thumb, thumbnail_path, gfx_thumbnail_upscale_threshold);
+
+      /* Texture is already on the GPU
+       * > If it is still being prefetched, load the
+       *   image normally rather than waiting on a
+       *   low priority task */
+      if (entry && entry->texture)
+      {
+         thumbnail->texture = entry->texture;
+         thumbnail->width   = entry->width;
+         thumbnail->height  = entry->height;
+         thumbnail->status  = GFX_THUMBNAIL_STATUS_AVAILABLE;
+         entry->refs++;
+         gfx_thumbnail_cache_touch(p_gfx_thumb, entry);
+      }
+      else if (gfx_thumbnail_image_exists(p_gfx_thumb, thumbnail_path))
       {
          gfx_thumbnail_tag_t *thumbnail_tag =
                (gfx_thumbnail_tag_t*)malloc(sizeof(gfx_thumbnail_tag_t));
@@ -275,16 +846,26 @@ void gfx_thumbnail_request(
             goto end;
 
          /* Configure user data */
-         thumbnail_tag->thumbnail = thumbnail;
-         thumbnail_tag->list_id   = p_gfx_thumb->list_id;
+         thumbnail_tag->thumbnail         = thumbnail;
+         thumbnail_tag->list_id           = p_gfx_thumb->list_id;
+         thumbnail_tag->path              = p_gfx_thumb->cache_budget
+               ? strdup(thumbnail_path) : NULL;
+         thumbnail_tag->upscale_threshold = gfx_thumbnail_upscale_threshold;
+         thumbnail_tag->prefetch_id       = 0;
 
          /* Would like to cancel any existing image load tasks
           * here, but can't see how to do it... */
-         if (task_push_image_load(
-               thumbnail_path, video_driver_supports_rgba(),
-               gfx_thumbnail_upscale_threshold,
+         if (gfx_thumbnail_push_image_load(p_gfx_thumb,
+               thumbnail_path, gfx_thumbnail_upscale_threshold,
+               TASK_PRIORITY_NORMAL,
                gfx_thumbnail_handle_upload, thumbnail_tag))
             thumbnail->status = GFX_THUMBNAIL_STATUS_PENDING;
+         else
+         {
+            if (thumbnail_tag->path)
+               free(thumbnail_tag->path);
+            free(thumbnail_tag);
+         }
       }
 #ifdef HAVE_NETWORKING
       /* Handle on demand thumbnail downloads */
@@ -374,9 +955,14 @@ void gfx_thumbnail_request_file(
    if (!thumbnail_tag)
       return;
 
-   /* Configure user data */
-   thumbnail_tag->thumbnail = thumbnail;
-   thumbnail_tag->list_id   = p_gfx_thumb->list_id;
+   /* Configure user data
+    * > Not cached, since files such as savestate
+    *   images may be overwritten at any time */
+   thumbnail_tag->thumbnail         = thumbnail;
+   thumbnail_tag->list_id           = p_gfx_thumb->list_id;
+   thumbnail_tag->path              = NULL;
+   thumbnail_tag->upscale_threshold = gfx_thumbnail_upscale_threshold;
+   thumbnail_tag->prefetch_id       = 0;
 
    /* Would like to cancel any existing image load tasks
     * here, but can't see how to do it... */
@@ -387,6 +973,127 @@ void gfx_thumbnail_request_file(
       thumbnail->status = GFX_THUMBNAIL_STATUS_PENDING;
 }
 
+/* Same as gfx_thumbnail_request_file(), for the
+ * thumbnail of the save state file 'state_path' */
+void gfx_thumbnail_request_savestate(
+      const char *state_path, gfx_thumbnail_t *thumbnail,
+      unsigned gfx_thumbnail_upscale_threshold)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+   gfx_thumbnail_tag_t *thumbnail_tag = NULL;
+
+   if (!thumbnail)
+      return;
+
+   gfx_thumbnail_reset(thumbnail);
+   thumbnail->status = GFX_THUMBNAIL_STATUS_MISSING;
+
+   if (string_is_empty(state_path))
+      return;
+
+   if (!path_is_valid(state_path))
+      return;
+
+   thumbnail_tag = (gfx_thumbnail_tag_t*)malloc(sizeof(gfx_thumbnail_tag_t));
+
+   if (!thumbnail_tag)
+      return;
+
+   /* Not cached - states are overwritten at any time */
+   thumbnail_tag->thumbnail         = thumbnail;
+   thumbnail_tag->list_id           = p_gfx_thumb->list_id;
+   thumbnail_tag->path              = NULL;
+   thumbnail_tag->upscale_threshold = gfx_thumbnail_upscale_threshold;
+   thumbnail_tag->prefetch_id       = 0;
+
+   if (task_push_image_load_savestate(
+         state_path, video_driver_supports_rgba(),
+         gfx_thumbnail_upscale_threshold,
+         gfx_thumbnail_handle_upload, thumbnail_tag))
+      thumbnail->status = GFX_THUMBNAIL_STATUS_PENDING;
+   else
+      free(thumbnail_tag);
+}
+
+/* Loads the specified thumbnail into the texture
+ * cache at low priority, ahead of the entry being
+ * displayed. Does nothing if the cache is disabled,
+ * or if the image is cached or already prefetching
+ * > Returns false if too many prefetches are already
+ *   pending, in which case the call should be retried
+ * NOTE: Calls gfx_thumbnail_set_content_playlist() */
+bool gfx_thumbnail_prefetch(
+      gfx_thumbnail_path_data_t *path_data, enum gfx_thumbnail_id thumbnail_id,
+      playlist_t *playlist, size_t idx,
+      unsigned gfx_thumbnail_upscale_threshold)
+{
+   const char *thumbnail_path         = NULL;
+   gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+   gfx_thumbnail_cache_entry_t *entry = NULL;
+   gfx_thumbnail_tag_t *thumbnail_tag = NULL;
+
+   if (!path_data || !playlist || !p_gfx_thumb->cache_budget)
+      return true;
+
+   if (p_gfx_thumb->prefetch_pending >= GFX_THUMBNAIL_PREFETCH_MAX_PENDING)
+      return false;
+
+   if (!gfx_thumbnail_set_content_playlist(path_data, playlist, idx))
+      return true;
+
+   if (     !gfx_thumbnail_is_enabled(path_data, thumbnail_id)
+         || !gfx_thumbnail_update_path(path_data, thumbnail_id)
+         || !gfx_thumbnail_get_path(path_data, thumbnail_id, &thumbnail_path))
+      return true;
+
+   if ((entry = gfx_thumbnail_cache_find(p_gfx_thumb,
+               thumbnail_path, gfx_thumbnail_upscale_threshold)))
+   {
+      /* Keep it from being evicted before
+       * the entry comes into view */
+      gfx_thumbnail_cache_touch(p_gfx_thumb, entry);
+      return true;
+   }
+
+   if (!gfx_thumbnail_image_exists(p_gfx_thumb, thumbnail_path))
+      return true;
+
+   thumbnail_tag = (gfx_thumbnail_tag_t*)malloc(sizeof(gfx_thumbnail_tag_t));
+
+   if (!thumbnail_tag)
+      return true;
+
+   thumbnail_tag->thumbnail         = NULL;
+   thumbnail_tag->list_id           = p_gfx_thumb->list_id;
+   thumbnail_tag->path              = strdup(thumbnail_path);
+   thumbnail_tag->upscale_threshold = gfx_thumbnail_upscale_threshold;
+   thumbnail_tag->prefetch_id       = p_gfx_thumb->prefetch_id;
+
+   if (     !thumbnail_tag->path
+         || !(entry = gfx_thumbnail_cache_new_entry(p_gfx_thumb,
+               thumbnail_path, gfx_thumbnail_upscale_threshold)))
+   {
+      free(thumbnail_tag->path);
+      free(thumbnail_tag);
+      return true;
+   }
+
+   /* Pending entry holds a slot until the load completes */
+   p_gfx_thumb->prefetch_pending++;
+
+   if (!gfx_thumbnail_push_image_load(p_gfx_thumb,
+         thumbnail_path, gfx_thumbnail_upscale_threshold,
+         TASK_PRIORITY_LOW,
+         gfx_thumbnail_handle_prefetch, thumbnail_tag))
+   {
+      gfx_thumbnail_cache_free_entry(p_gfx_thumb, entry);
+      free(thumbnail_tag->path);
+      free(thumbnail_tag);
+   }
+
+   return true;
+}
+
 /* Resets (and free()s the current texture of) the
  * specified thumbnail */
 void gfx_thumbnail_reset(gfx_thumbnail_t *thumbnail)
@@ -394,9 +1101,22 @@ void gfx_thumbnail_reset(gfx_thumbnail_t *thumbnail)
    if (!thumbnail)
       return;
 
-   /* Unload texture */
+   /* Unload texture, unless it belongs to the cache */
    if (thumbnail->texture)
-      video_driver_texture_unload(&thumbnail->texture);
+   {
+      gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+      gfx_thumbnail_cache_entry_t *entry =
+            gfx_thumbnail_cache_find_texture(p_gfx_thumb, thumbnail->texture);
+
+      if (entry)
+      {
+         if (entry->refs > 0)
+            entry->refs--;
+         gfx_thumbnail_cache_evict(p_gfx_thumb);
+      }
+      else
+         video_driver_texture_unload(&thumbnail->texture);
+   }
 
    /* Ensure any 'fade in' animation is killed */
    if (thumbnail->fade_active)
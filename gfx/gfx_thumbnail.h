@@ -30,6 +30,7 @@
 
 #include "gfx_animation.h"
 #include "gfx_thumbnail_path.h"
+#include "gfx_thumbnail_pack.h"
 
 RETRO_BEGIN_DECLS
 
@@ -93,10 +94,46 @@ typedef struct
    enum gfx_thumbnail_shadow_type type;
 } gfx_thumbnail_shadow_t;
 
+typedef struct gfx_thumbnail_cache_entry gfx_thumbnail_cache_entry_t;
+
+/* Number of thumbnail pack indexes kept open
+ * (enough for the right, left and any extra
+ * thumbnail type of one playlist) */
+#define GFX_THUMBNAIL_PACK_SLOTS 4
+
 /* Structure containing all gfx_thumbnail
  * variables */
 struct gfx_thumbnail_state
 {
+   /* Uploaded thumbnail textures, most recently
+    * used first. Entries no longer referenced by
+    * any gfx_thumbnail_t are kept until the total
+    * size exceeds 'cache_budget' */
+   gfx_thumbnail_cache_entry_t *cache_head;
+   gfx_thumbnail_cache_entry_t *cache_tail;
+
+   /* Estimated GPU memory in bytes used by, and
+    * allowed for, cached textures */
+   size_t cache_size;
+   size_t cache_budget;
+
+   /* Number of prefetch loads in flight, and
+    * a counter incremented whenever they are
+    * cancelled */
+   unsigned prefetch_pending;
+   unsigned prefetch_id;
+
+   /* Recently used thumbnail packs, keyed by pack
+    * file path. A NULL 'pack' records that no valid
+    * pack exists at 'path', so that it is not
+    * checked again for every thumbnail */
+   struct
+   {
+      char *path;
+      gfx_thumbnail_pack_t *pack;
+   } packs[GFX_THUMBNAIL_PACK_SLOTS];
+   unsigned pack_next;
+
    /* Due to the asynchronous nature of thumbnail
     * loading, it is quite possible to trigger a load
     * then navigate to a different menu list before
@@ -121,6 +158,10 @@ struct gfx_thumbnail_state
    /* When true, 'fade in' animation will also be
     * triggered for missing thumbnails */
    bool fade_missing;
+
+   /* When true, thumbnails are read from packs
+    * (when available) instead of image files */
+   bool pack_enable;
 };
 
 typedef struct gfx_thumbnail_state gfx_thumbnail_state_t;
@@ -145,8 +186,38 @@ void gfx_thumbnail_set_fade_duration(float duration);
  *   any 'thumbnail unavailable' notifications */
 void gfx_thumbnail_set_fade_missing(bool fade_missing);
 
+/* Sets the amount of GPU memory in bytes that
+ * cached thumbnail textures may use
+ * > If 'size' is zero, thumbnails are not cached */
+void gfx_thumbnail_set_cache_size(size_t size);
+
+/* Specifies whether thumbnails should be loaded
+ * from thumbnail packs when available */
+void gfx_thumbnail_set_pack_enable(bool enable);
+
 /* Core interface */
 
+/* Unloads all cached thumbnail textures
+ * >> **MUST** only be called once every gfx_thumbnail_t
+ *    has been reset, i.e. after the menu driver's
+ *    context_destroy() */
+void gfx_thumbnail_cache_flush(void);
+
+/* Unloads cached thumbnail textures that are not
+ * on screen, least recently used first, until
+ * @size bytes have been freed (or none are left) */
+void gfx_thumbnail_cache_trim(size_t size);
+
+/* Closes all open thumbnail packs, so that they
+ * are re-read on next use
+ * > Must be called whenever a pack is (re)generated */
+void gfx_thumbnail_pack_reload(void);
+
+/* Cancels all pending thumbnail prefetches
+ * > Unlike gfx_thumbnail_cancel_pending_requests(),
+ *   on-screen thumbnail loads are unaffected */
+void gfx_thumbnail_cancel_prefetch(void);
+
 /* When called, prevents the handling of any pending
  * thumbnail load requests
  * >> **MUST** be called before deleting any gfx_thumbnail_t
@@ -186,6 +257,26 @@ void gfx_thumbnail_request_file(
       const char *file_path, gfx_thumbnail_t *thumbnail,
       unsigned gfx_thumbnail_upscale_threshold);
 
+/* Same as gfx_thumbnail_request_file(), for the
+ * thumbnail of the save state file 'state_path'
+ * > Uses the thumbnail embedded in the state when
+ *   available, so no image has to be decoded */
+void gfx_thumbnail_request_savestate(
+      const char *state_path, gfx_thumbnail_t *thumbnail,
+      unsigned gfx_thumbnail_upscale_threshold);
+
+/* Loads the specified thumbnail into the texture
+ * cache at low priority, ahead of the entry being
+ * displayed. Does nothing if the cache is disabled,
+ * or if the image is cached or already prefetching
+ * > Returns false if too many prefetches are already
+ *   pending, in which case the call should be retried
+ * NOTE: Calls gfx_thumbnail_set_content_playlist() */
+bool gfx_thumbnail_prefetch(
+      gfx_thumbnail_path_data_t *path_data, enum gfx_thumbnail_id thumbnail_id,
+      playlist_t *playlist, size_t idx,
+      unsigned gfx_thumbnail_upscale_threshold);
+
 /* Resets (and free()s the current texture of) the
  * specified thumbnail */
 void gfx_thumbnail_reset(gfx_thumbnail_t *thumbnail);
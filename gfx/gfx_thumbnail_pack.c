@@ -0,0 +1,744 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (gfx_thumbnail_pack.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_miscellaneous.h>
+#include <compat/strl.h>
+#include <file/file_path.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+#include <gfx/scaler/scaler.h>
+#include <features/features_cpu.h>
+
+#include "gfx_thumbnail_pack.h"
+
+#define GFX_THUMBNAIL_PACK_MAGIC       "RTPK"
+#define GFX_THUMBNAIL_PACK_VERSION     1
+#define GFX_THUMBNAIL_PACK_HEADER_SIZE 32
+#define GFX_THUMBNAIL_PACK_RECORD_SIZE 32
+
+/* Sanity limits, applied when loading an index */
+#define GFX_THUMBNAIL_PACK_MAX_ENTRIES    (1 << 20)
+#define GFX_THUMBNAIL_PACK_MAX_NAMES_SIZE (64 * 1024 * 1024)
+
+struct gfx_thumbnail_pack
+{
+   gfx_thumbnail_pack_entry_t *entries; /* Sorted by hash */
+   char *names;
+   size_t count;
+   size_t names_size;
+};
+
+struct gfx_thumbnail_pack_writer
+{
+   RFILE *file;
+   char *path;
+   char *tmp_path;
+   gfx_thumbnail_pack_entry_t *entries;
+   char *names;
+   size_t count;
+   size_t capacity;
+   size_t names_size;
+   size_t names_capacity;
+   uint64_t offset;
+};
+
+/* Utility functions */
+
+static void gfx_thumbnail_pack_put16(uint8_t *s, uint16_t val)
+{
+   s[0] = (uint8_t)(val);
+   s[1] = (uint8_t)(val >> 8);
+}
+
+static void gfx_thumbnail_pack_put32(uint8_t *s, uint32_t val)
+{
+   s[0] = (uint8_t)(val);
+   s[1] = (uint8_t)(val >> 8);
+   s[2] = (uint8_t)(val >> 16);
+   s[3] = (uint8_t)(val >> 24);
+}
+
+static void gfx_thumbnail_pack_put64(uint8_t *s, uint64_t val)
+{
+   gfx_thumbnail_pack_put32(s,     (uint32_t)val);
+   gfx_thumbnail_pack_put32(s + 4, (uint32_t)(val >> 32));
+}
+
+static uint16_t gfx_thumbnail_pack_get16(const uint8_t *s)
+{
+   return (uint16_t)(s[0] | (s[1] << 8));
+}
+
+static uint32_t gfx_thumbnail_pack_get32(const uint8_t *s)
+{
+   return  (uint32_t)s[0]
+         | ((uint32_t)s[1] << 8)
+         | ((uint32_t)s[2] << 16)
+         | ((uint32_t)s[3] << 24);
+}
+
+static uint64_t gfx_thumbnail_pack_get64(const uint8_t *s)
+{
+   return  (uint64_t)gfx_thumbnail_pack_get32(s)
+         | ((uint64_t)gfx_thumbnail_pack_get32(s + 4) << 32);
+}
+
+/* djb2 */
+static uint32_t gfx_thumbnail_pack_hash(const char *name)
+{
+   uint32_t hash = 5381;
+   unsigned char c;
+
+   while ((c = (unsigned char)*name++))
+      hash = ((hash << 5) + hash) + c;
+
+   return hash;
+}
+
+static size_t gfx_thumbnail_pack_pixel_size(uint8_t format)
+{
+   return (format == GFX_THUMBNAIL_PACK_FORMAT_RGB565) ? 2 : 4;
+}
+
+static int gfx_thumbnail_pack_entry_cmp(const void *a, const void *b)
+{
+   uint32_t hash_a = ((const gfx_thumbnail_pack_entry_t*)a)->hash;
+   uint32_t hash_b = ((const gfx_thumbnail_pack_entry_t*)b)->hash;
+
+   if (hash_a < hash_b)
+      return -1;
+   if (hash_a > hash_b)
+      return 1;
+   return 0;
+}
+
+bool gfx_thumbnail_pack_get_path(const char *image_path,
+      char *s, size_t len)
+{
+   size_t _len;
+
+   if (string_is_empty(image_path))
+      return false;
+
+   strlcpy(s, image_path, len);
+   path_basedir(s);
+
+   /* Strip trailing slash */
+   _len = strlen(s);
+   if (_len < 2)
+      return false;
+   if ((s[_len - 1] == '/') || (s[_len - 1] == '\\'))
+      s[_len - 1] = '\0';
+
+   strlcat(s, GFX_THUMBNAIL_PACK_EXTENSION, len);
+   return true;
+}
+
+/* Reader */
+
+gfx_thumbnail_pack_t *gfx_thumbnail_pack_open(const char *path)
+{
+   uint8_t header[GFX_THUMBNAIL_PACK_HEADER_SIZE];
+   size_t i;
+   size_t count;
+   size_t names_size;
+   size_t index_size;
+   uint64_t index_offset;
+   uint8_t *index               = NULL;
+   gfx_thumbnail_pack_t *pack   = NULL;
+   RFILE *file                  = NULL;
+
+   if (string_is_empty(path))
+      return NULL;
+
+   if (!(file = filestream_open(path,
+               RETRO_VFS_FILE_ACCESS_READ,
+               RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return NULL;
+
+   if (filestream_read(file, header, sizeof(header)) != sizeof(header))
+      goto error;
+
+   if (     memcmp(header, GFX_THUMBNAIL_PACK_MAGIC, 4)
+         || (gfx_thumbnail_pack_get32(header + 4) != GFX_THUMBNAIL_PACK_VERSION))
+      goto error;
+
+   count        = gfx_thumbnail_pack_get32(header + 8);
+   names_size   = gfx_thumbnail_pack_get32(header + 12);
+   index_offset = gfx_thumbnail_pack_get64(header + 16);
+
+   if (     (count < 1)
+         || (count > GFX_THUMBNAIL_PACK_MAX_ENTRIES)
+         || (names_size < 1)
+         || (names_size > GFX_THUMBNAIL_PACK_MAX_NAMES_SIZE))
+      goto error;
+
+   if (!(pack = (gfx_thumbnail_pack_t*)calloc(1, sizeof(*pack))))
+      goto error;
+
+   index_size        = count * GFX_THUMBNAIL_PACK_RECORD_SIZE;
+   index             = (uint8_t*)malloc(index_size);
+   pack->entries     = (gfx_thumbnail_pack_entry_t*)malloc(
+         count * sizeof(gfx_thumbnail_pack_entry_t));
+   pack->names       = (char*)malloc(names_size);
+   pack->count       = count;
+   pack->names_size  = names_size;
+
+   if (!index || !pack->entries || !pack->names)
+      goto error;
+
+   if (filestream_seek(file, (int64_t)index_offset,
+            RETRO_VFS_SEEK_POSITION_START) != 0)
+      goto error;
+
+   if (     (filestream_read(file, index, index_size) != (int64_t)index_size)
+         || (filestream_read(file, pack->names, names_size) != (int64_t)names_size))
+      goto error;
+
+   /* Names must be terminated, so that a corrupt
+    * index can never be read past its end */
+   if (pack->names[names_size - 1] != '\0')
+      goto error;
+
+   for (i = 0; i < count; i++)
+   {
+      const uint8_t *record             = index + i * GFX_THUMBNAIL_PACK_RECORD_SIZE;
+      gfx_thumbnail_pack_entry_t *entry = &pack->entries[i];
+
+      entry->offset      = gfx_thumbnail_pack_get64(record);
+      entry->hash        = gfx_thumbnail_pack_get32(record + 8);
+      entry->name_offset = gfx_thumbnail_pack_get32(record + 12);
+      entry->width       = gfx_thumbnail_pack_get16(record + 16);
+      entry->height      = gfx_thumbnail_pack_get16(record + 18);
+      entry->format      = record[20];
+
+      if (     (entry->name_offset >= names_size)
+            || (entry->width  < 1)
+            || (entry->height < 1)
+            || (entry->format > GFX_THUMBNAIL_PACK_FORMAT_RGB565))
+         goto error;
+   }
+
+   free(index);
+   filestream_close(file);
+   return pack;
+
+error:
+   if (index)
+      free(index);
+   gfx_thumbnail_pack_free(pack);
+   filestream_close(file);
+   return NULL;
+}
+
+void gfx_thumbnail_pack_free(gfx_thumbnail_pack_t *pack)
+{
+   if (!pack)
+      return;
+
+   if (pack->entries)
+      free(pack->entries);
+   if (pack->names)
+      free(pack->names);
+   free(pack);
+}
+
+const gfx_thumbnail_pack_entry_t *gfx_thumbnail_pack_find(
+      const gfx_thumbnail_pack_t *pack, const char *name)
+{
+   uint32_t hash;
+   size_t lo, hi;
+
+   if (!pack || string_is_empty(name))
+      return NULL;
+
+   hash = gfx_thumbnail_pack_hash(name);
+   lo   = 0;
+   hi   = pack->count;
+
+   /* Find first entry with a matching hash */
+   while (lo < hi)
+   {
+      size_t mid = lo + (hi - lo) / 2;
+
+      if (pack->entries[mid].hash < hash)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+
+   for (; (lo < pack->count) && (pack->entries[lo].hash == hash); lo++)
+      if (string_is_equal(pack->names + pack->entries[lo].name_offset, name))
+         return &pack->entries[lo];
+
+   return NULL;
+}
+
+bool gfx_thumbnail_pack_read(const char *path,
+      const gfx_thumbnail_pack_entry_t *entry,
+      struct texture_image *out_img)
+{
+   size_t i;
+   size_t num_pixels;
+   size_t size;
+   uint8_t *data  = NULL;
+   uint32_t *dst  = NULL;
+   RFILE *file    = NULL;
+
+   if (!entry || !out_img)
+      return false;
+
+   num_pixels     = (size_t)entry->width * entry->height;
+   size           = num_pixels * gfx_thumbnail_pack_pixel_size(entry->format);
+
+   if (!(file = filestream_open(path,
+               RETRO_VFS_FILE_ACCESS_READ,
+               RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return false;
+
+   data           = (uint8_t*)malloc(size);
+   dst            = (uint32_t*)malloc(num_pixels * sizeof(uint32_t));
+
+   if (!data || !dst)
+      goto error;
+
+   if (filestream_seek(file, (int64_t)entry->offset,
+            RETRO_VFS_SEEK_POSITION_START) != 0)
+      goto error;
+
+   if (filestream_read(file, data, size) != (int64_t)size)
+      goto error;
+
+   filestream_close(file);
+   file = NULL;
+
+   if (entry->format == GFX_THUMBNAIL_PACK_FORMAT_RGB565)
+   {
+      for (i = 0; i < num_pixels; i++)
+      {
+         uint32_t col = gfx_thumbnail_pack_get16(data + i * 2);
+         uint32_t r   = (col >> 11) & 0x1F;
+         uint32_t g   = (col >>  5) & 0x3F;
+         uint32_t b   = (col      ) & 0x1F;
+
+         r            = (r << 3) | (r >> 2);
+         g            = (g << 2) | (g >> 4);
+         b            = (b << 3) | (b >> 2);
+
+         dst[i]       = 0xFF000000 | (r << 16) | (g << 8) | b;
+      }
+   }
+   else
+   {
+      for (i = 0; i < num_pixels; i++)
+         dst[i] = gfx_thumbnail_pack_get32(data + i * 4);
+   }
+
+   free(data);
+
+   out_img->pixels        = dst;
+   out_img->width         = entry->width;
+   out_img->height        = entry->height;
+   out_img->supports_rgba = false;
+   return true;
+
+error:
+   if (data)
+      free(data);
+   if (dst)
+      free(dst);
+   if (file)
+      filestream_close(file);
+   return false;
+}
+
+/* Writer */
+
+gfx_thumbnail_pack_writer_t *gfx_thumbnail_pack_writer_init(
+      const char *path)
+{
+   uint8_t header[GFX_THUMBNAIL_PACK_HEADER_SIZE];
+   char tmp_path[PATH_MAX_LENGTH];
+   gfx_thumbnail_pack_writer_t *writer = NULL;
+
+   if (string_is_empty(path))
+      return NULL;
+
+   if (!(writer = (gfx_thumbnail_pack_writer_t*)
+            calloc(1, sizeof(*writer))))
+      return NULL;
+
+   strlcpy(tmp_path, path, sizeof(tmp_path));
+   strlcat(tmp_path, ".tmp", sizeof(tmp_path));
+
+   writer->path     = strdup(path);
+   writer->tmp_path = strdup(tmp_path);
+
+   if (!writer->path || !writer->tmp_path)
+      goto error;
+
+   if (!(writer->file = filestream_open(tmp_path,
+               RETRO_VFS_FILE_ACCESS_WRITE,
+               RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      goto error;
+
+   /* Header is filled in once the index is written */
+   memset(header, 0, sizeof(header));
+   if (filestream_write(writer->file, header, sizeof(header))
+         != sizeof(header))
+      goto error;
+
+   writer->offset = sizeof(header);
+   return writer;
+
+error:
+   gfx_thumbnail_pack_writer_free(writer);
+   return NULL;
+}
+
+static bool gfx_thumbnail_pack_writer_pad(
+      gfx_thumbnail_pack_writer_t *writer, uint64_t alignment)
+{
+   static const uint8_t zero[GFX_THUMBNAIL_PACK_ALIGN] = {0};
+   size_t pad = (size_t)((alignment - (writer->offset % alignment))
+         % alignment);
+
+   if (pad == 0)
+      return true;
+
+   if (filestream_write(writer->file, zero, pad) != (int64_t)pad)
+      return false;
+
+   writer->offset += pad;
+   return true;
+}
+
+/* Downscales 'img' in place so that it fits within
+ * GFX_THUMBNAIL_PACK_MAX_SIZE, preserving aspect ratio */
+static bool gfx_thumbnail_pack_downscale(struct texture_image *img)
+{
+   struct scaler_ctx scaler;
+   unsigned max_dim = (img->width > img->height)
+         ? img->width : img->height;
+   unsigned width   = img->width;
+   unsigned height  = img->height;
+   uint32_t *pixels = NULL;
+   bool success     = false;
+
+   if (max_dim <= GFX_THUMBNAIL_PACK_MAX_SIZE)
+      return true;
+
+   width  = (unsigned)(((uint64_t)img->width  * GFX_THUMBNAIL_PACK_MAX_SIZE) / max_dim);
+   height = (unsigned)(((uint64_t)img->height * GFX_THUMBNAIL_PACK_MAX_SIZE) / max_dim);
+   width  = (width  > 0) ? width  : 1;
+   height = (height > 0) ? height : 1;
+
+   if (!(pixels = (uint32_t*)malloc(width * height * sizeof(uint32_t))))
+      return false;
+
+   memset(&scaler, 0, sizeof(scaler));
+   scaler.in_width    = img->width;
+   scaler.in_height   = img->height;
+   scaler.in_stride   = img->width * sizeof(uint32_t);
+   scaler.in_fmt      = SCALER_FMT_ARGB8888;
+   scaler.out_width   = width;
+   scaler.out_height  = height;
+   scaler.out_stride  = width * sizeof(uint32_t);
+   scaler.out_fmt     = SCALER_FMT_ARGB8888;
+   scaler.scaler_type = SCALER_TYPE_BILINEAR;
+   scaler.threads     = cpu_features_get_core_amount();
+
+   if (scaler_ctx_gen_filter(&scaler))
+   {
+      scaler_ctx_scale(&scaler, pixels, img->pixels);
+      success = true;
+   }
+   scaler_ctx_gen_reset(&scaler);
+
+   if (!success)
+   {
+      free(pixels);
+      return false;
+   }
+
+   free(img->pixels);
+   img->pixels = pixels;
+   img->width  = width;
+   img->height = height;
+   return true;
+}
+
+bool gfx_thumbnail_pack_writer_add(
+      gfx_thumbnail_pack_writer_t *writer, const char *image_path)
+{
+   struct texture_image img;
+   size_t i;
+   size_t name_len;
+   size_t num_pixels;
+   size_t size;
+   uint32_t hash;
+   gfx_thumbnail_pack_entry_t *entry = NULL;
+   uint8_t *data                     = NULL;
+   const char *name                  = NULL;
+   uint8_t format                    = GFX_THUMBNAIL_PACK_FORMAT_RGB565;
+   bool success                      = false;
+
+   if (!writer || string_is_empty(image_path))
+      return false;
+
+   name = path_basename_nocompression(image_path);
+
+   if (string_is_empty(name))
+      return false;
+
+   /* Playlists may reference the same image
+    * more than once */
+   hash = gfx_thumbnail_pack_hash(name);
+   for (i = 0; i < writer->count; i++)
+      if (     (writer->entries[i].hash == hash)
+            && string_is_equal(
+               writer->names + writer->entries[i].name_offset, name))
+         return true;
+
+   img.pixels        = NULL;
+   img.width         = 0;
+   img.height        = 0;
+   img.supports_rgba = false;
+
+   if (!image_texture_load(&img, image_path))
+      return false;
+
+   if (     (img.width < 1) || (img.height < 1)
+         || !gfx_thumbnail_pack_downscale(&img))
+      goto end;
+
+   num_pixels = (size_t)img.width * img.height;
+
+   /* Opaque images are stored at half size */
+   for (i = 0; i < num_pixels; i++)
+   {
+      if ((img.pixels[i] >> 24) != 0xFF)
+      {
+         format = GFX_THUMBNAIL_PACK_FORMAT_ARGB8888;
+         break;
+      }
+   }
+
+   size = num_pixels * gfx_thumbnail_pack_pixel_size(format);
+
+   if (!(data = (uint8_t*)malloc(size)))
+      goto end;
+
+   if (format == GFX_THUMBNAIL_PACK_FORMAT_RGB565)
+   {
+      for (i = 0; i < num_pixels; i++)
+      {
+         uint32_t col = img.pixels[i];
+         gfx_thumbnail_pack_put16(data + i * 2, (uint16_t)(
+                 ((col >> 8) & 0xF800)
+               | ((col >> 5) & 0x07E0)
+               | ((col >> 3) & 0x001F)));
+      }
+   }
+   else
+   {
+      for (i = 0; i < num_pixels; i++)
+         gfx_thumbnail_pack_put32(data + i * 4, img.pixels[i]);
+   }
+
+   /* Grow index */
+   if (writer->count >= writer->capacity)
+   {
+      size_t capacity = writer->capacity ? writer->capacity * 2 : 256;
+      gfx_thumbnail_pack_entry_t *entries = (gfx_thumbnail_pack_entry_t*)
+            realloc(writer->entries, capacity * sizeof(*entries));
+
+      if (!entries)
+         goto end;
+
+      writer->entries  = entries;
+      writer->capacity = capacity;
+   }
+
+   name_len = strlen(name) + 1;
+
+   if (writer->names_size + name_len > writer->names_capacity)
+   {
+      size_t capacity = writer->names_capacity
+            ? writer->names_capacity * 2 : 8192;
+      char *names;
+
+      while (writer->names_size + name_len > capacity)
+         capacity *= 2;
+
+      if (!(names = (char*)realloc(writer->names, capacity)))
+         goto end;
+
+      writer->names          = names;
+      writer->names_capacity = capacity;
+   }
+
+   /* Write pixel data */
+   if (!gfx_thumbnail_pack_writer_pad(writer, GFX_THUMBNAIL_PACK_ALIGN))
+      goto end;
+
+   if (filestream_write(writer->file, data, size) != (int64_t)size)
+      goto end;
+
+   entry              = &writer->entries[writer->count++];
+   entry->offset      = writer->offset;
+   entry->hash        = hash;
+   entry->name_offset = (uint32_t)writer->names_size;
+   entry->width       = (uint16_t)img.width;
+   entry->height      = (uint16_t)img.height;
+   entry->format      = format;
+
+   memcpy(writer->names + writer->names_size, name, name_len);
+   writer->names_size += name_len;
+   writer->offset     += size;
+   success             = true;
+
+end:
+   if (data)
+      free(data);
+   image_texture_free(&img);
+   return success;
+}
+
+bool gfx_thumbnail_pack_writer_finish(
+      gfx_thumbnail_pack_writer_t *writer)
+{
+   uint8_t header[GFX_THUMBNAIL_PACK_HEADER_SIZE];
+   size_t i;
+   uint64_t index_offset;
+   uint8_t *index = NULL;
+   bool success   = false;
+
+   if (!writer)
+      return false;
+
+   /* Nothing to pack - remove stale data */
+   if (writer->count < 1)
+   {
+      if (path_is_valid(writer->path))
+         filestream_delete(writer->path);
+      goto end;
+   }
+
+   qsort(writer->entries, writer->count,
+         sizeof(gfx_thumbnail_pack_entry_t),
+         gfx_thumbnail_pack_entry_cmp);
+
+   if (!(index = (uint8_t*)calloc(writer->count,
+               GFX_THUMBNAIL_PACK_RECORD_SIZE)))
+      goto end;
+
+   for (i = 0; i < writer->count; i++)
+   {
+      uint8_t *record                         = index + i * GFX_THUMBNAIL_PACK_RECORD_SIZE;
+      const gfx_thumbnail_pack_entry_t *entry = &writer->entries[i];
+
+      gfx_thumbnail_pack_put64(record,      entry->offset);
+      gfx_thumbnail_pack_put32(record + 8,  entry->hash);
+      gfx_thumbnail_pack_put32(record + 12, entry->name_offset);
+      gfx_thumbnail_pack_put16(record + 16, entry->width);
+      gfx_thumbnail_pack_put16(record + 18, entry->height);
+      record[20] = entry->format;
+   }
+
+   if (!gfx_thumbnail_pack_writer_pad(writer, 8))
+      goto end;
+
+   index_offset = writer->offset;
+
+   if (filestream_write(writer->file, index,
+            writer->count * GFX_THUMBNAIL_PACK_RECORD_SIZE)
+         != (int64_t)(writer->count * GFX_THUMBNAIL_PACK_RECORD_SIZE))
+      goto end;
+
+   if (filestream_write(writer->file, writer->names, writer->names_size)
+         != (int64_t)writer->names_size)
+      goto end;
+
+   memset(header, 0, sizeof(header));
+   memcpy(header, GFX_THUMBNAIL_PACK_MAGIC, 4);
+   gfx_thumbnail_pack_put32(header + 4,  GFX_THUMBNAIL_PACK_VERSION);
+   gfx_thumbnail_pack_put32(header + 8,  (uint32_t)writer->count);
+   gfx_thumbnail_pack_put32(header + 12, (uint32_t)writer->names_size);
+   gfx_thumbnail_pack_put64(header + 16, index_offset);
+
+   if (filestream_seek(writer->file, 0, RETRO_VFS_SEEK_POSITION_START) != 0)
+      goto end;
+
+   if (filestream_write(writer->file, header, sizeof(header))
+         != sizeof(header))
+      goto end;
+
+   if (filestream_close(writer->file) != 0)
+   {
+      writer->file = NULL;
+      goto end;
+   }
+   writer->file = NULL;
+
+   /* Rename does not replace existing files
+    * on every platform */
+   if (path_is_valid(writer->path))
+      filestream_delete(writer->path);
+
+   success = (filestream_rename(writer->tmp_path, writer->path) == 0);
+
+end:
+   if (index)
+      free(index);
+   gfx_thumbnail_pack_writer_free(writer);
+   return success;
+}
+
+void gfx_thumbnail_pack_writer_free(
+      gfx_thumbnail_pack_writer_t *writer)
+{
+   if (!writer)
+      return;
+
+   if (writer->file)
+      filestream_close(writer->file);
+
+   if (writer->tmp_path)
+   {
+      if (path_is_valid(writer->tmp_path))
+         filestream_delete(writer->tmp_path);
+      free(writer->tmp_path);
+   }
+
+   if (writer->path)
+      free(writer->path);
+   if (writer->entries)
+      free(writer->entries);
+   if (writer->names)
+      free(writer->names);
+
+   free(writer);
+}
@@ -0,0 +1,134 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (gfx_thumbnail_pack.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __GFX_THUMBNAIL_PACK_H
+#define __GFX_THUMBNAIL_PACK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <retro_common_api.h>
+#include <boolean.h>
+
+#include <formats/image.h>
+
+RETRO_BEGIN_DECLS
+
+/* A thumbnail pack holds every image of one thumbnail
+ * directory (e.g. thumbnails/<db>/Named_Boxarts) in a
+ * single file, pre-decoded and pre-scaled, so that
+ * loading a thumbnail costs one seek and one read
+ * instead of an open, a stat and a PNG decode.
+ *
+ * Layout (all values little endian):
+ * - 32 byte header: "RTPK", version, entry count,
+ *   name table size, index offset
+ * - pixel data, each image aligned to
+ *   GFX_THUMBNAIL_PACK_ALIGN bytes
+ * - index: 32 byte records sorted by name hash,
+ *   followed by the NUL-terminated names */
+
+#define GFX_THUMBNAIL_PACK_EXTENSION ".rtpk"
+
+/* Images are downscaled so that neither dimension
+ * exceeds this value */
+#define GFX_THUMBNAIL_PACK_MAX_SIZE 256
+
+#define GFX_THUMBNAIL_PACK_ALIGN 4096
+
+enum gfx_thumbnail_pack_format
+{
+   /* Used for images with transparency */
+   GFX_THUMBNAIL_PACK_FORMAT_ARGB8888 = 0,
+   /* Used for fully opaque images */
+   GFX_THUMBNAIL_PACK_FORMAT_RGB565
+};
+
+typedef struct gfx_thumbnail_pack_entry
+{
+   uint64_t offset;
+   uint32_t hash;
+   uint32_t name_offset;
+   uint16_t width;
+   uint16_t height;
+   uint8_t format;
+} gfx_thumbnail_pack_entry_t;
+
+/* Prevent direct access to pack members */
+typedef struct gfx_thumbnail_pack gfx_thumbnail_pack_t;
+typedef struct gfx_thumbnail_pack_writer gfx_thumbnail_pack_writer_t;
+
+/* Writes the path of the pack containing image file
+ * 'image_path' to 's' (i.e. the image's parent directory
+ * with GFX_THUMBNAIL_PACK_EXTENSION appended)
+ * Returns false if 'image_path' has no parent directory */
+bool gfx_thumbnail_pack_get_path(const char *image_path,
+      char *s, size_t len);
+
+/* Reader */
+
+/* Loads the index of the pack at 'path'
+ * Returns NULL if the file does not exist or
+ * is not a valid pack */
+gfx_thumbnail_pack_t *gfx_thumbnail_pack_open(const char *path);
+
+void gfx_thumbnail_pack_free(gfx_thumbnail_pack_t *pack);
+
+/* Returns the entry for image file name 'name'
+ * (without directory), or NULL if it is not packed */
+const gfx_thumbnail_pack_entry_t *gfx_thumbnail_pack_find(
+      const gfx_thumbnail_pack_t *pack, const char *name);
+
+/* Reads the pixels of 'entry' from the pack at 'path'
+ * into 'out_img' as ARGB8888
+ * > Opens its own file handle, so may be called
+ *   from any thread */
+bool gfx_thumbnail_pack_read(const char *path,
+      const gfx_thumbnail_pack_entry_t *entry,
+      struct texture_image *out_img);
+
+/* Writer */
+
+/* Starts writing a pack to 'path'
+ * > Data goes to a temporary file, which only
+ *   replaces 'path' on gfx_thumbnail_pack_writer_finish() */
+gfx_thumbnail_pack_writer_t *gfx_thumbnail_pack_writer_init(
+      const char *path);
+
+/* Decodes, scales and appends image file 'image_path'
+ * > Images whose name is already packed are skipped */
+bool gfx_thumbnail_pack_writer_add(
+      gfx_thumbnail_pack_writer_t *writer, const char *image_path);
+
+/* Writes the index and moves the pack into place.
+ * If no images were added, any existing pack is
+ * removed instead. Always frees 'writer' */
+bool gfx_thumbnail_pack_writer_finish(
+      gfx_thumbnail_pack_writer_t *writer);
+
+/* Discards an unfinished pack */
+void gfx_thumbnail_pack_writer_free(
+      gfx_thumbnail_pack_writer_t *writer);
+
+RETRO_END_DECLS
+
+#endif
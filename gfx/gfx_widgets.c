@@ -1598,6 +1598,40 @@ static void INLINE gfx_widgets_font_unbind(gfx_widget_font_data_t *font_data)
    font_driver_bind_block(font_data->font, NULL);
 }
 
+/* Whether the frame has anything to draw at all */
+static bool gfx_widgets_frame_is_alive(
+      dispgfx_widget_t *p_dispwidget,
+      video_frame_info_t *video_info)
+{
+   size_t i;
+
+   if (     video_info->fps_show
+         || video_info->framecount_show
+         || video_info->memory_show
+         || video_info->core_status_msg_show
+         || video_info->widgets_is_paused
+         || video_info->widgets_is_fast_forwarding
+         || video_info->widgets_is_rewinding
+         || video_info->runloop_is_slowmotion
+         || p_dispwidget->current_msgs_size)
+      return true;
+
+#ifdef HAVE_TRANSLATE
+   if (p_dispwidget->ai_service_overlay_state > 0)
+      return true;
+#endif
+
+   for (i = 0; i < ARRAY_SIZE(widgets); i++)
+   {
+      const gfx_widget_t* widget = widgets[i];
+
+      if (widget->frame && (!widget->is_alive || widget->is_alive()))
+         return true;
+   }
+
+   return false;
+}
+
 void gfx_widgets_frame(void *data)
 {
    size_t i;
@@ -1625,6 +1659,11 @@ void gfx_widgets_frame(void *data)
    if (menu_screensaver_active)
       return;
 
+   /* Nothing on screen is the usual case during gameplay,
+    * skip the viewport changes and font binds and flushes */
+   if (!gfx_widgets_frame_is_alive(p_dispwidget, video_info))
+      return;
+
    video_driver_set_viewport(video_width, video_height, true, false);
 
    /* Font setup */
@@ -1835,7 +1874,7 @@ void gfx_widgets_frame(void *data)
    {
       const gfx_widget_t* widget = widgets[i];
 
-      if (widget->frame)
+      if (widget->frame && (!widget->is_alive || widget->is_alive()))
          widget->frame(data, p_dispwidget);
    }
 
@@ -2219,50 +2258,19 @@ void gfx_widgets_deinit(void *data, bool widgets_persisting)
 }
 
 #ifdef HAVE_TRANSLATE
-/* NOTE: Reads image from memory buffer */
-static bool gfx_widgets_reset_textures_list_buffer(
-        uintptr_t *item, enum texture_filter_type filter_type,
-        void* buffer, unsigned buffer_len, enum image_type_enum image_type,
-        unsigned *width, unsigned *height)
-{
-   struct texture_image ti;
-
-   ti.width                      = 0;
-   ti.height                     = 0;
-   ti.pixels                     = NULL;
-   ti.supports_rgba              = video_driver_supports_rgba();
-
-   if (!image_texture_load_buffer(&ti, image_type, buffer, buffer_len))
-      return false;
-
-   if (width)
-      *width = ti.width;
-
-   if (height)
-      *height = ti.height;
-
-   /* if the poke interface doesn't support texture load then return false */  
-   if (!video_driver_texture_load(&ti, filter_type, item))
-       return false;
-   image_texture_free(&ti);
-   return true;
-}
-
 bool gfx_widgets_ai_service_overlay_load(
       dispgfx_widget_t *p_dispwidget,
-      char* buffer, unsigned buffer_len,
-      enum image_type_enum image_type)
+      struct texture_image *image)
 {
    if (p_dispwidget->ai_service_overlay_state == 0)
    {
-      if (!gfx_widgets_reset_textures_list_buffer(
-               &p_dispwidget->ai_service_overlay_texture, 
-               TEXTURE_FILTER_MIPMAP_LINEAR, 
-               (void *) buffer, buffer_len, image_type,
-               &p_dispwidget->ai_service_overlay_width,
-               &p_dispwidget->ai_service_overlay_height))
+      /* if the poke interface doesn't support texture load then return false */
+      if (!video_driver_texture_load(image, TEXTURE_FILTER_MIPMAP_LINEAR,
+               &p_dispwidget->ai_service_overlay_texture))
          return false;
-      p_dispwidget->ai_service_overlay_state = 1;
+      p_dispwidget->ai_service_overlay_width  = image->width;
+      p_dispwidget->ai_service_overlay_height = image->height;
+      p_dispwidget->ai_service_overlay_state  = 1;
    }
    return true;
 }
@@ -272,6 +272,12 @@ struct gfx_widget
     * -- userdata is a dispgfx_widget_t
     * -> draw the widget here */
    void (*frame)(void* data, void *userdata);
+
+   /* called every frame before frame()
+    * (on the video thread if threaded video is on)
+    * -> return whether the widget has anything to draw,
+    *    a NULL is taken as always */
+   bool (*is_alive)(void);
 };
 
 float gfx_widgets_get_thumbnail_scale_factor(
@@ -343,10 +349,11 @@ void gfx_widget_screenshot_taken(void *data,
 
 /* AI Service functions */
 #ifdef HAVE_TRANSLATE
+/* Uploads the already decoded @image as the overlay,
+ * the caller still owns @image afterwards */
 bool gfx_widgets_ai_service_overlay_load(
       dispgfx_widget_t *p_dispwidget,
-      char* buffer, unsigned buffer_len,
-      enum image_type_enum image_type);
+      struct texture_image *image);
 
 void gfx_widgets_ai_service_overlay_unload(dispgfx_widget_t *p_dispwidget);
 #endif
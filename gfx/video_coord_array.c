@@ -21,6 +21,85 @@
 
 #include "video_coord_array.h"
 
+/* Smallest block the frame arena allocates */
+#define VIDEO_FRAME_ARENA_MIN_BLOCK (64 * 1024)
+/* Every allocation is aligned to this */
+#define VIDEO_FRAME_ARENA_ALIGN     16
+
+#define VIDEO_FRAME_ARENA_HEADER \
+   ((sizeof(video_frame_arena_block_t) + VIDEO_FRAME_ARENA_ALIGN - 1) \
+    & ~(size_t)(VIDEO_FRAME_ARENA_ALIGN - 1))
+
+static bool video_frame_arena_grow(video_frame_arena_t *arena, size_t size)
+{
+   video_frame_arena_block_t *block = NULL;
+   size_t block_size                = VIDEO_FRAME_ARENA_MIN_BLOCK;
+
+   if (arena->block && arena->block->size * 2 > block_size)
+      block_size = arena->block->size * 2;
+   while (block_size < size)
+      block_size *= 2;
+
+   if (!(block = (video_frame_arena_block_t*)
+            malloc(VIDEO_FRAME_ARENA_HEADER + block_size)))
+      return false;
+
+   block->prev  = arena->block;
+   block->size  = block_size;
+   arena->block = block;
+   arena->used  = 0;
+   return true;
+}
+
+void *video_frame_arena_alloc(video_frame_arena_t *arena, size_t size)
+{
+   void *ptr;
+
+   size = (size + VIDEO_FRAME_ARENA_ALIGN - 1)
+      & ~(size_t)(VIDEO_FRAME_ARENA_ALIGN - 1);
+
+   if (  !arena->block
+         || arena->block->size - arena->used < size)
+   {
+      if (!video_frame_arena_grow(arena, size))
+         return NULL;
+   }
+
+   ptr           = (uint8_t*)arena->block + VIDEO_FRAME_ARENA_HEADER
+      + arena->used;
+   arena->used  += size;
+   arena->total += size;
+   return ptr;
+}
+
+void video_frame_arena_reset(video_frame_arena_t *arena)
+{
+   /* Last frame didn't fit in one block,
+    * replace the chain with one that holds all of it */
+   if (arena->block && arena->block->prev)
+   {
+      size_t total = arena->total;
+      video_frame_arena_free(arena);
+      video_frame_arena_grow(arena, total);
+   }
+
+   arena->used  = 0;
+   arena->total = 0;
+}
+
+void video_frame_arena_free(video_frame_arena_t *arena)
+{
+   while (arena->block)
+   {
+      video_frame_arena_block_t *prev = arena->block->prev;
+      free(arena->block);
+      arena->block = prev;
+   }
+
+   arena->used  = 0;
+   arena->total = 0;
+}
+
 static INLINE bool realloc_checked(void **ptr, size_t size)
 {
    void *nptr = NULL;
@@ -75,6 +75,23 @@ typedef struct video_mut_coords
    unsigned indexes;
 } video_mut_coords_t;
 
+/* Linear allocator for geometry that only lives for one frame.
+ * Allocations stay put until the next reset. A frame that outgrows
+ * the current block chains another one, and the next reset folds
+ * them into a single block, so a steady frame never calls malloc. */
+typedef struct video_frame_arena_block
+{
+   struct video_frame_arena_block *prev;
+   size_t size;
+} video_frame_arena_block_t;
+
+typedef struct video_frame_arena
+{
+   video_frame_arena_block_t *block; /* ptr alignment */
+   size_t used;  /* Bytes used in the current block */
+   size_t total; /* Bytes handed out since the last reset */
+} video_frame_arena_t;
+
 typedef struct video_coord_array
 {
    video_mut_coords_t coords; /* ptr alignment */
@@ -92,6 +109,12 @@ bool video_coord_array_append(video_coord_array_t *ca,
 
 void video_coord_array_free(video_coord_array_t *ca);
 
+void *video_frame_arena_alloc(video_frame_arena_t *arena, size_t size);
+
+void video_frame_arena_reset(video_frame_arena_t *arena);
+
+void video_frame_arena_free(video_frame_arena_t *arena);
+
 RETRO_END_DECLS
 
 #endif
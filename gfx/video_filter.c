@@ -15,7 +15,9 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
+#include <memalign.h>
 #include <file/file_path.h>
 #include <file/config_file_userdata.h>
 #include <lists/dir_list.h>
@@ -28,6 +30,10 @@
 #include "../config.h"
 #endif
 
+#ifdef HAVE_THREADS
+#include <rthreads/tpool.h>
+#endif
+
 #include "../frontend/frontend_driver.h"
 #include "../dynamic.h"
 #include "../performance_counters.h"
@@ -56,52 +62,53 @@ struct rarch_softfilter
    unsigned max_width, max_height;
    enum retro_pixel_format pix_fmt, out_pix_fmt;
 
+   /* One packet per row tile, as returned by query_num_threads */
    struct softfilter_work_packet *packets;
    unsigned threads;
 
+   /* SOFTFILTER_CAP_*, always 0 for API version 2 plugins */
+   unsigned caps;
+   /* One scratch buffer per packet */
+   void **scratch;
+   /* Aligned copy of unaligned input for SOFTFILTER_CAP_ALIGNED_INPUT */
+   void *staging;
+
 #ifdef HAVE_THREADS
-   struct filter_thread_data *thread_data;
+   /* Tiles are handed out in order to whichever pool thread (or
+    * the calling thread) is free next, so uneven tiles don't
+    * leave cores idle. */
+   tpool_t *pool;
 #endif
 };
 
-#ifdef HAVE_THREADS
-#include <rthreads/rthreads.h>
+/* Row tiles handed to a filter per worker; more tiles than
+ * workers lets the pool balance frames with uneven cost. */
+#define SOFTFILTER_TILES_PER_WORKER 4
 
-struct filter_thread_data
-{
-   sthread_t *thread;
-   const struct softfilter_work_packet *packet;
-   scond_t *cond;
-   slock_t *lock;
-   void *userdata;
-   bool die;
-   bool done;
-};
+#define SOFTFILTER_ALIGN_UP(x) \
+   (((x) + SOFTFILTER_BUFFER_ALIGN - 1) & ~((size_t)SOFTFILTER_BUFFER_ALIGN - 1))
 
-static void filter_thread_loop(void *data)
+static bool softfilter_api_supported(
+      const struct softfilter_implementation *impl)
 {
-   struct filter_thread_data *thr = (struct filter_thread_data*)data;
+   return impl->api_version >= SOFTFILTER_API_VERSION_MIN
+      && impl->api_version <= SOFTFILTER_API_VERSION;
+}
 
-   for (;;)
-   {
-      bool die;
-      slock_lock(thr->lock);
-      while (thr->done && !thr->die)
-         scond_wait(thr->cond, thr->lock);
-      die = thr->die;
-      slock_unlock(thr->lock);
-
-      if (die)
-         break;
+static unsigned softfilter_bpp(enum retro_pixel_format fmt)
+{
+   return (fmt == RETRO_PIXEL_FORMAT_XRGB8888)
+      ? SOFTFILTER_BPP_XRGB8888 : SOFTFILTER_BPP_RGB565;
+}
 
-      if (thr->packet && thr->packet->work)
-         thr->packet->work(thr->userdata, thr->packet->thread_data);
+#ifdef HAVE_THREADS
+static void softfilter_run_packet(void *data, unsigned index)
+{
+   rarch_softfilter_t *filt = (rarch_softfilter_t*)data;
+   const struct softfilter_work_packet *packet = &filt->packets[index];
 
-      slock_lock(thr->lock);
-      thr->done = true;
-      scond_signal(thr->cond);
-      slock_unlock(thr->lock);
-   }
+   if (packet->work)
+      packet->work(filt->impl_data, packet->thread_data);
 }
 #endif
 
@@ -135,7 +142,9 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
       softfilter_simd_mask_t cpu_features,
       unsigned threads)
 {
-   unsigned input_fmts, input_fmt, output_fmts, i = 0;
+   unsigned input_fmts, input_fmt, output_fmts, workers, tiles, i = 0;
+   unsigned tile_height   = 0;
+   size_t scratch_size    = 0;
    struct config_file_userdata userdata;
    char key[64], name[64];
 
@@ -208,11 +217,29 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
    filt->max_width = max_width;
    filt->max_height = max_height;
 
+   if (filt->impl->api_version >= 3)
+   {
+      filt->caps   = filt->impl->caps;
+      tile_height  = filt->impl->tile_height;
+      scratch_size = filt->impl->scratch_size;
+   }
+
+   workers = (threads != RARCH_SOFTFILTER_THREADS_AUTO)
+      ? threads : cpu_features_get_core_amount();
+   if (workers < 1)
+      workers = 1;
+
+   tiles = workers > 1 ? workers * SOFTFILTER_TILES_PER_WORKER : 1;
+   /* Honour the preferred tile shape, but keep every worker busy */
+   if (tile_height && tiles > workers)
+   {
+      unsigned rows = (max_height + tile_height - 1) / tile_height;
+      tiles         = MAX(workers, MIN(tiles, rows));
+   }
+
    filt->impl_data = filt->impl->create(
          &softfilter_config, input_fmt, input_fmt, max_width, max_height,
-         threads != RARCH_SOFTFILTER_THREADS_AUTO ? threads :
-         cpu_features_get_core_amount(), cpu_features,
-         &userdata);
+         tiles, cpu_features, &userdata);
    if (!filt->impl_data)
    {
       RARCH_ERR("Failed to create softfilter state.\n");
@@ -227,7 +254,6 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
    }
 
    filt->threads = threads;
-   RARCH_LOG("Using %u threads for softfilter.\n", threads);
 
    filt->packets = (struct softfilter_work_packet*)
       calloc(threads, sizeof(*filt->packets));
@@ -237,31 +263,51 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
       return false;
    }
 
-#ifdef HAVE_THREADS
-   if (filt->threads > 1)
+   if (scratch_size && filt->impl->set_scratch)
    {
-      filt->thread_data = (struct filter_thread_data*)
-         calloc(threads, sizeof(*filt->thread_data));
-      if (!filt->thread_data)
+      if (!(filt->scratch = (void**)calloc(threads, sizeof(*filt->scratch))))
          return false;
 
       for (i = 0; i < threads; i++)
       {
-         filt->thread_data[i].userdata = filt->impl_data;
-         filt->thread_data[i].done     = true;
-
-         filt->thread_data[i].lock     = slock_new();
-         if (!filt->thread_data[i].lock)
-            return false;
-         filt->thread_data[i].cond     = scond_new();
-         if (!filt->thread_data[i].cond)
-            return false;
-         filt->thread_data[i].thread   = sthread_create(
-               filter_thread_loop, &filt->thread_data[i]);
-         if (!filt->thread_data[i].thread)
+         if (!(filt->scratch[i] = memalign_alloc(SOFTFILTER_BUFFER_ALIGN,
+                     SOFTFILTER_ALIGN_UP(scratch_size))))
+         {
+            RARCH_ERR("Failed to allocate softfilter scratch memory.\n");
             return false;
+         }
       }
+
+      filt->impl->set_scratch(filt->impl_data, filt->scratch, threads);
    }
+
+   if (filt->caps & SOFTFILTER_CAP_ALIGNED_INPUT)
+   {
+      filt->staging = memalign_alloc(SOFTFILTER_BUFFER_ALIGN,
+            SOFTFILTER_ALIGN_UP(max_width * softfilter_bpp(filt->pix_fmt))
+            * max_height);
+      if (!filt->staging)
+      {
+         RARCH_ERR("Failed to allocate softfilter input buffer.\n");
+         return false;
+      }
+   }
+
+#ifdef HAVE_THREADS
+   /* The calling thread works on tiles too */
+   if (workers > threads)
+      workers = threads;
+
+   if (workers > 1)
+   {
+      if (!(filt->pool = tpool_create(workers - 1)))
+         return false;
+   }
+
+   RARCH_LOG("Using %u threads and %u tiles for softfilter.\n",
+         workers, threads);
+#else
+   RARCH_LOG("Using %u tiles for softfilter.\n", threads);
 #endif
 
    return true;
@@ -378,7 +424,7 @@ static bool append_softfilter_plugs(rarch_softfilter_t *filt,
          continue;
       }
 
-      if (impl->api_version != SOFTFILTER_API_VERSION)
+      if (!softfilter_api_supported(impl))
       {
          dylib_close(lib);
          continue;
@@ -489,6 +535,14 @@ void rarch_softfilter_free(rarch_softfilter_t *filt)
    if (filt->impl && filt->impl_data)
       filt->impl->destroy(filt->impl_data);
 
+   if (filt->scratch)
+   {
+      for (i = 0; i < filt->threads; i++)
+         memalign_free(filt->scratch[i]);
+      free(filt->scratch);
+   }
+   memalign_free(filt->staging);
+
 #ifdef HAVE_DYLIB
    for (i = 0; i < filt->num_plugs; i++)
    {
@@ -499,24 +553,8 @@ void rarch_softfilter_free(rarch_softfilter_t *filt)
 #endif
 
 #ifdef HAVE_THREADS
-   if (filt->threads > 1)
-   {
-      for (i = 0; i < filt->threads; i++)
-      {
-         if (!&filt->thread_data[i])
-            continue;
-         if (!filt->thread_data[i].thread)
-            continue;
-         slock_lock(filt->thread_data[i].lock);
-         filt->thread_data[i].die = true;
-         scond_signal(filt->thread_data[i].cond);
-         slock_unlock(filt->thread_data[i].lock);
-         sthread_join(filt->thread_data[i].thread);
-         slock_free(filt->thread_data[i].lock);
-         scond_free(filt->thread_data[i].cond);
-      }
-      free(filt->thread_data);
-   }
+   if (filt->pool)
+      tpool_destroy(filt->pool);
 #endif
 
    if (filt->conf)
@@ -547,6 +585,54 @@ enum retro_pixel_format rarch_softfilter_get_output_format(
    return filt->out_pix_fmt;
 }
 
+size_t rarch_softfilter_get_output_stride(rarch_softfilter_t *filt,
+      unsigned width)
+{
+   return SOFTFILTER_ALIGN_UP(width * softfilter_bpp(filt->out_pix_fmt));
+}
+
+/* Copies @input to an aligned buffer if the filter asked for
+ * aligned input and didn't get it. In-place filters are staged
+ * straight into the output buffer. */
+static const void *softfilter_stage_input(rarch_softfilter_t *filt,
+      void *output, size_t output_stride,
+      const void *input, unsigned width, unsigned height,
+      size_t *input_stride)
+{
+   unsigned y;
+   unsigned out_width, out_height;
+   uint8_t *dst;
+   size_t stride;
+   size_t row = width * softfilter_bpp(filt->pix_fmt);
+
+   if (     ((uintptr_t)input  % SOFTFILTER_BUFFER_ALIGN) == 0
+         && (*input_stride     % SOFTFILTER_BUFFER_ALIGN) == 0)
+      return input;
+
+   rarch_softfilter_get_output_size(filt, &out_width, &out_height,
+         width, height);
+
+   if (     (filt->caps & SOFTFILTER_CAP_IN_PLACE)
+         && filt->out_pix_fmt == filt->pix_fmt
+         && out_width  == width
+         && out_height == height)
+   {
+      dst    = (uint8_t*)output;
+      stride = output_stride;
+   }
+   else
+   {
+      dst    = (uint8_t*)filt->staging;
+      stride = SOFTFILTER_ALIGN_UP(row);
+   }
+
+   for (y = 0; y < height; y++)
+      memcpy(dst + y * stride, (const uint8_t*)input + y * *input_stride, row);
+
+   *input_stride = stride;
+   return dst;
+}
+
 void rarch_softfilter_process(rarch_softfilter_t *filt,
       void *output, size_t output_stride,
       const void *input, unsigned width, unsigned height,
@@ -557,37 +643,19 @@ void rarch_softfilter_process(rarch_softfilter_t *filt,
    if (!filt)
       return;
 
+   if (filt->staging)
+      input = softfilter_stage_input(filt, output, output_stride,
+            input, width, height, &input_stride);
+
    if (filt->impl && filt->impl->get_work_packets)
       filt->impl->get_work_packets(filt->impl_data, filt->packets,
             output, output_stride, input, width, height, input_stride);
 
 #ifdef HAVE_THREADS
-   if (filt->threads > 1)
+   if (filt->pool)
    {
-      /* Fire off workers */
-      for (i = 0; i < filt->threads; i++)
-      {
-#if 0
-         RARCH_LOG("Firing off filter thread %u ...\n", i);
-#endif
-         filt->thread_data[i].packet = &filt->packets[i];
-         slock_lock(filt->thread_data[i].lock);
-         filt->thread_data[i].done = false;
-         scond_signal(filt->thread_data[i].cond);
-         slock_unlock(filt->thread_data[i].lock);
-      }
-
-      /* Wait for workers */
-      for (i = 0; i < filt->threads; i++)
-      {
-#if 0
-         RARCH_LOG("Waiting for filter thread %u ...\n", i);
-#endif
-         slock_lock(filt->thread_data[i].lock);
-         while (!filt->thread_data[i].done)
-            scond_wait(filt->thread_data[i].cond, filt->thread_data[i].lock);
-         slock_unlock(filt->thread_data[i].lock);
-      }
+      tpool_run_batch(filt->pool, softfilter_run_packet,
+            filt, filt->threads);
       return;
    }
 #endif
@@ -46,6 +46,11 @@ void rarch_softfilter_get_output_size(rarch_softfilter_t *filt,
 enum retro_pixel_format rarch_softfilter_get_output_format(
       rarch_softfilter_t *filt);
 
+/* Output stride for a given output width, padded so that every
+ * row of the output buffer stays aligned for the filter. */
+size_t rarch_softfilter_get_output_stride(rarch_softfilter_t *filt,
+      unsigned width);
+
 void rarch_softfilter_process(rarch_softfilter_t *filt,
       void *output, size_t output_stride,
       const void *input, unsigned width, unsigned height, size_t input_stride);
@@ -175,6 +175,10 @@ static const struct softfilter_implementation darken = {
    SOFTFILTER_API_VERSION,
    "Darken",
    "darken",
+   SOFTFILTER_CAP_IN_PLACE,
+   0, /* tile_height */
+   0, /* scratch_size */
+   NULL,
 };
 
 const struct softfilter_implementation *softfilter_get_implementation(
@@ -97,7 +97,24 @@ typedef const struct softfilter_implementation
 const struct softfilter_implementation *softfilter_get_implementation(
       softfilter_simd_mask_t simd);
 
-#define SOFTFILTER_API_VERSION  2
+#define SOFTFILTER_API_VERSION  3
+
+/* Oldest API version the frontend still loads. Version 2 plugins
+ * end their softfilter_implementation at short_ident. */
+#define SOFTFILTER_API_VERSION_MIN 2
+
+/* Output buffers and output strides are always aligned to this
+ * many bytes. Input is too if SOFTFILTER_CAP_ALIGNED_INPUT is set. */
+#define SOFTFILTER_BUFFER_ALIGN 64
+
+/* Capabilities (API version 3) */
+
+/* Output may be the same buffer as the input. Only happens when the
+ * output has the same size and format as the input. */
+#define SOFTFILTER_CAP_IN_PLACE      (1 << 0)
+/* Input must be aligned like the output. Unaligned frames are
+ * copied into an aligned buffer first. */
+#define SOFTFILTER_CAP_ALIGNED_INPUT (1 << 1)
 
 /* Required base color formats */
 
@@ -158,12 +175,21 @@ typedef void (*softfilter_get_work_packets_t)(void *data,
       void *output, size_t output_stride,
       const void *input, unsigned width, unsigned height, size_t input_stride);
 
-/* Returns the number of worker threads the filter will use.
- * This can differ from the value passed to create() instead the filter
- * cannot be parallelized, etc. The number of threads must be less-or-equal
- * compared to the value passed to create(). */
+/* Returns the number of work packets the filter will submit per frame.
+ * The frontend schedules these over its worker pool, so a filter should
+ * split the frame into that many independent row tiles. This can differ
+ * from the value passed to create() if the filter cannot be parallelized,
+ * etc. The number must be less-or-equal compared to the value passed
+ * to create(). */
 typedef unsigned (*softfilter_query_num_threads_t)(void *data);
 
+/* Called once after create() with one buffer of scratch_size bytes
+ * per work packet, aligned to SOFTFILTER_BUFFER_ALIGN. Packets never
+ * run concurrently with themselves, so packet i may use scratch[i]
+ * freely. The buffers stay valid until destroy(). */
+typedef void (*softfilter_set_scratch_t)(void *data,
+      void **scratch, unsigned num_scratch);
+
 struct softfilter_implementation
 {
    softfilter_query_input_formats_t query_input_formats;
@@ -183,6 +209,18 @@ struct softfilter_implementation
    /* Computer-friendly short version of ident.
     * Lower case, no spaces and special characters, etc. */
    const char *short_ident;
+
+   /* Fields below are only read from API version 3 on. */
+
+   /* SOFTFILTER_CAP_* bitmask. */
+   unsigned caps;
+   /* Preferred rows per work packet, 0 for no preference.
+    * The frontend asks for fewer, taller tiles accordingly. */
+   unsigned tile_height;
+   /* Scratch bytes needed per work packet, 0 for none. */
+   size_t scratch_size;
+   /* Required if scratch_size is not 0. */
+   softfilter_set_scratch_t set_scratch;
 };
 
 #ifdef __cplusplus
@@ -75,7 +75,7 @@ static void *supereagle_generic_create(const struct softfilter_config *config,
    if (!filt)
       return NULL;
    filt->workers = (struct softfilter_thread_data*)calloc(threads, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
    if (!filt->workers)
    {
@@ -313,9 +313,11 @@ static void supereagle_generic_packets(void *data,
       thr->width = width;
       thr->height = y_end - y_start;
 
-      /* Workers need to know if they can access pixels outside their given buffer. */
+      /* The kernel only reads neighbouring rows when last is 0,
+       * which the single whole-frame packet never was. Keep every
+       * tile that way so output does not depend on the tile count. */
       thr->first = y_start;
-      thr->last = y_end == height;
+      thr->last = 1;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
          packets[i].work = supereagle_work_cb_rgb565;
@@ -0,0 +1,153 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#ifdef HAVE_CONFIG_H
+#include "../config.h"
+#endif
+
+#include "video_frame_export.h"
+
+#ifdef HAVE_VIDEO_FRAME_EXPORT
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <compat/strl.h>
+
+#include "../verbosity.h"
+
+struct video_frame_export
+{
+   video_frame_export_header_t *header;
+   uint8_t *data;
+   size_t map_size;
+   size_t slot_size;
+   unsigned sequence;
+   char path[256];
+};
+
+video_frame_export_t *video_frame_export_new(const char *path,
+      size_t slot_size)
+{
+   int fd;
+   void *map                   = NULL;
+   video_frame_export_t *exp   = NULL;
+   /* Keep the pixels of each slot page-aligned,
+    * as readers may well map them directly */
+   size_t data_offset          = (sizeof(video_frame_export_header_t)
+         + 4095) & ~(size_t)4095;
+
+   slot_size                   = (slot_size + 4095) & ~(size_t)4095;
+
+   if (!path || !slot_size || slot_size > UINT32_MAX)
+      return NULL;
+
+   if (!(exp = (video_frame_export_t*)calloc(1, sizeof(*exp))))
+      return NULL;
+
+   exp->slot_size              = slot_size;
+   exp->map_size               = data_offset
+      + slot_size * VIDEO_FRAME_EXPORT_SLOTS;
+   strlcpy(exp->path, path, sizeof(exp->path));
+
+   /* Start from a new file, so that readers still
+    * holding the previous one see it closed */
+   unlink(path);
+
+   if ((fd = open(path, O_RDWR | O_CREAT | O_EXCL, 0644)) < 0)
+      goto error;
+
+   if (ftruncate(fd, (off_t)exp->map_size) == 0)
+      map = mmap(NULL, exp->map_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED, fd, 0);
+
+   close(fd);
+
+   if (!map || map == MAP_FAILED)
+   {
+      unlink(path);
+      goto error;
+   }
+
+   exp->header                 = (video_frame_export_header_t*)map;
+   exp->data                   = (uint8_t*)map + data_offset;
+   exp->header->version        = VIDEO_FRAME_EXPORT_VERSION;
+   exp->header->slot_count     = VIDEO_FRAME_EXPORT_SLOTS;
+   exp->header->slot_size      = (uint32_t)slot_size;
+   exp->header->data_offset    = (uint32_t)data_offset;
+   retro_atomic_store(&exp->header->magic, VIDEO_FRAME_EXPORT_MAGIC);
+
+   RARCH_LOG("[Video]: Exporting frames to \"%s\".\n", path);
+
+   return exp;
+
+error:
+   RARCH_ERR("[Video]: Failed to create frame export \"%s\".\n", path);
+   free(exp);
+   return NULL;
+}
+
+void video_frame_export_free(video_frame_export_t *exp)
+{
+   if (!exp)
+      return;
+
+   retro_atomic_store(&exp->header->magic, 0);
+   munmap(exp->header, exp->map_size);
+   unlink(exp->path);
+   free(exp);
+}
+
+bool video_frame_export_push(video_frame_export_t *exp,
+      const void *data, unsigned width, unsigned height,
+      size_t pitch, unsigned format)
+{
+   int sequence;
+   video_frame_export_slot_t *slot = NULL;
+
+   if (!exp || !data || (size_t)height * pitch > exp->slot_size)
+      return false;
+
+   /* 0 is never a valid sequence number */
+   if (++exp->sequence > INT_MAX)
+      exp->sequence = 1;
+
+   sequence                        = (int)exp->sequence;
+   slot                            = &exp->header->slots[
+      sequence % VIDEO_FRAME_EXPORT_SLOTS];
+
+   retro_atomic_store(&slot->sequence, 0);
+
+   memcpy(exp->data + (sequence % VIDEO_FRAME_EXPORT_SLOTS)
+         * exp->slot_size, data, (size_t)height * pitch);
+   slot->width                     = width;
+   slot->height                    = height;
+   slot->pitch                     = (uint32_t)pitch;
+   slot->format                    = format;
+
+   retro_atomic_store(&slot->sequence, sequence);
+   retro_atomic_store(&exp->header->sequence, sequence);
+
+   return true;
+}
+
+#endif
@@ -0,0 +1,103 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __VIDEO_FRAME_EXPORT_H__
+#define __VIDEO_FRAME_EXPORT_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+#include <retro_atomic.h>
+
+#if defined(HAVE_MMAP) && !defined(_WIN32)
+#define HAVE_VIDEO_FRAME_EXPORT
+#endif
+
+RETRO_BEGIN_DECLS
+
+/* Core frames are published to other local processes
+ * through a file mapped into memory, so that they do
+ * not have to capture the screen to get at them */
+#if defined(__linux__)
+#define VIDEO_FRAME_EXPORT_PATH    "/dev/shm/retroarch-frame"
+#else
+#define VIDEO_FRAME_EXPORT_PATH    "/tmp/retroarch-frame"
+#endif
+
+#define VIDEO_FRAME_EXPORT_MAGIC   0x58464152 /* "RAFX" */
+#define VIDEO_FRAME_EXPORT_VERSION 1
+#define VIDEO_FRAME_EXPORT_SLOTS   3
+
+/* The mapping starts with a video_frame_export_header_t,
+ * followed by 'slot_count' frames of 'slot_size' bytes
+ * each, starting at 'data_offset'. All fields are native
+ * endian, sequence numbers are 32-bit and start at 1.
+ *
+ * Frame 'sequence' is always written to slot
+ * (sequence % slot_count). A reader takes the slot of
+ * the header's 'sequence', copies it out, and keeps the
+ * copy if the slot's 'sequence' still matches before
+ * and after - it is 0 while the slot is being written.
+ *
+ * 'magic' reads 0 once the exporter has closed (or
+ * recreated) the file, which should then be reopened */
+typedef struct video_frame_export_slot
+{
+   retro_atomic_int_t sequence;
+   uint32_t width;
+   uint32_t height;
+   uint32_t pitch;
+   uint32_t format; /* enum retro_pixel_format */
+} video_frame_export_slot_t;
+
+typedef struct video_frame_export_header
+{
+   retro_atomic_int_t magic;
+   uint32_t version;
+   uint32_t slot_count;
+   uint32_t slot_size;
+   uint32_t data_offset;
+   retro_atomic_int_t sequence;
+   video_frame_export_slot_t slots[VIDEO_FRAME_EXPORT_SLOTS];
+} video_frame_export_header_t;
+
+typedef struct video_frame_export video_frame_export_t;
+
+/**
+ * video_frame_export_new:
+ * @path                 : File to publish frames through.
+ * @slot_size            : Largest frame (pitch * height), in bytes.
+ *
+ * Creates (or replaces) the export file at @path.
+ *
+ * Returns: handle to publish frames with, or NULL on error.
+ **/
+video_frame_export_t *video_frame_export_new(const char *path,
+      size_t slot_size);
+
+void video_frame_export_free(video_frame_export_t *exp);
+
+/* Returns false if the frame is larger than the
+ * slots, in which case it has not been published */
+bool video_frame_export_push(video_frame_export_t *exp,
+      const void *data, unsigned width, unsigned height,
+      size_t pitch, unsigned format);
+
+RETRO_END_DECLS
+
+#endif
@@ -346,6 +346,8 @@ void video_layout_view_fit_bounds(video_layout_bounds_t bounds)
    {
       layer_t *layer = &view->layers[i];
 
+      layer->dirty   = true;
+
       for (j = 0; j < layer->elements_count; ++j)
       {
          element_t *elem       = &layer->elements[j];
@@ -376,6 +378,32 @@ int video_layout_layer_count(void)
    return video_layout_state->view->layers_count;
 }
 
+video_layout_blend_t video_layout_layer_blend(int index)
+{
+   return video_layout_state->view->layers[index].blend;
+}
+
+bool video_layout_layer_changed(int index)
+{
+   unsigned i;
+   layer_t *layer = &video_layout_state->view->layers[index];
+
+   if (layer->dirty)
+      return true;
+
+   /* Only elements bound to an output can change */
+   for (i = 0; i < layer->elements_count; ++i)
+   {
+      element_t *elem = &layer->elements[i];
+
+      if (     elem->o_bind != -1
+            && elem->state  != video_layout_state->io[elem->o_bind].value)
+         return true;
+   }
+
+   return false;
+}
+
 void video_layout_layer_render(int index)
 {
    unsigned i, j;
@@ -476,6 +504,8 @@ void video_layout_layer_render(int index)
    }
 
    r->layer_end(info, layer->blend);
+
+   layer->dirty = false;
 }
 
 const video_layout_bounds_t *video_layout_screen(int index)
@@ -86,6 +86,11 @@ bool        video_layout_view_on_change    (void);
 void        video_layout_view_fit_bounds   (video_layout_bounds_t bounds);
 
 int         video_layout_layer_count       (void);
+video_layout_blend_t
+            video_layout_layer_blend       (int index);
+/* Whether the layer would look different from when it
+ * was last rendered, as render targets can keep it */
+bool        video_layout_layer_changed     (int index);
 void        video_layout_layer_render      (int index);
 
 const video_layout_bounds_t
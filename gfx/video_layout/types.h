@@ -28,6 +28,9 @@ typedef enum video_layout_text_align
    VIDEO_LAYOUT_TEXT_ALIGN_RIGHT
 } video_layout_text_align_t;
 
+/* screen, overlay, backdrop, bezel, cpanel and marquee */
+#define VIDEO_LAYOUT_MAX_LAYERS 6
+
 typedef struct video_layout_color
 {
    float r;
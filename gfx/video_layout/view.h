@@ -11,6 +11,10 @@ typedef struct layer
 
    element_t            *elements;
    int                   elements_count;
+
+   /* needs to be rendered again, regardless of the
+    * states of its elements */
+   bool                  dirty;
 } layer_t;
 
 typedef struct view
@@ -1839,6 +1839,15 @@ end:
    return ret;
 }
 
+bool video_shader_pass_is_passthrough(const struct video_shader_pass *pass)
+{
+   const char *name = path_basename(pass->source.path);
+
+   return string_is_equal(name, "stock.slang")
+      ||  string_is_equal(name, "stock.glsl")
+      ||  string_is_equal(name, "stock.cg");
+}
+
 const char *video_shader_type_to_str(enum rarch_shader_type type)
 {
    switch (type)
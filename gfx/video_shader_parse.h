@@ -215,6 +215,18 @@ bool video_shader_write_preset(const char *path,
                                  bool reference);
 
 
+/**
+ * video_shader_pass_is_passthrough:
+ * @pass              : Shader pass.
+ *
+ * Checks whether a pass runs the stock shader, which only
+ * copies its source. Filter chains may skip such a pass
+ * when it neither scales nor changes the format.
+ *
+ * Returns: true (1) if the pass is a passthrough, otherwise false (0).
+ **/
+bool video_shader_pass_is_passthrough(const struct video_shader_pass *pass);
+
 enum rarch_shader_type video_shader_get_type_from_ext(const char *ext, bool *is_preset);
 
 /**
@@ -25,8 +25,10 @@
 
 #include "video_thread_wrapper.h"
 #include "font_driver.h"
+#include "gfx_display.h"
 
 #include "../retroarch.h"
+#include "../performance_counters.h"
 #include "../verbosity.h"
 
 static void *video_thread_init_never_call(const video_info_t *video,
@@ -374,19 +376,50 @@ static bool video_thread_handle_packet(
    return false;
 }
 
+static INLINE bool video_thread_frame_is_fresh(thread_video_t *thr)
+{
+   return (retro_atomic_load(&thr->frame.ready)
+         & THREAD_VIDEO_FRAME_FRESH) != 0;
+}
+
+/* Swaps the caller's own buffer index with the handoff slot
+ * and returns the previous content of the handoff slot. */
+static int video_thread_frame_swap(thread_video_t *thr, int value)
+{
+#if RETRO_ATOMIC_LOCK_FREE
+   return retro_atomic_exchange(&thr->frame.ready, value);
+#else
+   int old;
+   slock_lock(thr->lock);
+   old = retro_atomic_exchange(&thr->frame.ready, value);
+   slock_unlock(thr->lock);
+   return old;
+#endif
+}
+
 static void video_thread_loop(void *data)
 {
    thread_video_t *thr = (thread_video_t*)data;
 
+   perf_trace_set_thread_name("video");
+   sthread_set_role(STHREAD_ROLE_VIDEO);
+
    for (;;)
    {
       thread_packet_t pkt;
       bool updated = false;
 
       slock_lock(thr->lock);
-      while (thr->send_cmd == CMD_VIDEO_NONE && !thr->frame.updated)
+      /* Announce that we may block before checking for a new
+       * frame, so that video_thread_frame() either sees this
+       * or we see its frame - it only takes the lock to wake
+       * us up in the former case. */
+      retro_atomic_store(&thr->frame.waiting, 1);
+      while (thr->send_cmd == CMD_VIDEO_NONE
+            && !video_thread_frame_is_fresh(thr))
          scond_wait(thr->cond_thread, thr->lock);
-      if (thr->frame.updated)
+      retro_atomic_store(&thr->frame.waiting, 0);
+      if (video_thread_frame_is_fresh(thr))
          updated = true;
 
       /* To avoid race condition where send_cmd is updated
@@ -396,7 +429,10 @@ static void video_thread_loop(void *data)
       slock_unlock(thr->lock);
 
       if (video_thread_handle_packet(thr, &pkt))
+      {
+         perf_trace_thread_exit();
          return;
+      }
 
       if (updated)
       {
@@ -413,6 +449,13 @@ static void video_thread_loop(void *data)
          vp.full_width            = 0;
          vp.full_height           = 0;
 
+         /* Mark ourselves busy before taking the frame, so that
+          * the main thread never sees neither a fresh frame nor
+          * a frame being rendered while we are working. */
+         retro_atomic_store(&thr->frame.rendering, 1);
+         thr->frame.read_idx      = video_thread_frame_swap(thr,
+               (int)thr->frame.read_idx) & THREAD_VIDEO_FRAME_INDEX;
+
          slock_lock(thr->frame.lock);
 
          thread_update_driver_state(thr);
@@ -420,15 +463,24 @@ static void video_thread_loop(void *data)
          if (thr->driver && thr->driver->frame)
          {
             video_frame_info_t video_info;
+            unsigned idx = thr->frame.read_idx;
             /* TODO/FIXME - not thread-safe - should get 
              * rid of this */
             video_driver_build_info(&video_info);
+            gfx_display_frame_reset();
 
+            perf_trace_begin("video_thread_frame");
             ret = thr->driver->frame(thr->driver_data,
-                  thr->frame.buffer, thr->frame.width, thr->frame.height,
-                  thr->frame.count,
-                  thr->frame.pitch, *thr->frame.msg ? thr->frame.msg : NULL,
+                  thr->frame.slots[idx].dupe
+                  ? NULL : thr->frame.slots[idx].buffer,
+                  thr->frame.slots[idx].width,
+                  thr->frame.slots[idx].height,
+                  thr->frame.slots[idx].count,
+                  thr->frame.slots[idx].pitch,
+                  *thr->frame.slots[idx].msg
+                  ? thr->frame.slots[idx].msg : NULL,
                   &video_info);
+            perf_trace_end("video_thread_frame");
          }
 
          slock_unlock(thr->frame.lock);
@@ -449,8 +501,8 @@ static void video_thread_loop(void *data)
          thr->alive         = alive;
          thr->focus         = focus;
          thr->has_windowed  = has_windowed;
-         thr->frame.updated = false;
          thr->vp            = vp;
+         retro_atomic_store(&thr->frame.rendering, 0);
          scond_signal(thr->cond_cmd);
          slock_unlock(thr->lock);
       }
@@ -518,10 +570,12 @@ static bool video_thread_frame(void *data, const void *frame_,
       unsigned width, unsigned height, uint64_t frame_count,
       unsigned pitch, const char *msg, video_frame_info_t *video_info)
 {
+   int old;
    unsigned copy_stride;
    const uint8_t *src                  = NULL;
    uint8_t *dst                        = NULL;
    thread_video_t *thr                 = (thread_video_t*)data;
+   thread_video_frame_slot_t *slot     = NULL;
 
    /* If called from within read_viewport, we're actually in the
     * driver thread, so just render directly. */
@@ -538,20 +592,45 @@ static bool video_thread_frame(void *data, const void *frame_,
    copy_stride = width * (thr->info.rgb32
          ? sizeof(uint32_t) : sizeof(uint16_t));
 
-   src = (const uint8_t*)frame_;
-   dst = thr->frame.buffer;
-
-   slock_lock(thr->lock);
+   slot        = &thr->frame.slots[thr->frame.write_idx];
+   src         = (const uint8_t*)frame_;
+   dst         = slot->buffer;
 
-   if (!thr->nonblock)
+   /* The write buffer is owned by this thread, so the copy
+    * needs no lock. It is skipped altogether when the core
+    * rendered straight into it through
+    * RETRO_ENVIRONMENT_GET_CURRENT_SOFTWARE_FRAMEBUFFER. */
+   if (src && (src != dst || pitch != copy_stride))
    {
+      unsigned h;
+      for (h = 0; h < height; h++, src += pitch, dst += copy_stride)
+         memcpy(dst, src, copy_stride);
+   }
+
+   slot->dupe   = !src;
+   slot->width  = width;
+   slot->height = height;
+   slot->count  = frame_count;
+   slot->pitch  = copy_stride;
 
+   if (msg)
+      strlcpy(slot->msg, msg, sizeof(slot->msg));
+   else
+      *slot->msg = '\0';
+
+   if (     !thr->nonblock
+         && (  retro_atomic_load(&thr->frame.rendering)
+            || video_thread_frame_is_fresh(thr)))
+   {
       retro_time_t target_frame_time = (retro_time_t)
          roundf(1000000 / video_info->refresh_rate);
       retro_time_t target = thr->last_time + target_frame_time;
 
+      slock_lock(thr->lock);
+
       /* Ideally, use absolute time, but that is only a good idea on POSIX. */
-      while (thr->frame.updated)
+      while (  retro_atomic_load(&thr->frame.rendering)
+            || video_thread_frame_is_fresh(thr))
       {
          retro_time_t current = cpu_features_get_time_usec();
          retro_time_t delta   = target - current;
@@ -562,45 +641,39 @@ static bool video_thread_frame(void *data, const void *frame_,
          if (!scond_wait_timeout(thr->cond_cmd, thr->lock, delta))
             break;
       }
-   }
 
-   /* Drop frame if updated flag is still set, as thread is
-    * still working on last frame. */
-   if (!thr->frame.updated)
-   {
-      if (src)
-      {
-         unsigned h;
-         for (h = 0; h < height; h++, src += pitch, dst += copy_stride)
-            memcpy(dst, src, copy_stride);
-      }
+      slock_unlock(thr->lock);
+   }
 
-      thr->frame.updated = true;
-      thr->frame.width  = width;
-      thr->frame.height = height;
-      thr->frame.count  = frame_count;
-      thr->frame.pitch  = copy_stride;
+   /* Publish the new frame. If the video thread did not pick
+    * up the previous one yet, it is replaced (and dropped)
+    * instead of the new one. */
+   old                  = video_thread_frame_swap(thr,
+         (int)thr->frame.write_idx | THREAD_VIDEO_FRAME_FRESH);
+   thr->frame.write_idx = old & THREAD_VIDEO_FRAME_INDEX;
 
-      if (msg)
-         strlcpy(thr->frame.msg, msg, sizeof(thr->frame.msg));
-      else
-         *thr->frame.msg = '\0';
+   if (old & THREAD_VIDEO_FRAME_FRESH)
+      thr->miss_count++;
+   else
+      thr->hit_count++;
 
+   if (retro_atomic_load(&thr->frame.waiting) || !RETRO_ATOMIC_LOCK_FREE)
+   {
+      slock_lock(thr->lock);
       scond_signal(thr->cond_thread);
+      slock_unlock(thr->lock);
+   }
 
 #if defined(HAVE_MENU)
-      if (thr->texture.enable)
-      {
-         while (thr->frame.updated)
-            scond_wait(thr->cond_cmd, thr->lock);
-      }
-#endif
-      thr->hit_count++;
+   if (thr->texture.enable)
+   {
+      slock_lock(thr->lock);
+      while (  retro_atomic_load(&thr->frame.rendering)
+            || video_thread_frame_is_fresh(thr))
+         scond_wait(thr->cond_cmd, thr->lock);
+      slock_unlock(thr->lock);
    }
-   else
-      thr->miss_count++;
-
-   slock_unlock(thr->lock);
+#endif
 
    thr->last_time = cpu_features_get_time_usec();
    return true;
@@ -619,6 +692,7 @@ static bool video_thread_init(thread_video_t *thr,
       const video_info_t info,
       input_driver_t **input, void **input_data)
 {
+   unsigned i;
    size_t max_size;
    thread_packet_t pkt;
 
@@ -640,16 +714,27 @@ static bool video_thread_init(thread_video_t *thr,
    max_size                  = info.input_scale * RARCH_SCALE_BASE;
    max_size                 *= max_size;
    max_size                 *= info.rgb32 ? sizeof(uint32_t) : sizeof(uint16_t);
+   thr->frame.buffer_size    = max_size;
+
+   for (i = 0; i < THREAD_VIDEO_FRAME_BUFFERS; i++)
+   {
 #ifdef _3DS
-   thr->frame.buffer         = linearMemAlign(max_size, 0x80);
+      thr->frame.slots[i].buffer = (uint8_t*)linearMemAlign(max_size, 0x80);
 #else
-   thr->frame.buffer         = (uint8_t*)malloc(max_size);
+      thr->frame.slots[i].buffer = (uint8_t*)malloc(max_size);
 #endif
 
-   if (!thr->frame.buffer)
-      return false;
+      if (!thr->frame.slots[i].buffer)
+         return false;
+
+      memset(thr->frame.slots[i].buffer, 0x80, max_size);
+   }
 
-   memset(thr->frame.buffer, 0x80, max_size);
+   thr->frame.write_idx      = 0;
+   thr->frame.read_idx       = 1;
+   thr->frame.ready          = 2;
+   thr->frame.rendering      = 0;
+   thr->frame.waiting        = 0;
 
    thr->last_time            = cpu_features_get_time_usec();
    thr->thread               = sthread_create(video_thread_loop, thr);
@@ -750,6 +835,7 @@ static bool video_thread_read_viewport(void *data,
 
 static void video_thread_free(void *data)
 {
+   unsigned i;
    thread_packet_t pkt;
    thread_video_t *thr = (thread_video_t*)data;
 
@@ -764,11 +850,14 @@ static void video_thread_free(void *data)
 #if defined(HAVE_MENU)
    free(thr->texture.frame);
 #endif
+   for (i = 0; i < THREAD_VIDEO_FRAME_BUFFERS; i++)
+   {
 #ifdef _3DS
-   linearFree(thr->frame.buffer);
+      linearFree(thr->frame.slots[i].buffer);
 #else
-   free(thr->frame.buffer);
+      free(thr->frame.slots[i].buffer);
 #endif
+   }
    slock_free(thr->frame.lock);
    slock_free(thr->lock);
    scond_free(thr->cond_cmd);
@@ -1109,6 +1198,37 @@ static uint32_t thread_get_flags(void *data)
    return thr->poke->get_flags(thr->driver_data);
 }
 
+/* Hands the core the buffer the next frame will be published
+ * from, so video_thread_frame() does not have to copy it. */
+static bool thread_get_current_software_framebuffer(void *data,
+      struct retro_framebuffer *framebuffer)
+{
+   unsigned bpp;
+   thread_video_t *thr = (thread_video_t*)data;
+
+   if (!thr || !framebuffer)
+      return false;
+
+   /* Cores outputting 0RGB1555 get converted by the frontend
+    * before the frame reaches us */
+   if (video_driver_get_pixel_format() == RETRO_PIXEL_FORMAT_0RGB1555)
+      return false;
+
+   bpp = thr->info.rgb32 ? sizeof(uint32_t) : sizeof(uint16_t);
+
+   if ((size_t)framebuffer->width * framebuffer->height * bpp
+         > thr->frame.buffer_size)
+      return false;
+
+   framebuffer->data         = thr->frame.slots[thr->frame.write_idx].buffer;
+   framebuffer->pitch        = framebuffer->width * bpp;
+   framebuffer->format       = thr->info.rgb32
+      ? RETRO_PIXEL_FORMAT_XRGB8888 : RETRO_PIXEL_FORMAT_RGB565;
+   framebuffer->memory_flags = 0;
+
+   return true;
+}
+
 static const video_poke_interface_t thread_poke = {
    thread_get_flags,
    thread_load_texture,
@@ -1131,7 +1251,7 @@ static const video_poke_interface_t thread_poke = {
    thread_grab_mouse_toggle,
 
    thread_get_current_shader,
-   NULL,                      /* get_current_software_framebuffer */
+   thread_get_current_software_framebuffer,
    NULL                       /* get_hw_render_interface */
 };
 
@@ -1280,6 +1400,53 @@ bool video_thread_font_init(const void **font_driver, void **font_handle,
    return pkt.data.font_init.return_value;
 }
 
+typedef struct
+{
+   thread_video_t *thr;
+   video_driver_texture_upload_t *uploads;
+   size_t count;
+} thread_texture_batch_t;
+
+/* Runs on the video thread, which owns the context,
+ * so the driver may upload directly */
+static int video_thread_texture_load_batch_cmd(void *data)
+{
+   size_t i;
+   thread_texture_batch_t *batch = (thread_texture_batch_t*)data;
+   thread_video_t *thr           = batch->thr;
+
+   for (i = 0; i < batch->count; i++)
+      batch->uploads[i].id = thr->poke->load_texture(thr->driver_data,
+            batch->uploads[i].image, false,
+            batch->uploads[i].filter_type);
+
+   return 1;
+}
+
+bool video_thread_texture_load_batch(
+      video_driver_texture_upload_t *uploads, size_t count)
+{
+   thread_packet_t pkt;
+   thread_texture_batch_t batch;
+   thread_video_t *thr            = (thread_video_t*)
+      video_driver_get_data();
+
+   if (!thr || !thr->poke || !thr->poke->load_texture)
+      return false;
+
+   batch.thr                      = thr;
+   batch.uploads                  = uploads;
+   batch.count                    = count;
+
+   pkt.type                       = CMD_CUSTOM_COMMAND;
+   pkt.data.custom_command.method = video_thread_texture_load_batch_cmd;
+   pkt.data.custom_command.data   = &batch;
+
+   video_thread_send_and_wait(thr, &pkt);
+
+   return true;
+}
+
 unsigned video_thread_texture_load(void *data,
       custom_command_method_t func)
 {
@@ -21,6 +21,7 @@
 
 #include <boolean.h>
 #include <retro_common_api.h>
+#include <retro_atomic.h>
 #include <rthreads/rthreads.h>
 
 #include "font_driver.h"
@@ -67,6 +68,15 @@ typedef bool (*custom_font_command_method_t)(const void **font_driver,
       float font_size, enum font_driver_render_api api,
       bool is_threaded);
 
+/* Number of core frame buffers. At any time one is being
+ * written by the main thread, one is being read by the video
+ * thread, and one holds the most recently completed frame. */
+#define THREAD_VIDEO_FRAME_BUFFERS 3
+/* Set in thread_video_t.frame.ready while the buffer it
+ * points to has not been picked up by the video thread yet. */
+#define THREAD_VIDEO_FRAME_FRESH   0x100
+#define THREAD_VIDEO_FRAME_INDEX   0x0ff
+
 typedef struct thread_packet thread_packet_t;
 
 struct thread_packet
@@ -154,6 +164,17 @@ struct thread_packet
    enum thread_cmd type;
 };
 
+typedef struct thread_video_frame_slot
+{
+   uint64_t count;
+   uint8_t *buffer;
+   unsigned width;
+   unsigned height;
+   unsigned pitch;
+   char msg[255];
+   bool dupe;     /* Core sent no data, redraw the last frame */
+} thread_video_frame_slot_t;
+
 typedef struct thread_video
 {
    retro_time_t last_time;
@@ -210,14 +231,19 @@ typedef struct thread_video
 
    struct
    {
-      uint64_t count;
+      thread_video_frame_slot_t slots[THREAD_VIDEO_FRAME_BUFFERS];
       slock_t *lock;
-      uint8_t *buffer;
-      unsigned width;
-      unsigned height;
-      unsigned pitch;
-      char msg[255];
-      bool updated;
+      size_t buffer_size;
+      /* Owned by the main thread */
+      unsigned write_idx;
+      /* Owned by the video thread */
+      unsigned read_idx;
+      /* Handoff slot, swapped lock-free between both threads */
+      retro_atomic_int_t ready;
+      /* Video thread is rendering the frame it picked up */
+      retro_atomic_int_t rendering;
+      /* Video thread is (about to be) blocked on cond_thread */
+      retro_atomic_int_t waiting;
       bool within_thread;
    } frame;
 
@@ -264,6 +290,10 @@ bool video_thread_font_init(
 unsigned video_thread_texture_load(void *data,
       custom_command_method_t func);
 
+/* Loads all of 'uploads' on the video thread, in one go */
+bool video_thread_texture_load_batch(
+      video_driver_texture_upload_t *uploads, size_t count);
+
 RETRO_END_DECLS
 
 #endif
@@ -550,6 +550,11 @@ static void gfx_widget_generic_message_free(void)
 
 /* Widget definition */
 
+static bool gfx_widget_generic_message_is_alive(void)
+{
+   return p_w_generic_message_st.status != GFX_WIDGET_GENERIC_MESSAGE_IDLE;
+}
+
 const gfx_widget_t gfx_widget_generic_message = {
    NULL, /* init */
    gfx_widget_generic_message_free,
@@ -557,5 +562,6 @@ const gfx_widget_t gfx_widget_generic_message = {
    NULL, /* context_destroy */
    gfx_widget_generic_message_layout,
    gfx_widget_generic_message_iterate,
-   gfx_widget_generic_message_frame
+   gfx_widget_generic_message_frame,
+   gfx_widget_generic_message_is_alive
 };
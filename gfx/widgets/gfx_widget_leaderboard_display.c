@@ -304,6 +304,12 @@ void gfx_widgets_set_challenge_display(unsigned id, const char* badge)
       video_driver_texture_unload(&old_badge_id);
 }
 
+static bool gfx_widget_leaderboard_display_is_alive(void)
+{
+   gfx_widget_leaderboard_display_state_t *state = &p_w_leaderboard_display_st;
+   return state->tracker_count > 0 || state->challenge_count > 0;
+}
+
 const gfx_widget_t gfx_widget_leaderboard_display = {
    &gfx_widget_leaderboard_display_init,
    &gfx_widget_leaderboard_display_free,
@@ -311,5 +317,6 @@ const gfx_widget_t gfx_widget_leaderboard_display = {
    &gfx_widget_leaderboard_display_context_destroy,
    NULL, /* layout */
    NULL, /* iterate */
-   &gfx_widget_leaderboard_display_frame
+   &gfx_widget_leaderboard_display_frame,
+   gfx_widget_leaderboard_display_is_alive
 };
@@ -479,6 +479,11 @@ static void gfx_widget_libretro_message_free(void)
 
 /* Widget definition */
 
+static bool gfx_widget_libretro_message_is_alive(void)
+{
+   return p_w_libretro_message_st.status != GFX_WIDGET_LIBRETRO_MESSAGE_IDLE;
+}
+
 const gfx_widget_t gfx_widget_libretro_message = {
    NULL, /* init */
    gfx_widget_libretro_message_free,
@@ -486,5 +491,6 @@ const gfx_widget_t gfx_widget_libretro_message = {
    NULL, /* context_destroy */
    gfx_widget_libretro_message_layout,
    gfx_widget_libretro_message_iterate,
-   gfx_widget_libretro_message_frame
+   gfx_widget_libretro_message_frame,
+   gfx_widget_libretro_message_is_alive
 };
@@ -332,6 +332,11 @@ static void gfx_widget_progress_message_free(void)
 
 /* Widget definition */
 
+static bool gfx_widget_progress_message_is_alive(void)
+{
+   return p_w_progress_message_st.active;
+}
+
 const gfx_widget_t gfx_widget_progress_message = {
    NULL, /* init */
    gfx_widget_progress_message_free,
@@ -339,5 +344,6 @@ const gfx_widget_t gfx_widget_progress_message = {
    NULL, /* context_destroy */
    gfx_widget_progress_message_layout,
    NULL, /* iterate */
-   gfx_widget_progress_message_frame
+   gfx_widget_progress_message_frame,
+   gfx_widget_progress_message_is_alive
 };
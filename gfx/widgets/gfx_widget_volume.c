@@ -366,6 +366,11 @@ static void gfx_widget_volume_free(void)
    state->alpha = 0.0f;
 }
 
+static bool gfx_widget_volume_is_alive(void)
+{
+   return p_w_volume_st.alpha > 0.0f;
+}
+
 const gfx_widget_t gfx_widget_volume = {
    NULL, /* init */
    gfx_widget_volume_free,
@@ -373,5 +378,6 @@ const gfx_widget_t gfx_widget_volume = {
    gfx_widget_volume_context_destroy,
    gfx_widget_volume_layout,
    NULL, /* iterate */
-   gfx_widget_volume_frame
+   gfx_widget_volume_frame,
+   gfx_widget_volume_is_alive
 };
@@ -57,6 +57,13 @@
 #endif
 #endif
 
+/* Page-level allocation of large buffers */
+#if defined(HAVE_MMAP) || defined(HAVE_MMAP_WIN32)
+#ifndef HAVE_MEMMAP
+#define HAVE_MEMMAP
+#endif
+#endif
+
 #if _MSC_VER && !defined(__WINRT__)
 #include "../libretro-common/compat/compat_snprintf.c"
 #endif
@@ -93,6 +100,9 @@ COMPATIBILITY
 #include "../libretro-common/compat/compat_fnmatch.c"
 #include "../libretro-common/compat/fopen_utf8.c"
 #include "../libretro-common/memmap/memalign.c"
+#ifdef HAVE_MEMMAP
+#include "../libretro-common/memmap/memmap.c"
+#endif
 
 /*============================================================
 CONSOLE EXTENSIONS
@@ -144,6 +154,7 @@ COMPRESSION
 
 #ifdef HAVE_ZLIB
 #include "../libretro-common/streams/trans_stream_zlib.c"
+#include "../libretro-common/streams/inflate_buffer.c"
 #include "../libretro-common/streams/rzip_stream.c"
 #endif
 
@@ -672,6 +683,9 @@ INPUT
 #include "../tasks/task_audio_mixer.c"
 #endif
 #include "../input/input_keymaps.c"
+#ifdef HAVE_BSV_MOVIE
+#include "../input/bsv/bsv_stream.c"
+#endif
 
 #ifdef HAVE_OVERLAY
 #include "../led/drivers/led_overlay.c"
@@ -842,6 +856,8 @@ INPUT (HID)
 FIFO BUFFER
 ============================================================ */
 #include "../libretro-common/queues/fifo_queue.c"
+#include "../libretro-common/queues/spsc_ring.c"
+#include "../libretro-common/queues/mpsc_queue.c"
 
 /*============================================================
 AUDIO RESAMPLER
@@ -914,6 +930,7 @@ AUDIO
 #include "../audio/drivers/wiiu_audio.c"
 #elif defined(EMSCRIPTEN)
 #include "../audio/drivers/rwebaudio.c"
+#include "../audio/drivers/audioworklet.c"
 #elif defined(PSP) || defined(VITA) || defined(ORBIS)
 #include "../audio/drivers/psp_audio.c"
 #elif defined(PS2)
@@ -963,6 +980,10 @@ AUDIO
 #include "../audio/drivers/pulse.c"
 #endif
 
+#ifdef HAVE_PIPEWIRE
+#include "../audio/drivers/pipewire.c"
+#endif
+
 #ifdef HAVE_AL
 #include "../audio/drivers/openal.c"
 #endif
@@ -988,10 +1009,14 @@ DRIVERS
 #ifdef HAVE_CRTSWITCHRES
 #include "../gfx/video_crt_switch.c"
 #endif
+#if defined(HAVE_MMAP) && !defined(_WIN32)
+#include "../gfx/video_frame_export.c"
+#endif
 #include "../gfx/gfx_animation.c"
 #include "../gfx/gfx_display.c"
 #include "../gfx/gfx_thumbnail_path.c"
 #include "../gfx/gfx_thumbnail.c"
+#include "../gfx/gfx_thumbnail_pack.c"
 #include "../gfx/video_coord_array.c"
 #ifdef HAVE_AUDIOMIXER
 #include "../libretro-common/audio/audio_mixer.c"
@@ -1102,6 +1127,9 @@ FILE
 #include "../libretro-common/file/nbio/nbio_stdio.c"
 #if defined(__linux__)
 #include "../libretro-common/file/nbio/nbio_linux.c"
+#if defined(HAVE_IO_URING)
+#include "../libretro-common/file/nbio/nbio_uring.c"
+#endif
 #endif
 #if defined(HAVE_MMAP) && defined(BSD)
 #include "../libretro-common/file/nbio/nbio_unixmmap.c"
@@ -1185,6 +1213,7 @@ FRONTEND
 #include "../core_info.c"
 #include "../core_backup.c"
 #include "../core_option_manager.c"
+#include "../core_memory_dirty.c"
 
 #if defined(HAVE_NETWORKING)
 #include "../core_updater_list.c"
@@ -1209,6 +1238,8 @@ GIT
 RETROARCH
 ============================================================ */
 #include "../retroarch.c"
+#include "../performance_counters.c"
+#include "../session_runner.c"
 #include "../command.c"
 #include "../libretro-common/queues/task_queue.c"
 
@@ -1275,6 +1306,7 @@ THREAD
 #endif
 
 #include "../libretro-common/rthreads/rthreads.c"
+#include "../libretro-common/rthreads/tpool.c"
 #include "../gfx/video_thread_wrapper.c"
 #include "../audio/audio_thread_wrapper.c"
 #endif
@@ -1299,6 +1331,7 @@ NETPLAY
 #endif
 #include "../tasks/task_http.c"
 #include "../tasks/task_netplay_lan_scan.c"
+#include "../tasks/task_netplay_rooms.c"
 #include "../tasks/task_netplay_nat_traversal.c"
 #include "../tasks/task_bluetooth.c"
 #include "../tasks/task_wifi.c"
@@ -1318,10 +1351,12 @@ DATA RUNLOOP
 #include "../tasks/task_patch.c"
 #endif
 #include "../tasks/task_save.c"
+#include "../tasks/task_config_save.c"
 #include "../tasks/task_image.c"
 #include "../tasks/task_file_transfer.c"
 #include "../tasks/task_playlist_manager.c"
 #include "../tasks/task_manual_content_scan.c"
+#include "../tasks/task_content_prefetch.c"
 #include "../tasks/task_core_backup.c"
 #ifdef HAVE_ZLIB
 #include "../tasks/task_decompress.c"
@@ -1345,6 +1380,7 @@ SCREENSHOTS
 PLAYLISTS
 ============================================================ */
 #include "../playlist.c"
+#include "../content_hash_cache.c"
 
 /*============================================================
 MENU
@@ -0,0 +1,1121 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_endianness.h>
+#include <array/rbuf.h>
+#include <streams/file_stream.h>
+#include <streams/trans_stream.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#include "bsv_stream.h"
+
+#include "../../state_manager.h"
+#include "../../verbosity.h"
+
+/* Layout, all integers little endian except the magic:
+ *
+ * header       : magic, content CRC, state size,
+ *                keyframe interval, flags, reserved
+ * block        : type, flags, frame (low, high),
+ *                raw size, stored size, payload
+ * trailer      : index magic, index block offset
+ *                (low, high)
+ *
+ * The first block is the starting state, then each
+ * segment holds a keyframe block (a patch that turns
+ * the starting state into the keyframe, in the native
+ * endian format of state_manager_raw_compress) and an
+ * input block. The index block lists where each
+ * segment starts. Files cut short (e.g. by a crash)
+ * have no index, which then gets rebuilt from the
+ * block headers. */
+
+#define BSV2_INDEX_MAGIC       0x42535658
+#define BSV2_HEADER_SIZE       (6 * sizeof(uint32_t))
+#define BSV2_BLOCK_HEADER_SIZE (6 * sizeof(uint32_t))
+#define BSV2_TRAILER_SIZE      (3 * sizeof(uint32_t))
+
+/* Header flags */
+#define BSV2_FLAG_BIG_ENDIAN   (1 << 0)
+
+/* Block flags */
+#define BSV2_BLOCK_ZLIB        (1 << 0)
+
+/* Sanity limit for blocks read from a file */
+#define BSV2_MAX_BLOCK_SIZE    (512 * 1024 * 1024)
+
+enum bsv2_block_type
+{
+   BSV2_BLOCK_STATE    = 'S',
+   BSV2_BLOCK_KEYFRAME = 'K',
+   BSV2_BLOCK_INPUT    = 'I',
+   BSV2_BLOCK_INDEX    = 'X'
+};
+
+typedef struct bsv2_block
+{
+   uint64_t frame;
+   uint32_t type;
+   uint32_t flags;
+   uint32_t raw_size;
+   uint32_t stored_size;
+} bsv2_block_t;
+
+typedef struct bsv2_index_entry
+{
+   uint64_t frame;
+   /* Offset of the first block of the segment */
+   int64_t offset;
+} bsv2_index_entry_t;
+
+typedef struct bsv2_job
+{
+   struct bsv2_job *next;
+   uint8_t *data;
+   uint64_t frame;
+   size_t size;
+   uint32_t type;
+} bsv2_job_t;
+
+struct bsv_stream
+{
+   RFILE *file;
+   bsv_stream_serialize_t serialize;
+   bsv_stream_unserialize_t unserialize;
+
+   /* Starting state, and the keyframe of the current
+    * segment, both from state_manager_raw_alloc() */
+   uint8_t *base;
+   uint8_t *keyframe;
+   /* Keyframe patch, written by the worker when
+    * recording */
+   uint8_t *patch;
+   /* Compressed block scratch */
+   uint8_t *zbuf;
+   size_t zbuf_size;
+   void *zstream;
+   const struct trans_stream_backend *zbackend;
+
+   /* Input of the current segment; 'offsets' holds
+    * the first sample of each of its frames */
+   int16_t *samples;
+   uint32_t *offsets;
+   bsv2_index_entry_t *index;
+
+#ifdef HAVE_THREADS
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+#endif
+   bsv2_job_t *jobs;
+   bsv2_job_t *jobs_tail;
+
+   uint64_t frame;
+   uint64_t seg_start;
+   size_t seg_index;
+   size_t state_size;
+   size_t pos;
+   size_t end_pos;
+   unsigned interval;
+
+#ifdef HAVE_THREADS
+   bool quit;
+#endif
+   bool recording;
+   bool started;
+   bool ended;
+   bool can_seek;
+   bool failed;
+};
+
+static void bsv2_put32(uint8_t *out, uint32_t val)
+{
+   val = swap_if_big32(val);
+   memcpy(out, &val, sizeof(val));
+}
+
+static uint32_t bsv2_get32(const uint8_t *in)
+{
+   uint32_t val;
+   memcpy(&val, in, sizeof(val));
+   return swap_if_big32(val);
+}
+
+static bool bsv2_host_is_big_endian(void)
+{
+   return swap_if_big32(1) != 1;
+}
+
+/* Writes a block at the current position, compressing
+ * it first when that saves space */
+static bool bsv2_write_block(bsv_stream_t *stream,
+      uint32_t type, uint64_t frame, const uint8_t *data, size_t size)
+{
+   uint8_t header[BSV2_BLOCK_HEADER_SIZE];
+   const uint8_t *payload = data;
+   uint32_t stored_size   = (uint32_t)size;
+   uint32_t flags         = 0;
+
+   if (stream->zbackend && size > 64)
+   {
+      size_t bound = size + size / 8 + 64;
+      uint32_t rd  = 0;
+      uint32_t wn  = 0;
+      enum trans_stream_error err = TRANS_STREAM_ERROR_NONE;
+
+      if (bound > stream->zbuf_size)
+      {
+         uint8_t *zbuf = (uint8_t*)realloc(stream->zbuf, bound);
+         if (zbuf)
+         {
+            stream->zbuf      = zbuf;
+            stream->zbuf_size = bound;
+         }
+      }
+
+      if (!stream->zstream)
+         stream->zstream = stream->zbackend->stream_new();
+
+      if (stream->zstream && stream->zbuf_size >= bound)
+      {
+         stream->zbackend->set_in(stream->zstream, data, (uint32_t)size);
+         stream->zbackend->set_out(stream->zstream,
+               stream->zbuf, (uint32_t)stream->zbuf_size);
+
+         if (     stream->zbackend->trans(stream->zstream, true,
+                     &rd, &wn, &err)
+               && err == TRANS_STREAM_ERROR_NONE)
+         {
+            if (wn < size)
+            {
+               payload     = stream->zbuf;
+               stored_size = wn;
+               flags      |= BSV2_BLOCK_ZLIB;
+            }
+         }
+         else
+         {
+            /* Don't reuse a stream left mid-way */
+            stream->zbackend->stream_free(stream->zstream);
+            stream->zstream = NULL;
+         }
+      }
+   }
+
+   bsv2_put32(header +  0, type);
+   bsv2_put32(header +  4, flags);
+   bsv2_put32(header +  8, (uint32_t)frame);
+   bsv2_put32(header + 12, (uint32_t)(frame >> 32));
+   bsv2_put32(header + 16, (uint32_t)size);
+   bsv2_put32(header + 20, stored_size);
+
+   if (filestream_write(stream->file, header, sizeof(header))
+         != sizeof(header))
+      return false;
+   if (stored_size && filestream_write(stream->file,
+            payload, stored_size) != stored_size)
+      return false;
+   return true;
+}
+
+static void bsv2_index_segment(bsv_stream_t *stream, uint64_t frame)
+{
+   size_t count = RBUF_LEN(stream->index);
+   bsv2_index_entry_t entry;
+
+   if (count && stream->index[count - 1].frame == frame)
+      return;
+
+   entry.frame  = frame;
+   entry.offset = filestream_tell(stream->file);
+   RBUF_PUSH(stream->index, entry);
+}
+
+static void bsv2_job_process(bsv_stream_t *stream, bsv2_job_t *job)
+{
+   const uint8_t *data = job->data;
+   size_t size         = job->size;
+
+   if (stream->failed)
+      return;
+
+   bsv2_index_segment(stream, job->frame);
+
+   if (job->type == BSV2_BLOCK_KEYFRAME)
+   {
+      /* Patch that turns the starting state into this
+       * keyframe, so that each one decodes on its own */
+      size = state_manager_raw_compress(job->data, stream->base,
+            stream->state_size, stream->patch);
+      data = stream->patch;
+   }
+
+   if (!bsv2_write_block(stream, job->type, job->frame, data, size))
+   {
+      RARCH_ERR("[BSV]: Failed to write movie data.\n");
+      stream->failed = true;
+   }
+}
+
+#ifdef HAVE_THREADS
+static void bsv2_worker_thread(void *data)
+{
+   bsv_stream_t *stream = (bsv_stream_t*)data;
+
+   slock_lock(stream->lock);
+
+   for (;;)
+   {
+      bsv2_job_t *job = stream->jobs;
+
+      if (!job)
+      {
+         if (stream->quit)
+            break;
+         scond_wait(stream->cond, stream->lock);
+         continue;
+      }
+
+      if (!(stream->jobs = job->next))
+         stream->jobs_tail = NULL;
+      slock_unlock(stream->lock);
+
+      bsv2_job_process(stream, job);
+      free(job->data);
+      free(job);
+
+      slock_lock(stream->lock);
+   }
+
+   slock_unlock(stream->lock);
+}
+#endif
+
+/* Takes ownership of 'data' */
+static void bsv2_job_push(bsv_stream_t *stream,
+      uint32_t type, uint64_t frame, uint8_t *data, size_t size)
+{
+   bsv2_job_t *job = (bsv2_job_t*)calloc(1, sizeof(*job));
+
+   if (!job)
+   {
+      free(data);
+      stream->failed = true;
+      return;
+   }
+
+   job->type  = type;
+   job->frame = frame;
+   job->data  = data;
+   job->size  = size;
+
+#ifdef HAVE_THREADS
+   if (stream->thread)
+   {
+      slock_lock(stream->lock);
+      if (stream->jobs_tail)
+         stream->jobs_tail->next = job;
+      else
+         stream->jobs            = job;
+      stream->jobs_tail          = job;
+      scond_signal(stream->cond);
+      slock_unlock(stream->lock);
+      return;
+   }
+#endif
+
+   bsv2_job_process(stream, job);
+   free(job->data);
+   free(job);
+}
+
+/* Queues the input of the current segment */
+static void bsv2_segment_end(bsv_stream_t *stream)
+{
+   size_t i;
+   size_t frames  = RBUF_LEN(stream->offsets);
+   size_t samples = RBUF_LEN(stream->samples);
+   size_t size    = sizeof(uint32_t) * (1 + frames)
+      + sizeof(int16_t) * samples;
+   uint8_t *data  = NULL;
+   uint8_t *out   = NULL;
+
+   if (!frames)
+      return;
+
+   if (!(data = (uint8_t*)malloc(size)))
+   {
+      stream->failed = true;
+      return;
+   }
+
+   out = data;
+   bsv2_put32(out, (uint32_t)frames);
+   out += sizeof(uint32_t);
+   for (i = 0; i < frames; i++, out += sizeof(uint32_t))
+      bsv2_put32(out, stream->offsets[i]);
+   for (i = 0; i < samples; i++, out += sizeof(int16_t))
+   {
+      int16_t val = swap_if_big16(stream->samples[i]);
+      memcpy(out, &val, sizeof(val));
+   }
+
+   bsv2_job_push(stream, BSV2_BLOCK_INPUT, stream->seg_start, data, size);
+
+   RBUF_CLEAR(stream->offsets);
+   RBUF_CLEAR(stream->samples);
+}
+
+static bool bsv2_read_block_header(RFILE *file, bsv2_block_t *block)
+{
+   uint8_t header[BSV2_BLOCK_HEADER_SIZE];
+
+   if (filestream_read(file, header, sizeof(header)) != sizeof(header))
+      return false;
+
+   block->type        = bsv2_get32(header +  0);
+   block->flags       = bsv2_get32(header +  4);
+   block->frame       = bsv2_get32(header +  8)
+      | ((uint64_t)bsv2_get32(header + 12) << 32);
+   block->raw_size    = bsv2_get32(header + 16);
+   block->stored_size = bsv2_get32(header + 20);
+
+   return block->raw_size    <= BSV2_MAX_BLOCK_SIZE
+       && block->stored_size <= BSV2_MAX_BLOCK_SIZE;
+}
+
+/* Reads the payload following a block header,
+ * returns a buffer of block->raw_size bytes */
+static uint8_t *bsv2_read_block_payload(bsv_stream_t *stream,
+      const bsv2_block_t *block)
+{
+   uint8_t *out = (uint8_t*)malloc(block->raw_size ? block->raw_size : 1);
+
+   if (!out)
+      return NULL;
+
+   if (!(block->flags & BSV2_BLOCK_ZLIB))
+   {
+      if (     block->stored_size != block->raw_size
+            || filestream_read(stream->file, out, block->raw_size)
+            != block->raw_size)
+         goto error;
+      return out;
+   }
+
+   if (!stream->zbackend)
+      goto error;
+
+   if (block->stored_size > stream->zbuf_size)
+   {
+      uint8_t *zbuf = (uint8_t*)realloc(stream->zbuf, block->stored_size);
+      if (!zbuf)
+         goto error;
+      stream->zbuf      = zbuf;
+      stream->zbuf_size = block->stored_size;
+   }
+
+   if (filestream_read(stream->file, stream->zbuf, block->stored_size)
+         != block->stored_size)
+      goto error;
+
+   if (!stream->zstream)
+      stream->zstream = stream->zbackend->stream_new();
+
+   if (stream->zstream)
+   {
+      uint32_t rd = 0;
+      uint32_t wn = 0;
+      enum trans_stream_error err = TRANS_STREAM_ERROR_NONE;
+
+      stream->zbackend->set_in(stream->zstream,
+            stream->zbuf, block->stored_size);
+      stream->zbackend->set_out(stream->zstream, out, block->raw_size);
+
+      if (     stream->zbackend->trans(stream->zstream, true, &rd, &wn, &err)
+            && err == TRANS_STREAM_ERROR_NONE
+            && wn  == block->raw_size)
+         return out;
+
+      stream->zbackend->stream_free(stream->zstream);
+      stream->zstream = NULL;
+   }
+
+error:
+   free(out);
+   return NULL;
+}
+
+static bool bsv2_skip_block_payload(RFILE *file, const bsv2_block_t *block)
+{
+   return filestream_seek(file, block->stored_size,
+         RETRO_VFS_SEEK_POSITION_CURRENT) == 0;
+}
+
+/* Loads the index from the end of the file, or else
+ * rebuilds it from the block headers */
+static void bsv2_load_index(bsv_stream_t *stream, int64_t first_block)
+{
+   bsv2_block_t block;
+   uint8_t trailer[BSV2_TRAILER_SIZE];
+   int64_t size = filestream_get_size(stream->file);
+
+   RBUF_CLEAR(stream->index);
+
+   if (     size >= first_block + (int64_t)BSV2_TRAILER_SIZE
+         && filestream_seek(stream->file, size - BSV2_TRAILER_SIZE,
+            RETRO_VFS_SEEK_POSITION_START) == 0
+         && filestream_read(stream->file, trailer, sizeof(trailer))
+            == sizeof(trailer)
+         && bsv2_get32(trailer) == BSV2_INDEX_MAGIC)
+   {
+      int64_t offset = bsv2_get32(trailer + 4)
+         | ((int64_t)bsv2_get32(trailer + 8) << 32);
+
+      if (     filestream_seek(stream->file, offset,
+                  RETRO_VFS_SEEK_POSITION_START) == 0
+            && bsv2_read_block_header(stream->file, &block)
+            && block.type == BSV2_BLOCK_INDEX)
+      {
+         uint8_t *data = bsv2_read_block_payload(stream, &block);
+         uint32_t i, count;
+
+         if (data && block.raw_size >= sizeof(uint32_t))
+         {
+            count = bsv2_get32(data);
+
+            if (count <= (block.raw_size - sizeof(uint32_t))
+                  / (4 * sizeof(uint32_t)))
+            {
+               const uint8_t *in = data + sizeof(uint32_t);
+
+               for (i = 0; i < count; i++, in += 4 * sizeof(uint32_t))
+               {
+                  bsv2_index_entry_t entry;
+                  entry.frame  = bsv2_get32(in)
+                     | ((uint64_t)bsv2_get32(in + 4) << 32);
+                  entry.offset = bsv2_get32(in + 8)
+                     | ((int64_t)bsv2_get32(in + 12) << 32);
+                  RBUF_PUSH(stream->index, entry);
+               }
+            }
+         }
+
+         free(data);
+
+         if (RBUF_LEN(stream->index))
+            return;
+      }
+   }
+
+   RARCH_WARN("[BSV]: Movie has no index, scanning it.\n");
+
+   if (filestream_seek(stream->file, first_block,
+            RETRO_VFS_SEEK_POSITION_START) != 0)
+      return;
+
+   for (;;)
+   {
+      int64_t offset = filestream_tell(stream->file);
+
+      if (!bsv2_read_block_header(stream->file, &block))
+         break;
+      if (block.type == BSV2_BLOCK_INDEX)
+         break;
+      /* A block that got cut off ends the movie */
+      if (offset + (int64_t)BSV2_BLOCK_HEADER_SIZE
+            + block.stored_size > size)
+         break;
+
+      if (     block.type == BSV2_BLOCK_STATE
+            || block.type == BSV2_BLOCK_KEYFRAME
+            || block.type == BSV2_BLOCK_INPUT)
+      {
+         size_t count = RBUF_LEN(stream->index);
+
+         if (!count || stream->index[count - 1].frame != block.frame)
+         {
+            bsv2_index_entry_t entry;
+            entry.frame  = block.frame;
+            entry.offset = offset;
+            RBUF_PUSH(stream->index, entry);
+         }
+      }
+
+      if (!bsv2_skip_block_payload(stream->file, &block))
+         break;
+   }
+}
+
+/* Returns the last segment starting at or before 'frame' */
+static size_t bsv2_find_segment(bsv_stream_t *stream, uint64_t frame)
+{
+   size_t lo = 0;
+   size_t hi = RBUF_LEN(stream->index);
+
+   while (hi - lo > 1)
+   {
+      size_t mid = lo + (hi - lo) / 2;
+      if (stream->index[mid].frame <= frame)
+         lo = mid;
+      else
+         hi = mid;
+   }
+
+   return lo;
+}
+
+static bool bsv2_decode_input(bsv_stream_t *stream,
+      const uint8_t *data, size_t size)
+{
+   size_t i, samples;
+   uint32_t frames;
+   const uint8_t *in;
+
+   if (size < sizeof(uint32_t))
+      return false;
+
+   frames = bsv2_get32(data);
+
+   if (frames > (size - sizeof(uint32_t)) / sizeof(uint32_t))
+      return false;
+
+   samples = (size - sizeof(uint32_t) * (1 + frames)) / sizeof(int16_t);
+
+   if (     !RBUF_TRYFIT(stream->offsets, frames)
+         || !RBUF_TRYFIT(stream->samples, samples))
+      return false;
+
+   in = data + sizeof(uint32_t);
+   for (i = 0; i < frames; i++, in += sizeof(uint32_t))
+   {
+      uint32_t offset = bsv2_get32(in);
+      /* Offsets past the end read as empty frames */
+      RBUF_PUSH(stream->offsets,
+            offset < samples ? offset : (uint32_t)samples);
+   }
+
+   RBUF_RESIZE(stream->samples, samples);
+   for (i = 0; i < samples; i++, in += sizeof(int16_t))
+   {
+      int16_t val;
+      memcpy(&val, in, sizeof(val));
+      stream->samples[i] = swap_if_big16(val);
+   }
+
+   return true;
+}
+
+/* Reads the input of a segment. If 'keyframe' is set,
+ * also decodes its keyframe into stream->keyframe. */
+static bool bsv2_load_segment(bsv_stream_t *stream, size_t seg,
+      bool keyframe)
+{
+   bsv2_block_t block;
+   bool have_keyframe = false;
+
+   RBUF_CLEAR(stream->samples);
+   RBUF_CLEAR(stream->offsets);
+
+   if (seg >= RBUF_LEN(stream->index))
+      return false;
+
+   stream->seg_index = seg;
+   stream->seg_start = stream->index[seg].frame;
+
+   if (filestream_seek(stream->file, stream->index[seg].offset,
+            RETRO_VFS_SEEK_POSITION_START) != 0)
+      return false;
+
+   while (bsv2_read_block_header(stream->file, &block))
+   {
+      if (block.frame != stream->seg_start)
+         break;
+
+      if (block.type == BSV2_BLOCK_INPUT)
+      {
+         uint8_t *data = bsv2_read_block_payload(stream, &block);
+
+         /* A damaged input block leaves the segment empty,
+          * its keyframe remains usable */
+         if (!data || !bsv2_decode_input(stream, data, block.raw_size))
+         {
+            RBUF_CLEAR(stream->samples);
+            RBUF_CLEAR(stream->offsets);
+         }
+
+         free(data);
+         break;
+      }
+
+      if (keyframe && block.type == BSV2_BLOCK_STATE)
+      {
+         memcpy(stream->keyframe, stream->base, stream->state_size);
+         have_keyframe = true;
+      }
+      else if (keyframe && block.type == BSV2_BLOCK_KEYFRAME)
+      {
+         uint8_t *patch = bsv2_read_block_payload(stream, &block);
+
+         memcpy(stream->keyframe, stream->base, stream->state_size);
+         have_keyframe  = patch
+            && state_manager_raw_decompress_checked(patch,
+                  block.raw_size, stream->keyframe, stream->state_size);
+         free(patch);
+         continue;
+      }
+
+      if (!bsv2_skip_block_payload(stream->file, &block))
+         break;
+   }
+
+   return !keyframe || have_keyframe;
+}
+
+bool bsv_stream_probe(const char *path)
+{
+   uint32_t magic = 0;
+   RFILE *file    = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   filestream_read(file, &magic, sizeof(magic));
+   filestream_close(file);
+
+   return swap_if_little32(magic) == BSV2_MAGIC;
+}
+
+static bsv_stream_t *bsv2_stream_new(const char *path,
+      bool recording, size_t state_size)
+{
+   bsv_stream_t *stream = (bsv_stream_t*)calloc(1, sizeof(*stream));
+
+   if (!stream)
+      return NULL;
+
+   stream->recording  = recording;
+   stream->state_size = state_size;
+   stream->interval   = BSV_STREAM_KEYFRAME_INTERVAL;
+   stream->zbackend   = recording
+      ? trans_stream_get_zlib_deflate_backend()
+      : trans_stream_get_zlib_inflate_backend();
+
+   if (!(stream->file = filestream_open(path,
+               recording
+               ? RETRO_VFS_FILE_ACCESS_WRITE
+               : RETRO_VFS_FILE_ACCESS_READ,
+               RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+   {
+      free(stream);
+      return NULL;
+   }
+
+   if (state_size)
+   {
+      stream->base     = (uint8_t*)state_manager_raw_alloc(state_size, 0);
+      stream->keyframe = (uint8_t*)state_manager_raw_alloc(state_size, 1);
+      stream->patch    = (uint8_t*)malloc(
+            state_manager_raw_maxsize(state_size));
+
+      if (!stream->base || !stream->keyframe || !stream->patch)
+      {
+         bsv_stream_close(stream);
+         return NULL;
+      }
+   }
+
+   return stream;
+}
+
+bsv_stream_t *bsv_stream_open_write(const char *path,
+      uint32_t crc, size_t state_size,
+      bsv_stream_serialize_t serialize,
+      bsv_stream_unserialize_t unserialize)
+{
+   uint8_t header[BSV2_HEADER_SIZE];
+   /* The magic reads as "BSV2" in a hex editor */
+   uint32_t magic       = swap_if_little32(BSV2_MAGIC);
+   bsv_stream_t *stream = bsv2_stream_new(path, true, state_size);
+
+   if (!stream)
+      return NULL;
+
+   stream->serialize   = serialize;
+   stream->unserialize = unserialize;
+
+   memcpy(header, &magic, sizeof(magic));
+   bsv2_put32(header +  4, crc);
+   bsv2_put32(header +  8, (uint32_t)state_size);
+   bsv2_put32(header + 12, stream->interval);
+   bsv2_put32(header + 16,
+         bsv2_host_is_big_endian() ? BSV2_FLAG_BIG_ENDIAN : 0);
+   bsv2_put32(header + 20, 0);
+
+   if (filestream_write(stream->file, header, sizeof(header))
+         != sizeof(header))
+      goto error;
+
+   if (state_size)
+   {
+      if (!serialize(stream->base, state_size))
+         goto error;
+      memcpy(stream->keyframe, stream->base, state_size);
+
+      bsv2_index_segment(stream, 0);
+      if (!bsv2_write_block(stream, BSV2_BLOCK_STATE, 0,
+               stream->base, state_size))
+         goto error;
+   }
+
+#ifdef HAVE_THREADS
+   stream->lock   = slock_new();
+   stream->cond   = scond_new();
+   if (stream->lock && stream->cond)
+      stream->thread = sthread_create(bsv2_worker_thread, stream);
+#endif
+
+   return stream;
+
+error:
+   RARCH_ERR("[BSV]: Failed to start movie \"%s\".\n", path);
+   bsv_stream_close(stream);
+   return NULL;
+}
+
+bsv_stream_t *bsv_stream_open_read(const char *path,
+      uint32_t crc, size_t state_size,
+      bsv_stream_unserialize_t unserialize)
+{
+   uint8_t header[BSV2_HEADER_SIZE];
+   bsv2_block_t block;
+   uint32_t magic;
+   uint32_t file_state_size;
+   uint32_t flags;
+   int64_t first_block;
+   bsv_stream_t *stream = bsv2_stream_new(path, false, 0);
+
+   if (!stream)
+      return NULL;
+
+   stream->unserialize = unserialize;
+
+   if (filestream_read(stream->file, header, sizeof(header))
+         != sizeof(header))
+      goto error;
+
+   memcpy(&magic, header, sizeof(magic));
+   if (swap_if_little32(magic) != BSV2_MAGIC)
+      goto error;
+
+   if (crc && bsv2_get32(header + 4) != crc)
+      RARCH_WARN("[BSV]: Content CRC32 does not match the movie.\n");
+
+   file_state_size  = bsv2_get32(header + 8);
+   flags            = bsv2_get32(header + 16);
+   if (bsv2_get32(header + 12))
+      stream->interval = bsv2_get32(header + 12);
+   first_block      = filestream_tell(stream->file);
+
+   if (file_state_size)
+   {
+      uint8_t *data = NULL;
+
+      if (     !bsv2_read_block_header(stream->file, &block)
+            || block.type     != BSV2_BLOCK_STATE
+            || block.raw_size != file_state_size)
+         goto error;
+
+      stream->state_size = file_state_size;
+      stream->base       = (uint8_t*)state_manager_raw_alloc(
+            file_state_size, 0);
+      stream->keyframe   = (uint8_t*)state_manager_raw_alloc(
+            file_state_size, 1);
+
+      if (     !stream->base || !stream->keyframe
+            || !(data = bsv2_read_block_payload(stream, &block)))
+         goto error;
+
+      memcpy(stream->base, data, file_state_size);
+      free(data);
+
+      if (file_state_size == state_size)
+      {
+         unserialize(stream->base, file_state_size);
+         /* Keyframe patches are native endian */
+         stream->can_seek =
+            !(flags & BSV2_FLAG_BIG_ENDIAN) == !bsv2_host_is_big_endian();
+      }
+      else
+         RARCH_WARN("[BSV]: Movie was recorded with a different "
+               "serializer version, seeking is disabled.\n");
+   }
+
+   bsv2_load_index(stream, first_block);
+
+   if (!RBUF_LEN(stream->index) || !bsv2_load_segment(stream, 0, false))
+      stream->ended = true;
+
+   return stream;
+
+error:
+   RARCH_ERR("[BSV]: \"%s\" is not a valid BSV2 movie.\n", path);
+   bsv_stream_close(stream);
+   return NULL;
+}
+
+static void bsv2_write_index(bsv_stream_t *stream)
+{
+   size_t i;
+   uint8_t trailer[BSV2_TRAILER_SIZE];
+   size_t count   = RBUF_LEN(stream->index);
+   size_t size    = sizeof(uint32_t) * (1 + 4 * count);
+   uint8_t *data  = (uint8_t*)malloc(size);
+   uint8_t *out   = data;
+   int64_t offset = filestream_tell(stream->file);
+
+   if (!data)
+      return;
+
+   bsv2_put32(out, (uint32_t)count);
+   out += sizeof(uint32_t);
+   for (i = 0; i < count; i++, out += 4 * sizeof(uint32_t))
+   {
+      bsv2_put32(out,      (uint32_t)stream->index[i].frame);
+      bsv2_put32(out +  4, (uint32_t)(stream->index[i].frame >> 32));
+      bsv2_put32(out +  8, (uint32_t)stream->index[i].offset);
+      bsv2_put32(out + 12, (uint32_t)(stream->index[i].offset >> 32));
+   }
+
+   if (bsv2_write_block(stream, BSV2_BLOCK_INDEX, 0, data, size))
+   {
+      bsv2_put32(trailer,     BSV2_INDEX_MAGIC);
+      bsv2_put32(trailer + 4, (uint32_t)offset);
+      bsv2_put32(trailer + 8, (uint32_t)(offset >> 32));
+      filestream_write(stream->file, trailer, sizeof(trailer));
+   }
+
+   free(data);
+}
+
+void bsv_stream_close(bsv_stream_t *stream)
+{
+   if (!stream)
+      return;
+
+   if (stream->recording && stream->file && stream->started)
+      bsv2_segment_end(stream);
+
+#ifdef HAVE_THREADS
+   if (stream->thread)
+   {
+      slock_lock(stream->lock);
+      stream->quit = true;
+      scond_signal(stream->cond);
+      slock_unlock(stream->lock);
+      sthread_join(stream->thread);
+   }
+   if (stream->cond)
+      scond_free(stream->cond);
+   if (stream->lock)
+      slock_free(stream->lock);
+#endif
+
+   /* Only left over if the worker never started */
+   while (stream->jobs)
+   {
+      bsv2_job_t *job = stream->jobs;
+      stream->jobs    = job->next;
+      bsv2_job_process(stream, job);
+      free(job->data);
+      free(job);
+   }
+
+   if (stream->recording && stream->file && !stream->failed)
+      bsv2_write_index(stream);
+
+   if (stream->file)
+      filestream_close(stream->file);
+   if (stream->zstream)
+      stream->zbackend->stream_free(stream->zstream);
+
+   RBUF_FREE(stream->samples);
+   RBUF_FREE(stream->offsets);
+   RBUF_FREE(stream->index);
+   free(stream->zbuf);
+   free(stream->patch);
+   free(stream->keyframe);
+   free(stream->base);
+   free(stream);
+}
+
+void bsv_stream_frame_start(bsv_stream_t *stream)
+{
+   size_t rel;
+
+   if (stream->started)
+      stream->frame++;
+   stream->started = true;
+
+   if (stream->recording)
+   {
+      if (stream->frame - stream->seg_start >= stream->interval)
+      {
+         bsv2_segment_end(stream);
+         stream->seg_start = stream->frame;
+
+         if (stream->state_size)
+         {
+            uint8_t *state = (uint8_t*)state_manager_raw_alloc(
+                  stream->state_size, 1);
+
+            if (state && stream->serialize(stream->keyframe,
+                     stream->state_size))
+            {
+               memcpy(state, stream->keyframe, stream->state_size);
+               bsv2_job_push(stream, BSV2_BLOCK_KEYFRAME,
+                     stream->frame, state, stream->state_size);
+            }
+            else
+               free(state);
+         }
+      }
+
+      RBUF_PUSH(stream->offsets, (uint32_t)RBUF_LEN(stream->samples));
+      return;
+   }
+
+   if (stream->ended)
+      return;
+
+   rel = (size_t)(stream->frame - stream->seg_start);
+
+   while (rel >= RBUF_LEN(stream->offsets))
+   {
+      if (!bsv2_load_segment(stream, stream->seg_index + 1, false))
+      {
+         stream->ended = true;
+         return;
+      }
+      rel = (size_t)(stream->frame - stream->seg_start);
+   }
+
+   stream->pos     = stream->offsets[rel];
+   stream->end_pos = (rel + 1 < RBUF_LEN(stream->offsets))
+      ? stream->offsets[rel + 1] : RBUF_LEN(stream->samples);
+}
+
+void bsv_stream_write_input(bsv_stream_t *stream, int16_t value)
+{
+   if (!stream->started)
+      bsv_stream_frame_start(stream);
+   RBUF_PUSH(stream->samples, value);
+}
+
+bool bsv_stream_read_input(bsv_stream_t *stream, int16_t *value)
+{
+   if (!stream->started)
+      bsv_stream_frame_start(stream);
+
+   if (stream->ended)
+      return false;
+
+   /* A frame asking for more input than was recorded
+    * gets zeros, the next frame starts in sync again */
+   *value = (stream->pos < stream->end_pos)
+      ? stream->samples[stream->pos++] : 0;
+   return true;
+}
+
+void bsv_stream_rewind(bsv_stream_t *stream, bool first_rewind)
+{
+   uint64_t target = stream->frame;
+
+   if (!stream->started)
+      return;
+
+   /* The first rewound frame replays the last one */
+   if (!first_rewind && target > 0)
+      target--;
+
+   if (stream->recording)
+   {
+      if (target < stream->seg_start)
+      {
+         /* Frames before the keyframe have been written out
+          * already, restart the segment from its keyframe */
+         if (stream->state_size)
+            stream->unserialize(stream->keyframe, stream->state_size);
+         target = stream->seg_start;
+      }
+
+      if (target - stream->seg_start < RBUF_LEN(stream->offsets))
+      {
+         size_t rel = (size_t)(target - stream->seg_start);
+         RBUF_RESIZE(stream->samples, stream->offsets[rel]);
+         RBUF_RESIZE(stream->offsets, rel);
+      }
+   }
+   else if (target < stream->seg_start)
+      bsv2_load_segment(stream, bsv2_find_segment(stream, target), false);
+
+   stream->frame   = target;
+   stream->started = false;
+   stream->ended   = false;
+}
+
+int64_t bsv_stream_seek(bsv_stream_t *stream, uint64_t frame)
+{
+   size_t seg;
+
+   if (!bsv_stream_can_seek(stream))
+      return -1;
+
+   seg = bsv2_find_segment(stream, frame);
+
+   if (!bsv2_load_segment(stream, seg, true))
+   {
+      /* Leave playback where it was */
+      bsv2_load_segment(stream,
+            bsv2_find_segment(stream, stream->frame), false);
+      return -1;
+   }
+
+   if (!stream->unserialize(stream->keyframe, stream->state_size))
+      return -1;
+
+   stream->frame   = stream->seg_start;
+   stream->started = false;
+   stream->ended   = false;
+
+   return (int64_t)stream->frame;
+}
+
+bool bsv_stream_can_seek(bsv_stream_t *stream)
+{
+   return !stream->recording && stream->can_seek
+      && RBUF_LEN(stream->index);
+}
+
+uint64_t bsv_stream_get_frame(bsv_stream_t *stream)
+{
+   return stream->frame;
+}
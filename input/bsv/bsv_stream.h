@@ -0,0 +1,135 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __BSV_STREAM_H
+#define __BSV_STREAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* BSV2 movies
+ *
+ * A BSV2 file is a header, the starting savestate and
+ * then one segment per BSV_STREAM_KEYFRAME_INTERVAL
+ * frames. Each segment is a keyframe savestate, stored
+ * as a patch against the starting state, followed by
+ * the input of its frames. Blocks are zlib compressed
+ * when available, and an index at the end of the file
+ * lets playback jump to any segment without replaying
+ * the ones before it.
+ *
+ * Input is buffered per segment, compression and
+ * writes happen on a worker thread. */
+
+#define BSV2_MAGIC                     0x42535632
+
+#ifndef BSV_STREAM_KEYFRAME_INTERVAL
+#define BSV_STREAM_KEYFRAME_INTERVAL   600
+#endif
+
+typedef struct bsv_stream bsv_stream_t;
+
+/* Savestate callbacks, return false on failure */
+typedef bool (*bsv_stream_serialize_t)(void *data, size_t size);
+typedef bool (*bsv_stream_unserialize_t)(const void *data, size_t size);
+
+/* Returns true if 'path' starts with a BSV2 header */
+bool bsv_stream_probe(const char *path);
+
+/**
+ * bsv_stream_open_write:
+ * @path               : movie file to create
+ * @crc                : CRC32 of the content
+ * @state_size         : savestate size, 0 if the core
+ *                       can't serialize
+ * @serialize          : serializes the core into a
+ *                       @state_size buffer
+ * @unserialize        : restores a state, used when
+ *                       rewinding past a keyframe
+ *
+ * Starts recording, the current core state becoming
+ * the starting state of the movie.
+ *
+ * Returns: the stream, or NULL on failure.
+ **/
+bsv_stream_t *bsv_stream_open_write(const char *path,
+      uint32_t crc, size_t state_size,
+      bsv_stream_serialize_t serialize,
+      bsv_stream_unserialize_t unserialize);
+
+/**
+ * bsv_stream_open_read:
+ * @path               : movie file to play
+ * @crc                : CRC32 of the content, 0 to
+ *                       skip the check
+ * @state_size         : savestate size of the core
+ * @unserialize        : restores a state
+ *
+ * Starts playback from the beginning of the movie,
+ * restoring its starting state.
+ *
+ * Returns: the stream, or NULL on failure.
+ **/
+bsv_stream_t *bsv_stream_open_read(const char *path,
+      uint32_t crc, size_t state_size,
+      bsv_stream_unserialize_t unserialize);
+
+/* Finishes the file when recording, then frees the stream */
+void bsv_stream_close(bsv_stream_t *stream);
+
+/* Called once at the start of every frame */
+void bsv_stream_frame_start(bsv_stream_t *stream);
+
+void bsv_stream_write_input(bsv_stream_t *stream, int16_t value);
+
+/* Returns false once playback is past the last frame */
+bool bsv_stream_read_input(bsv_stream_t *stream, int16_t *value);
+
+/**
+ * bsv_stream_rewind:
+ * @first_rewind       : true if the previous frame was
+ *                       not rewound
+ *
+ * Steps the movie back along with the rewind buffer.
+ * A recording can't be rewound past its last keyframe,
+ * which gets restored instead.
+ **/
+void bsv_stream_rewind(bsv_stream_t *stream, bool first_rewind);
+
+/**
+ * bsv_stream_seek:
+ * @frame              : frame to jump to
+ *
+ * Jumps to the last keyframe at or before @frame
+ * during playback, restoring its state.
+ *
+ * Returns: the frame playback continues from, or
+ * -1 if the movie can't seek.
+ **/
+int64_t bsv_stream_seek(bsv_stream_t *stream, uint64_t frame);
+
+/* Returns true if bsv_stream_seek() can be used */
+bool bsv_stream_can_seek(bsv_stream_t *stream);
+
+/* Frame of the movie being played back or recorded */
+uint64_t bsv_stream_get_frame(bsv_stream_t *stream);
+
+RETRO_END_DECLS
+
+#endif
@@ -17,14 +17,18 @@
 #include <string.h>
 
 #include <poll.h>
+#include <time.h>
 #include <unistd.h>
 
+#include <features/features_cpu.h>
+
 #include <string/stdstring.h>
 
 #include "wayland_common.h"
 
 #include "../input_keymaps.h"
 #include "../../frontend/frontend_driver.h"
+#include "../../retroarch.h"
 
 static void keyboard_handle_keymap(void* data,
       struct wl_keyboard* keyboard,
@@ -565,6 +569,13 @@ static void registry_handle_global(void *data, struct wl_registry *reg,
    else if (string_is_equal(interface, "zxdg_decoration_manager_v1"))
       wl->deco_manager = (struct zxdg_decoration_manager_v1*)wl_registry_bind(
                                   reg, id, &zxdg_decoration_manager_v1_interface, 1);
+   else if (string_is_equal(interface, "wp_presentation"))
+   {
+      wl->presentation = (struct wp_presentation*)wl_registry_bind(
+                                  reg, id, &wp_presentation_interface, 1);
+      wp_presentation_add_listener(wl->presentation,
+            &presentation_listener, wl);
+   }
 }
 
 static void registry_handle_global_remove(void *data,
@@ -589,6 +600,71 @@ const struct wl_registry_listener registry_listener = {
    registry_handle_global_remove,
 };
 
+static void presentation_handle_clock_id(void *data,
+      struct wp_presentation *presentation, uint32_t clk_id)
+{
+   gfx_ctx_wayland_data_t *wl = (gfx_ctx_wayland_data_t*)data;
+   wl->presentation_clock     = clk_id;
+}
+
+const struct wp_presentation_listener presentation_listener = {
+   presentation_handle_clock_id,
+};
+
+static void feedback_handle_sync_output(void *data,
+      struct wp_presentation_feedback *feedback,
+      struct wl_output *output) { }
+
+static void feedback_handle_presented(void *data,
+      struct wp_presentation_feedback *feedback,
+      uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec,
+      uint32_t refresh, uint32_t seq_hi, uint32_t seq_lo,
+      uint32_t flags)
+{
+   struct timespec now;
+   gfx_ctx_wayland_data_t *wl = (gfx_ctx_wayland_data_t*)data;
+   retro_time_t presented     = (retro_time_t)
+      (((uint64_t)tv_sec_hi << 32) | tv_sec_lo) * 1000000
+      + tv_nsec / 1000;
+
+   wp_presentation_feedback_destroy(feedback);
+
+   /* Only vsync'd presents say anything about the refresh
+    * cycle. Timestamps are moved over to the clock of
+    * cpu_features_get_time_usec(). */
+   if (     !(flags & WP_PRESENTATION_FEEDBACK_KIND_VSYNC)
+         || clock_gettime((clockid_t)wl->presentation_clock, &now) != 0)
+      return;
+
+   presented += cpu_features_get_time_usec()
+      - ((retro_time_t)now.tv_sec * 1000000 + now.tv_nsec / 1000);
+
+   video_driver_set_present_timing(presented, refresh / 1000);
+}
+
+static void feedback_handle_discarded(void *data,
+      struct wp_presentation_feedback *feedback)
+{
+   wp_presentation_feedback_destroy(feedback);
+}
+
+static const struct wp_presentation_feedback_listener feedback_listener = {
+   feedback_handle_sync_output,
+   feedback_handle_presented,
+   feedback_handle_discarded,
+};
+
+void gfx_ctx_wl_request_presentation_feedback(gfx_ctx_wayland_data_t *wl)
+{
+   struct wp_presentation_feedback *feedback;
+
+   if (!wl->presentation || !wl->surface)
+      return;
+
+   feedback = wp_presentation_feedback(wl->presentation, wl->surface);
+   wp_presentation_feedback_add_listener(feedback, &feedback_listener, wl);
+}
+
 
 const struct wl_output_listener output_listener = {
    display_handle_geometry,
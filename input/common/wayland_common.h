@@ -45,6 +45,9 @@
 /* Generated from xdg-decoration-unstable-v1.h */
 #include "../../gfx/common/wayland/xdg-decoration-unstable-v1.h"
 
+/* Generated from presentation-time.xml */
+#include "../../gfx/common/wayland/presentation-time.h"
+
 #define UDEV_KEY_MAX			     0x2ff
 #define UDEV_MAX_KEYS           (UDEV_KEY_MAX + 7) / 8
 
@@ -135,6 +138,7 @@ typedef struct gfx_ctx_wayland_data
    struct zxdg_toplevel_decoration_v1 *deco;
    struct zwp_idle_inhibit_manager_v1 *idle_inhibit_manager;
    struct zwp_idle_inhibitor_v1 *idle_inhibitor;
+   struct wp_presentation *presentation;
    output_info_t *current_output;
 #ifdef HAVE_VULKAN
    gfx_ctx_vulkan_data_t vk;
@@ -153,6 +157,8 @@ typedef struct gfx_ctx_wayland_data
 
    int num_active_touches;
    int swap_interval;
+   /* Clock of the wp_presentation timestamps */
+   uint32_t presentation_clock;
    touch_pos_t active_touch_positions[MAX_TOUCHES]; /* int32_t alignment */
    unsigned prev_width;
    unsigned prev_height;
@@ -188,6 +194,12 @@ void handle_zxdg_toplevel_close(void *data,
 
 void flush_wayland_fd(void *data);
 
+/* Asks for the scanout time of the next commit, which is
+ * then handed to video_driver_set_present_timing() */
+void gfx_ctx_wl_request_presentation_feedback(gfx_ctx_wayland_data_t *wl);
+
+extern const struct wp_presentation_listener presentation_listener;
+
 extern const struct wl_keyboard_listener keyboard_listener;
 
 extern const struct wl_pointer_listener pointer_listener;
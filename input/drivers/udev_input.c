@@ -67,6 +67,16 @@
 #include <compat/strl.h>
 #include <string/stdstring.h>
 #include <retro_miscellaneous.h>
+#include <features/features_cpu.h>
+
+#if defined(HAVE_THREADS) && defined(HAVE_EPOLL)
+#include <rthreads/rthreads.h>
+#include <queues/spsc_ring.h>
+#include <retro_timers.h>
+/* Devices are read by a thread as soon as events
+ * arrive, and the events queued until the next poll */
+#define UDEV_INPUT_THREAD
+#endif
 
 #include "../input_keymaps.h"
 
@@ -82,6 +92,11 @@
 
 #define UDEV_MAX_KEYS (KEY_MAX + 7) / 8
 
+#ifdef UDEV_INPUT_THREAD
+/* Events the thread may queue ahead of the next poll */
+#define UDEV_INPUT_QUEUE_SIZE 1024
+#endif
+
 typedef struct udev_input udev_input_t;
 
 typedef struct udev_input_device udev_input_device_t;
@@ -129,6 +144,14 @@ struct udev_input_device
 typedef void (*device_handle_cb)(void *data,
       const struct input_event *event, udev_input_device_t *dev);
 
+#ifdef UDEV_INPUT_THREAD
+typedef struct udev_input_queued_event
+{
+   udev_input_device_t *device;
+   struct input_event event;
+} udev_input_queued_event_t;
+#endif
+
 struct udev_input
 {
    struct udev *udev;
@@ -142,6 +165,21 @@ struct udev_input
 
    unsigned num_devices;
 
+#ifdef UDEV_INPUT_THREAD
+   sthread_t *thread;
+   /* Held by the thread while it reads the devices,
+    * and by the poll around any change to the list */
+   slock_t *lock;
+   spsc_ring_t queue;
+   /* Written to, to make the thread quit */
+   int wake_fd[2];
+   retro_atomic_int_t quit;
+   /* Average time events waited in the queue before
+    * being handled by a poll, using the kernel's
+    * event timestamps */
+   retro_time_t event_age;
+#endif
+
    uint8_t state[UDEV_MAX_KEYS];
 
 #ifdef UDEV_XKB_HANDLING
@@ -516,6 +554,15 @@ static int udev_input_add_device(udev_input_t *udev,
    if (!device)
       goto error;
 
+#if defined(UDEV_INPUT_THREAD) && defined(EVIOCSCLOCKID)
+   /* Timestamp events with the clock
+    * cpu_features_get_time_usec() uses */
+   {
+      int clock_id = CLOCK_MONOTONIC;
+      ioctl(fd, EVIOCSCLOCKID, &clock_id);
+   }
+#endif
+
    device->fd        = fd;
    device->dev       = st.st_dev;
    device->handle_cb = cb;
@@ -730,6 +777,110 @@ static bool udev_input_poll_hotplug_available(struct udev_monitor *dev)
    return (poll(&fds, 1, 0) == 1) && (fds.revents & POLLIN);
 }
 
+#ifdef UDEV_INPUT_THREAD
+static bool udev_input_device_exists(const udev_input_t *udev,
+      const udev_input_device_t *device)
+{
+   unsigned i;
+
+   for (i = 0; i < udev->num_devices; i++)
+      if (udev->devices[i] == device)
+         return true;
+
+   return false;
+}
+
+static void udev_input_thread(void *data)
+{
+   udev_input_t *udev = (udev_input_t*)data;
+
+   while (!retro_atomic_load(&udev->quit))
+   {
+      int i;
+      struct epoll_event events[32];
+      int ret = epoll_wait(udev->fd, events, ARRAY_SIZE(events), -1);
+
+      if (ret < 0)
+      {
+         if (errno == EINTR)
+            continue;
+         break;
+      }
+
+      slock_lock(udev->lock);
+
+      for (i = 0; i < ret; i++)
+      {
+         int j, len;
+         struct input_event input_events[32];
+         udev_input_queued_event_t queued;
+         udev_input_device_t *device =
+            (udev_input_device_t*)events[i].data.ptr;
+
+         /* The wakeup pipe, or a device that was
+          * removed after epoll_wait() returned */
+         if (     !device
+               || !(events[i].events & EPOLLIN)
+               || !udev_input_device_exists(udev, device))
+            continue;
+
+         queued.device = device;
+
+         /* Leave the events in the kernel's buffer
+          * until the queue has room for them */
+         while (spsc_ring_write_avail(&udev->queue)
+               >= sizeof(input_events) / sizeof(*input_events)
+                  * sizeof(queued))
+         {
+            if ((len = read(device->fd,
+                        input_events, sizeof(input_events))) <= 0)
+               break;
+
+            len /= sizeof(*input_events);
+            for (j = 0; j < len; j++)
+            {
+               queued.event = input_events[j];
+               spsc_ring_write(&udev->queue, &queued, sizeof(queued));
+            }
+         }
+      }
+
+      slock_unlock(udev->lock);
+
+      /* Nobody polls (e.g. while paused) - the
+       * queue is full, so don't spin on epoll */
+      if (spsc_ring_write_avail(&udev->queue)
+            < 32 * sizeof(udev_input_queued_event_t))
+         retro_sleep(1);
+   }
+}
+
+/* Hands the queued events to the devices' handlers,
+ * so that they only ever run on the caller's thread */
+static void udev_input_handle_queue(udev_input_t *udev)
+{
+   udev_input_queued_event_t queued;
+   retro_time_t now = cpu_features_get_time_usec();
+
+   while (spsc_ring_read(&udev->queue, &queued,
+            sizeof(queued)) == sizeof(queued))
+   {
+#ifdef input_event_sec
+      retro_time_t time = (retro_time_t)queued.event.input_event_sec
+         * 1000000 + queued.event.input_event_usec;
+#else
+      retro_time_t time = (retro_time_t)queued.event.time.tv_sec
+         * 1000000 + queued.event.time.tv_usec;
+#endif
+
+      if (time > 0 && time <= now)
+         udev->event_age += (now - time - udev->event_age) / 16;
+
+      queued.device->handle_cb(udev, &queued.event, queued.device);
+   }
+}
+#endif
+
 static void udev_input_poll(void *data)
 {
    int i, ret;
@@ -764,6 +915,23 @@ static void udev_input_poll(void *data)
       mouse->whd   = false;
    }
 
+#ifdef UDEV_INPUT_THREAD
+   if (udev->thread)
+   {
+      slock_lock(udev->lock);
+
+      /* Events of a device that gets removed
+       * must be handled before it is freed */
+      udev_input_handle_queue(udev);
+
+      while (udev->monitor && udev_input_poll_hotplug_available(udev->monitor))
+         udev_input_handle_hotplug(udev);
+
+      slock_unlock(udev->lock);
+      return;
+   }
+#endif
+
    while (udev->monitor && udev_input_poll_hotplug_available(udev->monitor))
       udev_input_handle_hotplug(udev);
 
@@ -1199,6 +1367,29 @@ static void udev_input_free(void *data)
    if (!data || !udev)
       return;
 
+#ifdef UDEV_INPUT_THREAD
+   if (udev->thread)
+   {
+      char c     = 0;
+      ssize_t rc = 0;
+
+      retro_atomic_store(&udev->quit, 1);
+      rc         = write(udev->wake_fd[1], &c, 1);
+      (void)rc;
+      sthread_join(udev->thread);
+
+      RARCH_LOG("[udev]: Events waited %d us on average before being polled.\n",
+            (int)udev->event_age);
+   }
+   if (udev->lock)
+      slock_free(udev->lock);
+   if (udev->wake_fd[0] >= 0)
+      close(udev->wake_fd[0]);
+   if (udev->wake_fd[1] >= 0)
+      close(udev->wake_fd[1]);
+   spsc_ring_deinitialize(&udev->queue);
+#endif
+
    if (udev->fd >= 0)
       close(udev->fd);
 
@@ -1305,6 +1496,11 @@ static void *udev_input_init(const char *joypad_driver)
    if (!udev)
       return NULL;
 
+#ifdef UDEV_INPUT_THREAD
+   udev->wake_fd[0] = -1;
+   udev->wake_fd[1] = -1;
+#endif
+
    udev->udev = udev_new();
    if (!udev->udev)
       goto error;
@@ -1352,6 +1548,24 @@ static void *udev_input_init(const char *joypad_driver)
 
    input_keymaps_init_keyboard_lut(rarch_key_map_linux);
 
+#ifdef UDEV_INPUT_THREAD
+   /* Reading on the caller's thread
+    * still works if any of this fails */
+   if (     pipe(udev->wake_fd) == 0
+         && spsc_ring_initialize(&udev->queue, UDEV_INPUT_QUEUE_SIZE
+            * sizeof(udev_input_queued_event_t))
+         && (udev->lock = slock_new()))
+   {
+      struct epoll_event event;
+
+      event.events   = EPOLLIN;
+      event.data.ptr = NULL;
+
+      if (epoll_ctl(udev->fd, EPOLL_CTL_ADD, udev->wake_fd[0], &event) == 0)
+         udev->thread = sthread_create(udev_input_thread, udev);
+   }
+#endif
+
 #ifdef __linux__
    linux_terminal_disable_input();
 #endif
@@ -24,8 +24,8 @@
 
 #include <rthreads/rthreads.h>
 #include <compat/strl.h>
-#include <queues/fifo_queue.h>
 #include <string/stdstring.h>
+#include <retro_atomic.h>
 
 #include "../connect/joypad_connection.h"
 #include "../input_defines.h"
@@ -37,11 +37,28 @@
 #define LIBUSB_CAP_HAS_HOTPLUG 0x0001
 #endif
 
+/* IN transfers kept queued per adapter, so that the host
+ * controller always has one to fill while the callback
+ * of the other one runs */
+#define LIBUSB_HID_IN_TRANSFERS 2
+#define LIBUSB_HID_MAX_PACKET   1024
+
+/* Set in report_ready when the report there hasn't been
+ * passed on to the pad driver yet */
+#define LIBUSB_HID_REPORT_FRESH 4
+
 typedef struct libusb_hid
 {
    libusb_context *ctx;
    joypad_connection_t *slots;
    sthread_t *poll_thread;
+   /* Guards the adapter lists, which the hotplug callback
+    * changes on the polling thread */
+   slock_t *adapters_lock;
+#if !RETRO_ATOMIC_LOCK_FREE
+   slock_t *report_lock;
+#endif
+   struct libusb_adapter *dead;
    int can_hotplug;
 #if defined(__FreeBSD__) && LIBUSB_API_VERSION <= 0x01000102
    libusb_hotplug_callback_handle hp;
@@ -51,6 +68,14 @@ typedef struct libusb_hid
    int quit;
 } libusb_hid_t;
 
+struct libusb_report
+{
+   /* The first byte is left for the report ID, like the
+    * other HID drivers hand the packets to the pads */
+   uint8_t data[LIBUSB_HID_MAX_PACKET + 1];
+   int size;
+};
+
 struct libusb_adapter
 {
    libusb_hid_t *hid;
@@ -62,86 +87,172 @@ struct libusb_adapter
    int endpoint_out;
    int endpoint_in_max_size;
    int endpoint_out_max_size;
+   bool claimed;
 
    uint8_t manufacturer_name[255];
    uint8_t name[255];
-   uint8_t data[2048];
 
    int slot;
 
-   sthread_t *thread;
-   slock_t *send_control_lock;
-   fifo_buffer_t *send_control_buffer;
+   struct libusb_transfer *transfers[LIBUSB_HID_IN_TRANSFERS];
+   uint8_t in_buf[LIBUSB_HID_IN_TRANSFERS][LIBUSB_HID_MAX_PACKET];
+   /* Transfers that haven't called back for the last
+    * time yet; the adapter can only go once it's 0 */
+   retro_atomic_int_t pending;
+
+   /* Latest report, triple buffered between the polling
+    * thread, which owns reports[report_write], and
+    * input_poll, which owns reports[report_read] */
+   struct libusb_report reports[3];
+   int report_write;
+   int report_read;
+   retro_atomic_int_t report_ready;
+
    struct libusb_adapter *next;
 };
 
 static struct libusb_adapter adapters;
 
-static void adapter_thread(void *data)
+static int libusb_hid_report_swap(struct libusb_adapter *adapter, int value)
 {
-   uint8_t send_command_buf[4096];
-   struct libusb_adapter *adapter = (struct libusb_adapter*)data;
-   libusb_hid_t *hid              = adapter ? adapter->hid : NULL;
+#if RETRO_ATOMIC_LOCK_FREE
+   return retro_atomic_exchange(&adapter->report_ready, value);
+#else
+   int old;
+   slock_lock(adapter->hid->report_lock);
+   old = retro_atomic_exchange(&adapter->report_ready, value);
+   slock_unlock(adapter->hid->report_lock);
+   return old;
+#endif
+}
 
-   if (!adapter)
+static void LIBUSB_CALL libusb_hid_in_cb(struct libusb_transfer *transfer)
+{
+   struct libusb_adapter *adapter = (struct libusb_adapter*)
+      transfer->user_data;
+
+   if (     transfer->status == LIBUSB_TRANSFER_COMPLETED
+         && transfer->actual_length > 0)
+   {
+      struct libusb_report *report = &adapter->reports[adapter->report_write];
+
+      memcpy(&report->data[1], transfer->buffer, transfer->actual_length);
+      report->size          = transfer->actual_length;
+      adapter->report_write = libusb_hid_report_swap(adapter,
+            adapter->report_write | LIBUSB_HID_REPORT_FRESH)
+         & ~LIBUSB_HID_REPORT_FRESH;
+   }
+
+   if (     !adapter->quitting
+         && transfer->status != LIBUSB_TRANSFER_CANCELLED
+         && transfer->status != LIBUSB_TRANSFER_NO_DEVICE
+         && libusb_submit_transfer(transfer) == LIBUSB_SUCCESS)
       return;
 
-   while (!adapter->quitting)
+   retro_atomic_fetch_add(&adapter->pending, -1);
+}
+
+static void LIBUSB_CALL libusb_hid_out_cb(struct libusb_transfer *transfer)
+{
+   struct libusb_adapter *adapter = (struct libusb_adapter*)
+      transfer->user_data;
+
+   /* Buffer and transfer are freed by libusb */
+   retro_atomic_fetch_add(&adapter->pending, -1);
+}
+
+static bool libusb_hid_start_transfers(struct libusb_adapter *adapter)
+{
+   unsigned i;
+
+   for (i = 0; i < LIBUSB_HID_IN_TRANSFERS; i++)
    {
-      size_t send_command_size;
-      int tmp;
-      int report_number;
-      int size = 0;
-
-      slock_lock(adapter->send_control_lock);
-      if (FIFO_READ_AVAIL(adapter->send_control_buffer)
-            >= sizeof(send_command_size))
-      {
-         fifo_read(adapter->send_control_buffer,
-               &send_command_size, sizeof(send_command_size));
+      struct libusb_transfer *transfer = libusb_alloc_transfer(0);
 
-         if (FIFO_READ_AVAIL(adapter->send_control_buffer)
-               >= sizeof(send_command_size))
-         {
-            fifo_read(adapter->send_control_buffer,
-                  send_command_buf, send_command_size);
-            libusb_interrupt_transfer(adapter->handle,
-                  adapter->endpoint_out, send_command_buf,
-                  send_command_size, &tmp, 1000);
-         }
+      if (!transfer)
+         return false;
+
+      adapter->transfers[i] = transfer;
+      libusb_fill_interrupt_transfer(transfer, adapter->handle,
+            adapter->endpoint_in, adapter->in_buf[i],
+            adapter->endpoint_in_max_size, libusb_hid_in_cb, adapter, 0);
+
+      retro_atomic_fetch_add(&adapter->pending, 1);
+      if (libusb_submit_transfer(transfer) != LIBUSB_SUCCESS)
+      {
+         retro_atomic_fetch_add(&adapter->pending, -1);
+         return false;
       }
-      slock_unlock(adapter->send_control_lock);
+   }
 
-      libusb_interrupt_transfer(adapter->handle,
-            adapter->endpoint_in, &adapter->data[1],
-            adapter->endpoint_in_max_size, &size, 1000);
+   return true;
+}
 
-      if (adapter && hid && hid->slots && size)
-         pad_connection_packet(&hid->slots[adapter->slot], adapter->slot,
-               adapter->data, size+1);
+static void libusb_hid_cancel_transfers(struct libusb_adapter *adapter)
+{
+   unsigned i;
+
+   adapter->quitting = true;
+
+   for (i = 0; i < LIBUSB_HID_IN_TRANSFERS; i++)
+      if (adapter->transfers[i])
+         libusb_cancel_transfer(adapter->transfers[i]);
+}
+
+/* Only call once no transfer of the adapter is in flight */
+static void libusb_hid_free_adapter(struct libusb_adapter *adapter)
+{
+   unsigned i;
+
+   for (i = 0; i < LIBUSB_HID_IN_TRANSFERS; i++)
+      if (adapter->transfers[i])
+         libusb_free_transfer(adapter->transfers[i]);
+
+   if (adapter->handle)
+   {
+      if (adapter->claimed)
+         libusb_release_interface(adapter->handle,
+               adapter->interface_number);
+      libusb_close(adapter->handle);
    }
+
+   free(adapter);
 }
 
 static void libusb_hid_device_send_control(void *data,
       uint8_t* data_buf, size_t size)
 {
-   struct libusb_adapter *adapter = (struct libusb_adapter*)data;
+   uint8_t *buf                     = NULL;
+   struct libusb_transfer *transfer = NULL;
+   struct libusb_adapter *adapter   = (struct libusb_adapter*)data;
 
-   if (!adapter)
+   if (!adapter || adapter->quitting)
       return;
 
-   slock_lock(adapter->send_control_lock);
+   transfer = libusb_alloc_transfer(0);
+   buf      = (uint8_t*)malloc(size);
 
-   if (FIFO_WRITE_AVAIL(adapter->send_control_buffer) >= size + sizeof(size))
+   if (!transfer || !buf)
    {
-      fifo_write(adapter->send_control_buffer, &size, sizeof(size));
-      fifo_write(adapter->send_control_buffer, data_buf, size);
+      RARCH_WARN("Cannot allocate adapter send control transfer\n");
+      libusb_free_transfer(transfer);
+      free(buf);
+      return;
    }
-   else
+
+   memcpy(buf, data_buf, size);
+   libusb_fill_interrupt_transfer(transfer, adapter->handle,
+         adapter->endpoint_out, buf, (int)size,
+         libusb_hid_out_cb, adapter, 1000);
+   transfer->flags = LIBUSB_TRANSFER_FREE_BUFFER
+      | LIBUSB_TRANSFER_FREE_TRANSFER;
+
+   retro_atomic_fetch_add(&adapter->pending, 1);
+   if (libusb_submit_transfer(transfer) != LIBUSB_SUCCESS)
    {
-      RARCH_WARN("adapter write buffer is full, cannot write send control\n");
+      retro_atomic_fetch_add(&adapter->pending, -1);
+      libusb_free_transfer(transfer);
    }
-   slock_unlock(adapter->send_control_lock);
 }
 
 static void libusb_hid_device_add_autodetect(unsigned idx,
@@ -228,7 +339,6 @@ static int add_adapter(void *data, struct libusb_device *dev)
    int rc;
    struct libusb_device_descriptor desc;
    const char *device_name         = NULL;
-   struct libusb_adapter *old_head = NULL;
    struct libusb_hid          *hid = (struct libusb_hid*)data;
    struct libusb_adapter *adapter  = (struct libusb_adapter*)
       calloc(1, sizeof(struct libusb_adapter));
@@ -252,6 +362,8 @@ static int add_adapter(void *data, struct libusb_device *dev)
    }
 
    adapter->device = dev;
+   adapter->hid    = hid;
+   adapter->slot   = -1;
 
    libusb_get_description(adapter->device, adapter);
 
@@ -261,12 +373,16 @@ static int add_adapter(void *data, struct libusb_device *dev)
       goto error;
    }
 
+   if (adapter->endpoint_in_max_size > LIBUSB_HID_MAX_PACKET)
+      adapter->endpoint_in_max_size = LIBUSB_HID_MAX_PACKET;
+
    rc = libusb_open (adapter->device, &adapter->handle);
 
    if (rc != LIBUSB_SUCCESS)
    {
       RARCH_ERR("Error opening device 0x%p (VID/PID: %04x:%04x).\n",
             (void*)adapter->device, desc.idVendor, desc.idProduct);
+      adapter->handle = NULL;
       goto error;
    }
 
@@ -296,15 +412,26 @@ static int add_adapter(void *data, struct libusb_device *dev)
    if (string_is_empty((const char*)adapter->name))
       goto error;
 
-   adapter->send_control_lock = slock_new();
-   adapter->send_control_buffer = fifo_new(4096);
+   /* Claimed before the pad is set up, since pad drivers
+    * may send their init commands from there and those
+    * now go out right away */
+   if (libusb_kernel_driver_active(adapter->handle, 0) == 1
+         && libusb_detach_kernel_driver(adapter->handle, 0))
+   {
+      RARCH_ERR("Error detaching handle 0x%p from kernel.\n", adapter->handle);
+      goto error;
+   }
+
+   rc = libusb_claim_interface(adapter->handle, adapter->interface_number);
 
-   if (!adapter->send_control_lock || !adapter->send_control_buffer)
+   if (rc != LIBUSB_SUCCESS)
    {
-      RARCH_ERR("Error creating send control buffer.\n");
+      RARCH_ERR("Error claiming interface %d .\n", adapter->interface_number);
       goto error;
    }
 
+   adapter->claimed = true;
+
    adapter->slot = pad_connection_pad_init(hid->slots,
          device_name, desc.idVendor, desc.idProduct,
          adapter, &libusb_hid);
@@ -321,89 +448,82 @@ static int add_adapter(void *data, struct libusb_device *dev)
 
    RARCH_LOG("Interface found: [%s].\n", adapter->name);
 
-   if (libusb_kernel_driver_active(adapter->handle, 0) == 1
-         && libusb_detach_kernel_driver(adapter->handle, 0))
-   {
-      RARCH_ERR("Error detaching handle 0x%p from kernel.\n", adapter->handle);
-      goto error;
-   }
-
-   rc = libusb_claim_interface(adapter->handle, adapter->interface_number);
-
-   if (rc != LIBUSB_SUCCESS)
-   {
-      RARCH_ERR("Error claiming interface %d .\n", adapter->interface_number);
-      goto error;
-   }
-
    RARCH_LOG("Device 0x%p attached (VID/PID: %04x:%04x).\n",
          adapter->device, desc.idVendor, desc.idProduct);
 
    libusb_hid_device_add_autodetect(adapter->slot,
          device_name, libusb_hid.ident, desc.idVendor, desc.idProduct);
 
-   adapter->hid = hid;
-   adapter->thread = sthread_create(adapter_thread, adapter);
+   adapter->report_write = 0;
+   adapter->report_read  = 1;
+   retro_atomic_store(&adapter->report_ready, 2);
 
-   if (!adapter->thread)
+   if (!libusb_hid_start_transfers(adapter))
    {
-      RARCH_ERR("Error initializing adapter thread.\n");
+      RARCH_ERR("Error submitting adapter transfers.\n");
       goto error;
    }
 
-   old_head      = adapters.next;
+   slock_lock(hid->adapters_lock);
+   adapter->next = adapters.next;
    adapters.next = adapter;
-   adapter->next = old_head;
+   slock_unlock(hid->adapters_lock);
 
    return 0;
 
 error:
-   if (adapter->thread)
-      sthread_join(adapter->thread);
-   if (adapter->send_control_lock)
-      slock_free(adapter->send_control_lock);
-   if (adapter->send_control_buffer)
-      fifo_free(adapter->send_control_buffer);
-   if (adapter)
-      free(adapter);
+   if (adapter->slot != -1)
+      pad_connection_pad_deinit(&hid->slots[adapter->slot], adapter->slot);
+
+   /* Whatever got submitted is reaped by the polling thread */
+   if (retro_atomic_load(&adapter->pending))
+   {
+      libusb_hid_cancel_transfers(adapter);
+      slock_lock(hid->adapters_lock);
+      adapter->next = hid->dead;
+      hid->dead     = adapter;
+      slock_unlock(hid->adapters_lock);
+   }
+   else
+      libusb_hid_free_adapter(adapter);
    return -1;
 }
 
 static int remove_adapter(void *data, struct libusb_device *dev)
 {
-   struct libusb_adapter  *adapter = (struct libusb_adapter*)&adapters;
+   struct libusb_adapter  *prev    = &adapters;
+   struct libusb_adapter  *adapter = NULL;
    struct libusb_hid          *hid = (struct libusb_hid*)data;
 
-   while (!adapter->next)
-      return -1;
-
-   if (adapter->next->device == dev)
-   {
-      struct libusb_adapter *new_next = NULL;
-      const char                *name = (const char*)adapter->next->name;
+   slock_lock(hid->adapters_lock);
 
-      input_autoconfigure_disconnect(adapter->slot, name);
-
-      adapter->next->quitting = true;
-      sthread_join(adapter->next->thread);
+   for (adapter = prev->next; adapter; prev = adapter, adapter = adapter->next)
+      if (adapter->device == dev)
+         break;
 
-      pad_connection_pad_deinit(&hid->slots[adapter->slot], adapter->slot);
+   if (!adapter)
+   {
+      slock_unlock(hid->adapters_lock);
+      return -1;
+   }
 
-      slock_free(adapter->send_control_lock);
-      fifo_free(adapter->send_control_buffer);
+   prev->next = adapter->next;
 
-      libusb_release_interface(adapter->next->handle,
-            adapter->next->interface_number);
-      libusb_close(adapter->next->handle);
+   input_autoconfigure_disconnect(adapter->slot,
+         (const char*)adapter->name);
+   pad_connection_pad_deinit(&hid->slots[adapter->slot], adapter->slot);
 
-      new_next = adapter->next->next;
-      free(adapter->next);
-      adapter->next = new_next;
+   /* This may well run in the hotplug callback, i.e. while the
+    * polling thread is handling events, so the cancellations
+    * can't be waited for here. The polling thread frees the
+    * adapter once its last transfer called back. */
+   libusb_hid_cancel_transfers(adapter);
+   adapter->next = hid->dead;
+   hid->dead     = adapter;
 
-      return 0;
-   }
+   slock_unlock(hid->adapters_lock);
 
-   return -1;
+   return 0;
 }
 
 static int libusb_hid_hotplug_callback(struct libusb_context *ctx,
@@ -535,41 +655,92 @@ static int16_t libusb_hid_joypad_state(
    return ret;
 }
 
+/* Frees the removed adapters whose transfers have all
+ * called back.
+ *
+ * Returns: true if there are removed adapters left. */
+static bool libusb_hid_reap_adapters(libusb_hid_t *hid)
+{
+   struct libusb_adapter **link = NULL;
+   bool left                    = false;
+
+   slock_lock(hid->adapters_lock);
+
+   for (link = &hid->dead; *link; )
+   {
+      struct libusb_adapter *adapter = *link;
+
+      if (retro_atomic_load(&adapter->pending))
+      {
+         link = &adapter->next;
+         left = true;
+         continue;
+      }
+
+      *link = adapter->next;
+      libusb_hid_free_adapter(adapter);
+   }
+
+   slock_unlock(hid->adapters_lock);
+
+   return left;
+}
+
+static bool libusb_hid_handle_events(libusb_hid_t *hid)
+{
+   /* Completed transfers wake this up right away,
+    * the timeout only bounds how long quitting takes */
+   struct timeval timeout = {0, 100000};
+   libusb_handle_events_timeout_completed(hid->ctx, &timeout, NULL);
+   return libusb_hid_reap_adapters(hid);
+}
+
 static void libusb_hid_free(const void *data)
 {
    libusb_hid_t *hid = (libusb_hid_t*)data;
 
-   while (adapters.next)
-      if (remove_adapter(hid, adapters.next->device) == -1)
-         RARCH_ERR("could not remove device %p\n",
-               adapters.next->device);
+   if (hid->can_hotplug)
+      libusb_hotplug_deregister_callback(hid->ctx, hid->hp);
 
-   if (hid->poll_thread)
+   if (hid->adapters_lock)
    {
-      hid->quit = 1;
-      sthread_join(hid->poll_thread);
+      while (adapters.next)
+         if (remove_adapter(hid, adapters.next->device) == -1)
+            RARCH_ERR("could not remove device %p\n",
+                  adapters.next->device);
+
+      if (hid->poll_thread)
+      {
+         hid->quit = 1;
+         sthread_join(hid->poll_thread);
+      }
+      else
+         while (libusb_hid_handle_events(hid));
    }
 
    if (hid->slots)
       pad_connection_destroy(hid->slots);
 
-   if (hid->can_hotplug)
-      libusb_hotplug_deregister_callback(hid->ctx, hid->hp);
-
-   libusb_exit(hid->ctx);
+   if (hid->ctx)
+      libusb_exit(hid->ctx);
+   if (hid->adapters_lock)
+      slock_free(hid->adapters_lock);
+#if !RETRO_ATOMIC_LOCK_FREE
+   if (hid->report_lock)
+      slock_free(hid->report_lock);
+#endif
    free(hid);
 }
 
+/* Handles the transfers of all adapters. Reports are
+ * passed on to the pads by libusb_hid_poll() */
 static void poll_thread(void *data)
 {
    libusb_hid_t *hid = (libusb_hid_t*)data;
 
-   while (!hid->quit)
-   {
-      struct timeval timeout = {0};
-      libusb_handle_events_timeout_completed(NULL,
-            &timeout, &hid->quit);
-   }
+   /* Removed adapters still have to see their
+    * cancelled transfers through */
+   while (libusb_hid_handle_events(hid) || !hid->quit);
 }
 
 static void *libusb_hid_init(void)
@@ -582,10 +753,24 @@ static void *libusb_hid_init(void)
    if (!hid)
       goto error;
 
+   hid->adapters_lock = slock_new();
+#if !RETRO_ATOMIC_LOCK_FREE
+   hid->report_lock   = slock_new();
+
+   if (!hid->report_lock)
+      goto error;
+#endif
+
+   if (!hid->adapters_lock)
+      goto error;
+
    ret = libusb_init(&hid->ctx);
 
    if (ret < 0)
+   {
+      hid->ctx = NULL;
       goto error;
+   }
 
 #if LIBUSB_API_VERSION <= 0x01000102
    /* API is too old, so libusb_has_capability function does not exist.
@@ -664,9 +849,35 @@ error:
    return NULL;
 }
 
+/* Hands the latest report of each adapter to its pad, so
+ * that the pad drivers only ever run on the input thread */
 static void libusb_hid_poll(void *data)
 {
-   (void)data;
+   struct libusb_adapter *adapter = NULL;
+   libusb_hid_t              *hid = (libusb_hid_t*)data;
+
+   if (!hid)
+      return;
+
+   slock_lock(hid->adapters_lock);
+
+   for (adapter = adapters.next; adapter; adapter = adapter->next)
+   {
+      struct libusb_report *report = NULL;
+
+      if (!(retro_atomic_load(&adapter->report_ready)
+               & LIBUSB_HID_REPORT_FRESH))
+         continue;
+
+      adapter->report_read = libusb_hid_report_swap(adapter,
+            adapter->report_read) & ~LIBUSB_HID_REPORT_FRESH;
+      report               = &adapter->reports[adapter->report_read];
+
+      pad_connection_packet(&hid->slots[adapter->slot], adapter->slot,
+            report->data, report->size + 1);
+   }
+
+   slock_unlock(hid->adapters_lock);
 }
 
 hid_driver_t libusb_hid = {
@@ -120,6 +120,7 @@ enum
    RARCH_RUNAHEAD_TOGGLE,
 
    RARCH_AI_SERVICE,
+   RARCH_INSTANT_REPLAY_SAVE,
 
    RARCH_BIND_LIST_END,
    RARCH_BIND_LIST_END_NULL
@@ -161,6 +161,20 @@ struct overlay
       bool normalized;
    } config;
 
+   /* Uniform grid over the descriptors' hitboxes,
+    * rebuilt whenever the overlay is scaled. A pointer
+    * only has to be tested against the descriptors
+    * listed in the cell it falls into. */
+   struct
+   {
+      unsigned *cell_start; /* cols * rows + 1 offsets into descs */
+      unsigned *descs;
+      unsigned cols;
+      unsigned rows;
+      float x, y;
+      float x_scale, y_scale; /* cells per unit */
+   } hit_grid;
+
    bool full_screen;
    bool block_scale;
    bool block_x_separation;
@@ -130,6 +130,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_DELTA,
    "audio_rate_control_delta"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_ADAPTIVE,
+   "audio_rate_control_adaptive"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_AUDIO_RESAMPLER_DRIVER,
    "audio_resampler_driver"
@@ -1210,6 +1214,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_FASTFORWARD_RATIO,
    "fastforward_ratio"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_FASTFORWARD_FRAMESKIP,
+   "fastforward_frameskip"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_FILE_BROWSER_CORE,
    "file_browser_core"
@@ -1566,6 +1574,18 @@ MSG_HASH(
    MENU_ENUM_LABEL_INPUT_POLL_TYPE_BEHAVIOR,
    "input_poll_type_behavior"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_THREAD_PRIORITY_PROFILE,
+   "thread_priority_profile"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_THREAD_AFFINITY_FAST_CORES,
+   "thread_affinity_fast_cores"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_STATE_BUFFERS_LOCKED,
+   "state_buffers_locked"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_INPUT_PREFER_FRONT_TOUCH,
    "input_prefer_front_touch"
@@ -2202,6 +2222,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_MENU_INSERT_DISK_RESUME,
    "menu_insert_disk_resume"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_MENU_DEFER_INIT,
+   "menu_defer_init"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_QUIT_ON_CLOSE_CONTENT,
    "quit_on_close_content"
@@ -2650,6 +2674,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_REWIND_GRANULARITY,
    "rewind_granularity"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_REWIND_CHECKPOINT_INTERVAL,
+   "rewind_checkpoint_interval"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_REWIND_BUFFER_SIZE,
    "rewind_buffer_size"
@@ -2752,6 +2780,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_SAVESTATE_MAX_KEEP,
    "savestate_max_keep"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_SAVESTATE_CACHE_SLOTS,
+   "savestate_cache_slots"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_SAVESTATE_DIRECTORY,
    "savestate_directory"
@@ -2872,6 +2904,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_RUN_AHEAD_FRAMES,
    "run_ahead_frames"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_RUN_AHEAD_AUTO_DETECT,
+   "run_ahead_auto_detect"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_SORT_SAVEFILES_ENABLE,
    "sort_savefiles_enable"
@@ -3070,6 +3106,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_UNDO_SAVE_STATE,
    "undosavestate"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_MOVIE_SEEK,
+   "movie_seek"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_UPDATER_SETTINGS,
    "updater_settings"
@@ -3256,6 +3296,14 @@ MSG_HASH(
    MENU_ENUM_LABEL_VIDEO_FRAME_DELAY,
    "video_frame_delay"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VIDEO_FRAME_DELAY_AUTO,
+   "video_frame_delay_auto"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VIDEO_LATENCY_TEST,
+   "video_latency_test"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VIDEO_SHADER_DELAY,
    "video_shader_delay"
@@ -3272,6 +3320,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_VIDEO_GPU_RECORD,
    "video_gpu_record"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VIDEO_FRAME_EXPORT,
+   "video_frame_export"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VIDEO_GPU_SCREENSHOT,
    "video_gpu_screenshot"
@@ -3288,6 +3340,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_VIDEO_MAX_SWAPCHAIN_IMAGES,
    "video_max_swapchain_images"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VIDEO_GPU_MEMORY_BUDGET,
+   "video_gpu_memory_budget"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VIDEO_MESSAGE_POS_X,
    "video_message_pos_x"
@@ -3742,6 +3798,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_MENU_THROTTLE_FRAMERATE,
    "menu_throttle_framerate"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_MENU_SKIP_IDLE_FRAMES,
+   "menu_skip_idle_frames"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_OVERLAY_SETTINGS,
    "overlay_settings"
@@ -4648,6 +4708,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_PLAYLIST_FUZZY_ARCHIVE_MATCH,
    "playlist_fuzzy_archive_match"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_PLAYLIST_PREFETCH,
+   "playlist_prefetch"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_PLAYLIST_SUBLABEL_RUNTIME_TYPE,
    "playlist_sublabel_runtime_type"
@@ -4752,6 +4816,14 @@ MSG_HASH(
    MENU_ENUM_LABEL_VIDEO_RECORD_THREADS,
    "video_record_threads"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_INSTANT_REPLAY_LENGTH,
+   "instant_replay_length"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_STREAMING_RECORD_COPY,
+   "streaming_record_copy"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VIDEO_GPU_INDEX,
    "gpu_index"
@@ -1770,6 +1770,22 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_VIDEO_FRAME_DELAY,
    "Reduces latency at the cost of a higher risk of video stuttering. Adds a delay after VSync (in ms)."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_VIDEO_FRAME_DELAY_AUTO,
+   "Automatic Frame Delay"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_VIDEO_LATENCY_TEST,
+   "Latency Test"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_VIDEO_LATENCY_TEST,
+   "Mark the first frame shown after a button press of user 1 with a white square in the top left corner, and record the time each stage took in the 'latency' performance counters. Requires 'Performance Counters' to export the results."
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_VIDEO_FRAME_DELAY_AUTO,
+   "Adjust the frame delay at runtime to the largest value that still meets VSync, based on measured core frame times. 'Frame Delay' becomes the upper limit."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_VIDEO_HARD_SYNC,
    "Hard GPU Sync"
@@ -1994,6 +2010,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_AUDIO_RATE_CONTROL_DELTA,
    "Helps smooth out imperfections in timing when synchronizing audio and video. Be aware that if disabled, proper synchronization is nearly impossible to obtain."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_AUDIO_RATE_CONTROL_ADAPTIVE,
+   "Adaptive Rate Control"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_AUDIO_RATE_CONTROL_ADAPTIVE,
+   "Learn the clock drift between core and audio device and correct it continuously. This allows keeping the audio buffer less full, lowering latency, especially with variable refresh rate displays."
+   )
 
 /* Settings > Audio > MIDI */
 
@@ -2118,6 +2142,30 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_INPUT_POLL_TYPE_BEHAVIOR,
    "Influence how input polling is done in RetroArch. Setting it to 'Early' or 'Late' can result in less latency, depending on your configuration."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_THREAD_PRIORITY_PROFILE,
+   "Thread Priority"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_THREAD_PRIORITY_PROFILE,
+   "Raise the priority of the emulation, video and audio threads over background tasks. 'Realtime Audio' also requests realtime scheduling for the audio thread, which may need extra permissions."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_THREAD_AFFINITY_FAST_CORES,
+   "Keep Emulation on Fast Cores"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_THREAD_AFFINITY_FAST_CORES,
+   "On CPUs with cores of different speed (e.g. big.LITTLE), run the emulation, video and audio threads on the fast cores only and background tasks on the others. Has no effect on other CPUs."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_STATE_BUFFERS_LOCKED,
+   "Lock Rewind and Run-Ahead Memory"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_STATE_BUFFERS_LOCKED,
+   "Fault in and lock the rewind and Run-Ahead buffers in RAM when they are allocated, so that they never stall on page faults or get swapped out. Takes effect the next time the buffers are set up."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_INPUT_REMAP_BINDS_ENABLE,
    "Remap Controls for This Core"
@@ -2703,6 +2751,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_INPUT_META_AI_SERVICE,
    "Captures an image of the current content then translates and/or reads aloud any on-screen text.\n'AI Service' Must be enabled and configured."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_INPUT_META_INSTANT_REPLAY_SAVE,
+   "Save Instant Replay"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_INPUT_META_INSTANT_REPLAY_SAVE,
+   "Saves the last seconds of a running recording to a new file. 'Instant Replay Length' must be set."
+   )
 
 /* Settings > Input > Port # Controls */
 
@@ -2925,6 +2981,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_RUN_AHEAD_HIDE_WARNINGS,
    "Hide the warning message that appears when using Run-Ahead and the core does not support save states."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_RUN_AHEAD_AUTO_DETECT,
+   "Detect Run-Ahead Frames Automatically"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_RUN_AHEAD_AUTO_DETECT,
+   "While playing, replay the frames after a few button presses to find out how many frames the game takes to react to input. Run-Ahead is then set to match, and saved in the game override. Content whose game override already sets the number of frames is left alone."
+   )
 
 /* Settings > Core */
 
@@ -3120,6 +3184,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_SAVESTATE_MAX_KEEP,
    "Limit the number of save states that will be created when 'Increment Save State Index Automatically' is enabled. If limit is exceeded when saving a new state, the existing state with the lowest index will be deleted. A value of '0' means unlimited states will be recorded."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_SAVESTATE_CACHE_SLOTS,
+   "Save States Kept in Memory"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_SAVESTATE_CACHE_SLOTS,
+   "Keep this many recently saved or loaded states in RAM. Loading one of them is instant, without reading or decompressing the file. Repeated saves to a slot are written to disk once the previous write is done."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_SAVESTATE_AUTO_SAVE,
    "Auto Save State"
@@ -3313,6 +3385,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_FASTFORWARD_RATIO,
    "The maximum rate at which content will be run when using fast-forward (e.g., 5.0x for 60 fps content = 300 fps cap). If set to 0.0x, fast-forward ratio is unlimited (no FPS cap)."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_FASTFORWARD_FRAMESKIP,
+   "Fast-Forward Frameskip"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_FASTFORWARD_FRAMESKIP,
+   "Skip frames according to the display refresh rate while fast-forwarding, so that more time goes to running the content."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_SLOWMOTION_RATIO,
    "Slow-Motion Rate"
@@ -3329,6 +3409,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_MENU_ENUM_THROTTLE_FRAMERATE,
    "Makes sure the framerate is capped while inside the menu."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_MENU_SKIP_IDLE_FRAMES,
+   "Skip Idle Menu Frames"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_MENU_SKIP_IDLE_FRAMES,
+   "Stops redrawing the menu while nothing on screen changes, leaving the last frame displayed. Saves power on battery powered devices."
+   )
 
 /* Settings > Frame Throttle > Rewind */
 
@@ -3348,6 +3436,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_REWIND_GRANULARITY,
    "The number of frames to rewind per step. Higher values increase the rewind speed."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_REWIND_CHECKPOINT_INTERVAL,
+   "Rewind Checkpoint Interval"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_REWIND_CHECKPOINT_INTERVAL,
+   "Also keep a checkpoint of the game every this many seconds, in a quarter of the rewind buffer. Once rewind runs out of recent history, it carries on through these checkpoints, reaching minutes further back. Takes effect the next time rewind is set up."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_REWIND_BUFFER_SIZE,
    "Rewind Buffer Size (MB)"
@@ -3406,6 +3502,22 @@ MSG_HASH(
    MENU_ENUM_LABEL_VALUE_VIDEO_RECORD_THREADS,
    "Recording Threads"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_INSTANT_REPLAY_LENGTH,
+   "Instant Replay Length"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_INSTANT_REPLAY_LENGTH,
+   "Seconds of a recording to keep in memory. Nothing is written to disk until the 'Save Instant Replay' hotkey saves them to a new file. A value of '0' records everything to a file instead."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_STREAMING_RECORD_COPY,
+   "Record While Streaming"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_STREAMING_RECORD_COPY,
+   "Also save the stream to a file in the recording directory. The video is only encoded once, for both."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_VIDEO_POST_FILTER_RECORD,
    "Use Post Filter Recording"
@@ -3422,6 +3534,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_VIDEO_GPU_RECORD,
    "Record output of GPU shaded material if available."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_VIDEO_FRAME_EXPORT,
+   "Export Frames to Other Applications"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_VIDEO_FRAME_EXPORT,
+   "Publish each software rendered core frame through shared memory, so that local tools can grab it without capturing the screen."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_STREAMING_MODE,
    "Streaming Mode"
@@ -4059,6 +4179,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_MENU_INSERT_DISK_RESUME,
    "Automatically close the menu and resume content after inserting or loading a new disc."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_MENU_DEFER_INIT,
+   "Defer Menu on Direct Launch"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_MENU_DEFER_INIT,
+   "When content is launched from the command line, wait until the menu is first opened before loading it, its assets and the favorites. Content starts sooner."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_QUIT_ON_CLOSE_CONTENT,
    "Quit on Close Content"
@@ -5419,6 +5547,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_PLAYLIST_FUZZY_ARCHIVE_MATCH,
    "When searching playlists for entries associated with compressed files, match only the archive file name instead of [file name]+[content]. Enable this to avoid duplicate content history entries when loading compressed files."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_PLAYLIST_PREFETCH,
+   "Prefetch Hovered Entry"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_PLAYLIST_PREFETCH,
+   "Read the content, core and firmware of the highlighted playlist entry in the background, so that it launches faster from slow storage."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_SCAN_WITHOUT_CORE_MATCH,
    "Scan Without Core Match"
@@ -6340,6 +6476,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_UNDO_SAVE_STATE,
    "If a state was overwritten, it will roll back to the previous save state."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_MOVIE_SEEK,
+   "Seek Movie"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_MOVIE_SEEK,
+   "Jump to a frame number or a time of the movie being played back."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_ADD_TO_FAVORITES,
    "Add to Favorites"
@@ -8181,6 +8325,18 @@ MSG_HASH(
    MENU_ENUM_LABEL_VALUE_INPUT_POLL_TYPE_BEHAVIOR_LATE,
    "Late"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_THREAD_PRIORITY_PROFILE_DEFAULT,
+   "System Default"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_THREAD_PRIORITY_PROFILE_EMULATION,
+   "Favor Emulation"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_THREAD_PRIORITY_PROFILE_REALTIME_AUDIO,
+   "Favor Emulation, Realtime Audio"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_TIMEDATE_YMD_HMS,
    "YYYY-MM-DD HH:MM:SS"
@@ -10068,6 +10224,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_VIDEO_MAX_SWAPCHAIN_IMAGES,
    "Tells the video driver to explicitly use a specified buffering mode."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_VIDEO_GPU_MEMORY_BUDGET,
+   "GPU Memory Budget (MB)"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_VIDEO_GPU_MEMORY_BUDGET,
+   "Estimated GPU memory that menu textures, thumbnails, overlays and shaders may use together. Over it, cached thumbnails are unloaded and wallpapers are loaded without mipmaps. 0 disables the budget."
+   )
 MSG_HASH(
    MENU_ENUM_SUBLABEL_VIDEO_SHADER_PRESET_PARAMETERS,
    "Modifies the shader preset itself currently used in the menu."
@@ -11116,6 +11280,14 @@ MSG_HASH(
    MSG_FAILED_TO_LOAD_MOVIE_FILE,
    "Failed to load movie file"
    )
+MSG_HASH(
+   MSG_FAILED_TO_SEEK_MOVIE,
+   "Failed to seek movie"
+   )
+MSG_HASH(
+   MSG_MOVIE_SEEKED_TO_FRAME,
+   "Movie playback at frame"
+   )
 MSG_HASH(
    MSG_FAILED_TO_LOAD_OVERLAY,
    "Failed to load overlay."
@@ -11296,6 +11468,10 @@ MSG_HASH(
    MSG_INPUT_RENAME_ENTRY,
    "Rename Title"
    )
+MSG_HASH(
+   MSG_INPUT_MOVIE_SEEK,
+   "Frame or Time (hh:mm:ss)"
+   )
 MSG_HASH(
    MSG_INTERFACE,
    "Interface"
@@ -11432,6 +11608,18 @@ MSG_HASH(
    MSG_RECORDING_TO,
    "Recording to"
    )
+MSG_HASH(
+   MSG_INSTANT_REPLAY_BUFFERING,
+   "Keeping instant replay of"
+   )
+MSG_HASH(
+   MSG_INSTANT_REPLAY_SAVING,
+   "Saving instant replay to"
+   )
+MSG_HASH(
+   MSG_INSTANT_REPLAY_NOT_RUNNING,
+   "Instant replay is not running. Set its length and start recording first."
+   )
 MSG_HASH(
    MSG_REDIRECTING_CHEATFILE_TO,
    "Redirecting cheat file to"
@@ -11488,6 +11676,10 @@ MSG_HASH(
    MSG_REWINDING,
    "Rewinding."
    )
+MSG_HASH(
+   MSG_REWINDING_CHECKPOINTS,
+   "Rewinding through checkpoints."
+   )
 MSG_HASH(
    MSG_REWIND_INIT,
    "Initializing rewind buffer with size"
@@ -11808,6 +12000,14 @@ MSG_HASH(
    MSG_RUNAHEAD_FAILED_TO_CREATE_SECONDARY_INSTANCE,
    "Failed to create second instance.  Run-Ahead will now use only one instance."
    )
+MSG_HASH(
+   MSG_RUNAHEAD_LAG_FRAMES_DETECTED,
+   "Run-Ahead: %u lag frame(s) detected."
+   )
+MSG_HASH(
+   MSG_RUNAHEAD_LAG_FRAMES_NOT_DETECTED,
+   "Run-Ahead: could not detect the lag frames of this content."
+   )
 MSG_HASH(
    MSG_SCANNING_OF_FILE_FINISHED,
    "Scanning of file finished"
@@ -12286,6 +12486,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_VALUE_CPU_PERF_MODE_BALANCED,
    "Adapts to the current workload. Works well with most devices and emulators and helps saving power. Demanding games and cores might suffer a performance drop on some devices."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_CPU_PERF_MODE_MANAGED_FRAME_TIME,
+   "Frame Time (Managed)"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_VALUE_CPU_PERF_MODE_MANAGED_FRAME_TIME,
+   "Raises the frequency when the core gets close to missing its frame budget and lowers it while there is headroom. Saves power in lighter games on battery powered devices."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_CPU_POLICY_MIN_FREQ,
    "Minimum Frequency"
@@ -25,12 +25,19 @@
 #endif
 
 #include <audio/audio_mixer.h>
+#include <audio/audio_mix.h>
 #include <audio/audio_resampler.h>
 
 #ifdef HAVE_RWAV
 #include <formats/rwav.h>
 #endif
 #include <memalign.h>
+#include <retro_atomic.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#include <queues/spsc_ring.h>
+#endif
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -64,6 +71,19 @@
 #define AUDIO_MIXER_MAX_VOICES      8
 #define AUDIO_MIXER_TEMP_BUFFER 8192
 
+/* Compressed sounds that play for at most this long
+ * are decoded and resampled once when they are loaded,
+ * and are then mixed like WAV data */
+#define AUDIO_MIXER_PREDECODE_MAX_SECONDS 5
+
+#ifdef HAVE_THREADS
+/* How many samples the worker decodes each
+ * streaming voice ahead of the mixer */
+#define AUDIO_MIXER_STREAM_AHEAD (AUDIO_MIXER_TEMP_BUFFER * 2)
+/* Bounds the cost of a missed wakeup of the worker */
+#define AUDIO_MIXER_WORKER_TIMEOUT_USEC 10000
+#endif
+
 struct audio_mixer_sound
 {
    enum audio_mixer_type type;
@@ -115,69 +135,70 @@ struct audio_mixer_sound
    } types;
 };
 
-struct audio_mixer_voice
+/* Decodes a compressed sound to interleaved
+ * stereo float, at the sound's own sample rate */
+typedef struct audio_mixer_decoder
 {
+   enum audio_mixer_type type;
+   unsigned rate;
+
    union
    {
-      struct
-      {
-         unsigned position;
-      } wav;
-
 #ifdef HAVE_STB_VORBIS
-      struct
-      {
-         stb_vorbis *stream;
-         void       *resampler_data;
-         const retro_resampler_t *resampler;
-         float      *buffer;
-         unsigned    position;
-         unsigned    samples;
-         unsigned    buf_samples;
-         float       ratio;
-      } ogg;
+      stb_vorbis *ogg;
 #endif
-
 #ifdef HAVE_DR_FLAC
-      struct
-      {
-         float*      buffer;
-         drflac      *stream;
-         void        *resampler_data;
-         const retro_resampler_t *resampler;
-         unsigned    position;
-         unsigned    samples;
-         unsigned    buf_samples;
-         float       ratio;
-      } flac;
+      drflac *flac;
 #endif
-
 #ifdef HAVE_DR_MP3
-      struct
-      {
-         drmp3       stream;
-         void        *resampler_data;
-         const retro_resampler_t *resampler;
-         float*      buffer;
-         unsigned    position;
-         unsigned    samples;
-         unsigned    buf_samples;
-         float       ratio;
-      } mp3;
+      /* Points into itself - must not be copied */
+      drmp3 mp3;
 #endif
-
 #ifdef HAVE_IBXM
       struct
       {
-         int*              buffer;
-         struct replay*    stream;
-         struct module*    module;
-         unsigned          position;
-         unsigned          samples;
-         unsigned          buf_samples;
+         struct module* module;
+         struct replay* replay;
+         int*           buffer;
+         unsigned       position;
+         unsigned       samples;
       } mod;
 #endif
+      int dummy;
    } types;
+} audio_mixer_decoder_t;
+
+struct audio_mixer_voice
+{
+   struct
+   {
+      unsigned position;
+   } wav;
+
+   /* Everything but WAV is decoded while playing */
+   struct
+   {
+      audio_mixer_decoder_t decoder;
+      void *resampler_data;
+      const retro_resampler_t *resampler;
+      /* Decoded and resampled samples, of which
+       * [position, samples) are not yet mixed (or,
+       * with the worker, not yet queued) */
+      float *buffer;
+      unsigned position;
+      unsigned samples;
+      unsigned buf_samples;
+      float ratio;
+#ifdef HAVE_THREADS
+      /* Filled by the worker, drained by the mixer */
+      spsc_ring_t ring;
+#endif
+      /* Repeats not yet reported to stop_cb */
+      retro_atomic_int_t repeats;
+      /* Set once the last sample has been decoded */
+      retro_atomic_int_t finished;
+   } stream;
+
    audio_mixer_sound_t *sound;
    audio_mixer_stop_cb_t stop_cb;
    unsigned type;
@@ -189,6 +210,38 @@ struct audio_mixer_voice
 /* TODO/FIXME - static globals */
 static struct audio_mixer_voice s_voices[AUDIO_MIXER_MAX_VOICES] = {0};
 static unsigned s_rate = 0;
+/* Decoder output before resampling - only ever
+ * used by whoever feeds the voices (the worker,
+ * or the mixer itself without one) */
+static float s_decode_buffer[AUDIO_MIXER_TEMP_BUFFER];
+
+#ifdef HAVE_THREADS
+/* Decodes streaming voices ahead, so that
+ * audio_mixer_mix() only has to copy samples.
+ * s_lock guards the voices against the worker;
+ * the worker holds it except while waiting */
+static sthread_t *s_worker      = NULL;
+static slock_t   *s_lock        = NULL;
+static scond_t   *s_cond        = NULL;
+static bool       s_worker_quit = false;
+static float      s_mix_buffer[AUDIO_MIXER_TEMP_BUFFER];
+#endif
+
+static void audio_mixer_lock(void)
+{
+#ifdef HAVE_THREADS
+   if (s_lock)
+      slock_lock(s_lock);
+#endif
+}
+
+static void audio_mixer_unlock(void)
+{
+#ifdef HAVE_THREADS
+   if (s_lock)
+      slock_unlock(s_lock);
+#endif
+}
 
 #ifdef HAVE_RWAV
 static bool wav_to_float(const rwav_t* wav, float** pcm, size_t samples_out)
@@ -266,6 +319,9 @@ static bool wav_to_float(const rwav_t* wav, float** pcm, size_t samples_out)
    return true;
 }
 
+#endif
+
+#if defined(HAVE_RWAV) || defined(HAVE_STB_VORBIS) || defined(HAVE_DR_FLAC) || defined(HAVE_DR_MP3) || defined(HAVE_IBXM)
 static bool one_shot_resample(const float* in, size_t samples_in,
       unsigned rate, float** out, size_t* samples_out)
 {
@@ -291,7 +347,10 @@ static bool one_shot_resample(const float* in, size_t samples_in,
          ((*samples_out + 15) & ~15) * sizeof(float));
 
    if (*out == NULL)
+   {
+      resampler->free(data);
       return false;
+   }
 
    info.data_in                       = in;
    info.data_out                      = *out;
@@ -301,8 +360,528 @@ static bool one_shot_resample(const float* in, size_t samples_in,
 
    resampler->process(data, &info);
    resampler->free(data);
+
+   /* Don't mix the padding */
+   if (info.output_frames * 2 < *samples_out)
+      *samples_out                    = info.output_frames * 2;
+   return true;
+}
+#endif
+
+static bool audio_mixer_decoder_open(audio_mixer_decoder_t *dec,
+      const audio_mixer_sound_t *sound)
+{
+   memset(dec, 0, sizeof(*dec));
+
+   switch (sound->type)
+   {
+#ifdef HAVE_STB_VORBIS
+      case AUDIO_MIXER_TYPE_OGG:
+         {
+            stb_vorbis_info info;
+            int res        = 0;
+            dec->types.ogg = stb_vorbis_open_memory(
+                  (const unsigned char*)sound->types.ogg.data,
+                  sound->types.ogg.size, &res, NULL);
+
+            if (!dec->types.ogg)
+               return false;
+
+            info           = stb_vorbis_get_info(dec->types.ogg);
+            dec->rate      = info.sample_rate;
+         }
+         break;
+#endif
+#ifdef HAVE_DR_FLAC
+      case AUDIO_MIXER_TYPE_FLAC:
+         dec->types.flac = drflac_open_memory(
+               (const unsigned char*)sound->types.flac.data,
+               sound->types.flac.size);
+
+         if (!dec->types.flac)
+            return false;
+
+         if (     dec->types.flac->channels != 1
+               && dec->types.flac->channels != 2)
+         {
+            drflac_close(dec->types.flac);
+            return false;
+         }
+
+         dec->rate       = dec->types.flac->sampleRate;
+         break;
+#endif
+#ifdef HAVE_DR_MP3
+      case AUDIO_MIXER_TYPE_MP3:
+         /* Always outputs stereo */
+         if (!drmp3_init_memory(&dec->types.mp3,
+                  (const unsigned char*)sound->types.mp3.data,
+                  sound->types.mp3.size, NULL))
+            return false;
+
+         dec->rate       = dec->types.mp3.sampleRate;
+         break;
+#endif
+#ifdef HAVE_IBXM
+      case AUDIO_MIXER_TYPE_MOD:
+         {
+            struct data data;
+            char message[64];
+            int buf_samples            = calculate_mix_buf_len(s_rate);
+
+            data.buffer                = (char*)sound->types.mod.data;
+            data.length                = sound->types.mod.size;
+
+            if (!(dec->types.mod.module = module_load(&data, message)))
+            {
+               printf("audio_mixer: module_load() failed with error: %s\n", message);
+               return false;
+            }
+
+            /* Renders at the output rate directly */
+            dec->types.mod.replay      = new_replay(
+                  dec->types.mod.module, s_rate, 1);
+            dec->types.mod.buffer      = (int*)memalign_alloc(16,
+                  ((buf_samples + 15) & ~15) * sizeof(int));
+
+            if (     !dec->types.mod.replay
+                  || !dec->types.mod.buffer
+                  || !replay_calculate_duration(dec->types.mod.replay))
+            {
+               printf("audio_mixer: cannot start module replay\n");
+               if (dec->types.mod.buffer)
+                  memalign_free(dec->types.mod.buffer);
+               if (dec->types.mod.replay)
+                  dispose_replay(dec->types.mod.replay);
+               dispose_module(dec->types.mod.module);
+               return false;
+            }
+
+            dec->rate                  = s_rate;
+         }
+         break;
+#endif
+      default:
+         return false;
+   }
+
+   dec->type = sound->type;
+   return true;
+}
+
+static void audio_mixer_decoder_close(audio_mixer_decoder_t *dec)
+{
+   switch (dec->type)
+   {
+#ifdef HAVE_STB_VORBIS
+      case AUDIO_MIXER_TYPE_OGG:
+         stb_vorbis_close(dec->types.ogg);
+         break;
+#endif
+#ifdef HAVE_DR_FLAC
+      case AUDIO_MIXER_TYPE_FLAC:
+         drflac_close(dec->types.flac);
+         break;
+#endif
+#ifdef HAVE_DR_MP3
+      case AUDIO_MIXER_TYPE_MP3:
+         drmp3_uninit(&dec->types.mp3);
+         break;
+#endif
+#ifdef HAVE_IBXM
+      case AUDIO_MIXER_TYPE_MOD:
+         dispose_replay(dec->types.mod.replay);
+         dispose_module(dec->types.mod.module);
+         memalign_free(dec->types.mod.buffer);
+         break;
+#endif
+      default:
+         break;
+   }
+
+   dec->type = AUDIO_MIXER_TYPE_NONE;
+}
+
+static void audio_mixer_decoder_rewind(audio_mixer_decoder_t *dec)
+{
+   switch (dec->type)
+   {
+#ifdef HAVE_STB_VORBIS
+      case AUDIO_MIXER_TYPE_OGG:
+         stb_vorbis_seek_start(dec->types.ogg);
+         break;
+#endif
+#ifdef HAVE_DR_FLAC
+      case AUDIO_MIXER_TYPE_FLAC:
+         drflac_seek_to_sample(dec->types.flac, 0);
+         break;
+#endif
+#ifdef HAVE_DR_MP3
+      case AUDIO_MIXER_TYPE_MP3:
+         drmp3_seek_to_frame(&dec->types.mp3, 0);
+         break;
+#endif
+#ifdef HAVE_IBXM
+      case AUDIO_MIXER_TYPE_MOD:
+         replay_seek(dec->types.mod.replay, 0);
+         dec->types.mod.position = 0;
+         dec->types.mod.samples  = 0;
+         break;
+#endif
+      default:
+         break;
+   }
+}
+
+/* Reads up to 'frames' frames into 'out', which
+ * must have room for 'frames' * 2 samples
+ * Returns 0 at the end of the sound */
+static unsigned audio_mixer_decoder_read(audio_mixer_decoder_t *dec,
+      float *out, unsigned frames)
+{
+   switch (dec->type)
+   {
+#ifdef HAVE_STB_VORBIS
+      case AUDIO_MIXER_TYPE_OGG:
+         return (unsigned)stb_vorbis_get_samples_float_interleaved(
+               dec->types.ogg, 2, out, frames * 2);
+#endif
+#ifdef HAVE_DR_FLAC
+      case AUDIO_MIXER_TYPE_FLAC:
+         if (dec->types.flac->channels == 1)
+         {
+            /* Decode into the upper half, then spread
+             * out front to back - each store only lands
+             * on mono samples that were already read */
+            unsigned i;
+            float *mono = out + frames;
+
+            frames      = (unsigned)drflac_read_f32(
+                  dec->types.flac, frames, mono);
+
+            for (i = 0; i < frames; i++)
+            {
+               float sample = mono[i];
+               out[2 * i]     = sample;
+               out[2 * i + 1] = sample;
+            }
+
+            return frames;
+         }
+         return (unsigned)(drflac_read_f32(
+                  dec->types.flac, frames * 2, out) / 2);
+#endif
+#ifdef HAVE_DR_MP3
+      case AUDIO_MIXER_TYPE_MP3:
+         return (unsigned)drmp3_read_f32(&dec->types.mp3, frames, out);
+#endif
+#ifdef HAVE_IBXM
+      case AUDIO_MIXER_TYPE_MOD:
+         {
+            unsigned read = 0;
+
+            while (read < frames)
+            {
+               unsigned i, count;
+               const int *pcm;
+
+               if (dec->types.mod.position == dec->types.mod.samples)
+               {
+                  dec->types.mod.position = 0;
+                  dec->types.mod.samples  = replay_get_audio(
+                        dec->types.mod.replay, dec->types.mod.buffer, 0) * 2;
+
+                  if (dec->types.mod.samples == 0)
+                     break;
+               }
+
+               count = dec->types.mod.samples - dec->types.mod.position;
+               if (count > (frames - read) * 2)
+                  count = (frames - read) * 2;
+
+               pcm   = dec->types.mod.buffer + dec->types.mod.position;
+
+               for (i = count; i != 0; i--)
+               {
+                  float samplef = ((float)(*pcm++) + 32768.0f) / 65535.0f;
+                  *out++        = samplef * 2.0f - 1.0f;
+               }
+
+               dec->types.mod.position += count;
+               read                    += count / 2;
+            }
+
+            return read;
+         }
+#endif
+      default:
+         break;
+   }
+
+   return 0;
+}
+
+#if defined(HAVE_STB_VORBIS) || defined(HAVE_DR_FLAC) || defined(HAVE_DR_MP3) || defined(HAVE_IBXM)
+/* Length of the sound in frames, or 0 if the
+ * format can't tell without decoding it */
+static size_t audio_mixer_decoder_length(audio_mixer_decoder_t *dec)
+{
+   switch (dec->type)
+   {
+#ifdef HAVE_STB_VORBIS
+      case AUDIO_MIXER_TYPE_OGG:
+         return stb_vorbis_stream_length_in_samples(dec->types.ogg);
+#endif
+#ifdef HAVE_DR_FLAC
+      case AUDIO_MIXER_TYPE_FLAC:
+         return (size_t)(dec->types.flac->totalSampleCount /
+               dec->types.flac->channels);
+#endif
+#ifdef HAVE_IBXM
+      case AUDIO_MIXER_TYPE_MOD:
+         return replay_calculate_duration(dec->types.mod.replay);
+#endif
+      default:
+         break;
+   }
+
+   return 0;
+}
+
+/* Turns a short compressed sound into a WAV one, so
+ * that playing it never involves a decoder. Longer
+ * sounds are left alone, and are streamed */
+static void audio_mixer_predecode(audio_mixer_sound_t *sound)
+{
+   audio_mixer_decoder_t dec;
+   size_t max_frames, length;
+   size_t samples    = 0;
+   size_t frames     = 0;
+   size_t capacity   = 0;
+   float *pcm        = NULL;
+   float *out        = NULL;
+   void *data        = NULL;
+   unsigned rate;
+   bool fits         = true;
+
+   /* Output rate isn't known yet */
+   if (!s_rate || !audio_mixer_decoder_open(&dec, sound))
+      return;
+
+   rate       = dec.rate;
+   max_frames = (size_t)rate * AUDIO_MIXER_PREDECODE_MAX_SECONDS;
+
+   length     = audio_mixer_decoder_length(&dec);
+
+   if (length > max_frames)
+      fits    = false;
+
+   while (fits)
+   {
+      unsigned read;
+
+      if (capacity - frames < AUDIO_MIXER_TEMP_BUFFER / 2)
+      {
+         float *tmp = NULL;
+         capacity   = capacity ? capacity * 2 : AUDIO_MIXER_TEMP_BUFFER;
+
+         if (!(tmp = (float*)realloc(pcm, capacity * 2 * sizeof(float))))
+         {
+            fits    = false;
+            break;
+         }
+
+         pcm        = tmp;
+      }
+
+      if (!(read = audio_mixer_decoder_read(&dec,
+                  pcm + frames * 2, AUDIO_MIXER_TEMP_BUFFER / 2)))
+         break;
+
+      if ((frames += read) > max_frames)
+         fits       = false;
+      /* Modules never run dry, they loop */
+      else if (length && frames >= length)
+      {
+         frames     = length;
+         break;
+      }
+   }
+
+   audio_mixer_decoder_close(&dec);
+
+   if (!fits || !frames)
+      goto end;
+
+   samples = frames * 2;
+
+   if (rate != s_rate)
+   {
+      if (!one_shot_resample(pcm, samples, rate, &out, &samples))
+         goto end;
+   }
+   else
+   {
+      /* Same alignment and padding as wav_to_float() */
+      if (!(out = (float*)memalign_alloc(16,
+                  ((samples + 15) & ~15) * sizeof(float))))
+         goto end;
+      memcpy(out, pcm, samples * sizeof(float));
+   }
+
+   switch (sound->type)
+   {
+#ifdef HAVE_STB_VORBIS
+      case AUDIO_MIXER_TYPE_OGG:
+         data = (void*)sound->types.ogg.data;
+         break;
+#endif
+#ifdef HAVE_DR_FLAC
+      case AUDIO_MIXER_TYPE_FLAC:
+         data = (void*)sound->types.flac.data;
+         break;
+#endif
+#ifdef HAVE_DR_MP3
+      case AUDIO_MIXER_TYPE_MP3:
+         data = (void*)sound->types.mp3.data;
+         break;
+#endif
+#ifdef HAVE_IBXM
+      case AUDIO_MIXER_TYPE_MOD:
+         data = (void*)sound->types.mod.data;
+         break;
+#endif
+      default:
+         break;
+   }
+
+   /* The sound owns its compressed data */
+   if (data)
+      free(data);
+
+   sound->type             = AUDIO_MIXER_TYPE_WAV;
+   sound->types.wav.pcm    = out;
+   sound->types.wav.frames = (unsigned)(samples / 2);
+
+end:
+   if (pcm)
+      free(pcm);
+}
+#endif
+
+/* Frees what a streaming voice keeps
+ * around after it stopped playing */
+static void audio_mixer_stream_free(audio_mixer_voice_t *voice)
+{
+   audio_mixer_decoder_close(&voice->stream.decoder);
+
+   if (voice->stream.resampler && voice->stream.resampler_data)
+      voice->stream.resampler->free(voice->stream.resampler_data);
+   if (voice->stream.buffer)
+      memalign_free(voice->stream.buffer);
+
+   voice->stream.resampler      = NULL;
+   voice->stream.resampler_data = NULL;
+   voice->stream.buffer         = NULL;
+   voice->stream.position       = 0;
+   voice->stream.samples        = 0;
+}
+
+/* Decodes and resamples the next chunk of a streaming
+ * voice into its buffer, rewinding it if it repeats
+ * Returns false once the sound is over */
+static bool audio_mixer_stream_decode(audio_mixer_voice_t *voice)
+{
+   unsigned frames = audio_mixer_decoder_read(&voice->stream.decoder,
+         s_decode_buffer, AUDIO_MIXER_TEMP_BUFFER / 2);
+
+   if (frames == 0 && voice->repeat)
+   {
+      audio_mixer_decoder_rewind(&voice->stream.decoder);
+      retro_atomic_fetch_add(&voice->stream.repeats, 1);
+
+      frames = audio_mixer_decoder_read(&voice->stream.decoder,
+            s_decode_buffer, AUDIO_MIXER_TEMP_BUFFER / 2);
+   }
+
+   if (frames == 0)
+      return false;
+
+   if (voice->stream.resampler)
+   {
+      struct resampler_data info;
+
+      info.data_in           = s_decode_buffer;
+      info.data_out          = voice->stream.buffer;
+      info.input_frames      = frames;
+      info.output_frames     = 0;
+      info.ratio             = voice->stream.ratio;
+
+      voice->stream.resampler->process(
+            voice->stream.resampler_data, &info);
+
+      voice->stream.samples  = (unsigned)(info.output_frames * 2);
+   }
+   else
+   {
+      memcpy(voice->stream.buffer, s_decode_buffer,
+            frames * 2 * sizeof(float));
+      voice->stream.samples  = frames * 2;
+   }
+
+   voice->stream.position    = 0;
    return true;
 }
+
+#ifdef HAVE_THREADS
+static void audio_mixer_worker(void *data)
+{
+   slock_lock(s_lock);
+
+   while (!s_worker_quit)
+   {
+      unsigned i;
+      bool busy = false;
+
+      for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
+      {
+         size_t written;
+         audio_mixer_voice_t *voice = &s_voices[i];
+
+         if (     voice->type == AUDIO_MIXER_TYPE_NONE
+               || voice->type == AUDIO_MIXER_TYPE_WAV
+               || retro_atomic_load(&voice->stream.finished))
+            continue;
+
+         if (voice->stream.position == voice->stream.samples)
+         {
+            if (!audio_mixer_stream_decode(voice))
+            {
+               retro_atomic_store(&voice->stream.finished, 1);
+               continue;
+            }
+         }
+
+         /* Always whole frames, as the ring holds whole frames */
+         written = spsc_ring_write(&voice->stream.ring,
+               voice->stream.buffer + voice->stream.position,
+               (voice->stream.samples - voice->stream.position)
+               * sizeof(float)) / sizeof(float);
+
+         voice->stream.position += (unsigned)written;
+
+         /* Ring still has room - decode more */
+         if (voice->stream.position == voice->stream.samples)
+            busy = true;
+      }
+
+      if (!busy)
+         scond_wait_timeout(s_cond, s_lock,
+               AUDIO_MIXER_WORKER_TIMEOUT_USEC);
+   }
+
+   slock_unlock(s_lock);
+}
 #endif
 
 void audio_mixer_init(unsigned rate)
@@ -313,14 +892,64 @@ void audio_mixer_init(unsigned rate)
 
    for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
       s_voices[i].type = AUDIO_MIXER_TYPE_NONE;
+
+#ifdef HAVE_THREADS
+   if (s_worker)
+      return;
+
+   s_lock        = slock_new();
+   s_cond        = scond_new();
+   s_worker_quit = false;
+
+   if (s_lock && s_cond)
+      s_worker   = sthread_create(audio_mixer_worker, NULL);
+
+   /* Voices are then decoded by the mixer itself */
+   if (!s_worker)
+   {
+      if (s_cond)
+         scond_free(s_cond);
+      if (s_lock)
+         slock_free(s_lock);
+      s_cond     = NULL;
+      s_lock     = NULL;
+   }
+#endif
 }
 
 void audio_mixer_done(void)
 {
    unsigned i;
 
+   audio_mixer_lock();
    for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
       s_voices[i].type = AUDIO_MIXER_TYPE_NONE;
+#ifdef HAVE_THREADS
+   s_worker_quit = true;
+   if (s_cond)
+      scond_signal(s_cond);
+#endif
+   audio_mixer_unlock();
+
+#ifdef HAVE_THREADS
+   if (s_worker)
+   {
+      sthread_join(s_worker);
+      scond_free(s_cond);
+      slock_free(s_lock);
+   }
+   s_worker = NULL;
+   s_cond   = NULL;
+   s_lock   = NULL;
+#endif
+
+   for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
+   {
+      audio_mixer_stream_free(&s_voices[i]);
+#ifdef HAVE_THREADS
+      spsc_ring_deinitialize(&s_voices[i].stream.ring);
+#endif
+   }
 }
 
 audio_mixer_sound_t* audio_mixer_load_wav(void *buffer, int32_t size)
@@ -393,6 +1022,8 @@ audio_mixer_sound_t* audio_mixer_load_ogg(void *buffer, int32_t size)
    sound->types.ogg.size = size;
    sound->types.ogg.data = buffer;
 
+   audio_mixer_predecode(sound);
+
    return sound;
 #else
    return NULL;
@@ -411,6 +1042,8 @@ audio_mixer_sound_t* audio_mixer_load_flac(void *buffer, int32_t size)
    sound->types.flac.size = size;
    sound->types.flac.data = buffer;
 
+   audio_mixer_predecode(sound);
+
    return sound;
 #else
    return NULL;
@@ -429,6 +1062,8 @@ audio_mixer_sound_t* audio_mixer_load_mp3(void *buffer, int32_t size)
    sound->types.mp3.size = size;
    sound->types.mp3.data = buffer;
 
+   audio_mixer_predecode(sound);
+
    return sound;
 #else
    return NULL;
@@ -447,6 +1082,8 @@ audio_mixer_sound_t* audio_mixer_load_mod(void *buffer, int32_t size)
    sound->types.mod.size = size;
    sound->types.mod.data = buffer;
 
+   audio_mixer_predecode(sound);
+
    return sound;
 #else
    return NULL;
@@ -501,251 +1138,41 @@ void audio_mixer_destroy(audio_mixer_sound_t* sound)
    free(sound);
 }
 
+
 static bool audio_mixer_play_wav(audio_mixer_sound_t* sound,
       audio_mixer_voice_t* voice, bool repeat, float volume,
       audio_mixer_stop_cb_t stop_cb)
 {
-   voice->types.wav.position = 0;
+   voice->wav.position = 0;
    return true;
 }
 
-#ifdef HAVE_STB_VORBIS
-static bool audio_mixer_play_ogg(
-      audio_mixer_sound_t* sound,
-      audio_mixer_voice_t* voice,
-      bool repeat, float volume,
-      audio_mixer_stop_cb_t stop_cb)
+static bool audio_mixer_play_stream(audio_mixer_sound_t* sound,
+      audio_mixer_voice_t* voice)
 {
-   stb_vorbis_info info;
-   int res                         = 0;
    float ratio                     = 1.0f;
    unsigned samples                = 0;
-   void *ogg_buffer                = NULL;
    void *resampler_data            = NULL;
    const retro_resampler_t* resamp = NULL;
-   stb_vorbis *stb_vorbis          = stb_vorbis_open_memory(
-         (const unsigned char*)sound->types.ogg.data,
-         sound->types.ogg.size, &res, NULL);
-
-   if (!stb_vorbis)
-      return false;
-
-   info                    = stb_vorbis_get_info(stb_vorbis);
-
-   if (info.sample_rate != s_rate)
-   {
-      ratio = (double)s_rate / (double)info.sample_rate;
-
-      if (!retro_resampler_realloc(&resampler_data,
-               &resamp, NULL, RESAMPLER_QUALITY_DONTCARE,
-               ratio))
-         goto error;
-   }
-
-   samples                         = (unsigned)(AUDIO_MIXER_TEMP_BUFFER * ratio);
-   ogg_buffer                      = (float*)memalign_alloc(16,
-         ((samples + 15) & ~15) * sizeof(float));
-
-   if (!ogg_buffer)
-   {
-      if (resamp && resampler_data)
-         resamp->free(resampler_data);
-      goto error;
-   }
-
-   /* "system" menu sounds may reuse the same voice without freeing anything first, so do that here if needed */
-   if (voice->types.ogg.stream)
-      stb_vorbis_close(voice->types.ogg.stream);
-   if (voice->types.ogg.resampler && voice->types.ogg.resampler_data)
-      voice->types.ogg.resampler->free(voice->types.ogg.resampler_data);
-   if (voice->types.ogg.buffer)
-      memalign_free(voice->types.ogg.buffer);
-
-   voice->types.ogg.resampler      = resamp;
-   voice->types.ogg.resampler_data = resampler_data;
-   voice->types.ogg.buffer         = (float*)ogg_buffer;
-   voice->types.ogg.buf_samples    = samples;
-   voice->types.ogg.ratio          = ratio;
-   voice->types.ogg.stream         = stb_vorbis;
-   voice->types.ogg.position       = 0;
-   voice->types.ogg.samples        = 0;
-
-   return true;
-
-error:
-   stb_vorbis_close(stb_vorbis);
-   return false;
-}
-#endif
-
-#ifdef HAVE_IBXM
-static bool audio_mixer_play_mod(
-      audio_mixer_sound_t* sound,
-      audio_mixer_voice_t* voice,
-      bool repeat, float volume,
-      audio_mixer_stop_cb_t stop_cb)
-{
-   struct data data;
-   char message[64];
-   int buf_samples               = 0;
-   int samples                   = 0;
-   void *mod_buffer              = NULL;
-   struct module* module         = NULL;
-   struct replay* replay         = NULL;
-
-   data.buffer                   = (char*)sound->types.mod.data;
-   data.length                   = sound->types.mod.size;
-   module                        = module_load(&data, message);
-
-   if (!module)
-   {
-      printf("audio_mixer_play_mod module_load() failed with error: %s\n", message);
-      goto error;
-   }
-
-   if (voice->types.mod.module)
-      dispose_module(voice->types.mod.module);
-
-   voice->types.mod.module = module;
-
-   replay = new_replay(module, s_rate, 1);
-
-   if (!replay)
-   {
-      printf("audio_mixer_play_mod new_replay() failed\n");
-      goto error;
-   }
-
-   buf_samples = calculate_mix_buf_len(s_rate);
-   mod_buffer  = memalign_alloc(16, ((buf_samples + 15) & ~15) * sizeof(int));
-
-   if (!mod_buffer)
-   {
-      printf("audio_mixer_play_mod cannot allocate mod_buffer !\n");
-      goto error;
-   }
-
-   samples = replay_calculate_duration(replay);
-
-   if (!samples)
-   {
-      printf("audio_mixer_play_mod cannot retrieve duration !\n");
-      goto error;
-   }
-
-   /* FIXME: stopping and then starting a mod stream will crash here in dispose_replay (ASAN says struct replay is misaligned?) */
-   if (voice->types.mod.stream)
-      dispose_replay(voice->types.mod.stream);
-   if (voice->types.mod.buffer)
-      memalign_free(voice->types.mod.buffer);
-
-   voice->types.mod.buffer         = (int*)mod_buffer;
-   voice->types.mod.buf_samples    = buf_samples;
-   voice->types.mod.stream         = replay;
-   voice->types.mod.position       = 0;
-   voice->types.mod.samples        = 0; /* samples; */
-
-   return true;
 
-error:
-   if (mod_buffer)
-      memalign_free(mod_buffer);
-   if (module)
-      dispose_module(module);
-   return false;
-
-}
-#endif
-
-#ifdef HAVE_DR_FLAC
-static bool audio_mixer_play_flac(
-      audio_mixer_sound_t* sound,
-      audio_mixer_voice_t* voice,
-      bool repeat, float volume,
-      audio_mixer_stop_cb_t stop_cb)
-{
-   float ratio                     = 1.0f;
-   unsigned samples                = 0;
-   void *flac_buffer                = NULL;
-   void *resampler_data            = NULL;
-   const retro_resampler_t* resamp = NULL;
-   drflac *dr_flac          = drflac_open_memory((const unsigned char*)sound->types.flac.data,sound->types.flac.size);
+   /* "system" menu sounds may reuse the same voice without
+    * freeing anything first, so do that here if needed */
+   audio_mixer_stream_free(voice);
 
-   if (!dr_flac)
+#ifdef HAVE_THREADS
+   if (     s_worker
+         && !voice->stream.ring.buffer
+         && !spsc_ring_initialize(&voice->stream.ring,
+            AUDIO_MIXER_STREAM_AHEAD * sizeof(float)))
       return false;
-   if (dr_flac->sampleRate != s_rate)
-   {
-      ratio = (double)s_rate / (double)(dr_flac->sampleRate);
-
-      if (!retro_resampler_realloc(&resampler_data,
-               &resamp, NULL, RESAMPLER_QUALITY_DONTCARE,
-               ratio))
-         goto error;
-   }
-
-   samples                         = (unsigned)(AUDIO_MIXER_TEMP_BUFFER * ratio);
-   flac_buffer                      = (float*)memalign_alloc(16,
-         ((samples + 15) & ~15) * sizeof(float));
-
-   if (!flac_buffer)
-   {
-      if (resamp && resamp->free)
-         resamp->free(resampler_data);
-      goto error;
-   }
-
-   if (voice->types.flac.stream)
-      drflac_close(voice->types.flac.stream);
-   if (voice->types.flac.resampler && voice->types.flac.resampler_data)
-      voice->types.flac.resampler->free(voice->types.flac.resampler_data);
-   if (voice->types.flac.buffer)
-      memalign_free(voice->types.flac.buffer);
-
-   voice->types.flac.resampler      = resamp;
-   voice->types.flac.resampler_data = resampler_data;
-   voice->types.flac.buffer         = (float*)flac_buffer;
-   voice->types.flac.buf_samples    = samples;
-   voice->types.flac.ratio          = ratio;
-   voice->types.flac.stream         = dr_flac;
-   voice->types.flac.position       = 0;
-   voice->types.flac.samples        = 0;
-
-   return true;
-
-error:
-   drflac_close(dr_flac);
-   return false;
-}
 #endif
 
-#ifdef HAVE_DR_MP3
-static bool audio_mixer_play_mp3(
-      audio_mixer_sound_t* sound,
-      audio_mixer_voice_t* voice,
-      bool repeat, float volume,
-      audio_mixer_stop_cb_t stop_cb)
-{
-   float ratio                     = 1.0f;
-   unsigned samples                = 0;
-   void *mp3_buffer                = NULL;
-   void *resampler_data            = NULL;
-   const retro_resampler_t* resamp = NULL;
-   bool res;
-
-   if (voice->types.mp3.stream.pData)
-   {
-      drmp3_uninit(&voice->types.mp3.stream);
-      memset(&voice->types.mp3.stream, 0, sizeof(voice->types.mp3.stream));
-   }
-
-   res = drmp3_init_memory(&voice->types.mp3.stream, (const unsigned char*)sound->types.mp3.data, sound->types.mp3.size, NULL);
-
-   if (!res)
+   if (!audio_mixer_decoder_open(&voice->stream.decoder, sound))
       return false;
 
-   if (voice->types.mp3.stream.sampleRate != s_rate)
+   if (voice->stream.decoder.rate != s_rate)
    {
-      ratio = (double)s_rate / (double)(voice->types.mp3.stream.sampleRate);
+      ratio = (double)s_rate / (double)voice->stream.decoder.rate;
 
       if (!retro_resampler_realloc(&resampler_data,
                &resamp, NULL, RESAMPLER_QUALITY_DONTCARE,
@@ -753,38 +1180,35 @@ static bool audio_mixer_play_mp3(
          goto error;
    }
 
-   samples                         = (unsigned)(AUDIO_MIXER_TEMP_BUFFER * ratio);
-   mp3_buffer                      = (float*)memalign_alloc(16,
+   voice->stream.resampler      = resamp;
+   voice->stream.resampler_data = resampler_data;
+
+   /* One decoded chunk, plus some slack for the
+    * resampler, which may round up */
+   samples                      = (unsigned)(AUDIO_MIXER_TEMP_BUFFER * ratio) + 16;
+   voice->stream.buffer         = (float*)memalign_alloc(16,
          ((samples + 15) & ~15) * sizeof(float));
 
-   if (!mp3_buffer)
-   {
-      if (resamp && resampler_data)
-         resamp->free(resampler_data);
+   if (!voice->stream.buffer)
       goto error;
-   }
 
-   /* "system" menu sounds may reuse the same voice without freeing anything first, so do that here if needed */
-   if (voice->types.mp3.resampler && voice->types.mp3.resampler_data)
-      voice->types.mp3.resampler->free(voice->types.mp3.resampler_data);
-   if (voice->types.mp3.buffer)
-      memalign_free(voice->types.mp3.buffer);
-
-   voice->types.mp3.resampler      = resamp;
-   voice->types.mp3.resampler_data = resampler_data;
-   voice->types.mp3.buffer         = (float*)mp3_buffer;
-   voice->types.mp3.buf_samples    = samples;
-   voice->types.mp3.ratio          = ratio;
-   voice->types.mp3.position       = 0;
-   voice->types.mp3.samples        = 0;
+   voice->stream.buf_samples    = samples;
+   voice->stream.ratio          = ratio;
+   voice->stream.position       = 0;
+   voice->stream.samples        = 0;
+   retro_atomic_store(&voice->stream.repeats, 0);
+   retro_atomic_store(&voice->stream.finished, 0);
+#ifdef HAVE_THREADS
+   if (voice->stream.ring.buffer)
+      spsc_ring_clear(&voice->stream.ring);
+#endif
 
    return true;
 
 error:
-   drmp3_uninit(&voice->types.mp3.stream);
+   audio_mixer_stream_free(voice);
    return false;
 }
-#endif
 
 audio_mixer_voice_t* audio_mixer_play(audio_mixer_sound_t* sound, bool repeat,
       float volume, audio_mixer_stop_cb_t stop_cb)
@@ -796,6 +1220,8 @@ audio_mixer_voice_t* audio_mixer_play(audio_mixer_sound_t* sound, bool repeat,
    if (!sound)
       return NULL;
 
+   audio_mixer_lock();
+
    for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++, voice++)
    {
       if (voice->type != AUDIO_MIXER_TYPE_NONE)
@@ -806,28 +1232,11 @@ audio_mixer_voice_t* audio_mixer_play(audio_mixer_sound_t* sound, bool repeat,
          case AUDIO_MIXER_TYPE_WAV:
             res = audio_mixer_play_wav(sound, voice, repeat, volume, stop_cb);
             break;
-         case AUDIO_MIXER_TYPE_OGG:
-#ifdef HAVE_STB_VORBIS
-            res = audio_mixer_play_ogg(sound, voice, repeat, volume, stop_cb);
-#endif
-            break;
-         case AUDIO_MIXER_TYPE_MOD:
-#ifdef HAVE_IBXM
-            res = audio_mixer_play_mod(sound, voice, repeat, volume, stop_cb);
-#endif
-            break;
-         case AUDIO_MIXER_TYPE_FLAC:
-#ifdef HAVE_DR_FLAC
-            res = audio_mixer_play_flac(sound, voice, repeat, volume, stop_cb);
-#endif
-            break;
-         case AUDIO_MIXER_TYPE_MP3:
-#ifdef HAVE_DR_MP3
-            res = audio_mixer_play_mp3(sound, voice, repeat, volume, stop_cb);
-#endif
-            break;
          case AUDIO_MIXER_TYPE_NONE:
             break;
+         default:
+            res = audio_mixer_play_stream(sound, voice);
+            break;
       }
 
       break;
@@ -844,6 +1253,14 @@ audio_mixer_voice_t* audio_mixer_play(audio_mixer_sound_t* sound, bool repeat,
    else
       voice = NULL;
 
+   audio_mixer_unlock();
+
+#ifdef HAVE_THREADS
+   /* Have the worker decode ahead right away */
+   if (voice && s_worker && voice->type != AUDIO_MIXER_TYPE_WAV)
+      scond_signal(s_cond);
+#endif
+
    return voice;
 }
 
@@ -857,30 +1274,43 @@ void audio_mixer_stop(audio_mixer_voice_t* voice)
       stop_cb     = voice->stop_cb;
       sound       = voice->sound;
 
+      /* Once the lock is dropped, the worker won't touch
+       * this voice again - the caller may then free 'sound' */
+      audio_mixer_lock();
       voice->type = AUDIO_MIXER_TYPE_NONE;
+      audio_mixer_unlock();
 
       if (stop_cb)
          stop_cb(sound, AUDIO_MIXER_SOUND_STOPPED);
    }
 }
 
+static void audio_mixer_voice_finish(audio_mixer_voice_t* voice)
+{
+   audio_mixer_lock();
+   voice->type = AUDIO_MIXER_TYPE_NONE;
+   audio_mixer_unlock();
+
+   if (voice->stop_cb)
+      voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
+}
+
 static void audio_mixer_mix_wav(float* buffer, size_t num_frames,
       audio_mixer_voice_t* voice,
       float volume)
 {
-   int i;
    unsigned buf_free                = (unsigned)(num_frames * 2);
    const audio_mixer_sound_t* sound = voice->sound;
    unsigned pcm_available           = sound->types.wav.frames
-      * 2 - voice->types.wav.position;
+      * 2 - voice->wav.position;
    const float* pcm                 = sound->types.wav.pcm +
-      voice->types.wav.position;
+      voice->wav.position;
 
 again:
    if (pcm_available < buf_free)
    {
-      for (i = pcm_available; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
+      audio_mix_volume(buffer, pcm, volume, pcm_available);
+      buffer += pcm_available;
 
       if (voice->repeat)
       {
@@ -890,310 +1320,88 @@ again:
          buf_free                  -= pcm_available;
          pcm_available              = sound->types.wav.frames * 2;
          pcm                        = sound->types.wav.pcm;
-         voice->types.wav.position  = 0;
+         voice->wav.position  = 0;
          goto again;
       }
 
-      if (voice->stop_cb)
-         voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-      voice->type = AUDIO_MIXER_TYPE_NONE;
+      audio_mixer_voice_finish(voice);
    }
    else
    {
-      for (i = buf_free; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
-
-      voice->types.wav.position += buf_free;
-   }
-}
-
-#ifdef HAVE_STB_VORBIS
-static void audio_mixer_mix_ogg(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
-{
-   int i;
-   float* temp_buffer = NULL;
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   unsigned temp_samples            = 0;
-   float* pcm                       = NULL;
-
-   if (voice->types.ogg.position == voice->types.ogg.samples)
-   {
-again:
-      if (temp_buffer == NULL)
-         temp_buffer = (float*)malloc(AUDIO_MIXER_TEMP_BUFFER * sizeof(float));
-
-      temp_samples = stb_vorbis_get_samples_float_interleaved(
-            voice->types.ogg.stream, 2, temp_buffer,
-            AUDIO_MIXER_TEMP_BUFFER) * 2;
-
-      if (temp_samples == 0)
-      {
-         if (voice->repeat)
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            stb_vorbis_seek_start(voice->types.ogg.stream);
-            goto again;
-         }
-
-         if (voice->stop_cb)
-            voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-         voice->type = AUDIO_MIXER_TYPE_NONE;
-         goto cleanup;
-      }
-
-      if (voice->types.ogg.resampler)
-      {
-         struct resampler_data info;
-         info.data_in = temp_buffer;
-         info.data_out = voice->types.ogg.buffer;
-         info.input_frames = temp_samples / 2;
-         info.output_frames = 0;
-         info.ratio = voice->types.ogg.ratio;
-
-         voice->types.ogg.resampler->process(
-               voice->types.ogg.resampler_data, &info);
-      }
-      else
-         memcpy(voice->types.ogg.buffer, temp_buffer,
-               temp_samples * sizeof(float));
-
-      voice->types.ogg.position = 0;
-      voice->types.ogg.samples  = voice->types.ogg.buf_samples;
-   }
-
-   pcm = voice->types.ogg.buffer + voice->types.ogg.position;
-
-   if (voice->types.ogg.samples < buf_free)
-   {
-      for (i = voice->types.ogg.samples; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
+      audio_mix_volume(buffer, pcm, volume, buf_free);
 
-      buf_free -= voice->types.ogg.samples;
-      goto again;
+      voice->wav.position += buf_free;
    }
-
-   for (i = buf_free; i != 0; --i )
-      *buffer++ += *pcm++ * volume;
-
-   voice->types.ogg.position += buf_free;
-   voice->types.ogg.samples  -= buf_free;
-
-cleanup:
-   if (temp_buffer != NULL)
-      free(temp_buffer);
 }
-#endif
 
-#ifdef HAVE_IBXM
-static void audio_mixer_mix_mod(float* buffer, size_t num_frames,
+static void audio_mixer_mix_stream(float* buffer, size_t num_frames,
       audio_mixer_voice_t* voice,
       float volume)
 {
-   int i;
-   float samplef                    = 0.0f;
-   unsigned temp_samples            = 0;
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   int* pcm                         = NULL;
-
-   if (voice->types.mod.samples == 0)
-   {
-again:
-      temp_samples = replay_get_audio(
-            voice->types.mod.stream, voice->types.mod.buffer, 0 ) * 2;
-
-      if (temp_samples == 0)
-      {
-         if (voice->repeat)
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            replay_seek( voice->types.mod.stream, 0);
-            goto again;
-         }
-
-         if (voice->stop_cb)
-            voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-         voice->type = AUDIO_MIXER_TYPE_NONE;
-         return;
-      }
+   unsigned buf_free = (unsigned)(num_frames * 2);
+   int repeats       = retro_atomic_exchange(&voice->stream.repeats, 0);
 
-      voice->types.mod.position = 0;
-      voice->types.mod.samples  = temp_samples;
-   }
-   pcm = voice->types.mod.buffer + voice->types.mod.position;
+   for (; repeats > 0; repeats--)
+      if (voice->stop_cb)
+         voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
 
-   if (voice->types.mod.samples < buf_free)
+#ifdef HAVE_THREADS
+   if (s_worker)
    {
-      for (i = voice->types.mod.samples; i != 0; i--)
+      while (buf_free > 0)
       {
-         samplef     = ((float)(*pcm++) + 32768.0f) / 65535.0f;
-         samplef     = samplef * 2.0f - 1.0f;
-         *buffer++  += samplef * volume;
-      }
-
-      buf_free -= voice->types.mod.samples;
-      goto again;
-   }
-
-   for (i = buf_free; i != 0; --i )
-   {
-      samplef     = ((float)(*pcm++) + 32768.0f) / 65535.0f;
-      samplef     = samplef * 2.0f - 1.0f;
-      *buffer++  += samplef * volume;
-   }
+         size_t count = buf_free;
 
-   voice->types.mod.position += buf_free;
-   voice->types.mod.samples  -= buf_free;
-}
-#endif
+         if (count > AUDIO_MIXER_TEMP_BUFFER)
+            count = AUDIO_MIXER_TEMP_BUFFER;
 
-#ifdef HAVE_DR_FLAC
-static void audio_mixer_mix_flac(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
-{
-   int i;
-   struct resampler_data info;
-   float temp_buffer[AUDIO_MIXER_TEMP_BUFFER] = { 0 };
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   unsigned temp_samples            = 0;
-   float *pcm                       = NULL;
+         count = spsc_ring_read(&voice->stream.ring,
+               s_mix_buffer, count * sizeof(float)) / sizeof(float);
 
-   if (voice->types.flac.position == voice->types.flac.samples)
-   {
-again:
-      temp_samples = (unsigned)drflac_read_f32( voice->types.flac.stream, AUDIO_MIXER_TEMP_BUFFER, temp_buffer);
-      if (temp_samples == 0)
-      {
-         if (voice->repeat)
+         if (count == 0)
          {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            drflac_seek_to_sample(voice->types.flac.stream,0);
-            goto again;
+            /* The worker only flags the end after queueing
+             * the last samples, so none can be left behind.
+             * Otherwise it fell behind, which leaves a gap */
+            if (     retro_atomic_load(&voice->stream.finished)
+                  && spsc_ring_read_avail(&voice->stream.ring) == 0)
+               audio_mixer_voice_finish(voice);
+            break;
          }
 
-         if (voice->stop_cb)
-            voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-         voice->type = AUDIO_MIXER_TYPE_NONE;
-         return;
+         audio_mix_volume(buffer, s_mix_buffer, volume, count);
+         buffer   += count;
+         buf_free -= (unsigned)count;
       }
 
-      info.data_in              = temp_buffer;
-      info.data_out             = voice->types.flac.buffer;
-      info.input_frames         = temp_samples / 2;
-      info.output_frames        = 0;
-      info.ratio                = voice->types.flac.ratio;
-
-      if (voice->types.flac.resampler)
-         voice->types.flac.resampler->process(
-               voice->types.flac.resampler_data, &info);
-      else
-         memcpy(voice->types.flac.buffer, temp_buffer, temp_samples * sizeof(float));
-      voice->types.flac.position = 0;
-      voice->types.flac.samples  = voice->types.flac.buf_samples;
-   }
-
-   pcm = voice->types.flac.buffer + voice->types.flac.position;
-
-   if (voice->types.flac.samples < buf_free)
-   {
-      for (i = voice->types.flac.samples; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
-
-      buf_free -= voice->types.flac.samples;
-      goto again;
+      scond_signal(s_cond);
+      return;
    }
-
-   for (i = buf_free; i != 0; --i )
-      *buffer++ += *pcm++ * volume;
-
-   voice->types.flac.position += buf_free;
-   voice->types.flac.samples  -= buf_free;
-}
 #endif
 
-#ifdef HAVE_DR_MP3
-static void audio_mixer_mix_mp3(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
-{
-   int i;
-   struct resampler_data info;
-   float temp_buffer[AUDIO_MIXER_TEMP_BUFFER] = { 0 };
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   unsigned temp_samples            = 0;
-   float* pcm                       = NULL;
-
-   if (voice->types.mp3.position == voice->types.mp3.samples)
+   while (buf_free > 0)
    {
-again:
-      temp_samples = (unsigned)drmp3_read_f32(
-            &voice->types.mp3.stream,
-            AUDIO_MIXER_TEMP_BUFFER / 2, temp_buffer) * 2;
+      unsigned count;
 
-      if (temp_samples == 0)
+      if (     voice->stream.position == voice->stream.samples
+            && !audio_mixer_stream_decode(voice))
       {
-         if (voice->repeat)
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            drmp3_seek_to_frame(&voice->types.mp3.stream,0);
-            goto again;
-         }
-
-         if (voice->stop_cb)
-            voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-         voice->type = AUDIO_MIXER_TYPE_NONE;
+         audio_mixer_voice_finish(voice);
          return;
       }
 
-      info.data_in              = temp_buffer;
-      info.data_out             = voice->types.mp3.buffer;
-      info.input_frames         = temp_samples / 2;
-      info.output_frames        = 0;
-      info.ratio                = voice->types.mp3.ratio;
-
-      if (voice->types.mp3.resampler)
-         voice->types.mp3.resampler->process(
-               voice->types.mp3.resampler_data, &info);
-      else
-         memcpy(voice->types.mp3.buffer, temp_buffer,
-               temp_samples * sizeof(float));
-      voice->types.mp3.position = 0;
-      voice->types.mp3.samples  = voice->types.mp3.buf_samples;
-   }
-
-   pcm = voice->types.mp3.buffer + voice->types.mp3.position;
+      count = voice->stream.samples - voice->stream.position;
+      if (count > buf_free)
+         count = buf_free;
 
-   if (voice->types.mp3.samples < buf_free)
-   {
-      for (i = voice->types.mp3.samples; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
+      audio_mix_volume(buffer,
+            voice->stream.buffer + voice->stream.position, volume, count);
 
-      buf_free -= voice->types.mp3.samples;
-      goto again;
+      buffer                 += count;
+      buf_free               -= count;
+      voice->stream.position += count;
    }
-
-   for (i = buf_free; i != 0; --i )
-      *buffer++ += *pcm++ * volume;
-
-   voice->types.mp3.position += buf_free;
-   voice->types.mp3.samples  -= buf_free;
 }
-#endif
 
 void audio_mixer_mix(float* buffer, size_t num_frames,
       float volume_override, bool override)
@@ -1212,28 +1420,11 @@ void audio_mixer_mix(float* buffer, size_t num_frames,
          case AUDIO_MIXER_TYPE_WAV:
             audio_mixer_mix_wav(buffer, num_frames, voice, volume);
             break;
-         case AUDIO_MIXER_TYPE_OGG:
-#ifdef HAVE_STB_VORBIS
-            audio_mixer_mix_ogg(buffer, num_frames, voice, volume);
-#endif
-            break;
-         case AUDIO_MIXER_TYPE_MOD:
-#ifdef HAVE_IBXM
-            audio_mixer_mix_mod(buffer, num_frames, voice, volume);
-#endif
-            break;
-         case AUDIO_MIXER_TYPE_FLAC:
-#ifdef HAVE_DR_FLAC
-            audio_mixer_mix_flac(buffer, num_frames, voice, volume);
-#endif
-            break;
-            case AUDIO_MIXER_TYPE_MP3:
-#ifdef HAVE_DR_MP3
-            audio_mixer_mix_mp3(buffer, num_frames, voice, volume);
-#endif
-            break;
          case AUDIO_MIXER_TYPE_NONE:
             break;
+         default:
+            audio_mixer_mix_stream(buffer, num_frames, voice, volume);
+            break;
       }
    }
 
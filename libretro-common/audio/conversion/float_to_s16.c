@@ -28,7 +28,11 @@
 #include <altivec.h>
 #endif
 
-#if (defined(__ARM_NEON__) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)) || defined(HAVE_NEON)
+#if defined(__aarch64__) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+/* The ARM assembly is 32-bit only - use intrinsics instead */
+#define HAVE_ARM_NEON_A64_OPTIMIZATIONS
+#elif (defined(__ARM_NEON__) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)) || defined(HAVE_NEON)
 #ifndef HAVE_ARM_NEON_OPTIMIZATIONS
 #define HAVE_ARM_NEON_OPTIMIZATIONS
 #endif
@@ -37,7 +41,9 @@
 #include <features/features_cpu.h>
 #include <audio/conversion/float_to_s16.h>
 
-#if defined(HAVE_ARM_NEON_OPTIMIZATIONS)
+#if defined(HAVE_ARM_NEON_A64_OPTIMIZATIONS)
+static bool float_to_s16_neon_enabled = false;
+#elif defined(HAVE_ARM_NEON_OPTIMIZATIONS)
 static bool float_to_s16_neon_enabled = false;
 void convert_float_s16_asm(int16_t *out, const float *in, size_t samples);
 #endif
@@ -97,6 +103,27 @@ void convert_float_to_s16(int16_t *out,
 
    samples = samples_in;
    i       = 0;
+#elif defined(HAVE_ARM_NEON_A64_OPTIMIZATIONS)
+   if (float_to_s16_neon_enabled)
+   {
+      float32x4_t factor = vdupq_n_f32((float)0x8000);
+
+      /* vcvtq truncates and saturates, like the C version
+       * below; vqmovn then saturates to 16 bits */
+      for (i = 0; i + 16 <= samples; i += 16, in += 16, out += 16)
+      {
+         int32x4_t ints_0 = vcvtq_s32_f32(vmulq_f32(vld1q_f32(in +  0), factor));
+         int32x4_t ints_1 = vcvtq_s32_f32(vmulq_f32(vld1q_f32(in +  4), factor));
+         int32x4_t ints_2 = vcvtq_s32_f32(vmulq_f32(vld1q_f32(in +  8), factor));
+         int32x4_t ints_3 = vcvtq_s32_f32(vmulq_f32(vld1q_f32(in + 12), factor));
+
+         vst1q_s16(out + 0, vqmovn_high_s32(vqmovn_s32(ints_0), ints_1));
+         vst1q_s16(out + 8, vqmovn_high_s32(vqmovn_s32(ints_2), ints_3));
+      }
+
+      samples = samples - i;
+      i       = 0;
+   }
 #elif defined(HAVE_ARM_NEON_OPTIMIZATIONS)
    if (float_to_s16_neon_enabled)
    {
@@ -157,7 +184,13 @@ void convert_float_to_s16(int16_t *out,
  **/
 void convert_float_to_s16_init_simd(void)
 {
-#if defined(HAVE_ARM_NEON_OPTIMIZATIONS)
+#if defined(HAVE_ARM_NEON_A64_OPTIMIZATIONS)
+   unsigned cpu = cpu_features_get();
+
+   /* Linux reports AArch64 NEON as "asimd" */
+   if (cpu & (RETRO_SIMD_NEON | RETRO_SIMD_ASIMD))
+      float_to_s16_neon_enabled = true;
+#elif defined(HAVE_ARM_NEON_OPTIMIZATIONS)
    unsigned cpu = cpu_features_get();
 
    if (cpu & RETRO_SIMD_NEON)
@@ -29,13 +29,19 @@
 #include <features/features_cpu.h>
 #include <audio/conversion/s16_to_float.h>
 
-#if (defined(__ARM_NEON__) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)) || defined(HAVE_NEON)
+#if defined(__aarch64__) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+/* The ARM assembly is 32-bit only - use intrinsics instead */
+#define HAVE_ARM_NEON_A64_OPTIMIZATIONS
+#elif (defined(__ARM_NEON__) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)) || defined(HAVE_NEON)
 #ifndef HAVE_ARM_NEON_OPTIMIZATIONS
 #define HAVE_ARM_NEON_OPTIMIZATIONS
 #endif
 #endif
 
-#if defined(HAVE_ARM_NEON_OPTIMIZATIONS)
+#if defined(HAVE_ARM_NEON_A64_OPTIMIZATIONS)
+static bool s16_to_float_neon_enabled = false;
+#elif defined(HAVE_ARM_NEON_OPTIMIZATIONS)
 static bool s16_to_float_neon_enabled = false;
 
 /* Avoid potential hard-float/soft-float ABI issues. */
@@ -104,6 +110,30 @@ void convert_s16_to_float(float *out,
    samples = samples_in;
    i       = 0;
 
+#elif defined(HAVE_ARM_NEON_A64_OPTIMIZATIONS)
+   if (s16_to_float_neon_enabled)
+   {
+      float32x4_t factor = vdupq_n_f32(gain / 0x8000);
+
+      for (i = 0; i + 16 <= samples; i += 16, in += 16, out += 16)
+      {
+         int16x8_t input_l = vld1q_s16(in + 0);
+         int16x8_t input_r = vld1q_s16(in + 8);
+
+         vst1q_f32(out +  0, vmulq_f32(vcvtq_f32_s32(
+                     vmovl_s16(vget_low_s16(input_l))), factor));
+         vst1q_f32(out +  4, vmulq_f32(vcvtq_f32_s32(
+                     vmovl_high_s16(input_l)), factor));
+         vst1q_f32(out +  8, vmulq_f32(vcvtq_f32_s32(
+                     vmovl_s16(vget_low_s16(input_r))), factor));
+         vst1q_f32(out + 12, vmulq_f32(vcvtq_f32_s32(
+                     vmovl_high_s16(input_r)), factor));
+      }
+
+      samples = samples - i;
+      i       = 0;
+   }
+
 #elif defined(HAVE_ARM_NEON_OPTIMIZATIONS)
    if (s16_to_float_neon_enabled)
    {
@@ -187,7 +217,13 @@ void convert_s16_to_float(float *out,
  **/
 void convert_s16_to_float_init_simd(void)
 {
-#if defined(HAVE_ARM_NEON_OPTIMIZATIONS)
+#if defined(HAVE_ARM_NEON_A64_OPTIMIZATIONS)
+   unsigned cpu = cpu_features_get();
+
+   /* Linux reports AArch64 NEON as "asimd" */
+   if (cpu & (RETRO_SIMD_NEON | RETRO_SIMD_ASIMD))
+      s16_to_float_neon_enabled = true;
+#elif defined(HAVE_ARM_NEON_OPTIMIZATIONS)
    unsigned cpu = cpu_features_get();
 
    if (cpu & RETRO_SIMD_NEON)
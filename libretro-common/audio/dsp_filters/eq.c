@@ -100,8 +100,8 @@ static void eq_process(void *data, struct dspfilter_output *output,
          for (c = 0; c < 2; c++)
          {
             fft_process_forward(eq->fft, eq->fftblock, eq->block + c, 2);
-            for (i = 0; i < 2 * eq->block_size; i++)
-               eq->fftblock[i] = fft_complex_mul(eq->fftblock[i], eq->filter[i]);
+            fft_complex_mul_array(eq->fftblock, eq->filter,
+                  2 * eq->block_size);
             fft_process_inverse(eq->fft, out + c, eq->fftblock, 2);
          }
 
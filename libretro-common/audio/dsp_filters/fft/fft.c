@@ -27,6 +27,14 @@
 
 #include <retro_miscellaneous.h>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#define FFT_HAVE_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define FFT_HAVE_NEON
+#endif
+
 struct fft
 {
    fft_complex_t *interleave_buffer;
@@ -140,6 +148,29 @@ static void butterfly(fft_complex_t *a, fft_complex_t *b, fft_complex_t mod)
    *a  = fft_complex_add(*a, mod);
 }
 
+#if defined(FFT_HAVE_SSE)
+/* Two complex products at once, on packed
+ * { real, imag, real, imag } vectors */
+static INLINE __m128 fft_complex_mul_sse(__m128 a, __m128 b)
+{
+   const __m128 sign = _mm_setr_ps(-0.0f, 0.0f, -0.0f, 0.0f);
+   __m128 a_re       = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 0, 0));
+   __m128 a_im       = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 1, 1));
+   __m128 b_swap     = _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1));
+   return _mm_add_ps(_mm_mul_ps(a_re, b),
+         _mm_xor_ps(_mm_mul_ps(a_im, b_swap), sign));
+}
+#elif defined(FFT_HAVE_NEON)
+static INLINE float32x4_t fft_complex_mul_neon(float32x4_t a, float32x4_t b)
+{
+   static const float sign_lut[4] = { -1.0f, 1.0f, -1.0f, 1.0f };
+   float32x4x2_t a_split = vtrnq_f32(a, a);
+   float32x4_t b_swap    = vrev64q_f32(b);
+   return vmlaq_f32(vmulq_f32(a_split.val[0], b),
+         vmulq_f32(a_split.val[1], vld1q_f32(sign_lut)), b_swap);
+}
+#endif
+
 static void butterflies(fft_complex_t *butterfly_buf,
       const fft_complex_t *phase_lut,
       int phase_dir, unsigned step_size, unsigned samples)
@@ -148,12 +179,59 @@ static void butterflies(fft_complex_t *butterfly_buf,
    for (i = 0; i < samples; i += step_size << 1)
    {
       int phase_step = (int)samples * phase_dir / (int)step_size;
+#if defined(FFT_HAVE_SSE) || defined(FFT_HAVE_NEON)
+      /* Past the first pass, spans are even - do two at a time */
+      if (step_size >= 2)
+      {
+         for (j = i; j < i + step_size; j += 2)
+         {
+            const fft_complex_t *mod0 = &phase_lut[phase_step * (int)(j - i)];
+            const fft_complex_t *mod1 = mod0 + phase_step;
+            float *a                  = &butterfly_buf[j].real;
+            float *b                  = &butterfly_buf[j + step_size].real;
+#if defined(FFT_HAVE_SSE)
+            __m128 mod = _mm_loadh_pi(
+                  _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)mod0),
+                  (const __m64*)mod1);
+            __m128 va  = _mm_loadu_ps(a);
+            mod        = fft_complex_mul_sse(mod, _mm_loadu_ps(b));
+            _mm_storeu_ps(b, _mm_sub_ps(va, mod));
+            _mm_storeu_ps(a, _mm_add_ps(va, mod));
+#else
+            float32x4_t mod = vcombine_f32(
+                  vld1_f32(&mod0->real), vld1_f32(&mod1->real));
+            float32x4_t va  = vld1q_f32(a);
+            mod             = fft_complex_mul_neon(mod, vld1q_f32(b));
+            vst1q_f32(b, vsubq_f32(va, mod));
+            vst1q_f32(a, vaddq_f32(va, mod));
+#endif
+         }
+         continue;
+      }
+#endif
       for (j = i; j < i + step_size; j++)
          butterfly(&butterfly_buf[j], &butterfly_buf[j + step_size],
                phase_lut[phase_step * (int)(j - i)]);
    }
 }
 
+void fft_complex_mul_array(fft_complex_t *out,
+      const fft_complex_t *in, unsigned samples)
+{
+   unsigned i = 0;
+#if defined(FFT_HAVE_SSE)
+   for (; i + 2 <= samples; i += 2)
+      _mm_storeu_ps(&out[i].real, fft_complex_mul_sse(
+               _mm_loadu_ps(&out[i].real), _mm_loadu_ps(&in[i].real)));
+#elif defined(FFT_HAVE_NEON)
+   for (; i + 2 <= samples; i += 2)
+      vst1q_f32(&out[i].real, fft_complex_mul_neon(
+               vld1q_f32(&out[i].real), vld1q_f32(&in[i].real)));
+#endif
+   for (; i < samples; i++)
+      out[i] = fft_complex_mul(out[i], in[i]);
+}
+
 void fft_process_forward_complex(fft_t *fft,
       fft_complex_t *out, const fft_complex_t *in, unsigned step)
 {
@@ -41,4 +41,8 @@ void fft_process_forward(fft_t *fft,
 void fft_process_inverse(fft_t *fft,
       float *out, const fft_complex_t *in, unsigned step);
 
+/* Multiplies @out by @in, element by element */
+void fft_complex_mul_array(fft_complex_t *out,
+      const fft_complex_t *in, unsigned samples);
+
 #endif
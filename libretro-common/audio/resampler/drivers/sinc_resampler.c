@@ -39,10 +39,40 @@
 #include <xmmintrin.h>
 #endif
 
+/* The AVX kernels are built with function-level target attributes
+ * where the compiler supports them, so they can be picked at runtime
+ * by binaries targeting plain SSE. */
 #if defined(__AVX__)
+#define SINC_HAVE_AVX
+#define SINC_TARGET_AVX
+#elif (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || (defined(__GNUC__) && ((__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define SINC_HAVE_AVX
+#define SINC_TARGET_AVX __attribute__((target("avx")))
+#elif (defined(_M_X64) || defined(_M_IX86)) && defined(_MSC_VER) && _MSC_VER >= 1700
+#define SINC_HAVE_AVX
+#define SINC_TARGET_AVX
+#endif
+
+#if defined(__AVX2__) && defined(__FMA__)
+#define SINC_HAVE_AVX2
+#define SINC_TARGET_AVX2
+#elif defined(SINC_HAVE_AVX) && defined(__GNUC__)
+#define SINC_HAVE_AVX2
+#define SINC_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#elif defined(SINC_HAVE_AVX) && defined(_MSC_VER) && _MSC_VER >= 1800
+#define SINC_HAVE_AVX2
+#define SINC_TARGET_AVX2
+#endif
+
+#if defined(SINC_HAVE_AVX)
 #include <immintrin.h>
 #endif
 
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SINC_HAVE_NEON_INTRINSICS
+#include <arm_neon.h>
+#endif
+
 /* Rough SNR values for upsampling:
  * LOWEST: 40 dB
  * LOWER: 55 dB
@@ -85,7 +115,7 @@ typedef struct rarch_sinc_resampler
    float kaiser_beta;
 } rarch_sinc_resampler_t;
 
-#if (defined(__ARM_NEON__) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)) || defined(HAVE_NEON)
+#if ((defined(__ARM_NEON__) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)) || defined(HAVE_NEON)) && !defined(__aarch64__)
 #if TARGET_OS_IPHONE
 #else
 #ifndef WANT_NEON
@@ -151,8 +181,152 @@ static void resampler_sinc_process_neon(void *re_, struct resampler_data *data)
 }
 #endif
 
-#if defined(__AVX__)
-static void resampler_sinc_process_avx_kaiser(void *re_, struct resampler_data *data)
+#if defined(SINC_HAVE_NEON_INTRINSICS)
+static INLINE float sinc_neon_sum(float32x4_t sum)
+{
+#if defined(__aarch64__)
+   return vaddvq_f32(sum);
+#else
+   float32x2_t half = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+   return vget_lane_f32(vpadd_f32(half, half), 0);
+#endif
+}
+
+static void resampler_sinc_process_neon_intrin_kaiser(void *re_,
+      struct resampler_data *data)
+{
+   rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
+   unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
+
+   uint32_t ratio                 = phases / data->ratio;
+   const float *input             = data->data_in;
+   float *output                  = data->data_out;
+   size_t frames                  = data->input_frames;
+   size_t out_frames              = 0;
+
+   while (frames)
+   {
+      while (frames && resamp->time >= phases)
+      {
+         /* Push in reverse to make filter more obvious. */
+         if (!resamp->ptr)
+            resamp->ptr = resamp->taps;
+         resamp->ptr--;
+
+         resamp->buffer_l[resamp->ptr + resamp->taps] =
+         resamp->buffer_l[resamp->ptr]                = *input++;
+
+         resamp->buffer_r[resamp->ptr + resamp->taps] =
+         resamp->buffer_r[resamp->ptr]                = *input++;
+
+         resamp->time                                -= phases;
+         frames--;
+      }
+
+      {
+         const float *buffer_l    = resamp->buffer_l + resamp->ptr;
+         const float *buffer_r    = resamp->buffer_r + resamp->ptr;
+         unsigned taps            = resamp->taps;
+         while (resamp->time < phases)
+         {
+            unsigned i;
+            unsigned phase           = resamp->time >> resamp->subphase_bits;
+            const float *phase_table = resamp->phase_table + phase * taps * 2;
+            const float *delta_table = phase_table + taps;
+            float32x4_t delta        = vdupq_n_f32((float)
+                  (resamp->time & resamp->subphase_mask) * resamp->subphase_mod);
+            float32x4_t sum_l        = vdupq_n_f32(0.0f);
+            float32x4_t sum_r        = vdupq_n_f32(0.0f);
+
+            for (i = 0; i < taps; i += 4)
+            {
+               float32x4_t sinc      = vmlaq_f32(vld1q_f32(phase_table + i),
+                     vld1q_f32(delta_table + i), delta);
+
+               sum_l                 = vmlaq_f32(sum_l, vld1q_f32(buffer_l + i), sinc);
+               sum_r                 = vmlaq_f32(sum_r, vld1q_f32(buffer_r + i), sinc);
+            }
+
+            output[0]                = sinc_neon_sum(sum_l);
+            output[1]                = sinc_neon_sum(sum_r);
+
+            output                  += 2;
+            out_frames++;
+            resamp->time            += ratio;
+         }
+      }
+   }
+
+   data->output_frames = out_frames;
+}
+
+static void resampler_sinc_process_neon_intrin(void *re_,
+      struct resampler_data *data)
+{
+   rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
+   unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
+
+   uint32_t ratio                 = phases / data->ratio;
+   const float *input             = data->data_in;
+   float *output                  = data->data_out;
+   size_t frames                  = data->input_frames;
+   size_t out_frames              = 0;
+
+   while (frames)
+   {
+      while (frames && resamp->time >= phases)
+      {
+         /* Push in reverse to make filter more obvious. */
+         if (!resamp->ptr)
+            resamp->ptr = resamp->taps;
+         resamp->ptr--;
+
+         resamp->buffer_l[resamp->ptr + resamp->taps] =
+         resamp->buffer_l[resamp->ptr]                = *input++;
+
+         resamp->buffer_r[resamp->ptr + resamp->taps] =
+         resamp->buffer_r[resamp->ptr]                = *input++;
+
+         resamp->time                                -= phases;
+         frames--;
+      }
+
+      {
+         const float *buffer_l    = resamp->buffer_l + resamp->ptr;
+         const float *buffer_r    = resamp->buffer_r + resamp->ptr;
+         unsigned taps            = resamp->taps;
+         while (resamp->time < phases)
+         {
+            unsigned i;
+            unsigned phase           = resamp->time >> resamp->subphase_bits;
+            const float *phase_table = resamp->phase_table + phase * taps;
+            float32x4_t sum_l        = vdupq_n_f32(0.0f);
+            float32x4_t sum_r        = vdupq_n_f32(0.0f);
+
+            for (i = 0; i < taps; i += 4)
+            {
+               float32x4_t sinc      = vld1q_f32(phase_table + i);
+
+               sum_l                 = vmlaq_f32(sum_l, vld1q_f32(buffer_l + i), sinc);
+               sum_r                 = vmlaq_f32(sum_r, vld1q_f32(buffer_r + i), sinc);
+            }
+
+            output[0]                = sinc_neon_sum(sum_l);
+            output[1]                = sinc_neon_sum(sum_r);
+
+            output                  += 2;
+            out_frames++;
+            resamp->time            += ratio;
+         }
+      }
+   }
+
+   data->output_frames = out_frames;
+}
+#endif
+
+#if defined(SINC_HAVE_AVX)
+static SINC_TARGET_AVX void resampler_sinc_process_avx_kaiser(void *re_, struct resampler_data *data)
 {
    rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
    unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
@@ -237,7 +411,7 @@ static void resampler_sinc_process_avx_kaiser(void *re_, struct resampler_data *
    data->output_frames = out_frames;
 }
 
-static void resampler_sinc_process_avx(void *re_, struct resampler_data *data)
+static SINC_TARGET_AVX void resampler_sinc_process_avx(void *re_, struct resampler_data *data)
 {
    rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
    unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
@@ -318,6 +492,174 @@ static void resampler_sinc_process_avx(void *re_, struct resampler_data *data)
 }
 #endif
 
+#if defined(SINC_HAVE_AVX2)
+/* Same as the AVX kernels, with fused multiply-adds */
+static SINC_TARGET_AVX2 void resampler_sinc_process_avx2_kaiser(void *re_, struct resampler_data *data)
+{
+   rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
+   unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
+
+   uint32_t ratio                 = phases / data->ratio;
+   const float *input             = data->data_in;
+   float *output                  = data->data_out;
+   size_t frames                  = data->input_frames;
+   size_t out_frames              = 0;
+
+   {
+      while (frames)
+      {
+         while (frames && resamp->time >= phases)
+         {
+            /* Push in reverse to make filter more obvious. */
+            if (!resamp->ptr)
+               resamp->ptr = resamp->taps;
+            resamp->ptr--;
+
+            resamp->buffer_l[resamp->ptr + resamp->taps] =
+               resamp->buffer_l[resamp->ptr]                = *input++;
+
+            resamp->buffer_r[resamp->ptr + resamp->taps] =
+               resamp->buffer_r[resamp->ptr]                = *input++;
+
+            resamp->time                                -= phases;
+            frames--;
+         }
+
+         {
+            const float *buffer_l    = resamp->buffer_l + resamp->ptr;
+            const float *buffer_r    = resamp->buffer_r + resamp->ptr;
+            unsigned taps            = resamp->taps;
+            while (resamp->time < phases)
+            {
+               unsigned i;
+               unsigned phase           = resamp->time >> resamp->subphase_bits;
+
+               float *phase_table       = resamp->phase_table + phase * taps * 2;
+               float *delta_table       = phase_table + taps;
+               __m256 delta             = _mm256_set1_ps((float)
+                     (resamp->time & resamp->subphase_mask) * resamp->subphase_mod);
+
+               __m256 sum_l             = _mm256_setzero_ps();
+               __m256 sum_r             = _mm256_setzero_ps();
+
+               for (i = 0; i < taps; i += 8)
+               {
+                  __m256 buf_l  = _mm256_loadu_ps(buffer_l + i);
+                  __m256 buf_r  = _mm256_loadu_ps(buffer_r + i);
+                  __m256 deltas = _mm256_load_ps(delta_table + i);
+                  __m256 sinc   = _mm256_fmadd_ps(deltas, delta,
+                        _mm256_load_ps((const float*)phase_table + i));
+
+                  sum_l         = _mm256_fmadd_ps(buf_l, sinc, sum_l);
+                  sum_r         = _mm256_fmadd_ps(buf_r, sinc, sum_r);
+               }
+
+               /* hadd on AVX is weird, and acts on low-lanes
+                * and high-lanes separately. */
+               __m256 res_l = _mm256_hadd_ps(sum_l, sum_l);
+               __m256 res_r = _mm256_hadd_ps(sum_r, sum_r);
+               res_l        = _mm256_hadd_ps(res_l, res_l);
+               res_r        = _mm256_hadd_ps(res_r, res_r);
+               res_l        = _mm256_add_ps(_mm256_permute2f128_ps(res_l, res_l, 1), res_l);
+               res_r        = _mm256_add_ps(_mm256_permute2f128_ps(res_r, res_r, 1), res_r);
+
+               /* This is optimized to mov %xmmN, [mem].
+                * There doesn't seem to be any _mm256_store_ss intrinsic. */
+               _mm_store_ss(output + 0, _mm256_extractf128_ps(res_l, 0));
+               _mm_store_ss(output + 1, _mm256_extractf128_ps(res_r, 0));
+
+               output += 2;
+               out_frames++;
+               resamp->time += ratio;
+            }
+         }
+      }
+   }
+
+   data->output_frames = out_frames;
+}
+
+static SINC_TARGET_AVX2 void resampler_sinc_process_avx2(void *re_, struct resampler_data *data)
+{
+   rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
+   unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
+
+   uint32_t ratio                 = phases / data->ratio;
+   const float *input             = data->data_in;
+   float *output                  = data->data_out;
+   size_t frames                  = data->input_frames;
+   size_t out_frames              = 0;
+
+   {
+      while (frames)
+      {
+         while (frames && resamp->time >= phases)
+         {
+            /* Push in reverse to make filter more obvious. */
+            if (!resamp->ptr)
+               resamp->ptr = resamp->taps;
+            resamp->ptr--;
+
+            resamp->buffer_l[resamp->ptr + resamp->taps] =
+               resamp->buffer_l[resamp->ptr]                = *input++;
+
+            resamp->buffer_r[resamp->ptr + resamp->taps] =
+               resamp->buffer_r[resamp->ptr]                = *input++;
+
+            resamp->time                                -= phases;
+            frames--;
+         }
+
+         {
+            const float *buffer_l    = resamp->buffer_l + resamp->ptr;
+            const float *buffer_r    = resamp->buffer_r + resamp->ptr;
+            unsigned taps            = resamp->taps;
+            while (resamp->time < phases)
+            {
+               unsigned i;
+               __m256 delta;
+               unsigned phase           = resamp->time >> resamp->subphase_bits;
+               float *phase_table       = resamp->phase_table + phase * taps;
+
+               __m256 sum_l             = _mm256_setzero_ps();
+               __m256 sum_r             = _mm256_setzero_ps();
+
+               for (i = 0; i < taps; i += 8)
+               {
+                  __m256 buf_l  = _mm256_loadu_ps(buffer_l + i);
+                  __m256 buf_r  = _mm256_loadu_ps(buffer_r + i);
+                  __m256 sinc   = _mm256_load_ps((const float*)phase_table + i);
+
+                  sum_l         = _mm256_fmadd_ps(buf_l, sinc, sum_l);
+                  sum_r         = _mm256_fmadd_ps(buf_r, sinc, sum_r);
+               }
+
+               /* hadd on AVX is weird, and acts on low-lanes
+                * and high-lanes separately. */
+               __m256 res_l = _mm256_hadd_ps(sum_l, sum_l);
+               __m256 res_r = _mm256_hadd_ps(sum_r, sum_r);
+               res_l        = _mm256_hadd_ps(res_l, res_l);
+               res_r        = _mm256_hadd_ps(res_r, res_r);
+               res_l        = _mm256_add_ps(_mm256_permute2f128_ps(res_l, res_l, 1), res_l);
+               res_r        = _mm256_add_ps(_mm256_permute2f128_ps(res_r, res_r, 1), res_r);
+
+               /* This is optimized to mov %xmmN, [mem].
+                * There doesn't seem to be any _mm256_store_ss intrinsic. */
+               _mm_store_ss(output + 0, _mm256_extractf128_ps(res_l, 0));
+               _mm_store_ss(output + 1, _mm256_extractf128_ps(res_r, 0));
+
+               output += 2;
+               out_frames++;
+               resamp->time += ratio;
+            }
+         }
+      }
+   }
+
+   data->output_frames = out_frames;
+}
+#endif
+
 #if defined(__SSE__)
 static void resampler_sinc_process_sse_kaiser(void *re_, struct resampler_data *data)
 {
@@ -764,10 +1106,67 @@ static void sinc_init_table_lanczos(
    }
 }
 
+/* Returns the fastest kernel supported by both the build and the
+ * CPU features in @mask, and the multiple of taps it requires. */
+static resampler_process_t sinc_resampler_select(resampler_simd_mask_t mask,
+      bool enable_avx, bool kaiser, unsigned *simd_width)
+{
+   *simd_width = 4;
+
+#if defined(SINC_HAVE_AVX2)
+   /* The AVX2 kernels are built around FMA3 */
+   if (     enable_avx
+         && (mask & RESAMPLER_SIMD_AVX2)
+         && (mask & RESAMPLER_SIMD_FMA3)
+         && (mask & RESAMPLER_SIMD_AVX))
+   {
+      *simd_width = 8;
+      return kaiser ? resampler_sinc_process_avx2_kaiser
+         : resampler_sinc_process_avx2;
+   }
+#endif
+#if defined(SINC_HAVE_AVX)
+   if (enable_avx && (mask & RESAMPLER_SIMD_AVX))
+   {
+      *simd_width = 8;
+      return kaiser ? resampler_sinc_process_avx_kaiser
+         : resampler_sinc_process_avx;
+   }
+#endif
+#if defined(__SSE__)
+   if (mask & RESAMPLER_SIMD_SSE)
+      return kaiser ? resampler_sinc_process_sse_kaiser
+         : resampler_sinc_process_sse;
+#endif
+#if defined(WANT_NEON)
+   /* The hand-written kernel only handles the plain window */
+   if ((mask & RESAMPLER_SIMD_NEON) && !kaiser)
+   {
+      *simd_width = 8;
+      return resampler_sinc_process_neon;
+   }
+#endif
+#if defined(SINC_HAVE_NEON_INTRINSICS)
+   /* NEON is mandatory on AArch64 */
+#if defined(__aarch64__)
+   if (true)
+#else
+   if (mask & RESAMPLER_SIMD_NEON)
+#endif
+      return kaiser ? resampler_sinc_process_neon_intrin_kaiser
+         : resampler_sinc_process_neon_intrin;
+#endif
+
+   return kaiser ? resampler_sinc_process_c_kaiser
+      : resampler_sinc_process_c;
+}
+
 static void *resampler_sinc_new(const struct resampler_config *config,
       double bandwidth_mod, enum resampler_quality quality,
       resampler_simd_mask_t mask)
 {
+   resampler_process_t process    = NULL;
+   unsigned simd_width            = 4;
    double cutoff                  = 0.0;
    size_t phase_elems             = 0;
    size_t elems                   = 0;
@@ -837,19 +1236,12 @@ static void *resampler_sinc_new(const struct resampler_config *config,
       re->taps = (unsigned)ceil(re->taps / bandwidth_mod);
    }
 
+   /* Pick the best kernel this CPU can run */
+   process = sinc_resampler_select(mask, enable_avx,
+         window_type == SINC_WINDOW_KAISER, &simd_width);
+
    /* Be SIMD-friendly. */
-#if defined(__AVX__)
-   if (enable_avx)
-      re->taps  = (re->taps + 7) & ~7;
-   else
-#endif
-   {
-#if defined(WANT_NEON)
-      re->taps     = (re->taps + 7) & ~7;
-#else
-      re->taps     = (re->taps + 3) & ~3;
-#endif
-   }
+   re->taps        = (re->taps + simd_width - 1) & ~(simd_width - 1);
 
    phase_elems     = ((1 << re->phase_bits) * re->taps);
    if (window_type == SINC_WINDOW_KAISER)
@@ -880,32 +1272,7 @@ static void *resampler_sinc_new(const struct resampler_config *config,
          goto error;
    }
 
-   sinc_resampler.process = resampler_sinc_process_c;
-   if (window_type == SINC_WINDOW_KAISER)
-      sinc_resampler.process    = resampler_sinc_process_c_kaiser;
-
-   if (mask & RESAMPLER_SIMD_AVX && enable_avx)
-   {
-#if defined(__AVX__)
-      sinc_resampler.process    = resampler_sinc_process_avx;
-      if (window_type == SINC_WINDOW_KAISER)
-         sinc_resampler.process = resampler_sinc_process_avx_kaiser;
-#endif
-   }
-   else if (mask & RESAMPLER_SIMD_SSE)
-   {
-#if defined(__SSE__)
-      sinc_resampler.process = resampler_sinc_process_sse;
-      if (window_type == SINC_WINDOW_KAISER)
-         sinc_resampler.process = resampler_sinc_process_sse_kaiser;
-#endif
-   }
-   else if (mask & RESAMPLER_SIMD_NEON && window_type != SINC_WINDOW_KAISER)
-   {
-#if defined(WANT_NEON)
-      sinc_resampler.process = resampler_sinc_process_neon;
-#endif
-   }
+   sinc_resampler.process = process;
 
    return re;
 
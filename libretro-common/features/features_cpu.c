@@ -586,6 +586,20 @@ unsigned cpu_features_get_core_amount(void)
 #define VENDOR_INTEL_c  0x6c65746e
 #define VENDOR_INTEL_d  0x49656e69
 
+#if defined(__MACH__) && defined(CPU_X86)
+/* The hw.optional keys also exist on CPUs that lack the
+ * feature, with a value of 0 */
+static bool cpu_features_sysctl_enabled(const char *name)
+{
+   int value  = 0;
+   size_t len = sizeof(value);
+
+   if (sysctlbyname(name, &value, &len, NULL, 0) != 0)
+      return false;
+   return value != 0;
+}
+#endif
+
 /**
  * cpu_features_get:
  *
@@ -644,14 +658,15 @@ uint64_t cpu_features_get(void)
    if (sysctlbyname("hw.optional.aes", NULL, &len, NULL, 0) == 0)
       cpu |= RETRO_SIMD_AES;
 
-   len            = sizeof(size_t);
-   if (sysctlbyname("hw.optional.avx1_0", NULL, &len, NULL, 0) == 0)
+   if (cpu_features_sysctl_enabled("hw.optional.avx1_0"))
       cpu |= RETRO_SIMD_AVX;
 
-   len            = sizeof(size_t);
-   if (sysctlbyname("hw.optional.avx2_0", NULL, &len, NULL, 0) == 0)
+   if (cpu_features_sysctl_enabled("hw.optional.avx2_0"))
       cpu |= RETRO_SIMD_AVX2;
 
+   if (cpu_features_sysctl_enabled("hw.optional.fma"))
+      cpu |= RETRO_SIMD_FMA3;
+
    len            = sizeof(size_t);
    if (sysctlbyname("hw.optional.altivec", NULL, &len, NULL, 0) == 0)
       cpu |= RETRO_SIMD_VMX;
@@ -743,10 +758,16 @@ uint64_t cpu_features_get(void)
          && ((xgetbv_x86(0) & 0x6) == 0x6))
       cpu |= RETRO_SIMD_AVX;
 
+   /* FMA3 operates on YMM state as well, and is not
+    * implied by AVX2 (hypervisors may mask it out) */
+   if ((cpu & RETRO_SIMD_AVX) && (flags[2] & (1 << 12)))
+      cpu |= RETRO_SIMD_FMA3;
+
    if (max_flag >= 7)
    {
       x86_cpuid(7, flags);
-      if (flags[1] & (1 << 5))
+      /* Needs the same OS support for YMM state as AVX */
+      if ((cpu & RETRO_SIMD_AVX) && (flags[1] & (1 << 5)))
          cpu |= RETRO_SIMD_AVX2;
    }
 
@@ -817,6 +838,81 @@ uint64_t cpu_features_get(void)
    return cpu;
 }
 
+#if defined(__linux__)
+static uint64_t cpu_features_read_sysfs_value(unsigned cpu, const char *file)
+{
+   char path[64];
+   int64_t length = 0;
+   char *buf      = NULL;
+   uint64_t value = 0;
+
+   snprintf(path, sizeof(path),
+         "/sys/devices/system/cpu/cpu%u/%s", cpu, file);
+
+   if (filestream_read_file(path, (void**)&buf, &length) != 1)
+      return 0;
+   if (buf)
+   {
+      value = strtoull(buf, NULL, 10);
+      free(buf);
+   }
+   return value;
+}
+#endif
+
+/**
+ * cpu_features_get_fast_core_mask:
+ *
+ * Finds the fastest cores of a CPU with cores of different
+ * speed, such as ARM big.LITTLE or hybrid x86 designs.
+ *
+ * Returns: mask of the fastest cores, bit N being core N.
+ * 0 if all cores are alike or the topology is unknown.
+ **/
+uint64_t cpu_features_get_fast_core_mask(void)
+{
+#if defined(__linux__)
+   unsigned i;
+   uint64_t mask      = 0;
+   uint64_t slow_mask = 0;
+   uint64_t best      = 0;
+   unsigned amount    = cpu_features_get_core_amount();
+
+   if (amount > 64)
+      amount = 64;
+
+   for (i = 0; i < amount; i++)
+   {
+      /* Set by the kernel on asymmetric CPUs, otherwise
+       * the highest clock is the best guess we have */
+      uint64_t value = cpu_features_read_sysfs_value(i, "cpu_capacity");
+      if (!value)
+         value = cpu_features_read_sysfs_value(i,
+               "cpufreq/cpuinfo_max_freq");
+      if (!value)
+         continue;
+
+      if (value > best)
+      {
+         slow_mask |= mask;
+         mask       = 0;
+         best       = value;
+      }
+
+      if (value == best)
+         mask      |= UINT64_C(1) << i;
+      else
+         slow_mask |= UINT64_C(1) << i;
+   }
+
+   if (!slow_mask)
+      return 0;
+   return mask;
+#else
+   return 0;
+#endif
+}
+
 void cpu_features_get_model_name(char *name, int len)
 {
 #if defined(CPU_X86) && !defined(__MACH__)
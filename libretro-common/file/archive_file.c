@@ -195,7 +195,10 @@ static int file_archive_parse_file_init(file_archive_transfer_t *state,
  * @size                        : output file size
  * @checksum                    : CRC32 checksum from input data.
  *
- * Write data to file.
+ * Write data to file. The data goes to a temporary file that
+ * then replaces @path, so a file being extracted over is never
+ * truncated while in use - readers that map it (databases) or
+ * run it (cores) would otherwise crash on the pages they lose.
  *
  * Returns: true (1) on success, otherwise false (0).
  **/
@@ -206,6 +209,8 @@ static int file_archive_decompress_data_to_file(
       uint32_t size,
       uint32_t checksum)
 {
+   char tmp_path[PATH_MAX_LENGTH];
+
    if (!handle)
       return 0;
 
@@ -220,10 +225,27 @@ static int file_archive_decompress_data_to_file(
    }
 #endif
 
-   if (!filestream_write_file(path, handle->data, size))
+   strlcpy(tmp_path, path, sizeof(tmp_path));
+   strlcat(tmp_path, ".tmp", sizeof(tmp_path));
+
+   if (!filestream_write_file(tmp_path, handle->data, size))
+   {
+      filestream_delete(tmp_path);
       return 0;
+   }
 
-   return 1;
+   if (filestream_rename(tmp_path, path) == 0)
+      return 1;
+
+#if defined(_WIN32)
+   /* rename() does not replace an existing file here */
+   if (     filestream_delete(path) == 0
+         && filestream_rename(tmp_path, path) == 0)
+      return 1;
+#endif
+
+   filestream_delete(tmp_path);
+   return 0;
 }
 
 void file_archive_parse_file_iterate_stop(file_archive_transfer_t *state)
@@ -726,6 +748,14 @@ uint32_t file_archive_get_file_crc32(const char *path)
                   &returnerr, path, NULL, NULL,
                   &userdata);
 
+      /* Reached the end of the archive without
+       * finding the file (or failed to open it) */
+      if (state.type != ARCHIVE_TRANSFER_ITERATE)
+      {
+         userdata.crc = 0;
+         break;
+      }
+
       /* If no path specified within archive, stop after
        * finding the first file.
        */
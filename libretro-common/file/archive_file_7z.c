@@ -32,6 +32,7 @@
 #include <lists/string_list.h>
 #include <file/file_path.h>
 #include <compat/strl.h>
+#include <retro_atomic.h>
 #include <7zip/7z.h>
 #include <7zip/7zCrc.h>
 #include <7zip/7zFile.h>
@@ -40,6 +41,17 @@
 #define SEVENZIP_MAGIC_LEN 6
 #define SEVENZIP_LOOKTOREAD_BUF_SIZE (1 << 14)
 
+/* Decoded solid blocks kept around for the
+ * extraction of further members */
+#define SEVENZIP_BLOCK_CACHE_SIZE    (64 * 1024 * 1024)
+#define SEVENZIP_BLOCK_CACHE_ENTRIES 8
+
+/* The cache is guarded by a spinlock, which
+ * needs real atomics once threads are involved */
+#if RETRO_ATOMIC_LOCK_FREE || !defined(HAVE_THREADS)
+#define HAVE_SEVENZIP_BLOCK_CACHE
+#endif
+
 /* Assume W-functions do not work below Win2K and Xbox platforms */
 #if defined(_WIN32_WINNT) && _WIN32_WINNT < 0x0500 || defined(_XBOX)
 #ifndef LEGACY_WIN32
@@ -50,6 +62,9 @@
 struct sevenzip_context_t
 {
    uint8_t *output;
+   char *path;
+   uint64_t archive_size;
+   size_t output_size;
    CFileInStream archiveStream;
    CLookToRead2 lookStream;
    ISzAlloc allocImp;
@@ -62,6 +77,165 @@ struct sevenzip_context_t
    uint32_t   block_index;
 };
 
+#ifdef HAVE_SEVENZIP_BLOCK_CACHE
+struct sevenzip_block
+{
+   char *path;
+   uint8_t *data;
+   uint64_t archive_size;
+   size_t size;
+   uint32_t index;
+   unsigned last_use;
+};
+
+static struct sevenzip_block sevenzip_block_cache[SEVENZIP_BLOCK_CACHE_ENTRIES];
+static size_t sevenzip_block_cache_size;
+static unsigned sevenzip_block_cache_clock;
+static retro_atomic_int_t sevenzip_block_cache_lock;
+
+static void sevenzip_block_cache_acquire(void)
+{
+   while (!retro_atomic_cas(&sevenzip_block_cache_lock, 0, 1));
+}
+
+static void sevenzip_block_cache_release(void)
+{
+   retro_atomic_store(&sevenzip_block_cache_lock, 0);
+}
+#endif
+
+/* Takes the decoded block 'index' of archive 'path'
+ * out of the cache. The caller owns the returned
+ * buffer, and may hand it back with
+ * sevenzip_block_cache_put() once done with it. */
+static bool sevenzip_block_cache_take(const char *path,
+      uint64_t archive_size, uint32_t index,
+      uint8_t **data, size_t *size)
+{
+#ifdef HAVE_SEVENZIP_BLOCK_CACHE
+   unsigned i;
+   char *block_path = NULL;
+
+   if (!path)
+      return false;
+
+   sevenzip_block_cache_acquire();
+
+   for (i = 0; i < SEVENZIP_BLOCK_CACHE_ENTRIES; i++)
+   {
+      struct sevenzip_block *block = &sevenzip_block_cache[i];
+
+      if (     block->data
+            && block->index        == index
+            && block->archive_size == archive_size
+            && string_is_equal(block->path, path))
+      {
+         *data                      = block->data;
+         *size                      = block->size;
+         block_path                 = block->path;
+         sevenzip_block_cache_size -= block->size;
+         memset(block, 0, sizeof(*block));
+         break;
+      }
+   }
+
+   sevenzip_block_cache_release();
+
+   if (!block_path)
+      return false;
+
+   free(block_path);
+   return true;
+#else
+   return false;
+#endif
+}
+
+/* Hands a decoded block over to the cache, which
+ * frees the least recently used blocks beyond
+ * SEVENZIP_BLOCK_CACHE_SIZE */
+static void sevenzip_block_cache_put(const char *path,
+      uint64_t archive_size, uint32_t index,
+      uint8_t *data, size_t size)
+{
+#ifdef HAVE_SEVENZIP_BLOCK_CACHE
+   unsigned i;
+   struct sevenzip_block evicted[SEVENZIP_BLOCK_CACHE_ENTRIES];
+   unsigned num_evicted = 0;
+   char *block_path     = NULL;
+
+   if (     !path
+         || !data
+         || size > SEVENZIP_BLOCK_CACHE_SIZE
+         || !(block_path = strdup(path)))
+   {
+      free(data);
+      return;
+   }
+
+   sevenzip_block_cache_acquire();
+
+   /* Drop another copy of the same block */
+   for (i = 0; i < SEVENZIP_BLOCK_CACHE_ENTRIES; i++)
+   {
+      struct sevenzip_block *block = &sevenzip_block_cache[i];
+
+      if (     block->data
+            && block->index        == index
+            && block->archive_size == archive_size
+            && string_is_equal(block->path, path))
+      {
+         evicted[num_evicted++]     = *block;
+         sevenzip_block_cache_size -= block->size;
+         memset(block, 0, sizeof(*block));
+      }
+   }
+
+   /* Then the least recently used blocks, until this one fits */
+   for (;;)
+   {
+      struct sevenzip_block *slot = NULL;
+      struct sevenzip_block *lru  = NULL;
+
+      for (i = 0; i < SEVENZIP_BLOCK_CACHE_ENTRIES; i++)
+      {
+         struct sevenzip_block *block = &sevenzip_block_cache[i];
+
+         if (!block->data)
+            slot = block;
+         else if (!lru || block->last_use < lru->last_use)
+            lru  = block;
+      }
+
+      if (slot && sevenzip_block_cache_size + size <= SEVENZIP_BLOCK_CACHE_SIZE)
+      {
+         slot->path                 = block_path;
+         slot->data                 = data;
+         slot->archive_size         = archive_size;
+         slot->size                 = size;
+         slot->index                = index;
+         slot->last_use             = ++sevenzip_block_cache_clock;
+         sevenzip_block_cache_size += size;
+         break;
+      }
+
+      evicted[num_evicted++]     = *lru;
+      sevenzip_block_cache_size -= lru->size;
+      memset(lru, 0, sizeof(*lru));
+   }
+
+   sevenzip_block_cache_release();
+
+   for (i = 0; i < num_evicted; i++)
+   {
+      free(evicted[i].path);
+      free(evicted[i].data);
+   }
+#else
+   free(data);
+#endif
+}
+
 static void *sevenzip_stream_alloc_impl(ISzAllocPtr p, size_t size)
 {
    if (size == 0)
@@ -115,12 +289,18 @@ static void sevenzip_parse_file_free(void *context)
    if (!sevenzip_context)
       return;
 
+   /* Another member of the last block may be asked for next */
    if (sevenzip_context->output)
    {
-      IAlloc_Free(&sevenzip_context->allocImp, sevenzip_context->output);
+      sevenzip_block_cache_put(sevenzip_context->path,
+            sevenzip_context->archive_size, sevenzip_context->block_index,
+            sevenzip_context->output, sevenzip_context->output_size);
       sevenzip_context->output       = NULL;
    }
 
+   if (sevenzip_context->path)
+      free(sevenzip_context->path);
+
    SzArEx_Free(&sevenzip_context->db, &sevenzip_context->allocImp);
    File_Close(&sevenzip_context->archiveStream.file);
 
@@ -145,6 +325,7 @@ static int64_t sevenzip_file_read(
    ISzAlloc allocImp;
    ISzAlloc allocTempImp;
    CSzArEx db;
+   uint64_t archive_size = 0;
    uint8_t *output      = 0;
    int64_t outsize      = -1;
 
@@ -184,6 +365,8 @@ static int64_t sevenzip_file_read(
       return -1;
 #endif
 
+   File_GetLength(&archiveStream.file, &archive_size);
+
    FileInStream_CreateVTable(&archiveStream);
    LookToRead2_CreateVTable(&lookStream, false);
    lookStream.realStream = &archiveStream.vt;
@@ -242,6 +425,16 @@ static int64_t sevenzip_file_read(
          if (string_is_equal(infile, needle))
          {
             size_t output_size   = 0;
+            uint32_t folder      = db.FileToFolder[i];
+            /* Only blocks holding several members are
+             * worth keeping once this one is extracted */
+            bool solid           = folder != 0xFFFFFFFF
+               && db.FolderToFile[folder + 1] - db.FolderToFile[folder] > 1;
+            bool cached          = solid && sevenzip_block_cache_take(path,
+                  archive_size, folder, &output, &output_size);
+
+            if (cached)
+               block_index       = folder;
 
             /* C LZMA SDK does not support chunked extraction - see here:
              * sourceforge.net/p/sevenzip/discussion/45798/thread/6fb59aaf/
@@ -251,6 +444,18 @@ static int64_t sevenzip_file_read(
                   &output, &output_size, &offset, &outSizeProcessed,
                   &allocImp, &allocTempImp);
 
+            /* The archive was replaced by one of the same size */
+            if (res != SZ_OK && cached)
+            {
+               IAlloc_Free(&allocImp, output);
+               output      = NULL;
+               output_size = 0;
+               block_index = 0xFFFFFFFF;
+               res = SzArEx_Extract(&db, &lookStream.vt, i, &block_index,
+                     &output, &output_size, &offset, &outSizeProcessed,
+                     &allocImp, &allocTempImp);
+            }
+
             if (res != SZ_OK)
                break; /* This goes to the error section. */
 
@@ -267,16 +472,45 @@ static int64_t sevenzip_file_read(
                   outsize    = -1;
                }
             }
+            else if (solid)
+            {
+               uint8_t *data = (uint8_t*)malloc((size_t)(outsize + 1));
+
+               if (data)
+               {
+                  memcpy(data, output + offset, (size_t)outsize);
+                  data[outsize] = '\0';
+                  *buf          = data;
+               }
+               else
+                  outsize       = -1;
+            }
             else
             {
-               /*We could either use the 7Zip allocated buffer,
-                * or create our own and use it.
-                * We would however need to realloc anyways, because RetroArch
-                * expects a \0 at the end, therefore we allocate new,
-                * copy and free the old one. */
-               *buf = malloc((size_t)(outsize + 1));
-               ((char*)(*buf))[outsize] = '\0';
-               memcpy(*buf,output + offset,outsize);
+               /* The 7Zip output buffer is allocated with malloc(),
+                * so it is handed over instead of copied. It only
+                * needs to be resized, since RetroArch expects
+                * a \0 at the end */
+               uint8_t *data = output;
+
+               if (offset != 0)
+                  memmove(data, output + offset, (size_t)outsize);
+
+               if ((data = (uint8_t*)realloc(data, (size_t)(outsize + 1))))
+               {
+                  data[outsize] = '\0';
+                  *buf          = data;
+                  output        = NULL;
+               }
+               else
+                  outsize       = -1;
+            }
+
+            if (solid && output)
+            {
+               sevenzip_block_cache_put(path, archive_size, folder,
+                     output, output_size);
+               output = NULL;
             }
             break;
          }
@@ -328,18 +562,43 @@ static int sevenzip_stream_decompress_data_to_file_iterate(
          (struct sevenzip_context_t*)context;
 
    SRes res                = SZ_ERROR_FAIL;
-   size_t output_size      = 0;
    size_t offset           = 0;
    size_t outSizeProcessed = 0;
+   uint32_t folder         = sevenzip_context->db.FileToFolder[
+      sevenzip_context->decompress_index];
+
+   /* Swap the decoded block for a cached one */
+   if (folder != 0xFFFFFFFF && folder != sevenzip_context->block_index)
+   {
+      if (sevenzip_context->output)
+         sevenzip_block_cache_put(sevenzip_context->path,
+               sevenzip_context->archive_size, sevenzip_context->block_index,
+               sevenzip_context->output, sevenzip_context->output_size);
+      sevenzip_context->output      = NULL;
+      sevenzip_context->output_size = 0;
+      sevenzip_context->block_index = 0xFFFFFFFF;
+
+      if (sevenzip_block_cache_take(sevenzip_context->path,
+               sevenzip_context->archive_size, folder,
+               &sevenzip_context->output, &sevenzip_context->output_size))
+         sevenzip_context->block_index = folder;
+   }
 
    res = SzArEx_Extract(&sevenzip_context->db,
          &sevenzip_context->lookStream.vt, sevenzip_context->decompress_index,
          &sevenzip_context->block_index, &sevenzip_context->output,
-         &output_size, &offset, &outSizeProcessed,
+         &sevenzip_context->output_size, &offset, &outSizeProcessed,
          &sevenzip_context->allocImp, &sevenzip_context->allocTempImp);
 
    if (res != SZ_OK)
-      return 0;
+   {
+      /* Never reuse a block that failed to check out */
+      IAlloc_Free(&sevenzip_context->allocImp, sevenzip_context->output);
+      sevenzip_context->output      = NULL;
+      sevenzip_context->output_size = 0;
+      sevenzip_context->block_index = 0xFFFFFFFF;
+      return -1;
+   }
 
    if (handle)
       handle->data = sevenzip_context->output + offset;
@@ -400,6 +659,10 @@ static int sevenzip_parse_file_init(file_archive_transfer_t *state,
          &sevenzip_context->allocImp, &sevenzip_context->allocTempImp) != SZ_OK)
       goto error;
 
+   File_GetLength(&sevenzip_context->archiveStream.file,
+         &sevenzip_context->archive_size);
+   sevenzip_context->path = strdup(file);
+
    state->step_total = sevenzip_context->db.NumFiles;
 
    return 0;
@@ -193,7 +193,9 @@ static int zlib_stream_decompress_data_to_file_iterate(
       return 1;
    }
 
-   zstatus = zlib_inflate_backend.trans(zip_context->current_stream, false, &rd, &wn, &terror);
+   /* The output buffer holds the whole member, so the
+    * stream can be finished in a single call */
+   zstatus = zlib_inflate_backend.trans(zip_context->current_stream, true, &rd, &wn, &terror);
 
    if (zstatus && !terror)
    {
@@ -30,6 +30,9 @@
 #include <sys/fcntl.h>
 #include <orbisFile.h>
 #endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
 #include <retro_miscellaneous.h>
 #include <compat/strl.h>
 #include <compat/posix_string.h>
@@ -43,15 +46,37 @@
 
 #define MAX_INCLUDE_DEPTH 16
 
+/* Allocations of CONFIG_FILE_BLOCK_SIZE / 4 bytes or
+ * more get a block of their own */
+#define CONFIG_FILE_BLOCK_SIZE 4096
+
+#define CONFIG_FILE_ALIGN(len) (((len) + sizeof(void*) - 1) & ~(sizeof(void*) - 1))
+
 struct config_include_list
 {
    char *path;
    struct config_include_list *next;
 };
 
+/* Entries, key/value strings and include paths are carved
+ * out of a chain of blocks owned by the config file, and are
+ * released all at once by config_file_deinitialize().
+ * A block either holds its data inline or adopts a buffer
+ * allocated elsewhere - i.e. the contents of a config file,
+ * which is parsed in place.
+ * The head of the chain is the block currently being
+ * filled; full and adopted blocks are linked behind it */
+struct config_file_block
+{
+   struct config_file_block *next;
+   char *data;
+   size_t size;
+   size_t used;
+};
+
 /* Forward declaration */
 static bool config_file_parse_line(config_file_t *conf,
-      struct config_entry_list *list, char *line, config_file_cb_t *cb);
+      char *line, config_file_cb_t *cb);
 
 static int config_file_sort_compare_func(struct config_entry_list *a,
       struct config_entry_list *b)
@@ -205,10 +230,275 @@ static char *config_file_strip_comment(char *str)
    return NULL;
 }
 
+static void config_file_link_block(config_file_t *conf,
+      struct config_file_block *block, bool active)
+{
+   if (active || !conf->blocks)
+   {
+      block->next        = conf->blocks;
+      conf->blocks       = block;
+   }
+   else
+   {
+      block->next        = conf->blocks->next;
+      conf->blocks->next = block;
+   }
+}
+
+static void *config_file_alloc(config_file_t *conf, size_t len)
+{
+   struct config_file_block *block = conf->blocks;
+   void *ptr                       = NULL;
+
+   len = CONFIG_FILE_ALIGN(len);
+
+   if (!block || (block->size - block->used) < len)
+   {
+      bool active = len < (CONFIG_FILE_BLOCK_SIZE / 4);
+      size_t size = active ? CONFIG_FILE_BLOCK_SIZE : len;
+
+      if (!(block = (struct config_file_block*)
+               malloc(sizeof(*block) + size)))
+         return NULL;
+
+      block->data = (char*)(block + 1);
+      block->size = size;
+      block->used = 0;
+
+      config_file_link_block(conf, block, active);
+   }
+
+   ptr          = block->data + block->used;
+   block->used += len;
+   return ptr;
+}
+
+static char *config_file_strdup(config_file_t *conf, const char *str)
+{
+   size_t len = strlen(str) + 1;
+   char  *s   = (char*)config_file_alloc(conf, len);
+   if (s)
+      memcpy(s, str, len);
+   return s;
+}
+
+/* Hands 'data' (allocated with malloc()) over to 'conf' */
+static bool config_file_adopt(config_file_t *conf, char *data)
+{
+   struct config_file_block *block = (struct config_file_block*)
+      malloc(sizeof(*block));
+
+   if (!block)
+      return false;
+
+   block->data = data;
+   block->size = 0;
+   block->used = 0;
+
+   config_file_link_block(conf, block, false);
+   return true;
+}
+
+/* Moves all blocks of 'src' over to 'conf' */
+static void config_file_take_blocks(config_file_t *conf,
+      config_file_t *src)
+{
+   struct config_file_block *block = src->blocks;
+
+   if (!block)
+      return;
+
+   if (conf->blocks)
+   {
+      while (block->next)
+         block = block->next;
+
+      block->next        = conf->blocks->next;
+      conf->blocks->next = src->blocks;
+   }
+   else
+      conf->blocks       = src->blocks;
+
+   src->blocks = NULL;
+}
+
+static void config_file_free_blocks(config_file_t *conf)
+{
+   struct config_file_block *block = conf->blocks;
+
+   while (block)
+   {
+      struct config_file_block *next = block->next;
+
+      if (block->data != (char*)(block + 1))
+         free(block->data);
+      free(block);
+
+      block = next;
+   }
+
+   conf->blocks = NULL;
+}
+
+static struct config_entry_list *config_file_map_get(
+      const config_file_t *conf, uint32_t hash, const char *key)
+{
+   size_t mask;
+   size_t i;
+
+   if (!conf->entries_map)
+      return NULL;
+
+   mask = conf->entries_map_cap - 1;
+
+   for (i = hash & mask; conf->entries_map[i]; i = (i + 1) & mask)
+   {
+      struct config_entry_list *entry = conf->entries_map[i];
+
+      if (     entry->hash == hash
+            && string_is_equal(entry->key, key))
+         return entry;
+   }
+
+   return NULL;
+}
+
+/* Ensures that 'count' more entries can be added to
+ * the map without growing it */
+static bool config_file_map_reserve(config_file_t *conf, size_t count)
+{
+   struct config_entry_list **map = NULL;
+   size_t cap                     = conf->entries_map_cap;
+   size_t mask;
+   size_t i;
+
+   if (!cap)
+      cap  = 16;
+
+   /* Keep the load factor at or below 1/2 */
+   while (cap < (conf->entries_map_len + count) * 2)
+      cap *= 2;
+
+   if (cap == conf->entries_map_cap)
+      return true;
+
+   if (!(map = (struct config_entry_list**)
+            calloc(cap, sizeof(*map))))
+      return false;
+
+   mask = cap - 1;
+
+   for (i = 0; i < conf->entries_map_cap; i++)
+   {
+      struct config_entry_list *entry = conf->entries_map[i];
+      size_t j;
+
+      if (!entry)
+         continue;
+
+      for (j = entry->hash & mask; map[j]; j = (j + 1) & mask);
+      map[j] = entry;
+   }
+
+   free(conf->entries_map);
+   conf->entries_map     = map;
+   conf->entries_map_cap = cap;
+   return true;
+}
+
+/* Adds 'entry' to the map. If an entry with the same
+ * key already exists, it is only replaced if 'replace'
+ * is set. Returns true if 'entry' was added */
+static bool config_file_map_add(config_file_t *conf,
+      struct config_entry_list *entry, bool replace)
+{
+   size_t mask;
+   size_t i;
+
+   if (!config_file_map_reserve(conf, 1))
+      return false;
+
+   mask = conf->entries_map_cap - 1;
+
+   for (i = entry->hash & mask; conf->entries_map[i]; i = (i + 1) & mask)
+   {
+      struct config_entry_list *cur = conf->entries_map[i];
+
+      if (     cur->hash == entry->hash
+            && string_is_equal(cur->key, entry->key))
+      {
+         if (!replace)
+            return false;
+         conf->entries_map[i] = entry;
+         return true;
+      }
+   }
+
+   conf->entries_map[i] = entry;
+   conf->entries_map_len++;
+   return true;
+}
+
+static void config_file_map_del(config_file_t *conf,
+      struct config_entry_list *entry)
+{
+   size_t mask;
+   size_t i;
+   size_t j;
+
+   if (!conf->entries_map)
+      return;
+
+   mask = conf->entries_map_cap - 1;
+
+   for (i = entry->hash & mask; conf->entries_map[i] != entry;
+         i = (i + 1) & mask)
+      if (!conf->entries_map[i])
+         return;
+
+   conf->entries_map[i] = NULL;
+   conf->entries_map_len--;
+
+   /* Shift back any following entry whose probe
+    * sequence passes through the freed slot */
+   for (j = (i + 1) & mask; conf->entries_map[j]; j = (j + 1) & mask)
+   {
+      size_t home = conf->entries_map[j]->hash & mask;
+
+      if (((j - home) & mask) >= ((j - i) & mask))
+      {
+         conf->entries_map[i] = conf->entries_map[j];
+         conf->entries_map[j] = NULL;
+         i                    = j;
+      }
+   }
+}
+
+/* Appends 'entry' to the list. Returns true if its
+ * key is new, i.e. if it was added to the map */
+static bool config_file_add_entry(config_file_t *conf,
+      struct config_entry_list *entry)
+{
+   if (conf->tail)
+      conf->tail->next = entry;
+   else
+      conf->entries    = entry;
+
+   conf->tail          = entry;
+
+   /* Only add entry to the map if an entry
+    * with the specified key does not
+    * already exist */
+   return config_file_map_add(conf, entry, false);
+}
+
+/* Parses a value (or the argument of a directive)
+ * in place
+ * > Returns a pointer into 'line', or NULL if 'is_value'
+ *   is set and 'line' does not start with an equal sign */
 static char *config_file_extract_value(char *line, bool is_value)
 {
    size_t idx  = 0;
-   char *value = NULL;
 
    if (is_value)
    {
@@ -227,8 +517,7 @@ static char *config_file_extract_value(char *line, bool is_value)
       line++;
 
    /* Note: From this point on, an empty value
-    * string is valid - and in this case, strdup("")
-    * will be returned
+    * string is valid
     * > If we instead return NULL, the the entry
     *   is ignored completely - which means we cannot
     *   track *changes* in entry value */
@@ -240,121 +529,47 @@ static char *config_file_extract_value(char *line, bool is_value)
       /* Skip to next character */
       line++;
 
-      /* If this a ("), then value string is empty */
-      if (*line == '"')
-         return strdup("");
-
       /* Find the next (") character */
       while (line[idx] && (line[idx] != '\"'))
          idx++;
-
-      line[idx] = '\0';
-      value     = line;
    }
    /* This is not a string literal - just read
-    * until the next space is found
-    * > Note: Skip this if line is empty */
-   else if (*line != '\0')
-   {
-      /* Find next space character */
+    * until the next space is found */
+   else
       while (line[idx] && isgraph((int)line[idx]))
          idx++;
 
-      line[idx] = '\0';
-      value     = line;
-   }
-
-   if (value && *value)
-      return strdup(value);
-
-   return strdup("");
+   line[idx] = '\0';
+   return line;
 }
 
-/* Move semantics? */
 static void config_file_add_child_list(config_file_t *parent, config_file_t *child)
 {
    struct config_entry_list *list = child->entries;
-   bool merge_hash_map            = false;
-
-   if (parent->entries)
-   {
-      struct config_entry_list *head = parent->entries;
-      while (head->next)
-         head = head->next;
 
-      /* set list readonly */
-      while (list)
-      {
-         list->readonly = true;
-         list           = list->next;
-      }
-      head->next        = child->entries;
-
-      merge_hash_map    = true;
-   }
-   else
+   /* Set list readonly, and add any child entry (key)
+    * not present in the parent list to the parent map */
+   for (; list; list = list->next)
    {
-      /* set list readonly */
-      while (list)
-      {
-         list->readonly = true;
-         list           = list->next;
-      }
-      parent->entries   = child->entries;
+      list->readonly = true;
+      config_file_map_add(parent, list, false);
    }
 
-   /* Rebase tail. */
-   if (parent->entries)
+   if (child->entries)
    {
-      struct config_entry_list *head =
-         (struct config_entry_list*)parent->entries;
+      if (parent->tail)
+         parent->tail->next = child->entries;
+      else
+         parent->entries    = child->entries;
 
-      while (head->next)
-         head = head->next;
-      parent->tail = head;
+      parent->tail          = child->tail;
    }
-   else
-      parent->tail = NULL;
-
-   /* Update hash map */
-   if (merge_hash_map)
-   {
-      size_t i;
-      size_t cap;
-
-      /* We are merging two lists - if any child entry
-       * (key) is not present in the parent list, add it
-       * to the parent hash map */
-      for (i = 0, cap = RHMAP_CAP(child->entries_map); i != cap; i++)
-      {
-         uint32_t child_hash   = RHMAP_KEY(child->entries_map, i);
-         const char *child_key = RHMAP_KEY_STR(child->entries_map, i);
 
-         if (child_hash &&
-             child_key &&
-             !RHMAP_HAS_FULL(parent->entries_map, child_hash, child_key))
-         {
-            struct config_entry_list *entry = child->entries_map[i];
-
-            if (entry)
-               RHMAP_SET_FULL(parent->entries_map, child_hash, child_key, entry);
-         }
-      }
-
-      /* Child entries map is no longer required,
-       * so free it now */
-      RHMAP_FREE(child->entries_map);
-   }
-   else
-   {
-      /* If parent list was originally empty,
-       * take map from child list */
-      RHMAP_FREE(parent->entries_map);
-      parent->entries_map = child->entries_map;
-      child->entries_map  = NULL;
-   }
+   /* Child entries live in child blocks */
+   config_file_take_blocks(parent, child);
 
    child->entries = NULL;
+   child->tail    = NULL;
 }
 
 static void config_file_get_realpath(char *s, size_t len,
@@ -384,174 +599,138 @@ static void config_file_get_realpath(char *s, size_t len,
 #endif
 }
 
-static void config_file_add_sub_conf(config_file_t *conf, char *path,
-      char *real_path, size_t len, config_file_cb_t *cb)
+static bool config_file_add_sub_conf(config_file_t *conf, char *path,
+      char *real_path, size_t len)
 {
    struct config_include_list *head = conf->includes;
    struct config_include_list *node = (struct config_include_list*)
-      malloc(sizeof(*node));
+      config_file_alloc(conf, sizeof(*node));
 
-   if (node)
-   {
-      node->next        = NULL;
-      /* Add include list */
-      node->path        = strdup(path);
+   if (!node)
+      return false;
 
-      if (head)
-      {
-         while (head->next)
-            head        = head->next;
+   /* 'path' points into the (in place parsed)
+    * buffer of 'conf' */
+   node->next        = NULL;
+   node->path        = path;
 
-         head->next     = node;
-      }
-      else
-         conf->includes = node;
+   /* Add include list */
+   if (head)
+   {
+      while (head->next)
+         head        = head->next;
+
+      head->next     = node;
    }
+   else
+      conf->includes = node;
 
    config_file_get_realpath(real_path, len, path,
          conf->path);
+   return true;
+}
+
+/* Parses the NUL-terminated buffer 'buf' of 'len'
+ * bytes in place. 'buf' must be owned by 'conf' */
+static int config_file_parse_buffer(config_file_t *conf,
+      char *buf, size_t len, config_file_cb_t *cb)
+{
+   char       *line  = buf;
+   char       *end   = buf + len;
+   const char *s     = buf;
+   size_t lines      = 1;
+
+   /* Size the map for the worst case up front */
+   while ((s = (const char*)memchr(s, '\n', end - s)))
+   {
+      lines++;
+      s++;
+   }
+
+   if (!config_file_map_reserve(conf, lines))
+      return -1;
+
+   while (line < end)
+   {
+      char *eol = (char*)memchr(line, '\n', end - line);
+
+      if (eol)
+         *eol   = '\0';
+      else
+         eol    = end;
+
+      if (     !string_is_empty(line)
+            && !config_file_parse_line(conf, line, cb))
+         return -1;
+
+      line      = eol + 1;
+   }
+
+   return 0;
 }
 
 static int config_file_load_internal(
       struct config_file *conf,
       const char *path, unsigned depth, config_file_cb_t *cb)
 {
-   RFILE         *file = NULL;
+   void          *buf  = NULL;
+   int64_t     length  = 0;
    char      *new_path = strdup(path);
    if (!new_path)
       return 1;
 
    conf->path          = new_path;
    conf->include_depth = depth;
-   file                = filestream_open(path,
-         RETRO_VFS_FILE_ACCESS_READ,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE);
 
-   if (!file)
+   if (!filestream_read_file(path, &buf, &length))
    {
       free(conf->path);
+      conf->path       = NULL;
       return 1;
    }
 
-   while (!filestream_eof(file))
+   if (!config_file_adopt(conf, (char*)buf))
    {
-      char *line                     = NULL;
-      struct config_entry_list *list = (struct config_entry_list*)
-         malloc(sizeof(*list));
-
-      if (!list)
-      {
-         filestream_close(file);
-         return -1;
-      }
-
-      list->readonly  = false;
-      list->key       = NULL;
-      list->value     = NULL;
-      list->next      = NULL;
-
-      line            = filestream_getline(file);
-
-      if (!line)
-      {
-         free(list);
-         continue;
-      }
-
-      if ( 
-              !string_is_empty(line) 
-            && config_file_parse_line(conf, list, line, cb))
-      {
-         if (conf->entries)
-            conf->tail->next = list;
-         else
-            conf->entries    = list;
-
-         conf->tail = list;
-
-         if (list->key)
-         {
-            /* Only add entry to the map if an entry
-             * with the specified value does not
-             * already exist */
-            uint32_t hash = rhmap_hash_string(list->key);
-
-            if (!RHMAP_HAS_FULL(conf->entries_map, hash, list->key))
-            {
-               RHMAP_SET_FULL(conf->entries_map, hash, list->key, list);
-
-               if (cb && list->value)
-                  cb->config_file_new_entry_cb(list->key, list->value);
-            }
-         }
-      }
-
-      free(line);
-
-      if (list != conf->tail)
-         free(list);
+      free(buf);
+      return -1;
    }
 
-   filestream_close(file);
-
-   return 0;
+   return config_file_parse_buffer(conf, (char*)buf, (size_t)length, cb);
 }
 
+/* Returns false if memory could not be allocated */
 static bool config_file_parse_line(config_file_t *conf,
-      struct config_entry_list *list, char *line, config_file_cb_t *cb)
+      char *line, config_file_cb_t *cb)
 {
-   size_t cur_size       = 32;
-   size_t idx            = 0;
-   char *key             = NULL;
-   char *key_tmp         = NULL;
+   struct config_entry_list *list = NULL;
+   char *key                      = NULL;
+   char *value                    = NULL;
    /* Remove any comment text */
-   char *comment         = config_file_strip_comment(line);
+   char *comment                  = config_file_strip_comment(line);
 
    /* Check whether entire line is a comment */
    if (comment)
    {
       config_file_t sub_conf;
-      bool include_found       = false;
-      bool reference_found     = false;
       char real_path[PATH_MAX_LENGTH];
       char *path               = NULL;
-      char *include_line       = NULL;
-      char *reference_line     = NULL;
-
-      include_found = string_starts_with_size(comment, "include ",
-                                          STRLEN_CONST("include "));
-      reference_found = string_starts_with_size(comment, "reference ",
-                                          STRLEN_CONST("reference "));
-
-      /* All comments except those starting with the include or 
-       * reference directive are ignored */
-      if (!include_found && !reference_found)
-         return false;
 
       /* Starting a line with an 'include' directive
        * appends a sub-config file */
-      if (include_found)
+      if (string_starts_with_size(comment, "include ",
+               STRLEN_CONST("include ")))
       {
-         include_line = comment + STRLEN_CONST("include ");
-
-         if (string_is_empty(include_line))
-            return false;
-
-         path = config_file_extract_value(include_line, false);
-
-         if (!path)
-            return false;
+         path = config_file_extract_value(
+               comment + STRLEN_CONST("include "), false);
 
          if (     string_is_empty(path)
                || conf->include_depth >= MAX_INCLUDE_DEPTH)
-         {
-            free(path);
-            return false;
-         }
+            return true;
 
          real_path[0]         = '\0';
-         config_file_add_sub_conf(conf, path,
-            real_path, sizeof(real_path), cb);
+         if (!config_file_add_sub_conf(conf, path,
+               real_path, sizeof(real_path)))
+            return false;
 
          config_file_initialize(&sub_conf);
 
@@ -570,28 +749,19 @@ static bool config_file_parse_line(config_file_t *conf,
                break;
          }
       }
-
       /* Starting a line with an 'reference' directive
        * sets the reference path */
-      if (reference_found)
+      else if (string_starts_with_size(comment, "reference ",
+               STRLEN_CONST("reference ")))
       {
-         reference_line = comment + STRLEN_CONST("reference ");
-
-         if (string_is_empty(reference_line))
-            return false;
-
-         path = config_file_extract_value(reference_line, false);
+         char *reference_line = comment + STRLEN_CONST("reference ");
 
-         if (!path)
-            return false;
-
-         config_file_set_reference_path(conf, path);
-
-         if (!path)
-            return false;
+         if (!string_is_empty(reference_line))
+            config_file_set_reference_path(conf,
+                  config_file_extract_value(reference_line, false));
       }
 
-      free(path);
+      /* All other comments are ignored */
       return true;
    }
 
@@ -599,46 +769,33 @@ static bool config_file_parse_line(config_file_t *conf,
    while (ISSPACE((int)*line))
       line++;
 
-   /* Allocate storage for key */
-   key = (char*)malloc(cur_size + 1);
-   if (!key)
-      return false;
-
-   /* Copy line contents into key until we
-    * reach the next space character */
+   /* Key runs until the next space character */
+   key = line;
    while (isgraph((int)*line))
-   {
-      /* If current key storage is too small,
-       * double its size */
-      if (idx == cur_size)
-      {
-         cur_size *= 2;
-         key_tmp   = (char*)realloc(key, cur_size + 1);
-
-         if (!key_tmp)
-         {
-            free(key);
-            return false;
-         }
+      line++;
 
-         key = key_tmp;
-      }
+   /* An entry without a value is invalid */
+   if (!*line)
+      return true;
 
-      key[idx++] = *line++;
-   }
-   key[idx]      = '\0';
+   *line++ = '\0';
 
-   /* Add key and value entries to list */
-   list->key     = key;
-   list->value   = config_file_extract_value(line, true);
+   if (!(value = config_file_extract_value(line, true)))
+      return true;
 
-   /* An entry without a value is invalid */
-   if (!list->value)
-   {
-      list->key = NULL;
-      free(key);
+   if (!(list = (struct config_entry_list*)
+            config_file_alloc(conf, sizeof(*list))))
       return false;
-   }
+
+   list->key             = key;
+   list->value           = value;
+   list->next            = NULL;
+   list->hash            = rhmap_hash_string(key);
+   list->readonly        = false;
+   list->value_allocated = false;
+
+   if (config_file_add_entry(conf, list) && cb)
+      cb->config_file_new_entry_cb(list->key, list->value);
 
    return true;
 }
@@ -648,62 +805,22 @@ static int config_file_from_string_internal(
       char *from_string,
       const char *path)
 {
-   char *lines                    = from_string;
-   char *save_ptr                 = NULL;
-   char *line                     = NULL;
+   char *lines = NULL;
+   size_t len  = 0;
 
    if (!string_is_empty(path))
-      conf->path                  = strdup(path);
-   if (string_is_empty(lines))
+      conf->path = strdup(path);
+   if (string_is_empty(from_string))
       return 0;
 
-   /* Get first line of config file */
-   line = strtok_r(lines, "\n", &save_ptr);
-
-   while (line)
-   {
-      struct config_entry_list *list = (struct config_entry_list*)
-            malloc(sizeof(*list));
-
-      if (!list)
-         return -1;
-
-      list->readonly  = false;
-      list->key       = NULL;
-      list->value     = NULL;
-      list->next      = NULL;
-
-      /* Parse current line */
-      if (
-              !string_is_empty(line)
-            && config_file_parse_line(conf, list, line, NULL))
-      {
-         if (conf->entries)
-            conf->tail->next = list;
-         else
-            conf->entries    = list;
-
-         conf->tail          = list;
-
-         if (list->key)
-         {
-            /* Only add entry to the map if an entry
-             * with the specified value does not
-             * already exist */
-            uint32_t hash = rhmap_hash_string(list->key);
-            if (!RHMAP_HAS_FULL(conf->entries_map, hash, list->key))
-               RHMAP_SET_FULL(conf->entries_map, hash, list->key, list);
-         }
-      }
-
-      if (list != conf->tail)
-         free(list);
+   /* Parse a private copy, so that entries may
+    * point into it */
+   len   = strlen(from_string);
+   if (!(lines = (char*)config_file_alloc(conf, len + 1)))
+      return -1;
+   memcpy(lines, from_string, len + 1);
 
-      /* Get next line of config file */
-      line = strtok_r(NULL, "\n", &save_ptr);
-   }
-   
-   return 0;
+   return config_file_parse_buffer(conf, lines, len, NULL);
 }
 
 void config_file_set_reference_path(config_file_t *conf, char *path)
@@ -730,41 +847,21 @@ void config_file_set_reference_path(config_file_t *conf, char *path)
 
 bool config_file_deinitialize(config_file_t *conf)
 {
-   struct config_include_list *inc_tmp = NULL;
-   struct config_entry_list *tmp       = NULL;
+   struct config_entry_list *tmp = NULL;
    if (!conf)
       return false;
 
-   tmp = conf->entries;
-   while (tmp)
-   {
-      struct config_entry_list *hold = NULL;
-      if (tmp->key)
-         free(tmp->key);
-      if (tmp->value)
+   /* Everything else lives in the blocks */
+   for (tmp = conf->entries; tmp; tmp = tmp->next)
+      if (tmp->value_allocated)
          free(tmp->value);
 
-      tmp->value = NULL;
-      tmp->key   = NULL;
-
-      hold       = tmp;
-      tmp        = tmp->next;
+   config_file_free_blocks(conf);
 
-      if (hold)
-         free(hold);
-   }
-
-   inc_tmp = (struct config_include_list*)conf->includes;
-   while (inc_tmp)
-   {
-      struct config_include_list *hold = NULL;
-      if (inc_tmp->path)
-         free(inc_tmp->path);
-      hold    = (struct config_include_list*)inc_tmp;
-      inc_tmp = inc_tmp->next;
-      if (hold)
-         free(hold);
-   }
+   conf->entries  = NULL;
+   conf->tail     = NULL;
+   conf->last     = NULL;
+   conf->includes = NULL;
 
    if (conf->reference)
       free(conf->reference);
@@ -772,7 +869,7 @@ bool config_file_deinitialize(config_file_t *conf)
    if (conf->path)
       free(conf->path);
 
-   RHMAP_FREE(conf->entries_map);
+   free(conf->entries_map);
 
    return true;
 }
@@ -788,33 +885,30 @@ bool config_append_file(config_file_t *conf, const char *path)
 {
    config_file_t *new_conf = config_file_new_from_path_to_string(path);
    size_t i;
-   size_t cap;
 
    if (!new_conf)
       return false;
 
    /* Update hash map */
-   for (i = 0, cap = RHMAP_CAP(new_conf->entries_map); i != cap; i++)
+   for (i = 0; i < new_conf->entries_map_cap; i++)
    {
-      uint32_t new_hash   = RHMAP_KEY(new_conf->entries_map, i);
-      const char *new_key = RHMAP_KEY_STR(new_conf->entries_map, i);
-
-      if (new_hash && new_key)
-      {
-         struct config_entry_list *entry = new_conf->entries_map[i];
+      struct config_entry_list *entry = new_conf->entries_map[i];
 
-         if (entry)
-            RHMAP_SET_FULL(conf->entries_map, new_hash, new_key, entry);
-      }
+      if (entry)
+         config_file_map_add(conf, entry, true);
    }
 
    if (new_conf->tail)
    {
       new_conf->tail->next = conf->entries;
+      if (!conf->tail)
+         conf->tail        = new_conf->tail;
       conf->entries        = new_conf->entries; /* Pilfer. */
       new_conf->entries    = NULL;
    }
 
+   config_file_take_blocks(conf, new_conf);
+
    config_file_free(new_conf);
    return true;
 }
@@ -837,22 +931,32 @@ config_file_t *config_file_new_from_string(char *from_string,
 config_file_t *config_file_new_from_path_to_string(const char *path)
 {
    int64_t length                = 0;
-   uint8_t *ret_buf              = NULL;
+   void *ret_buf                 = NULL;
    config_file_t *conf           = NULL;
 
-   if (path_is_valid(path))
+   if (!path_is_valid(path))
+      return NULL;
+
+   if (!filestream_read_file(path, &ret_buf, &length))
+      return NULL;
+
+   /* 'ret_buf' is handed over to 'conf' and
+    * parsed in place */
+   if (     !(conf = config_file_new_alloc())
+         || !config_file_adopt(conf, (char*)ret_buf))
    {
-      if (filestream_read_file(path, (void**)&ret_buf, &length))
-      {
-         /* Note: 'ret_buf' is not used outside this
-          * function - we do not care that it will be
-          * modified by config_file_new_from_string() */
-         if (length >= 0)
-            conf = config_file_new_from_string((char*)ret_buf, path);
-
-         if ((void*)ret_buf)
-            free((void*)ret_buf);
-      }
+      free(ret_buf);
+      config_file_free(conf);
+      return NULL;
+   }
+
+   conf->path = strdup(path);
+
+   if (config_file_parse_buffer(conf, (char*)ret_buf,
+            (size_t)length, NULL) == -1)
+   {
+      config_file_free(conf);
+      return NULL;
    }
 
    return conf;
@@ -911,6 +1015,9 @@ void config_file_initialize(struct config_file *conf)
    conf->last                     = NULL;
    conf->reference                = NULL;
    conf->includes                 = NULL;
+   conf->blocks                   = NULL;
+   conf->entries_map_cap          = 0;
+   conf->entries_map_len          = 0;
    conf->include_depth            = 0;
    conf->guaranteed_no_duplicates = false;
    conf->modified                 = false;
@@ -925,33 +1032,10 @@ config_file_t *config_file_new_alloc(void)
    return conf;
 }
 
-static struct config_entry_list *config_get_entry_internal(
-      const config_file_t *conf,
-      const char *key, struct config_entry_list **prev)
-{
-   struct config_entry_list *entry    = NULL;
-   struct config_entry_list *previous = prev ? *prev : NULL;
-
-   entry = RHMAP_GET_STR(conf->entries_map, key);
-
-   if (entry)
-      return entry;
-
-   if (prev)
-   {
-      for (entry = conf->entries; entry; entry = entry->next)
-         previous = entry;
-
-      *prev = previous;
-   }
-
-   return NULL;
-}
-
 struct config_entry_list *config_get_entry(
       const config_file_t *conf, const char *key)
 {
-   return RHMAP_GET_STR(conf->entries_map, key);
+   return config_file_map_get(conf, rhmap_hash_string(key), key);
 }
 
 bool config_get_double(config_file_t *conf, const char *key, double *in)
@@ -1164,95 +1248,100 @@ bool config_get_bool(config_file_t *conf, const char *key, bool *in)
 
 void config_set_string(config_file_t *conf, const char *key, const char *val)
 {
-   struct config_entry_list *last  = NULL;
    struct config_entry_list *entry = NULL;
 
    if (!conf || !key || !val)
       return;
 
-   last                            = conf->entries;
-
-   if (conf->guaranteed_no_duplicates)
+   if (!conf->guaranteed_no_duplicates)
    {
-      if (conf->last)
-         last                      = conf->last;
-   }
-   else
-   {
-      entry                        = config_get_entry_internal(
-            conf, key, &last);
+      entry = config_get_entry(conf, key);
       if (entry)
       {
          /* An entry corresponding to 'key' already exists
           * > Check whether value is currently set */
          if (entry->value)
          {
+            size_t len = strlen(entry->value);
+
             /* Do nothing if value is unchanged */
             if (string_is_equal(entry->value, val))
                return;
 
             /* Value is to be updated
-             * > Free existing */
-            free(entry->value);
+             * > Reuse existing storage if the new
+             *   value fits, otherwise free it */
+            if (strlen(val) <= len)
+            {
+               strcpy(entry->value, val);
+               entry->readonly = false;
+               conf->modified  = true;
+               return;
+            }
+
+            if (entry->value_allocated)
+               free(entry->value);
          }
 
          /* Update value
           * > Note that once a value is set, it
           *   is no longer considered 'read only' */
-         entry->value    = strdup(val);
-         entry->readonly = false;
-         conf->modified  = true;
+         entry->value           = strdup(val);
+         entry->value_allocated = true;
+         entry->readonly        = false;
+         conf->modified         = true;
          return;
       }
    }
 
    /* Entry corresponding to 'key' does not exist
     * > Create new entry */
-   entry = (struct config_entry_list*)malloc(sizeof(*entry));
+   entry = (struct config_entry_list*)config_file_alloc(conf, sizeof(*entry));
    if (!entry)
       return;
 
-   entry->readonly  = false;
-   entry->key       = strdup(key);
-   entry->value     = strdup(val);
-   entry->next      = NULL;
-   conf->modified   = true;
+   if (     !(entry->key   = config_file_strdup(conf, key))
+         || !(entry->value = config_file_strdup(conf, val)))
+      return;
+
+   entry->next            = NULL;
+   entry->hash            = rhmap_hash_string(entry->key);
+   entry->readonly        = false;
+   entry->value_allocated = false;
+   conf->modified         = true;
 
-   if (last)
-      last->next    = entry;
+   if (conf->tail)
+      conf->tail->next    = entry;
    else
-      conf->entries = entry;
+      conf->entries       = entry;
 
-   conf->last       = entry;
+   conf->tail             = entry;
+   conf->last             = entry;
 
-   RHMAP_SET_STR(conf->entries_map, entry->key, entry);
+   config_file_map_add(conf, entry, true);
 }
 
 void config_unset(config_file_t *conf, const char *key)
 {
-   struct config_entry_list *last  = NULL;
    struct config_entry_list *entry = NULL;
 
    if (!conf || !key)
       return;
 
-   last  = conf->entries;
-   entry = config_get_entry_internal(conf, key, &last);
+   entry = config_get_entry(conf, key);
 
    if (!entry)
       return;
 
-   (void)RHMAP_DEL_STR(conf->entries_map, entry->key);
-
-   if (entry->key)
-      free(entry->key);
+   config_file_map_del(conf, entry);
 
-   if (entry->value)
+   if (entry->value_allocated)
       free(entry->value);
 
-   entry->key     = NULL;
-   entry->value   = NULL;
-   conf->modified = true;
+   entry->key             = NULL;
+   entry->value           = NULL;
+   entry->value_allocated = false;
+   conf->modified         = true;
 }
 
 void config_set_path(config_file_t *conf, const char *entry, const char *val)
@@ -1345,9 +1434,18 @@ bool config_file_write(config_file_t *conf, const char *path, bool sort)
       config_file_dump_orbis(conf,fd);
       orbisClose(fd);
 #else
-      void* buf  = NULL;
-      FILE *file = (FILE*)fopen_utf8(path, "wb");
-      if (!file)
+      char tmp_path[PATH_MAX_LENGTH];
+      void* buf    = NULL;
+      FILE *file   = NULL;
+      bool success = false;
+
+      /* Write to a temporary file first and move it
+       * into place, so that an interrupted write never
+       * leaves a truncated config behind */
+      strlcpy(tmp_path, path, sizeof(tmp_path));
+      strlcat(tmp_path, ".tmp", sizeof(tmp_path));
+
+      if (!(file = (FILE*)fopen_utf8(tmp_path, "wb")))
          return false;
 
       /* TODO: this is only useful for a few platforms, find which and add ifdef */
@@ -1358,10 +1456,32 @@ bool config_file_write(config_file_t *conf, const char *path, bool sort)
 
       config_file_dump(conf, file, sort);
 
-      if (file != stdout)
-         fclose(file);
+      success = (fflush(file) == 0) && !ferror(file);
+#if defined(__unix__) || defined(__APPLE__)
+      /* Make sure the data is on disk before the
+       * rename is */
+      if (success)
+         success = (fsync(fileno(file)) == 0);
+#endif
+      if (fclose(file) != 0)
+         success = false;
       if (buf)
          free(buf);
+
+      /* rename() replaces 'path' atomically where
+       * supported, otherwise it fails if 'path' exists */
+      if (      success
+            && (filestream_rename(tmp_path, path) != 0))
+      {
+         filestream_delete(path);
+         success = (filestream_rename(tmp_path, path) == 0);
+      }
+
+      if (!success)
+      {
+         filestream_delete(tmp_path);
+         return false;
+      }
 #endif
 
       /* Only update modified flag if config file
@@ -1401,7 +1521,9 @@ void config_file_dump_orbis(config_file_t *conf, int fd)
                "%s = %s\n", list->key, list->value);
          orbisWrite(fd, newlist, strlen(newlist));
       }
-      list = list->next;
+      /* Sorting reorders the list */
+      conf->tail = list;
+      list       = list->next;
    }
 
    /* Config files are read from the top down - if
@@ -1445,7 +1567,9 @@ void config_file_dump(config_file_t *conf, FILE *file, bool sort)
    {
       if (!list->readonly && list->key)
          fprintf(file, "%s = \"%s\"\n", list->key, list->value);
-      list = list->next;
+      /* Sorting reorders the list */
+      conf->tail = list;
+      list       = list->next;
    }
 
    /* Config files are read from the top down - if
@@ -1463,7 +1587,7 @@ void config_file_dump(config_file_t *conf, FILE *file, bool sort)
 
 bool config_entry_exists(config_file_t *conf, const char *entry)
 {
-   return (bool)RHMAP_HAS_STR(conf->entries_map, entry);
+   return config_get_entry(conf, entry) != NULL;
 }
 
 bool config_get_entry_list_head(config_file_t *conf,
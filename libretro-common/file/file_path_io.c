@@ -44,6 +44,10 @@
 #include <unistd.h> /* stat() is defined here */
 #endif
 
+#if defined(__linux__) || defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__) || defined(__HAIKU__)
+#define HAVE_PATH_MTIME
+#endif
+
 /* TODO/FIXME - globals */
 static retro_vfs_stat_t path_stat_cb   = retro_vfs_stat_impl;
 static retro_vfs_mkdir_t path_mkdir_cb = retro_vfs_mkdir_impl;
@@ -100,6 +104,25 @@ int32_t path_get_size(const char *path)
    return -1;
 }
 
+bool path_get_mtime(const char *path, int64_t *mtime)
+{
+#ifdef HAVE_PATH_MTIME
+   struct stat buf;
+
+   /* Nothing says what the frontend VFS is backed by */
+   if (path_stat_cb != retro_vfs_stat_impl)
+      return false;
+
+   if (!path || !*path || stat(path, &buf) != 0)
+      return false;
+
+   *mtime = (int64_t)buf.st_mtime;
+   return true;
+#else
+   return false;
+#endif
+}
+
 /**
  * path_mkdir:
  * @dir                : directory
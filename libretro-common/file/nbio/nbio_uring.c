@@ -0,0 +1,568 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (nbio_uring.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <file/nbio.h>
+
+#if defined(__linux__) && defined(HAVE_IO_URING)
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+#ifdef HAVE_THREADS
+#include <pthread.h>
+#endif
+
+/* All handles share one ring, so that the reads and
+ * writes begun in between two calls of nbio_iterate()
+ * get submitted with a single syscall. Like nbio_linux,
+ * this talks to the kernel directly rather than adding
+ * a dependency on liburing */
+#define NBIO_URING_ENTRIES 64
+
+/* Amount read or written per nbio_iterate() when the
+ * kernel has no io_uring (or it is disabled) */
+#define NBIO_URING_SYNC_CHUNK (256 * 1024)
+
+#if !defined(__NR_io_uring_setup) || !defined(__NR_io_uring_enter)
+#define NBIO_URING_NO_SYSCALLS
+#endif
+
+struct nbio_uring_t
+{
+   void *ptr;
+   struct iovec iov;
+   size_t len;
+   size_t progress;
+   int fd;
+   /* NBIO_READ, NBIO_WRITE, or -1 when idle */
+   signed char op;
+   signed char mode;
+   /* An SQE for this handle is in the ring */
+   bool queued;
+};
+
+typedef struct nbio_uring_ring
+{
+   unsigned *sq_head;
+   unsigned *sq_tail;
+   unsigned *sq_array;
+   unsigned *cq_head;
+   unsigned *cq_tail;
+   struct io_uring_sqe *sqes;
+   struct io_uring_cqe *cqes;
+   void *sq_map;
+   void *cq_map;
+   size_t sq_map_size;
+   size_t cq_map_size;
+   size_t sqes_size;
+   unsigned sq_mask;
+   unsigned cq_mask;
+   unsigned sq_entries;
+   unsigned cq_entries;
+   /* Queued since the last io_uring_enter() */
+   unsigned to_submit;
+   /* Queued, without a completion yet */
+   unsigned inflight;
+   int fd;
+} nbio_uring_ring_t;
+
+/* TODO/FIXME - static globals */
+static nbio_uring_ring_t nbio_uring_ring;
+/* 0: not set up yet, 1: ready, -1: unavailable */
+static int nbio_uring_state           = 0;
+#ifdef HAVE_THREADS
+/* Handles may be used from any thread, and this
+ * needs to be usable before anything sets it up */
+static pthread_mutex_t nbio_uring_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static void nbio_uring_lock_ring(void)
+{
+#ifdef HAVE_THREADS
+   pthread_mutex_lock(&nbio_uring_lock);
+#endif
+}
+
+static void nbio_uring_unlock_ring(void)
+{
+#ifdef HAVE_THREADS
+   pthread_mutex_unlock(&nbio_uring_lock);
+#endif
+}
+
+static bool nbio_uring_ring_init(nbio_uring_ring_t *ring)
+{
+#ifdef NBIO_URING_NO_SYSCALLS
+   return false;
+#else
+   struct io_uring_params p;
+   uint8_t *sq_ptr;
+   uint8_t *cq_ptr;
+
+   memset(&p, 0, sizeof(p));
+   memset(ring, 0, sizeof(*ring));
+
+   if ((ring->fd = (int)syscall(__NR_io_uring_setup,
+               NBIO_URING_ENTRIES, &p)) < 0)
+      return false;
+
+   ring->sq_map_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+   ring->cq_map_size = p.cq_off.cqes
+      + p.cq_entries * sizeof(struct io_uring_cqe);
+   ring->sqes_size   = p.sq_entries * sizeof(struct io_uring_sqe);
+
+   /* Both rings may live in the same mapping */
+   if (p.features & IORING_FEAT_SINGLE_MMAP)
+   {
+      if (ring->cq_map_size > ring->sq_map_size)
+         ring->sq_map_size = ring->cq_map_size;
+      ring->cq_map_size    = 0;
+   }
+
+   ring->sq_map = mmap(NULL, ring->sq_map_size, PROT_READ | PROT_WRITE,
+         MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+   if (ring->sq_map == MAP_FAILED)
+      goto error;
+
+   if (ring->cq_map_size)
+   {
+      ring->cq_map = mmap(NULL, ring->cq_map_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+      if (ring->cq_map == MAP_FAILED)
+         goto error;
+   }
+   else
+      ring->cq_map = ring->sq_map;
+
+   ring->sqes = (struct io_uring_sqe*)mmap(NULL, ring->sqes_size,
+         PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+         ring->fd, IORING_OFF_SQES);
+   if (ring->sqes == MAP_FAILED)
+      goto error;
+
+   sq_ptr           = (uint8_t*)ring->sq_map;
+   cq_ptr           = (uint8_t*)ring->cq_map;
+
+   ring->sq_head    = (unsigned*)(sq_ptr + p.sq_off.head);
+   ring->sq_tail    = (unsigned*)(sq_ptr + p.sq_off.tail);
+   ring->sq_array   = (unsigned*)(sq_ptr + p.sq_off.array);
+   ring->sq_mask    = *(unsigned*)(sq_ptr + p.sq_off.ring_mask);
+   ring->sq_entries = p.sq_entries;
+
+   ring->cq_head    = (unsigned*)(cq_ptr + p.cq_off.head);
+   ring->cq_tail    = (unsigned*)(cq_ptr + p.cq_off.tail);
+   ring->cqes       = (struct io_uring_cqe*)(cq_ptr + p.cq_off.cqes);
+   ring->cq_mask    = *(unsigned*)(cq_ptr + p.cq_off.ring_mask);
+   ring->cq_entries = p.cq_entries;
+
+   return true;
+
+error:
+   if (ring->sq_map && ring->sq_map != MAP_FAILED)
+      munmap(ring->sq_map, ring->sq_map_size);
+   if (ring->cq_map_size && ring->cq_map && ring->cq_map != MAP_FAILED)
+      munmap(ring->cq_map, ring->cq_map_size);
+   close(ring->fd);
+   ring->fd = -1;
+   return false;
+#endif
+}
+
+/* Submits everything queued, and waits for
+ * at least one completion if 'wait' is set */
+static void nbio_uring_enter(nbio_uring_ring_t *ring, bool wait)
+{
+#ifndef NBIO_URING_NO_SYSCALLS
+   for (;;)
+   {
+      int ret = (int)syscall(__NR_io_uring_enter, ring->fd,
+            ring->to_submit, wait ? 1 : 0,
+            wait ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+
+      if (ret >= 0)
+      {
+         ring->to_submit -= ((unsigned)ret < ring->to_submit)
+            ? (unsigned)ret : ring->to_submit;
+         if (!wait || ring->to_submit == 0)
+            return;
+      }
+      else if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+         return;
+   }
+#endif
+}
+
+static void nbio_uring_queue(nbio_uring_ring_t *ring,
+      struct nbio_uring_t *handle);
+
+static void nbio_uring_complete(nbio_uring_ring_t *ring,
+      struct nbio_uring_t *handle, int res)
+{
+   handle->queued = false;
+
+   if (res == -EINTR || res == -EAGAIN)
+      res = 0;
+   else if (res <= 0)
+   {
+      /* Error, or the file got shorter since it
+       * was opened - there is no way to report
+       * either, so just stop there */
+      handle->op = -1;
+      return;
+   }
+
+   handle->progress += (size_t)res;
+
+   if (handle->progress < handle->len)
+      nbio_uring_queue(ring, handle);
+   else
+      handle->op = -1;
+}
+
+/* Handles every completion that has arrived */
+static void nbio_uring_reap(nbio_uring_ring_t *ring)
+{
+   unsigned head = *ring->cq_head;
+
+   for (;;)
+   {
+      struct io_uring_cqe *cqe;
+      struct nbio_uring_t *handle;
+      int res;
+
+      if (head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE))
+         break;
+
+      cqe    = &ring->cqes[head & ring->cq_mask];
+      handle = (struct nbio_uring_t*)(uintptr_t)cqe->user_data;
+      res    = cqe->res;
+
+      /* Free the CQE before requeueing anything */
+      __atomic_store_n(ring->cq_head, ++head, __ATOMIC_RELEASE);
+      ring->inflight--;
+
+      nbio_uring_complete(ring, handle, res);
+      head = *ring->cq_head;
+   }
+}
+
+/* Queues the remainder of the current operation of 'handle'.
+ * It only gets submitted by the next io_uring_enter() */
+static void nbio_uring_queue(nbio_uring_ring_t *ring,
+      struct nbio_uring_t *handle)
+{
+   unsigned tail;
+   struct io_uring_sqe *sqe;
+
+   /* Every operation in flight must have room for
+    * its completion */
+   while (  (*ring->sq_tail - __atomic_load_n(ring->sq_head,
+               __ATOMIC_ACQUIRE)) >= ring->sq_entries
+         || ring->inflight >= ring->cq_entries)
+   {
+      nbio_uring_enter(ring, ring->inflight > 0);
+      nbio_uring_reap(ring);
+   }
+
+   tail                = *ring->sq_tail;
+   sqe                 = &ring->sqes[tail & ring->sq_mask];
+
+   handle->iov.iov_base = (uint8_t*)handle->ptr + handle->progress;
+   handle->iov.iov_len  = handle->len - handle->progress;
+
+   memset(sqe, 0, sizeof(*sqe));
+   sqe->opcode         = (handle->op == NBIO_READ)
+      ? IORING_OP_READV : IORING_OP_WRITEV;
+   sqe->fd             = handle->fd;
+   sqe->off            = handle->progress;
+   sqe->addr           = (uint64_t)(uintptr_t)&handle->iov;
+   sqe->len            = 1;
+   sqe->user_data      = (uint64_t)(uintptr_t)handle;
+
+   ring->sq_array[tail & ring->sq_mask] = tail & ring->sq_mask;
+   __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+   ring->to_submit++;
+   ring->inflight++;
+   handle->queued      = true;
+}
+
+/* Waits until the kernel is done with 'handle' */
+static void nbio_uring_wait(nbio_uring_ring_t *ring,
+      struct nbio_uring_t *handle)
+{
+   while (handle->queued)
+   {
+      nbio_uring_enter(ring, true);
+      nbio_uring_reap(ring);
+   }
+}
+
+/* Without a ring, the operation is done
+ * here, one chunk at a time */
+static void nbio_uring_iterate_sync(struct nbio_uring_t *handle)
+{
+   do
+   {
+      ssize_t ret;
+      size_t amount = handle->len - handle->progress;
+      uint8_t *ptr  = (uint8_t*)handle->ptr + handle->progress;
+
+      if (amount > NBIO_URING_SYNC_CHUNK)
+         amount = NBIO_URING_SYNC_CHUNK;
+
+      if (handle->op == NBIO_READ)
+         ret = pread(handle->fd, ptr, amount, (off_t)handle->progress);
+      else
+         ret = pwrite(handle->fd, ptr, amount, (off_t)handle->progress);
+
+      if (ret < 0 && errno == EINTR)
+         continue;
+
+      if (ret <= 0)
+      {
+         handle->op = -1;
+         break;
+      }
+
+      handle->progress += (size_t)ret;
+      if (handle->progress >= handle->len)
+         handle->op = -1;
+   } while (handle->op >= 0 && handle->mode >= BIO_READ);
+}
+
+static void *nbio_uring_open(const char * filename, unsigned mode)
+{
+   static const int o_flags[]  = { O_RDONLY, O_RDWR|O_CREAT|O_TRUNC, O_RDWR, O_RDONLY, O_RDWR|O_CREAT|O_TRUNC };
+   off_t len                   = 0;
+   struct nbio_uring_t *handle = NULL;
+   int fd                      = open(filename, o_flags[mode]|O_CLOEXEC, 0644);
+
+   if (fd < 0)
+      return NULL;
+
+   if (mode != NBIO_WRITE && mode != BIO_WRITE)
+   {
+      if ((len = lseek(fd, 0, SEEK_END)) < 0)
+         goto error;
+   }
+
+   if (!(handle = (struct nbio_uring_t*)calloc(1, sizeof(*handle))))
+      goto error;
+
+   if (len && !(handle->ptr = malloc((size_t)len)))
+      goto error;
+
+   handle->fd       = fd;
+   handle->len      = (size_t)len;
+   handle->progress = handle->len;
+   handle->op       = -1;
+   handle->mode     = mode;
+
+   nbio_uring_lock_ring();
+   if (nbio_uring_state == 0)
+      nbio_uring_state = nbio_uring_ring_init(&nbio_uring_ring) ? 1 : -1;
+   nbio_uring_unlock_ring();
+
+   return handle;
+
+error:
+   if (handle)
+      free(handle);
+   close(fd);
+   return NULL;
+}
+
+static void nbio_uring_begin_op(struct nbio_uring_t *handle, signed char op)
+{
+   if (handle->op >= 0)
+      abort();
+
+   handle->op       = op;
+   handle->progress = 0;
+
+   if (handle->len == 0)
+   {
+      handle->op    = -1;
+      return;
+   }
+
+   if (nbio_uring_state != 1)
+      return;
+
+   nbio_uring_lock_ring();
+   nbio_uring_queue(&nbio_uring_ring, handle);
+   nbio_uring_unlock_ring();
+}
+
+static void nbio_uring_begin_read(void *data)
+{
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+   if (handle)
+      nbio_uring_begin_op(handle, NBIO_READ);
+}
+
+static void nbio_uring_begin_write(void *data)
+{
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+   if (handle)
+      nbio_uring_begin_op(handle, NBIO_WRITE);
+}
+
+static bool nbio_uring_iterate(void *data)
+{
+   bool done;
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+
+   if (!handle)
+      return false;
+
+   if (nbio_uring_state != 1)
+   {
+      if (handle->op >= 0)
+         nbio_uring_iterate_sync(handle);
+      return handle->op < 0;
+   }
+
+   nbio_uring_lock_ring();
+
+   /* Submits what every handle queued since */
+   if (nbio_uring_ring.to_submit > 0)
+      nbio_uring_enter(&nbio_uring_ring, false);
+   nbio_uring_reap(&nbio_uring_ring);
+
+   if (handle->mode >= BIO_READ)
+      nbio_uring_wait(&nbio_uring_ring, handle);
+
+   done = handle->op < 0;
+
+   nbio_uring_unlock_ring();
+
+   return done;
+}
+
+static void nbio_uring_resize(void *data, size_t len)
+{
+   void *new_ptr               = NULL;
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return;
+
+   if (handle->op >= 0)
+      abort();
+   if (len < handle->len)
+      abort();
+
+   if (ftruncate(handle->fd, (off_t)len) != 0)
+      abort(); /* nbio_resize() has no way to report failure */
+
+   if (!(new_ptr = realloc(handle->ptr, len)))
+      return;
+
+   handle->ptr      = new_ptr;
+   handle->len      = len;
+   handle->progress = len;
+}
+
+static void *nbio_uring_get_ptr(void *data, size_t* len)
+{
+   bool idle;
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return NULL;
+
+   nbio_uring_lock_ring();
+   idle = handle->op < 0;
+   nbio_uring_unlock_ring();
+
+   if (len)
+      *len = handle->len;
+   if (idle)
+      return handle->ptr;
+   return NULL;
+}
+
+static void nbio_uring_cancel(void *data)
+{
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return;
+
+   nbio_uring_lock_ring();
+   /* The kernel may still be using the buffer */
+   if (nbio_uring_state == 1)
+      nbio_uring_wait(&nbio_uring_ring, handle);
+   handle->op       = -1;
+   handle->progress = handle->len;
+   nbio_uring_unlock_ring();
+}
+
+static void nbio_uring_free(void *data)
+{
+   struct nbio_uring_t *handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return;
+
+   nbio_uring_cancel(handle);
+
+   close(handle->fd);
+   free(handle->ptr);
+   free(handle);
+}
+
+nbio_intf_t nbio_uring = {
+   nbio_uring_open,
+   nbio_uring_begin_read,
+   nbio_uring_begin_write,
+   nbio_uring_iterate,
+   nbio_uring_resize,
+   nbio_uring_get_ptr,
+   nbio_uring_cancel,
+   nbio_uring_free,
+   "nbio_uring",
+};
+#else
+nbio_intf_t nbio_uring = {
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   "nbio_uring",
+};
+
+#endif
@@ -31,6 +31,12 @@
 #define VFS_FRONTEND
 #include <vfs/vfs_implementation.h>
 
+#if defined(__linux__) || defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__) || defined(__HAIKU__)
+#define HAVE_DIRENT_MTIME
+#include <sys/types.h>
+#include <sys/stat.h>
+#endif
+
 /* TODO/FIXME - static globals */
 static retro_vfs_opendir_t dirent_opendir_cb                 = NULL;
 static retro_vfs_readdir_t dirent_readdir_cb                 = NULL;
@@ -120,3 +126,30 @@ void retro_closedir(struct RDIR *rdir)
    else
       retro_vfs_closedir_impl((struct retro_vfs_dir_handle *)rdir);
 }
+
+bool retro_dirent_get_mtime(const char *name, int64_t *mtime)
+{
+#ifdef HAVE_DIRENT_MTIME
+   struct stat buf;
+
+   /* Nothing says what the frontend VFS is backed by */
+   if (dirent_opendir_cb)
+      return false;
+
+   if (!name || !*name || stat(name, &buf) != 0 || !S_ISDIR(buf.st_mode))
+      return false;
+
+   /* Whole seconds would miss changes made in the same
+    * second the directory was last looked at */
+#if defined(__APPLE__)
+   *mtime = (int64_t)buf.st_mtimespec.tv_sec * 1000000000
+          + buf.st_mtimespec.tv_nsec;
+#else
+   *mtime = (int64_t)buf.st_mtim.tv_sec * 1000000000
+          + buf.st_mtim.tv_nsec;
+#endif
+   return true;
+#else
+   return false;
+#endif
+}
@@ -33,6 +33,14 @@
 #include <streams/interface_stream.h>
 #include <streams/file_stream.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define _rJSON_SCAN_SSE2
+#elif defined(__aarch64__) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define _rJSON_SCAN_NEON
+#endif
+
 struct _rjson_stack { enum rjson_type type; size_t count; };
 
 struct rjson
@@ -363,6 +371,63 @@ static bool _rjson_validate_utf8(rjson_t *json)
    }
 }
 
+#if defined(_rJSON_SCAN_SSE2) || defined(_rJSON_SCAN_NEON)
+/* Skips 16 bytes at a time over the part of a string that
+ * needs no special handling, stopping at the block holding
+ * the first quote, backslash or control character (or when
+ * less than a block is left) for the byte loop to take over.
+ * Sets the high bit of utf8mask if a skipped byte had it. */
+static INLINE const unsigned char *_rjson_scan_string(
+      const unsigned char *p, const unsigned char *end,
+      unsigned char *utf8mask)
+{
+#if defined(_rJSON_SCAN_SSE2)
+   const __m128i quote  = _mm_set1_epi8('"');
+   const __m128i bslash = _mm_set1_epi8('\\');
+   const __m128i ctrl   = _mm_set1_epi8(0x1F);
+   __m128i high         = _mm_setzero_si128();
+   while (end - p >= 16)
+   {
+      __m128i v = _mm_loadu_si128((const __m128i*)p);
+      __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, quote),
+                         _mm_cmpeq_epi8(v, bslash)),
+            /* unsigned v <= 0x1F */
+            _mm_cmpeq_epi8(_mm_min_epu8(v, ctrl), v));
+      if (_mm_movemask_epi8(special))
+         break;
+      high = _mm_or_si128(high, v);
+      p   += 16;
+   }
+   if (_mm_movemask_epi8(high))
+      *utf8mask |= 0x80;
+#else
+   const uint8x16_t quote  = vdupq_n_u8('"');
+   const uint8x16_t bslash = vdupq_n_u8('\\');
+   const uint8x16_t space  = vdupq_n_u8(0x20);
+   uint8x16_t high         = vdupq_n_u8(0);
+   while (end - p >= 16)
+   {
+      uint8x16_t v = vld1q_u8(p);
+      uint8x16_t special = vorrq_u8(
+            vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, bslash)),
+            vcltq_u8(v, space));
+      if (vmaxvq_u8(special))
+         break;
+      high = vorrq_u8(high, v);
+      p   += 16;
+   }
+   if (vmaxvq_u8(high) & 0x80)
+      *utf8mask |= 0x80;
+#endif
+   return p;
+}
+#define _rJSON_SCAN_STRING(p, end, utf8mask) \
+   (p) = _rjson_scan_string((p), (end), &(utf8mask))
+#else
+#define _rJSON_SCAN_STRING(p, end, utf8mask)
+#endif
+
 static enum rjson_type _rjson_read_string(rjson_t *json)
 {
    const unsigned char *p   = json->input_p, *raw = p;
@@ -370,6 +435,7 @@ static enum rjson_type _rjson_read_string(rjson_t *json)
    unsigned char utf8mask = 0;
    json->string_pass_through = NULL;
    json->string_len = 0;
+   _rJSON_SCAN_STRING(p, end, utf8mask);
    for (;;)
    {
       if (_rJSON_LIKELY(p != end))
@@ -445,6 +511,7 @@ static enum rjson_type _rjson_read_string(rjson_t *json)
             }
             raw = p = json->input_p;
             end     = json->input_end;
+            _rJSON_SCAN_STRING(p, end, utf8mask);
          }
          else if (!(json->option_flags & RJSON_OPTION_ALLOW_UNESCAPED_CONTROL_CHARACTERS))
             return _rjson_error_char(json, "unescaped control character %s in string", c);
@@ -462,6 +529,7 @@ static enum rjson_type _rjson_read_string(rjson_t *json)
             return _rjson_error(json, "unterminated string literal");
          raw = p = json->input_p;
          end     = json->input_end;
+         _rJSON_SCAN_STRING(p, end, utf8mask);
       }
    }
 }
@@ -27,6 +27,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #ifdef GEKKO
 #include <malloc.h>
 #endif
@@ -76,12 +80,6 @@ struct adam7_pass
    unsigned stride_y;
 };
 
-struct idat_buffer
-{
-   uint8_t *data;
-   size_t size;
-};
-
 struct rpng_process
 {
    uint32_t *data;
@@ -95,7 +93,6 @@ struct rpng_process
    size_t adam7_restore_buf_size;
    size_t data_restore_buf_size;
    size_t inflate_buf_size;
-   size_t avail_in;
    size_t avail_out;
    size_t total_out;
    size_t pass_size;
@@ -116,7 +113,6 @@ struct rpng
    struct rpng_process *process;
    uint8_t *buff_data;
    uint8_t *buff_end;
-   struct idat_buffer idat_buf; /* ptr alignment */
    struct png_ihdr ihdr; /* uint32 alignment */
    uint32_t palette[256];
    bool has_ihdr;
@@ -555,11 +551,160 @@ error:
    return -1;
 }
 
+#if defined(__SSE2__)
+/* SSE2 reverse filters for 8-bit RGB and RGBA scanlines,
+ * one pixel per iteration for the filters depending on the
+ * pixel to the left, 16 bytes at a time for Up. */
+static INLINE __m128i png_load_pixel(const uint8_t *p, unsigned bpp)
+{
+   uint32_t v = 0;
+   memcpy(&v, p, bpp);
+   return _mm_cvtsi32_si128((int)v);
+}
+
+static INLINE void png_store_pixel(uint8_t *p, __m128i x, unsigned bpp)
+{
+   uint32_t v = (uint32_t)_mm_cvtsi128_si32(x);
+   memcpy(p, &v, bpp);
+}
+
+static void png_unfilter_up_sse2(uint8_t *dst, const uint8_t *src,
+      const uint8_t *prev, unsigned pitch)
+{
+   unsigned i = 0;
+
+   for (; i + 16 <= pitch; i += 16)
+   {
+      __m128i x = _mm_loadu_si128((const __m128i*)(src  + i));
+      __m128i b = _mm_loadu_si128((const __m128i*)(prev + i));
+      _mm_storeu_si128((__m128i*)(dst + i), _mm_add_epi8(x, b));
+   }
+
+   for (; i < pitch; i++)
+      dst[i] = prev[i] + src[i];
+}
+
+static void png_unfilter_sub_sse2(uint8_t *dst, const uint8_t *src,
+      unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   __m128i a = _mm_setzero_si128();
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      a = _mm_add_epi8(a, png_load_pixel(src + i, bpp));
+      png_store_pixel(dst + i, a, bpp);
+   }
+}
+
+static void png_unfilter_avg_sse2(uint8_t *dst, const uint8_t *src,
+      const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   const __m128i one = _mm_set1_epi8(1);
+   __m128i a         = _mm_setzero_si128();
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      __m128i b   = png_load_pixel(prev + i, bpp);
+      /* pavgb rounds up, (a + b) >> 1 rounds down */
+      __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b),
+            _mm_and_si128(_mm_xor_si128(a, b), one));
+      a           = _mm_add_epi8(avg, png_load_pixel(src + i, bpp));
+      png_store_pixel(dst + i, a, bpp);
+   }
+}
+
+static INLINE __m128i png_abs_epi16(__m128i x)
+{
+   return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+
+static INLINE __m128i png_select_epi16(__m128i mask, __m128i t, __m128i f)
+{
+   return _mm_or_si128(_mm_and_si128(mask, t), _mm_andnot_si128(mask, f));
+}
+
+static void png_unfilter_paeth_sse2(uint8_t *dst, const uint8_t *src,
+      const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   const __m128i zero = _mm_setzero_si128();
+   __m128i a          = zero;
+   __m128i c          = zero;
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      __m128i smallest, nearest, pa, pb, pc;
+      __m128i b = _mm_unpacklo_epi8(png_load_pixel(prev + i, bpp), zero);
+
+      /* Same as paeth(), ties favour a, then b */
+      pa        = _mm_sub_epi16(b, c);
+      pb        = _mm_sub_epi16(a, c);
+      pc        = png_abs_epi16(_mm_add_epi16(pa, pb));
+      pa        = png_abs_epi16(pa);
+      pb        = png_abs_epi16(pb);
+
+      smallest  = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+      nearest   = png_select_epi16(_mm_cmpeq_epi16(smallest, pa), a,
+            png_select_epi16(_mm_cmpeq_epi16(smallest, pb), b, c));
+
+      nearest   = _mm_add_epi8(png_load_pixel(src + i, bpp),
+            _mm_packus_epi16(nearest, nearest));
+      png_store_pixel(dst + i, nearest, bpp);
+
+      a         = _mm_unpacklo_epi8(nearest, zero);
+      c         = b;
+   }
+}
+
+/* Returns false if the filter has no SSE2 path for this
+ * line format, and must be reversed the regular way. */
+static bool png_reverse_filter_line_sse2(struct rpng_process *pngp,
+      unsigned filter)
+{
+   if (filter == PNG_FILTER_UP)
+   {
+      png_unfilter_up_sse2(pngp->decoded_scanline,
+            pngp->inflate_buf, pngp->prev_scanline, pngp->pitch);
+      return true;
+   }
+
+   if (pngp->bpp != 3 && pngp->bpp != 4)
+      return false;
+
+   switch (filter)
+   {
+      case PNG_FILTER_SUB:
+         png_unfilter_sub_sse2(pngp->decoded_scanline,
+               pngp->inflate_buf, pngp->pitch, pngp->bpp);
+         return true;
+      case PNG_FILTER_AVERAGE:
+         png_unfilter_avg_sse2(pngp->decoded_scanline,
+               pngp->inflate_buf, pngp->prev_scanline,
+               pngp->pitch, pngp->bpp);
+         return true;
+      case PNG_FILTER_PAETH:
+         png_unfilter_paeth_sse2(pngp->decoded_scanline,
+               pngp->inflate_buf, pngp->prev_scanline,
+               pngp->pitch, pngp->bpp);
+         return true;
+      default:
+         break;
+   }
+
+   return false;
+}
+#endif
+
 static int png_reverse_filter_copy_line(uint32_t *data, const struct png_ihdr *ihdr,
       struct rpng_process *pngp, unsigned filter)
 {
    unsigned i;
 
+#if defined(__SSE2__)
+   if (!png_reverse_filter_line_sse2(pngp, filter))
+#endif
    switch (filter)
    {
       case PNG_FILTER_NONE:
@@ -752,29 +897,9 @@ static int png_reverse_filter_iterate(rpng_t *rpng, uint32_t **data)
 
 static int rpng_load_image_argb_process_inflate_init(rpng_t *rpng, uint32_t **data)
 {
-   bool zstatus;
-   enum trans_stream_error terror;
-   uint32_t rd, wn;
    struct rpng_process *process = (struct rpng_process*)rpng->process;
-   bool to_continue        = (process->avail_in > 0
-         && process->avail_out > 0);
-
-   if (!to_continue)
-      goto end;
-
-   zstatus = process->stream_backend->trans(process->stream, false, &rd, &wn, &terror);
-
-   if (!zstatus && terror != TRANS_STREAM_ERROR_BUFFER_FULL)
-      goto error;
-
-   process->avail_in -= rd;
-   process->avail_out -= wn;
-   process->total_out += wn;
-
-   if (terror)
-      return 0;
 
-end:
+   /* All IDAT chunks were inflated by rpng_iterate_image */
    process->stream_backend->stream_free(process->stream);
    process->stream = NULL;
 
@@ -800,7 +925,6 @@ end:
    process->inflate_initialized = true;
    return 1;
 
-error:
 false_end:
    process->inflate_initialized = false;
    return -1;
@@ -832,17 +956,6 @@ static bool png_read_trns(uint8_t *buf, uint32_t *palette, unsigned entries)
    return true;
 }
 
-bool png_realloc_idat(struct idat_buffer *buf, uint32_t chunk_size)
-{
-   uint8_t *new_buffer = (uint8_t*)realloc(buf->data, buf->size + chunk_size);
-
-   if (!new_buffer)
-      return false;
-
-   buf->data  = new_buffer;
-   return true;
-}
-
 static struct rpng_process *rpng_process_init(rpng_t *rpng)
 {
    uint8_t *inflate_buf            = NULL;
@@ -870,7 +983,6 @@ static struct rpng_process *rpng_process_init(rpng_t *rpng)
    process->adam7_restore_buf_size = 0;
    process->data_restore_buf_size  = 0;
    process->inflate_buf_size       = 0;
-   process->avail_in               = 0;
    process->avail_out              = 0;
    process->total_out              = 0;
    process->pass_size              = 0;
@@ -903,13 +1015,8 @@ static struct rpng_process *rpng_process_init(rpng_t *rpng)
       goto error;
 
    process->inflate_buf = inflate_buf;
-   process->avail_in    = rpng->idat_buf.size;
    process->avail_out   = process->inflate_buf_size;
 
-   process->stream_backend->set_in(
-         process->stream,
-         rpng->idat_buf.data,
-         (uint32_t)rpng->idat_buf.size);
    process->stream_backend->set_out(
          process->stream,
          process->inflate_buf,
@@ -927,6 +1034,42 @@ error:
    return NULL;
 }
 
+/* IDAT chunks are inflated straight from the file buffer
+ * as they are parsed, rather than being gathered into one
+ * buffer first. */
+static bool png_inflate_idat(rpng_t *rpng,
+      const uint8_t *buf, uint32_t chunk_size)
+{
+   uint32_t rd, wn;
+   enum trans_stream_error terror = TRANS_STREAM_ERROR_NONE;
+   struct rpng_process *process   = rpng->process;
+
+   if (!process)
+   {
+      if (!(process = rpng_process_init(rpng)))
+         return false;
+      rpng->process = process;
+   }
+
+   /* Anything past a full output buffer is ignored */
+   if (chunk_size == 0 || process->avail_out == 0)
+      return true;
+
+   process->stream_backend->set_in(process->stream, buf, chunk_size);
+
+   if (!process->stream_backend->trans(process->stream,
+            false, &rd, &wn, &terror))
+   {
+      if (terror != TRANS_STREAM_ERROR_BUFFER_FULL)
+         return false;
+   }
+
+   process->avail_out -= wn;
+   process->total_out += wn;
+
+   return true;
+}
+
 static enum png_chunk_type read_chunk_header(
       uint8_t *buf, uint32_t chunk_size)
 {
@@ -989,7 +1132,6 @@ static enum png_chunk_type read_chunk_header(
 
 bool rpng_iterate_image(rpng_t *rpng)
 {
-   unsigned i;
    uint8_t *buf             = (uint8_t*)rpng->buff_data;
    uint32_t chunk_size      = 0;
 
@@ -1104,16 +1246,9 @@ bool rpng_iterate_image(rpng_t *rpng)
          if (!(rpng->has_ihdr) || rpng->has_iend || (rpng->ihdr.color_type == PNG_IHDR_COLOR_PLT && !(rpng->has_plte)))
             return false;
 
-         if (!png_realloc_idat(&rpng->idat_buf, chunk_size))
+         if (!png_inflate_idat(rpng, buf + 8, chunk_size))
             return false;
 
-         buf += 8;
-
-         for (i = 0; i < chunk_size; i++)
-            rpng->idat_buf.data[i + rpng->idat_buf.size] = buf[i];
-
-         rpng->idat_buf.size += chunk_size;
-
          rpng->has_idat = true;
          break;
 
@@ -1140,16 +1275,9 @@ int rpng_process_image(rpng_t *rpng,
 
    (void)size;
 
+   /* Created by the first IDAT chunk */
    if (!rpng->process)
-   {
-      struct rpng_process *process = rpng_process_init(rpng);
-
-      if (!process)
-         goto error;
-
-      rpng->process = process;
-      return IMAGE_PROCESS_NEXT;
-   }
+      goto error;
 
    if (!rpng->process->inflate_initialized)
    {
@@ -1181,8 +1309,6 @@ void rpng_free(rpng_t *rpng)
    if (!rpng)
       return;
 
-   if (rpng->idat_buf.data)
-      free(rpng->idat_buf.data);
    if (rpng->process)
    {
       if (rpng->process->inflate_buf)
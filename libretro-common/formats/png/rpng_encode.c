@@ -23,9 +23,19 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include <libretro.h>
 #include <encodings/crc32.h>
+#include <features/features_cpu.h>
+#ifdef HAVE_THREADS
+#include <rthreads/tpool.h>
+#endif
+#include <zlib.h>
 #include <streams/interface_stream.h>
 #include <streams/trans_stream.h>
 
@@ -140,11 +150,28 @@ static void copy_bgr24_line(uint8_t *dst, const uint8_t *src, unsigned width)
    }
 }
 
+/* Sum of absolute values of the bytes taken as signed.
+ * Biasing by 0x80 turns |(int8_t)x| into |x' - 0x80| on unsigned
+ * bytes, which PSADBW computes 16 at a time. */
 static unsigned count_sad(const uint8_t *data, size_t size)
 {
-   size_t i;
+   size_t i     = 0;
    unsigned cnt = 0;
-   for (i = 0; i < size; i++)
+#if defined(__SSE2__)
+   const __m128i bias = _mm_set1_epi8((char)0x80);
+   __m128i sum        = _mm_setzero_si128();
+
+   for (; i + 16 <= size; i += 16)
+   {
+      __m128i v = _mm_loadu_si128((const __m128i*)(data + i));
+      sum       = _mm_add_epi64(sum,
+            _mm_sad_epu8(_mm_xor_si128(v, bias), bias));
+   }
+
+   cnt = (unsigned)_mm_cvtsi128_si32(sum)
+      + (unsigned)_mm_cvtsi128_si32(_mm_srli_si128(sum, 8));
+#endif
+   for (; i < size; i++)
    {
       if (data[i])
          cnt += abs((int8_t)data[i]);
@@ -203,67 +230,123 @@ static unsigned filter_paeth(uint8_t *target,
    return count_sad(target, width);
 }
 
-bool rpng_save_image_stream(const uint8_t *data, intfstream_t* intf_s,
-      unsigned width, unsigned height, signed pitch, unsigned bpp)
+/* Filtered rows are split into chunks which are filtered and
+ * deflated independently, pigz-style. Every chunk but the last
+ * ends with a sync flush, so the raw deflate outputs concatenate
+ * into a single zlib stream, written as one IDAT per chunk. */
+#define RPNG_ENCODE_MIN_CHUNK (1 << 18)
+#define RPNG_ENCODE_MAX_CHUNKS 16
+
+struct rpng_encode_chunk
+{
+   const uint8_t *data;
+   uint8_t *encode;
+   uint8_t *out;
+   size_t encode_size;
+   size_t out_size;
+   uint32_t out_len;
+   uint32_t adler;
+   signed pitch;
+   unsigned width;
+   unsigned first_row;
+   unsigned rows;
+   unsigned bpp;
+   int level;
+   bool last;
+   bool ok;
+};
+
+#define ADLER_BASE 65521U
+/* Largest n such that 255n(n+1)/2 + (n+1)(BASE-1) fits in 32 bits */
+#define ADLER_NMAX 5552
+
+static uint32_t png_adler32(uint32_t adler, const uint8_t *buf, size_t len)
+{
+   uint32_t s1 = adler & 0xffff;
+   uint32_t s2 = adler >> 16;
+
+   while (len)
+   {
+      size_t n = len < ADLER_NMAX ? len : ADLER_NMAX;
+      len     -= n;
+      while (n--)
+      {
+         s1 += *buf++;
+         s2 += s1;
+      }
+      s1 %= ADLER_BASE;
+      s2 %= ADLER_BASE;
+   }
+
+   return (s2 << 16) | s1;
+}
+
+/* Adler-32 of two concatenated buffers, given the checksum of
+ * each and the length of the second. Same as zlib's adler32_combine. */
+static uint32_t png_adler32_combine(uint32_t adler1, uint32_t adler2,
+      size_t len2)
+{
+   uint32_t rem  = (uint32_t)(len2 % ADLER_BASE);
+   uint32_t sum1 = adler1 & 0xffff;
+   uint32_t sum2 = (uint32_t)(((uint64_t)rem * sum1) % ADLER_BASE);
+
+   sum1 += (adler2 & 0xffff) + ADLER_BASE - 1;
+   sum2 += ((adler1 >> 16) & 0xffff) + ((adler2 >> 16) & 0xffff)
+      + ADLER_BASE - rem;
+   if (sum1 >= ADLER_BASE)
+      sum1 -= ADLER_BASE;
+   if (sum1 >= ADLER_BASE)
+      sum1 -= ADLER_BASE;
+   if (sum2 >= (ADLER_BASE << 1))
+      sum2 -= (ADLER_BASE << 1);
+   if (sum2 >= ADLER_BASE)
+      sum2 -= ADLER_BASE;
+   return sum1 | (sum2 << 16);
+}
+
+static void copy_line(uint8_t *dst, const uint8_t *src,
+      unsigned width, unsigned bpp)
+{
+   if (bpp == sizeof(uint32_t))
+      copy_argb_line(dst, (const uint32_t*)src, width);
+   else
+      copy_bgr24_line(dst, src, width);
+}
+
+static void rpng_encode_chunk(void *data)
 {
    unsigned h;
-   struct png_ihdr ihdr = {0};
-   bool ret = true;
-   const struct trans_stream_backend *stream_backend = NULL;
-   size_t encode_buf_size  = 0;
-   uint8_t *encode_buf     = NULL;
-   uint8_t *deflate_buf    = NULL;
-   uint8_t *rgba_line      = NULL;
-   uint8_t *up_filtered    = NULL;
-   uint8_t *sub_filtered   = NULL;
-   uint8_t *avg_filtered   = NULL;
-   uint8_t *paeth_filtered = NULL;
-   uint8_t *prev_encoded   = NULL;
-   uint8_t *encode_target  = NULL;
+   struct rpng_encode_chunk *chunk = (struct rpng_encode_chunk*)data;
+   const struct trans_stream_backend *stream_backend =
+      trans_stream_get_zlib_deflate_backend();
+   unsigned line_size      = chunk->width * chunk->bpp;
+   const uint8_t *src      = chunk->data;
+   uint8_t *encode_target  = chunk->encode;
+   uint8_t *rgba_line      = (uint8_t*)malloc(line_size);
+   uint8_t *up_filtered    = (uint8_t*)malloc(line_size);
+   uint8_t *sub_filtered   = (uint8_t*)malloc(line_size);
+   uint8_t *avg_filtered   = (uint8_t*)malloc(line_size);
+   uint8_t *paeth_filtered = (uint8_t*)malloc(line_size);
+   uint8_t *prev_encoded   = (uint8_t*)calloc(1, line_size);
    void *stream            = NULL;
    uint32_t total_in       = 0;
    uint32_t total_out      = 0;
-   
-   if (!intf_s)
-      GOTO_END_ERROR();
-
-   stream_backend = trans_stream_get_zlib_deflate_backend();
-
-   if (intfstream_write(intf_s, png_magic, sizeof(png_magic)) != sizeof(png_magic))
-      GOTO_END_ERROR();
 
-   ihdr.width = width;
-   ihdr.height = height;
-   ihdr.depth = 8;
-   ihdr.color_type = bpp == sizeof(uint32_t) ? 6 : 2; /* RGBA or RGB */
-   if (!png_write_ihdr_string(intf_s, &ihdr))
-      GOTO_END_ERROR();
+   chunk->ok = false;
 
-   encode_buf_size = (width * bpp + 1) * height;
-   encode_buf      = (uint8_t*)malloc(encode_buf_size);
-   if (!encode_buf)
-      GOTO_END_ERROR();
+   if (!rgba_line || !up_filtered || !sub_filtered
+         || !avg_filtered || !paeth_filtered || !prev_encoded)
+      goto end;
 
-   prev_encoded = (uint8_t*)calloc(1, width * bpp);
-   if (!prev_encoded)
-      GOTO_END_ERROR();
+   /* Filters look at the unfiltered line above,
+    * which for a later chunk belongs to the previous one. */
+   if (chunk->first_row)
+      copy_line(prev_encoded, src - chunk->pitch, chunk->width, chunk->bpp);
 
-   rgba_line      = (uint8_t*)malloc(width * bpp);
-   up_filtered    = (uint8_t*)malloc(width * bpp);
-   sub_filtered   = (uint8_t*)malloc(width * bpp);
-   avg_filtered   = (uint8_t*)malloc(width * bpp);
-   paeth_filtered = (uint8_t*)malloc(width * bpp);
-   if (!rgba_line || !up_filtered || !sub_filtered || !avg_filtered || !paeth_filtered)
-      GOTO_END_ERROR();
-
-   encode_target = encode_buf;
-   for (h = 0; h < height;
-         h++, encode_target += width * bpp, data += pitch)
+   for (h = 0; h < chunk->rows;
+         h++, encode_target += line_size, src += chunk->pitch)
    {
-      if (bpp == sizeof(uint32_t))
-         copy_argb_line(rgba_line, (const uint32_t*)data, width);
-      else
-         copy_bgr24_line(rgba_line, data, width);
+      copy_line(rgba_line, src, chunk->width, chunk->bpp);
 
       /* Try every filtering method, and choose the method
        * which has most entries as zero.
@@ -272,11 +355,11 @@ bool rpng_save_image_stream(const uint8_t *data, intfstream_t* intf_s,
        * simple to implement.
        */
       {
-         unsigned none_score  = count_sad(rgba_line, width * bpp);
-         unsigned up_score    = filter_up(up_filtered, rgba_line, prev_encoded, width, bpp);
-         unsigned sub_score   = filter_sub(sub_filtered, rgba_line, width, bpp);
-         unsigned avg_score   = filter_avg(avg_filtered, rgba_line, prev_encoded, width, bpp);
-         unsigned paeth_score = filter_paeth(paeth_filtered, rgba_line, prev_encoded, width, bpp);
+         unsigned none_score  = count_sad(rgba_line, line_size);
+         unsigned up_score    = filter_up(up_filtered, rgba_line, prev_encoded, chunk->width, chunk->bpp);
+         unsigned sub_score   = filter_sub(sub_filtered, rgba_line, chunk->width, chunk->bpp);
+         unsigned avg_score   = filter_avg(avg_filtered, rgba_line, prev_encoded, chunk->width, chunk->bpp);
+         unsigned paeth_score = filter_paeth(paeth_filtered, rgba_line, prev_encoded, chunk->width, chunk->bpp);
 
          uint8_t filter       = 0;
          unsigned min_sad     = none_score;
@@ -310,58 +393,209 @@ bool rpng_save_image_stream(const uint8_t *data, intfstream_t* intf_s,
          }
 
          *encode_target++ = filter;
-         memcpy(encode_target, chosen_filtered, width * bpp);
+         memcpy(encode_target, chosen_filtered, line_size);
 
-         memcpy(prev_encoded, rgba_line, width * bpp);
+         memcpy(prev_encoded, rgba_line, line_size);
       }
    }
 
-   deflate_buf = (uint8_t*)malloc(encode_buf_size * 2); /* Just to be sure. */
-   if (!deflate_buf)
-      GOTO_END_ERROR();
+   chunk->adler = png_adler32(1, chunk->encode, chunk->encode_size);
 
-   stream = stream_backend->stream_new();
+   if (!(stream = stream_backend->stream_new()))
+      goto end;
 
-   if (!stream)
-      GOTO_END_ERROR();
+   stream_backend->define(stream, "level", (uint32_t)chunk->level);
+   stream_backend->define(stream, "window_bits", (uint32_t)-MAX_WBITS);
+   stream_backend->define(stream, "sync_flush", !chunk->last);
 
    stream_backend->set_in(
          stream,
-         encode_buf,
-         (unsigned)encode_buf_size);
+         chunk->encode,
+         (uint32_t)chunk->encode_size);
    stream_backend->set_out(
          stream,
-         deflate_buf + 8,
-         (unsigned)(encode_buf_size * 2));
+         chunk->out,
+         (uint32_t)chunk->out_size);
 
-   if (!stream_backend->trans(stream, true, &total_in, &total_out, NULL))
-      GOTO_END_ERROR();
+   if (!stream_backend->trans(stream, true, &total_in, &total_out, NULL)
+         || total_in != chunk->encode_size)
+      goto end;
 
-   memcpy(deflate_buf + 4, "IDAT", 4);
-   dword_write_be(deflate_buf + 0,        ((uint32_t)total_out));
-   if (!png_write_idat_string(intf_s, deflate_buf, ((size_t)total_out + 8)))
-      GOTO_END_ERROR();
+   chunk->out_len = total_out;
+   chunk->ok      = true;
 
-   if (!png_write_iend_string(intf_s))
-      GOTO_END_ERROR();
 end:
-   free(encode_buf);
-   free(deflate_buf);
+   if (stream)
+      stream_backend->stream_free(stream);
    free(rgba_line);
    free(prev_encoded);
    free(up_filtered);
    free(sub_filtered);
    free(avg_filtered);
    free(paeth_filtered);
+}
 
-   if (stream_backend)
+#ifdef HAVE_THREADS
+static void rpng_encode_chunk_job(void *data, unsigned index)
+{
+   rpng_encode_chunk(&((struct rpng_encode_chunk*)data)[index]);
+}
+#endif
+
+static unsigned rpng_encode_num_chunks(size_t encode_buf_size,
+      unsigned height)
+{
+#ifdef HAVE_THREADS
+   unsigned chunks = cpu_features_get_core_amount();
+
+   if (chunks > RPNG_ENCODE_MAX_CHUNKS)
+      chunks = RPNG_ENCODE_MAX_CHUNKS;
+   if (chunks > encode_buf_size / RPNG_ENCODE_MIN_CHUNK)
+      chunks = (unsigned)(encode_buf_size / RPNG_ENCODE_MIN_CHUNK);
+   if (chunks > height)
+      chunks = height;
+   if (chunks >= 1)
+      return chunks;
+#endif
+   return 1;
+}
+
+/* zlib header (RFC 1950) with FLEVEL matching the deflate level */
+static uint8_t png_zlib_header_flags(int level)
+{
+   if (level < 2)
+      return 0x01;
+   if (level < 6)
+      return 0x5e;
+   if (level == 6)
+      return 0x9c;
+   return 0xda;
+}
+
+bool rpng_save_image_stream(const uint8_t *data, intfstream_t* intf_s,
+      unsigned width, unsigned height, signed pitch, unsigned bpp,
+      int level)
+{
+   unsigned i;
+   struct png_ihdr ihdr = {0};
+   bool ret = true;
+   struct rpng_encode_chunk chunks[RPNG_ENCODE_MAX_CHUNKS];
+   unsigned num_chunks     = 0;
+   unsigned row_size       = width * bpp + 1;
+   size_t encode_buf_size  = 0;
+   size_t deflate_buf_size = 0;
+   uint8_t *encode_buf     = NULL;
+   uint8_t *deflate_buf    = NULL;
+   uint32_t adler          = 1;
+
+   if (!intf_s)
+      GOTO_END_ERROR();
+
+   if (intfstream_write(intf_s, png_magic, sizeof(png_magic)) != sizeof(png_magic))
+      GOTO_END_ERROR();
+
+   ihdr.width = width;
+   ihdr.height = height;
+   ihdr.depth = 8;
+   ihdr.color_type = bpp == sizeof(uint32_t) ? 6 : 2; /* RGBA or RGB */
+   if (!png_write_ihdr_string(intf_s, &ihdr))
+      GOTO_END_ERROR();
+
+   encode_buf_size = (size_t)row_size * height;
+   encode_buf      = (uint8_t*)malloc(encode_buf_size);
+   if (!encode_buf)
+      GOTO_END_ERROR();
+
+   num_chunks      = rpng_encode_num_chunks(encode_buf_size, height);
+
+   /* Each chunk gets twice its input (just to be sure), plus room
+    * for the IDAT header, the zlib header and the Adler-32 trailer. */
+   deflate_buf_size = encode_buf_size * 2 + num_chunks * (8 + 2 + 4);
+   deflate_buf      = (uint8_t*)malloc(deflate_buf_size);
+   if (!deflate_buf)
+      GOTO_END_ERROR();
+
+   {
+      uint8_t *out = deflate_buf;
+
+      for (i = 0; i < num_chunks; i++)
+      {
+         struct rpng_encode_chunk *chunk = &chunks[i];
+         unsigned first_row = (unsigned)(((uint64_t)height * i) / num_chunks);
+         unsigned last_row  = (unsigned)(((uint64_t)height * (i + 1)) / num_chunks);
+
+         chunk->data        = data + (ptrdiff_t)first_row * pitch;
+         chunk->encode      = encode_buf + (size_t)first_row * row_size;
+         chunk->encode_size = (size_t)(last_row - first_row) * row_size;
+         /* The first chunk starts with the zlib header */
+         chunk->out         = out + 8 + (i == 0 ? 2 : 0);
+         chunk->out_size    = chunk->encode_size * 2;
+         chunk->out_len     = 0;
+         chunk->adler       = 1;
+         chunk->pitch       = pitch;
+         chunk->width       = width;
+         chunk->first_row   = first_row;
+         chunk->rows        = last_row - first_row;
+         chunk->bpp         = bpp;
+         chunk->level       = level;
+         chunk->last        = (i + 1 == num_chunks);
+         chunk->ok          = false;
+
+         out                = chunk->out + chunk->out_size + 4;
+      }
+   }
+
+#ifdef HAVE_THREADS
+   if (num_chunks > 1)
+   {
+      /* The calling thread encodes chunks too. Without a
+       * pool, tpool_run_batch() encodes them all in turn. */
+      tpool_run_batch(tpool_shared(), rpng_encode_chunk_job,
+            chunks, num_chunks);
+   }
+   else
+#endif
+      rpng_encode_chunk(&chunks[0]);
+
+   for (i = 0; i < num_chunks; i++)
+   {
+      if (!chunks[i].ok)
+         GOTO_END_ERROR();
+      adler = (i == 0) ? chunks[i].adler : png_adler32_combine(adler,
+            chunks[i].adler, chunks[i].encode_size);
+   }
+
+   for (i = 0; i < num_chunks; i++)
    {
-      if (stream)
+      struct rpng_encode_chunk *chunk = &chunks[i];
+      uint8_t *idat                   = chunk->out - 8;
+      size_t idat_len                 = chunk->out_len;
+
+      if (i == 0)
+      {
+         idat       -= 2;
+         idat[8]     = 0x78;
+         idat[9]     = png_zlib_header_flags(level);
+         idat_len   += 2;
+      }
+
+      if (chunk->last)
       {
-         if (stream_backend->stream_free)
-            stream_backend->stream_free(stream);
+         dword_write_be(chunk->out + chunk->out_len, adler);
+         idat_len   += 4;
       }
+
+      memcpy(idat + 4, "IDAT", 4);
+      dword_write_be(idat + 0, ((uint32_t)idat_len));
+      if (!png_write_idat_string(intf_s, idat, idat_len + 8))
+         GOTO_END_ERROR();
    }
+
+   if (!png_write_iend_string(intf_s))
+      GOTO_END_ERROR();
+end:
+   free(encode_buf);
+   free(deflate_buf);
    return ret;
 }
 
@@ -377,7 +611,7 @@ bool rpng_save_image_argb(const char *path, const uint32_t *data,
 
    ret = rpng_save_image_stream((const uint8_t*) data, intf_s,
                                 width, height,
-                                (signed) pitch, sizeof(uint32_t));
+                                (signed) pitch, sizeof(uint32_t), 9);
    intfstream_close(intf_s);
    free(intf_s);
    return ret;
@@ -385,6 +619,12 @@ bool rpng_save_image_argb(const char *path, const uint32_t *data,
 
 bool rpng_save_image_bgr24(const char *path, const uint8_t *data,
       unsigned width, unsigned height, unsigned pitch)
+{
+   return rpng_save_image_bgr24_level(path, data, width, height, pitch, 9);
+}
+
+bool rpng_save_image_bgr24_level(const char *path, const uint8_t *data,
+      unsigned width, unsigned height, unsigned pitch, int level)
 {
    bool ret                      = false;
    intfstream_t* intf_s          = NULL;
@@ -393,7 +633,7 @@ bool rpng_save_image_bgr24(const char *path, const uint8_t *data,
          RETRO_VFS_FILE_ACCESS_WRITE,
          RETRO_VFS_FILE_ACCESS_HINT_NONE);
    ret = rpng_save_image_stream(data, intf_s, width, height, 
-                                (signed) pitch, 3);
+                                (signed) pitch, 3, level);
    intfstream_close(intf_s);
    free(intf_s);
    return ret;
@@ -420,7 +660,7 @@ uint8_t* rpng_save_image_bgr24_string(const uint8_t *data,
          buf_length);
 
    ret = rpng_save_image_stream((const uint8_t*)data, 
-            intf_s, width, height, pitch, 3);
+            intf_s, width, height, pitch, 3, 9);
 
    *bytes = intfstream_get_ptr(intf_s);
    intfstream_rewind(intf_s);
@@ -26,6 +26,8 @@
 #include <string.h>
 
 #include <retro_inline.h>
+#include <libretro.h>
+#include <features/features_cpu.h>
 
 #include <gfx/scaler/pixconv.h>
 
@@ -33,16 +35,146 @@
 #define SCALER_NO_SIMD
 #endif
 
-#ifdef SCALER_NO_SIMD
-#undef __SSE2__
+#if defined(__SSE2__) && !defined(SCALER_NO_SIMD)
+#define PIXCONV_HAVE_SSE2
 #endif
 
-#if defined(__SSE2__)
+/* AVX2 kernels are built with a target attribute and only
+ * picked at runtime, so the baseline stays SSE2. */
+#if !defined(SCALER_NO_SIMD)
+#if defined(__AVX2__)
+#define PIXCONV_HAVE_AVX2
+#define PIXCONV_TARGET_AVX2
+#elif (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || (defined(__GNUC__) && ((__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define PIXCONV_HAVE_AVX2
+#define PIXCONV_TARGET_AVX2 __attribute__((target("avx2")))
+#elif (defined(_M_X64) || defined(_M_IX86)) && defined(_MSC_VER) && _MSC_VER >= 1800
+#define PIXCONV_HAVE_AVX2
+#define PIXCONV_TARGET_AVX2
+#endif
+#endif
+
+/* NEON kernels store with vst4, which assumes little-endian
+ * ARGB8888 words. */
+#if !defined(SCALER_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__)) && !defined(__ARMEB__) && !defined(__AARCH64EB__)
+#define PIXCONV_HAVE_NEON
+#endif
+
+#if defined(PIXCONV_HAVE_AVX2)
+#include <immintrin.h>
+#elif defined(PIXCONV_HAVE_SSE2)
 #include <emmintrin.h>
 #elif defined(__MMX__)
 #include <mmintrin.h>
 #endif
 
+#if defined(PIXCONV_HAVE_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(PIXCONV_HAVE_AVX2)
+static bool pixconv_has_avx2(void)
+{
+   static int avx2 = -1;
+   if (avx2 < 0)
+      avx2 = (cpu_features_get() & RETRO_SIMD_AVX2) ? 1 : 0;
+   return avx2 == 1;
+}
+
+/* Interleaves 16 pixels of 16-bit B, G, R and A (value in the
+ * low byte) into ARGB8888. The unpacks work per 128-bit lane,
+ * the final permutes put the pixels back in order. */
+static PIXCONV_TARGET_AVX2 INLINE void pixconv_store_argb8888_avx2(
+      uint32_t *output, __m256i b, __m256i g, __m256i r, __m256i a)
+{
+   __m256i lo = _mm256_or_si256(_mm256_unpacklo_epi8(b, g),
+         _mm256_slli_epi32(_mm256_unpacklo_epi8(r, a), 16));
+   __m256i hi = _mm256_or_si256(_mm256_unpackhi_epi8(b, g),
+         _mm256_slli_epi32(_mm256_unpackhi_epi8(r, a), 16));
+
+   _mm256_storeu_si256((__m256i*)(output + 0),
+         _mm256_permute2x128_si256(lo, hi, 0x20));
+   _mm256_storeu_si256((__m256i*)(output + 8),
+         _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+/* Each AVX2 row kernel converts as many whole vectors as fit and
+ * returns the number of pixels done; the caller finishes the row. */
+static PIXCONV_TARGET_AVX2 int conv_0rgb1555_argb8888_avx2(
+      uint32_t *output, const uint16_t *input, int width)
+{
+   int w                     = 0;
+   const __m256i pix_mask_r  = _mm256_set1_epi16(0x1f << 10);
+   const __m256i pix_mask_gb = _mm256_set1_epi16(0x1f <<  5);
+   const __m256i mul15_mid   = _mm256_set1_epi16(0x4200);
+   const __m256i mul15_hi    = _mm256_set1_epi16(0x0210);
+   const __m256i a           = _mm256_set1_epi16(0x00ff);
+
+   for (; w + 16 <= width; w += 16)
+   {
+      const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+      __m256i r = _mm256_and_si256(in, pix_mask_r);
+      __m256i g = _mm256_and_si256(in, pix_mask_gb);
+      __m256i b = _mm256_and_si256(_mm256_slli_epi16(in, 5), pix_mask_gb);
+
+      r = _mm256_mulhi_epi16(r, mul15_hi);
+      g = _mm256_mulhi_epi16(g, mul15_mid);
+      b = _mm256_mulhi_epi16(b, mul15_mid);
+
+      pixconv_store_argb8888_avx2(output + w, b, g, r, a);
+   }
+
+   return w;
+}
+
+static PIXCONV_TARGET_AVX2 int conv_rgb565_argb8888_avx2(
+      uint32_t *output, const uint16_t *input, int width)
+{
+   int w                    = 0;
+   const __m256i pix_mask_r = _mm256_set1_epi16(0x1f << 10);
+   const __m256i pix_mask_g = _mm256_set1_epi16(0x3f <<  5);
+   const __m256i pix_mask_b = _mm256_set1_epi16(0x1f <<  5);
+   const __m256i mul16_r    = _mm256_set1_epi16(0x0210);
+   const __m256i mul16_g    = _mm256_set1_epi16(0x2080);
+   const __m256i mul16_b    = _mm256_set1_epi16(0x4200);
+   const __m256i a          = _mm256_set1_epi16(0x00ff);
+
+   for (; w + 16 <= width; w += 16)
+   {
+      const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+      __m256i r = _mm256_and_si256(_mm256_srli_epi16(in, 1), pix_mask_r);
+      __m256i g = _mm256_and_si256(in, pix_mask_g);
+      __m256i b = _mm256_and_si256(_mm256_slli_epi16(in, 5), pix_mask_b);
+
+      r = _mm256_mulhi_epi16(r, mul16_r);
+      g = _mm256_mulhi_epi16(g, mul16_g);
+      b = _mm256_mulhi_epi16(b, mul16_b);
+
+      pixconv_store_argb8888_avx2(output + w, b, g, r, a);
+   }
+
+   return w;
+}
+
+static PIXCONV_TARGET_AVX2 int conv_argb8888_abgr8888_avx2(
+      uint32_t *output, const uint32_t *input, int width)
+{
+   int w              = 0;
+   const __m256i shuf = _mm256_setr_epi8(
+         2, 1, 0, 3,  6,  5,  4,  7, 10,  9,  8, 11, 14, 13, 12, 15,
+         2, 1, 0, 3,  6,  5,  4,  7, 10,  9,  8, 11, 14, 13, 12, 15);
+
+   for (; w + 8 <= width; w += 8)
+   {
+      const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+      _mm256_storeu_si256((__m256i*)(output + w),
+            _mm256_shuffle_epi8(in, shuf));
+   }
+
+   return w;
+}
+#endif
+
 void conv_rgb565_0rgb1555(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
@@ -51,7 +183,7 @@ void conv_rgb565_0rgb1555(void *output_, const void *input_,
    const uint16_t *input = (const uint16_t*)input_;
    uint16_t *output = (uint16_t*)output_;
 
-#if defined(__SSE2__)
+#if defined(PIXCONV_HAVE_SSE2)
    int max_width           = width - 7;
    const __m128i hi_mask   = _mm_set1_epi16(0x7fe0);
    const __m128i lo_mask   = _mm_set1_epi16(0x1f);
@@ -61,7 +193,7 @@ void conv_rgb565_0rgb1555(void *output_, const void *input_,
          h++, output += out_stride >> 1, input += in_stride >> 1)
    {
       int w = 0;
-#if defined(__SSE2__)
+#if defined(PIXCONV_HAVE_SSE2)
       for (; w < max_width; w += 8)
       {
          const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
@@ -89,7 +221,7 @@ void conv_0rgb1555_rgb565(void *output_, const void *input_,
    const uint16_t *input   = (const uint16_t*)input_;
    uint16_t *output        = (uint16_t*)output_;
 
-#if defined(__SSE2__)
+#if defined(PIXCONV_HAVE_SSE2)
    int max_width           = width - 7;
 
    const __m128i hi_mask   = _mm_set1_epi16(
@@ -102,7 +234,7 @@ void conv_0rgb1555_rgb565(void *output_, const void *input_,
          h++, output += out_stride >> 1, input += in_stride >> 1)
    {
       int w = 0;
-#if defined(__SSE2__)
+#if defined(PIXCONV_HAVE_SSE2)
       for (; w < max_width; w += 8)
       {
          const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
@@ -132,8 +264,11 @@ void conv_0rgb1555_argb8888(void *output_, const void *input_,
    int h;
    const uint16_t *input = (const uint16_t*)input_;
    uint32_t *output      = (uint32_t*)output_;
+#if defined(PIXCONV_HAVE_AVX2)
+   bool avx2             = pixconv_has_avx2();
+#endif
 
-#ifdef __SSE2__
+#ifdef PIXCONV_HAVE_SSE2
    const __m128i pix_mask_r  = _mm_set1_epi16(0x1f << 10);
    const __m128i pix_mask_gb = _mm_set1_epi16(0x1f <<  5);
    const __m128i mul15_mid   = _mm_set1_epi16(0x4200);
@@ -147,7 +282,28 @@ void conv_0rgb1555_argb8888(void *output_, const void *input_,
          h++, output += out_stride >> 2, input += in_stride >> 1)
    {
       int w = 0;
-#ifdef __SSE2__
+#if defined(PIXCONV_HAVE_AVX2)
+      if (avx2)
+         w = conv_0rgb1555_argb8888_avx2(output, input, width);
+#endif
+#if defined(PIXCONV_HAVE_NEON)
+      for (; w + 8 <= width; w += 8)
+      {
+         uint8x8x4_t res;
+         const uint16x8_t mask = vdupq_n_u16(0x1f);
+         const uint16x8_t in   = vld1q_u16(input + w);
+         uint16x8_t r          = vandq_u16(vshrq_n_u16(in, 10), mask);
+         uint16x8_t g          = vandq_u16(vshrq_n_u16(in,  5), mask);
+         uint16x8_t b          = vandq_u16(in, mask);
+
+         res.val[0] = vmovn_u16(vorrq_u16(vshlq_n_u16(b, 3), vshrq_n_u16(b, 2)));
+         res.val[1] = vmovn_u16(vorrq_u16(vshlq_n_u16(g, 3), vshrq_n_u16(g, 2)));
+         res.val[2] = vmovn_u16(vorrq_u16(vshlq_n_u16(r, 3), vshrq_n_u16(r, 2)));
+         res.val[3] = vdup_n_u8(0xff);
+         vst4_u8((uint8_t*)(output + w), res);
+      }
+#endif
+#ifdef PIXCONV_HAVE_SSE2
       for (; w < max_width; w += 8)
       {
          __m128i res_lo_bg, res_hi_bg;
@@ -199,8 +355,11 @@ void conv_rgb565_argb8888(void *output_, const void *input_,
    int h;
    const uint16_t *input    = (const uint16_t*)input_;
    uint32_t *output         = (uint32_t*)output_;
+#if defined(PIXCONV_HAVE_AVX2)
+   bool avx2                = pixconv_has_avx2();
+#endif
 
-#if defined(__SSE2__)
+#if defined(PIXCONV_HAVE_SSE2)
    const __m128i pix_mask_r = _mm_set1_epi16(0x1f << 10);
    const __m128i pix_mask_g = _mm_set1_epi16(0x3f <<  5);
    const __m128i pix_mask_b = _mm_set1_epi16(0x1f <<  5);
@@ -226,7 +385,27 @@ void conv_rgb565_argb8888(void *output_, const void *input_,
          h++, output += out_stride >> 2, input += in_stride >> 1)
    {
       int w = 0;
-#if defined(__SSE2__)
+#if defined(PIXCONV_HAVE_AVX2)
+      if (avx2)
+         w = conv_rgb565_argb8888_avx2(output, input, width);
+#endif
+#if defined(PIXCONV_HAVE_NEON)
+      for (; w + 8 <= width; w += 8)
+      {
+         uint8x8x4_t res;
+         const uint16x8_t in = vld1q_u16(input + w);
+         uint16x8_t r        = vshrq_n_u16(in, 11);
+         uint16x8_t g        = vandq_u16(vshrq_n_u16(in, 5), vdupq_n_u16(0x3f));
+         uint16x8_t b        = vandq_u16(in, vdupq_n_u16(0x1f));
+
+         res.val[0] = vmovn_u16(vorrq_u16(vshlq_n_u16(b, 3), vshrq_n_u16(b, 2)));
+         res.val[1] = vmovn_u16(vorrq_u16(vshlq_n_u16(g, 2), vshrq_n_u16(g, 4)));
+         res.val[2] = vmovn_u16(vorrq_u16(vshlq_n_u16(r, 3), vshrq_n_u16(r, 2)));
+         res.val[3] = vdup_n_u8(0xff);
+         vst4_u8((uint8_t*)(output + w), res);
+      }
+#endif
+#if defined(PIXCONV_HAVE_SSE2)
       for (; w < max_width; w += 8)
       {
          __m128i res_lo, res_hi;
@@ -306,7 +485,7 @@ void conv_rgb565_abgr8888(void *output_, const void *input_,
    int h;
    const uint16_t *input    = (const uint16_t*)input_;
    uint32_t *output         = (uint32_t*)output_;
- #if defined(__SSE2__)
+ #if defined(PIXCONV_HAVE_SSE2)
    const __m128i pix_mask_r = _mm_set1_epi16(0x1f << 10);
    const __m128i pix_mask_g = _mm_set1_epi16(0x3f <<  5);
    const __m128i pix_mask_b = _mm_set1_epi16(0x1f <<  5);
@@ -320,7 +499,7 @@ void conv_rgb565_abgr8888(void *output_, const void *input_,
          h++, output += out_stride >> 2, input += in_stride >> 1)
    {
       int w = 0;
-#if defined(__SSE2__)
+#if defined(PIXCONV_HAVE_SSE2)
       for (; w < max_width; w += 8)
       {
          __m128i res_lo, res_hi;
@@ -481,7 +660,7 @@ void conv_rgba4444_rgb565(void *output_, const void *input_,
    }
 }
 
-#if defined(__SSE2__)
+#if defined(PIXCONV_HAVE_SSE2)
 /* :( TODO: Make this saner. */
 static INLINE void store_bgr24_sse2(void *output, __m128i a,
       __m128i b, __m128i c, __m128i d)
@@ -536,7 +715,7 @@ void conv_0rgb1555_bgr24(void *output_, const void *input_,
    const uint16_t *input     = (const uint16_t*)input_;
    uint8_t *output           = (uint8_t*)output_;
 
-#if defined(__SSE2__)
+#if defined(PIXCONV_HAVE_SSE2)
    const __m128i pix_mask_r  = _mm_set1_epi16(0x1f << 10);
    const __m128i pix_mask_gb = _mm_set1_epi16(0x1f <<  5);
    const __m128i mul15_mid   = _mm_set1_epi16(0x4200);
@@ -552,7 +731,7 @@ void conv_0rgb1555_bgr24(void *output_, const void *input_,
       uint8_t *out = output;
       int   w = 0;
 
-#if defined(__SSE2__)
+#if defined(PIXCONV_HAVE_SSE2)
       for (; w < max_width; w += 16, out += 48)
       {
          __m128i res_lo_bg0, res_lo_bg1, res_hi_bg0, res_hi_bg1,
@@ -622,7 +801,7 @@ void conv_rgb565_bgr24(void *output_, const void *input_,
    const uint16_t *input    = (const uint16_t*)input_;
    uint8_t *output          = (uint8_t*)output_;
 
-#if defined(__SSE2__)
+#if defined(PIXCONV_HAVE_SSE2)
    const __m128i pix_mask_r = _mm_set1_epi16(0x1f << 10);
    const __m128i pix_mask_g = _mm_set1_epi16(0x3f <<  5);
    const __m128i pix_mask_b = _mm_set1_epi16(0x1f <<  5);
@@ -638,7 +817,7 @@ void conv_rgb565_bgr24(void *output_, const void *input_,
    {
       uint8_t *out = output;
       int        w = 0;
-#if defined(__SSE2__)
+#if defined(PIXCONV_HAVE_SSE2)
       for (; w < max_width; w += 16, out += 48)
       {
          __m128i res_lo_bg0, res_hi_bg0, res_lo_ra0, res_hi_ra0;
@@ -773,7 +952,7 @@ void conv_argb8888_bgr24(void *output_, const void *input_,
    const uint32_t *input = (const uint32_t*)input_;
    uint8_t *output       = (uint8_t*)output_;
 
-#if defined(__SSE2__)
+#if defined(PIXCONV_HAVE_SSE2)
    int max_width = width - 15;
 #endif
 
@@ -782,7 +961,7 @@ void conv_argb8888_bgr24(void *output_, const void *input_,
    {
       uint8_t *out = output;
       int        w = 0;
-#if defined(__SSE2__)
+#if defined(PIXCONV_HAVE_SSE2)
       for (; w < max_width; w += 16, out += 48)
       {
          __m128i l0 = _mm_loadu_si128((const __m128i*)(input + w +  0));
@@ -803,7 +982,7 @@ void conv_argb8888_bgr24(void *output_, const void *input_,
    }
 }
 
-#if defined(__SSE2__)
+#if defined(PIXCONV_HAVE_SSE2)
 static INLINE __m128i conv_shuffle_rb_epi32(__m128i c)
 {
    /* SSSE3 plz */
@@ -826,7 +1005,7 @@ void conv_abgr8888_bgr24(void *output_, const void *input_,
    const uint32_t *input = (const uint32_t*)input_;
    uint8_t *output       = (uint8_t*)output_;
 
-#if defined(__SSE2__)
+#if defined(PIXCONV_HAVE_SSE2)
    int max_width = width - 15;
 #endif
 
@@ -835,7 +1014,7 @@ void conv_abgr8888_bgr24(void *output_, const void *input_,
    {
       uint8_t *out = output;
       int        w = 0;
-#if defined(__SSE2__)
+#if defined(PIXCONV_HAVE_SSE2)
       for (; w < max_width; w += 16, out += 48)
       {
 		 __m128i a = _mm_loadu_si128((const __m128i*)(input + w +  0));
@@ -864,14 +1043,49 @@ void conv_argb8888_abgr8888(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint32_t *input = (const uint32_t*)input_;
    uint32_t *output      = (uint32_t*)output_;
+#if defined(PIXCONV_HAVE_AVX2)
+   bool avx2             = pixconv_has_avx2();
+#endif
+#if defined(PIXCONV_HAVE_SSE2)
+   const __m128i mask_ag = _mm_set1_epi32(0xff00ff00);
+   const __m128i mask_r  = _mm_set1_epi32(0x00ff0000);
+   const __m128i mask_b  = _mm_set1_epi32(0x000000ff);
+#endif
 
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride >> 2)
    {
-      for (w = 0; w < width; w++)
+      int w = 0;
+#if defined(PIXCONV_HAVE_AVX2)
+      if (avx2)
+         w = conv_argb8888_abgr8888_avx2(output, input, width);
+#endif
+#if defined(PIXCONV_HAVE_NEON)
+      for (; w + 8 <= width; w += 8)
+      {
+         uint8x8x4_t px = vld4_u8((const uint8_t*)(input + w));
+         uint8x8_t  tmp = px.val[0];
+         px.val[0]      = px.val[2];
+         px.val[2]      = tmp;
+         vst4_u8((uint8_t*)(output + w), px);
+      }
+#endif
+#if defined(PIXCONV_HAVE_SSE2)
+      for (; w + 4 <= width; w += 4)
+      {
+         const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
+         __m128i res      = _mm_or_si128(_mm_and_si128(in, mask_ag),
+               _mm_or_si128(
+                  _mm_and_si128(_mm_slli_epi32(in, 16), mask_r),
+                  _mm_and_si128(_mm_srli_epi32(in, 16), mask_b)));
+         _mm_storeu_si128((__m128i*)(output + w), res);
+      }
+#endif
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          output[w]    = ((col << 16) & 0xff0000) |
@@ -888,6 +1102,95 @@ void conv_argb8888_abgr8888(void *output_, const void *input_,
 #define YUV_MAT_V_R (90)
 #define YUV_MAT_V_G (-46)
 
+#if defined(PIXCONV_HAVE_AVX2)
+/* Same algorithm as the SSE2 path, 32 pixels at a time. Chroma
+ * packing and the final interleave stay within 128-bit lanes, so
+ * the two halves of each output pair are swapped back at the end. */
+static PIXCONV_TARGET_AVX2 int conv_yuyv_argb8888_avx2(
+      uint32_t *dst, const uint8_t *src, int width)
+{
+   int w                       = 0;
+   const __m256i mask_y        = _mm256_set1_epi16(0xffu);
+   const __m256i mask_u        = _mm256_set1_epi32(0xffu << 8);
+   const __m256i mask_v        = _mm256_set1_epi32(0xffu << 24);
+   const __m256i chroma_offset = _mm256_set1_epi16(128);
+   const __m256i round_offset  = _mm256_set1_epi16(YUV_OFFSET);
+   const __m256i yuv_mul       = _mm256_set1_epi16(YUV_MAT_Y);
+   const __m256i u_g_mul       = _mm256_set1_epi16(YUV_MAT_U_G);
+   const __m256i u_b_mul       = _mm256_set1_epi16(YUV_MAT_U_B);
+   const __m256i v_r_mul       = _mm256_set1_epi16(YUV_MAT_V_R);
+   const __m256i v_g_mul       = _mm256_set1_epi16(YUV_MAT_V_G);
+   const __m256i a             = _mm256_set1_epi16(-1);
+
+   for (; w + 32 <= width; w += 32, src += 64, dst += 32)
+   {
+      __m256i u, v, r0, g0, b0, r1, g1, b1;
+      __m256i res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
+      __m256i res0, res1, res2, res3;
+      __m256i yuv0 = _mm256_loadu_si256((const __m256i*)(src +  0));
+      __m256i yuv1 = _mm256_loadu_si256((const __m256i*)(src + 32));
+      __m256i _y0  = _mm256_and_si256(yuv0, mask_y);
+      __m256i _y1  = _mm256_and_si256(yuv1, mask_y);
+      __m256i u0   = _mm256_srli_si256(_mm256_and_si256(yuv0, mask_u), 1);
+      __m256i v0   = _mm256_srli_si256(_mm256_and_si256(yuv0, mask_v), 3);
+      __m256i u1   = _mm256_srli_si256(_mm256_and_si256(yuv1, mask_u), 1);
+      __m256i v1   = _mm256_srli_si256(_mm256_and_si256(yuv1, mask_v), 3);
+
+      u  = _mm256_sub_epi16(_mm256_packs_epi32(u0, u1), chroma_offset);
+      v  = _mm256_sub_epi16(_mm256_packs_epi32(v0, v1), chroma_offset);
+
+      /* Per lane this lines up with _y0 (lo) and _y1 (hi). */
+      u0 = _mm256_unpacklo_epi16(u, u);
+      u1 = _mm256_unpackhi_epi16(u, u);
+      v0 = _mm256_unpacklo_epi16(v, v);
+      v1 = _mm256_unpackhi_epi16(v, v);
+
+      _y0 = _mm256_mullo_epi16(_y0, yuv_mul);
+      _y1 = _mm256_mullo_epi16(_y1, yuv_mul);
+
+      r0 = _mm256_srai_epi16(_mm256_adds_epi16(_mm256_adds_epi16(_y0,
+                  _mm256_mullo_epi16(v0, v_r_mul)), round_offset), YUV_SHIFT);
+      g0 = _mm256_srai_epi16(_mm256_adds_epi16(_mm256_adds_epi16(
+                  _mm256_adds_epi16(_y0, _mm256_mullo_epi16(v0, v_g_mul)),
+                  _mm256_mullo_epi16(u0, u_g_mul)), round_offset), YUV_SHIFT);
+      b0 = _mm256_srai_epi16(_mm256_adds_epi16(_mm256_adds_epi16(_y0,
+                  _mm256_mullo_epi16(u0, u_b_mul)), round_offset), YUV_SHIFT);
+
+      r1 = _mm256_srai_epi16(_mm256_adds_epi16(_mm256_adds_epi16(_y1,
+                  _mm256_mullo_epi16(v1, v_r_mul)), round_offset), YUV_SHIFT);
+      g1 = _mm256_srai_epi16(_mm256_adds_epi16(_mm256_adds_epi16(
+                  _mm256_adds_epi16(_y1, _mm256_mullo_epi16(v1, v_g_mul)),
+                  _mm256_mullo_epi16(u1, u_g_mul)), round_offset), YUV_SHIFT);
+      b1 = _mm256_srai_epi16(_mm256_adds_epi16(_mm256_adds_epi16(_y1,
+                  _mm256_mullo_epi16(u1, u_b_mul)), round_offset), YUV_SHIFT);
+
+      r0 = _mm256_packus_epi16(r0, r1);
+      g0 = _mm256_packus_epi16(g0, g1);
+      b0 = _mm256_packus_epi16(b0, b1);
+
+      res_lo_bg = _mm256_unpacklo_epi8(b0, g0);
+      res_hi_bg = _mm256_unpackhi_epi8(b0, g0);
+      res_lo_ra = _mm256_unpacklo_epi8(r0, a);
+      res_hi_ra = _mm256_unpackhi_epi8(r0, a);
+      res0      = _mm256_unpacklo_epi16(res_lo_bg, res_lo_ra);
+      res1      = _mm256_unpackhi_epi16(res_lo_bg, res_lo_ra);
+      res2      = _mm256_unpacklo_epi16(res_hi_bg, res_hi_ra);
+      res3      = _mm256_unpackhi_epi16(res_hi_bg, res_hi_ra);
+
+      _mm256_storeu_si256((__m256i*)(dst +  0),
+            _mm256_permute2x128_si256(res0, res1, 0x20));
+      _mm256_storeu_si256((__m256i*)(dst +  8),
+            _mm256_permute2x128_si256(res0, res1, 0x31));
+      _mm256_storeu_si256((__m256i*)(dst + 16),
+            _mm256_permute2x128_si256(res2, res3, 0x20));
+      _mm256_storeu_si256((__m256i*)(dst + 24),
+            _mm256_permute2x128_si256(res2, res3, 0x31));
+   }
+
+   return w;
+}
+#endif
+
 void conv_yuyv_argb8888(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
@@ -895,8 +1198,11 @@ void conv_yuyv_argb8888(void *output_, const void *input_,
    int h;
    const uint8_t *input        = (const uint8_t*)input_;
    uint32_t *output            = (uint32_t*)output_;
+#if defined(PIXCONV_HAVE_AVX2)
+   bool avx2                   = pixconv_has_avx2();
+#endif
 
-#if defined(__SSE2__)
+#if defined(PIXCONV_HAVE_SSE2)
    const __m128i mask_y        = _mm_set1_epi16(0xffu);
    const __m128i mask_u        = _mm_set1_epi32(0xffu << 8);
    const __m128i mask_v        = _mm_set1_epi32(0xffu << 24);
@@ -918,7 +1224,54 @@ void conv_yuyv_argb8888(void *output_, const void *input_,
       uint32_t      *dst = output;
       int              w = 0;
 
-#if defined(__SSE2__)
+#if defined(PIXCONV_HAVE_AVX2)
+      if (avx2)
+      {
+         w    = conv_yuyv_argb8888_avx2(dst, src, width);
+         src += w * 2;
+         dst += w;
+      }
+#endif
+#if defined(PIXCONV_HAVE_NEON)
+      /* Each loop processes 16 pixels. The rounding narrowing shift
+       * adds YUV_OFFSET and saturates like clamp_8bit() below. */
+      for (; w + 16 <= width; w += 16, src += 32, dst += 16)
+      {
+         uint8x8x4_t res;
+         uint8x8x2_t r, g, b;
+         uint8x8x4_t yuv  = vld4_u8(src); /* Y0, U, Y1, V planes */
+         int16x8_t   u    = vsubq_s16(vreinterpretq_s16_u16(
+                  vmovl_u8(yuv.val[1])), vdupq_n_s16(128));
+         int16x8_t   v    = vsubq_s16(vreinterpretq_s16_u16(
+                  vmovl_u8(yuv.val[3])), vdupq_n_s16(128));
+         int16x8_t   _y0  = vreinterpretq_s16_u16(
+               vshlq_n_u16(vmovl_u8(yuv.val[0]), 6));
+         int16x8_t   _y1  = vreinterpretq_s16_u16(
+               vshlq_n_u16(vmovl_u8(yuv.val[2]), 6));
+         int16x8_t   c_r  = vmulq_n_s16(v, YUV_MAT_V_R);
+         int16x8_t   c_g  = vmlaq_n_s16(vmulq_n_s16(u, YUV_MAT_U_G),
+               v, YUV_MAT_V_G);
+         int16x8_t   c_b  = vmulq_n_s16(u, YUV_MAT_U_B);
+
+         r = vzip_u8(vqrshrun_n_s16(vaddq_s16(_y0, c_r), YUV_SHIFT),
+               vqrshrun_n_s16(vaddq_s16(_y1, c_r), YUV_SHIFT));
+         g = vzip_u8(vqrshrun_n_s16(vaddq_s16(_y0, c_g), YUV_SHIFT),
+               vqrshrun_n_s16(vaddq_s16(_y1, c_g), YUV_SHIFT));
+         b = vzip_u8(vqrshrun_n_s16(vaddq_s16(_y0, c_b), YUV_SHIFT),
+               vqrshrun_n_s16(vaddq_s16(_y1, c_b), YUV_SHIFT));
+
+         res.val[3] = vdup_n_u8(0xff);
+         res.val[0] = b.val[0];
+         res.val[1] = g.val[0];
+         res.val[2] = r.val[0];
+         vst4_u8((uint8_t*)(dst + 0), res);
+         res.val[0] = b.val[1];
+         res.val[1] = g.val[1];
+         res.val[2] = r.val[1];
+         vst4_u8((uint8_t*)(dst + 8), res);
+      }
+#endif
+#if defined(PIXCONV_HAVE_SSE2)
       /* Each loop processes 16 pixels. */
       for (; w + 16 <= width; w += 16, src += 32, dst += 16)
       {
@@ -30,6 +30,145 @@
 #include <gfx/scaler/filter.h>
 #include <gfx/scaler/pixconv.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/tpool.h>
+
+/* Upper bound on slices per frame; past this the passes are
+ * memory bound and extra threads only add wakeup latency. */
+#define SCALER_MAX_THREADS 16
+
+enum scaler_pass
+{
+   SCALER_PASS_HORIZ = 0,
+   SCALER_PASS_VERT
+};
+
+struct scaler_thread_pool
+{
+   /* NULL while the shared pool is used, which is
+    * looked up for every frame instead */
+   tpool_t *tp;
+
+   /* Current job, set by scaler_ctx_scale() */
+   const struct scaler_ctx *ctx;
+   const void *input;
+   void *output;
+   enum scaler_pass pass;
+
+   unsigned num_slices;
+};
+#endif
+
+/* Horizontal slices cover input rows, so the input pixel
+ * conversion for those rows is done in the same slice. */
+static void scaler_ctx_horiz_slice(const struct scaler_ctx *ctx,
+      const void *input, unsigned slice, unsigned num_slices)
+{
+   int first_row    = (int)(((int64_t)ctx->scaled.height * slice)
+         / num_slices);
+   int last_row     = (int)(((int64_t)ctx->scaled.height * (slice + 1))
+         / num_slices);
+   int input_stride = ctx->in_stride;
+
+   if (!ctx->scaler_horiz || first_row >= last_row)
+      return;
+
+   if (ctx->in_fmt != SCALER_FMT_ARGB8888)
+   {
+      ctx->in_pixconv(
+            ctx->input.frame + first_row * (ctx->input.stride >> 2),
+            (const uint8_t*)input + first_row * ctx->in_stride,
+            ctx->in_width, last_row - first_row,
+            ctx->input.stride, ctx->in_stride);
+
+      input        = ctx->input.frame;
+      input_stride = ctx->input.stride;
+   }
+
+   ctx->scaler_horiz(ctx, input, input_stride, first_row, last_row);
+}
+
+/* Vertical slices cover output rows, likewise followed by
+ * the output pixel conversion for those rows. */
+static void scaler_ctx_vert_slice(const struct scaler_ctx *ctx,
+      void *output, unsigned slice, unsigned num_slices)
+{
+   int first_row = (int)(((int64_t)ctx->out_height * slice)
+         / num_slices);
+   int last_row  = (int)(((int64_t)ctx->out_height * (slice + 1))
+         / num_slices);
+
+   if (!ctx->scaler_vert || first_row >= last_row)
+      return;
+
+   if (ctx->out_fmt != SCALER_FMT_ARGB8888)
+   {
+      ctx->scaler_vert(ctx, ctx->output.frame, ctx->output.stride,
+            first_row, last_row);
+      ctx->out_pixconv(
+            (uint8_t*)output + first_row * ctx->out_stride,
+            ctx->output.frame + first_row * (ctx->output.stride >> 2),
+            ctx->out_width, last_row - first_row,
+            ctx->out_stride, ctx->output.stride);
+   }
+   else
+      ctx->scaler_vert(ctx, output, ctx->out_stride,
+            first_row, last_row);
+}
+
+#ifdef HAVE_THREADS
+static void scaler_pool_run_slice(void *data, unsigned slice)
+{
+   struct scaler_thread_pool *pool = (struct scaler_thread_pool*)data;
+
+   if (pool->pass == SCALER_PASS_HORIZ)
+      scaler_ctx_horiz_slice(pool->ctx, pool->input,
+            slice, pool->num_slices);
+   else
+      scaler_ctx_vert_slice(pool->ctx, pool->output,
+            slice, pool->num_slices);
+}
+
+/* Runs one pass over all slices and returns once every slice
+ * is done, so the vertical pass never sees a partial frame. */
+static void scaler_pool_run_pass(struct scaler_thread_pool *pool,
+      enum scaler_pass pass)
+{
+   pool->pass = pass;
+   tpool_run_batch(pool->tp ? pool->tp : tpool_shared(),
+         scaler_pool_run_slice, pool, pool->num_slices);
+}
+
+static void scaler_pool_free(struct scaler_thread_pool *pool)
+{
+   if (pool->tp)
+      tpool_destroy(pool->tp);
+   free(pool);
+}
+
+static struct scaler_thread_pool *scaler_pool_new(unsigned threads)
+{
+   struct scaler_thread_pool *pool = (struct scaler_thread_pool*)
+      calloc(1, sizeof(*pool));
+
+   if (!pool)
+      return NULL;
+
+   /* The calling thread works on slices too, next to the
+    * frontend's shared pool if there is one, so that every
+    * scaler in use does not start threads of its own */
+   pool->num_slices = threads;
+   if (     !tpool_shared()
+         && !(pool->tp = tpool_create(threads - 1)))
+   {
+      free(pool);
+      return NULL;
+   }
+
+   return pool;
+}
+#endif
+
 static bool allocate_frames(struct scaler_ctx *ctx)
 {
    uint64_t *scaled_frame = NULL;
@@ -261,6 +400,22 @@ bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
 
       if (!scaler_gen_filter(ctx))
          return false;
+
+#ifdef HAVE_THREADS
+      if (ctx->threads > 1)
+      {
+         unsigned threads = ctx->threads;
+
+         if (threads > SCALER_MAX_THREADS)
+            threads = SCALER_MAX_THREADS;
+         if (threads > (unsigned)ctx->out_height)
+            threads = ctx->out_height;
+
+         /* Not fatal, we just scale on the calling thread. */
+         if (threads > 1)
+            ctx->pool = scaler_pool_new(threads);
+      }
+#endif
    }
 
    return true;
@@ -268,6 +423,10 @@ bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
 
 void scaler_ctx_gen_reset(struct scaler_ctx *ctx)
 {
+#ifdef HAVE_THREADS
+   if (ctx->pool)
+      scaler_pool_free(ctx->pool);
+#endif
    if (ctx->horiz.filter)
       free(ctx->horiz.filter);
    if (ctx->horiz.filter_pos)
@@ -303,6 +462,8 @@ void scaler_ctx_gen_reset(struct scaler_ctx *ctx)
 
    ctx->output.frame        = NULL;
    ctx->output.stride       = 0;
+
+   ctx->pool                = NULL;
 }
 
 /**
@@ -316,44 +477,56 @@ void scaler_ctx_gen_reset(struct scaler_ctx *ctx)
 void scaler_ctx_scale(struct scaler_ctx *ctx,
       void *output, const void *input)
 {
-   const void *input_frame = input;
-   void *output_frame      = output;
-   int input_stride        = ctx->in_stride;
-   int output_stride       = ctx->out_stride;
-
-   if (ctx->in_fmt != SCALER_FMT_ARGB8888)
+   /* Take some special, and (hopefully) more optimized path. */
+   if (ctx->scaler_special)
    {
-      ctx->in_pixconv(ctx->input.frame, input,
-            ctx->in_width, ctx->in_height,
-            ctx->input.stride, ctx->in_stride);
+      const void *input_frame = input;
+      void *output_frame      = output;
+      int input_stride        = ctx->in_stride;
+      int output_stride       = ctx->out_stride;
 
-      input_frame       = ctx->input.frame;
-      input_stride      = ctx->input.stride;
-   }
+      if (ctx->in_fmt != SCALER_FMT_ARGB8888)
+      {
+         ctx->in_pixconv(ctx->input.frame, input,
+               ctx->in_width, ctx->in_height,
+               ctx->input.stride, ctx->in_stride);
 
-   if (ctx->out_fmt != SCALER_FMT_ARGB8888)
-   {
-      output_frame  = ctx->output.frame;
-      output_stride = ctx->output.stride;
-   }
+         input_frame       = ctx->input.frame;
+         input_stride      = ctx->input.stride;
+      }
+
+      if (ctx->out_fmt != SCALER_FMT_ARGB8888)
+      {
+         output_frame  = ctx->output.frame;
+         output_stride = ctx->output.stride;
+      }
 
-   /* Take some special, and (hopefully) more optimized path. */
-   if (ctx->scaler_special)
       ctx->scaler_special(ctx, output_frame, input_frame,
             ctx->out_width, ctx->out_height,
             ctx->in_width, ctx->in_height,
             output_stride, input_stride);
-   else
+
+      if (ctx->out_fmt != SCALER_FMT_ARGB8888)
+         ctx->out_pixconv(output, ctx->output.frame,
+               ctx->out_width, ctx->out_height,
+               ctx->out_stride, ctx->output.stride);
+      return;
+   }
+
+   /* Take generic filter path. */
+#ifdef HAVE_THREADS
+   if (ctx->pool)
    {
-      /* Take generic filter path. */
-      if (ctx->scaler_horiz)
-         ctx->scaler_horiz(ctx, input_frame, input_stride);
-      if (ctx->scaler_vert)
-         ctx->scaler_vert (ctx, output, output_stride);
+      ctx->pool->ctx    = ctx;
+      ctx->pool->input  = input;
+      ctx->pool->output = output;
+
+      scaler_pool_run_pass(ctx->pool, SCALER_PASS_HORIZ);
+      scaler_pool_run_pass(ctx->pool, SCALER_PASS_VERT);
+      return;
    }
+#endif
 
-   if (ctx->out_fmt != SCALER_FMT_ARGB8888)
-      ctx->out_pixconv(output, ctx->output.frame,
-            ctx->out_width, ctx->out_height,
-            ctx->out_stride, ctx->output.stride);
+   scaler_ctx_horiz_slice(ctx, input, 0, 1);
+   scaler_ctx_vert_slice(ctx, output, 0, 1);
 }
@@ -24,15 +24,23 @@
 
 #include <retro_inline.h>
 
-#ifdef SCALER_NO_SIMD
-#undef __SSE2__
+#if defined(__SSE2__) && !defined(SCALER_NO_SIMD)
+#define SCALER_HAVE_SSE2
 #endif
 
-#if defined(__SSE2__)
+/* The NEON kernels reinterpret the 16-bit channel words in
+ * place, which assumes a little-endian layout. */
+#if !defined(SCALER_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__)) && !defined(__ARMEB__) && !defined(__AARCH64EB__)
+#define SCALER_HAVE_NEON
+#endif
+
+#if defined(SCALER_HAVE_SSE2)
 #include <emmintrin.h>
 #ifdef _WIN32
 #include <intrin.h>
 #endif
+#elif defined(SCALER_HAVE_NEON)
+#include <arm_neon.h>
 #endif
 
 /* ARGB8888 scaler is split in two:
@@ -60,60 +68,106 @@
  *
  * The C version of scalers perform the exact same operations as the
  * SIMD code for testing purposes.
+ *
+ * Both passes work on a range of rows [first_row, last_row) so that
+ * scaler_ctx_scale() can split a frame into slices across threads.
+ * Horizontal rows map 1:1 to input rows, vertical rows to output rows.
  */
 
-void scaler_argb8888_vert(const struct scaler_ctx *ctx, void *output_, int stride)
+void scaler_argb8888_vert(const struct scaler_ctx *ctx, void *output_, int stride,
+      int first_row, int last_row)
 {
    int h, w, y;
    const uint64_t      *input = ctx->scaled.frame;
-   uint32_t           *output = (uint32_t*)output_;
+   uint32_t           *output = (uint32_t*)output_ + first_row * (stride >> 2);
+   const int      scaled_step = ctx->scaled.stride >> 3;
 
-   const int16_t *filter_vert = ctx->vert.filter;
+   const int16_t *filter_vert = ctx->vert.filter
+      + first_row * ctx->vert.filter_stride;
 
-   for (h = 0; h < ctx->out_height; h++,
+   for (h = first_row; h < last_row; h++,
          filter_vert += ctx->vert.filter_stride, output += stride >> 2)
    {
       const uint64_t *input_base = input + ctx->vert.filter_pos[h]
-         * (ctx->scaled.stride >> 3);
+         * scaled_step;
 
-      for (w = 0; w < ctx->out_width; w++)
+      w = 0;
+
+#if defined(SCALER_HAVE_SSE2)
+      /* Two pixels per register; the scaled frame is padded
+       * to 8 pixels so the unaligned loads never run off a row.
+       * Even and odd taps are summed apart and then combined,
+       * which saturates the same way as the per-pixel path. */
+      for (; (w + 1) < ctx->out_width; w += 2)
       {
          const uint64_t *input_base_y = input_base + w;
-#if defined(__SSE2__)
-         __m128i final;
-         __m128i res = _mm_setzero_si128();
+         __m128i res      = _mm_setzero_si128();
+         __m128i res_odd  = _mm_setzero_si128();
 
          for (y = 0; (y + 1) < ctx->vert.filter_len; y += 2,
-               input_base_y += (ctx->scaled.stride >> 2))
+               input_base_y += (scaled_step << 1))
          {
-            __m128i coeff = _mm_set_epi64x(filter_vert[y + 1] * 0x0001000100010001ll, filter_vert[y + 0] * 0x0001000100010001ll);
-            __m128i col   = _mm_set_epi64x(input_base_y[ctx->scaled.stride >> 3], input_base_y[0]);
+            __m128i coeff = _mm_set1_epi16(filter_vert[y + 0]);
+            __m128i col   = _mm_loadu_si128((const __m128i*)input_base_y);
 
             res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
+
+            coeff         = _mm_set1_epi16(filter_vert[y + 1]);
+            col           = _mm_loadu_si128((const __m128i*)
+                  (input_base_y + scaled_step));
+            res_odd       = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res_odd);
          }
 
-         for (; y < ctx->vert.filter_len; y++, input_base_y += (ctx->scaled.stride >> 3))
+         for (; y < ctx->vert.filter_len; y++, input_base_y += scaled_step)
          {
-            __m128i coeff = _mm_set_epi64x(0, filter_vert[y] * 0x0001000100010001ll);
-            __m128i col   = _mm_set_epi64x(0, input_base_y[0]);
+            __m128i coeff = _mm_set1_epi16(filter_vert[y]);
+            __m128i col   = _mm_loadu_si128((const __m128i*)input_base_y);
 
             res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
          }
 
-         res       = _mm_adds_epi16(_mm_srli_si128(res, 8), res);
-         res       = _mm_srai_epi16(res, (7 - 2 - 2));
+         res = _mm_adds_epi16(res_odd, res);
+         res = _mm_srai_epi16(res, (7 - 2 - 2));
+         _mm_storel_epi64((__m128i*)(output + w), _mm_packus_epi16(res, res));
+      }
+#elif defined(SCALER_HAVE_NEON)
+      for (; (w + 1) < ctx->out_width; w += 2)
+      {
+         const uint64_t *input_base_y = input_base + w;
+         int16x8_t res     = vdupq_n_s16(0);
+         int16x8_t res_odd = vdupq_n_s16(0);
+
+         for (y = 0; y < ctx->vert.filter_len; y++,
+               input_base_y += scaled_step)
+         {
+            int16x8_t col   = vreinterpretq_s16_u64(vld1q_u64(input_base_y));
+            int16x4_t coeff = vdup_n_s16(filter_vert[y]);
+            int16x8_t prod  = vcombine_s16(
+                  vshrn_n_s32(vmull_s16(vget_low_s16(col),  coeff), 16),
+                  vshrn_n_s32(vmull_s16(vget_high_s16(col), coeff), 16));
+
+            if (y & 1)
+               res_odd      = vqaddq_s16(prod, res_odd);
+            else
+               res          = vqaddq_s16(prod, res);
+         }
 
-         final     = _mm_packus_epi16(res, res);
+         res = vqaddq_s16(res_odd, res);
+         res = vshrq_n_s16(res, (7 - 2 - 2));
+         vst1_u32(output + w, vreinterpret_u32_u8(vqmovun_s16(res)));
+      }
+#endif
 
-         output[w] = _mm_cvtsi128_si32(final);
-#else
+      for (; w < ctx->out_width; w++)
+      {
+         const uint64_t *input_base_y = input_base + w;
          int16_t res_a = 0;
          int16_t res_r = 0;
          int16_t res_g = 0;
          int16_t res_b = 0;
 
          for (y = 0; y < ctx->vert.filter_len; y++,
-               input_base_y += (ctx->scaled.stride >> 3))
+               input_base_y += scaled_step)
          {
             uint64_t col   = *input_base_y;
 
@@ -140,18 +194,19 @@ void scaler_argb8888_vert(const struct scaler_ctx *ctx, void *output_, int strid
             (clamp_8bit(res_r) << 16) |
             (clamp_8bit(res_g) << 8)  |
             (clamp_8bit(res_b) << 0);
-#endif
       }
    }
 }
 
-void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int stride)
+void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int stride,
+      int first_row, int last_row)
 {
    int h, w, x;
-   const uint32_t *input = (uint32_t*)input_;
-   uint64_t *output      = ctx->scaled.frame;
+   const uint32_t *input = (const uint32_t*)input_ + first_row * (stride >> 2);
+   uint64_t *output      = ctx->scaled.frame
+      + first_row * (ctx->scaled.stride >> 3);
 
-   for (h = 0; h < ctx->scaled.height; h++, input += stride >> 2,
+   for (h = first_row; h < last_row; h++, input += stride >> 2,
          output += ctx->scaled.stride >> 3)
    {
       const int16_t *filter_horiz = ctx->horiz.filter;
@@ -160,7 +215,7 @@ void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int
             filter_horiz += ctx->horiz.filter_stride)
       {
          const uint32_t *input_base_x = input + ctx->horiz.filter_pos[w];
-#if defined(__SSE2__)
+#if defined(SCALER_HAVE_SSE2)
          __m128i res = _mm_setzero_si128();
 #ifndef __x86_64__
          union
@@ -171,7 +226,11 @@ void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int
 #endif
          for (x = 0; (x + 1) < ctx->horiz.filter_len; x += 2)
          {
-            __m128i coeff = _mm_set_epi64x(filter_horiz[x + 1] * 0x0001000100010001ll, filter_horiz[x + 0] * 0x0001000100010001ll);
+            __m128i coeff = _mm_set_epi16(
+                  filter_horiz[x + 1], filter_horiz[x + 1],
+                  filter_horiz[x + 1], filter_horiz[x + 1],
+                  filter_horiz[x + 0], filter_horiz[x + 0],
+                  filter_horiz[x + 0], filter_horiz[x + 0]);
 
             __m128i col   = _mm_unpacklo_epi8(_mm_set_epi64x(0,
                      ((uint64_t)input_base_x[x + 1] << 32) | input_base_x[x + 0]), _mm_setzero_si128());
@@ -182,7 +241,9 @@ void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int
 
          for (; x < ctx->horiz.filter_len; x++)
          {
-            __m128i coeff = _mm_set_epi64x(0, filter_horiz[x] * 0x0001000100010001ll);
+            __m128i coeff = _mm_set_epi16(0, 0, 0, 0,
+                  filter_horiz[x], filter_horiz[x],
+                  filter_horiz[x], filter_horiz[x]);
             __m128i col   = _mm_unpacklo_epi8(_mm_set_epi32(0, 0, 0, input_base_x[x]), _mm_setzero_si128());
 
             col           = _mm_slli_epi16(col, 7);
@@ -198,6 +259,27 @@ void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int
          u.u32[0] = _mm_cvtsi128_si32(res);
          u.u32[1] = _mm_cvtsi128_si32(_mm_srli_si128(res, 4));
 #endif
+#elif defined(SCALER_HAVE_NEON)
+         int16x4_t res     = vdup_n_s16(0);
+         int16x4_t res_odd = vdup_n_s16(0);
+
+         for (x = 0; x < ctx->horiz.filter_len; x++)
+         {
+            uint8x8_t  px   = vreinterpret_u8_u32(vdup_n_u32(input_base_x[x]));
+            int16x4_t  col  = vreinterpret_s16_u16(
+                  vshl_n_u16(vget_low_u16(vmovl_u8(px)), 7));
+            int16x4_t coeff = vdup_n_s16(filter_horiz[x]);
+            int16x4_t prod  = vshrn_n_s32(vmull_s16(col, coeff), 16);
+
+            /* Same even/odd split as the SSE2 path */
+            if (x & 1)
+               res_odd      = vqadd_s16(prod, res_odd);
+            else
+               res          = vqadd_s16(prod, res);
+         }
+
+         res = vqadd_s16(res_odd, res);
+         vst1_u64(output + w, vreinterpret_u64_s16(res));
 #else
          int16_t res_a = 0;
          int16_t res_r = 0;
@@ -221,11 +303,13 @@ void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int
             res_b         += (b * coeff) >> 16;
          }
 
+         /* Channels can go negative with sinc, so keep the
+          * sign extension out of the neighbouring channels. */
          output[w]         = (
-               (uint64_t)res_a  << 48)  |
-               ((uint64_t)res_r << 32)  |
-               ((uint64_t)res_g << 16)  |
-               ((uint64_t)res_b << 0);
+               (uint64_t)(uint16_t)res_a  << 48)  |
+               ((uint64_t)(uint16_t)res_r << 32)  |
+               ((uint64_t)(uint16_t)res_g << 16)  |
+               ((uint64_t)(uint16_t)res_b << 0);
 #endif
       }
    }
@@ -68,6 +68,17 @@ uint64_t cpu_features_get(void);
  **/
 unsigned cpu_features_get_core_amount(void);
 
+/**
+ * cpu_features_get_fast_core_mask:
+ *
+ * Finds the fastest cores of a CPU with cores of different
+ * speed, such as ARM big.LITTLE or hybrid x86 designs.
+ *
+ * Returns: mask of the fastest cores, bit N being core N.
+ * 0 if all cores are alike or the topology is unknown.
+ **/
+uint64_t cpu_features_get_fast_core_mask(void);
+
 void cpu_features_get_model_name(char *name, int len);
 
 RETRO_END_DECLS
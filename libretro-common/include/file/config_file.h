@@ -55,11 +55,17 @@ struct config_file
 {
    char *path;
    char *reference;
+   /* Open addressing hash table of 'entries_map_cap'
+    * slots (a power of two), indexed by key hash */
    struct config_entry_list **entries_map;
    struct config_entry_list *entries;
    struct config_entry_list *tail;
    struct config_entry_list *last;
    struct config_include_list *includes;
+   /* Storage for entries and their strings */
+   struct config_file_block *blocks;
+   size_t entries_map_cap;
+   size_t entries_map_len;
    unsigned include_depth;
    bool guaranteed_no_duplicates;
    bool modified;
@@ -98,9 +104,7 @@ void config_file_initialize(struct config_file *conf);
 config_file_t *config_file_new_with_callback(const char *path, config_file_cb_t *cb);
 
 /* Load a config file from a string.
- * > WARNING: This will modify 'from_string'.
- *   Pass a copy of source string if original
- *   contents must be preserved */
+ * > 'from_string' is copied and left untouched */
 config_file_t *config_file_new_from_string(char *from_string,
       const char *path);
 
@@ -127,9 +131,15 @@ struct config_entry_list
    char *key;
    char *value;
    struct config_entry_list *next;
+   uint32_t hash;
    /* If we got this from an #include,
     * do not allow overwrite. */
    bool readonly;
+   /* Entries, keys and values live in the blocks of
+    * the owning config file. Only values replaced by
+    * config_set_string() may be malloc()-ed, in which
+    * case this is set */
+   bool value_allocated;
 };
 
 
@@ -531,6 +531,18 @@ bool path_is_valid(const char *path);
 
 int32_t path_get_size(const char *path);
 
+/**
+ * path_get_mtime:
+ * @path               : path
+ * @mtime              : set to the last modification time of @path,
+ *                       in seconds.
+ *
+ * Returns: true on success, false if @path doesn't exist or if
+ * modification times are unavailable (unsupported platform, or
+ * a frontend VFS interface in use).
+ */
+bool path_get_mtime(const char *path, int64_t *mtime);
+
 bool is_path_accessible_using_standard_io(const char *path);
 
 RETRO_END_DECLS
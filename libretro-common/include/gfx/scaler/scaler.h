@@ -62,9 +62,9 @@ struct scaler_filter
 struct scaler_ctx
 {
    void (*scaler_horiz)(const struct scaler_ctx*,
-         const void*, int);
+         const void*, int, int, int);
    void (*scaler_vert)(const struct scaler_ctx*,
-         void*, int);
+         void*, int, int, int);
    void (*scaler_special)(const struct scaler_ctx*,
          void*, const void*, int, int, int, int, int, int);
 
@@ -73,6 +73,12 @@ struct scaler_ctx
    void (*direct_pixconv)(void*, const void*, int, int, int, int);
    struct scaler_filter horiz, vert;   /* ptr alignment */
 
+   /* Slice state for threaded scaling, owned by the context.
+    * Created by scaler_ctx_gen_filter() when threads > 1;
+    * slices run on tpool_shared() if set up, else on a
+    * thread pool of the context's own. */
+   struct scaler_thread_pool *pool;
+
    struct
    {
       uint32_t *frame;
@@ -105,6 +111,10 @@ struct scaler_ctx
    enum scaler_pix_fmt out_fmt;
    enum scaler_type scaler_type;
 
+   /* Number of horizontal slices a frame is split into when
+    * filtering. 0 or 1 scales on the calling thread only. */
+   unsigned threads;
+
    bool unscaled;
 };
 
@@ -94,6 +94,21 @@ void dir_list_free(struct string_list *list);
 
 bool dir_list_deinitialize(struct string_list *list);
 
+/**
+ * dir_list_cache_init:
+ *
+ * Starts caching non-recursive directory listings. A cached
+ * listing is used again for as long as the modification time
+ * of its directory stays the same, on platforms where
+ * retro_dirent_get_mtime() is available.
+ *
+ * Must be called before any thread lists directories.
+ **/
+void dir_list_cache_init(void);
+
+/* Must be called upon program termination */
+void dir_list_cache_deinit(void);
+
 RETRO_END_DECLS
 
 #endif
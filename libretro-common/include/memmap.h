@@ -49,4 +49,33 @@ int memsync(void *start, void *end);
 
 int memprotect(void *addr, size_t len);
 
+/* Flags for memmap_alloc_large() */
+enum memmap_large_flags
+{
+   /* Touch every page up front, so that using the
+    * buffer later never page faults */
+   MEMMAP_LARGE_PREFAULT = (1 << 0),
+   /* Keep the pages resident (mlock/VirtualLock) */
+   MEMMAP_LARGE_LOCK     = (1 << 1)
+};
+
+/**
+ * memmap_alloc_large:
+ * @len                : size of the buffer.
+ * @flags              : mask of enum memmap_large_flags.
+ *
+ * Allocates a buffer for large data that gets touched often.
+ * It is backed by huge pages where the OS makes them
+ * available (MAP_HUGETLB or transparent huge pages on Linux,
+ * large pages on Windows), which spares TLB misses; otherwise
+ * it is plain page-aligned memory. Locking that the OS refuses
+ * is silently skipped.
+ *
+ * Returns: the buffer, to be freed with memmap_free_large(),
+ * or NULL on failure.
+ **/
+void *memmap_alloc_large(size_t len, unsigned flags);
+
+void memmap_free_large(void *ptr);
+
 #endif
@@ -34,6 +34,12 @@ RETRO_BEGIN_DECLS
 struct http_t;
 struct http_connection_t;
 
+/* Receives a successful (20x) response body piece
+ * by piece, as it arrives. Returning false aborts
+ * the transfer. */
+typedef bool (*net_http_sink_t)(void *userdata,
+      const uint8_t *data, size_t len);
+
 struct http_connection_t *net_http_connection_new(const char *url, const char *method, const char *data);
 
 bool net_http_connection_iterate(struct http_connection_t *conn);
@@ -50,6 +56,13 @@ const char* net_http_connection_method(struct http_connection_t* conn);
 
 struct http_t *net_http_new(struct http_connection_t *conn);
 
+/* Hands the response body to 'sink' instead of keeping
+ * it in memory, so that net_http_data() returns nothing
+ * for a successful transfer. To be set up before the
+ * first net_http_update(). Error bodies are kept as usual. */
+void net_http_set_sink(struct http_t *state,
+      net_http_sink_t sink, void *userdata);
+
 /* You can use this to call net_http_update
  * only when something will happen; select() it for reading. */
 int net_http_fd(struct http_t *state);
@@ -0,0 +1,101 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (mpsc_queue.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_SDK_MPSC_QUEUE_H
+#define __LIBRETRO_SDK_MPSC_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <retro_common_api.h>
+#include <retro_atomic.h>
+#include <boolean.h>
+
+#if !RETRO_ATOMIC_LOCK_FREE && defined(HAVE_THREADS)
+#include <rthreads/rthreads.h>
+#endif
+
+RETRO_BEGIN_DECLS
+
+/* Bounded queue of fixed-size records, filled by any
+ * number of producer threads and emptied by exactly
+ * one consumer thread, without a lock.
+ *
+ * Every slot carries a sequence number telling
+ * whether it is free for the producer that claimed
+ * that position or holds a record for the consumer.
+ * Producers only contend on claiming a position, and
+ * never wait on each other or on the consumer: a push
+ * to a full queue fails instead.
+ *
+ * On targets without atomics (RETRO_ATOMIC_LOCK_FREE
+ * is 0) the queue falls back to an internal lock. */
+
+#define MPSC_QUEUE_CACHE_LINE 64
+
+struct mpsc_queue
+{
+   uint8_t *records;
+   retro_atomic_int_t *sequences;
+   size_t record_size;
+   unsigned capacity;
+#if !RETRO_ATOMIC_LOCK_FREE && defined(HAVE_THREADS)
+   slock_t *lock;
+#endif
+   char pad0[MPSC_QUEUE_CACHE_LINE];
+   /* Claimed by the producers */
+   retro_atomic_int_t tail;
+   char pad1[MPSC_QUEUE_CACHE_LINE - sizeof(retro_atomic_int_t)];
+   /* Advanced by the consumer only */
+   unsigned head;
+   char pad2[MPSC_QUEUE_CACHE_LINE - sizeof(unsigned)];
+};
+
+typedef struct mpsc_queue mpsc_queue_t;
+
+/* Allocates room for 'capacity' records of
+ * 'record_size' bytes each
+ * > 'capacity' is rounded up to a power of two */
+bool mpsc_queue_initialize(mpsc_queue_t *queue,
+      size_t record_size, unsigned capacity);
+
+void mpsc_queue_deinitialize(mpsc_queue_t *queue);
+
+mpsc_queue_t *mpsc_queue_new(size_t record_size, unsigned capacity);
+
+void mpsc_queue_free(mpsc_queue_t *queue);
+
+/* Producer side, safe from any thread. Copies
+ * 'record_size' bytes from 'record' into the queue.
+ * Returns false if the queue is full */
+bool mpsc_queue_push(mpsc_queue_t *queue, const void *record);
+
+/* Consumer side. Copies the oldest record into
+ * 'record' and returns true, or returns false when
+ * there is nothing (yet) to read. A record whose
+ * producer is still writing it holds back the ones
+ * behind it until the next call */
+bool mpsc_queue_pop(mpsc_queue_t *queue, void *record);
+
+RETRO_END_DECLS
+
+#endif
@@ -0,0 +1,105 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (spsc_ring.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_SDK_SPSC_RING_H
+#define __LIBRETRO_SDK_SPSC_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <retro_common_api.h>
+#include <retro_atomic.h>
+#include <boolean.h>
+
+#if !RETRO_ATOMIC_LOCK_FREE && defined(HAVE_THREADS)
+#include <rthreads/rthreads.h>
+#endif
+
+RETRO_BEGIN_DECLS
+
+/* Byte ring buffer shared by exactly one producer
+ * thread and one consumer thread, without a lock.
+ *
+ * Each side only ever advances its own position,
+ * and both positions live on their own cache line,
+ * so that neither side invalidates the line the
+ * other one writes. All of spsc_ring_write_avail(),
+ * spsc_ring_read_avail(), spsc_ring_write() and
+ * spsc_ring_read() are wait-free.
+ *
+ * On targets without atomics (RETRO_ATOMIC_LOCK_FREE
+ * is 0) the ring falls back to an internal lock. */
+
+#define SPSC_RING_CACHE_LINE 64
+
+struct spsc_ring
+{
+   uint8_t *buffer;
+   size_t size;
+#if !RETRO_ATOMIC_LOCK_FREE && defined(HAVE_THREADS)
+   slock_t *lock;
+#endif
+   char pad0[SPSC_RING_CACHE_LINE];
+   /* Written by the producer only */
+   retro_atomic_int_t end;
+   char pad1[SPSC_RING_CACHE_LINE - sizeof(retro_atomic_int_t)];
+   /* Written by the consumer only */
+   retro_atomic_int_t first;
+   char pad2[SPSC_RING_CACHE_LINE - sizeof(retro_atomic_int_t)];
+};
+
+typedef struct spsc_ring spsc_ring_t;
+
+/* Allocates room for 'size' bytes
+ * > 'size' must be less than INT_MAX */
+bool spsc_ring_initialize(spsc_ring_t *ring, size_t size);
+
+void spsc_ring_deinitialize(spsc_ring_t *ring);
+
+spsc_ring_t *spsc_ring_new(size_t size);
+
+void spsc_ring_free(spsc_ring_t *ring);
+
+/* Empties the ring
+ * > Only safe while neither side is using it */
+void spsc_ring_clear(spsc_ring_t *ring);
+
+/* May be called from either side. The result is
+ * a lower bound, since the other side may have
+ * made room or added data since */
+size_t spsc_ring_read_avail(spsc_ring_t *ring);
+
+size_t spsc_ring_write_avail(spsc_ring_t *ring);
+
+/* Producer side. Writes as much of 'in_buf' as fits,
+ * and returns the number of bytes written */
+size_t spsc_ring_write(spsc_ring_t *ring,
+      const void *in_buf, size_t size);
+
+/* Consumer side. Reads up to 'size' bytes into
+ * 'out_buf', and returns the number of bytes read */
+size_t spsc_ring_read(spsc_ring_t *ring,
+      void *out_buf, size_t size);
+
+RETRO_END_DECLS
+
+#endif
@@ -44,6 +44,27 @@ enum task_type
    TASK_TYPE_BLOCKING
 };
 
+/* The threaded task queue runs the highest priority
+ * task first, and round-robins between tasks of
+ * the same priority. */
+enum task_priority
+{
+   TASK_PRIORITY_LOW = 0,
+   TASK_PRIORITY_NORMAL,
+   /* Something the user is waiting for */
+   TASK_PRIORITY_HIGH
+};
+
+/* What a task mostly waits on. Workers prefer tasks
+ * of their own class, but run the other class instead
+ * of idling. */
+enum task_affinity
+{
+   TASK_AFFINITY_CPU = 0,
+   /* File or network I/O */
+   TASK_AFFINITY_IO
+};
+
 typedef struct retro_task retro_task_t;
 typedef void (*retro_task_callback_t)(retro_task_t *task,
       void *task_data,
@@ -62,6 +83,10 @@ typedef bool (*retro_task_retriever_t)(retro_task_t *task, void *data);
 
 typedef bool (*retro_task_condition_fn_t)(void *data);
 
+/* Called right before and right after each run
+ * of a task handler, on the thread running it */
+typedef void (*retro_task_trace_t)(retro_task_t *task, bool begin);
+
 typedef struct
 {
    char *source_file;
@@ -115,6 +140,10 @@ struct retro_task
 
    enum task_type type;
 
+   enum task_priority priority;
+
+   enum task_affinity affinity;
+
    /* if set to true, frontend will
    use an alternative look for the
    task progress display */
@@ -130,6 +159,17 @@ struct retro_task
 
    /* if true no OSD messages will be displayed. */
    bool mute;
+
+   /* if true, the handler keeps no state shared
+    * with other tasks and touches no files other
+    * tasks write, so the threaded task queue may run
+    * it alongside other tasks. Tasks without it run
+    * one at a time. */
+   bool concurrent;
+
+   /* don't touch this. set while a worker thread
+    * is running the handler. */
+   bool worker_busy;
 };
 
 typedef struct task_finder_data
@@ -252,6 +292,17 @@ void task_queue_deinit(void);
  * This must only be called from the main thread. */
 void task_queue_init(bool threaded, retro_task_queue_msg_t msg_push);
 
+/* Sets a callback for profilers, invoked around
+ * every task handler run. NULL removes it. */
+void task_queue_set_trace(retro_task_trace_t trace);
+
+/* Limits the time task_queue_check() spends on callbacks
+ * of finished tasks. Once it is used up, only callbacks of
+ * TASK_PRIORITY_HIGH tasks still run, the others are put off
+ * to the next check. 0 (the default) runs them all.
+ * task_queue_wait() always runs them all. */
+void task_queue_set_callback_budget(retro_time_t usec);
+
 /* Allocates and inits a new retro_task_t */
 retro_task_t *task_init(void);
 
@@ -0,0 +1,178 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (retro_atomic.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_SDK_ATOMIC_H
+#define __LIBRETRO_SDK_ATOMIC_H
+
+#include <boolean.h>
+#include <retro_inline.h>
+
+/* Minimal set of sequentially consistent atomic operations
+ * on a single int-sized value.
+ *
+ * RETRO_ATOMIC_LOCK_FREE is defined to 1 when the operations
+ * below are real atomics. When it is 0, they degrade to plain
+ * volatile accesses which are only safe when both sides run on
+ * the same thread - callers must then fall back to a lock. */
+
+#if defined(__GNUC__) && ((__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)) || defined(__clang__)
+
+#define RETRO_ATOMIC_LOCK_FREE 1
+typedef volatile int retro_atomic_int_t;
+
+static INLINE int retro_atomic_load(retro_atomic_int_t *a)
+{
+   return __atomic_load_n(a, __ATOMIC_SEQ_CST);
+}
+
+static INLINE void retro_atomic_store(retro_atomic_int_t *a, int v)
+{
+   __atomic_store_n(a, v, __ATOMIC_SEQ_CST);
+}
+
+static INLINE int retro_atomic_exchange(retro_atomic_int_t *a, int v)
+{
+   return __atomic_exchange_n(a, v, __ATOMIC_SEQ_CST);
+}
+
+static INLINE int retro_atomic_fetch_add(retro_atomic_int_t *a, int v)
+{
+   return __atomic_fetch_add(a, v, __ATOMIC_SEQ_CST);
+}
+
+static INLINE bool retro_atomic_cas(retro_atomic_int_t *a,
+      int expected, int desired)
+{
+   return __atomic_compare_exchange_n(a, &expected, desired, false,
+         __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+#elif defined(__GNUC__) && ((__GNUC__ == 4 && __GNUC_MINOR__ >= 1))
+
+#define RETRO_ATOMIC_LOCK_FREE 1
+typedef volatile int retro_atomic_int_t;
+
+static INLINE int retro_atomic_load(retro_atomic_int_t *a)
+{
+   return __sync_fetch_and_add(a, 0);
+}
+
+static INLINE int retro_atomic_exchange(retro_atomic_int_t *a, int v)
+{
+   int old;
+   do
+   {
+      old = *a;
+   } while (!__sync_bool_compare_and_swap(a, old, v));
+   return old;
+}
+
+static INLINE void retro_atomic_store(retro_atomic_int_t *a, int v)
+{
+   retro_atomic_exchange(a, v);
+}
+
+static INLINE int retro_atomic_fetch_add(retro_atomic_int_t *a, int v)
+{
+   return __sync_fetch_and_add(a, v);
+}
+
+static INLINE bool retro_atomic_cas(retro_atomic_int_t *a,
+      int expected, int desired)
+{
+   return __sync_bool_compare_and_swap(a, expected, desired);
+}
+
+#elif defined(_MSC_VER) && !defined(_XBOX)
+
+#include <intrin.h>
+
+#define RETRO_ATOMIC_LOCK_FREE 1
+typedef volatile long retro_atomic_int_t;
+
+static INLINE int retro_atomic_load(retro_atomic_int_t *a)
+{
+   return (int)_InterlockedCompareExchange(a, 0, 0);
+}
+
+static INLINE void retro_atomic_store(retro_atomic_int_t *a, int v)
+{
+   _InterlockedExchange(a, v);
+}
+
+static INLINE int retro_atomic_exchange(retro_atomic_int_t *a, int v)
+{
+   return (int)_InterlockedExchange(a, v);
+}
+
+static INLINE int retro_atomic_fetch_add(retro_atomic_int_t *a, int v)
+{
+   return (int)_InterlockedExchangeAdd(a, v);
+}
+
+static INLINE bool retro_atomic_cas(retro_atomic_int_t *a,
+      int expected, int desired)
+{
+   return _InterlockedCompareExchange(a, desired, expected) == expected;
+}
+
+#else
+
+#define RETRO_ATOMIC_LOCK_FREE 0
+typedef volatile int retro_atomic_int_t;
+
+static INLINE int retro_atomic_load(retro_atomic_int_t *a)
+{
+   return *a;
+}
+
+static INLINE void retro_atomic_store(retro_atomic_int_t *a, int v)
+{
+   *a = v;
+}
+
+static INLINE int retro_atomic_exchange(retro_atomic_int_t *a, int v)
+{
+   int old = *a;
+   *a      = v;
+   return old;
+}
+
+static INLINE int retro_atomic_fetch_add(retro_atomic_int_t *a, int v)
+{
+   int old = *a;
+   *a      = old + v;
+   return old;
+}
+
+static INLINE bool retro_atomic_cas(retro_atomic_int_t *a,
+      int expected, int desired)
+{
+   if (*a != expected)
+      return false;
+   *a = desired;
+   return true;
+}
+
+#endif
+
+#endif
@@ -26,6 +26,7 @@
 #include <libretro.h>
 #include <retro_common_api.h>
 
+#include <stdint.h>
 #include <boolean.h>
 
 RETRO_BEGIN_DECLS
@@ -72,6 +73,21 @@ bool retro_dirent_is_dir(struct RDIR *rdir, const char *unused);
 
 void retro_closedir(struct RDIR *rdir);
 
+/**
+ *
+ * retro_dirent_get_mtime:
+ * @name         : path to the directory.
+ * @mtime        : set to the last modification time of the directory,
+ *                 in nanoseconds.
+ *
+ * Only available where a directory is guaranteed to be modified
+ * whenever an entry is added to, removed from or renamed in it,
+ * and when no frontend VFS interface is in use.
+ *
+ * Returns: true on success, false if unavailable.
+ */
+bool retro_dirent_get_mtime(const char *name, int64_t *mtime);
+
 RETRO_END_DECLS
 
 #endif
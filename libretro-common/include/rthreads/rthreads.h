@@ -103,6 +103,55 @@ void sthread_join(sthread_t *thread);
  */
 bool sthread_isself(sthread_t *thread);
 
+/* What a thread is used for. Each role has a profile
+ * (CPU mask and priority class) that a thread takes on
+ * with sthread_set_role(). */
+enum sthread_role
+{
+   STHREAD_ROLE_MAIN = 0,
+   STHREAD_ROLE_VIDEO,
+   STHREAD_ROLE_AUDIO,
+   STHREAD_ROLE_WORKER,
+   STHREAD_ROLE_LAST
+};
+
+enum sthread_priority_class
+{
+   STHREAD_PRIORITY_DEFAULT = 0,
+   STHREAD_PRIORITY_LOW,
+   STHREAD_PRIORITY_HIGH,
+   /* SCHED_FIFO on Linux, MMCSS on Windows, user-interactive
+    * QoS on Apple platforms. Falls back to HIGH where the
+    * process isn't allowed to use it. */
+   STHREAD_PRIORITY_REALTIME
+};
+
+/**
+ * sthread_set_role_profile:
+ * @role                    : thread role
+ * @cpu_mask                : CPUs the threads may run on, bit N
+ *                            being CPU N. 0 means no restriction.
+ * @priority                : priority class of the threads
+ *
+ * Sets the profile that sthread_set_role() applies for @role.
+ * Threads that already took on @role keep the old profile
+ * until they call sthread_set_role() again.
+ */
+void sthread_set_role_profile(enum sthread_role role,
+      uint64_t cpu_mask, enum sthread_priority_class priority);
+
+/**
+ * sthread_set_role:
+ * @role                    : thread role
+ *
+ * Applies the profile of @role to the calling thread.
+ * Parts of the profile the platform doesn't support
+ * are ignored.
+ *
+ * Returns: true if the whole profile could be applied.
+ */
+bool sthread_set_role(enum sthread_role role);
+
 /**
  * slock_new:
  *
@@ -48,6 +48,15 @@ typedef struct tpool tpool_t;
  **/
 typedef void (*thread_func_t)(void *arg);
 
+/**
+ * (*tpool_batch_func_t):
+ * @userdata      : Argument passed to tpool_run_batch().
+ * @index         : Index of the job, from 0 to count - 1.
+ *
+ * Callback function the pool will call for each job of a batch.
+ **/
+typedef void (*tpool_batch_func_t)(void *userdata, unsigned index);
+
 /**
  * tpool_create:
  * @num           : Number of threads the pool should have.
@@ -91,6 +100,57 @@ bool tpool_add_work(tpool_t *tp, thread_func_t func, void *arg);
  */
 void tpool_wait(tpool_t *tp);
 
+/**
+ * tpool_run_batch:
+ * @tp         : Thread pool, or NULL to run all jobs on the
+ *               calling thread.
+ * @func       : Function the pool should call for each job.
+ * @userdata   : Argument to pass to func.
+ * @count      : Number of jobs.
+ *
+ * Calls func for every index from 0 to count - 1. The jobs are
+ * handed out in order to the pool's threads and the calling
+ * thread, whichever is free first, so jobs of uneven cost still
+ * keep every thread busy. Returns once all jobs have completed.
+ *
+ * Unlike tpool_wait(), this only waits for the jobs of this
+ * batch, so other work and other batches may share the pool.
+ * The pool must not be destroyed while a batch is running.
+ */
+void tpool_run_batch(tpool_t *tp, tpool_batch_func_t func,
+      void *userdata, unsigned count);
+
+/**
+ * tpool_shared_init:
+ * @num        : Number of threads of the shared pool, 0 to
+ *               leave it disabled.
+ *
+ * Enables the pool returned by tpool_shared(). Its threads are
+ * only started on first use.
+ *
+ * Must be called before any thread calls tpool_shared().
+ */
+void tpool_shared_init(size_t num);
+
+/**
+ * tpool_shared_deinit:
+ *
+ * Destroys the shared pool. No batch may be running on it.
+ */
+void tpool_shared_deinit(void);
+
+/**
+ * tpool_shared:
+ *
+ * Gets the pool shared by code that runs short batches now and
+ * then (image encoding, stream compression, ...), so they don't
+ * start threads of their own on every call.
+ *
+ * Returns: the shared pool, or NULL if tpool_shared_init() was
+ * not called - tpool_run_batch() then runs the jobs in turn.
+ */
+tpool_t *tpool_shared(void);
+
 RETRO_END_DECLS
 
 #endif
@@ -0,0 +1,61 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (inflate_buffer.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef LIBRETRO_SDK_INFLATE_BUFFER_H__
+#define LIBRETRO_SDK_INFLATE_BUFFER_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <boolean.h>
+
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/**
+ * inflate_buffer:
+ * @in                 : compressed data.
+ * @in_size            : size of @in.
+ * @out                : output buffer.
+ * @out_size           : size of @out.
+ * @window_bits        : as for zlib's inflateInit2(); negative for a
+ *                       raw deflate stream, 8..15 for a zlib stream.
+ * @in_used            : (optional) set to the number of bytes of @in
+ *                       the stream took up.
+ * @out_used           : set to the number of bytes written to @out.
+ *
+ * Decompresses a complete stream in one go. As the whole output
+ * is in memory there is no sliding window to maintain, which makes
+ * this a good deal faster than zlib's streaming inflate().
+ *
+ * Returns: true on success, false if the data is invalid or
+ * truncated, if @out is too small or if @window_bits asks for
+ * a format that isn't handled here (gzip). The caller can fall
+ * back to zlib in that case.
+ **/
+bool inflate_buffer(const uint8_t *in, size_t in_size,
+      uint8_t *out, size_t out_size, int window_bits,
+      size_t *in_used, size_t *out_used);
+
+RETRO_END_DECLS
+
+#endif
@@ -39,9 +39,12 @@ typedef void* HANDLE;
 #endif
 
 #ifdef HAVE_CDROM
+struct vfs_cdrom_cache;
+
 typedef struct
 {
    int64_t byte_pos;
+   struct vfs_cdrom_cache *cache; /* sector cache of a track */
    char *cue_buf;
    size_t cue_len;
    unsigned cur_lba;
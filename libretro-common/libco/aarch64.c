@@ -22,37 +22,51 @@ extern "C" {
 static thread_local uint64_t co_active_buffer[64];
 static thread_local cothread_t co_active_handle;
 
+/* Only what AAPCS64 has the callee preserve is switched:
+ * x19-x28, the frame pointer, the link register, sp and
+ * the low halves of v8-v15. Layout of a context:
+ *
+ *    0  x19 x20 x21 x22 x23 x24 x25 x26 x27 x28
+ *   80  x29 sp
+ *   96  x30 (resume address) padding
+ *  112  d8 d9 d10 d11 d12 d13 d14 d15
+ */
 asm (
       ".globl co_switch_aarch64\n"
       ".globl _co_switch_aarch64\n"
       "co_switch_aarch64:\n"
       "_co_switch_aarch64:\n"
-      "  stp x8,  x9,  [x1]\n"
-      "  stp x10, x11, [x1, #16]\n"
-      "  stp x12, x13, [x1, #32]\n"
-      "  stp x14, x15, [x1, #48]\n"
-      "  str x19, [x1, #72]\n"
-      "  stp x20, x21, [x1, #80]\n"
-      "  stp x22, x23, [x1, #96]\n"
-      "  stp x24, x25, [x1, #112]\n"
-      "  stp x26, x27, [x1, #128]\n"
-      "  stp x28, x29, [x1, #144]\n"
+#if defined(__ARM_FEATURE_BTI_DEFAULT)
+      "  bti c\n"
+#endif
       "  mov x16, sp\n"
-      "  stp x16, x30, [x1, #160]\n"
+      "  stp x19, x20, [x1]\n"
+      "  stp x21, x22, [x1, #16]\n"
+      "  stp x23, x24, [x1, #32]\n"
+      "  stp x25, x26, [x1, #48]\n"
+      "  stp x27, x28, [x1, #64]\n"
+      "  stp x29, x16, [x1, #80]\n"
+      "  str x30, [x1, #96]\n"
+      "  stp d8,  d9,  [x1, #112]\n"
+      "  stp d10, d11, [x1, #128]\n"
+      "  stp d12, d13, [x1, #144]\n"
+      "  stp d14, d15, [x1, #160]\n"
 
-      "  ldp x8,  x9,  [x0]\n"
-      "  ldp x10, x11, [x0, #16]\n"
-      "  ldp x12, x13, [x0, #32]\n"
-      "  ldp x14, x15, [x0, #48]\n"
-      "  ldr x19, [x0, #72]\n"
-      "  ldp x20, x21, [x0, #80]\n"
-      "  ldp x22, x23, [x0, #96]\n"
-      "  ldp x24, x25, [x0, #112]\n"
-      "  ldp x26, x27, [x0, #128]\n"
-      "  ldp x28, x29, [x0, #144]\n"
-      "  ldp x16, x17, [x0, #160]\n"
+      "  ldp x19, x20, [x0]\n"
+      "  ldp x21, x22, [x0, #16]\n"
+      "  ldp x23, x24, [x0, #32]\n"
+      "  ldp x25, x26, [x0, #48]\n"
+      "  ldp x27, x28, [x0, #64]\n"
+      "  ldp x29, x16, [x0, #80]\n"
+      "  ldr x17, [x0, #96]\n"
+      "  ldp d8,  d9,  [x0, #112]\n"
+      "  ldp d10, d11, [x0, #128]\n"
+      "  ldp d12, d13, [x0, #144]\n"
+      "  ldp d14, d15, [x0, #160]\n"
       "  mov sp, x16\n"
-      "  br x17\n"
+      /* ret rather than br, so that no BTI landing pad
+       * is needed where execution resumes */
+      "  ret x17\n"
     );
 
 /* ASM */
@@ -79,29 +93,11 @@ cothread_t co_create(unsigned int size, void (*entrypoint)(void))
       return handle;
 
    uint64_t *ptr = (uint64_t*)handle;
-   /* Non-volatiles.  */
-   ptr[0]  = 0; /* x8  */
-   ptr[1]  = 0; /* x9  */
-   ptr[2]  = 0; /* x10 */
-   ptr[3]  = 0; /* x11 */
-   ptr[4]  = 0; /* x12 */
-   ptr[5]  = 0; /* x13 */
-   ptr[6]  = 0; /* x14 */
-   ptr[7]  = 0; /* x15 */
-   ptr[8]  = 0; /* padding */
-   ptr[9]  = 0; /* x19 */
-   ptr[10] = 0; /* x20 */
-   ptr[11] = 0; /* x21 */
-   ptr[12] = 0; /* x22 */
-   ptr[13] = 0; /* x23 */
-   ptr[14] = 0; /* x24 */
-   ptr[15] = 0; /* x25 */
-   ptr[16] = 0; /* x26 */
-   ptr[17] = 0; /* x27 */
-   ptr[18] = 0; /* x28 */
-   ptr[20] = (uintptr_t)ptr + size + 512 - 16; /* x30, stack pointer */
-   ptr[19] = ptr[20]; /* x29, frame pointer */
-   ptr[21] = (uintptr_t)entrypoint; /* PC (link register x31 gets saved here). */
+   /* Callee-saved registers start out zeroed */
+   memset(ptr, 0, 22 * sizeof(uint64_t));
+   ptr[11] = (uintptr_t)ptr + size + 512 - 16; /* stack pointer */
+   ptr[10] = ptr[11]; /* x29, frame pointer */
+   ptr[12] = (uintptr_t)entrypoint; /* resume address, x30 */
    return handle;
 }
 
@@ -127,6 +127,19 @@ static void crash(void)
   assert(0); /* called only if cothread_t entrypoint returns */
 }
 
+#if defined(__CET__) && (__CET__ & 2) && !defined(_WIN32)
+/* Switching stacks with a plain ret, as co_switch does,
+ * faults once the shadow stack is in use, so cothreads
+ * can't be created then. rdsspq leaves the register alone
+ * where shadow stacks are off or not supported. */
+static int co_shadow_stack_active(void)
+{
+   unsigned long long ssp = 0;
+   __asm__ __volatile__("rdsspq %0" : "+r"(ssp));
+   return ssp != 0;
+}
+#endif
+
 cothread_t co_active(void)
 {
   if (!co_active_handle)
@@ -146,6 +159,11 @@ cothread_t co_create(unsigned int size, void (*entrypoint)(void))
    }
 #endif
 
+#if defined(__CET__) && (__CET__ & 2) && !defined(_WIN32)
+   if (co_shadow_stack_active())
+      return 0;
+#endif
+
    if (!co_active_handle)
       co_active_handle = &co_active_buffer;
    size += 512; /* allocate additional space for storage */
@@ -197,6 +215,11 @@ __asm__(
 ".intel_syntax noprefix         \n"
 ".globl " ASM_PREFIX "co_switch              \n"
 ASM_PREFIX "co_switch:                     \n"
+#if defined(__CET__) && (__CET__ & 1)
+/* Landing pad for indirect calls, e.g. through the PLT,
+ * when the core is built with IBT enabled */
+"endbr64                        \n"
+#endif
 "mov rsi, [rip+" ASM_PREFIX "co_active_handle]\n"
 "mov [rsi],rsp                  \n"
 "mov [rsi+0x08],rbp             \n"
@@ -21,6 +21,8 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 #if defined(_WIN32) && defined(_XBOX)
 #include <xtl.h>
@@ -38,6 +40,36 @@
 #include <string/stdstring.h>
 #include <retro_miscellaneous.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+/* Non-recursive listings of directories that have not
+ * changed since are served from here, since reading
+ * big directories (e.g. on network shares) is slow */
+#define DIR_LIST_CACHE_SIZE 8
+/* Directories modified less than this many seconds ago
+ * are not cached - a file system may only keep coarse
+ * timestamps, so a change made right after the listing
+ * could leave the modification time as it is */
+#define DIR_LIST_CACHE_MIN_AGE 2
+
+typedef struct dir_list_cache_entry
+{
+   struct string_list list;
+   char *key;
+   int64_t mtime;
+   unsigned last_used;
+} dir_list_cache_entry_t;
+
+/* TODO/FIXME - static globals */
+static dir_list_cache_entry_t dir_list_cache[DIR_LIST_CACHE_SIZE];
+static unsigned dir_list_cache_clock = 0;
+static bool dir_list_cache_enabled   = false;
+#ifdef HAVE_THREADS
+static slock_t *dir_list_cache_lock  = NULL;
+#endif
+
 static int qstrcmp_plain(const void *a_, const void *b_)
 {
    const struct string_list_elem *a = (const struct string_list_elem*)a_;
@@ -93,6 +125,183 @@ bool dir_list_deinitialize(struct string_list *list)
    return string_list_deinitialize(list);
 }
 
+static void dir_list_cache_entry_free(dir_list_cache_entry_t *entry)
+{
+   if (entry->key)
+      string_list_deinitialize(&entry->list);
+   free(entry->key);
+   entry->key       = NULL;
+   entry->mtime     = 0;
+   entry->last_used = 0;
+}
+
+/* Must be called before directory listings get cached */
+void dir_list_cache_init(void)
+{
+   dir_list_cache_deinit();
+#ifdef HAVE_THREADS
+   if (!(dir_list_cache_lock = slock_new()))
+      return;
+#endif
+   dir_list_cache_enabled = true;
+}
+
+void dir_list_cache_deinit(void)
+{
+   size_t i;
+
+   dir_list_cache_enabled = false;
+
+   for (i = 0; i < DIR_LIST_CACHE_SIZE; i++)
+      dir_list_cache_entry_free(&dir_list_cache[i]);
+   dir_list_cache_clock   = 0;
+
+#ifdef HAVE_THREADS
+   if (dir_list_cache_lock)
+      slock_free(dir_list_cache_lock);
+   dir_list_cache_lock    = NULL;
+#endif
+}
+
+/* Cached listings depend on all of the arguments
+ * of dir_list_append(), other than the list */
+static char *dir_list_cache_key(const char *dir, const char *ext,
+      bool include_dirs, bool include_hidden, bool include_compressed)
+{
+   size_t dir_len = strlen(dir);
+   size_t ext_len = ext ? strlen(ext) : 0;
+   char *key      = (char*)malloc(dir_len + ext_len + 6);
+
+   if (!key)
+      return NULL;
+
+   key[0] = include_dirs       ? '1' : '0';
+   key[1] = include_hidden     ? '1' : '0';
+   key[2] = include_compressed ? '1' : '0';
+   key[3] = ext                ? '1' : '0';
+   memcpy(key + 4, dir, dir_len);
+   key[4 + dir_len] = '\n';
+   if (ext_len)
+      memcpy(key + 5 + dir_len, ext, ext_len);
+   key[5 + dir_len + ext_len] = '\0';
+
+   return key;
+}
+
+/* Appends the cached listing for 'key' to 'list',
+ * if the directory was not modified since */
+static bool dir_list_cache_get(const char *key, int64_t mtime,
+      struct string_list *list)
+{
+   size_t i, j;
+   bool found = false;
+
+#ifdef HAVE_THREADS
+   slock_lock(dir_list_cache_lock);
+#endif
+
+   for (i = 0; i < DIR_LIST_CACHE_SIZE; i++)
+   {
+      dir_list_cache_entry_t *entry = &dir_list_cache[i];
+
+      if (!entry->key || !string_is_equal(entry->key, key))
+         continue;
+
+      if (entry->mtime != mtime)
+      {
+         dir_list_cache_entry_free(entry);
+         break;
+      }
+
+      for (j = 0; j < entry->list.size; j++)
+         if (!string_list_append(list, entry->list.elems[j].data,
+                  entry->list.elems[j].attr))
+            break;
+
+      if (j < entry->list.size)
+      {
+         /* Leave the list as it was */
+         while (list->size > 0 && j-- > 0)
+         {
+            list->size--;
+            free(list->elems[list->size].data);
+            list->elems[list->size].data = NULL;
+         }
+         break;
+      }
+
+      entry->last_used = ++dir_list_cache_clock;
+      found            = true;
+      break;
+   }
+
+#ifdef HAVE_THREADS
+   slock_unlock(dir_list_cache_lock);
+#endif
+
+   return found;
+}
+
+/* Caches the elements of 'list' from 'start' as the
+ * listing for 'key'. 'mtime' must have been taken
+ * before the directory was read */
+static void dir_list_cache_put(const char *key, int64_t mtime,
+      const struct string_list *list, size_t start)
+{
+   size_t i;
+   dir_list_cache_entry_t *slot = NULL;
+
+   if (mtime / 1000000000 + DIR_LIST_CACHE_MIN_AGE
+         > (int64_t)time(NULL))
+      return;
+
+#ifdef HAVE_THREADS
+   slock_lock(dir_list_cache_lock);
+#endif
+
+   /* Replace the same listing or else the least
+    * recently used one */
+   for (i = 0; i < DIR_LIST_CACHE_SIZE; i++)
+   {
+      dir_list_cache_entry_t *entry = &dir_list_cache[i];
+
+      if (entry->key && string_is_equal(entry->key, key))
+      {
+         slot = entry;
+         break;
+      }
+
+      if (!slot || entry->last_used < slot->last_used)
+         slot = entry;
+   }
+
+   dir_list_cache_entry_free(slot);
+
+   if (     (slot->key = strdup(key))
+         && string_list_initialize(&slot->list))
+   {
+      for (i = start; i < list->size; i++)
+         if (!string_list_append(&slot->list, list->elems[i].data,
+                  list->elems[i].attr))
+            break;
+
+      slot->mtime     = mtime;
+      slot->last_used = ++dir_list_cache_clock;
+
+      if (i < list->size)
+         dir_list_cache_entry_free(slot);
+   }
+   else
+   {
+      free(slot->key);
+      slot->key = NULL;
+   }
+
+#ifdef HAVE_THREADS
+   slock_unlock(dir_list_cache_lock);
+#endif
+}
+
 /**
  * dir_list_read:
  * @dir                : directory path.
@@ -217,6 +426,25 @@ bool dir_list_append(struct string_list *list,
    bool ret                         = false;
    struct string_list ext_list      = {0};
    struct string_list *ext_list_ptr = NULL;
+   char *cache_key                  = NULL;
+   int64_t mtime                    = 0;
+   size_t start                     = list->size;
+
+   /* The modification time is taken first, so that
+    * the directory changing while it is read makes
+    * the cached listing stale */
+   if (     dir_list_cache_enabled
+         && !recursive
+         && retro_dirent_get_mtime(dir, &mtime)
+         && (cache_key = dir_list_cache_key(dir, ext,
+               include_dirs, include_hidden, include_compressed)))
+   {
+      if (dir_list_cache_get(cache_key, mtime, list))
+      {
+         free(cache_key);
+         return true;
+      }
+   }
 
    if (ext)
    {
@@ -227,6 +455,14 @@ bool dir_list_append(struct string_list *list,
    ret                            = dir_list_read(dir, list, ext_list_ptr,
          include_dirs, include_hidden, include_compressed, recursive) != -1;
    string_list_deinitialize(&ext_list);
+
+   if (cache_key)
+   {
+      if (ret)
+         dir_list_cache_put(cache_key, mtime, list, start);
+      free(cache_key);
+   }
+
    return ret;
 }
 
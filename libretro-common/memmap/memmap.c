@@ -21,6 +21,7 @@
  */
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <memmap.h>
 
 #ifndef PROT_READ
@@ -161,3 +162,163 @@ int memprotect(void *addr, size_t len)
 {
    return mprotect(addr, len, PROT_READ | PROT_WRITE | PROT_EXEC);
 }
+
+/* Ahead of each large buffer, keeping it cache line aligned */
+#define MEMMAP_LARGE_HEADER_SIZE 64
+#define MEMMAP_HUGE_PAGE_SIZE    (2 * 1024 * 1024)
+#define MEMMAP_PAGE_SIZE         4096
+
+#if defined(HAVE_MMAN) && !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+enum memmap_large_kind
+{
+   MEMMAP_LARGE_HEAP = 0,
+   MEMMAP_LARGE_MMAP,
+   MEMMAP_LARGE_VIRTUAL
+};
+
+struct memmap_large_header
+{
+   size_t map_len;
+   unsigned kind;
+   unsigned locked;
+};
+
+#if defined(_WIN32) && !defined(_XBOX) && !defined(__WINRT__)
+/* Large pages need SeLockMemoryPrivilege, which users
+ * rarely have; VirtualAlloc() fails without it */
+static void *memmap_alloc_large_pages(size_t *len)
+{
+   typedef SIZE_T (WINAPI *large_page_min_fn)(void);
+   large_page_min_fn large_page_min = (large_page_min_fn)GetProcAddress(
+         GetModuleHandleA("kernel32.dll"), "GetLargePageMinimum");
+   size_t page_size                 = large_page_min
+      ? (size_t)large_page_min() : 0;
+   size_t map_len;
+   void *ptr;
+
+   if (!page_size || *len < page_size)
+      return NULL;
+
+   map_len = (*len + page_size - 1) & ~(page_size - 1);
+   ptr     = VirtualAlloc(NULL, map_len,
+         MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+   if (ptr)
+      *len = map_len;
+   return ptr;
+}
+#endif
+
+void *memmap_alloc_large(size_t len, unsigned flags)
+{
+   struct memmap_large_header *header = NULL;
+   size_t map_len                     = len + MEMMAP_LARGE_HEADER_SIZE;
+   unsigned kind                      = MEMMAP_LARGE_HEAP;
+   uint8_t *base                      = NULL;
+
+#if defined(_WIN32) && !defined(_XBOX) && !defined(__WINRT__)
+   if ((base = (uint8_t*)memmap_alloc_large_pages(&map_len)))
+      kind    = MEMMAP_LARGE_VIRTUAL;
+   else if ((base = (uint8_t*)VirtualAlloc(NULL, map_len,
+               MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE)))
+      kind    = MEMMAP_LARGE_VIRTUAL;
+#elif defined(HAVE_MMAN) && defined(MAP_ANONYMOUS)
+#ifdef MAP_HUGETLB
+   /* Only succeeds if the admin reserved huge pages */
+   if (map_len >= MEMMAP_HUGE_PAGE_SIZE)
+   {
+      size_t huge_len = (map_len + MEMMAP_HUGE_PAGE_SIZE - 1)
+         & ~((size_t)MEMMAP_HUGE_PAGE_SIZE - 1);
+      void *ptr       = mmap(NULL, huge_len, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (ptr != MAP_FAILED)
+      {
+         base         = (uint8_t*)ptr;
+         map_len      = huge_len;
+      }
+   }
+#endif
+   if (!base)
+   {
+      void *ptr = mmap(NULL, map_len, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (ptr != MAP_FAILED)
+      {
+         base   = (uint8_t*)ptr;
+#ifdef MADV_HUGEPAGE
+         /* Transparent huge pages, where enabled in 'madvise' mode */
+         if (map_len >= MEMMAP_HUGE_PAGE_SIZE)
+            madvise(ptr, map_len, MADV_HUGEPAGE);
+#endif
+      }
+   }
+   if (base)
+      kind = MEMMAP_LARGE_MMAP;
+#endif
+
+   if (!base && !(base = (uint8_t*)malloc(map_len)))
+      return NULL;
+
+   if (flags & MEMMAP_LARGE_PREFAULT)
+   {
+      size_t i;
+      for (i = 0; i < map_len; i += MEMMAP_PAGE_SIZE)
+         base[i] = 0;
+   }
+
+   header          = (struct memmap_large_header*)base;
+   header->map_len = map_len;
+   header->kind    = kind;
+   header->locked  = 0;
+
+   if (flags & MEMMAP_LARGE_LOCK)
+   {
+#if defined(_WIN32) && !defined(_XBOX) && !defined(__WINRT__)
+      if (kind == MEMMAP_LARGE_VIRTUAL && VirtualLock(base, map_len))
+         header->locked = 1;
+#elif defined(HAVE_MMAN)
+      if (kind == MEMMAP_LARGE_MMAP && mlock(base, map_len) == 0)
+         header->locked = 1;
+#endif
+   }
+
+   return base + MEMMAP_LARGE_HEADER_SIZE;
+}
+
+void memmap_free_large(void *ptr)
+{
+   struct memmap_large_header *header = NULL;
+   uint8_t *base                      = NULL;
+
+   if (!ptr)
+      return;
+
+   base   = (uint8_t*)ptr - MEMMAP_LARGE_HEADER_SIZE;
+   header = (struct memmap_large_header*)base;
+
+   switch (header->kind)
+   {
+#if defined(_WIN32) && !defined(_XBOX) && !defined(__WINRT__)
+      case MEMMAP_LARGE_VIRTUAL:
+         if (header->locked)
+            VirtualUnlock(base, header->map_len);
+         VirtualFree(base, 0, MEM_RELEASE);
+         return;
+#elif defined(HAVE_MMAN)
+      case MEMMAP_LARGE_MMAP:
+         {
+            size_t map_len = header->map_len;
+            if (header->locked)
+               munlock(base, map_len);
+            munmap(base, map_len);
+         }
+         return;
+#endif
+      default:
+         break;
+   }
+
+   free(base);
+}
@@ -35,6 +35,7 @@
 #include <string.h>
 #include <retro_common_api.h>
 #include <retro_miscellaneous.h>
+#include <retro_atomic.h>
 
 enum
 {
@@ -63,16 +64,63 @@ struct http_socket_state_t
 struct http_t
 {
    char *data;
+   /* Kept until the response starts, so that it can be
+    * sent again if a pooled connection turns out dead */
+   char *request;
+   char *domain;
+   net_http_sink_t sink;
+   void *sink_data;
    struct http_socket_state_t sock_state; /* ptr alignment */
    size_t pos;
    size_t len;
    size_t buflen;
+   size_t request_len;
+   /* Body bytes already handed to the sink */
+   size_t sunk;
    int status;
+   int port;
    char part;
    char bodytype;
    bool error;
+   bool reused;
+   bool keep_alive;
 };
 
+struct http_request_t
+{
+   char *data;
+   size_t len;
+   size_t size;
+};
+
+/* Idle HTTP/1.1 connections are kept around, so that
+ * further requests to the same host skip the TCP and
+ * TLS handshakes. Slots are claimed with a compare and
+ * swap, so the pool needs real atomics with threads. */
+#if !defined(HAVE_THREADS) || RETRO_ATOMIC_LOCK_FREE
+#define NET_HTTP_POOL_SIZE 8
+#endif
+
+#ifdef NET_HTTP_POOL_SIZE
+enum
+{
+   POOL_EMPTY = 0,
+   POOL_BUSY,
+   POOL_IDLE
+};
+
+struct http_pool_entry_t
+{
+   struct http_socket_state_t sock_state; /* ptr alignment */
+   char domain[256];
+   int port;
+   retro_atomic_int_t state;
+};
+
+/* TODO/FIXME - static global */
+static struct http_pool_entry_t net_http_pool[NET_HTTP_POOL_SIZE];
+#endif
+
 struct http_connection_t
 {
    char *domain;
@@ -412,16 +460,17 @@ void net_http_urlencode_full(char *dest,
    free (tmp);
 }
 
-static int net_http_new_socket(struct http_connection_t *conn)
+static int net_http_new_socket(struct http_socket_state_t *sock_state,
+      const char *domain, int port)
 {
    int ret;
    struct addrinfo *addr = NULL, *next_addr = NULL;
    int fd                = socket_init(
-         (void**)&addr, conn->port, conn->domain, SOCKET_TYPE_STREAM);
+         (void**)&addr, port, domain, SOCKET_TYPE_STREAM);
 #ifdef HAVE_SSL
-   if (conn->sock_state.ssl)
+   if (sock_state->ssl)
    {
-      if (!(conn->sock_state.ssl_ctx = ssl_socket_init(fd, conn->domain)))
+      if (!(sock_state->ssl_ctx = ssl_socket_init(fd, domain)))
          return -1;
    }
 #endif
@@ -431,15 +480,15 @@ static int net_http_new_socket(struct http_connection_t *conn)
    while (fd >= 0)
    {
 #ifdef HAVE_SSL
-      if (conn->sock_state.ssl)
+      if (sock_state->ssl)
       {
-         ret = ssl_socket_connect(conn->sock_state.ssl_ctx,
+         ret = ssl_socket_connect(sock_state->ssl_ctx,
                (void*)next_addr, true, true);
 
          if (ret >= 0)
             break;
 
-         ssl_socket_close(conn->sock_state.ssl_ctx);
+         ssl_socket_close(sock_state->ssl_ctx);
       }
       else
 #endif
@@ -458,32 +507,175 @@ static int net_http_new_socket(struct http_connection_t *conn)
    if (addr)
       freeaddrinfo_retro(addr);
 
-   conn->sock_state.fd = fd;
+#ifdef HAVE_SSL
+   if (fd < 0 && sock_state->ssl_ctx)
+   {
+      ssl_socket_free(sock_state->ssl_ctx);
+      sock_state->ssl_ctx = NULL;
+   }
+#endif
+
+   sock_state->fd = fd;
 
    return fd;
 }
 
-static void net_http_send_str(
-      struct http_socket_state_t *sock_state, bool *error, const char *text)
+static void net_http_socket_free(struct http_socket_state_t *sock_state)
 {
-   size_t text_size;
-   if (*error)
+   if (sock_state->fd < 0)
       return;
-   text_size = strlen(text);
+
+   socket_close(sock_state->fd);
 #ifdef HAVE_SSL
-   if (sock_state->ssl)
+   if (sock_state->ssl && sock_state->ssl_ctx)
+      ssl_socket_free(sock_state->ssl_ctx);
+#endif
+   sock_state->fd      = -1;
+   sock_state->ssl_ctx = NULL;
+}
+
+#ifdef NET_HTTP_POOL_SIZE
+/* An idle connection has nothing to read - anything
+ * else means the server hung up on it meanwhile */
+static bool net_http_socket_alive(struct http_socket_state_t *sock_state)
+{
+   uint8_t c;
+   ssize_t ret;
+   bool error = false;
+
+#ifdef HAVE_SSL
+   if (sock_state->ssl && sock_state->ssl_ctx)
+      ret = ssl_socket_receive_all_nonblocking(sock_state->ssl_ctx,
+            &error, &c, 1);
+   else
+#endif
+      ret = socket_receive_all_nonblocking(sock_state->fd,
+            &error, &c, 1);
+
+   return (ret == 0 && !error);
+}
+#endif
+
+/* Takes an idle connection to the given host out of the pool */
+static bool net_http_pool_get(struct http_socket_state_t *sock_state,
+      const char *domain, int port)
+{
+#ifdef NET_HTTP_POOL_SIZE
+   unsigned i;
+
+   for (i = 0; i < NET_HTTP_POOL_SIZE; i++)
    {
-      if (!ssl_socket_send_all_blocking(
-               sock_state->ssl_ctx, text, text_size, true))
-         *error = true;
+      struct http_pool_entry_t *entry = &net_http_pool[i];
+
+      if (!retro_atomic_cas(&entry->state, POOL_IDLE, POOL_BUSY))
+         continue;
+
+      if (     entry->port           != port
+            || entry->sock_state.ssl != sock_state->ssl
+            || !string_is_equal(entry->domain, domain))
+      {
+         retro_atomic_store(&entry->state, POOL_IDLE);
+         continue;
+      }
+
+      *sock_state = entry->sock_state;
+      retro_atomic_store(&entry->state, POOL_EMPTY);
+
+      if (net_http_socket_alive(sock_state))
+         return true;
+
+      net_http_socket_free(sock_state);
    }
-   else
 #endif
+
+   return false;
+}
+
+/* Hands a connection whose last response was read
+ * in full over to the pool, if there is room left */
+static bool net_http_pool_put(struct http_socket_state_t *sock_state,
+      const char *domain, int port)
+{
+#ifdef NET_HTTP_POOL_SIZE
+   unsigned i;
+
+   if (strlen(domain) >= sizeof(net_http_pool[0].domain))
+      return false;
+
+   for (i = 0; i < NET_HTTP_POOL_SIZE; i++)
    {
-      if (!socket_send_all_blocking(
-               sock_state->fd, text, text_size, true))
-         *error = true;
+      struct http_pool_entry_t *entry = &net_http_pool[i];
+
+      if (!retro_atomic_cas(&entry->state, POOL_EMPTY, POOL_BUSY))
+         continue;
+
+      entry->sock_state = *sock_state;
+      entry->port       = port;
+      strlcpy(entry->domain, domain, sizeof(entry->domain));
+      retro_atomic_store(&entry->state, POOL_IDLE);
+      return true;
    }
+#endif
+
+   return false;
+}
+
+/* Requests are built up front and sent in one go;
+ * sending each header on its own makes Nagle's
+ * algorithm hold back all but the first one */
+static void net_http_append_str(
+      struct http_request_t *request, bool *error, const char *text)
+{
+   size_t text_size;
+   if (*error)
+      return;
+   text_size = strlen(text);
+   if (request->len + text_size > request->size)
+   {
+      size_t size = request->size * 2;
+      char  *data = NULL;
+
+      if (size < request->len + text_size)
+         size     = request->len + text_size;
+
+      if (!(data = (char*)realloc(request->data, size)))
+      {
+         *error   = true;
+         return;
+      }
+
+      request->data = data;
+      request->size = size;
+   }
+   memcpy(request->data + request->len, text, text_size);
+   request->len += text_size;
+}
+
+static bool net_http_send_request(struct http_t *state)
+{
+#ifdef HAVE_SSL
+   if (state->sock_state.ssl)
+      return ssl_socket_send_all_blocking(state->sock_state.ssl_ctx,
+            state->request, state->request_len, true) != 0;
+#endif
+   return socket_send_all_blocking(state->sock_state.fd,
+         state->request, state->request_len, true) != 0;
+}
+
+/* Sends the request again on a new connection, after
+ * a pooled one failed before the response started */
+static bool net_http_reconnect(struct http_t *state)
+{
+   net_http_socket_free(&state->sock_state);
+
+   state->reused = false;
+   state->error  = false;
+
+   if (net_http_new_socket(&state->sock_state,
+            state->domain, state->port) < 0)
+      return false;
+
+   return net_http_send_request(state);
 }
 
 struct http_connection_t *net_http_connection_new(const char *url,
@@ -689,36 +881,36 @@ const char* net_http_connection_method(struct http_connection_t* conn)
 
 struct http_t *net_http_new(struct http_connection_t *conn)
 {
+   struct http_request_t request;
    bool error            = false;
-   int fd                = -1;
    struct http_t *state  = NULL;
 
    if (!conn)
-      goto error;
-
-   fd = net_http_new_socket(conn);
+      return NULL;
 
-   if (fd < 0)
-      goto error;
+   request.len           = 0;
+   request.size          = 512;
+   request.data          = (char*)malloc(request.size);
 
-   error = false;
+   if (!request.data)
+      return NULL;
 
    /* This is a bit lazy, but it works. */
    if (conn->methodcopy)
    {
-      net_http_send_str(&conn->sock_state, &error, conn->methodcopy);
-      net_http_send_str(&conn->sock_state, &error, " /");
+      net_http_append_str(&request, &error, conn->methodcopy);
+      net_http_append_str(&request, &error, " /");
    }
    else
    {
-      net_http_send_str(&conn->sock_state, &error, "GET /");
+      net_http_append_str(&request, &error, "GET /");
    }
 
-   net_http_send_str(&conn->sock_state, &error, conn->location);
-   net_http_send_str(&conn->sock_state, &error, " HTTP/1.1\r\n");
+   net_http_append_str(&request, &error, conn->location);
+   net_http_append_str(&request, &error, " HTTP/1.1\r\n");
 
-   net_http_send_str(&conn->sock_state, &error, "Host: ");
-   net_http_send_str(&conn->sock_state, &error, conn->domain);
+   net_http_append_str(&request, &error, "Host: ");
+   net_http_append_str(&request, &error, conn->domain);
 
    if (!conn->port)
    {
@@ -727,17 +919,17 @@ struct http_t *net_http_new(struct http_connection_t *conn)
       portstr[0] = '\0';
 
       snprintf(portstr, sizeof(portstr), ":%i", conn->port);
-      net_http_send_str(&conn->sock_state, &error, portstr);
+      net_http_append_str(&request, &error, portstr);
    }
 
-   net_http_send_str(&conn->sock_state, &error, "\r\n");
+   net_http_append_str(&request, &error, "\r\n");
 
    /* This is not being set anywhere yet */
    if (conn->contenttypecopy)
    {
-      net_http_send_str(&conn->sock_state, &error, "Content-Type: ");
-      net_http_send_str(&conn->sock_state, &error, conn->contenttypecopy);
-      net_http_send_str(&conn->sock_state, &error, "\r\n");
+      net_http_append_str(&request, &error, "Content-Type: ");
+      net_http_append_str(&request, &error, conn->contenttypecopy);
+      net_http_append_str(&request, &error, "\r\n");
    }
 
    if (conn->methodcopy && (string_is_equal(conn->methodcopy, "POST")))
@@ -749,10 +941,10 @@ struct http_t *net_http_new(struct http_connection_t *conn)
          goto error;
 
       if (!conn->contenttypecopy)
-         net_http_send_str(&conn->sock_state, &error,
+         net_http_append_str(&request, &error,
                "Content-Type: application/x-www-form-urlencoded\r\n");
 
-      net_http_send_str(&conn->sock_state, &error, "Content-Length: ");
+      net_http_append_str(&request, &error, "Content-Length: ");
 
       post_len = strlen(conn->postdatacopy);
 #ifdef _WIN32
@@ -767,39 +959,73 @@ struct http_t *net_http_new(struct http_connection_t *conn)
 
       len_str[len] = '\0';
 
-      net_http_send_str(&conn->sock_state, &error, len_str);
-      net_http_send_str(&conn->sock_state, &error, "\r\n");
+      net_http_append_str(&request, &error, len_str);
+      net_http_append_str(&request, &error, "\r\n");
 
       free(len_str);
    }
 
-   net_http_send_str(&conn->sock_state, &error, "User-Agent: ");
+   net_http_append_str(&request, &error, "User-Agent: ");
    if (conn->useragentcopy)
-      net_http_send_str(&conn->sock_state, &error, conn->useragentcopy);
+      net_http_append_str(&request, &error, conn->useragentcopy);
    else
-      net_http_send_str(&conn->sock_state, &error, "libretro");
-   net_http_send_str(&conn->sock_state, &error, "\r\n");
+      net_http_append_str(&request, &error, "libretro");
+   net_http_append_str(&request, &error, "\r\n");
 
-   net_http_send_str(&conn->sock_state, &error, "Connection: close\r\n");
-   net_http_send_str(&conn->sock_state, &error, "\r\n");
+   net_http_append_str(&request, &error, "Connection: keep-alive\r\n");
+   net_http_append_str(&request, &error, "\r\n");
 
    if (conn->methodcopy && (string_is_equal(conn->methodcopy, "POST")))
-      net_http_send_str(&conn->sock_state, &error, conn->postdatacopy);
+      net_http_append_str(&request, &error, conn->postdatacopy);
 
    if (error)
       goto error;
 
-   state             = (struct http_t*)malloc(sizeof(struct http_t));
-   state->sock_state = conn->sock_state;
-   state->status     = -1;
-   state->data       = NULL;
-   state->part       = P_HEADER_TOP;
-   state->bodytype   = T_FULL;
-   state->error      = false;
-   state->pos        = 0;
-   state->len        = 0;
-   state->buflen     = 512;
-   state->data       = (char*)malloc(state->buflen);
+   state                      = (struct http_t*)malloc(sizeof(struct http_t));
+
+   if (!state)
+      goto error;
+
+   state->sock_state          = conn->sock_state;
+   state->sock_state.fd       = -1;
+   state->sock_state.ssl_ctx  = NULL;
+   state->request             = request.data;
+   state->request_len         = request.len;
+   state->domain              = strdup(conn->domain);
+   state->port                = conn->port;
+   state->status              = -1;
+   state->data                = NULL;
+   state->part                = P_HEADER_TOP;
+   state->bodytype            = T_FULL;
+   state->error               = false;
+   state->keep_alive          = false;
+   state->pos                 = 0;
+   state->len                 = 0;
+   state->buflen              = 512;
+   state->sink                = NULL;
+   state->sink_data           = NULL;
+   state->sunk                = 0;
+   request.data               = NULL;
+
+   if (!state->domain)
+      goto error;
+
+   state->reused              = net_http_pool_get(&state->sock_state,
+         state->domain, state->port);
+
+   if (!state->reused && net_http_new_socket(&state->sock_state,
+            state->domain, state->port) < 0)
+      goto error;
+
+   if (!net_http_send_request(state))
+   {
+      /* The server may have closed a pooled
+       * connection while we were writing */
+      if (!state->reused || !net_http_reconnect(state))
+         goto error;
+   }
+
+   state->data                = (char*)malloc(state->buflen);
 
    if (!state->data)
       goto error;
@@ -807,32 +1033,66 @@ struct http_t *net_http_new(struct http_connection_t *conn)
    return state;
 
 error:
-   if (conn)
-   {
-      if (conn->methodcopy)
-         free(conn->methodcopy);
-      if (conn->contenttypecopy)
-         free(conn->contenttypecopy);
-      conn->methodcopy = NULL;
-      conn->contenttypecopy = NULL;
-      conn->postdatacopy = NULL;
-   }
-#ifdef HAVE_SSL
-   if (conn && conn->sock_state.ssl && conn->sock_state.ssl_ctx && fd >= 0)
-   {
-      ssl_socket_close(conn->sock_state.ssl_ctx);
-      ssl_socket_free(conn->sock_state.ssl_ctx);
-      conn->sock_state.ssl_ctx = NULL;
-   }
-#else
-   if (fd >= 0)
-      socket_close(fd);
-#endif
+   if (conn->methodcopy)
+      free(conn->methodcopy);
+   if (conn->contenttypecopy)
+      free(conn->contenttypecopy);
+   conn->methodcopy = NULL;
+   conn->contenttypecopy = NULL;
+   conn->postdatacopy = NULL;
+   if (request.data)
+      free(request.data);
    if (state)
+   {
+      net_http_socket_free(&state->sock_state);
+      if (state->request)
+         free(state->request);
+      if (state->domain)
+         free(state->domain);
       free(state);
+   }
    return NULL;
 }
 
+void net_http_set_sink(struct http_t *state,
+      net_http_sink_t sink, void *userdata)
+{
+   if (!state)
+      return;
+
+   state->sink      = sink;
+   state->sink_data = userdata;
+}
+
+/* Hands the body received so far to the sink, keeping
+ * only what the parser still needs in the buffer */
+static bool net_http_flush_body(struct http_t *state)
+{
+   /* In between chunks, the next chunk's size line
+    * follows the body received so far */
+   size_t len = (state->part == P_BODY_CHUNKLEN)
+      ? state->len : state->pos;
+
+   if (len == 0)
+      return true;
+
+   if (!state->sink(state->sink_data, (const uint8_t*)state->data, len))
+      return false;
+
+   memmove(state->data, state->data + len, state->pos - len);
+   state->pos  -= len;
+   state->sunk += len;
+
+   /* 'len' is the size of the body that is left, or
+    * where the chunked body received so far ends; but
+    * within a chunk, it is whatever is left of that chunk */
+   if (     state->bodytype == T_LEN
+         || (state->bodytype == T_CHUNK && state->part != P_BODY))
+      state->len  -= len;
+
+   return true;
+}
+
 int net_http_fd(struct http_t *state)
 {
    if (!state)
@@ -866,7 +1126,17 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
       }
 
       if (newlen < 0)
+      {
+         /* A pooled connection the server closed
+          * meanwhile - the request can be sent again */
+         if (     state->reused
+               && state->request
+               && state->part == P_HEADER_TOP
+               && state->pos  == 0
+               && net_http_reconnect(state))
+            return false;
          goto fail;
+      }
 
       if (state->pos + newlen >= state->buflen - 64)
       {
@@ -875,6 +1145,13 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
       }
       state->pos += newlen;
 
+      /* The response started, there's no going back */
+      if (state->pos && state->request)
+      {
+         free(state->request);
+         state->request = NULL;
+      }
+
       while (state->part < P_BODY)
       {
          char *dataend = state->data + state->pos;
@@ -890,8 +1167,18 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
 
          if (state->part == P_HEADER_TOP)
          {
+            /* Skip what's left of the CRLF ending the
+             * previous chunked response on this connection */
+            if (state->data[0] == '\0')
+            {
+               memmove(state->data, lineend + 1, dataend-(lineend+1));
+               state->pos = (dataend-(lineend + 1));
+               continue;
+            }
             if (strncmp(state->data, "HTTP/1.", STRLEN_CONST("HTTP/1."))!=0)
                goto fail;
+            /* HTTP/1.1 connections persist unless told otherwise */
+            state->keep_alive = (state->data[STRLEN_CONST("HTTP/1.")] == '1');
             state->status = (int)strtoul(state->data 
                   + STRLEN_CONST("HTTP/1.1 "), NULL, 10);
             state->part   = P_HEADER;
@@ -907,10 +1194,23 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
             }
             if (string_is_equal(state->data, "Transfer-Encoding: chunked"))
                state->bodytype = T_CHUNK;
+            if (string_is_equal_case_insensitive(state->data,
+                     "Connection: close"))
+               state->keep_alive = false;
+            else if (string_is_equal_case_insensitive(state->data,
+                     "Connection: keep-alive"))
+               state->keep_alive = true;
 
             /* TODO: save headers somewhere */
             if (state->data[0]=='\0')
             {
+               /* These never have a body, and on a persistent
+                * connection it can't be told apart by EOF */
+               if (state->status == 204 || state->status == 304)
+               {
+                  state->bodytype = T_LEN;
+                  state->len      = 0;
+               }
                state->part = P_BODY;
                if (state->bodytype == T_CHUNK)
                   state->part = P_BODY_CHUNKLEN;
@@ -1046,13 +1346,21 @@ parse_again:
       }
    }
 
+   if (     state->sink
+         && state->part   >= P_BODY
+         && state->part   <= P_DONE
+         && state->status >= 200
+         && state->status <= 299
+         && !net_http_flush_body(state))
+      goto fail;
+
    if (progress)
-      *progress = state->pos;
+      *progress = state->sunk + state->pos;
 
    if (total)
    {
       if (state->bodytype == T_LEN)
-         *total=state->len;
+         *total=state->sunk + state->len;
       else
          *total=0;
    }
@@ -1100,17 +1408,21 @@ void net_http_delete(struct http_t *state)
    if (!state)
       return;
 
-   if (state->sock_state.fd >= 0)
-   {
-      socket_close(state->sock_state.fd);
-#ifdef HAVE_SSL
-      if (state->sock_state.ssl && state->sock_state.ssl_ctx)
-      {
-         ssl_socket_free(state->sock_state.ssl_ctx);
-         state->sock_state.ssl_ctx = NULL;
-      }
-#endif
-   }
+   /* Without a length, the body ended with the connection */
+   if (     state->sock_state.fd >= 0
+         && state->part     == P_DONE
+         && state->bodytype != T_FULL
+         && state->keep_alive
+         && net_http_pool_put(&state->sock_state,
+            state->domain, state->port))
+      state->sock_state.fd = -1;
+
+   net_http_socket_free(&state->sock_state);
+
+   if (state->request)
+      free(state->request);
+   if (state->domain)
+      free(state->domain);
    free(state);
 }
 
@@ -25,6 +25,8 @@
 #include <encodings/base64.h>
 #include <streams/file_stream.h>
 #include <string/stdstring.h>
+#include <retro_atomic.h>
+#include <retro_timers.h>
 
 #include "../../deps/bearssl-0.6/inc/bearssl.h"
 
@@ -148,17 +150,28 @@ static void append_certs_pem_x509(char * certs_pem)
    }
 }
 
-/* TODO: not thread safe, rthreads doesn't provide any 
- * statically allocatable mutex/etc */
+/* 0 until loading the trust anchors starts, 1 while
+ * it is underway and 2 once it is done. rthreads doesn't
+ * provide any statically allocatable mutex, and HTTP
+ * transfers may connect from several task threads */
+static retro_atomic_int_t TAs_state = 0;
+
 static void initialize(void)
 {
    void* certs_pem;
-   if (TAs_NUM)
+   if (retro_atomic_load(&TAs_state) == 2)
+      return;
+   if (!retro_atomic_cas(&TAs_state, 0, 1))
+   {
+      while (retro_atomic_load(&TAs_state) != 2)
+         retro_sleep(1);
       return;
+   }
    /* filestream_read_file appends a NUL */
    filestream_read_file("/etc/ssl/certs/ca-certificates.crt", &certs_pem, NULL);
    append_certs_pem_x509((char*)certs_pem);
    free(certs_pem);
+   retro_atomic_store(&TAs_state, 2);
 }
 
 void* ssl_socket_init(int fd, const char *domain)
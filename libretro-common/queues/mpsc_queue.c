@@ -0,0 +1,210 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (mpsc_queue.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_common_api.h>
+#include <boolean.h>
+
+#include <queues/mpsc_queue.h>
+
+#if !RETRO_ATOMIC_LOCK_FREE && defined(HAVE_THREADS)
+#define MPSC_QUEUE_LOCK(queue)   slock_lock((queue)->lock)
+#define MPSC_QUEUE_UNLOCK(queue) slock_unlock((queue)->lock)
+#else
+#define MPSC_QUEUE_LOCK(queue)
+#define MPSC_QUEUE_UNLOCK(queue)
+#endif
+
+bool mpsc_queue_initialize(mpsc_queue_t *queue,
+      size_t record_size, unsigned capacity)
+{
+   unsigned i;
+   unsigned size = 1;
+
+   if (!queue || !record_size || !capacity)
+      return false;
+
+   memset(queue, 0, sizeof(*queue));
+
+   /* Positions are mapped onto slots with a mask */
+   while (size < capacity)
+      size <<= 1;
+
+   if (!(queue->records = (uint8_t*)calloc(size, record_size)))
+      return false;
+
+   if (!(queue->sequences = (retro_atomic_int_t*)
+            calloc(size, sizeof(*queue->sequences))))
+   {
+      free(queue->records);
+      queue->records = NULL;
+      return false;
+   }
+
+#if !RETRO_ATOMIC_LOCK_FREE && defined(HAVE_THREADS)
+   if (!(queue->lock = slock_new()))
+   {
+      free(queue->sequences);
+      free(queue->records);
+      queue->sequences = NULL;
+      queue->records   = NULL;
+      return false;
+   }
+#endif
+
+   queue->record_size = record_size;
+   queue->capacity    = size;
+   queue->head        = 0;
+
+   /* Slot i is free for whoever claims position i */
+   for (i = 0; i < size; i++)
+      retro_atomic_store(&queue->sequences[i], (int)i);
+   retro_atomic_store(&queue->tail, 0);
+
+   return true;
+}
+
+void mpsc_queue_deinitialize(mpsc_queue_t *queue)
+{
+   if (!queue)
+      return;
+
+   if (queue->records)
+      free(queue->records);
+   if (queue->sequences)
+      free((void*)queue->sequences);
+   queue->records     = NULL;
+   queue->sequences   = NULL;
+   queue->record_size = 0;
+   queue->capacity    = 0;
+
+#if !RETRO_ATOMIC_LOCK_FREE && defined(HAVE_THREADS)
+   if (queue->lock)
+      slock_free(queue->lock);
+   queue->lock        = NULL;
+#endif
+}
+
+mpsc_queue_t *mpsc_queue_new(size_t record_size, unsigned capacity)
+{
+   mpsc_queue_t *queue = (mpsc_queue_t*)malloc(sizeof(*queue));
+
+   if (!queue)
+      return NULL;
+
+   if (!mpsc_queue_initialize(queue, record_size, capacity))
+   {
+      free(queue);
+      return NULL;
+   }
+
+   return queue;
+}
+
+void mpsc_queue_free(mpsc_queue_t *queue)
+{
+   if (!queue)
+      return;
+
+   mpsc_queue_deinitialize(queue);
+   free(queue);
+}
+
+bool mpsc_queue_push(mpsc_queue_t *queue, const void *record)
+{
+   unsigned pos;
+   unsigned slot;
+
+   if (!queue || !queue->records)
+      return false;
+
+   MPSC_QUEUE_LOCK(queue);
+
+   for (;;)
+   {
+      int diff;
+
+      pos  = (unsigned)retro_atomic_load(&queue->tail);
+      slot = pos & (queue->capacity - 1);
+      diff = (int)((unsigned)retro_atomic_load(
+               &queue->sequences[slot]) - pos);
+
+      /* The slot still holds a record from one lap
+       * ago that the consumer has not read yet */
+      if (diff < 0)
+      {
+         MPSC_QUEUE_UNLOCK(queue);
+         return false;
+      }
+
+      /* Another producer took this position first
+       * when diff > 0 or the exchange fails; retry
+       * with the new tail */
+      if (diff == 0 && retro_atomic_cas(&queue->tail,
+               (int)pos, (int)(pos + 1)))
+         break;
+   }
+
+   /* The record is copied before the slot is handed
+    * over, so the consumer never sees it half written */
+   memcpy(queue->records + slot * queue->record_size,
+         record, queue->record_size);
+   retro_atomic_store(&queue->sequences[slot], (int)(pos + 1));
+
+   MPSC_QUEUE_UNLOCK(queue);
+
+   return true;
+}
+
+bool mpsc_queue_pop(mpsc_queue_t *queue, void *record)
+{
+   unsigned pos;
+   unsigned slot;
+
+   if (!queue || !queue->records)
+      return false;
+
+   MPSC_QUEUE_LOCK(queue);
+
+   pos  = queue->head;
+   slot = pos & (queue->capacity - 1);
+
+   if ((unsigned)retro_atomic_load(&queue->sequences[slot]) != pos + 1)
+   {
+      MPSC_QUEUE_UNLOCK(queue);
+      return false;
+   }
+
+   memcpy(record, queue->records + slot * queue->record_size,
+         queue->record_size);
+
+   /* Free the slot for the producer one lap ahead */
+   retro_atomic_store(&queue->sequences[slot],
+         (int)(pos + queue->capacity));
+   queue->head = pos + 1;
+
+   MPSC_QUEUE_UNLOCK(queue);
+
+   return true;
+}
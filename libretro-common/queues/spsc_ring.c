@@ -0,0 +1,212 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (spsc_ring.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include <retro_common_api.h>
+#include <retro_inline.h>
+#include <boolean.h>
+
+#include <queues/spsc_ring.h>
+
+#if !RETRO_ATOMIC_LOCK_FREE && defined(HAVE_THREADS)
+#define SPSC_RING_LOCK(ring)   slock_lock((ring)->lock)
+#define SPSC_RING_UNLOCK(ring) slock_unlock((ring)->lock)
+#else
+#define SPSC_RING_LOCK(ring)
+#define SPSC_RING_UNLOCK(ring)
+#endif
+
+bool spsc_ring_initialize(spsc_ring_t *ring, size_t size)
+{
+   if (!ring || (size >= INT_MAX))
+      return false;
+
+   memset(ring, 0, sizeof(*ring));
+
+   /* One byte always stays free, so that
+    * a full ring can be told from an empty one */
+   if (!(ring->buffer = (uint8_t*)calloc(1, size + 1)))
+      return false;
+
+#if !RETRO_ATOMIC_LOCK_FREE && defined(HAVE_THREADS)
+   if (!(ring->lock = slock_new()))
+   {
+      free(ring->buffer);
+      ring->buffer = NULL;
+      return false;
+   }
+#endif
+
+   ring->size = size + 1;
+   retro_atomic_store(&ring->end, 0);
+   retro_atomic_store(&ring->first, 0);
+
+   return true;
+}
+
+void spsc_ring_deinitialize(spsc_ring_t *ring)
+{
+   if (!ring)
+      return;
+
+   if (ring->buffer)
+      free(ring->buffer);
+   ring->buffer = NULL;
+   ring->size   = 0;
+
+#if !RETRO_ATOMIC_LOCK_FREE && defined(HAVE_THREADS)
+   if (ring->lock)
+      slock_free(ring->lock);
+   ring->lock   = NULL;
+#endif
+}
+
+spsc_ring_t *spsc_ring_new(size_t size)
+{
+   spsc_ring_t *ring = (spsc_ring_t*)malloc(sizeof(*ring));
+
+   if (!ring)
+      return NULL;
+
+   if (!spsc_ring_initialize(ring, size))
+   {
+      free(ring);
+      return NULL;
+   }
+
+   return ring;
+}
+
+void spsc_ring_free(spsc_ring_t *ring)
+{
+   if (!ring)
+      return;
+
+   spsc_ring_deinitialize(ring);
+   free(ring);
+}
+
+void spsc_ring_clear(spsc_ring_t *ring)
+{
+   retro_atomic_store(&ring->end, 0);
+   retro_atomic_store(&ring->first, 0);
+}
+
+static INLINE size_t spsc_ring_used(const spsc_ring_t *ring,
+      size_t first, size_t end)
+{
+   return (end >= first) ? (end - first) : (ring->size - first + end);
+}
+
+size_t spsc_ring_read_avail(spsc_ring_t *ring)
+{
+   size_t first, end;
+
+   SPSC_RING_LOCK(ring);
+   first = (size_t)retro_atomic_load(&ring->first);
+   end   = (size_t)retro_atomic_load(&ring->end);
+   SPSC_RING_UNLOCK(ring);
+
+   return spsc_ring_used(ring, first, end);
+}
+
+size_t spsc_ring_write_avail(spsc_ring_t *ring)
+{
+   size_t first, end;
+
+   SPSC_RING_LOCK(ring);
+   first = (size_t)retro_atomic_load(&ring->first);
+   end   = (size_t)retro_atomic_load(&ring->end);
+   SPSC_RING_UNLOCK(ring);
+
+   return (ring->size - 1) - spsc_ring_used(ring, first, end);
+}
+
+size_t spsc_ring_write(spsc_ring_t *ring,
+      const void *in_buf, size_t size)
+{
+   size_t first, end, avail, first_write;
+
+   SPSC_RING_LOCK(ring);
+
+   /* The data is copied before the new end is
+    * published, so the consumer never sees
+    * bytes that are still being written */
+   first = (size_t)retro_atomic_load(&ring->first);
+   end   = (size_t)retro_atomic_load(&ring->end);
+   avail = (ring->size - 1) - spsc_ring_used(ring, first, end);
+
+   if (size > avail)
+      size = avail;
+
+   if (size > 0)
+   {
+      first_write = ring->size - end;
+      if (first_write > size)
+         first_write = size;
+
+      memcpy(ring->buffer + end, in_buf, first_write);
+      memcpy(ring->buffer, (const uint8_t*)in_buf + first_write,
+            size - first_write);
+
+      retro_atomic_store(&ring->end, (int)((end + size) % ring->size));
+   }
+
+   SPSC_RING_UNLOCK(ring);
+
+   return size;
+}
+
+size_t spsc_ring_read(spsc_ring_t *ring,
+      void *out_buf, size_t size)
+{
+   size_t first, end, avail, first_read;
+
+   SPSC_RING_LOCK(ring);
+
+   first = (size_t)retro_atomic_load(&ring->first);
+   end   = (size_t)retro_atomic_load(&ring->end);
+   avail = spsc_ring_used(ring, first, end);
+
+   if (size > avail)
+      size = avail;
+
+   if (size > 0)
+   {
+      first_read = ring->size - first;
+      if (first_read > size)
+         first_read = size;
+
+      memcpy(out_buf, ring->buffer + first, first_read);
+      memcpy((uint8_t*)out_buf + first_read, ring->buffer,
+            size - first_read);
+
+      retro_atomic_store(&ring->first, (int)((first + size) % ring->size));
+   }
+
+   SPSC_RING_UNLOCK(ring);
+
+   return size;
+}
@@ -23,6 +23,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <stdint.h>
 
 #include <queues/task_queue.h>
 
@@ -59,19 +60,25 @@ struct retro_task_impl
 
 /* TODO/FIXME - static globals */
 static retro_task_queue_msg_t msg_push_bak  = NULL;
+static retro_task_trace_t task_trace        = NULL;
 static task_queue_t tasks_running           = {NULL, NULL};
 static task_queue_t tasks_finished          = {NULL, NULL};
 
 static struct retro_task_impl *impl_current = NULL;
+static retro_time_t task_callback_budget    = 0;
 static bool task_threaded_enable            = false;
 
 #ifdef HAVE_THREADS
+/* Upper bound on worker threads, the actual amount
+ * depends on the amount of cores */
+#define TASK_QUEUE_MAX_WORKERS 4
+
 static slock_t *running_lock                = NULL;
 static slock_t *finished_lock               = NULL;
 static slock_t *property_lock               = NULL;
-static slock_t *queue_lock                  = NULL;
 static scond_t *worker_cond                 = NULL;
-static sthread_t *worker_thread             = NULL;
+static sthread_t *worker_threads[TASK_QUEUE_MAX_WORKERS];
+static unsigned worker_count                = 0;
 static bool worker_continue                 = true; 
 /* use running_lock when touching it */
 #endif
@@ -167,10 +174,50 @@ static retro_task_t *task_queue_get(task_queue_t *queue)
    return task;
 }
 
-static void retro_task_internal_gather(void)
+/* Takes the finished task whose callback runs next, the
+ * oldest one of the highest priority. With 'high_only' set,
+ * only a TASK_PRIORITY_HIGH one is taken. */
+static retro_task_t *task_queue_get_finished(task_queue_t *queue,
+      bool high_only)
 {
-   retro_task_t *task = NULL;
-   while ((task = task_queue_get(&tasks_finished)))
+   retro_task_t *task      = NULL;
+   retro_task_t *prev      = NULL;
+   retro_task_t *best      = NULL;
+   retro_task_t *best_prev = NULL;
+
+   for (task = queue->front; task; prev = task, task = task->next)
+   {
+      if (!best || task->priority > best->priority)
+      {
+         best      = task;
+         best_prev = prev;
+      }
+   }
+
+   if (!best || (high_only && best->priority != TASK_PRIORITY_HIGH))
+      return NULL;
+
+   if (best_prev)
+      best_prev->next = best->next;
+   else
+      queue->front    = best->next;
+   if (queue->back == best)
+      queue->back     = best_prev;
+   best->next         = NULL;
+
+   return best;
+}
+
+/* Runs the callbacks of finished tasks. With a budget, once it
+ * is used up only high priority callbacks still run, the rest
+ * wait for the next call. At least one callback always runs. */
+static void retro_task_internal_gather(retro_time_t budget)
+{
+   retro_task_t *task    = NULL;
+   retro_time_t deadline = budget ? cpu_features_get_time_usec() + budget : 0;
+   bool over_budget      = false;
+
+   while ((task = task_queue_get_finished(&tasks_finished, over_budget)))
    {
       task_queue_push_progress(task);
 
@@ -187,6 +234,9 @@ static void retro_task_internal_gather(void)
          free(task->title);
 
       free(task);
+
+      if (deadline && cpu_features_get_time_usec() >= deadline)
+         over_budget = true;
    }
 }
 
@@ -201,7 +251,7 @@ static void retro_task_regular_cancel(void *task)
    t->cancelled    = true;
 }
 
-static void retro_task_regular_gather(void)
+static void retro_task_regular_run(retro_time_t budget)
 {
    retro_task_t *task  = NULL;
    retro_task_t *queue = NULL;
@@ -219,7 +269,11 @@ static void retro_task_regular_gather(void)
 
       if (!task->when || task->when < cpu_features_get_time_usec())
       {
+         if (task_trace)
+            task_trace(task, true);
          task->handler(task);
+         if (task_trace)
+            task_trace(task, false);
 
          task_queue_push_progress(task);
       }
@@ -230,13 +284,21 @@ static void retro_task_regular_gather(void)
          retro_task_regular_push_running(task);
    }
 
-   retro_task_internal_gather();
+   retro_task_internal_gather(budget);
+}
+
+static void retro_task_regular_gather(void)
+{
+   retro_task_regular_run(task_callback_budget);
 }
 
 static void retro_task_regular_wait(retro_task_condition_fn_t cond, void* data)
 {
    while ((tasks_running.front && !tasks_running.front->when) && (!cond || cond(data)))
-      retro_task_regular_gather();
+      retro_task_regular_run(0);
+
+   /* Nothing that was put off is left behind */
+   retro_task_internal_gather(0);
 }
 
 static void retro_task_regular_reset(void)
@@ -323,7 +385,7 @@ static struct retro_task_impl impl_regular = {
 
 #ifdef HAVE_THREADS
 
-/* 'queue_lock' must be held for the duration of this function */
+/* 'running_lock' must be held for the duration of this function */
 static void task_queue_remove(task_queue_t *queue, retro_task_t *task)
 {
    retro_task_t     *t = NULL;
@@ -369,10 +431,8 @@ static void task_queue_remove(task_queue_t *queue, retro_task_t *task)
 static void retro_task_threaded_push_running(retro_task_t *task)
 {
    slock_lock(running_lock);
-   slock_lock(queue_lock);
    task_queue_put(&tasks_running, task);
    scond_signal(worker_cond);
-   slock_unlock(queue_lock);
    slock_unlock(running_lock);
 }
 
@@ -394,7 +454,7 @@ static void retro_task_threaded_cancel(void *task)
    slock_unlock(running_lock);
 }
 
-static void retro_task_threaded_gather(void)
+static void retro_task_threaded_run(retro_time_t budget)
 {
    retro_task_t *task = NULL;
 
@@ -406,18 +466,23 @@ static void retro_task_threaded_gather(void)
    slock_unlock(running_lock);
 
    slock_lock(finished_lock);
-   retro_task_internal_gather();
+   retro_task_internal_gather(budget);
    slock_unlock(finished_lock);
    slock_unlock(property_lock);
 }
 
+static void retro_task_threaded_gather(void)
+{
+   retro_task_threaded_run(task_callback_budget);
+}
+
 static void retro_task_threaded_wait(retro_task_condition_fn_t cond, void* data)
 {
    bool wait = false;
 
    do
    {
-      retro_task_threaded_gather();
+      retro_task_threaded_run(0);
 
       slock_lock(running_lock);
       wait = (tasks_running.front && !tasks_running.front->when);
@@ -467,121 +532,198 @@ static void retro_task_threaded_retrieve(task_retriever_data_t *data)
    slock_unlock(running_lock);
 }
 
-static void threaded_worker(void *userdata)
+/* Whether 'next' has to wait for a running task.
+ * Only tasks flagged as concurrent run alongside other
+ * tasks. Everything else runs one at a time, as handlers
+ * may share state or files with other handlers (a
+ * savestate load reading the file a save is writing,
+ * two scans writing the same playlist).
+ *
+ * 'running_lock' must be held for the duration of this function */
+static bool task_queue_task_blocked(const retro_task_t *next)
 {
-   (void)userdata;
+   retro_task_t *task = NULL;
+
+   if (next->concurrent)
+      return false;
 
-   for (;;)
+   for (task = tasks_running.front; task; task = task->next)
    {
-      retro_task_t *task  = NULL;
-      bool       finished = false;
+      if (task->worker_busy && !task->concurrent)
+         return true;
+   }
 
-      if (!worker_continue)
-         break; /* should we keep running until all tasks finished? */
+   return false;
+}
 
-      slock_lock(running_lock);
+/* Picks the next task for a worker preferring 'affinity':
+ * the highest priority task that is due, preferring the
+ * worker's own class, then queue order.
+ *
+ * Tasks not flagged as concurrent are skipped while
+ * another such task is running, see
+ * task_queue_task_blocked().
+ *
+ * If nothing is due, '*wait_until' is set to the time
+ * the next scheduled task becomes due, if any.
+ *
+ * 'running_lock' must be held for the duration of this function */
+static retro_task_t *task_queue_pick(enum task_affinity affinity,
+      retro_time_t now, retro_time_t *wait_until)
+{
+   retro_task_t *task = NULL;
+   retro_task_t *best = NULL;
 
-      /* Get first task to run */
-      task = tasks_running.front;
-      if (!task)
+   for (task = tasks_running.front; task; task = task->next)
+   {
+      if (task->worker_busy)
+         continue;
+
+      /* allow half a millisecond for context switching */
+      if (task->when && task->when - 500 > now)
       {
-         scond_wait(worker_cond, running_lock);
-         slock_unlock(running_lock);
+         if (!*wait_until || task->when < *wait_until)
+            *wait_until = task->when;
          continue;
       }
 
-      if (task->when)
+      if (task_queue_task_blocked(task))
+         continue;
+
+      if (     !best
+            || task->priority > best->priority
+            || (   task->priority == best->priority
+                && task->affinity == affinity
+                && best->affinity != affinity))
+         best = task;
+   }
+
+   return best;
+}
+
+static void threaded_worker(void *userdata)
+{
+   enum task_affinity affinity = (enum task_affinity)(uintptr_t)userdata;
+
+   sthread_set_role(STHREAD_ROLE_WORKER);
+
+   slock_lock(running_lock);
+
+   /* should we keep running until all tasks finished? */
+   while (worker_continue)
+   {
+      retro_time_t now        = cpu_features_get_time_usec();
+      retro_time_t wait_until = 0;
+      bool finished           = false;
+      retro_task_t *task      = task_queue_pick(affinity, now, &wait_until);
+
+      if (!task)
       {
-         retro_time_t now   = cpu_features_get_time_usec();
-         retro_time_t delay = task->when - now - 500; /* allow half a millisecond for context switching */
-         if (delay > 0)
-         {
-            scond_wait_timeout(worker_cond, running_lock, delay);
-            slock_unlock(running_lock);
-            continue;
-         }
+         if (wait_until)
+            scond_wait_timeout(worker_cond, running_lock,
+                  wait_until - now - 500);
+         else
+            scond_wait(worker_cond, running_lock);
+         continue;
       }
 
+      task->worker_busy = true;
       slock_unlock(running_lock);
 
+      if (task_trace)
+         task_trace(task, true);
       task->handler(task);
+      if (task_trace)
+         task_trace(task, false);
 
       slock_lock(property_lock);
       finished = task->finished;
       slock_unlock(property_lock);
 
-      /* Update queue */
-      if (!finished)
-      {
-         /* Move the task to the back of the queue */
-         /* mimics retro_task_threaded_push_running, 
-          * but also includes a task_queue_remove */
-         slock_lock(running_lock);
-         slock_lock(queue_lock);
-
-         /* do nothing if only item in queue */
-         if (task->next) 
-         {
-            task_queue_remove(&tasks_running, task);
-            task_queue_put(&tasks_running, task);
-            scond_signal(worker_cond);
-         }
-         slock_unlock(queue_lock);
-         slock_unlock(running_lock);
-      }
-      else
-      {
-         /* Remove task from running queue */
-         slock_lock(running_lock);
-         slock_lock(queue_lock);
-         task_queue_remove(&tasks_running, task);
-         slock_unlock(queue_lock);
-         slock_unlock(running_lock);
+      slock_lock(running_lock);
+      task->worker_busy = false;
+      task_queue_remove(&tasks_running, task);
 
+      if (finished)
+      {
          /* Add task to finished queue */
          slock_lock(finished_lock);
          task_queue_put(&tasks_finished, task);
          slock_unlock(finished_lock);
       }
+      else
+      {
+         /* Move the task to the back of the queue,
+          * so other tasks of the same priority get a turn */
+         task_queue_put(&tasks_running, task);
+      }
+
+      /* Other workers may have skipped tasks
+       * that had to wait for this one */
+      scond_broadcast(worker_cond);
    }
+
+   slock_unlock(running_lock);
 }
 
 static void retro_task_threaded_init(void)
 {
+   unsigned i;
+   unsigned cores  = cpu_features_get_core_amount();
+
    running_lock    = slock_new();
    finished_lock   = slock_new();
    property_lock   = slock_new();
-   queue_lock      = slock_new();
    worker_cond     = scond_new();
 
    slock_lock(running_lock);
    worker_continue = true;
    slock_unlock(running_lock);
 
-   worker_thread   = sthread_create(threaded_worker, NULL);
+   /* At least two workers, so that I/O bound tasks
+    * don't hold up CPU bound ones even on a single core */
+   worker_count    = cores;
+   if (worker_count < 2)
+      worker_count = 2;
+   if (worker_count > TASK_QUEUE_MAX_WORKERS)
+      worker_count = TASK_QUEUE_MAX_WORKERS;
+
+   for (i = 0; i < worker_count; i++)
+   {
+      /* Alternate between preferring CPU and I/O bound tasks */
+      enum task_affinity affinity = (i & 1)
+         ? TASK_AFFINITY_IO : TASK_AFFINITY_CPU;
+      worker_threads[i] = sthread_create(threaded_worker,
+            (void*)(uintptr_t)affinity);
+   }
 }
 
 static void retro_task_threaded_deinit(void)
 {
+   unsigned i;
+
    slock_lock(running_lock);
    worker_continue = false;
-   scond_signal(worker_cond);
+   scond_broadcast(worker_cond);
    slock_unlock(running_lock);
 
-   sthread_join(worker_thread);
+   for (i = 0; i < worker_count; i++)
+   {
+      if (worker_threads[i])
+         sthread_join(worker_threads[i]);
+      worker_threads[i] = NULL;
+   }
+   worker_count    = 0;
 
    scond_free(worker_cond);
    slock_free(running_lock);
    slock_free(finished_lock);
    slock_free(property_lock);
-   slock_free(queue_lock);
 
-   worker_thread   = NULL;
    worker_cond     = NULL;
    running_lock    = NULL;
    finished_lock   = NULL;
    property_lock   = NULL;
-   queue_lock      = NULL;
 }
 
 static struct retro_task_impl impl_threaded = {
@@ -609,6 +751,16 @@ void task_queue_deinit(void)
    impl_current = NULL;
 }
 
+void task_queue_set_trace(retro_task_trace_t trace)
+{
+   task_trace = trace;
+}
+
+void task_queue_set_callback_budget(retro_time_t usec)
+{
+   task_callback_budget = usec;
+}
+
 void task_queue_init(bool threaded, retro_task_queue_msg_t msg_push)
 {
    impl_current = &impl_regular;
@@ -678,7 +830,7 @@ bool task_queue_push(retro_task_t *task)
       retro_task_t *running = NULL;
       bool            found = false;
 
-      SLOCK_LOCK(queue_lock);
+      SLOCK_LOCK(running_lock);
       running = tasks_running.front;
 
       for (; running; running = running->next)
@@ -690,7 +842,7 @@ bool task_queue_push(retro_task_t *task)
          }
       }
 
-      SLOCK_UNLOCK(queue_lock);
+      SLOCK_UNLOCK(running_lock);
 
       /* skip this task, user must try again later */
       if (found)
@@ -908,6 +1060,10 @@ retro_task_t *task_init(void)
    task->progress_cb       = NULL;
    task->title             = NULL;
    task->type              = TASK_TYPE_NONE;
+   task->priority          = TASK_PRIORITY_NORMAL;
+   task->affinity          = TASK_AFFINITY_CPU;
+   task->concurrent        = false;
+   task->worker_busy       = false;
    task->ident             = task_count++;
    task->frontend_userdata = NULL;
    task->alternative_look  = false;
@@ -64,6 +64,14 @@
 #include <mach/mach.h>
 #endif
 
+#if defined(__linux__) && (defined(_GNU_SOURCE) || defined(ANDROID))
+#define HAVE_LINUX_THREAD_PROFILE
+#include <sched.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
 struct thread_data
 {
    void (*func)(void*);
@@ -317,6 +325,233 @@ bool sthread_isself(sthread_t *thread)
 #endif
 }
 
+struct sthread_role_profile
+{
+   uint64_t cpu_mask;
+   enum sthread_priority_class priority;
+};
+
+static struct sthread_role_profile sthread_role_profiles[STHREAD_ROLE_LAST];
+static bool sthread_role_profiles_set = false;
+
+#if defined(HAVE_LINUX_THREAD_PROFILE)
+/* Nice value and affinity the process started with;
+ * the default profile restores these */
+static int sthread_initial_nice = 0;
+static bool sthread_initial_saved = false;
+#ifdef CPU_SET
+static cpu_set_t sthread_initial_cpus;
+static bool sthread_initial_cpus_saved = false;
+#endif
+#endif
+
+/**
+ * sthread_set_role_profile:
+ * @role                    : thread role
+ * @cpu_mask                : CPUs the threads may run on, bit N
+ *                            being CPU N. 0 means no restriction.
+ * @priority                : priority class of the threads
+ *
+ * Sets the profile that sthread_set_role() applies for @role.
+ * Threads that already took on @role keep the old profile
+ * until they call sthread_set_role() again.
+ */
+void sthread_set_role_profile(enum sthread_role role,
+      uint64_t cpu_mask, enum sthread_priority_class priority)
+{
+   if (role >= STHREAD_ROLE_LAST)
+      return;
+
+#if defined(HAVE_LINUX_THREAD_PROFILE)
+   /* The first call comes from the main thread before
+    * any profile got applied */
+   if (!sthread_initial_saved)
+   {
+      sthread_initial_saved = true;
+      sthread_initial_nice  = getpriority(PRIO_PROCESS, 0);
+#ifdef CPU_SET
+      if (sched_getaffinity(0, sizeof(sthread_initial_cpus),
+               &sthread_initial_cpus) == 0)
+         sthread_initial_cpus_saved = true;
+#endif
+   }
+#endif
+
+   sthread_role_profiles[role].cpu_mask = cpu_mask;
+   sthread_role_profiles[role].priority = priority;
+   sthread_role_profiles_set            = true;
+}
+
+static bool sthread_set_affinity(uint64_t cpu_mask)
+{
+#if defined(HAVE_LINUX_THREAD_PROFILE) && defined(CPU_SET)
+   unsigned i;
+   cpu_set_t cpus;
+
+   if (!cpu_mask)
+   {
+      if (!sthread_initial_cpus_saved)
+         return true;
+      return sched_setaffinity(0, sizeof(sthread_initial_cpus),
+            &sthread_initial_cpus) == 0;
+   }
+
+   CPU_ZERO(&cpus);
+   for (i = 0; i < 64; i++)
+      if (cpu_mask & (UINT64_C(1) << i))
+         CPU_SET(i, &cpus);
+   return sched_setaffinity(0, sizeof(cpus), &cpus) == 0;
+#elif defined(USE_WIN32_THREADS) && !defined(_XBOX) && !defined(__WINRT__)
+   DWORD_PTR process_mask = 0;
+   DWORD_PTR system_mask  = 0;
+
+   if (!cpu_mask)
+   {
+      if (!GetProcessAffinityMask(GetCurrentProcess(),
+               &process_mask, &system_mask))
+         return false;
+      cpu_mask = process_mask;
+   }
+   return SetThreadAffinityMask(GetCurrentThread(),
+         (DWORD_PTR)cpu_mask) != 0;
+#else
+   /* Apple platforms only take affinity hints through QoS */
+   return !cpu_mask;
+#endif
+}
+
+#if defined(HAVE_LINUX_THREAD_PROFILE)
+static bool sthread_set_nice(int nice_offset)
+{
+   int nice_value = sthread_initial_nice + nice_offset;
+   struct sched_param sp;
+   memset(&sp, 0, sizeof(sp));
+   /* Drops SCHED_FIFO again if the thread had it */
+   pthread_setschedparam(pthread_self(), SCHED_OTHER, &sp);
+   if (nice_value > 19)
+      nice_value = 19;
+   /* Unlike POSIX, Linux applies this to the thread only */
+   return setpriority(PRIO_PROCESS,
+         (id_t)syscall(SYS_gettid), nice_value) == 0;
+}
+#endif
+
+static bool sthread_set_priority_class(enum sthread_priority_class priority)
+{
+#if defined(HAVE_LINUX_THREAD_PROFILE)
+   switch (priority)
+   {
+      case STHREAD_PRIORITY_LOW:
+         return sthread_set_nice(10);
+      case STHREAD_PRIORITY_HIGH:
+         return sthread_set_nice(-5);
+      case STHREAD_PRIORITY_REALTIME:
+         {
+            struct sched_param sp;
+            memset(&sp, 0, sizeof(sp));
+            /* Kept low so that it can't starve
+             * other realtime threads on the system */
+            sp.sched_priority = sched_get_priority_min(SCHED_FIFO) + 9;
+            if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp) == 0)
+               return true;
+         }
+         sthread_set_nice(-5);
+         return false;
+      default:
+         break;
+   }
+   return sthread_set_nice(0);
+#elif defined(USE_WIN32_THREADS) && !defined(_XBOX)
+   int win32_priority = THREAD_PRIORITY_NORMAL;
+
+   switch (priority)
+   {
+      case STHREAD_PRIORITY_LOW:
+         win32_priority = THREAD_PRIORITY_BELOW_NORMAL;
+         break;
+      case STHREAD_PRIORITY_HIGH:
+         win32_priority = THREAD_PRIORITY_ABOVE_NORMAL;
+         break;
+      case STHREAD_PRIORITY_REALTIME:
+#ifndef __WINRT__
+         {
+            /* Multimedia Class Scheduler Service, the same
+             * the system audio engine uses. Stays in effect
+             * until the thread exits. */
+            typedef HANDLE (WINAPI *av_set_fn)(LPCSTR, LPDWORD);
+            HMODULE avrt = LoadLibraryA("avrt.dll");
+
+            if (avrt)
+            {
+               DWORD task_index = 0;
+               av_set_fn av_set = (av_set_fn)GetProcAddress(avrt,
+                     "AvSetMmThreadCharacteristicsA");
+               if (av_set && av_set("Pro Audio", &task_index))
+                  return true;
+               FreeLibrary(avrt);
+            }
+         }
+#endif
+         win32_priority = THREAD_PRIORITY_HIGHEST;
+         break;
+      default:
+         break;
+   }
+   return SetThreadPriority(GetCurrentThread(), win32_priority) != 0;
+#elif defined(__APPLE__) && defined(_PTHREAD_QOS_H)
+   qos_class_t qos = QOS_CLASS_DEFAULT;
+
+   switch (priority)
+   {
+      case STHREAD_PRIORITY_LOW:
+         qos = QOS_CLASS_UTILITY;
+         break;
+      case STHREAD_PRIORITY_HIGH:
+         qos = QOS_CLASS_USER_INITIATED;
+         break;
+      case STHREAD_PRIORITY_REALTIME:
+         qos = QOS_CLASS_USER_INTERACTIVE;
+         break;
+      default:
+         break;
+   }
+   return pthread_set_qos_class_self_np(qos, 0) == 0;
+#else
+   return priority == STHREAD_PRIORITY_DEFAULT;
+#endif
+}
+
+/**
+ * sthread_set_role:
+ * @role                    : thread role
+ *
+ * Applies the profile of @role to the calling thread.
+ * Parts of the profile the platform doesn't support
+ * are ignored.
+ *
+ * Returns: true if the whole profile could be applied.
+ */
+bool sthread_set_role(enum sthread_role role)
+{
+   bool ret = true;
+   const struct sthread_role_profile *profile = NULL;
+
+   if (role >= STHREAD_ROLE_LAST)
+      return false;
+
+   /* Leave threads alone until a profile was given */
+   if (!sthread_role_profiles_set)
+      return true;
+
+   profile = &sthread_role_profiles[role];
+
+   if (!sthread_set_affinity(profile->cpu_mask))
+      ret = false;
+   if (!sthread_set_priority_class(profile->priority))
+      ret = false;
+   return ret;
+}
+
 /**
  * slock_new:
  *
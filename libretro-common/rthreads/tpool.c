@@ -39,10 +39,25 @@ struct tpool_work
 {
    thread_func_t      func;  /* Function to be called. */
    void              *arg;   /* Data to be passed to func. */
+   struct tpool_batch *batch; /* Batch this item helps with, if any. */
    struct tpool_work *next;  /* Next work item in the queue. */
 };
 typedef struct tpool_work tpool_work_t;
 
+/* A tpool_run_batch() call. Lives on the stack of the calling
+ * thread, which only returns once no worker refers to it. */
+struct tpool_batch
+{
+   struct tpool      *tp;
+   tpool_batch_func_t func;
+   void              *userdata;
+   unsigned           count;
+   unsigned           next;     /* Next job to start. */
+   unsigned           pending;  /* Jobs not completed yet. */
+   unsigned           helpers;  /* Workers taken off the queue to help. */
+};
+typedef struct tpool_batch tpool_batch_t;
+
 struct tpool
 {
    tpool_work_t    *work_first;   /* First work item in the work queue. */
@@ -51,11 +66,17 @@ struct tpool
    scond_t         *work_cond;    /* Conditional to signal when there is work to process. */
    scond_t         *working_cond; /* Conditional to signal when there is no work processing.
                                        This will also signal when there are no threads running. */
+   scond_t         *batch_cond;   /* Conditional to signal when a batch has completed. */
    size_t           working_cnt;  /* The number of threads processing work (Not waiting for work). */
    size_t           thread_cnt;   /* Total number of threads within the pool. */
    bool             stop;         /* Marker to tell the work threads to exit. */
 };
 
+/* Pool handed out by tpool_shared(), created on first use. */
+static tpool_t *tpool_shared_pool    = NULL;
+static slock_t *tpool_shared_lock    = NULL;
+static size_t   tpool_shared_threads = 0;
+
 static tpool_work_t *tpool_work_create(thread_func_t func, void *arg)
 {
    tpool_work_t *work;
@@ -64,6 +85,9 @@ static tpool_work_t *tpool_work_create(thread_func_t func, void *arg)
       return NULL;
 
    work       = (tpool_work_t*)calloc(1, sizeof(*work));
+   if (!work)
+      return NULL;
+
    work->func = func;
    work->arg  = arg;
    work->next = NULL;
@@ -99,6 +123,65 @@ static tpool_work_t *tpool_work_get(tpool_t *tp)
    return work;
 }
 
+/* Runs jobs of a batch until none are left to start.
+ * Called with work_mutex held. */
+static void tpool_batch_run_jobs(tpool_t *tp, tpool_batch_t *batch)
+{
+   while (batch->next < batch->count)
+   {
+      unsigned index = batch->next++;
+
+      slock_unlock(tp->work_mutex);
+      batch->func(batch->userdata, index);
+      slock_lock(tp->work_mutex);
+
+      batch->pending--;
+   }
+}
+
+/* Work function of the items queued by tpool_run_batch(). */
+static void tpool_batch_help(void *arg)
+{
+   tpool_batch_t *batch = (tpool_batch_t*)arg;
+   tpool_t       *tp    = batch->tp;
+
+   slock_lock(tp->work_mutex);
+   tpool_batch_run_jobs(tp, batch);
+   /* Last access to the batch, it may be gone once
+    * the lock is released */
+   if (--batch->helpers == 0 && batch->pending == 0)
+      scond_broadcast(tp->batch_cond);
+   slock_unlock(tp->work_mutex);
+}
+
+/* Drops the items of a batch that no worker has taken yet.
+ * Called with work_mutex held. */
+static void tpool_work_remove_batch(tpool_t *tp, tpool_batch_t *batch)
+{
+   tpool_work_t *prev = NULL;
+   tpool_work_t *work = tp->work_first;
+
+   while (work)
+   {
+      tpool_work_t *next = work->next;
+
+      if (work->batch == batch)
+      {
+         if (prev)
+            prev->next     = next;
+         else
+            tp->work_first = next;
+         if (tp->work_last == work)
+            tp->work_last  = prev;
+         tpool_work_destroy(work);
+      }
+      else
+         prev = work;
+
+      work = next;
+   }
+}
+
 static void tpool_worker(void *arg)
 {
    tpool_work_t *work = NULL;
@@ -118,6 +201,10 @@ static void tpool_worker(void *arg)
 
       /* Try to pull work from the queue. */
       work = tpool_work_get(tp);
+      /* The batch must know about this worker before the
+       * lock is released, or it could return without it. */
+      if (work && work->batch)
+         work->batch->helpers++;
       tp->working_cnt++;
       slock_unlock(tp->work_mutex);
 
@@ -165,21 +252,40 @@ tpool_t *tpool_create(size_t num)
       num = 2;
 
    tp               = (tpool_t*)calloc(1, sizeof(*tp));
-   tp->thread_cnt   = num;
+   if (!tp)
+      return NULL;
 
    tp->work_mutex   = slock_new();
    tp->work_cond    = scond_new();
    tp->working_cond = scond_new();
+   tp->batch_cond   = scond_new();
 
    tp->work_first   = NULL;
    tp->work_last    = NULL;
 
-   /* Create the requested number of thread and detach them. */
+   if (!tp->work_mutex || !tp->work_cond || !tp->working_cond
+         || !tp->batch_cond)
+   {
+      slock_free(tp->work_mutex);
+      scond_free(tp->work_cond);
+      scond_free(tp->working_cond);
+      scond_free(tp->batch_cond);
+      free(tp);
+      return NULL;
+   }
+
+   /* Create the requested number of thread and detach them.
+    * Only threads that could be created are counted, or
+    * tpool_destroy() would wait for them forever. */
+   slock_lock(tp->work_mutex);
    for (i = 0; i < num; i++)
    {
-      thread = sthread_create(tpool_worker, tp);
+      if (!(thread = sthread_create(tpool_worker, tp)))
+         break;
+      tp->thread_cnt++;
       sthread_detach(thread);
    }
+   slock_unlock(tp->work_mutex);
 
    return tp;
 }
@@ -213,6 +319,7 @@ void tpool_destroy(tpool_t *tp)
    slock_free(tp->work_mutex);
    scond_free(tp->work_cond);
    scond_free(tp->working_cond);
+   scond_free(tp->batch_cond);
 
    free(tp);
 }
@@ -266,3 +373,101 @@ void tpool_wait(tpool_t *tp)
 
    slock_unlock(tp->work_mutex);
 }
+
+void tpool_run_batch(tpool_t *tp, tpool_batch_func_t func,
+      void *userdata, unsigned count)
+{
+   size_t i;
+   size_t helpers;
+   tpool_batch_t batch;
+
+   if (!func)
+      return;
+
+   if (!tp || count < 2)
+   {
+      for (i = 0; i < count; i++)
+         func(userdata, (unsigned)i);
+      return;
+   }
+
+   batch.tp       = tp;
+   batch.func     = func;
+   batch.userdata = userdata;
+   batch.count    = count;
+   batch.next     = 0;
+   batch.pending  = count;
+   batch.helpers  = 0;
+
+   slock_lock(tp->work_mutex);
+
+   /* The calling thread takes jobs as well, so one helper
+    * fewer than there are jobs is enough */
+   helpers = tp->thread_cnt;
+   if (helpers > count - 1)
+      helpers = count - 1;
+
+   for (i = 0; i < helpers; i++)
+   {
+      tpool_work_t *work = tpool_work_create(tpool_batch_help, &batch);
+
+      if (!work)
+         break;
+
+      work->batch = &batch;
+      if (!tp->work_first)
+         tp->work_first      = work;
+      else
+         tp->work_last->next = work;
+      tp->work_last          = work;
+   }
+
+   scond_broadcast(tp->work_cond);
+
+   tpool_batch_run_jobs(tp, &batch);
+
+   /* Helpers still in the queue would find nothing left to do */
+   tpool_work_remove_batch(tp, &batch);
+
+   while (batch.pending || batch.helpers)
+      scond_wait(tp->batch_cond, tp->work_mutex);
+
+   slock_unlock(tp->work_mutex);
+}
+
+void tpool_shared_init(size_t num)
+{
+   tpool_shared_deinit();
+
+   if (!num || !(tpool_shared_lock = slock_new()))
+      return;
+
+   tpool_shared_threads = num;
+}
+
+void tpool_shared_deinit(void)
+{
+   tpool_destroy(tpool_shared_pool);
+   tpool_shared_pool    = NULL;
+
+   if (tpool_shared_lock)
+      slock_free(tpool_shared_lock);
+   tpool_shared_lock    = NULL;
+   tpool_shared_threads = 0;
+}
+
+tpool_t *tpool_shared(void)
+{
+   tpool_t *tp;
+
+   if (!tpool_shared_lock)
+      return NULL;
+
+   slock_lock(tpool_shared_lock);
+   if (!tpool_shared_pool)
+      tpool_shared_pool = tpool_create(tpool_shared_threads);
+   tp = tpool_shared_pool;
+   slock_unlock(tpool_shared_lock);
+
+   return tp;
+}
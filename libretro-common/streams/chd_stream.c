@@ -26,6 +26,14 @@
 
 #include <boolean.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include <streams/chd_stream.h>
 #include <retro_endianness.h>
 #include <libchdr/chd.h>
@@ -35,11 +43,42 @@
 #define SUBCODE_SIZE 96
 #define TRACK_PAD 4
 
+/* Number of decompressed hunks kept around - scanners
+ * and hashers seek back and forth between a few spots */
+#define CHDSTREAM_CACHE_HUNKS 8
+
+typedef struct chdstream_hunk
+{
+   uint8_t *mem;
+   /* Hunk held, -1 if none */
+   int32_t hunknum;
+   /* Value of 'use_count' when last used */
+   uint32_t last_use;
+} chdstream_hunk_t;
+
 struct chdstream
 {
    chd_file *chd;
-   /* Loaded hunk */
+   /* Loaded hunk, one of 'cache' */
    uint8_t *hunkmem;
+   /* Most recently used hunks */
+   chdstream_hunk_t cache[CHDSTREAM_CACHE_HUNKS];
+#ifdef HAVE_THREADS
+   /* Reads the hunk after the loaded one
+    * ahead, while sequential reads go on.
+    * Started on the first sequential read */
+   sthread_t *thread;
+   /* Protects 'cache', 'use_count', 'chd' and
+    * the members below */
+   slock_t *lock;
+   scond_t *cond;
+   /* Hunk the thread should read, -1 if none */
+   int32_t ahead_hunknum;
+   /* Entry of 'cache' the thread is reading
+    * into, -1 if none */
+   int32_t loading;
+   bool quit;
+#endif
    /* Byte offset where track data starts (after pregap) */
    size_t track_start;
    /* Byte offset where track data ends */
@@ -54,6 +93,8 @@ struct chdstream
    uint32_t frame_offset;
    /* Number of frames per hunk */
    uint32_t frames_per_hunk;
+   /* Bumped on every cache access */
+   uint32_t use_count;
    /* First frame of track in chd */
    uint32_t track_frame;
    /* Should we swap bytes? */
@@ -207,8 +248,8 @@ chdstream_find_track(chd_file *fd, int32_t track, metadata_t *meta)
 chdstream_t *chdstream_open(const char *path, int32_t track)
 {
    metadata_t meta;
+   unsigned i;
    uint32_t pregap         = 0;
-   uint8_t *hunkmem        = NULL;
    const chd_header *hd    = NULL;
    chdstream_t *stream     = NULL;
    chd_file *chd           = NULL;
@@ -220,7 +261,7 @@ chdstream_t *chdstream_open(const char *path, int32_t track)
    if (!chdstream_find_track(chd, track, &meta))
       goto error;
 
-   stream                  = (chdstream_t*)malloc(sizeof(*stream));
+   stream                  = (chdstream_t*)calloc(1, sizeof(*stream));
    if (!stream)
       goto error;
 
@@ -235,13 +276,28 @@ chdstream_t *chdstream_open(const char *path, int32_t track)
    stream->offset          = 0;
    stream->hunkmem         = NULL;
    stream->hunknum         = -1;
+   stream->use_count       = 0;
 
    hd                      = chd_get_header(chd);
-   hunkmem                 = (uint8_t*)malloc(hd->hunkbytes);
-   if (!hunkmem)
-      goto error;
 
-   stream->hunkmem         = hunkmem;
+   for (i = 0; i < CHDSTREAM_CACHE_HUNKS; i++)
+   {
+      stream->cache[i].hunknum  = -1;
+      stream->cache[i].last_use = 0;
+      if (!(stream->cache[i].mem = (uint8_t*)malloc(hd->hunkbytes)))
+         goto error;
+   }
+
+#ifdef HAVE_THREADS
+   stream->thread          = NULL;
+   stream->ahead_hunknum   = -1;
+   stream->loading         = -1;
+   stream->quit            = false;
+   stream->lock            = slock_new();
+   stream->cond            = scond_new();
+   if (!stream->lock || !stream->cond)
+      goto error;
+#endif
 
    if (string_is_equal(meta.type, "MODE1_RAW"))
       stream->frame_size   = SECTOR_SIZE;
@@ -280,38 +336,225 @@ error:
 
 void chdstream_close(chdstream_t *stream)
 {
+   unsigned i;
+
    if (!stream)
       return;
 
-   if (stream->hunkmem)
-      free(stream->hunkmem);
+#ifdef HAVE_THREADS
+   if (stream->thread)
+   {
+      slock_lock(stream->lock);
+      stream->quit = true;
+      scond_broadcast(stream->cond);
+      slock_unlock(stream->lock);
+
+      sthread_join(stream->thread);
+   }
+   if (stream->cond)
+      scond_free(stream->cond);
+   if (stream->lock)
+      slock_free(stream->lock);
+#endif
+
+   for (i = 0; i < CHDSTREAM_CACHE_HUNKS; i++)
+      if (stream->cache[i].mem)
+         free(stream->cache[i].mem);
    if (stream->chd)
       chd_close(stream->chd);
    free(stream);
 }
 
+static void chdstream_swab(uint8_t *mem, uint32_t bytes)
+{
+   uint32_t i = 0;
+#if defined(__SSE2__)
+   for (; i + 16 <= bytes; i += 16)
+   {
+      __m128i v = _mm_loadu_si128((const __m128i*)(mem + i));
+      _mm_storeu_si128((__m128i*)(mem + i),
+            _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+   }
+#endif
+   /* Two at a time otherwise */
+   for (; i + 4 <= bytes; i += 4)
+   {
+      uint32_t v;
+      memcpy(&v, mem + i, sizeof(v));
+      v = ((v & 0x00FF00FF) << 8) | ((v >> 8) & 0x00FF00FF);
+      memcpy(mem + i, &v, sizeof(v));
+   }
+   for (; i + 2 <= bytes; i += 2)
+   {
+      uint8_t tmp = mem[i];
+      mem[i]      = mem[i + 1];
+      mem[i + 1]  = tmp;
+   }
+}
+
+static bool chdstream_decode_hunk(chdstream_t *stream,
+      uint8_t *mem, uint32_t hunknum)
+{
+   if (chd_read(stream->chd, hunknum, mem) != CHDERR_NONE)
+      return false;
+
+   if (stream->swab)
+      chdstream_swab(mem, chd_get_header(stream->chd)->hunkbytes);
+
+   return true;
+}
+
+/* Returns the cache entry holding 'hunknum', or -1 */
+static int chdstream_find_hunk(chdstream_t *stream, uint32_t hunknum)
+{
+   int i;
+
+   for (i = 0; i < CHDSTREAM_CACHE_HUNKS; i++)
+   {
+#ifdef HAVE_THREADS
+      if (i == stream->loading)
+         continue;
+#endif
+      if (stream->cache[i].hunknum == (int32_t)hunknum)
+         return i;
+   }
+
+   return -1;
+}
+
+/* Returns the least recently used cache entry,
+ * other than the loaded one */
+static int chdstream_evict_hunk(chdstream_t *stream)
+{
+   int i;
+   int victim = -1;
+
+   for (i = 0; i < CHDSTREAM_CACHE_HUNKS; i++)
+   {
+#ifdef HAVE_THREADS
+      if (i == stream->loading)
+         continue;
+#endif
+      if (stream->cache[i].mem == stream->hunkmem)
+         continue;
+
+      if (stream->cache[i].hunknum < 0)
+         return i;
+
+      if (victim < 0 || stream->cache[i].last_use
+            < stream->cache[victim].last_use)
+         victim = i;
+   }
+
+   stream->cache[victim].hunknum = -1;
+   return victim;
+}
+
+#ifdef HAVE_THREADS
+static void chdstream_read_ahead(void *data)
+{
+   chdstream_t *stream = (chdstream_t*)data;
+
+   slock_lock(stream->lock);
+
+   for (;;)
+   {
+      int i;
+      bool ok;
+      uint32_t hunknum;
+
+      while (stream->ahead_hunknum < 0 && !stream->quit)
+         scond_wait(stream->cond, stream->lock);
+
+      if (stream->quit)
+         break;
+
+      hunknum               = (uint32_t)stream->ahead_hunknum;
+      stream->ahead_hunknum = -1;
+
+      if (chdstream_find_hunk(stream, hunknum) >= 0)
+         continue;
+
+      i                         = chdstream_evict_hunk(stream);
+      stream->cache[i].hunknum  = hunknum;
+      stream->loading           = i;
+
+      /* The reader leaves 'chd' alone while 'loading' is set */
+      slock_unlock(stream->lock);
+      ok = chdstream_decode_hunk(stream, stream->cache[i].mem, hunknum);
+      slock_lock(stream->lock);
+
+      if (ok)
+         stream->cache[i].last_use = ++stream->use_count;
+      else
+         stream->cache[i].hunknum  = -1;
+      stream->loading           = -1;
+      scond_broadcast(stream->cond);
+   }
+
+   slock_unlock(stream->lock);
+}
+#endif
+
 static bool
 chdstream_load_hunk(chdstream_t *stream, uint32_t hunknum)
 {
-   uint16_t *array;
+   int i;
+   bool ok = true;
 
    if (hunknum == stream->hunknum)
       return true;
 
-   if (chd_read(stream->chd, hunknum, stream->hunkmem) != CHDERR_NONE)
-      return false;
+#ifdef HAVE_THREADS
+   slock_lock(stream->lock);
 
-   if (stream->swab)
+   /* Wait if the thread is reading this hunk, or
+    * if it is using 'chd' and this one isn't cached */
+   while (stream->loading >= 0
+         && (stream->cache[stream->loading].hunknum == (int32_t)hunknum
+            || chdstream_find_hunk(stream, hunknum) < 0))
+      scond_wait(stream->cond, stream->lock);
+#endif
+
+   if ((i = chdstream_find_hunk(stream, hunknum)) < 0)
    {
-      uint32_t i;
-      uint32_t count = chd_get_header(stream->chd)->hunkbytes / 2;
-      array          = (uint16_t*)stream->hunkmem;
-      for (i = 0; i < count; ++i)
-         array[i] = SWAP16(array[i]);
+      i = chdstream_evict_hunk(stream);
+
+      if ((ok = chdstream_decode_hunk(stream,
+                  stream->cache[i].mem, hunknum)))
+         stream->cache[i].hunknum = hunknum;
    }
 
-   stream->hunknum = hunknum;
-   return true;
+   if (ok)
+   {
+      stream->cache[i].last_use = ++stream->use_count;
+      stream->hunkmem           = stream->cache[i].mem;
+
+#ifdef HAVE_THREADS
+      /* Reading sequentially, get the next one ready */
+      if (     hunknum == (uint32_t)(stream->hunknum + 1)
+            && hunknum + 1 < chd_get_header(stream->chd)->totalhunks
+            && chdstream_find_hunk(stream, hunknum + 1) < 0)
+      {
+         if (!stream->thread)
+            stream->thread = sthread_create(chdstream_read_ahead, stream);
+
+         if (stream->thread)
+         {
+            stream->ahead_hunknum = hunknum + 1;
+            scond_broadcast(stream->cond);
+         }
+      }
+#endif
+
+      stream->hunknum           = hunknum;
+   }
+
+#ifdef HAVE_THREADS
+   slock_unlock(stream->lock);
+#endif
+
+   return ok;
 }
 
 ssize_t chdstream_read(chdstream_t *stream, void *data, size_t bytes)
@@ -434,16 +677,32 @@ uint32_t chdstream_get_track_start(chdstream_t *stream)
    uint32_t i;
    metadata_t meta;
    uint32_t frame_offset = 0;
+   uint32_t track_start  = 0;
+
+#ifdef HAVE_THREADS
+   /* Metadata is read from the file, which the
+    * read ahead thread may be using */
+   slock_lock(stream->lock);
+   while (stream->loading >= 0)
+      scond_wait(stream->cond, stream->lock);
+#endif
 
    for (i = 0; chdstream_get_meta(stream->chd, i, &meta); ++i)
    {
       if (stream->track_frame == frame_offset)
-         return meta.pregap * stream->frame_size;
+      {
+         track_start = meta.pregap * stream->frame_size;
+         break;
+      }
 
       frame_offset += meta.frames + meta.extra;
    }
 
-   return 0;
+#ifdef HAVE_THREADS
+   slock_unlock(stream->lock);
+#endif
+
+   return track_start;
 }
 
 uint32_t chdstream_get_frame_size(chdstream_t *stream)
@@ -0,0 +1,577 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (inflate_buffer.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <zlib.h>
+#include <retro_endianness.h>
+#include <streams/inflate_buffer.h>
+
+/* Decoding tables are looked up with this many bits, longer
+ * codes continue in a subtable. The sizes are the worst cases
+ * for these lookup widths, as computed by zlib's 'enough'. */
+#define INFLATE_LITLEN_BITS   11
+#define INFLATE_LITLEN_ENOUGH 2342
+#define INFLATE_DIST_BITS     8
+#define INFLATE_DIST_ENOUGH   402
+#define INFLATE_PRECODE_BITS  7
+
+#define INFLATE_NUM_LITLEN    288
+#define INFLATE_NUM_DIST      32
+#define INFLATE_NUM_PRECODE   19
+
+/* A table entry holds the number of bits to consume in bits 0-3,
+ * the kind of entry in bits 4-7, the number of extra bits (or
+ * the size of the subtable) in bits 8-15 and the value in 16-31.
+ * Lengths and distances have no kind bit set. */
+#define INFLATE_LITERAL       0x10
+#define INFLATE_END_OF_BLOCK  0x20
+#define INFLATE_SUBTABLE      0x40
+#define INFLATE_INVALID       0x80
+
+#define INFLATE_ENTRY(value, extra, kind) \
+   (((uint32_t)(value) << 16) | ((uint32_t)(extra) << 8) | (kind))
+
+enum inflate_table_type
+{
+   INFLATE_TABLE_PRECODE = 0,
+   INFLATE_TABLE_LITLEN,
+   INFLATE_TABLE_DIST
+};
+
+typedef struct
+{
+   uint32_t litlen[INFLATE_LITLEN_ENOUGH];
+   uint32_t dist[INFLATE_DIST_ENOUGH];
+   uint32_t precode[1 << INFLATE_PRECODE_BITS];
+   uint8_t lens[INFLATE_NUM_LITLEN + INFLATE_NUM_DIST];
+} inflate_tables_t;
+
+static const uint16_t inflate_length_base[29] = {
+   3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+   35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+static const uint8_t inflate_length_extra[29] = {
+   0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+   3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+static const uint16_t inflate_dist_base[30] = {
+   1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+   257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+   8193, 12289, 16385, 24577
+};
+
+static const uint8_t inflate_dist_extra[30] = {
+   0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+   7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+static const uint8_t inflate_precode_order[INFLATE_NUM_PRECODE] = {
+   16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+static uint32_t inflate_symbol_entry(enum inflate_table_type type,
+      unsigned sym)
+{
+   switch (type)
+   {
+      case INFLATE_TABLE_PRECODE:
+         return INFLATE_ENTRY(sym, 0, 0);
+      case INFLATE_TABLE_LITLEN:
+         if (sym < 256)
+            return INFLATE_ENTRY(sym, 0, INFLATE_LITERAL);
+         if (sym == 256)
+            return INFLATE_ENTRY(0, 0, INFLATE_END_OF_BLOCK);
+         if (sym < 286)
+            return INFLATE_ENTRY(inflate_length_base[sym - 257],
+                  inflate_length_extra[sym - 257], 0);
+         break;
+      case INFLATE_TABLE_DIST:
+         if (sym < 30)
+            return INFLATE_ENTRY(inflate_dist_base[sym],
+                  inflate_dist_extra[sym], 0);
+         break;
+   }
+
+   return INFLATE_INVALID;
+}
+
+/* Builds a decoding table for the canonical code given by @lens,
+ * the same way zlib's inflate_table() does. The only incomplete
+ * code allowed is a single code of one bit. */
+static bool inflate_build_table(uint32_t *table, unsigned root,
+      unsigned enough, const uint8_t *lens, unsigned num,
+      enum inflate_table_type type)
+{
+   unsigned len, sym, max, curr, drop, used, huff, low, mask;
+   int left;
+   uint16_t count[16];
+   uint16_t offs[16];
+   uint16_t sorted[INFLATE_NUM_LITLEN];
+   uint32_t *next;
+
+   memset(count, 0, sizeof(count));
+   for (sym = 0; sym < num; sym++)
+      count[lens[sym]]++;
+
+   for (max = 15; max >= 1; max--)
+      if (count[max])
+         break;
+
+   /* No codes at all; fine as long as none get used */
+   if (max == 0)
+   {
+      for (sym = 0; sym < (1U << root); sym++)
+         table[sym] = INFLATE_INVALID;
+      return true;
+   }
+
+   left = 1;
+   for (len = 1; len <= 15; len++)
+   {
+      left <<= 1;
+      left  -= count[len];
+      if (left < 0)
+         return false;
+   }
+
+   if (left > 0)
+   {
+      if (type == INFLATE_TABLE_PRECODE || max != 1)
+         return false;
+      for (sym = 0; sym < (1U << root); sym++)
+         table[sym] = INFLATE_INVALID;
+   }
+
+   offs[1] = 0;
+   for (len = 1; len < 15; len++)
+      offs[len + 1] = offs[len] + count[len];
+   for (sym = 0; sym < num; sym++)
+      if (lens[sym])
+         sorted[offs[lens[sym]]++] = sym;
+
+   for (len = 1; !count[len]; len++);
+
+   huff = 0;
+   sym  = 0;
+   next = table;
+   curr = root;
+   drop = 0;
+   low  = (unsigned)-1;
+   used = 1U << root;
+   mask = used - 1;
+
+   for (;;)
+   {
+      uint32_t entry;
+      unsigned incr, fill;
+
+      /* Codes longer than the root table start a new subtable
+       * whenever their first 'root' bits change */
+      if (len > root && (huff & mask) != low)
+      {
+         if (drop == 0)
+            drop = root;
+         next += 1U << curr;
+
+         curr  = len - drop;
+         left  = (int)(1 << curr);
+         while (curr + drop < max)
+         {
+            left -= count[curr + drop];
+            if (left <= 0)
+               break;
+            curr++;
+            left <<= 1;
+         }
+
+         used += 1U << curr;
+         if (used > enough)
+            return false;
+
+         low        = huff & mask;
+         table[low] = INFLATE_ENTRY(next - table, curr, INFLATE_SUBTABLE);
+      }
+
+      entry = inflate_symbol_entry(type, sorted[sym]) | (len - drop);
+      incr  = 1U << (len - drop);
+      fill  = 1U << curr;
+      do
+      {
+         fill -= incr;
+         next[(huff >> drop) + fill] = entry;
+      } while (fill != 0);
+
+      /* Increment the bit-reversed code */
+      incr = 1U << (len - 1);
+      while (huff & incr)
+         incr >>= 1;
+      if (incr != 0)
+      {
+         huff &= incr - 1;
+         huff += incr;
+      }
+      else
+         huff = 0;
+
+      sym++;
+      if (--count[len] == 0)
+      {
+         if (len == max)
+            break;
+         len = lens[sorted[sym]];
+      }
+   }
+
+   return true;
+}
+
+/* Keeps at least 48 bits in the bit buffer, which covers the
+ * longest length/distance pair. Past the end of the input zeros
+ * are shifted in; 'overrun' counts them so that reading into
+ * them can be told apart from a stream that ends in time.
+ *
+ * The word-sized load puts more bits in the buffer than
+ * 'bitsleft' accounts for. Those are the bits of the next input
+ * byte, which the following refill ORs in at the same place. */
+#define INFLATE_REFILL() \
+   if (bitsleft < 48) \
+   { \
+      if (in_end - in >= 8) \
+      { \
+         bitbuf   |= retro_get_unaligned_64le((void*)in) << bitsleft; \
+         in       += (63 - bitsleft) >> 3; \
+         bitsleft |= 56; \
+      } \
+      else \
+      { \
+         while (bitsleft <= 56) \
+         { \
+            if (in < in_end) \
+               bitbuf |= (uint64_t)*in++ << bitsleft; \
+            else if (++overrun > 8) \
+               goto error; \
+            bitsleft += 8; \
+         } \
+      } \
+   }
+
+#define INFLATE_BITS(n) ((unsigned)bitbuf & ((1U << (n)) - 1))
+
+#define INFLATE_DROP(n) \
+   bitbuf   >>= (n); \
+   bitsleft  -= (n)
+
+/* Gives back the whole bytes read ahead into the bit buffer */
+#define INFLATE_ALIGN() \
+   INFLATE_DROP(bitsleft & 7); \
+   if ((bitsleft >> 3) < overrun) \
+      goto error; \
+   in      -= (bitsleft >> 3) - overrun; \
+   bitbuf   = 0; \
+   bitsleft = 0; \
+   overrun  = 0
+
+bool inflate_buffer(const uint8_t *in, size_t in_size,
+      uint8_t *out, size_t out_size, int window_bits,
+      size_t *in_used, size_t *out_used)
+{
+   inflate_tables_t *t;
+   const uint8_t *in_start = in;
+   const uint8_t *in_end   = in + in_size;
+   uint8_t *out_ptr        = out;
+   uint8_t *out_end        = out + out_size;
+   uint64_t bitbuf         = 0;
+   unsigned bitsleft       = 0;
+   unsigned overrun        = 0;
+   unsigned final_block    = 0;
+
+   /* Raw deflate or zlib; gzip is left to zlib */
+   if (window_bits < -15 || window_bits > 15)
+      return false;
+
+   if (window_bits >= 0)
+   {
+      if (     in_size < 6
+            || (in[0] & 0x0f) != Z_DEFLATED
+            || (in[0] >> 4) > 7
+            || (in[1] & 0x20)
+            || ((in[0] << 8) | in[1]) % 31)
+         return false;
+      in += 2;
+   }
+
+   if (!(t = (inflate_tables_t*)malloc(sizeof(*t))))
+      return false;
+
+   do
+   {
+      unsigned type;
+
+      INFLATE_REFILL();
+      final_block = INFLATE_BITS(1);
+      INFLATE_DROP(1);
+      type        = INFLATE_BITS(2);
+      INFLATE_DROP(2);
+
+      if (type == 0)
+      {
+         unsigned len;
+
+         INFLATE_ALIGN();
+
+         if (in_end - in < 4)
+            goto error;
+         len = in[0] | (in[1] << 8);
+         if (len != (~(in[2] | (in[3] << 8)) & 0xffff))
+            goto error;
+         in += 4;
+
+         if (     (size_t)(in_end - in)       < len
+               || (size_t)(out_end - out_ptr) < len)
+            goto error;
+         memcpy(out_ptr, in, len);
+         in      += len;
+         out_ptr += len;
+         continue;
+      }
+      else if (type == 1)
+      {
+         memset(t->lens,       8, 144);
+         memset(t->lens + 144, 9, 112);
+         memset(t->lens + 256, 7, 24);
+         memset(t->lens + 280, 8, 8);
+         memset(t->lens + INFLATE_NUM_LITLEN, 5, INFLATE_NUM_DIST);
+
+         if (     !inflate_build_table(t->litlen, INFLATE_LITLEN_BITS,
+                     INFLATE_LITLEN_ENOUGH, t->lens, INFLATE_NUM_LITLEN,
+                     INFLATE_TABLE_LITLEN)
+               || !inflate_build_table(t->dist, INFLATE_DIST_BITS,
+                     INFLATE_DIST_ENOUGH, t->lens + INFLATE_NUM_LITLEN,
+                     INFLATE_NUM_DIST, INFLATE_TABLE_DIST))
+            goto error;
+      }
+      else if (type == 2)
+      {
+         unsigned i, n, num_litlen, num_dist, num_precode;
+
+         num_litlen  = INFLATE_BITS(5) + 257;
+         INFLATE_DROP(5);
+         num_dist    = INFLATE_BITS(5) + 1;
+         INFLATE_DROP(5);
+         num_precode = INFLATE_BITS(4) + 4;
+         INFLATE_DROP(4);
+
+         if (num_litlen > 286 || num_dist > 30)
+            goto error;
+
+         memset(t->lens, 0, INFLATE_NUM_PRECODE);
+         for (i = 0; i < num_precode; i++)
+         {
+            INFLATE_REFILL();
+            t->lens[inflate_precode_order[i]] = INFLATE_BITS(3);
+            INFLATE_DROP(3);
+         }
+
+         if (!inflate_build_table(t->precode, INFLATE_PRECODE_BITS,
+                  1 << INFLATE_PRECODE_BITS, t->lens, INFLATE_NUM_PRECODE,
+                  INFLATE_TABLE_PRECODE))
+            goto error;
+
+         /* Code lengths of both codes, run-length coded
+          * with the precode. Runs may span the two. */
+         for (n = 0; n < num_litlen + num_dist; )
+         {
+            unsigned sym, rep, val;
+            uint32_t entry;
+
+            INFLATE_REFILL();
+            entry = t->precode[INFLATE_BITS(INFLATE_PRECODE_BITS)];
+            if (entry & INFLATE_INVALID)
+               goto error;
+            INFLATE_DROP(entry & 15);
+
+            sym = entry >> 16;
+            if (sym < 16)
+            {
+               t->lens[n++] = sym;
+               continue;
+            }
+
+            if (sym == 16)
+            {
+               if (n == 0)
+                  goto error;
+               val = t->lens[n - 1];
+               rep = 3 + INFLATE_BITS(2);
+               INFLATE_DROP(2);
+            }
+            else if (sym == 17)
+            {
+               val = 0;
+               rep = 3 + INFLATE_BITS(3);
+               INFLATE_DROP(3);
+            }
+            else
+            {
+               val = 0;
+               rep = 11 + INFLATE_BITS(7);
+               INFLATE_DROP(7);
+            }
+
+            if (n + rep > num_litlen + num_dist)
+               goto error;
+            memset(t->lens + n, val, rep);
+            n += rep;
+         }
+
+         if (     !t->lens[256]
+               || !inflate_build_table(t->litlen, INFLATE_LITLEN_BITS,
+                     INFLATE_LITLEN_ENOUGH, t->lens, num_litlen,
+                     INFLATE_TABLE_LITLEN)
+               || !inflate_build_table(t->dist, INFLATE_DIST_BITS,
+                     INFLATE_DIST_ENOUGH, t->lens + num_litlen,
+                     num_dist, INFLATE_TABLE_DIST))
+            goto error;
+      }
+      else
+         goto error;
+
+      for (;;)
+      {
+         uint32_t entry;
+         unsigned extra, length, dist;
+         const uint8_t *src;
+         uint8_t *dst_end;
+
+         INFLATE_REFILL();
+
+         entry = t->litlen[INFLATE_BITS(INFLATE_LITLEN_BITS)];
+         if (entry & INFLATE_SUBTABLE)
+         {
+            INFLATE_DROP(INFLATE_LITLEN_BITS);
+            entry = t->litlen[(entry >> 16)
+               + INFLATE_BITS((entry >> 8) & 0xff)];
+         }
+         INFLATE_DROP(entry & 15);
+
+         if (entry & INFLATE_LITERAL)
+         {
+            if (out_ptr == out_end)
+               goto error;
+            *out_ptr++ = (uint8_t)(entry >> 16);
+            continue;
+         }
+
+         if (entry & INFLATE_INVALID)
+            goto error;
+         if (entry & INFLATE_END_OF_BLOCK)
+            break;
+
+         extra  = (entry >> 8) & 0xff;
+         length = (entry >> 16) + INFLATE_BITS(extra);
+         INFLATE_DROP(extra);
+
+         entry = t->dist[INFLATE_BITS(INFLATE_DIST_BITS)];
+         if (entry & INFLATE_SUBTABLE)
+         {
+            INFLATE_DROP(INFLATE_DIST_BITS);
+            entry = t->dist[(entry >> 16)
+               + INFLATE_BITS((entry >> 8) & 0xff)];
+         }
+         if (entry & INFLATE_INVALID)
+            goto error;
+         INFLATE_DROP(entry & 15);
+
+         extra  = (entry >> 8) & 0xff;
+         dist   = (entry >> 16) + INFLATE_BITS(extra);
+         INFLATE_DROP(extra);
+
+         if (     (size_t)(out_ptr - out)     < dist
+               || (size_t)(out_end - out_ptr) < length)
+            goto error;
+
+         /* The whole output is the window */
+         src     = out_ptr - dist;
+         dst_end = out_ptr + length;
+         if (dist >= 8 && out_end - dst_end >= 8)
+         {
+            /* May write up to 7 bytes past the match,
+             * later output overwrites them */
+            do
+            {
+               memcpy(out_ptr, src, 8);
+               out_ptr += 8;
+               src     += 8;
+            } while (out_ptr < dst_end);
+            out_ptr = dst_end;
+         }
+         else if (dist == 1)
+         {
+            memset(out_ptr, *src, length);
+            out_ptr = dst_end;
+         }
+         else
+         {
+            while (out_ptr < dst_end)
+               *out_ptr++ = *src++;
+         }
+      }
+   } while (!final_block);
+
+   INFLATE_ALIGN();
+
+   if (window_bits >= 0)
+   {
+      uLong adler      = adler32(0L, Z_NULL, 0);
+      const uint8_t *p = out;
+      size_t remaining = out_ptr - out;
+
+      while (remaining)
+      {
+         uInt chunk = remaining > 0x40000000 ? 0x40000000 : (uInt)remaining;
+         adler      = adler32(adler, p, chunk);
+         p         += chunk;
+         remaining -= chunk;
+      }
+
+      if (in_end - in < 4 || (uint32_t)adler != (
+                 ((uint32_t)in[0] << 24) | ((uint32_t)in[1] << 16)
+               | ((uint32_t)in[2] << 8)  |  (uint32_t)in[3]))
+         goto error;
+      in += 4;
+   }
+
+   free(t);
+
+   if (in_used)
+      *in_used  = in - in_start;
+   *out_used    = out_ptr - out;
+   return true;
+
+error:
+   free(t);
+   return false;
+}
@@ -28,6 +28,11 @@
 
 #include <streams/rzip_stream.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/tpool.h>
+#include <features/features_cpu.h>
+#endif
+
 /* Current RZIP file format version */
 #define RZIP_VERSION 1
 
@@ -44,6 +49,26 @@
 #define RZIP_HEADER_SIZE 20
 #define RZIP_CHUNK_HEADER_SIZE 4
 
+/* Maximum number of chunks that are (de)compressed
+ * at once - one per thread */
+#define RZIP_MAX_JOBS 8
+
+/* Compresses or decompresses a single chunk
+ * > Chunks are independent zlib streams, so any
+ *   number of jobs may run in parallel */
+typedef struct rzipstream_job
+{
+   const struct trans_stream_backend *backend;
+   void *trans_stream;
+   const uint8_t *in;
+   uint8_t *out;
+   uint32_t in_size;
+   uint32_t out_size;
+   uint32_t read;
+   uint32_t written;
+   bool success;
+} rzipstream_job_t;
+
 /* Holds all metadata for an RZIP file stream */
 struct rzipstream
 {
@@ -58,6 +83,10 @@ struct rzipstream
    void *inflate_stream;
    uint8_t *in_buf;
    uint8_t *out_buf;
+   /* Compressed data is buffered for 'num_jobs'
+    * chunks at a time, and handled by one job each */
+   rzipstream_job_t *jobs;
+   unsigned num_jobs;
    uint32_t in_buf_size;
    uint32_t in_buf_ptr;
    uint32_t out_buf_size;
@@ -200,6 +229,96 @@ static bool rzipstream_write_file_header(rzipstream_t *stream)
 
 /* Stream Initialisation/De-initialisation */
 
+/* Returns the number of chunks to (de)compress in
+ * parallel - one per core, as long as the buffers
+ * of a batch can still be addressed */
+static unsigned rzipstream_get_num_jobs(uint32_t chunk_size)
+{
+   unsigned num_jobs = 1;
+#ifdef HAVE_THREADS
+   num_jobs = cpu_features_get_core_amount();
+
+   if (num_jobs > RZIP_MAX_JOBS)
+      num_jobs = RZIP_MAX_JOBS;
+
+   while ((num_jobs > 1) &&
+          ((uint64_t)chunk_size * 2 * num_jobs + 11 > 0xFFFFFFFF))
+      num_jobs--;
+#endif
+   return (num_jobs > 0) ? num_jobs : 1;
+}
+
+/* Gives each job its own transform stream
+ * > The first job shares the stream's own */
+static bool rzipstream_init_jobs(rzipstream_t *stream,
+      const struct trans_stream_backend *backend, void *trans_stream)
+{
+   unsigned i;
+
+   for (i = 0; i < stream->num_jobs; i++)
+   {
+      rzipstream_job_t *job = &stream->jobs[i];
+
+      job->backend      = backend;
+      job->trans_stream = trans_stream;
+
+      if (i == 0)
+         continue;
+
+      if (!(job->trans_stream = backend->stream_new()))
+         return false;
+
+      if (stream->is_writing &&
+          !backend->define(job->trans_stream,
+               "level", RZIP_COMPRESSION_LEVEL))
+         return false;
+   }
+
+   return true;
+}
+
+static void rzipstream_run_job(void *data)
+{
+   rzipstream_job_t *job = (rzipstream_job_t*)data;
+
+   job->read    = 0;
+   job->written = 0;
+
+   job->backend->set_in(job->trans_stream, job->in, job->in_size);
+   job->backend->set_out(job->trans_stream, job->out, job->out_size);
+
+   /* Note: We have to set 'flush == true' here, otherwise we
+    * can't guarantee that the entire chunk will be written
+    * to the output buffer - this is inefficient, but not
+    * much we can do... */
+   job->success = job->backend->trans(job->trans_stream, true,
+         &job->read, &job->written, NULL);
+}
+
+#ifdef HAVE_THREADS
+static void rzipstream_run_job_index(void *data, unsigned index)
+{
+   rzipstream_run_job(&((rzipstream_job_t*)data)[index]);
+}
+#endif
+
+/* Runs the first 'count' jobs, on pool
+ * threads where available */
+static void rzipstream_run_jobs(rzipstream_t *stream, unsigned count)
+{
+#ifdef HAVE_THREADS
+   /* All streams share one pool - without
+    * it, the jobs run in turn */
+   tpool_run_batch(count > 1 ? tpool_shared() : NULL,
+         rzipstream_run_job_index, stream->jobs, count);
+#else
+   unsigned i;
+
+   for (i = 0; i < count; i++)
+      rzipstream_run_job(&stream->jobs[i]);
+#endif
+}
+
 /* Initialises all members of an rzipstream_t struct,
  * reading config from existing file header if available */
 static bool rzipstream_init_stream(
@@ -225,6 +344,8 @@ static bool rzipstream_init_stream(
    stream->out_buf_size      = 0;
    stream->out_buf_ptr       = 0;
    stream->out_buf_occupancy = 0;
+   stream->jobs              = NULL;
+   stream->num_jobs          = 1;
 
    /* Check whether this is a read or write stream */
    stream->is_writing = is_writing;
@@ -263,6 +384,15 @@ static bool rzipstream_init_stream(
 
    /* Initialise appropriate transform stream
     * and determine associated buffer sizes */
+   if (stream->is_writing || stream->is_compressed)
+   {
+      stream->num_jobs = rzipstream_get_num_jobs(stream->chunk_size);
+      stream->jobs     = (rzipstream_job_t*)calloc(
+            stream->num_jobs, sizeof(rzipstream_job_t));
+      if (!stream->jobs)
+         return false;
+   }
+
    if (stream->is_writing)
    {
       /* Compression */
@@ -279,6 +409,10 @@ static bool rzipstream_init_stream(
             stream->deflate_stream, "level", RZIP_COMPRESSION_LEVEL))
          return false;
 
+      if (!rzipstream_init_jobs(stream,
+            stream->deflate_backend, stream->deflate_stream))
+         return false;
+
       /* Buffers
        * > Input: uncompressed
        * > Output: compressed */
@@ -291,6 +425,11 @@ static bool rzipstream_init_stream(
                   stream->out_buf_size + 11 :
                   stream->out_buf_size;
 
+      /* Each job gets a chunk-sized slice
+       * of both buffers */
+      stream->in_buf_size  *= stream->num_jobs;
+      stream->out_buf_size *= stream->num_jobs;
+
       /* Redundant safety check */
       if ((stream->in_buf_size == 0) ||
           (stream->out_buf_size == 0))
@@ -309,6 +448,10 @@ static bool rzipstream_init_stream(
       if (!stream->inflate_stream)
          return false;
 
+      if (!rzipstream_init_jobs(stream,
+            stream->inflate_backend, stream->inflate_stream))
+         return false;
+
       /* Buffers
        * > Input: compressed
        * > Output: uncompressed
@@ -318,9 +461,13 @@ static bool rzipstream_init_stream(
        * Note 2: If file header is valid, output buffer
        *         should have a size of exactly stream->chunk_size.
        *         Allocate some additional space, just for
-       *         redundant safety... */
+       *         redundant safety...
+       * Note 3: Decompressed chunks of a batch are placed
+       *         back to back, and only the last one may
+       *         use the additional space */
       stream->in_buf_size  = stream->chunk_size * 2;
-      stream->out_buf_size = stream->chunk_size + (stream->chunk_size >> 2);
+      stream->out_buf_size = stream->chunk_size * stream->num_jobs
+            + (stream->chunk_size >> 2);
 
       /* Redundant safety check */
       if ((stream->in_buf_size == 0) ||
@@ -355,6 +502,19 @@ static int rzipstream_free_stream(rzipstream_t *stream)
    if (!stream)
       return -1;
 
+   /* Free job transform streams
+    * > The first one belongs to the stream itself */
+   if (stream->jobs)
+   {
+      unsigned i;
+      for (i = 1; i < stream->num_jobs; i++)
+         if (stream->jobs[i].trans_stream)
+            stream->jobs[i].backend->stream_free(
+                  stream->jobs[i].trans_stream);
+      free(stream->jobs);
+   }
+   stream->jobs = NULL;
+
    /* Free transform streams */
    if (stream->deflate_stream && stream->deflate_backend)
       stream->deflate_backend->stream_free(stream->deflate_stream);
@@ -436,6 +596,8 @@ rzipstream_t* rzipstream_open(const char *path, unsigned mode)
    stream->out_buf_size    = 0;
    stream->out_buf_ptr     = 0;
    stream->out_buf_occupancy = 0;
+   stream->jobs            = NULL;
+   stream->num_jobs        = 1;
 
    /* Initialise stream */
    if (!rzipstream_init_stream(
@@ -451,90 +613,132 @@ rzipstream_t* rzipstream_open(const char *path, unsigned mode)
 
 /* File Read */
 
-/* Reads and decompresses the next chunk of data
- * in the RZIP file */
-static bool rzipstream_read_chunk(rzipstream_t *stream)
+/* Reads and decompresses the next batch of (up to
+ * 'num_jobs') chunks in the RZIP file, starting at
+ * uncompressed offset 'offset'
+ * > The batch is cut short once it holds 'len' bytes */
+static bool rzipstream_read_chunks(rzipstream_t *stream,
+      uint64_t offset, uint64_t len)
 {
    unsigned i;
-   int64_t length;
-   uint8_t chunk_header_bytes[RZIP_CHUNK_HEADER_SIZE];
-   uint32_t compressed_chunk_size;
-   uint32_t inflate_read;
-   uint32_t inflate_written;
+   unsigned count;
+   uint64_t num_chunks;
+   uint32_t in_buf_ptr = 0;
 
-   if (!stream || !stream->inflate_backend || !stream->inflate_stream)
+   if (!stream || !stream->inflate_backend || !stream->jobs)
       return false;
 
-   for (i = 0; i < RZIP_CHUNK_HEADER_SIZE; i++)
-      chunk_header_bytes[i] = 0;
-
-   /* Attempt to read chunk header bytes */
-   length = filestream_read(
-         stream->file, chunk_header_bytes, sizeof(chunk_header_bytes));
-   if (length != RZIP_CHUNK_HEADER_SIZE)
+   if (offset >= stream->size)
       return false;
 
-   /* Get size of next compressed chunk */
-   compressed_chunk_size = ((uint32_t)chunk_header_bytes[3] << 24) |
-                           ((uint32_t)chunk_header_bytes[2] << 16) |
-                           ((uint32_t)chunk_header_bytes[1] <<  8) |
-                            (uint32_t)chunk_header_bytes[0];
-   if (compressed_chunk_size == 0)
+   /* Never read beyond the last chunk */
+   num_chunks = (stream->size - offset + stream->chunk_size - 1) /
+         stream->chunk_size;
+   if (num_chunks > (len + stream->chunk_size - 1) / stream->chunk_size)
+      num_chunks = (len + stream->chunk_size - 1) / stream->chunk_size;
+   count      = (num_chunks < stream->num_jobs) ?
+         (unsigned)num_chunks : stream->num_jobs;
+
+   if (count == 0)
       return false;
 
-   /* Resize input buffer, if required */
-   if (compressed_chunk_size > stream->in_buf_size)
+   for (i = 0; i < count; i++)
    {
-      free(stream->in_buf);
-      stream->in_buf      = NULL;
+      int64_t length;
+      uint8_t chunk_header_bytes[RZIP_CHUNK_HEADER_SIZE];
+      uint32_t compressed_chunk_size;
+
+      /* Attempt to read chunk header bytes */
+      length = filestream_read(
+            stream->file, chunk_header_bytes, sizeof(chunk_header_bytes));
+      if (length != RZIP_CHUNK_HEADER_SIZE)
+         return false;
 
-      stream->in_buf_size = compressed_chunk_size;
-      stream->in_buf      = (uint8_t *)calloc(stream->in_buf_size, 1);
-      if (!stream->in_buf)
+      /* Get size of next compressed chunk */
+      compressed_chunk_size = ((uint32_t)chunk_header_bytes[3] << 24) |
+                              ((uint32_t)chunk_header_bytes[2] << 16) |
+                              ((uint32_t)chunk_header_bytes[1] <<  8) |
+                               (uint32_t)chunk_header_bytes[0];
+      if (compressed_chunk_size == 0)
+         return false;
+
+      if (compressed_chunk_size > 0xFFFFFFFF - in_buf_ptr)
+         return false;
+
+      /* Grow input buffer, if required
+       * > Earlier chunks of the batch are kept */
+      if (in_buf_ptr + compressed_chunk_size > stream->in_buf_size)
+      {
+         uint32_t new_size = in_buf_ptr + compressed_chunk_size;
+         uint8_t *new_buf  = (uint8_t *)realloc(stream->in_buf, new_size);
+
+         if (!new_buf)
+            return false;
+
+         stream->in_buf      = new_buf;
+         stream->in_buf_size = new_size;
+
+         /* Note: Uncompressed data size is fixed, and read
+          * from the file header - we therefore don't attempt
+          * to resize the output buffer (if it's too small, then
+          * that's an error condition) */
+      }
+
+      /* Read compressed chunk from file */
+      length = filestream_read(
+            stream->file, stream->in_buf + in_buf_ptr,
+            compressed_chunk_size);
+      if (length != compressed_chunk_size)
          return false;
 
-      /* Note: Uncompressed data size is fixed, and read
-       * from the file header - we therefore don't attempt
-       * to resize the output buffer (if it's too small, then
-       * that's an error condition) */
+      /* Input pointers are assigned once the
+       * buffer can no longer move */
+      stream->jobs[i].in_size = compressed_chunk_size;
+      in_buf_ptr             += compressed_chunk_size;
    }
 
-   /* Read compressed chunk from file */
-   length = filestream_read(
-         stream->file, stream->in_buf, compressed_chunk_size);
-   if (length != compressed_chunk_size)
-      return false;
+   /* Each chunk but the last of the batch
+    * decompresses to exactly one chunk_size */
+   in_buf_ptr = 0;
+   for (i = 0; i < count; i++)
+   {
+      rzipstream_job_t *job = &stream->jobs[i];
+
+      job->in       = stream->in_buf + in_buf_ptr;
+      job->out      = stream->out_buf + (size_t)i * stream->chunk_size;
+      job->out_size = (i == count - 1) ?
+            stream->out_buf_size - i * stream->chunk_size :
+            stream->chunk_size;
+      in_buf_ptr   += job->in_size;
+   }
 
    /* Decompress chunk data */
-   stream->inflate_backend->set_in(
-         stream->inflate_stream,
-         stream->in_buf, compressed_chunk_size);
+   rzipstream_run_jobs(stream, count);
 
-   stream->inflate_backend->set_out(
-         stream->inflate_stream,
-         stream->out_buf, stream->out_buf_size);
+   /* Error checking
+    * > Output is packed together in case a chunk
+    *   came up short */
+   stream->out_buf_occupancy = 0;
+   for (i = 0; i < count; i++)
+   {
+      rzipstream_job_t *job = &stream->jobs[i];
 
-   /* Note: We have to set 'flush == true' here, otherwise we
-    * can't guarantee that the entire chunk will be written
-    * to the output buffer - this is inefficient, but not
-    * much we can do... */
-   if (!stream->inflate_backend->trans(
-         stream->inflate_stream, true,
-         &inflate_read, &inflate_written, NULL))
-      return false;
+      if (!job->success || (job->read != job->in_size))
+         return false;
 
-   /* Error checking */
-   if (inflate_read != compressed_chunk_size)
-      return false;
+      if ((job->written == 0) ||
+          (job->written > job->out_size))
+         return false;
 
-   if ((inflate_written == 0) ||
-       (inflate_written > stream->out_buf_size))
-      return false;
+      if (job->out != stream->out_buf + stream->out_buf_occupancy)
+         memmove(stream->out_buf + stream->out_buf_occupancy,
+               job->out, job->written);
 
-   /* Record current output buffer occupancy
-    * and reset pointer */
-   stream->out_buf_occupancy = inflate_written;
-   stream->out_buf_ptr       = 0;
+      stream->out_buf_occupancy += job->written;
+   }
+
+   /* Reset pointer */
+   stream->out_buf_ptr = 0;
 
    return true;
 }
@@ -568,9 +772,13 @@ int64_t rzipstream_read(rzipstream_t *stream, void *data, int64_t len)
 
       /* If everything in the output buffer has already
        * been read, grab and extract the next chunk
-       * from disk */
+       * from disk
+       * > The first batch only covers this request, so
+       *   that reading a file header does not inflate
+       *   'num_jobs' chunks */
       if (stream->out_buf_ptr >= stream->out_buf_occupancy)
-         if (!rzipstream_read_chunk(stream))
+         if (!rzipstream_read_chunks(stream, stream->virtual_ptr,
+               (stream->virtual_ptr == 0) ? (uint64_t)data_len : stream->size))
             return -1;
 
       /* Get amount of data to 'read out' this loop
@@ -742,64 +950,70 @@ error:
 /* File Write */
 
 /* Compresses currently cached data and writes it
- * as the next RZIP file chunk */
-static bool rzipstream_write_chunk(rzipstream_t *stream)
+ * as the next RZIP file chunk(s) */
+static bool rzipstream_write_chunks(rzipstream_t *stream)
 {
    unsigned i;
-   int64_t length;
-   uint8_t chunk_header_bytes[RZIP_CHUNK_HEADER_SIZE];
-   uint32_t deflate_read;
-   uint32_t deflate_written;
+   unsigned count;
+   uint32_t out_slot_size;
 
-   if (!stream || !stream->deflate_backend || !stream->deflate_stream)
+   if (!stream || !stream->deflate_backend || !stream->jobs)
       return false;
 
-   for (i = 0; i < RZIP_CHUNK_HEADER_SIZE; i++)
-      chunk_header_bytes[i] = 0;
+   count         = (stream->in_buf_ptr + stream->chunk_size - 1) /
+         stream->chunk_size;
+   out_slot_size = stream->out_buf_size / stream->num_jobs;
 
-   /* Compress data currently held in input buffer */
-   stream->deflate_backend->set_in(
-         stream->deflate_stream,
-         stream->in_buf, stream->in_buf_ptr);
+   /* Compress data currently held in input buffer,
+    * one chunk per job */
+   for (i = 0; i < count; i++)
+   {
+      rzipstream_job_t *job = &stream->jobs[i];
+      uint32_t in_offset    = i * stream->chunk_size;
+
+      job->in       = stream->in_buf + in_offset;
+      job->in_size  = stream->in_buf_ptr - in_offset;
+      if (job->in_size > stream->chunk_size)
+         job->in_size = stream->chunk_size;
+      job->out      = stream->out_buf + (size_t)i * out_slot_size;
+      job->out_size = out_slot_size;
+   }
 
-   stream->deflate_backend->set_out(
-         stream->deflate_stream,
-         stream->out_buf, stream->out_buf_size);
+   rzipstream_run_jobs(stream, count);
 
-   /* Note: We have to set 'flush == true' here, otherwise we
-    * can't guarantee that the entire chunk will be written
-    * to the output buffer - this is inefficient, but not
-    * much we can do... */
-   if (!stream->deflate_backend->trans(
-         stream->deflate_stream, true,
-         &deflate_read, &deflate_written, NULL))
-      return false;
+   for (i = 0; i < count; i++)
+   {
+      int64_t length;
+      uint8_t chunk_header_bytes[RZIP_CHUNK_HEADER_SIZE];
+      rzipstream_job_t *job    = &stream->jobs[i];
+      uint32_t deflate_written = job->written;
 
-   /* Error checking */
-   if (deflate_read != stream->in_buf_ptr)
-      return false;
+      /* Error checking */
+      if (!job->success || (job->read != job->in_size))
+         return false;
 
-   if ((deflate_written == 0) ||
-       (deflate_written > stream->out_buf_size))
-      return false;
+      if ((deflate_written == 0) ||
+          (deflate_written > job->out_size))
+         return false;
 
-   /* Write compressed chunk size to file */
-   chunk_header_bytes[3] = (deflate_written >> 24) & 0xFF;
-   chunk_header_bytes[2] = (deflate_written >> 16) & 0xFF;
-   chunk_header_bytes[1] = (deflate_written >>  8) & 0xFF;
-   chunk_header_bytes[0] =  deflate_written        & 0xFF;
+      /* Write compressed chunk size to file */
+      chunk_header_bytes[3] = (deflate_written >> 24) & 0xFF;
+      chunk_header_bytes[2] = (deflate_written >> 16) & 0xFF;
+      chunk_header_bytes[1] = (deflate_written >>  8) & 0xFF;
+      chunk_header_bytes[0] =  deflate_written        & 0xFF;
 
-   length = filestream_write(
-         stream->file, chunk_header_bytes, sizeof(chunk_header_bytes));
-   if (length != RZIP_CHUNK_HEADER_SIZE)
-      return false;
+      length = filestream_write(
+            stream->file, chunk_header_bytes, sizeof(chunk_header_bytes));
+      if (length != RZIP_CHUNK_HEADER_SIZE)
+         return false;
 
-   /* Write compressed data to file */
-   length = filestream_write(
-         stream->file, stream->out_buf, deflate_written);
+      /* Write compressed data to file */
+      length = filestream_write(
+            stream->file, job->out, deflate_written);
 
-   if (length != deflate_written)
-      return false;
+      if (length != deflate_written)
+         return false;
+   }
 
    /* Reset input buffer pointer */
    stream->in_buf_ptr = 0;
@@ -825,7 +1039,7 @@ int64_t rzipstream_write(rzipstream_t *stream, const void *data, int64_t len)
 
       /* If input buffer is full, compress and write to disk */
       if (stream->in_buf_ptr >= stream->in_buf_size)
-         if (!rzipstream_write_chunk(stream))
+         if (!rzipstream_write_chunks(stream))
             return -1;
 
       /* Get amount of data to cache during this loop
@@ -849,7 +1063,7 @@ int64_t rzipstream_write(rzipstream_t *stream, const void *data, int64_t len)
    }
 
    /* We always write the specified number of bytes
-    * (unless rzipstream_write_chunk() fails, in
+    * (unless rzipstream_write_chunks() fails, in
     * which we register a complete failure...) */
    return len;
 }
@@ -995,8 +1209,8 @@ void rzipstream_rewind(rzipstream_t *stream)
    {
       /* Check whether first file chunk is currently
        * buffered in memory */
-      if ((stream->virtual_ptr < stream->chunk_size) &&
-          (stream->out_buf_ptr < stream->out_buf_occupancy))
+      if ((stream->virtual_ptr == stream->out_buf_ptr) &&
+          (stream->out_buf_occupancy > 0))
       {
          /* It is: No file access is therefore required
           * > Just reset pointers */
@@ -1019,7 +1233,7 @@ void rzipstream_rewind(rzipstream_t *stream)
          }
 
          /* Read chunk */
-         if (!rzipstream_read_chunk(stream))
+         if (!rzipstream_read_chunks(stream, 0, stream->size))
          {
             fprintf(
                   stderr,
@@ -1101,7 +1315,7 @@ int rzipstream_close(rzipstream_t *stream)
    if (stream->is_writing)
    {
       if (stream->in_buf_ptr > 0)
-         if (!rzipstream_write_chunk(stream))
+         if (!rzipstream_write_chunks(stream))
             goto error;
 
       if (!rzipstream_write_file_header(stream))
@@ -25,15 +25,25 @@
 
 #include <zlib.h>
 #include <string/stdstring.h>
+#include <streams/inflate_buffer.h>
 #include <streams/trans_stream.h>
 
 struct zlib_trans_stream
 {
    z_stream z;
    int ex; /* window_bits or level */
+   int window_bits; /* deflate only, negative for a raw stream */
+   bool sync_flush; /* deflate only, flush without finishing the stream */
    bool inited;
 };
 
+static void zlib_deflate_init(struct zlib_trans_stream *zt)
+{
+   deflateInit2(&zt->z, zt->ex, Z_DEFLATED, zt->window_bits,
+         8, Z_DEFAULT_STRATEGY);
+   zt->inited = true;
+}
+
 static void *zlib_deflate_stream_new(void)
 {
    struct zlib_trans_stream *ret = (struct zlib_trans_stream*)
@@ -42,6 +52,8 @@ static void *zlib_deflate_stream_new(void)
       return NULL;
    ret->inited      = false;
    ret->ex          = 9;
+   ret->window_bits = MAX_WBITS;
+   ret->sync_flush  = false;
 
    ret->z.next_in   = NULL;
    ret->z.avail_in  = 0;
@@ -71,6 +83,8 @@ static void *zlib_inflate_stream_new(void)
       return NULL;
    ret->inited      = false;
    ret->ex          = MAX_WBITS;
+   ret->window_bits = MAX_WBITS;
+   ret->sync_flush  = false;
 
    ret->z.next_in   = NULL;
    ret->z.avail_in  = 0;
@@ -122,6 +136,22 @@ static bool zlib_deflate_define(void *data, const char *prop, uint32_t val)
          z->ex = (int) val;
       return true;
    }
+   /* Pass the window size as an int cast to uint32_t;
+    * -MAX_WBITS produces a raw deflate stream. */
+   else if (string_is_equal(prop, "window_bits"))
+   {
+      if (z)
+         z->window_bits = (int) val;
+      return true;
+   }
+   /* When set, a flushing trans() ends with Z_SYNC_FLUSH rather than
+    * Z_FINISH, so the output can be followed by another stream. */
+   else if (string_is_equal(prop, "sync_flush"))
+   {
+      if (z)
+         z->sync_flush = val != 0;
+      return true;
+   }
    return false;
 }
 
@@ -148,10 +178,7 @@ static void zlib_deflate_set_in(void *data, const uint8_t *in, uint32_t in_size)
    z->z.avail_in               = in_size;
 
    if (!z->inited)
-   {
-      deflateInit(&z->z, z->ex);
-      z->inited = true;
-   }
+      zlib_deflate_init(z);
 }
 
 static void zlib_inflate_set_in(void *data, const uint8_t *in, uint32_t in_size)
@@ -194,14 +221,12 @@ static bool zlib_deflate_trans(
    z_stream                  *z = &zt->z;
 
    if (!zt->inited)
-   {
-      deflateInit(z, zt->ex);
-      zt->inited = true;
-   }
+      zlib_deflate_init(zt);
 
    pre_avail_in  = z->avail_in;
    pre_avail_out = z->avail_out;
-   zret          = deflate(z, flush ? Z_FINISH : Z_NO_FLUSH);
+   zret          = deflate(z, flush
+         ? (zt->sync_flush ? Z_SYNC_FLUSH : Z_FINISH) : Z_NO_FLUSH);
 
    if (zret == Z_OK)
    {
@@ -264,6 +289,41 @@ static bool zlib_inflate_trans(
 
    pre_avail_in  = z->avail_in;
    pre_avail_out = z->avail_out;
+
+   /* Given the whole stream and room for all of its output,
+    * decompress it in one go. Anything that doesn't work out
+    * that way is left to zlib, which reports the error. */
+   if (flush && z->total_in == 0 && z->avail_in)
+   {
+      size_t in_used, out_used;
+
+      if (inflate_buffer(z->next_in, z->avail_in,
+               z->next_out, z->avail_out, zt->ex, &in_used, &out_used))
+      {
+         z->next_in   += in_used;
+         z->avail_in  -= (uInt)in_used;
+         z->next_out  += out_used;
+         z->avail_out -= (uInt)out_used;
+
+         *rd = (uint32_t)in_used;
+         *wn = (uint32_t)out_used;
+
+         inflateEnd(z);
+         zt->inited = false;
+
+         if (z->avail_out == 0 && z->avail_in != 0)
+         {
+            if (error)
+               *error = TRANS_STREAM_ERROR_BUFFER_FULL;
+            return false;
+         }
+
+         if (error)
+            *error = TRANS_STREAM_ERROR_NONE;
+         return true;
+      }
+   }
+
    zret          = inflate(z, flush ? Z_FINISH : Z_NO_FLUSH);
 
    if (zret == Z_OK)
@@ -0,0 +1,68 @@
+/* Copyright  (C) 2021 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (bench_libco.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Measures the cost of a context switch the way cooperative
+ * cores use libco: two cothreads handing control back and
+ * forth, with no work in between. */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <libco.h>
+
+#define BENCH_SWITCHES 20000000UL
+
+static cothread_t main_thread;
+static cothread_t co_thread;
+
+static void co_entry(void)
+{
+   for (;;)
+      co_switch(main_thread);
+}
+
+int main(void)
+{
+   unsigned long i;
+   clock_t start, end;
+   double seconds;
+
+   main_thread = co_active();
+   if (!(co_thread = co_create(65536, co_entry)))
+   {
+      fprintf(stderr, "co_create failed\n");
+      return EXIT_FAILURE;
+   }
+
+   start = clock();
+   for (i = 0; i < BENCH_SWITCHES / 2; i++)
+      co_switch(co_thread);
+   end   = clock();
+
+   seconds = (double)(end - start) / CLOCKS_PER_SEC;
+   printf("%lu switches in %.3f s, %.2f ns per switch\n",
+         BENCH_SWITCHES, seconds, seconds * 1e9 / BENCH_SWITCHES);
+
+   co_delete(co_thread);
+   return EXIT_SUCCESS;
+}
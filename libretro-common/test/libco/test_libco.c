@@ -0,0 +1,126 @@
+/* Copyright  (C) 2021 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (test_libco.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <check.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <libco.h>
+
+#define SUITE_NAME "libco"
+
+static cothread_t main_thread;
+static cothread_t co_thread;
+static cothread_t co_thread_seen;
+static unsigned co_count;
+static double co_sum;
+
+static void co_entry(void)
+{
+   double scale = 0.5;
+
+   co_thread_seen = co_active();
+
+   for (;;)
+   {
+      co_count++;
+      co_sum += scale;
+      co_switch(main_thread);
+   }
+}
+
+START_TEST (test_co_switch)
+{
+   unsigned i;
+
+   main_thread = co_active();
+   co_thread   = co_create(65536, co_entry);
+   ck_assert(co_thread != NULL);
+
+   co_count    = 0;
+   co_sum      = 0.0;
+
+   for (i = 0; i < 1000; i++)
+      co_switch(co_thread);
+
+   ck_assert_uint_eq(co_count, 1000);
+   ck_assert(co_sum == 500.0);
+   ck_assert(co_thread_seen == co_thread);
+   ck_assert(co_active() == main_thread);
+
+   co_delete(co_thread);
+}
+END_TEST
+
+START_TEST (test_co_callee_saved)
+{
+   unsigned i;
+   /* Live across every switch, so the compiler keeps
+    * them in callee-saved registers */
+   long     a = (long)rand() | 1;
+   long     b = a * 3;
+   double   c = (double)a * 0.25;
+   double   d = c + 1.0;
+
+   main_thread = co_active();
+   co_thread   = co_create(65536, co_entry);
+   ck_assert(co_thread != NULL);
+
+   for (i = 0; i < 100; i++)
+   {
+      co_switch(co_thread);
+      ck_assert(b == a * 3);
+      ck_assert(c == (double)a * 0.25);
+      ck_assert(d == c + 1.0);
+      a += 2;
+      b  = a * 3;
+      c  = (double)a * 0.25;
+      d  = c + 1.0;
+   }
+
+   co_delete(co_thread);
+}
+END_TEST
+
+Suite *create_suite(void)
+{
+   Suite *s = suite_create(SUITE_NAME);
+
+   TCase *tc_core = tcase_create("Core");
+   tcase_add_test(tc_core, test_co_switch);
+   tcase_add_test(tc_core, test_co_callee_saved);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
+
+int main(void)
+{
+   int num_fail;
+   Suite *s = create_suite();
+   SRunner *sr = srunner_create(s);
+   srunner_run_all(sr, CK_NORMAL);
+   num_fail = srunner_ntests_failed(sr);
+   srunner_free(sr);
+   return (num_fail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
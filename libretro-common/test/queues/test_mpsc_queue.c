@@ -0,0 +1,266 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (test_mpsc_queue.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <check.h>
+#include <stdarg.h>
+#include <stdlib.h>
+
+#include <queues/mpsc_queue.h>
+#include <rthreads/rthreads.h>
+#include <retro_timers.h>
+
+#define SUITE_NAME "MPSC Queue"
+
+#define STRESS_PRODUCERS 4
+#define STRESS_RECORDS   100000
+#define STRESS_CAPACITY  64
+
+typedef struct
+{
+   unsigned producer;
+   unsigned seq;
+} _record_t;
+
+typedef struct
+{
+   mpsc_queue_t *queue;
+   unsigned producer;
+} _producer_t;
+
+START_TEST (test_mpsc_queue_create)
+{
+   mpsc_queue_t *queue = mpsc_queue_new(sizeof(_record_t), 16);
+   ck_assert_ptr_nonnull(queue);
+   mpsc_queue_free(queue);
+   mpsc_queue_free(NULL);
+
+   ck_assert_ptr_null(mpsc_queue_new(0, 16));
+   ck_assert_ptr_null(mpsc_queue_new(sizeof(_record_t), 0));
+}
+END_TEST
+
+START_TEST (test_mpsc_queue_push_pop)
+{
+   unsigned i;
+   _record_t rec;
+   mpsc_queue_t queue;
+
+   ck_assert(mpsc_queue_initialize(&queue, sizeof(rec), 8));
+
+   for (i = 0; i < 5; i++)
+   {
+      rec.producer = 0;
+      rec.seq      = i;
+      ck_assert(mpsc_queue_push(&queue, &rec));
+   }
+
+   /* Records come out in the order they went in */
+   for (i = 0; i < 5; i++)
+   {
+      ck_assert(mpsc_queue_pop(&queue, &rec));
+      ck_assert_uint_eq(rec.seq, i);
+   }
+
+   mpsc_queue_deinitialize(&queue);
+}
+END_TEST
+
+START_TEST (test_mpsc_queue_empty)
+{
+   _record_t rec = {0, 0};
+   mpsc_queue_t *queue = mpsc_queue_new(sizeof(rec), 4);
+
+   ck_assert(!mpsc_queue_pop(queue, &rec));
+   ck_assert(mpsc_queue_push(queue, &rec));
+   ck_assert(mpsc_queue_pop(queue, &rec));
+   ck_assert(!mpsc_queue_pop(queue, &rec));
+
+   mpsc_queue_free(queue);
+}
+END_TEST
+
+START_TEST (test_mpsc_queue_full)
+{
+   unsigned i;
+   _record_t rec = {0, 0};
+   /* Rounded up to 8 */
+   mpsc_queue_t *queue = mpsc_queue_new(sizeof(rec), 5);
+
+   for (i = 0; i < 8; i++)
+   {
+      rec.seq = i;
+      ck_assert(mpsc_queue_push(queue, &rec));
+   }
+
+   rec.seq = 8;
+   ck_assert(!mpsc_queue_push(queue, &rec));
+
+   /* Popping one makes room for exactly one */
+   ck_assert(mpsc_queue_pop(queue, &rec));
+   ck_assert_uint_eq(rec.seq, 0);
+   rec.seq = 8;
+   ck_assert(mpsc_queue_push(queue, &rec));
+   ck_assert(!mpsc_queue_push(queue, &rec));
+
+   for (i = 1; i <= 8; i++)
+   {
+      ck_assert(mpsc_queue_pop(queue, &rec));
+      ck_assert_uint_eq(rec.seq, i);
+   }
+   ck_assert(!mpsc_queue_pop(queue, &rec));
+
+   mpsc_queue_free(queue);
+}
+END_TEST
+
+START_TEST (test_mpsc_queue_wraparound)
+{
+   unsigned i;
+   unsigned next_in    = 0;
+   unsigned next_out   = 0;
+   _record_t rec       = {0, 0};
+   mpsc_queue_t *queue = mpsc_queue_new(sizeof(rec), 4);
+
+   /* Many laps around the slots, with the queue
+    * at a different fill level each time */
+   for (i = 0; i < 1000; i++)
+   {
+      unsigned j;
+
+      for (j = 0; j < 1 + (i % 4); j++)
+      {
+         rec.seq = next_in;
+         if (mpsc_queue_push(queue, &rec))
+            next_in++;
+      }
+
+      for (j = 0; j < 1 + ((i * 3) % 4); j++)
+      {
+         if (!mpsc_queue_pop(queue, &rec))
+            break;
+         ck_assert_uint_eq(rec.seq, next_out);
+         next_out++;
+      }
+   }
+
+   ck_assert_int_gt(next_out, 4 * 100);
+
+   mpsc_queue_free(queue);
+}
+END_TEST
+
+static void _producer(void *data)
+{
+   _producer_t *producer = (_producer_t*)data;
+   _record_t rec;
+
+   rec.producer = producer->producer;
+
+   for (rec.seq = 0; rec.seq < STRESS_RECORDS; )
+   {
+      if (mpsc_queue_push(producer->queue, &rec))
+         rec.seq++;
+      else
+         retro_sleep(0); /* Let the consumer run on a single core */
+   }
+}
+
+START_TEST (test_mpsc_queue_producers)
+{
+   unsigned i;
+   unsigned received = 0;
+   bool ok           = true;
+   unsigned next_seq[STRESS_PRODUCERS];
+   sthread_t *threads[STRESS_PRODUCERS];
+   _producer_t producers[STRESS_PRODUCERS];
+   _record_t rec;
+   mpsc_queue_t *queue = mpsc_queue_new(sizeof(rec), STRESS_CAPACITY);
+
+   for (i = 0; i < STRESS_PRODUCERS; i++)
+   {
+      next_seq[i]           = 0;
+      producers[i].queue    = queue;
+      producers[i].producer = i;
+      threads[i]            = sthread_create(_producer, &producers[i]);
+      ck_assert_ptr_nonnull(threads[i]);
+   }
+
+   /* The records of each producer have to arrive in
+    * the order they were pushed, so a lost or doubled
+    * one shows up as a gap in its sequence */
+   while (received < STRESS_PRODUCERS * STRESS_RECORDS)
+   {
+      if (!mpsc_queue_pop(queue, &rec))
+      {
+         retro_sleep(0);
+         continue;
+      }
+
+      if (     rec.producer >= STRESS_PRODUCERS
+            || rec.seq != next_seq[rec.producer])
+      {
+         ok = false;
+         break;
+      }
+
+      next_seq[rec.producer]++;
+      received++;
+   }
+
+   for (i = 0; i < STRESS_PRODUCERS; i++)
+      sthread_join(threads[i]);
+
+   ck_assert(ok);
+   ck_assert(!mpsc_queue_pop(queue, &rec));
+   for (i = 0; i < STRESS_PRODUCERS; i++)
+      ck_assert_uint_eq(next_seq[i], STRESS_RECORDS);
+
+   mpsc_queue_free(queue);
+}
+END_TEST
+
+Suite *create_suite(void)
+{
+   Suite *s = suite_create(SUITE_NAME);
+
+   TCase *tc_core = tcase_create("Core");
+   tcase_add_test(tc_core, test_mpsc_queue_create);
+   tcase_add_test(tc_core, test_mpsc_queue_push_pop);
+   tcase_add_test(tc_core, test_mpsc_queue_empty);
+   tcase_add_test(tc_core, test_mpsc_queue_full);
+   tcase_add_test(tc_core, test_mpsc_queue_wraparound);
+   tcase_add_test(tc_core, test_mpsc_queue_producers);
+   tcase_set_timeout(tc_core, 60);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
+
+int main(void)
+{
+	int num_fail;
+	Suite *s = create_suite();
+	SRunner *sr = srunner_create(s);
+	srunner_run_all(sr, CK_NORMAL);
+	num_fail = srunner_ntests_failed(sr);
+	srunner_free(sr);
+	return (num_fail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
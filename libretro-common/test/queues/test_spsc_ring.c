@@ -0,0 +1,239 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (test_spsc_ring.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <check.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <queues/spsc_ring.h>
+#include <rthreads/rthreads.h>
+#include <retro_timers.h>
+
+#define SUITE_NAME "SPSC Ring"
+
+#define STRESS_RING_SIZE 61
+#define STRESS_BYTES     (1 << 20)
+
+/* Byte 'i' of the stream the stress test pushes through */
+static uint8_t _stream_byte(unsigned i)
+{
+   return (uint8_t)((i * 7) ^ (i >> 8));
+}
+
+START_TEST (test_spsc_ring_create)
+{
+   spsc_ring_t *ring = spsc_ring_new(16);
+   ck_assert_ptr_nonnull(ring);
+   ck_assert_uint_eq(spsc_ring_read_avail(ring), 0);
+   ck_assert_uint_eq(spsc_ring_write_avail(ring), 16);
+   spsc_ring_free(ring);
+   spsc_ring_free(NULL);
+}
+END_TEST
+
+START_TEST (test_spsc_ring_empty)
+{
+   uint8_t out[4];
+   spsc_ring_t ring;
+
+   ck_assert(spsc_ring_initialize(&ring, 16));
+   ck_assert_uint_eq(spsc_ring_read(&ring, out, sizeof(out)), 0);
+
+   ck_assert_uint_eq(spsc_ring_write(&ring, "ab", 2), 2);
+   ck_assert_uint_eq(spsc_ring_read(&ring, out, sizeof(out)), 2);
+   ck_assert_mem_eq(out, "ab", 2);
+
+   /* Drained again */
+   ck_assert_uint_eq(spsc_ring_read_avail(&ring), 0);
+   ck_assert_uint_eq(spsc_ring_write_avail(&ring), 16);
+   ck_assert_uint_eq(spsc_ring_read(&ring, out, sizeof(out)), 0);
+
+   spsc_ring_deinitialize(&ring);
+}
+END_TEST
+
+START_TEST (test_spsc_ring_full)
+{
+   unsigned i;
+   uint8_t in[20];
+   uint8_t out[20];
+   spsc_ring_t *ring = spsc_ring_new(16);
+
+   for (i = 0; i < sizeof(in); i++)
+      in[i] = (uint8_t)i;
+
+   /* Only what fits is written */
+   ck_assert_uint_eq(spsc_ring_write(ring, in, sizeof(in)), 16);
+   ck_assert_uint_eq(spsc_ring_read_avail(ring), 16);
+   ck_assert_uint_eq(spsc_ring_write_avail(ring), 0);
+   ck_assert_uint_eq(spsc_ring_write(ring, in, 1), 0);
+
+   /* One byte of room takes exactly one byte */
+   ck_assert_uint_eq(spsc_ring_read(ring, out, 1), 1);
+   ck_assert_uint_eq(out[0], 0);
+   ck_assert_uint_eq(spsc_ring_write_avail(ring), 1);
+   ck_assert_uint_eq(spsc_ring_write(ring, in + 16, 4), 1);
+   ck_assert_uint_eq(spsc_ring_write_avail(ring), 0);
+
+   ck_assert_uint_eq(spsc_ring_read(ring, out, sizeof(out)), 16);
+   ck_assert_mem_eq(out, in + 1, 16);
+
+   spsc_ring_free(ring);
+}
+END_TEST
+
+START_TEST (test_spsc_ring_wraparound)
+{
+   unsigned i, j;
+   unsigned next_in  = 0;
+   unsigned next_out = 0;
+   uint8_t in[13];
+   uint8_t out[13];
+   spsc_ring_t *ring = spsc_ring_new(16);
+
+   /* Odd sizes against a ring of 16 bytes make both
+    * copies split across the end of the buffer */
+   for (i = 0; i < 200; i++)
+   {
+      size_t len_in  = 1 + (i % 13);
+      size_t len_out = 1 + ((i * 5) % 13);
+      size_t wrote, read;
+
+      for (j = 0; j < len_in; j++)
+         in[j] = _stream_byte(next_in + j);
+      wrote    = spsc_ring_write(ring, in, len_in);
+      next_in += (unsigned)wrote;
+
+      read     = spsc_ring_read(ring, out, len_out);
+      for (j = 0; j < read; j++)
+         ck_assert_uint_eq(out[j], _stream_byte(next_out + j));
+      next_out += (unsigned)read;
+
+      ck_assert_uint_eq(spsc_ring_read_avail(ring), next_in - next_out);
+      ck_assert_uint_eq(spsc_ring_write_avail(ring),
+            16 - (next_in - next_out));
+   }
+
+   ck_assert_int_gt(next_out, 16 * 10);
+
+   spsc_ring_free(ring);
+}
+END_TEST
+
+START_TEST (test_spsc_ring_clear)
+{
+   uint8_t out[4];
+   spsc_ring_t *ring = spsc_ring_new(8);
+
+   spsc_ring_write(ring, "abcdef", 6);
+   spsc_ring_clear(ring);
+   ck_assert_uint_eq(spsc_ring_read_avail(ring), 0);
+   ck_assert_uint_eq(spsc_ring_write_avail(ring), 8);
+   ck_assert_uint_eq(spsc_ring_read(ring, out, sizeof(out)), 0);
+
+   spsc_ring_free(ring);
+}
+END_TEST
+
+static void _producer(void *data)
+{
+   spsc_ring_t *ring = (spsc_ring_t*)data;
+   unsigned next     = 0;
+   uint8_t in[17];
+
+   while (next < STRESS_BYTES)
+   {
+      unsigned j;
+      size_t len = 1 + (next % sizeof(in));
+
+      if (len > STRESS_BYTES - next)
+         len = STRESS_BYTES - next;
+      for (j = 0; j < len; j++)
+         in[j] = _stream_byte(next + j);
+
+      if (!(len = spsc_ring_write(ring, in, len)))
+         retro_sleep(0); /* Let the consumer run on a single core */
+      next += (unsigned)len;
+   }
+}
+
+START_TEST (test_spsc_ring_two_threads)
+{
+   unsigned next     = 0;
+   bool ok           = true;
+   spsc_ring_t *ring = spsc_ring_new(STRESS_RING_SIZE);
+   sthread_t *thread = sthread_create(_producer, ring);
+   uint8_t out[23];
+
+   ck_assert_ptr_nonnull(thread);
+
+   /* Every byte has to arrive once and in order */
+   while (next < STRESS_BYTES)
+   {
+      size_t j;
+      size_t read = spsc_ring_read(ring, out,
+            1 + (next % sizeof(out)));
+
+      if (!read)
+         retro_sleep(0);
+      for (j = 0; j < read; j++)
+         if (out[j] != _stream_byte(next + (unsigned)j))
+            ok = false;
+      next += (unsigned)read;
+   }
+
+   sthread_join(thread);
+
+   ck_assert(ok);
+   ck_assert_uint_eq(spsc_ring_read_avail(ring), 0);
+
+   spsc_ring_free(ring);
+}
+END_TEST
+
+Suite *create_suite(void)
+{
+   Suite *s = suite_create(SUITE_NAME);
+
+   TCase *tc_core = tcase_create("Core");
+   tcase_add_test(tc_core, test_spsc_ring_create);
+   tcase_add_test(tc_core, test_spsc_ring_empty);
+   tcase_add_test(tc_core, test_spsc_ring_full);
+   tcase_add_test(tc_core, test_spsc_ring_wraparound);
+   tcase_add_test(tc_core, test_spsc_ring_clear);
+   tcase_add_test(tc_core, test_spsc_ring_two_threads);
+   tcase_set_timeout(tc_core, 60);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
+
+int main(void)
+{
+	int num_fail;
+	Suite *s = create_suite();
+	SRunner *sr = srunner_create(s);
+	srunner_run_all(sr, CK_NORMAL);
+	num_fail = srunner_ntests_failed(sr);
+	srunner_free(sr);
+	return (num_fail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,273 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (test_tpool.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <check.h>
+#include <stdarg.h>
+#include <stdlib.h>
+
+#include <retro_atomic.h>
+#include <rthreads/rthreads.h>
+#include <rthreads/tpool.h>
+
+#define SUITE_NAME "Thread Pool"
+
+#define NUM_JOBS 1000
+
+typedef struct
+{
+   retro_atomic_int_t runs[NUM_JOBS];
+   uintptr_t thread[NUM_JOBS];
+} _batch_t;
+
+/* Holds pool threads until opened, to keep the pool busy */
+typedef struct
+{
+   slock_t *lock;
+   scond_t *cond;
+   unsigned started;
+   bool open;
+} _gate_t;
+
+typedef struct
+{
+   tpool_t *tp;
+   _batch_t *batch;
+} _runner_t;
+
+static void _job(void *data, unsigned index)
+{
+   _batch_t *batch      = (_batch_t*)data;
+   batch->thread[index] = sthread_get_current_thread_id();
+   retro_atomic_fetch_add(&batch->runs[index], 1);
+}
+
+static _batch_t *_batch_new(void)
+{
+   unsigned i;
+   _batch_t *batch = (_batch_t*)calloc(1, sizeof(*batch));
+
+   for (i = 0; i < NUM_JOBS; i++)
+      retro_atomic_store(&batch->runs[i], 0);
+
+   return batch;
+}
+
+/* Counts the jobs of 'batch' that did not run exactly once */
+static unsigned _batch_errors(_batch_t *batch, unsigned count)
+{
+   unsigned i;
+   unsigned errors = 0;
+
+   for (i = 0; i < NUM_JOBS; i++)
+      if (retro_atomic_load(&batch->runs[i]) != (i < count ? 1 : 0))
+         errors++;
+
+   return errors;
+}
+
+static void _gate_wait(void *data)
+{
+   _gate_t *gate = (_gate_t*)data;
+
+   slock_lock(gate->lock);
+   gate->started++;
+   scond_broadcast(gate->cond);
+   while (!gate->open)
+      scond_wait(gate->cond, gate->lock);
+   slock_unlock(gate->lock);
+}
+
+static void _count_work(void *data)
+{
+   retro_atomic_fetch_add((retro_atomic_int_t*)data, 1);
+}
+
+START_TEST (test_tpool_batch_no_pool)
+{
+   unsigned i;
+   _batch_t *batch = _batch_new();
+   uintptr_t self  = sthread_get_current_thread_id();
+
+   tpool_run_batch(NULL, _job, batch, NUM_JOBS);
+
+   ck_assert_uint_eq(_batch_errors(batch, NUM_JOBS), 0);
+   for (i = 0; i < NUM_JOBS; i++)
+      ck_assert(batch->thread[i] == self);
+
+   free(batch);
+}
+END_TEST
+
+START_TEST (test_tpool_batch_runs_once)
+{
+   unsigned count;
+   tpool_t *tp     = tpool_create(3);
+   _batch_t *batch = NULL;
+
+   ck_assert_ptr_nonnull(tp);
+
+   /* Fewer jobs than threads, and many more */
+   for (count = 0; count <= NUM_JOBS; count += (count < 8) ? 1 : 331)
+   {
+      batch = _batch_new();
+      tpool_run_batch(tp, _job, batch, count);
+      ck_assert_uint_eq(_batch_errors(batch, count), 0);
+      free(batch);
+   }
+
+   tpool_destroy(tp);
+}
+END_TEST
+
+START_TEST (test_tpool_batch_caller_runs)
+{
+   tpool_t *tp     = tpool_create(3);
+   _batch_t *batch = _batch_new();
+
+   /* The caller takes the first job before
+    * letting go of the pool's lock */
+   tpool_run_batch(tp, _job, batch, NUM_JOBS);
+
+   ck_assert_uint_eq(_batch_errors(batch, NUM_JOBS), 0);
+   ck_assert(batch->thread[0] == sthread_get_current_thread_id());
+
+   free(batch);
+   tpool_destroy(tp);
+}
+END_TEST
+
+START_TEST (test_tpool_batch_busy_pool)
+{
+   unsigned i;
+   retro_atomic_int_t before;
+   retro_atomic_int_t after;
+   _gate_t gate;
+   tpool_t *tp     = tpool_create(2);
+   _batch_t *batch = _batch_new();
+   uintptr_t self  = sthread_get_current_thread_id();
+
+   retro_atomic_store(&before, 0);
+   retro_atomic_store(&after, 0);
+   gate.lock    = slock_new();
+   gate.cond    = scond_new();
+   gate.started = 0;
+   gate.open    = false;
+
+   /* Both threads get stuck, and one more item waits behind */
+   tpool_add_work(tp, _gate_wait, &gate);
+   tpool_add_work(tp, _gate_wait, &gate);
+   slock_lock(gate.lock);
+   while (gate.started < 2)
+      scond_wait(gate.cond, gate.lock);
+   slock_unlock(gate.lock);
+   tpool_add_work(tp, _count_work, (void*)&before);
+
+   /* Nobody is free to help, so the caller runs every job,
+    * and the helper items it queued behind the one above
+    * have to be taken out again before it returns */
+   tpool_run_batch(tp, _job, batch, NUM_JOBS);
+
+   ck_assert_uint_eq(_batch_errors(batch, NUM_JOBS), 0);
+   for (i = 0; i < NUM_JOBS; i++)
+      ck_assert(batch->thread[i] == self);
+   free(batch);
+
+   /* Appending still works after the items at the end of
+    * the queue were removed, and nothing else got lost */
+   tpool_add_work(tp, _count_work, (void*)&after);
+   ck_assert_int_eq(retro_atomic_load(&before), 0);
+
+   slock_lock(gate.lock);
+   gate.open = true;
+   scond_broadcast(gate.cond);
+   slock_unlock(gate.lock);
+
+   tpool_wait(tp);
+
+   ck_assert_int_eq(retro_atomic_load(&before), 1);
+   ck_assert_int_eq(retro_atomic_load(&after), 1);
+
+   tpool_destroy(tp);
+   slock_free(gate.lock);
+   scond_free(gate.cond);
+}
+END_TEST
+
+static void _runner(void *data)
+{
+   _runner_t *runner = (_runner_t*)data;
+   tpool_run_batch(runner->tp, _job, runner->batch, NUM_JOBS);
+}
+
+START_TEST (test_tpool_batch_shared)
+{
+   unsigned i;
+   sthread_t *threads[2];
+   _runner_t runners[2];
+   tpool_t *tp = tpool_create(2);
+
+   /* Batches from several threads share the pool, and each
+    * caller only waits for the jobs of its own */
+   for (i = 0; i < 2; i++)
+   {
+      runners[i].tp    = tp;
+      runners[i].batch = _batch_new();
+      threads[i]       = sthread_create(_runner, &runners[i]);
+      ck_assert_ptr_nonnull(threads[i]);
+   }
+
+   for (i = 0; i < 2; i++)
+   {
+      sthread_join(threads[i]);
+      ck_assert_uint_eq(_batch_errors(runners[i].batch, NUM_JOBS), 0);
+      free(runners[i].batch);
+   }
+
+   tpool_destroy(tp);
+}
+END_TEST
+
+Suite *create_suite(void)
+{
+   Suite *s = suite_create(SUITE_NAME);
+
+   TCase *tc_core = tcase_create("Core");
+   tcase_add_test(tc_core, test_tpool_batch_no_pool);
+   tcase_add_test(tc_core, test_tpool_batch_runs_once);
+   tcase_add_test(tc_core, test_tpool_batch_caller_runs);
+   tcase_add_test(tc_core, test_tpool_batch_busy_pool);
+   tcase_add_test(tc_core, test_tpool_batch_shared);
+   tcase_set_timeout(tc_core, 60);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
+
+int main(void)
+{
+	int num_fail;
+	Suite *s = create_suite();
+	SRunner *sr = srunner_create(s);
+	srunner_run_all(sr, CK_NORMAL);
+	num_fail = srunner_ntests_failed(sr);
+	srunner_free(sr);
+	return (num_fail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
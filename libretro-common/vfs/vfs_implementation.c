@@ -244,7 +244,7 @@ int64_t retro_vfs_file_seek_internal(
             stream->mappos = stream->mapsize + offset;
             break;
       }
-      return stream->mappos;
+      return 0;
    }
 #endif
 
@@ -313,6 +313,7 @@ libretro_vfs_implementation_file *retro_vfs_file_open_impl(
    stream->cdrom.cue_buf          = NULL;
    stream->cdrom.cue_len          = 0;
    stream->cdrom.byte_pos         = 0;
+   stream->cdrom.cache            = NULL;
    stream->cdrom.drive            = 0;
    stream->cdrom.cur_min          = 0;
    stream->cdrom.cur_sec          = 0;
@@ -336,6 +337,10 @@ libretro_vfs_implementation_file *retro_vfs_file_open_impl(
    stream->orig_path       = strdup(path);
 
 #ifdef HAVE_MMAP
+   /* Only read-only files get mapped. A mapped file that is
+    * truncated behind our back raises SIGBUS on the pages it
+    * lost, so callers should only pass this hint for files
+    * that are replaced by rename and never written in place */
    if (stream->hints & RETRO_VFS_FILE_ACCESS_HINT_FREQUENT_ACCESS && mode == RETRO_VFS_FILE_ACCESS_READ)
       stream->hints |= RFILE_HINT_UNBUFFERED;
    else
@@ -494,7 +499,11 @@ libretro_vfs_implementation_file *retro_vfs_file_open_impl(
       {
          stream->mappos  = 0;
          stream->mapped  = NULL;
-         stream->mapsize = retro_vfs_file_seek_internal(stream, 0, SEEK_END);
+
+         if (retro_vfs_file_seek_internal(stream, 0, SEEK_END) != 0)
+            goto error;
+
+         stream->mapsize = retro_vfs_file_tell_impl(stream);
 
          if (stream->mapsize == (uint64_t)-1)
             goto error;
@@ -665,10 +674,12 @@ int64_t retro_vfs_file_tell_impl(libretro_vfs_implementation_file *stream)
          RETRO_VFS_FILE_ACCESS_HINT_FREQUENT_ACCESS)
       return stream->mappos;
 #endif
-   if (lseek(stream->fd, 0, SEEK_CUR) < 0)
-      return -1;
-
-   return 0;
+   {
+      off_t ret = lseek(stream->fd, 0, SEEK_CUR);
+      if (ret < 0)
+         return -1;
+      return (int64_t)ret;
+   }
 }
 
 int64_t retro_vfs_file_seek_impl(libretro_vfs_implementation_file *stream,
@@ -20,19 +20,348 @@
 * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
+#include <stdlib.h>
+
 #include <vfs/vfs_implementation.h>
 #include <file/file_path.h>
 #include <compat/fopen_utf8.h>
 #include <string/stdstring.h>
 #include <cdrom/cdrom.h>
+#include <retro_miscellaneous.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #if defined(_WIN32) && !defined(_XBOX)
 #include <windows.h>
 #endif
 
+/* Size of the sector cache kept for each open track,
+ * 0 reads straight from the drive */
+#ifndef CDROM_CACHE_SIZE_MB
+#define CDROM_CACHE_SIZE_MB 8
+#endif
+
+/* Sectors are read from the drive and cached this many at a time */
+#define CDROM_CACHE_CHUNK_FRAMES 32
+
+/* Chunks past the one last read that get fetched in the background */
+#define CDROM_CACHE_READ_AHEAD 4
+
+#define CDROM_FRAME_SIZE 2352
+
+typedef struct
+{
+   unsigned char *data;
+   unsigned lba;
+   unsigned frames;
+   unsigned last_used;
+   bool valid;
+   bool loading;
+} vfs_cdrom_cache_chunk_t;
+
+struct vfs_cdrom_cache
+{
+   vfs_cdrom_cache_chunk_t *chunks;
+   unsigned num_chunks;
+   unsigned tick;
+   unsigned start_lba; /* first sector of the track */
+   unsigned end_lba;   /* one past its last sector */
+#ifdef HAVE_THREADS
+   libretro_vfs_implementation_file *stream;
+   slock_t *lock;      /* guards the chunks */
+   slock_t *io_lock;   /* one read from the drive at a time */
+   scond_t *cond;
+   sthread_t *thread;
+   unsigned ahead_lba; /* where reading ahead starts */
+   bool quit;
+#endif
+};
+
 /* TODO/FIXME - static global variable */
 static cdrom_toc_t vfs_cdrom_toc = {0};
 
+#ifdef HAVE_THREADS
+#define CDROM_CACHE_LOCK(lock)   slock_lock(lock)
+#define CDROM_CACHE_UNLOCK(lock) slock_unlock(lock)
+#else
+#define CDROM_CACHE_LOCK(lock)
+#define CDROM_CACHE_UNLOCK(lock)
+#endif
+
+static vfs_cdrom_cache_chunk_t *vfs_cdrom_cache_find(
+      struct vfs_cdrom_cache *cache, unsigned lba)
+{
+   unsigned i;
+
+   for (i = 0; i < cache->num_chunks; i++)
+   {
+      vfs_cdrom_cache_chunk_t *chunk = &cache->chunks[i];
+      if ((chunk->valid || chunk->loading) && chunk->lba == lba)
+         return chunk;
+   }
+
+   return NULL;
+}
+
+/* Reads the chunk starting at @lba into the least recently
+ * used slot. Called with the cache locked, which is let go
+ * of while the drive is busy. */
+static vfs_cdrom_cache_chunk_t *vfs_cdrom_cache_load(
+      libretro_vfs_implementation_file *stream,
+      struct vfs_cdrom_cache *cache, unsigned lba)
+{
+   unsigned i;
+   int rv;
+   unsigned char min, sec, frame;
+   vfs_cdrom_cache_chunk_t *chunk = NULL;
+
+   for (i = 0; i < cache->num_chunks; i++)
+   {
+      vfs_cdrom_cache_chunk_t *cur = &cache->chunks[i];
+
+      if (cur->loading)
+         continue;
+      if (!cur->valid)
+      {
+         chunk = cur;
+         break;
+      }
+      if (!chunk || cache->tick - cur->last_used
+            > cache->tick - chunk->last_used)
+         chunk = cur;
+   }
+
+   if (!chunk)
+      return NULL;
+   if (!chunk->data && !(chunk->data = (unsigned char*)
+            malloc(CDROM_CACHE_CHUNK_FRAMES * CDROM_FRAME_SIZE)))
+      return NULL;
+
+   chunk->lba     = lba;
+   chunk->frames  = MIN(CDROM_CACHE_CHUNK_FRAMES, cache->end_lba - lba);
+   chunk->valid   = false;
+   chunk->loading = true;
+
+   cdrom_lba_to_msf(lba, &min, &sec, &frame);
+
+#ifdef HAVE_THREADS
+   slock_unlock(cache->lock);
+   slock_lock(cache->io_lock);
+#endif
+   rv = cdrom_read(stream, &vfs_cdrom_toc.timeouts, min, sec, frame,
+         chunk->data, chunk->frames * CDROM_FRAME_SIZE, 0);
+#ifdef HAVE_THREADS
+   slock_unlock(cache->io_lock);
+   slock_lock(cache->lock);
+#endif
+
+   chunk->loading   = false;
+   chunk->valid     = !rv;
+   chunk->last_used = ++cache->tick;
+#ifdef HAVE_THREADS
+   scond_broadcast(cache->cond);
+#endif
+
+   return chunk->valid ? chunk : NULL;
+}
+
+static vfs_cdrom_cache_chunk_t *vfs_cdrom_cache_get(
+      libretro_vfs_implementation_file *stream,
+      struct vfs_cdrom_cache *cache, unsigned lba)
+{
+   for (;;)
+   {
+      vfs_cdrom_cache_chunk_t *chunk = vfs_cdrom_cache_find(cache, lba);
+
+      if (!chunk)
+         return vfs_cdrom_cache_load(stream, cache, lba);
+
+      if (chunk->valid)
+      {
+         chunk->last_used = ++cache->tick;
+         return chunk;
+      }
+
+#ifdef HAVE_THREADS
+      /* Being read ahead right now */
+      scond_wait(cache->cond, cache->lock);
+#endif
+   }
+}
+
+#ifdef HAVE_THREADS
+static void vfs_cdrom_cache_thread(void *data)
+{
+   struct vfs_cdrom_cache *cache = (struct vfs_cdrom_cache*)data;
+
+   slock_lock(cache->lock);
+
+   while (!cache->quit)
+   {
+      unsigned i;
+      unsigned lba = cache->end_lba;
+
+      for (i = 0; i < CDROM_CACHE_READ_AHEAD; i++)
+      {
+         unsigned next = cache->ahead_lba + i * CDROM_CACHE_CHUNK_FRAMES;
+
+         if (next >= cache->end_lba)
+            break;
+         if (!vfs_cdrom_cache_find(cache, next))
+         {
+            lba = next;
+            break;
+         }
+      }
+
+      if (lba >= cache->end_lba)
+      {
+         scond_wait(cache->cond, cache->lock);
+         continue;
+      }
+
+      /* Don't keep at it if the disc can't be read there */
+      if (!vfs_cdrom_cache_load(cache->stream, cache, lba))
+         cache->ahead_lba = cache->end_lba;
+   }
+
+   slock_unlock(cache->lock);
+}
+#endif
+
+static void vfs_cdrom_cache_free(struct vfs_cdrom_cache *cache)
+{
+   unsigned i;
+
+#ifdef HAVE_THREADS
+   if (cache->thread)
+   {
+      slock_lock(cache->lock);
+      cache->quit = true;
+      scond_broadcast(cache->cond);
+      slock_unlock(cache->lock);
+      sthread_join(cache->thread);
+   }
+   if (cache->lock)
+      slock_free(cache->lock);
+   if (cache->io_lock)
+      slock_free(cache->io_lock);
+   if (cache->cond)
+      scond_free(cache->cond);
+#endif
+
+   if (cache->chunks)
+   {
+      for (i = 0; i < cache->num_chunks; i++)
+         free(cache->chunks[i].data);
+      free(cache->chunks);
+   }
+   free(cache);
+}
+
+/* Sets up the sector cache of a track and starts reading
+ * its first sectors, where the file system usually is */
+static struct vfs_cdrom_cache *vfs_cdrom_cache_new(
+      libretro_vfs_implementation_file *stream)
+{
+   const cdrom_track_t *track;
+   struct vfs_cdrom_cache *cache;
+   unsigned num_chunks = (unsigned)(((uint64_t)CDROM_CACHE_SIZE_MB << 20)
+         / (CDROM_CACHE_CHUNK_FRAMES * CDROM_FRAME_SIZE));
+
+   if (     !num_chunks
+         || !stream->cdrom.cur_track
+         ||  stream->cdrom.cur_track > vfs_cdrom_toc.num_tracks)
+      return NULL;
+
+   track = &vfs_cdrom_toc.track[stream->cdrom.cur_track - 1];
+   if (!track->track_bytes)
+      return NULL;
+
+   if (!(cache = (struct vfs_cdrom_cache*)calloc(1, sizeof(*cache))))
+      return NULL;
+
+   /* Leave room for what is being read ahead */
+   cache->num_chunks = MAX(num_chunks, CDROM_CACHE_READ_AHEAD + 2);
+   cache->start_lba  = track->lba;
+   cache->end_lba    = track->lba
+      + (track->track_bytes + CDROM_FRAME_SIZE - 1) / CDROM_FRAME_SIZE;
+
+   if (!(cache->chunks = (vfs_cdrom_cache_chunk_t*)calloc(
+               cache->num_chunks, sizeof(*cache->chunks))))
+      goto error;
+
+#ifdef HAVE_THREADS
+   cache->stream    = stream;
+   cache->ahead_lba = cache->start_lba;
+
+   if (     !(cache->lock    = slock_new())
+         || !(cache->io_lock = slock_new())
+         || !(cache->cond    = scond_new()))
+      goto error;
+
+   /* Without the thread there is just no reading ahead */
+   cache->thread    = sthread_create(vfs_cdrom_cache_thread, cache);
+#endif
+
+   return cache;
+
+error:
+   vfs_cdrom_cache_free(cache);
+   return NULL;
+}
+
+/* Serves a read from the cache, filling it as needed.
+ * Returns 0 on success like cdrom_read(). */
+static int vfs_cdrom_cache_read(libretro_vfs_implementation_file *stream,
+      struct vfs_cdrom_cache *cache, void *s, size_t len, size_t skip)
+{
+   size_t done = 0;
+   unsigned lba = stream->cdrom.cur_lba;
+   unsigned base;
+
+   if (lba < cache->start_lba)
+      return 1;
+
+   CDROM_CACHE_LOCK(cache->lock);
+
+   do
+   {
+      size_t offset, avail;
+      vfs_cdrom_cache_chunk_t *chunk;
+
+      base  = cache->start_lba + ((lba - cache->start_lba)
+            / CDROM_CACHE_CHUNK_FRAMES) * CDROM_CACHE_CHUNK_FRAMES;
+      if (!(chunk = vfs_cdrom_cache_get(stream, cache, base)))
+         break;
+
+      offset = (lba - base) * CDROM_FRAME_SIZE + skip;
+      if (offset >= chunk->frames * CDROM_FRAME_SIZE)
+         break;
+      avail  = MIN(chunk->frames * CDROM_FRAME_SIZE - offset, len - done);
+
+      memcpy((char*)s + done, chunk->data + offset, avail);
+      done  += avail;
+      lba    = base + chunk->frames;
+      skip   = 0;
+   } while (done < len);
+
+#ifdef HAVE_THREADS
+   /* Carry on past the last chunk read */
+   if (cache->thread)
+   {
+      cache->ahead_lba = base + CDROM_CACHE_CHUNK_FRAMES;
+      scond_broadcast(cache->cond);
+   }
+#endif
+
+   CDROM_CACHE_UNLOCK(cache->lock);
+
+   return done == len ? 0 : 1;
+}
+
 const cdrom_toc_t* retro_vfs_file_get_cdrom_toc(void)
 {
    return &vfs_cdrom_toc;
@@ -196,6 +525,9 @@ void retro_vfs_file_open_cdrom(
    if (!stream->fp)
       return;
 
+   if (string_is_equal_noncase(ext, "bin"))
+      stream->cdrom.cache = vfs_cdrom_cache_new(stream);
+
    if (string_is_equal_noncase(ext, "cue"))
    {
       if (stream->cdrom.cue_buf)
@@ -277,6 +609,9 @@ void retro_vfs_file_open_cdrom(
    if (stream->fh == INVALID_HANDLE_VALUE)
       return;
 
+   if (string_is_equal_noncase(ext, "bin"))
+      stream->cdrom.cache = vfs_cdrom_cache_new(stream);
+
    if (string_is_equal_noncase(ext, "cue"))
    {
       if (stream->cdrom.cue_buf)
@@ -331,6 +666,13 @@ int retro_vfs_file_close_cdrom(libretro_vfs_implementation_file *stream)
    fflush(stdout);
 #endif
 
+   /* Stops reading ahead before the drive goes away */
+   if (stream->cdrom.cache)
+   {
+      vfs_cdrom_cache_free(stream->cdrom.cache);
+      stream->cdrom.cache = NULL;
+   }
+
 #if defined(_WIN32) && !defined(_XBOX)
    if (!stream->fh || !CloseHandle(stream->fh))
       return -1;
@@ -435,8 +777,12 @@ int64_t retro_vfs_file_read_cdrom(libretro_vfs_implementation_file *stream,
 #endif
 
 #if 1
-      rv = cdrom_read(stream, &vfs_cdrom_toc.timeouts, min, sec,
-            frame, s, (size_t)len, skip);
+      if (stream->cdrom.cache)
+         rv = vfs_cdrom_cache_read(stream, stream->cdrom.cache,
+               s, (size_t)len, skip);
+      else
+         rv = cdrom_read(stream, &vfs_cdrom_toc.timeouts, min, sec,
+               frame, s, (size_t)len, skip);
 #else
       rv = cdrom_read_lba(stream, stream->cdrom.cur_lba, s,
             (size_t)len, skip);
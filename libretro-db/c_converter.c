@@ -31,8 +31,10 @@
 #include <lrc_hash.h>
 
 #include <retro_assert.h>
+#include <retro_miscellaneous.h>
 #include <string/stdstring.h>
 #include <streams/file_stream.h>
+#include <rthreads/tpool.h>
 
 #include "libretrodb.h"
 
@@ -743,19 +745,133 @@ static int dat_converter_value_provider(
    return 0;
 }
 
+/* One DAT file, lexed and parsed into a list of its own so that
+ * several of them can be worked on at once. The shards are merged
+ * in command line order afterwards, which gives the same result
+ * as parsing them one after the other into a single list. */
+typedef struct
+{
+   const char* path;
+   char* buffer;
+   dat_converter_list_t* list;
+} dat_converter_shard_t;
+
+typedef struct
+{
+   dat_converter_shard_t* shards;
+   dat_converter_match_key_t* match_key;
+} dat_converter_jobs_t;
+
+static void dat_converter_shard_parse(dat_converter_shard_t* shard,
+      dat_converter_match_key_t* match_key)
+{
+   size_t dat_file_size;
+   dat_converter_list_t* dat_lexer_list = NULL;
+   FILE* dat_file                       = fopen(shard->path, "r");
+
+   if (!dat_file)
+   {
+      printf("  could not open dat file '%s': %s\n",
+            shard->path, strerror(errno));
+      dat_converter_exit(1);
+   }
+
+   fseek(dat_file, 0, SEEK_END);
+   dat_file_size = ftell(dat_file);
+   fseek(dat_file, 0, SEEK_SET);
+   shard->buffer = (char*)malloc(dat_file_size + 1);
+   fread(shard->buffer, 1, dat_file_size, dat_file);
+   fclose(dat_file);
+   shard->buffer[dat_file_size] = '\0';
+
+   dat_lexer_list = dat_converter_lexer(shard->buffer, shard->path);
+   shard->list    = dat_converter_parser(NULL, dat_lexer_list, match_key);
+
+   dat_converter_list_free(dat_lexer_list);
+}
+
+static void dat_converter_job(void* data, unsigned index)
+{
+   dat_converter_jobs_t* jobs = (dat_converter_jobs_t*)data;
+
+   dat_converter_shard_parse(&jobs->shards[index], jobs->match_key);
+}
+
+/* Moves the entries of a shard into the target list, leaving
+ * only the (emptied) shard itself to be freed */
+static void dat_converter_shard_merge(dat_converter_list_t* target,
+      dat_converter_list_t* shard)
+{
+   int i;
+
+   /* skip the NULL-keyed map the parser starts every list with */
+   for (i = 1; i < shard->count; i++)
+      dat_converter_list_append(target, &shard->values[i].map);
+
+   shard->count = 0;
+   dat_converter_list_free(shard);
+}
+
+/* An RDB only needs rebuilding when it is missing or
+ * older than any of the DATs it is made from */
+static bool dat_converter_rdb_up_to_date(const char* rdb_path,
+      char** dat_paths, int dat_count)
+{
+   struct stat rdb_stat;
+
+   if (stat(rdb_path, &rdb_stat) != 0)
+      return false;
+
+   while (dat_count--)
+   {
+      struct stat dat_stat;
+
+      if (stat(dat_paths[dat_count], &dat_stat) != 0)
+         return false;
+
+      if (dat_stat.st_mtime >= rdb_stat.st_mtime)
+         return false;
+   }
+
+   return true;
+}
+
 int main(int argc, char** argv)
 {
    const char* rdb_path;
+   char rdb_tmp_path[PATH_MAX_LENGTH];
    dat_converter_match_key_t* match_key = NULL;
    RFILE* rdb_file;
+   bool incremental                     = false;
+   long jobs_count                      = sysconf(_SC_NPROCESSORS_ONLN);
+   const char* program                  = *argv;
+
+   argc--;
+   argv++;
+
+   while (argc && **argv == '-')
+   {
+      if (string_is_equal(*argv, "--incremental"))
+         incremental = true;
+      else if (string_is_equal(*argv, "-j") && argc > 1)
+      {
+         argc--;
+         argv++;
+         jobs_count = strtol(*argv, NULL, 10);
+      }
+      else
+         break;
+
+      argc--;
+      argv++;
+   }
 
    if (argc < 2)
    {
-      printf("usage:\n%s <db file> [args ...]\n", *argv);
+      printf("usage:\n%s [-j jobs] [--incremental] <db file> [args ...]\n",
+            program);
       dat_converter_exit(1);
    }
-   argc--;
-   argv++;
 
    rdb_path  = *argv;
    argc--;
@@ -768,46 +884,57 @@ int main(int argc, char** argv)
       argv++;
    }
 
+   if (incremental && dat_converter_rdb_up_to_date(rdb_path, argv, argc))
+   {
+      printf("  %s is up to date\n", rdb_path);
+      dat_converter_match_key_free(match_key);
+      return 0;
+   }
+
    int dat_count                         = argc;
-   char** dat_buffers                    = (char**)
-      malloc(dat_count * sizeof(*dat_buffers));
-   char** dat_buffer                     = dat_buffers;
+   dat_converter_shard_t* shards         = (dat_converter_shard_t*)
+      calloc(dat_count, sizeof(*shards));
    dat_converter_list_t* dat_parser_list = NULL;
+   int i;
 
-   while (argc)
-   {
-      size_t dat_file_size;
-      dat_converter_list_t* dat_lexer_list = NULL;
-      FILE* dat_file                       = fopen(*argv, "r");
+   for (i = 0; i < dat_count; i++)
+      shards[i].path = argv[i];
 
-      if (!dat_file)
-      {
-         printf("  could not open dat file '%s': %s\n",
-               *argv, strerror(errno));
-         dat_converter_exit(1);
-      }
+   if (jobs_count > dat_count)
+      jobs_count = dat_count;
 
-      fseek(dat_file, 0, SEEK_END);
-      dat_file_size = ftell(dat_file);
-      fseek(dat_file, 0, SEEK_SET);
-      *dat_buffer = (char*)malloc(dat_file_size + 1);
-      fread(*dat_buffer, 1, dat_file_size, dat_file);
-      fclose(dat_file);
-      (*dat_buffer)[dat_file_size] = '\0';
+   if (jobs_count > 1)
+   {
+      dat_converter_jobs_t jobs;
+      /* the calling thread parses shards too */
+      tpool_t* pool  = tpool_create(jobs_count - 1);
 
-      printf("  %s\n", *argv);
-      dat_lexer_list  = dat_converter_lexer(*dat_buffer, *argv);
-      dat_parser_list = dat_converter_parser(
-            dat_parser_list, dat_lexer_list, match_key);
+      jobs.shards    = shards;
+      jobs.match_key = match_key;
 
-      dat_converter_list_free(dat_lexer_list);
+      tpool_run_batch(pool, dat_converter_job, &jobs, dat_count);
+      tpool_destroy(pool);
+   }
+   else
+      for (i = 0; i < dat_count; i++)
+         dat_converter_shard_parse(&shards[i], match_key);
 
-      argc--;
-      argv++;
-      dat_buffer++;
+   for (i = 0; i < dat_count; i++)
+   {
+      printf("  %s\n", shards[i].path);
+
+      if (!dat_parser_list)
+         dat_parser_list = shards[i].list;
+      else
+         dat_converter_shard_merge(dat_parser_list, shards[i].list);
    }
 
-   rdb_file = filestream_open(rdb_path,
+   /* Write next to the destination and only replace it once
+    * complete, so an interrupted run never leaves behind an
+    * RDB that --incremental would take for up to date */
+   snprintf(rdb_tmp_path, sizeof(rdb_tmp_path), "%s.tmp", rdb_path);
+
+   rdb_file = filestream_open(rdb_tmp_path,
          RETRO_VFS_FILE_ACCESS_WRITE,
          RETRO_VFS_FILE_ACCESS_HINT_NONE);
 
@@ -815,7 +942,7 @@ int main(int argc, char** argv)
    {
       printf(
          "Could not open destination file '%s': %s\n",
-         rdb_path,
+         rdb_tmp_path,
          strerror(errno)
       );
       dat_converter_exit(1);
@@ -832,11 +959,22 @@ int main(int argc, char** argv)
 
    filestream_close(rdb_file);
 
+   if (rename(rdb_tmp_path, rdb_path) != 0)
+   {
+      printf(
+         "Could not replace destination file '%s': %s\n",
+         rdb_path,
+         strerror(errno)
+      );
+      remove(rdb_tmp_path);
+      dat_converter_exit(1);
+   }
+
    dat_converter_list_free(dat_parser_list);
 
-   while (dat_count--)
-      free(dat_buffers[dat_count]);
-   free(dat_buffers);
+   for (i = 0; i < dat_count; i++)
+      free(shards[i].buffer);
+   free(shards);
 
    dat_converter_match_key_free(match_key);
 
@@ -31,6 +31,7 @@
 #include <sys/stat.h>
 #include <stdlib.h>
 
+#include <boolean.h>
 #include <streams/file_stream.h>
 #include <retro_endianness.h>
 #include <string/stdstring.h>
@@ -45,6 +46,20 @@
 
 #define MAGIC_NUMBER "RARCHDB"
 
+/* Records are read ahead of the cursor this much at a time,
+ * so they can be looked at raw. The buffer only grows to
+ * fit bigger records */
+#define LIBRETRODB_RAW_BUFFER_SIZE 0x10000
+
+/* Databases are read through a memory mapping where the VFS
+ * supports it. Seeking is then free, reads are plain copies,
+ * and every handle to a file shares the same pages.
+ * This relies on databases only ever being replaced by
+ * renaming a new file over them (c_converter, the archive
+ * extraction of the updater), never rewritten in place -
+ * truncating a mapped file raises SIGBUS in its readers */
+#define LIBRETRODB_FILE_HINTS RETRO_VFS_FILE_ACCESS_HINT_FREQUENT_ACCESS
+
 struct node_iter_ctx
 {
 	libretrodb_t *db;
@@ -83,6 +98,14 @@ struct libretrodb_cursor
    RFILE *fd;
 	libretrodb_query_t *query;
 	libretrodb_t *db;
+   /* Read-ahead data, from 'raw_offset' in the file. When
+    * 'raw_len' is non-zero, the cursor is at 'raw_pos' and
+    * 'fd' is past the buffered data */
+   uint8_t *raw;
+   int64_t raw_offset;
+   size_t raw_pos;
+   size_t raw_len;
+   size_t raw_size;
 	int is_valid;
 	int eof;
 };
@@ -217,7 +240,7 @@ int libretrodb_open(const char *path, libretrodb_t *db)
    int rv    = 0;
    RFILE *fd = filestream_open(path,
          RETRO_VFS_FILE_ACCESS_READ,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+         LIBRETRODB_FILE_HINTS);
 
    if (!fd)
       return -errno;
@@ -360,22 +383,140 @@ int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
  **/
 int libretrodb_cursor_reset(libretrodb_cursor_t *cursor)
 {
-   cursor->eof = 0;
+   cursor->eof     = 0;
+   cursor->raw_pos = 0;
+   cursor->raw_len = 0;
    return (int)filestream_seek(cursor->fd,
          (ssize_t)(cursor->db->root + sizeof(libretrodb_header_t)),
          RETRO_VFS_SEEK_POSITION_START);
 }
 
+int64_t libretrodb_cursor_tell(libretrodb_cursor_t *cursor)
+{
+   if (cursor->raw_len)
+      return cursor->raw_offset + (int64_t)cursor->raw_pos;
+   return filestream_tell(cursor->fd);
+}
+
+int libretrodb_cursor_seek(libretrodb_cursor_t *cursor, uint64_t offset)
+{
+   cursor->eof     = 0;
+   cursor->raw_pos = 0;
+   cursor->raw_len = 0;
+   return (int)filestream_seek(cursor->fd, (int64_t)offset,
+         RETRO_VFS_SEEK_POSITION_START);
+}
+
+/* Moves the buffered data left to the front of the buffer
+ * and reads more after it, growing the buffer if it's full.
+ * Returns false if no more data could be read */
+static bool libretrodb_cursor_fill(libretrodb_cursor_t *cursor)
+{
+   int64_t nread;
+   size_t left;
+
+   if (!cursor->raw_len)
+   {
+      cursor->raw_offset = filestream_tell(cursor->fd);
+      cursor->raw_pos    = 0;
+   }
+
+   left = cursor->raw_len - cursor->raw_pos;
+
+   if (left == cursor->raw_size)
+   {
+      size_t size  = cursor->raw_size
+         ? cursor->raw_size * 2 : LIBRETRODB_RAW_BUFFER_SIZE;
+      uint8_t *raw = (uint8_t*)realloc(cursor->raw, size);
+
+      if (!raw)
+         return false;
+
+      cursor->raw      = raw;
+      cursor->raw_size = size;
+   }
+
+   memmove(cursor->raw, cursor->raw + cursor->raw_pos, left);
+   cursor->raw_offset += (int64_t)cursor->raw_pos;
+   cursor->raw_pos     = 0;
+   cursor->raw_len     = left;
+
+   nread = filestream_read(cursor->fd, cursor->raw + left,
+         cursor->raw_size - left);
+
+   if (nread <= 0)
+      return false;
+
+   cursor->raw_len += (size_t)nread;
+   return true;
+}
+
+/* Skips over the records that don't match the query without
+ * decoding them, then leaves 'fd' at the next record that has
+ * to be decoded. Returns 1 if that record is known to match */
+static int libretrodb_cursor_skip_raw(libretrodb_cursor_t *cursor)
+{
+   int rv;
+
+   for (;;)
+   {
+      size_t used = 0;
+
+      rv = libretrodb_query_filter_raw(cursor->query,
+            cursor->raw + cursor->raw_pos,
+            cursor->raw_len - cursor->raw_pos, &used);
+
+      if (rv == 0)
+         cursor->raw_pos += used;
+      else if (rv != -2 || !libretrodb_cursor_fill(cursor))
+         break;
+   }
+
+   if (cursor->raw_len)
+      filestream_seek(cursor->fd,
+            cursor->raw_offset + (int64_t)cursor->raw_pos,
+            RETRO_VFS_SEEK_POSITION_START);
+
+   return rv;
+}
+
 int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
       struct rmsgpack_dom_value *out)
 {
    int rv;
+   int raw = -1;
 
    if (cursor->eof)
       return EOF;
 
 retry:
+   if (cursor->query)
+      raw = libretrodb_cursor_skip_raw(cursor);
+
    rv = rmsgpack_dom_read(cursor->fd, out);
+
+   /* Go on from the buffered data, if the decoded record
+    * ended within it */
+   if (cursor->raw_len)
+   {
+      int64_t pos = filestream_tell(cursor->fd);
+
+      if (     rv >= 0
+            && pos >= cursor->raw_offset
+            && pos <= cursor->raw_offset + (int64_t)cursor->raw_len)
+      {
+         cursor->raw_pos = (size_t)(pos - cursor->raw_offset);
+         filestream_seek(cursor->fd,
+               cursor->raw_offset + (int64_t)cursor->raw_len,
+               RETRO_VFS_SEEK_POSITION_START);
+      }
+      else
+      {
+         cursor->raw_pos = 0;
+         cursor->raw_len = 0;
+      }
+   }
+
    if (rv < 0)
       return rv;
 
@@ -385,7 +526,7 @@ retry:
       return EOF;
    }
 
-   if (cursor->query)
+   if (cursor->query && raw != 1)
    {
       if (!libretrodb_query_filter(cursor->query, out))
       {
@@ -397,6 +538,81 @@ retry:
    return 0;
 }
 
+/* Runs the query over the buffered record at the cursor the
+ * regular way, for when it can't be run on the raw data */
+static int libretrodb_cursor_filter_dom(libretrodb_cursor_t *cursor)
+{
+   struct rmsgpack_dom_value item;
+   int rv = 0;
+
+   filestream_seek(cursor->fd,
+         cursor->raw_offset + (int64_t)cursor->raw_pos,
+         RETRO_VFS_SEEK_POSITION_START);
+
+   if (rmsgpack_dom_read(cursor->fd, &item) >= 0)
+   {
+      rv = libretrodb_query_filter(cursor->query, &item);
+      rmsgpack_dom_value_free(&item);
+   }
+
+   filestream_seek(cursor->fd,
+         cursor->raw_offset + (int64_t)cursor->raw_len,
+         RETRO_VFS_SEEK_POSITION_START);
+
+   return rv;
+}
+
+int libretrodb_cursor_read_raw(libretrodb_cursor_t *cursor,
+      const uint8_t **data, size_t *len)
+{
+   if (cursor->eof)
+      return EOF;
+
+   for (;;)
+   {
+      struct rmsgpack_item_head head;
+      size_t end         = 0;
+      const uint8_t *rec = cursor->raw + cursor->raw_pos;
+      size_t avail       = cursor->raw_len - cursor->raw_pos;
+
+      /* Get the whole record in the buffer */
+      if (     rmsgpack_parse_head(rec, avail, &end, &head) < 0
+            || rmsgpack_parse_skip(rec, avail, &end, &head) < 0)
+      {
+         if (libretrodb_cursor_fill(cursor))
+            continue;
+         return -EINVAL;
+      }
+
+      if (head.type == RMSGPACK_ITEM_NIL)
+      {
+         cursor->eof = 1;
+         return EOF;
+      }
+
+      if (cursor->query)
+      {
+         size_t used = 0;
+         int rv      = libretrodb_query_filter_raw(cursor->query,
+               rec, end, &used);
+
+         if (rv < 0)
+            rv = libretrodb_cursor_filter_dom(cursor);
+
+         if (!rv)
+         {
+            cursor->raw_pos += end;
+            continue;
+         }
+      }
+
+      cursor->raw_pos += end;
+      *data            = rec;
+      *len             = end;
+      return 0;
+   }
+}
+
 /**
  * libretrodb_cursor_close:
  * @cursor              : Handle to database cursor.
@@ -414,11 +630,18 @@ void libretrodb_cursor_close(libretrodb_cursor_t *cursor)
    if (cursor->query)
       libretrodb_query_free(cursor->query);
 
+   if (cursor->raw)
+      free(cursor->raw);
+
    cursor->is_valid = 0;
    cursor->eof      = 1;
    cursor->fd       = NULL;
    cursor->db       = NULL;
    cursor->query    = NULL;
+   cursor->raw      = NULL;
+   cursor->raw_pos  = 0;
+   cursor->raw_len  = 0;
+   cursor->raw_size = 0;
 }
 
 /**
@@ -441,7 +664,7 @@ int libretrodb_cursor_open(libretrodb_t *db,
 
    fd = filestream_open(db->path,
          RETRO_VFS_FILE_ACCESS_READ,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+         LIBRETRODB_FILE_HINTS);
 
    if (!fd)
       return -errno;
@@ -588,6 +811,11 @@ libretrodb_cursor_t *libretrodb_cursor_new(void)
    dbc->eof                 = 0;
    dbc->query               = NULL;
    dbc->db                  = NULL;
+   dbc->raw                 = NULL;
+   dbc->raw_offset          = 0;
+   dbc->raw_pos             = 0;
+   dbc->raw_len             = 0;
+   dbc->raw_size            = 0;
 
    return dbc;
 }
@@ -89,6 +89,25 @@ int libretrodb_cursor_open(libretrodb_t *db,
  **/
 int libretrodb_cursor_reset(libretrodb_cursor_t *cursor);
 
+/**
+ * libretrodb_cursor_tell:
+ * @cursor              : Handle to database cursor.
+ *
+ * Returns: offset of the item read next, or negative on error.
+ **/
+int64_t libretrodb_cursor_tell(libretrodb_cursor_t *cursor);
+
+/**
+ * libretrodb_cursor_seek:
+ * @cursor              : Handle to database cursor.
+ * @offset              : Item offset, as returned by libretrodb_cursor_tell.
+ *
+ * Moves cursor to the item at @offset.
+ *
+ * Returns: 0 if successful, otherwise negative.
+ **/
+int libretrodb_cursor_seek(libretrodb_cursor_t *cursor, uint64_t offset);
+
 /**
  * libretrodb_cursor_close:
  * @cursor              : Handle to database cursor.
@@ -105,6 +124,23 @@ void libretrodb_query_free(void *q);
 int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
       struct rmsgpack_dom_value *out);
 
+/**
+ * libretrodb_cursor_read_raw:
+ * @cursor              : Handle to database cursor.
+ * @data                : Set to the raw msgpack of the record read.
+ * @len                 : Set to the size of the record read.
+ *
+ * Reads the next record matching the cursor's query, like
+ * libretrodb_cursor_read_item(), without decoding it. Nothing
+ * gets allocated per record: @data points into the cursor's
+ * own buffer, and is only valid until the cursor is used again.
+ * See rmsgpack_parse_head() for going through it.
+ *
+ * Returns: 0 if successful, EOF at the end, otherwise negative.
+ **/
+int libretrodb_cursor_read_raw(libretrodb_cursor_t *cursor,
+      const uint8_t **data, size_t *len);
+
 RETRO_END_DECLS
 
 #endif
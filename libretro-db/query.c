@@ -37,6 +37,7 @@
 
 #include "libretrodb.h"
 #include "query.h"
+#include "rmsgpack.h"
 #include "rmsgpack_dom.h"
 
 #define MAX_ERROR_LEN   256
@@ -80,9 +81,22 @@ struct argument
    enum argument_type type;
 };
 
+/* One 'key: value' or 'key: glob(pattern)' of a plain
+ * table query, checked straight against the raw record */
+struct query_raw_term
+{
+   const struct rmsgpack_dom_value *key;
+   const struct rmsgpack_dom_value *value;
+   bool glob;
+   bool seen;
+};
+
 struct query
 {
    struct invocation root; /* ptr alignment */
+   /* NULL unless every term of the query has a raw form */
+   struct query_raw_term *raw;
+   unsigned raw_count;
    unsigned ref_count;
 };
 
@@ -919,11 +933,240 @@ void libretrodb_query_free(void *q)
       query_argument_free(&real_q->root.argv[i]);
 
    free(real_q->root.argv);
+   if (real_q->raw)
+      free(real_q->raw);
    real_q->root.argv = NULL;
    real_q->root.argc = 0;
+   real_q->raw       = NULL;
    free(real_q);
 }
 
+/* Table queries only made of plain values and globs - which
+ * is what the menu and database scans use - can be checked
+ * against the raw msgpack bytes of a record, so records that
+ * don't match never have to be decoded */
+static void query_compile_raw(struct query *q)
+{
+   unsigned i;
+   unsigned count = q->root.argc / 2;
+
+   if (     q->root.func != query_func_all_map
+         || q->root.argc == 0
+         || (q->root.argc % 2) != 0)
+      return;
+
+   for (i = 0; i < q->root.argc; i += 2)
+   {
+      const struct argument *key = &q->root.argv[i];
+      const struct argument *val = &q->root.argv[i + 1];
+
+      unsigned j;
+
+      if (key->type != AT_VALUE || key->a.value.type != RDT_STRING)
+         return;
+
+      /* Each field is only looked at once */
+      for (j = 0; j < i; j += 2)
+         if (rmsgpack_dom_value_cmp(&key->a.value,
+                  &q->root.argv[j].a.value) == 0)
+            return;
+
+      if (val->type == AT_VALUE)
+      {
+         switch (val->a.value.type)
+         {
+            case RDT_STRING:
+            case RDT_BINARY:
+            case RDT_INT:
+            case RDT_UINT:
+               break;
+            default:
+               return;
+         }
+      }
+      else if (     val->a.invocation.func != query_func_glob
+               ||   val->a.invocation.argc != 1
+               ||   val->a.invocation.argv[0].type != AT_VALUE
+               ||   val->a.invocation.argv[0].a.value.type != RDT_STRING)
+         return;
+   }
+
+   if (!(q->raw = (struct query_raw_term*)calloc(count, sizeof(*q->raw))))
+      return;
+
+   for (i = 0; i < count; i++)
+   {
+      const struct argument *val = &q->root.argv[i * 2 + 1];
+
+      q->raw[i].key   = &q->root.argv[i * 2].a.value;
+      if (val->type == AT_VALUE)
+         q->raw[i].value = &val->a.value;
+      else
+      {
+         q->raw[i].value = &val->a.invocation.argv[0].a.value;
+         q->raw[i].glob  = true;
+      }
+   }
+
+   q->raw_count = count;
+}
+
+/* Same result as func_equals()/query_func_glob() on the
+ * decoded value. Returns 1 on a match, 0 if not, or a negative
+ * value if the value runs past the buffer */
+static int query_raw_term_match(const uint8_t *data, size_t len,
+      size_t *pos, const struct query_raw_term *term,
+      const struct rmsgpack_item_head *head)
+{
+   int rv;
+   const char *str                    = NULL;
+   const struct rmsgpack_dom_value *v = term->value;
+
+   if (     (head->type != RMSGPACK_ITEM_STRING && head->type != RMSGPACK_ITEM_BINARY)
+         || ( term->glob && head->type != RMSGPACK_ITEM_STRING)
+         || (!term->glob && (v->type == RDT_INT || v->type == RDT_UINT)))
+   {
+      if ((rv = rmsgpack_parse_skip(data, len, pos, head)) < 0)
+         return rv;
+
+      if (term->glob)
+         return 0;
+
+      switch (v->type)
+      {
+         case RDT_INT:
+            if (head->type == RMSGPACK_ITEM_INT)
+               return head->val.int_ == v->val.int_;
+            /* Integers are compared unsigned against unsigned fields */
+            if (head->type == RMSGPACK_ITEM_UINT)
+               return head->val.uint_ == (uint64_t)v->val.int_;
+            return 0;
+         case RDT_UINT:
+            return  head->type == RMSGPACK_ITEM_UINT
+               &&   head->val.uint_ == v->val.uint_;
+         default:
+            return 0;
+      }
+   }
+
+   if (head->len > len - *pos)
+      return -1;
+
+   str   = (const char*)data + *pos;
+   *pos += (size_t)head->len;
+
+   if (term->glob)
+   {
+      /* fnmatch needs the string NUL terminated */
+      char tmp[256];
+      char *buff = tmp;
+
+      if (head->len >= sizeof(tmp))
+         if (!(buff = (char*)malloc((size_t)head->len + 1)))
+            return -1;
+
+      memcpy(buff, str, (size_t)head->len);
+      buff[head->len] = '\0';
+      rv              = rl_fnmatch(v->val.string.buff, buff, 0) == 0;
+
+      if (buff != tmp)
+         free(buff);
+      return rv;
+   }
+
+   /* Strings and binaries of the wrong type or size can't match */
+   if (     (v->type == RDT_STRING) != (head->type == RMSGPACK_ITEM_STRING)
+         || head->len != v->val.string.len)
+      return 0;
+
+   if (v->type == RDT_STRING)
+      return strncmp(str, v->val.string.buff, v->val.string.len) == 0;
+   return memcmp(str, v->val.binary.buff, v->val.binary.len) == 0;
+}
+
+int libretrodb_query_filter_raw(libretrodb_query_t *q,
+      const uint8_t *data, size_t len, size_t *consumed)
+{
+   uint64_t i;
+   unsigned j;
+   struct rmsgpack_item_head head;
+   size_t pos       = 0;
+   struct query *rq = (struct query *)q;
+   bool match       = true;
+
+   if (!rq->raw)
+      return -1;
+
+   if (rmsgpack_parse_head(data, len, &pos, &head) < 0)
+      return -2;
+
+   /* Non-map records (and the trailing nil) always take the
+    * regular path */
+   if (head.type != RMSGPACK_ITEM_MAP)
+      return -1;
+
+   for (j = 0; j < rq->raw_count; j++)
+      rq->raw[j].seen = false;
+
+   for (i = 0; i < head.len; i++)
+   {
+      struct rmsgpack_item_head key;
+      struct rmsgpack_item_head value;
+      struct query_raw_term *term = NULL;
+
+      if (rmsgpack_parse_head(data, len, &pos, &key) < 0)
+         return -2;
+
+      if (key.type == RMSGPACK_ITEM_STRING && match)
+      {
+         const char *name = (const char*)data + pos;
+
+         if (key.len > len - pos)
+            return -2;
+
+         /* Only the first occurrence of a key counts */
+         for (j = 0; j < rq->raw_count; j++)
+         {
+            const struct rmsgpack_dom_value *k = rq->raw[j].key;
+
+            if (     !rq->raw[j].seen
+                  && k->val.string.len == key.len
+                  && strncmp(name, k->val.string.buff, k->val.string.len) == 0)
+            {
+               term = &rq->raw[j];
+               break;
+            }
+         }
+      }
+
+      if (     rmsgpack_parse_skip(data, len, &pos, &key) < 0
+            || rmsgpack_parse_head(data, len, &pos, &value) < 0)
+         return -2;
+
+      if (term)
+      {
+         int rv = query_raw_term_match(data, len, &pos, term, &value);
+
+         if (rv < 0)
+            return -2;
+
+         term->seen = true;
+         if (!rv)
+            match   = false;
+      }
+      else if (rmsgpack_parse_skip(data, len, &pos, &value) < 0)
+         return -2;
+   }
+
+   /* Missing fields are nil, which no term matches */
+   for (j = 0; j < rq->raw_count && match; j++)
+      if (!rq->raw[j].seen)
+         match = false;
+
+   *consumed = pos;
+   return match ? 1 : 0;
+}
+
 void *libretrodb_query_compile(libretrodb_t *db,
       const char *query, size_t buff_len, const char **error_string)
 {
@@ -940,6 +1183,8 @@ void *libretrodb_query_compile(libretrodb_t *db,
    q->root.argc          = 0;
    q->root.func          = NULL;
    q->root.argv          = NULL;
+   q->raw                = NULL;
+   q->raw_count          = 0;
 
    buff.data             = query;
    buff.len              = buff_len;
@@ -977,6 +1222,8 @@ void *libretrodb_query_compile(libretrodb_t *db,
       goto error;
    }
 
+   query_compile_raw(q);
+
    return q;
 
 error:
@@ -38,6 +38,22 @@ void libretrodb_query_dec_ref(libretrodb_query_t *q);
 
 int libretrodb_query_filter(libretrodb_query_t *q, struct rmsgpack_dom_value *v);
 
+/**
+ * libretrodb_query_filter_raw:
+ * @q                   : Query to match against.
+ * @data                : Raw msgpack, starting with a record.
+ * @len                 : Number of bytes available in @data.
+ * @consumed            : Size of the record, if it was matched.
+ *
+ * Matches a record without decoding it, for queries that allow it.
+ *
+ * Returns: 1 if the record matches, 0 if it doesn't, -1 if it has to
+ * be decoded and passed to libretrodb_query_filter() instead, or -2
+ * if the record doesn't fit in @len bytes.
+ **/
+int libretrodb_query_filter_raw(libretrodb_query_t *q,
+      const uint8_t *data, size_t len, size_t *consumed);
+
 RETRO_END_DECLS
 
 #endif
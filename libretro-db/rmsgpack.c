@@ -658,3 +658,177 @@ int rmsgpack_read(RFILE *fd,
 error:
    return -errno;
 }
+
+static int parse_head_uint(const uint8_t *data, size_t len, size_t *pos,
+      uint64_t *out, size_t size)
+{
+   size_t i;
+   uint64_t v = 0;
+
+   if (len - *pos < size)
+      return -EINVAL;
+
+   for (i = 0; i < size; i++)
+      v = (v << 8) | data[*pos + i];
+
+   *pos += size;
+   *out  = v;
+   return 0;
+}
+
+int rmsgpack_parse_head(const uint8_t *data, size_t len, size_t *pos,
+      struct rmsgpack_item_head *head)
+{
+   uint64_t tmp;
+   uint8_t type;
+   int rv          = 0;
+
+   head->val.uint_ = 0;
+   head->len       = 0;
+
+   if (*pos >= len)
+      return -EINVAL;
+
+   type            = data[(*pos)++];
+
+   if (type < MPF_FIXMAP)
+   {
+      head->type     = RMSGPACK_ITEM_INT;
+      head->val.int_ = type;
+      return 0;
+   }
+   else if (type < MPF_FIXARRAY)
+   {
+      head->type = RMSGPACK_ITEM_MAP;
+      head->len  = type - MPF_FIXMAP;
+      return 0;
+   }
+   else if (type < MPF_FIXSTR)
+   {
+      head->type = RMSGPACK_ITEM_ARRAY;
+      head->len  = type - MPF_FIXARRAY;
+      return 0;
+   }
+   else if (type < MPF_NIL)
+   {
+      head->type = RMSGPACK_ITEM_STRING;
+      head->len  = type - MPF_FIXSTR;
+      return 0;
+   }
+   else if (type > MPF_MAP32)
+   {
+      head->type     = RMSGPACK_ITEM_INT;
+      head->val.int_ = type - 0xff - 1;
+      return 0;
+   }
+
+   switch (type)
+   {
+      case _MPF_NIL:
+         head->type      = RMSGPACK_ITEM_NIL;
+         break;
+      case _MPF_FALSE:
+      case _MPF_TRUE:
+         head->type      = RMSGPACK_ITEM_BOOL;
+         head->val.uint_ = (type == _MPF_TRUE);
+         break;
+      case _MPF_BIN8:
+      case _MPF_BIN16:
+      case _MPF_BIN32:
+         head->type = RMSGPACK_ITEM_BINARY;
+         rv         = parse_head_uint(data, len, pos, &head->len,
+               (size_t)(1 << (type - _MPF_BIN8)));
+         break;
+      case _MPF_STR8:
+      case _MPF_STR16:
+      case _MPF_STR32:
+         head->type = RMSGPACK_ITEM_STRING;
+         rv         = parse_head_uint(data, len, pos, &head->len,
+               (size_t)(1 << (type - _MPF_STR8)));
+         break;
+      case _MPF_UINT8:
+      case _MPF_UINT16:
+      case _MPF_UINT32:
+      case _MPF_UINT64:
+         head->type = RMSGPACK_ITEM_UINT;
+         rv         = parse_head_uint(data, len, pos, &head->val.uint_,
+               (size_t)(1 << (type - _MPF_UINT8)));
+         break;
+      case _MPF_INT8:
+      case _MPF_INT16:
+      case _MPF_INT32:
+      case _MPF_INT64:
+         head->type = RMSGPACK_ITEM_INT;
+         if ((rv = parse_head_uint(data, len, pos, &tmp,
+                     (size_t)(1 << (type - _MPF_INT8)))) < 0)
+            return rv;
+         switch (type)
+         {
+            case _MPF_INT8:
+               head->val.int_ = (int8_t)tmp;
+               break;
+            case _MPF_INT16:
+               head->val.int_ = (int16_t)tmp;
+               break;
+            case _MPF_INT32:
+               head->val.int_ = (int32_t)tmp;
+               break;
+            default:
+               head->val.int_ = (int64_t)tmp;
+               break;
+         }
+         break;
+      case _MPF_ARRAY16:
+      case _MPF_ARRAY32:
+         head->type = RMSGPACK_ITEM_ARRAY;
+         rv         = parse_head_uint(data, len, pos, &head->len,
+               2 << (type - _MPF_ARRAY16));
+         break;
+      case _MPF_MAP16:
+      case _MPF_MAP32:
+         head->type = RMSGPACK_ITEM_MAP;
+         rv         = parse_head_uint(data, len, pos, &head->len,
+               2 << (type - _MPF_MAP16));
+         break;
+      default:
+         return -EINVAL;
+   }
+
+   return rv;
+}
+
+int rmsgpack_parse_skip(const uint8_t *data, size_t len, size_t *pos,
+      const struct rmsgpack_item_head *head)
+{
+   int rv;
+   uint64_t i, count;
+   struct rmsgpack_item_head child;
+
+   switch (head->type)
+   {
+      case RMSGPACK_ITEM_STRING:
+      case RMSGPACK_ITEM_BINARY:
+         if (head->len > len - *pos)
+            return -EINVAL;
+         *pos += (size_t)head->len;
+         return 0;
+      case RMSGPACK_ITEM_MAP:
+         count = head->len * 2;
+         break;
+      case RMSGPACK_ITEM_ARRAY:
+         count = head->len;
+         break;
+      default:
+         return 0;
+   }
+
+   for (i = 0; i < count; i++)
+   {
+      if ((rv = rmsgpack_parse_head(data, len, pos, &child)) < 0)
+         return rv;
+      if ((rv = rmsgpack_parse_skip(data, len, pos, &child)) < 0)
+         return rv;
+   }
+
+   return 0;
+}
@@ -23,6 +23,7 @@
 #ifndef __LIBRETRODB_MSGPACK_H__
 #define __LIBRETRODB_MSGPACK_H__
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include <streams/file_stream.h>
@@ -39,6 +40,32 @@ struct rmsgpack_read_callbacks
    int (*read_array_start)(uint32_t, void *);
 };
 
+enum rmsgpack_item_type
+{
+   RMSGPACK_ITEM_NIL = 0,
+   RMSGPACK_ITEM_BOOL,
+   RMSGPACK_ITEM_UINT,
+   RMSGPACK_ITEM_INT,
+   RMSGPACK_ITEM_STRING,
+   RMSGPACK_ITEM_BINARY,
+   RMSGPACK_ITEM_MAP,
+   RMSGPACK_ITEM_ARRAY
+};
+
+/* Type of an item, with either its scalar value or the size
+ * of what follows - bytes for strings and binaries, items for
+ * arrays and pairs for maps */
+struct rmsgpack_item_head
+{
+   union
+   {
+      uint64_t uint_;
+      int64_t int_;
+   } val;
+   uint64_t len;
+   enum rmsgpack_item_type type;
+};
+
 int rmsgpack_write_array_header(RFILE *fd, uint32_t size);
 
 int rmsgpack_write_map_header(RFILE *fd, uint32_t size);
@@ -57,4 +84,13 @@ int rmsgpack_write_uint(RFILE *fd, uint64_t value );
 
 int rmsgpack_read(RFILE *fd, struct rmsgpack_read_callbacks *callbacks, void *data);
 
+/* Parse an item in place from a buffer holding raw msgpack,
+ * advancing @pos. Both fail when running past @len */
+int rmsgpack_parse_head(const uint8_t *data, size_t len, size_t *pos,
+      struct rmsgpack_item_head *head);
+
+/* Skips over whatever follows the head just parsed */
+int rmsgpack_parse_skip(const uint8_t *data, size_t len, size_t *pos,
+      const struct rmsgpack_item_head *head);
+
 #endif
@@ -25,6 +25,11 @@
 #include <string/stdstring.h>
 #include <lists/dir_list.h>
 #include <retro_miscellaneous.h>
+#ifdef HAVE_THREADS
+#include <features/features_cpu.h>
+#include <rthreads/rthreads.h>
+#include <rthreads/tpool.h>
+#endif
 
 #include "msg_hash.h"
 #include "list_special.h"
@@ -907,6 +912,176 @@ bool manual_content_scan_get_task_config(
  * content directory
  * > Returns NULL in the event of failure
  * > Returned string list must be free()'d */
+#ifdef HAVE_THREADS
+/* Upper bound on the threads listing directories.
+ * Listing is bound by file access latency (e.g. on
+ * network shares), so this is not tied to the
+ * amount of cores */
+#define MANUAL_CONTENT_SCAN_MAX_WALKERS 8
+
+typedef struct
+{
+   struct string_list *dirs;  /* every directory found so far */
+   struct string_list *files;
+   const char *file_exts;
+   slock_t *lock;
+   scond_t *cond;
+   size_t next_dir;
+   unsigned busy;             /* walkers listing a directory */
+   bool include_compressed;
+   bool error;
+} manual_content_scan_walk_t;
+
+static void manual_content_scan_walk_thread(void *data)
+{
+   manual_content_scan_walk_t *walk = (manual_content_scan_walk_t*)data;
+
+   slock_lock(walk->lock);
+
+   while (!walk->error)
+   {
+      size_t i;
+      char *dir                = NULL;
+      struct string_list *list = NULL;
+
+      if (walk->next_dir >= walk->dirs->size)
+      {
+         /* Done once no one can find more directories */
+         if (!walk->busy)
+            break;
+         scond_wait(walk->cond, walk->lock);
+         continue;
+      }
+
+      /* 'dirs' may be reallocated while unlocked */
+      dir = strdup(walk->dirs->elems[walk->next_dir++].data);
+      walk->busy++;
+      slock_unlock(walk->lock);
+
+      /* As dir_list_new() would do when recursing,
+       * directories that cannot be read are skipped */
+      if (dir)
+         list = dir_list_new(dir, walk->file_exts,
+               true,  /* include_dirs */
+               false, /* include_hidden */
+               walk->include_compressed,
+               false  /* recursive */
+         );
+      free(dir);
+
+      slock_lock(walk->lock);
+      walk->busy--;
+
+      if (list)
+      {
+         for (i = 0; i < list->size; i++)
+         {
+            struct string_list *dst =
+                  (list->elems[i].attr.i == RARCH_DIRECTORY)
+                  ? walk->dirs : walk->files;
+
+            if (!string_list_append(dst,
+                     list->elems[i].data, list->elems[i].attr))
+               walk->error = true;
+         }
+
+         string_list_free(list);
+      }
+
+      scond_broadcast(walk->cond);
+   }
+
+   scond_broadcast(walk->cond);
+   slock_unlock(walk->lock);
+}
+
+/* Lists all files below 'dir' the same way as a recursive
+ * dir_list_new(), but lists several directories at once */
+static struct string_list *manual_content_scan_walk(const char *dir,
+      const char *file_exts, bool include_compressed)
+{
+   size_t i;
+   manual_content_scan_walk_t walk;
+   tpool_t *pool        = NULL;
+   unsigned max_workers = cpu_features_get_core_amount();
+
+   if (max_workers < 4)
+      max_workers = 4;
+   if (max_workers > MANUAL_CONTENT_SCAN_MAX_WALKERS)
+      max_workers = MANUAL_CONTENT_SCAN_MAX_WALKERS;
+   /* Calling thread is a walker too */
+   max_workers--;
+
+   walk.dirs               = string_list_new();
+   walk.files              = string_list_new();
+   walk.file_exts          = file_exts;
+   walk.lock               = slock_new();
+   walk.cond               = scond_new();
+   walk.next_dir           = 0;
+   walk.busy               = 0;
+   walk.include_compressed = include_compressed;
+   walk.error              = false;
+
+   if (!walk.dirs || !walk.files || !walk.lock || !walk.cond)
+      goto error;
+
+   /* Unlike its subdirectories, the content
+    * directory itself must be readable */
+   {
+      union string_list_elem_attr attr;
+      struct string_list *list = dir_list_new(dir, file_exts,
+            true, false, include_compressed, false);
+
+      if (!list)
+         goto error;
+
+      for (i = 0; i < list->size; i++)
+      {
+         attr = list->elems[i].attr;
+
+         if (!string_list_append(
+                  (attr.i == RARCH_DIRECTORY) ? walk.dirs : walk.files,
+                  list->elems[i].data, attr))
+            walk.error = true;
+      }
+
+      string_list_free(list);
+   }
+
+   /* Each pool thread walks until no one can find more
+    * directories, so the calling thread returns only
+    * once the walk is complete. tpool_destroy() then
+    * waits for the walkers still winding down. */
+   if (walk.dirs->size > 0 && (pool = tpool_create(max_workers)))
+      for (i = 0; i < max_workers; i++)
+         tpool_add_work(pool, manual_content_scan_walk_thread, &walk);
+
+   manual_content_scan_walk_thread(&walk);
+
+   tpool_destroy(pool);
+
+   if (walk.error)
+      goto error;
+
+   string_list_free(walk.dirs);
+   scond_free(walk.cond);
+   slock_free(walk.lock);
+
+   return walk.files;
+
+error:
+   if (walk.dirs)
+      string_list_free(walk.dirs);
+   if (walk.files)
+      string_list_free(walk.files);
+   if (walk.cond)
+      scond_free(walk.cond);
+   if (walk.lock)
+      slock_free(walk.lock);
+   return NULL;
+}
+#endif
+
 struct string_list *manual_content_scan_get_content_list(manual_content_scan_task_config_t *task_config)
 {
    struct string_list *dir_list = NULL;
@@ -937,14 +1112,22 @@ struct string_list *manual_content_scan_get_content_list(manual_content_scan_tas
 
    /* Get directory listing
     * > Exclude directories and hidden files */
-   dir_list = dir_list_new(
-         task_config->content_dir,
-         filter_exts ? task_config->file_exts : NULL,
-         false, /* include_dirs */
-         false, /* include_hidden */
-         include_compressed,
-         task_config->search_recursively
-   );
+#ifdef HAVE_THREADS
+   if (task_config->search_recursively)
+      dir_list = manual_content_scan_walk(
+            task_config->content_dir,
+            filter_exts ? task_config->file_exts : NULL,
+            include_compressed);
+   else
+#endif
+      dir_list = dir_list_new(
+            task_config->content_dir,
+            filter_exts ? task_config->file_exts : NULL,
+            false, /* include_dirs */
+            false, /* include_hidden */
+            include_compressed,
+            task_config->search_recursively
+      );
 
    /* Sanity check */
    if (!dir_list)
@@ -1113,6 +1296,55 @@ static bool manual_content_scan_get_playlist_content_label(
    return true;
 }
 
+/* Gets the playlist path and label of specified
+ * content, without touching any playlist */
+bool manual_content_scan_get_playlist_entry(
+      manual_content_scan_task_config_t *task_config,
+      const char *content_path, int content_type,
+      logiqx_dat_t *dat_file,
+      char *playlist_content_path, size_t path_len,
+      char *label, size_t label_len)
+{
+   playlist_content_path[0] = '\0';
+   label[0]                 = '\0';
+
+   /* Sanity check */
+   if (!task_config)
+      return false;
+
+   /* Get 'actual' content path */
+   if (!manual_content_scan_get_playlist_content_path(
+         task_config, content_path, content_type,
+         playlist_content_path, path_len))
+      return false;
+
+   /* Get entry label */
+   return manual_content_scan_get_playlist_content_label(
+         playlist_content_path, dat_file,
+         task_config->filter_dat_content,
+         label, label_len);
+}
+
+/* Sets up a playlist entry for content found by
+ * manual_content_scan_get_playlist_entry() */
+void manual_content_scan_init_playlist_entry(
+      manual_content_scan_task_config_t *task_config,
+      struct playlist_entry *entry,
+      const char *playlist_content_path, const char *label)
+{
+   memset(entry, 0, sizeof(*entry));
+
+   /* Configure playlist entry
+    * > The push function reads our entry as const,
+    *   so these casts are safe */
+   entry->path      = (char*)playlist_content_path;
+   entry->label     = (char*)label;
+   entry->core_path = (char*)"DETECT";
+   entry->core_name = (char*)"DETECT";
+   entry->crc32     = (char*)"00000000|crc";
+   entry->db_name   = task_config->database_name;
+}
+
 /* Adds specified content to playlist, if not already
  * present */
 void manual_content_scan_add_content_to_playlist(
@@ -1121,46 +1353,27 @@ void manual_content_scan_add_content_to_playlist(
       int content_type, logiqx_dat_t *dat_file)
 {
    char playlist_content_path[PATH_MAX_LENGTH];
-
-   playlist_content_path[0] = '\0';
+   char label[PATH_MAX_LENGTH];
+   struct playlist_entry entry;
 
    /* Sanity check */
    if (!task_config || !playlist)
       return;
 
-   /* Get 'actual' content path */
-   if (!manual_content_scan_get_playlist_content_path(
-         task_config, content_path, content_type,
-         playlist_content_path, sizeof(playlist_content_path)))
+   if (!manual_content_scan_get_playlist_entry(task_config,
+         content_path, content_type, dat_file,
+         playlist_content_path, sizeof(playlist_content_path),
+         label, sizeof(label)))
       return;
 
    /* Check whether content is already included
     * in playlist */
-   if (!playlist_entry_exists(playlist, playlist_content_path))
-   {
-      struct playlist_entry entry = {0};
-      char label[PATH_MAX_LENGTH];
-
-      label[0] = '\0';
-
-      /* Get entry label */
-      if (!manual_content_scan_get_playlist_content_label(
-            playlist_content_path, dat_file,
-            task_config->filter_dat_content,
-            label, sizeof(label)))
-         return;
-
-      /* Configure playlist entry
-       * > The push function reads our entry as const,
-       *   so these casts are safe */
-      entry.path      = (char*)playlist_content_path;
-      entry.label     = label;
-      entry.core_path = (char*)"DETECT";
-      entry.core_name = (char*)"DETECT";
-      entry.crc32     = (char*)"00000000|crc";
-      entry.db_name   = task_config->database_name;
-
-      /* Add entry to playlist */
-      playlist_push(playlist, &entry);
-   }
+   if (playlist_entry_exists(playlist, playlist_content_path))
+      return;
+
+   manual_content_scan_init_playlist_entry(task_config,
+         &entry, playlist_content_path, label);
+
+   /* Add entry to playlist */
+   playlist_push(playlist, &entry);
 }
@@ -241,6 +241,26 @@ bool manual_content_scan_get_task_config(
  * > Returned string list must be free()'d */
 struct string_list *manual_content_scan_get_content_list(manual_content_scan_task_config_t *task_config);
 
+/* Gets the path and label of the playlist entry for
+ * specified content, without touching any playlist
+ * > May be called from any thread
+ * > Returns false if content is invalid, or should
+ *   not be added */
+bool manual_content_scan_get_playlist_entry(
+      manual_content_scan_task_config_t *task_config,
+      const char *content_path, int content_type,
+      logiqx_dat_t *dat_file,
+      char *playlist_content_path, size_t path_len,
+      char *label, size_t label_len);
+
+/* Sets up a playlist entry for content found by
+ * manual_content_scan_get_playlist_entry()
+ * > Entry points to the specified strings */
+void manual_content_scan_init_playlist_entry(
+      manual_content_scan_task_config_t *task_config,
+      struct playlist_entry *entry,
+      const char *playlist_content_path, const char *label);
+
 /* Adds specified content to playlist, if not already
  * present */
 void manual_content_scan_add_content_to_playlist(
@@ -263,7 +263,18 @@ static void menu_action_setting_disp_set_label_shader_pass(
       return;
 
    if (!string_is_empty(shader_pass->source.path))
+   {
+      retro_time_t pass_time = video_driver_get_shader_pass_time(
+            type - MENU_SETTINGS_SHADER_PASS_0);
+
       fill_pathname_base(s, shader_pass->source.path, len);
+
+      if (pass_time >= 0)
+      {
+         size_t _len = strlen(s);
+         snprintf(s + _len, len - _len, " (%.2f ms)", pass_time / 1000.0f);
+      }
+   }
 }
 
 static void menu_action_setting_disp_set_label_shader_default_filter(
@@ -1885,9 +1885,7 @@ static int generic_action_ok(const char *path,
                   settings->paths.path_menu_wallpaper,
                   action_path);
 
-            task_push_image_load(action_path,
-                  video_driver_supports_rgba(), 0,
-                  menu_display_handle_wallpaper_upload, NULL);
+            menu_display_load_wallpaper(action_path);
          }
          break;
       case ACTION_OK_LOAD_CORE:
@@ -2922,6 +2920,23 @@ static void menu_input_st_string_cb_rename_entry(void *userdata,
    menu_input_dialog_end();
 }
 
+#ifdef HAVE_BSV_MOVIE
+static void menu_input_st_string_cb_movie_seek(void *userdata,
+      const char *str)
+{
+   bool seeked = false;
+
+   if (str && *str)
+      seeked = command_event(CMD_EVENT_BSV_SEEK,
+            (void*)menu_input_dialog_get_buffer());
+
+   menu_input_dialog_end();
+
+   if (seeked)
+      command_event(CMD_EVENT_RESUME, NULL);
+}
+#endif
+
 static void menu_input_st_string_cb_disable_kiosk_mode(void *userdata,
       const char *str)
 {
@@ -3259,7 +3274,7 @@ static int action_ok_video_filter_remove(const char *path,
 
       /* Unload video filter */
       settings->paths.path_softfilter_plugin[0] = '\0';
-      command_event(CMD_EVENT_REINIT, NULL);
+      command_event(CMD_EVENT_VIDEO_FILTER_REINIT, NULL);
 
       /* Refresh menu */
       menu_entries_ctl(MENU_ENTRIES_CTL_SET_REFRESH, &refresh);
@@ -3331,6 +3346,12 @@ DEFAULT_ACTION_DIALOG_START(action_ok_cheat_file_save_as,
    (unsigned)idx,
    menu_input_st_string_cb_cheat_file_save_as)
 #endif
+#ifdef HAVE_BSV_MOVIE
+DEFAULT_ACTION_DIALOG_START(action_ok_movie_seek,
+   msg_hash_to_str(MSG_INPUT_MOVIE_SEEK),
+   (unsigned)entry_idx,
+   menu_input_st_string_cb_movie_seek)
+#endif
 DEFAULT_ACTION_DIALOG_START(action_ok_disable_kiosk_mode,
    msg_hash_to_str(MSG_INPUT_KIOSK_MODE_PASSWORD),
    (unsigned)entry_idx,
@@ -4925,6 +4946,7 @@ static int action_ok_update_installed_cores(const char *path,
    settings_t          *settings     = config_get_ptr();
    bool auto_backup                  = settings->bools.core_updater_auto_backup;
    unsigned auto_backup_history_size = settings->uints.core_updater_auto_backup_history_size;
+   unsigned download_max             = settings->uints.core_updater_download_max;
    const char *path_dir_libretro     = settings->paths.directory_libretro;
    const char *path_dir_core_assets  = settings->paths.directory_core_assets;
 
@@ -4933,7 +4955,7 @@ static int action_ok_update_installed_cores(const char *path,
 
    /* Push update task */
    task_push_update_installed_cores(
-         auto_backup, auto_backup_history_size,
+         auto_backup, auto_backup_history_size, download_max,
          path_dir_libretro, path_dir_core_assets);
 
    return 0;
@@ -5820,22 +5842,114 @@ static void netplay_lan_scan_callback(retro_task_t *task,
 }
 #endif
 
-static void netplay_refresh_rooms_cb(retro_task_t *task,
-      void *task_data, void *user_data, const char *err)
+static bool netplay_refresh_rooms_menu_active(void)
 {
-   char *new_data                = NULL;
    const char *path              = NULL;
    const char *label             = NULL;
    unsigned menu_type            = 0;
    enum msg_hash_enums enum_idx  = MSG_UNKNOWN;
 
-   http_transfer_data_t *data    = (http_transfer_data_t*)task_data;
-
    menu_entries_get_last_stack(&path, &label, &menu_type, &enum_idx, NULL);
 
+   return string_is_equal(label, msg_hash_to_str(MENU_ENUM_LABEL_NETPLAY_TAB))
+       || string_is_equal(label, msg_hash_to_str(MENU_ENUM_LABEL_NETPLAY));
+}
+
+static void netplay_refresh_rooms_parsed_cb(retro_task_t *task,
+      void *task_data, void *user_data, const char *err)
+{
+   unsigned i                           = 0;
+   unsigned j                           = 0;
+   struct netplay_host_list *lan_hosts  = NULL;
+   int lan_room_count                   = 0;
+   bool refresh                         = false;
+   netplay_rooms_parse_data_t *data     = (netplay_rooms_parse_data_t*)task_data;
+   struct netplay_room *rooms           = NULL;
+
+   /* Don't push the results if we left the netplay menu */
+   if (!data || !netplay_refresh_rooms_menu_active())
+      return;
+
+#ifdef HAVE_NETPLAYDISCOVERY
+   netplay_discovery_driver_ctl(RARCH_NETPLAY_DISCOVERY_CTL_LAN_GET_RESPONSES, &lan_hosts);
+   if (lan_hosts)
+      lan_room_count                    = (int)lan_hosts->size;
+#endif
+
+   /* Take the parsed rooms, with room for the LAN ones */
+   rooms = data->rooms;
+   if (lan_room_count != 0)
+      rooms = (struct netplay_room*)realloc(data->rooms,
+            (data->count + lan_room_count) * sizeof(*rooms));
+   if (!rooms)
+      return;
+   data->rooms = NULL;
+
+   if (netplay_room_list)
+      free(netplay_room_list);
+
+   /* TODO/FIXME - right now, a LAN and non-LAN netplay session might appear
+    * in the same list. If both entries are available, we want to show only
+    * the LAN one. */
+
+   netplay_room_count                   = data->count;
+   netplay_room_list                    = rooms;
+
+   if (lan_room_count != 0)
+   {
+      memset(&netplay_room_list[netplay_room_count], 0,
+            lan_room_count * sizeof(*netplay_room_list));
+
+      for (i = netplay_room_count; i < (unsigned)(netplay_room_count + lan_room_count); i++)
+      {
+         struct netplay_host *host = &lan_hosts->hosts[j++];
+
+         strlcpy(netplay_room_list[i].nickname,
+               host->nick,
+               sizeof(netplay_room_list[i].nickname));
+
+         strlcpy(netplay_room_list[i].address,
+               host->address,
+               INET6_ADDRSTRLEN);
+         strlcpy(netplay_room_list[i].corename,
+               host->core,
+               sizeof(netplay_room_list[i].corename));
+         strlcpy(netplay_room_list[i].retroarch_version,
+               host->retroarch_version,
+               sizeof(netplay_room_list[i].retroarch_version));
+         strlcpy(netplay_room_list[i].coreversion,
+               host->core_version,
+               sizeof(netplay_room_list[i].coreversion));
+         strlcpy(netplay_room_list[i].gamename,
+               host->content,
+               sizeof(netplay_room_list[i].gamename));
+         strlcpy(netplay_room_list[i].frontend,
+               host->frontend,
+               sizeof(netplay_room_list[i].frontend));
+         strlcpy(netplay_room_list[i].subsystem_name,
+               host->subsystem_name,
+               sizeof(netplay_room_list[i].subsystem_name));
+
+         netplay_room_list[i].port      = host->port;
+         netplay_room_list[i].gamecrc   = host->content_crc;
+         netplay_room_list[i].timestamp = 0;
+         netplay_room_list[i].lan       = true;
+      }
+      netplay_room_count += lan_room_count;
+   }
+
+   menu_entries_ctl(MENU_ENTRIES_CTL_SET_REFRESH, &refresh);
+   menu_driver_ctl(RARCH_MENU_CTL_SET_PREVENT_POPULATE, NULL);
+}
+
+static void netplay_refresh_rooms_cb(retro_task_t *task,
+      void *task_data, void *user_data, const char *err)
+{
+   char *new_data                = NULL;
+   http_transfer_data_t *data    = (http_transfer_data_t*)task_data;
+
    /* Don't push the results if we left the netplay menu */
-   if (!string_is_equal(label, msg_hash_to_str(MENU_ENUM_LABEL_NETPLAY_TAB))
-    && !string_is_equal(label, msg_hash_to_str(MENU_ENUM_LABEL_NETPLAY)))
+   if (!netplay_refresh_rooms_menu_active())
       return;
 
    if (!data || err)
@@ -5857,82 +5971,12 @@ static void netplay_refresh_rooms_cb(retro_task_t *task,
          netplay_room_count = 0;
       else
       {
-         char s[PATH_MAX_LENGTH];
-         unsigned i                           = 0;
-         unsigned j                           = 0;
-         struct netplay_host_list *lan_hosts  = NULL;
-         int lan_room_count                   = 0;
-         bool refresh                         = false;
-
-#ifdef HAVE_NETPLAYDISCOVERY
-         netplay_discovery_driver_ctl(RARCH_NETPLAY_DISCOVERY_CTL_LAN_GET_RESPONSES, &lan_hosts);
-         if (lan_hosts)
-            lan_room_count                    = (int)lan_hosts->size;
-#endif
-
-         netplay_rooms_parse(data->data);
-
-         if (netplay_room_list)
-            free(netplay_room_list);
-
-         /* TODO/FIXME - right now, a LAN and non-LAN netplay session might appear
-          * in the same list. If both entries are available, we want to show only
-          * the LAN one. */
-
-         netplay_room_count                   = netplay_rooms_get_count();
-         netplay_room_list                    = (struct netplay_room*)
-            calloc(netplay_room_count + lan_room_count,
-                  sizeof(struct netplay_room));
-
-         for (i = 0; i < (unsigned)netplay_room_count; i++)
-            memcpy(&netplay_room_list[i], netplay_room_get(i), sizeof(netplay_room_list[i]));
-
-         if (lan_room_count != 0)
-         {
-            for (i = netplay_room_count; i < (unsigned)(netplay_room_count + lan_room_count); i++)
-            {
-               struct netplay_host *host = &lan_hosts->hosts[j++];
-
-               strlcpy(netplay_room_list[i].nickname,
-                     host->nick,
-                     sizeof(netplay_room_list[i].nickname));
-
-               strlcpy(netplay_room_list[i].address,
-                     host->address,
-                     INET6_ADDRSTRLEN);
-               strlcpy(netplay_room_list[i].corename,
-                     host->core,
-                     sizeof(netplay_room_list[i].corename));
-               strlcpy(netplay_room_list[i].retroarch_version,
-                     host->retroarch_version,
-                     sizeof(netplay_room_list[i].retroarch_version));
-               strlcpy(netplay_room_list[i].coreversion,
-                     host->core_version,
-                     sizeof(netplay_room_list[i].coreversion));
-               strlcpy(netplay_room_list[i].gamename,
-                     host->content,
-                     sizeof(netplay_room_list[i].gamename));
-               strlcpy(netplay_room_list[i].frontend,
-                     host->frontend,
-                     sizeof(netplay_room_list[i].frontend));
-               strlcpy(netplay_room_list[i].subsystem_name,
-                     host->subsystem_name,
-                     sizeof(netplay_room_list[i].subsystem_name));
-
-               netplay_room_list[i].port      = host->port;
-               netplay_room_list[i].gamecrc   = host->content_crc;
-               netplay_room_list[i].timestamp = 0;
-               netplay_room_list[i].lan       = true;
-
-               snprintf(s, sizeof(s),
-                     msg_hash_to_str(MENU_ENUM_LABEL_VALUE_NETPLAY_ROOM_NICKNAME),
-                     netplay_room_list[i].nickname);
-            }
-            netplay_room_count += lan_room_count;
-         }
-
-         menu_entries_ctl(MENU_ENTRIES_CTL_SET_REFRESH, &refresh);
-         menu_driver_ctl(RARCH_MENU_CTL_SET_PREVENT_POPULATE, NULL);
+         /* Parsing a long room list takes a while, so
+          * leave it to a task - which takes the data */
+         task_push_netplay_rooms_parse(data->data,
+               netplay_refresh_rooms_parsed_cb);
+         data->data = NULL;
+         data->len  = 0;
       }
    }
 
@@ -7610,6 +7654,9 @@ static int menu_cbs_init_bind_ok_compare_label(menu_file_list_cbs_t *cbs,
          {MENU_ENUM_LABEL_LOAD_STATE,                          action_ok_load_state},
          {MENU_ENUM_LABEL_UNDO_LOAD_STATE,                     action_ok_undo_load_state},
          {MENU_ENUM_LABEL_UNDO_SAVE_STATE,                     action_ok_undo_save_state},
+#ifdef HAVE_BSV_MOVIE
+         {MENU_ENUM_LABEL_MOVIE_SEEK,                          action_ok_movie_seek},
+#endif
          {MENU_ENUM_LABEL_RESUME_CONTENT,                      action_ok_resume_content},
          {MENU_ENUM_LABEL_ADD_TO_FAVORITES_PLAYLIST,           action_ok_add_to_favorites_playlist},
          {MENU_ENUM_LABEL_SET_CORE_ASSOCIATION,                action_ok_set_core_association},
@@ -801,7 +801,7 @@ static int cpu_policy_mode_change(unsigned type, const char *label,
 {
    bool refresh = false;
    enum cpu_scaling_mode mode = get_cpu_scaling_mode(NULL);
-   if (mode != CPUSCALING_MANUAL)
+   if (mode != CPUSCALING_MANAGED_FRAME_TIME)
       mode++;
    set_cpu_scaling_mode(mode, NULL);
    menu_entries_ctl(MENU_ENTRIES_CTL_SET_REFRESH, &refresh);
@@ -117,7 +117,7 @@ static int action_start_video_filter_file_load(
 
       /* Unload video filter */
       settings->paths.path_softfilter_plugin[0] = '\0';
-      command_event(CMD_EVENT_REINIT, NULL);
+      command_event(CMD_EVENT_VIDEO_FILTER_REINIT, NULL);
 
       /* Refresh menu */
       menu_entries_ctl(MENU_ENTRIES_CTL_SET_REFRESH, &refresh);
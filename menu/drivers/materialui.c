@@ -1277,6 +1277,16 @@ typedef struct
  *   the scroll animation duration */
 #define MUI_THUMBNAIL_STREAM_DELAY_PLAYLIST_DESKTOP MUI_ANIM_DURATION_SCROLL
 
+/* Number of off-screen entries ahead of the scroll
+ * direction for which thumbnails are prefetched
+ * > The minimum is always prefetched while scrolling,
+ *   plus however many entries would scroll into view
+ *   within MUI_THUMBNAIL_PREFETCH_LOOKAHEAD ms at
+ *   the current speed */
+#define MUI_THUMBNAIL_PREFETCH_MIN 2
+#define MUI_THUMBNAIL_PREFETCH_MAX 16
+#define MUI_THUMBNAIL_PREFETCH_LOOKAHEAD 500.0f
+
 /* Defines the various types of supported menu
  * list views
  * - MUI_LIST_VIEW_DEFAULT is the standard for
@@ -1324,6 +1334,8 @@ typedef struct
    float x;
    float y;
    enum materialui_node_icon_type icon_type;
+   /* False while entry_height is only an estimate */
+   bool measured;
 } materialui_node_t;
 
 /* Defines all standard menu textures */
@@ -1636,6 +1648,12 @@ typedef struct materialui_handle
     *   its thumbnails while waiting for next
     *   to load after the selection has changed */
    size_t desktop_thumbnail_last_selection;
+   /* Furthest entry for which thumbnails were
+    * prefetched in the current scroll direction */
+   size_t thumbnail_prefetch_edge;
+   /* Number of entries whose height is still
+    * an estimate (see materialui_measure_entries()) */
+   size_t unmeasured_entries;
    unsigned last_width;
    unsigned last_height;
    unsigned sys_bar_height;
@@ -1675,6 +1693,8 @@ typedef struct materialui_handle
    /* Scrollbar parameters */
    materialui_scrollbar_t scrollbar;   /* int alignment */
    int cursor_size;
+   /* Width available to entry sublabels */
+   int entries_usable_width;
    /* Cached system bar data */
    materialui_sys_bar_cache_t sys_bar_cache; /* int alignment */
    float last_scale_factor;
@@ -1686,10 +1706,16 @@ typedef struct materialui_handle
    float transition_alpha;
    float transition_x_offset;
    float thumbnail_stream_delay;
+   /* Scroll position on the previous frame,
+    * used to determine scroll velocity */
+   float thumbnail_prefetch_scroll_y;
    float fullscreen_thumbnail_alpha;
    float touch_feedback_alpha;
    int16_t pointer_start_x;
    int16_t pointer_start_y;
+   /* Direction of the last scroll movement
+    * (-1: up, 1: down, 0: none) */
+   int8_t thumbnail_prefetch_direction;
 
    /* Colour theme parameters */
    enum materialui_color_theme color_theme;
@@ -2766,68 +2792,292 @@ static unsigned materialui_count_sublabel_lines(
    return materialui_count_lines(wrapped_sublabel_str);
 }
 
-/* Used for standard, non-playlist entries
- * > MUI_LIST_VIEW_DEFAULT */
-static void materialui_compute_entries_box_default(
+/* > Returns how many entries of the smallest possible
+ *   height fit into the list view. Entry heights are
+ *   measured this many entries around the selection */
+static size_t materialui_get_measure_margin(
+      materialui_handle_t* mui, unsigned height, unsigned header_height)
+{
+   float view_height = (float)height - (float)header_height -
+         (float)mui->nav_bar_layout_height - (float)mui->status_bar.height;
+   float min_height  = (float)mui->font_data.list.line_height +
+         (mui->dip_base_unit_size / 5.0f);
+
+   if ((view_height < 1.0f) || (min_height < 1.0f))
+      return 1;
+
+   return (size_t)(view_height / min_height) + 1;
+}
+
+/* > Sets the height of entry 'entry_idx' from its
+ *   wrapped sublabel
+ *   > MUI_LIST_VIEW_DEFAULT */
+static void materialui_measure_entry_default(
+      materialui_handle_t* mui, materialui_node_t *node,
+      size_t entry_idx)
+{
+   unsigned num_sublabel_lines = 0;
+   bool has_icon               = false;
+
+   switch (node->icon_type)
+   {
+      case MUI_ICON_TYPE_INTERNAL:
+         has_icon = mui->textures.list[node->icon_texture_index] != 0;
+         break;
+      case MUI_ICON_TYPE_MENU_EXPLORE:
+         has_icon = true;
+         break;
+      case MUI_ICON_TYPE_PLAYLIST:
+         has_icon = materialui_get_playlist_icon(
+               mui, node->icon_texture_index) != 0;
+         break;
+      default:
+         break;
+   }
+
+   num_sublabel_lines = materialui_count_sublabel_lines(
+         mui, mui->entries_usable_width, entry_idx, has_icon);
+
+   node->text_height  = mui->font_data.list.line_height +
+         (num_sublabel_lines * mui->font_data.hint.line_height);
+
+   node->entry_height = node->text_height +
+         mui->dip_base_unit_size / 10;
+
+   node->entry_height += mui->dip_base_unit_size / 10;
+   node->measured      = true;
+}
+
+/* > Sets the height of entry 'entry_idx' from its
+ *   wrapped sublabel and the thumbnail size
+ *   > MUI_LIST_VIEW_PLAYLIST
+ *   > MUI_LIST_VIEW_PLAYLIST_THUMB_LIST_SMALL
+ *   > MUI_LIST_VIEW_PLAYLIST_THUMB_LIST_MEDIUM
+ *   > MUI_LIST_VIEW_PLAYLIST_THUMB_LIST_LARGE */
+static void materialui_measure_entry_playlist_list(
+      materialui_handle_t* mui, materialui_node_t *node,
+      size_t entry_idx)
+{
+   unsigned num_sublabel_lines = materialui_count_sublabel_lines(
+         mui, mui->entries_usable_width, entry_idx, false);
+
+   node->text_height  = mui->font_data.list.line_height +
+         (num_sublabel_lines * mui->font_data.hint.line_height);
+
+   node->entry_height = node->text_height +
+         mui->dip_base_unit_size / 10;
+
+   /* If thumbnails are enabled, must ensure
+    * that line_height is greater than maximum
+    * thumbnail height */
+   if (mui->list_view_type != MUI_LIST_VIEW_PLAYLIST)
+      node->entry_height = (node->entry_height < mui->thumbnail_height_max) ?
+            mui->thumbnail_height_max : node->entry_height;
+
+   node->entry_height += mui->dip_base_unit_size / 10;
+   node->measured      = true;
+}
+
+/* Measures a single entry of the current list view
+ * > NULL when all entries have the same height */
+static void (*materialui_measure_entry)(
+      materialui_handle_t* mui, materialui_node_t *node,
+      size_t entry_idx) = materialui_measure_entry_default;
+
+/* > Measures the entries from 'first' to 'last' that
+ *   only have an estimated height, and moves the ones
+ *   below them to match. Height gained or lost above
+ *   the top of the list view is added to the scroll
+ *   position, so that what is on screen stays put.
+ *   Returns true if any entry changed */
+static bool materialui_measure_entries(
+      materialui_handle_t* mui, file_list_t *list,
+      size_t first, size_t last)
+{
+   size_t i;
+   float sum          = 0.0f;
+   float scroll_shift = 0.0f;
+   bool changed       = false;
+   size_t entries_end = menu_entries_get_size();
+
+   if (     !mui->unmeasured_entries
+         || !materialui_measure_entry
+         || !list
+         || (entries_end < 1)
+         || !mui->font_data.list.font
+         || !mui->font_data.hint.font)
+      return false;
+
+   if (last >= entries_end)
+      last = entries_end - 1;
+
+   for (i = first; i <= last; i++)
+   {
+      materialui_node_t *node = (materialui_node_t*)list->list[i].userdata;
+      float estimate;
+
+      if (!node || node->measured)
+         continue;
+
+      estimate = node->entry_height;
+      materialui_measure_entry(mui, node, i);
+      mui->unmeasured_entries--;
+
+      if (node->y + estimate <= mui->scroll_y)
+         scroll_shift += node->entry_height - estimate;
+
+      changed = true;
+   }
+
+   if (!changed)
+      return false;
+
+   for (i = 0; i < entries_end; i++)
+   {
+      materialui_node_t *node = (materialui_node_t*)list->list[i].userdata;
+
+      if (!node)
+         continue;
+
+      node->y  = sum;
+      sum     += node->entry_height;
+   }
+
+   mui->content_height  = sum;
+   mui->scroll_y       += scroll_shift;
+
+   return true;
+}
+
+/* > Measures the entries that are about to come
+ *   into view, i.e. those within half a list view
+ *   height of the visible ones */
+static void materialui_refine_entries_box(
       materialui_handle_t* mui,
       unsigned width, unsigned height, unsigned header_height)
 {
    size_t i;
-   file_list_t *list      = menu_entries_get_selection_buf_ptr(0);
-   float node_entry_width = (float)width -
-         (float)(mui->landscape_optimization.border_width * 2) -
-         (float)mui->nav_bar_layout_width;
-   float node_x           = (float)mui->landscape_optimization.border_width;
-   int usable_width       = node_entry_width -
-         (int)(mui->margin * 2) -
-         (int)(mui->landscape_optimization.entry_margin * 2);
-   float sum              = 0;
-   size_t entries_end     = menu_entries_get_size();
+   file_list_t *list  = menu_entries_get_selection_buf_ptr(0);
+   size_t entries_end = menu_entries_get_size();
+   size_t first       = 0;
+   size_t last        = 0;
+   bool first_found   = false;
+   float view_height  = (float)height - (float)header_height -
+         (float)mui->nav_bar_layout_height - (float)mui->status_bar.height;
+   float view_top     = mui->scroll_y - (view_height / 2.0f);
+   float view_bottom  = mui->scroll_y + view_height + (view_height / 2.0f);
+
+   if (!mui->unmeasured_entries || !list)
+      return;
+
+   for (i = 0; i < entries_end; i++)
+   {
+      materialui_node_t *node = (materialui_node_t*)list->list[i].userdata;
+
+      if (!node)
+         continue;
+
+      if (node->y >= view_bottom)
+         break;
+
+      if (!first_found && (node->y + node->entry_height > view_top))
+      {
+         first       = i;
+         first_found = true;
+      }
+
+      last = i;
+   }
+
+   if (!first_found)
+      return;
+
+   if (materialui_measure_entries(mui, list, first, last))
+      materialui_scrollbar_init(mui, width, height, header_height);
+}
+
+/* > Places the entries of the list views that wrap
+ *   sublabels. Measuring every sublabel is slow for
+ *   large lists, so only the entries around the
+ *   selection are measured here. All others get the
+ *   average height of those until they come close
+ *   to the list view */
+static void materialui_compute_entries_box_lazy(
+      materialui_handle_t* mui,
+      unsigned width, unsigned height, unsigned header_height,
+      float node_entry_width, float node_x)
+{
+   size_t i;
+   file_list_t *list            = menu_entries_get_selection_buf_ptr(0);
+   size_t entries_end           = menu_entries_get_size();
+   size_t selection             = menu_navigation_get_selection();
+   size_t margin                = materialui_get_measure_margin(
+         mui, height, header_height);
+   size_t first                 = 0;
+   size_t last                  = 0;
+   size_t num_measured          = 0;
+   float text_height_estimate   = (float)mui->font_data.list.line_height;
+   float entry_height_estimate  = text_height_estimate +
+         (mui->dip_base_unit_size / 5.0f);
+   float text_height_sum        = 0.0f;
+   float entry_height_sum       = 0.0f;
+   float sum                    = 0.0f;
 
    if (!list)
       return;
 
+   if (selection >= entries_end)
+      selection = (entries_end > 0) ? entries_end - 1 : 0;
+
+   first                   = (selection > margin) ? selection - margin : 0;
+   last                    = selection + margin;
+   mui->unmeasured_entries = 0;
+
    for (i = 0; i < entries_end; i++)
    {
-      unsigned num_sublabel_lines = 0;
-      materialui_node_t *node     = (materialui_node_t*)list->list[i].userdata;
-      bool has_icon               = false;
+      materialui_node_t *node = (materialui_node_t*)list->list[i].userdata;
 
       if (!node)
          continue;
 
-      switch (node->icon_type)
+      node->entry_width = node_entry_width;
+      node->x           = node_x;
+
+      if ((i >= first) && (i <= last))
       {
-         case MUI_ICON_TYPE_INTERNAL:
-            has_icon = mui->textures.list[node->icon_texture_index] != 0;
-            break;
-         case MUI_ICON_TYPE_MENU_EXPLORE:
-            has_icon = true;
-            break;
-         case MUI_ICON_TYPE_PLAYLIST:
-            has_icon = materialui_get_playlist_icon(
-                  mui, node->icon_texture_index) != 0;
-            break;
-         default:
-            break;
+         materialui_measure_entry(mui, node, i);
+         text_height_sum  += node->text_height;
+         entry_height_sum += node->entry_height;
+         num_measured++;
       }
+      else
+      {
+         node->measured = false;
+         mui->unmeasured_entries++;
+      }
+   }
 
-      num_sublabel_lines = materialui_count_sublabel_lines(
-            mui, usable_width, i, has_icon);
-
-      node->text_height  = mui->font_data.list.line_height +
-            (num_sublabel_lines * mui->font_data.hint.line_height);
+   if (num_measured > 0)
+   {
+      text_height_estimate  = text_height_sum  / (float)num_measured;
+      entry_height_estimate = entry_height_sum / (float)num_measured;
+   }
 
-      node->entry_height = node->text_height +
-            mui->dip_base_unit_size / 10;
+   for (i = 0; i < entries_end; i++)
+   {
+      materialui_node_t *node = (materialui_node_t*)list->list[i].userdata;
 
-      node->entry_height      += mui->dip_base_unit_size / 10;
-      node->y                  = sum;
+      if (!node)
+         continue;
 
-      node->entry_width        = node_entry_width;
-      node->x                  = node_x;
+      if (!node->measured)
+      {
+         node->text_height  = text_height_estimate;
+         node->entry_height = entry_height_estimate;
+      }
 
-      sum                     += node->entry_height;
+      node->y  = sum;
+      sum     += node->entry_height;
    }
 
    mui->content_height = sum;
@@ -2836,6 +3086,25 @@ static void materialui_compute_entries_box_default(
    materialui_scrollbar_init(mui, width, height, header_height);
 }
 
+/* Used for standard, non-playlist entries
+ * > MUI_LIST_VIEW_DEFAULT */
+static void materialui_compute_entries_box_default(
+      materialui_handle_t* mui,
+      unsigned width, unsigned height, unsigned header_height)
+{
+   float node_entry_width    = (float)width -
+         (float)(mui->landscape_optimization.border_width * 2) -
+         (float)mui->nav_bar_layout_width;
+   float node_x              = (float)mui->landscape_optimization.border_width;
+
+   mui->entries_usable_width = node_entry_width -
+         (int)(mui->margin * 2) -
+         (int)(mui->landscape_optimization.entry_margin * 2);
+
+   materialui_compute_entries_box_lazy(mui, width, height, header_height,
+         node_entry_width, node_x);
+}
+
 /* Used for playlist 'list view' (with and without
  * thumbnails) entries
  * > MUI_LIST_VIEW_PLAYLIST
@@ -2846,18 +3115,11 @@ static void materialui_compute_entries_box_playlist_list(
       materialui_handle_t* mui,
       unsigned width, unsigned height, unsigned header_height)
 {
-   size_t i;
-   file_list_t *list      = menu_entries_get_selection_buf_ptr(0);
    float node_entry_width = (float)width -
          (float)(mui->landscape_optimization.border_width * 2) -
          (float)mui->nav_bar_layout_width;
    float node_x           = (float)mui->landscape_optimization.border_width;
    int usable_width       = node_entry_width - (int)(mui->margin * 2);
-   float sum              = 0;
-   size_t entries_end     = menu_entries_get_size();
-
-   if (!list)
-      return;
 
    /* If thumbnails are *not* enabled, decrease usable
     * width by landscape optimisation entry margin */
@@ -2886,43 +3148,10 @@ static void materialui_compute_entries_box_playlist_list(
          usable_width -= mui->thumbnail_width_max + thumbnail_margin;
    }
 
-   for (i = 0; i < entries_end; i++)
-   {
-      unsigned num_sublabel_lines = 0;
-      materialui_node_t *node     = (materialui_node_t*)list->list[i].userdata;
-
-      if (!node)
-         continue;
-
-      num_sublabel_lines = materialui_count_sublabel_lines(
-            mui, usable_width, i, false);
-
-      node->text_height  = mui->font_data.list.line_height +
-            (num_sublabel_lines * mui->font_data.hint.line_height);
-
-      node->entry_height = node->text_height +
-            mui->dip_base_unit_size / 10;
+   mui->entries_usable_width = usable_width;
 
-      /* If thumbnails are enabled, must ensure
-       * that line_height is greater than maximum
-       * thumbnail height */
-      if (mui->list_view_type != MUI_LIST_VIEW_PLAYLIST)
-         node->entry_height = (node->entry_height < mui->thumbnail_height_max) ?
-               mui->thumbnail_height_max : node->entry_height;
-
-      node->entry_height      += mui->dip_base_unit_size / 10;
-      node->y                  = sum;
-
-      node->entry_width        = node_entry_width;
-      node->x                  = node_x;
-
-      sum                     += node->entry_height;
-   }
-
-   mui->content_height = sum;
-
-   /* Total height is now known - can initialise scrollbar */
-   materialui_scrollbar_init(mui, width, height, header_height);
+   materialui_compute_entries_box_lazy(mui, width, height, header_height,
+         node_entry_width, node_x);
 }
 
 /* Used for playlist 'dual icon' entries
@@ -2962,10 +3191,12 @@ static void materialui_compute_entries_box_playlist_dual_icon(
       node->entry_height = node_entry_height;
       node->x            = node_x;
       node->y            = sum;
+      node->measured     = true;
       sum               += node_entry_height;
    }
 
-   mui->content_height = sum;
+   mui->content_height     = sum;
+   mui->unmeasured_entries = 0;
 
    /* Total height is now known - can initialise scrollbar */
    materialui_scrollbar_init(mui, width, height, header_height);
@@ -3028,10 +3259,12 @@ static void materialui_compute_entries_box_playlist_desktop(
       node->entry_height = node_entry_height;
       node->x            = node_x;
       node->y            = sum;
+      node->measured     = true;
       sum               += node_entry_height;
    }
 
-   mui->content_height = sum;
+   mui->content_height     = sum;
+   mui->unmeasured_entries = 0;
 
    /* Total height is now known - can initialise scrollbar */
    materialui_scrollbar_init(mui, width, height, header_height);
@@ -3057,6 +3290,7 @@ static float materialui_get_scroll(materialui_handle_t *mui,
    unsigned height         = 0;
    float view_centre       = 0.0f;
    float selection_centre  = 0.0f;
+   size_t margin;
    size_t i;
 
    if (!mui || !list)
@@ -3065,6 +3299,14 @@ static float materialui_get_scroll(materialui_handle_t *mui,
    /* Get current window size */
    video_driver_get_size(&width, &height);
 
+   /* Entries around the selection need their
+    * actual height to centre it properly */
+   margin = materialui_get_measure_margin(mui, height, header_height);
+   if (materialui_measure_entries(mui, list,
+            (selection > margin) ? selection - margin : 0,
+            selection + margin))
+      materialui_scrollbar_init(mui, width, height, header_height);
+
    /* Get the vertical midpoint of the actual
     * list view - i.e. account for header +
     * navigation bar */
@@ -3506,6 +3748,98 @@ static void materialui_layout(
  * - Determine index of first/last on-screen entries
  * - Handle dynamic pointer input
  * - Handle streaming thumbnails */
+/* Prefetches thumbnails for the entries about to
+ * scroll into view, based on scroll direction and
+ * speed. Prefetches for the opposite direction are
+ * cancelled whenever the user turns around */
+static void materialui_prefetch_thumbnails(
+      materialui_handle_t *mui, file_list_t *list,
+      size_t entries_end, unsigned thumbnail_upscale_threshold)
+{
+   size_t i;
+   float speed;
+   unsigned ahead;
+   int8_t direction;
+   materialui_node_t *node = NULL;
+   gfx_animation_t *p_anim = anim_get_ptr();
+   float delta             = mui->scroll_y - mui->thumbnail_prefetch_scroll_y;
+   bool secondary          = mui->secondary_thumbnail_enabled ||
+         (mui->list_view_type == MUI_LIST_VIEW_PLAYLIST_THUMB_DUAL_ICON);
+
+   mui->thumbnail_prefetch_scroll_y = mui->scroll_y;
+
+   if (delta == 0.0f || p_anim->delta_time <= 0.0f)
+      return;
+
+   direction = (delta > 0.0f) ? 1 : -1;
+
+   if (direction != mui->thumbnail_prefetch_direction)
+   {
+      if (mui->thumbnail_prefetch_direction != 0)
+         gfx_thumbnail_cancel_prefetch();
+      mui->thumbnail_prefetch_direction = direction;
+      mui->thumbnail_prefetch_edge      = (direction > 0) ? 0 : (size_t)-1;
+   }
+
+   if (mui->first_onscreen_entry >= entries_end)
+      return;
+
+   node = (materialui_node_t*)
+         list->list[mui->first_onscreen_entry].userdata;
+
+   if (!node || node->entry_height <= 0.0f)
+      return;
+
+   /* Entries per ms */
+   speed = ((delta > 0.0f) ? delta : -delta) /
+         (node->entry_height * p_anim->delta_time);
+   ahead = MUI_THUMBNAIL_PREFETCH_MIN +
+         (unsigned)(speed * MUI_THUMBNAIL_PREFETCH_LOOKAHEAD);
+
+   if (ahead > MUI_THUMBNAIL_PREFETCH_MAX)
+      ahead = MUI_THUMBNAIL_PREFETCH_MAX;
+
+   for (i = 1; i <= ahead; i++)
+   {
+      size_t idx;
+
+      if (direction > 0)
+      {
+         idx = mui->last_onscreen_entry + i;
+         if (idx >= entries_end)
+            break;
+         /* Already prefetched */
+         if (idx <= mui->thumbnail_prefetch_edge)
+            continue;
+      }
+      else
+      {
+         if (mui->first_onscreen_entry < i)
+            break;
+         idx = mui->first_onscreen_entry - i;
+         if (idx >= mui->thumbnail_prefetch_edge)
+            continue;
+      }
+
+      /* Try again next frame if too many
+       * prefetches are already in flight */
+      if (!gfx_thumbnail_prefetch(mui->thumbnail_path_data,
+               GFX_THUMBNAIL_RIGHT, mui->playlist,
+               list->list[idx].entry_idx,
+               thumbnail_upscale_threshold))
+         break;
+
+      if (secondary)
+         if (!gfx_thumbnail_prefetch(mui->thumbnail_path_data,
+                  GFX_THUMBNAIL_LEFT, mui->playlist,
+                  list->list[idx].entry_idx,
+                  thumbnail_upscale_threshold))
+            break;
+
+      mui->thumbnail_prefetch_edge = idx;
+   }
+}
+
 static void materialui_render(void *data,
       unsigned width, unsigned height,
       bool is_idle)
@@ -3600,6 +3934,10 @@ static void materialui_render(void *data,
       /* Get new scroll position */
       mui->scroll_y     = materialui_get_scroll(mui, p_disp);
       mui->need_compute = false;
+
+      /* List has changed - restart thumbnail prefetching */
+      mui->thumbnail_prefetch_scroll_y  = mui->scroll_y;
+      mui->thumbnail_prefetch_direction = 0;
    }
 
    /* Need to update this each frame, otherwise touchscreen
@@ -3660,6 +3998,10 @@ static void materialui_render(void *data,
          mui->scroll_y -= mui->pointer.y_accel;
    }
 
+   /* Measure entries that are coming into view
+    * before the scroll position gets clamped */
+   materialui_refine_entries_box(mui, width, height, header_height);
+
    if (mui->scroll_y < 0.0f)
       mui->scroll_y = 0.0f;
 
@@ -3781,6 +4123,22 @@ static void materialui_render(void *data,
          break;
    }
 
+   /* Thumbnail list views stream thumbnails as entries
+    * scroll into view - load the next ones in advance */
+   switch (mui->list_view_type)
+   {
+      case MUI_LIST_VIEW_PLAYLIST_THUMB_LIST_SMALL:
+      case MUI_LIST_VIEW_PLAYLIST_THUMB_LIST_MEDIUM:
+      case MUI_LIST_VIEW_PLAYLIST_THUMB_LIST_LARGE:
+      case MUI_LIST_VIEW_PLAYLIST_THUMB_DUAL_ICON:
+         if (mui->playlist)
+            materialui_prefetch_thumbnails(mui, list, entries_end,
+                  thumbnail_upscale_threshold);
+         break;
+      default:
+         break;
+   }
+
    menu_entries_ctl(MENU_ENTRIES_CTL_SET_START, &mui->first_onscreen_entry);
 }
 
@@ -5472,6 +5830,7 @@ static void materialui_render_header(
    /* Draw background quads
     * > Title bar is underneath system bar
     * > Shadow is underneath title bar */
+   gfx_display_batch_begin(p_disp);
 
    /* > Shadow */
    gfx_display_draw_quad(
@@ -5515,6 +5874,8 @@ static void materialui_render_header(
          video_height,
          mui->colors.sys_bar_background);
 
+   gfx_display_batch_end(p_disp);
+
    /* System bar items */
 
    /* > Draw battery indicator (if required) */
@@ -7094,6 +7455,7 @@ static void materialui_set_list_view_type(
    {
       case MUI_LIST_VIEW_PLAYLIST:
          materialui_compute_entries_box       = materialui_compute_entries_box_playlist_list;
+         materialui_measure_entry             = materialui_measure_entry_playlist_list;
          materialui_render_process_entry      = materialui_render_process_entry_default;
          materialui_render_menu_entry         = materialui_render_menu_entry_playlist_list;
          materialui_render_selected_entry_aux = NULL;
@@ -7102,18 +7464,21 @@ static void materialui_set_list_view_type(
       case MUI_LIST_VIEW_PLAYLIST_THUMB_LIST_MEDIUM:
       case MUI_LIST_VIEW_PLAYLIST_THUMB_LIST_LARGE:
          materialui_compute_entries_box       = materialui_compute_entries_box_playlist_list;
+         materialui_measure_entry             = materialui_measure_entry_playlist_list;
          materialui_render_process_entry      = materialui_render_process_entry_playlist_thumb_list;
          materialui_render_menu_entry         = materialui_render_menu_entry_playlist_list;
          materialui_render_selected_entry_aux = NULL;
          break;
       case MUI_LIST_VIEW_PLAYLIST_THUMB_DUAL_ICON:
          materialui_compute_entries_box       = materialui_compute_entries_box_playlist_dual_icon;
+         materialui_measure_entry             = NULL;
          materialui_render_process_entry      = materialui_render_process_entry_playlist_dual_icon;
          materialui_render_menu_entry         = materialui_render_menu_entry_playlist_dual_icon;
          materialui_render_selected_entry_aux = NULL;
          break;
       case MUI_LIST_VIEW_PLAYLIST_THUMB_DESKTOP:
          materialui_compute_entries_box       = materialui_compute_entries_box_playlist_desktop;
+         materialui_measure_entry             = NULL;
          materialui_render_process_entry      = materialui_render_process_entry_playlist_desktop;
          materialui_render_menu_entry         = materialui_render_menu_entry_playlist_desktop;
          materialui_render_selected_entry_aux = materialui_render_selected_entry_aux_playlist_desktop;
@@ -7121,6 +7486,7 @@ static void materialui_set_list_view_type(
       case MUI_LIST_VIEW_DEFAULT:
       default:
          materialui_compute_entries_box       = materialui_compute_entries_box_default;
+         materialui_measure_entry             = materialui_measure_entry_default;
          materialui_render_process_entry      = materialui_render_process_entry_default;
          materialui_render_menu_entry         = materialui_render_menu_entry_default;
          materialui_render_selected_entry_aux = NULL;
@@ -8018,7 +8384,8 @@ static bool materialui_load_image(void *userdata, void *data, enum menu_image_ty
    {
       materialui_context_bg_destroy(mui);
       video_driver_texture_load(data,
-            TEXTURE_FILTER_MIPMAP_LINEAR, &mui->textures.bg);
+            video_driver_gpu_mem_filter(TEXTURE_FILTER_MIPMAP_LINEAR),
+            &mui->textures.bg);
       if (gfx_display_white_texture)
          video_driver_texture_unload(&gfx_display_white_texture);
       gfx_display_init_white_texture(gfx_display_white_texture);
@@ -8477,9 +8844,7 @@ static void materialui_context_reset(void *data, bool is_threaded)
    menu_screensaver_context_destroy(mui->screensaver);
 
    if (path_is_valid(path_menu_wallpaper))
-      task_push_image_load(path_menu_wallpaper,
-            video_driver_supports_rgba(), 0,
-            menu_display_handle_wallpaper_upload, NULL);
+      menu_display_load_wallpaper(path_menu_wallpaper);
 
    video_driver_monitor_reset();
 }
@@ -9897,6 +10262,7 @@ static void materialui_list_insert(
       node->text_height                      = 0.0f;
       node->x                                = 0.0f;
       node->y                                = 0.0f;
+      node->measured                         = false;
 
       node->thumbnails.primary.status        = GFX_THUMBNAIL_STATUS_UNKNOWN;
       node->thumbnails.primary.texture       = 0;
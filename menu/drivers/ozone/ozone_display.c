@@ -168,6 +168,8 @@ static void ozone_draw_cursor_fallback(
       last_alpha = alpha;
    }
 
+   gfx_display_batch_begin(p_disp);
+
    /* Fill */
    gfx_display_draw_quad(
          p_disp,
@@ -239,6 +241,8 @@ static void ozone_draw_cursor_fallback(
          video_width,
          video_height,
          ozone->theme_dynamic.selection_border);
+
+   gfx_display_batch_end(p_disp);
 }
 
 
@@ -34,6 +34,7 @@
 
 #include <retro_inline.h>
 #include <gfx/scaler/scaler.h>
+#include <features/features_cpu.h>
 
 #ifdef HAVE_CONFIG_H
 #include "../../config.h"
@@ -1728,7 +1729,7 @@ static void rgui_fill_rect(
    uint16_t scanline_even[RGUI_MAX_FB_WIDTH]; /* Initial values don't matter here */
    uint16_t scanline_odd[RGUI_MAX_FB_WIDTH];
 
-   /* Note: unlike rgui_color_rect() and rgui_draw_particle(),
+   /* Note: unlike rgui_draw_particle(),
     * this function is frequently used to fill large areas.
     * We therefore gain significant performance benefits
     * from using memcpy() tricks... */
@@ -1868,11 +1869,18 @@ static void rgui_color_rect(
    x_end = x_end <= fb_width  ? x_end : fb_width;
    y_end = y_end <= fb_height ? y_end : fb_height;
 
-   for (y_index = y_start; y_index < y_end; y_index++)
+   if (x_end <= x_start || y_end <= y_start)
+      return;
+
+   /* Fill the first row, then copy it to the others */
    {
-      uint16_t *data_ptr = data + (y_index * fb_width);
+      uint16_t *src = data + (y_start * fb_width);
       for (x_index = x_start; x_index < x_end; x_index++)
-         *(data_ptr + x_index) = color;
+         *(src + x_index) = color;
+
+      for (y_index = y_start + 1; y_index < y_end; y_index++)
+         memcpy(data + (y_index * fb_width) + x_start, src + x_start,
+               (x_end - x_start) * sizeof(uint16_t));
    }
 }
 
@@ -2508,6 +2516,7 @@ static bool downscale_thumbnail(rgui_t *rgui,
 
       rgui->image_scaler.scaler_type = (thumbnail_downscaler == RGUI_THUMB_SCALE_SINC) ?
          SCALER_TYPE_SINC : SCALER_TYPE_BILINEAR;
+      rgui->image_scaler.threads     = cpu_features_get_core_amount();
 
       /* This reset is redundant, since scaler_ctx_gen_filter()
        * calls it - but do it anyway in case the
@@ -2683,14 +2692,8 @@ static void rgui_render_background(rgui_t *rgui,
 
    /* If screensaver is active, 'zero out' framebuffer */
    if (rgui->show_screensaver)
-   {
-      size_t i;
-      uint16_t ss_bg_color    = rgui->colors.ss_bg_color;
-      uint16_t *frame_buf_ptr = frame_buf->data;
-
-      for (i = 0; i < frame_buf->width * frame_buf->height; i++)
-         *(frame_buf_ptr++) = ss_bg_color;
-   }
+      rgui_color_rect(frame_buf->data, fb_width, fb_height,
+            0, 0, fb_width, fb_height, rgui->colors.ss_bg_color);
    /* Otherwise copy background to framebuffer */
    else if (background_buf->data)
       memcpy(frame_buf->data, background_buf->data,
@@ -6047,11 +6050,22 @@ static void rgui_set_texture(void *data)
 
          for (y_dst = 0; y_dst < out_height; y_dst++)
          {
+            uint16_t *dst = upscale_buf->data + (y_dst * out_width);
+
             y_src = (y_dst * y_ratio) >> 16;
+
+            /* Rows scaled from the same source row are
+             * identical - just copy the previous one */
+            if ((y_dst > 0) && (((y_dst - 1) * y_ratio) >> 16) == y_src)
+            {
+               memcpy(dst, dst - out_width, out_width * sizeof(uint16_t));
+               continue;
+            }
+
             for (x_dst = 0; x_dst < out_width; x_dst++)
             {
                x_src = (x_dst * x_ratio) >> 16;
-               upscale_buf->data[(y_dst * out_width) + x_dst] = frame_buf->data[(y_src * fb_width) + x_src];
+               dst[x_dst] = frame_buf->data[(y_src * fb_width) + x_src];
             }
          }
          
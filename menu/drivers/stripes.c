@@ -1465,9 +1465,7 @@ static void stripes_list_switch_new(stripes_handle_t *stripes,
        {
            if (path_is_valid(path))
            {
-              task_push_image_load(path,
-                    video_driver_supports_rgba(), 0,
-                  menu_display_handle_wallpaper_upload, NULL);
+              menu_display_load_wallpaper(path);
               if (!string_is_empty(stripes->bg_file_path))
                  free(stripes->bg_file_path);
               stripes->bg_file_path = strdup(path);
@@ -3456,7 +3454,7 @@ static bool stripes_load_image(void *userdata, void *data, enum menu_image_type
          stripes_context_bg_destroy(stripes);
          video_driver_texture_unload(&stripes->textures.bg);
          video_driver_texture_load(data,
-               TEXTURE_FILTER_MIPMAP_LINEAR,
+               video_driver_gpu_mem_filter(TEXTURE_FILTER_MIPMAP_LINEAR),
                &stripes->textures.bg);
          if (gfx_display_white_texture)
             video_driver_texture_unload(&gfx_display_white_texture);
@@ -3694,9 +3692,7 @@ static void stripes_context_reset_background(const char *iconpath)
       fill_pathname_join(path, iconpath, "bg.png", sizeof(path));
 
    if (path_is_valid(path))
-      task_push_image_load(path,
-            video_driver_supports_rgba(), 0,
-            menu_display_handle_wallpaper_upload, NULL);
+      menu_display_load_wallpaper(path);
 }
 
 static void stripes_context_reset(void *data, bool is_threaded)
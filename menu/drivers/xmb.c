@@ -1121,9 +1121,7 @@ static void xmb_update_dynamic_wallpaper(xmb_handle_t *xmb)
    {
       if (path_is_valid(path))
       {
-         task_push_image_load(path,
-               video_driver_supports_rgba(), 0,
-               menu_display_handle_wallpaper_upload, NULL);
+         menu_display_load_wallpaper(path);
          if (!string_is_empty(xmb->bg_file_path))
             free(xmb->bg_file_path);
          xmb->bg_file_path = strdup(path);
@@ -1191,8 +1189,8 @@ static void xmb_update_savestate_thumbnail_path(void *data, unsigned i)
                   strlcpy(path, global->name.savestate, sizeof(path));
             }
 
-            strlcat(path, FILE_PATH_PNG_EXTENSION, sizeof(path));
-
+            /* The thumbnail is read from the state itself,
+             * or from the screenshot saved next to it */
             if (path_is_valid(path))
                strlcpy(
                      xmb->savestate_thumbnail_file_path, path,
@@ -1459,7 +1457,7 @@ static void xmb_update_savestate_thumbnail_image(void *data)
        * > Thumbnail path has changed */
       if ((xmb->thumbnails.savestate.status == GFX_THUMBNAIL_STATUS_UNKNOWN) ||
           !string_is_equal(xmb->savestate_thumbnail_file_path, xmb->prev_savestate_thumbnail_file_path))
-         gfx_thumbnail_request_file(
+         gfx_thumbnail_request_savestate(
                xmb->savestate_thumbnail_file_path,
                &xmb->thumbnails.savestate,
                thumbnail_upscale_threshold);
@@ -5940,7 +5938,7 @@ static bool xmb_load_image(void *userdata, void *data,
          if (gfx_display_white_texture)
             video_driver_texture_unload(&gfx_display_white_texture);
          video_driver_texture_load(data,
-               TEXTURE_FILTER_MIPMAP_LINEAR,
+               video_driver_gpu_mem_filter(TEXTURE_FILTER_MIPMAP_LINEAR),
                &xmb->textures.bg);
          gfx_display_init_white_texture(gfx_display_white_texture);
          break;
@@ -6361,16 +6359,12 @@ static void xmb_context_reset_background(xmb_handle_t *xmb, const char *iconpath
 
    if (!string_is_empty(path) && path_is_valid(path))
    {
-      task_push_image_load(path,
-            video_driver_supports_rgba(), 0,
-            menu_display_handle_wallpaper_upload, NULL);
+      menu_display_load_wallpaper(path);
    }
    else if (!string_is_empty(path_menu_wp))
    {
       if (path_is_valid(path_menu_wp))
-         task_push_image_load(path_menu_wp,
-               video_driver_supports_rgba(), 0,
-               menu_display_handle_wallpaper_upload, NULL);
+         menu_display_load_wallpaper(path_menu_wp);
    }
    else if (!string_is_empty(iconpath))
    {
@@ -6378,9 +6372,7 @@ static void xmb_context_reset_background(xmb_handle_t *xmb, const char *iconpath
             FILE_PATH_BACKGROUND_IMAGE, sizeof(path));
 
       if (path_is_valid(path))
-         task_push_image_load(path,
-               video_driver_supports_rgba(), 0,
-               menu_display_handle_wallpaper_upload, NULL);
+         menu_display_load_wallpaper(path);
    }
 
 #ifdef ORBIS
@@ -287,6 +287,9 @@ static void filebrowser_parse(
 
    if (list_size > 0)
    {
+      /* Preallocate the file list */
+      file_list_reserve(info->list, info->list->size + list_size);
+
       for (i = 0; i < list_size; i++)
       {
          enum msg_hash_enums enum_idx      = MSG_UNKNOWN;
@@ -1797,6 +1800,7 @@ static int menu_displaylist_parse_playlist(menu_displaylist_info_t *info,
    bool show_inline_core_name        = false;
    const char *menu_driver           = menu_driver_ident();
    menu_serch_terms_t *search_terms  = menu_entries_search_get_terms();
+   uint64_t search_signature         = 0;
    unsigned pl_show_inline_core_name = settings->uints.playlist_show_inline_core_name;
    bool pl_show_sublabels            = settings->bools.playlist_show_sublabels;
    void (*sanitization)(char*);
@@ -1883,6 +1887,17 @@ static int menu_displaylist_parse_playlist(menu_displaylist_info_t *info,
          sanitization = NULL;
    }
 
+   /* Entries can be ruled out using the playlist search
+    * index, as long as menu labels are plain playlist
+    * labels (or file/core names) */
+   if (search_terms && !sanitization && !show_inline_core_name)
+   {
+      size_t j;
+      for (j = 0; j < search_terms->size; j++)
+         search_signature |= playlist_get_search_signature(
+               search_terms->terms[j]);
+   }
+
    for (i = 0; i < list_size; i++)
    {
       char menu_entry_label[PATH_MAX_LENGTH];
@@ -1890,6 +1905,10 @@ static int menu_displaylist_parse_playlist(menu_displaylist_info_t *info,
       const char *entry_path             = NULL;
       bool entry_valid                   = true;
 
+      if (     search_signature
+            && !playlist_search_may_match(playlist, i, search_signature))
+         continue;
+
       menu_entry_label[0] = '\0';
 
       /* Read playlist entry */
@@ -2948,6 +2967,18 @@ static int menu_displaylist_parse_load_content_settings(
             count++;
       }
 
+#ifdef HAVE_BSV_MOVIE
+      if (rarch_ctl(RARCH_CTL_BSV_MOVIE_CAN_SEEK, NULL))
+      {
+         if (menu_entries_append_enum(list,
+               msg_hash_to_str(MENU_ENUM_LABEL_VALUE_MOVIE_SEEK),
+               msg_hash_to_str(MENU_ENUM_LABEL_MOVIE_SEEK),
+               MENU_ENUM_LABEL_MOVIE_SEEK,
+               MENU_SETTING_ACTION, 0, 0))
+            count++;
+      }
+#endif
+
       if (
             settings->bools.quick_menu_show_add_to_favorites &&
             settings->bools.menu_content_show_favorites
@@ -5500,6 +5531,7 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_PLAYLIST_SUBLABEL_RUNTIME_TYPE,      PARSE_ONLY_UINT, false},
                {MENU_ENUM_LABEL_PLAYLIST_SUBLABEL_LAST_PLAYED_STYLE, PARSE_ONLY_UINT, false},
                {MENU_ENUM_LABEL_PLAYLIST_FUZZY_ARCHIVE_MATCH,        PARSE_ONLY_BOOL, true},
+               {MENU_ENUM_LABEL_PLAYLIST_PREFETCH,                   PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_SCAN_WITHOUT_CORE_MATCH,             PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_OZONE_TRUNCATE_PLAYLIST_NAME,        PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_OZONE_SORT_AFTER_TRUNCATE_PLAYLIST_NAME, PARSE_ONLY_BOOL, true},
@@ -5984,6 +6016,10 @@ unsigned menu_displaylist_build_list(
                   MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_DELTA,
                   PARSE_ONLY_FLOAT, false) == 0)
             count++;
+         if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
+                  MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_ADAPTIVE,
+                  PARSE_ONLY_BOOL, false) == 0)
+            count++;
          break;
       case DISPLAYLIST_AUDIO_SETTINGS_LIST:
 	 {
@@ -6129,6 +6165,10 @@ unsigned menu_displaylist_build_list(
                      MENU_ENUM_LABEL_VIDEO_SHADER_DELAY,
                      PARSE_ONLY_UINT, false) == 0)
                count++;
+            if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
+                     MENU_ENUM_LABEL_VIDEO_GPU_MEMORY_BUDGET,
+                     PARSE_ONLY_UINT, false) == 0)
+               count++;
 #ifdef HAVE_VIDEO_FILTER
             if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
                      MENU_ENUM_LABEL_VIDEO_FILTER,
@@ -7479,11 +7519,14 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_VIDEO_RECORD_QUALITY,                                  PARSE_ONLY_UINT,   true},
                {MENU_ENUM_LABEL_RECORD_CONFIG,                                         PARSE_ONLY_PATH,   true},
                {MENU_ENUM_LABEL_VIDEO_RECORD_THREADS,                                  PARSE_ONLY_UINT,   true},
+               {MENU_ENUM_LABEL_INSTANT_REPLAY_LENGTH,                                 PARSE_ONLY_UINT,   true},
                {MENU_ENUM_LABEL_VIDEO_POST_FILTER_RECORD,                              PARSE_ONLY_BOOL,   true},
                {MENU_ENUM_LABEL_VIDEO_GPU_RECORD,                                      PARSE_ONLY_BOOL,   true},
+               {MENU_ENUM_LABEL_VIDEO_FRAME_EXPORT,                                    PARSE_ONLY_BOOL,   true},
                {MENU_ENUM_LABEL_STREAMING_MODE,                                        PARSE_ONLY_UINT,   true},
                {MENU_ENUM_LABEL_VIDEO_STREAM_QUALITY,                                  PARSE_ONLY_UINT,   true},
                {MENU_ENUM_LABEL_STREAM_CONFIG,                                         PARSE_ONLY_PATH,   true},
+               {MENU_ENUM_LABEL_STREAMING_RECORD_COPY,                                 PARSE_ONLY_BOOL,   true},
                {MENU_ENUM_LABEL_STREAMING_TITLE,                                       PARSE_ONLY_STRING, true},
                {MENU_ENUM_LABEL_STREAMING_URL,                                         PARSE_ONLY_STRING, true},
                {MENU_ENUM_LABEL_UDP_STREAM_PORT,                                       PARSE_ONLY_UINT,   true},
@@ -7600,6 +7643,7 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_PAUSE_NONACTIVE,                                       PARSE_ONLY_BOOL,   true},
                {MENU_ENUM_LABEL_MENU_SAVESTATE_RESUME,                                 PARSE_ONLY_BOOL,   true},
                {MENU_ENUM_LABEL_MENU_INSERT_DISK_RESUME,                               PARSE_ONLY_BOOL,   true},
+               {MENU_ENUM_LABEL_MENU_DEFER_INIT,                                       PARSE_ONLY_BOOL,   true},
                {MENU_ENUM_LABEL_QUIT_ON_CLOSE_CONTENT,                                 PARSE_ONLY_UINT,   true},
                {MENU_ENUM_LABEL_MENU_SCREENSAVER_TIMEOUT,                              PARSE_ONLY_UINT,   false},
                {MENU_ENUM_LABEL_MENU_SCREENSAVER_ANIMATION,                            PARSE_ONLY_UINT,   false},
@@ -7861,6 +7905,10 @@ unsigned menu_displaylist_build_list(
                         MENU_ENUM_LABEL_VIDEO_FRAME_DELAY,
                         PARSE_ONLY_UINT, false) == 0)
                   count++;
+               if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
+                        MENU_ENUM_LABEL_VIDEO_FRAME_DELAY_AUTO,
+                        PARSE_ONLY_BOOL, false) == 0)
+                  count++;
             }
 
             if (video_driver_test_all_flags(GFX_CTX_FLAGS_HARD_SYNC))
@@ -8252,14 +8300,24 @@ unsigned menu_displaylist_build_list(
             bool video_hard_sync          = settings->bools.video_hard_sync;
             menu_displaylist_build_info_selective_t build_list[] = {
                {MENU_ENUM_LABEL_VIDEO_FRAME_DELAY,                     PARSE_ONLY_UINT, true },
+               {MENU_ENUM_LABEL_VIDEO_FRAME_DELAY_AUTO,                PARSE_ONLY_BOOL, true },
+               {MENU_ENUM_LABEL_VIDEO_LATENCY_TEST,                    PARSE_ONLY_BOOL, true },
                {MENU_ENUM_LABEL_AUDIO_LATENCY,                         PARSE_ONLY_UINT, true },
                {MENU_ENUM_LABEL_INPUT_POLL_TYPE_BEHAVIOR,              PARSE_ONLY_UINT, true },
                {MENU_ENUM_LABEL_INPUT_BLOCK_TIMEOUT,                   PARSE_ONLY_UINT, true },
+#ifdef HAVE_THREADS
+               {MENU_ENUM_LABEL_THREAD_PRIORITY_PROFILE,               PARSE_ONLY_UINT, true },
+               {MENU_ENUM_LABEL_THREAD_AFFINITY_FAST_CORES,            PARSE_ONLY_BOOL, true },
+#endif
+#ifdef HAVE_MEMMAP
+               {MENU_ENUM_LABEL_STATE_BUFFERS_LOCKED,                  PARSE_ONLY_BOOL, true },
+#endif
 #ifdef HAVE_RUNAHEAD
                {MENU_ENUM_LABEL_RUN_AHEAD_ENABLED,                     PARSE_ONLY_BOOL, true },
                {MENU_ENUM_LABEL_RUN_AHEAD_FRAMES,                      PARSE_ONLY_UINT, false },
                {MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_INSTANCE,          PARSE_ONLY_BOOL, false },
                {MENU_ENUM_LABEL_RUN_AHEAD_HIDE_WARNINGS,               PARSE_ONLY_BOOL, false },
+               {MENU_ENUM_LABEL_RUN_AHEAD_AUTO_DETECT,                 PARSE_ONLY_BOOL, true },
 #endif
             };
 
@@ -8565,6 +8623,7 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_AUTOSAVE_INTERVAL,                  PARSE_ONLY_UINT, true},
                {MENU_ENUM_LABEL_SAVESTATE_AUTO_INDEX,               PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_SAVESTATE_MAX_KEEP,                 PARSE_ONLY_UINT, false},
+               {MENU_ENUM_LABEL_SAVESTATE_CACHE_SLOTS,              PARSE_ONLY_UINT, true},
                {MENU_ENUM_LABEL_SAVESTATE_AUTO_SAVE,                PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_SAVESTATE_AUTO_LOAD,                PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_SAVESTATE_THUMBNAIL_ENABLE,         PARSE_ONLY_BOOL, true},
@@ -9135,6 +9194,7 @@ unsigned menu_displaylist_build_list(
             menu_displaylist_build_info_selective_t build_list[] = {
                {MENU_ENUM_LABEL_REWIND_ENABLE,           PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_REWIND_GRANULARITY,      PARSE_ONLY_UINT, false},
+               {MENU_ENUM_LABEL_REWIND_CHECKPOINT_INTERVAL, PARSE_ONLY_UINT, false},
                {MENU_ENUM_LABEL_REWIND_BUFFER_SIZE,      PARSE_ONLY_SIZE, false},
                {MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP, PARSE_ONLY_UINT, false},
             };
@@ -9144,6 +9204,7 @@ unsigned menu_displaylist_build_list(
                switch (build_list[i].enum_idx)
                {
                   case MENU_ENUM_LABEL_REWIND_GRANULARITY:
+                  case MENU_ENUM_LABEL_REWIND_CHECKPOINT_INTERVAL:
                   case MENU_ENUM_LABEL_REWIND_BUFFER_SIZE:
                   case MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP:
                      if (rewind_enable)
@@ -9174,9 +9235,11 @@ unsigned menu_displaylist_build_list(
 #endif
                {MENU_ENUM_LABEL_FRAME_TIME_COUNTER_SETTINGS, PARSE_ACTION},
                {MENU_ENUM_LABEL_FASTFORWARD_RATIO,       PARSE_ONLY_FLOAT},
+               {MENU_ENUM_LABEL_FASTFORWARD_FRAMESKIP,   PARSE_ONLY_BOOL },
                {MENU_ENUM_LABEL_SLOWMOTION_RATIO,        PARSE_ONLY_FLOAT},
                {MENU_ENUM_LABEL_VRR_RUNLOOP_ENABLE,      PARSE_ONLY_BOOL },
                {MENU_ENUM_LABEL_MENU_THROTTLE_FRAMERATE, PARSE_ONLY_BOOL },
+               {MENU_ENUM_LABEL_MENU_SKIP_IDLE_FRAMES,   PARSE_ONLY_BOOL },
             };
 
             for (i = 0; i < ARRAY_SIZE(build_list); i++)
@@ -10221,6 +10284,7 @@ bool menu_displaylist_ctl(enum menu_displaylist_ctl_state type,
 
                /* fallthrough */
             case CPUSCALING_MANAGED_PERFORMANCE:
+            case CPUSCALING_MANAGED_FRAME_TIME:
                /* Allow users to choose max/min frequencies */
                menu_entries_append_enum(info->list,
                   "0",
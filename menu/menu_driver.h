@@ -498,6 +498,8 @@ void menu_display_handle_wallpaper_upload(retro_task_t *task,
       void *task_data,
       void *user_data, const char *err);
 
+bool menu_display_load_wallpaper(const char *path);
+
 #if defined(HAVE_LIBRETRODB)
 uintptr_t menu_explore_get_entry_icon(unsigned type);
 void menu_explore_context_init(void);
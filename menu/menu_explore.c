@@ -20,9 +20,12 @@
 #include "../retroarch.h"
 #include "../configuration.h"
 #include "../playlist.h"
+#include "../database_info.h"
+#include "../file_path_special.h"
 #include "../libretro-db/libretrodb.h"
 #include <compat/strcasestr.h>
 #include <compat/strl.h>
+#include <lists/dir_list.h>
 #include <array/rbuf.h>
 #include <array/rhmap.h>
 
@@ -97,6 +100,17 @@ typedef struct
    bool has_unknown[EXPLORE_CAT_COUNT];
 } explore_state_t;
 
+/* A database referenced by the playlists, with the
+ * playlist entries it can still match */
+typedef struct explore_rdb
+{
+   libretrodb_t *handle;
+   const struct playlist_entry **playlist_crcs;
+   const struct playlist_entry **playlist_names;
+   size_t count;
+   char systemname[256];
+} explore_rdb_t;
+
 static const struct
 {
    const char* rdbkey;
@@ -399,19 +413,233 @@ static void explore_load_icons(explore_state_t *state)
    }
 }
 
-static explore_state_t *explore_build_list(settings_t *settings)
+/* Adds the explore entry of database item 'item', if it
+ * matches one of the playlist entries of 'rdb' */
+static bool explore_add_rdb_item(explore_state_t *explore,
+      explore_string_t** cat_maps[EXPLORE_CAT_COUNT],
+      explore_string_t ***split_buf,
+      explore_rdb_t *rdb, struct rmsgpack_dom_value *item)
 {
-   unsigned i;
-   char tmp[PATH_MAX_LENGTH];
-   struct explore_rdb
+   unsigned k, l, cat;
+   explore_entry_t e;
+   char *fields[EXPLORE_CAT_COUNT];
+   char numeric_buf[EXPLORE_CAT_COUNT][16];
+   const struct playlist_entry *entry = NULL;
+   uint32_t crc32                     = 0;
+   char *name                         = NULL;
+#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
+   char *original_title               = NULL;
+#endif
+
+   if (item->type != RDT_MAP)
+      return false;
+
+   for (k = 0; k < EXPLORE_CAT_COUNT; k++)
+      fields[k]                       = NULL;
+
+   for (k = 0; k < item->val.map.len; k++)
+   {
+      const char *key_str             = NULL;
+      struct rmsgpack_dom_value *key  = &item->val.map.items[k].key;
+      struct rmsgpack_dom_value *val  = &item->val.map.items[k].value;
+      if (!key || !val || key->type != RDT_STRING)
+         continue;
+
+      key_str                         = key->val.string.buff;
+      if (string_is_equal(key_str, "crc"))
+      {
+         switch (val->val.binary.len)
+         {
+            case 1:
+               crc32 = *(uint8_t*)val->val.binary.buff;
+               break;
+            case 2:
+               crc32 = swap_if_little16(*(uint16_t*)val->val.binary.buff);
+               break;
+            case 4:
+               crc32 = swap_if_little32(*(uint32_t*)val->val.binary.buff);
+               break;
+            default:
+               crc32 = 0;
+               break;
+         }
+
+         continue;
+      }
+      else if (string_is_equal(key_str, "name"))
+      {
+         name = val->val.string.buff;
+         continue;
+      }
+#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
+      else if (string_is_equal(key_str, "original_title"))
+      {
+         original_title = val->val.string.buff;
+         continue;
+      }
+#endif
+
+      for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+      {
+         if (!string_is_equal(key_str, explore_by_info[cat].rdbkey))
+            continue;
+
+         if (explore_by_info[cat].is_numeric)
+         {
+            if (!val->val.int_)
+               break;
+            snprintf(numeric_buf[cat],
+                  sizeof(numeric_buf[cat]),
+                  "%d", (int)val->val.int_);
+            fields[cat] = numeric_buf[cat];
+            break;
+         }
+         if (val->type != RDT_STRING)
+            break;
+         fields[cat] = val->val.string.buff;
+         break;
+      }
+   }
+
+   if (crc32)
+   {
+      entry = RHMAP_GET(rdb->playlist_crcs, crc32);
+   }
+   if (!entry && name)
+   {
+      entry = RHMAP_GET_STR(rdb->playlist_names, name);
+   }
+   if (!entry)
+      return false;
+
+   e.playlist_entry  = entry;
+   for (l = 0; l < EXPLORE_CAT_COUNT; l++)
+      e.by[l]        = NULL;
+   e.split           = NULL;
+#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
+   e.original_title  = NULL;
+#endif
+
+   fields[EXPLORE_BY_SYSTEM] = rdb->systemname;
+
+   for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+   {
+      explore_add_unique_string(explore,
+            cat_maps, &e, cat,
+            fields[cat], split_buf);
+   }
+
+#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
+   if (original_title && *original_title)
+   {
+      size_t len       = strlen(original_title) + 1;
+      e.original_title = (char*)
+         ex_arena_alloc(&explore->arena, len);
+      memcpy(e.original_title, original_title, len);
+   }
+#endif
+
+   if (RBUF_LEN(*split_buf))
+   {
+      size_t len;
+
+      RBUF_PUSH(*split_buf, NULL); /* terminator */
+      len        = RBUF_SIZEOF(*split_buf);
+      e.split    = (explore_string_t **)
+         ex_arena_alloc(&explore->arena, len);
+      memcpy(e.split, *split_buf, len);
+      RBUF_CLEAR(*split_buf);
+   }
+
+   RBUF_PUSH(explore->entries, e);
+   return true;
+}
+
+/* Looks up the playlist entries of 'rdb' with a CRC
+ * in the database index, and only reads the matching
+ * items, instead of going through the whole database.
+ * Returns false if the database must be scanned */
+static bool explore_add_indexed_items(explore_state_t *explore,
+      explore_string_t** cat_maps[EXPLORE_CAT_COUNT],
+      explore_string_t ***split_buf,
+      explore_rdb_t *rdb, const database_info_index_t *index,
+      size_t index_pos)
+{
+   size_t k;
+   libretrodb_cursor_t *cur = libretrodb_cursor_new();
+
+   if (!cur)
+      return false;
+
+   if (libretrodb_cursor_open(rdb->handle, cur, NULL) != 0)
+   {
+      libretrodb_cursor_free(cur);
+      return false;
+   }
+
+   for (k = 0; k < RHMAP_CAP(rdb->playlist_crcs); k++)
    {
-      libretrodb_t *handle;
-      const struct playlist_entry **playlist_crcs;
-      const struct playlist_entry **playlist_names;
       size_t count;
-      char systemname[256];
+      const database_info_index_record_t *records = NULL;
+      uint32_t crc32 = RHMAP_KEY(rdb->playlist_crcs, k);
+
+      if (!crc32)
+         continue;
+
+      count = database_info_index_find(index,
+            DATABASE_INDEX_KEY_CRC, crc32, &records);
+
+      for (; count > 0; count--, records++)
+      {
+         struct rmsgpack_dom_value item;
+
+         if (     records->rdb != index_pos
+               || libretrodb_cursor_seek(cur, records->offset) != 0
+               || libretrodb_cursor_read_item(cur, &item) != 0)
+            continue;
+
+         if (explore_add_rdb_item(explore, cat_maps, split_buf, rdb, &item))
+            rdb->count--;
+         rmsgpack_dom_value_free(&item);
+      }
    }
-   *rdbs                                          = NULL;
+
+   libretrodb_cursor_close(cur);
+   libretrodb_cursor_free(cur);
+
+   /* Whatever is left can only be matched by name */
+   RHMAP_FREE(rdb->playlist_crcs);
+   return true;
+}
+
+/* Opens the database index shared with the content
+ * scanner, which is cached next to the databases and
+ * only rebuilt when one of them changes */
+static database_info_index_t *explore_open_db_index(
+      const char *directory_database, bool show_hidden_files,
+      struct string_list **rdb_list)
+{
+   char cache_path[PATH_MAX_LENGTH];
+
+   /* Same list as the scanner, or each would
+    * invalidate the cache of the other */
+   if (!(*rdb_list = dir_list_new(directory_database,
+               "rdb", false, show_hidden_files, false, false)))
+      return NULL;
+
+   fill_pathname_join(cache_path, directory_database,
+         FILE_PATH_RDB_INDEX_CACHE, sizeof(cache_path));
+
+   return database_info_index_new(*rdb_list, cache_path);
+}
+
+static explore_state_t *explore_build_list(settings_t *settings)
+{
+   unsigned i;
+   char tmp[PATH_MAX_LENGTH];
+   explore_rdb_t *rdbs                            = NULL;
+   database_info_index_t *index                   = NULL;
+   struct string_list *rdb_list                   = NULL;
    int *rdb_indices                               = NULL;
    explore_string_t **cat_maps[EXPLORE_CAT_COUNT] = {NULL};
    explore_string_t **split_buf                   = NULL;
@@ -471,7 +699,7 @@ static explore_state_t *explore_build_list(settings_t *settings)
       {
          int rdb_num;
          uint32_t entry_crc32;
-         struct explore_rdb* rdb             = NULL;
+         explore_rdb_t *rdb                  = NULL;
          const struct playlist_entry *entry  = NULL;
          const char *db_name                 = fname;
          const char *db_ext                  = fext;
@@ -498,7 +726,7 @@ static explore_state_t *explore_build_list(settings_t *settings)
          rdb_num = RHMAP_GET(rdb_indices, rdb_hash);
          if (!rdb_num)
          {
-            struct explore_rdb newrdb;
+            explore_rdb_t newrdb;
             size_t systemname_len;
 
             newrdb.handle         = libretrodb_new();
@@ -553,164 +781,59 @@ static explore_state_t *explore_build_list(settings_t *settings)
          playlist_free(playlist);
    }
 
+   /* Entries with a CRC are looked up in the database
+    * index rather than scanning each whole database */
+   if (RBUF_LEN(rdbs))
+      index = explore_open_db_index(directory_database,
+            settings->bools.show_hidden_files, &rdb_list);
+
    /* Loop through all RDBs referenced in the playlists 
     * and load meta data strings */
    for (i = 0; i != RBUF_LEN(rdbs); i++)
    {
       struct rmsgpack_dom_value item;
-      struct explore_rdb* rdb  = &rdbs[i];
-      libretrodb_cursor_t *cur = libretrodb_cursor_new();
-      bool more                = 
-         (
-          libretrodb_cursor_open(rdb->handle, cur, NULL) == 0
-          && libretrodb_cursor_read_item(cur, &item) == 0);
+      explore_rdb_t *rdb       = &rdbs[i];
+      libretrodb_cursor_t *cur = NULL;
+      bool more                = false;
 
-      for (; more; more = (rmsgpack_dom_value_free(&item),
-               libretrodb_cursor_read_item(cur, &item) == 0))
+      if (index && RHMAP_LEN(rdb->playlist_crcs))
       {
-         unsigned k, l, cat;
-         explore_entry_t e;
-         char *fields[EXPLORE_CAT_COUNT];
-         char numeric_buf[EXPLORE_CAT_COUNT][16];
-         const struct playlist_entry *entry = NULL;
-         uint32_t crc32                     = 0;
-         char *name                         = NULL;
-#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
-         char *original_title               = NULL;
-#endif
-
-         if (item.type != RDT_MAP)
-            continue;
-
-         for (k = 0; k < EXPLORE_CAT_COUNT; k++)
-            fields[k]                       = NULL;
-
-         for (k = 0; k < item.val.map.len; k++)
-         {
-            const char *key_str             = NULL;
-            struct rmsgpack_dom_value *key  = &item.val.map.items[k].key;
-            struct rmsgpack_dom_value *val  = &item.val.map.items[k].value;
-            if (!key || !val || key->type != RDT_STRING)
-               continue;
-
-            key_str                         = key->val.string.buff;
-            if (string_is_equal(key_str, "crc"))
-            {
-               switch (val->val.binary.len)
-               {
-                  case 1:
-                     crc32 = *(uint8_t*)val->val.binary.buff;
-                     break;
-                  case 2:
-                     crc32 = swap_if_little16(*(uint16_t*)val->val.binary.buff);
-                     break;
-                  case 4:
-                     crc32 = swap_if_little32(*(uint32_t*)val->val.binary.buff);
-                     break;
-                  default:
-                     crc32 = 0;
-                     break;
-               }
-
-               continue;
-            }
-            else if (string_is_equal(key_str, "name"))
-            {
-               name = val->val.string.buff;
-               continue;
-            }
-#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
-            else if (string_is_equal(key_str, "original_title"))
-            {
-               original_title = val->val.string.buff;
-               continue;
-            }
-#endif
-
-            for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
-            {
-               if (!string_is_equal(key_str, explore_by_info[cat].rdbkey))
-                  continue;
-
-               if (explore_by_info[cat].is_numeric)
-               {
-                  if (!val->val.int_)
-                     break;
-                  snprintf(numeric_buf[cat],
-                        sizeof(numeric_buf[cat]),
-                        "%d", (int)val->val.int_);
-                  fields[cat] = numeric_buf[cat];
-                  break;
-               }
-               if (val->type != RDT_STRING)
-                  break;
-               fields[cat] = val->val.string.buff;
-               break;
-            }
-         }
-
-         if (crc32)
-         {
-            entry = RHMAP_GET(rdb->playlist_crcs, crc32);
-         }
-         if (!entry && name)
-         {
-            entry = RHMAP_GET_STR(rdb->playlist_names, name);
-         }
-         if (!entry)
-            continue;
+         int index_pos;
 
-         e.playlist_entry  = entry;
-         for (l = 0; l < EXPLORE_CAT_COUNT; l++)
-            e.by[l]        = NULL;
-         e.split           = NULL;
-#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
-         e.original_title  = NULL;
-#endif
-
-         fields[EXPLORE_BY_SYSTEM] = rdb->systemname;
-
-         for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
-         {
-            explore_add_unique_string(explore,
-                  cat_maps, &e, cat,
-                  fields[cat], &split_buf);
-         }
-
-#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
-         if (original_title && *original_title)
-         {
-            size_t len       = strlen(original_title) + 1;
-            e.original_title = (char*)
-               ex_arena_alloc(&explore->arena, len);
-            memcpy(e.original_title, original_title, len);
-         }
-#endif
+         fill_pathname_join(tmp, directory_database,
+               rdb->systemname, sizeof(tmp));
+         strlcat(tmp, ".rdb", sizeof(tmp));
 
-         if (RBUF_LEN(split_buf))
-         {
-            size_t len;
-
-            RBUF_PUSH(split_buf, NULL); /* terminator */
-            len        = RBUF_SIZEOF(split_buf);
-            e.split    = (explore_string_t **)
-               ex_arena_alloc(&explore->arena, len);
-            memcpy(e.split, split_buf, len);
-            RBUF_CLEAR(split_buf);
-         }
+         if ((index_pos = string_list_find_elem(rdb_list, tmp)) > 0)
+            explore_add_indexed_items(explore, cat_maps, &split_buf,
+                  rdb, index, (size_t)(index_pos - 1));
+      }
 
-         RBUF_PUSH(explore->entries, e);
+      /* Scan the database for whatever is left */
+      if (     rdb->count > 0
+            && (RHMAP_LEN(rdb->playlist_crcs) || RHMAP_LEN(rdb->playlist_names))
+            && (cur = libretrodb_cursor_new()))
+         more = (
+                libretrodb_cursor_open(rdb->handle, cur, NULL) == 0
+             && libretrodb_cursor_read_item(cur, &item) == 0);
 
+      for (; more; more = (rmsgpack_dom_value_free(&item),
+               libretrodb_cursor_read_item(cur, &item) == 0))
+      {
          /* if all entries have found connections, we can leave early */
-         if (--rdb->count == 0)
+         if (     explore_add_rdb_item(explore, cat_maps, &split_buf, rdb, &item)
+               && --rdb->count == 0)
          {
             rmsgpack_dom_value_free(&item);
             break;
          }
       }
 
-      libretrodb_cursor_close(cur);
-      libretrodb_cursor_free(cur);
+      if (cur)
+      {
+         libretrodb_cursor_close(cur);
+         libretrodb_cursor_free(cur);
+      }
       libretrodb_close(rdb->handle);
       libretrodb_free(rdb->handle);
       RHMAP_FREE(rdb->playlist_crcs);
@@ -719,6 +842,9 @@ static explore_state_t *explore_build_list(settings_t *settings)
    RBUF_FREE(split_buf);
    RHMAP_FREE(rdb_indices);
    RBUF_FREE(rdbs);
+   database_info_index_free(index);
+   if (rdb_list)
+      string_list_free(rdb_list);
 
    for (i = 0; i != EXPLORE_CAT_COUNT; i++)
    {
@@ -90,6 +90,7 @@
 #include "../lakka.h"
 #include "../retroarch.h"
 #include "../gfx/video_display_server.h"
+#include "../gfx/video_frame_export.h"
 #ifdef HAVE_CHEATS
 #include "../cheat_manager.h"
 #endif
@@ -2930,6 +2931,9 @@ static void setting_get_string_representation_video_stream_quality(
       case RECORD_CONFIG_TYPE_STREAMING_HIGH_QUALITY:
          strlcpy(s, "High", len);
          break;
+      case RECORD_CONFIG_TYPE_STREAMING_LOW_LATENCY:
+         strlcpy(s, "Low Latency", len);
+         break;
    }
 }
 
@@ -6302,6 +6306,20 @@ static void setting_get_string_representation_uint_analog_dpad_mode(
    strlcpy(s, modes[*setting->value.target.unsigned_integer % ANALOG_DPAD_LAST], len);
 }
 
+static void setting_get_string_representation_uint_rewind_checkpoint_interval(
+      rarch_setting_t *setting,
+      char *s, size_t len)
+{
+   if (!setting)
+      return;
+
+   if (*setting->value.target.unsigned_integer)
+      snprintf(s, len, "%u %s",
+            *setting->value.target.unsigned_integer, msg_hash_to_str(MENU_ENUM_LABEL_VALUE_SECONDS));
+   else
+      strlcpy(s, msg_hash_to_str(MENU_ENUM_LABEL_VALUE_OFF), len);
+}
+
 static void setting_get_string_representation_uint_input_remap_port(
       rarch_setting_t *setting,
       char *s, size_t len)
@@ -6530,6 +6548,35 @@ static void setting_get_string_representation_poll_type_behavior(
    }
 }
 
+#ifdef HAVE_THREADS
+static void setting_get_string_representation_thread_priority_profile(
+      rarch_setting_t *setting,
+      char *s, size_t len)
+{
+   if (!setting)
+      return;
+
+   switch (*setting->value.target.unsigned_integer)
+   {
+      case THREAD_PRIORITY_PROFILE_DEFAULT:
+         strlcpy(s,
+               msg_hash_to_str(
+                  MENU_ENUM_LABEL_VALUE_THREAD_PRIORITY_PROFILE_DEFAULT), len);
+         break;
+      case THREAD_PRIORITY_PROFILE_EMULATION:
+         strlcpy(s,
+               msg_hash_to_str(
+                  MENU_ENUM_LABEL_VALUE_THREAD_PRIORITY_PROFILE_EMULATION), len);
+         break;
+      case THREAD_PRIORITY_PROFILE_REALTIME_AUDIO:
+         strlcpy(s,
+               msg_hash_to_str(
+                  MENU_ENUM_LABEL_VALUE_THREAD_PRIORITY_PROFILE_REALTIME_AUDIO), len);
+         break;
+   }
+}
+#endif
+
 static void setting_get_string_representation_input_touch_scale(rarch_setting_t *setting,
       char *s, size_t len)
 {
@@ -7493,6 +7540,10 @@ static void general_write_handler(rarch_setting_t *setting)
       case MENU_ENUM_LABEL_INPUT_POLL_TYPE_BEHAVIOR:
          core_set_poll_type(*setting->value.target.integer);
          break;
+      case MENU_ENUM_LABEL_THREAD_PRIORITY_PROFILE:
+      case MENU_ENUM_LABEL_THREAD_AFFINITY_FAST_CORES:
+         retroarch_apply_thread_profiles();
+         break;
       case MENU_ENUM_LABEL_VIDEO_SCALE_INTEGER:
          {
             video_viewport_t vp;
@@ -7744,6 +7795,7 @@ static void general_write_handler(rarch_setting_t *setting)
       case MENU_ENUM_LABEL_AUDIO_WASAPI_EXCLUSIVE_MODE:
       case MENU_ENUM_LABEL_AUDIO_WASAPI_FLOAT_FORMAT:
       case MENU_ENUM_LABEL_AUDIO_WASAPI_SH_BUFFER_LENGTH:
+      case MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_ADAPTIVE:
          rarch_cmd = CMD_EVENT_AUDIO_REINIT;
          break;
       case MENU_ENUM_LABEL_PAL60_ENABLE:
@@ -10128,6 +10180,20 @@ static bool setting_append_list(
             (*list)[list_info->index - 1].action_ok     = &setting_action_ok_uint;
             menu_settings_list_current_add_range(list, list_info, 0, 999, 1, true, true);
 
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.savestate_cache_slots,
+                  MENU_ENUM_LABEL_SAVESTATE_CACHE_SLOTS,
+                  MENU_ENUM_LABEL_VALUE_SAVESTATE_CACHE_SLOTS,
+                  DEFAULT_SAVESTATE_CACHE_SLOTS,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].action_ok     = &setting_action_ok_uint;
+            menu_settings_list_current_add_range(list, list_info, 0, 10, 1, true, true);
+
             CONFIG_BOOL(
                   list, list_info,
                   &settings->bools.content_runtime_log,
@@ -10307,6 +10373,22 @@ static bool setting_append_list(
             (*list)[list_info->index - 1].offset_by     = 1;
             menu_settings_list_current_add_range(list, list_info, 1, 32768, 1, true, true);
 
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.rewind_checkpoint_interval,
+                  MENU_ENUM_LABEL_REWIND_CHECKPOINT_INTERVAL,
+                  MENU_ENUM_LABEL_VALUE_REWIND_CHECKPOINT_INTERVAL,
+                  DEFAULT_REWIND_CHECKPOINT_INTERVAL,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].action_ok     = &setting_action_ok_uint;
+            (*list)[list_info->index - 1].get_string_representation =
+               &setting_get_string_representation_uint_rewind_checkpoint_interval;
+            menu_settings_list_current_add_range(list, list_info, 0, 600, 1, true, true);
+
             CONFIG_SIZE(
                   list, list_info,
                   &settings->sizes.rewind_buffer_size,
@@ -11788,6 +11870,7 @@ static bool setting_append_list(
                   general_read_handler);
             (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
             (*list)[list_info->index - 1].offset_by = 1;
+            MENU_SETTINGS_LIST_CURRENT_ADD_CMD(list, list_info, CMD_EVENT_VIDEO_SWAPCHAIN_REINIT);
             menu_settings_list_current_add_range(list, list_info, 1, 4, 1, true, true);
             SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_CMD_APPLY_AUTO);
 
@@ -11857,6 +11940,38 @@ static bool setting_append_list(
             menu_settings_list_current_add_range(list, list_info, 0, MAXIMUM_FRAME_DELAY, 1, true, true);
             SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_LAKKA_ADVANCED);
 
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.video_frame_delay_auto,
+                  MENU_ENUM_LABEL_VIDEO_FRAME_DELAY_AUTO,
+                  MENU_ENUM_LABEL_VALUE_VIDEO_FRAME_DELAY_AUTO,
+                  DEFAULT_FRAME_DELAY_AUTO,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_LAKKA_ADVANCED
+                  );
+
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.video_latency_test,
+                  MENU_ENUM_LABEL_VIDEO_LATENCY_TEST,
+                  MENU_ENUM_LABEL_VALUE_VIDEO_LATENCY_TEST,
+                  DEFAULT_LATENCY_TEST,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_ADVANCED
+                  );
+
             /* Unlike all other shader-related menu entries
              * (which appear in the shaders quick menu, and
              * are thus hidden automatically on platforms
@@ -11884,6 +11999,21 @@ static bool setting_append_list(
             }
 #endif
 
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.video_gpu_memory_budget,
+                  MENU_ENUM_LABEL_VIDEO_GPU_MEMORY_BUDGET,
+                  MENU_ENUM_LABEL_VALUE_VIDEO_GPU_MEMORY_BUDGET,
+                  DEFAULT_VIDEO_GPU_MEMORY_BUDGET,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
+            menu_settings_list_current_add_range(list, list_info, 0, 4096, 32, true, true);
+            SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
+
             CONFIG_BOOL(
                   list, list_info,
                   &settings->bools.video_shader_watch_files,
@@ -11993,7 +12123,7 @@ static bool setting_append_list(
             (*list)[list_info->index - 1].get_string_representation =
                &setting_get_string_representation_video_filter;
             MENU_SETTINGS_LIST_CURRENT_ADD_VALUES(list, list_info, "filt");
-            MENU_SETTINGS_LIST_CURRENT_ADD_CMD(list, list_info, CMD_EVENT_REINIT);
+            MENU_SETTINGS_LIST_CURRENT_ADD_CMD(list, list_info, CMD_EVENT_VIDEO_FILTER_REINIT);
             SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_LAKKA_ADVANCED);
 
             END_SUB_GROUP(list, list_info, parent_group);
@@ -12395,6 +12525,22 @@ static bool setting_append_list(
                false);
          SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.audio_rate_control_adaptive,
+               MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_ADAPTIVE,
+               MENU_ENUM_LABEL_VALUE_AUDIO_RATE_CONTROL_ADAPTIVE,
+               DEFAULT_RATE_CONTROL_ADAPTIVE,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_ADVANCED
+               );
+
          CONFIG_FLOAT(
                list, list_info,
                &settings->floats.audio_max_timing_skew,
@@ -12682,6 +12828,61 @@ static bool setting_append_list(
             menu_settings_list_current_add_range(list, list_info, 0, 2, 1, true, true);
             SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_LAKKA_ADVANCED);
 
+#ifdef HAVE_THREADS
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.thread_priority_profile,
+                  MENU_ENUM_LABEL_THREAD_PRIORITY_PROFILE,
+                  MENU_ENUM_LABEL_VALUE_THREAD_PRIORITY_PROFILE,
+                  DEFAULT_THREAD_PRIORITY_PROFILE,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].ui_type   = ST_UI_TYPE_UINT_COMBOBOX;
+            (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
+            (*list)[list_info->index - 1].get_string_representation =
+               &setting_get_string_representation_thread_priority_profile;
+            menu_settings_list_current_add_range(list, list_info,
+                  0, THREAD_PRIORITY_PROFILE_LAST - 1, 1, true, true);
+            SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
+
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.thread_affinity_fast_cores,
+                  MENU_ENUM_LABEL_THREAD_AFFINITY_FAST_CORES,
+                  MENU_ENUM_LABEL_VALUE_THREAD_AFFINITY_FAST_CORES,
+                  DEFAULT_THREAD_AFFINITY_FAST_CORES,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_ADVANCED
+                  );
+#endif
+
+#ifdef HAVE_MEMMAP
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.state_buffers_locked,
+                  MENU_ENUM_LABEL_STATE_BUFFERS_LOCKED,
+                  MENU_ENUM_LABEL_VALUE_STATE_BUFFERS_LOCKED,
+                  DEFAULT_STATE_BUFFERS_LOCKED,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_ADVANCED
+                  );
+#endif
+
 #ifdef GEKKO
             CONFIG_UINT(
                   list, list_info,
@@ -13316,7 +13517,7 @@ static bool setting_append_list(
                (*list)[list_info->index - 1].get_string_representation =
                &setting_get_string_representation_video_stream_quality;
                (*list)[list_info->index - 1].offset_by = RECORD_CONFIG_TYPE_STREAMING_CUSTOM;
-            menu_settings_list_current_add_range(list, list_info, RECORD_CONFIG_TYPE_STREAMING_CUSTOM, RECORD_CONFIG_TYPE_STREAMING_HIGH_QUALITY, 1, true, true);
+            menu_settings_list_current_add_range(list, list_info, RECORD_CONFIG_TYPE_STREAMING_CUSTOM, RECORD_CONFIG_TYPE_STREAMING_LOW_LATENCY, 1, true, true);
 
             CONFIG_PATH(
                list, list_info,
@@ -13333,6 +13534,22 @@ static bool setting_append_list(
             MENU_SETTINGS_LIST_CURRENT_ADD_VALUES(list, list_info, "cfg");
             (*list)[list_info->index - 1].ui_type       = ST_UI_TYPE_FILE_SELECTOR;
 
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.streaming_record_copy,
+                  MENU_ENUM_LABEL_STREAMING_RECORD_COPY,
+                  MENU_ENUM_LABEL_VALUE_STREAMING_RECORD_COPY,
+                  DEFAULT_STREAMING_RECORD_COPY,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE
+                  );
+
             CONFIG_STRING(
                list, list_info,
                settings->paths.path_stream_url,
@@ -13365,6 +13582,20 @@ static bool setting_append_list(
                SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_LAKKA_ADVANCED);
                (*list)[list_info->index - 1].ui_type   = ST_UI_TYPE_UINT_COMBOBOX;
 
+            CONFIG_UINT(
+               list, list_info,
+               &settings->uints.instant_replay_length,
+               MENU_ENUM_LABEL_INSTANT_REPLAY_LENGTH,
+               MENU_ENUM_LABEL_VALUE_INSTANT_REPLAY_LENGTH,
+               DEFAULT_INSTANT_REPLAY_LENGTH,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler);
+               (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
+               menu_settings_list_current_add_range(list, list_info, 0, 600, 5, true, true);
+
             CONFIG_DIR(
                list, list_info,
                global->record.output_dir,
@@ -13416,6 +13647,24 @@ static bool setting_append_list(
                   SD_FLAG_NONE
                   );
 
+#ifdef HAVE_VIDEO_FRAME_EXPORT
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.video_frame_export,
+                  MENU_ENUM_LABEL_VIDEO_FRAME_EXPORT,
+                  MENU_ENUM_LABEL_VALUE_VIDEO_FRAME_EXPORT,
+                  DEFAULT_VIDEO_FRAME_EXPORT,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE
+                  );
+#endif
+
             END_SUB_GROUP(list, list_info, parent_group);
             END_GROUP(list, list_info, parent_group);
          break;
@@ -13482,6 +13731,22 @@ static bool setting_append_list(
          MENU_SETTINGS_LIST_CURRENT_ADD_CMD(list, list_info, CMD_EVENT_SET_FRAME_LIMIT);
          menu_settings_list_current_add_range(list, list_info, 0, 10, 1.0, true, true);
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.fastforward_frameskip,
+               MENU_ENUM_LABEL_FASTFORWARD_FRAMESKIP,
+               MENU_ENUM_LABEL_VALUE_FASTFORWARD_FRAMESKIP,
+               DEFAULT_FASTFORWARD_FRAMESKIP,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_NONE
+               );
+
          CONFIG_BOOL(
                list, list_info,
                &settings->bools.vrr_runloop_enable,
@@ -13582,6 +13847,22 @@ static bool setting_append_list(
                SD_FLAG_ADVANCED
                );
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.run_ahead_auto_detect,
+               MENU_ENUM_LABEL_RUN_AHEAD_AUTO_DETECT,
+               MENU_ENUM_LABEL_VALUE_RUN_AHEAD_AUTO_DETECT,
+               DEFAULT_RUN_AHEAD_AUTO_DETECT,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_NONE
+               );
+
 #ifdef ANDROID
          CONFIG_UINT(
             list, list_info,
@@ -13615,6 +13896,22 @@ static bool setting_append_list(
                SD_FLAG_ADVANCED
                );
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.menu_skip_idle_frames,
+               MENU_ENUM_LABEL_MENU_SKIP_IDLE_FRAMES,
+               MENU_ENUM_LABEL_VALUE_MENU_SKIP_IDLE_FRAMES,
+               DEFAULT_MENU_SKIP_IDLE_FRAMES,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_ADVANCED
+               );
+
          END_SUB_GROUP(list, list_info, parent_group);
          END_GROUP(list, list_info, parent_group);
          break;
@@ -14824,6 +15121,22 @@ static bool setting_append_list(
                SD_FLAG_ADVANCED
                );
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.menu_defer_init,
+               MENU_ENUM_LABEL_MENU_DEFER_INIT,
+               MENU_ENUM_LABEL_VALUE_MENU_DEFER_INIT,
+               DEFAULT_MENU_DEFER_INIT,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_ADVANCED
+               );
+
          CONFIG_UINT(
                list, list_info,
                &settings->uints.quit_on_close_content,
@@ -18184,6 +18497,22 @@ static bool setting_append_list(
                SD_FLAG_NONE
                );
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.playlist_prefetch,
+               MENU_ENUM_LABEL_PLAYLIST_PREFETCH,
+               MENU_ENUM_LABEL_VALUE_PLAYLIST_PREFETCH,
+               DEFAULT_PLAYLIST_PREFETCH,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_ADVANCED
+               );
+
          CONFIG_BOOL(
                list, list_info,
                &settings->bools.playlist_portable_paths,
@@ -50,6 +50,10 @@ bool menu_shader_manager_init(void);
  * @apply                    : Whether to apply the shader or just update shader information
  *
  * Sets shader preset.
+ *
+ * Returns: true if the preset was set. False on failure, and
+ * also while a preset to apply is still being compiled in the
+ * background - the menu is only updated once it is applied.
  **/
 bool menu_shader_manager_set_preset(
       struct video_shader *shader,
@@ -29,6 +29,18 @@
 #define REFRESH_TIMEOUT  2
 #define CPU_POLICIES_DIR "/sys/devices/system/cpu/cpufreq/"
 
+/* CPUSCALING_MANAGED_FRAME_TIME: step up as soon as a frame
+ * takes more than FT_UP_LOAD % of the budget, step down once
+ * no frame took more than FT_DOWN_LOAD % for FT_DOWN_WINDOWS
+ * windows of FT_WINDOW frames in a row. The gap between the
+ * two keeps a step down from being undone right away */
+#define FT_WINDOW        30
+#define FT_DOWN_WINDOWS  4
+#define FT_UP_LOAD       85
+#define FT_DOWN_LOAD     60
+/* Frames to give a step up to take effect */
+#define FT_UP_HOLD       5
+
 static time_t last_update = 0;
 static cpu_scaling_driver_t **scaling_drivers = NULL;
 /* Mode state and its options */
@@ -36,6 +48,18 @@ static enum cpu_scaling_mode cur_smode = CPUSCALING_MANAGED_PERFORMANCE;
 static cpu_scaling_opts_t cur_smode_opts = { 1, ~0U, "performance", "ondemand" };
 /* Precalculate and store the absolute max and min frequencies */
 static uint32_t abs_min_freq = 1, abs_max_freq = ~0U;
+/* Frame time mode state. The level is how many steps below
+ * the maximum frequency the policies are capped at, so that
+ * it means the same for policies with different tables */
+static struct
+{
+   retro_time_t peak;
+   unsigned level;
+   unsigned frames;
+   unsigned light_windows;
+   unsigned hold;
+   bool in_core;
+} ft_state;
 
 static bool readparse_uint32(const char *path, uint32_t *value)
 {
@@ -326,6 +350,87 @@ static void steer_all_drivers(
    }
 }
 
+/* Caps every policy @level steps below the user's max
+ * frequency. Returns false if none of them could go that
+ * low, with the caps left at the lowest they go */
+static bool steer_all_drivers_level(unsigned level)
+{
+   bool lowered = false;
+   cpu_scaling_driver_t **drivers = get_cpu_scaling_drivers(false);
+   if (!drivers)
+      return false;
+   while (*drivers)
+   {
+      unsigned i;
+      cpu_scaling_driver_t *d = *drivers++;
+      uint32_t minfreq = MAX(cur_smode_opts.min_freq, d->min_cpu_freq);
+      uint32_t freq = MIN(cur_smode_opts.max_freq, d->max_cpu_freq);
+
+      for (i = 0; i < level && freq > minfreq; i++)
+         freq = get_cpu_scaling_next_frequency(d, freq, -1);
+      if (i == level)
+         lowered = true;
+
+      freq = MAX(freq, minfreq);
+      if (freq != d->max_policy_freq)
+         set_cpu_scaling_max_frequency(d, freq);
+   }
+   return lowered;
+}
+
+static void frame_time_reset_window(void)
+{
+   ft_state.peak          = 0;
+   ft_state.frames        = 0;
+   ft_state.light_windows = 0;
+}
+
+void set_cpu_scaling_frame_time(retro_time_t frame_time,
+      retro_time_t budget)
+{
+   if (  cur_smode != CPUSCALING_MANAGED_FRAME_TIME
+      || !ft_state.in_core
+      || budget <= 0)
+      return;
+
+   if (ft_state.hold)
+   {
+      ft_state.hold--;
+      return;
+   }
+
+   if (frame_time * 100 > budget * FT_UP_LOAD)
+   {
+      if (ft_state.level)
+      {
+         steer_all_drivers_level(--ft_state.level);
+         ft_state.hold = FT_UP_HOLD;
+      }
+      frame_time_reset_window();
+      return;
+   }
+
+   if (frame_time > ft_state.peak)
+      ft_state.peak = frame_time;
+
+   if (++ft_state.frames < FT_WINDOW)
+      return;
+
+   if (ft_state.peak * 100 < budget * FT_DOWN_LOAD)
+      ft_state.light_windows++;
+   else
+      ft_state.light_windows = 0;
+   ft_state.peak   = 0;
+   ft_state.frames = 0;
+
+   if (ft_state.light_windows >= FT_DOWN_WINDOWS)
+   {
+      if (steer_all_drivers_level(ft_state.level + 1))
+         ft_state.level++;
+      ft_state.light_windows = 0;
+   }
+}
+
 void set_cpu_scaling_signal(enum cpu_scaling_event event)
 {
    switch (cur_smode) {
@@ -345,6 +450,19 @@ void set_cpu_scaling_signal(enum cpu_scaling_event event)
       else
          steer_all_drivers(cur_smode_opts.menu_policy, 1, ~0U);
       break;
+   case CPUSCALING_MANAGED_FRAME_TIME:
+      /* Pick up at the level reached before the menu came up */
+      ft_state.in_core = (event == CPUSCALING_EVENT_FOCUS_CORE);
+      frame_time_reset_window();
+      ft_state.hold    = 0;
+      if (ft_state.in_core)
+      {
+         steer_all_drivers("performance", cur_smode_opts.min_freq, 0);
+         steer_all_drivers_level(ft_state.level);
+      }
+      else
+         steer_all_drivers("ondemand", 1, ~0U);
+      break;
    default:
       break;
    };
@@ -373,6 +491,11 @@ void set_cpu_scaling_mode(
    case CPUSCALING_MANUAL:
       /* Do nothing, the UI allows for tweaking directly */
       break;
+   case CPUSCALING_MANAGED_FRAME_TIME:
+      /* Start at full speed, the cap only comes down as
+       * the frame times show there is headroom */
+      ft_state.level = 0;
+      /* fallthrough */
    case CPUSCALING_MANAGED_PERFORMANCE:
    case CPUSCALING_MANAGED_PER_CONTEXT:
       /* Simulate a state change to enforce the policy */
@@ -423,7 +546,7 @@ void cpu_scaling_driver_init(void)
    cur_smode_opts.min_freq = settings->uints.cpu_min_freq;
    cur_smode_opts.max_freq = settings->uints.cpu_max_freq;
 
-   if (mode <= (int)CPUSCALING_MANUAL)
+   if (mode <= (int)CPUSCALING_MANAGED_FRAME_TIME)
       cur_smode = (enum cpu_scaling_mode)mode;
 
    if (settings->arrays.cpu_main_gov[0])
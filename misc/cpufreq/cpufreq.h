@@ -18,6 +18,8 @@
 
 #include <stdint.h>
 
+#include <libretro.h>
+
 RETRO_BEGIN_DECLS
 
 #define MAX_GOV_STRLEN   32
@@ -38,7 +40,8 @@ enum cpu_scaling_mode
    CPUSCALING_MAX_PERFORMANCE,         /* Performance (Max Freq)             */
    CPUSCALING_MIN_POWER,               /* Use Powersave governor             */
    CPUSCALING_BALANCED,                /* Uses schedutil/ondemand            */
-   CPUSCALING_MANUAL                   /* Can manually tweak stuff           */
+   CPUSCALING_MANUAL,                  /* Can manually tweak stuff           */
+   CPUSCALING_MANAGED_FRAME_TIME       /* Follows the core's frame time      */
 };
 
 typedef struct cpu_scaling_opts
@@ -102,6 +105,12 @@ void set_cpu_scaling_mode(enum cpu_scaling_mode mode,
 /* Get the base cpufreq policy mode */
 enum cpu_scaling_mode get_cpu_scaling_mode(cpu_scaling_opts_t *opts);
 
+/* Report how long the core took to run a frame against
+ * how long it may take (both in us, budget 0 to ignore
+ * the frame), for CPUSCALING_MANAGED_FRAME_TIME */
+void set_cpu_scaling_frame_time(retro_time_t frame_time,
+      retro_time_t budget);
+
 RETRO_END_DECLS
 
 #endif
@@ -30,6 +30,11 @@
 /* TODO/FIXME - static public global variable */
 static unsigned uint_user_language;
 
+/* Resolved strings for the current language, indexed by enum,
+ * with the English fallback already applied. Filled in as
+ * strings are first looked up and cleared on language change. */
+static const char *msg_hash_str_cache[MSG_LAST];
+
 int msg_hash_get_help_enum(enum msg_hash_enums msg, char *s, size_t len)
 {
    int ret = -1;
@@ -175,7 +180,7 @@ const char *get_user_language_iso639_1(bool limit)
    return "en";
 }
 
-const char *msg_hash_to_str(enum msg_hash_enums msg)
+static const char *msg_hash_to_str_resolve(enum msg_hash_enums msg)
 {
    const char *ret = NULL;
 
@@ -262,6 +267,23 @@ const char *msg_hash_to_str(enum msg_hash_enums msg)
    return msg_hash_to_str_us(msg);
 }
 
+const char *msg_hash_to_str(enum msg_hash_enums msg)
+{
+   const char *ret;
+
+   /* Hotkey labels are formatted into a shared buffer,
+    * so they can't be kept */
+   if (     (unsigned)msg >= MSG_LAST
+         || (     msg >= MENU_ENUM_LABEL_INPUT_HOTKEY_BIND_BEGIN
+               && msg <= MENU_ENUM_LABEL_INPUT_HOTKEY_BIND_END))
+      return msg_hash_to_str_resolve(msg);
+
+   if (!(ret = msg_hash_str_cache[msg]))
+      ret = msg_hash_str_cache[msg] = msg_hash_to_str_resolve(msg);
+
+   return ret;
+}
+
 uint32_t msg_hash_calculate(const char *s)
 {
    return djb2_calculate(s);
@@ -530,6 +552,8 @@ void msg_hash_set_uint(enum msg_hash_action type, unsigned val)
    switch (type)
    {
       case MSG_HASH_USER_LANGUAGE:
+         if (uint_user_language != val)
+            memset(msg_hash_str_cache, 0, sizeof(msg_hash_str_cache));
          uint_user_language = val;
          break;
       case MSG_HASH_NONE:
@@ -338,6 +338,7 @@ enum msg_hash_enums
    MSG_INPUT_PRESET_FILENAME,
    MSG_INPUT_CHEAT_FILENAME,
    MSG_INPUT_RENAME_ENTRY,
+   MSG_INPUT_MOVIE_SEEK,
    MSG_INPUT_ENABLE_SETTINGS_PASSWORD,
    MSG_INPUT_ENABLE_SETTINGS_PASSWORD_OK,
    MSG_INPUT_ENABLE_SETTINGS_PASSWORD_NOK,
@@ -368,6 +369,9 @@ enum msg_hash_enums
    MSG_LIBRETRO_ABI_BREAK,
    MSG_DETECTED_VIEWPORT_OF,
    MSG_RECORDING_TO,
+   MSG_INSTANT_REPLAY_BUFFERING,
+   MSG_INSTANT_REPLAY_SAVING,
+   MSG_INSTANT_REPLAY_NOT_RUNNING,
    MSG_HW_RENDERED_MUST_USE_POSTSHADED_RECORDING,
    MSG_VIEWPORT_SIZE_CALCULATION_FAILED,
    MSG_AUTOSAVE_FAILED,
@@ -407,6 +411,7 @@ enum msg_hash_enums
    MSG_SENDING_COMMAND,
    MSG_RESTARTING_RECORDING_DUE_TO_DRIVER_REINIT,
    MSG_REWINDING,
+   MSG_REWINDING_CHECKPOINTS,
    MSG_SLOW_MOTION_REWIND,
    MSG_SLOW_MOTION,
    MSG_FAST_FORWARD,
@@ -453,6 +458,8 @@ enum msg_hash_enums
    MSG_GAME_FOCUS_ON,
    MSG_GAME_FOCUS_OFF,
    MSG_FAILED_TO_LOAD_MOVIE_FILE,
+   MSG_FAILED_TO_SEEK_MOVIE,
+   MSG_MOVIE_SEEKED_TO_FRAME,
    MSG_FAILED_TO,
    MSG_SAVING_RAM_TYPE,
    MSG_TO,
@@ -478,6 +485,8 @@ enum msg_hash_enums
    MSG_RUNAHEAD_FAILED_TO_SAVE_STATE,
    MSG_RUNAHEAD_FAILED_TO_LOAD_STATE,
    MSG_RUNAHEAD_FAILED_TO_CREATE_SECONDARY_INSTANCE,
+   MSG_RUNAHEAD_LAG_FRAMES_DETECTED,
+   MSG_RUNAHEAD_LAG_FRAMES_NOT_DETECTED,
    MSG_MISSING_ASSETS,
    MSG_RGUI_MISSING_FONTS,
    MSG_RGUI_INVALID_LANGUAGE,
@@ -698,6 +707,9 @@ enum msg_hash_enums
    MENU_ENUM_LABEL_VALUE_INPUT_POLL_TYPE_BEHAVIOR_LATE,
    MENU_ENUM_LABEL_VALUE_INPUT_POLL_TYPE_BEHAVIOR_NORMAL,
    MENU_ENUM_LABEL_VALUE_INPUT_POLL_TYPE_BEHAVIOR_EARLY,
+   MENU_ENUM_LABEL_VALUE_THREAD_PRIORITY_PROFILE_DEFAULT,
+   MENU_ENUM_LABEL_VALUE_THREAD_PRIORITY_PROFILE_EMULATION,
+   MENU_ENUM_LABEL_VALUE_THREAD_PRIORITY_PROFILE_REALTIME_AUDIO,
    MENU_ENUM_LABEL_PLAYLIST_COLLECTION_ENTRY,
 
    MENU_LABEL(CHEEVOS_UNLOCKED_ENTRY),
@@ -884,6 +896,7 @@ enum msg_hash_enums
    MENU_ENUM_LABEL_VALUE_INPUT_META_STREAMING_TOGGLE,
    MENU_ENUM_LABEL_VALUE_INPUT_META_RUNAHEAD_TOGGLE,
    MENU_ENUM_LABEL_VALUE_INPUT_META_AI_SERVICE,
+   MENU_ENUM_LABEL_VALUE_INPUT_META_INSTANT_REPLAY_SAVE,
    MENU_ENUM_LABEL_VALUE_INPUT_META_MENU_TOGGLE,
 
    MENU_ENUM_LABEL_VALUE_INPUT_DEVICE_INDEX,
@@ -941,6 +954,7 @@ enum msg_hash_enums
    MENU_ENUM_SUBLABEL_INPUT_META_STREAMING_TOGGLE,
    MENU_ENUM_SUBLABEL_INPUT_META_RUNAHEAD_TOGGLE,
    MENU_ENUM_SUBLABEL_INPUT_META_AI_SERVICE,
+   MENU_ENUM_SUBLABEL_INPUT_META_INSTANT_REPLAY_SAVE,
    MENU_ENUM_SUBLABEL_INPUT_META_MENU_TOGGLE,
 
    MENU_ENUM_LABEL_INPUT_DESCRIPTION,
@@ -1005,6 +1019,9 @@ enum msg_hash_enums
    MENU_LABEL(INPUT_ICADE_ENABLE),
    MENU_LABEL(INPUT_ALL_USERS_CONTROL_MENU),
    MENU_LABEL(INPUT_POLL_TYPE_BEHAVIOR),
+   MENU_LABEL(THREAD_PRIORITY_PROFILE),
+   MENU_LABEL(THREAD_AFFINITY_FAST_CORES),
+   MENU_LABEL(STATE_BUFFERS_LOCKED),
    MENU_LABEL(INPUT_UNIFIED_MENU_CONTROLS),
 
    MENU_LABEL(QUIT_PRESS_TWICE),
@@ -1043,9 +1060,12 @@ enum msg_hash_enums
    MENU_LABEL(VIDEO_FILTER_FLICKER),
    MENU_LABEL(VIDEO_SOFT_FILTER),
    MENU_LABEL(VIDEO_MAX_SWAPCHAIN_IMAGES),
+   MENU_LABEL(VIDEO_GPU_MEMORY_BUDGET),
    MENU_LABEL(VIDEO_GPU_SCREENSHOT),
    MENU_LABEL(VIDEO_BLACK_FRAME_INSERTION),
    MENU_LABEL(VIDEO_FRAME_DELAY),
+   MENU_LABEL(VIDEO_FRAME_DELAY_AUTO),
+   MENU_LABEL(VIDEO_LATENCY_TEST),
    MENU_LABEL(VIDEO_SHADER_DELAY),
    MENU_LABEL(VIDEO_VSYNC),
    MENU_LABEL(VIDEO_ADAPTIVE_VSYNC),
@@ -1064,6 +1084,8 @@ enum msg_hash_enums
    MENU_LABEL(SCREEN_ORIENTATION),
    MENU_LABEL(VIDEO_SCALE),
    MENU_LABEL(VIDEO_RECORD_THREADS),
+   MENU_LABEL(INSTANT_REPLAY_LENGTH),
+   MENU_LABEL(STREAMING_RECORD_COPY),
    MENU_LABEL(VIDEO_SMOOTH),
    MENU_LABEL(VIDEO_CTX_SCALING),
 #ifdef HAVE_ODROIDGO2
@@ -1331,6 +1353,7 @@ enum msg_hash_enums
    MENU_LABEL(SET_CORE_ASSOCIATION),
    MENU_LABEL(RESET_CORE_ASSOCIATION),
    MENU_LABEL(MENU_THROTTLE_FRAMERATE),
+   MENU_LABEL(MENU_SKIP_IDLE_FRAMES),
 
    MENU_LABEL(NO_ACHIEVEMENTS_TO_DISPLAY),
    MENU_LABEL(NOT_LOGGED_IN),
@@ -1671,6 +1694,7 @@ enum msg_hash_enums
    MENU_LABEL(PAUSE_LIBRETRO),
    MENU_LABEL(MENU_SAVESTATE_RESUME),
    MENU_LABEL(MENU_INSERT_DISK_RESUME),
+   MENU_LABEL(MENU_DEFER_INIT),
    MENU_LABEL(DIRECTORY_NOT_FOUND),
    MENU_LABEL(NO_ITEMS),
    MENU_LABEL(NO_PLAYLISTS),
@@ -1709,6 +1733,7 @@ enum msg_hash_enums
    MENU_LABEL(AUDIO_VOLUME),
    MENU_LABEL(AUDIO_MIXER_VOLUME),
    MENU_LABEL(AUDIO_RATE_CONTROL_DELTA),
+   MENU_LABEL(AUDIO_RATE_CONTROL_ADAPTIVE),
    MENU_LABEL(AUDIO_LATENCY),
    MENU_LABEL(AUDIO_RESAMPLER_QUALITY),
    MENU_LABEL(AUDIO_WASAPI_EXCLUSIVE_MODE),
@@ -1719,6 +1744,7 @@ enum msg_hash_enums
    MENU_LABEL(LOAD_STATE),
    MENU_LABEL(UNDO_LOAD_STATE),
    MENU_LABEL(UNDO_SAVE_STATE),
+   MENU_LABEL(MOVIE_SEEK),
 
    MENU_LABEL(NETPLAY_GAME_WATCH),
    MENU_LABEL(CHEAT_INDEX_MINUS),
@@ -1768,6 +1794,7 @@ enum msg_hash_enums
    MENU_LABEL(SCREENSHOT),
    MENU_LABEL(REWIND),
    MENU_LABEL(REWIND_GRANULARITY),
+   MENU_LABEL(REWIND_CHECKPOINT_INTERVAL),
    MENU_LABEL(REWIND_BUFFER_SIZE),
    MENU_LABEL(REWIND_BUFFER_SIZE_STEP),
    /* TODO/FIXME: INPUT_META_REWIND is incorrectly defined;
@@ -1838,6 +1865,7 @@ enum msg_hash_enums
    MENU_LABEL(SCREEN_RESOLUTION),
    MENU_LABEL(SAVESTATE_AUTO_INDEX),
    MENU_LABEL(SAVESTATE_MAX_KEEP),
+   MENU_LABEL(SAVESTATE_CACHE_SLOTS),
    MENU_LABEL(SAVESTATE_AUTO_SAVE),
    MENU_LABEL(SAVESTATE_AUTO_LOAD),
    MENU_LABEL(SAVESTATE_THUMBNAIL_ENABLE),
@@ -1925,6 +1953,7 @@ enum msg_hash_enums
    MENU_LABEL(OVERLAY_CENTER_Y),
 
    MENU_LABEL(FASTFORWARD_RATIO),
+   MENU_LABEL(FASTFORWARD_FRAMESKIP),
    MENU_LABEL(VRR_RUNLOOP_ENABLE),
    MENU_LABEL(REWIND_ENABLE),
    MENU_LABEL(CHEAT_APPLY_AFTER_TOGGLE),
@@ -1985,6 +2014,7 @@ enum msg_hash_enums
    MENU_LABEL(RUN_AHEAD_SECONDARY_INSTANCE),
    MENU_LABEL(RUN_AHEAD_HIDE_WARNINGS),
    MENU_LABEL(RUN_AHEAD_FRAMES),
+   MENU_LABEL(RUN_AHEAD_AUTO_DETECT),
    MENU_LABEL(INPUT_BLOCK_TIMEOUT),
    MENU_LABEL(TURBO),
 
@@ -2489,6 +2519,7 @@ enum msg_hash_enums
 #endif
    MENU_LABEL(VIDEO_VFILTER),
    MENU_LABEL(VIDEO_GPU_RECORD),
+   MENU_LABEL(VIDEO_FRAME_EXPORT),
    MENU_LABEL(RECORD_USE_OUTPUT_DIRECTORY),
    MENU_LABEL(RECORD_CONFIG),
    MENU_LABEL(STREAM_CONFIG),
@@ -3000,6 +3031,7 @@ enum msg_hash_enums
    MENU_ENUM_LABEL_VALUE_CPU_PERF_MODE_MIN_POWER,
    MENU_ENUM_LABEL_VALUE_CPU_PERF_MODE_BALANCED,
    MENU_ENUM_LABEL_VALUE_CPU_PERF_MODE_MANUAL,
+   MENU_ENUM_LABEL_VALUE_CPU_PERF_MODE_MANAGED_FRAME_TIME,
 
    MENU_ENUM_SUBLABEL_VALUE_CPU_PERF_MODE_MANAGED_PERF,
    MENU_ENUM_SUBLABEL_VALUE_CPU_PERF_MODE_MANAGED_PER_CONTEXT,
@@ -3007,6 +3039,7 @@ enum msg_hash_enums
    MENU_ENUM_SUBLABEL_VALUE_CPU_PERF_MODE_MIN_POWER,
    MENU_ENUM_SUBLABEL_VALUE_CPU_PERF_MODE_BALANCED,
    MENU_ENUM_SUBLABEL_VALUE_CPU_PERF_MODE_MANUAL,
+   MENU_ENUM_SUBLABEL_VALUE_CPU_PERF_MODE_MANAGED_FRAME_TIME,
 
    MENU_ENUM_LABEL_CHEAT_HANDLER_TYPE_EMU,
    MENU_ENUM_LABEL_CHEAT_HANDLER_TYPE_RETRO,
@@ -3139,6 +3172,7 @@ enum msg_hash_enums
    MENU_LABEL(PLAYLIST_SHOW_SUBLABELS),
    MENU_LABEL(PLAYLIST_SHOW_ENTRY_IDX),
    MENU_LABEL(PLAYLIST_FUZZY_ARCHIVE_MATCH),
+   MENU_LABEL(PLAYLIST_PREFETCH),
    MENU_LABEL(PLAYLIST_SUBLABEL_RUNTIME_TYPE),
    MENU_LABEL(PLAYLIST_SUBLABEL_LAST_PLAYED_STYLE),
    MENU_LABEL(PLAYLIST_PORTABLE_PATHS),
@@ -104,4 +104,10 @@ extern int netplay_room_count;
 
 struct netplay_room* netplay_get_host_room(void);
 
+/* Parses a lobby room list into a new array of *rooms, which
+ * the caller frees. Returns the number of rooms. Unlike
+ * netplay_rooms_parse(), this keeps no global state, so it
+ * may run on a task thread */
+int netplay_rooms_parse_array(const char *buf, struct netplay_room **rooms);
+
 #endif
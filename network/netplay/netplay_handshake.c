@@ -235,7 +235,9 @@ bool netplay_handshake_init_send(netplay_t *netplay,
 
    header[0] = htonl(NETPLAY_MAGIC);
    header[1] = htonl(netplay_platform_magic());
-   header[2] = htonl(NETPLAY_COMPRESSION_SUPPORTED);
+   header[2] = htonl(NETPLAY_COMPRESSION_SUPPORTED |
+         (settings->bools.netplay_udp_input ?
+          NETPLAY_COMPRESSION_SUPPORTED_UDP_INPUT : 0));
    header[3] = 0;
    header[4] = htonl(NETPLAY_PROTOCOL_VERSION);
    header[5] = htonl(netplay_impl_magic());
@@ -367,8 +369,18 @@ bool netplay_handshake_init(netplay_t *netplay,
 
    /* Check what compression is supported */
    compression  = ntohl(header[2]);
+
+   /* Not compression, and not masked like it: whether we use it too is up
+    * to our own settings */
+   connection->udp_supported = !!(compression &
+         NETPLAY_COMPRESSION_SUPPORTED_UDP_INPUT);
+
    compression &= NETPLAY_COMPRESSION_SUPPORTED;
 
+   /* The delta format is native endian */
+   connection->delta_supported = (compression & NETPLAY_COMPRESSION_DELTA) &&
+      !netplay_endian_mismatch(local_pmagic, remote_pmagic);
+
    if (compression & NETPLAY_COMPRESSION_ZLIB)
    {
       ctrans = &netplay->compress_zlib;
@@ -674,6 +686,23 @@ static bool netplay_handshake_sync(netplay_t *netplay,
    autosave_unlock();
 #endif
 
+   /* Let them send their input over UDP too */
+   if (connection->udp_supported && netplay->udp_fd >= 0)
+   {
+      uint32_t token;
+
+      if (simple_rand_next == 1)
+         simple_srand((unsigned int) time(NULL));
+      connection->udp_token = simple_rand_uint32();
+      if (connection->udp_token == 0)
+         connection->udp_token = 1;
+
+      token = htonl(connection->udp_token);
+      if (!netplay_send_raw_cmd(netplay, connection, NETPLAY_CMD_UDP_TOKEN,
+               &token, sizeof(token)))
+         return false;
+   }
+
    /* Now we're ready! */
    connection->mode = NETPLAY_CONNECTION_SPECTATING;
    netplay_handshake_ready(netplay, connection);
@@ -35,6 +35,9 @@
 
 #include "../../autosave.h"
 #include "../../configuration.h"
+#ifdef HAVE_REWIND
+#include "../../state_manager.h"
+#endif
 #include "../../driver.h"
 #include "../../retroarch.h"
 #include "../../command.h"
@@ -1512,6 +1515,8 @@ void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
        netplay->replay_frame_count < netplay->run_frame_count)
    {
       retro_ctx_serialize_info_t serial_info;
+      retro_time_t replay_start       = cpu_features_get_time_usec();
+      uint32_t replay_start_frame     = netplay->replay_frame_count;
 
       /* Replay frames. */
       netplay->is_replay = true;
@@ -1605,6 +1610,8 @@ void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
 
       /* Average our time */
       netplay->frame_run_time_avg   = netplay->frame_run_time_sum / NETPLAY_FRAME_RUN_TIME_WINDOW;
+      netplay->replay_frames_last   = netplay->run_frame_count - replay_start_frame;
+      netplay->replay_time_last     = cpu_features_get_time_usec() - replay_start;
 
       if (netplay->unread_frame_count < netplay->run_frame_count)
       {
@@ -1825,10 +1832,19 @@ void netplay_hangup(netplay_t *netplay,
    runloop_msg_queue_push(dmsg, 1, 180, false, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
 
    socket_close(connection->fd);
-   connection->active = false;
+   connection->active       = false;
+   connection->udp_token    = 0;
+   connection->udp_addr_len = 0;
    netplay_deinit_socket_buffer(&connection->send_packet_buffer);
    netplay_deinit_socket_buffer(&connection->recv_packet_buffer);
 
+   if (connection->delta_send_state)
+      free(connection->delta_send_state);
+   if (connection->delta_recv_state)
+      free(connection->delta_recv_state);
+   connection->delta_send_state = NULL;
+   connection->delta_recv_state = NULL;
+
    if (!netplay->is_server)
    {
       netplay->self_mode = NETPLAY_CONNECTION_NONE;
@@ -1914,13 +1930,25 @@ void netplay_delayed_state_change(netplay_t *netplay)
    }
 }
 
-/* Send the specified input data */
-static bool send_input_frame(netplay_t *netplay, struct delta_frame *dframe,
-      struct netplay_connection *only, struct netplay_connection *except,
-      uint32_t client_num, bool slave)
+/* Longest NETPLAY_CMD_INPUT we send, in words */
+#define NETPLAY_INPUT_CMD_WORDS 16 /* FIXME: Arbitrary restriction */
+
+/* The NETPLAY_CMD_INPUT of every client for the current frame, encoded once
+ * however many connections it's then sent to */
+struct netplay_cur_input
+{
+   uint32_t cmd[MAX_CLIENTS][NETPLAY_INPUT_CMD_WORDS];
+   /* 0 if we don't have that client's input */
+   size_t words[MAX_CLIENTS];
+};
+
+/* Encode the specified input data as a NETPLAY_CMD_INPUT, returns its size
+ * in words */
+static size_t encode_input_frame(netplay_t *netplay, struct delta_frame *dframe,
+      uint32_t client_num, bool slave, uint32_t *buffer)
 {
-#define BUFSZ 16 /* FIXME: Arbitrary restriction */
-   uint32_t buffer[BUFSZ], devices, device;
+#define BUFSZ NETPLAY_INPUT_CMD_WORDS
+   uint32_t devices, device;
    size_t bufused, i;
 
    /* Set up the basic buffer */
@@ -1949,6 +1977,20 @@ static bool send_input_frame(netplay_t *netplay, struct delta_frame *dframe,
    }
    buffer[1] = htonl((bufused-2) * sizeof(uint32_t));
 
+   return bufused;
+#undef BUFSZ
+}
+
+/* Send the specified input data */
+static bool send_input_frame(netplay_t *netplay, struct delta_frame *dframe,
+      struct netplay_connection *only, struct netplay_connection *except,
+      uint32_t client_num, bool slave)
+{
+   uint32_t buffer[NETPLAY_INPUT_CMD_WORDS];
+   size_t bufused = encode_input_frame(netplay, dframe, client_num, slave,
+         buffer);
+   size_t i;
+
 #ifdef DEBUG_NETPLAY_STEPS
    RARCH_LOG("[netplay] Sending input for client %u\n", (unsigned) client_num);
    print_state(netplay);
@@ -1982,41 +2024,221 @@ static bool send_input_frame(netplay_t *netplay, struct delta_frame *dframe,
    }
 
    return true;
-#undef BUFSZ
 }
 
 /**
- * netplay_send_cur_input
+ * netplay_init_udp
  *
- * Send the current input frame to a given connection.
+ * Open the UDP socket we send input over ahead of TCP. The server binds it to
+ * the address (and port) of its listening socket, a client connects it to the
+ * server it's talking to over TCP. Failing is not an error, input then just
+ * only goes over TCP.
+ */
+static void netplay_init_udp(netplay_t *netplay, int tcp_fd)
+{
+#ifndef HAVE_SOCKET_LEGACY
+   struct sockaddr_storage addr;
+   socklen_t addr_len = sizeof(addr);
+   int fd;
+
+   if (netplay->is_server)
+   {
+      if (getsockname(tcp_fd, (struct sockaddr*)&addr, &addr_len) < 0)
+         return;
+   }
+   else if (getpeername(tcp_fd, (struct sockaddr*)&addr, &addr_len) < 0)
+      return;
+
+   fd = socket(addr.ss_family, SOCK_DGRAM, 0);
+   if (fd < 0)
+      return;
+
+#if defined(HAVE_INET6) && defined(IPPROTO_IPV6) && defined(IPV6_V6ONLY)
+   /* Take datagrams from IPv4 clients too, like the TCP socket */
+   if (netplay->is_server && addr.ss_family == AF_INET6)
+   {
+      int on = 0;
+      setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, (const char*)&on, sizeof(on));
+   }
+#endif
+
+   if (netplay->is_server)
+   {
+      if (bind(fd, (struct sockaddr*)&addr, addr_len) < 0)
+         goto error;
+   }
+   else if (connect(fd, (struct sockaddr*)&addr, addr_len) < 0)
+      goto error;
+
+   if (!socket_nonblock(fd))
+      goto error;
+
+   netplay->udp_fd = fd;
+   return;
+
+error:
+   RARCH_WARN("[netplay] Could not set up UDP input, using only TCP.\n");
+   socket_close(fd);
+#endif
+}
+
+/**
+ * netplay_send_udp_input
+ *
+ * Send our input of the last NETPLAY_UDP_INPUT_FRAMES frames to the given
+ * connection over UDP, if it takes it. Every datagram repeats the frames of
+ * the ones before it, so a lost datagram costs nothing as long as a later one
+ * arrives, and our input never waits behind a lost TCP segment. It still goes
+ * over TCP as well, so nothing depends on the datagrams arriving.
+ *
+ * The datagram is the token, the frame count, then for each frame (oldest
+ * first) the frame number, our client number, our devices and their input.
+ */
+static void netplay_send_udp_input(netplay_t *netplay,
+      struct netplay_connection *connection)
+{
+   uint32_t buffer[2 + NETPLAY_UDP_INPUT_FRAMES * (3 + NETPLAY_UDP_INPUT_WORDS)];
+   size_t bufused      = 2;
+   uint32_t frames     = 0;
+   uint32_t client_num = netplay->self_client_num;
+   uint32_t devices    = netplay->client_devices[client_num];
+   uint32_t input_size = netplay_expected_input_size(netplay, devices);
+   int i;
+
+   if (netplay->udp_fd < 0 || !connection->udp_token)
+      return;
+
+   /* We only know where to send to once the client sent us something */
+   if (netplay->is_server && !connection->udp_addr_len)
+      return;
+
+   if (     netplay->self_mode == NETPLAY_CONNECTION_PLAYING
+         && input_size <= NETPLAY_UDP_INPUT_WORDS)
+   {
+      for (i = NETPLAY_UDP_INPUT_FRAMES - 1; i >= 0; i--)
+      {
+         struct delta_frame *dframe;
+         uint32_t device;
+         size_t start;
+
+         if (     (uint32_t)i > netplay->self_frame_count
+               || (size_t)i >= netplay->buffer_size)
+            continue;
+
+         dframe = &netplay->buffer[(netplay->self_ptr
+               + netplay->buffer_size - i) % netplay->buffer_size];
+         if (     !dframe->used
+               || dframe->frame != netplay->self_frame_count - i
+               || !dframe->have_real[client_num])
+            continue;
+
+         start            = bufused;
+         buffer[bufused++] = htonl(dframe->frame);
+         buffer[bufused++] = htonl(client_num);
+         buffer[bufused++] = htonl(devices);
+
+         for (device = 0; device < MAX_INPUT_DEVICES; device++)
+         {
+            netplay_input_state_t istate;
+            uint32_t di;
+
+            if (!(devices & (1<<device)))
+               continue;
+            istate = dframe->real_input[device];
+            while (istate && (!istate->used || istate->client_num != client_num))
+               istate = istate->next;
+            if (!istate)
+               break;
+            for (di = 0; di < istate->size; di++)
+               buffer[bufused++] = htonl(istate->data[di]);
+         }
+
+         /* Only ever send whole frames */
+         if (bufused - start != 3 + input_size)
+         {
+            bufused = start;
+            continue;
+         }
+
+         frames++;
+      }
+   }
+
+   /* The server has nothing to say without input, but a client keeps
+    * sending so that the server learns (and keeps) its address */
+   if (netplay->is_server && !frames)
+      return;
+
+   buffer[0] = htonl(connection->udp_token);
+   buffer[1] = htonl(frames);
+
+   if (netplay->is_server)
+      sendto(netplay->udp_fd, (const char*)buffer, bufused * sizeof(uint32_t),
+            0, (struct sockaddr*)&connection->udp_addr,
+            connection->udp_addr_len);
+   else
+      send(netplay->udp_fd, (const char*)buffer, bufused * sizeof(uint32_t), 0);
+}
+
+/**
+ * encode_cur_input
+ *
+ * Encode the current input frame of every client we'd send it of.
+ */
+static void encode_cur_input(netplay_t *netplay, struct netplay_cur_input *cur)
+{
+   uint32_t from_client;
+   struct delta_frame *dframe = &netplay->buffer[netplay->self_ptr];
+
+   memset(cur->words, 0, sizeof(cur->words));
+
+   /* The other players' input data */
+   if (netplay->is_server)
+   {
+      for (from_client = 1; from_client < MAX_CLIENTS; from_client++)
+      {
+         if ((netplay->connected_players & (1<<from_client)) &&
+               dframe->have_real[from_client])
+            cur->words[from_client] = encode_input_frame(netplay, dframe,
+                  from_client, false, cur->cmd[from_client]);
+      }
+   }
+
+   /* And our own */
+   if (netplay->self_mode == NETPLAY_CONNECTION_PLAYING
+         || netplay->self_mode == NETPLAY_CONNECTION_SLAVE)
+      cur->words[netplay->self_client_num] = encode_input_frame(netplay,
+            dframe, netplay->self_client_num,
+            netplay->self_mode == NETPLAY_CONNECTION_SLAVE,
+            cur->cmd[netplay->self_client_num]);
+}
+
+/**
+ * send_cur_input
+ *
+ * Send the encoded current input frame to a given connection.
  *
  * Returns true if successful, false otherwise.
  */
-bool netplay_send_cur_input(netplay_t *netplay,
-   struct netplay_connection *connection)
+static bool send_cur_input(netplay_t *netplay,
+   struct netplay_connection *connection, const struct netplay_cur_input *cur)
 {
    uint32_t from_client, to_client;
-   struct delta_frame *dframe = &netplay->buffer[netplay->self_ptr];
 
    if (netplay->is_server)
    {
       to_client = (uint32_t)(connection - netplay->connections + 1);
 
-      /* Send the other players' input data (FIXME: This involves an
-       * unacceptable amount of recalculating) */
+      /* Send the other players' input data */
       for (from_client = 1; from_client < MAX_CLIENTS; from_client++)
       {
-         if (from_client == to_client)
+         if (from_client == to_client || !cur->words[from_client])
             continue;
 
-         if ((netplay->connected_players & (1<<from_client)))
-         {
-            if (dframe->have_real[from_client])
-            {
-               if (!send_input_frame(netplay, dframe, connection, NULL, from_client, false))
-                  return false;
-            }
-         }
+         if (!netplay_send(&connection->send_packet_buffer, connection->fd,
+                  cur->cmd[from_client],
+                  cur->words[from_client] * sizeof(uint32_t)))
+            return false;
       }
 
       /* If we're not playing, send a NOINPUT */
@@ -2031,15 +2253,16 @@ bool netplay_send_cur_input(netplay_t *netplay,
    }
 
    /* Send our own data */
-   if (netplay->self_mode == NETPLAY_CONNECTION_PLAYING
-         || netplay->self_mode == NETPLAY_CONNECTION_SLAVE)
+   if (cur->words[netplay->self_client_num])
    {
-      if (!send_input_frame(netplay, dframe, connection, NULL,
-            netplay->self_client_num,
-            netplay->self_mode == NETPLAY_CONNECTION_SLAVE))
+      if (!netplay_send(&connection->send_packet_buffer, connection->fd,
+               cur->cmd[netplay->self_client_num],
+               cur->words[netplay->self_client_num] * sizeof(uint32_t)))
          return false;
    }
 
+   netplay_send_udp_input(netplay, connection);
+
    if (!netplay_send_flush(&connection->send_packet_buffer, connection->fd,
          false))
       return false;
@@ -2047,6 +2270,45 @@ bool netplay_send_cur_input(netplay_t *netplay,
    return true;
 }
 
+/**
+ * netplay_send_cur_input
+ *
+ * Send the current input frame to a given connection.
+ *
+ * Returns true if successful, false otherwise.
+ */
+bool netplay_send_cur_input(netplay_t *netplay,
+   struct netplay_connection *connection)
+{
+   struct netplay_cur_input cur;
+
+   encode_cur_input(netplay, &cur);
+
+   return send_cur_input(netplay, connection, &cur);
+}
+
+/**
+ * netplay_send_cur_input_all
+ *
+ * Send the current input frame to every connected peer. It's encoded only
+ * once, however many peers (spectators, mostly) there are.
+ */
+void netplay_send_cur_input_all(netplay_t *netplay)
+{
+   struct netplay_cur_input cur;
+   size_t i;
+
+   encode_cur_input(netplay, &cur);
+
+   for (i = 0; i < netplay->connections_size; i++)
+   {
+      struct netplay_connection *connection = &netplay->connections[i];
+      if (connection->active && connection->mode >= NETPLAY_CONNECTION_CONNECTED &&
+            !send_cur_input(netplay, connection, &cur))
+         netplay_hangup(netplay, connection);
+   }
+}
+
 /**
  * netplay_send_raw_cmd
  *
@@ -2585,6 +2847,42 @@ static void handle_play_spectate(netplay_t *netplay, uint32_t client_num,
    }
 }
 
+/**
+ * netplay_input_received
+ *
+ * Account for the real input of client_num in dframe, the next frame we were
+ * waiting for, having arrived over the given connection.
+ */
+static void netplay_input_received(netplay_t *netplay,
+      struct netplay_connection *connection, struct delta_frame *dframe,
+      uint32_t client_num)
+{
+   dframe->have_real[client_num] = true;
+
+   /* Slaves may go through several packets of data in the same frame
+    * if latency is choppy, so we advance and send their data after
+    * handling all network data this frame */
+   if (connection->mode == NETPLAY_CONNECTION_PLAYING)
+   {
+      netplay->read_ptr[client_num] = NEXT_PTR(netplay->read_ptr[client_num]);
+      netplay->read_frame_count[client_num]++;
+
+      if (netplay->is_server)
+      {
+         /* Forward it on if it's past data */
+         if (dframe->frame <= netplay->self_frame_count)
+            send_input_frame(netplay, dframe, NULL, connection, client_num, false);
+      }
+   }
+
+   /* If this was server data, advance our server pointer too */
+   if (!netplay->is_server && client_num == 0)
+   {
+      netplay->server_ptr = netplay->read_ptr[0];
+      netplay->server_frame_count = netplay->read_frame_count[0];
+   }
+}
+
 #undef RECV
 #define RECV(buf, sz) \
 recvd = netplay_recv(&connection->recv_packet_buffer, connection->fd, (buf), \
@@ -2736,30 +3034,8 @@ static bool netplay_get_cmd(netplay_t *netplay,
                for (di = 0; di < dsize; di++)
                   istate->data[di] = ntohl(istate->data[di]);
             }
-            dframe->have_real[client_num] = true;
 
-            /* Slaves may go through several packets of data in the same frame
-             * if latency is choppy, so we advance and send their data after
-             * handling all network data this frame */
-            if (connection->mode == NETPLAY_CONNECTION_PLAYING)
-            {
-               netplay->read_ptr[client_num] = NEXT_PTR(netplay->read_ptr[client_num]);
-               netplay->read_frame_count[client_num]++;
-
-               if (netplay->is_server)
-               {
-                  /* Forward it on if it's past data */
-                  if (dframe->frame <= netplay->self_frame_count)
-                     send_input_frame(netplay, dframe, NULL, connection, client_num, false);
-               }
-            }
-
-            /* If this was server data, advance our server pointer too */
-            if (!netplay->is_server && client_num == 0)
-            {
-               netplay->server_ptr = netplay->read_ptr[0];
-               netplay->server_frame_count = netplay->read_frame_count[0];
-            }
+            netplay_input_received(netplay, connection, dframe, client_num);
 
 #ifdef DEBUG_NETPLAY_STEPS
             RARCH_LOG("[netplay] Received input from %u\n", client_num);
@@ -3246,6 +3522,7 @@ static bool netplay_get_cmd(netplay_t *netplay,
          break;
 
       case NETPLAY_CMD_LOAD_SAVESTATE:
+      case NETPLAY_CMD_LOAD_SAVESTATE_DELTA:
       case NETPLAY_CMD_RESET:
          {
             uint32_t frame;
@@ -3300,8 +3577,18 @@ static bool netplay_get_cmd(netplay_t *netplay,
              * gets loaded. This is just to avoid having reloading implemented in
              * too many places. */
 
+            /* We can only apply a delta to a savestate we've received */
+            if (cmd == NETPLAY_CMD_LOAD_SAVESTATE_DELTA &&
+                (!connection->delta_supported ||
+                 !connection->delta_recv_state ||
+                 !netplay->delta_patch))
+            {
+               RARCH_ERR("CMD_LOAD_SAVESTATE_DELTA received without a savestate to apply it to.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
             /* Check the payload size */
-            if ((cmd == NETPLAY_CMD_LOAD_SAVESTATE &&
+            if ((cmd != NETPLAY_CMD_RESET &&
                  (cmd_size < 2*sizeof(uint32_t) || cmd_size > netplay->zbuffer_size + 2*sizeof(uint32_t))) ||
                 (cmd == NETPLAY_CMD_RESET && cmd_size != sizeof(uint32_t)))
             {
@@ -3340,7 +3627,7 @@ static bool netplay_get_cmd(netplay_t *netplay,
             }
 
             /* Now we switch based on whether we're loading a state or resetting */
-            if (cmd == NETPLAY_CMD_LOAD_SAVESTATE)
+            if (cmd != NETPLAY_CMD_RESET)
             {
                RECV(&isize, sizeof(isize))
                {
@@ -3372,11 +3659,50 @@ static bool netplay_get_cmd(netplay_t *netplay,
                }
                ctrans->decompression_backend->set_in(ctrans->decompression_stream,
                   netplay->zbuffer, cmd_size - 2*sizeof(uint32_t));
-               ctrans->decompression_backend->set_out(ctrans->decompression_stream,
-                  (uint8_t*)netplay->buffer[load_ptr].state,
-                  (unsigned)netplay->state_size);
-               ctrans->decompression_backend->trans(ctrans->decompression_stream,
-                  true, &rd, &wn, NULL);
+
+#ifdef HAVE_REWIND
+               if (cmd == NETPLAY_CMD_LOAD_SAVESTATE_DELTA)
+               {
+                  /* Decompress the patch and apply it to the last
+                   * savestate received from this peer */
+                  ctrans->decompression_backend->set_out(ctrans->decompression_stream,
+                     netplay->delta_patch, (uint32_t)netplay->delta_patch_size);
+                  ctrans->decompression_backend->trans(ctrans->decompression_stream,
+                     true, &rd, &wn, NULL);
+
+                  if (!state_manager_raw_decompress_checked(netplay->delta_patch,
+                        wn, connection->delta_recv_state,
+                        (netplay->state_size + 1) & ~(size_t)1))
+                  {
+                     RARCH_ERR("CMD_LOAD_SAVESTATE_DELTA received an invalid delta.\n");
+                     return netplay_cmd_nak(netplay, connection);
+                  }
+
+                  memcpy(netplay->buffer[load_ptr].state,
+                     connection->delta_recv_state, netplay->state_size);
+               }
+               else
+#endif
+               {
+                  ctrans->decompression_backend->set_out(ctrans->decompression_stream,
+                     (uint8_t*)netplay->buffer[load_ptr].state,
+                     (unsigned)netplay->state_size);
+                  ctrans->decompression_backend->trans(ctrans->decompression_stream,
+                     true, &rd, &wn, NULL);
+
+#ifdef HAVE_REWIND
+                  /* Keep it around for the next delta */
+                  if (connection->delta_supported)
+                  {
+                     if (!connection->delta_recv_state)
+                        connection->delta_recv_state = (uint8_t*)
+                           state_manager_raw_alloc(netplay->state_size, 0);
+                     if (connection->delta_recv_state)
+                        memcpy(connection->delta_recv_state,
+                           netplay->buffer[load_ptr].state, netplay->state_size);
+                  }
+#endif
+               }
 
                /* Force a rewind to the relevant frame */
                netplay->force_rewind = true;
@@ -3516,6 +3842,34 @@ static bool netplay_get_cmd(netplay_t *netplay,
             break;
          }
 
+      case NETPLAY_CMD_UDP_TOKEN:
+         {
+            uint32_t token;
+
+            if (netplay->is_server)
+            {
+               RARCH_ERR("Netplay client sent a UDP token?\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            if (cmd_size != sizeof(uint32_t))
+            {
+               RARCH_ERR("NETPLAY_CMD_UDP_TOKEN with incorrect payload size.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            RECV(&token, sizeof(token))
+               return false;
+
+            connection->udp_token = ntohl(token);
+
+            if (netplay->udp_fd < 0)
+               netplay_init_udp(netplay, connection->fd);
+            if (netplay->udp_fd >= 0)
+               RARCH_LOG("[netplay] Sending input over UDP as well.\n");
+            break;
+         }
+
       default:
          RARCH_ERR("%s.\n", msg_hash_to_str(MSG_UNKNOWN_NETPLAY_COMMAND_RECEIVED));
          return netplay_cmd_nak(netplay, connection);
@@ -3535,6 +3889,117 @@ shrt:
 #undef RECV
 }
 
+/**
+ * netplay_recv_udp_input
+ *
+ * Take in whatever input arrived over UDP. Only the next frame we're waiting
+ * for of each client is ever taken, anything older (or already received over
+ * TCP) is skipped, and the TCP copy of whatever we do take is dropped when it
+ * arrives. Bad datagrams are silently ignored, they may be anyone's.
+ */
+static void netplay_recv_udp_input(netplay_t *netplay, bool *had_input)
+{
+   uint32_t buffer[2 + NETPLAY_UDP_INPUT_FRAMES * (3 + NETPLAY_UDP_INPUT_WORDS)];
+
+   for (;;)
+   {
+      struct sockaddr_storage addr;
+      socklen_t addr_len                    = sizeof(addr);
+      struct netplay_connection *connection = NULL;
+      size_t words, pos                     = 2;
+      uint32_t token, frames;
+      ssize_t recvd;
+      size_t i;
+
+      recvd = recvfrom(netplay->udp_fd, (char*)buffer, sizeof(buffer), 0,
+            (struct sockaddr*)&addr, &addr_len);
+      if (recvd < 0)
+         break;
+      if (recvd < (ssize_t)(2 * sizeof(uint32_t)))
+         continue;
+
+      words  = (size_t)recvd / sizeof(uint32_t);
+      token  = ntohl(buffer[0]);
+      frames = ntohl(buffer[1]);
+
+      if (!token)
+         continue;
+
+      for (i = 0; i < netplay->connections_size; i++)
+      {
+         if (     netplay->connections[i].active
+               && netplay->connections[i].udp_token == token)
+         {
+            connection = &netplay->connections[i];
+            break;
+         }
+      }
+      if (!connection)
+         continue;
+
+      /* This is where we send our own input to, from now on */
+      if (netplay->is_server && addr_len <= sizeof(connection->udp_addr))
+      {
+         memcpy(&connection->udp_addr, &addr, addr_len);
+         connection->udp_addr_len = addr_len;
+      }
+
+      if (connection->mode != NETPLAY_CONNECTION_PLAYING)
+         continue;
+
+      for (; frames && pos + 3 <= words; frames--)
+      {
+         struct delta_frame *dframe;
+         uint32_t frame_num  = ntohl(buffer[pos]);
+         uint32_t client_num = ntohl(buffer[pos + 1]);
+         uint32_t devices    = ntohl(buffer[pos + 2]);
+         uint32_t input_size = netplay_expected_input_size(netplay, devices);
+         uint32_t device;
+         size_t ipos         = pos + 3;
+
+         if (ipos + input_size > words)
+            break;
+         pos = ipos + input_size;
+
+         /* On the server, it can only be the client's own input */
+         if (netplay->is_server)
+            client_num = (uint32_t)(connection - netplay->connections + 1);
+
+         if (     client_num >= MAX_CLIENTS
+               || !(netplay->connected_players & (1<<client_num))
+               || devices != netplay->client_devices[client_num]
+               || frame_num != netplay->read_frame_count[client_num])
+            continue;
+
+         dframe = &netplay->buffer[netplay->read_ptr[client_num]];
+         if (!netplay_delta_frame_ready(netplay, dframe, frame_num))
+            break;
+
+         for (device = 0; device < MAX_INPUT_DEVICES; device++)
+         {
+            netplay_input_state_t istate;
+            uint32_t dsize, di;
+
+            if (!(devices & (1<<device)))
+               continue;
+
+            dsize  = netplay_expected_input_size(netplay, 1 << device);
+            istate = netplay_input_state_for(&dframe->real_input[device],
+                  client_num, dsize, false, false);
+            if (!istate)
+               break;
+            for (di = 0; di < dsize; di++)
+               istate->data[di] = ntohl(buffer[ipos++]);
+         }
+         if (device < MAX_INPUT_DEVICES)
+            break;
+
+         netplay_input_received(netplay, connection, dframe, client_num);
+         *had_input = true;
+      }
+   }
+}
+
 /**
  * netplay_poll_net_input
  *
@@ -3556,6 +4021,9 @@ int netplay_poll_net_input(netplay_t *netplay, bool block)
    if (max_fd == 0)
       return 0;
 
+   if (netplay->udp_fd >= max_fd)
+      max_fd = netplay->udp_fd + 1;
+
    netplay->timeout_cnt = 0;
 
    do
@@ -3564,6 +4032,10 @@ int netplay_poll_net_input(netplay_t *netplay, bool block)
 
       netplay->timeout_cnt++;
 
+      /* Input over UDP may be ahead of what's waiting over TCP */
+      if (netplay->udp_fd >= 0)
+         netplay_recv_udp_input(netplay, &had_input);
+
       /* Read input from each connection */
       for (i = 0; i < netplay->connections_size; i++)
       {
@@ -3594,6 +4066,8 @@ int netplay_poll_net_input(netplay_t *netplay, bool block)
                if (connection->active)
                   FD_SET(connection->fd, &fds);
             }
+            if (netplay->udp_fd >= 0)
+               FD_SET(netplay->udp_fd, &fds);
 
             if (socket_select(max_fd, &fds, NULL, NULL, &tv) < 0)
                return -1;
@@ -3933,6 +4407,10 @@ static bool init_socket(netplay_t *netplay, void *direct_host,
    if (!init_tcp_socket(netplay, direct_host, server, port))
       return false;
 
+   /* A client only opens its UDP socket once the server offers UDP input */
+   if (netplay->is_server && config_get_ptr()->bools.netplay_udp_input)
+      netplay_init_udp(netplay, netplay->listen_fd);
+
    if (netplay->is_server && netplay->nat_traversal)
       netplay_init_nat_traversal(netplay);
 
@@ -4010,6 +4488,24 @@ static bool netplay_init_serialization(netplay_t *netplay)
       return false;
    }
 
+#ifdef HAVE_REWIND
+   /* Optional, we fall back to sending full savestates without them */
+   netplay->delta_patch_size = state_manager_raw_maxsize(netplay->state_size);
+   netplay->delta_state      = (uint8_t*)
+      state_manager_raw_alloc(netplay->state_size, 1);
+   netplay->delta_patch      = (uint8_t*)malloc(netplay->delta_patch_size);
+   if (!netplay->delta_state || !netplay->delta_patch)
+   {
+      if (netplay->delta_state)
+         free(netplay->delta_state);
+      if (netplay->delta_patch)
+         free(netplay->delta_patch);
+      netplay->delta_state      = NULL;
+      netplay->delta_patch      = NULL;
+      netplay->delta_patch_size = 0;
+   }
+#endif
+
    return true;
 }
 
@@ -4131,6 +4627,7 @@ netplay_t *netplay_new(void *direct_host, const char *server, uint16_t port,
       return NULL;
 
    netplay->listen_fd            = -1;
+   netplay->udp_fd               = -1;
    netplay->tcp_port             = port;
    netplay->cbs                  = *cb;
    netplay->is_server            = (direct_host == NULL && server == NULL);
@@ -4141,6 +4638,7 @@ netplay_t *netplay_new(void *direct_host, const char *server, uint16_t port,
    netplay->crc_validity_checked = false;
    netplay->crcs_valid           = true;
    netplay->quirks               = quirks;
+   netplay->rollback_max_frames  = NETPLAY_MAX_STALL_FRAMES;
    netplay->self_mode            = netplay->is_server ?
                                 NETPLAY_CONNECTION_SPECTATING :
                                 NETPLAY_CONNECTION_NONE;
@@ -4218,6 +4716,9 @@ error:
    if (netplay->listen_fd >= 0)
       socket_close(netplay->listen_fd);
 
+   if (netplay->udp_fd >= 0)
+      socket_close(netplay->udp_fd);
+
    if (netplay->connections && netplay->connections[0].fd >= 0)
       socket_close(netplay->connections[0].fd);
 
@@ -4238,6 +4739,9 @@ void netplay_free(netplay_t *netplay)
    if (netplay->listen_fd >= 0)
       socket_close(netplay->listen_fd);
 
+   if (netplay->udp_fd >= 0)
+      socket_close(netplay->udp_fd);
+
    for (i = 0; i < netplay->connections_size; i++)
    {
       struct netplay_connection *connection = &netplay->connections[i];
@@ -4247,6 +4751,10 @@ void netplay_free(netplay_t *netplay)
          netplay_deinit_socket_buffer(&connection->send_packet_buffer);
          netplay_deinit_socket_buffer(&connection->recv_packet_buffer);
       }
+      if (connection->delta_send_state)
+         free(connection->delta_send_state);
+      if (connection->delta_recv_state)
+         free(connection->delta_recv_state);
    }
 
    if (netplay->connections && netplay->connections != &netplay->one_connection)
@@ -4265,6 +4773,10 @@ void netplay_free(netplay_t *netplay)
 
    if (netplay->zbuffer)
       free(netplay->zbuffer);
+   if (netplay->delta_state)
+      free(netplay->delta_state);
+   if (netplay->delta_patch)
+      free(netplay->delta_patch);
 
    if (netplay->compress_nil.compression_stream)
    {
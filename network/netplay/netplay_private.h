@@ -54,9 +54,19 @@ typedef uint32_t client_bitmap_t;
 
 #define NETPLAY_MAX_STALL_FRAMES       60
 #define NETPLAY_FRAME_RUN_TIME_WINDOW  120
+
+/* Never limit the rollback depth below this, so that stalling on it still
+ * has some hysteresis */
+#define NETPLAY_MIN_ROLLBACK_FRAMES    3
 #define NETPLAY_MAX_REQ_STALL_TIME     60
 #define NETPLAY_MAX_REQ_STALL_FREQUENCY 120
 
+/* How many frames of our own input each UDP input datagram repeats, so that
+ * losing a few in a row still costs nothing */
+#define NETPLAY_UDP_INPUT_FRAMES       8
+/* Input words a single frame may carry in a UDP input datagram */
+#define NETPLAY_UDP_INPUT_WORDS        16
+
 #define PREV_PTR(x) ((x) == 0 ? netplay->buffer_size - 1 : (x) - 1)
 #define NEXT_PTR(x) ((x + 1) % netplay->buffer_size)
 
@@ -89,10 +99,32 @@ typedef uint32_t client_bitmap_t;
 
 /* Compression protocols supported */
 #define NETPLAY_COMPRESSION_ZLIB (1<<0)
+/* Savestates may be sent as a delta against the last one sent
+ * (NETPLAY_CMD_LOAD_SAVESTATE_DELTA). Uses the rewind delta codec. */
+#define NETPLAY_COMPRESSION_DELTA (1<<1)
+
 #if HAVE_ZLIB
-#define NETPLAY_COMPRESSION_SUPPORTED NETPLAY_COMPRESSION_ZLIB
+#define NETPLAY_COMPRESSION_SUPPORTED_ZLIB NETPLAY_COMPRESSION_ZLIB
 #else
-#define NETPLAY_COMPRESSION_SUPPORTED 0
+#define NETPLAY_COMPRESSION_SUPPORTED_ZLIB 0
+#endif
+#ifdef HAVE_REWIND
+#define NETPLAY_COMPRESSION_SUPPORTED_DELTA NETPLAY_COMPRESSION_DELTA
+#else
+#define NETPLAY_COMPRESSION_SUPPORTED_DELTA 0
+#endif
+#define NETPLAY_COMPRESSION_SUPPORTED \
+   (NETPLAY_COMPRESSION_SUPPORTED_ZLIB | NETPLAY_COMPRESSION_SUPPORTED_DELTA)
+
+/* Not a compression protocol, but advertised alongside them: input may also
+ * be sent over UDP, ahead of the TCP stream (NETPLAY_CMD_UDP_TOKEN). Only
+ * advertised if netplay_udp_input is enabled. */
+#define NETPLAY_COMPRESSION_UDP_INPUT (1<<2)
+
+#ifndef HAVE_SOCKET_LEGACY
+#define NETPLAY_COMPRESSION_SUPPORTED_UDP_INPUT NETPLAY_COMPRESSION_UDP_INPUT
+#else
+#define NETPLAY_COMPRESSION_SUPPORTED_UDP_INPUT 0
 #endif
 
 enum netplay_cmd
@@ -166,6 +198,10 @@ enum netplay_cmd
    /* Sends over cheats enabled on client (unsupported) */
    NETPLAY_CMD_CHEATS         = 0x0047,
 
+   /* Send a savestate for the client to load, as a delta against the last
+    * savestate sent over this connection */
+   NETPLAY_CMD_LOAD_SAVESTATE_DELTA = 0x0048,
+
    /* Misc. commands */
 
    /* Sends multiple config requests over,
@@ -175,7 +211,11 @@ enum netplay_cmd
    /* CMD_CFG streamlines sending multiple
       configurations. This acknowledges
       each one individually */
-   NETPLAY_CMD_CFG_ACK        = 0x0062
+   NETPLAY_CMD_CFG_ACK        = 0x0062,
+
+   /* Gives a client the token to tag its UDP input datagrams with. Only sent
+    * by the server, to clients advertising NETPLAY_COMPRESSION_UDP_INPUT */
+   NETPLAY_CMD_UDP_TOKEN      = 0x0063
 };
 
 #define NETPLAY_CMD_SYNC_BIT_PAUSED    (1U<<31)
@@ -340,6 +380,13 @@ struct netplay_connection
    /* Buffers for sending and receiving data */
    struct socket_buffer send_packet_buffer, recv_packet_buffer;
 
+   /* The last savestates sent to and received from this peer, which the
+    * next one in the same direction may be sent as a delta against.
+    * NULL until a savestate has been transferred, or if the peer doesn't
+    * support deltas. */
+   uint8_t *delta_send_state;
+   uint8_t *delta_recv_state;
+
    /* fd associated with this connection */
    int fd;
 
@@ -358,6 +405,14 @@ struct netplay_connection
    /* Salt associated with password transaction */
    uint32_t salt;
 
+   /* Token tagging UDP input datagrams to and from this peer, 0 if input
+    * only goes over TCP */
+   uint32_t udp_token;
+
+   /* Address this peer sends its UDP input from, once known (server only) */
+   struct sockaddr_storage udp_addr;
+   socklen_t udp_addr_len;
+
    /* Is this connection stalling? */
    enum rarch_netplay_stall_reason stall;
 
@@ -373,6 +428,12 @@ struct netplay_connection
    /* Is this connection allowed to play (server only)? */
    bool can_play;
 
+   /* Does this peer support NETPLAY_CMD_LOAD_SAVESTATE_DELTA? */
+   bool delta_supported;
+
+   /* Does this peer take input over UDP? */
+   bool udp_supported;
+
    /* Is this connection buffer in use? */
    bool active;
 };
@@ -400,11 +461,18 @@ struct netplay
    retro_time_t frame_run_time[NETPLAY_FRAME_RUN_TIME_WINDOW];
    retro_time_t frame_run_time_sum, frame_run_time_avg;
 
+   /* How long did the last replay take? */
+   retro_time_t replay_time_last;
+
    struct netplay_connection one_connection; /* Client only */ /* retro_time_t alignment */
 
    /* TCP connection for listening (server only) */
    int listen_fd;
 
+   /* UDP socket input is sent ahead of TCP over, -1 if none. Bound to the
+    * TCP port on the server, connected to the server on a client. */
+   int udp_fd;
+
    /* Our client number */
    uint32_t self_client_num;
 
@@ -455,6 +523,12 @@ struct netplay
    uint8_t *zbuffer;
    size_t zbuffer_size;
 
+   /* Scratch buffers for savestate deltas: a copy of the state being sent
+    * (allocated as the delta codec needs it) and the uncompressed patch */
+   uint8_t *delta_state;
+   uint8_t *delta_patch;
+   size_t delta_patch_size;
+
    /* The size of our packet buffers */
    size_t packet_buffer_size;
 
@@ -491,6 +565,15 @@ struct netplay
    size_t replay_ptr;
    uint32_t replay_frame_count;
 
+   /* How many frames did the last replay resimulate? */
+   uint32_t replay_frames_last;
+
+   /* How far ahead of confirmed input we allow ourselves to run, and thus
+    * the longest replay we may have to do in a single frame. Derived from
+    * frame_run_time_avg so that a replay fits in one frame's time budget,
+    * and never greater than NETPLAY_MAX_STALL_FRAMES. */
+   uint32_t rollback_max_frames;
+
    /* Our local socket info */
    struct addrinfo *addr;
 
@@ -796,6 +879,13 @@ void netplay_delayed_state_change(netplay_t *netplay);
 bool netplay_send_cur_input(netplay_t *netplay,
    struct netplay_connection *connection);
 
+/**
+ * netplay_send_cur_input_all
+ *
+ * Send the current input frame to every connected peer.
+ */
+void netplay_send_cur_input_all(netplay_t *netplay);
+
 /**
  * netplay_send_raw_cmd
  *
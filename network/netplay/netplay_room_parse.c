@@ -43,6 +43,7 @@ struct netplay_rooms
 
 struct netplay_json_context
 {
+   struct netplay_rooms *rooms;
    bool *cur_member_bool;
    int  *cur_member_int;
    int  *cur_member_inthex;
@@ -107,15 +108,15 @@ static bool netplay_json_start_object(void* ctx)
    {
       p_ctx->state = STATE_FIELDS_OBJECT_START;
 
-      if (!netplay_rooms_data->head)
+      if (!p_ctx->rooms->head)
       {
-         netplay_rooms_data->head      = (struct netplay_room*)calloc(1, sizeof(*netplay_rooms_data->head));
-         netplay_rooms_data->cur       = netplay_rooms_data->head;
+         p_ctx->rooms->head      = (struct netplay_room*)calloc(1, sizeof(*p_ctx->rooms->head));
+         p_ctx->rooms->cur       = p_ctx->rooms->head;
       }
-      else if (!netplay_rooms_data->cur->next)
+      else if (!p_ctx->rooms->cur->next)
       {
-         netplay_rooms_data->cur->next = (struct netplay_room*)calloc(1, sizeof(*netplay_rooms_data->cur->next));
-         netplay_rooms_data->cur       = netplay_rooms_data->cur->next;
+         p_ctx->rooms->cur->next = (struct netplay_room*)calloc(1, sizeof(*p_ctx->rooms->cur->next));
+         p_ctx->rooms->cur       = p_ctx->rooms->cur->next;
       }
    }
    else if (p_ctx->state == STATE_ARRAY_START)
@@ -157,81 +158,81 @@ static bool netplay_json_object_member(void *ctx, const char *p_value,
       {
          if (string_is_equal(p_value, "username"))
          {
-            p_ctx->cur_member_string = netplay_rooms_data->cur->nickname;
-            p_ctx->cur_member_size   = sizeof(netplay_rooms_data->cur->nickname);
+            p_ctx->cur_member_string = p_ctx->rooms->cur->nickname;
+            p_ctx->cur_member_size   = sizeof(p_ctx->rooms->cur->nickname);
          }
          else if (string_is_equal(p_value, "game_name"))
          {
-            p_ctx->cur_member_string = netplay_rooms_data->cur->gamename;
-            p_ctx->cur_member_size   = sizeof(netplay_rooms_data->cur->gamename);
+            p_ctx->cur_member_string = p_ctx->rooms->cur->gamename;
+            p_ctx->cur_member_size   = sizeof(p_ctx->rooms->cur->gamename);
          }
          else if (string_is_equal(p_value, "core_name"))
          {
-            p_ctx->cur_member_string = netplay_rooms_data->cur->corename;
-            p_ctx->cur_member_size   = sizeof(netplay_rooms_data->cur->corename);
+            p_ctx->cur_member_string = p_ctx->rooms->cur->corename;
+            p_ctx->cur_member_size   = sizeof(p_ctx->rooms->cur->corename);
          }
          else if (string_is_equal(p_value, "ip"))
          {
-            p_ctx->cur_member_string = netplay_rooms_data->cur->address;
-            p_ctx->cur_member_size   = sizeof(netplay_rooms_data->cur->address);
+            p_ctx->cur_member_string = p_ctx->rooms->cur->address;
+            p_ctx->cur_member_size   = sizeof(p_ctx->rooms->cur->address);
          }
          else if (string_is_equal(p_value, "port"))
          {
-            p_ctx->cur_member_int    = &netplay_rooms_data->cur->port;
+            p_ctx->cur_member_int    = &p_ctx->rooms->cur->port;
          }
          else if (string_is_equal(p_value, "game_crc"))
          {
-            p_ctx->cur_member_inthex = &netplay_rooms_data->cur->gamecrc;
+            p_ctx->cur_member_inthex = &p_ctx->rooms->cur->gamecrc;
          }
          else if (string_is_equal(p_value, "core_version"))
          {
-            p_ctx->cur_member_string = netplay_rooms_data->cur->coreversion;
-            p_ctx->cur_member_size   = sizeof(netplay_rooms_data->cur->coreversion);
+            p_ctx->cur_member_string = p_ctx->rooms->cur->coreversion;
+            p_ctx->cur_member_size   = sizeof(p_ctx->rooms->cur->coreversion);
          }
          else if (string_is_equal(p_value, "has_password"))
          {
-            p_ctx->cur_member_bool   = &netplay_rooms_data->cur->has_password;
+            p_ctx->cur_member_bool   = &p_ctx->rooms->cur->has_password;
          }
          else if (string_is_equal(p_value, "has_spectate_password"))
          {
-            p_ctx->cur_member_bool   = &netplay_rooms_data->cur->has_spectate_password;
+            p_ctx->cur_member_bool   = &p_ctx->rooms->cur->has_spectate_password;
          }
          else if (string_is_equal(p_value, "fixed"))
          {
-            p_ctx->cur_member_bool   = &netplay_rooms_data->cur->fixed;
+            p_ctx->cur_member_bool   = &p_ctx->rooms->cur->fixed;
          }
          else if (string_is_equal(p_value, "mitm_ip"))
          {
-            p_ctx->cur_member_string = netplay_rooms_data->cur->mitm_address;
-            p_ctx->cur_member_size   = sizeof(netplay_rooms_data->cur->mitm_address);
+            p_ctx->cur_member_string = p_ctx->rooms->cur->mitm_address;
+            p_ctx->cur_member_size   = sizeof(p_ctx->rooms->cur->mitm_address);
          }
          else if (string_is_equal(p_value, "mitm_port"))
          {
-            p_ctx->cur_member_int    = &netplay_rooms_data->cur->mitm_port;
+            p_ctx->cur_member_int    = &p_ctx->rooms->cur->mitm_port;
          }
          else if (string_is_equal(p_value, "host_method"))
          {
-            p_ctx->cur_member_int    = &netplay_rooms_data->cur->host_method;
+            p_ctx->cur_member_int    = &p_ctx->rooms->cur->host_method;
          }
          else if (string_is_equal(p_value, "retroarch_version"))
          {
-            p_ctx->cur_member_string = netplay_rooms_data->cur->retroarch_version;
-            p_ctx->cur_member_size   = sizeof(netplay_rooms_data->cur->retroarch_version);
+            p_ctx->cur_member_string = p_ctx->rooms->cur->retroarch_version;
+            p_ctx->cur_member_size   = sizeof(p_ctx->rooms->cur->retroarch_version);
          }
          else if (string_is_equal(p_value, "country"))
          {
-            p_ctx->cur_member_string = netplay_rooms_data->cur->country;
-            p_ctx->cur_member_size   = sizeof(netplay_rooms_data->cur->country);
+            p_ctx->cur_member_string = p_ctx->rooms->cur->country;
+            p_ctx->cur_member_size   = sizeof(p_ctx->rooms->cur->country);
          }
          else if (string_is_equal(p_value, "frontend"))
          {
-            p_ctx->cur_member_string = netplay_rooms_data->cur->frontend;
-            p_ctx->cur_member_size   = sizeof(netplay_rooms_data->cur->frontend);
+            p_ctx->cur_member_string = p_ctx->rooms->cur->frontend;
+            p_ctx->cur_member_size   = sizeof(p_ctx->rooms->cur->frontend);
          }
          else if (string_is_equal(p_value, "subsystem_name"))
          {
-            p_ctx->cur_member_string = netplay_rooms_data->cur->subsystem_name;
-            p_ctx->cur_member_size   = sizeof(netplay_rooms_data->cur->subsystem_name);
+            p_ctx->cur_member_string = p_ctx->rooms->cur->subsystem_name;
+            p_ctx->cur_member_size   = sizeof(p_ctx->rooms->cur->subsystem_name);
          }
       }
    }
@@ -256,41 +257,39 @@ static void netplay_rooms_error(void *context,
          line, col, error);
 }
 
-void netplay_rooms_free(void)
+static void netplay_rooms_list_free(struct netplay_rooms *rooms)
 {
-   if (netplay_rooms_data)
+   struct netplay_room *room = rooms->head;
+
+   while (room)
    {
-      struct netplay_room *room = netplay_rooms_data->head;
+      struct netplay_room *next = room->next;
 
-      if (room)
-      {
-         while (room)
-         {
-            struct netplay_room *next = room->next;
+      free(room);
+      room = next;
+   }
 
-            free(room);
-            room = next;
-         }
-      }
+   free(rooms);
+}
 
-      free(netplay_rooms_data);
-   }
+void netplay_rooms_free(void)
+{
+   if (netplay_rooms_data)
+      netplay_rooms_list_free(netplay_rooms_data);
    netplay_rooms_data = NULL;
 }
 
-int netplay_rooms_parse(const char *buf)
+static struct netplay_rooms *netplay_rooms_list_parse(const char *buf)
 {
    struct netplay_json_context ctx;
 
    memset(&ctx, 0, sizeof(ctx));
 
    ctx.state = STATE_START;
+   ctx.rooms = (struct netplay_rooms*)calloc(1, sizeof(*ctx.rooms));
 
-   /* delete any previous rooms */
-   netplay_rooms_free();
-
-   netplay_rooms_data = (struct netplay_rooms*)
-      calloc(1, sizeof(*netplay_rooms_data));
+   if (!ctx.rooms)
+      return NULL;
 
    rjson_parse_quick(buf, &ctx, 0,
          netplay_json_object_member,
@@ -304,17 +303,63 @@ int netplay_rooms_parse(const char *buf)
          NULL /* null handler */,
          netplay_rooms_error);
 
+   return ctx.rooms;
+}
+
+int netplay_rooms_parse(const char *buf)
+{
+   /* delete any previous rooms */
+   netplay_rooms_free();
+
+   netplay_rooms_data = netplay_rooms_list_parse(buf);
+
    return 0;
 }
 
+int netplay_rooms_parse_array(const char *buf, struct netplay_room **rooms)
+{
+   int i                       = 0;
+   int count                   = 0;
+   struct netplay_room *room   = NULL;
+   struct netplay_rooms *list  = netplay_rooms_list_parse(buf);
+
+   *rooms                      = NULL;
+
+   if (!list)
+      return 0;
+
+   for (room = list->head; room; room = room->next)
+      count++;
+
+   if (count)
+      *rooms = (struct netplay_room*)calloc(count, sizeof(**rooms));
+
+   if (*rooms)
+   {
+      for (room = list->head; room; room = room->next, i++)
+      {
+         memcpy(&(*rooms)[i], room, sizeof(**rooms));
+         (*rooms)[i].next = NULL;
+      }
+   }
+   else
+      count = 0;
+
+   netplay_rooms_list_free(list);
+
+   return count;
+}
+
 struct netplay_room* netplay_room_get(int index)
 {
    int                   cur = 0;
-   struct netplay_room *room = netplay_rooms_data->head;
+   struct netplay_room *room = NULL;
 
-   if (index < 0)
+   if (index < 0 || !netplay_rooms_data)
       return NULL;
 
+   room = netplay_rooms_data->head;
+
    while (room)
    {
       if (cur == index)
@@ -0,0 +1,672 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <compat/strl.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#include "performance_counters.h"
+#include "verbosity.h"
+
+#define PERF_TRACE_EVENT_MASK (PERF_TRACE_EVENTS_PER_THREAD - 1)
+
+typedef struct perf_trace_event
+{
+   const char *name;
+   retro_time_t start;
+   retro_time_t duration;          /* -1 for instant events */
+} perf_trace_event_t;
+
+typedef struct perf_trace_scope
+{
+   const char *name;
+   retro_time_t start;
+} perf_trace_scope_t;
+
+typedef struct perf_trace_thread
+{
+   perf_trace_scope_t stack[PERF_TRACE_MAX_DEPTH];
+   perf_trace_event_t *events;
+#ifdef HAVE_THREADS
+   /* Only contended while dumping */
+   slock_t *lock;
+#endif
+   uint64_t count;
+#if defined(HAVE_THREADS) && !defined(HAVE_THREAD_STORAGE)
+   uintptr_t owner;
+#endif
+   unsigned session;
+   unsigned depth;
+   char name[32];
+   bool in_use;
+} perf_trace_thread_t;
+
+typedef struct perf_boot_event
+{
+   retro_time_t start;
+   retro_time_t duration;
+   unsigned phase;
+   bool main_thread;
+} perf_boot_event_t;
+
+int perf_trace_enabled                                   = 0;
+
+static perf_trace_thread_t *s_threads[PERF_TRACE_MAX_THREADS];
+static retro_time_t s_start                              = 0;
+static unsigned s_session                                = 0;
+#ifdef HAVE_THREADS
+static slock_t *s_lock                                   = NULL;
+#ifdef HAVE_THREAD_STORAGE
+static sthread_tls_t s_tls;
+static bool s_tls_inited                                 = false;
+#endif
+#else
+static perf_trace_thread_t *s_thread                     = NULL;
+#endif
+
+static const char *s_boot_phase_names[PERF_BOOT_PHASES]  = {
+   "config_load",
+   "core_info",
+   "drivers",
+   "menu",
+   "assets",
+   "shaders",
+   "content_load",
+};
+static perf_boot_event_t s_boot_events[PERF_BOOT_MAX_EVENTS];
+static retro_time_t s_boot_opened[PERF_BOOT_PHASES];
+static retro_time_t s_boot_total[PERF_BOOT_PHASES];
+static retro_time_t s_boot_start                         = 0;
+static retro_time_t s_boot_first_frame                   = 0;
+static unsigned s_boot_depth[PERF_BOOT_PHASES];
+static unsigned s_boot_count                             = 0;
+#ifdef HAVE_THREADS
+static uintptr_t s_boot_thread                           = 0;
+#endif
+static bool s_boot_done                                  = false;
+
+void perf_trace_init(void)
+{
+#ifdef HAVE_THREADS
+   if (!s_lock)
+      s_lock       = slock_new();
+#ifdef HAVE_THREAD_STORAGE
+   if (!s_tls_inited)
+      s_tls_inited = sthread_tls_create(&s_tls);
+#endif
+#endif
+}
+
+void perf_trace_deinit(void)
+{
+   unsigned i;
+
+   perf_trace_enabled = 0;
+
+   for (i = 0; i < PERF_TRACE_MAX_THREADS; i++)
+   {
+      perf_trace_thread_t *thread = s_threads[i];
+
+      if (!thread)
+         continue;
+
+#ifdef HAVE_THREADS
+      if (thread->lock)
+         slock_free(thread->lock);
+#endif
+      free(thread->events);
+      free(thread);
+      s_threads[i] = NULL;
+   }
+
+#ifdef HAVE_THREADS
+#ifdef HAVE_THREAD_STORAGE
+   if (s_tls_inited)
+      sthread_tls_delete(&s_tls);
+   s_tls_inited = false;
+#endif
+   if (s_lock)
+      slock_free(s_lock);
+   s_lock       = NULL;
+#else
+   s_thread     = NULL;
+#endif
+}
+
+void perf_trace_set_enabled(bool enable)
+{
+   if (enable && !perf_trace_enabled)
+   {
+      s_start = cpu_features_get_time_usec();
+      /* Threads drop their old rings lazily, on
+       * their first scope of the new session */
+      s_session++;
+   }
+
+   perf_trace_enabled = enable ? 1 : 0;
+}
+
+static perf_trace_thread_t *perf_trace_thread_new(void)
+{
+   perf_trace_thread_t *thread = (perf_trace_thread_t*)
+      calloc(1, sizeof(*thread));
+
+   if (!thread)
+      return NULL;
+
+#ifdef HAVE_THREADS
+   if (!(thread->lock = slock_new()))
+   {
+      free(thread);
+      return NULL;
+   }
+#endif
+
+   return thread;
+}
+
+/* Returns the slot bound to the calling thread, if any */
+static perf_trace_thread_t *perf_trace_lookup_thread(void)
+{
+#if defined(HAVE_THREADS) && defined(HAVE_THREAD_STORAGE)
+   if (!s_tls_inited)
+      return NULL;
+   return (perf_trace_thread_t*)sthread_tls_get(&s_tls);
+#elif defined(HAVE_THREADS)
+   unsigned i;
+   uintptr_t id = sthread_get_current_thread_id();
+
+   for (i = 0; i < PERF_TRACE_MAX_THREADS; i++)
+   {
+      perf_trace_thread_t *thread = s_threads[i];
+      if (thread && thread->in_use && thread->owner == id)
+         return thread;
+   }
+
+   return NULL;
+#else
+   return s_thread;
+#endif
+}
+
+static void perf_trace_bind_thread(perf_trace_thread_t *thread)
+{
+#if defined(HAVE_THREADS) && defined(HAVE_THREAD_STORAGE)
+   sthread_tls_set(&s_tls, thread);
+#elif defined(HAVE_THREADS)
+   if (thread)
+      thread->owner = sthread_get_current_thread_id();
+#else
+   s_thread = thread;
+#endif
+}
+
+/* Finds the calling thread's slot, taking a free one
+ * on its first call. Returns NULL once all slots
+ * are taken. */
+static perf_trace_thread_t *perf_trace_get_thread(void)
+{
+   unsigned i;
+   perf_trace_thread_t *thread = NULL;
+
+#ifdef HAVE_THREADS
+   if (!s_lock)
+      return NULL;
+#if defined(HAVE_THREAD_STORAGE)
+   if (!s_tls_inited)
+      return NULL;
+#endif
+#endif
+
+   if ((thread = perf_trace_lookup_thread()))
+      return thread;
+
+#ifdef HAVE_THREADS
+   slock_lock(s_lock);
+#endif
+
+   for (i = 0; i < PERF_TRACE_MAX_THREADS; i++)
+   {
+      if (!s_threads[i])
+         s_threads[i] = perf_trace_thread_new();
+
+      if (s_threads[i] && !s_threads[i]->in_use)
+      {
+         thread          = s_threads[i];
+#ifdef HAVE_THREADS
+         slock_lock(thread->lock);
+#endif
+         perf_trace_bind_thread(thread);
+         thread->in_use  = true;
+         thread->count   = 0;
+         thread->depth   = 0;
+         thread->session = s_session;
+         thread->name[0] = '\0';
+#ifdef HAVE_THREADS
+         slock_unlock(thread->lock);
+#endif
+         break;
+      }
+   }
+
+#ifdef HAVE_THREADS
+   slock_unlock(s_lock);
+#endif
+
+   return thread;
+}
+
+static perf_trace_thread_t *perf_trace_get_session_thread(void)
+{
+   perf_trace_thread_t *thread = perf_trace_get_thread();
+
+   if (thread && thread->session != s_session)
+   {
+#ifdef HAVE_THREADS
+      slock_lock(thread->lock);
+#endif
+      thread->count   = 0;
+      thread->depth   = 0;
+      thread->session = s_session;
+#ifdef HAVE_THREADS
+      slock_unlock(thread->lock);
+#endif
+   }
+
+   return thread;
+}
+
+void perf_trace_set_thread_name(const char *name)
+{
+   perf_trace_thread_t *thread = perf_trace_get_thread();
+
+   if (thread)
+      strlcpy(thread->name, name, sizeof(thread->name));
+}
+
+void perf_trace_thread_exit(void)
+{
+   perf_trace_thread_t *thread = NULL;
+
+#ifdef HAVE_THREADS
+   if (!s_lock)
+      return;
+#endif
+
+   if (!(thread = perf_trace_lookup_thread()))
+      return;
+
+   /* What it recorded stays in the dump until
+    * another thread takes the slot */
+#ifdef HAVE_THREADS
+   slock_lock(s_lock);
+#endif
+   perf_trace_bind_thread(NULL);
+   thread->in_use = false;
+#ifdef HAVE_THREADS
+   slock_unlock(s_lock);
+#endif
+}
+
+static void perf_trace_push_event(perf_trace_thread_t *thread,
+      const char *name, retro_time_t start, retro_time_t duration)
+{
+   perf_trace_event_t *event = NULL;
+
+   /* Threads that never record anything (tracing
+    * is off most of the time) don't get a ring */
+   if (!thread->events)
+   {
+      perf_trace_event_t *events = (perf_trace_event_t*)malloc(
+            PERF_TRACE_EVENTS_PER_THREAD * sizeof(*events));
+
+      if (!events)
+         return;
+
+#ifdef HAVE_THREADS
+      slock_lock(thread->lock);
+#endif
+      thread->events = events;
+#ifdef HAVE_THREADS
+      slock_unlock(thread->lock);
+#endif
+   }
+
+#ifdef HAVE_THREADS
+   slock_lock(thread->lock);
+#endif
+   event           = &thread->events[thread->count & PERF_TRACE_EVENT_MASK];
+   event->name     = name;
+   event->start    = start;
+   event->duration = duration;
+   thread->count++;
+#ifdef HAVE_THREADS
+   slock_unlock(thread->lock);
+#endif
+}
+
+void perf_trace_begin_internal(const char *name)
+{
+   perf_trace_thread_t *thread = perf_trace_get_session_thread();
+
+   if (!thread || thread->depth >= PERF_TRACE_MAX_DEPTH)
+      return;
+
+   thread->stack[thread->depth].name  = name;
+   thread->stack[thread->depth].start = cpu_features_get_time_usec();
+   thread->depth++;
+}
+
+void perf_trace_end_internal(const char *name)
+{
+   retro_time_t now;
+   perf_trace_scope_t *scope   = NULL;
+   perf_trace_thread_t *thread = perf_trace_get_session_thread();
+
+   /* The scope may have been opened before tracing
+    * was turned on, in which case there's nothing
+    * to close */
+   if (!thread || !thread->depth)
+      return;
+
+   scope = &thread->stack[thread->depth - 1];
+   if (scope->name != name)
+      return;
+
+   now   = cpu_features_get_time_usec();
+   thread->depth--;
+
+   perf_trace_push_event(thread, name, scope->start, now - scope->start);
+}
+
+void perf_trace_mark_internal(const char *name)
+{
+   perf_trace_thread_t *thread = perf_trace_get_session_thread();
+
+   if (thread)
+      perf_trace_push_event(thread, name,
+            cpu_features_get_time_usec(), -1);
+}
+
+/**
+ * perf_trace_dump:
+ * @path               : path of the JSON file to write
+ * @events             : if not NULL, set to the number
+ *                       of events written
+ *
+ * Writes what the current (or last) trace recorded,
+ * in the Chrome trace event format.
+ *
+ * Returns: true if the file was written.
+ **/
+bool perf_trace_dump(const char *path, size_t *events)
+{
+   unsigned i;
+   size_t written = 0;
+   bool comma     = false;
+   RFILE *file    = NULL;
+
+   if (events)
+      *events     = 0;
+
+   if (string_is_empty(path))
+      return false;
+
+   if (!(file = filestream_open(path,
+               RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return false;
+
+   filestream_printf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+#ifdef HAVE_THREADS
+   if (s_lock)
+      slock_lock(s_lock);
+#endif
+
+   for (i = 0; i < PERF_TRACE_MAX_THREADS; i++)
+   {
+      uint64_t j, first;
+      perf_trace_thread_t *thread = s_threads[i];
+
+      if (!thread)
+         continue;
+
+#ifdef HAVE_THREADS
+      slock_lock(thread->lock);
+#endif
+
+      if (     thread->session == s_session
+            && thread->count
+            && thread->events)
+      {
+         first = (thread->count > PERF_TRACE_EVENTS_PER_THREAD)
+            ? thread->count - PERF_TRACE_EVENTS_PER_THREAD : 0;
+
+         if (string_is_empty(thread->name))
+            filestream_printf(file,
+                  "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                  "\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}",
+                  comma ? "," : "", i + 1, i + 1);
+         else
+            filestream_printf(file,
+                  "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                  "\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                  comma ? "," : "", i + 1, thread->name);
+         comma = true;
+
+         for (j = first; j < thread->count; j++)
+         {
+            const perf_trace_event_t *event =
+               &thread->events[j & PERF_TRACE_EVENT_MASK];
+
+            if (event->duration < 0)
+               filestream_printf(file,
+                     ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\","
+                     "\"pid\":1,\"tid\":%u,\"ts\":%" PRId64 "}",
+                     event->name, i + 1,
+                     (int64_t)(event->start - s_start));
+            else
+               filestream_printf(file,
+                     ",\n{\"name\":\"%s\",\"ph\":\"X\","
+                     "\"pid\":1,\"tid\":%u,\"ts\":%" PRId64 ",\"dur\":%" PRId64 "}",
+                     event->name, i + 1,
+                     (int64_t)(event->start - s_start),
+                     (int64_t)event->duration);
+            written++;
+         }
+      }
+
+#ifdef HAVE_THREADS
+      slock_unlock(thread->lock);
+#endif
+   }
+
+#ifdef HAVE_THREADS
+   if (s_lock)
+      slock_unlock(s_lock);
+#endif
+
+   filestream_printf(file, "\n]}\n");
+   filestream_close(file);
+
+   if (events)
+      *events = written;
+
+   return true;
+}
+
+/* Boot trace */
+
+void perf_boot_init(void)
+{
+   s_boot_start       = cpu_features_get_time_usec();
+   s_boot_first_frame = 0;
+   s_boot_count       = 0;
+   s_boot_done        = false;
+#ifdef HAVE_THREADS
+   s_boot_thread      = sthread_get_current_thread_id();
+#endif
+   memset(s_boot_depth, 0, sizeof(s_boot_depth));
+   memset(s_boot_total, 0, sizeof(s_boot_total));
+}
+
+void perf_boot_begin(enum perf_boot_phase phase)
+{
+   if (s_boot_done || phase >= PERF_BOOT_PHASES)
+      return;
+
+#ifdef HAVE_THREADS
+   if (s_lock)
+      slock_lock(s_lock);
+#endif
+
+   if (s_boot_depth[phase]++ == 0)
+      s_boot_opened[phase] = cpu_features_get_time_usec();
+
+#ifdef HAVE_THREADS
+   if (s_lock)
+      slock_unlock(s_lock);
+#endif
+}
+
+void perf_boot_end(enum perf_boot_phase phase)
+{
+   if (s_boot_done || phase >= PERF_BOOT_PHASES)
+      return;
+
+#ifdef HAVE_THREADS
+   if (s_lock)
+      slock_lock(s_lock);
+#endif
+
+   if (s_boot_depth[phase] && --s_boot_depth[phase] == 0)
+   {
+      retro_time_t duration = cpu_features_get_time_usec()
+         - s_boot_opened[phase];
+
+      s_boot_total[phase]  += duration;
+
+      if (s_boot_count < PERF_BOOT_MAX_EVENTS)
+      {
+         perf_boot_event_t *event = &s_boot_events[s_boot_count++];
+
+         event->start       = s_boot_opened[phase];
+         event->duration    = duration;
+         event->phase       = phase;
+#ifdef HAVE_THREADS
+         event->main_thread = sthread_get_current_thread_id()
+            == s_boot_thread;
+#else
+         event->main_thread = true;
+#endif
+      }
+   }
+
+#ifdef HAVE_THREADS
+   if (s_lock)
+      slock_unlock(s_lock);
+#endif
+}
+
+void perf_boot_first_frame(void)
+{
+   unsigned i;
+   char summary[512];
+   size_t len = 0;
+
+   if (s_boot_done)
+      return;
+
+   s_boot_done        = true;
+   s_boot_first_frame = cpu_features_get_time_usec();
+
+   for (i = 0; i < PERF_BOOT_PHASES && len < sizeof(summary); i++)
+      len += snprintf(summary + len, sizeof(summary) - len,
+            "%s%s %.1f", i ? ", " : "", s_boot_phase_names[i],
+            s_boot_total[i] / 1000.0);
+
+   /* Goes to net_logger on builds that have it */
+   RARCH_LOG("[Boot]: First frame after %.1f ms (%s ms).\n",
+         (s_boot_first_frame - s_boot_start) / 1000.0, summary);
+}
+
+/**
+ * perf_boot_dump:
+ * @path               : path of the JSON file to write
+ *
+ * Writes the boot phases recorded so far in the
+ * Chrome trace event format, phases run off the
+ * main thread being put on a second track.
+ *
+ * Returns: true if the file was written.
+ **/
+bool perf_boot_dump(const char *path)
+{
+   unsigned i;
+   RFILE *file = NULL;
+
+   if (string_is_empty(path))
+      return false;
+
+   if (!(file = filestream_open(path,
+               RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return false;
+
+   filestream_printf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":["
+         "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+         "\"tid\":1,\"args\":{\"name\":\"main\"}}"
+         ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+         "\"tid\":2,\"args\":{\"name\":\"other threads\"}}");
+
+#ifdef HAVE_THREADS
+   if (s_lock)
+      slock_lock(s_lock);
+#endif
+
+   for (i = 0; i < s_boot_count; i++)
+   {
+      const perf_boot_event_t *event = &s_boot_events[i];
+
+      filestream_printf(file,
+            ",\n{\"name\":\"%s\",\"ph\":\"X\","
+            "\"pid\":1,\"tid\":%u,\"ts\":%" PRId64 ",\"dur\":%" PRId64 "}",
+            s_boot_phase_names[event->phase],
+            event->main_thread ? 1 : 2,
+            (int64_t)(event->start - s_boot_start),
+            (int64_t)event->duration);
+   }
+
+#ifdef HAVE_THREADS
+   if (s_lock)
+      slock_unlock(s_lock);
+#endif
+
+   if (s_boot_first_frame)
+      filestream_printf(file,
+            ",\n{\"name\":\"first_frame\",\"ph\":\"i\",\"s\":\"g\","
+            "\"pid\":1,\"tid\":1,\"ts\":%" PRId64 "}",
+            (int64_t)(s_boot_first_frame - s_boot_start));
+
+   filestream_printf(file, "\n]}\n");
+   filestream_close(file);
+
+   return true;
+}
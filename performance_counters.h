@@ -81,6 +81,131 @@ void rarch_perf_register(struct retro_perf_counter *perf);
  **/
 #define performance_counter_stop_plus(is_perfcnt_enable, perf) performance_counter_stop_internal(is_perfcnt_enable, perf)
 
+/* Scope tracing
+ *
+ * Unlike the counters above, trace scopes record each
+ * call with its start time, duration and nesting, per
+ * thread, into a ring holding the last
+ * PERF_TRACE_EVENTS_PER_THREAD scopes of each thread.
+ * perf_trace_dump() writes them out in the Chrome trace
+ * event format, which chrome://tracing and the Perfetto
+ * UI both open.
+ *
+ * Scope names are stored as pointers, so they must be
+ * string literals. */
+
+#ifndef PERF_TRACE_MAX_THREADS
+#define PERF_TRACE_MAX_THREADS 32
+#endif
+
+#ifndef PERF_TRACE_EVENTS_PER_THREAD
+#define PERF_TRACE_EVENTS_PER_THREAD 16384
+#endif
+
+#define PERF_TRACE_MAX_DEPTH 32
+
+extern int perf_trace_enabled;
+
+void perf_trace_init(void);
+
+void perf_trace_deinit(void);
+
+/* Starting a new trace drops whatever was
+ * recorded by the previous one */
+void perf_trace_set_enabled(bool enable);
+
+/* Names the calling thread in the trace. Threads
+ * that never call this show up as "thread <n>" */
+void perf_trace_set_thread_name(const char *name);
+
+/* Hands the calling thread's slot over to the next
+ * thread that traces something. Threads that come
+ * and go (e.g. task workers) should call this
+ * before exiting */
+void perf_trace_thread_exit(void);
+
+void perf_trace_begin_internal(const char *name);
+
+void perf_trace_end_internal(const char *name);
+
+void perf_trace_mark_internal(const char *name);
+
+bool perf_trace_dump(const char *path, size_t *events);
+
+/**
+ * perf_trace_begin:
+ * @name               : scope name, a string literal
+ *
+ * Opens a trace scope on the calling thread. Every
+ * perf_trace_begin() needs a matching perf_trace_end()
+ * with the same name in the same function.
+ **/
+#define perf_trace_begin(name) \
+   if (perf_trace_enabled) \
+      perf_trace_begin_internal(name)
+
+/**
+ * perf_trace_end:
+ * @name               : name passed to perf_trace_begin()
+ *
+ * Closes the innermost trace scope of the calling thread.
+ **/
+#define perf_trace_end(name) \
+   if (perf_trace_enabled) \
+      perf_trace_end_internal(name)
+
+/**
+ * perf_trace_mark:
+ * @name               : event name, a string literal
+ *
+ * Records an instant event, e.g. a frame boundary.
+ **/
+#define perf_trace_mark(name) \
+   if (perf_trace_enabled) \
+      perf_trace_mark_internal(name)
+
+/* Boot trace
+ *
+ * Times the phases of startup, from perf_boot_init()
+ * to the first frame of content. Recording only costs
+ * a few timestamps, so it is always on; the summary is
+ * logged once the first frame is out and
+ * perf_boot_dump() writes the phases in the Chrome
+ * trace event format.
+ *
+ * A phase entered again while it is open (e.g. a font
+ * loaded while loading widget assets) is only timed
+ * once. */
+
+#ifndef PERF_BOOT_MAX_EVENTS
+#define PERF_BOOT_MAX_EVENTS 128
+#endif
+
+enum perf_boot_phase
+{
+   PERF_BOOT_CONFIG = 0,
+   PERF_BOOT_CORE_INFO,
+   PERF_BOOT_DRIVERS,
+   PERF_BOOT_MENU,
+   PERF_BOOT_ASSETS,
+   PERF_BOOT_SHADERS,
+   PERF_BOOT_CONTENT,
+   PERF_BOOT_PHASES
+};
+
+/* Call after perf_trace_init(), as early as possible */
+void perf_boot_init(void);
+
+void perf_boot_begin(enum perf_boot_phase phase);
+
+void perf_boot_end(enum perf_boot_phase phase);
+
+/* Ends the boot trace and logs its summary, later
+ * calls do nothing */
+void perf_boot_first_frame(void);
+
+bool perf_boot_dump(const char *path);
+
 RETRO_END_DECLS
 
 #endif
@@ -27,10 +27,14 @@
 #include <compat/posix_string.h>
 #include <string/stdstring.h>
 #include <streams/interface_stream.h>
+#include <streams/file_stream.h>
 #include <file/file_path.h>
 #include <lists/string_list.h>
 #include <formats/rjson.h>
 #include <array/rbuf.h>
+#include <array/rhmap.h>
+#include <encodings/crc32.h>
+#include <retro_endianness.h>
 
 #include "playlist.h"
 #include "verbosity.h"
@@ -64,6 +68,32 @@ struct content_playlist
 
    struct playlist_entry *entries;
 
+   /* Number of entries per path hash (rhmap), used to
+    * skip searches that cannot match any entry. Built
+    * on the first search, since it requires the path
+    * ID of every entry */
+   uint32_t *path_index;
+
+   /* Search signature of every entry (see
+    * playlist_search_may_match()). Built on the
+    * first filtered search, and dropped whenever
+    * entries are added, removed or renamed */
+   uint64_t *search_index;
+
+   /* Contents of the binary cache file the playlist
+    * was loaded from (if any). Entry strings may point
+    * into this buffer, and must then not be free()d */
+   char *cache_buf;
+   size_t cache_buf_size;
+
+   /* Journal records not yet appended to the
+    * journal file */
+   uint8_t *journal;
+   /* Number of records in the journal file */
+   unsigned journal_records;
+   /* Number of records in 'journal' */
+   unsigned journal_pending;
+
    playlist_config_t config;  /* size_t alignment */
 
    enum playlist_label_display_mode label_display_mode;
@@ -75,6 +105,8 @@ struct content_playlist
    bool old_format;
    bool compressed;
    bool cached_external;
+   bool path_index_valid;
+   bool search_index_valid;
 };
 
 typedef struct
@@ -530,6 +562,217 @@ static bool playlist_core_path_equal(const char *real_core_path, const char *ent
    return false;
 }
 
+/* Playlist path index
+ * > Entries are counted under the hash of their
+ *   'real' path and, if they refer to a file inside
+ *   an archive, under the hash of the archive path
+ *   (required for fuzzy archive matching)
+ * > Hashes are case insensitive and may collide, so
+ *   a hit only means that a search must be performed */
+
+static void playlist_path_index_adjust(playlist_t *playlist,
+      uint32_t hash, int delta)
+{
+   uint32_t count;
+
+   if (!hash)
+      return;
+
+   count = RHMAP_GET(playlist->path_index, hash) + delta;
+
+   if (count > 0)
+      RHMAP_SET(playlist->path_index, hash, count);
+   else
+      (void)RHMAP_DEL(playlist->path_index, hash);
+}
+
+static void playlist_path_index_update(playlist_t *playlist,
+      const playlist_path_id_t *path_id, int delta)
+{
+   if (!playlist->path_index_valid || !path_id)
+      return;
+
+   playlist_path_index_adjust(playlist, path_id->real_path_hash, delta);
+
+   if (path_id->is_in_archive)
+      playlist_path_index_adjust(playlist,
+            path_id->archive_path_hash, delta);
+}
+
+static void playlist_path_index_free(playlist_t *playlist)
+{
+   RHMAP_FREE(playlist->path_index);
+   playlist->path_index_valid = false;
+}
+
+static bool playlist_path_index_init(playlist_t *playlist)
+{
+   size_t i, len;
+
+   if (playlist->path_index_valid)
+      return true;
+
+   playlist->path_index_valid = true;
+
+   for (i = 0, len = RBUF_LEN(playlist->entries); i < len; i++)
+   {
+      struct playlist_entry *entry = &playlist->entries[i];
+
+      if (!entry->path_id)
+         entry->path_id = playlist_path_id_init(entry->path);
+
+      /* Entries must always have a path ID
+       * while the index is valid */
+      if (!entry->path_id)
+      {
+         playlist_path_index_free(playlist);
+         return false;
+      }
+
+      playlist_path_index_update(playlist, entry->path_id, 1);
+   }
+
+   return true;
+}
+
+/* Returns 'false' if no entry can match
+ * 'path_id', i.e. searching can be skipped */
+static bool playlist_path_index_may_match(playlist_t *playlist,
+      const playlist_path_id_t *path_id)
+{
+   /* Empty paths only match entries with
+    * empty paths, which are not indexed */
+   if (     string_is_empty(path_id->real_path)
+         || !playlist_path_index_init(playlist))
+      return true;
+
+   if (RHMAP_HAS(playlist->path_index, path_id->real_path_hash))
+      return true;
+
+#ifdef RARCH_INTERNAL
+   if (!playlist->config.fuzzy_archive_match)
+      return false;
+#endif
+
+   return path_id->archive_path &&
+         RHMAP_HAS(playlist->path_index, path_id->archive_path_hash);
+}
+
+/* Invalidates the cached path ID of 'entry'
+ * after its path has changed */
+static void playlist_entry_reset_path_id(playlist_t *playlist,
+      struct playlist_entry *entry)
+{
+   if (entry->path_id)
+   {
+      playlist_path_index_update(playlist, entry->path_id, -1);
+      playlist_path_id_free(entry->path_id);
+      entry->path_id = NULL;
+   }
+
+   if (!playlist->path_index_valid)
+      return;
+
+   if (!(entry->path_id = playlist_path_id_init(entry->path)))
+      playlist_path_index_free(playlist);
+   else
+      playlist_path_index_update(playlist, entry->path_id, 1);
+}
+
+/* Playlist search index
+ * > Each entry has a 64 bit signature, with one bit
+ *   set for each (hashed, lower case) trigram of its
+ *   label, path file name, core name and database name
+ * > A search term can only be contained in one of these
+ *   strings if the entry has all the bits of the term's
+ *   trigrams, so most entries are ruled out without
+ *   building or matching their menu labels
+ * > Case folding is the same as strcasestr()'s */
+
+static INLINE uint64_t playlist_search_trigram_bit(
+      int a, int b, int c)
+{
+   uint32_t hash = ((uint32_t)a * 0x9E3779B1)
+                 ^ ((uint32_t)b * 0x85EBCA77)
+                 ^ ((uint32_t)c * 0xC2B2AE3D);
+   return (uint64_t)1 << (hash >> 26);
+}
+
+static uint64_t playlist_search_add_string(uint64_t signature,
+      const char *str)
+{
+   int a, b;
+
+   if (!str || !str[0] || !str[1])
+      return signature;
+
+   a = tolower(str[0]);
+   b = tolower(str[1]);
+
+   for (str += 2; *str; str++)
+   {
+      int c      = tolower(*str);
+      signature |= playlist_search_trigram_bit(a, b, c);
+      a          = b;
+      b          = c;
+   }
+
+   return signature;
+}
+
+static void playlist_search_index_free(playlist_t *playlist)
+{
+   RBUF_FREE(playlist->search_index);
+   playlist->search_index_valid = false;
+}
+
+static bool playlist_search_index_init(playlist_t *playlist)
+{
+   size_t i;
+   size_t len = RBUF_LEN(playlist->entries);
+
+   if (playlist->search_index_valid)
+      return true;
+
+   if (!RBUF_TRYFIT(playlist->search_index, len))
+      return false;
+   RBUF_RESIZE(playlist->search_index, len);
+
+   for (i = 0; i < len; i++)
+   {
+      const struct playlist_entry *entry = &playlist->entries[i];
+      uint64_t signature                 = 0;
+
+      signature = playlist_search_add_string(signature, entry->label);
+      signature = playlist_search_add_string(signature,
+            path_basename(entry->path));
+      signature = playlist_search_add_string(signature, entry->core_name);
+      signature = playlist_search_add_string(signature, entry->db_name);
+
+      playlist->search_index[i] = signature;
+   }
+
+   playlist->search_index_valid = true;
+   return true;
+}
+
+uint64_t playlist_get_search_signature(const char *search_term)
+{
+   return playlist_search_add_string(0, search_term);
+}
+
+bool playlist_search_may_match(playlist_t *playlist, size_t idx,
+      uint64_t signature)
+{
+   if (     !signature
+         || !playlist
+         || (idx >= RBUF_LEN(playlist->entries))
+         || !playlist_search_index_init(playlist))
+      return true;
+
+   return (playlist->search_index[idx] & signature) == signature;
+}
+
 uint32_t playlist_get_size(playlist_t *playlist)
 {
    if (!playlist)
@@ -564,41 +807,58 @@ void playlist_get_index(playlist_t *playlist,
    *entry = &playlist->entries[idx];
 }
 
+/* Frees an entry string, unless it belongs
+ * to the playlist's binary cache buffer */
+static void playlist_free_string(const playlist_t *playlist, char *str)
+{
+   if (     playlist->cache_buf
+         && ((uintptr_t)str >= (uintptr_t)playlist->cache_buf)
+         && ((uintptr_t)str <  (uintptr_t)playlist->cache_buf
+            + playlist->cache_buf_size))
+      return;
+
+   free(str);
+}
+
 /**
  * playlist_free_entry:
  * @entry               : Playlist entry handle.
  *
  * Frees playlist entry.
  **/
-static void playlist_free_entry(struct playlist_entry *entry)
+static void playlist_free_entry(playlist_t *playlist,
+      struct playlist_entry *entry)
 {
    if (!entry)
       return;
 
    if (entry->path)
-      free(entry->path);
+      playlist_free_string(playlist, entry->path);
    if (entry->label)
-      free(entry->label);
+      playlist_free_string(playlist, entry->label);
    if (entry->core_path)
-      free(entry->core_path);
+      playlist_free_string(playlist, entry->core_path);
    if (entry->core_name)
-      free(entry->core_name);
+      playlist_free_string(playlist, entry->core_name);
    if (entry->db_name)
-      free(entry->db_name);
+      playlist_free_string(playlist, entry->db_name);
    if (entry->crc32)
-      free(entry->crc32);
+      playlist_free_string(playlist, entry->crc32);
    if (entry->subsystem_ident)
-      free(entry->subsystem_ident);
+      playlist_free_string(playlist, entry->subsystem_ident);
    if (entry->subsystem_name)
-      free(entry->subsystem_name);
+      playlist_free_string(playlist, entry->subsystem_name);
    if (entry->runtime_str)
-      free(entry->runtime_str);
+      playlist_free_string(playlist, entry->runtime_str);
    if (entry->last_played_str)
-      free(entry->last_played_str);
+      playlist_free_string(playlist, entry->last_played_str);
    if (entry->subsystem_roms)
       string_list_free(entry->subsystem_roms);
    if (entry->path_id)
+   {
+      playlist_path_index_update(playlist, entry->path_id, -1);
       playlist_path_id_free(entry->path_id);
+   }
 
    entry->path      = NULL;
    entry->label     = NULL;
@@ -647,7 +907,7 @@ void playlist_delete_index(playlist_t *playlist,
    /* Free unwanted entry */
    entry_to_delete = (struct playlist_entry *)(playlist->entries + idx);
    if (entry_to_delete)
-      playlist_free_entry(entry_to_delete);
+      playlist_free_entry(playlist, entry_to_delete);
 
    /* Shift remaining entries to fill the gap */
    memmove(playlist->entries + idx, playlist->entries + idx + 1,
@@ -655,6 +915,7 @@ void playlist_delete_index(playlist_t *playlist,
 
    RBUF_RESIZE(playlist->entries, len - 1);
 
+   playlist_search_index_free(playlist);
    playlist->modified = true;
 }
 
@@ -679,6 +940,12 @@ void playlist_delete_by_path(playlist_t *playlist,
    if (!path_id)
       return;
 
+   if (!playlist_path_index_may_match(playlist, path_id))
+   {
+      playlist_path_id_free(path_id);
+      return;
+   }
+
    while (i < RBUF_LEN(playlist->entries))
    {
       if (!playlist_path_matches_entry(path_id,
@@ -712,7 +979,10 @@ void playlist_get_index_by_path(playlist_t *playlist,
    if (!path_id)
       return;
 
-   for (i = 0, len = RBUF_LEN(playlist->entries); i < len; i++)
+   len = playlist_path_index_may_match(playlist, path_id)
+         ? RBUF_LEN(playlist->entries) : 0;
+
+   for (i = 0; i < len; i++)
    {
       if (!playlist_path_matches_entry(path_id,
             &playlist->entries[i], &playlist->config))
@@ -738,7 +1008,10 @@ bool playlist_entry_exists(playlist_t *playlist,
    if (!path_id)
       return false;
 
-   for (i = 0, len = RBUF_LEN(playlist->entries); i < len; i++)
+   len = playlist_path_index_may_match(playlist, path_id)
+         ? RBUF_LEN(playlist->entries) : 0;
+
+   for (i = 0; i < len; i++)
    {
       if (playlist_path_matches_entry(path_id,
             &playlist->entries[i], &playlist->config))
@@ -765,14 +1038,11 @@ void playlist_update(playlist_t *playlist, size_t idx,
    if (update_entry->path && (update_entry->path != entry->path))
    {
       if (entry->path)
-         free(entry->path);
+         playlist_free_string(playlist, entry->path);
       entry->path        = strdup(update_entry->path);
+      playlist_search_index_free(playlist);
 
-      if (entry->path_id)
-      {
-         playlist_path_id_free(entry->path_id);
-         entry->path_id  = NULL;
-      }
+      playlist_entry_reset_path_id(playlist, entry);
 
       playlist->modified = true;
    }
@@ -780,15 +1050,16 @@ void playlist_update(playlist_t *playlist, size_t idx,
    if (update_entry->label && (update_entry->label != entry->label))
    {
       if (entry->label)
-         free(entry->label);
+         playlist_free_string(playlist, entry->label);
       entry->label       = strdup(update_entry->label);
+      playlist_search_index_free(playlist);
       playlist->modified = true;
    }
 
    if (update_entry->core_path && (update_entry->core_path != entry->core_path))
    {
       if (entry->core_path)
-         free(entry->core_path);
+         playlist_free_string(playlist, entry->core_path);
       entry->core_path   = NULL;
       entry->core_path   = strdup(update_entry->core_path);
       playlist->modified = true;
@@ -797,23 +1068,25 @@ void playlist_update(playlist_t *playlist, size_t idx,
    if (update_entry->core_name && (update_entry->core_name != entry->core_name))
    {
       if (entry->core_name)
-         free(entry->core_name);
+         playlist_free_string(playlist, entry->core_name);
       entry->core_name   = strdup(update_entry->core_name);
+      playlist_search_index_free(playlist);
       playlist->modified = true;
    }
 
    if (update_entry->db_name && (update_entry->db_name != entry->db_name))
    {
       if (entry->db_name)
-         free(entry->db_name);
+         playlist_free_string(playlist, entry->db_name);
       entry->db_name     = strdup(update_entry->db_name);
+      playlist_search_index_free(playlist);
       playlist->modified = true;
    }
 
    if (update_entry->crc32 && (update_entry->crc32 != entry->crc32))
    {
       if (entry->crc32)
-         free(entry->crc32);
+         playlist_free_string(playlist, entry->crc32);
       entry->crc32       = strdup(update_entry->crc32);
       playlist->modified = true;
    }
@@ -833,14 +1106,11 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
    if (update_entry->path && (update_entry->path != entry->path))
    {
       if (entry->path)
-         free(entry->path);
+         playlist_free_string(playlist, entry->path);
       entry->path        = strdup(update_entry->path);
 
-      if (entry->path_id)
-      {
-         playlist_path_id_free(entry->path_id);
-         entry->path_id  = NULL;
-      }
+      playlist_entry_reset_path_id(playlist, entry);
+      playlist_search_index_free(playlist);
 
       playlist->modified = playlist->modified || register_update;
    }
@@ -848,7 +1118,7 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
    if (update_entry->core_path && (update_entry->core_path != entry->core_path))
    {
       if (entry->core_path)
-         free(entry->core_path);
+         playlist_free_string(playlist, entry->core_path);
       entry->core_path   = NULL;
       entry->core_path   = strdup(update_entry->core_path);
       playlist->modified = playlist->modified || register_update;
@@ -917,7 +1187,7 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
    if (update_entry->runtime_str && (update_entry->runtime_str != entry->runtime_str))
    {
       if (entry->runtime_str)
-         free(entry->runtime_str);
+         playlist_free_string(playlist, entry->runtime_str);
       entry->runtime_str = NULL;
       entry->runtime_str = strdup(update_entry->runtime_str);
       playlist->modified = playlist->modified || register_update;
@@ -926,7 +1196,7 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
    if (update_entry->last_played_str && (update_entry->last_played_str != entry->last_played_str))
    {
       if (entry->last_played_str)
-         free(entry->last_played_str);
+         playlist_free_string(playlist, entry->last_played_str);
       entry->last_played_str = NULL;
       entry->last_played_str = strdup(update_entry->last_played_str);
       playlist->modified = playlist->modified || register_update;
@@ -937,7 +1207,7 @@ bool playlist_push_runtime(playlist_t *playlist,
       const struct playlist_entry *entry)
 {
    playlist_path_id_t *path_id = NULL;
-   size_t i, len;
+   size_t i, len, search_len;
    char real_core_path[PATH_MAX_LENGTH];
 
    if (!playlist || !entry)
@@ -969,8 +1239,9 @@ bool playlist_push_runtime(playlist_t *playlist,
       goto error;
    }
 
-   len = RBUF_LEN(playlist->entries);
-   for (i = 0; i < len; i++)
+   len        = RBUF_LEN(playlist->entries);
+   search_len = playlist_path_index_may_match(playlist, path_id) ? len : 0;
+   for (i = 0; i < search_len; i++)
    {
       struct playlist_entry tmp;
       bool equal_path  = (string_is_empty(path_id->real_path) &&
@@ -1007,7 +1278,7 @@ bool playlist_push_runtime(playlist_t *playlist,
    if (len == playlist->config.capacity)
    {
       struct playlist_entry *last_entry = &playlist->entries[len - 1];
-      playlist_free_entry(last_entry);
+      playlist_free_entry(playlist, last_entry);
       len--;
    }
    else
@@ -1029,6 +1300,7 @@ bool playlist_push_runtime(playlist_t *playlist,
       if (!string_is_empty(path_id->real_path))
          playlist->entries[0].path         = strdup(path_id->real_path);
       playlist->entries[0].path_id         = path_id;
+      playlist_path_index_update(playlist, path_id, 1);
       path_id                              = NULL;
 
       if (!string_is_empty(real_core_path))
@@ -1057,6 +1329,7 @@ bool playlist_push_runtime(playlist_t *playlist,
 success:
    if (path_id)
       playlist_path_id_free(path_id);
+   playlist_search_index_free(playlist);
    playlist->modified = true;
    return true;
 
@@ -1123,6 +1396,219 @@ void playlist_resolve_path(enum playlist_file_mode mode,
 #endif
 }
 
+/* Playlist journal
+ * > Pushing an entry onto a playlist that is otherwise
+ *   unchanged since it was loaded or saved does not
+ *   mark it as modified. The entry is instead recorded
+ *   in a journal, which playlist_write_file() appends
+ *   to a file next to the playlist (with
+ *   FILE_PATH_LPL_JOURNAL_EXTENSION appended). Saving
+ *   content history on each launch therefore no longer
+ *   rewrites the whole playlist file
+ * > The journal is replayed through playlist_push()
+ *   when the playlist is loaded, and only while the
+ *   playlist file matches the fingerprint recorded
+ *   in the journal header
+ * > Once it holds more than PLAYLIST_JOURNAL_MAX_RECORDS
+ *   records (or on any other modification), the
+ *   playlist file is rewritten and the journal removed
+ * > Layout (all values are little endian uint32):
+ *   - header (PLAYLIST_JOURNAL_HEADER_SIZE values)
+ *   - records: payload size, payload crc32, payload
+ *   - payload: number of subsystem roms, followed
+ *     by the entry strings and subsystem roms, each
+ *     stored as the string length (PLAYLIST_JOURNAL_NULL
+ *     for NULL strings) and the NUL-terminated string */
+
+#define PLAYLIST_JOURNAL_MAGIC   0x4A4C5052 /* "RPLJ" */
+#define PLAYLIST_JOURNAL_VERSION 1
+
+#define PLAYLIST_JOURNAL_HEADER_SIZE 5
+#define PLAYLIST_JOURNAL_MAX_RECORDS 32
+
+/* String length used for NULL strings */
+#define PLAYLIST_JOURNAL_NULL 0xFFFFFFFF
+
+/* Same order as playlist_cache_entry_strings() */
+#define PLAYLIST_JOURNAL_NUM_STRINGS 8
+
+static uint8_t *playlist_journal_put_u32(uint8_t *s, uint32_t val)
+{
+   s[0] = (uint8_t)val;
+   s[1] = (uint8_t)(val >> 8);
+   s[2] = (uint8_t)(val >> 16);
+   s[3] = (uint8_t)(val >> 24);
+   return s + 4;
+}
+
+static uint8_t *playlist_journal_put_string(uint8_t *s, const char *str)
+{
+   size_t len;
+
+   if (!str)
+      return playlist_journal_put_u32(s, PLAYLIST_JOURNAL_NULL);
+
+   len = strlen(str);
+   s   = playlist_journal_put_u32(s, (uint32_t)len);
+   memcpy(s, str, len + 1);
+   return s + len + 1;
+}
+
+/* Records the pushing of 'entry' in the journal
+ * of 'playlist'. Returns false on failure, in
+ * which case the playlist must be rewritten */
+static bool playlist_journal_push(playlist_t *playlist,
+      const struct playlist_entry *entry)
+{
+   size_t i;
+   uint8_t *s;
+   const char *strings[PLAYLIST_JOURNAL_NUM_STRINGS];
+   size_t offset   = RBUF_LEN(playlist->journal);
+   size_t size     = 4;
+   size_t num_roms = entry->subsystem_roms
+         ? entry->subsystem_roms->size : 0;
+
+   strings[0] = entry->path;
+   strings[1] = entry->label;
+   strings[2] = entry->core_path;
+   strings[3] = entry->core_name;
+   strings[4] = entry->db_name;
+   strings[5] = entry->crc32;
+   strings[6] = entry->subsystem_ident;
+   strings[7] = entry->subsystem_name;
+
+   for (i = 0; i < PLAYLIST_JOURNAL_NUM_STRINGS; i++)
+      size += 4 + (strings[i] ? strlen(strings[i]) + 1 : 0);
+   for (i = 0; i < num_roms; i++)
+      size += 4 + (entry->subsystem_roms->elems[i].data
+            ? strlen(entry->subsystem_roms->elems[i].data) + 1 : 0);
+
+   if (!RBUF_TRYFIT(playlist->journal, offset + 8 + size))
+      return false;
+   RBUF_RESIZE(playlist->journal, offset + 8 + size);
+
+   s = playlist_journal_put_u32(playlist->journal + offset + 8,
+         (uint32_t)num_roms);
+   for (i = 0; i < PLAYLIST_JOURNAL_NUM_STRINGS; i++)
+      s = playlist_journal_put_string(s, strings[i]);
+   for (i = 0; i < num_roms; i++)
+      s = playlist_journal_put_string(s,
+            entry->subsystem_roms->elems[i].data);
+
+   s = playlist_journal_put_u32(playlist->journal + offset,
+         (uint32_t)size);
+   playlist_journal_put_u32(s, encoding_crc32(0, s + 4, size));
+
+   playlist->journal_pending++;
+   return true;
+}
+
+/* Resolves the core path and name that 'entry' gets
+ * pushed with. '*core_name' may point to a static buffer
+ * until the next call */
+static bool playlist_push_get_core(const struct playlist_entry *entry,
+      char *real_core_path, size_t len, const char **core_name)
+{
+   *core_name = entry->core_name;
+
+   if (string_is_empty(entry->core_path))
+   {
+      RARCH_ERR("cannot push NULL or empty core path into the playlist.\n");
+      return false;
+   }
+
+   /* Get 'real' core path */
+   strlcpy(real_core_path, entry->core_path, len);
+   if (!string_is_equal(real_core_path, FILE_PATH_DETECT) &&
+       !string_is_equal(real_core_path, FILE_PATH_BUILTIN))
+      playlist_resolve_path(PLAYLIST_SAVE, true, real_core_path, len);
+
+   if (string_is_empty(real_core_path))
+   {
+      RARCH_ERR("cannot push NULL or empty core path into the playlist.\n");
+      return false;
+   }
+
+   if (string_is_empty(*core_name))
+   {
+      static char base_path[255] = {0};
+      fill_pathname_base_noext(base_path, real_core_path, sizeof(base_path));
+      *core_name = base_path;
+
+      if (string_is_empty(*core_name))
+      {
+         RARCH_ERR("cannot push NULL or empty core name into the playlist.\n");
+         return false;
+      }
+   }
+
+   return true;
+}
+
+/* Sets up 'dst' as a new playlist entry for 'entry',
+ * counting it in the path index. Takes ownership
+ * of 'path_id' */
+static void playlist_entry_init_new(playlist_t *playlist,
+      struct playlist_entry *dst, const struct playlist_entry *entry,
+      playlist_path_id_t *path_id,
+      const char *real_core_path, const char *core_name)
+{
+   size_t i;
+
+   dst->path               = NULL;
+   dst->label              = NULL;
+   dst->core_path          = NULL;
+   dst->core_name          = NULL;
+   dst->db_name            = NULL;
+   dst->crc32              = NULL;
+   dst->subsystem_ident    = NULL;
+   dst->subsystem_name     = NULL;
+   dst->runtime_str        = NULL;
+   dst->last_played_str    = NULL;
+   dst->subsystem_roms     = NULL;
+   dst->path_id            = NULL;
+   dst->runtime_status     = PLAYLIST_RUNTIME_UNKNOWN;
+   dst->runtime_hours      = 0;
+   dst->runtime_minutes    = 0;
+   dst->runtime_seconds    = 0;
+   dst->last_played_year   = 0;
+   dst->last_played_month  = 0;
+   dst->last_played_day    = 0;
+   dst->last_played_hour   = 0;
+   dst->last_played_minute = 0;
+   dst->last_played_second = 0;
+
+   if (!string_is_empty(path_id->real_path))
+      dst->path            = strdup(path_id->real_path);
+   dst->path_id            = path_id;
+   playlist_path_index_update(playlist, path_id, 1);
+
+   if (!string_is_empty(entry->label))
+      dst->label           = strdup(entry->label);
+   if (!string_is_empty(real_core_path))
+      dst->core_path       = strdup(real_core_path);
+   if (!string_is_empty(core_name))
+      dst->core_name       = strdup(core_name);
+   if (!string_is_empty(entry->db_name))
+      dst->db_name         = strdup(entry->db_name);
+   if (!string_is_empty(entry->crc32))
+      dst->crc32           = strdup(entry->crc32);
+   if (!string_is_empty(entry->subsystem_ident))
+      dst->subsystem_ident = strdup(entry->subsystem_ident);
+   if (!string_is_empty(entry->subsystem_name))
+      dst->subsystem_name  = strdup(entry->subsystem_name);
+
+   if (entry->subsystem_roms)
+   {
+      union string_list_elem_attr attributes = {0};
+
+      dst->subsystem_roms    = string_list_new();
+
+      for (i = 0; i < entry->subsystem_roms->size; i++)
+         string_list_append(dst->subsystem_roms, entry->subsystem_roms->elems[i].data, attributes);
+   }
+}
+
 /**
  * playlist_push:
  * @playlist        	   : Playlist handle.
@@ -1132,256 +1618,1140 @@ void playlist_resolve_path(enum playlist_file_mode mode,
 bool playlist_push(playlist_t *playlist,
       const struct playlist_entry *entry)
 {
-   size_t i, len;
+   size_t i, len, search_len;
    char real_core_path[PATH_MAX_LENGTH];
    playlist_path_id_t *path_id = NULL;
-   const char *core_name       = entry->core_name;
+   const char *core_name       = NULL;
    bool entry_updated          = false;
 
-   real_core_path[0] = '\0';
+   real_core_path[0] = '\0';
+
+   if (!playlist || !entry)
+      goto error;
+
+   if (!playlist_push_get_core(entry, real_core_path,
+            sizeof(real_core_path), &core_name))
+      goto error;
+
+   /* Get path ID */
+   path_id = playlist_path_id_init(entry->path);
+   if (!path_id)
+      goto error;
+
+   len        = RBUF_LEN(playlist->entries);
+   search_len = playlist_path_index_may_match(playlist, path_id) ? len : 0;
+   for (i = 0; i < search_len; i++)
+   {
+      struct playlist_entry tmp;
+      bool equal_path  = (string_is_empty(path_id->real_path) &&
+            string_is_empty(playlist->entries[i].path));
+
+      equal_path       = equal_path || playlist_path_matches_entry(
+            path_id, &playlist->entries[i], &playlist->config);
+
+      if (!equal_path)
+         continue;
+
+      /* Core name can have changed while still being the same core.
+       * Differentiate based on the core path only. */
+      if (!playlist_core_path_equal(real_core_path, playlist->entries[i].core_path, &playlist->config))
+         continue;
+
+      if (     !string_is_empty(entry->subsystem_ident)
+            && !string_is_empty(playlist->entries[i].subsystem_ident)
+            && !string_is_equal(playlist->entries[i].subsystem_ident, entry->subsystem_ident))
+         continue;
+
+      if (      string_is_empty(entry->subsystem_ident)
+            && !string_is_empty(playlist->entries[i].subsystem_ident))
+         continue;
+
+      if (    !string_is_empty(entry->subsystem_ident)
+            && string_is_empty(playlist->entries[i].subsystem_ident))
+         continue;
+
+      if (     !string_is_empty(entry->subsystem_name)
+            && !string_is_empty(playlist->entries[i].subsystem_name)
+            && !string_is_equal(playlist->entries[i].subsystem_name, entry->subsystem_name))
+         continue;
+
+      if (      string_is_empty(entry->subsystem_name)
+            && !string_is_empty(playlist->entries[i].subsystem_name))
+         continue;
+
+      if (     !string_is_empty(entry->subsystem_name)
+            &&  string_is_empty(playlist->entries[i].subsystem_name))
+         continue;
+
+      if (entry->subsystem_roms)
+      {
+         unsigned j;
+         const struct string_list *roms = playlist->entries[i].subsystem_roms;
+         bool                   unequal = false;
+
+         if (entry->subsystem_roms->size != roms->size)
+            continue;
+
+         for (j = 0; j < entry->subsystem_roms->size; j++)
+         {
+            char real_rom_path[PATH_MAX_LENGTH];
+
+            real_rom_path[0] = '\0';
+
+            if (!string_is_empty(entry->subsystem_roms->elems[j].data))
+            {
+               strlcpy(real_rom_path, entry->subsystem_roms->elems[j].data, sizeof(real_rom_path));
+               path_resolve_realpath(real_rom_path, sizeof(real_rom_path), true);
+            }
+
+            if (!playlist_path_equal(real_rom_path, roms->elems[j].data,
+                     &playlist->config))
+            {
+               unequal = true;
+               break;
+            }
+         }
+
+         if (unequal)
+            continue;
+      }
+
+      /* If content was previously loaded via file browser
+       * or command line, certain entry values will be missing.
+       * If we are now loading the same content from a playlist,
+       * fill in any blanks */
+      if (!playlist->entries[i].label && !string_is_empty(entry->label))
+      {
+         playlist->entries[i].label   = strdup(entry->label);
+         entry_updated                = true;
+      }
+      if (!playlist->entries[i].crc32 && !string_is_empty(entry->crc32))
+      {
+         playlist->entries[i].crc32   = strdup(entry->crc32);
+         entry_updated                = true;
+      }
+      if (!playlist->entries[i].db_name && !string_is_empty(entry->db_name))
+      {
+         playlist->entries[i].db_name = strdup(entry->db_name);
+         entry_updated                = true;
+      }
+
+      /* If top entry, we don't want to push a new entry since
+       * the top and the entry to be pushed are the same. */
+      if (i == 0)
+      {
+         if (entry_updated)
+            goto success;
+
+         goto error;
+      }
+
+      /* Seen it before, bump to top. */
+      tmp = playlist->entries[i];
+      memmove(playlist->entries + 1, playlist->entries,
+            i * sizeof(struct playlist_entry));
+      playlist->entries[0] = tmp;
+
+      goto success;
+   }
+
+   if (playlist->config.capacity == 0)
+      goto error;
+
+   if (len == playlist->config.capacity)
+   {
+      struct playlist_entry *last_entry = &playlist->entries[len - 1];
+      playlist_free_entry(playlist, last_entry);
+      len--;
+   }
+   else
+   {
+      /* Allocate memory to fit one more item and resize the buffer */
+      if (!RBUF_TRYFIT(playlist->entries, len + 1))
+         goto error; /* out of memory */
+      RBUF_RESIZE(playlist->entries, len + 1);
+   }
+
+   if (playlist->entries)
+   {
+      memmove(playlist->entries + 1, playlist->entries,
+            len * sizeof(struct playlist_entry));
+
+      playlist_entry_init_new(playlist, &playlist->entries[0],
+            entry, path_id, real_core_path, core_name);
+      path_id = NULL;
+   }
+
+success:
+   if (path_id)
+      playlist_path_id_free(path_id);
+   playlist_search_index_free(playlist);
+   if (playlist->modified || !playlist_journal_push(playlist, entry))
+      playlist->modified = true;
+   return true;
+
+error:
+   if (path_id)
+      playlist_path_id_free(path_id);
+   return false;
+}
+
+/* Moves the new entries staged by playlist_push_batch()
+ * to the top of the playlist, with the same result as
+ * pushing them one by one. Returns the number moved */
+static size_t playlist_push_batch_flush(playlist_t *playlist,
+      struct playlist_entry **staged)
+{
+   size_t i;
+   size_t count    = RBUF_LEN(*staged);
+   size_t len      = RBUF_LEN(playlist->entries);
+   size_t capacity = playlist->config.capacity;
+   size_t keep     = (count < capacity) ? count : capacity;
+   size_t old_keep = (len < capacity - keep) ? len : capacity - keep;
+
+   if (!count)
+      return 0;
+
+   if (!RBUF_TRYFIT(playlist->entries, old_keep + keep))
+   {
+      /* Journal no longer matches the playlist */
+      for (i = 0; i < count; i++)
+         playlist_free_entry(playlist, &(*staged)[i]);
+      RBUF_CLEAR(*staged);
+      playlist->modified = true;
+      return 0;
+   }
+
+   /* A full playlist loses its oldest entries first,
+    * then the first entries of the batch */
+   for (i = 0; i < count - keep; i++)
+      playlist_free_entry(playlist, &(*staged)[i]);
+   for (i = old_keep; i < len; i++)
+      playlist_free_entry(playlist, &playlist->entries[i]);
+
+   RBUF_RESIZE(playlist->entries, old_keep + keep);
+   memmove(playlist->entries + keep, playlist->entries,
+         old_keep * sizeof(struct playlist_entry));
+
+   for (i = 0; i < keep; i++)
+      playlist->entries[i] = (*staged)[count - 1 - i];
+
+   RBUF_CLEAR(*staged);
+   playlist_search_index_free(playlist);
+   return count;
+}
+
+size_t playlist_push_batch(playlist_t *playlist,
+      const struct playlist_entry *entries, size_t count)
+{
+   size_t i;
+   size_t pushed                 = 0;
+   struct playlist_entry *staged = NULL;
+
+   if (!playlist || !entries || playlist->config.capacity == 0)
+      return 0;
+
+   for (i = 0; i < count; i++)
+   {
+      char real_core_path[PATH_MAX_LENGTH];
+      struct playlist_entry new_entry;
+      const struct playlist_entry *entry = &entries[i];
+      const char *core_name              = NULL;
+      playlist_path_id_t *path_id        = NULL;
+
+      real_core_path[0] = '\0';
+
+      if (!playlist_push_get_core(entry, real_core_path,
+               sizeof(real_core_path), &core_name))
+         continue;
+
+      if (!(path_id = playlist_path_id_init(entry->path)))
+         continue;
+
+      /* Entries that may already be in the playlist, or
+       * in the batch, get pushed the regular way */
+      if (     playlist_path_index_may_match(playlist, path_id)
+            || !RBUF_TRYFIT(staged, RBUF_LEN(staged) + 1))
+      {
+         playlist_path_id_free(path_id);
+         pushed += playlist_push_batch_flush(playlist, &staged);
+         if (playlist_push(playlist, entry))
+            pushed++;
+         continue;
+      }
+
+      playlist_entry_init_new(playlist, &new_entry,
+            entry, path_id, real_core_path, core_name);
+      RBUF_PUSH(staged, new_entry);
+
+      if (playlist->modified || !playlist_journal_push(playlist, entry))
+         playlist->modified = true;
+   }
+
+   pushed += playlist_push_batch_flush(playlist, &staged);
+   RBUF_FREE(staged);
+
+   return pushed;
+}
+
+/* Binary playlist cache
+ * > Written next to each playlist file (with
+ *   FILE_PATH_LPL_CACHE_EXTENSION appended), and only
+ *   used while the size and fingerprint (modification
+ *   time and contents) of the playlist file match those
+ *   recorded in the cache. The playlist file therefore
+ *   always remains the source of truth
+ * > Only holds what playlist_write_file() stores, so
+ *   loading the cache gives the same result as parsing
+ *   the file. Playlists in the old format are not cached
+ * > Layout (all values are little endian uint32):
+ *   - header (PLAYLIST_CACHE_HEADER_SIZE values)
+ *   - one record of PLAYLIST_CACHE_RECORD_SIZE values
+ *     per entry: string offsets and subsystem roms
+ *   - table of NUL-terminated strings; identical
+ *     strings (e.g. core paths) are only stored once
+ * > On load, entry strings point directly into the
+ *   cache buffer instead of being duplicated */
+
+#define PLAYLIST_CACHE_MAGIC   0x434C5052 /* "RPLC" */
+#define PLAYLIST_CACHE_VERSION 1
+
+#define PLAYLIST_CACHE_HEADER_SIZE 16
+#define PLAYLIST_CACHE_RECORD_SIZE 10
+#define PLAYLIST_CACHE_NUM_STRINGS 8
+
+/* String offset used for NULL strings */
+#define PLAYLIST_CACHE_NULL 0xFFFFFFFF
+
+/* Size of the regions at the start and end of
+ * the playlist file included in its fingerprint */
+#define PLAYLIST_CACHE_FINGERPRINT_SIZE (64 * 1024)
+
+enum playlist_cache_header
+{
+   PLAYLIST_CACHE_HDR_MAGIC = 0,
+   PLAYLIST_CACHE_HDR_VERSION,
+   PLAYLIST_CACHE_HDR_FILE_SIZE_LO,
+   PLAYLIST_CACHE_HDR_FILE_SIZE_HI,
+   PLAYLIST_CACHE_HDR_FILE_CRC,
+   PLAYLIST_CACHE_HDR_FLAGS,
+   PLAYLIST_CACHE_HDR_NUM_ENTRIES,
+   PLAYLIST_CACHE_HDR_STRINGS_SIZE,
+   PLAYLIST_CACHE_HDR_DEFAULT_CORE_PATH,
+   PLAYLIST_CACHE_HDR_DEFAULT_CORE_NAME,
+   PLAYLIST_CACHE_HDR_BASE_CONTENT_DIR,
+   PLAYLIST_CACHE_HDR_LABEL_DISPLAY_MODE,
+   PLAYLIST_CACHE_HDR_RIGHT_THUMBNAIL_MODE,
+   PLAYLIST_CACHE_HDR_LEFT_THUMBNAIL_MODE,
+   PLAYLIST_CACHE_HDR_SORT_MODE
+};
+
+enum playlist_cache_record
+{
+   /* First PLAYLIST_CACHE_NUM_STRINGS values
+    * are string offsets, in the order returned
+    * by playlist_cache_entry_strings() */
+   PLAYLIST_CACHE_REC_SUBSYSTEM_ROMS = PLAYLIST_CACHE_NUM_STRINGS,
+   PLAYLIST_CACHE_REC_NUM_SUBSYSTEM_ROMS
+};
+
+#define PLAYLIST_CACHE_FLAG_COMPRESSED (1 << 0)
+
+typedef struct
+{
+   char *strings;
+   uint32_t *slots; /* String offset + 1, 0 if empty */
+   size_t strings_size;
+   size_t strings_capacity;
+   size_t num_slots;
+   bool out_of_memory;
+} playlist_cache_writer_t;
+
+static void playlist_cache_entry_strings(struct playlist_entry *entry,
+      char ***strings)
+{
+   strings[0] = &entry->path;
+   strings[1] = &entry->label;
+   strings[2] = &entry->core_path;
+   strings[3] = &entry->core_name;
+   strings[4] = &entry->db_name;
+   strings[5] = &entry->crc32;
+   strings[6] = &entry->subsystem_ident;
+   strings[7] = &entry->subsystem_name;
+}
+
+static void playlist_cache_get_path(const char *playlist_path,
+      char *s, size_t len)
+{
+   strlcpy(s, playlist_path, len);
+   strlcat(s, FILE_PATH_LPL_CACHE_EXTENSION, len);
+}
+
+/* Identifies the current contents of the playlist
+ * file. Where its modification time is known, that is
+ * combined with the start and end of the file, so an
+ * edit that keeps the size still changes the fingerprint
+ * without reading all of the file. Otherwise the whole
+ * file is checksummed */
+static bool playlist_cache_get_fingerprint(const char *path,
+      uint64_t *file_size, uint32_t *crc)
+{
+   uint8_t *buf;
+   int64_t size;
+   int64_t len;
+   int64_t mtime = 0;
+   bool has_mtime = path_get_mtime(path, &mtime);
+   RFILE *file    = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   size = filestream_get_size(file);
+   buf  = (uint8_t*)malloc(PLAYLIST_CACHE_FINGERPRINT_SIZE);
+
+   if ((size < 0) || !buf)
+      goto error;
+
+   *file_size = (uint64_t)size;
+   *crc       = 0;
+
+   if (has_mtime)
+   {
+      unsigned i;
+      uint8_t stamp[8];
+
+      for (i = 0; i < sizeof(stamp); i++)
+         stamp[i] = (uint8_t)((uint64_t)mtime >> (i * 8));
+      *crc = encoding_crc32(*crc, stamp, sizeof(stamp));
+   }
+
+   /* Start of file */
+   len = filestream_read(file, buf, PLAYLIST_CACHE_FINGERPRINT_SIZE);
+   if (len < 0)
+      goto error;
+   *crc = encoding_crc32(*crc, buf, (size_t)len);
+
+   if (!has_mtime)
+   {
+      /* Rest of file */
+      while ((len = filestream_read(file, buf,
+                  PLAYLIST_CACHE_FINGERPRINT_SIZE)) > 0)
+         *crc = encoding_crc32(*crc, buf, (size_t)len);
+      if (len < 0)
+         goto error;
+   }
+   else
+   {
+      /* End of file, if not already covered */
+      if (size > 2 * PLAYLIST_CACHE_FINGERPRINT_SIZE)
+      {
+         if (filestream_seek(file, size - PLAYLIST_CACHE_FINGERPRINT_SIZE,
+                  RETRO_VFS_SEEK_POSITION_START) != 0)
+            goto error;
+      }
+
+      len = filestream_read(file, buf, PLAYLIST_CACHE_FINGERPRINT_SIZE);
+      if (len < 0)
+         goto error;
+      *crc = encoding_crc32(*crc, buf, (size_t)len);
+   }
+
+   free(buf);
+   filestream_close(file);
+   return true;
+
+error:
+   if (buf)
+      free(buf);
+   filestream_close(file);
+   return false;
+}
+
+/* Returns the string table offset of 'str', adding
+ * it to the table if required */
+static uint32_t playlist_cache_intern(playlist_cache_writer_t *writer,
+      const char *str)
+{
+   size_t len;
+   size_t slot;
+   uint32_t hash = 5381;
+   const unsigned char *c;
+
+   if (!str)
+      return PLAYLIST_CACHE_NULL;
+
+   for (c = (const unsigned char*)str; *c; c++)
+      hash = ((hash << 5) + hash) + *c;
+
+   len  = (size_t)((const char*)c - str) + 1;
+   slot = hash & (writer->num_slots - 1);
+
+   /* Linear probing - the table is sized so
+    * that it can never be full */
+   while (writer->slots[slot])
+   {
+      uint32_t offset = writer->slots[slot] - 1;
+
+      if (string_is_equal(writer->strings + offset, str))
+         return offset;
+
+      slot = (slot + 1) & (writer->num_slots - 1);
+   }
+
+   if (writer->strings_size + len > writer->strings_capacity)
+   {
+      size_t capacity = writer->strings_capacity * 2;
+      char *strings;
+
+      while (writer->strings_size + len > capacity)
+         capacity *= 2;
+
+      if (!(strings = (char*)realloc(writer->strings, capacity)))
+      {
+         writer->out_of_memory = true;
+         return PLAYLIST_CACHE_NULL;
+      }
+
+      writer->strings          = strings;
+      writer->strings_capacity = capacity;
+   }
+
+   memcpy(writer->strings + writer->strings_size, str, len);
+   writer->slots[slot]   = (uint32_t)writer->strings_size + 1;
+   writer->strings_size += len;
+
+   return (uint32_t)(writer->strings_size - len);
+}
+
+/* Appends a string without interning it
+ * (subsystem roms are stored contiguously) */
+static uint32_t playlist_cache_append(playlist_cache_writer_t *writer,
+      const char *str)
+{
+   size_t len = strlen(str) + 1;
+
+   if (writer->strings_size + len > writer->strings_capacity)
+   {
+      size_t capacity = writer->strings_capacity * 2;
+      char *strings;
+
+      while (writer->strings_size + len > capacity)
+         capacity *= 2;
+
+      if (!(strings = (char*)realloc(writer->strings, capacity)))
+      {
+         writer->out_of_memory = true;
+         return PLAYLIST_CACHE_NULL;
+      }
+
+      writer->strings          = strings;
+      writer->strings_capacity = capacity;
+   }
+
+   memcpy(writer->strings + writer->strings_size, str, len);
+   writer->strings_size += len;
+
+   return (uint32_t)(writer->strings_size - len);
+}
+
+/* Writes the binary cache of 'playlist', which
+ * must match the current playlist file */
+static void playlist_write_cache(playlist_t *playlist)
+{
+   char cache_path[PATH_MAX_LENGTH];
+   playlist_cache_writer_t writer;
+   size_t i, j;
+   uint64_t file_size;
+   uint32_t file_crc;
+   size_t num_entries = RBUF_LEN(playlist->entries);
+   size_t records_len = num_entries * PLAYLIST_CACHE_RECORD_SIZE;
+   uint32_t *data     = NULL;
+   uint32_t *records  = NULL;
+   size_t max_strings = num_entries * PLAYLIST_CACHE_NUM_STRINGS + 3;
+
+   if (playlist->old_format)
+      return;
+
+   playlist_cache_get_path(playlist->config.path,
+         cache_path, sizeof(cache_path));
+
+   if (!playlist_cache_get_fingerprint(playlist->config.path,
+            &file_size, &file_crc))
+      return;
+
+   writer.strings          = (char*)malloc(64 * 1024);
+   writer.strings_size     = 0;
+   writer.strings_capacity = 64 * 1024;
+   writer.out_of_memory    = false;
+
+   /* Twice the maximum number of unique strings,
+    * rounded up to a power of two */
+   for (writer.num_slots = 64; writer.num_slots < max_strings * 2;)
+      writer.num_slots *= 2;
+   writer.slots = (uint32_t*)calloc(writer.num_slots, sizeof(uint32_t));
+
+   data = (uint32_t*)malloc((PLAYLIST_CACHE_HEADER_SIZE + records_len)
+         * sizeof(uint32_t));
+
+   if (!writer.strings || !writer.slots || !data)
+      goto end;
+
+   records = data + PLAYLIST_CACHE_HEADER_SIZE;
+
+   for (i = 0; i < num_entries; i++)
+   {
+      char **strings[PLAYLIST_CACHE_NUM_STRINGS];
+      struct playlist_entry *entry = &playlist->entries[i];
+      uint32_t *record             = records + i * PLAYLIST_CACHE_RECORD_SIZE;
+
+      playlist_cache_entry_strings(entry, strings);
+
+      for (j = 0; j < PLAYLIST_CACHE_NUM_STRINGS; j++)
+         record[j] = playlist_cache_intern(&writer, *strings[j]);
+
+      record[PLAYLIST_CACHE_REC_SUBSYSTEM_ROMS]     = PLAYLIST_CACHE_NULL;
+      record[PLAYLIST_CACHE_REC_NUM_SUBSYSTEM_ROMS] = 0;
+
+      if (entry->subsystem_roms)
+      {
+         for (j = 0; j < entry->subsystem_roms->size; j++)
+         {
+            uint32_t offset = playlist_cache_append(&writer,
+                  entry->subsystem_roms->elems[j].data
+                  ? entry->subsystem_roms->elems[j].data : "");
+
+            if (j == 0)
+               record[PLAYLIST_CACHE_REC_SUBSYSTEM_ROMS] = offset;
+         }
+
+         record[PLAYLIST_CACHE_REC_NUM_SUBSYSTEM_ROMS] =
+               (uint32_t)entry->subsystem_roms->size;
+      }
+   }
+
+   data[PLAYLIST_CACHE_HDR_MAGIC]                = PLAYLIST_CACHE_MAGIC;
+   data[PLAYLIST_CACHE_HDR_VERSION]              = PLAYLIST_CACHE_VERSION;
+   data[PLAYLIST_CACHE_HDR_FILE_SIZE_LO]         = (uint32_t)file_size;
+   data[PLAYLIST_CACHE_HDR_FILE_SIZE_HI]         = (uint32_t)(file_size >> 32);
+   data[PLAYLIST_CACHE_HDR_FILE_CRC]             = file_crc;
+   data[PLAYLIST_CACHE_HDR_FLAGS]                =
+         playlist->compressed ? PLAYLIST_CACHE_FLAG_COMPRESSED : 0;
+   data[PLAYLIST_CACHE_HDR_NUM_ENTRIES]          = (uint32_t)num_entries;
+   data[PLAYLIST_CACHE_HDR_DEFAULT_CORE_PATH]    = playlist_cache_intern(
+         &writer, playlist->default_core_path);
+   data[PLAYLIST_CACHE_HDR_DEFAULT_CORE_NAME]    = playlist_cache_intern(
+         &writer, playlist->default_core_name);
+   data[PLAYLIST_CACHE_HDR_BASE_CONTENT_DIR]     = playlist_cache_intern(
+         &writer, playlist->base_content_directory);
+   data[PLAYLIST_CACHE_HDR_LABEL_DISPLAY_MODE]   = playlist->label_display_mode;
+   data[PLAYLIST_CACHE_HDR_RIGHT_THUMBNAIL_MODE] = playlist->right_thumbnail_mode;
+   data[PLAYLIST_CACHE_HDR_LEFT_THUMBNAIL_MODE]  = playlist->left_thumbnail_mode;
+   data[PLAYLIST_CACHE_HDR_SORT_MODE]            = playlist->sort_mode;
+   data[PLAYLIST_CACHE_HDR_STRINGS_SIZE]         = (uint32_t)writer.strings_size;
+
+   if (writer.out_of_memory)
+      goto end;
+
+#ifdef MSB_FIRST
+   for (i = 0; i < PLAYLIST_CACHE_HEADER_SIZE + records_len; i++)
+      data[i] = retro_cpu_to_le32(data[i]);
+#endif
+
+   /* Write header and records, followed by strings
+    * > Remove any existing cache first, so that a
+    *   failed write cannot leave a stale cache
+    *   that looks valid */
+   {
+      RFILE *file;
+
+      if (path_is_valid(cache_path))
+         filestream_delete(cache_path);
+
+      if (!(file = filestream_open(cache_path,
+                  RETRO_VFS_FILE_ACCESS_WRITE,
+                  RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+         goto end;
+
+      if (     (filestream_write(file, data,
+                  (PLAYLIST_CACHE_HEADER_SIZE + records_len) * sizeof(uint32_t))
+               != (int64_t)((PLAYLIST_CACHE_HEADER_SIZE + records_len) * sizeof(uint32_t)))
+            || (filestream_write(file, writer.strings, writer.strings_size)
+               != (int64_t)writer.strings_size))
+      {
+         filestream_close(file);
+         filestream_delete(cache_path);
+         goto end;
+      }
+
+      filestream_close(file);
+   }
+
+end:
+   if (writer.strings)
+      free(writer.strings);
+   if (writer.slots)
+      free(writer.slots);
+   if (data)
+      free(data);
+}
+
+/* Returns the string at 'offset' in a cache string
+ * table, or NULL if the offset is invalid */
+static char *playlist_cache_get_string(char *strings,
+      size_t strings_size, uint32_t offset)
+{
+   if (offset >= strings_size)
+      return NULL;
+   return strings + offset;
+}
+
+/* Loads entries and metadata of 'playlist' from its
+ * binary cache, if the cache matches the playlist file
+ * Returns false if the playlist file must be parsed */
+static bool playlist_read_cache(playlist_t *playlist)
+{
+   char cache_path[PATH_MAX_LENGTH];
+   size_t i, j;
+   uint64_t file_size;
+   uint32_t file_crc;
+   size_t num_entries;
+   size_t strings_size;
+   size_t records_len;
+   char *strings     = NULL;
+   uint32_t *data    = NULL;
+   uint32_t *records = NULL;
+   void *buf         = NULL;
+   int64_t len       = 0;
+
+   playlist_cache_get_path(playlist->config.path,
+         cache_path, sizeof(cache_path));
+
+   if (!path_is_valid(cache_path))
+      return false;
 
-   if (!playlist || !entry)
+   if (!playlist_cache_get_fingerprint(playlist->config.path,
+            &file_size, &file_crc))
+      return false;
+
+   if (     !filestream_read_file(cache_path, &buf, &len)
+         || (len < (int64_t)(PLAYLIST_CACHE_HEADER_SIZE * sizeof(uint32_t))))
       goto error;
 
-   if (string_is_empty(entry->core_path))
-   {
-      RARCH_ERR("cannot push NULL or empty core path into the playlist.\n");
+   data = (uint32_t*)buf;
+
+#ifdef MSB_FIRST
+   for (i = 0; i < PLAYLIST_CACHE_HEADER_SIZE; i++)
+      data[i] = retro_le_to_cpu32(data[i]);
+#endif
+
+   if (     (data[PLAYLIST_CACHE_HDR_MAGIC]   != PLAYLIST_CACHE_MAGIC)
+         || (data[PLAYLIST_CACHE_HDR_VERSION] != PLAYLIST_CACHE_VERSION))
       goto error;
-   }
 
-   /* Get path ID */
-   path_id = playlist_path_id_init(entry->path);
-   if (!path_id)
+   /* Cache is stale */
+   if (     (data[PLAYLIST_CACHE_HDR_FILE_SIZE_LO] != (uint32_t)file_size)
+         || (data[PLAYLIST_CACHE_HDR_FILE_SIZE_HI] != (uint32_t)(file_size >> 32))
+         || (data[PLAYLIST_CACHE_HDR_FILE_CRC]     != file_crc))
       goto error;
 
-   /* Get 'real' core path */
-   strlcpy(real_core_path, entry->core_path, sizeof(real_core_path));
-   if (!string_is_equal(real_core_path, FILE_PATH_DETECT) &&
-       !string_is_equal(real_core_path, FILE_PATH_BUILTIN))
-      playlist_resolve_path(PLAYLIST_SAVE, true, real_core_path,
-             sizeof(real_core_path));
+   num_entries  = data[PLAYLIST_CACHE_HDR_NUM_ENTRIES];
+   strings_size = data[PLAYLIST_CACHE_HDR_STRINGS_SIZE];
+   records_len  = num_entries * PLAYLIST_CACHE_RECORD_SIZE;
 
-   if (string_is_empty(real_core_path))
-   {
-      RARCH_ERR("cannot push NULL or empty core path into the playlist.\n");
+   /* Playlist was truncated to a smaller capacity
+    * when the cache was written - parse the file */
+   if (num_entries > playlist->config.capacity)
       goto error;
-   }
 
-   if (string_is_empty(core_name))
-   {
-      static char base_path[255] = {0};
-      fill_pathname_base_noext(base_path, real_core_path, sizeof(base_path));
-      core_name = base_path;
+   if (     (len != (int64_t)((PLAYLIST_CACHE_HEADER_SIZE + records_len)
+               * sizeof(uint32_t) + strings_size))
+         || ((strings_size > 0) && (((char*)buf)[len - 1] != '\0')))
+      goto error;
 
-      if (string_is_empty(core_name))
-      {
-         RARCH_ERR("cannot push NULL or empty core name into the playlist.\n");
+   records = data + PLAYLIST_CACHE_HEADER_SIZE;
+   strings = (char*)(records + records_len);
+
+#ifdef MSB_FIRST
+   for (i = 0; i < records_len; i++)
+      records[i] = retro_le_to_cpu32(records[i]);
+#endif
+
+   if (num_entries > 0)
+   {
+      if (!RBUF_TRYFIT(playlist->entries, num_entries))
          goto error;
-      }
+      RBUF_RESIZE(playlist->entries, num_entries);
+      memset(playlist->entries, 0, num_entries * sizeof(struct playlist_entry));
    }
 
-   len = RBUF_LEN(playlist->entries);
-   for (i = 0; i < len; i++)
-   {
-      struct playlist_entry tmp;
-      bool equal_path  = (string_is_empty(path_id->real_path) &&
-            string_is_empty(playlist->entries[i].path));
+   /* Entries reference the buffer from here on */
+   playlist->cache_buf      = (char*)buf;
+   playlist->cache_buf_size = (size_t)len;
 
-      equal_path       = equal_path || playlist_path_matches_entry(
-            path_id, &playlist->entries[i], &playlist->config);
+   for (i = 0; i < num_entries; i++)
+   {
+      char **entry_strings[PLAYLIST_CACHE_NUM_STRINGS];
+      struct playlist_entry *entry = &playlist->entries[i];
+      const uint32_t *record       = records + i * PLAYLIST_CACHE_RECORD_SIZE;
+      uint32_t num_roms            = record[PLAYLIST_CACHE_REC_NUM_SUBSYSTEM_ROMS];
 
-      if (!equal_path)
-         continue;
+      playlist_cache_entry_strings(entry, entry_strings);
 
-      /* Core name can have changed while still being the same core.
-       * Differentiate based on the core path only. */
-      if (!playlist_core_path_equal(real_core_path, playlist->entries[i].core_path, &playlist->config))
-         continue;
+      for (j = 0; j < PLAYLIST_CACHE_NUM_STRINGS; j++)
+         *entry_strings[j] = playlist_cache_get_string(
+               strings, strings_size, record[j]);
 
-      if (     !string_is_empty(entry->subsystem_ident)
-            && !string_is_empty(playlist->entries[i].subsystem_ident)
-            && !string_is_equal(playlist->entries[i].subsystem_ident, entry->subsystem_ident))
-         continue;
+      if (num_roms > 0)
+      {
+         union string_list_elem_attr attr;
+         char *rom = playlist_cache_get_string(strings, strings_size,
+               record[PLAYLIST_CACHE_REC_SUBSYSTEM_ROMS]);
 
-      if (      string_is_empty(entry->subsystem_ident)
-            && !string_is_empty(playlist->entries[i].subsystem_ident))
-         continue;
+         attr.i                = 0;
+         entry->subsystem_roms = string_list_new();
 
-      if (    !string_is_empty(entry->subsystem_ident)
-            && string_is_empty(playlist->entries[i].subsystem_ident))
-         continue;
+         if (!entry->subsystem_roms)
+            goto error_entries;
 
-      if (     !string_is_empty(entry->subsystem_name)
-            && !string_is_empty(playlist->entries[i].subsystem_name)
-            && !string_is_equal(playlist->entries[i].subsystem_name, entry->subsystem_name))
-         continue;
+         for (j = 0; j < num_roms; j++)
+         {
+            /* Strings are terminated, since the table is */
+            if (!rom || (rom >= strings + strings_size))
+               goto error_entries;
 
-      if (      string_is_empty(entry->subsystem_name)
-            && !string_is_empty(playlist->entries[i].subsystem_name))
-         continue;
+            string_list_append(entry->subsystem_roms, rom, attr);
+            rom += strlen(rom) + 1;
+         }
+      }
 
-      if (     !string_is_empty(entry->subsystem_name)
-            &&  string_is_empty(playlist->entries[i].subsystem_name))
-         continue;
+   }
 
-      if (entry->subsystem_roms)
-      {
-         unsigned j;
-         const struct string_list *roms = playlist->entries[i].subsystem_roms;
-         bool                   unequal = false;
+   /* Metadata is copied, since it is replaced
+    * through the regular setters */
+   {
+      const char *default_core_path = playlist_cache_get_string(strings,
+            strings_size, data[PLAYLIST_CACHE_HDR_DEFAULT_CORE_PATH]);
+      const char *default_core_name = playlist_cache_get_string(strings,
+            strings_size, data[PLAYLIST_CACHE_HDR_DEFAULT_CORE_NAME]);
+      const char *base_content_dir  = playlist_cache_get_string(strings,
+            strings_size, data[PLAYLIST_CACHE_HDR_BASE_CONTENT_DIR]);
+
+      if (default_core_path)
+         playlist->default_core_path      = strdup(default_core_path);
+      if (default_core_name)
+         playlist->default_core_name      = strdup(default_core_name);
+      if (base_content_dir)
+         playlist->base_content_directory = strdup(base_content_dir);
+   }
 
-         if (entry->subsystem_roms->size != roms->size)
-            continue;
+   if (data[PLAYLIST_CACHE_HDR_LABEL_DISPLAY_MODE] <= LABEL_DISPLAY_MODE_KEEP_REGION_AND_DISC_INDEX)
+      playlist->label_display_mode   = (enum playlist_label_display_mode)
+            data[PLAYLIST_CACHE_HDR_LABEL_DISPLAY_MODE];
+   if (data[PLAYLIST_CACHE_HDR_RIGHT_THUMBNAIL_MODE] <= PLAYLIST_THUMBNAIL_MODE_BOXARTS)
+      playlist->right_thumbnail_mode = (enum playlist_thumbnail_mode)
+            data[PLAYLIST_CACHE_HDR_RIGHT_THUMBNAIL_MODE];
+   if (data[PLAYLIST_CACHE_HDR_LEFT_THUMBNAIL_MODE] <= PLAYLIST_THUMBNAIL_MODE_BOXARTS)
+      playlist->left_thumbnail_mode  = (enum playlist_thumbnail_mode)
+            data[PLAYLIST_CACHE_HDR_LEFT_THUMBNAIL_MODE];
+   if (data[PLAYLIST_CACHE_HDR_SORT_MODE] <= PLAYLIST_SORT_MODE_OFF)
+      playlist->sort_mode            = (enum playlist_sort_mode)
+            data[PLAYLIST_CACHE_HDR_SORT_MODE];
+
+   playlist->old_format = false;
+   playlist->compressed = (data[PLAYLIST_CACHE_HDR_FLAGS]
+         & PLAYLIST_CACHE_FLAG_COMPRESSED) != 0;
 
-         for (j = 0; j < entry->subsystem_roms->size; j++)
-         {
-            char real_rom_path[PATH_MAX_LENGTH];
+   return true;
 
-            real_rom_path[0] = '\0';
+error_entries:
+   /* Discard partially loaded entries */
+   for (i = 0; i < num_entries; i++)
+      if (playlist->entries[i].subsystem_roms)
+         string_list_free(playlist->entries[i].subsystem_roms);
+   RBUF_CLEAR(playlist->entries);
+   playlist->cache_buf      = NULL;
+   playlist->cache_buf_size = 0;
 
-            if (!string_is_empty(entry->subsystem_roms->elems[j].data))
-            {
-               strlcpy(real_rom_path, entry->subsystem_roms->elems[j].data, sizeof(real_rom_path));
-               path_resolve_realpath(real_rom_path, sizeof(real_rom_path), true);
-            }
+error:
+   if (buf)
+      free(buf);
+   return false;
+}
 
-            if (!playlist_path_equal(real_rom_path, roms->elems[j].data,
-                     &playlist->config))
-            {
-               unequal = true;
-               break;
-            }
-         }
+static void playlist_journal_get_path(const char *playlist_path,
+      char *s, size_t len)
+{
+   strlcpy(s, playlist_path, len);
+   strlcat(s, FILE_PATH_LPL_JOURNAL_EXTENSION, len);
+}
 
-         if (unequal)
-            continue;
-      }
+static void playlist_journal_clear(playlist_t *playlist)
+{
+   char journal_path[PATH_MAX_LENGTH];
 
-      /* If content was previously loaded via file browser
-       * or command line, certain entry values will be missing.
-       * If we are now loading the same content from a playlist,
-       * fill in any blanks */
-      if (!playlist->entries[i].label && !string_is_empty(entry->label))
-      {
-         playlist->entries[i].label   = strdup(entry->label);
-         entry_updated                = true;
-      }
-      if (!playlist->entries[i].crc32 && !string_is_empty(entry->crc32))
-      {
-         playlist->entries[i].crc32   = strdup(entry->crc32);
-         entry_updated                = true;
-      }
-      if (!playlist->entries[i].db_name && !string_is_empty(entry->db_name))
-      {
-         playlist->entries[i].db_name = strdup(entry->db_name);
-         entry_updated                = true;
-      }
+   playlist_journal_get_path(playlist->config.path,
+         journal_path, sizeof(journal_path));
 
-      /* If top entry, we don't want to push a new entry since
-       * the top and the entry to be pushed are the same. */
-      if (i == 0)
-      {
-         if (entry_updated)
-            goto success;
+   if (path_is_valid(journal_path))
+      filestream_delete(journal_path);
 
-         goto error;
-      }
+   RBUF_CLEAR(playlist->journal);
+   playlist->journal_records = 0;
+   playlist->journal_pending = 0;
+}
 
-      /* Seen it before, bump to top. */
-      tmp = playlist->entries[i];
-      memmove(playlist->entries + 1, playlist->entries,
-            i * sizeof(struct playlist_entry));
-      playlist->entries[0] = tmp;
+/* Appends pending journal records to the journal file
+ * Returns false if the playlist file must be rewritten
+ * instead */
+static bool playlist_write_journal(playlist_t *playlist)
+{
+   char journal_path[PATH_MAX_LENGTH];
+   RFILE *file;
+   int64_t len = (int64_t)RBUF_LEN(playlist->journal);
 
-      goto success;
-   }
+   if (playlist->journal_records + playlist->journal_pending
+         > PLAYLIST_JOURNAL_MAX_RECORDS)
+      return false;
 
-   if (playlist->config.capacity == 0)
-      goto error;
+   playlist_journal_get_path(playlist->config.path,
+         journal_path, sizeof(journal_path));
 
-   if (len == playlist->config.capacity)
+   if (playlist->journal_records == 0)
    {
-      struct playlist_entry *last_entry = &playlist->entries[len - 1];
-      playlist_free_entry(last_entry);
-      len--;
+      uint8_t header[PLAYLIST_JOURNAL_HEADER_SIZE * 4];
+      uint8_t *s = header;
+      uint64_t file_size;
+      uint32_t file_crc;
+
+      /* Journal is only valid for the playlist
+       * file as it currently is */
+      if (!playlist_cache_get_fingerprint(playlist->config.path,
+               &file_size, &file_crc))
+         return false;
+
+      s = playlist_journal_put_u32(s, PLAYLIST_JOURNAL_MAGIC);
+      s = playlist_journal_put_u32(s, PLAYLIST_JOURNAL_VERSION);
+      s = playlist_journal_put_u32(s, (uint32_t)file_size);
+      s = playlist_journal_put_u32(s, (uint32_t)(file_size >> 32));
+      playlist_journal_put_u32(s, file_crc);
+
+      if (!(file = filestream_open(journal_path,
+                  RETRO_VFS_FILE_ACCESS_WRITE,
+                  RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+         return false;
+
+      if (filestream_write(file, header, sizeof(header))
+            != (int64_t)sizeof(header))
+         goto error;
    }
    else
    {
-      /* Allocate memory to fit one more item and resize the buffer */
-      if (!RBUF_TRYFIT(playlist->entries, len + 1))
-         goto error; /* out of memory */
-      RBUF_RESIZE(playlist->entries, len + 1);
+      if (!(file = filestream_open(journal_path,
+                  RETRO_VFS_FILE_ACCESS_READ_WRITE
+                  | RETRO_VFS_FILE_ACCESS_UPDATE_EXISTING,
+                  RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+         return false;
+
+      if (filestream_seek(file, 0, RETRO_VFS_SEEK_POSITION_END) != 0)
+         goto error;
    }
 
-   if (playlist->entries)
+   if (filestream_write(file, playlist->journal, len) != len)
+      goto error;
+
+   filestream_close(file);
+
+   playlist->journal_records += playlist->journal_pending;
+   playlist->journal_pending  = 0;
+   RBUF_CLEAR(playlist->journal);
+
+   RARCH_LOG("[Playlist]: Written to playlist journal: %s\n", journal_path);
+   return true;
+
+error:
+   /* A partially written record would be discarded
+    * on load, but later records appended after
+    * it would be lost as well */
+   filestream_close(file);
+   filestream_delete(journal_path);
+   playlist->journal_records = 0;
+   return false;
+}
+
+static bool playlist_journal_get_u32(const uint8_t **s,
+      const uint8_t *end, uint32_t *val)
+{
+   const uint8_t *p = *s;
+
+   if (end - p < 4)
+      return false;
+
+   *val = (uint32_t)p[0]
+        | ((uint32_t)p[1] << 8)
+        | ((uint32_t)p[2] << 16)
+        | ((uint32_t)p[3] << 24);
+   *s   = p + 4;
+   return true;
+}
+
+static bool playlist_journal_get_string(const uint8_t **s,
+      const uint8_t *end, const char **str)
+{
+   uint32_t len;
+
+   if (!playlist_journal_get_u32(s, end, &len))
+      return false;
+
+   if (len == PLAYLIST_JOURNAL_NULL)
    {
-      memmove(playlist->entries + 1, playlist->entries,
-            len * sizeof(struct playlist_entry));
+      *str = NULL;
+      return true;
+   }
 
-      playlist->entries[0].path               = NULL;
-      playlist->entries[0].label              = NULL;
-      playlist->entries[0].core_path          = NULL;
-      playlist->entries[0].core_name          = NULL;
-      playlist->entries[0].db_name            = NULL;
-      playlist->entries[0].crc32              = NULL;
-      playlist->entries[0].subsystem_ident    = NULL;
-      playlist->entries[0].subsystem_name     = NULL;
-      playlist->entries[0].runtime_str        = NULL;
-      playlist->entries[0].last_played_str    = NULL;
-      playlist->entries[0].subsystem_roms     = NULL;
-      playlist->entries[0].path_id            = NULL;
-      playlist->entries[0].runtime_status     = PLAYLIST_RUNTIME_UNKNOWN;
-      playlist->entries[0].runtime_hours      = 0;
-      playlist->entries[0].runtime_minutes    = 0;
-      playlist->entries[0].runtime_seconds    = 0;
-      playlist->entries[0].last_played_year   = 0;
-      playlist->entries[0].last_played_month  = 0;
-      playlist->entries[0].last_played_day    = 0;
-      playlist->entries[0].last_played_hour   = 0;
-      playlist->entries[0].last_played_minute = 0;
-      playlist->entries[0].last_played_second = 0;
+   if (((size_t)(end - *s) <= len) || ((*s)[len] != '\0'))
+      return false;
 
-      if (!string_is_empty(path_id->real_path))
-         playlist->entries[0].path            = strdup(path_id->real_path);
-      playlist->entries[0].path_id            = path_id;
-      path_id                                 = NULL;
+   *str = (const char*)*s;
+   *s  += len + 1;
+   return true;
+}
 
-      if (!string_is_empty(entry->label))
-         playlist->entries[0].label           = strdup(entry->label);
-      if (!string_is_empty(real_core_path))
-         playlist->entries[0].core_path       = strdup(real_core_path);
-      if (!string_is_empty(core_name))
-         playlist->entries[0].core_name       = strdup(core_name);
-      if (!string_is_empty(entry->db_name))
-         playlist->entries[0].db_name         = strdup(entry->db_name);
-      if (!string_is_empty(entry->crc32))
-         playlist->entries[0].crc32           = strdup(entry->crc32);
-      if (!string_is_empty(entry->subsystem_ident))
-         playlist->entries[0].subsystem_ident = strdup(entry->subsystem_ident);
-      if (!string_is_empty(entry->subsystem_name))
-         playlist->entries[0].subsystem_name  = strdup(entry->subsystem_name);
+/* Replays one journal record through playlist_push() */
+static bool playlist_journal_replay(playlist_t *playlist,
+      const uint8_t *s, const uint8_t *end)
+{
+   size_t i;
+   uint32_t num_roms;
+   struct playlist_entry entry;
+   const char *strings[PLAYLIST_JOURNAL_NUM_STRINGS];
 
-      if (entry->subsystem_roms)
+   if (!playlist_journal_get_u32(&s, end, &num_roms))
+      return false;
+
+   for (i = 0; i < PLAYLIST_JOURNAL_NUM_STRINGS; i++)
+      if (!playlist_journal_get_string(&s, end, &strings[i]))
+         return false;
+
+   memset(&entry, 0, sizeof(entry));
+   entry.path            = (char*)strings[0];
+   entry.label           = (char*)strings[1];
+   entry.core_path       = (char*)strings[2];
+   entry.core_name       = (char*)strings[3];
+   entry.db_name         = (char*)strings[4];
+   entry.crc32           = (char*)strings[5];
+   entry.subsystem_ident = (char*)strings[6];
+   entry.subsystem_name  = (char*)strings[7];
+
+   if (num_roms > 0)
+   {
+      union string_list_elem_attr attr;
+
+      attr.i = 0;
+
+      if (!(entry.subsystem_roms = string_list_new()))
+         return false;
+
+      for (i = 0; i < num_roms; i++)
       {
-         union string_list_elem_attr attributes = {0};
+         const char *rom = NULL;
 
-         playlist->entries[0].subsystem_roms    = string_list_new();
+         if (!playlist_journal_get_string(&s, end, &rom))
+         {
+            string_list_free(entry.subsystem_roms);
+            return false;
+         }
 
-         for (i = 0; i < entry->subsystem_roms->size; i++)
-            string_list_append(playlist->entries[0].subsystem_roms, entry->subsystem_roms->elems[i].data, attributes);
+         string_list_append(entry.subsystem_roms, rom ? rom : "", attr);
       }
    }
 
-success:
-   if (path_id)
-      playlist_path_id_free(path_id);
-   playlist->modified = true;
+   playlist_push(playlist, &entry);
+
+   if (entry.subsystem_roms)
+      string_list_free(entry.subsystem_roms);
+
    return true;
+}
 
-error:
-   if (path_id)
-      playlist_path_id_free(path_id);
-   return false;
+/* Applies the journal of 'playlist', if it
+ * was written for the current playlist file */
+static void playlist_read_journal(playlist_t *playlist)
+{
+   char journal_path[PATH_MAX_LENGTH];
+   uint64_t file_size;
+   uint32_t file_crc;
+   uint32_t header[PLAYLIST_JOURNAL_HEADER_SIZE];
+   size_t i;
+   const uint8_t *s   = NULL;
+   const uint8_t *end = NULL;
+   void *buf          = NULL;
+   int64_t len        = 0;
+   bool modified      = playlist->modified;
+
+   playlist_journal_get_path(playlist->config.path,
+         journal_path, sizeof(journal_path));
+
+   if (!path_is_valid(journal_path))
+      return;
+
+   if (     !playlist_cache_get_fingerprint(playlist->config.path,
+               &file_size, &file_crc)
+         || !filestream_read_file(journal_path, &buf, &len))
+      goto stale;
+
+   s   = (const uint8_t*)buf;
+   end = s + len;
+
+   for (i = 0; i < PLAYLIST_JOURNAL_HEADER_SIZE; i++)
+      if (!playlist_journal_get_u32(&s, end, &header[i]))
+         goto stale;
+
+   /* Playlist file has been rewritten since the
+    * journal was started (e.g. by another program) */
+   if (     (header[0] != PLAYLIST_JOURNAL_MAGIC)
+         || (header[1] != PLAYLIST_JOURNAL_VERSION)
+         || (header[2] != (uint32_t)file_size)
+         || (header[3] != (uint32_t)(file_size >> 32))
+         || (header[4] != file_crc))
+      goto stale;
+
+   /* Pushes are not journaled while the
+    * playlist is flagged as modified */
+   playlist->modified = true;
+
+   while (s < end)
+   {
+      uint32_t size;
+      uint32_t crc;
+
+      if (     !playlist_journal_get_u32(&s, end, &size)
+            || !playlist_journal_get_u32(&s, end, &crc)
+            || ((size_t)(end - s) < size)
+            || (encoding_crc32(0, s, size) != crc)
+            || !playlist_journal_replay(playlist, s, s + size))
+      {
+         /* Incomplete record (e.g. power was lost
+          * while appending): force a rewrite on the
+          * next save, since records appended after
+          * it could not be read back */
+         playlist->journal_records = PLAYLIST_JOURNAL_MAX_RECORDS + 1;
+         break;
+      }
+
+      s += size;
+      playlist->journal_records++;
+   }
+
+   playlist->modified = modified;
+   free(buf);
+   return;
+
+stale:
+   if (buf)
+      free(buf);
+   filestream_delete(journal_path);
 }
 
 void playlist_write_runtime_file(playlist_t *playlist)
@@ -1549,6 +2919,7 @@ void playlist_write_file(playlist_t *playlist)
    size_t i, len;
    intfstream_t *file = NULL;
    bool compressed    = false;
+   bool written       = false;
 
    /* Playlist will be written if any of the
     * following are true:
@@ -1556,13 +2927,17 @@ void playlist_write_file(playlist_t *playlist)
     * > Current playlist format (old/new) does not
     *   match requested
     * > Current playlist compression status does
-    *   not match requested */
+    *   not match requested
+    * > Journal records are pending, and cannot be
+    *   appended to the journal file */
    if (!playlist ||
        !(playlist->modified ||
 #if defined(HAVE_ZLIB)
         (playlist->compressed != playlist->config.compress) ||
 #endif
-        (playlist->old_format != playlist->config.old_format)))
+        (playlist->old_format != playlist->config.old_format) ||
+        ((playlist->journal_pending > 0) &&
+            !playlist_write_journal(playlist))))
       return;
 
 #if defined(HAVE_ZLIB)
@@ -1848,9 +3223,17 @@ void playlist_write_file(playlist_t *playlist)
    playlist->compressed = compressed;
 
    RARCH_LOG("[Playlist]: Written to playlist file: %s\n", playlist->config.path);
+   written              = true;
+
+   /* Journaled changes are now part of the file */
+   playlist_journal_clear(playlist);
 end:
    intfstream_close(file);
    free(file);
+
+   /* File must be closed before it is fingerprinted */
+   if (written)
+      playlist_write_cache(playlist);
 }
 
 /**
@@ -1878,6 +3261,10 @@ void playlist_free(playlist_t *playlist)
       free(playlist->base_content_directory);
    playlist->base_content_directory = NULL;
 
+   /* Not maintained while freeing entries */
+   playlist_path_index_free(playlist);
+   playlist_search_index_free(playlist);
+
    if (playlist->entries)
    {
       for (i = 0, len = RBUF_LEN(playlist->entries); i < len; i++)
@@ -1885,12 +3272,20 @@ void playlist_free(playlist_t *playlist)
          struct playlist_entry *entry = &playlist->entries[i];
 
          if (entry)
-            playlist_free_entry(entry);
+            playlist_free_entry(playlist, entry);
       }
 
       RBUF_FREE(playlist->entries);
    }
 
+   /* Must come after the entries, which may
+    * reference it */
+   if (playlist->cache_buf)
+      free(playlist->cache_buf);
+   playlist->cache_buf = NULL;
+
+   RBUF_FREE(playlist->journal);
+
    free(playlist);
 }
 
@@ -1911,9 +3306,14 @@ void playlist_clear(playlist_t *playlist)
       struct playlist_entry *entry = &playlist->entries[i];
 
       if (entry)
-         playlist_free_entry(entry);
+         playlist_free_entry(playlist, entry);
    }
    RBUF_CLEAR(playlist->entries);
+   playlist_search_index_free(playlist);
+
+   /* Pushes onto a cleared playlist must not be
+    * journaled against the old playlist file */
+   playlist->modified = true;
 }
 
 /**
@@ -2257,7 +3657,8 @@ static bool playlist_read_file(playlist_t *playlist)
 {
    unsigned i;
    int test_char;
-   bool res = true;
+   bool res       = true;
+   bool cacheable = false;
 
 #if defined(HAVE_ZLIB)
       /* Always use RZIP interface when reading playlists
@@ -2278,6 +3679,14 @@ static bool playlist_read_file(playlist_t *playlist)
    if (!file)
       return true;
 
+   /* Skip parsing if the binary cache is up to date */
+   if (playlist_read_cache(playlist))
+   {
+      intfstream_close(file);
+      free(file);
+      return true;
+   }
+
    playlist->compressed = intfstream_is_compressed(file);
 
    /* Detect format of playlist
@@ -2339,7 +3748,9 @@ static bool playlist_read_file(playlist_t *playlist)
             JSONStartArrayHandler,
             JSONEndArrayHandler,
             NULL, NULL) /* unused boolean/null handlers */
-            != RJSON_DONE)
+            == RJSON_DONE)
+         cacheable = true;
+      else
       {
          if (context.out_of_memory)
          {
@@ -2559,6 +3970,14 @@ static bool playlist_read_file(playlist_t *playlist)
 end:
    intfstream_close(file);
    free(file);
+
+   /* Playlists truncated to the current capacity
+    * must be parsed again if the capacity grows */
+   if (     res
+         && cacheable
+         && (RBUF_LEN(playlist->entries) < playlist->config.capacity))
+      playlist_write_cache(playlist);
+
    return res;
 }
 
@@ -2619,6 +4038,15 @@ playlist_t *playlist_init(const playlist_config_t *config)
    playlist->default_core_path      = NULL;
    playlist->base_content_directory = NULL;
    playlist->entries                = NULL;
+   playlist->path_index             = NULL;
+   playlist->path_index_valid       = false;
+   playlist->search_index           = NULL;
+   playlist->search_index_valid     = false;
+   playlist->cache_buf              = NULL;
+   playlist->cache_buf_size         = 0;
+   playlist->journal                = NULL;
+   playlist->journal_records        = 0;
+   playlist->journal_pending        = 0;
    playlist->label_display_mode     = LABEL_DISPLAY_MODE_DEFAULT;
    playlist->right_thumbnail_mode   = PLAYLIST_THUMBNAIL_MODE_DEFAULT;
    playlist->left_thumbnail_mode    = PLAYLIST_THUMBNAIL_MODE_DEFAULT;
@@ -2632,6 +4060,8 @@ playlist_t *playlist_init(const playlist_config_t *config)
    if (!playlist_read_file(playlist))
       goto error;
 
+   playlist_read_journal(playlist);
+
    /* Try auto-fixing paths if enabled, and playlist
     * base content directory is different */
    if (config->autofix_paths && !string_is_equal(playlist->base_content_directory, config->base_content_directory))
@@ -2655,8 +4085,9 @@ playlist_t *playlist_init(const playlist_config_t *config)
                playlist->base_content_directory, playlist->config.base_content_directory,
                sizeof(tmp_entry_path));
 
-            free(entry->path);
+            playlist_free_string(playlist, entry->path);
             entry->path = strdup(tmp_entry_path);
+            playlist_entry_reset_path_id(playlist, entry);
 
             /* Fix subsystem roms paths*/
             if (entry->subsystem_roms && (entry->subsystem_roms->size > 0))
@@ -2796,6 +4227,8 @@ void playlist_qsort(playlist_t *playlist)
    qsort(playlist->entries, RBUF_LEN(playlist->entries),
          sizeof(struct playlist_entry),
          (int (*)(const void *, const void *))playlist_qsort_func);
+
+   playlist_search_index_free(playlist);
 }
 
 void command_playlist_push_write(
@@ -258,6 +258,22 @@ void playlist_resolve_path(enum playlist_file_mode mode,
 bool playlist_push(playlist_t *playlist,
       const struct playlist_entry *entry);
 
+/**
+ * playlist_push_batch:
+ * @playlist               : Playlist handle.
+ * @entries                : Entries to push.
+ * @count                  : Number of entries.
+ *
+ * Pushes entries to top of playlist, with the same result
+ * as calling playlist_push() for each of them in turn. New
+ * entries are much faster to add this way, since existing
+ * entries are moved only once for all of them.
+ *
+ * Returns: number of entries pushed.
+ **/
+size_t playlist_push_batch(playlist_t *playlist,
+      const struct playlist_entry *entries, size_t count);
+
 bool playlist_push_runtime(playlist_t *playlist,
       const struct playlist_entry *entry);
 
@@ -280,6 +296,19 @@ void playlist_get_index_by_path(playlist_t *playlist,
 bool playlist_entry_exists(playlist_t *playlist,
       const char *path);
 
+/* Returns the search signature of 'search_term',
+ * or 0 if it is too short to rule out any entry.
+ * The signatures of several terms that must all
+ * match may be combined with a bitwise OR */
+uint64_t playlist_get_search_signature(const char *search_term);
+
+/* Returns false if none of the label, path file name,
+ * core name and database name of entry 'idx' can
+ * contain (case insensitively) the search terms of
+ * 'signature', i.e. matching them can be skipped */
+bool playlist_search_may_match(playlist_t *playlist, size_t idx,
+      uint64_t signature);
+
 char *playlist_get_conf_path(playlist_t *playlist);
 
 uint32_t playlist_get_size(playlist_t *playlist);
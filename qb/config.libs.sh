@@ -271,6 +271,8 @@ check_pkgconf RSOUND rsound 1.1
 check_pkgconf ROAR libroar 1.0.12
 check_val '' JACK -ljack '' jack 0.120.1 '' false
 check_val '' PULSE -lpulse '' libpulse '' '' false
+check_enabled THREADS PIPEWIRE PipeWire 'Threads are' false
+check_pkgconf PIPEWIRE libpipewire-0.3 0.3.20
 check_val '' SDL -lSDL SDL sdl 1.2.10 '' false
 check_val '' SDL2 -lSDL2 SDL2 sdl2 2.0.0 '' false
 
@@ -513,6 +515,7 @@ else
 fi
 
 check_enabled X11 XINERAMA Xinerama 'Xinerama is' false
+check_enabled X11 XPRESENT XPresent 'XPresent is' false
 check_enabled X11 XSHM XShm 'XShm is' false
 check_enabled X11 XRANDR Xrandr 'Xrandr is' false
 check_enabled X11 XVIDEO XVideo 'Xvideo is' false
@@ -521,6 +524,7 @@ check_enabled XF86VM XVIDEO XVideo 'XF86vm is' false
 
 check_val '' XVIDEO -lXv '' xv '' '' false
 check_val '' XINERAMA -lXinerama '' xinerama '' '' false
+check_val '' XPRESENT -lXpresent '' xpresent '' '' false
 check_lib '' XRANDR -lXrandr
 check_header '' XSHM X11/Xlib.h X11/extensions/XShm.h
 check_val '' XKBCOMMON -lxkbcommon '' xkbcommon 0.3.2 '' false
@@ -544,6 +548,7 @@ fi
 
 check_header '' PARPORT linux/parport.h
 check_header '' PARPORT linux/ppdev.h
+check_header '' IO_URING linux/io_uring.h
 
 if [ "$OS" != 'Win32' ] && [ "$OS" != 'Linux' ]; then
    check_lib '' STRL "$CLIB" strlcpy
@@ -93,6 +93,7 @@ HAVE_X11=auto              # everything X11.
 HAVE_XRANDR=auto           # Xrandr support.
 HAVE_OMAP=no               # OMAP video support
 HAVE_XINERAMA=auto         # Xinerama support.
+HAVE_XPRESENT=auto         # XPresent frame timing support.
 HAVE_KMS=auto              # KMS context support
 HAVE_PLAIN_DRM=no          # Plain DRM video support
 HAVE_EXYNOS=no             # Exynos video support
@@ -122,6 +123,8 @@ HAVE_COREAUDIO=auto        # CoreAudio support
 HAVE_COREAUDIO3=no         # CoreAudio3 support
 HAVE_PULSE=auto            # PulseAudio support
 C89_PULSE=no
+HAVE_PIPEWIRE=auto         # PipeWire support
+C89_PIPEWIRE=no
 HAVE_FREETYPE=auto         # FreeType support
 HAVE_STB_FONT=yes          # stb_truetype font support
 HAVE_STB_IMAGE=yes         # stb image loading support
@@ -146,6 +149,7 @@ HAVE_PRESERVE_DYLIB=no     # Enable dlclose() for Valgrind support
 HAVE_PARPORT=auto          # Parallel port joypad support
 HAVE_IMAGEVIEWER=yes       # Built-in image viewer support.
 HAVE_MMAP=auto             # MMAP support
+HAVE_IO_URING=auto         # io_uring nbio backend (Linux)
 HAVE_QT=auto               # Qt companion support
 C89_QT=no
 HAVE_XSHM=auto             # XShm video driver support
@@ -20,6 +20,7 @@
 #include <stdlib.h>
 
 #include <retro_assert.h>
+#include <retro_miscellaneous.h>
 #include <compat/msvc.h>
 #include <compat/strl.h>
 
@@ -29,6 +30,7 @@
 #include <gfx/scaler/scaler.h>
 #include <gfx/video_frame.h>
 #include <file/config_file.h>
+#include <lists/string_list.h>
 #include <audio/audio_resampler.h>
 #include <string/stdstring.h>
 #include <audio/conversion/float_to_s16.h>
@@ -61,6 +63,12 @@ extern "C" {
 #include <libavutil/pixdesc.h>
 #include <libswscale/swscale.h>
 
+/* Hardware encoding needs the hwcontext API with device lookup by name. */
+#if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(56, 0, 0)
+#define HAVE_FFMPEG_HWACCEL
+#include <libavutil/hwcontext.h>
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -153,6 +161,13 @@ struct ff_video_info
    struct scaler_ctx scaler;
    struct SwsContext *sws;
    bool use_sws;
+
+#ifdef HAVE_FFMPEG_HWACCEL
+   /* Hardware encode. conv_frame is then a software NV12 frame
+    * which is uploaded into a pooled hw_frame before encoding. */
+   AVBufferRef *hw_device_ctx;
+   AVFrame *hw_frame;
+#endif
 };
 
 struct ff_audio_info
@@ -194,11 +209,56 @@ struct ff_audio_info
    double ratio;
 };
 
+/* Destinations of the encoded stream, separated by '|'
+ * in the record filename. */
+#define FF_MAX_MUXERS 4
+/* Packets a muxer may have waiting, about 5 seconds */
+#define FF_MUXER_QUEUE_SIZE 512
+
 struct ff_muxer_info
 {
    AVFormatContext *ctx;
    AVStream *astream;
    AVStream *vstream;
+
+   /* With several muxers, each one is fed through its
+    * own queue and thread, so a slow one doesn't hold up
+    * the encoder or the others. Queued packets are in
+    * codec time base, stream index 0 being video and
+    * 1 audio. */
+   AVPacket *queue[FF_MUXER_QUEUE_SIZE];
+   size_t queue_head;
+   size_t queue_count;
+
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+
+   /* Network outputs drop packets up to the next
+    * keyframe when they fall behind, files block. */
+   bool lossy;
+   bool skip_to_keyframe;
+   bool failed;
+   bool alive;
+};
+
+/* Instant replay: encoded packets of the last seconds, in
+ * the time base of their codec, oldest first. Stream index
+ * 0 is video, 1 is audio. Only the encoding thread touches
+ * the packets. */
+struct ff_replay_info
+{
+   AVPacket **packets;
+   size_t capacity;
+   size_t head;
+   size_t count;
+
+   /* In video codec time base units. */
+   int64_t length;
+
+   /* Set by save_replay(), handled by the thread. */
+   char path[PATH_MAX_LENGTH];
+   volatile bool save_pending;
 };
 
 struct ff_config_param
@@ -207,11 +267,15 @@ struct ff_config_param
    char vcodec[64];
    char acodec[64];
    char format[64];
+   char hwaccel[32];
+   char hwaccel_device[256];
    enum PixelFormat out_pix_fmt;
    unsigned threads;
    unsigned frame_drop_ratio;
    unsigned sample_rate;
    float scale_factor;
+   /* Seconds between keyframes, 0 leaves it to the encoder. */
+   float keyframe_interval;
 
    bool audio_enable;
    /* Keep same naming conventions as libavcodec. */
@@ -230,8 +294,10 @@ typedef struct ffmpeg
 {
    struct ff_video_info video;
    struct ff_audio_info audio;
-   struct ff_muxer_info muxer;
+   struct ff_muxer_info muxers[FF_MAX_MUXERS];
+   unsigned num_muxers;
    struct ff_config_param config;
+   struct ff_replay_info replay;
 
    struct record_params params;
 
@@ -247,7 +313,16 @@ typedef struct ffmpeg
    volatile bool can_sleep;
 } ffmpeg_t;
 
-AVFormatContext *ctx;
+static bool ffmpeg_needs_global_header(ffmpeg_t *handle)
+{
+   unsigned i;
+
+   for (i = 0; i < handle->num_muxers; i++)
+      if (handle->muxers[i].ctx->oformat->flags & AVFMT_GLOBALHEADER)
+         return true;
+
+   return false;
+}
 
 static bool ffmpeg_codec_has_sample_format(enum AVSampleFormat fmt,
       const enum AVSampleFormat *fmts)
@@ -392,7 +467,7 @@ static bool ffmpeg_init_audio(ffmpeg_t *handle, const char *audio_resampler)
    /* Allow experimental codecs. */
    audio->codec->strict_std_compliance = FF_COMPLIANCE_EXPERIMENTAL;
 
-   if (handle->muxer.ctx->oformat->flags & AVFMT_GLOBALHEADER)
+   if (ffmpeg_needs_global_header(handle))
       audio->codec->flags             |= AV_CODEC_FLAG_GLOBAL_HEADER;
 
    if (avcodec_open2(audio->codec, codec,
@@ -424,6 +499,133 @@ static bool ffmpeg_init_audio(ffmpeg_t *handle, const char *audio_resampler)
    return true;
 }
 
+#ifdef HAVE_FFMPEG_HWACCEL
+struct ffmpeg_hwaccel
+{
+   const char *ident;
+   enum AVHWDeviceType type;
+   enum AVPixelFormat pix_fmt;
+   /* Encoder used when the config doesn't name one */
+   const char *vcodec;
+};
+
+static const struct ffmpeg_hwaccel ffmpeg_hwaccels[] = {
+   { "vaapi",        AV_HWDEVICE_TYPE_VAAPI,        AV_PIX_FMT_VAAPI,        "h264_vaapi"        },
+   { "nvenc",        AV_HWDEVICE_TYPE_CUDA,         AV_PIX_FMT_CUDA,         "h264_nvenc"        },
+   { "cuda",         AV_HWDEVICE_TYPE_CUDA,         AV_PIX_FMT_CUDA,         "h264_nvenc"        },
+   { "qsv",          AV_HWDEVICE_TYPE_QSV,          AV_PIX_FMT_QSV,          "h264_qsv"          },
+   { "videotoolbox", AV_HWDEVICE_TYPE_VIDEOTOOLBOX, AV_PIX_FMT_VIDEOTOOLBOX, "h264_videotoolbox" },
+};
+
+static const struct ffmpeg_hwaccel *ffmpeg_find_hwaccel(const char *ident)
+{
+   unsigned i;
+
+   for (i = 0; i < ARRAY_SIZE(ffmpeg_hwaccels); i++)
+      if (string_is_equal(ffmpeg_hwaccels[i].ident, ident))
+         return &ffmpeg_hwaccels[i];
+   return NULL;
+}
+
+/* Opens the hardware device named by the config.
+ * Returns NULL (and software encoding is used) if there is
+ * no such device on this machine. */
+static const struct ffmpeg_hwaccel *ffmpeg_init_hwaccel_device(
+      struct ff_video_info *video, const struct ff_config_param *params)
+{
+   int ret;
+   const struct ffmpeg_hwaccel *hw = NULL;
+
+   if (!*params->hwaccel)
+      return NULL;
+
+   if (!(hw = ffmpeg_find_hwaccel(params->hwaccel)))
+   {
+      RARCH_WARN("[FFmpeg]: Unknown hwaccel \"%s\", encoding in software.\n",
+            params->hwaccel);
+      return NULL;
+   }
+
+   ret = av_hwdevice_ctx_create(&video->hw_device_ctx, hw->type,
+         *params->hwaccel_device ? params->hwaccel_device : NULL, NULL, 0);
+   if (ret < 0)
+   {
+#ifdef __cplusplus
+      RARCH_WARN("[FFmpeg]: Cannot open %s device, encoding in software. Error code: %d.\n",
+            hw->ident, ret);
+#else
+      RARCH_WARN("[FFmpeg]: Cannot open %s device, encoding in software. Error code: %s.\n",
+            hw->ident, av_err2str(ret));
+#endif
+      video->hw_device_ctx = NULL;
+      return NULL;
+   }
+
+   RARCH_LOG("[FFmpeg]: Using %s hardware encoding.\n", hw->ident);
+   return hw;
+}
+
+/* Attaches a pool of hardware frames to the encoder. Frames are
+ * converted to NV12 on the CPU and uploaded into this pool. */
+static bool ffmpeg_init_hwaccel_frames(struct ff_video_info *video,
+      const struct ffmpeg_hwaccel *hw, unsigned width, unsigned height)
+{
+   AVHWFramesContext *frames = NULL;
+   AVBufferRef *frames_ref   = av_hwframe_ctx_alloc(video->hw_device_ctx);
+
+   if (!frames_ref)
+      return false;
+
+   frames                    = (AVHWFramesContext*)frames_ref->data;
+   frames->format            = hw->pix_fmt;
+   frames->sw_format         = AV_PIX_FMT_NV12;
+   frames->width             = width;
+   frames->height            = height;
+   /* Fixed size pools (QSV) need room for the encoder's lookahead. */
+   frames->initial_pool_size = 20;
+
+   if (av_hwframe_ctx_init(frames_ref) < 0)
+   {
+      av_buffer_unref(&frames_ref);
+      return false;
+   }
+
+   video->codec->pix_fmt       = hw->pix_fmt;
+   video->codec->hw_frames_ctx = av_buffer_ref(frames_ref);
+   av_buffer_unref(&frames_ref);
+
+   if (!video->codec->hw_frames_ctx)
+      return false;
+
+   video->hw_frame = av_frame_alloc();
+   return video->hw_frame != NULL;
+}
+
+static bool ffmpeg_upload_hw_frame(struct ff_video_info *video)
+{
+   int ret;
+
+   av_frame_unref(video->hw_frame);
+
+   if ((ret = av_hwframe_get_buffer(video->codec->hw_frames_ctx,
+         video->hw_frame, 0)) >= 0)
+      ret = av_hwframe_transfer_data(video->hw_frame, video->conv_frame, 0);
+
+   if (ret < 0)
+   {
+#ifdef __cplusplus
+      RARCH_ERR("[FFmpeg]: Cannot upload video frame. Error code: %d.\n", ret);
+#else
+      RARCH_ERR("[FFmpeg]: Cannot upload video frame. Error code: %s.\n", av_err2str(ret));
+#endif
+      return false;
+   }
+
+   video->hw_frame->pts = video->conv_frame->pts;
+   return true;
+}
+#endif
+
 static bool ffmpeg_init_video(ffmpeg_t *handle)
 {
    size_t size;
@@ -431,9 +633,17 @@ static bool ffmpeg_init_video(ffmpeg_t *handle)
    struct ff_video_info *video     = &handle->video;
    struct record_params *param     = &handle->params;
    AVCodec *codec                  = NULL;
+#ifdef HAVE_FFMPEG_HWACCEL
+   const struct ffmpeg_hwaccel *hw = ffmpeg_init_hwaccel_device(
+         video, params);
+#endif
 
    if (*params->vcodec)
       codec = avcodec_find_encoder_by_name(params->vcodec);
+#ifdef HAVE_FFMPEG_HWACCEL
+   else if (hw)
+      codec = avcodec_find_encoder_by_name(hw->vcodec);
+#endif
    else
    {
       /* By default, lossless video. */
@@ -483,6 +693,19 @@ static bool ffmpeg_init_video(ffmpeg_t *handle)
       video->scaler.out_fmt = SCALER_FMT_BGR24;
    }
 
+#ifdef HAVE_FFMPEG_HWACCEL
+   /* Hardware encoders take NV12 surfaces, which only swscale outputs. */
+   if (hw)
+   {
+      video->pix_fmt = AV_PIX_FMT_NV12;
+      video->use_sws = true;
+   }
+#endif
+
+   /* The in-house scaler shares the encoder's thread budget,
+    * splitting each frame into that many slices. */
+   video->scaler.threads = params->threads;
+
    switch (param->pix_fmt)
    {
       case FFEMU_PIX_RGB565:
@@ -534,9 +757,22 @@ static bool ffmpeg_init_video(ffmpeg_t *handle)
    else if (params->video_bit_rate)
       video->codec->bit_rate = params->video_bit_rate;
 
-   if (handle->muxer.ctx->oformat->flags & AVFMT_GLOBALHEADER)
+   if (params->keyframe_interval > 0.0f)
+      video->codec->gop_size = MAX(1, (int)(param->fps
+               * params->keyframe_interval / params->frame_drop_ratio));
+
+   if (ffmpeg_needs_global_header(handle))
       video->codec->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
 
+#ifdef HAVE_FFMPEG_HWACCEL
+   if (hw && !ffmpeg_init_hwaccel_frames(video, hw,
+            param->out_width, param->out_height))
+   {
+      RARCH_ERR("[FFmpeg]: Cannot allocate %s frames.\n", hw->ident);
+      return false;
+   }
+#endif
+
    if (avcodec_open2(video->codec, codec, params->video_opts ?
             &params->video_opts : NULL) != 0)
       return false;
@@ -688,6 +924,27 @@ static bool ffmpeg_init_config_common(struct ff_config_param *params,
          av_dict_set(&params->video_opts, "pred", "avg", 0);
          av_dict_set(&params->audio_opts, "audio_global_quality", "0", 0);
          break;
+      case RECORD_CONFIG_TYPE_STREAMING_LOW_LATENCY:
+         params->threads              = video_record_threads;
+         params->frame_drop_ratio     = 1;
+         params->audio_enable         = true;
+         params->audio_global_quality = 50;
+         params->out_pix_fmt          = PIX_FMT_YUV420P;
+         /* Viewers joining or recovering from loss
+          * only wait for the next keyframe */
+         params->keyframe_interval    = 1.0f;
+
+         strlcpy(params->vcodec, "libx264", sizeof(params->vcodec));
+         strlcpy(params->acodec, "aac", sizeof(params->acodec));
+
+         /* No B-frames or lookahead, so every frame goes
+          * out as soon as it is encoded */
+         av_dict_set(&params->video_opts, "preset", "veryfast", 0);
+         av_dict_set(&params->video_opts, "tune", "zerolatency", 0);
+         av_dict_set(&params->video_opts, "crf", "23", 0);
+         av_dict_set(&params->video_opts, "bf", "0", 0);
+         av_dict_set(&params->audio_opts, "audio_global_quality", "50", 0);
+         break;
       case RECORD_CONFIG_TYPE_STREAMING_NETPLAY:
          params->threads              = video_record_threads;
          params->frame_drop_ratio     = 1;
@@ -752,7 +1009,7 @@ static bool ffmpeg_init_config_common(struct ff_config_param *params,
       params->scale_factor = 1;
       strlcpy(params->format, "apng", sizeof(params->format));
    }
-   else if (preset <= RECORD_CONFIG_TYPE_STREAMING_HIGH_QUALITY)
+   else if (preset <= RECORD_CONFIG_TYPE_STREAMING_LOW_LATENCY)
    {
       if (!video_gpu_record)
          params->scale_factor = (video_stream_scale_factor > 0) ?
@@ -823,6 +1080,10 @@ static bool ffmpeg_init_config(struct ff_config_param *params,
          sizeof(params->acodec));
    config_get_array(params->conf, "format", params->format,
          sizeof(params->format));
+   config_get_array(params->conf, "hwaccel", params->hwaccel,
+         sizeof(params->hwaccel));
+   config_get_array(params->conf, "hwaccel_device", params->hwaccel_device,
+         sizeof(params->hwaccel_device));
 
    config_get_uint(params->conf, "threads", &params->threads);
 
@@ -835,6 +1096,8 @@ static bool ffmpeg_init_config(struct ff_config_param *params,
 
    config_get_uint(params->conf, "sample_rate", &params->sample_rate);
    config_get_float(params->conf, "scale_factor", &params->scale_factor);
+   config_get_float(params->conf, "keyframe_interval",
+         &params->keyframe_interval);
 
    params->audio_qscale = config_get_int(params->conf, "audio_global_quality",
          &params->audio_global_quality);
@@ -873,53 +1136,556 @@ static bool ffmpeg_init_config(struct ff_config_param *params,
    return true;
 }
 
-static bool ffmpeg_init_muxer_pre(ffmpeg_t *handle)
+/* Outputs after the first one have their format guessed
+ * from the name, as the configured one is for the first. */
+static AVOutputFormat *ffmpeg_guess_format(const char *filename)
+{
+   AVOutputFormat *fmt = av_guess_format(NULL, filename, NULL);
+
+   if (fmt)
+      return fmt;
+
+   /* Stream URLs rarely have an extension */
+   if (string_starts_with(filename, "rtmp"))
+      return av_guess_format("flv", NULL, NULL);
+   if (strstr(filename, "://"))
+      return av_guess_format("mpegts", NULL, NULL);
+
+   return NULL;
+}
+
+static AVFormatContext *ffmpeg_muxer_new(ffmpeg_t *handle,
+      const char *filename, bool open_file, bool primary)
 {
-   ctx = avformat_alloc_context();
-   av_strlcpy(ctx->filename, handle->params.filename, sizeof(ctx->filename));
+   AVFormatContext *mux = avformat_alloc_context();
+
+   if (!mux)
+      return NULL;
+
+   av_strlcpy(mux->filename, filename, sizeof(mux->filename));
 
-   if (*handle->config.format)
-      ctx->oformat = av_guess_format(handle->config.format, NULL, NULL);
+   if (primary && *handle->config.format)
+      mux->oformat = av_guess_format(handle->config.format, NULL, NULL);
+   else if (primary)
+      mux->oformat = av_guess_format(NULL, mux->filename, NULL);
    else
-      ctx->oformat = av_guess_format(NULL, ctx->filename, NULL);
+      mux->oformat = ffmpeg_guess_format(mux->filename);
+
+   if (!mux->oformat)
+   {
+      avformat_free_context(mux);
+      return NULL;
+   }
+
+   if (open_file && avio_open(&mux->pb, mux->filename, AVIO_FLAG_WRITE) < 0)
+   {
+      avformat_free_context(mux);
+      return NULL;
+   }
+
+   return mux;
+}
+
+static bool ffmpeg_init_muxer_pre(ffmpeg_t *handle)
+{
+   size_t i;
+   struct string_list *filenames = string_split(handle->params.filename, "|");
 
-   if (!ctx->oformat)
+   if (!filenames)
       return false;
 
-   if (avio_open(&ctx->pb, ctx->filename, AVIO_FLAG_WRITE) < 0)
+   for (i = 0; i < filenames->size; i++)
+   {
+      const char *filename        = filenames->elems[i].data;
+      struct ff_muxer_info *muxer = &handle->muxers[handle->num_muxers];
+
+      if (handle->num_muxers == FF_MAX_MUXERS)
+      {
+         RARCH_WARN("[FFmpeg] Too many outputs, ignoring \"%s\".\n",
+               filename);
+         break;
+      }
+
+      /* The replay buffer only needs the format here, the
+       * files are opened when a replay is saved. */
+      muxer->ctx = ffmpeg_muxer_new(handle, filename,
+            !handle->params.replay_length, handle->num_muxers == 0);
+
+      if (!muxer->ctx)
+      {
+         RARCH_ERR("[FFmpeg] Cannot open output \"%s\".\n", filename);
+         string_list_free(filenames);
+         return false;
+      }
+
+      muxer->lossy = strstr(filename, "://")
+         && !string_starts_with(filename, "file:");
+      handle->num_muxers++;
+
+      if (handle->params.replay_length)
+         break;
+   }
+
+   string_list_free(filenames);
+
+   return handle->num_muxers > 0;
+}
+
+static bool ffmpeg_init_muxer_post(ffmpeg_t *handle)
+{
+   unsigned i;
+
+   for (i = 0; i < handle->num_muxers; i++)
+   {
+      struct ff_muxer_info *muxer = &handle->muxers[i];
+      AVStream *stream            = avformat_new_stream(muxer->ctx,
+            handle->video.encoder);
+
+      stream->codec = handle->video.codec;
+      stream->time_base = stream->codec->time_base;
+      muxer->vstream = stream;
+      muxer->vstream->sample_aspect_ratio =
+         handle->video.codec->sample_aspect_ratio;
+
+      if (handle->config.audio_enable)
+      {
+         stream = avformat_new_stream(muxer->ctx,
+               handle->audio.encoder);
+         stream->codec = handle->audio.codec;
+         stream->time_base = stream->codec->time_base;
+         muxer->astream = stream;
+      }
+
+      av_dict_set(&muxer->ctx->metadata, "title",
+            "RetroArch Video Dump", 0);
+
+      if (handle->params.replay_length)
+      {
+         handle->replay.length = av_rescale_q(handle->params.replay_length,
+               av_make_q(1, 1), handle->video.codec->time_base);
+         return true;
+      }
+
+      if (avformat_write_header(muxer->ctx, NULL) < 0)
+         return false;
+   }
+
+   return true;
+}
+
+/* Takes over the data of 'pkt', which is in codec time
+ * base with stream index 0 for video and 1 for audio.
+ * Returns the result of av_interleaved_write_frame(). */
+static int ffmpeg_muxer_write(ffmpeg_t *handle,
+      struct ff_muxer_info *muxer, AVPacket *pkt)
+{
+   AVCodecContext *codec = pkt->stream_index == 0
+      ? handle->video.codec : handle->audio.codec;
+   AVStream *stream      = pkt->stream_index == 0
+      ? muxer->vstream : muxer->astream;
+
+   pkt->pts = av_rescale_q(pkt->pts, codec->time_base,
+      stream->time_base);
+
+   pkt->dts = av_rescale_q(pkt->dts, codec->time_base,
+      stream->time_base);
+
+   pkt->stream_index = stream->index;
+
+   return av_interleaved_write_frame(muxer->ctx, pkt);
+}
+
+static void ffmpeg_muxer_clear_queue(struct ff_muxer_info *muxer)
+{
+   while (muxer->queue_count)
+   {
+      av_packet_free(&muxer->queue[muxer->queue_head]);
+      muxer->queue_head = (muxer->queue_head + 1) % FF_MUXER_QUEUE_SIZE;
+      muxer->queue_count--;
+   }
+}
+
+static void ffmpeg_muxer_thread(void *data)
+{
+   struct ff_muxer_info *muxer = (struct ff_muxer_info*)data;
+   ffmpeg_t *handle            = (ffmpeg_t*)muxer->ctx->opaque;
+
+   slock_lock(muxer->lock);
+
+   for (;;)
+   {
+      AVPacket *pkt;
+      bool write_failed = false;
+
+      while (muxer->alive && !muxer->queue_count)
+         scond_wait(muxer->cond, muxer->lock);
+
+      /* Stopped, and everything queued is written */
+      if (!muxer->queue_count)
+         break;
+
+      pkt               = muxer->queue[muxer->queue_head];
+      muxer->queue_head = (muxer->queue_head + 1) % FF_MUXER_QUEUE_SIZE;
+      muxer->queue_count--;
+      slock_unlock(muxer->lock);
+
+      /* Wakes the encoder if it waits for room */
+      scond_signal(muxer->cond);
+
+      if (!muxer->failed && ffmpeg_muxer_write(handle, muxer, pkt) < 0)
+         write_failed = true;
+
+      av_packet_free(&pkt);
+
+      slock_lock(muxer->lock);
+
+      /* The other outputs carry on */
+      if (write_failed)
+      {
+         RARCH_ERR("[FFmpeg] Cannot write to \"%s\", dropping this output.\n",
+               muxer->ctx->filename);
+         muxer->failed = true;
+         ffmpeg_muxer_clear_queue(muxer);
+      }
+   }
+
+   slock_unlock(muxer->lock);
+}
+
+static bool ffmpeg_muxer_queue(struct ff_muxer_info *muxer,
+      const AVPacket *pkt)
+{
+   AVPacket *copy;
+   bool keyframe = pkt->stream_index == 0 && (pkt->flags & AV_PKT_FLAG_KEY);
+
+   slock_lock(muxer->lock);
+
+   if (muxer->failed)
+      goto done;
+
+   while (muxer->queue_count == FF_MUXER_QUEUE_SIZE)
+   {
+      if (muxer->lossy)
+      {
+         if (!muxer->skip_to_keyframe)
+            RARCH_WARN("[FFmpeg] \"%s\" can't keep up, dropping packets.\n",
+                  muxer->ctx->filename);
+         ffmpeg_muxer_clear_queue(muxer);
+         muxer->skip_to_keyframe = true;
+         break;
+      }
+
+      scond_wait(muxer->cond, muxer->lock);
+   }
+
+   /* After a drop, resume where the stream can be decoded */
+   if (muxer->skip_to_keyframe)
    {
-      av_free(ctx);
+      if (!keyframe)
+         goto done;
+      muxer->skip_to_keyframe = false;
+   }
+
+   if (!(copy = av_packet_clone(pkt)))
+   {
+      slock_unlock(muxer->lock);
       return false;
    }
 
-   handle->muxer.ctx = ctx;
+   muxer->queue[(muxer->queue_head + muxer->queue_count)
+      % FF_MUXER_QUEUE_SIZE] = copy;
+   muxer->queue_count++;
+
+done:
+   slock_unlock(muxer->lock);
+   scond_signal(muxer->cond);
    return true;
 }
 
-static bool ffmpeg_init_muxer_post(ffmpeg_t *handle)
+/* Hands an encoded packet to every output, see
+ * ffmpeg_muxer_write(). */
+static int ffmpeg_mux_packet(ffmpeg_t *handle, AVPacket *pkt)
+{
+   unsigned i;
+
+   if (handle->num_muxers == 1)
+      return ffmpeg_muxer_write(handle, &handle->muxers[0], pkt);
+
+   for (i = 0; i < handle->num_muxers; i++)
+      if (!ffmpeg_muxer_queue(&handle->muxers[i], pkt))
+         return AVERROR(ENOMEM);
+
+   av_packet_unref(pkt);
+   return 0;
+}
+
+static bool ffmpeg_init_muxer_threads(ffmpeg_t *handle)
 {
-   AVStream *stream = avformat_new_stream(handle->muxer.ctx,
-         handle->video.encoder);
+   unsigned i;
+
+   if (handle->num_muxers < 2)
+      return true;
+
+   for (i = 0; i < handle->num_muxers; i++)
+   {
+      struct ff_muxer_info *muxer = &handle->muxers[i];
+
+      muxer->ctx->opaque = handle;
+      muxer->alive       = true;
+
+      if (     !(muxer->lock   = slock_new())
+            || !(muxer->cond   = scond_new())
+            || !(muxer->thread = sthread_create(ffmpeg_muxer_thread, muxer)))
+         return false;
+   }
+
+   return true;
+}
+
+/* Writes out what is still queued and stops the threads. */
+static void ffmpeg_deinit_muxer_threads(ffmpeg_t *handle)
+{
+   unsigned i;
+
+   for (i = 0; i < handle->num_muxers; i++)
+   {
+      struct ff_muxer_info *muxer = &handle->muxers[i];
+
+      if (muxer->thread)
+      {
+         slock_lock(muxer->lock);
+         muxer->alive = false;
+         slock_unlock(muxer->lock);
+         scond_signal(muxer->cond);
+
+         sthread_join(muxer->thread);
+         muxer->thread = NULL;
+      }
+
+      ffmpeg_muxer_clear_queue(muxer);
+
+      if (muxer->lock)
+         slock_free(muxer->lock);
+      if (muxer->cond)
+         scond_free(muxer->cond);
+      muxer->lock = NULL;
+      muxer->cond = NULL;
+   }
+}
+
+#define REPLAY_PACKET(replay, i) \
+   ((replay)->packets[((replay)->head + (i)) % (replay)->capacity])
+
+static void ffmpeg_replay_free(struct ff_replay_info *replay)
+{
+   size_t i;
+
+   for (i = 0; i < replay->count; i++)
+      av_packet_free(&REPLAY_PACKET(replay, i));
+
+   av_free(replay->packets);
+   replay->packets  = NULL;
+   replay->capacity = 0;
+   replay->head     = 0;
+   replay->count    = 0;
+}
+
+/* Drops whole GOPs from the front while the rest still
+ * covers the replay length, so a saved replay always
+ * starts on a keyframe. */
+static void ffmpeg_replay_trim(struct ff_replay_info *replay,
+      int64_t keyframe_pts)
+{
+   int64_t cutoff = keyframe_pts - replay->length;
+
+   for (;;)
+   {
+      size_t i;
+
+      for (i = 1; i < replay->count; i++)
+      {
+         AVPacket *pkt = REPLAY_PACKET(replay, i);
+         if (pkt->stream_index == 0 && (pkt->flags & AV_PKT_FLAG_KEY))
+            break;
+      }
+
+      if (i >= replay->count || REPLAY_PACKET(replay, i)->pts > cutoff)
+         return;
+
+      while (i--)
+      {
+         av_packet_free(&replay->packets[replay->head]);
+         replay->head = (replay->head + 1) % replay->capacity;
+         replay->count--;
+      }
+   }
+}
+
+/* Takes over the data of 'pkt'. */
+static bool ffmpeg_replay_push(ffmpeg_t *handle, AVPacket *pkt,
+      bool is_video)
+{
+   AVPacket *copy;
+   struct ff_replay_info *replay = &handle->replay;
+
+   if (is_video && (pkt->flags & AV_PKT_FLAG_KEY))
+      ffmpeg_replay_trim(replay, pkt->pts);
+
+   if (replay->count == replay->capacity)
+   {
+      size_t i;
+      size_t capacity   = replay->capacity ? replay->capacity * 2 : 256;
+      AVPacket **packets = (AVPacket**)av_malloc(
+            capacity * sizeof(*packets));
+
+      if (!packets)
+         return false;
+
+      for (i = 0; i < replay->count; i++)
+         packets[i] = REPLAY_PACKET(replay, i);
+
+      av_free(replay->packets);
+      replay->packets  = packets;
+      replay->capacity = capacity;
+      replay->head     = 0;
+   }
+
+   if (!(copy = av_packet_clone(pkt)))
+      return false;
 
-   stream->codec = handle->video.codec;
-   stream->time_base = stream->codec->time_base;
-   handle->muxer.vstream = stream;
-   handle->muxer.vstream->sample_aspect_ratio =
-      handle->video.codec->sample_aspect_ratio;
+   av_packet_unref(pkt);
+
+   copy->stream_index = is_video ? 0 : 1;
+   REPLAY_PACKET(replay, replay->count) = copy;
+   replay->count++;
+
+   return true;
+}
+
+static AVStream *ffmpeg_replay_new_stream(AVFormatContext *mux,
+      AVCodecContext *codec)
+{
+   AVStream *stream = avformat_new_stream(mux, NULL);
+
+   if (!stream || avcodec_parameters_from_context(
+            stream->codecpar, codec) < 0)
+      return NULL;
+
+   stream->time_base           = codec->time_base;
+   stream->sample_aspect_ratio = codec->sample_aspect_ratio;
+
+   return stream;
+}
+
+/* Muxes the replay buffer into a new file, with the
+ * first video frame at time 0. */
+static bool ffmpeg_replay_write(ffmpeg_t *handle, const char *path)
+{
+   size_t i;
+   AVStream *streams[2]          = {NULL};
+   AVRational time_bases[2];
+   int64_t start                 = AV_NOPTS_VALUE;
+   bool ret                      = false;
+   struct ff_replay_info *replay = &handle->replay;
+   AVFormatContext *mux          = ffmpeg_muxer_new(handle, path, true, true);
+
+   if (!mux)
+      return false;
+
+   time_bases[0] = handle->video.codec->time_base;
+   if (!(streams[0] = ffmpeg_replay_new_stream(mux, handle->video.codec)))
+      goto end;
 
    if (handle->config.audio_enable)
    {
-      stream = avformat_new_stream(handle->muxer.ctx,
-            handle->audio.encoder);
-      stream->codec = handle->audio.codec;
-      stream->time_base = stream->codec->time_base;
-      handle->muxer.astream = stream;
+      time_bases[1] = handle->audio.codec->time_base;
+      if (!(streams[1] = ffmpeg_replay_new_stream(mux, handle->audio.codec)))
+         goto end;
+   }
+
+   av_dict_set(&mux->metadata, "title", "RetroArch Instant Replay", 0);
+
+   if (avformat_write_header(mux, NULL) < 0)
+      goto end;
+
+   for (i = 0; i < replay->count; i++)
+   {
+      AVPacket *pkt = REPLAY_PACKET(replay, i);
+      if (pkt->stream_index == 0)
+      {
+         start = pkt->dts != AV_NOPTS_VALUE ? pkt->dts : pkt->pts;
+         break;
+      }
+   }
+
+   if (start == AV_NOPTS_VALUE)
+      start = 0;
+
+   for (i = 0; i < replay->count; i++)
+   {
+      AVPacket pkt;
+      int64_t offset;
+      const AVPacket *src = REPLAY_PACKET(replay, i);
+      int index           = src->stream_index;
+
+      if (!streams[index])
+         continue;
+
+      /* Skips audio from before the first video frame */
+      offset              = av_rescale_q(start,
+            time_bases[0], time_bases[index]);
+      if (src->pts < offset)
+         continue;
+
+      if (av_packet_ref(&pkt, src) < 0)
+         break;
+
+      pkt.pts          = av_rescale_q(pkt.pts - offset,
+            time_bases[index], streams[index]->time_base);
+      if (pkt.dts != AV_NOPTS_VALUE)
+         pkt.dts       = av_rescale_q(pkt.dts - offset,
+               time_bases[index], streams[index]->time_base);
+      pkt.stream_index = streams[index]->index;
+
+      if (av_interleaved_write_frame(mux, &pkt) < 0)
+         break;
+   }
+
+   ret = i == replay->count;
+
+   if (av_write_trailer(mux) < 0)
+      ret = false;
+
+end:
+   avio_closep(&mux->pb);
+   avformat_free_context(mux);
+
+   if (ret)
+      RARCH_LOG("[FFmpeg] Saved instant replay to \"%s\".\n", path);
+   else
+      RARCH_ERR("[FFmpeg] Failed to save instant replay to \"%s\".\n", path);
+
+   return ret;
+}
+
+static void ffmpeg_replay_check_save(ffmpeg_t *handle)
+{
+   char path[PATH_MAX_LENGTH];
+
+   slock_lock(handle->lock);
+   if (!handle->replay.save_pending)
+   {
+      slock_unlock(handle->lock);
+      return;
    }
+   strlcpy(path, handle->replay.path, sizeof(path));
+   slock_unlock(handle->lock);
 
-   av_dict_set(&handle->muxer.ctx->metadata, "title",
-         "RetroArch Video Dump", 0);
+   ffmpeg_replay_write(handle, path);
 
-   return avformat_write_header(handle->muxer.ctx, NULL) >= 0;
+   slock_lock(handle->lock);
+   handle->replay.save_pending = false;
+   slock_unlock(handle->lock);
 }
 
 #define MAX_FRAMES 32
@@ -997,6 +1763,7 @@ static void ffmpeg_free(void *data)
 
    deinit_thread(handle);
    deinit_thread_buf(handle);
+   ffmpeg_deinit_muxer_threads(handle);
 
    if (handle->audio.codec)
    {
@@ -1015,6 +1782,11 @@ static void ffmpeg_free(void *data)
    av_frame_free(&handle->video.conv_frame);
    av_free(handle->video.conv_frame_buf);
 
+#ifdef HAVE_FFMPEG_HWACCEL
+   av_frame_free(&handle->video.hw_frame);
+   av_buffer_unref(&handle->video.hw_device_ctx);
+#endif
+
    scaler_ctx_gen_reset(&handle->video.scaler);
 
    if (handle->video.sws)
@@ -1037,6 +1809,8 @@ static void ffmpeg_free(void *data)
    av_free(handle->audio.fixed_conv);
    av_free(handle->audio.planar_buf);
 
+   ffmpeg_replay_free(&handle->replay);
+
    free(handle);
 }
 
@@ -1087,6 +1861,9 @@ static void *ffmpeg_new(const struct record_params *params)
    if (!ffmpeg_init_muxer_post(handle))
       goto error;
 
+   if (!ffmpeg_init_muxer_threads(handle))
+      goto error;
+
    if (!init_thread(handle))
       goto error;
 
@@ -1251,16 +2028,16 @@ static bool encode_video(ffmpeg_t *handle, AVFrame *frame)
          return false;
       }
 
-      pkt.pts = av_rescale_q(pkt.pts, handle->video.codec->time_base,
-         handle->muxer.vstream->time_base);
+      if (handle->params.replay_length)
+      {
+         if (!ffmpeg_replay_push(handle, &pkt, true))
+            return false;
+         continue;
+      }
 
-      pkt.dts = av_rescale_q(pkt.dts,
-         handle->video.codec->time_base,
-         handle->muxer.vstream->time_base);
-      
-      pkt.stream_index = handle->muxer.vstream->index;
+      pkt.stream_index = 0;
 
-      ret = av_interleaved_write_frame(handle->muxer.ctx, &pkt);
+      ret = ffmpeg_mux_packet(handle, &pkt);
       if (ret < 0)
       {
 #ifdef __cplusplus
@@ -1317,6 +2094,18 @@ static bool ffmpeg_push_video_thread(ffmpeg_t *handle,
 
    handle->video.conv_frame->pts = handle->video.frame_cnt;
 
+#ifdef HAVE_FFMPEG_HWACCEL
+   if (handle->video.hw_frame)
+   {
+      if (!ffmpeg_upload_hw_frame(&handle->video))
+         return false;
+      if (!encode_video(handle, handle->video.hw_frame))
+         return false;
+      handle->video.frame_cnt++;
+      return true;
+   }
+#endif
+
    if (!encode_video(handle, handle->video.conv_frame))
       return false;
 
@@ -1438,17 +2227,19 @@ static bool encode_audio(ffmpeg_t *handle, bool dry)
          return false;
       }
 
-      pkt.pts = av_rescale_q(pkt.pts,
-         handle->audio.codec->time_base,
-         handle->muxer.astream->time_base);
-
-      pkt.dts = av_rescale_q(pkt.dts,
-         handle->audio.codec->time_base,
-         handle->muxer.astream->time_base);
+      if (handle->params.replay_length)
+      {
+         if (!ffmpeg_replay_push(handle, &pkt, false))
+         {
+            av_frame_free(&frame);
+            return false;
+         }
+         continue;
+      }
 
-      pkt.stream_index = handle->muxer.astream->index;
+      pkt.stream_index = 1;
 
-      ret = av_interleaved_write_frame(handle->muxer.ctx, &pkt);
+      ret = ffmpeg_mux_packet(handle, &pkt);
       if (ret < 0)
       {
          av_frame_free(&frame);
@@ -1663,6 +2454,7 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
 
 static bool ffmpeg_finalize(void *data)
 {
+   unsigned i;
    ffmpeg_t *handle = (ffmpeg_t*)data;
    if (!handle)
       return false;
@@ -1674,14 +2466,51 @@ static bool ffmpeg_finalize(void *data)
 
    deinit_thread_buf(handle);
 
+   /* Nothing was written to the file, but a replay
+    * requested just before stopping is still saved. */
+   if (handle->params.replay_length)
+   {
+      if (handle->replay.save_pending)
+         ffmpeg_replay_write(handle, handle->replay.path);
+      handle->replay.save_pending = false;
+      return true;
+   }
+
+   ffmpeg_deinit_muxer_threads(handle);
+
    /* Write final data. */
-   av_write_trailer(handle->muxer.ctx);
+   for (i = 0; i < handle->num_muxers; i++)
+   {
+      av_write_trailer(handle->muxers[i].ctx);
 
-   avio_close(ctx->pb);
+      avio_close(handle->muxers[i].ctx->pb);
+   }
 
    return true;
 }
 
+static bool ffmpeg_save_replay(void *data, const char *path)
+{
+   bool ret         = false;
+   ffmpeg_t *handle = (ffmpeg_t*)data;
+
+   if (!handle || !handle->params.replay_length || !handle->thread)
+      return false;
+
+   slock_lock(handle->lock);
+   if (!handle->replay.save_pending)
+   {
+      strlcpy(handle->replay.path, path, sizeof(handle->replay.path));
+      handle->replay.save_pending = true;
+      ret                         = true;
+   }
+   slock_unlock(handle->lock);
+
+   scond_signal(handle->cond);
+
+   return ret;
+}
+
 static void ffmpeg_thread(void *data)
 {
    size_t audio_buf_size;
@@ -1714,6 +2543,9 @@ static void ffmpeg_thread(void *data)
             avail_audio = true;
       slock_unlock(ff->lock);
 
+      if (ff->replay.save_pending)
+         ffmpeg_replay_check_save(ff);
+
       if (!avail_video && !avail_audio)
       {
          slock_lock(ff->cond_lock);
@@ -1768,5 +2600,6 @@ const record_driver_t record_ffmpeg = {
    ffmpeg_push_video,
    ffmpeg_push_audio,
    ffmpeg_finalize,
+   ffmpeg_save_replay,
    "ffmpeg",
 };
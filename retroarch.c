@@ -69,9 +69,13 @@
 #include <file/config_file.h>
 #include <lists/string_list.h>
 #include <memalign.h>
+#ifdef HAVE_MEMMAP
+#include <memmap.h>
+#endif
 #include <retro_math.h>
 #include <retro_timers.h>
 #include <encodings/utf.h>
+#include <encodings/crc32.h>
 #include <time/rtime.h>
 
 #include <gfx/scaler/pixconv.h>
@@ -101,6 +105,7 @@
 #include <retro_assert.h>
 #include <retro_miscellaneous.h>
 #include <queues/message_queue.h>
+#include <queues/mpsc_queue.h>
 #include <queues/task_queue.h>
 #include <lists/dir_list.h>
 #ifdef HAVE_NETWORKING
@@ -175,6 +180,10 @@
 #include "input/input_keymaps.h"
 #include "input/input_remapping.h"
 
+#ifdef HAVE_BSV_MOVIE
+#include "input/bsv/bsv_stream.h"
+#endif
+
 #ifdef HAVE_CHEEVOS
 #include "cheevos/cheevos.h"
 #include "cheevos/cheevos_menu.h"
@@ -200,6 +209,7 @@
 
 #ifdef HAVE_THREADS
 #include <rthreads/rthreads.h>
+#include <rthreads/tpool.h>
 #endif
 
 #if defined(HAVE_OPENGL)
@@ -213,6 +223,7 @@
 #include "config.features.h"
 #include "cores/internal_cores.h"
 #include "content.h"
+#include "content_hash_cache.h"
 #include "core_type.h"
 #include "core_info.h"
 #include "dynamic.h"
@@ -229,6 +240,10 @@
 #include "gfx/video_thread_wrapper.h"
 #endif
 #include "gfx/video_display_server.h"
+#include "gfx/video_frame_export.h"
+#ifdef HAVE_SLANG
+#include "gfx/drivers_shader/glslang_util.h"
+#endif
 #ifdef HAVE_CRTSWITCHRES
 #include "gfx/video_crt_switch.h"
 #endif
@@ -241,6 +256,7 @@
 #include "configuration.h"
 #include "list_special.h"
 #include "core_option_manager.h"
+#include "core_memory_dirty.h"
 #ifdef HAVE_CHEATS
 #include "cheat_manager.h"
 #endif
@@ -255,6 +271,7 @@
 #include "tasks/task_powerstate.h"
 #include "tasks/tasks_internal.h"
 #include "performance_counters.h"
+#include "session_runner.h"
 
 #include "version.h"
 #include "version_git.h"
@@ -1642,6 +1659,49 @@ static void menu_cbs_init(
    if (!label || !menu_label)
       return;
 
+   /* Only appends can reuse the bindings of the previous
+    * entry - anything else may have shifted the list */
+   if (idx + 1 != list->size)
+      menu_st->bind_cache.list = NULL;
+   else
+   {
+      menu_file_list_cbs_t *prev_cbs = (idx > 0)
+         ? (menu_file_list_cbs_t*)list->list[idx - 1].actiondata
+         : NULL;
+
+      if (     prev_cbs
+            && menu_st->bind_cache.list == list
+            && menu_st->bind_cache.idx  == idx - 1
+            && prev_cbs->enum_idx       == cbs->enum_idx
+            && prev_cbs->setting        == cbs->setting
+            && list->list[idx - 1].type == type
+            && string_is_equal(list->list[idx - 1].label, label)
+            && string_is_equal(menu_st->bind_cache.menu_label, menu_label))
+      {
+         cbs->action_iterate        = prev_cbs->action_iterate;
+         cbs->action_deferred_push  = prev_cbs->action_deferred_push;
+         cbs->action_select         = prev_cbs->action_select;
+         cbs->action_get_title      = prev_cbs->action_get_title;
+         cbs->action_ok             = prev_cbs->action_ok;
+         cbs->action_cancel         = prev_cbs->action_cancel;
+         cbs->action_scan           = prev_cbs->action_scan;
+         cbs->action_start          = prev_cbs->action_start;
+         cbs->action_info           = prev_cbs->action_info;
+         cbs->action_left           = prev_cbs->action_left;
+         cbs->action_right          = prev_cbs->action_right;
+         cbs->action_label          = prev_cbs->action_label;
+         cbs->action_sublabel       = prev_cbs->action_sublabel;
+         cbs->action_get_value      = prev_cbs->action_get_value;
+         menu_st->bind_cache.idx    = idx;
+         return;
+      }
+
+      menu_st->bind_cache.list      = list;
+      menu_st->bind_cache.idx       = idx;
+      strlcpy(menu_st->bind_cache.menu_label, menu_label,
+            sizeof(menu_st->bind_cache.menu_label));
+   }
+
 #ifdef DEBUG_LOG
    RARCH_LOG("\n");
 
@@ -3281,8 +3341,8 @@ static bool menu_entries_init(
 {
    if (!(menu_st->entries.list = (menu_list_t*)menu_list_new(menu_driver_ctx)))
       return false;
-   if (!(menu_st->entries.list_settings = menu_setting_new()))
-      return false;
+   /* The settings list is built on first use,
+    * see MENU_ENTRIES_CTL_SETTINGS_GET */
    return true;
 }
 
@@ -3312,10 +3372,6 @@ void menu_entries_append(
 
    list_info.list     = list;
    list_info.path     = path;
-   list_info.fullpath = NULL;
-
-   if (!string_is_empty(menu_path))
-      list_info.fullpath = strdup(menu_path);
 
    list_info.label       = label;
    list_info.idx         = idx;
@@ -3327,14 +3383,11 @@ void menu_entries_append(
             p_rarch->menu_userdata,
             list_info.list,
             list_info.path,
-            list_info.fullpath,
+            menu_path,
             list_info.label,
             list_info.idx,
             list_info.entry_type);
 
-   if (list_info.fullpath)
-      free(list_info.fullpath);
-
    file_list_free_actiondata(list, idx);
    cbs                             = (menu_file_list_cbs_t*)
       malloc(sizeof(menu_file_list_cbs_t));
@@ -3399,10 +3452,6 @@ bool menu_entries_append_enum(
 
    idx                   = list->size - 1;
 
-   list_info.fullpath    = NULL;
-
-   if (!string_is_empty(menu_path))
-      list_info.fullpath = strdup(menu_path);
    list_info.list        = list;
    list_info.path        = path;
    list_info.label       = label;
@@ -3415,14 +3464,11 @@ bool menu_entries_append_enum(
             p_rarch->menu_userdata,
             list_info.list,
             list_info.path,
-            list_info.fullpath,
+            menu_path,
             list_info.label,
             list_info.idx,
             list_info.entry_type);
 
-   if (list_info.fullpath)
-      free(list_info.fullpath);
-
    file_list_free_actiondata(list, idx);
    cbs                             = (menu_file_list_cbs_t*)
       malloc(sizeof(menu_file_list_cbs_t));
@@ -3488,10 +3534,6 @@ void menu_entries_prepend(file_list_t *list,
    file_list_get_last(MENU_LIST_GET(menu_st->entries.list, 0),
          &menu_path, NULL, NULL, NULL);
 
-   list_info.fullpath    = NULL;
-
-   if (!string_is_empty(menu_path))
-      list_info.fullpath = strdup(menu_path);
    list_info.list        = list;
    list_info.path        = path;
    list_info.label       = label;
@@ -3504,14 +3546,11 @@ void menu_entries_prepend(file_list_t *list,
             p_rarch->menu_userdata,
             list_info.list,
             list_info.path,
-            list_info.fullpath,
+            menu_path,
             list_info.label,
             list_info.idx,
             list_info.entry_type);
 
-   if (list_info.fullpath)
-      free(list_info.fullpath);
-
    file_list_free_actiondata(list, idx);
    cbs                             = (menu_file_list_cbs_t*)
       malloc(sizeof(menu_file_list_cbs_t));
@@ -3647,6 +3686,12 @@ bool menu_entries_ctl(enum menu_entries_ctl_state state, void *data)
             rarch_setting_t **settings  = (rarch_setting_t**)data;
             if (!settings)
                return false;
+            /* Building every setting takes a while and a fair
+             * amount of memory, so wait until something actually
+             * looks one up. Content started without ever showing
+             * the menu then never pays for it. */
+            if (!menu_st->entries.list_settings && menu_st->entries.list)
+               menu_st->entries.list_settings = menu_setting_new();
             *settings = menu_st->entries.list_settings;
          }
          break;
@@ -4051,6 +4096,21 @@ void menu_display_handle_wallpaper_upload(
          MENU_IMAGE_WALLPAPER);
 }
 
+/* Loads 'path' as the menu wallpaper. It is never shown
+ * larger than the screen, so it is scaled down to that
+ * while decoding */
+bool menu_display_load_wallpaper(const char *path)
+{
+   unsigned width  = 0;
+   unsigned height = 0;
+
+   video_driver_get_size(&width, &height);
+
+   return task_push_image_load_scaled(path,
+         video_driver_supports_rgba(), width, height,
+         menu_display_handle_wallpaper_upload, NULL);
+}
+
 /**
  * config_get_menu_driver_options:
  *
@@ -4817,6 +4877,8 @@ bool menu_driver_init(bool video_is_threaded)
    command_event(CMD_EVENT_CORE_INFO_INIT, NULL);
    command_event(CMD_EVENT_LOAD_CORE_PERSIST, NULL);
 
+   perf_boot_begin(PERF_BOOT_MENU);
+
    if (  p_rarch->menu_driver_data ||
          menu_driver_init_internal(
             &p_rarch->dispgfx,
@@ -4824,14 +4886,25 @@ bool menu_driver_init(bool video_is_threaded)
             p_rarch->configuration_settings,
             video_is_threaded))
    {
+      gfx_thumbnail_set_cache_size((size_t)p_rarch->configuration_settings->
+            uints.gfx_thumbnail_cache_size * 1024 * 1024);
+      gfx_thumbnail_set_pack_enable(p_rarch->configuration_settings->
+            bools.gfx_thumbnail_pack_enable);
+
       if (p_rarch->menu_driver_ctx && p_rarch->menu_driver_ctx->context_reset)
       {
+         /* Loads the menu's textures and fonts */
+         perf_boot_begin(PERF_BOOT_ASSETS);
          p_rarch->menu_driver_ctx->context_reset(p_rarch->menu_userdata,
                video_is_threaded);
+         perf_boot_end(PERF_BOOT_ASSETS);
+         perf_boot_end(PERF_BOOT_MENU);
          return true;
       }
    }
 
+   perf_boot_end(PERF_BOOT_MENU);
+
    /* If driver initialisation failed, must reset
     * driver id to 'unknown' */
    p_disp->menu_driver_id = MENU_DRIVER_ID_UNKNOWN;
@@ -5345,6 +5418,9 @@ bool menu_driver_ctl(enum rarch_menu_ctl_state state, void *data)
                && p_rarch->menu_driver_ctx->context_destroy)
             p_rarch->menu_driver_ctx->context_destroy(p_rarch->menu_userdata);
 
+         /* Drivers released their thumbnails above */
+         gfx_thumbnail_cache_flush();
+
          if (menu_st->data_own)
             return true;
 
@@ -5395,8 +5471,10 @@ bool menu_driver_ctl(enum rarch_menu_ctl_state state, void *data)
             gfx_animation_deinit(&p_rarch->anim);
             gfx_display_free();
 
-            menu_entries_settings_deinit(menu_st);
+            /* Lists first, so nothing can build the
+             * settings list again once it is gone */
             menu_entries_list_deinit(p_rarch->menu_driver_ctx, menu_st);
+            menu_entries_settings_deinit(menu_st);
 
             if (p_rarch->menu_driver_data->core_buf)
                free(p_rarch->menu_driver_data->core_buf);
@@ -5815,6 +5893,10 @@ end:
  * @apply                    : Whether to apply the shader or just update shader information
  *
  * Sets shader preset.
+ *
+ * Returns: true if the preset was set. False on failure, and
+ * also while a preset to apply is still being compiled in the
+ * background - the menu is only updated once it is applied.
  **/
 bool menu_shader_manager_set_preset(struct video_shader *shader,
       enum rarch_shader_type type, const char *preset_path, bool apply)
@@ -5824,9 +5906,22 @@ bool menu_shader_manager_set_preset(struct video_shader *shader,
    struct rarch_state  *p_rarch  = &rarch_st;
    settings_t *settings          = p_rarch->configuration_settings;
 
-   if (apply && !retroarch_apply_shader(p_rarch, settings,
-            type, preset_path, true))
-      goto clear;
+   if (apply)
+   {
+      switch (retroarch_apply_shader(p_rarch, settings,
+               type, preset_path, true))
+      {
+         case SHADER_APPLY_FAILED:
+            goto clear;
+         case SHADER_APPLY_PENDING:
+            /* The menu is left as it is until the preset has
+             * been compiled - task_shader_compile_cb() then
+             * calls back in here with 'apply' unset */
+            return false;
+         default:
+            break;
+      }
+   }
 
    if (string_is_empty(preset_path))
    {
@@ -7090,12 +7185,7 @@ static bool get_self_input_state(
    }
 
    /* And send this input to our peers */
-   for (i = 0; i < netplay->connections_size; i++)
-   {
-      struct netplay_connection *connection = &netplay->connections[i];
-      if (connection->active && connection->mode >= NETPLAY_CONNECTION_CONNECTED)
-         netplay_send_cur_input(netplay, &netplay->connections[i]);
-   }
+   netplay_send_cur_input_all(netplay);
 
    /* Handle any delayed state changes */
    if (netplay->is_server)
@@ -7172,9 +7262,12 @@ static bool netplay_poll(
     * network latency */
    if (netplay->frame_run_time_avg || netplay->stateless_mode)
    {
-      /* FIXME: Using fixed 60fps for this calculation */
+      struct rarch_state *p_rarch  = &rarch_st;
+      double fps                   = p_rarch->video_driver_av_info.timing.fps;
+      retro_time_t frame_period    = (fps > 0.0) ?
+         (retro_time_t)(1000000.0 / fps) : 16666;
       unsigned frames_per_frame    = netplay->frame_run_time_avg ?
-         (16666 / netplay->frame_run_time_avg) :
+         (unsigned)(frame_period / netplay->frame_run_time_avg) :
          0;
       unsigned frames_ahead        = (netplay->run_frame_count > netplay->unread_frame_count) ?
          (netplay->run_frame_count - netplay->unread_frame_count) :
@@ -7190,6 +7283,19 @@ static bool netplay_poll(
       else
          frames_per_frame = 0;
 
+      /* Don't run further ahead than we can replay within a frame, so that
+       * a misprediction never turns into a long replay and a hitch. Running
+       * out of rollback depth stalls us, and the latency adjustment below
+       * then hides the rest with input latency. */
+      if (netplay->stateless_mode)
+         netplay->rollback_max_frames = NETPLAY_MAX_STALL_FRAMES;
+      else if (frames_per_frame < NETPLAY_MIN_ROLLBACK_FRAMES)
+         netplay->rollback_max_frames = NETPLAY_MIN_ROLLBACK_FRAMES;
+      else if (frames_per_frame > NETPLAY_MAX_STALL_FRAMES)
+         netplay->rollback_max_frames = NETPLAY_MAX_STALL_FRAMES;
+      else
+         netplay->rollback_max_frames = frames_per_frame;
+
       /* Shall we adjust our latency? */
       if (netplay->stateless_mode)
       {
@@ -7225,8 +7331,8 @@ static bool netplay_poll(
    switch (netplay->stall)
    {
       case NETPLAY_STALL_RUNNING_FAST:
-         if (netplay->unread_frame_count + NETPLAY_MAX_STALL_FRAMES - 2
-               > netplay->self_frame_count)
+         if (netplay->unread_frame_count + netplay->rollback_max_frames
+               > netplay->self_frame_count + 2)
          {
             netplay->stall = NETPLAY_STALL_NONE;
             for (i = 0; i < netplay->connections_size; i++)
@@ -7279,7 +7385,7 @@ static bool netplay_poll(
       }
 
       /* Are we too far ahead? */
-      if (netplay->unread_frame_count + NETPLAY_MAX_STALL_FRAMES
+      if (netplay->unread_frame_count + netplay->rollback_max_frames
             <= netplay->self_frame_count)
       {
          netplay->stall      = NETPLAY_STALL_RUNNING_FAST;
@@ -8007,6 +8113,30 @@ static void netplay_force_future(netplay_t *netplay)
    }
 }
 
+/**
+ * netplay_compress_savestate
+ * @netplay              : pointer to netplay object
+ * @z                    : compression backend to use
+ * @data                 : data to compress into netplay->zbuffer
+ * @size                 : size of @data
+ * @wn                   : number of bytes written to netplay->zbuffer
+ *
+ * Returns: true (1) if successful, otherwise false (0).
+ */
+static bool netplay_compress_savestate(netplay_t *netplay,
+   struct compression_transcoder *z, const void *data, size_t size,
+   uint32_t *wn)
+{
+   uint32_t rd;
+
+   z->compression_backend->set_in(z->compression_stream,
+      (const uint8_t*)data, (uint32_t)size);
+   z->compression_backend->set_out(z->compression_stream,
+      netplay->zbuffer, (uint32_t)netplay->zbuffer_size);
+   return z->compression_backend->trans(z->compression_stream, true, &rd,
+         wn, NULL);
+}
+
 /**
  * netplay_send_savestate
  * @netplay              : pointer to netplay object
@@ -8015,33 +8145,22 @@ static void netplay_force_future(netplay_t *netplay)
  * @z                    : compression backend to use
  *
  * Send a loaded savestate to those connected peers using the given compression
- * scheme.
+ * scheme. Peers which support it and already have a savestate from us get
+ * a delta against that one instead of the whole state.
  */
 static void netplay_send_savestate(netplay_t *netplay,
    retro_ctx_serialize_info_t *serial_info, uint32_t cx,
    struct compression_transcoder *z)
 {
    uint32_t header[4];
-   uint32_t rd, wn;
+   uint32_t wn             = 0;
+   bool have_full          = false;
+#ifdef HAVE_REWIND
+   bool have_delta_state   = false;
+   bool full_size          = (serial_info->size == netplay->state_size);
+#endif
    size_t i;
 
-   /* Compress it */
-   z->compression_backend->set_in(z->compression_stream,
-      (const uint8_t*)serial_info->data_const, (uint32_t)serial_info->size);
-   z->compression_backend->set_out(z->compression_stream,
-      netplay->zbuffer, (uint32_t)netplay->zbuffer_size);
-   if (!z->compression_backend->trans(z->compression_stream, true, &rd,
-         &wn, NULL))
-   {
-      /* Catastrophe! */
-      for (i = 0; i < netplay->connections_size; i++)
-         netplay_hangup(netplay, &netplay->connections[i]);
-      return;
-   }
-
-   /* Send it to relevant peers */
-   header[0] = htonl(NETPLAY_CMD_LOAD_SAVESTATE);
-   header[1] = htonl(wn + 2*sizeof(uint32_t));
    header[2] = htonl(netplay->run_frame_count);
    header[3] = htonl(serial_info->size);
 
@@ -8052,11 +8171,86 @@ static void netplay_send_savestate(netplay_t *netplay,
           connection->mode < NETPLAY_CONNECTION_CONNECTED ||
           connection->compression_supported != cx) continue;
 
+#ifdef HAVE_REWIND
+      if (connection->delta_send_state && netplay->delta_state && full_size)
+      {
+         size_t patch_size;
+
+         /* The delta codec needs the new state in its own buffer */
+         if (!have_delta_state)
+         {
+            memcpy(netplay->delta_state, serial_info->data_const,
+                  serial_info->size);
+            have_delta_state = true;
+         }
+
+         /* A patch that turns the last state sent into this one */
+         patch_size = state_manager_raw_compress(netplay->delta_state,
+               connection->delta_send_state, netplay->state_size,
+               netplay->delta_patch);
+
+         if (!netplay_compress_savestate(netplay, z, netplay->delta_patch,
+                  patch_size, &wn))
+         {
+            netplay_hangup(netplay, connection);
+            continue;
+         }
+
+         header[0] = htonl(NETPLAY_CMD_LOAD_SAVESTATE_DELTA);
+         have_full = false;
+      }
+      else
+#endif
+      {
+         if (!have_full)
+         {
+            if (!netplay_compress_savestate(netplay, z,
+                     serial_info->data_const, serial_info->size, &wn))
+            {
+               /* Catastrophe! */
+               for (i = 0; i < netplay->connections_size; i++)
+                  netplay_hangup(netplay, &netplay->connections[i]);
+               return;
+            }
+            have_full = true;
+         }
+
+         header[0] = htonl(NETPLAY_CMD_LOAD_SAVESTATE);
+      }
+
+      header[1] = htonl(wn + 2*sizeof(uint32_t));
+
       if (!netplay_send(&connection->send_packet_buffer, connection->fd, header,
             sizeof(header)) ||
           !netplay_send(&connection->send_packet_buffer, connection->fd,
             netplay->zbuffer, wn))
+      {
          netplay_hangup(netplay, connection);
+         continue;
+      }
+
+#ifdef HAVE_REWIND
+      /* Remember what the peer has now, for the next delta */
+      if (connection->delta_supported && netplay->delta_state)
+      {
+         if (!full_size)
+         {
+            /* The peer refuses states of the wrong size, so this
+             * one can't be a reference */
+            if (connection->delta_send_state)
+               free(connection->delta_send_state);
+            connection->delta_send_state = NULL;
+            continue;
+         }
+
+         if (!connection->delta_send_state)
+            connection->delta_send_state = (uint8_t*)
+               state_manager_raw_alloc(netplay->state_size, 0);
+         if (connection->delta_send_state)
+            memcpy(connection->delta_send_state, serial_info->data_const,
+                  serial_info->size);
+      }
+#endif
    }
 }
 
@@ -10429,6 +10623,14 @@ bool menu_driver_is_alive(void)
    struct rarch_state *p_rarch = &rarch_st;
    return p_rarch->menu_driver_alive;
 }
+
+/* Checks if the menu waits for its first use to be
+ * initialised */
+bool menu_driver_is_deferred(void)
+{
+   struct rarch_state *p_rarch = &rarch_st;
+   return p_rarch->menu_driver_deferred;
+}
 #endif
 
 /* MESSAGE QUEUE */
@@ -10440,6 +10642,8 @@ static void retroarch_msg_queue_deinit(void)
    msg_queue_deinitialize(&runloop_state.msg_queue);
 
    RUNLOOP_MSG_QUEUE_UNLOCK(runloop_state);
+
+   mpsc_queue_deinitialize(&runloop_state.msg_queue_incoming);
 #ifdef HAVE_THREADS
    slock_free(runloop_state.msg_queue_lock);
    runloop_state.msg_queue_lock = NULL;
@@ -10452,6 +10656,8 @@ static void retroarch_msg_queue_init(void)
 {
    retroarch_msg_queue_deinit();
    msg_queue_initialize(&runloop_state.msg_queue, 8);
+   mpsc_queue_initialize(&runloop_state.msg_queue_incoming,
+         sizeof(runloop_msg_t), RUNLOOP_MSG_QUEUE_INCOMING_SIZE);
 
 #ifdef HAVE_THREADS
    runloop_state.msg_queue_lock   = slock_new();
@@ -10517,6 +10723,211 @@ bool command_get_status(command_t *cmd, const char* arg)
    return true;
 }
 
+static size_t command_frame_telemetry_print(char *s, size_t len,
+      const frame_telemetry_t *rec, const char *separator)
+{
+   return snprintf(s, len,
+         "%" PRIu64 "%s%" PRId64 "%s%" PRId64 "%s%" PRId64 "%s%u%s%d",
+         rec->frame,                     separator,
+         (int64_t)rec->cpu_time,         separator,
+         (int64_t)rec->gpu_time,         separator,
+         (int64_t)rec->present_interval, separator,
+         rec->missed_vsyncs,             separator,
+         rec->queue_depth);
+}
+
+/* Replies with one line per frame, for the last
+ * [count] frames (oldest first), each being
+ * <frame> <cpu us> <gpu us> <interval us> <missed vsyncs> <queue depth> */
+bool command_get_frame_telemetry(command_t *cmd, const char* arg)
+{
+   char reply[FRAME_TELEMETRY_REPLY_MAX * 128];
+   struct rarch_state *p_rarch = &rarch_st;
+   uint64_t total              = p_rarch->frame_telemetry_count;
+   unsigned count              = 1;
+   size_t len                  = 0;
+   uint64_t i;
+
+   if (!string_is_empty(arg))
+      count = (unsigned)strtoul(arg, NULL, 10);
+   if (count > FRAME_TELEMETRY_REPLY_MAX)
+      count = FRAME_TELEMETRY_REPLY_MAX;
+   if (count > total)
+      count = (unsigned)total;
+
+   reply[0] = '\0';
+
+   if (count == 0)
+      len = strlcpy(reply, "GET_FRAME_TELEMETRY -1\n", sizeof(reply));
+
+   for (i = total - count; i < total; i++)
+   {
+      len += strlcpy(reply + len, "GET_FRAME_TELEMETRY ", sizeof(reply) - len);
+      len += command_frame_telemetry_print(reply + len, sizeof(reply) - len,
+            &p_rarch->frame_telemetry[i & (FRAME_TELEMETRY_COUNT - 1)], " ");
+      len += strlcpy(reply + len, "\n", sizeof(reply) - len);
+   }
+
+   cmd->replier(cmd, reply, len);
+
+   return true;
+}
+
+/* Writes every frame still in the ring to <path> as CSV */
+bool command_dump_frame_telemetry(command_t *cmd, const char* arg)
+{
+   char reply[PATH_MAX_LENGTH + 64];
+   struct rarch_state *p_rarch = &rarch_st;
+   uint64_t total              = p_rarch->frame_telemetry_count;
+   uint64_t first              = total > FRAME_TELEMETRY_COUNT
+      ? total - FRAME_TELEMETRY_COUNT : 0;
+   RFILE *file                 = NULL;
+   uint64_t i;
+
+   if (!string_is_empty(arg))
+      file = filestream_open(arg,
+            RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+   {
+      snprintf(reply, sizeof(reply), "DUMP_FRAME_TELEMETRY -1\n");
+      cmd->replier(cmd, reply, strlen(reply));
+      return false;
+   }
+
+   filestream_printf(file,
+         "frame,cpu_us,gpu_us,interval_us,missed_vsyncs,queue_depth\n");
+
+   for (i = first; i < total; i++)
+   {
+      char line[128];
+      command_frame_telemetry_print(line, sizeof(line),
+            &p_rarch->frame_telemetry[i & (FRAME_TELEMETRY_COUNT - 1)], ",");
+      filestream_printf(file, "%s\n", line);
+   }
+
+   filestream_close(file);
+
+   snprintf(reply, sizeof(reply), "DUMP_FRAME_TELEMETRY %u %s\n",
+         (unsigned)(total - first), arg);
+   cmd->replier(cmd, reply, strlen(reply));
+
+   return true;
+}
+
+/* Writes the averaged GPU time of each shader pass to <path> as CSV */
+bool command_dump_shader_pass_timings(command_t *cmd, const char* arg)
+{
+   char reply[PATH_MAX_LENGTH + 64];
+   video_shader_ctx_t shader_info;
+   struct rarch_state *p_rarch = &rarch_st;
+   shader_pass_timing_t *st    = &p_rarch->shader_pass_timing;
+   RFILE *file                 = NULL;
+   unsigned i;
+
+   shader_info.data            = NULL;
+
+   if (!string_is_empty(arg))
+      file = filestream_open(arg,
+            RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+   {
+      snprintf(reply, sizeof(reply), "DUMP_SHADER_PASS_TIMINGS -1\n");
+      cmd->replier(cmd, reply, strlen(reply));
+      return false;
+   }
+
+   video_shader_driver_get_current_shader(&shader_info);
+
+   filestream_printf(file, "pass,shader,gpu_us\n");
+
+   for (i = 0; i < st->passes; i++)
+   {
+      const char *path = "";
+
+      if (shader_info.data && i < shader_info.data->passes)
+         path          = path_basename(shader_info.data->pass[i].source.path);
+
+      filestream_printf(file, "%u,%s,%" PRId64 "\n",
+            i, path, (int64_t)st->average[i]);
+   }
+
+   filestream_close(file);
+
+   snprintf(reply, sizeof(reply), "DUMP_SHADER_PASS_TIMINGS %u %s\n",
+         st->passes, arg);
+   cmd->replier(cmd, reply, strlen(reply));
+
+   return true;
+}
+
+static void command_perf_trace_task(retro_task_t *task, bool begin)
+{
+   if (begin)
+   {
+      perf_trace_begin("task");
+   }
+   else
+   {
+      perf_trace_end("task");
+   }
+}
+
+/* Starts (1) or stops (0) recording trace scopes */
+bool command_perf_trace(command_t *cmd, const char* arg)
+{
+   char reply[64];
+   bool enable = !string_is_empty(arg) && string_to_unsigned(arg) != 0;
+
+   /* Only hook the task queue while tracing, so that
+    * tasks don't pay for it otherwise */
+   task_queue_set_trace(enable ? command_perf_trace_task : NULL);
+   perf_trace_set_enabled(enable);
+
+   snprintf(reply, sizeof(reply), "PERF_TRACE %d\n", enable ? 1 : 0);
+   cmd->replier(cmd, reply, strlen(reply));
+
+   return true;
+}
+
+/* Writes the recorded trace scopes to <path>, in the
+ * Chrome trace event format */
+bool command_dump_perf_trace(command_t *cmd, const char* arg)
+{
+   char reply[PATH_MAX_LENGTH + 64];
+   size_t events = 0;
+
+   if (!perf_trace_dump(arg, &events))
+   {
+      snprintf(reply, sizeof(reply), "DUMP_PERF_TRACE -1\n");
+      cmd->replier(cmd, reply, strlen(reply));
+      return false;
+   }
+
+   snprintf(reply, sizeof(reply), "DUMP_PERF_TRACE %u %s\n",
+         (unsigned)events, arg);
+   cmd->replier(cmd, reply, strlen(reply));
+
+   return true;
+}
+
+#ifdef HAVE_BSV_MOVIE
+/* Jumps BSV2 movie playback to <frame> or <[hh:]mm:ss>,
+ * replies with the frame it landed on */
+bool command_bsv_seek(command_t *cmd, const char* arg)
+{
+   char reply[64];
+   struct rarch_state *p_rarch = &rarch_st;
+   int64_t frame               = bsv_movie_seek(p_rarch, arg);
+
+   snprintf(reply, sizeof(reply), "BSV_SEEK %" PRId64 "\n", frame);
+   cmd->replier(cmd, reply, strlen(reply));
+
+   return frame >= 0;
+}
+#endif
+
 bool command_show_osd_msg(command_t *cmd, const char* arg)
 {
     runloop_msg_queue_push(arg, 1, 180, false, NULL,
@@ -10755,9 +11166,316 @@ bool command_write_memory(command_t *cmd, const char *arg)
    cmd->replier(cmd, reply, strlen(reply));
    return true;
 }
+
+static void command_memory_put_le32(uint8_t *out, uint32_t val)
+{
+   out[0] = (uint8_t)(val);
+   out[1] = (uint8_t)(val >> 8);
+   out[2] = (uint8_t)(val >> 16);
+   out[3] = (uint8_t)(val >> 24);
+}
+
+/* Parses '<address> <number of bytes>' pairs,
+ * returns how many were found */
+static unsigned command_memory_parse_ranges(const char *arg,
+      command_memory_range_t *ranges)
+{
+   unsigned count = 0;
+
+   while (count < COMMAND_MEMORY_RANGES_MAX)
+   {
+      char *end        = NULL;
+      unsigned address = (unsigned)strtoul(arg, &end, 16);
+      unsigned len;
+
+      if (end == arg)
+         break;
+      arg              = end;
+      len              = (unsigned)strtoul(arg, &end, 10);
+      if (end == arg)
+         break;
+      arg              = end;
+
+      ranges[count].address = address;
+      ranges[count].len     = len;
+      count++;
+   }
+
+   return count;
+}
+
+/* Sends the given ranges as one binary reply, ranges
+ * are cut short once COMMAND_MEMORY_REPLY_MAX is hit */
+static void command_memory_reply_ranges(command_t *cmd,
+      command_replier_t replier, const char *name,
+      const command_memory_range_t *ranges, unsigned count)
+{
+   unsigned i;
+   char head[64];
+   uint8_t *reply = NULL;
+   size_t size    = snprintf(head, sizeof(head), "%s %u\n", name, count);
+   size_t len     = size;
+
+   size          += count * 8;
+   for (i = 0; i < count; i++)
+      size       += ranges[i].len;
+   if (size > COMMAND_MEMORY_REPLY_MAX)
+      size        = COMMAND_MEMORY_REPLY_MAX;
+
+   if (!(reply = (uint8_t*)malloc(size)))
+      return;
+
+   memcpy(reply, head, len);
+
+   for (i = 0; i < count; i++)
+   {
+      char error[64];
+      unsigned max_bytes  = 0;
+      unsigned nbytes     = ranges[i].len;
+      const uint8_t *data = command_memory_get_pointer(ranges[i].address,
+            &max_bytes, 0, error, sizeof(error));
+
+      if (!data)
+         nbytes           = 0;
+      if (nbytes > max_bytes)
+         nbytes           = max_bytes;
+      if (nbytes > size - len - 8)
+         nbytes           = (unsigned)(size - len - 8);
+
+      command_memory_put_le32(reply + len,     ranges[i].address);
+      command_memory_put_le32(reply + len + 4, nbytes);
+      len                += 8;
+
+      if (nbytes)
+         memcpy(reply + len, data, nbytes);
+      len                += nbytes;
+   }
+
+   replier(cmd, (const char*)reply, len);
+   free(reply);
+}
+
+bool command_read_memory_bin(command_t *cmd, const char *arg)
+{
+   command_memory_range_t ranges[COMMAND_MEMORY_RANGES_MAX];
+   unsigned count = command_memory_parse_ranges(arg, ranges);
+
+   if (count == 0)
+      return false;
+
+   command_memory_reply_ranges(cmd, cmd->replier,
+         "READ_CORE_MEMORY_BIN", ranges, count);
+   return true;
+}
+
+bool command_subscribe_memory(command_t *cmd, const char *arg)
+{
+   char reply[64];
+   char *end                   = NULL;
+   struct rarch_state *p_rarch = &rarch_st;
+   unsigned interval           = (unsigned)strtoul(arg, &end, 10);
+
+   if (!cmd->push)
+   {
+      strlcpy(reply, "SUBSCRIBE_CORE_MEMORY -1\n", sizeof(reply));
+      cmd->replier(cmd, reply, strlen(reply));
+      return false;
+   }
+
+   /* An interval of 0 (or no ranges) ends the subscription */
+   cmd->subscribe_count      = 0;
+   if (interval > 0 && end != arg)
+      cmd->subscribe_count   = command_memory_parse_ranges(end,
+            cmd->subscribe_ranges);
+   cmd->subscribe_interval   = interval;
+   cmd->subscribe_last_frame = p_rarch->video_driver_frame_count;
+
+   if (cmd->subscribe)
+      cmd->subscribe(cmd);
+
+   snprintf(reply, sizeof(reply), "SUBSCRIBE_CORE_MEMORY %u\n",
+         cmd->subscribe_count);
+   cmd->replier(cmd, reply, strlen(reply));
+   return true;
+}
+
+static void command_push_memory(command_t *cmd, uint64_t frame)
+{
+   if (     cmd->subscribe_count == 0
+         || frame - cmd->subscribe_last_frame < cmd->subscribe_interval)
+      return;
+
+   cmd->subscribe_last_frame = frame;
+   command_memory_reply_ranges(cmd, cmd->push, "CORE_MEMORY_UPDATE",
+         cmd->subscribe_ranges, cmd->subscribe_count);
+}
 #endif
 
-static bool retroarch_apply_shader(
+static bool retroarch_apply_shader_now(
+      struct rarch_state *p_rarch,
+      settings_t *settings,
+      enum rarch_shader_type type,
+      const char *preset_path, bool message);
+
+#if defined(HAVE_SLANG) && defined(HAVE_THREADS)
+typedef struct shader_compile_state
+{
+   struct video_shader *shader;
+   enum rarch_shader_type type;
+   unsigned generation;
+   unsigned pass;
+   bool message;
+   char path[PATH_MAX_LENGTH];
+} shader_compile_state_t;
+
+static void shader_compile_state_free(shader_compile_state_t *state)
+{
+   if (!state)
+      return;
+   if (state->shader)
+      free(state->shader);
+   free(state);
+}
+
+/* Runs on a task worker: compiles one pass per step so the
+ * task can be cancelled between passes. No GPU objects are
+ * touched, the results only land in the SPIR-V cache. */
+static void task_shader_compile_handler(retro_task_t *task)
+{
+   shader_compile_state_t *state = (shader_compile_state_t*)task->state;
+
+   if (task_get_cancelled(task))
+   {
+      task_set_finished(task, true);
+      return;
+   }
+
+   if (!state->shader)
+   {
+      state->shader = (struct video_shader*)
+         calloc(1, sizeof(*state->shader));
+      if (!state->shader || !video_shader_load_preset_into_shader(
+               state->path, state->shader))
+      {
+         task_set_error(task, strdup("Failed to load shader preset"));
+         task_set_finished(task, true);
+         return;
+      }
+
+      /* Nothing to compile with an up to date bundle */
+      if (slang_bundle_check(state->path, state->shader))
+         state->pass = state->shader->passes;
+   }
+
+   if (state->pass < state->shader->passes)
+   {
+      glslang_precompile_shader(
+            state->shader->pass[state->pass].source.path);
+      state->pass++;
+      task_set_progress(task,
+            (int8_t)((state->pass * 100) / state->shader->passes));
+      return;
+   }
+
+   task_set_finished(task, true);
+}
+
+/* Runs on the main thread once compilation is done; the driver
+ * then builds the new chain from cached SPIR-V and swaps it in. */
+static void task_shader_compile_cb(retro_task_t *task,
+      void *task_data, void *user_data, const char *error)
+{
+   struct rarch_state    *p_rarch = &rarch_st;
+   shader_compile_state_t *state  = (shader_compile_state_t*)task->state;
+
+   if (state && !task_get_cancelled(task)
+         && state->generation == p_rarch->shader_compile_generation)
+      retroarch_apply_shader_now(p_rarch,
+            p_rarch->configuration_settings,
+            state->type, state->path, state->message);
+
+   shader_compile_state_free(state);
+   task->state = NULL;
+}
+
+/* Finder that cancels every pending compile; the queue's
+ * running lock is held while this runs. */
+static bool task_shader_compile_cancel(retro_task_t *task, void *user_data)
+{
+   if (task && task->handler == task_shader_compile_handler)
+      task->cancelled = true;
+   return false;
+}
+
+/* Compiles a slang preset in the background while the current
+ * chain keeps rendering. Returns false if the caller should
+ * apply the preset synchronously instead. */
+static bool retroarch_apply_shader_async(
+      struct rarch_state *p_rarch,
+      enum rarch_shader_type type,
+      const char *preset_path, bool message)
+{
+   task_finder_data_t find_data;
+   retro_task_t          *task   = NULL;
+   shader_compile_state_t *state = NULL;
+
+   if (type != RARCH_SHADER_SLANG || string_is_empty(preset_path)
+         || !task_queue_is_threaded())
+      return false;
+
+   /* Only the latest request matters */
+   find_data.func     = task_shader_compile_cancel;
+   find_data.userdata = NULL;
+   task_queue_find(&find_data);
+
+   if (!(task = task_init()))
+      return false;
+   if (!(state = (shader_compile_state_t*)calloc(1, sizeof(*state))))
+   {
+      free(task);
+      return false;
+   }
+
+   state->type       = type;
+   state->message    = message;
+   state->generation = ++p_rarch->shader_compile_generation;
+   strlcpy(state->path, preset_path, sizeof(state->path));
+
+   task->handler     = task_shader_compile_handler;
+   task->callback    = task_shader_compile_cb;
+   task->state       = state;
+   task->mute        = true;
+   task->priority    = TASK_PRIORITY_HIGH;
+
+   task_queue_push(task);
+   return true;
+}
+#endif
+
+static enum shader_apply_result retroarch_apply_shader(
+      struct rarch_state *p_rarch,
+      settings_t *settings,
+      enum rarch_shader_type type,
+      const char *preset_path, bool message)
+{
+#if defined(HAVE_SLANG) && defined(HAVE_THREADS)
+   /* Disallow loading shaders when no core is loaded */
+   if (string_is_empty(runloop_state.system.info.library_name))
+      return SHADER_APPLY_FAILED;
+
+   if (retroarch_apply_shader_async(p_rarch, type, preset_path, message))
+      return SHADER_APPLY_PENDING;
+
+   /* Anything applied synchronously supersedes pending compiles */
+   p_rarch->shader_compile_generation++;
+#endif
+   if (!retroarch_apply_shader_now(p_rarch, settings,
+         type, preset_path, message))
+      return SHADER_APPLY_FAILED;
+   return SHADER_APPLY_DONE;
+}
+
+static bool retroarch_apply_shader_now(
       struct rarch_state *p_rarch,
       settings_t *settings,
       enum rarch_shader_type type,
@@ -10783,8 +11501,14 @@ static bool retroarch_apply_shader(
     * We need to reconfigure this at some point to only load it once */
    if (p_rarch->current_video->set_shader)
    {
-      if ((p_rarch->current_video->set_shader(
-                  p_rarch->video_driver_data, type, preset_path)))
+      bool shader_set;
+
+      perf_boot_begin(PERF_BOOT_SHADERS);
+      shader_set = p_rarch->current_video->set_shader(
+            p_rarch->video_driver_data, type, preset_path);
+      perf_boot_end(PERF_BOOT_SHADERS);
+
+      if (shader_set)
       {
          configuration_set_bool(settings, settings->bools.video_shader_enable, true);
          if (!string_is_empty(preset_path))
@@ -10845,6 +11569,7 @@ static bool retroarch_apply_shader(
          ' ',
          sizeof(msg));
 
+   RARCH_ERR("%s\n", msg);
    runloop_msg_queue_push(
          msg, 1, 180, true, NULL,
          MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_ERROR);
@@ -10878,7 +11603,10 @@ bool command_set_shader(command_t *cmd, const char *arg)
       }
    }
 
-   return retroarch_apply_shader(p_rarch, settings, type, arg, true);
+   /* A preset still being compiled counts as accepted, whether
+    * it ends up applied is reported by task_shader_compile_cb() */
+   return retroarch_apply_shader(p_rarch, settings,
+         type, arg, true) != SHADER_APPLY_FAILED;
 }
 #endif
 
@@ -10978,60 +11706,260 @@ static void call_auto_translate_task(
    }
 }
 
-static void handle_translation_cb(
-      retro_task_t *task, void *task_data,
-      void *user_data, const char *error)
+/* What the AI service sent back. The body is parsed and
+ * any image in it decoded by task_ai_service_response_handler(),
+ * so task_ai_service_response_cb() only has to hand the
+ * results over to the video driver, mixer and narrator. */
+typedef struct
+{
+   char *body;
+   uint8_t *frame;
+   void *sound;
+   char *text;
+   char *error;
+   char *auto_mode;
+   char *keys;
+   const char *message;
+#ifdef HAVE_GFX_WIDGETS
+   struct texture_image overlay;
+#endif
+   size_t body_len;
+   size_t frame_pitch;
+   unsigned frame_width;
+   unsigned frame_height;
+   unsigned image_width;
+   unsigned image_height;
+   int sound_size;
+   enum retro_pixel_format pix_fmt;
+   bool frame_hw;
+   bool use_overlay;
+   bool supports_rgba;
+   bool has_image;
+   bool has_overlay;
+   bool no_text;
+} ai_service_response_t;
+
+/* Decodes the image the AI service sent back into what
+ * the main thread shows: a texture for the widget overlay,
+ * or otherwise a frame in the core's pixel format. */
+static void ai_service_decode_image(ai_service_response_t *response,
+      char *file, int file_size)
 {
    size_t pitch;
-   unsigned width, height;
+   struct scaler_ctx *scaler         = NULL;
    unsigned image_width, image_height;
-   uint8_t* raw_output_data          = NULL;
-   char* raw_image_file_data         = NULL;
-   struct scaler_ctx* scaler         = NULL;
-   http_transfer_data_t *data        = (http_transfer_data_t*)task_data;
-   int new_image_size                = 0;
-#ifdef HAVE_AUDIOMIXER
-   int new_sound_size                = 0;
-#endif
-   const void* dummy_data            = NULL;
-   void* raw_image_data              = NULL;
-   void* raw_image_data_alpha        = NULL;
-   void* raw_sound_data              = NULL;
    int retval                        = 0;
-   rjson_t* json                     = NULL;
-   int json_current_key              = 0;
-   char* err_string                  = NULL;
-   char* text_string                 = NULL;
-   char* auto_string                 = NULL;
-   char* key_string                  = NULL;
-   struct rarch_state *p_rarch       = &rarch_st;
-   settings_t* settings              = p_rarch->configuration_settings;
-   bool was_paused                   = runloop_state.paused;
-   const enum retro_pixel_format
-      video_driver_pix_fmt           = p_rarch->video_driver_pix_fmt;
-#ifdef HAVE_ACCESSIBILITY
-   bool accessibility_enable         = settings->bools.accessibility_enable;
-   unsigned accessibility_narrator_speech_speed = settings->uints.accessibility_narrator_speech_speed;
-#endif
+   void *raw_image_data              = NULL;
+   void *raw_image_data_alpha        = NULL;
+   uint8_t *raw_output_data          = NULL;
+   unsigned width                    = response->frame_width;
+   unsigned height                   = response->frame_height;
+   enum image_type_enum image_type   = IMAGE_TYPE_NONE;
+
+   if (file_size >= 4 && file[0] == 'B' && file[1] == 'M')
+      image_type = IMAGE_TYPE_BMP;
+   else if (file_size >= 4 && file[1] == 'P' && file[2] == 'N' &&
+         file[3] == 'G')
+      image_type = IMAGE_TYPE_PNG;
+
+   /* try two different modes for text display *
+    * In the first mode, we use display widget overlays, but they require
+    * the video poke interface to be able to load image buffers.
+    *
+    * The other method is to draw to the video buffer directly, which needs
+    * a software core to be running. */
 #ifdef HAVE_GFX_WIDGETS
-   bool gfx_widgets_paused           = p_rarch->gfx_widgets_paused;
+   if (response->use_overlay)
+   {
+      if (image_type == IMAGE_TYPE_NONE)
+      {
+         response->message = "Invalid image type returned from server.";
+         return;
+      }
 
-   /* When auto mode is on, we turn off the overlay
-    * once we have the result for the next call.*/
-   if (p_rarch->dispwidget_st.ai_service_overlay_state != 0
-       && p_rarch->ai_service_auto == 2)
-      gfx_widgets_ai_service_overlay_unload(&p_rarch->dispwidget_st);
+      response->overlay.supports_rgba = response->supports_rgba;
+      response->has_overlay           = image_texture_load_buffer(
+            &response->overlay, image_type, file, file_size);
+      return;
+   }
 #endif
 
-#ifdef DEBUG
-   if (p_rarch->ai_service_auto != 2)
-      RARCH_LOG("RESULT FROM AI SERVICE...\n");
-#endif
+   if (image_type == IMAGE_TYPE_BMP)
+   {
+      /* This is a BMP file coming back. */
+      /* Get image data (24 bit), and convert to the emulated pixel format */
+      if (file_size < 54)
+      {
+         response->message = "Output from URL not a valid file type, or is not supported.";
+         return;
+      }
 
-   if (!data || error || !data->data)
-      goto finish;
+      image_width    =
+         ((uint32_t) ((uint8_t)file[21]) << 24) +
+         ((uint32_t) ((uint8_t)file[20]) << 16) +
+         ((uint32_t) ((uint8_t)file[19]) << 8) +
+         ((uint32_t) ((uint8_t)file[18]) << 0);
+
+      image_height   =
+         ((uint32_t) ((uint8_t)file[25]) << 24) +
+         ((uint32_t) ((uint8_t)file[24]) << 16) +
+         ((uint32_t) ((uint8_t)file[23]) << 8) +
+         ((uint32_t) ((uint8_t)file[22]) << 0);
+
+      if ((uint64_t)image_width * image_height * 3 + 54 > (uint64_t)file_size)
+      {
+         response->message = "Output from URL not a valid file type, or is not supported.";
+         return;
+      }
+
+      raw_image_data = (void*)malloc(image_width*image_height*3*sizeof(uint8_t));
+      if (!raw_image_data)
+      {
+         response->message = "Can't allocate memory.";
+         return;
+      }
+      memcpy(raw_image_data,
+             file+54*sizeof(uint8_t),
+             image_width*image_height*3*sizeof(uint8_t));
+   }
+   else if (image_type == IMAGE_TYPE_PNG)
+   {
+      unsigned ui;
+      int d, tw, th, tc;
+      rpng_t *rpng = rpng_alloc();
+
+      if (!rpng)
+      {
+         response->message = "Can't allocate memory.";
+         return;
+      }
+
+      /* PNG coming back from the url */
+      rpng_set_buf_ptr(rpng, file, (size_t)file_size);
+      rpng_start(rpng);
+      while (rpng_iterate_image(rpng));
+
+      do
+      {
+         retval = rpng_process_image(rpng, &raw_image_data_alpha,
+               (size_t)file_size, &image_width, &image_height);
+      } while (retval == IMAGE_PROCESS_NEXT);
+
+      rpng_free(rpng);
+
+      if (!raw_image_data_alpha)
+      {
+         response->message = "Output from URL not a valid file type, or is not supported.";
+         return;
+      }
+
+      /* Returned output from the png processor is an upside down RGBA
+       * image, so we have to change that to RGB first.  This should
+       * probably be replaced with a scaler call.*/
+      d              = 0;
+      raw_image_data = (void*)malloc(image_width*image_height*3*sizeof(uint8_t));
+      if (!raw_image_data)
+      {
+         free(raw_image_data_alpha);
+         response->message = "Can't allocate memory.";
+         return;
+      }
+      for (ui = 0; ui < image_width * image_height * 4; ui++)
+      {
+         if (ui % 4 != 3)
+         {
+            tc = d%3;
+            th = image_height-d / (3*image_width)-1;
+            tw = (d%(image_width*3)) / 3;
+            ((uint8_t*) raw_image_data)[tw*3+th*3*image_width+tc] = ((uint8_t *)raw_image_data_alpha)[ui];
+            d+=1;
+         }
+      }
+      free(raw_image_data_alpha);
+   }
+   else
+   {
+      response->message = "Output from URL not a valid file type, or is not supported.";
+      return;
+   }
+
+   if (response->frame_hw)
+   {
+      /*
+         In this case, we used the viewport to grab the image
+         and translate it, and we have the translated image in
+         the raw_image_data buffer.
+      */
+      response->message = "Hardware frame buffer core, but selected video driver isn't supported.";
+      free(raw_image_data);
+      return;
+   }
+
+   scaler = (struct scaler_ctx*)calloc(1, sizeof(struct scaler_ctx));
+   if (!scaler)
+   {
+      free(raw_image_data);
+      return;
+   }
+
+   /* The assigned pitch may not be reliable.  The width of
+      the video frame can change during run-time, but the
+      pitch may not, so we just assign it as the width
+      times the byte depth.
+   */
+
+   if (response->pix_fmt == RETRO_PIXEL_FORMAT_XRGB8888)
+   {
+      raw_output_data    = (uint8_t*)malloc(width * height * 4 * sizeof(uint8_t));
+      scaler->out_fmt    = SCALER_FMT_ARGB8888;
+      pitch              = width * 4;
+      scaler->out_stride = width * 4;
+   }
+   else
+   {
+      raw_output_data    = (uint8_t*)malloc(width * height * 2 * sizeof(uint8_t));
+      scaler->out_fmt    = SCALER_FMT_RGB565;
+      pitch              = width * 2;
+      scaler->out_stride = width * 1;
+   }
+
+   if (!raw_output_data)
+   {
+      free(raw_image_data);
+      free(scaler);
+      return;
+   }
+
+   scaler->in_fmt        = SCALER_FMT_BGR24;
+   scaler->in_width      = image_width;
+   scaler->in_height     = image_height;
+   scaler->out_width     = width;
+   scaler->out_height    = height;
+   scaler->scaler_type   = SCALER_TYPE_POINT;
+   scaler_ctx_gen_filter(scaler);
+   scaler->in_stride     = -1 * width * 3;
+
+   scaler_ctx_scale_direct(scaler, raw_output_data,
+         (uint8_t*)raw_image_data + (image_height - 1) * width * 3);
+   scaler_ctx_gen_reset(scaler);
+   free(scaler);
+   free(raw_image_data);
+
+   response->frame        = raw_output_data;
+   response->frame_pitch  = pitch;
+   response->image_width  = image_width;
+   response->image_height = image_height;
+}
+
+static void task_ai_service_response_handler(retro_task_t *task)
+{
+   ai_service_response_t *response = (ai_service_response_t*)task->state;
+   char *image_file                = NULL;
+   int image_file_size             = 0;
+   int json_current_key            = 0;
+   rjson_t *json                   = rjson_open_buffer(
+         response->body, response->body_len);
 
-   json = rjson_open_buffer(data->data, data->len);
    if (!json)
       goto finish;
 
@@ -11071,46 +11999,76 @@ static void handle_translation_cb(
          switch (json_current_key)
          {
             case 0: /* image */
-               raw_image_file_data = (char*)unbase64(str,
-                    (int)str_len, &new_image_size);
+               image_file = (char*)unbase64(str,
+                    (int)str_len, &image_file_size);
                break;
 #ifdef HAVE_AUDIOMIXER
             case 1: /* sound */
-               raw_sound_data = (void*)unbase64(str,
-                    (int)str_len, &new_sound_size);
+               response->sound     = (void*)unbase64(str,
+                    (int)str_len, &response->sound_size);
                break;
 #endif
             case 2: /* text */
-               text_string = strdup(str);
+               response->text      = strdup(str);
                break;
             case 3: /* error */
-               err_string  = strdup(str);
+               response->error     = strdup(str);
                break;
             case 4: /* auto */
-               auto_string = strdup(str);
+               response->auto_mode = strdup(str);
                break;
             case 5: /* press */
-               key_string  = strdup(str);
+               response->keys      = strdup(str);
                break;
          }
          json_current_key = -1;
       }
    }
 
-   if (string_is_equal(err_string, "No text found."))
+   if (string_is_equal(response->error, "No text found."))
+   {
+      if (response->text)
+         free(response->text);
+      response->text    = strdup(response->error);
+      response->no_text = true;
+   }
+
+   if (image_file)
+   {
+      response->has_image = true;
+      ai_service_decode_image(response, image_file, image_file_size);
+   }
+
+finish:
+   if (json)
+      rjson_free(json);
+   if (image_file)
+      free(image_file);
+
+   task_set_finished(task, true);
+}
+
+static void task_ai_service_response_cb(
+      retro_task_t *task, void *task_data,
+      void *user_data, const char *err)
+{
+   ai_service_response_t *response   = (ai_service_response_t*)task->state;
+   struct rarch_state *p_rarch       = &rarch_st;
+   settings_t* settings              = p_rarch->configuration_settings;
+   bool was_paused                   = runloop_state.paused;
+#ifdef HAVE_ACCESSIBILITY
+   bool accessibility_enable         = settings->bools.accessibility_enable;
+   unsigned accessibility_narrator_speech_speed = settings->uints.accessibility_narrator_speech_speed;
+#endif
+#ifdef HAVE_GFX_WIDGETS
+   bool gfx_widgets_paused           = p_rarch->gfx_widgets_paused;
+#endif
+
+   if (response->no_text)
    {
 #ifdef DEBUG
       RARCH_LOG("No text found...\n");
 #endif
-      if (text_string)
-      {
-         free(text_string);
-         text_string = NULL;
-      }
-
-      text_string = (char*)malloc(15);
-
-      strlcpy(text_string, err_string, 15);
 #ifdef HAVE_GFX_WIDGETS
       if (gfx_widgets_paused)
       {
@@ -11121,214 +12079,56 @@ static void handle_translation_cb(
 #endif
    }
 
-   if (     !raw_image_file_data
-         && !raw_sound_data
-         && !text_string
+   if (     !response->has_image
+         && !response->sound
+         && !response->text
          && (p_rarch->ai_service_auto != 2)
-         && !key_string)
+         && !response->keys)
    {
-      error = "Invalid JSON body.";
+      RARCH_ERR("%s: %s\n", msg_hash_to_str(MSG_DOWNLOAD_FAILED),
+            "Invalid JSON body.");
       goto finish;
    }
 
-   if (raw_image_file_data)
+   if (response->message)
    {
-      /* Get the video frame dimensions reference */
-      video_driver_cached_frame_get(&dummy_data, &width, &height, &pitch);
+      RARCH_LOG("%s\n", response->message);
+      goto finish;
+   }
 
-      /* try two different modes for text display *
-       * In the first mode, we use display widget overlays, but they require
-       * the video poke interface to be able to load image buffers.
-       *
-       * The other method is to draw to the video buffer directly, which needs
-       * a software core to be running. */
 #ifdef HAVE_GFX_WIDGETS
-      if (p_rarch->video_driver_poke
-          && p_rarch->video_driver_poke->load_texture
-          && p_rarch->video_driver_poke->unload_texture)
-      {
-         bool ai_res;
-         enum image_type_enum image_type;
-         /* Write to overlay */
-         if (  raw_image_file_data[0] == 'B' &&
-               raw_image_file_data[1] == 'M')
-             image_type = IMAGE_TYPE_BMP;
-         else if (raw_image_file_data[1] == 'P' &&
-                  raw_image_file_data[2] == 'N' &&
-                  raw_image_file_data[3] == 'G')
-            image_type = IMAGE_TYPE_PNG;
-         else
-         {
-            RARCH_LOG("Invalid image type returned from server.\n");
-            goto finish;
-         }
-
-         ai_res = gfx_widgets_ai_service_overlay_load(
-               &p_rarch->dispwidget_st,
-               raw_image_file_data, (unsigned)new_image_size,
-               image_type);
-
-         if (!ai_res)
-         {
-            RARCH_LOG("Video driver not supported for AI Service.");
-            runloop_msg_queue_push(
-               /* msg_hash_to_str(MSG_VIDEO_DRIVER_NOT_SUPPORTED), */
-               "Video driver not supported.",
-               1, 180, true,
-               NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-         }
-         else if (gfx_widgets_paused)
-         {
-            /* In this case we have to unpause and then repause for a frame */
-#ifdef HAVE_TRANSLATE
-            /* Unpausing state */
-            p_rarch->dispwidget_st.ai_service_overlay_state = 2;
-#endif
-            command_event(CMD_EVENT_UNPAUSE, NULL);
-         }
+   if (response->has_image && response->use_overlay)
+   {
+      /* Write to overlay */
+      if (     !response->has_overlay
+            || !gfx_widgets_ai_service_overlay_load(
+               &p_rarch->dispwidget_st, &response->overlay))
+      {
+         RARCH_LOG("Video driver not supported for AI Service.");
+         runloop_msg_queue_push(
+            /* msg_hash_to_str(MSG_VIDEO_DRIVER_NOT_SUPPORTED), */
+            "Video driver not supported.",
+            1, 180, true,
+            NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
       }
-      else
-#endif
-      /* Can't use display widget overlays, so try writing to video buffer */
-      {
-         /* Write to video buffer directly (software cores only) */
-         if (raw_image_file_data[0] == 'B' && raw_image_file_data[1] == 'M')
-         {
-            /* This is a BMP file coming back. */
-            /* Get image data (24 bit), and convert to the emulated pixel format */
-            image_width    =
-               ((uint32_t) ((uint8_t)raw_image_file_data[21]) << 24) +
-               ((uint32_t) ((uint8_t)raw_image_file_data[20]) << 16) +
-               ((uint32_t) ((uint8_t)raw_image_file_data[19]) << 8) +
-               ((uint32_t) ((uint8_t)raw_image_file_data[18]) << 0);
-
-            image_height   =
-               ((uint32_t) ((uint8_t)raw_image_file_data[25]) << 24) +
-               ((uint32_t) ((uint8_t)raw_image_file_data[24]) << 16) +
-               ((uint32_t) ((uint8_t)raw_image_file_data[23]) << 8) +
-               ((uint32_t) ((uint8_t)raw_image_file_data[22]) << 0);
-            raw_image_data = (void*)malloc(image_width*image_height*3*sizeof(uint8_t));
-            memcpy(raw_image_data,
-                   raw_image_file_data+54*sizeof(uint8_t),
-                   image_width*image_height*3*sizeof(uint8_t));
-         }
-         else if (raw_image_file_data[1] == 'P' && raw_image_file_data[2] == 'N' &&
-                  raw_image_file_data[3] == 'G')
-         {
-            rpng_t *rpng = NULL;
-            /* PNG coming back from the url */
-            image_width  =
-                ((uint32_t) ((uint8_t)raw_image_file_data[16]) << 24)+
-                ((uint32_t) ((uint8_t)raw_image_file_data[17]) << 16)+
-                ((uint32_t) ((uint8_t)raw_image_file_data[18]) << 8)+
-                ((uint32_t) ((uint8_t)raw_image_file_data[19]) << 0);
-            image_height =
-                ((uint32_t) ((uint8_t)raw_image_file_data[20]) << 24)+
-                ((uint32_t) ((uint8_t)raw_image_file_data[21]) << 16)+
-                ((uint32_t) ((uint8_t)raw_image_file_data[22]) << 8)+
-                ((uint32_t) ((uint8_t)raw_image_file_data[23]) << 0);
-            rpng = rpng_alloc();
-
-            if (!rpng)
-            {
-               error = "Can't allocate memory.";
-               goto finish;
-            }
-
-            rpng_set_buf_ptr(rpng, raw_image_file_data, (size_t)new_image_size);
-            rpng_start(rpng);
-            while (rpng_iterate_image(rpng));
-
-            do
-            {
-               retval = rpng_process_image(rpng, &raw_image_data_alpha,
-                     (size_t)new_image_size, &image_width, &image_height);
-            } while (retval == IMAGE_PROCESS_NEXT);
-
-            /* Returned output from the png processor is an upside down RGBA
-             * image, so we have to change that to RGB first.  This should
-             * probably be replaced with a scaler call.*/
-            {
-               unsigned ui;
-               int d,tw,th,tc;
-               d=0;
-               raw_image_data = (void*)malloc(image_width*image_height*3*sizeof(uint8_t));
-               for (ui = 0; ui < image_width * image_height * 4; ui++)
-               {
-                  if (ui % 4 != 3)
-                  {
-                     tc = d%3;
-                     th = image_height-d / (3*image_width)-1;
-                     tw = (d%(image_width*3)) / 3;
-                     ((uint8_t*) raw_image_data)[tw*3+th*3*image_width+tc] = ((uint8_t *)raw_image_data_alpha)[ui];
-                     d+=1;
-                  }
-               }
-            }
-            rpng_free(rpng);
-         }
-         else
-         {
-            RARCH_LOG("Output from URL not a valid file type, or is not supported.\n");
-            goto finish;
-         }
-
-         scaler = (struct scaler_ctx*)calloc(1, sizeof(struct scaler_ctx));
-         if (!scaler)
-            goto finish;
-
-         if (dummy_data == RETRO_HW_FRAME_BUFFER_VALID)
-         {
-            /*
-               In this case, we used the viewport to grab the image
-               and translate it, and we have the translated image in
-               the raw_image_data buffer.
-            */
-            RARCH_LOG("Hardware frame buffer core, but selected video driver isn't supported.\n");
-            goto finish;
-         }
-
-         /* The assigned pitch may not be reliable.  The width of
-            the video frame can change during run-time, but the
-            pitch may not, so we just assign it as the width
-            times the byte depth.
-         */
-
-         if (video_driver_pix_fmt == RETRO_PIXEL_FORMAT_XRGB8888)
-         {
-            raw_output_data    = (uint8_t*)malloc(width * height * 4 * sizeof(uint8_t));
-            scaler->out_fmt    = SCALER_FMT_ARGB8888;
-            pitch              = width * 4;
-            scaler->out_stride = width * 4;
-         }
-         else
-         {
-            raw_output_data    = (uint8_t*)malloc(width * height * 2 * sizeof(uint8_t));
-            scaler->out_fmt    = SCALER_FMT_RGB565;
-            pitch              = width * 2;
-            scaler->out_stride = width * 1;
-         }
-
-         if (!raw_output_data)
-            goto finish;
-
-         scaler->in_fmt        = SCALER_FMT_BGR24;
-         scaler->in_width      = image_width;
-         scaler->in_height     = image_height;
-         scaler->out_width     = width;
-         scaler->out_height    = height;
-         scaler->scaler_type   = SCALER_TYPE_POINT;
-         scaler_ctx_gen_filter(scaler);
-         scaler->in_stride     = -1 * width * 3;
-
-         scaler_ctx_scale_direct(scaler, raw_output_data,
-               (uint8_t*)raw_image_data + (image_height - 1) * width * 3);
-         video_driver_frame(raw_output_data, image_width, image_height, pitch);
+      else if (gfx_widgets_paused)
+      {
+         /* In this case we have to unpause and then repause for a frame */
+         /* Unpausing state */
+         p_rarch->dispwidget_st.ai_service_overlay_state = 2;
+         command_event(CMD_EVENT_UNPAUSE, NULL);
       }
    }
+#endif
+
+   /* Write to video buffer directly (software cores only) */
+   if (response->frame)
+      video_driver_frame(response->frame,
+            response->image_width, response->image_height,
+            response->frame_pitch);
 
 #ifdef HAVE_AUDIOMIXER
-   if (raw_sound_data)
+   if (response->sound)
    {
       audio_mixer_stream_params_t params;
 
@@ -11338,28 +12138,23 @@ static void handle_translation_cb(
       params.stream_type          = AUDIO_STREAM_TYPE_SYSTEM; /* user->stream_type; */
       params.type                 = AUDIO_MIXER_TYPE_WAV;
       params.state                = AUDIO_STREAM_STATE_PLAYING;
-      params.buf                  = raw_sound_data;
-      params.bufsize              = new_sound_size;
+      params.buf                  = response->sound;
+      params.bufsize              = response->sound_size;
       params.cb                   = NULL;
       params.basename             = NULL;
 
       audio_driver_mixer_add_stream(&params);
-
-      if (raw_sound_data)
-      {
-         free(raw_sound_data);
-         raw_sound_data = NULL;
-      }
    }
 #endif
 
-   if (key_string)
+   if (response->keys)
    {
       char key[8];
-      size_t length = strlen(key_string);
-      int i         = 0;
-      int start     = 0;
-      char t        = ' ';
+      const char *key_string = response->keys;
+      size_t length          = strlen(key_string);
+      int i                  = 0;
+      int start              = 0;
+      char t                 = ' ';
 
       for (i = 1; i < (int)length; i++)
       {
@@ -11429,49 +12224,111 @@ static void handle_translation_cb(
    }
 
 #ifdef HAVE_ACCESSIBILITY
-   if (text_string && is_accessibility_enabled(
+   if (response->text && is_accessibility_enabled(
             accessibility_enable,
             p_rarch->accessibility_enabled))
       accessibility_speak_priority(p_rarch,
             accessibility_enable,
             accessibility_narrator_speech_speed,
-            text_string, 10);
+            response->text, 10);
 #endif
 
 finish:
-   if (error)
-      RARCH_ERR("%s: %s\n", msg_hash_to_str(MSG_DOWNLOAD_FAILED), error);
-
-   if (user_data)
-      free(user_data);
-
-   if (json)
-      rjson_free(json);
-   if (raw_image_file_data)
-      free(raw_image_file_data);
-   if (raw_image_data_alpha)
-       free(raw_image_data_alpha);
-   if (raw_image_data)
-      free(raw_image_data);
-   if (scaler)
-      free(scaler);
-   if (err_string)
-      free(err_string);
-   if (text_string)
-      free(text_string);
-   if (raw_output_data)
-      free(raw_output_data);
-
-   if (string_is_equal(auto_string, "auto"))
+   if (string_is_equal(response->auto_mode, "auto"))
    {
       if (     (p_rarch->ai_service_auto != 0)
             && !settings->bools.ai_service_pause)
          call_auto_translate_task(p_rarch, settings, &was_paused);
    }
-   if (auto_string)
-      free(auto_string);
-   if (key_string)
-      free(key_string);
+}
+
+static void task_ai_service_response_cleanup(retro_task_t *task)
+{
+   ai_service_response_t *response = (ai_service_response_t*)task->state;
+
+   if (response->body)
+      free(response->body);
+   if (response->frame)
+      free(response->frame);
+   if (response->sound)
+      free(response->sound);
+   if (response->text)
+      free(response->text);
+   if (response->error)
+      free(response->error);
+   if (response->auto_mode)
+      free(response->auto_mode);
+   if (response->keys)
+      free(response->keys);
+#ifdef HAVE_GFX_WIDGETS
+   if (response->has_overlay)
+      image_texture_free(&response->overlay);
+#endif
+   free(response);
+}
+
+static void handle_translation_cb(
+      retro_task_t *task, void *task_data,
+      void *user_data, const char *error)
+{
+   size_t pitch;
+   const void *dummy_data            = NULL;
+   http_transfer_data_t *data        = (http_transfer_data_t*)task_data;
+   ai_service_response_t *response   = NULL;
+   retro_task_t *decode_task         = NULL;
+   struct rarch_state *p_rarch       = &rarch_st;
+
+#ifdef HAVE_GFX_WIDGETS
+   /* When auto mode is on, we turn off the overlay
+    * once we have the result for the next call.*/
+   if (p_rarch->dispwidget_st.ai_service_overlay_state != 0
+       && p_rarch->ai_service_auto == 2)
+      gfx_widgets_ai_service_overlay_unload(&p_rarch->dispwidget_st);
+#endif
+
+#ifdef DEBUG
+   if (p_rarch->ai_service_auto != 2)
+      RARCH_LOG("RESULT FROM AI SERVICE...\n");
+#endif
+
+   if (!data || error || !data->data)
+      goto error;
+
+   if (!(response = (ai_service_response_t*)calloc(1, sizeof(*response))))
+      goto error;
+   if (!(decode_task = task_init()))
+      goto error;
+
+   /* Taken over from the transfer, which would free it */
+   response->body          = data->data;
+   response->body_len      = data->len;
+   data->data              = NULL;
+
+   /* Get the video frame dimensions reference */
+   video_driver_cached_frame_get(&dummy_data,
+         &response->frame_width, &response->frame_height, &pitch);
+   response->frame_hw      = dummy_data == RETRO_HW_FRAME_BUFFER_VALID;
+   response->pix_fmt       = p_rarch->video_driver_pix_fmt;
+#ifdef HAVE_GFX_WIDGETS
+   response->use_overlay   = p_rarch->video_driver_poke
+      && p_rarch->video_driver_poke->load_texture
+      && p_rarch->video_driver_poke->unload_texture;
+   response->supports_rgba = video_driver_supports_rgba();
+#endif
+
+   decode_task->state      = response;
+   decode_task->handler    = task_ai_service_response_handler;
+   decode_task->callback   = task_ai_service_response_cb;
+   decode_task->cleanup    = task_ai_service_response_cleanup;
+   decode_task->mute       = true;
+   task_queue_push(decode_task);
+   return;
+
+error:
+   if (error)
+      RARCH_ERR("%s: %s\n", msg_hash_to_str(MSG_DOWNLOAD_FAILED), error);
+   if (response)
+      free(response);
 }
 
 static const char *ai_service_get_str(enum translation_lang id)
@@ -11615,6 +12472,330 @@ static const char *ai_service_get_str(enum translation_lang id)
 }
 
 
+/* A frame on its way to the AI service. run_translation_service()
+ * only copies the frame out and gathers what the request needs
+ * from the frontend; converting, scaling and encoding it and
+ * forming the request body is left to
+ * task_ai_service_request_handler(). */
+typedef struct
+{
+   uint8_t *frame;
+   char *system_label;
+   char *json;
+   size_t frame_pitch;
+   unsigned frame_width;
+   unsigned frame_height;
+   unsigned width;
+   unsigned height;
+   enum scaler_pix_fmt frame_fmt;
+   uint8_t signature[
+      AI_SERVICE_SIGNATURE_SIZE * AI_SERVICE_SIGNATURE_SIZE];
+   uint8_t prev_signature[
+      AI_SERVICE_SIGNATURE_SIZE * AI_SERVICE_SIGNATURE_SIZE];
+   bool gamepad_state[16];
+   char url[PATH_MAX_LENGTH];
+   bool paused;
+   bool skip_unchanged;
+   bool unchanged;
+} ai_service_request_t;
+
+/* Averages the luma of a 24-bit image over an
+ * AI_SERVICE_SIGNATURE_SIZE square grid */
+static void ai_service_get_signature(uint8_t *signature,
+      const uint8_t *image, unsigned width, unsigned height)
+{
+   unsigned x, y, i;
+   uint32_t sums[AI_SERVICE_SIGNATURE_SIZE * AI_SERVICE_SIGNATURE_SIZE];
+   uint32_t counts[AI_SERVICE_SIGNATURE_SIZE * AI_SERVICE_SIGNATURE_SIZE];
+
+   memset(sums,   0, sizeof(sums));
+   memset(counts, 0, sizeof(counts));
+
+   for (y = 0; y < height; y++)
+   {
+      const uint8_t *row = image + (size_t)y * width * 3;
+      uint32_t *cells    = sums + (y * AI_SERVICE_SIGNATURE_SIZE / height)
+         * AI_SERVICE_SIGNATURE_SIZE;
+      uint32_t *count    = counts + (cells - sums);
+
+      for (x = 0; x < width; x++, row += 3)
+      {
+         unsigned cell = x * AI_SERVICE_SIGNATURE_SIZE / width;
+         cells[cell]  += (row[0] * 29 + row[1] * 150 + row[2] * 77) >> 8;
+         count[cell]++;
+      }
+   }
+
+   for (i = 0; i < ARRAY_SIZE(sums); i++)
+      signature[i] = counts[i] ? (uint8_t)(sums[i] / counts[i]) : 0;
+}
+
+static bool ai_service_signature_changed(
+      const uint8_t *a, const uint8_t *b)
+{
+   unsigned i;
+
+   for (i = 0; i < AI_SERVICE_SIGNATURE_SIZE * AI_SERVICE_SIGNATURE_SIZE; i++)
+      if (abs((int)a[i] - (int)b[i]) > AI_SERVICE_SIGNATURE_TOLERANCE)
+         return true;
+
+   return false;
+}
+
+static void task_ai_service_request_handler(retro_task_t *task)
+{
+   uint8_t header[54];
+   ai_service_request_t *request         = (ai_service_request_t*)task->state;
+   unsigned width                        = request->width;
+   unsigned height                       = request->height;
+   struct scaler_ctx *scaler             = NULL;
+   uint8_t *bit24_image                  = NULL;
+   uint8_t *bmp_buffer                   = NULL;
+   uint64_t buffer_bytes                 = 0;
+   char *bmp64_buffer                    = NULL;
+   rjsonwriter_t* jsonwriter             = NULL;
+   const char *json_buffer               = NULL;
+   int bmp64_length                      = 0;
+   bool TRANSLATE_USE_BMP                = false;
+
+   if (task_get_cancelled(task))
+      goto finish;
+
+   bit24_image = (uint8_t*)malloc(width * height * 3);
+   if (!bit24_image)
+      goto finish;
+
+   scaler      = (struct scaler_ctx*)calloc(1, sizeof(struct scaler_ctx));
+   if (!scaler)
+      goto finish;
+
+   if (request->frame_fmt == SCALER_FMT_BGR24)
+   {
+      /* Read back from the viewport, which has to come
+       * down to the core's resolution again */
+      scaler->in_fmt      = SCALER_FMT_BGR24;
+      scaler->out_fmt     = SCALER_FMT_BGR24;
+      scaler->scaler_type = SCALER_TYPE_POINT;
+      scaler->in_width    = request->frame_width;
+      scaler->in_height   = request->frame_height;
+      scaler->out_width   = width;
+      scaler->out_height  = height;
+      scaler_ctx_gen_filter(scaler);
+
+      scaler->in_stride   = (int)request->frame_pitch;
+      scaler->out_stride  = width*3;
+      scaler_ctx_scale_direct(scaler, bit24_image, request->frame);
+   }
+   else
+   {
+      /* This is a software core, so just change the pixel format to 24-bit. */
+      scaler->in_fmt      = request->frame_fmt;
+      video_frame_convert_to_bgr24(
+         scaler,
+         (uint8_t *)bit24_image,
+         (const uint8_t*)request->frame
+         + ((int)height - 1) * request->frame_pitch,
+         width, height,
+         -(int)request->frame_pitch);
+   }
+   scaler_ctx_gen_reset(scaler);
+
+   /* Nothing new on the screen since the last request */
+   ai_service_get_signature(request->signature, bit24_image, width, height);
+   if (     request->skip_unchanged
+         && !ai_service_signature_changed(
+            request->signature, request->prev_signature))
+   {
+      request->unchanged = true;
+      goto finish;
+   }
+
+   if (TRANSLATE_USE_BMP)
+   {
+      /*
+        At this point, we should have a screenshot in the buffer,
+        so allocate an array to contain the BMP image along with
+        the BMP header as bytes, and then covert that to a
+        b64 encoded array for transport in JSON.
+      */
+
+      form_bmp_header(header, width, height, false);
+      bmp_buffer  = (uint8_t*)malloc(width * height * 3 + 54);
+      if (!bmp_buffer)
+         goto finish;
+
+      memcpy(bmp_buffer, header, 54 * sizeof(uint8_t));
+      memcpy(bmp_buffer + 54,
+            bit24_image,
+            width * height * 3 * sizeof(uint8_t));
+      buffer_bytes = sizeof(uint8_t) * (width * height * 3 + 54);
+   }
+   else
+   {
+      size_t pitch = width * 3;
+      bmp_buffer   = rpng_save_image_bgr24_string(
+            bit24_image + width * (height-1) * 3,
+            width, height, (signed)-pitch, &buffer_bytes);
+   }
+
+   if (!bmp_buffer)
+      goto finish;
+
+   bmp64_buffer    = base64((void *)bmp_buffer,
+         sizeof(uint8_t) * buffer_bytes,
+         &bmp64_length);
+
+   if (!bmp64_buffer)
+      goto finish;
+
+   jsonwriter = rjsonwriter_open_memory();
+   if (!jsonwriter)
+      goto finish;
+
+   rjsonwriter_add_start_object(jsonwriter);
+   rjsonwriter_add_space(jsonwriter);
+   rjsonwriter_add_string(jsonwriter, "image");
+   rjsonwriter_add_colon(jsonwriter);
+   rjsonwriter_add_space(jsonwriter);
+   rjsonwriter_add_string_len(jsonwriter, bmp64_buffer, bmp64_length);
+
+   /* Form request... */
+   if (request->system_label)
+   {
+      rjsonwriter_add_comma(jsonwriter);
+      rjsonwriter_add_space(jsonwriter);
+      rjsonwriter_add_string(jsonwriter, "label");
+      rjsonwriter_add_colon(jsonwriter);
+      rjsonwriter_add_space(jsonwriter);
+      rjsonwriter_add_string(jsonwriter, request->system_label);
+   }
+
+   rjsonwriter_add_comma(jsonwriter);
+   rjsonwriter_add_space(jsonwriter);
+   rjsonwriter_add_string(jsonwriter, "state");
+   rjsonwriter_add_colon(jsonwriter);
+   rjsonwriter_add_space(jsonwriter);
+   rjsonwriter_add_start_object(jsonwriter);
+   rjsonwriter_add_space(jsonwriter);
+   rjsonwriter_add_string(jsonwriter, "paused");
+   rjsonwriter_add_colon(jsonwriter);
+   rjsonwriter_add_space(jsonwriter);
+   rjsonwriter_add_unsigned(jsonwriter, (request->paused ? 1 : 0));
+   {
+      static const char* state_labels[] = { "b", "y", "select", "start", "up", "down", "left", "right", "a", "x", "l", "r", "l2", "r2", "l3", "r3" };
+      int i;
+      for (i = 0; i < ARRAY_SIZE(state_labels); i++)
+      {
+         rjsonwriter_add_comma(jsonwriter);
+         rjsonwriter_add_space(jsonwriter);
+         rjsonwriter_add_string(jsonwriter, state_labels[i]);
+         rjsonwriter_add_colon(jsonwriter);
+         rjsonwriter_add_space(jsonwriter);
+         rjsonwriter_add_unsigned(jsonwriter,
+               (request->gamepad_state[i] ? 1 : 0));
+      }
+   }
+   rjsonwriter_add_space(jsonwriter);
+   rjsonwriter_add_end_object(jsonwriter);
+   rjsonwriter_add_space(jsonwriter);
+   rjsonwriter_add_end_object(jsonwriter);
+
+   json_buffer = rjsonwriter_get_memory_buffer(jsonwriter, NULL);
+   if (json_buffer)
+      request->json = strdup(json_buffer);
+
+#ifdef DEBUG
+   RARCH_LOG("Request size: %d\n", bmp64_length);
+#endif
+
+finish:
+   if (scaler)
+      free(scaler);
+   if (bit24_image)
+      free(bit24_image);
+   if (bmp_buffer)
+      free(bmp_buffer);
+   if (bmp64_buffer)
+      free(bmp64_buffer);
+   if (jsonwriter)
+      rjsonwriter_free(jsonwriter);
+
+   task_set_finished(task, true);
+}
+
+static void task_ai_service_retry_handler(retro_task_t *task)
+{
+   task_set_finished(task, true);
+}
+
+static void task_ai_service_retry_cb(
+      retro_task_t *task, void *task_data,
+      void *user_data, const char *err)
+{
+   struct rarch_state *p_rarch = &rarch_st;
+   settings_t *settings        = p_rarch->configuration_settings;
+   bool was_paused             = runloop_state.paused;
+
+   RARCH_LOG("XXRETRY\n");
+   /* Auto mode may have been turned off meanwhile */
+   if (     (p_rarch->ai_service_auto != 0)
+         && !settings->bools.ai_service_pause)
+      call_auto_translate_task(p_rarch, settings, &was_paused);
+}
+
+static void task_ai_service_request_cb(
+      retro_task_t *task, void *task_data,
+      void *user_data, const char *err)
+{
+   ai_service_request_t *request = (ai_service_request_t*)task->state;
+   struct rarch_state *p_rarch   = &rarch_st;
+
+   if (request->unchanged)
+   {
+      /* Keep auto mode going, but only look at
+       * the screen again after a while */
+      retro_task_t *retry = task_init();
+
+      if (!retry)
+         return;
+
+      retry->handler      = task_ai_service_retry_handler;
+      retry->callback     = task_ai_service_retry_cb;
+      retry->when         = cpu_features_get_time_usec()
+         + AI_SERVICE_UNCHANGED_RETRY_USEC;
+      retry->mute         = true;
+      task_queue_push(retry);
+      return;
+   }
+
+   if (!request->json)
+      return;
+
+   memcpy(p_rarch->ai_service_signature, request->signature,
+         sizeof(p_rarch->ai_service_signature));
+   p_rarch->ai_service_signature_valid = true;
+
+#ifdef DEBUG
+   if (p_rarch->ai_service_auto != 2)
+      RARCH_LOG("SENDING... %s\n", request->url);
+#endif
+   task_push_http_post_transfer(request->url,
+         request->json, true, NULL, handle_translation_cb, NULL);
+}
+
+static void task_ai_service_request_cleanup(retro_task_t *task)
+{
+   ai_service_request_t *request = (ai_service_request_t*)task->state;
+
+   if (request->frame)
+      free(request->frame);
+   if (request->system_label)
+      free(request->system_label);
+   if (request->json)
+      free(request->json);
+   free(request);
+}
+
 /*
    This function does all the stuff needed to translate the game screen,
    using the URL given in the settings.  Once the image from the frame
@@ -11657,28 +12838,14 @@ static bool run_translation_service(
       bool paused)
 {
    struct video_viewport vp;
-   uint8_t header[54];
    size_t pitch;
    unsigned width, height;
    const void *data                      = NULL;
-   uint8_t *bit24_image                  = NULL;
-   uint8_t *bit24_image_prev             = NULL;
-   struct scaler_ctx *scaler             = (struct scaler_ctx*)
-      calloc(1, sizeof(struct scaler_ctx));
-   bool error                            = false;
-
-   uint8_t *bmp_buffer                   = NULL;
-   uint64_t buffer_bytes                 = 0;
-   char *bmp64_buffer                    = NULL;
-   rjsonwriter_t* jsonwriter             = NULL;
-   const char *json_buffer               = NULL;
-
-   int bmp64_length                      = 0;
-   bool TRANSLATE_USE_BMP                = false;
+   ai_service_request_t *request         = NULL;
+   retro_task_t *task                    = NULL;
    bool use_overlay                      = false;
 
    const char *label                     = NULL;
-   char* system_label                    = NULL;
    core_info_t *core_info                = NULL;
    const enum retro_pixel_format
       video_driver_pix_fmt               = p_rarch->video_driver_pix_fmt;
@@ -11689,7 +12856,7 @@ static bool run_translation_service(
          && (p_rarch->ai_service_auto == 1))
    {
       gfx_widgets_ai_service_overlay_unload(&p_rarch->dispwidget_st);
-      goto finish;
+      return true;
    }
 #endif
 
@@ -11700,6 +12867,94 @@ static bool run_translation_service(
       use_overlay = true;
 #endif
 
+   video_driver_cached_frame_get(&data, &width, &height, &pitch);
+
+   if (!data)
+      return false;
+
+   request = (ai_service_request_t*)calloc(1, sizeof(*request));
+   if (!request)
+      return false;
+
+   if (data == RETRO_HW_FRAME_BUFFER_VALID)
+   {
+      /*
+        The direct frame capture didn't work, so try getting it
+        from the viewport instead.  This isn't as good as the
+        raw frame buffer, since the viewport may us bilinear
+        filtering, or other shaders that will completely trash
+        the OCR, but it's better than nothing.
+      */
+      vp.x                           = 0;
+      vp.y                           = 0;
+      vp.width                       = 0;
+      vp.height                      = 0;
+      vp.full_width                  = 0;
+      vp.full_height                 = 0;
+
+      video_driver_get_viewport_info(&vp);
+
+      if (!vp.width || !vp.height)
+         goto error;
+
+      request->frame = (uint8_t*)malloc(vp.width * vp.height * 3);
+      if (!request->frame)
+         goto error;
+
+      if (!video_driver_read_viewport(request->frame, false))
+      {
+         RARCH_LOG("Could not read viewport for translation service...\n");
+         goto error;
+      }
+
+      request->frame_fmt    = SCALER_FMT_BGR24;
+      request->frame_width  = vp.width;
+      request->frame_height = vp.height;
+      request->frame_pitch  = vp.width * 3;
+   }
+   else
+   {
+      /* The frame is only valid for now, take a copy
+       * of it as it is and convert it later on */
+      unsigned bpp          =
+         (video_driver_pix_fmt == RETRO_PIXEL_FORMAT_XRGB8888) ? 4 : 2;
+      size_t frame_size     = (height - 1) * pitch + width * bpp;
+
+      request->frame        = (uint8_t*)malloc(frame_size);
+      if (!request->frame)
+         goto error;
+      memcpy(request->frame, data, frame_size);
+
+      if (video_driver_pix_fmt == RETRO_PIXEL_FORMAT_XRGB8888)
+         request->frame_fmt = SCALER_FMT_ARGB8888;
+      else
+         request->frame_fmt = SCALER_FMT_RGB565;
+      request->frame_width  = width;
+      request->frame_height = height;
+      request->frame_pitch  = pitch;
+   }
+
+   request->width           = width;
+   request->height          = height;
+   request->paused          = paused;
+
+   /* In auto mode the same screen needn't go out twice */
+   if (     p_rarch->ai_service_auto == 2
+         && p_rarch->ai_service_signature_valid)
+   {
+      request->skip_unchanged = true;
+      memcpy(request->prev_signature, p_rarch->ai_service_signature,
+            sizeof(request->prev_signature));
+   }
+
+#ifdef HAVE_ACCESSIBILITY
+   {
+      unsigned i;
+      for (i = 0; i < ARRAY_SIZE(request->gamepad_state); i++)
+         request->gamepad_state[i] = p_rarch->ai_gamepad_state[i] != 0;
+   }
+#endif
+
    /* get the core info here so we can pass long the game name */
    core_info_get_current_core(&core_info);
 
@@ -11711,6 +12966,7 @@ static bool run_translation_service(
       size_t system_id_len                = strlen(system_id);
       const struct playlist_entry *entry  = NULL;
       playlist_t *current_playlist        = playlist_get_cached();
+      char *system_label                  = NULL;
 
       if (current_playlist)
       {
@@ -11729,197 +12985,18 @@ static bool run_translation_service(
       memcpy(system_label + system_id_len, "__", 2);
       memcpy(system_label + 2 + system_id_len, label, label_len);
       system_label[system_id_len + 2 + label_len] = '\0';
+      request->system_label = system_label;
    }
 
-   if (!scaler)
-      goto finish;
-
-   video_driver_cached_frame_get(&data, &width, &height, &pitch);
-
-   if (!data)
-      goto finish;
-
-   if (data == RETRO_HW_FRAME_BUFFER_VALID)
-   {
-      /*
-        The direct frame capture didn't work, so try getting it
-        from the viewport instead.  This isn't as good as the
-        raw frame buffer, since the viewport may us bilinear
-        filtering, or other shaders that will completely trash
-        the OCR, but it's better than nothing.
-      */
-      vp.x                           = 0;
-      vp.y                           = 0;
-      vp.width                       = 0;
-      vp.height                      = 0;
-      vp.full_width                  = 0;
-      vp.full_height                 = 0;
-
-      video_driver_get_viewport_info(&vp);
-
-      if (!vp.width || !vp.height)
-         goto finish;
-
-      bit24_image_prev = (uint8_t*)malloc(vp.width * vp.height * 3);
-      bit24_image      = (uint8_t*)malloc(width * height * 3);
-
-      if (!bit24_image_prev || !bit24_image)
-         goto finish;
-
-      if (!video_driver_read_viewport(bit24_image_prev, false))
-      {
-         RARCH_LOG("Could not read viewport for translation service...\n");
-         goto finish;
-      }
-
-      /* TODO: Rescale down to regular resolution */
-      scaler->in_fmt      = SCALER_FMT_BGR24;
-      scaler->out_fmt     = SCALER_FMT_BGR24;
-      scaler->scaler_type = SCALER_TYPE_POINT;
-      scaler->in_width    = vp.width;
-      scaler->in_height   = vp.height;
-      scaler->out_width   = width;
-      scaler->out_height  = height;
-      scaler_ctx_gen_filter(scaler);
-
-      scaler->in_stride   = vp.width*3;
-      scaler->out_stride  = width*3;
-      scaler_ctx_scale_direct(scaler, bit24_image, bit24_image_prev);
-   }
-   else
-   {
-      /* This is a software core, so just change the pixel format to 24-bit. */
-      bit24_image = (uint8_t*)malloc(width * height * 3);
-      if (!bit24_image)
-          goto finish;
-
-      if (video_driver_pix_fmt == RETRO_PIXEL_FORMAT_XRGB8888)
-         scaler->in_fmt = SCALER_FMT_ARGB8888;
-      else
-         scaler->in_fmt = SCALER_FMT_RGB565;
-      video_frame_convert_to_bgr24(
-         scaler,
-         (uint8_t *)bit24_image,
-         (const uint8_t*)data + ((int)height - 1)*pitch,
-         width, height,
-         (int)-pitch);
-   }
-   scaler_ctx_gen_reset(scaler);
-
-   if (!bit24_image)
-   {
-      error = true;
-      goto finish;
-   }
-
-   if (TRANSLATE_USE_BMP)
    {
-      /*
-        At this point, we should have a screenshot in the buffer,
-        so allocate an array to contain the BMP image along with
-        the BMP header as bytes, and then covert that to a
-        b64 encoded array for transport in JSON.
-      */
-
-      form_bmp_header(header, width, height, false);
-      bmp_buffer  = (uint8_t*)malloc(width * height * 3 + 54);
-      if (!bmp_buffer)
-         goto finish;
-
-      memcpy(bmp_buffer, header, 54 * sizeof(uint8_t));
-      memcpy(bmp_buffer + 54,
-            bit24_image,
-            width * height * 3 * sizeof(uint8_t));
-      buffer_bytes = sizeof(uint8_t) * (width * height * 3 + 54);
-   }
-   else
-   {
-      pitch        = width * 3;
-      bmp_buffer   = rpng_save_image_bgr24_string(
-            bit24_image + width * (height-1) * 3,
-            width, height, (signed)-pitch, &buffer_bytes);
-   }
-
-   bmp64_buffer    = base64((void *)bmp_buffer,
-         sizeof(uint8_t) * buffer_bytes,
-         &bmp64_length);
-
-   if (!bmp64_buffer)
-      goto finish;
-
-   jsonwriter = rjsonwriter_open_memory();
-   if (!jsonwriter)
-      goto finish;
-
-   rjsonwriter_add_start_object(jsonwriter);
-   rjsonwriter_add_space(jsonwriter);
-   rjsonwriter_add_string(jsonwriter, "image");
-   rjsonwriter_add_colon(jsonwriter);
-   rjsonwriter_add_space(jsonwriter);
-   rjsonwriter_add_string_len(jsonwriter, bmp64_buffer, bmp64_length);
-
-   /* Form request... */
-   if (system_label)
-   {
-      rjsonwriter_add_comma(jsonwriter);
-      rjsonwriter_add_space(jsonwriter);
-      rjsonwriter_add_string(jsonwriter, "label");
-      rjsonwriter_add_colon(jsonwriter);
-      rjsonwriter_add_space(jsonwriter);
-      rjsonwriter_add_string(jsonwriter, system_label);
-   }
-
-   rjsonwriter_add_comma(jsonwriter);
-   rjsonwriter_add_space(jsonwriter);
-   rjsonwriter_add_string(jsonwriter, "state");
-   rjsonwriter_add_colon(jsonwriter);
-   rjsonwriter_add_space(jsonwriter);
-   rjsonwriter_add_start_object(jsonwriter);
-   rjsonwriter_add_space(jsonwriter);
-   rjsonwriter_add_string(jsonwriter, "paused");
-   rjsonwriter_add_colon(jsonwriter);
-   rjsonwriter_add_space(jsonwriter);
-   rjsonwriter_add_unsigned(jsonwriter, (paused ? 1 : 0));
-   {
-      static const char* state_labels[] = { "b", "y", "select", "start", "up", "down", "left", "right", "a", "x", "l", "r", "l2", "r2", "l3", "r3" };
-      int i;
-      for (i = 0; i < ARRAY_SIZE(state_labels); i++)
-      {
-         rjsonwriter_add_comma(jsonwriter);
-         rjsonwriter_add_space(jsonwriter);
-         rjsonwriter_add_string(jsonwriter, state_labels[i]);
-         rjsonwriter_add_colon(jsonwriter);
-         rjsonwriter_add_space(jsonwriter);
-#ifdef HAVE_ACCESSIBILITY
-         rjsonwriter_add_unsigned(jsonwriter,
-               (p_rarch->ai_gamepad_state[i] ? 1 : 0)
-               );
-#else
-         rjsonwriter_add_unsigned(jsonwriter, 0);
-#endif
-      }
-   }
-   rjsonwriter_add_space(jsonwriter);
-   rjsonwriter_add_end_object(jsonwriter);
-   rjsonwriter_add_space(jsonwriter);
-   rjsonwriter_add_end_object(jsonwriter);
-
-   json_buffer = rjsonwriter_get_memory_buffer(jsonwriter, NULL);
-   if (!json_buffer)
-      goto finish; /* ran out of memory */
-
-#ifdef DEBUG
-   if (p_rarch->ai_service_auto != 2)
-      RARCH_LOG("Request size: %d\n", bmp64_length);
-#endif
-   {
-      char new_ai_service_url[PATH_MAX_LENGTH];
+      char *new_ai_service_url        = request->url;
+      size_t new_ai_service_url_size  = sizeof(request->url);
       char separator                  = '?';
       unsigned ai_service_source_lang = settings->uints.ai_service_source_lang;
       unsigned ai_service_target_lang = settings->uints.ai_service_target_lang;
       const char *ai_service_url      = settings->arrays.ai_service_url;
 
-      strlcpy(new_ai_service_url, ai_service_url, sizeof(new_ai_service_url));
+      strlcpy(new_ai_service_url, ai_service_url, new_ai_service_url_size);
 
       /* if query already exists in url, then use &'s instead */
       if (strrchr(new_ai_service_url, '?'))
@@ -11939,7 +13016,7 @@ static bool run_translation_service(
                   "%csource_lang=%s", separator, lang_source);
             separator = '&';
             strlcat(new_ai_service_url,
-                  temp_string, sizeof(new_ai_service_url));
+                  temp_string, new_ai_service_url_size);
          }
       }
 
@@ -11958,7 +13035,7 @@ static bool run_translation_service(
             separator = '&';
 
             strlcat(new_ai_service_url, temp_string,
-                  sizeof(new_ai_service_url));
+                  new_ai_service_url_size);
          }
       }
 
@@ -12002,36 +13079,28 @@ static bool run_translation_service(
          separator = '&';
 
          strlcat(new_ai_service_url, temp_string,
-                 sizeof(new_ai_service_url));
+                 new_ai_service_url_size);
       }
-#ifdef DEBUG
-      if (p_rarch->ai_service_auto != 2)
-         RARCH_LOG("SENDING... %s\n", new_ai_service_url);
-#endif
-      task_push_http_post_transfer(new_ai_service_url,
-            json_buffer, true, NULL, handle_translation_cb, NULL);
    }
 
-   error = false;
-finish:
-   if (bit24_image_prev)
-      free(bit24_image_prev);
-   if (bit24_image)
-      free(bit24_image);
-
-   if (scaler)
-      free(scaler);
+   if (!(task = task_init()))
+      goto error;
 
-   if (bmp_buffer)
-      free(bmp_buffer);
+   task->state    = request;
+   task->handler  = task_ai_service_request_handler;
+   task->callback = task_ai_service_request_cb;
+   task->cleanup  = task_ai_service_request_cleanup;
+   task->mute     = true;
+   task_queue_push(task);
+   return true;
 
-   if (bmp64_buffer)
-      free(bmp64_buffer);
-   if (system_label)
-      free(system_label);
-   if (jsonwriter)
-      rjsonwriter_free(jsonwriter);
-   return !error;
+error:
+   if (request->frame)
+      free(request->frame);
+   if (request->system_label)
+      free(request->system_label);
+   free(request);
+   return false;
 }
 #endif
 
@@ -12209,6 +13278,70 @@ static void command_event_disable_overrides(struct rarch_state *p_rarch)
 }
 #endif
 
+/* Deinitializes the core kept by a warm content
+ * switch if it wasn't taken back by a core init */
+static void retroarch_release_resident_core(struct rarch_state *p_rarch)
+{
+   if (!p_rarch->resident_core.inited)
+      return;
+
+   RARCH_LOG("[Core]: Unloading resident core..\n");
+   p_rarch->resident_core.retro_deinit();
+#ifdef HAVE_DYNAMIC
+   if (p_rarch->resident_lib_handle)
+      dylib_close(p_rarch->resident_lib_handle);
+   p_rarch->resident_lib_handle    = NULL;
+#endif
+   memset(&p_rarch->resident_core, 0, sizeof(p_rarch->resident_core));
+   p_rarch->resident_core_path[0]  = '\0';
+}
+
+/* Takes back the core kept by a warm content switch,
+ * if it is the one @type and RARCH_PATH_CORE ask for.
+ * It is then inited already and only needs content.
+ *
+ * Returns: true if the resident core was taken. */
+static bool retroarch_take_resident_core(struct rarch_state *p_rarch,
+      enum rarch_core_type type)
+{
+   struct retro_core_t *core = &p_rarch->current_core;
+
+   if (!p_rarch->resident_core.inited)
+      return false;
+
+   if (     type != CORE_TYPE_PLAIN
+         || !string_is_equal(p_rarch->resident_core_path,
+            path_get(RARCH_PATH_CORE)))
+   {
+      retroarch_release_resident_core(p_rarch);
+      return false;
+   }
+
+   RARCH_LOG("[Core]: Reusing resident core from: \"%s\"\n",
+         p_rarch->resident_core_path);
+
+   /* Only the entry points carry over,
+    * the rest describes the previous content */
+   *core                             = p_rarch->resident_core;
+   core->serialization_quirks_v      = 0;
+   core->poll_type                   = 0;
+   core->game_loaded                 = false;
+   core->input_polled                = false;
+   core->has_set_subsystems          = false;
+   core->has_set_input_descriptors   = false;
+#ifdef HAVE_DYNAMIC
+   p_rarch->lib_handle               = p_rarch->resident_lib_handle;
+   p_rarch->resident_lib_handle      = NULL;
+#endif
+#ifdef HAVE_RUNAHEAD
+   p_rarch->last_core_type           = type;
+#endif
+
+   memset(&p_rarch->resident_core, 0, sizeof(p_rarch->resident_core));
+   p_rarch->resident_core_path[0]    = '\0';
+   return true;
+}
+
 static void command_event_deinit_core(
       struct rarch_state *p_rarch,
       bool reinit)
@@ -12217,11 +13350,29 @@ static void command_event_deinit_core(
 
    video_driver_set_cached_frame_ptr(NULL);
 
-   if (p_rarch->current_core.inited)
+   retroarch_release_resident_core(p_rarch);
+
+   if (     p_rarch->core_keep_resident
+         && p_rarch->current_core.inited
+         && p_rarch->current_core_type == CORE_TYPE_PLAIN)
+   {
+      /* The library stays open and inited, everything
+       * the frontend tied to it goes as usual below */
+      RARCH_LOG("[Core]: Keeping core resident for the next content..\n");
+      p_rarch->resident_core          = p_rarch->current_core;
+      strlcpy(p_rarch->resident_core_path, path_get(RARCH_PATH_CORE),
+            sizeof(p_rarch->resident_core_path));
+#ifdef HAVE_DYNAMIC
+      p_rarch->resident_lib_handle    = p_rarch->lib_handle;
+      p_rarch->lib_handle             = NULL;
+#endif
+   }
+   else if (p_rarch->current_core.inited)
    {
       RARCH_LOG("[Core]: Unloading core..\n");
       p_rarch->current_core.retro_deinit();
    }
+   p_rarch->core_keep_resident        = false;
 
    RARCH_LOG("[Core]: Unloading core symbols..\n");
    uninit_libretro_symbols(p_rarch, &p_rarch->current_core);
@@ -12459,7 +13610,10 @@ static void command_event_set_savestate_garbage_collect(
     *   the risk of deleting multiple incorrect files
     *   in case of accident */
    if (!string_is_empty(oldest_save) && (cnt > max_to_keep))
+   {
+      content_forget_state(oldest_save);
       filestream_delete(oldest_save);
+   }
 
    dir_list_free(dir_list);
 }
@@ -12498,11 +13652,14 @@ static bool event_init_content(
    if (!contentless)
       path_fill_names(p_rarch);
 
+   perf_boot_begin(PERF_BOOT_CONTENT);
    if (!content_init())
    {
+      perf_boot_end(PERF_BOOT_CONTENT);
       runloop_state.core_running = false;
       return false;
    }
+   perf_boot_end(PERF_BOOT_CONTENT);
 
    command_event_set_savestate_auto_index(settings, global, p_rarch);
 
@@ -12689,7 +13846,8 @@ static bool command_event_init_core(
    float fastforward_ratio         = 0.0f;
    rarch_system_info_t *sys_info   = &runloop_state.system;
 
-   if (!init_libretro_symbols(p_rarch,
+   if (     !retroarch_take_resident_core(p_rarch, type)
+         && !init_libretro_symbols(p_rarch,
             type, &p_rarch->current_core))
       return false;
    if (!p_rarch->current_core.retro_run)
@@ -12773,8 +13931,12 @@ static bool command_event_init_core(
 
    video_driver_set_cached_frame_ptr(NULL);
 
-   p_rarch->current_core.retro_init();
-   p_rarch->current_core.inited          = true;
+   /* A resident core is still inited */
+   if (!p_rarch->current_core.inited)
+   {
+      p_rarch->current_core.retro_init();
+      p_rarch->current_core.inited       = true;
+   }
 
    /* Attempt to set initial disk index */
    disk_control_set_initial_index(
@@ -13535,6 +14697,7 @@ static void retroarch_system_info_free(struct rarch_state *p_rarch)
    sys_info->ports.data                               = NULL;
    sys_info->ports.size                               = 0;
 
+   core_memory_dirty_deinit();
    if (sys_info->mmaps.descriptors)
       free((void *)sys_info->mmaps.descriptors);
    sys_info->mmaps.descriptors                        = NULL;
@@ -13570,6 +14733,8 @@ static void runahead_clear_variables(struct rarch_state *p_rarch)
    p_rarch->runahead_available                = true;
    p_rarch->runahead_secondary_core_available = true;
    p_rarch->runahead_force_input_dirty        = true;
+   p_rarch->runahead_ring_valid               = false;
+   p_rarch->runahead_ring_base                = 0;
    p_rarch->runahead_last_frame_count         = 0;
 }
 #endif
@@ -13642,6 +14807,29 @@ bool command_event(enum event_command cmd, void *data)
          else
             command_event(CMD_EVENT_RECORD_DEINIT, NULL);
          bsv_movie_check(p_rarch, settings);
+#endif
+         break;
+      case CMD_EVENT_BSV_SEEK:
+#ifdef HAVE_BSV_MOVIE
+         {
+            char msg[128];
+            int64_t frame = bsv_movie_seek(p_rarch, (const char*)data);
+
+            if (frame < 0)
+            {
+               runloop_msg_queue_push(
+                     msg_hash_to_str(MSG_FAILED_TO_SEEK_MOVIE),
+                     1, 180, true,
+                     NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+               return false;
+            }
+
+            snprintf(msg, sizeof(msg), "%s %" PRId64 ".",
+                  msg_hash_to_str(MSG_MOVIE_SEEKED_TO_FRAME), frame);
+            runloop_msg_queue_push(msg, 1, 180, true,
+                  NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+            RARCH_LOG("[BSV]: %s\n", msg);
+         }
 #endif
          break;
       case CMD_EVENT_AI_SERVICE_TOGGLE:
@@ -13750,6 +14938,41 @@ bool command_event(enum event_command cmd, void *data)
          else
             command_event(CMD_EVENT_RECORD_INIT, NULL);
          break;
+      case CMD_EVENT_INSTANT_REPLAY_SAVE:
+         {
+            char msg[PATH_MAX_LENGTH + 64];
+            char path[PATH_MAX_LENGTH];
+
+            if (     !p_rarch->recording_data
+                  || !p_rarch->recording_driver->save_replay)
+            {
+               runloop_msg_queue_push(
+                     msg_hash_to_str(MSG_INSTANT_REPLAY_NOT_RUNNING),
+                     1, 180, true, NULL,
+                     MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_WARNING);
+               return false;
+            }
+
+            recording_fill_dated_path(settings, &p_rarch->g_extern,
+                  NULL, path, sizeof(path));
+
+            if (!p_rarch->recording_driver->save_replay(
+                     p_rarch->recording_data, path))
+            {
+               runloop_msg_queue_push(
+                     msg_hash_to_str(MSG_INSTANT_REPLAY_NOT_RUNNING),
+                     1, 180, true, NULL,
+                     MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_WARNING);
+               return false;
+            }
+
+            snprintf(msg, sizeof(msg), "%s \"%s\"",
+                  msg_hash_to_str(MSG_INSTANT_REPLAY_SAVING),
+                  path_basename(path));
+            runloop_msg_queue_push(msg, 1, 180, true, NULL,
+                  MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+         }
+         break;
       case CMD_EVENT_OSK_TOGGLE:
          if (p_rarch->input_driver_keyboard_linefeed_enable)
             p_rarch->input_driver_keyboard_linefeed_enable = false;
@@ -14053,6 +15276,8 @@ bool command_event(enum event_command cmd, void *data)
          {
             bool rewind_enable        = settings->bools.rewind_enable;
             size_t rewind_buf_size    = settings->sizes.rewind_buffer_size;
+            bool lock_memory          = settings->bools.state_buffers_locked;
+            unsigned checkpoint_secs  = settings->uints.rewind_checkpoint_interval;
 	    bool core_type_is_dummy   = p_rarch->current_core_type == CORE_TYPE_DUMMY;
 	    if (core_type_is_dummy)
                return false;
@@ -14069,8 +15294,13 @@ bool command_event(enum event_command cmd, void *data)
                         RARCH_NETPLAY_CTL_IS_ENABLED, NULL))
 #endif
                {
+                  double fps                = p_rarch->video_driver_av_info.timing.fps;
+                  unsigned checkpoint_frames = (unsigned)(checkpoint_secs
+                        * ((fps > 0.0) ? fps : 60.0) + 0.5);
+
                   state_manager_event_init(&p_rarch->rewind_st,
-                        (unsigned)rewind_buf_size);
+                        (unsigned)rewind_buf_size, lock_memory,
+                        checkpoint_frames);
                }
             }
          }
@@ -14319,12 +15549,14 @@ bool command_event(enum event_command cmd, void *data)
             {
                bool cache_supported = false;
 
+               perf_boot_begin(PERF_BOOT_CORE_INFO);
                core_info_init_list(path_libretro_info,
                      dir_libretro,
                      ext_name,
                      show_hidden_files,
                      core_info_cache_enable,
                      &cache_supported);
+               perf_boot_end(PERF_BOOT_CORE_INFO);
 
                /* If core info cache is enabled but cache
                 * functionality is unsupported (i.e. because
@@ -14369,6 +15601,10 @@ bool command_event(enum event_command cmd, void *data)
              * RetroArch */
             if (!p_rarch->runahead_available)
                runahead_clear_variables(p_rarch);
+
+            /* Lag frames are detected anew for the next content */
+            memset(&p_rarch->runahead_probe, 0,
+                  sizeof(p_rarch->runahead_probe));
 #endif
 
             if (hwr)
@@ -14407,6 +15643,24 @@ bool command_event(enum event_command cmd, void *data)
                      adaptive_vsync, swap_interval);
          }
          break;
+      case CMD_EVENT_VIDEO_SWAPCHAIN_REINIT:
+         /* Drivers that can't recreate their swapchain in
+          * place pick the new image count up on the next
+          * reinit, as they always have */
+         if (     p_rarch->video_driver_data
+               && p_rarch->video_driver_poke
+               && p_rarch->video_driver_poke->reconfigure)
+            p_rarch->video_driver_poke->reconfigure(
+                  p_rarch->video_driver_data,
+                  VIDEO_RECONFIGURE_SWAPCHAIN);
+         break;
+      case CMD_EVENT_VIDEO_FILTER_REINIT:
+#ifdef HAVE_VIDEO_FILTER
+         if (video_driver_swap_filter(p_rarch, settings))
+            break;
+#endif
+         command_event_reinit(p_rarch, DRIVERS_CMD_ALL);
+         break;
       case CMD_EVENT_VIDEO_SET_ASPECT_RATIO:
          video_driver_set_aspect_ratio();
          break;
@@ -14453,6 +15707,9 @@ bool command_event(enum event_command cmd, void *data)
 #if defined(__linux__) && !defined(ANDROID)
          runloop_msg_queue_push(msg_hash_to_str(MSG_VALUE_SHUTTING_DOWN), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
          command_event(CMD_EVENT_MENU_SAVE_CURRENT_CONFIG, NULL);
+#ifdef HAVE_CONFIGFILE
+         task_config_save_flush();
+#endif
          command_event(CMD_EVENT_QUIT, NULL);
          system("shutdown -P now");
 #endif
@@ -14461,6 +15718,9 @@ bool command_event(enum event_command cmd, void *data)
 #if defined(__linux__) && !defined(ANDROID)
          runloop_msg_queue_push(msg_hash_to_str(MSG_VALUE_REBOOTING), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
          command_event(CMD_EVENT_MENU_SAVE_CURRENT_CONFIG, NULL);
+#ifdef HAVE_CONFIGFILE
+         task_config_save_flush();
+#endif
          command_event(CMD_EVENT_QUIT, NULL);
          system("shutdown -r now");
 #endif
@@ -15548,10 +16808,19 @@ void main_exit(void *args)
    settings_t     *settings     = p_rarch->configuration_settings;
    bool     config_save_on_exit = settings->bools.config_save_on_exit;
 
+   if (     !string_is_empty(p_rarch->boot_trace_path)
+         && !perf_boot_dump(p_rarch->boot_trace_path))
+      RARCH_ERR("[Boot]: Could not write \"%s\".\n",
+            p_rarch->boot_trace_path);
+
    video_driver_restore_cached(p_rarch, settings);
 
    if (config_save_on_exit)
       command_event(CMD_EVENT_MENU_SAVE_CURRENT_CONFIG, NULL);
+#ifdef HAVE_CONFIGFILE
+   /* Config saves are written from a task */
+   task_config_save_flush();
+#endif
 
 #if defined(HAVE_GFX_WIDGETS)
    /* Do not want display widgets to live any more. */
@@ -15589,12 +16858,18 @@ void main_exit(void *args)
 
    retroarch_msg_queue_deinit();
    driver_uninit(p_rarch, DRIVERS_CMD_ALL);
+   retroarch_release_resident_core(p_rarch);
 
    retro_main_log_file_deinit();
 
    rarch_ctl(RARCH_CTL_STATE_FREE,  NULL);
    global_free(p_rarch);
    task_queue_deinit();
+#ifdef HAVE_CONFIGFILE
+   task_config_save_deinit();
+#endif
+   content_hash_cache_deinit();
+   input_autoconfigure_index_deinit();
 
    if (p_rarch->configuration_settings)
       free(p_rarch->configuration_settings);
@@ -15609,6 +16884,12 @@ void main_exit(void *args)
    frontend_driver_free();
 
    rtime_deinit();
+   dir_list_cache_deinit();
+#ifdef HAVE_THREADS
+   tpool_shared_deinit();
+#endif
+   task_queue_set_trace(NULL);
+   perf_trace_deinit();
 
 #if defined(ANDROID)
    play_feature_delivery_deinit();
@@ -15655,6 +16936,17 @@ int rarch_main(int argc, char *argv[], void *data)
 #endif
 
    rtime_init();
+   dir_list_cache_init();
+#ifdef HAVE_THREADS
+   /* The calling thread of a batch runs jobs as well */
+   tpool_shared_init(cpu_features_get_core_amount() - 1);
+#endif
+#ifdef HAVE_CONFIGFILE
+   task_config_save_init();
+#endif
+   perf_trace_init();
+   perf_trace_set_thread_name("main");
+   perf_boot_init();
 
 #if defined(ANDROID)
    play_feature_delivery_init();
@@ -17646,6 +18938,7 @@ static bool rarch_environment_cb(unsigned cmd, void *data)
                system->mmaps.descriptors[i].core = mmaps->descriptors[i];
 
             mmap_preprocess_descriptors(descriptors, mmaps->num_descriptors);
+            core_memory_dirty_init(&system->mmaps);
 
             if (sizeof(void *) == 8)
                RARCH_LOG("   ndx flags  ptr              offset   start    select   disconn  len      addrspace\n");
@@ -19781,6 +21074,39 @@ static void video_driver_gpu_record_deinit(struct rarch_state *p_rarch)
    p_rarch->video_driver_record_gpu_buffer = NULL;
 }
 
+/* Fills 's' with a new dated file name in the
+ * recording directory. Without 'ext', the extension
+ * is the one of the recording quality preset. */
+static void recording_fill_dated_path(
+      settings_t *settings,
+      global_t *global,
+      const char *ext,
+      char *s, size_t len)
+{
+   char buf[PATH_MAX_LENGTH];
+   unsigned video_record_quality = settings->uints.video_record_quality;
+   const char *game_name         = path_basename(path_get(RARCH_PATH_BASENAME));
+   /* Fallback to core name if started without content */
+   if (string_is_empty(game_name))
+      game_name = runloop_state.system.info.library_name;
+
+   if (ext)
+      ;
+   else if (video_record_quality < RECORD_CONFIG_TYPE_RECORDING_WEBM_FAST)
+      ext = "mkv";
+   else if (video_record_quality >= RECORD_CONFIG_TYPE_RECORDING_WEBM_FAST
+         && video_record_quality < RECORD_CONFIG_TYPE_RECORDING_GIF)
+      ext = "webm";
+   else if (video_record_quality >= RECORD_CONFIG_TYPE_RECORDING_GIF
+         && video_record_quality < RECORD_CONFIG_TYPE_RECORDING_APNG)
+      ext = "gif";
+   else
+      ext = "png";
+
+   fill_str_dated_filename(buf, game_name, ext, sizeof(buf));
+   fill_pathname_join(s, global->record.output_dir, buf, len);
+}
+
 /**
  * recording_init:
  *
@@ -19793,7 +21119,6 @@ static bool recording_init(
       struct rarch_state *p_rarch)
 {
    char output[PATH_MAX_LENGTH];
-   char buf[PATH_MAX_LENGTH];
    struct record_params params          = {0};
    struct retro_system_av_info *av_info = &p_rarch->video_driver_av_info;
    global_t *global                     = &p_rarch->g_extern;
@@ -19834,49 +21159,34 @@ static bool recording_init(
    else
    {
       const char *stream_url        = settings->paths.path_stream_url;
-      unsigned video_record_quality = settings->uints.video_record_quality;
       unsigned video_stream_port    = settings->uints.video_stream_port;
       if (p_rarch->streaming_enable)
+      {
          if (!string_is_empty(stream_url))
             strlcpy(output, stream_url, sizeof(output));
          else
             /* Fallback, stream locally to 127.0.0.1 */
             snprintf(output, sizeof(output), "udp://127.0.0.1:%u",
                   video_stream_port);
-      else
-      {
-         const char *game_name = path_basename(path_get(RARCH_PATH_BASENAME));
-         /* Fallback to core name if started without content */
-         if (string_is_empty(game_name))
-            game_name = runloop_state.system.info.library_name;
 
-         if (video_record_quality < RECORD_CONFIG_TYPE_RECORDING_WEBM_FAST)
+         /* The same encode goes to a file as well,
+          * Matroska taking whatever the stream uses */
+         if (settings->bools.streaming_record_copy)
          {
-            fill_str_dated_filename(buf, game_name,
-                     "mkv", sizeof(buf));
-            fill_pathname_join(output, global->record.output_dir, buf, sizeof(output));
-         }
-         else if (video_record_quality >= RECORD_CONFIG_TYPE_RECORDING_WEBM_FAST
-               && video_record_quality < RECORD_CONFIG_TYPE_RECORDING_GIF)
-         {
-            fill_str_dated_filename(buf, game_name,
-                     "webm", sizeof(buf));
-            fill_pathname_join(output, global->record.output_dir, buf, sizeof(output));
-         }
-         else if (video_record_quality >= RECORD_CONFIG_TYPE_RECORDING_GIF
-               && video_record_quality < RECORD_CONFIG_TYPE_RECORDING_APNG)
-         {
-            fill_str_dated_filename(buf, game_name,
-                     "gif", sizeof(buf));
-            fill_pathname_join(output, global->record.output_dir, buf, sizeof(output));
-         }
-         else
-         {
-            fill_str_dated_filename(buf, game_name,
-                     "png", sizeof(buf));
-            fill_pathname_join(output, global->record.output_dir, buf, sizeof(output));
+            char path[PATH_MAX_LENGTH];
+            recording_fill_dated_path(settings, global, "mkv",
+                  path, sizeof(path));
+            strlcat(output, "|", sizeof(output));
+            strlcat(output, path, sizeof(output));
          }
       }
+      else
+      {
+         recording_fill_dated_path(settings, global, NULL,
+               output, sizeof(output));
+         /* Nothing is written until a replay is saved */
+         params.replay_length = settings->uints.instant_replay_length;
+      }
    }
 
    params.audio_resampler           = settings->arrays.audio_resampler;
@@ -19997,12 +21307,20 @@ static bool recording_init(
 #endif
    }
 
-   RARCH_LOG("[recording] %s %s @ %ux%u. (FB size: %ux%u pix_fmt: %u)\n",
-         msg_hash_to_str(MSG_RECORDING_TO),
-         output,
-         params.out_width, params.out_height,
-         params.fb_width, params.fb_height,
-         (unsigned)params.pix_fmt);
+   if (params.replay_length)
+      RARCH_LOG("[recording] %s %u s @ %ux%u. (FB size: %ux%u pix_fmt: %u)\n",
+            msg_hash_to_str(MSG_INSTANT_REPLAY_BUFFERING),
+            params.replay_length,
+            params.out_width, params.out_height,
+            params.fb_width, params.fb_height,
+            (unsigned)params.pix_fmt);
+   else
+      RARCH_LOG("[recording] %s %s @ %ux%u. (FB size: %ux%u pix_fmt: %u)\n",
+            msg_hash_to_str(MSG_RECORDING_TO),
+            output,
+            params.out_width, params.out_height,
+            params.fb_width, params.fb_height,
+            (unsigned)params.pix_fmt);
 
    if (!record_driver_init_first(
             &p_rarch->recording_driver, &p_rarch->recording_data, &params))
@@ -20077,13 +21395,48 @@ void recording_driver_update_streaming_url(void)
 
 #ifdef HAVE_BSV_MOVIE
 /* BSV MOVIE */
+static bool bsv_movie_serialize(void *data, size_t size)
+{
+   retro_ctx_serialize_info_t serial_info;
+
+   serial_info.data       = data;
+   serial_info.size       = size;
+
+   return core_serialize(&serial_info);
+}
+
+static bool bsv_movie_unserialize(const void *data, size_t size)
+{
+   retro_ctx_serialize_info_t serial_info;
+
+   serial_info.data_const = data;
+   serial_info.size       = size;
+
+   return core_unserialize(&serial_info);
+}
+
 static bool bsv_movie_init_playback(
       bsv_movie_t *handle, const char *path)
 {
    uint32_t state_size       = 0;
    uint32_t content_crc      = 0;
    uint32_t header[4]        = {0};
-   intfstream_t *file        = intfstream_open_file(path,
+   intfstream_t *file        = NULL;
+
+   if (bsv_stream_probe(path))
+   {
+      retro_ctx_size_info_t info;
+
+      core_serialize_size(&info);
+
+      handle->playback       = true;
+      handle->stream         = bsv_stream_open_read(path,
+            content_get_crc(), info.size, bsv_movie_unserialize);
+
+      return handle->stream != NULL;
+   }
+
+   file                      = intfstream_open_file(path,
          RETRO_VFS_FILE_ACCESS_READ,
          RETRO_VFS_FILE_ACCESS_HINT_NONE);
 
@@ -20157,60 +21510,24 @@ static bool bsv_movie_init_playback(
    return true;
 }
 
+/* Recordings are always BSV2, with input buffered and
+ * written out by the stream along with its keyframes */
 static bool bsv_movie_init_record(
       bsv_movie_t *handle, const char *path)
 {
    retro_ctx_size_info_t info;
-   uint32_t state_size       = 0;
-   uint32_t content_crc      = 0;
-   uint32_t header[4]        = {0};
-   intfstream_t *file        = intfstream_open_file(path,
-         RETRO_VFS_FILE_ACCESS_WRITE,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE);
-
-   if (!file)
-   {
-      RARCH_ERR("Could not open BSV file for recording, path : \"%s\".\n", path);
-      return false;
-   }
-
-   handle->file             = file;
-
-   content_crc              = content_get_crc();
-
-   /* This value is supposed to show up as
-    * BSV1 in a HEX editor, big-endian. */
-   header[MAGIC_INDEX]      = swap_if_little32(BSV_MAGIC);
-   header[CRC_INDEX]        = swap_if_big32(content_crc);
 
    core_serialize_size(&info);
 
-   state_size               = (unsigned)info.size;
+   handle->state_size       = info.size;
+   handle->stream           = bsv_stream_open_write(path,
+         content_get_crc(), info.size,
+         bsv_movie_serialize, bsv_movie_unserialize);
 
-   header[STATE_SIZE_INDEX] = swap_if_big32(state_size);
-
-   intfstream_write(handle->file, header, 4 * sizeof(uint32_t));
-
-   handle->min_file_pos     = sizeof(header) + state_size;
-   handle->state_size       = state_size;
-
-   if (state_size)
+   if (!handle->stream)
    {
-      retro_ctx_serialize_info_t serial_info;
-      uint8_t *st      = (uint8_t*)malloc(state_size);
-
-      if (!st)
-         return false;
-
-      handle->state    = st;
-
-      serial_info.data = handle->state;
-      serial_info.size = state_size;
-
-      core_serialize(&serial_info);
-
-      intfstream_write(handle->file,
-            handle->state, state_size);
+      RARCH_ERR("Could not open BSV file for recording, path : \"%s\".\n", path);
+      return false;
    }
 
    return true;
@@ -20221,8 +21538,13 @@ static void bsv_movie_free(bsv_movie_t *handle)
    if (!handle)
       return;
 
-   intfstream_close(handle->file);
-   free(handle->file);
+   bsv_stream_close(handle->stream);
+
+   if (handle->file)
+   {
+      intfstream_close(handle->file);
+      free(handle->file);
+   }
 
    free(handle->state);
    free(handle->frame_pos);
@@ -20246,6 +21568,10 @@ static bsv_movie_t *bsv_movie_init_internal(const char *path,
    else if (!bsv_movie_init_record(handle, path))
       goto error;
 
+   /* BSV2 streams keep track of frames themselves */
+   if (handle->stream)
+      return handle;
+
    /* Just pick something really large
     * ~1 million frames rewind should do the trick. */
    if (!(frame_pos = (size_t*)calloc((1 << 20), sizeof(size_t))))
@@ -20273,6 +21599,12 @@ void bsv_movie_frame_rewind(void)
 
    handle->did_rewind = true;
 
+   if (handle->stream)
+   {
+      bsv_stream_rewind(handle->stream, handle->first_rewind);
+      return;
+   }
+
    if (     (handle->frame_ptr <= 1)
          && (handle->frame_pos[0] == handle->min_file_pos))
    {
@@ -20440,6 +21772,102 @@ static bool runloop_check_movie_init(struct rarch_state *p_rarch,
    return true;
 }
 
+/* Parses a movie position, either a frame number
+ * or a [hh:]mm:ss time */
+static bool bsv_movie_parse_position(struct rarch_state *p_rarch,
+      const char *str, uint64_t *frame)
+{
+   char *end        = NULL;
+   unsigned fields  = 0;
+   uint64_t value   = 0;
+   uint64_t seconds = 0;
+   double fps       = p_rarch->video_driver_av_info.timing.fps;
+
+   if (string_is_empty(str))
+      return false;
+
+   for (;;)
+   {
+      value   = strtoull(str, &end, 10);
+      if (end == str)
+         return false;
+      seconds = seconds * 60 + value;
+      fields++;
+      if (*end != ':')
+         break;
+      str     = end + 1;
+   }
+
+   while (ISSPACE(*end))
+      end++;
+
+   if (*end || fields > 3)
+      return false;
+
+   if (fields == 1)
+      *frame = value;
+   else if (fps > 0.0)
+      *frame = (uint64_t)(seconds * fps + 0.5);
+   else
+      return false;
+
+   return true;
+}
+
+/**
+ * bsv_movie_seek:
+ * @position             : frame number or [hh:]mm:ss time.
+ *
+ * Jumps BSV2 movie playback to @position. Playback is
+ * restored to the last keyframe before it, then the
+ * core is run up to @position with video and audio
+ * suspended, as run-ahead does.
+ *
+ * Returns: the frame playback continues from, or -1 if
+ * the movie can't seek.
+ **/
+static int64_t bsv_movie_seek(struct rarch_state *p_rarch,
+      const char *position)
+{
+   uint64_t target;
+   int64_t frame;
+   bool video_driver_active;
+   bool audio_suspended;
+   bsv_movie_t *handle = p_rarch->bsv_movie_state_handle;
+
+   if (     !BSV_MOVIE_IS_PLAYBACK_ON()
+         || !handle->stream
+         || !bsv_movie_parse_position(p_rarch, position, &target))
+      return -1;
+
+   if ((frame = bsv_stream_seek(handle->stream, target)) < 0)
+      return -1;
+
+   p_rarch->bsv_movie_state.movie_end = false;
+
+   video_driver_active          = p_rarch->video_driver_active;
+   audio_suspended              = p_rarch->audio_suspended;
+   p_rarch->video_driver_active = false;
+   p_rarch->audio_suspended     = true;
+
+   while (     (uint64_t)frame < target
+            && !p_rarch->bsv_movie_state.movie_end)
+   {
+      bsv_stream_frame_start(handle->stream);
+      core_run();
+      frame++;
+   }
+
+   p_rarch->video_driver_active = video_driver_active;
+   p_rarch->audio_suspended     = audio_suspended;
+
+   /* Rewinding must not go back to before the seek */
+   command_event(CMD_EVENT_REWIND_DEINIT, NULL);
+   command_event(CMD_EVENT_REWIND_INIT, NULL);
+
+   return frame;
+}
+
 static bool bsv_movie_check(struct rarch_state *p_rarch,
       settings_t *settings)
 {
@@ -20752,6 +22180,141 @@ static void input_overlay_parse_layout(
    }
 }
 
+#define OVERLAY_HIT_GRID_MAX 16
+
+static void input_overlay_free_hit_grid(struct overlay *ol)
+{
+   if (ol->hit_grid.cell_start)
+      free(ol->hit_grid.cell_start);
+   if (ol->hit_grid.descs)
+      free(ol->hit_grid.descs);
+   ol->hit_grid.cell_start = NULL;
+   ol->hit_grid.descs      = NULL;
+}
+
+/* Cell span of a descriptor's hitbox, grown by its
+ * range_mod since pressed hitboxes get larger. */
+static void input_overlay_hit_grid_span(const struct overlay *ol,
+      const struct overlay_desc *desc,
+      unsigned *col0, unsigned *col1, unsigned *row0, unsigned *row1)
+{
+   float mod = (desc->range_mod > 1.0f) ? desc->range_mod : 1.0f;
+   float c0  = (desc->x_shift - desc->range_x * mod - ol->hit_grid.x)
+      * ol->hit_grid.x_scale;
+   float c1  = (desc->x_shift + desc->range_x * mod - ol->hit_grid.x)
+      * ol->hit_grid.x_scale;
+   float r0  = (desc->y_shift - desc->range_y * mod - ol->hit_grid.y)
+      * ol->hit_grid.y_scale;
+   float r1  = (desc->y_shift + desc->range_y * mod - ol->hit_grid.y)
+      * ol->hit_grid.y_scale;
+
+   *col0     = (unsigned)clamp_float(c0, 0.0f, ol->hit_grid.cols - 1);
+   *col1     = (unsigned)clamp_float(c1, 0.0f, ol->hit_grid.cols - 1);
+   *row0     = (unsigned)clamp_float(r0, 0.0f, ol->hit_grid.rows - 1);
+   *row1     = (unsigned)clamp_float(r1, 0.0f, ol->hit_grid.rows - 1);
+}
+
+/**
+ * input_overlay_build_hit_grid:
+ * @ol                    : Overlay handle.
+ *
+ * Bins the (scaled) descriptors of @ol into a uniform
+ * grid for input_overlay_poll(). Each cell lists its
+ * descriptors in their original order.
+ **/
+static void input_overlay_build_hit_grid(struct overlay *ol)
+{
+   size_t i;
+   unsigned c, r, cells, dim;
+   unsigned *cursor = NULL;
+   float min_x      = 0.0f;
+   float min_y      = 0.0f;
+   float max_x      = 0.0f;
+   float max_y      = 0.0f;
+
+   input_overlay_free_hit_grid(ol);
+
+   if (ol->size == 0)
+      return;
+
+   for (i = 0; i < ol->size; i++)
+   {
+      const struct overlay_desc *desc = &ol->descs[i];
+      float mod = (desc->range_mod > 1.0f) ? desc->range_mod : 1.0f;
+      float x0  = desc->x_shift - desc->range_x * mod;
+      float x1  = desc->x_shift + desc->range_x * mod;
+      float y0  = desc->y_shift - desc->range_y * mod;
+      float y1  = desc->y_shift + desc->range_y * mod;
+
+      if (i == 0 || x0 < min_x)
+         min_x = x0;
+      if (i == 0 || x1 > max_x)
+         max_x = x1;
+      if (i == 0 || y0 < min_y)
+         min_y = y0;
+      if (i == 0 || y1 > max_y)
+         max_y = y1;
+   }
+
+   /* About two cells per descriptor along each axis */
+   dim = (unsigned)ceilf(sqrtf((float)ol->size)) * 2;
+   if (dim > OVERLAY_HIT_GRID_MAX)
+      dim = OVERLAY_HIT_GRID_MAX;
+
+   ol->hit_grid.cols    = dim;
+   ol->hit_grid.rows    = dim;
+   ol->hit_grid.x       = min_x;
+   ol->hit_grid.y       = min_y;
+   ol->hit_grid.x_scale = (max_x > min_x) ? dim / (max_x - min_x) : 0.0f;
+   ol->hit_grid.y_scale = (max_y > min_y) ? dim / (max_y - min_y) : 0.0f;
+
+   cells                = dim * dim;
+   ol->hit_grid.cell_start = (unsigned*)calloc(cells + 1, sizeof(unsigned));
+   cursor               = (unsigned*)calloc(cells, sizeof(unsigned));
+   if (!ol->hit_grid.cell_start || !cursor)
+      goto error;
+
+   /* Count, prefix sum, then fill */
+   for (i = 0; i < ol->size; i++)
+   {
+      unsigned col0, col1, row0, row1;
+      input_overlay_hit_grid_span(ol, &ol->descs[i],
+            &col0, &col1, &row0, &row1);
+      for (r = row0; r <= row1; r++)
+         for (c = col0; c <= col1; c++)
+            ol->hit_grid.cell_start[r * dim + c + 1]++;
+   }
+
+   for (c = 0; c < cells; c++)
+   {
+      ol->hit_grid.cell_start[c + 1] += ol->hit_grid.cell_start[c];
+      cursor[c]                       = ol->hit_grid.cell_start[c];
+   }
+
+   if (!(ol->hit_grid.descs = (unsigned*)malloc(
+         MAX(ol->hit_grid.cell_start[cells], 1) * sizeof(unsigned))))
+      goto error;
+
+   for (i = 0; i < ol->size; i++)
+   {
+      unsigned col0, col1, row0, row1;
+      input_overlay_hit_grid_span(ol, &ol->descs[i],
+            &col0, &col1, &row0, &row1);
+      for (r = row0; r <= row1; r++)
+         for (c = col0; c <= col1; c++)
+            ol->hit_grid.descs[cursor[r * dim + c]++] = (unsigned)i;
+   }
+
+   free(cursor);
+   return;
+
+error:
+   if (cursor)
+      free(cursor);
+   /* Polling falls back to testing every descriptor */
+   input_overlay_free_hit_grid(ol);
+}
+
 /**
  * input_overlay_scale:
  * @ol                    : Overlay handle.
@@ -20808,6 +22371,8 @@ static void input_overlay_scale(struct overlay *ol,
       desc->mod_x   = adj_center_x - scale_w;
       desc->mod_y   = adj_center_y - scale_h;
    }
+
+   input_overlay_build_hit_grid(ol);
 }
 
 static void input_overlay_set_vertex_geom(input_overlay_t *ol)
@@ -20882,6 +22447,7 @@ void input_overlay_free_overlay(struct overlay *overlay)
    if (overlay->descs)
       free(overlay->descs);
    overlay->descs       = NULL;
+   input_overlay_free_hit_grid(overlay);
    image_texture_free(&overlay->image);
 }
 
@@ -20953,9 +22519,20 @@ static void input_overlay_load_active(
       input_overlay_t *ol, float opacity)
 {
    if (ol->iface->load)
+   {
+      unsigned i;
+      size_t size = 0;
+
       ol->iface->load(ol->iface_data, ol->active->load_images,
             ol->active->load_images_size);
 
+      /* Replaces the textures of the previous overlay */
+      for (i = 0; i < ol->active->load_images_size; i++)
+         size += video_driver_texture_size(&ol->active->load_images[i],
+               TEXTURE_FILTER_LINEAR);
+      p_rarch->video_driver_gpu_mem.usage[VIDEO_GPU_MEM_OVERLAYS] = size;
+   }
+
    input_overlay_set_alpha_mod(p_rarch, ol, opacity);
    input_overlay_set_vertex_geom(ol);
 
@@ -21087,6 +22664,8 @@ static void input_overlay_poll(
       int16_t norm_x, int16_t norm_y, float touch_scale)
 {
    size_t i;
+   const unsigned *indices = NULL;
+   size_t count            = ol->active->size;
 
    /* norm_x and norm_y is in [-0x7fff, 0x7fff] range,
     * like RETRO_DEVICE_POINTER. */
@@ -21101,11 +22680,32 @@ static void input_overlay_poll(
    x *= touch_scale;
    y *= touch_scale;
 
-   for (i = 0; i < ol->active->size; i++)
+   /* Only test the descriptors sharing the pointer's grid cell */
+   if (ol->active->hit_grid.cell_start)
+   {
+      float col = (x - ol->active->hit_grid.x) * ol->active->hit_grid.x_scale;
+      float row = (y - ol->active->hit_grid.y) * ol->active->hit_grid.y_scale;
+
+      count     = 0;
+      if (     col >= 0.0f && col <= (float)ol->active->hit_grid.cols
+            && row >= 0.0f && row <= (float)ol->active->hit_grid.rows)
+      {
+         unsigned cell = MIN((unsigned)row, ol->active->hit_grid.rows - 1)
+            * ol->active->hit_grid.cols
+            + MIN((unsigned)col, ol->active->hit_grid.cols - 1);
+
+         indices       = &ol->active->hit_grid.descs[
+            ol->active->hit_grid.cell_start[cell]];
+         count         = ol->active->hit_grid.cell_start[cell + 1]
+            - ol->active->hit_grid.cell_start[cell];
+      }
+   }
+
+   for (i = 0; i < count; i++)
    {
       float x_dist, y_dist;
       unsigned int base         = 0;
-      struct overlay_desc *desc = &ol->active->descs[i];
+      struct overlay_desc *desc = &ol->active->descs[indices ? indices[i] : i];
 
       if (!inside_hitbox(desc, x, y))
          continue;
@@ -21598,6 +23198,7 @@ static void retroarch_overlay_deinit(struct rarch_state *p_rarch)
 {
    input_overlay_free(p_rarch->overlay_ptr);
    p_rarch->overlay_ptr = NULL;
+   p_rarch->video_driver_gpu_mem.usage[VIDEO_GPU_MEM_OVERLAYS] = 0;
 }
 
 static void retroarch_overlay_init(struct rarch_state *p_rarch)
@@ -21914,6 +23515,99 @@ float input_sensor_get_input(unsigned port, unsigned id)
  *
  * Input polling callback function.
  **/
+/**
+ * latency_test_poll:
+ *
+ * Starts a latency measurement when a RetroPad
+ * button of user 1 goes down, unless one is
+ * already in progress.
+ **/
+static void latency_test_poll(struct rarch_state *p_rarch,
+      settings_t *settings,
+      const input_device_driver_t *sec_joypad)
+{
+   int16_t buttons;
+   rarch_joypad_info_t joypad_info;
+   latency_test_state_t *st  = &p_rarch->latency_test;
+
+   if (!p_rarch->joypad)
+      return;
+
+   joypad_info.axis_threshold = p_rarch->input_driver_axis_threshold;
+   joypad_info.joy_idx        = settings->uints.input_joypad_index[0];
+   joypad_info.auto_binds     = input_autoconf_binds[joypad_info.joy_idx];
+
+   buttons                    = input_state_wrap(
+         p_rarch->current_input,
+         p_rarch->current_input_data,
+         p_rarch->joypad,
+         sec_joypad,
+         &joypad_info,
+         p_rarch->libretro_input_binds,
+         p_rarch->keyboard_mapping_blocked,
+         0,
+         RETRO_DEVICE_JOYPAD,
+         0,
+         RETRO_DEVICE_ID_JOYPAD_MASK);
+
+   if ((buttons & ~st->buttons) && !st->pending)
+   {
+      st->pending   = true;
+      st->input     = cpu_features_get_time_usec();
+      st->input_run = st->run_start;
+      st->frame     = 0;
+      st->present   = 0;
+   }
+
+   st->buttons      = buttons;
+}
+
+static void input_remap_plan_compile(struct rarch_state *p_rarch,
+      settings_t *settings, unsigned max_users)
+{
+   unsigned i, j;
+#ifdef HAVE_MENU
+   bool menu_driver_alive        = p_rarch->menu_driver_alive;
+#else
+   bool menu_driver_alive        = false;
+#endif
+   bool input_remap_binds_enable = settings->bools.input_remap_binds_enable;
+
+   for (i = 0; i < MAX_USERS; i++)
+   {
+      input_remap_plan_t *plan          = &p_rarch->input_driver_remap_plan[i];
+      const struct retro_keybind *binds = p_rarch->libretro_input_binds[i];
+
+      plan->binds                       = 0;
+      plan->remapped                    = 0;
+      plan->overlay                     = 0;
+      plan->joypad_state                = 0;
+      plan->joypad_state_valid          = false;
+      plan->valid                       = (i < max_users) && binds;
+
+      if (!plan->valid)
+         continue;
+
+      for (j = 0; j < RARCH_FIRST_CUSTOM_BIND; j++)
+      {
+         unsigned remap_button = settings->uints.input_remap_ids[i][j];
+
+         if (binds[j].valid)
+         {
+            plan->binds        |= (1 << j);
+            if (j != remap_button)
+               plan->remapped  |= (1 << j);
+         }
+
+         /* See input_state_device() */
+         if (     menu_driver_alive
+               || !input_remap_binds_enable
+               || j == remap_button)
+            plan->overlay      |= (1 << j);
+      }
+   }
+}
+
 static void input_driver_poll(void)
 {
    size_t i, j;
@@ -21945,8 +23639,13 @@ static void input_driver_poll(void)
          && p_rarch->current_input->poll)
       p_rarch->current_input->poll(p_rarch->current_input_data);
 
+   if (settings->bools.video_latency_test)
+      latency_test_poll(p_rarch, settings, sec_joypad);
+
    p_rarch->input_driver_turbo_btns.count++;
 
+   input_remap_plan_compile(p_rarch, settings, max_users);
+
    if (p_rarch->input_driver_block_libretro_input)
    {
       for (i = 0; i < max_users; i++)
@@ -22320,6 +24019,9 @@ static void input_driver_poll(void)
 
          p_rarch->input_driver_command[i]->poll(
             p_rarch->input_driver_command[i]);
+
+         command_push_memory(p_rarch->input_driver_command[i],
+               p_rarch->video_driver_frame_count);
       }
    }
 #endif
@@ -22713,6 +24415,74 @@ static int16_t input_state_device(
    return res;
 }
 
+/* Same result as calling input_state_device() for each
+ * RetroPad button, taken from the remap plan compiled in
+ * input_driver_poll(). Returns false when the per button
+ * path is needed, i.e. while turbo is engaged or input
+ * comes from a remote RetroPad. */
+static bool input_state_joypad_plan(
+      struct rarch_state *p_rarch,
+      settings_t *settings,
+      rarch_joypad_info_t *joypad_info,
+      const input_device_driver_t *sec_joypad,
+      unsigned port,
+      unsigned id,
+      int16_t *res)
+{
+   uint32_t state;
+   input_remap_plan_t *plan = &p_rarch->input_driver_remap_plan[port];
+   turbo_buttons_t *turbo   = &p_rarch->input_driver_turbo_btns;
+
+   if (!plan->valid || turbo->frame_enable[port])
+      return false;
+#ifdef HAVE_NETWORKGAMEPAD
+   if (p_rarch->input_driver_remote)
+      return false;
+#endif
+
+   if (settings->uints.input_turbo_mode > INPUT_TURBO_MODE_CLASSIC)
+   {
+      if (turbo->mode1_enable[port])
+         return false;
+      turbo->turbo_pressed[port] &= ~(1 << 31);
+   }
+   else if (turbo->enable[port])
+      return false;
+
+   if (!plan->joypad_state_valid)
+   {
+      plan->joypad_state       = input_state_wrap(
+            p_rarch->current_input,
+            p_rarch->current_input_data,
+            p_rarch->joypad,
+            sec_joypad,
+            joypad_info,
+            p_rarch->libretro_input_binds,
+            p_rarch->keyboard_mapping_blocked,
+            port, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_MASK);
+      plan->joypad_state_valid = true;
+   }
+
+   state  = (uint16_t)plan->joypad_state & ~plan->remapped;
+   /* Single button queries never see unbound buttons */
+   if (id != RETRO_DEVICE_ID_JOYPAD_MASK)
+      state &= plan->binds;
+   state |= p_rarch->input_driver_mapper.buttons[port].data[0];
+#ifdef HAVE_OVERLAY
+   if (     (port == 0)
+         && p_rarch->overlay_ptr
+         && p_rarch->overlay_ptr->alive)
+      state |= p_rarch->overlay_ptr->overlay_state.buttons.data[0]
+         & plan->overlay;
+#endif
+
+   if (id != RETRO_DEVICE_ID_JOYPAD_MASK)
+      *res = (state >> id) & 1;
+   else
+      *res = (int16_t)(state & 0xFFFF);
+   return true;
+}
+
 static int16_t input_state_internal(unsigned port, unsigned device,
       unsigned idx, unsigned id)
 {
@@ -22775,6 +24545,17 @@ static int16_t input_state_internal(unsigned port, unsigned device,
             break;
       }
 
+      /* RetroPad buttons are served from the remap plan */
+      if (     (device == RETRO_DEVICE_JOYPAD)
+            && (bitmask_enabled || id < RARCH_FIRST_CUSTOM_BIND)
+            && !input_blocked
+            && input_state_joypad_plan(p_rarch, settings,
+               &joypad_info, sec_joypad, mapped_port, id, &port_result))
+      {
+         result |= port_result;
+         continue;
+      }
+
       /* TODO/FIXME: This code is gibberish - a mess of nested
        * refactors that make no sense whatsoever. The entire
        * thing needs to be rewritten from scratch... */
@@ -22892,15 +24673,6 @@ static int16_t input_state_internal(unsigned port, unsigned device,
          result |= port_result;
    }
 
-#ifdef HAVE_BSV_MOVIE
-   /* Save input to BSV record, if enabled */
-   if (BSV_MOVIE_IS_PLAYBACK_OFF())
-   {
-      result = swap_if_big16(result);
-      intfstream_write(p_rarch->bsv_movie_state_handle->file, &result, 2);
-   }
-#endif
-
    return result;
 }
 
@@ -22926,8 +24698,20 @@ static int16_t input_state(unsigned port, unsigned device,
    /* Load input from BSV record, if enabled */
    if (BSV_MOVIE_IS_PLAYBACK_ON())
    {
-      int16_t bsv_result = 0;
-      if (intfstream_read(p_rarch->bsv_movie_state_handle->file, &bsv_result, 2) == 2)
+      int16_t bsv_result  = 0;
+      bsv_movie_t *handle = p_rarch->bsv_movie_state_handle;
+
+      if (handle->stream)
+      {
+         if (bsv_stream_read_input(handle->stream, &bsv_result))
+         {
+#ifdef HAVE_CHEEVOS
+            rcheevos_pause_hardcore();
+#endif
+            return bsv_result;
+         }
+      }
+      else if (intfstream_read(handle->file, &bsv_result, 2) == 2)
       {
 #ifdef HAVE_CHEEVOS
          rcheevos_pause_hardcore();
@@ -22952,10 +24736,7 @@ static int16_t input_state(unsigned port, unsigned device,
 #ifdef HAVE_BSV_MOVIE
    /* Save input to BSV record, if enabled */
    if (BSV_MOVIE_IS_PLAYBACK_OFF())
-   {
-      result = swap_if_big16(result);
-      intfstream_write(p_rarch->bsv_movie_state_handle->file, &result, 2);
-   }
+      bsv_stream_write_input(p_rarch->bsv_movie_state_handle->stream, result);
 #endif
 
    return result;
@@ -28063,6 +29844,7 @@ static bool audio_driver_init_internal(
 
    p_rarch->audio_driver_output_samples_buf = (float*)samples_buf;
    p_rarch->audio_driver_control            = false;
+   p_rarch->audio_driver_control_adaptive   = false;
 
    if (
          !audio_cb_inited
@@ -28078,6 +29860,12 @@ static bool audio_driver_init_internal(
             p_rarch->current_audio->buffer_size(
                   p_rarch->audio_driver_context_audio_data);
          p_rarch->audio_driver_control     = true;
+         p_rarch->audio_driver_control_adaptive =
+            settings->bools.audio_rate_control_adaptive;
+         p_rarch->audio_driver_rate_control_avail =
+            (double)p_rarch->audio_driver_buffer_size *
+            (1.0 - AUDIO_RATE_CONTROL_ADAPTIVE_FILL);
+         p_rarch->audio_driver_rate_control_drift = 0.0;
       }
       else
          RARCH_WARN("[Audio]: Rate control was desired, but driver does not support needed features.\n");
@@ -28121,43 +29909,38 @@ static void audio_driver_flush(
       bool is_slowmotion, bool is_fastmotion)
 {
    struct resampler_data src_data;
+   size_t offset;
+   double ratio;
+   size_t output_frames              = 0;
+   float *output_buf                 = p_rarch->audio_driver_output_samples_buf;
+   int16_t *conv_buf                 = p_rarch->audio_driver_output_samples_conv_buf;
+   bool use_float                    = p_rarch->audio_driver_use_float;
+   /* audio_driver_sample() batches its input in conv_buf; converting
+    * a block to s16 could then overwrite input we haven't read yet */
+   bool convert_per_block            = !use_float && data != conv_buf;
+   retro_time_t bench_start          = p_rarch->benchmark.enable
+      ? cpu_features_get_time_usec() : 0;
+#ifdef HAVE_AUDIOMIXER
+   bool mixer_active                 = p_rarch->audio_mixer_active;
+   bool mixer_override               = true;
+   float mixer_gain                  = 0.0f;
+#endif
    float audio_volume_gain           = (p_rarch->audio_driver_mute_enable ||
          (audio_fastforward_mute && is_fastmotion)) ?
                0.0f : p_rarch->audio_driver_volume_gain;
 
-   src_data.data_out                 = NULL;
-   src_data.output_frames            = 0;
-
-   convert_s16_to_float(p_rarch->audio_driver_input_data, data, samples,
-         audio_volume_gain);
-
-   src_data.data_in                  = p_rarch->audio_driver_input_data;
-   src_data.input_frames             = samples >> 1;
-
-#ifdef HAVE_DSP_FILTER
-   if (p_rarch->audio_driver_dsp)
-   {
-      struct retro_dsp_data dsp_data;
-
-      dsp_data.input                 = NULL;
-      dsp_data.input_frames          = 0;
-      dsp_data.output                = NULL;
-      dsp_data.output_frames         = 0;
-
-      dsp_data.input                 = p_rarch->audio_driver_input_data;
-      dsp_data.input_frames          = (unsigned)(samples >> 1);
-
-      retro_dsp_filter_process(p_rarch->audio_driver_dsp, &dsp_data);
-
-      if (dsp_data.output)
-      {
-         src_data.data_in            = dsp_data.output;
-         src_data.input_frames       = dsp_data.output_frames;
-      }
-   }
+   /* Muted fast-forward: nothing would be heard, and audio
+    * is nonblocking meanwhile, so skip DSP, resampling and
+    * the write altogether */
+   if (     audio_fastforward_mute
+         && is_fastmotion
+#ifdef HAVE_AUDIOMIXER
+         && !mixer_active
 #endif
+      )
+      return;
 
-   src_data.data_out                 = p_rarch->audio_driver_output_samples_buf;
+   perf_trace_begin("audio_driver_flush");
 
    if (p_rarch->audio_driver_control)
    {
@@ -28165,8 +29948,11 @@ static void audio_driver_flush(
       int      half_size           =
          (int)(p_rarch->audio_driver_buffer_size / 2);
       int      avail               =
-         (int)p_rarch->current_audio->write_avail(
-               p_rarch->audio_driver_context_audio_data);
+         (int)(p_rarch->current_audio->measured_write_avail
+               ? p_rarch->current_audio->measured_write_avail(
+                     p_rarch->audio_driver_context_audio_data)
+               : p_rarch->current_audio->write_avail(
+                     p_rarch->audio_driver_context_audio_data));
       int      delta_mid           = avail - half_size;
       double   direction           = (double)delta_mid / half_size;
       double   adjust              = 1.0 +
@@ -28175,6 +29961,46 @@ static void audio_driver_flush(
          p_rarch->audio_driver_free_samples_count++ &
          (AUDIO_BUFFER_FREE_SAMPLES_COUNT - 1);
 
+      if (p_rarch->audio_driver_control_adaptive)
+      {
+         /* PI controller around a lower fill level. The
+          * proportional part reacts to jitter as above; the
+          * integral part converges on the actual clock drift,
+          * which otherwise has to be paid for with a standing
+          * offset from the target. */
+         double delta    = p_rarch->audio_driver_rate_control_delta;
+         double size     = (double)p_rarch->audio_driver_buffer_size;
+         double target   = size * (1.0 - AUDIO_RATE_CONTROL_ADAPTIVE_FILL);
+         double drift    = p_rarch->audio_driver_rate_control_drift;
+         double error;
+
+         /* Writes wake up in bursts relative to the device,
+          * only the trend of write_avail is of interest */
+         p_rarch->audio_driver_rate_control_avail +=
+            (avail - p_rarch->audio_driver_rate_control_avail) / 8.0;
+
+         /* Normalise against the distance to the relevant
+          * edge, so that an empty and a full buffer both
+          * map to the full delta */
+         error = p_rarch->audio_driver_rate_control_avail - target;
+         error = (error > 0.0)
+            ? error / (size - target)
+            : error / target;
+
+         /* Fast/slow motion deliberately run off-rate */
+         if (!is_slowmotion && !is_fastmotion)
+         {
+            drift += delta * error / AUDIO_RATE_CONTROL_ADAPTIVE_PERIOD;
+            if (drift > delta)
+               drift = delta;
+            else if (drift < -delta)
+               drift = -delta;
+            p_rarch->audio_driver_rate_control_drift = drift;
+         }
+
+         adjust = 1.0 + drift + delta * error;
+      }
+
       p_rarch->audio_driver_free_samples_buf
          [write_idx]                        = avail;
       p_rarch->audio_source_ratio_current   =
@@ -28193,10 +30019,10 @@ static void audio_driver_flush(
 #endif
    }
 
-   src_data.ratio           = p_rarch->audio_source_ratio_current;
+   ratio                    = p_rarch->audio_source_ratio_current;
 
    if (is_slowmotion)
-      src_data.ratio       *= slowmotion_ratio;
+      ratio                *= slowmotion_ratio;
 
    /* Note: Ideally we would divide by the user-configured
     * 'fastforward_ratio' when fast forward is enabled,
@@ -28215,50 +30041,98 @@ static void audio_driver_flush(
     * trying to do anything. Just leave the ratio as-is,
     * and hope for the best... */
 
-   p_rarch->audio_driver_resampler->process(
-         p_rarch->audio_driver_resampler_data, &src_data);
-
 #ifdef HAVE_AUDIOMIXER
-   if (p_rarch->audio_mixer_active)
+   if (mixer_active && !p_rarch->audio_driver_mixer_mute_enable)
    {
-      bool override                       = true;
-      float mixer_gain                    = 0.0f;
-      bool audio_driver_mixer_mute_enable =
-         p_rarch->audio_driver_mixer_mute_enable;
+      if (p_rarch->audio_driver_mixer_volume_gain == 1.0f)
+         mixer_override   = false;
+      mixer_gain          = p_rarch->audio_driver_mixer_volume_gain;
+   }
+#endif
+
+   /* Every stage below is streaming, so rather than making one pass
+    * over the whole buffer per stage, run all of them on one block
+    * at a time while it is still in cache. */
+   for (offset = 0; offset < samples; offset += AUDIO_FLUSH_BLOCK_SAMPLES)
+   {
+      size_t block_samples           = samples - offset;
+      float *block_out               = output_buf + output_frames * 2;
+
+      if (block_samples > AUDIO_FLUSH_BLOCK_SAMPLES)
+         block_samples               = AUDIO_FLUSH_BLOCK_SAMPLES;
+
+      convert_s16_to_float(p_rarch->audio_driver_input_data,
+            data + offset, block_samples, audio_volume_gain);
 
-      if (!audio_driver_mixer_mute_enable)
+      src_data.data_in               = p_rarch->audio_driver_input_data;
+      src_data.input_frames          = block_samples >> 1;
+
+#ifdef HAVE_DSP_FILTER
+      if (p_rarch->audio_driver_dsp)
       {
-         if (p_rarch->audio_driver_mixer_volume_gain == 1.0f)
-            override                      = false;
-         mixer_gain                       =
-            p_rarch->audio_driver_mixer_volume_gain;
+         struct retro_dsp_data dsp_data;
+
+         dsp_data.input              = p_rarch->audio_driver_input_data;
+         dsp_data.input_frames       = (unsigned)(block_samples >> 1);
+         dsp_data.output             = NULL;
+         dsp_data.output_frames      = 0;
+
+         retro_dsp_filter_process(p_rarch->audio_driver_dsp, &dsp_data);
+
+         if (dsp_data.output)
+         {
+            src_data.data_in         = dsp_data.output;
+            src_data.input_frames    = dsp_data.output_frames;
+         }
       }
-      audio_mixer_mix(
-            p_rarch->audio_driver_output_samples_buf,
-            src_data.output_frames, mixer_gain, override);
-   }
 #endif
 
+      src_data.data_out              = block_out;
+      src_data.output_frames         = 0;
+      src_data.ratio                 = ratio;
+
+      p_rarch->audio_driver_resampler->process(
+            p_rarch->audio_driver_resampler_data, &src_data);
+
+#ifdef HAVE_AUDIOMIXER
+      if (mixer_active)
+         audio_mixer_mix(block_out,
+               src_data.output_frames, mixer_gain, mixer_override);
+#endif
+
+      if (convert_per_block)
+         convert_float_to_s16(conv_buf + output_frames * 2,
+               block_out, src_data.output_frames * 2);
+
+      output_frames                 += src_data.output_frames;
+   }
+
    {
-      const void *output_data = p_rarch->audio_driver_output_samples_buf;
-      unsigned output_frames  = (unsigned)src_data.output_frames;
+      const void *output_data = output_buf;
+      size_t output_size      = output_frames * 2;
 
-      if (p_rarch->audio_driver_use_float)
-         output_frames       *= sizeof(float);
+      if (use_float)
+         output_size         *= sizeof(float);
       else
       {
-         convert_float_to_s16(p_rarch->audio_driver_output_samples_conv_buf,
-               (const float*)output_data, output_frames * 2);
+         if (!convert_per_block)
+            convert_float_to_s16(conv_buf, output_buf, output_frames * 2);
 
-         output_data          = p_rarch->audio_driver_output_samples_conv_buf;
-         output_frames       *= sizeof(int16_t);
+         output_data          = conv_buf;
+         output_size         *= sizeof(int16_t);
       }
 
       if (p_rarch->current_audio->write(
                p_rarch->audio_driver_context_audio_data,
-               output_data, output_frames * 2) < 0)
+               output_data, output_size) < 0)
          p_rarch->audio_driver_active = false;
    }
+
+   perf_trace_end("audio_driver_flush");
+
+   if (bench_start)
+      p_rarch->benchmark.frame[BENCHMARK_AUDIO] +=
+         cpu_features_get_time_usec() - bench_start;
 }
 
 /**
@@ -29686,7 +31560,7 @@ static void video_driver_filter_free(void)
 #ifdef _3DS
       linearFree(p_rarch->video_driver_state_buffer);
 #else
-      free(p_rarch->video_driver_state_buffer);
+      memalign_free(p_rarch->video_driver_state_buffer);
 #endif
    }
    p_rarch->video_driver_state_buffer    = NULL;
@@ -29759,13 +31633,13 @@ static void video_driver_init_filter(enum retro_pixel_format colfmt_int,
       sizeof(uint32_t)             :
       sizeof(uint16_t);
 
-   /* TODO: Aligned output. */
+   /* Rows are padded so each one starts aligned for the filter */
 #ifdef _3DS
-   buf = linearMemAlign(
-         width * height * p_rarch->video_driver_state_out_bpp, 0x80);
+   buf = linearMemAlign(rarch_softfilter_get_output_stride(
+            p_rarch->video_driver_state_filter, width) * height, 0x80);
 #else
-   buf = malloc(
-         width * height * p_rarch->video_driver_state_out_bpp);
+   buf = memalign_alloc(64, rarch_softfilter_get_output_stride(
+            p_rarch->video_driver_state_filter, width) * height);
 #endif
    if (!buf)
    {
@@ -29776,6 +31650,50 @@ static void video_driver_init_filter(enum retro_pixel_format colfmt_int,
 
    p_rarch->video_driver_state_buffer    = buf;
 }
+
+/* Replaces the video filter with the one set in
+ * settings without reinitialising the video driver.
+ * That only works as long as the new filter's output
+ * has the pixel format the driver was set up for and
+ * fits in its textures.
+ *
+ * Returns: false if the drivers need to be
+ * reinitialised to apply the new filter. */
+static bool video_driver_swap_filter(struct rarch_state *p_rarch,
+      settings_t *settings)
+{
+   unsigned scale;
+   bool rgb32;
+   struct retro_game_geometry *geom = &p_rarch->video_driver_av_info.geometry;
+
+   if (!p_rarch->video_driver_active || !p_rarch->video_driver_data)
+      return false;
+
+   video_driver_filter_free();
+
+   if (!string_is_empty(settings->paths.path_softfilter_plugin))
+      video_driver_init_filter(p_rarch->video_driver_pix_fmt, settings);
+
+   if (p_rarch->video_driver_state_filter)
+   {
+      scale = p_rarch->video_driver_state_scale;
+      rgb32 = p_rarch->video_driver_state_out_rgb32;
+   }
+   else
+   {
+      scale = next_pow2(MAX(geom->max_width, geom->max_height))
+         / RARCH_SCALE_BASE;
+      scale = MAX(scale, 1);
+      rgb32 = p_rarch->video_driver_pix_fmt == RETRO_PIXEL_FORMAT_XRGB8888;
+   }
+
+   if (     scale > p_rarch->video_driver_input_scale
+         || rgb32 != p_rarch->video_driver_input_rgb32)
+      return false;
+
+   RARCH_LOG("[Video]: Swapped video filter in place.\n");
+   return true;
+}
 #endif
 
 static void video_driver_init_input(
@@ -29884,6 +31802,14 @@ static void video_driver_free_internal(struct rarch_state *p_rarch)
 
    command_event(CMD_EVENT_OVERLAY_DEINIT, NULL);
 
+   video_driver_texture_queue_flush(p_rarch, false);
+
+#ifdef HAVE_VIDEO_FRAME_EXPORT
+   video_frame_export_free(p_rarch->video_frame_export);
+   p_rarch->video_frame_export        = NULL;
+   p_rarch->video_frame_export_failed = false;
+#endif
+
    if (!video_driver_is_video_cache_context())
       video_driver_free_hw_context(p_rarch);
 
@@ -29909,9 +31835,15 @@ static void video_driver_free_internal(struct rarch_state *p_rarch)
          && p_rarch->current_video->free)
       p_rarch->current_video->free(p_rarch->video_driver_data);
 
+   video_driver_gpu_mem_clear(&p_rarch->video_driver_gpu_mem);
+
    if (p_rarch->video_driver_scaler_ptr)
       video_driver_pixel_converter_free(p_rarch->video_driver_scaler_ptr);
    p_rarch->video_driver_scaler_ptr = NULL;
+
+   free(p_rarch->latency_test.mark_buffer);
+   p_rarch->latency_test.mark_buffer      = NULL;
+   p_rarch->latency_test.mark_buffer_size = 0;
 #ifdef HAVE_VIDEO_FILTER
    video_driver_filter_free();
 #endif
@@ -30255,6 +32187,10 @@ static bool video_driver_init_internal(
    video.parent                      = 0;
 
    p_rarch->video_started_fullscreen = video.fullscreen;
+#ifdef HAVE_VIDEO_FILTER
+   p_rarch->video_driver_input_scale = video.input_scale;
+   p_rarch->video_driver_input_rgb32 = video.rgb32;
+#endif
 
    /* Reset video frame count */
    p_rarch->video_driver_frame_count = 0;
@@ -31370,6 +33306,285 @@ struct video_viewport *video_viewport_get_custom(void)
  *
  * Video frame render callback function.
  **/
+/**
+ * latency_test_mark_frame:
+ *
+ * Copies a software rendered frame and draws a white
+ * square into the top left corner of the copy. White
+ * has every bit set in all pixel formats.
+ *
+ * Returns: the marked copy, or @data if it can't be marked.
+ **/
+static const void *latency_test_mark_frame(
+      latency_test_state_t *st, const void *data,
+      unsigned width, unsigned height, size_t pitch,
+      enum retro_pixel_format pix_fmt)
+{
+   unsigned y;
+   uint8_t *mark;
+   size_t size         = pitch * height;
+   size_t mark_width   = MIN(width, LATENCY_TEST_MARK_SIZE);
+   unsigned mark_lines = MIN(height, LATENCY_TEST_MARK_SIZE);
+
+   if (!data || data == RETRO_HW_FRAME_BUFFER_VALID)
+      return data;
+
+   if (size > st->mark_buffer_size)
+   {
+      uint8_t *tmp = (uint8_t*)realloc(st->mark_buffer, size);
+      if (!tmp)
+         return data;
+      st->mark_buffer      = tmp;
+      st->mark_buffer_size = size;
+   }
+
+   mark_width *= (pix_fmt == RETRO_PIXEL_FORMAT_XRGB8888)
+      ? sizeof(uint32_t) : sizeof(uint16_t);
+
+   memcpy(st->mark_buffer, data, size);
+   for (y = 0, mark = st->mark_buffer; y < mark_lines; y++, mark += pitch)
+      memset(mark, 0xFF, mark_width);
+
+   return st->mark_buffer;
+}
+
+/**
+ * video_driver_frame_telemetry:
+ * @now                  : time at which the driver's frame() returned.
+ *
+ * Adds a record for the frame the video driver
+ * was just handed to the frame telemetry ring.
+ **/
+static void video_driver_frame_telemetry(
+      struct rarch_state *p_rarch,
+      settings_t *settings,
+      retro_time_t now)
+{
+   const frame_telemetry_t *prev             = NULL;
+   frame_telemetry_t *rec                    = &p_rarch->frame_telemetry[
+      p_rarch->frame_telemetry_count & (FRAME_TELEMETRY_COUNT - 1)];
+   retro_time_t start                        = p_rarch->frame_telemetry_start;
+   const video_poke_interface_t *video_poke  = p_rarch->video_driver_poke;
+
+   if (p_rarch->frame_telemetry_count)
+      prev = &p_rarch->frame_telemetry[
+         (p_rarch->frame_telemetry_count - 1) & (FRAME_TELEMETRY_COUNT - 1)];
+
+   /* Frames without a core_run() in between (menu,
+    * pause) count from the previous frame instead */
+   if (prev && prev->time > start)
+      start                = prev->time;
+
+   rec->frame              = p_rarch->video_driver_frame_count;
+   rec->time               = now;
+   rec->cpu_time           = start ? now - start : -1;
+   rec->present_interval   = prev ? now - prev->time : -1;
+   rec->gpu_time           = -1;
+   rec->queue_depth        = -1;
+   rec->missed_vsyncs      = 0;
+
+   if (     rec->present_interval > 0
+         && settings->bools.video_vsync
+         && !p_rarch->input_driver_nonblock_state
+         && settings->floats.video_refresh_rate > 0.0f)
+   {
+      unsigned swap_interval = MAX(settings->uints.video_swap_interval, 1);
+      retro_time_t period    = (retro_time_t)(1000000.0f * swap_interval
+            / settings->floats.video_refresh_rate);
+      /* Intervals are rounded to the nearest multiple of the period */
+      retro_time_t periods   = (rec->present_interval + period / 2) / period;
+
+      if (periods > 1)
+         rec->missed_vsyncs  = (unsigned)(periods - 1);
+   }
+
+   if (video_poke && video_poke->get_gpu_timing)
+      video_poke->get_gpu_timing(p_rarch->video_driver_data,
+            &rec->gpu_time, &rec->queue_depth);
+
+   p_rarch->frame_telemetry_count++;
+}
+
+/**
+ * video_driver_shader_pass_timing:
+ *
+ * Adds the GPU time of each shader pass reported by
+ * the video driver to the running averages.
+ **/
+static void video_driver_shader_pass_timing(
+      struct rarch_state *p_rarch)
+{
+   unsigned i, passes;
+   retro_time_t pass_time[GFX_MAX_SHADERS];
+   shader_pass_timing_t *st                  = &p_rarch->shader_pass_timing;
+   const video_poke_interface_t *video_poke  = p_rarch->video_driver_poke;
+
+   if (!video_poke || !video_poke->get_shader_pass_timings)
+      passes = 0;
+   else
+      passes = video_poke->get_shader_pass_timings(
+            p_rarch->video_driver_data, pass_time, GFX_MAX_SHADERS);
+
+   /* Start over whenever the preset changes shape */
+   if (passes != st->passes)
+   {
+      for (i = 0; i < GFX_MAX_SHADERS; i++)
+      {
+         st->sum[i]     = 0;
+         st->samples[i] = 0;
+         st->average[i] = -1;
+      }
+      st->frames        = 0;
+      st->passes        = passes;
+   }
+
+   if (!passes)
+      return;
+
+   for (i = 0; i < passes; i++)
+   {
+      if (pass_time[i] < 0)
+         continue;
+      st->sum[i]        += pass_time[i];
+      st->samples[i]++;
+   }
+
+   if (++st->frames < SHADER_PASS_TIMING_WINDOW)
+      return;
+
+   for (i = 0; i < passes; i++)
+   {
+      if (st->samples[i])
+         st->average[i] = st->sum[i] / st->samples[i];
+      st->sum[i]        = 0;
+      st->samples[i]    = 0;
+   }
+   st->frames           = 0;
+}
+
+retro_time_t video_driver_get_shader_pass_time(unsigned pass)
+{
+   struct rarch_state *p_rarch = &rarch_st;
+   shader_pass_timing_t *st    = &p_rarch->shader_pass_timing;
+
+   if (pass >= st->passes)
+      return -1;
+   return st->average[pass];
+}
+
+#ifdef HAVE_VIDEO_FRAME_EXPORT
+/* Publishes the core's frame for other processes,
+ * if enabled, (re)creating the export as needed */
+static void video_driver_frame_export(struct rarch_state *p_rarch,
+      const void *data, unsigned width, unsigned height,
+      size_t pitch, enum retro_pixel_format fmt)
+{
+   size_t size;
+   struct retro_game_geometry *geom = NULL;
+   settings_t *settings             = p_rarch->configuration_settings;
+
+   if (!settings->bools.video_frame_export)
+   {
+      video_frame_export_free(p_rarch->video_frame_export);
+      p_rarch->video_frame_export        = NULL;
+      p_rarch->video_frame_export_failed = false;
+      return;
+   }
+
+   /* Dupes have already been published, and hardware
+    * rendered frames never reach us */
+   if (!data || data == RETRO_HW_FRAME_BUFFER_VALID)
+      return;
+
+   if (video_frame_export_push(p_rarch->video_frame_export,
+            data, width, height, pitch, fmt))
+      return;
+
+   /* Not created yet, or the frame has outgrown it */
+   if (p_rarch->video_frame_export_failed)
+      return;
+
+   geom = &p_rarch->video_driver_av_info.geometry;
+   size = (size_t)geom->max_width * geom->max_height
+      * (fmt == RETRO_PIXEL_FORMAT_XRGB8888 ? 4 : 2);
+   if (size < (size_t)height * pitch)
+      size = (size_t)height * pitch;
+
+   video_frame_export_free(p_rarch->video_frame_export);
+   p_rarch->video_frame_export        = video_frame_export_new(
+         VIDEO_FRAME_EXPORT_PATH, size);
+   p_rarch->video_frame_export_failed = !p_rarch->video_frame_export;
+
+   video_frame_export_push(p_rarch->video_frame_export,
+         data, width, height, pitch, fmt);
+}
+#endif
+
+/* While fast-forwarding most frames would never make it
+ * to the screen anyway. Returns true for those that are
+ * not to be presented: all but every Nth one, or with an
+ * interval of 0 all but one per display refresh. */
+static bool video_driver_fastforward_skip_frame(
+      struct rarch_state *p_rarch, settings_t *settings,
+      retro_time_t current_time)
+{
+   unsigned interval = settings->uints.fastforward_frameskip_interval;
+   float refresh_rate;
+
+   if (     !settings->bools.fastforward_frameskip
+         || !runloop_state.fastmotion
+         ||  runloop_state.paused
+#ifdef HAVE_MENU
+         ||  p_rarch->menu_driver_alive
+#endif
+         ||  p_rarch->recording_data)
+      return false;
+
+   if (interval)
+      return (p_rarch->fastforward_frameskip_count++ % interval) != 0;
+
+   refresh_rate = settings->floats.video_refresh_rate;
+   if (     refresh_rate > 0.0f
+         && current_time - p_rarch->fastforward_frameskip_last
+            < (retro_time_t)(1000000.0f / refresh_rate))
+      return true;
+
+   p_rarch->fastforward_frameskip_last = current_time;
+   return false;
+}
+
+#ifdef HAVE_RUNAHEAD
+/* Takes the frames output while detecting lag frames,
+ * none of which are shown */
+static void runahead_probe_frame(runahead_probe_state_t *probe,
+      const void *data, unsigned width, unsigned height, size_t pitch,
+      enum retro_pixel_format fmt)
+{
+   unsigned y;
+   size_t row_size;
+   uint32_t hash       = 0;
+   const uint8_t *src  = (const uint8_t*)data;
+
+   /* Dupes leave the hash of the previous frame */
+   if (!data)
+      return;
+
+   if (data == RETRO_HW_FRAME_BUFFER_VALID)
+   {
+      probe->hw_frame  = true;
+      return;
+   }
+
+   row_size            = width *
+      (fmt == RETRO_PIXEL_FORMAT_XRGB8888 ? 4 : 2);
+
+   for (y = 0; y < height; y++, src += pitch)
+      hash             = encoding_crc32(hash, src, row_size);
+
+   probe->last_hash    = hash;
+}
+#endif
+
 static void video_driver_frame(const void *data, unsigned width,
       unsigned height, size_t pitch)
 {
@@ -31393,17 +33608,52 @@ static void video_driver_frame(const void *data, unsigned width,
    status_text[0]               = '\0';
    video_driver_msg[0]          = '\0';
 
+#ifdef HAVE_RUNAHEAD
+   if (p_rarch->runahead_probe.hashing)
+   {
+      runahead_probe_frame(&p_rarch->runahead_probe,
+            data, width, height, pitch, video_driver_pix_fmt);
+      return;
+   }
+#endif
+
    if (!video_driver_active)
       return;
 
    new_time                     = cpu_features_get_time_usec();
 
+   /* Time at which the core finished its first frame of
+    * this iteration, used by the automatic frame delay */
+   if (     p_rarch->frame_delay_auto.run_start
+         && !p_rarch->frame_delay_auto.core_end)
+      p_rarch->frame_delay_auto.core_end = new_time;
+
    if (data)
       p_rarch->frame_cache_data = data;
    p_rarch->frame_cache_width   = width;
    p_rarch->frame_cache_height  = height;
    p_rarch->frame_cache_pitch   = pitch;
 
+   /* Skipped frames stay cached, for the menu and screenshots */
+   if (video_driver_fastforward_skip_frame(p_rarch,
+            p_rarch->configuration_settings, new_time))
+      return;
+
+   /* Only the frame on screen is marked,
+    * not the one re-used by frame dupes */
+   if (     p_rarch->latency_test.pending
+         && !p_rarch->latency_test.frame)
+   {
+      p_rarch->latency_test.frame = new_time;
+      data = latency_test_mark_frame(&p_rarch->latency_test,
+            data, width, height, pitch, video_driver_pix_fmt);
+   }
+
+#ifdef HAVE_VIDEO_FRAME_EXPORT
+   video_driver_frame_export(p_rarch, data, width, height,
+         pitch, video_driver_pix_fmt);
+#endif
+
    if (
             p_rarch->video_driver_scaler_ptr
          && data
@@ -31583,7 +33833,8 @@ static void video_driver_frame(const void *data, unsigned width,
       rarch_softfilter_get_output_size(p_rarch->video_driver_state_filter,
             &output_width, &output_height, width, height);
 
-      output_pitch = (output_width) * p_rarch->video_driver_state_out_bpp;
+      output_pitch = (unsigned)rarch_softfilter_get_output_stride(
+            p_rarch->video_driver_state_filter, output_width);
 
       rarch_softfilter_process(p_rarch->video_driver_state_filter,
             p_rarch->video_driver_state_buffer, output_pitch,
@@ -31619,12 +33870,10 @@ static void video_driver_frame(const void *data, unsigned width,
          msg_queue_entry_t msg_entry;
          bool msg_found = false;
 
-         RUNLOOP_MSG_QUEUE_LOCK(runloop_state);
          msg_found                       = msg_queue_extract(
                &runloop_state.msg_queue, &msg_entry);
          runloop_state.msg_queue_size = msg_queue_size(
                &runloop_state.msg_queue);
-         RUNLOOP_MSG_QUEUE_UNLOCK(runloop_state);
 
          if (msg_found)
             gfx_widgets_msg_queue_push(
@@ -31651,13 +33900,11 @@ static void video_driver_frame(const void *data, unsigned width,
       if (video_info.font_enable)
 #endif
       {
-         const char *msg                 = NULL;
-         RUNLOOP_MSG_QUEUE_LOCK(runloop_state);
-         msg                             = msg_queue_pull(&runloop_state.msg_queue);
+         const char *msg                 = msg_queue_pull(
+               &runloop_state.msg_queue);
          runloop_state.msg_queue_size = msg_queue_size(&runloop_state.msg_queue);
          if (msg)
             strlcpy(video_driver_msg, msg, sizeof(video_driver_msg));
-         RUNLOOP_MSG_QUEUE_UNLOCK(runloop_state);
       }
    }
 
@@ -31718,15 +33965,97 @@ static void video_driver_frame(const void *data, unsigned width,
             av_info->timing.fps,
             av_info->timing.sample_rate);
 
+#ifdef HAVE_NETWORKING
+      if (p_rarch->netplay_data && p_rarch->netplay_data->is_connected)
+      {
+         netplay_t *netplay = p_rarch->netplay_data;
+         size_t       len   = strlen(video_info.stat_text);
+
+         snprintf(video_info.stat_text + len,
+               sizeof(video_info.stat_text) - len,
+               "Netplay Statistics:\n -Input latency: %d frames\n -Rollback depth: %u frames\n"
+               " -Resimulation cost: %.2f ms/frame\n -Last replay: %u frames, %.2f ms\n",
+               netplay->input_latency_frames,
+               (unsigned)netplay->rollback_max_frames,
+               netplay->frame_run_time_avg / 1000.0f,
+               (unsigned)netplay->replay_frames_last,
+               netplay->replay_time_last / 1000.0f);
+      }
+#endif
+
+      {
+         video_gpu_mem_state_t *st = &p_rarch->video_driver_gpu_mem;
+         size_t len = strlen(video_info.stat_text);
+
+         snprintf(video_info.stat_text + len,
+               sizeof(video_info.stat_text) - len,
+               "GPU Memory:\n -Textures: %.1f MB\n -Thumbnails: %.1f MB\n"
+               " -Overlays: %.1f MB\n -Shaders: %.1f MB\n",
+               st->usage[VIDEO_GPU_MEM_TEXTURES]   / (1024.0f * 1024.0f),
+               st->usage[VIDEO_GPU_MEM_THUMBNAILS] / (1024.0f * 1024.0f),
+               st->usage[VIDEO_GPU_MEM_OVERLAYS]   / (1024.0f * 1024.0f),
+               st->usage[VIDEO_GPU_MEM_SHADERS]    / (1024.0f * 1024.0f));
+      }
+
+      if (p_rarch->shader_pass_timing.passes)
+      {
+         unsigned i;
+         size_t len = strlcat(video_info.stat_text, "Shader Passes:\n",
+               sizeof(video_info.stat_text));
+
+         for (i = 0; i < p_rarch->shader_pass_timing.passes
+               && len < sizeof(video_info.stat_text); i++)
+         {
+            retro_time_t pass_time = p_rarch->shader_pass_timing.average[i];
+
+            if (pass_time < 0)
+               len += snprintf(video_info.stat_text + len,
+                     sizeof(video_info.stat_text) - len,
+                     " -#%u: N/A\n", i);
+            else
+               len += snprintf(video_info.stat_text + len,
+                     sizeof(video_info.stat_text) - len,
+                     " -#%u: %.2f ms\n", i, pass_time / 1000.0f);
+         }
+      }
+
       /* TODO/FIXME - add OSD chat text here */
    }
 
+   video_driver_texture_queue_flush(p_rarch, true);
+
+   /* The video thread does this itself */
+   if (!VIDEO_DRIVER_IS_THREADED_INTERNAL())
+      gfx_display_frame_reset();
+
+   perf_trace_begin("video_driver_frame");
    if (p_rarch->current_video && p_rarch->current_video->frame)
       p_rarch->video_driver_active = p_rarch->current_video->frame(
             p_rarch->video_driver_data, data, width, height,
             p_rarch->video_driver_frame_count, (unsigned)pitch,
             video_info.menu_screensaver_active ? "" : video_driver_msg,
             &video_info);
+   perf_trace_end("video_driver_frame");
+   perf_boot_first_frame();
+
+   /* Drivers swap (or hand the frame to their
+    * thread) before returning */
+   {
+      retro_time_t present = cpu_features_get_time_usec();
+
+      if (     p_rarch->latency_test.frame
+            && !p_rarch->latency_test.present)
+         p_rarch->latency_test.present = present;
+
+      if (p_rarch->benchmark.enable)
+         p_rarch->benchmark.frame[BENCHMARK_VIDEO] += present - new_time;
+
+      video_driver_frame_telemetry(p_rarch,
+            p_rarch->configuration_settings, present);
+      video_driver_shader_pass_timing(p_rarch);
+      video_driver_gpu_mem_update(p_rarch,
+            p_rarch->configuration_settings);
+   }
 
    p_rarch->video_driver_frame_count++;
 
@@ -31855,6 +34184,195 @@ uintptr_t video_driver_window_get(void)
    return p_rarch->video_driver_window;
 }
 
+/* GPU memory accounting */
+
+/* Estimated GPU memory used by a texture,
+ * including its mipmap chain */
+static size_t video_driver_texture_size(
+      const struct texture_image *img,
+      enum texture_filter_type filter_type)
+{
+   size_t size = (size_t)img->width * img->height * sizeof(uint32_t);
+
+   if (     filter_type == TEXTURE_FILTER_MIPMAP_LINEAR
+         || filter_type == TEXTURE_FILTER_MIPMAP_NEAREST)
+      size = size * 4 / 3;
+
+   return size;
+}
+
+static video_gpu_mem_texture_t *video_driver_gpu_mem_find(
+      video_gpu_mem_state_t *st, uintptr_t id)
+{
+   size_t i;
+
+   for (i = 0; i < st->textures_count; i++)
+      if (st->textures[i].id == id)
+         return &st->textures[i];
+
+   return NULL;
+}
+
+static void video_driver_gpu_mem_track(video_gpu_mem_state_t *st,
+      uintptr_t id, const struct texture_image *img,
+      enum texture_filter_type filter_type)
+{
+   video_gpu_mem_texture_t *tex = NULL;
+
+   if (!id || !img)
+      return;
+
+   if (st->textures_count == st->textures_cap)
+   {
+      size_t cap                       = st->textures_cap
+         ? st->textures_cap * 2 : 64;
+      video_gpu_mem_texture_t *textures = (video_gpu_mem_texture_t*)
+         realloc(st->textures, cap * sizeof(*textures));
+
+      if (!textures)
+         return;
+
+      st->textures     = textures;
+      st->textures_cap = cap;
+   }
+
+   tex                   = &st->textures[st->textures_count++];
+   tex->id               = id;
+   tex->size             = video_driver_texture_size(img, filter_type);
+   tex->type             = VIDEO_GPU_MEM_TEXTURES;
+   st->usage[tex->type] += tex->size;
+}
+
+static void video_driver_gpu_mem_untrack(video_gpu_mem_state_t *st,
+      uintptr_t id)
+{
+   video_gpu_mem_texture_t *tex = video_driver_gpu_mem_find(st, id);
+
+   if (!tex)
+      return;
+
+   st->usage[tex->type] -= tex->size;
+   *tex = st->textures[--st->textures_count];
+}
+
+/* The driver's textures go away with it */
+static void video_driver_gpu_mem_clear(video_gpu_mem_state_t *st)
+{
+   unsigned i;
+
+   free(st->textures);
+   st->textures       = NULL;
+   st->textures_count = 0;
+   st->textures_cap   = 0;
+
+   for (i = 0; i < VIDEO_GPU_MEM_LAST; i++)
+      st->usage[i]    = 0;
+   st->over_budget    = false;
+}
+
+void video_driver_texture_set_gpu_mem_type(uintptr_t id,
+      enum video_gpu_mem_type type)
+{
+   struct rarch_state *p_rarch  = &rarch_st;
+   video_gpu_mem_state_t *st    = &p_rarch->video_driver_gpu_mem;
+   video_gpu_mem_texture_t *tex = video_driver_gpu_mem_find(st, id);
+
+   if (!tex || type >= VIDEO_GPU_MEM_LAST)
+      return;
+
+   st->usage[tex->type] -= tex->size;
+   st->usage[type]      += tex->size;
+   tex->type             = type;
+}
+
+size_t video_driver_get_gpu_mem_usage(enum video_gpu_mem_type type)
+{
+   unsigned i;
+   size_t total                = 0;
+   struct rarch_state *p_rarch = &rarch_st;
+   video_gpu_mem_state_t *st   = &p_rarch->video_driver_gpu_mem;
+
+   if (type < VIDEO_GPU_MEM_LAST)
+      return st->usage[type];
+
+   for (i = 0; i < VIDEO_GPU_MEM_LAST; i++)
+      total += st->usage[i];
+
+   return total;
+}
+
+bool video_driver_gpu_mem_over_budget(void)
+{
+   struct rarch_state *p_rarch = &rarch_st;
+   return p_rarch->video_driver_gpu_mem.over_budget;
+}
+
+enum texture_filter_type video_driver_gpu_mem_filter(
+      enum texture_filter_type filter)
+{
+   struct rarch_state *p_rarch = &rarch_st;
+
+   if (!p_rarch->video_driver_gpu_mem.over_budget)
+      return filter;
+
+   switch (filter)
+   {
+      case TEXTURE_FILTER_MIPMAP_LINEAR:
+         return TEXTURE_FILTER_LINEAR;
+      case TEXTURE_FILTER_MIPMAP_NEAREST:
+         return TEXTURE_FILTER_NEAREST;
+      default:
+         break;
+   }
+
+   return filter;
+}
+
+/**
+ * video_driver_gpu_mem_update:
+ *
+ * Picks up the shader preset's memory use and, once
+ * everything together exceeds the budget, has cached
+ * thumbnails that are not on screen unloaded.
+ **/
+static void video_driver_gpu_mem_update(
+      struct rarch_state *p_rarch, settings_t *settings)
+{
+   size_t total;
+   bool over_budget;
+   video_gpu_mem_state_t *st                 = &p_rarch->video_driver_gpu_mem;
+   const video_poke_interface_t *video_poke  = p_rarch->video_driver_poke;
+   size_t budget                             = (size_t)
+      settings->uints.video_gpu_memory_budget * 1024 * 1024;
+
+   st->usage[VIDEO_GPU_MEM_SHADERS] =
+      (video_poke && video_poke->get_shader_memory_usage)
+      ? video_poke->get_shader_memory_usage(p_rarch->video_driver_data)
+      : 0;
+
+   if (!budget)
+   {
+      st->over_budget = false;
+      return;
+   }
+
+   total = video_driver_get_gpu_mem_usage(VIDEO_GPU_MEM_LAST);
+
+   if (total > budget)
+   {
+      gfx_thumbnail_cache_trim(total - budget);
+      total = video_driver_get_gpu_mem_usage(VIDEO_GPU_MEM_LAST);
+   }
+
+   over_budget = total > budget;
+
+   if (over_budget && !st->over_budget)
+      RARCH_WARN("[Video]: GPU memory use (%u MB) is over budget (%u MB).\n",
+            (unsigned)(total >> 20), (unsigned)(budget >> 20));
+
+   st->over_budget = over_budget;
+}
+
 bool video_driver_texture_load(void *data,
       enum texture_filter_type  filter_type,
       uintptr_t *id)
@@ -31868,15 +34386,106 @@ bool video_driver_texture_load(void *data,
          p_rarch->video_driver_data, data,
          VIDEO_DRIVER_IS_THREADED_INTERNAL(),
          filter_type);
+   video_driver_gpu_mem_track(&p_rarch->video_driver_gpu_mem,
+         *id, (const struct texture_image*)data, filter_type);
    return true;
 }
 
+bool video_driver_texture_load_async(void *data,
+      enum texture_filter_type filter_type,
+      video_driver_texture_cb_t cb, void *userdata)
+{
+   struct rarch_state *p_rarch           = &rarch_st;
+   video_driver_texture_upload_t *upload = NULL;
+
+   if (!data || !cb)
+      return false;
+
+   if (p_rarch->video_driver_texture_queue_size
+         == p_rarch->video_driver_texture_queue_cap)
+   {
+      size_t cap = p_rarch->video_driver_texture_queue_cap
+         ? p_rarch->video_driver_texture_queue_cap * 2 : 16;
+      video_driver_texture_upload_t *queue =
+         (video_driver_texture_upload_t*)realloc(
+               p_rarch->video_driver_texture_queue,
+               cap * sizeof(*queue));
+
+      if (!queue)
+         return false;
+
+      p_rarch->video_driver_texture_queue     = queue;
+      p_rarch->video_driver_texture_queue_cap = cap;
+   }
+
+   upload              = &p_rarch->video_driver_texture_queue[
+      p_rarch->video_driver_texture_queue_size++];
+   upload->image       = data;
+   upload->userdata    = userdata;
+   upload->cb          = cb;
+   upload->id          = 0;
+   upload->filter_type = filter_type;
+   return true;
+}
+
+/* Hands all queued uploads to the driver (or, if 'load'
+ * is false, drops them) and reports back to their owners */
+static void video_driver_texture_queue_flush(
+      struct rarch_state *p_rarch, bool load)
+{
+   size_t i;
+   bool loaded                          = false;
+   size_t count                         =
+      p_rarch->video_driver_texture_queue_size;
+   video_driver_texture_upload_t *queue =
+      p_rarch->video_driver_texture_queue;
+
+   if (count == 0)
+      return;
+
+   /* Callbacks may queue more - those wait for the next frame */
+   p_rarch->video_driver_texture_queue      = NULL;
+   p_rarch->video_driver_texture_queue_size = 0;
+   p_rarch->video_driver_texture_queue_cap  = 0;
+
+   if (     load
+         && p_rarch->video_driver_poke
+         && p_rarch->video_driver_poke->load_texture)
+   {
+#ifdef HAVE_THREADS
+      if (VIDEO_DRIVER_IS_THREADED_INTERNAL())
+         loaded = video_thread_texture_load_batch(queue, count);
+      else
+#endif
+      {
+         for (i = 0; i < count; i++)
+            queue[i].id = p_rarch->video_driver_poke->load_texture(
+                  p_rarch->video_driver_data, queue[i].image,
+                  false, queue[i].filter_type);
+         loaded = true;
+      }
+   }
+
+   for (i = 0; i < count; i++)
+   {
+      if (loaded)
+         video_driver_gpu_mem_track(&p_rarch->video_driver_gpu_mem,
+               queue[i].id, (const struct texture_image*)queue[i].image,
+               queue[i].filter_type);
+      queue[i].cb(queue[i].userdata, queue[i].image,
+            loaded ? queue[i].id : 0, loaded);
+   }
+
+   free(queue);
+}
+
 bool video_driver_texture_unload(uintptr_t *id)
 {
    struct rarch_state *p_rarch = &rarch_st;
    if (     !p_rarch->video_driver_poke
          || !p_rarch->video_driver_poke->unload_texture)
       return false;
+   video_driver_gpu_mem_untrack(&p_rarch->video_driver_gpu_mem, *id);
    p_rarch->video_driver_poke->unload_texture(
          p_rarch->video_driver_data,
          VIDEO_DRIVER_IS_THREADED_INTERNAL(),
@@ -32536,6 +35145,20 @@ float video_driver_get_refresh_rate(void)
    return 0.0f;
 }
 
+void video_driver_set_present_timing(retro_time_t presented,
+      retro_time_t refresh_interval)
+{
+   struct rarch_state *p_rarch          = &rarch_st;
+   p_rarch->present_timing_last         = presented;
+   p_rarch->present_timing_interval     = refresh_interval;
+}
+
+void video_driver_set_present_composited(bool composited)
+{
+   struct rarch_state *p_rarch          = &rarch_st;
+   p_rarch->present_timing_composited   = composited;
+}
+
 #if defined(HAVE_GFX_WIDGETS)
 bool video_driver_has_widgets(void)
 {
@@ -33124,6 +35747,7 @@ static void drivers_init(struct rarch_state *p_rarch,
       bool video_is_fullscreen    = settings->bools.video_fullscreen ||
             rarch_force_fullscreen;
 
+      perf_boot_begin(PERF_BOOT_ASSETS);
       p_rarch->widgets_active     = gfx_widgets_init(
             &p_rarch->dispwidget_st,
             &p_rarch->dispgfx,
@@ -33136,6 +35760,7 @@ static void drivers_init(struct rarch_state *p_rarch,
             video_is_fullscreen,
             settings->paths.directory_assets,
             settings->paths.path_font);
+      perf_boot_end(PERF_BOOT_ASSETS);
    }
    else
 #endif
@@ -33149,6 +35774,11 @@ static void drivers_init(struct rarch_state *p_rarch,
       /* Initialize menu driver */
       if (flags & DRIVER_MENU_MASK)
       {
+         /* Favorites were skipped along with the menu */
+         if (p_rarch->menu_driver_deferred)
+            rarch_favorites_init();
+         p_rarch->menu_driver_deferred = false;
+
          if (!menu_driver_init(video_is_threaded))
              RARCH_ERR("Unable to init menu driver.\n");
 
@@ -33489,14 +36119,6 @@ static void mylist_resize(my_list *list,
    list->size = new_size;
 }
 
-static void *mylist_add_element(my_list *list)
-{
-   int old_size = list->size;
-   if (list)
-      mylist_resize(list, old_size + 1, true);
-   return list->data[old_size];
-}
-
 static void mylist_destroy(my_list **list_p)
 {
    my_list *list = NULL;
@@ -33535,53 +36157,103 @@ static void mylist_create(my_list **list_p, int initial_capacity,
    list->capacity     = initial_capacity;
 }
 
-static void *input_list_element_constructor(void)
+static void input_snapshot_entry_expand(
+      input_snapshot_entry_t *entry, unsigned id)
 {
-   void *ptr                   = malloc(sizeof(input_list_element));
-   input_list_element *element = (input_list_element*)ptr;
+   unsigned new_size = entry->state_size ? entry->state_size : 32;
 
-   element->port               = 0;
-   element->device             = 0;
-   element->index              = 0;
-   element->state              = (int16_t*)calloc(256, sizeof(int16_t));
-   element->state_size         = 256;
+   while (id >= new_size)
+      new_size *= 2;
 
-   return ptr;
+   if (new_size > entry->state_size)
+   {
+      int16_t *state = (int16_t*)realloc(entry->state,
+            new_size * sizeof(int16_t));
+
+      if (!state)
+         return;
+
+      memset(&state[entry->state_size], 0,
+            (new_size - entry->state_size) * sizeof(int16_t));
+      entry->state      = state;
+      entry->state_size = new_size;
+   }
 }
 
-static void input_list_element_realloc(
-      input_list_element *element,
-      unsigned int new_size)
+static input_snapshot_entry_t *input_snapshot_find(
+      input_snapshot_t *snapshot,
+      unsigned port, unsigned device, unsigned index)
 {
-   if (new_size > element->state_size)
+   unsigned i;
+   input_snapshot_entry_t *entry = NULL;
+
+   if (snapshot->last < snapshot->count)
    {
-      element->state = (int16_t*)realloc(element->state,
-            new_size * sizeof(int16_t));
-      memset(&element->state[element->state_size], 0,
-            (new_size - element->state_size) * sizeof(int16_t));
-      element->state_size = new_size;
+      entry = &snapshot->entries[snapshot->last];
+      if (     (entry->port   == port)
+            && (entry->device == device)
+            && (entry->index  == index))
+         return entry;
    }
+
+   for (i = 0; i < snapshot->count; i++)
+   {
+      entry = &snapshot->entries[i];
+      if (     (entry->port   == port)
+            && (entry->device == device)
+            && (entry->index  == index))
+      {
+         snapshot->last = i;
+         return entry;
+      }
+   }
+
+   return NULL;
 }
 
-static void input_list_element_expand(
-      input_list_element *element, unsigned int new_index)
+static input_snapshot_entry_t *input_snapshot_add(
+      input_snapshot_t *snapshot,
+      unsigned port, unsigned device, unsigned index)
 {
-   unsigned int new_size = element->state_size;
-   if (new_size == 0)
-      new_size = 32;
-   while (new_index >= new_size)
-      new_size *= 2;
-   input_list_element_realloc(element, new_size);
+   input_snapshot_entry_t *entry = NULL;
+
+   if (snapshot->count == snapshot->capacity)
+   {
+      unsigned capacity                = snapshot->capacity
+         ? snapshot->capacity * 2 : 16;
+      input_snapshot_entry_t *entries  = (input_snapshot_entry_t*)
+         realloc(snapshot->entries, capacity * sizeof(*entries));
+
+      if (!entries)
+         return NULL;
+
+      snapshot->entries  = entries;
+      snapshot->capacity = capacity;
+   }
+
+   entry             = &snapshot->entries[snapshot->count];
+   entry->port       = port;
+   entry->device     = device;
+   entry->index      = index;
+   entry->state      = (int16_t*)calloc(256, sizeof(int16_t));
+   entry->state_size = entry->state ? 256 : 0;
+
+   snapshot->last    = snapshot->count++;
+   return entry;
 }
 
-static void input_list_element_destructor(void* element_ptr)
+static void input_snapshot_free(input_snapshot_t *snapshot)
 {
-   input_list_element *element = (input_list_element*)element_ptr;
-   if (!element)
-      return;
+   unsigned i;
+
+   for (i = 0; i < snapshot->count; i++)
+      free(snapshot->entries[i].state);
+   free(snapshot->entries);
 
-   free(element->state);
-   free(element_ptr);
+   snapshot->entries  = NULL;
+   snapshot->count    = 0;
+   snapshot->capacity = 0;
+   snapshot->last     = 0;
 }
 
 static void input_state_set_last(
@@ -33589,69 +36261,42 @@ static void input_state_set_last(
       unsigned port, unsigned device,
       unsigned index, unsigned id, int16_t value)
 {
-   unsigned i;
-   input_list_element *element = NULL;
+   input_snapshot_t *snapshot    = &p_rarch->input_snapshot;
+   input_snapshot_entry_t *entry = input_snapshot_find(snapshot,
+         port, device, index);
 
-   if (!p_rarch->input_state_list)
-      mylist_create(&p_rarch->input_state_list, 16,
-            input_list_element_constructor,
-            input_list_element_destructor);
+   if (!entry && !(entry = input_snapshot_add(snapshot,
+               port, device, index)))
+      return;
 
-   /* Find list item */
-   for (i = 0; i < (unsigned)p_rarch->input_state_list->size; i++)
-   {
-      element = (input_list_element*)p_rarch->input_state_list->data[i];
-      if (  (element->port   == port)   &&
-            (element->device == device) &&
-            (element->index  == index)
-         )
-      {
-         if (id >= element->state_size)
-            input_list_element_expand(element, id);
-         element->state[id] = value;
-         return;
-      }
-   }
+   if (id >= entry->state_size)
+      input_snapshot_entry_expand(entry, id);
+   if (id >= entry->state_size)
+      return;
+
+   entry->state[id] = value;
 
-   element               = NULL;
-   if (p_rarch->input_state_list)
-      element            = (input_list_element*)
-         mylist_add_element(p_rarch->input_state_list);
-   if (element)
+   /* Keep the buttons in line with the bitmask, so that
+    * replays and runahead_input_unchanged() agree on them
+    * whichever way the core reads the RetroPad */
+   if (     (device == RETRO_DEVICE_JOYPAD)
+         && (id     == RETRO_DEVICE_ID_JOYPAD_MASK))
    {
-      element->port         = port;
-      element->device       = device;
-      element->index        = index;
-      if (id >= element->state_size)
-         input_list_element_expand(element, id);
-      element->state[id]    = value;
+      unsigned i;
+      for (i = 0; i < RARCH_FIRST_CUSTOM_BIND; i++)
+         entry->state[i] = (value >> i) & 1;
    }
 }
 
 static int16_t input_state_get_last(unsigned port,
       unsigned device, unsigned index, unsigned id)
 {
-   unsigned i;
    struct rarch_state      *p_rarch = &rarch_st;
+   input_snapshot_entry_t *entry    = input_snapshot_find(
+         &p_rarch->input_snapshot, port, device, index);
 
-   if (!p_rarch->input_state_list)
-      return 0;
-
-   /* find list item */
-   for (i = 0; i < (unsigned)p_rarch->input_state_list->size; i++)
-   {
-      input_list_element *element =
-         (input_list_element*)p_rarch->input_state_list->data[i];
-
-      if (  (element->port   == port)   &&
-            (element->device == device) &&
-            (element->index  == index))
-      {
-         if (id < element->state_size)
-            return element->state[id];
-         return 0;
-      }
-   }
+   if (entry && id < entry->state_size)
+      return entry->state[id];
    return 0;
 }
 
@@ -33731,7 +36376,7 @@ static void remove_input_state_hook(struct rarch_state *p_rarch)
       cbs->state_cb                 = p_rarch->input_state_callback_original;
       p_rarch->current_core.retro_set_input_state(cbs->state_cb);
       p_rarch->input_state_callback_original = NULL;
-      mylist_destroy(&p_rarch->input_state_list);
+      input_snapshot_free(&p_rarch->input_snapshot);
    }
 
    if (p_rarch->retro_reset_callback_original)
@@ -33765,7 +36410,15 @@ static void *runahead_save_state_alloc(void)
    if (  (p_rarch->runahead_save_state_size > 0) &&
          p_rarch->runahead_save_state_size_known)
    {
+#ifdef HAVE_MEMMAP
+      settings_t *settings  = p_rarch->configuration_settings;
+      savestate->data       = memmap_alloc_large(
+            p_rarch->runahead_save_state_size,
+            settings->bools.state_buffers_locked
+            ? (MEMMAP_LARGE_PREFAULT | MEMMAP_LARGE_LOCK) : 0);
+#else
       savestate->data       = malloc(p_rarch->runahead_save_state_size);
+#endif
       savestate->data_const = savestate->data;
       savestate->size       = p_rarch->runahead_save_state_size;
    }
@@ -33778,7 +36431,11 @@ static void runahead_save_state_free(void *data)
    retro_ctx_serialize_info_t *savestate = (retro_ctx_serialize_info_t*)data;
    if (!savestate)
       return;
+#ifdef HAVE_MEMMAP
+   memmap_free_large(savestate->data);
+#else
    free(savestate->data);
+#endif
    free(savestate);
 }
 
@@ -33865,6 +36522,7 @@ static void runahead_error(struct rarch_state *p_rarch)
    runahead_remove_hooks(p_rarch);
    p_rarch->runahead_save_state_size       = 0;
    p_rarch->runahead_save_state_size_known = true;
+   p_rarch->runahead_ring_valid            = false;
 }
 
 static bool runahead_create(struct rarch_state *p_rarch)
@@ -33894,16 +36552,18 @@ static bool runahead_create(struct rarch_state *p_rarch)
    return true;
 }
 
-static bool runahead_save_state(struct rarch_state *p_rarch)
+static bool runahead_save_state(struct rarch_state *p_rarch,
+      unsigned slot)
 {
    retro_ctx_serialize_info_t *serialize_info;
    bool okay                       = false;
 
-   if (!p_rarch->runahead_save_state_list)
+   if (     !p_rarch->runahead_save_state_list
+         || (slot >= (unsigned)p_rarch->runahead_save_state_list->size))
       return false;
 
    serialize_info                  =
-      (retro_ctx_serialize_info_t*)p_rarch->runahead_save_state_list->data[0];
+      (retro_ctx_serialize_info_t*)p_rarch->runahead_save_state_list->data[slot];
 
    p_rarch->request_fast_savestate = true;
    okay                            = core_serialize(serialize_info);
@@ -33916,11 +36576,12 @@ static bool runahead_save_state(struct rarch_state *p_rarch)
    return false;
 }
 
-static bool runahead_load_state(struct rarch_state *p_rarch)
+static bool runahead_load_state(struct rarch_state *p_rarch,
+      unsigned slot)
 {
    bool okay                                  = false;
    retro_ctx_serialize_info_t *serialize_info = (retro_ctx_serialize_info_t*)
-      p_rarch->runahead_save_state_list->data[0];
+      p_rarch->runahead_save_state_list->data[slot];
    bool last_dirty                            = p_rarch->input_is_dirty;
 
    p_rarch->request_fast_savestate            = true;
@@ -33986,11 +36647,127 @@ static bool runahead_core_run_use_last_input(struct rarch_state *p_rarch)
    return true;
 }
 
+/* Runs the 'real' frame after input has already been polled
+ * by runahead_input_unchanged(), so that a rejected snapshot
+ * ring does not cause a second poll (and a second turbo tick)
+ * within the same frame. */
+static void runahead_core_run_polled(struct rarch_state *p_rarch)
+{
+   struct retro_callbacks *cbs            = &p_rarch->retro_ctx;
+   retro_input_poll_t old_poll_function   = cbs->poll_cb;
+
+   cbs->poll_cb                           = retro_input_poll_null;
+   p_rarch->current_core.retro_set_input_poll(cbs->poll_cb);
+   p_rarch->current_core.input_polled     = true;
+
+   p_rarch->current_core.retro_run();
+
+   cbs->poll_cb                           = old_poll_function;
+   p_rarch->current_core.retro_set_input_poll(cbs->poll_cb);
+}
+
+/**
+ * runahead_input_unchanged:
+ * @poll                 : poll input first, unless that was
+ *                         already done this frame.
+ *
+ * Compares every input state the core has
+ * queried so far against the values logged during the last
+ * real frame. Inputs which were never queried are compared
+ * against zero, so the check can only err on the side of
+ * reporting a change. RetroPad buttons are all checked with
+ * a single bitmask query.
+ *
+ * Returns: true if the predicted frames held in the runahead
+ * snapshot ring are still valid for the current input.
+ **/
+static bool runahead_input_unchanged(struct rarch_state *p_rarch,
+      bool poll)
+{
+   unsigned i;
+   input_snapshot_t *snapshot = &p_rarch->input_snapshot;
+
+   if (poll)
+      input_driver_poll();
+
+   for (i = 0; i < snapshot->count; i++)
+   {
+      unsigned id;
+      input_snapshot_entry_t *entry = &snapshot->entries[i];
+
+      if (entry->device == RETRO_DEVICE_JOYPAD)
+      {
+         int16_t mask = input_state_internal(entry->port,
+               RETRO_DEVICE_JOYPAD, entry->index,
+               RETRO_DEVICE_ID_JOYPAD_MASK);
+
+         for (id = 0; id < RARCH_FIRST_CUSTOM_BIND; id++)
+            if (entry->state[id] != ((mask >> id) & 1))
+               return false;
+         if (     entry->state_size > RETRO_DEVICE_ID_JOYPAD_MASK
+               && entry->state[RETRO_DEVICE_ID_JOYPAD_MASK] != mask)
+            return false;
+         continue;
+      }
+
+      for (id = 0; id < entry->state_size; id++)
+      {
+         if (input_state_internal(entry->port, entry->device,
+                  entry->index, id) != entry->state[id])
+            return false;
+      }
+   }
+
+   return true;
+}
+
+/**
+ * runahead_ring_resize:
+ * @runahead_count       : number of frames to run ahead.
+ *
+ * Single-instance runahead keeps one snapshot per simulated
+ * frame (the real frame plus @runahead_count predicted ones),
+ * so that frames with unchanged input only need to advance the
+ * newest prediction by a single frame.
+ *
+ * Returns: false if the snapshot ring could not be allocated.
+ **/
+static bool runahead_ring_resize(struct rarch_state *p_rarch,
+      int runahead_count)
+{
+   int i;
+   my_list *list = p_rarch->runahead_save_state_list;
+
+   if (!list)
+      return false;
+
+   if (list->size == runahead_count + 1)
+      return true;
+
+   p_rarch->runahead_ring_valid = false;
+   p_rarch->runahead_ring_base  = 0;
+   mylist_resize(list, runahead_count + 1, true);
+
+   for (i = 0; i < list->size; i++)
+   {
+      retro_ctx_serialize_info_t *savestate =
+         (retro_ctx_serialize_info_t*)list->data[i];
+      if (!savestate || !savestate->data)
+      {
+         runahead_error(p_rarch);
+         return false;
+      }
+   }
+
+   return true;
+}
+
 static void do_runahead(
       struct rarch_state *p_rarch,
       int runahead_count,
       bool runahead_hide_warnings,
-      bool use_secondary)
+      bool use_secondary,
+      bool input_polled)
 {
    int frame_number        = 0;
    bool last_frame         = false;
@@ -34026,8 +36803,62 @@ static void do_runahead(
          || !have_dynamic
          || !p_rarch->runahead_secondary_core_available)
    {
-      /* TODO: multiple savestates for higher performance
-       * when not using secondary core */
+      unsigned ring_size = (unsigned)runahead_count + 1;
+
+      if (!runahead_ring_resize(p_rarch, runahead_count))
+      {
+         runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE), 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+         goto force_input_dirty;
+      }
+
+      /* The ring holds the state after the last real frame
+       * (at runahead_ring_base) followed by the states after
+       * each predicted frame. If input did not change, the
+       * real frame is identical to the first prediction, so
+       * advancing the ring by a single frame is enough. */
+      if (     p_rarch->runahead_ring_valid
+            && !p_rarch->runahead_force_input_dirty
+            && !p_rarch->input_is_dirty
+            && !p_rarch->bsv_movie_state_handle)
+      {
+         unsigned old_base = p_rarch->runahead_ring_base;
+         unsigned new_base = (old_base + 1) % ring_size;
+         unsigned newest   = (old_base + ring_size - 1) % ring_size;
+
+         if (runahead_input_unchanged(p_rarch, !input_polled))
+         {
+            if (!runahead_load_state(p_rarch, newest))
+            {
+               runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_LOAD_STATE), 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+               return;
+            }
+
+            runahead_core_run_use_last_input(p_rarch);
+
+            /* The old base is no longer needed, its slot
+             * becomes the newest prediction */
+            if (!runahead_save_state(p_rarch, old_base))
+            {
+               runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE), 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+               return;
+            }
+
+            if (!runahead_load_state(p_rarch, new_base))
+            {
+               runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_LOAD_STATE), 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+               return;
+            }
+
+            p_rarch->runahead_ring_base         = new_base;
+            p_rarch->runahead_force_input_dirty = false;
+            return;
+         }
+
+         input_polled = true;
+      }
+
+      p_rarch->runahead_ring_valid = false;
+
       for (frame_number = 0; frame_number <= runahead_count; frame_number++)
       {
          last_frame      = frame_number == runahead_count;
@@ -34040,7 +36871,12 @@ static void do_runahead(
          }
 
          if (frame_number == 0)
-            core_run();
+         {
+            if (input_polled)
+               runahead_core_run_polled(p_rarch);
+            else
+               core_run();
+         }
          else
             runahead_core_run_use_last_input(p_rarch);
 
@@ -34050,24 +36886,27 @@ static void do_runahead(
             p_rarch->audio_suspended     = false;
          }
 
-         if (frame_number == 0)
+         if (!runahead_save_state(p_rarch, frame_number))
          {
-            if (!runahead_save_state(p_rarch))
-            {
-               runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE), 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-               return;
-            }
+            runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE), 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+            return;
          }
 
          if (last_frame)
          {
-            if (!runahead_load_state(p_rarch))
+            if (!runahead_load_state(p_rarch, 0))
             {
                runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_LOAD_STATE), 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
                return;
             }
          }
       }
+
+      /* Any input change seen during the real frame has
+       * already been used for the predictions above */
+      p_rarch->input_is_dirty      = false;
+      p_rarch->runahead_ring_base  = 0;
+      p_rarch->runahead_ring_valid = true;
    }
    else
    {
@@ -34080,9 +36919,15 @@ static void do_runahead(
          goto force_input_dirty;
       }
 
+      /* The secondary instance only uses the first slot */
+      p_rarch->runahead_ring_valid     = false;
+
       /* run main core with video suspended */
       p_rarch->video_driver_active     = false;
-      core_run();
+      if (input_polled)
+         runahead_core_run_polled(p_rarch);
+      else
+         core_run();
       RUNAHEAD_RESUME_VIDEO(p_rarch);
 
       if (     p_rarch->input_is_dirty
@@ -34090,7 +36935,7 @@ static void do_runahead(
       {
          p_rarch->input_is_dirty       = false;
 
-         if (!runahead_save_state(p_rarch))
+         if (!runahead_save_state(p_rarch, 0))
          {
             runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE), 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
             return;
@@ -34124,9 +36969,243 @@ static void do_runahead(
    return;
 
 force_input_dirty:
-   core_run();
+   if (input_polled)
+      runahead_core_run_polled(p_rarch);
+   else
+      core_run();
    p_rarch->runahead_force_input_dirty   = true;
 }
+
+/* Runs the frames that follow an input change with
+ * 'state_cb' as input, keeping the hash of each */
+static void runahead_probe_pass(struct rarch_state *p_rarch,
+      uint32_t *hashes, retro_input_state_t state_cb)
+{
+   unsigned i;
+   struct retro_callbacks *cbs            = &p_rarch->retro_ctx;
+   runahead_probe_state_t *probe          = &p_rarch->runahead_probe;
+   retro_input_poll_t old_poll_function   = cbs->poll_cb;
+   retro_input_state_t old_input_function = cbs->state_cb;
+
+   cbs->poll_cb                           = retro_input_poll_null;
+   cbs->state_cb                          = state_cb;
+
+   p_rarch->current_core.retro_set_input_poll(cbs->poll_cb);
+   p_rarch->current_core.retro_set_input_state(cbs->state_cb);
+
+   probe->last_hash                       = 0;
+
+   for (i = 0; i < RUNAHEAD_PROBE_FRAMES; i++)
+   {
+      p_rarch->current_core.retro_run();
+      hashes[i]                           = probe->last_hash;
+   }
+
+   cbs->poll_cb                           = old_poll_function;
+   cbs->state_cb                          = old_input_function;
+
+   p_rarch->current_core.retro_set_input_poll(cbs->poll_cb);
+   p_rarch->current_core.retro_set_input_state(cbs->state_cb);
+}
+
+/* Looks up whether the game override already sets
+ * the number of frames, which then is left alone */
+static bool runahead_probe_is_overridden(void)
+{
+#ifdef HAVE_CONFIGFILE
+   char override_path[PATH_MAX_LENGTH];
+   config_file_t *conf = NULL;
+   bool overridden     = false;
+
+   if (!config_get_game_override_path(&runloop_state.system,
+            override_path, sizeof(override_path)))
+      return true;
+
+   if ((conf = config_file_new_from_path_to_string(override_path)))
+   {
+      overridden = config_entry_exists(conf, "run_ahead_frames");
+      config_file_free(conf);
+   }
+
+   return overridden;
+#else
+   return false;
+#endif
+}
+
+static void runahead_probe_finish(struct rarch_state *p_rarch,
+      settings_t *settings, bool detected)
+{
+   char msg[128];
+   runahead_probe_state_t *probe = &p_rarch->runahead_probe;
+   unsigned lag                  = probe->lag;
+
+   probe->done                   = true;
+
+   if (!detected)
+   {
+      RARCH_WARN("[Runahead]: %s\n",
+            msg_hash_to_str(MSG_RUNAHEAD_LAG_FRAMES_NOT_DETECTED));
+      runloop_msg_queue_push(
+            msg_hash_to_str(MSG_RUNAHEAD_LAG_FRAMES_NOT_DETECTED),
+            0, 3 * 60, true, NULL,
+            MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_WARNING);
+      return;
+   }
+
+   /* Without lag frames there is nothing to run ahead of */
+   settings->bools.run_ahead_enabled = lag > 0;
+   if (lag > 0)
+      settings->uints.run_ahead_frames = lag;
+
+   snprintf(msg, sizeof(msg),
+         msg_hash_to_str(MSG_RUNAHEAD_LAG_FRAMES_DETECTED), lag);
+   RARCH_LOG("[Runahead]: %s\n", msg);
+   runloop_msg_queue_push(msg, 0, 3 * 60, true, NULL,
+         MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+
+#ifdef HAVE_CONFIGFILE
+   {
+      char override_path[PATH_MAX_LENGTH];
+      config_file_t *conf = NULL;
+
+      if (!config_get_game_override_path(&runloop_state.system,
+               override_path, sizeof(override_path)))
+         return;
+
+      if (!(conf = config_file_new_from_path_to_string(override_path)))
+      {
+         char override_dir[PATH_MAX_LENGTH];
+
+         fill_pathname_basedir(override_dir, override_path,
+               sizeof(override_dir));
+         if (!path_is_directory(override_dir))
+            path_mkdir(override_dir);
+
+         if (!(conf = config_file_new_alloc()))
+            return;
+      }
+
+      config_set_bool(conf, "run_ahead_enabled",
+            settings->bools.run_ahead_enabled);
+      config_set_uint(conf, "run_ahead_frames",
+            settings->uints.run_ahead_frames);
+
+      if (!config_file_write(conf, override_path, true))
+         RARCH_ERR("[Runahead]: Failed to write \"%s\".\n",
+               override_path);
+
+      config_file_free(conf);
+   }
+#endif
+}
+
+/**
+ * runahead_probe_run:
+ *
+ * Automatic lag frame detection, called before each real
+ * frame. When input changed since the last one, the frames
+ * that follow are run twice from the current state, once
+ * with the previous input and once with the new one, and the
+ * state is then restored. The first frame to differ between
+ * the two is the first to show the reaction to the input.
+ *
+ * Returns: true if input was polled for this frame.
+ **/
+static bool runahead_probe_run(struct rarch_state *p_rarch,
+      settings_t *settings)
+{
+   unsigned lag;
+   bool ok                       = true;
+   runahead_probe_state_t *probe = &p_rarch->runahead_probe;
+
+   if (     probe->done
+         || !p_rarch->runahead_available
+         || p_rarch->bsv_movie_state_handle)
+      return false;
+
+   if (!probe->started)
+   {
+      probe->started = true;
+      probe->done    = runahead_probe_is_overridden();
+      return false;
+   }
+
+   /* The save state buffer and input logging hooks
+    * of runahead are needed even while it is off */
+   if (     !p_rarch->runahead_save_state_size_known
+         && !runahead_create(p_rarch))
+   {
+      probe->done = true;
+      return false;
+   }
+
+   if (     runahead_input_unchanged(p_rarch, true)
+         || !p_rarch->input_state_callback_original)
+      return true;
+
+   if (!runahead_save_state(p_rarch, 0))
+   {
+      probe->done = true;
+      return true;
+   }
+
+   /* Whatever runahead predicted is stale now */
+   p_rarch->runahead_ring_valid         = false;
+   p_rarch->runahead_force_input_dirty  = true;
+
+   probe->hashing                       = true;
+   p_rarch->audio_suspended             = true;
+
+   runahead_probe_pass(p_rarch, probe->hashes[0], input_state_get_last);
+
+   /* Cores that don't replay the same frames from the
+    * same state and input can't be measured this way */
+   if (!probe->deterministic && (ok = runahead_load_state(p_rarch, 0)))
+   {
+      runahead_probe_pass(p_rarch, probe->hashes[1], input_state_get_last);
+      probe->deterministic = !memcmp(probe->hashes[0], probe->hashes[1],
+            sizeof(probe->hashes[0]));
+   }
+
+   if (ok && probe->deterministic && (ok = runahead_load_state(p_rarch, 0)))
+      runahead_probe_pass(p_rarch, probe->hashes[1],
+            p_rarch->input_state_callback_original);
+
+   if (ok)
+      ok = runahead_load_state(p_rarch, 0);
+
+   probe->hashing                       = false;
+   p_rarch->audio_suspended             = false;
+
+   if (!ok || probe->hw_frame || !probe->deterministic)
+   {
+      runahead_probe_finish(p_rarch, settings, false);
+      return true;
+   }
+
+   for (lag = 0; lag < RUNAHEAD_PROBE_FRAMES; lag++)
+      if (probe->hashes[0][lag] != probe->hashes[1][lag])
+         break;
+
+   /* No visible reaction in time */
+   if (lag == RUNAHEAD_PROBE_FRAMES)
+   {
+      if (++probe->misses >= RUNAHEAD_PROBE_MAX_MISSES)
+         runahead_probe_finish(p_rarch, settings, false);
+      return true;
+   }
+
+   /* Some inputs only show after a while (fades,
+    * animations); the fastest reaction is the lag */
+   if (!probe->samples++ || lag < probe->lag)
+      probe->lag = lag;
+
+   if (probe->samples >= RUNAHEAD_PROBE_SAMPLES)
+      runahead_probe_finish(p_rarch, settings, true);
+
+   return true;
+}
 #endif
 
 static retro_time_t rarch_core_runtime_tick(
@@ -34406,6 +37485,26 @@ static void retroarch_print_help(const char *arg0)
 #ifdef HAVE_ACCESSIBILITY
       strlcat(buf, "      --accessibility\n"
             "                        Enables accessibilty for blind users using text-to-speech.\n", sizeof(buf));
+#endif
+      strlcat(buf, "      --benchmark=NUMBER\n"
+            "                        Runs content unthrottled for the specified number of frames\n"
+            "                        with the null video driver, then reports the time spent\n"
+            "                        in each stage as JSON. Combine with -P for input.\n", sizeof(buf));
+      strlcat(buf, "      --benchmark-output=FILE\n"
+            "                        Writes the benchmark report to FILE instead of stdout.\n", sizeof(buf));
+      strlcat(buf, "      --benchmark-drivers\n"
+            "                        Keeps the configured video and input drivers while benchmarking.\n", sizeof(buf));
+      strlcat(buf, "      --sessions=FILE\n"
+            "                        Runs the headless sessions listed in FILE side by side,\n"
+            "                        one '<frames> [<BSV2 movie>]' per line, then exits.\n"
+            "                        The report goes where --benchmark-output says.\n", sizeof(buf));
+      strlcat(buf, "      --boot-trace=FILE\n"
+            "                        Writes the time taken by each startup phase to FILE on exit,\n"
+            "                        in the Chrome trace event format.\n", sizeof(buf));
+#ifdef HAVE_SLANG
+      strlcat(buf, "      --bundle-shader=PRESET\n"
+            "                        Compiles every pass of the slang PRESET into a precompiled\n"
+            "                        bundle next to it, then exits.\n", sizeof(buf));
 #endif
       strlcat(buf, "      --load-menu-on-error\n"
             "                        Open menu instead of quitting if specified core or content fails to load.\n", sizeof(buf));
@@ -34490,6 +37589,14 @@ static bool retroarch_parse_input_and_config(
       { "log-file",           1, NULL, RA_OPT_LOG_FILE },
       { "accessibility",      0, NULL, RA_OPT_ACCESSIBILITY},
       { "load-menu-on-error", 0, NULL, RA_OPT_LOAD_MENU_ON_ERROR },
+      { "benchmark",          1, NULL, RA_OPT_BENCHMARK },
+      { "benchmark-output",   1, NULL, RA_OPT_BENCHMARK_OUTPUT },
+      { "benchmark-drivers",  0, NULL, RA_OPT_BENCHMARK_DRIVERS },
+      { "sessions",           1, NULL, RA_OPT_SESSIONS },
+      { "boot-trace",         1, NULL, RA_OPT_BOOT_TRACE },
+#ifdef HAVE_SLANG
+      { "bundle-shader",      1, NULL, RA_OPT_BUNDLE_SHADER },
+#endif
       { NULL, 0, NULL, 0 }
    };
 
@@ -34646,10 +37753,12 @@ static bool retroarch_parse_input_and_config(
    {
       /* If this is a static build, load salamander
        * config file first (sets RARCH_PATH_CORE) */
+      perf_boot_begin(PERF_BOOT_CONFIG);
 #if !defined(HAVE_DYNAMIC)
       config_load_file_salamander();
 #endif
       config_load(&p_rarch->g_extern);
+      perf_boot_end(PERF_BOOT_CONFIG);
    }
 
    /* Second pass: All other arguments override the config file */
@@ -35060,6 +38169,29 @@ static bool retroarch_parse_input_and_config(
             case RA_OPT_LOAD_MENU_ON_ERROR:
                global->cli_load_menu_on_error = true;
                break;
+            case RA_OPT_BENCHMARK:
+               runloop_state.max_frames          = (unsigned)strtoul(optarg, NULL, 10);
+               p_rarch->benchmark.enable         = true;
+               break;
+            case RA_OPT_BENCHMARK_OUTPUT:
+               strlcpy(p_rarch->benchmark.output_path, optarg,
+                     sizeof(p_rarch->benchmark.output_path));
+               break;
+            case RA_OPT_BENCHMARK_DRIVERS:
+               p_rarch->benchmark.keep_drivers   = true;
+               break;
+            case RA_OPT_SESSIONS:
+               strlcpy(p_rarch->sessions_path, optarg,
+                     sizeof(p_rarch->sessions_path));
+               break;
+            case RA_OPT_BOOT_TRACE:
+               strlcpy(p_rarch->boot_trace_path, optarg,
+                     sizeof(p_rarch->boot_trace_path));
+               break;
+            case RA_OPT_BUNDLE_SHADER:
+               strlcpy(p_rarch->bundle_shader_path, optarg,
+                     sizeof(p_rarch->bundle_shader_path));
+               break;
             default:
                RARCH_ERR("%s\n", msg_hash_to_str(MSG_ERROR_PARSING_ARGUMENTS));
                retroarch_fail(p_rarch, 1, "retroarch_parse_input()");
@@ -35067,6 +38199,9 @@ static bool retroarch_parse_input_and_config(
       }
    }
 
+   if (p_rarch->benchmark.enable)
+      runloop_benchmark_init(p_rarch, p_rarch->configuration_settings);
+
    verbosity_enabled = verbosity_is_enabled();
 
    if (verbosity_enabled)
@@ -35394,6 +38529,42 @@ bool retroarch_main_init(int argc, char *argv[])
 #endif
 
    retroarch_validate_cpu_features(p_rarch);
+
+#ifdef HAVE_SLANG
+   /* --bundle-shader is an offline tool, only glslang is needed */
+   if (!string_is_empty(p_rarch->bundle_shader_path))
+      exit(slang_bundle_write(p_rarch->bundle_shader_path) ? 0 : 1);
+#endif
+
+   /* --sessions runs its own cores, nothing else gets
+    * initialised */
+   if (!string_is_empty(p_rarch->sessions_path))
+   {
+      session_runner_config_t config;
+      const char *dir_system      = settings->paths.directory_system;
+      const char *dir_savefile    = dir_get_ptr(RARCH_DIR_SAVEFILE);
+      const char *dir_cache       = settings->paths.directory_cache;
+
+      if (string_is_empty(dir_cache))
+         dir_cache                = getenv("TMPDIR");
+
+      config.core_path            = path_get(RARCH_PATH_CORE);
+      config.content_path         = path_get(RARCH_PATH_CONTENT);
+      config.list_path            = p_rarch->sessions_path;
+      config.output_path          = p_rarch->benchmark.output_path;
+      config.tmp_dir              = dir_cache;
+      config.system_dir           = string_is_empty(dir_system)
+         ? NULL : dir_system;
+      config.save_dir             = string_is_empty(dir_savefile)
+         ? NULL : dir_savefile;
+      config.log_level            = settings->uints.libretro_log_level;
+
+      exit(session_runner_run(&config) ? 0 : 1);
+   }
+
+   content_hash_cache_init(settings->paths.directory_cache);
+   /* Before any driver or task thread gets created */
+   retroarch_apply_thread_profiles();
    retroarch_init_task_queue();
 
    {
@@ -35531,7 +38702,23 @@ bool retroarch_main_init(int argc, char *argv[])
                              settings->paths.path_cheat_database,
                              p_rarch);
 #endif
-   drivers_init(p_rarch, settings, DRIVERS_CMD_ALL, verbosity_enabled);
+   perf_boot_begin(PERF_BOOT_DRIVERS);
+#ifdef HAVE_MENU
+   /* Content launched straight from the command line
+    * doesn't need the menu before its first frame */
+   if (     settings->bools.menu_defer_init
+         && global->launched_from_cli
+         && p_rarch->current_core_type != CORE_TYPE_DUMMY)
+   {
+      RARCH_LOG("[Menu]: Deferring initialisation until first use.\n");
+      drivers_init(p_rarch, settings, DRIVERS_CMD_ALL & ~DRIVER_MENU_MASK,
+            verbosity_enabled);
+      p_rarch->menu_driver_deferred = true;
+   }
+   else
+#endif
+      drivers_init(p_rarch, settings, DRIVERS_CMD_ALL, verbosity_enabled);
+   perf_boot_end(PERF_BOOT_DRIVERS);
 #ifdef HAVE_COMMAND
    input_driver_deinit_command(p_rarch);
    input_driver_init_command(p_rarch, settings);
@@ -35761,6 +38948,23 @@ void retroarch_menu_running(void)
 #ifdef HAVE_MENU
    menu_handle_t *menu             = p_rarch->menu_driver_data;
    struct menu_state *menu_st      = &p_rarch->menu_driver_state;
+
+   /* Initialisation was skipped at startup, catch
+    * up on what the menu needs */
+   if (!menu && p_rarch->menu_driver_deferred)
+   {
+      p_rarch->menu_driver_deferred = false;
+
+      if (!menu_driver_init(VIDEO_DRIVER_IS_THREADED_INTERNAL()))
+         RARCH_ERR("Unable to init menu driver.\n");
+#ifdef HAVE_LIBRETRODB
+      menu_explore_context_init();
+#endif
+      rarch_favorites_init();
+
+      menu                         = p_rarch->menu_driver_data;
+   }
+
    if (menu)
       menu_driver_toggle(p_rarch, menu, settings,
             &runloop_state.key_event,
@@ -36112,6 +39316,53 @@ static void rarch_init_core_options(
                   categories_enabled);
 }
 
+/* Sets up the profiles that the main, video, audio and
+ * task threads take on, and applies the main thread's.
+ * Threads already running pick up changes when they
+ * get recreated (driver reinit, task queue restart). */
+void retroarch_apply_thread_profiles(void)
+{
+#ifdef HAVE_THREADS
+   struct rarch_state *p_rarch            = &rarch_st;
+   settings_t *settings                   = p_rarch->configuration_settings;
+   unsigned profile                       = settings->uints.thread_priority_profile;
+   uint64_t fast_mask                     = 0;
+   uint64_t slow_mask                     = 0;
+   enum sthread_priority_class emu_prio   = STHREAD_PRIORITY_DEFAULT;
+   enum sthread_priority_class audio_prio = STHREAD_PRIORITY_DEFAULT;
+   enum sthread_priority_class task_prio  = STHREAD_PRIORITY_DEFAULT;
+
+   if (settings->bools.thread_affinity_fast_cores)
+   {
+      unsigned cores = cpu_features_get_core_amount();
+
+      /* 0 unless the cores differ in speed */
+      fast_mask      = cpu_features_get_fast_core_mask();
+      if (fast_mask && cores < 64)
+         slow_mask   = ((UINT64_C(1) << cores) - 1) & ~fast_mask;
+   }
+
+   if (profile != THREAD_PRIORITY_PROFILE_DEFAULT)
+   {
+      emu_prio   = STHREAD_PRIORITY_HIGH;
+      audio_prio = (profile == THREAD_PRIORITY_PROFILE_REALTIME_AUDIO)
+         ? STHREAD_PRIORITY_REALTIME
+         : STHREAD_PRIORITY_HIGH;
+      task_prio  = STHREAD_PRIORITY_LOW;
+   }
+
+   /* The main thread never gets realtime priority;
+    * a core stuck in a loop would lock up the system */
+   sthread_set_role_profile(STHREAD_ROLE_MAIN,   fast_mask, emu_prio);
+   sthread_set_role_profile(STHREAD_ROLE_VIDEO,  fast_mask, emu_prio);
+   sthread_set_role_profile(STHREAD_ROLE_AUDIO,  fast_mask, audio_prio);
+   sthread_set_role_profile(STHREAD_ROLE_WORKER, slow_mask, task_prio);
+
+   if (!sthread_set_role(STHREAD_ROLE_MAIN))
+      RARCH_WARN("[Threads]: Could not fully apply the main thread profile.\n");
+#endif
+}
+
 void retroarch_init_task_queue(void)
 {
 #ifdef HAVE_THREADS
@@ -36124,6 +39375,7 @@ void retroarch_init_task_queue(void)
 
    task_queue_deinit();
    task_queue_init(threaded_enable, runloop_task_msg_queue_push);
+   task_queue_set_callback_budget(TASK_CALLBACK_BUDGET_USEC);
 }
 
 bool rarch_ctl(enum rarch_ctl_state state, void *data)
@@ -36139,6 +39391,10 @@ bool rarch_ctl(enum rarch_ctl_state state, void *data)
 #ifdef HAVE_BSV_MOVIE
       case RARCH_CTL_BSV_MOVIE_IS_INITED:
          return (p_rarch->bsv_movie_state_handle != NULL);
+      case RARCH_CTL_BSV_MOVIE_CAN_SEEK:
+         return BSV_MOVIE_IS_PLAYBACK_ON()
+            && p_rarch->bsv_movie_state_handle->stream
+            && bsv_stream_can_seek(p_rarch->bsv_movie_state_handle->stream);
 #endif
 #ifdef HAVE_PATCH
       case RARCH_CTL_IS_PATCH_BLOCKED:
@@ -36178,6 +39434,9 @@ bool rarch_ctl(enum rarch_ctl_state state, void *data)
             }
          }
          return false;
+      case RARCH_CTL_KEEP_CORE_RESIDENT:
+         p_rarch->core_keep_resident = true;
+         break;
       case RARCH_CTL_HAS_SET_USERNAME:
          return p_rarch->has_set_username;
       case RARCH_CTL_IS_INITED:
@@ -36758,6 +40017,8 @@ int retroarch_get_capabilities(enum rarch_capabilities type,
                strlcat(s, " AVX", len);
             if (cpu & RETRO_SIMD_AVX2)
                strlcat(s, " AVX2", len);
+            if (cpu & RETRO_SIMD_FMA3)
+               strlcat(s, " FMA3", len);
             if (cpu & RETRO_SIMD_NEON)
                strlcat(s, " NEON", len);
             if (cpu & RETRO_SIMD_VFPV3)
@@ -36919,7 +40180,32 @@ void runloop_msg_queue_push(const char *msg,
       enum message_queue_icon icon,
       enum message_queue_category category)
 {
-   struct rarch_state *p_rarch = &rarch_st;
+   runloop_msg_t record;
+
+   /* Tasks push from their own threads, so only a copy
+    * goes into the incoming queue here. Everything else
+    * happens in runloop_msg_queue_drain() on the main
+    * thread. A full queue drops the message, the same
+    * as a full msg_queue does. */
+   record.entry.duration = duration;
+   record.entry.prio     = prio;
+   record.entry.icon     = icon;
+   record.entry.category = category;
+   record.flush          = flush;
+   strlcpy(record.entry.msg, msg ? msg : "", sizeof(record.entry.msg));
+   strlcpy(record.entry.title, title ? title : "",
+         sizeof(record.entry.title));
+
+   mpsc_queue_push(&runloop_state.msg_queue_incoming, &record);
+}
+
+/* Hands the messages pushed since the last frame on to
+ * the widgets or the OSD message queue, in the order they
+ * were pushed. Sorting by priority is left to msg_queue,
+ * which is only ever touched from the main thread. */
+static void runloop_msg_queue_drain(struct rarch_state *p_rarch)
+{
+   runloop_msg_t record;
 #if defined(HAVE_GFX_WIDGETS)
    bool widgets_active         = p_rarch->widgets_active;
 #endif
@@ -36929,56 +40215,61 @@ void runloop_msg_queue_push(const char *msg,
    unsigned accessibility_narrator_speech_speed = settings->uints.accessibility_narrator_speech_speed;
 #endif
 
-   RUNLOOP_MSG_QUEUE_LOCK(runloop_state);
+   while (mpsc_queue_pop(&runloop_state.msg_queue_incoming, &record))
+   {
+      const char *msg   = record.entry.msg;
+      char *title       = string_is_empty(record.entry.title)
+         ? NULL : record.entry.title;
+      unsigned duration = record.entry.duration;
+
 #ifdef HAVE_ACCESSIBILITY
-   if (is_accessibility_enabled(
-            accessibility_enable,
-            p_rarch->accessibility_enabled))
-      accessibility_speak_priority(p_rarch,
-            accessibility_enable,
-            accessibility_narrator_speech_speed,
-            (char*) msg, 0);
+      if (is_accessibility_enabled(
+               accessibility_enable,
+               p_rarch->accessibility_enabled))
+         accessibility_speak_priority(p_rarch,
+               accessibility_enable,
+               accessibility_narrator_speech_speed,
+               (char*) msg, 0);
 #endif
 #if defined(HAVE_GFX_WIDGETS)
-   if (widgets_active)
-   {
-      gfx_widgets_msg_queue_push(
-            &p_rarch->dispwidget_st,
-            NULL,
-            msg,
-            roundf((float)duration / 60.0f * 1000.0f),
-            title,
-            icon,
-            category,
-            prio,
-            flush,
+      if (widgets_active)
+      {
+         gfx_widgets_msg_queue_push(
+               &p_rarch->dispwidget_st,
+               NULL,
+               msg,
+               roundf((float)duration / 60.0f * 1000.0f),
+               title,
+               record.entry.icon,
+               record.entry.category,
+               record.entry.prio,
+               record.flush,
 #ifdef HAVE_MENU
-            p_rarch->menu_driver_alive
+               p_rarch->menu_driver_alive
 #else
-            false
+               false
 #endif
-            );
-      duration = duration * 60 / 1000;
-   }
-   else
+               );
+         duration = duration * 60 / 1000;
+      }
+      else
 #endif
-   {
-      if (flush)
-         msg_queue_clear(&runloop_state.msg_queue);
-
-      msg_queue_push(&runloop_state.msg_queue, msg,
-            prio, duration,
-            title, icon, category);
+      {
+         if (record.flush)
+            msg_queue_clear(&runloop_state.msg_queue);
 
-      runloop_state.msg_queue_size = msg_queue_size(
-            &runloop_state.msg_queue);
-   }
+         msg_queue_push(&runloop_state.msg_queue, msg,
+               record.entry.prio, duration,
+               title, record.entry.icon, record.entry.category);
 
-   ui_companion_driver_msg_queue_push(p_rarch,
-         msg,
-         prio, duration, flush);
+         runloop_state.msg_queue_size = msg_queue_size(
+               &runloop_state.msg_queue);
+      }
 
-   RUNLOOP_MSG_QUEUE_UNLOCK(runloop_state);
+      ui_companion_driver_msg_queue_push(p_rarch,
+            msg,
+            record.entry.prio, duration, record.flush);
+   }
 }
 
 void runloop_get_status(bool *is_paused, bool *is_idle,
@@ -37161,6 +40452,158 @@ static bool menu_display_libretro(
 }
 #endif
 
+#ifdef HAVE_MENU
+static bool menu_driver_find_any_task(retro_task_t *task, void *userdata)
+{
+   return true;
+}
+
+/* Whether the menu will look just like it did last frame -
+ * nothing animates, no input, message or task is pending,
+ * and the window kept its size - so that redrawing and
+ * presenting it can be skipped */
+static bool menu_driver_is_idle(
+      struct rarch_state *p_rarch,
+      struct menu_state *menu_st,
+      menu_handle_t *menu,
+      enum menu_action action,
+      bool anim_active,
+      retro_time_t current_time)
+{
+   static unsigned idle_frames = 0;
+   static unsigned last_width  = 0;
+   static unsigned last_height = 0;
+   task_finder_data_t find_data;
+
+   find_data.func              = menu_driver_find_any_task;
+   find_data.userdata          = NULL;
+
+   if (     action != MENU_ACTION_NOOP
+         || anim_active
+         || menu_st->screensaver_active
+         || BIT64_GET(menu->state, MENU_STATE_RENDER_FRAMEBUFFER)
+         || BIT64_GET(menu->state, MENU_STATE_RENDER_MESSAGEBOX)
+         || (current_time - menu_st->input_last_time_us) < MENU_IDLE_INPUT_USEC
+         || runloop_state.msg_queue_size > 0
+         || p_rarch->video_driver_width  != last_width
+         || p_rarch->video_driver_height != last_height
+         || task_queue_find(&find_data))
+   {
+      idle_frames = 0;
+      last_width  = p_rarch->video_driver_width;
+      last_height = p_rarch->video_driver_height;
+      return false;
+   }
+
+   if (idle_frames < MENU_IDLE_REDRAW_FRAMES)
+   {
+      idle_frames++;
+      return false;
+   }
+
+   return true;
+}
+
+/* Once the selection rests on a playlist entry for
+ * PLAYLIST_PREFETCH_DELAY, starts reading what launching
+ * it would load. This watches the menu selection rather
+ * than any one driver, so it works the same in every
+ * menu */
+static void menu_driver_prefetch_update(
+      struct menu_state *menu_st,
+      settings_t *settings,
+      retro_time_t current_time)
+{
+   size_t i;
+   char content_path[PATH_MAX_LENGTH];
+   union string_list_elem_attr attr;
+   const struct playlist_entry *entry = NULL;
+   core_info_t *core_info             = NULL;
+   struct string_list *firmware       = NULL;
+   playlist_t *playlist               = NULL;
+   const char *system_dir             = settings->paths.directory_system;
+   file_list_t *list                  = MENU_LIST_GET_SELECTION(
+         menu_st->entries.list, 0);
+   size_t selection                   = menu_st->selection_ptr;
+
+   if (     list      != menu_st->prefetch.list
+         || selection != menu_st->prefetch.selection)
+   {
+      if (menu_st->prefetch.done)
+         task_content_prefetch_cancel();
+      menu_st->prefetch.list      = list;
+      menu_st->prefetch.selection = selection;
+      menu_st->prefetch.start_us  = current_time;
+      menu_st->prefetch.done      = false;
+      return;
+   }
+
+   if (     menu_st->prefetch.done
+         || (current_time - menu_st->prefetch.start_us)
+            < PLAYLIST_PREFETCH_DELAY * 1000)
+      return;
+
+   menu_st->prefetch.done = true;
+
+   if (     !list
+         || selection >= list->size
+         || list->list[selection].type != FILE_TYPE_RPL_ENTRY
+         || !(playlist = playlist_get_cached()))
+      return;
+
+   playlist_get_index(playlist, list->list[selection].entry_idx, &entry);
+
+   if (!entry || string_is_empty(entry->path))
+      return;
+
+   strlcpy(content_path, entry->path, sizeof(content_path));
+   playlist_resolve_path(PLAYLIST_LOAD, false,
+         content_path, sizeof(content_path));
+
+   if (playlist_entry_has_core(entry))
+   {
+      if (!string_ends_with_size(entry->core_path, "builtin",
+               strlen(entry->core_path), STRLEN_CONST("builtin")))
+         core_info = playlist_entry_get_core_info(entry);
+   }
+   else
+      core_info = playlist_get_default_core_info(playlist);
+
+   if (core_info && core_info->firmware_count > 0)
+   {
+      char content_dir[PATH_MAX_LENGTH];
+
+      if (string_is_empty(system_dir))
+      {
+         fill_pathname_basedir(content_dir, content_path,
+               sizeof(content_dir));
+         system_dir = content_dir;
+      }
+
+      attr.i   = 0;
+      firmware = string_list_new();
+
+      for (i = 0; firmware && i < core_info->firmware_count; i++)
+      {
+         char firmware_path[PATH_MAX_LENGTH];
+
+         if (string_is_empty(core_info->firmware[i].path))
+            continue;
+
+         fill_pathname_join(firmware_path, system_dir,
+               core_info->firmware[i].path, sizeof(firmware_path));
+         string_list_append(firmware, firmware_path, attr);
+      }
+   }
+
+   task_push_content_prefetch(content_path,
+         core_info ? core_info->path : NULL, firmware);
+
+   if (firmware)
+      string_list_free(firmware);
+}
+#endif
+
 static enum runloop_state runloop_check_state(
       struct rarch_state *p_rarch,
       settings_t *settings,
@@ -37169,6 +40612,7 @@ static enum runloop_state runloop_check_state(
    input_bits_t current_bits;
 #ifdef HAVE_MENU
    static input_bits_t last_input      = {{0}};
+   bool menu_frame_skipped             = false;
 #endif
    static bool old_focus               = true;
    struct retro_callbacks *cbs         = &p_rarch->retro_ctx;
@@ -37576,6 +41020,10 @@ static enum runloop_state runloop_check_state(
       if (TIME_TO_EXIT(trig_quit_key))
       {
          bool quit_runloop           = false;
+
+         if (     p_rarch->benchmark.enable
+               && !p_rarch->benchmark.reported)
+            runloop_benchmark_report(p_rarch);
 #ifdef HAVE_SCREENSHOTS
          unsigned runloop_max_frames = runloop_state.max_frames;
 
@@ -37788,6 +41236,8 @@ static enum runloop_state runloop_check_state(
          else
             retroarch_menu_running_finished(false);
       }
+      else if (settings->bools.playlist_prefetch)
+         menu_driver_prefetch_update(menu_st, settings, current_time);
 
       if (focused || !runloop_state.idle)
       {
@@ -37799,6 +41249,13 @@ static enum runloop_state runloop_check_state(
 
          if (menu)
          {
+            /* Menu drivers clear the animation state
+             * while rendering, so sample it first */
+            bool menu_idle           = settings->bools.menu_skip_idle_frames
+               && !libretro_running
+               && menu_driver_is_idle(p_rarch, menu_st, menu, action,
+                     ANIM_IS_ACTIVE(&p_rarch->anim), current_time);
+
             if (BIT64_GET(menu->state, MENU_STATE_RENDER_FRAMEBUFFER)
                   != BIT64_GET(menu->state, MENU_STATE_RENDER_MESSAGEBOX))
                BIT64_SET(menu->state, MENU_STATE_RENDER_FRAMEBUFFER);
@@ -37836,7 +41293,13 @@ static enum runloop_state runloop_check_state(
                if (menu_display_libretro(p_rarch,
                         settings->floats.slowmotion_ratio,
                         libretro_running, current_time))
-                  video_driver_cached_frame();
+               {
+                  /* Leave the last presented frame on screen */
+                  if (menu_idle)
+                     menu_frame_skipped = true;
+                  else
+                     video_driver_cached_frame();
+               }
 
             if (menu->driver_ctx->set_texture)
                menu->driver_ctx->set_texture(menu->userdata);
@@ -37930,6 +41393,10 @@ static enum runloop_state runloop_check_state(
       float fastforward_ratio = retroarch_get_runloop_fastforward_ratio(
             settings, &runloop_state);
 
+      /* Nothing to throttle - just poll again a bit later */
+      if (menu_frame_skipped)
+         return RUNLOOP_STATE_POLLED_AND_SLEEP;
+
       if (!settings->bools.menu_throttle_framerate && !fastforward_ratio)
          return RUNLOOP_STATE_MENU_ITERATE;
 
@@ -37954,6 +41421,9 @@ static enum runloop_state runloop_check_state(
    /* Check if we have pressed the recording toggle button */
    HOTKEY_CHECK(RARCH_RECORDING_TOGGLE, CMD_EVENT_RECORDING_TOGGLE, true, NULL);
 
+   /* Check if we have pressed the instant replay save button */
+   HOTKEY_CHECK(RARCH_INSTANT_REPLAY_SAVE, CMD_EVENT_INSTANT_REPLAY_SAVE, true, NULL);
+
    /* Check if we have pressed the streaming toggle button */
    HOTKEY_CHECK(RARCH_STREAMING_TOGGLE, CMD_EVENT_STREAMING_TOGGLE, true, NULL);
 
@@ -38364,6 +41834,378 @@ static enum runloop_state runloop_check_state(
    return RUNLOOP_STATE_ITERATE;
 }
 
+/**
+ * runloop_frame_delay_auto:
+ * @max_delay            : largest frame delay allowed (in ms).
+ * @current_time         : time at the start of this iteration.
+ *
+ * Picks the frame delay for the upcoming frame from the time
+ * the core needed to produce its last FRAME_DELAY_AUTO_WINDOW
+ * frames. The delay is lowered as soon as the window's 90th
+ * percentile no longer fits and halved after a missed VSync,
+ * but is only ever raised by 1 ms per window.
+ *
+ * Returns: frame delay to apply (in ms).
+ **/
+static unsigned runloop_frame_delay_auto(
+      struct rarch_state *p_rarch,
+      settings_t *settings,
+      unsigned max_delay,
+      retro_time_t current_time)
+{
+   frame_delay_auto_state_t *st = &p_rarch->frame_delay_auto;
+   float refresh_rate           = settings->floats.video_refresh_rate;
+   unsigned swap_interval       = settings->uints.video_swap_interval;
+   retro_time_t last_iterate    = st->last_iterate;
+   retro_time_t period;
+
+   st->last_iterate             = current_time;
+
+   if (  !settings->bools.video_vsync
+       || p_rarch->input_driver_nonblock_state
+       || refresh_rate <= 0.0f)
+   {
+      st->run_start = 0;
+      return 0;
+   }
+
+   if (max_delay == 0 || max_delay > MAXIMUM_FRAME_DELAY)
+      max_delay  = MAXIMUM_FRAME_DELAY;
+   if (swap_interval == 0)
+      swap_interval = 1;
+
+   period        = (retro_time_t)(1000000.0f * swap_interval / refresh_rate);
+
+   /* A frame that took noticeably longer than one period
+    * (but not so long that it was caused by a pause or the
+    * menu) means VSync was missed - back off right away */
+   if (     last_iterate
+         && st->run_start
+         && (current_time - last_iterate) > (period * 3) / 2
+         && (current_time - last_iterate) < (period * 4))
+   {
+      st->delay  /= 2;
+      st->hold    = FRAME_DELAY_AUTO_WINDOW * 4;
+      st->count   = 0;
+   }
+   else if (st->run_start && st->core_end > st->run_start)
+      st->samples[st->count++] = st->core_end - st->run_start;
+
+   if (st->hold)
+      st->hold--;
+
+   if (st->count >= FRAME_DELAY_AUTO_WINDOW)
+   {
+      unsigned i, j;
+      retro_time_t budget;
+      retro_time_t sorted[FRAME_DELAY_AUTO_WINDOW];
+      unsigned target = 0;
+
+      memcpy(sorted, st->samples, sizeof(sorted));
+
+      for (i = 1; i < FRAME_DELAY_AUTO_WINDOW; i++)
+      {
+         retro_time_t v = sorted[i];
+         for (j = i; j > 0 && sorted[j - 1] > v; j--)
+            sorted[j] = sorted[j - 1];
+         sorted[j] = v;
+      }
+
+      budget = period - FRAME_DELAY_AUTO_MARGIN_USEC
+         - sorted[(FRAME_DELAY_AUTO_WINDOW * 9) / 10];
+      if (p_rarch->present_timing_composited)
+         budget -= FRAME_DELAY_AUTO_COMPOSITOR_USEC;
+      if (budget > 0)
+         target = (unsigned)(budget / 1000);
+      if (target > max_delay)
+         target = max_delay;
+
+      if (target < st->delay)
+         st->delay = target;
+      else if (target > st->delay && !st->hold)
+         st->delay++;
+
+      st->count = 0;
+   }
+
+   if (st->delay > max_delay)
+      st->delay = max_delay;
+
+   st->core_end  = 0;
+   st->run_start = 0;
+
+   return st->delay;
+}
+
+/**
+ * runloop_frame_delay_sleep:
+ * @delay                : frame delay (in ms).
+ *
+ * Sleeps until @delay ms past the last vblank. That is only
+ * known if the context driver reports when frames are scanned
+ * out, otherwise the swap is assumed to have just returned on
+ * the vblank and this sleeps for @delay ms.
+ **/
+static void runloop_frame_delay_sleep(struct rarch_state *p_rarch,
+      unsigned delay)
+{
+   retro_time_t last     = p_rarch->present_timing_last;
+   retro_time_t interval = p_rarch->present_timing_interval;
+
+   if (last && interval > 0 && !VIDEO_DRIVER_IS_THREADED_INTERNAL())
+   {
+      retro_time_t now = cpu_features_get_time_usec();
+
+      /* Only predict from a recent scanout */
+      if (now >= last && now - last < interval * 8)
+      {
+         retro_time_t vblank = last + ((now - last) / interval) * interval;
+         retro_time_t wait   = vblank + (retro_time_t)delay * 1000 - now;
+
+         if (wait >= 1000)
+            retro_sleep((unsigned)(wait / 1000));
+         return;
+      }
+   }
+
+   retro_sleep(delay);
+}
+
+static void latency_test_add(struct retro_perf_counter *perf,
+      const char *ident, retro_time_t usec)
+{
+   performance_counter_init((*perf), ident);
+   perf->call_cnt++;
+   perf->total += usec;
+}
+
+/**
+ * runloop_latency_test_finish:
+ * @run_end              : time at which core_run() returned.
+ *
+ * Once the marked frame was presented, adds the
+ * measured input's timings to the latency counters.
+ **/
+static void runloop_latency_test_finish(
+      struct rarch_state *p_rarch, retro_time_t run_end)
+{
+   static const char *stage_idents[LATENCY_TEST_STAGES] = {
+      "latency_input_to_frame",
+      "latency_frame_to_present",
+      "latency_input_to_present",
+      "latency_core_run",
+   };
+   static const char *bucket_idents[LATENCY_TEST_BUCKETS + 1] = {
+      "latency_hist_00_04ms",
+      "latency_hist_04_08ms",
+      "latency_hist_08_12ms",
+      "latency_hist_12_16ms",
+      "latency_hist_16_20ms",
+      "latency_hist_20_24ms",
+      "latency_hist_24_28ms",
+      "latency_hist_28_32ms",
+      "latency_hist_32_36ms",
+      "latency_hist_36_40ms",
+      "latency_hist_40_44ms",
+      "latency_hist_44_48ms",
+      "latency_hist_48ms_up",
+   };
+   latency_test_state_t *st     = &p_rarch->latency_test;
+   retro_time_t input_present   = st->present - st->input;
+   unsigned bucket              = (unsigned)(input_present
+         / LATENCY_TEST_BUCKET_USEC);
+
+   if (bucket > LATENCY_TEST_BUCKETS)
+      bucket = LATENCY_TEST_BUCKETS;
+
+   latency_test_add(&st->stages[LATENCY_TEST_INPUT_TO_FRAME],
+         stage_idents[LATENCY_TEST_INPUT_TO_FRAME], st->frame - st->input);
+   latency_test_add(&st->stages[LATENCY_TEST_FRAME_TO_PRESENT],
+         stage_idents[LATENCY_TEST_FRAME_TO_PRESENT], st->present - st->frame);
+   latency_test_add(&st->stages[LATENCY_TEST_INPUT_TO_PRESENT],
+         stage_idents[LATENCY_TEST_INPUT_TO_PRESENT], input_present);
+   if (st->input_run)
+      latency_test_add(&st->stages[LATENCY_TEST_CORE_RUN],
+            stage_idents[LATENCY_TEST_CORE_RUN], run_end - st->input_run);
+   latency_test_add(&st->buckets[bucket], bucket_idents[bucket], input_present);
+
+   RARCH_LOG("[Latency]: Input to frame: %d us, to present: %d us.\n",
+         (int)(st->frame - st->input), (int)input_present);
+
+   st->pending = false;
+   st->frame   = 0;
+   st->present = 0;
+}
+
+/**
+ * runloop_benchmark_init:
+ *
+ * Overrides the settings that would throttle or hide
+ * a --benchmark run. The config file is not saved
+ * on exit, so that none of this sticks.
+ **/
+static void runloop_benchmark_init(struct rarch_state *p_rarch,
+      settings_t *settings)
+{
+   unsigned i;
+   benchmark_state_t *bench = &p_rarch->benchmark;
+
+   if (!bench->keep_drivers)
+   {
+      strlcpy(settings->arrays.video_driver, "null",
+            sizeof(settings->arrays.video_driver));
+      strlcpy(settings->arrays.input_driver, "null",
+            sizeof(settings->arrays.input_driver));
+   }
+
+   settings->bools.video_vsync            = false;
+   settings->bools.audio_sync             = false;
+   settings->bools.video_threaded         = false;
+   settings->bools.video_frame_delay_auto = false;
+   settings->uints.video_frame_delay      = 0;
+   settings->bools.config_save_on_exit    = false;
+
+   for (i = 0; i < BENCHMARK_STAGES; i++)
+   {
+      bench->stages[i].total = 0;
+      bench->stages[i].min   = -1;
+      bench->stages[i].max   = 0;
+      bench->frame[i]        = 0;
+   }
+
+   bench->run         = 0;
+   bench->start       = 0;
+   bench->end         = 0;
+   bench->frames      = 0;
+   bench->reported    = false;
+}
+
+/**
+ * runloop_benchmark_frame_end:
+ * @run_start            : time at which core_run() or
+ *                         the runahead loop was entered.
+ *
+ * Adds the timings of the frame that just ran.
+ **/
+static void runloop_benchmark_frame_end(
+      benchmark_state_t *bench, retro_time_t run_start)
+{
+   unsigned i;
+   retro_time_t end      = cpu_features_get_time_usec();
+   retro_time_t run_time = end - run_start;
+   retro_time_t core     = bench->run
+      - bench->frame[BENCHMARK_VIDEO] - bench->frame[BENCHMARK_AUDIO];
+
+   bench->frame[BENCHMARK_FRAME]    = run_time;
+   bench->frame[BENCHMARK_CORE]     = (core > 0) ? core : 0;
+   /* Savestates, input polling and extra runs not made
+    * through retro_run() */
+   bench->frame[BENCHMARK_RUNAHEAD] = (run_time > bench->run)
+      ? run_time - bench->run : 0;
+
+   for (i = 0; i < BENCHMARK_STAGES; i++)
+   {
+      benchmark_stage_time_t *stage = &bench->stages[i];
+      retro_time_t t                = bench->frame[i];
+
+      stage->total += t;
+      if (stage->min < 0 || t < stage->min)
+         stage->min = t;
+      if (t > stage->max)
+         stage->max = t;
+      bench->frame[i] = 0;
+   }
+
+   if (!bench->frames)
+      bench->start = run_start;
+   bench->end      = end;
+   bench->run      = 0;
+   bench->frames++;
+}
+
+/**
+ * runloop_benchmark_report:
+ *
+ * Writes the --benchmark results as JSON, to the
+ * --benchmark-output file or else to stdout.
+ **/
+static void runloop_benchmark_report(struct rarch_state *p_rarch)
+{
+   static const char *stage_idents[BENCHMARK_STAGES] = {
+      "frame",
+      "core",
+      "runahead",
+      "video",
+      "audio",
+   };
+   char report[2048];
+   unsigned i;
+   size_t len                    = 0;
+   benchmark_state_t *bench      = &p_rarch->benchmark;
+   rarch_system_info_t *sys_info = &runloop_state.system;
+   retro_time_t wall_time        = bench->end - bench->start;
+   uint64_t frames               = bench->frames ? bench->frames : 1;
+   const char *content_path      = path_get(RARCH_PATH_CONTENT);
+
+   bench->reported = true;
+
+   len += snprintf(report + len, sizeof(report) - len,
+         "{\n"
+         "  \"core\": \"%s\",\n"
+         "  \"core_version\": \"%s\",\n"
+         "  \"content\": \"%s\",\n"
+         "  \"video_driver\": \"%s\",\n"
+         "  \"frames\": %" PRIu64 ",\n"
+         "  \"wall_time_us\": %" PRId64 ",\n"
+         "  \"fps\": %.2f,\n"
+         "  \"stages\": {\n",
+         sys_info->info.library_name ? sys_info->info.library_name : "",
+         sys_info->info.library_version ? sys_info->info.library_version : "",
+         string_is_empty(content_path) ? "" : path_basename(content_path),
+         p_rarch->current_video ? p_rarch->current_video->ident : "",
+         bench->frames,
+         (int64_t)wall_time,
+         wall_time > 0 ? (double)bench->frames * 1000000.0 / wall_time : 0.0);
+
+   for (i = 0; i < BENCHMARK_STAGES && len < sizeof(report); i++)
+   {
+      const benchmark_stage_time_t *stage = &bench->stages[i];
+
+      len += snprintf(report + len, sizeof(report) - len,
+            "    \"%s\": { \"total_us\": %" PRId64
+            ", \"avg_us\": %.1f, \"min_us\": %" PRId64
+            ", \"max_us\": %" PRId64 " }%s\n",
+            stage_idents[i],
+            (int64_t)stage->total,
+            (double)stage->total / frames,
+            (int64_t)(stage->min < 0 ? 0 : stage->min),
+            (int64_t)stage->max,
+            (i + 1 < BENCHMARK_STAGES) ? "," : "");
+   }
+
+   if (len < sizeof(report))
+      snprintf(report + len, sizeof(report) - len, "  }\n}\n");
+
+   if (!string_is_empty(bench->output_path))
+   {
+      RFILE *file = filestream_open(bench->output_path,
+            RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+      if (file)
+      {
+         filestream_write(file, report, strlen(report));
+         filestream_close(file);
+         return;
+      }
+
+      RARCH_ERR("[Benchmark]: Could not write \"%s\".\n",
+            bench->output_path);
+   }
+
+   fputs(report, stdout);
+   fflush(stdout);
+}
+
 /**
  * runloop_iterate:
  *
@@ -38380,6 +42222,8 @@ int runloop_iterate(void)
    struct rarch_state                  *p_rarch = &rarch_st;
    settings_t *settings                         = p_rarch->configuration_settings;
    unsigned video_frame_delay                   = settings->uints.video_frame_delay;
+   bool video_frame_delay_auto                  = settings->bools.video_frame_delay_auto;
+   bool video_latency_test                      = settings->bools.video_latency_test;
    bool vrr_runloop_enable                      = settings->bools.vrr_runloop_enable;
    unsigned max_users                           = p_rarch->input_driver_max_users;
    retro_time_t current_time                    = cpu_features_get_time_usec();
@@ -38408,6 +42252,8 @@ int runloop_iterate(void)
    }
 #endif
 
+   runloop_msg_queue_drain(p_rarch);
+
    if (runloop_state.frame_time.callback)
    {
       /* Updates frame timing if frame timing callback is in use by the core.
@@ -38523,8 +42369,13 @@ int runloop_iterate(void)
 #ifdef HAVE_BSV_MOVIE
    /* Used for rewinding while playback/record. */
    if (p_rarch->bsv_movie_state_handle)
-      p_rarch->bsv_movie_state_handle->frame_pos[p_rarch->bsv_movie_state_handle->frame_ptr]
-         = intfstream_tell(p_rarch->bsv_movie_state_handle->file);
+   {
+      if (p_rarch->bsv_movie_state_handle->stream)
+         bsv_stream_frame_start(p_rarch->bsv_movie_state_handle->stream);
+      else
+         p_rarch->bsv_movie_state_handle->frame_pos[p_rarch->bsv_movie_state_handle->frame_ptr]
+            = intfstream_tell(p_rarch->bsv_movie_state_handle->file);
+   }
 #endif
 
    if (  p_rarch->camera_cb.caps &&
@@ -38606,32 +42457,106 @@ int runloop_iterate(void)
       }
    }
 
+   if (video_frame_delay_auto)
+      video_frame_delay = runloop_frame_delay_auto(p_rarch, settings,
+            video_frame_delay, current_time);
+
+   /* Start the core only once the video driver can
+    * take its frame (if it can tell) */
+   if (     !p_rarch->input_driver_nonblock_state
+         && !VIDEO_DRIVER_IS_THREADED_INTERNAL()
+         &&  p_rarch->video_driver_poke
+         &&  p_rarch->video_driver_poke->wait_frame_latency)
+      p_rarch->video_driver_poke->wait_frame_latency(
+            p_rarch->video_driver_data);
+
    if ((video_frame_delay > 0) && !p_rarch->input_driver_nonblock_state)
-      retro_sleep(video_frame_delay);
+      runloop_frame_delay_sleep(p_rarch, video_frame_delay);
+
+   if (video_frame_delay_auto)
+      p_rarch->frame_delay_auto.run_start = cpu_features_get_time_usec();
+
+   p_rarch->frame_telemetry_start         = cpu_features_get_time_usec();
+
+   perf_trace_mark("frame");
+   perf_trace_begin("core_run");
+
+   if (video_latency_test)
+      p_rarch->latency_test.run_start     = p_rarch->frame_telemetry_start;
+   else if (p_rarch->latency_test.mark_buffer)
+   {
+      free(p_rarch->latency_test.mark_buffer);
+      p_rarch->latency_test.mark_buffer      = NULL;
+      p_rarch->latency_test.mark_buffer_size = 0;
+      p_rarch->latency_test.pending          = false;
+   }
 
    {
 #ifdef HAVE_RUNAHEAD
-      bool run_ahead_enabled            = settings->bools.run_ahead_enabled;
-      unsigned run_ahead_num_frames     = settings->uints.run_ahead_frames;
+      bool run_ahead_enabled, want_runahead;
+      unsigned run_ahead_num_frames;
       bool run_ahead_hide_warnings      = settings->bools.run_ahead_hide_warnings;
       bool run_ahead_secondary_instance = settings->bools.run_ahead_secondary_instance;
-      /* Run Ahead Feature replaces the call to core_run in this loop */
-      bool want_runahead                = run_ahead_enabled && run_ahead_num_frames > 0;
+      bool input_polled                 = false;
+      bool netplay_enabled              = false;
 #ifdef HAVE_NETWORKING
-      want_runahead                     = want_runahead && !netplay_driver_ctl(RARCH_NETPLAY_CTL_IS_ENABLED, NULL);
+      netplay_enabled                   = netplay_driver_ctl(RARCH_NETPLAY_CTL_IS_ENABLED, NULL);
 #endif
 
+      /* May change the settings read below */
+      if (settings->bools.run_ahead_auto_detect && !netplay_enabled)
+         input_polled                   = runahead_probe_run(p_rarch, settings);
+
+      run_ahead_enabled                 = settings->bools.run_ahead_enabled;
+      run_ahead_num_frames              = settings->uints.run_ahead_frames;
+      /* Run Ahead Feature replaces the call to core_run in this loop */
+      want_runahead                     = run_ahead_enabled && run_ahead_num_frames > 0 && !netplay_enabled;
+
       if (want_runahead)
          do_runahead(
                p_rarch,
                run_ahead_num_frames,
                run_ahead_hide_warnings,
-               run_ahead_secondary_instance);
+               run_ahead_secondary_instance,
+               input_polled);
+      else if (input_polled)
+         runahead_core_run_polled(p_rarch);
       else
 #endif
          core_run();
    }
 
+   perf_trace_end("core_run");
+
+#ifdef HAVE_LAKKA
+   {
+      /* Skip frames that are meant to run faster or slower */
+      float fps           = p_rarch->video_driver_av_info.timing.fps;
+      retro_time_t budget = (fps > 0.0f
+            && !p_rarch->input_driver_nonblock_state
+            && !runloop_state.slowmotion)
+         ? (retro_time_t)(1000000.0f / fps) : 0;
+
+      set_cpu_scaling_frame_time(cpu_features_get_time_usec()
+            - p_rarch->frame_telemetry_start, budget);
+   }
+#endif
+
+   if (p_rarch->benchmark.enable)
+      runloop_benchmark_frame_end(&p_rarch->benchmark,
+            p_rarch->frame_telemetry_start);
+
+   if (video_latency_test && p_rarch->latency_test.pending)
+   {
+      retro_time_t run_end = cpu_features_get_time_usec();
+
+      if (p_rarch->latency_test.present)
+         runloop_latency_test_finish(p_rarch, run_end);
+      /* Nothing was shown (e.g. the menu is up) - give up */
+      else if (run_end - p_rarch->latency_test.input > 1000000)
+         p_rarch->latency_test.pending = false;
+   }
+
    /* Increment runtime tick counter after each call to
     * core_run() or run_ahead() */
    p_rarch->libretro_core_runtime_usec += rarch_core_runtime_tick(
@@ -39287,7 +43212,14 @@ bool core_run(void)
    else if (late_polling)
       current_core->input_polled = false;
 
-   current_core->retro_run();
+   if (p_rarch->benchmark.enable)
+   {
+      retro_time_t run_start = cpu_features_get_time_usec();
+      current_core->retro_run();
+      p_rarch->benchmark.run += cpu_features_get_time_usec() - run_start;
+   }
+   else
+      current_core->retro_run();
 
    if (late_polling && !current_core->input_polled)
       input_driver_poll();
@@ -90,6 +90,10 @@ enum rarch_ctl_state
 
    RARCH_CTL_IS_DUMMY_CORE,
    RARCH_CTL_IS_CORE_LOADED,
+   /* Keeps the running core inited when the next content
+    * is loaded, so that content can be loaded into it
+    * without retro_deinit() and retro_init() in between */
+   RARCH_CTL_KEEP_CORE_RESIDENT,
 
    RARCH_CTL_IS_BPS_PREF,
    RARCH_CTL_UNSET_BPS_PREF,
@@ -161,7 +165,8 @@ enum rarch_ctl_state
    RARCH_CTL_CORE_IS_RUNNING,
 
    /* BSV Movie */
-   RARCH_CTL_BSV_MOVIE_IS_INITED
+   RARCH_CTL_BSV_MOVIE_IS_INITED,
+   RARCH_CTL_BSV_MOVIE_CAN_SEEK
 };
 
 enum rarch_capabilities
@@ -318,6 +323,9 @@ typedef struct content_file_info
    size_t data_size;
    bool file_in_archive;
    bool persistent_data;
+   /* 'data' is a private file mapping rather
+    * than a malloc'd buffer */
+   bool data_mapped;
 } content_file_info_t;
 
 typedef struct content_file_list
@@ -543,6 +551,13 @@ typedef struct audio_driver
    size_t (*write_avail)(void *data);
 
    size_t (*buffer_size)(void *data);
+
+   /* Optional. For drivers whose device pulls samples from
+    * a callback: average free space in the buffer, measured
+    * by the callback itself. Used for rate control instead
+    * of write_avail(), which swings by a whole device period
+    * depending on when it happens to be polled. */
+   size_t (*measured_write_avail)(void *data);
 } audio_driver_t;
 
 bool audio_driver_enable_callback(void);
@@ -626,6 +641,7 @@ extern audio_driver_t audio_jack;
 extern audio_driver_t audio_sdl;
 extern audio_driver_t audio_xa;
 extern audio_driver_t audio_pulse;
+extern audio_driver_t audio_pipewire;
 extern audio_driver_t audio_dsound;
 extern audio_driver_t audio_wasapi;
 extern audio_driver_t audio_coreaudio;
@@ -646,6 +662,7 @@ extern audio_driver_t audio_switch_thread;
 extern audio_driver_t audio_switch_libnx_audren;
 extern audio_driver_t audio_switch_libnx_audren_thread;
 extern audio_driver_t audio_rwebaudio;
+extern audio_driver_t audio_audioworklet;
 
 /* Recording */
 
@@ -680,6 +697,7 @@ enum record_config_type
    RECORD_CONFIG_TYPE_STREAMING_LOW_QUALITY,
    RECORD_CONFIG_TYPE_STREAMING_MED_QUALITY,
    RECORD_CONFIG_TYPE_STREAMING_HIGH_QUALITY,
+   RECORD_CONFIG_TYPE_STREAMING_LOW_LATENCY,
    RECORD_CONFIG_TYPE_STREAMING_NETPLAY
 
 };
@@ -692,7 +710,8 @@ struct record_params
    /* Sample rate of input audio. */
    double samplerate;
 
-   /* Filename to dump to. */
+   /* Filename to dump to. Several outputs can be given,
+    * separated by '|', which all get the same encode. */
    const char *filename;
 
    /* Path to config. Optional. */
@@ -716,6 +735,10 @@ struct record_params
    unsigned video_record_threads;
    unsigned streaming_mode;
 
+   /* Seconds of encoded output kept in memory for save_replay()
+    * instead of recording to 'filename'. 0 records normally. */
+   unsigned replay_length;
+
    /* Aspect ratio of input video. Parameters are passed to the muxer,
     * the video itself is not scaled.
     */
@@ -751,6 +774,8 @@ typedef struct record_driver
    bool  (*push_video)(void *data, const struct record_video_data *video_data);
    bool  (*push_audio)(void *data, const struct record_audio_data *audio_data);
    bool  (*finalize)(void *data);
+   /* Writes what the replay buffer holds to a new file. */
+   bool  (*save_replay)(void *data, const char *path);
    const char *ident;
 } record_driver_t;
 
@@ -1211,7 +1236,7 @@ typedef struct video_frame_info
       bool full_screen;
    } osd_stat_params;
 
-   char stat_text[512];
+   char stat_text[1024];
 
    bool widgets_active;
    bool menu_mouse_enable;
@@ -1407,6 +1432,13 @@ struct aspect_ratio_elem
    char name[64];
 };
 
+/* Settings video_poke_interface_t::reconfigure can apply */
+enum video_reconfigure_flags
+{
+   /* video_max_swapchain_images */
+   VIDEO_RECONFIGURE_SWAPCHAIN = (1 << 0)
+};
+
 /* Optionally implemented interface to poke more
  * deeply into video driver. */
 
@@ -1451,6 +1483,27 @@ typedef struct video_poke_interface
          struct retro_framebuffer *framebuffer);
    bool (*get_hw_render_interface)(void *data,
          const struct retro_hw_render_interface **iface);
+   /* GPU time (in us) of the most recent frame the GPU
+    * finished, and how many submitted frames it has not
+    * finished yet. Either may be -1 if unknown */
+   bool (*get_gpu_timing)(void *data,
+         retro_time_t *gpu_time, int *queue_depth);
+   /* Blocks until the driver can take another frame
+    * without it queueing up behind those not yet shown,
+    * so that the core gets to run as late as possible */
+   void (*wait_frame_latency)(void *data);
+   /* Applies the changes named by @flags (VIDEO_RECONFIGURE_*)
+    * without reinitialising the driver. Returns false if it
+    * can't, in which case the caller falls back to a reinit */
+   bool (*reconfigure)(void *data, unsigned flags);
+   /* GPU time (in us) of each pass of the shader preset in
+    * the most recent frame the GPU finished, -1 for passes
+    * not timed yet. Returns the number of passes written */
+   unsigned (*get_shader_pass_timings)(void *data,
+         retro_time_t *pass_time, unsigned max_passes);
+   /* Bytes of GPU memory held by the shader preset's
+    * framebuffers, history and feedback included */
+   size_t (*get_shader_memory_usage)(void *data);
 } video_poke_interface_t;
 
 /* msg is for showing a message on the screen
@@ -1669,6 +1722,10 @@ void video_driver_set_aspect_ratio_value(float value);
 
 enum retro_pixel_format video_driver_get_pixel_format(void);
 
+/* GPU time of a pass of the active shader preset, averaged
+ * over the last few frames, in us. -1 when unknown */
+retro_time_t video_driver_get_shader_pass_time(unsigned pass);
+
 void video_driver_cached_frame_set(const void *data, unsigned width,
       unsigned height, size_t pitch);
 
@@ -1775,6 +1832,64 @@ bool video_driver_texture_load(void *data,
 
 bool video_driver_texture_unload(uintptr_t *id);
 
+/* What the GPU memory of the video driver is used for */
+enum video_gpu_mem_type
+{
+   /* Menu, widgets and anything else loaded through
+    * video_driver_texture_load() and not retagged */
+   VIDEO_GPU_MEM_TEXTURES = 0,
+   VIDEO_GPU_MEM_THUMBNAILS,
+   VIDEO_GPU_MEM_OVERLAYS,
+   VIDEO_GPU_MEM_SHADERS,
+   VIDEO_GPU_MEM_LAST
+};
+
+/* Counts a texture loaded through video_driver_texture_load()
+ * against @type instead of VIDEO_GPU_MEM_TEXTURES */
+void video_driver_texture_set_gpu_mem_type(uintptr_t id,
+      enum video_gpu_mem_type type);
+
+/* Estimated bytes of GPU memory used for @type,
+ * or for everything if @type is VIDEO_GPU_MEM_LAST */
+size_t video_driver_get_gpu_mem_usage(enum video_gpu_mem_type type);
+
+/* True while the estimated GPU memory use is above
+ * the budget set by 'video_gpu_memory_budget' */
+bool video_driver_gpu_mem_over_budget(void);
+
+/* Returns @filter without mipmapping while over the
+ * GPU memory budget, for large optional textures
+ * such as wallpapers */
+enum texture_filter_type video_driver_gpu_mem_filter(
+      enum texture_filter_type filter);
+
+/* Called once a queued upload has been handed to the
+ * video driver. 'success' is false if the driver could
+ * not take it (or went away first), in which case 'id'
+ * is 0. Either way, 'image' belongs to the caller again */
+typedef void (*video_driver_texture_cb_t)(void *userdata,
+      void *image, uintptr_t id, bool success);
+
+typedef struct video_driver_texture_upload
+{
+   void *image;
+   void *userdata;
+   video_driver_texture_cb_t cb;
+   uintptr_t id;
+   enum texture_filter_type filter_type;
+} video_driver_texture_upload_t;
+
+/* Queues 'data' (a struct texture_image) for upload
+ * instead of loading it right away - all uploads queued
+ * during a frame are done together before the next one
+ * is drawn, in a single round trip with threaded video.
+ * 'data' must stay valid until 'cb' is called.
+ * Returns false (and never calls 'cb') if the upload
+ * could not be queued */
+bool video_driver_texture_load_async(void *data,
+      enum texture_filter_type filter_type,
+      video_driver_texture_cb_t cb, void *userdata);
+
 void video_driver_build_info(video_frame_info_t *video_info);
 
 void video_driver_reinit(int flags);
@@ -1824,6 +1939,32 @@ bool video_shader_driver_get_current_shader(video_shader_ctx_t *shader);
 
 float video_driver_get_refresh_rate(void);
 
+/**
+ * video_driver_set_present_timing:
+ * @presented            : when the last frame was scanned out,
+ *                         in cpu_features_get_time_usec() time.
+ * @refresh_interval     : refresh period in microseconds,
+ *                         0 if not constant.
+ *
+ * For context drivers that learn from the display server when
+ * frames actually reach the screen. The frame delay is then
+ * timed from the predicted vblank rather than from when the
+ * swap returned.
+ **/
+void video_driver_set_present_timing(retro_time_t presented,
+      retro_time_t refresh_interval);
+
+/**
+ * video_driver_set_present_composited:
+ * @composited           : true if frames are copied to a
+ *                         compositor rather than flipped.
+ *
+ * A compositor only picks up frames that arrive before it
+ * starts repainting, so automatic frame delay leaves more
+ * room before the vblank while this is set.
+ **/
+void video_driver_set_present_composited(bool composited);
+
 #if defined(HAVE_GFX_WIDGETS)
 bool video_driver_has_widgets(void);
 #endif
@@ -2004,12 +2145,16 @@ const char* config_get_camera_driver_options(void);
 
 bool menu_driver_is_alive(void);
 
+bool menu_driver_is_deferred(void);
+
 bool gfx_widgets_ready(void);
 
 unsigned int retroarch_get_rotation(void);
 
 void retroarch_init_task_queue(void);
 
+void retroarch_apply_thread_profiles(void);
+
 bool input_key_pressed(int key, bool keyboard_pressed);
 
 bool input_mouse_grabbed(void);
@@ -76,12 +76,64 @@
 
 #define MEASURE_FRAME_TIME_SAMPLES_COUNT (2 * 1024)
 
+/* Time per frame the callbacks of finished tasks may take,
+ * those past it wait for the next frame */
+#define TASK_CALLBACK_BUDGET_USEC 4000
+
+/* Number of core frame times the automatic frame delay
+ * looks at before re-evaluating the delay */
+#define FRAME_DELAY_AUTO_WINDOW 32
+/* Time reserved for presentation and sleep jitter
+ * when automatic frame delay picks a delay */
+#define FRAME_DELAY_AUTO_MARGIN_USEC 2000
+/* Extra time reserved when frames are copied to a
+ * compositor, which has to repaint ahead of the vblank */
+#define FRAME_DELAY_AUTO_COMPOSITOR_USEC 3000
+
+/* Frames kept by the frame telemetry ring
+ * > Must be a power of 2 */
+#define FRAME_TELEMETRY_COUNT 1024
+/* Most records GET_FRAME_TELEMETRY replies with */
+#define FRAME_TELEMETRY_REPLY_MAX 16
+
+/* Frames each shader pass GPU time is averaged over */
+#define SHADER_PASS_TIMING_WINDOW 60
+
+/* Latency test: side of the square drawn into the
+ * marked frame, and the histogram of input to
+ * presentation times (LATENCY_TEST_BUCKETS buckets
+ * of LATENCY_TEST_BUCKET_USEC, plus one for the rest) */
+#define LATENCY_TEST_MARK_SIZE 32
+#define LATENCY_TEST_BUCKETS 12
+#define LATENCY_TEST_BUCKET_USEC 4000
+
+/* Side of the grid of average lumas frames sent to the AI
+ * service are compared by. Auto mode doesn't send a frame
+ * when no cell moved by more than the tolerance, and looks
+ * again after the retry delay. */
+#define AI_SERVICE_SIGNATURE_SIZE 32
+#define AI_SERVICE_SIGNATURE_TOLERANCE 2
+#define AI_SERVICE_UNCHANGED_RETRY_USEC 500000
+
 #define TIME_TO_FPS(last_time, new_time, frames) ((1000000.0f * (frames)) / ((new_time) - (last_time)))
 
 #define AUDIO_BUFFER_FREE_SAMPLES_COUNT (8 * 1024)
 
+/* Adaptive rate control: buffer fill level it steers
+ * towards, and number of flushes over which an error
+ * is fully folded into the drift estimate */
+#define AUDIO_RATE_CONTROL_ADAPTIVE_FILL 0.25
+#define AUDIO_RATE_CONTROL_ADAPTIVE_PERIOD 1024.0
+
 #define MENU_SOUND_FORMATS "ogg|mod|xm|s3m|mp3|flac|wav"
 
+/* With menu_skip_idle_frames, the menu counts as idle
+ * this long after the last input, and is still drawn for
+ * this many frames after that, so that every swapchain
+ * image ends up holding the latest frame */
+#define MENU_IDLE_INPUT_USEC    100000
+#define MENU_IDLE_REDRAW_FRAMES 4
+
 #define MIDI_DRIVER_BUF_SIZE 4096
 
 /**
@@ -161,6 +213,10 @@
 
 #define VIDEO_DRIVER_GET_HW_CONTEXT_INTERNAL(p_rarch) (&p_rarch->hw_render)
 
+/* Messages that can be pushed between two drains of
+ * the incoming message queue */
+#define RUNLOOP_MSG_QUEUE_INCOMING_SIZE 32
+
 #ifdef HAVE_THREADS
 #define RUNLOOP_MSG_QUEUE_LOCK(runloop) slock_lock(runloop.msg_queue_lock)
 #define RUNLOOP_MSG_QUEUE_UNLOCK(runloop) slock_unlock(runloop.msg_queue_lock)
@@ -475,6 +531,9 @@ static const audio_driver_t *audio_drivers[] = {
 #ifdef HAVE_PULSE
    &audio_pulse,
 #endif
+#ifdef HAVE_PIPEWIRE
+   &audio_pipewire,
+#endif
 #if defined(__PSL1GHT__) || defined(__PS3__)
    &audio_ps3,
 #endif
@@ -489,6 +548,7 @@ static const audio_driver_t *audio_drivers[] = {
 #endif
 #ifdef EMSCRIPTEN
    &audio_rwebaudio,
+   &audio_audioworklet,
 #endif
 #if defined(PSP) || defined(VITA) || defined(ORBIS)
   &audio_psp,
@@ -1156,6 +1216,7 @@ static const record_driver_t record_null = {
    NULL, /* push_video */
    NULL, /* push_audio */
    NULL, /* finalize */
+   NULL, /* save_replay */
    "null",
 };
 
@@ -1266,7 +1327,13 @@ enum
    RA_OPT_MAX_FRAMES_SCREENSHOT_PATH,
    RA_OPT_SET_SHADER,
    RA_OPT_ACCESSIBILITY,
-   RA_OPT_LOAD_MENU_ON_ERROR
+   RA_OPT_LOAD_MENU_ON_ERROR,
+   RA_OPT_BENCHMARK,
+   RA_OPT_BENCHMARK_OUTPUT,
+   RA_OPT_BENCHMARK_DRIVERS,
+   RA_OPT_SESSIONS,
+   RA_OPT_BOOT_TRACE,
+   RA_OPT_BUNDLE_SHADER
 };
 
 enum  runloop_state
@@ -1299,6 +1366,15 @@ enum auto_shader_operation
    AUTO_SHADER_OP_EXISTS
 };
 
+enum shader_apply_result
+{
+   SHADER_APPLY_FAILED = 0,
+   SHADER_APPLY_DONE,
+   /* Compiling in the background - task_shader_compile_cb()
+    * applies it and reports the outcome */
+   SHADER_APPLY_PENDING
+};
+
 enum input_game_focus_cmd_type
 {
    GAME_FOCUS_CMD_OFF = 0,
@@ -1323,6 +1399,14 @@ typedef struct
    bool set;
 } runloop_core_status_msg_t;
 
+/* A runloop_msg_queue_push() call, as queued up
+ * for the main thread */
+typedef struct
+{
+   msg_queue_entry_t entry;
+   bool flush;
+} runloop_msg_t;
+
 struct rarch_dir_shader_list
 {
    struct string_list *shader_list;
@@ -1350,6 +1434,9 @@ struct bsv_state
 
 struct bsv_movie
 {
+   /* BSV2 movie, all recordings and BSV2 playback.
+    * The fields below are for BSV1 playback. */
+   bsv_stream_t *stream;
    intfstream_t *file;
    uint8_t *state;
    /* A ring buffer keeping track of positions
@@ -1409,14 +1496,27 @@ typedef struct input_remote_state
    int16_t analog[4][MAX_USERS];
 } input_remote_state_t;
 
-typedef struct input_list_element_t
+typedef struct input_snapshot_entry
 {
    int16_t *state;
    unsigned port;
    unsigned device;
    unsigned index;
-   unsigned int state_size;
-} input_list_element;
+   unsigned state_size;
+} input_snapshot_entry_t;
+
+/* Input states the core queried during the last real
+ * frame, replayed as is to the runahead frames and the
+ * secondary core */
+typedef struct input_snapshot
+{
+   input_snapshot_entry_t *entries;
+   unsigned count;
+   unsigned capacity;
+   /* Entry of the previous lookup, cores mostly query
+    * the same port and device many times in a row */
+   unsigned last;
+} input_snapshot_t;
 
 typedef void *(*constructor_t)(void);
 typedef void  (*destructor_t )(void*);
@@ -1513,6 +1613,153 @@ typedef struct input_game_focus_state
    bool core_requested;
 } input_game_focus_state_t;
 
+typedef struct frame_delay_auto_state
+{
+   retro_time_t samples[FRAME_DELAY_AUTO_WINDOW];
+   retro_time_t run_start;
+   retro_time_t core_end;
+   retro_time_t last_iterate;
+   unsigned count;
+   unsigned hold;
+   unsigned delay;
+} frame_delay_auto_state_t;
+
+/* Pacing of one frame handed to the video driver.
+ * Times are in microseconds, -1 when unknown */
+typedef struct frame_telemetry
+{
+   uint64_t frame;
+   retro_time_t time;             /* When frame() returned */
+   retro_time_t cpu_time;         /* Core and frontend, up to then */
+   retro_time_t gpu_time;         /* Of a recent frame, see video_poke */
+   retro_time_t present_interval; /* Since the previous frame() */
+   int queue_depth;               /* Frames the GPU has yet to finish */
+   unsigned missed_vsyncs;
+} frame_telemetry_t;
+
+/* A texture loaded through video_driver_texture_load() */
+typedef struct video_gpu_mem_texture
+{
+   uintptr_t id;
+   size_t size;
+   enum video_gpu_mem_type type;
+} video_gpu_mem_texture_t;
+
+/* Estimated GPU memory use of the video driver */
+typedef struct video_gpu_mem_state
+{
+   video_gpu_mem_texture_t *textures;
+   size_t textures_count;
+   size_t textures_cap;
+   size_t usage[VIDEO_GPU_MEM_LAST];
+   bool over_budget;
+} video_gpu_mem_state_t;
+
+/* GPU time of each pass of the active shader preset,
+ * averaged over SHADER_PASS_TIMING_WINDOW frames.
+ * Times are in microseconds, -1 when unknown */
+typedef struct shader_pass_timing
+{
+   retro_time_t sum[GFX_MAX_SHADERS];
+   retro_time_t average[GFX_MAX_SHADERS];
+   unsigned samples[GFX_MAX_SHADERS];
+   unsigned frames;
+   unsigned passes;
+} shader_pass_timing_t;
+
+enum latency_test_stage
+{
+   LATENCY_TEST_INPUT_TO_FRAME = 0,
+   LATENCY_TEST_FRAME_TO_PRESENT,
+   LATENCY_TEST_INPUT_TO_PRESENT,
+   LATENCY_TEST_CORE_RUN,
+   LATENCY_TEST_STAGES
+};
+
+/* Timestamps of the one input being measured.
+ * The counters hold microseconds in 'total', rather
+ * than perf ticks, so that total / call_cnt is the
+ * average latency in microseconds */
+typedef struct latency_test_state
+{
+   struct retro_perf_counter stages[LATENCY_TEST_STAGES];
+   struct retro_perf_counter buckets[LATENCY_TEST_BUCKETS + 1];
+   retro_time_t run_start;    /* Of the current core_run() */
+   retro_time_t input_run;    /* Of the core_run() that saw the input */
+   retro_time_t input;
+   retro_time_t frame;
+   retro_time_t present;
+   uint8_t *mark_buffer;
+   size_t mark_buffer_size;
+   int16_t buttons;
+   bool pending;
+} latency_test_state_t;
+
+#ifdef HAVE_RUNAHEAD
+/* Frames replayed after an input change when detecting
+ * lag frames - up to one less can be detected */
+#define RUNAHEAD_PROBE_FRAMES     8
+/* Input changes the frames have to react to before the
+ * lowest lag seen is taken, and how many that show no
+ * reaction end the detection */
+#define RUNAHEAD_PROBE_SAMPLES    5
+#define RUNAHEAD_PROBE_MAX_MISSES 40
+
+/* Automatic lag frame detection. Each input change is
+ * replayed from the same state with the previous and the
+ * new input; the first frame that differs between the two
+ * gives the number of lag frames */
+typedef struct runahead_probe_state
+{
+   uint32_t hashes[2][RUNAHEAD_PROBE_FRAMES];
+   uint32_t last_hash;   /* Of the last frame the core output */
+   unsigned samples;
+   unsigned misses;
+   unsigned lag;         /* Lowest seen so far */
+   bool started;
+   bool hashing;         /* Frames go to the probe, not the screen */
+   bool hw_frame;        /* Got a frame that can't be hashed */
+   bool deterministic;   /* Replays were checked to match */
+   bool done;
+} runahead_probe_state_t;
+#endif
+
+enum benchmark_stage
+{
+   BENCHMARK_FRAME = 0,
+   BENCHMARK_CORE,
+   BENCHMARK_RUNAHEAD,
+   BENCHMARK_VIDEO,
+   BENCHMARK_AUDIO,
+   BENCHMARK_STAGES
+};
+
+/* Microseconds spent in one stage, over all frames */
+typedef struct benchmark_stage_time
+{
+   retro_time_t total;
+   retro_time_t min;
+   retro_time_t max;
+} benchmark_stage_time_t;
+
+/* State of --benchmark
+ * > 'run' and 'frame' are filled in while a frame
+ *   is made, 'run' being the time spent in retro_run(),
+ *   which includes video and audio */
+typedef struct benchmark_state
+{
+   benchmark_stage_time_t stages[BENCHMARK_STAGES];
+   retro_time_t frame[BENCHMARK_STAGES];
+   retro_time_t run;
+   retro_time_t start;
+   retro_time_t end;
+   uint64_t frames;
+   char output_path[PATH_MAX_LENGTH];
+   bool enable;
+   bool keep_drivers;
+   bool reported;
+} benchmark_state_t;
+
 #ifdef HAVE_RUNAHEAD
 typedef bool(*runahead_load_state_function)(const void*, size_t);
 #endif
@@ -1550,6 +1797,28 @@ struct menu_state
    } entries;
    size_t   selection_ptr;
 
+   /* Last entry that went through menu_cbs_init().
+    * Lists such as playlists and directories append
+    * thousands of entries sharing label, type and enum;
+    * those all bind to the same callbacks, so the next
+    * one copies them instead of running every binder */
+   struct
+   {
+      const file_list_t *list;
+      size_t idx;
+      char menu_label[256];
+   } bind_cache;
+
+   /* Selection being watched by the playlist prefetch,
+    * see menu_driver_prefetch_update() */
+   struct
+   {
+      const file_list_t *list;
+      size_t selection;
+      retro_time_t start_us;
+      bool done;
+   } prefetch;
+
    /* Quick jumping indices with L/R.
     * Rebuilt when parsing directory. */
    struct
@@ -1635,6 +1904,27 @@ typedef struct input_mapper
    input_bits_t buttons[MAX_USERS];
 } input_mapper_t;
 
+/* Per port summary of the binds and remaps, compiled on
+ * every poll so that RetroPad queries can be answered
+ * with a few mask operations instead of walking the
+ * bind and remap tables button by button */
+typedef struct input_remap_plan
+{
+   /* Buttons with a valid bind */
+   uint32_t binds;
+   /* Buttons whose own input is dropped, since they
+    * are remapped to another button */
+   uint32_t remapped;
+   /* Overlay buttons that are not already handled by
+    * the mapper in input_driver_poll() */
+   uint32_t overlay;
+   /* RetroPad state of the current frame, read on
+    * first use */
+   int16_t joypad_state;
+   bool joypad_state_valid;
+   bool valid;
+} input_remap_plan_t;
+
 #ifdef HAVE_DISCORD
 /* The Discord API specifies these variables:
 - userId --------- char[24]   - the userId of the player asking to join
@@ -1673,6 +1963,9 @@ struct runloop
    retro_usec_t frame_time_last;        /* int64_t alignment */
 
    msg_queue_t msg_queue;                        /* ptr alignment */
+   /* Messages pushed from any thread, waiting to
+    * be moved into msg_queue by the main thread */
+   mpsc_queue_t msg_queue_incoming;              /* ptr alignment */
 #ifdef HAVE_THREADS
    slock_t *msg_queue_lock;
 #endif
@@ -1723,16 +2016,32 @@ struct rarch_state
 {
    double audio_source_ratio_original;
    double audio_source_ratio_current;
+   /* Adaptive rate control state: low-passed write_avail
+    * and the learned core/device clock drift */
+   double audio_driver_rate_control_avail;
+   double audio_driver_rate_control_drift;
    struct retro_system_av_info video_driver_av_info; /* double alignment */
 #ifdef HAVE_CRTSWITCHRES
    videocrt_switch_t crt_switch_st;                  /* double alignment */
 #endif
    retro_time_t frame_limit_minimum_time;
    retro_time_t frame_limit_last_time;
+   retro_time_t fastforward_frameskip_last;
    retro_time_t libretro_core_runtime_last;
    retro_time_t libretro_core_runtime_usec;
    retro_time_t video_driver_frame_time_samples[
       MEASURE_FRAME_TIME_SAMPLES_COUNT];
+   frame_delay_auto_state_t frame_delay_auto;   /* retro_time_t alignment */
+   /* Last scanout reported by the context driver */
+   retro_time_t present_timing_last;
+   retro_time_t present_timing_interval;
+   latency_test_state_t latency_test;           /* retro_time_t alignment */
+   benchmark_state_t benchmark;                 /* retro_time_t alignment */
+   frame_telemetry_t frame_telemetry[FRAME_TELEMETRY_COUNT]; /* retro_time_t alignment */
+   uint64_t frame_telemetry_count;
+   /* Start of the work that leads to the next frame */
+   retro_time_t frame_telemetry_start;
+   shader_pass_timing_t shader_pass_timing;    /* retro_time_t alignment */
    struct global              g_extern;         /* retro_time_t alignment */
 #ifdef HAVE_MENU
    menu_input_t menu_input_state;               /* retro_time_t alignment */
@@ -1756,6 +2065,9 @@ struct rarch_state
    struct menu_bind_state menu_input_binds;     /* uint64_t alignment */
 #endif
    struct retro_core_t        current_core;     /* uint64_t alignment */
+   /* Core kept inited across a warm content switch,
+    * until the next core init takes it back */
+   struct retro_core_t        resident_core;    /* uint64_t alignment */
 #if defined(HAVE_RUNAHEAD)
 #if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
    struct retro_core_t secondary_core;          /* uint64_t alignment */
@@ -1842,6 +2154,16 @@ struct rarch_state
    /* Interface for "poking". */
    const video_poke_interface_t *video_driver_poke;
 
+   /* Uploads from video_driver_texture_load_async(),
+    * handed to the driver before the next frame */
+   video_driver_texture_upload_t *video_driver_texture_queue;
+#ifdef HAVE_VIDEO_FRAME_EXPORT
+   video_frame_export_t *video_frame_export;
+#endif
+   size_t video_driver_texture_queue_size;
+   size_t video_driver_texture_queue_cap;
+   video_gpu_mem_state_t video_driver_gpu_mem;  /* ptr alignment */
+
    /* Used for 15-bit -> 16-bit conversions that take place before
     * being passed to video driver. */
    video_pixel_scaler_t *video_driver_scaler_ptr;
@@ -1901,7 +2223,7 @@ struct rarch_state
    frontend_ctx_driver_t *current_frontend_ctx;
 #ifdef HAVE_RUNAHEAD
    my_list *runahead_save_state_list;
-   my_list *input_state_list;
+   input_snapshot_t input_snapshot;
 #endif
 
    struct retro_perf_counter *perf_counters_rarch[MAX_COUNTERS];
@@ -1959,6 +2281,7 @@ struct rarch_state
 #endif
 #ifdef HAVE_DYNAMIC
    dylib_t lib_handle;                                   /* ptr alignment */
+   dylib_t resident_lib_handle;                          /* ptr alignment */
 #endif
 #if defined(HAVE_RUNAHEAD)
 #if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
@@ -2032,6 +2355,12 @@ struct rarch_state
    sthread_tls_t rarch_tls;               /* unsigned alignment */
 #endif
    unsigned fastforward_after_frames;
+   unsigned fastforward_frameskip_count;
+#if defined(HAVE_SLANG) && defined(HAVE_THREADS)
+   /* Bumped for every preset applied, so that only the
+    * most recently requested background compile is applied */
+   unsigned shader_compile_generation;
+#endif
 
 #ifdef HAVE_MENU
    unsigned menu_input_dialog_keyboard_type;
@@ -2044,6 +2373,8 @@ struct rarch_state
 #ifdef HAVE_VIDEO_FILTER
    unsigned video_driver_state_scale;
    unsigned video_driver_state_out_bpp;
+   /* Input scale the video driver was initialised with */
+   unsigned video_driver_input_scale;
 #endif
    unsigned frame_cache_width;
    unsigned frame_cache_height;
@@ -2060,6 +2391,12 @@ struct rarch_state
 #ifdef HAVE_NETWORKING
    unsigned server_port_deferred;
 #endif
+#ifdef HAVE_RUNAHEAD
+   /* Slot of runahead_save_state_list holding the
+    * state of the last 'real' (non-predicted) frame */
+   unsigned runahead_ring_base;
+   runahead_probe_state_t runahead_probe;       /* uint32_t alignment */
+#endif
 
    unsigned audio_driver_free_samples_buf[
       AUDIO_BUFFER_FREE_SAMPLES_COUNT];
@@ -2118,6 +2455,7 @@ struct rarch_state
    gfx_ctx_flags_t deferred_flag_data;          /* uint32_t alignment */
    retro_bits_t has_set_libretro_device;        /* uint32_t alignment */
    input_mapper_t input_driver_mapper;          /* uint32_t alignment */
+   input_remap_plan_t input_driver_remap_plan[MAX_USERS]; /* uint32_t alignment */
 
 
 #ifdef HAVE_BSV_MOVIE
@@ -2140,6 +2478,7 @@ struct rarch_state
    char current_library_version[256];
    char current_valid_extensions[256];
    char launch_arguments[4096];
+   char resident_core_path[PATH_MAX_LENGTH];
    char path_main_basename[8192];
 #if defined(HAVE_CG) || defined(HAVE_GLSL) || defined(HAVE_SLANG) || defined(HAVE_HLSL)
    char cli_shader[PATH_MAX_LENGTH];
@@ -2159,11 +2498,22 @@ struct rarch_state
    char current_savefile_dir[PATH_MAX_LENGTH];
    char current_savestate_dir[PATH_MAX_LENGTH];
    char dir_savestate[PATH_MAX_LENGTH];
+   char sessions_path[PATH_MAX_LENGTH];         /* --sessions list */
+   char boot_trace_path[PATH_MAX_LENGTH];
+   char bundle_shader_path[PATH_MAX_LENGTH];    /* --bundle-shader preset */
+#ifdef HAVE_TRANSLATE
+   /* Luma grid of the last frame sent to the AI service */
+   uint8_t ai_service_signature[
+      AI_SERVICE_SIGNATURE_SIZE * AI_SERVICE_SIGNATURE_SIZE];
+#endif
 
 #ifdef HAVE_GFX_WIDGETS
    bool widgets_active;
    bool widgets_persisting;
 #endif
+#ifdef HAVE_TRANSLATE
+   bool ai_service_signature_valid;
+#endif
 #ifdef HAVE_NETWORKING
 /* Only used before init_netplay */
    bool netplay_enabled;
@@ -2217,6 +2567,8 @@ struct rarch_state
    bool deferred_video_context_driver_set_flags;
    bool ignore_environment_cb;
    bool core_set_shared_context;
+   /* Keep the core inited on the next core deinit */
+   bool core_keep_resident;
 
    /* Graphics driver requires RGBA byte order data (ABGR on little-endian)
     * for 32-bit.
@@ -2258,13 +2610,19 @@ struct rarch_state
    bool camera_driver_active;
 #ifdef HAVE_VIDEO_FILTER
    bool video_driver_state_out_rgb32;
+   bool video_driver_input_rgb32;
 #endif
    bool video_driver_crt_switching_active;
    bool video_driver_threaded;
+#ifdef HAVE_VIDEO_FRAME_EXPORT
+   /* Don't retry creating the export every frame */
+   bool video_frame_export_failed;
+#endif
 
    bool video_started_fullscreen;
 
    bool audio_driver_control;
+   bool audio_driver_control_adaptive;
    bool audio_driver_mute_enable;
    bool audio_driver_use_float;
 
@@ -2301,6 +2659,8 @@ struct rarch_state
    bool menu_input_dialog_keyboard_display;
    /* Is the menu driver still running? */
    bool menu_driver_alive;
+   /* Was menu initialisation left for its first use? */
+   bool menu_driver_deferred;
    /* Are we binding a button inside the menu? */
    bool menu_driver_is_binding;
 #endif
@@ -2315,6 +2675,8 @@ struct rarch_state
 
    bool main_ui_companion_is_on_foreground;
    bool keyboard_mapping_blocked;
+   /* Presents are copied by a compositor, not flipped */
+   bool present_timing_composited;
    retro_bits_512_t keyboard_mapping_bits;
 
 #if defined(HAVE_CG) || defined(HAVE_GLSL) || defined(HAVE_SLANG) || defined(HAVE_HLSL)
@@ -2325,6 +2687,7 @@ struct rarch_state
    bool runahead_available;
    bool runahead_secondary_core_available;
    bool runahead_force_input_dirty;
+   bool runahead_ring_valid;
 #endif
 
 #ifdef HAVE_AUDIOMIXER
@@ -2479,6 +2842,7 @@ static const struct input_bind_map input_config_bind_map[RARCH_BIND_LIST_END_NUL
       DECLARE_META_BIND(2, streaming_toggle,      RARCH_STREAMING_TOGGLE,      MENU_ENUM_LABEL_VALUE_INPUT_META_STREAMING_TOGGLE),
       DECLARE_META_BIND(2, runahead_toggle,       RARCH_RUNAHEAD_TOGGLE,       MENU_ENUM_LABEL_VALUE_INPUT_META_RUNAHEAD_TOGGLE),
       DECLARE_META_BIND(2, ai_service,            RARCH_AI_SERVICE,            MENU_ENUM_LABEL_VALUE_INPUT_META_AI_SERVICE),
+      DECLARE_META_BIND(2, instant_replay_save,   RARCH_INSTANT_REPLAY_SAVE,   MENU_ENUM_LABEL_VALUE_INPUT_META_INSTANT_REPLAY_SAVE),
 };
 
 /* TODO/FIXME - turn these into static global variable */
@@ -0,0 +1,747 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "session_runner.h"
+#include "verbosity.h"
+
+#if defined(HAVE_THREADS) && defined(HAVE_DYNAMIC)
+
+#include <retro_miscellaneous.h>
+#include <libretro.h>
+#include <compat/strl.h>
+#include <dynamic/dylib.h>
+#include <encodings/crc32.h>
+#include <features/features_cpu.h>
+#include <file/file_path.h>
+#include <rthreads/rthreads.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+
+#include "dynamic.h"
+#ifdef HAVE_BSV_MOVIE
+#include "input/bsv/bsv_stream.h"
+#endif
+
+typedef struct session_runner_shared
+{
+   const session_runner_config_t *config;
+   void *content_data;               /* NULL if the core needs the path */
+   int64_t content_size;
+   struct retro_system_info info;
+} session_runner_shared_t;
+
+typedef struct runner_session
+{
+   struct retro_core_t core;
+   char core_path[PATH_MAX_LENGTH];
+   char movie_path[PATH_MAX_LENGTH];
+   const session_runner_shared_t *shared;
+   const char *error;
+   dylib_t lib;
+   sthread_t *thread;
+#ifdef HAVE_BSV_MOVIE
+   bsv_stream_t *movie;
+#endif
+   uintptr_t thread_id;
+   retro_time_t run_time;
+   uint64_t max_frames;              /* 0 to run to the end of the movie */
+   uint64_t frames;
+   unsigned id;
+   unsigned pix_fmt;
+   uint32_t video_crc;
+   uint32_t state_crc;
+   bool is_copy;                     /* 'core_path' gets deleted */
+   bool movie_ended;
+} runner_session_t;
+
+/* Libretro callbacks carry no context, they find
+ * the session from the thread calling them */
+#ifdef HAVE_THREAD_STORAGE
+static sthread_tls_t session_runner_tls;
+#else
+static slock_t *session_runner_lock      = NULL;
+#endif
+static runner_session_t *session_runner_list = NULL;
+static unsigned session_runner_count     = 0;
+
+static void session_runner_set_current(runner_session_t *s)
+{
+#ifdef HAVE_THREAD_STORAGE
+   sthread_tls_set(&session_runner_tls, s);
+#else
+   slock_lock(session_runner_lock);
+   s->thread_id = sthread_get_current_thread_id();
+   slock_unlock(session_runner_lock);
+#endif
+}
+
+static runner_session_t *session_runner_current(void)
+{
+#ifdef HAVE_THREAD_STORAGE
+   return (runner_session_t*)sthread_tls_get(&session_runner_tls);
+#else
+   unsigned i;
+   runner_session_t *s = NULL;
+   uintptr_t id        = sthread_get_current_thread_id();
+
+   slock_lock(session_runner_lock);
+   for (i = 0; i < session_runner_count; i++)
+   {
+      if (session_runner_list[i].thread_id == id)
+      {
+         s = &session_runner_list[i];
+         break;
+      }
+   }
+   slock_unlock(session_runner_lock);
+   return s;
+#endif
+}
+
+static void session_runner_log(enum retro_log_level level,
+      const char *fmt, ...)
+{
+   va_list vp;
+   runner_session_t *s = session_runner_current();
+
+   if (!s || (unsigned)level < s->shared->config->log_level)
+      return;
+
+   if (!verbosity_is_enabled())
+      return;
+
+   va_start(vp, fmt);
+
+   switch (level)
+   {
+      case RETRO_LOG_DEBUG:
+         RARCH_LOG_V("[libretro DEBUG]", fmt, vp);
+         break;
+      case RETRO_LOG_INFO:
+         RARCH_LOG_OUTPUT_V("[libretro INFO]", fmt, vp);
+         break;
+      case RETRO_LOG_WARN:
+         RARCH_WARN_V("[libretro WARN]", fmt, vp);
+         break;
+      case RETRO_LOG_ERROR:
+         RARCH_ERR_V("[libretro ERROR]", fmt, vp);
+         break;
+      default:
+         break;
+   }
+
+   va_end(vp);
+}
+
+/* Just enough of an environment for a headless,
+ * software rendered session */
+static bool session_runner_environment(unsigned cmd, void *data)
+{
+   runner_session_t *s = session_runner_current();
+
+   if (!s)
+      return false;
+
+   switch (cmd)
+   {
+      case RETRO_ENVIRONMENT_GET_CAN_DUPE:
+         *(bool*)data = true;
+         break;
+      case RETRO_ENVIRONMENT_SET_PIXEL_FORMAT:
+         {
+            enum retro_pixel_format pix_fmt =
+               *(const enum retro_pixel_format*)data;
+
+            switch (pix_fmt)
+            {
+               case RETRO_PIXEL_FORMAT_0RGB1555:
+               case RETRO_PIXEL_FORMAT_RGB565:
+               case RETRO_PIXEL_FORMAT_XRGB8888:
+                  s->pix_fmt = pix_fmt;
+                  break;
+               default:
+                  return false;
+            }
+         }
+         break;
+      case RETRO_ENVIRONMENT_GET_SYSTEM_DIRECTORY:
+         *(const char**)data = s->shared->config->system_dir;
+         break;
+      case RETRO_ENVIRONMENT_GET_SAVE_DIRECTORY:
+         *(const char**)data = s->shared->config->save_dir;
+         break;
+      case RETRO_ENVIRONMENT_GET_LIBRETRO_PATH:
+         *(const char**)data = s->core_path;
+         break;
+      case RETRO_ENVIRONMENT_GET_LOG_INTERFACE:
+         ((struct retro_log_callback*)data)->log = session_runner_log;
+         break;
+      case RETRO_ENVIRONMENT_GET_LANGUAGE:
+         *(unsigned*)data = RETRO_LANGUAGE_ENGLISH;
+         break;
+      case RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE:
+         *(bool*)data = false;
+         break;
+      case RETRO_ENVIRONMENT_GET_INPUT_BITMASKS:
+      case RETRO_ENVIRONMENT_SET_SUPPORT_NO_GAME:
+      case RETRO_ENVIRONMENT_SET_GEOMETRY:
+      case RETRO_ENVIRONMENT_SET_SYSTEM_AV_INFO:
+      case RETRO_ENVIRONMENT_SET_MESSAGE:
+      case RETRO_ENVIRONMENT_SET_PERFORMANCE_LEVEL:
+      case RETRO_ENVIRONMENT_SET_INPUT_DESCRIPTORS:
+      case RETRO_ENVIRONMENT_SET_CONTROLLER_INFO:
+         break;
+      default:
+         /* Core options keep their defaults, hardware
+          * rendering is refused */
+         return false;
+   }
+
+   return true;
+}
+
+static void session_runner_video_refresh(const void *data,
+      unsigned width, unsigned height, size_t pitch)
+{
+   unsigned y;
+   size_t row_size;
+   uint32_t crc        = 0;
+   const uint8_t *src  = (const uint8_t*)data;
+   runner_session_t *s = session_runner_current();
+
+   /* Duped frames keep the previous CRC */
+   if (!s || !src)
+      return;
+
+   row_size = width *
+      ((s->pix_fmt == RETRO_PIXEL_FORMAT_XRGB8888) ? 4 : 2);
+
+   for (y = 0; y < height; y++, src += pitch)
+      crc = encoding_crc32(crc, src, row_size);
+
+   s->video_crc = crc;
+}
+
+static void session_runner_audio_sample(int16_t left, int16_t right) { }
+
+static size_t session_runner_audio_sample_batch(
+      const int16_t *data, size_t frames)
+{
+   return frames;
+}
+
+static void session_runner_input_poll(void) { }
+
+static int16_t session_runner_input_state(unsigned port,
+      unsigned device, unsigned idx, unsigned id)
+{
+#ifdef HAVE_BSV_MOVIE
+   int16_t value       = 0;
+   runner_session_t *s = session_runner_current();
+
+   if (!s || !s->movie || s->movie_ended)
+      return 0;
+
+   if (!bsv_stream_read_input(s->movie, &value))
+   {
+      s->movie_ended = true;
+      return 0;
+   }
+
+   return value;
+#else
+   return 0;
+#endif
+}
+
+#ifdef HAVE_BSV_MOVIE
+static bool session_runner_unserialize(const void *data, size_t size)
+{
+   runner_session_t *s = session_runner_current();
+   return s && s->core.retro_unserialize(data, size);
+}
+#endif
+
+#define SESSION_SYMBOL(x) do { \
+   function_t func = dylib_proc(s->lib, #x); \
+   memcpy(&s->core.x, &func, sizeof(func)); \
+   if (!s->core.x) \
+   { \
+      RARCH_ERR("[Sessions]: Failed to load symbol: \"%s\"\n", #x); \
+      return false; \
+   } \
+} while (0)
+
+static bool session_runner_load_core(runner_session_t *s)
+{
+   if (!(s->lib = dylib_load(s->core_path)))
+   {
+      RARCH_ERR("[Sessions]: Could not load \"%s\": %s\n",
+            s->core_path, dylib_error());
+      return false;
+   }
+
+   SESSION_SYMBOL(retro_init);
+   SESSION_SYMBOL(retro_deinit);
+   SESSION_SYMBOL(retro_api_version);
+   SESSION_SYMBOL(retro_get_system_info);
+   SESSION_SYMBOL(retro_get_system_av_info);
+   SESSION_SYMBOL(retro_set_environment);
+   SESSION_SYMBOL(retro_set_video_refresh);
+   SESSION_SYMBOL(retro_set_audio_sample);
+   SESSION_SYMBOL(retro_set_audio_sample_batch);
+   SESSION_SYMBOL(retro_set_input_poll);
+   SESSION_SYMBOL(retro_set_input_state);
+   SESSION_SYMBOL(retro_run);
+   SESSION_SYMBOL(retro_serialize_size);
+   SESSION_SYMBOL(retro_serialize);
+   SESSION_SYMBOL(retro_unserialize);
+   SESSION_SYMBOL(retro_load_game);
+   SESSION_SYMBOL(retro_unload_game);
+
+   if (s->core.retro_api_version() != RETRO_API_VERSION)
+   {
+      RARCH_ERR("[Sessions]: \"%s\" has the wrong API version.\n",
+            s->core_path);
+      return false;
+   }
+
+   return true;
+}
+
+static void session_runner_thread(void *data)
+{
+   struct retro_game_info game;
+   runner_session_t *s                 = (runner_session_t*)data;
+   const session_runner_shared_t *sh   = s->shared;
+   const char *content_path            = sh->config->content_path;
+   bool has_content                    = !string_is_empty(content_path);
+   retro_time_t start;
+
+   session_runner_set_current(s);
+
+   s->core.retro_set_environment(session_runner_environment);
+   s->core.retro_init();
+   s->core.retro_set_video_refresh(session_runner_video_refresh);
+   s->core.retro_set_audio_sample(session_runner_audio_sample);
+   s->core.retro_set_audio_sample_batch(session_runner_audio_sample_batch);
+   s->core.retro_set_input_poll(session_runner_input_poll);
+   s->core.retro_set_input_state(session_runner_input_state);
+
+   game.path = content_path;
+   game.data = sh->content_data;
+   game.size = (size_t)sh->content_size;
+   game.meta = NULL;
+
+   if (!s->core.retro_load_game(has_content ? &game : NULL))
+   {
+      s->error = "content failed to load";
+      goto end;
+   }
+
+#ifdef HAVE_BSV_MOVIE
+   if (!string_is_empty(s->movie_path))
+   {
+      if (!(s->movie = bsv_stream_open_read(s->movie_path, 0,
+                  s->core.retro_serialize_size(),
+                  session_runner_unserialize)))
+      {
+         s->error = "movie failed to open";
+         goto unload;
+      }
+   }
+#endif
+
+   start = cpu_features_get_time_usec();
+
+   while (!s->movie_ended
+         && (!s->max_frames || s->frames < s->max_frames))
+   {
+#ifdef HAVE_BSV_MOVIE
+      if (s->movie)
+         bsv_stream_frame_start(s->movie);
+#endif
+      s->core.retro_run();
+      s->frames++;
+   }
+
+   s->run_time = cpu_features_get_time_usec() - start;
+
+   {
+      size_t state_size = s->core.retro_serialize_size();
+      void *state       = state_size ? malloc(state_size) : NULL;
+
+      if (state && s->core.retro_serialize(state, state_size))
+         s->state_crc = encoding_crc32(0, (const uint8_t*)state, state_size);
+      free(state);
+   }
+
+#ifdef HAVE_BSV_MOVIE
+   if (s->movie)
+      bsv_stream_close(s->movie);
+   s->movie = NULL;
+
+unload:
+#endif
+   s->core.retro_unload_game();
+end:
+   s->core.retro_deinit();
+}
+
+/* Reads the session list, returns the number of
+ * sessions or 0 on error */
+static unsigned session_runner_parse_list(const char *path,
+      runner_session_t **list)
+{
+   char *buf          = NULL;
+   char *line         = NULL;
+   int64_t len        = 0;
+   unsigned count     = 0;
+   unsigned lines     = 1;
+   runner_session_t *sessions;
+
+   if (!filestream_read_file(path, (void**)&buf, &len))
+   {
+      RARCH_ERR("[Sessions]: Could not read \"%s\".\n", path);
+      return 0;
+   }
+
+   for (line = buf; *line; line++)
+      if (*line == '\n')
+         lines++;
+
+   if (!(sessions = (runner_session_t*)calloc(lines, sizeof(*sessions))))
+   {
+      free(buf);
+      return 0;
+   }
+
+   for (line = buf; line; )
+   {
+      char *next  = strchr(line, '\n');
+      char *frames_end;
+      char *movie;
+      runner_session_t *s;
+
+      if (next)
+         *next++ = '\0';
+
+      string_trim_whitespace(line);
+
+      if (*line && *line != '#')
+      {
+         s             = &sessions[count];
+         s->max_frames = strtoull(line, &frames_end, 10);
+         movie         = frames_end;
+
+         while (*movie == ' ' || *movie == '\t')
+            movie++;
+
+         if (frames_end == line || (*movie && movie == frames_end))
+         {
+            RARCH_ERR("[Sessions]: Bad line in \"%s\": %s\n", path, line);
+            count = 0;
+            break;
+         }
+
+         strlcpy(s->movie_path, movie, sizeof(s->movie_path));
+         s->id = count++;
+      }
+
+      line = next;
+   }
+
+   free(buf);
+
+   if (!count)
+   {
+      free(sessions);
+      return 0;
+   }
+
+   *list = sessions;
+   return count;
+}
+
+/* Gives every session past the first its own copy
+ * of the core library */
+static bool session_runner_copy_cores(runner_session_t *sessions,
+      unsigned count, const session_runner_config_t *config)
+{
+   char tmp_path[PATH_MAX_LENGTH];
+   unsigned i;
+   void *core_data   = NULL;
+   int64_t core_size = 0;
+   const char *name  = path_basename(config->core_path);
+
+   strlcpy(sessions[0].core_path, config->core_path,
+         sizeof(sessions[0].core_path));
+
+   if (count < 2)
+      return true;
+
+   fill_pathname_join(tmp_path,
+         string_is_empty(config->tmp_dir) ? "/tmp" : config->tmp_dir,
+         "retroarch_sessions", sizeof(tmp_path));
+
+   if (!path_mkdir(tmp_path))
+   {
+      RARCH_ERR("[Sessions]: Could not create \"%s\".\n", tmp_path);
+      return false;
+   }
+
+   if (!filestream_read_file(config->core_path, &core_data, &core_size))
+   {
+      RARCH_ERR("[Sessions]: Could not read \"%s\".\n", config->core_path);
+      return false;
+   }
+
+   for (i = 1; i < count; i++)
+   {
+      char copy_name[PATH_MAX_LENGTH];
+      runner_session_t *s = &sessions[i];
+
+      snprintf(copy_name, sizeof(copy_name), "%u_%s", i, name);
+      fill_pathname_join(s->core_path, tmp_path, copy_name,
+            sizeof(s->core_path));
+
+      if (!filestream_write_file(s->core_path, core_data, core_size))
+      {
+         RARCH_ERR("[Sessions]: Could not write \"%s\".\n", s->core_path);
+         break;
+      }
+
+      s->is_copy = true;
+   }
+
+   free(core_data);
+   return i == count;
+}
+
+static void session_runner_report(const session_runner_config_t *config,
+      const session_runner_shared_t *sh, runner_session_t *sessions,
+      unsigned count, retro_time_t wall_time)
+{
+   unsigned i;
+   size_t len    = 0;
+   size_t size   = 1024 + count * (PATH_MAX_LENGTH + 512);
+   char *report  = (char*)malloc(size);
+
+   if (!report)
+      return;
+
+   len += snprintf(report + len, size - len,
+         "{\n"
+         "  \"core\": \"%s\",\n"
+         "  \"core_version\": \"%s\",\n"
+         "  \"content\": \"%s\",\n"
+         "  \"wall_time_us\": %" PRId64 ",\n"
+         "  \"sessions\": [\n",
+         sh->info.library_name ? sh->info.library_name : "",
+         sh->info.library_version ? sh->info.library_version : "",
+         string_is_empty(config->content_path)
+         ? "" : path_basename(config->content_path),
+         (int64_t)wall_time);
+
+   for (i = 0; i < count && len < size; i++)
+   {
+      const runner_session_t *s = &sessions[i];
+
+      len += snprintf(report + len, size - len,
+            "    { \"id\": %u, \"movie\": \"%s\", \"frames\": %" PRIu64
+            ", \"run_us\": %" PRId64 ", \"fps\": %.2f"
+            ", \"movie_ended\": %s, \"video_crc\": \"%08x\""
+            ", \"state_crc\": \"%08x\", \"error\": %s%s%s }%s\n",
+            s->id,
+            string_is_empty(s->movie_path) ? "" : path_basename(s->movie_path),
+            s->frames,
+            (int64_t)s->run_time,
+            s->run_time > 0 ? (double)s->frames * 1000000.0 / s->run_time : 0.0,
+            s->movie_ended ? "true" : "false",
+            s->video_crc,
+            s->state_crc,
+            s->error ? "\"" : "",
+            s->error ? s->error : "null",
+            s->error ? "\"" : "",
+            (i + 1 < count) ? "," : "");
+   }
+
+   if (len < size)
+      snprintf(report + len, size - len, "  ]\n}\n");
+
+   if (!string_is_empty(config->output_path))
+   {
+      if (filestream_write_file(config->output_path, report, strlen(report)))
+      {
+         free(report);
+         return;
+      }
+
+      RARCH_ERR("[Sessions]: Could not write \"%s\".\n",
+            config->output_path);
+   }
+
+   fputs(report, stdout);
+   fflush(stdout);
+   free(report);
+}
+
+bool session_runner_run(const session_runner_config_t *config)
+{
+   unsigned i;
+   retro_time_t start;
+   session_runner_shared_t shared;
+   runner_session_t *sessions = NULL;
+   unsigned count             = 0;
+   bool ok                    = false;
+
+   memset(&shared, 0, sizeof(shared));
+   shared.config = config;
+
+   if (string_is_empty(config->core_path))
+   {
+      RARCH_ERR("[Sessions]: No core given, use -L.\n");
+      return false;
+   }
+
+   if (!(count = session_runner_parse_list(config->list_path, &sessions)))
+      return false;
+
+   for (i = 0; i < count; i++)
+   {
+      sessions[i].shared = &shared;
+
+      if (!sessions[i].max_frames && string_is_empty(sessions[i].movie_path))
+      {
+         RARCH_ERR("[Sessions]: Session %u has neither frames nor a movie.\n", i);
+         goto end;
+      }
+#ifdef HAVE_BSV_MOVIE
+      if (     !string_is_empty(sessions[i].movie_path)
+            && !bsv_stream_probe(sessions[i].movie_path))
+      {
+         RARCH_ERR("[Sessions]: \"%s\" is not a BSV2 movie.\n",
+               sessions[i].movie_path);
+         goto end;
+      }
+#else
+      if (!string_is_empty(sessions[i].movie_path))
+      {
+         RARCH_ERR("[Sessions]: Movies are not supported by this build.\n");
+         goto end;
+      }
+#endif
+   }
+
+   if (!session_runner_copy_cores(sessions, count, config))
+      goto end;
+
+   for (i = 0; i < count; i++)
+      if (!session_runner_load_core(&sessions[i]))
+         goto end;
+
+   sessions[0].core.retro_get_system_info(&shared.info);
+
+   /* Loaded once, every session reads the same copy */
+   if (     !string_is_empty(config->content_path)
+         && !shared.info.need_fullpath)
+   {
+      if (!filestream_read_file(config->content_path,
+               &shared.content_data, &shared.content_size))
+      {
+         RARCH_ERR("[Sessions]: Could not read \"%s\".\n",
+               config->content_path);
+         goto end;
+      }
+   }
+
+#ifdef HAVE_THREAD_STORAGE
+   if (!sthread_tls_create(&session_runner_tls))
+      goto end;
+#else
+   if (!(session_runner_lock = slock_new()))
+      goto end;
+#endif
+
+   session_runner_list  = sessions;
+   session_runner_count = count;
+
+   RARCH_LOG("[Sessions]: Running %u sessions of \"%s\".\n",
+         count, config->core_path);
+
+   start = cpu_features_get_time_usec();
+
+   for (i = 0; i < count; i++)
+   {
+      if (!(sessions[i].thread = sthread_create(
+                  session_runner_thread, &sessions[i])))
+         sessions[i].error = "thread failed to start";
+   }
+
+   for (i = 0; i < count; i++)
+      if (sessions[i].thread)
+         sthread_join(sessions[i].thread);
+
+   session_runner_report(config, &shared, sessions, count,
+         cpu_features_get_time_usec() - start);
+
+   session_runner_list  = NULL;
+   session_runner_count = 0;
+
+#ifdef HAVE_THREAD_STORAGE
+   sthread_tls_delete(&session_runner_tls);
+#else
+   slock_free(session_runner_lock);
+   session_runner_lock  = NULL;
+#endif
+
+   ok = true;
+   for (i = 0; i < count; i++)
+      if (sessions[i].error)
+         ok = false;
+
+end:
+   /* Library strings of the system info go away with
+    * the first core */
+   for (i = count; i-- > 0; )
+   {
+      if (sessions[i].lib)
+         dylib_close(sessions[i].lib);
+      if (sessions[i].is_copy)
+         filestream_delete(sessions[i].core_path);
+   }
+
+   free(shared.content_data);
+   free(sessions);
+   return ok;
+}
+
+#else
+
+bool session_runner_run(const session_runner_config_t *config)
+{
+   RARCH_ERR("[Sessions]: Not supported by this build.\n");
+   return false;
+}
+
+#endif
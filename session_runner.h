@@ -0,0 +1,70 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SESSION_RUNNER_H
+#define __SESSION_RUNNER_H
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* Session runner
+ *
+ * Runs several headless instances of one core side by
+ * side, each on its own thread, to save the startup of
+ * a process per test. Sessions are listed one per line
+ * in a text file:
+ *
+ *    <frames> [<BSV2 movie>]
+ *
+ * A movie supplies the input of its session, which then
+ * stops at the end of the movie when 'frames' is 0. Lines
+ * starting with '#' are ignored.
+ *
+ * Libretro cores keep their state in globals, so every
+ * session past the first loads its own copy of the core
+ * library. The core's system info and the content, when
+ * the core can load it from memory, are only read once.
+ *
+ * The results, including a CRC of the last frame and of
+ * the final savestate of every session, are written as
+ * JSON. */
+
+typedef struct session_runner_config
+{
+   const char *core_path;
+   const char *content_path;     /* may be NULL */
+   const char *list_path;
+   const char *output_path;      /* NULL for stdout */
+   const char *tmp_dir;          /* where core copies go */
+   const char *system_dir;
+   const char *save_dir;
+   unsigned log_level;           /* of core messages */
+} session_runner_config_t;
+
+/**
+ * session_runner_run:
+ * @config             : what to run
+ *
+ * Runs every session of @config->list_path to completion
+ * and writes the report.
+ *
+ * Returns: true if all sessions ran without error.
+ **/
+bool session_runner_run(const session_runner_config_t *config);
+
+RETRO_END_DECLS
+
+#endif
@@ -26,6 +26,10 @@
 #include <retro_inline.h>
 #include <compat/strl.h>
 #include <compat/intrinsics.h>
+#include <features/features_cpu.h>
+#ifdef HAVE_MEMMAP
+#include <memmap.h>
+#endif
 
 #include "state_manager.h"
 #include "msg_hash.h"
@@ -59,10 +63,25 @@
 #define NO_UNALIGNED_MEM
 #endif
 
-#if __SSE2__
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif __SSE2__
 #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define STATE_MANAGER_NEON
 #endif
 
+/* Largest vector read done by find_change()/find_same(),
+ * which may read this far past the end-of-state sentinels. */
+#define STATE_MANAGER_SIMD_PADDING 32
+
+/* Tiered rewind: frames each checkpoint is shown for while
+ * rewinding through them, and the fraction of the rewind
+ * buffer (1/N) they are kept in */
+#define STATE_MANAGER_CHECKPOINT_HOLD  10
+#define STATE_MANAGER_CHECKPOINT_SHARE 4
+
 /* Format per frame (pseudocode): */
 #if 0
 size nextstart;
@@ -87,7 +106,28 @@ size thisstart;
  * std::mismatch exists, but it's not optimized at all. */
 static size_t find_change(const uint16_t *a, const uint16_t *b)
 {
-#if __SSE2__
+#if defined(__AVX2__)
+   const __m256i *a256 = (const __m256i*)a;
+   const __m256i *b256 = (const __m256i*)b;
+
+   for (;;)
+   {
+      __m256i v0    = _mm256_loadu_si256(a256);
+      __m256i v1    = _mm256_loadu_si256(b256);
+      __m256i c     = _mm256_cmpeq_epi8(v0, v1);
+      uint32_t mask = (uint32_t)_mm256_movemask_epi8(c);
+
+      if (mask != 0xffffffff)
+      {
+         size_t ret = (((uint8_t*)a256 - (uint8_t*)a) |
+               (compat_ctz(~mask)));
+         return (ret >> 1);
+      }
+
+      a256++;
+      b256++;
+   }
+#elif __SSE2__
    const __m128i *a128 = (const __m128i*)a;
    const __m128i *b128 = (const __m128i*)b;
 
@@ -111,6 +151,29 @@ static size_t find_change(const uint16_t *a, const uint16_t *b)
       a128++;
       b128++;
    }
+#elif defined(STATE_MANAGER_NEON)
+   const uint8_t *a8 = (const uint8_t*)a;
+   const uint8_t *b8 = (const uint8_t*)b;
+
+   for (;;)
+   {
+      uint8x16_t c  = vceqq_u8(vld1q_u8(a8), vld1q_u8(b8));
+      /* Narrow to 4 bits per byte, 0xf for equal bytes */
+      uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(
+               vshrn_n_u16(vreinterpretq_u16_u8(c), 4)), 0);
+
+      if (mask != UINT64_C(0xffffffffffffffff))
+      {
+         uint32_t lo = ~(uint32_t)mask;
+         size_t ret  = (a8 - (const uint8_t*)a) + (lo
+               ? (compat_ctz(lo) >> 2)
+               : 8 + (compat_ctz(~(uint32_t)(mask >> 32)) >> 2));
+         return (ret >> 1);
+      }
+
+      a8 += 16;
+      b8 += 16;
+   }
 #else
    const uint16_t *a_org = a;
 #ifdef NO_UNALIGNED_MEM
@@ -146,6 +209,56 @@ static size_t find_change(const uint16_t *a, const uint16_t *b)
 static size_t find_same(const uint16_t *a, const uint16_t *b)
 {
    const uint16_t *a_org = a;
+#if defined(__AVX2__) || __SSE2__ || defined(STATE_MANAGER_NEON)
+   /* Same as the scalar loop below, four 32-bit words at a time */
+   if (*a != *b)
+   {
+      const uint32_t *a_big = (const uint32_t*)a;
+      const uint32_t *b_big = (const uint32_t*)b;
+
+      for (;;)
+      {
+#if defined(STATE_MANAGER_NEON)
+         uint32x4_t c  = vceqq_u32(
+               vreinterpretq_u32_u8(vld1q_u8((const uint8_t*)a_big)),
+               vreinterpretq_u32_u8(vld1q_u8((const uint8_t*)b_big)));
+         uint64_t mask = vget_lane_u64(vreinterpret_u64_u16(
+                  vmovn_u32(c)), 0);
+
+         if (mask)
+         {
+            uint32_t lo = (uint32_t)mask;
+            a_big      += lo
+               ? (compat_ctz(lo) >> 4)
+               : 2 + (compat_ctz((uint32_t)(mask >> 32)) >> 4);
+            break;
+         }
+#else
+         __m128i c     = _mm_cmpeq_epi32(
+               _mm_loadu_si128((const __m128i*)a_big),
+               _mm_loadu_si128((const __m128i*)b_big));
+         unsigned mask = (unsigned)_mm_movemask_ps(_mm_castsi128_ps(c));
+
+         if (mask)
+         {
+            a_big     += compat_ctz(mask);
+            break;
+         }
+#endif
+         a_big += 4;
+         b_big += 4;
+      }
+
+      a = (const uint16_t*)a_big;
+      b = b + (a - a_org);
+
+      if (a != a_org && a[-1] == b[-1])
+      {
+         a--;
+         b--;
+      }
+   }
+#else
 #ifdef NO_UNALIGNED_MEM
    if (((uintptr_t)a & (sizeof(uint32_t) - 1)) && *a != *b)
    {
@@ -180,12 +293,13 @@ static size_t find_same(const uint16_t *a, const uint16_t *b)
          b--;
       }
    }
+#endif
    return a - a_org;
 }
 
 /* Returns the maximum compressed size of a savestate.
  * It is very likely to compress to far less. */
-static size_t state_manager_raw_maxsize(size_t uncomp)
+size_t state_manager_raw_maxsize(size_t uncomp)
 {
    /* bytes covered by a compressed block */
    const int maxcblkcover = UINT16_MAX * sizeof(uint16_t);
@@ -201,10 +315,11 @@ static size_t state_manager_raw_maxsize(size_t uncomp)
  * See state_manager_raw_compress for information about this.
  * When you're done with it, send it to free().
  */
-static void *state_manager_raw_alloc(size_t len, uint16_t uniq)
+void *state_manager_raw_alloc(size_t len, uint16_t uniq)
 {
    size_t  len16 = (len + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
-   uint16_t *ret = (uint16_t*)calloc(len16 + sizeof(uint16_t) * 4 + 16, 1);
+   uint16_t *ret = (uint16_t*)calloc(len16 + sizeof(uint16_t) * 4
+         + STATE_MANAGER_SIMD_PADDING, 1);
 
    /* Force in a different byte at the end, so we don't need to check
     * bounds in the innermost loop (it's expensive).
@@ -215,7 +330,7 @@ static void *state_manager_raw_alloc(size_t len, uint16_t uniq)
     * There is also some padding at the end. This is so we don't
     * read outside the buffer end if we're reading in large blocks;
     *
-    * It doesn't make any difference to us, but sacrificing 16 bytes to get
+    * It doesn't make any difference to us, but sacrificing a few bytes to get
     * Valgrind happy is worth it. */
    ret[len16/sizeof(uint16_t) + 3] = uniq;
 
@@ -230,7 +345,7 @@ static void *state_manager_raw_alloc(size_t len, uint16_t uniq)
  * 'patch' must be size 'state_manager_raw_maxsize(len)' or more.
  * Returns the number of bytes actually written to 'patch'.
  */
-static size_t state_manager_raw_compress(const void *src,
+size_t state_manager_raw_compress(const void *src,
       const void *dst, size_t len, void *patch)
 {
    const uint16_t  *old16 = (const uint16_t*)src;
@@ -335,6 +450,64 @@ static void state_manager_raw_decompress(const void *patch,
    }
 }
 
+/*
+ * Same as state_manager_raw_decompress(), but for patches from an
+ * untrusted source: validates every run against 'patchlen' and
+ * 'datalen' and returns false, possibly having modified 'data',
+ * if the patch does not fit.
+ */
+bool state_manager_raw_decompress_checked(const void *patch,
+      size_t patchlen, void *data, size_t datalen)
+{
+   uint16_t         *out16 = (uint16_t*)data;
+   const uint16_t *patch16 = (const uint16_t*)patch;
+   size_t          patch16s = patchlen / sizeof(uint16_t);
+   size_t          data16s  = datalen  / sizeof(uint16_t);
+   size_t          in       = 0;
+   size_t          out      = 0;
+
+   for (;;)
+   {
+      uint16_t numchanged;
+
+      if (in >= patch16s)
+         return false;
+      numchanged = patch16[in++];
+
+      if (numchanged)
+      {
+         uint16_t i;
+
+         if (in + 1 + numchanged > patch16s)
+            return false;
+         out += patch16[in++];
+         if (out > data16s || numchanged > data16s - out)
+            return false;
+
+         for (i = 0; i < numchanged; i++)
+            out16[out + i] = patch16[in + i];
+
+         in  += numchanged;
+         out += numchanged;
+      }
+      else
+      {
+         uint32_t numunchanged;
+
+         if (in + 2 > patch16s)
+            return false;
+         numunchanged = patch16[in] | (patch16[in + 1] << 16);
+
+         if (!numunchanged)
+            return true;
+         in  += 2;
+         out += numunchanged;
+         if (out > data16s)
+            return false;
+      }
+   }
+}
+
 /* The start offsets point to 'nextstart' of any given compressed frame.
  * Each uint16 is stored native endian; anything that claims any other
  * endianness refers to the endianness of this specific item.
@@ -370,13 +543,56 @@ static INLINE size_t read_size_t(const void *ptr)
    return ret;
 }
 
+#ifdef HAVE_THREADS
+/* Waits until the state handed to the compression thread,
+ * if any, has been written to the buffer. */
+static void state_manager_wait(state_manager_t *state)
+{
+   if (!state->thread)
+      return;
+
+   slock_lock(state->lock);
+   while (state->pendingblock)
+      scond_wait(state->cond, state->lock);
+   slock_unlock(state->lock);
+}
+#endif
+
 static void state_manager_free(state_manager_t *state)
 {
    if (!state)
       return;
 
+#ifdef HAVE_THREADS
+   if (state->thread)
+   {
+      slock_lock(state->lock);
+      state->thread_alive = false;
+      scond_signal(state->cond);
+      slock_unlock(state->lock);
+      sthread_join(state->thread);
+      state->thread       = NULL;
+   }
+   if (state->cond)
+      scond_free(state->cond);
+   if (state->lock)
+      slock_free(state->lock);
+   if (state->spareblock)
+      free(state->spareblock);
+   if (state->pendingblock)
+      free(state->pendingblock);
+   state->cond         = NULL;
+   state->lock         = NULL;
+   state->spareblock   = NULL;
+   state->pendingblock = NULL;
+#endif
+
    if (state->data)
+#ifdef HAVE_MEMMAP
+      memmap_free_large(state->data);
+#else
       free(state->data);
+#endif
    if (state->thisblock)
       free(state->thisblock);
    if (state->nextblock)
@@ -391,8 +607,96 @@ static void state_manager_free(state_manager_t *state)
    state->nextblock  = NULL;
 }
 
+/* Compresses 'block' against the last pushed state
+ * and makes it the new last pushed state.
+ * Returns the buffer which is no longer in use. */
+static uint8_t *state_manager_push_block(state_manager_t *state,
+      uint8_t *block)
+{
+   uint8_t *swap = NULL;
+
+   if (state->thisblock_valid)
+   {
+      const uint8_t *oldb, *newb;
+      uint8_t *compressed;
+      size_t headpos, tailpos, remaining;
+      if (state->capacity < sizeof(size_t) + state->maxcompsize)
+         return block;
+
+recheckcapacity:;
+      headpos   = state->head - state->data;
+      tailpos   = state->tail - state->data;
+      remaining = (tailpos + state->capacity -
+            sizeof(size_t) - headpos - 1) % state->capacity + 1;
+
+      if (remaining <= state->maxcompsize)
+      {
+         state->tail = state->data + read_size_t(state->tail);
+         state->entries--;
+         goto recheckcapacity;
+      }
+
+      oldb              = state->thisblock;
+      newb              = block;
+      compressed        = state->head + sizeof(size_t);
+
+      compressed       += state_manager_raw_compress(oldb, newb,
+            state->blocksize, compressed);
+
+      if (compressed - state->data + state->maxcompsize > state->capacity)
+      {
+         compressed     = state->data;
+         if (state->tail == state->data + sizeof(size_t))
+            state->tail = state->data + read_size_t(state->tail);
+      }
+      write_size_t(compressed, state->head-state->data);
+      compressed       += sizeof(size_t);
+      write_size_t(state->head, compressed-state->data);
+      state->head       = compressed;
+   }
+   else
+      state->thisblock_valid = true;
+
+   swap                      = state->thisblock;
+   state->thisblock          = block;
+
+   state->entries++;
+
+   return swap;
+}
+
+#ifdef HAVE_THREADS
+static void state_manager_thread(void *data)
+{
+   state_manager_t *state = (state_manager_t*)data;
+
+   for (;;)
+   {
+      uint8_t *block = NULL;
+      uint8_t *freed = NULL;
+
+      slock_lock(state->lock);
+      while (state->thread_alive && !state->pendingblock)
+         scond_wait(state->cond, state->lock);
+      block = state->pendingblock;
+      slock_unlock(state->lock);
+
+      if (!block)
+         break;
+
+      freed = state_manager_push_block(state, block);
+
+      slock_lock(state->lock);
+      state->spareblock   = freed;
+      state->pendingblock = NULL;
+      scond_signal(state->cond);
+      slock_unlock(state->lock);
+   }
+}
+#endif
+
 static state_manager_t *state_manager_new(
-      size_t state_size, size_t buffer_size)
+      size_t state_size, size_t buffer_size, bool lock_memory)
 {
    size_t max_comp_size, block_size;
    uint8_t *next_block    = NULL;
@@ -406,7 +710,13 @@ static state_manager_t *state_manager_new(
    block_size         = (state_size + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
    /* the compressed data is surrounded by pointers to the other side */
    max_comp_size      = state_manager_raw_maxsize(state_size) + sizeof(size_t) * 2;
+#ifdef HAVE_MEMMAP
+   /* Touched all over every frame; huge pages spare TLB misses */
+   state_data         = (uint8_t*)memmap_alloc_large(buffer_size,
+         lock_memory ? (MEMMAP_LARGE_PREFAULT | MEMMAP_LARGE_LOCK) : 0);
+#else
    state_data         = (uint8_t*)malloc(buffer_size);
+#endif
 
    if (!state_data)
       goto error;
@@ -432,11 +742,34 @@ static state_manager_t *state_manager_new(
    state->debugblock  = (uint8_t*)malloc(state_size);
 #endif
 
+#ifdef HAVE_THREADS
+   /* Compression only pays off on a separate core */
+   if (cpu_features_get_core_amount() > 1)
+   {
+      /* All three blocks need distinct end markers, as any
+       * two of them may be compared against each other. */
+      state->spareblock   = (uint8_t*)state_manager_raw_alloc(state_size, 2);
+      state->lock         = slock_new();
+      state->cond         = scond_new();
+      state->thread_alive = true;
+
+      if (state->spareblock && state->lock && state->cond)
+         state->thread    = sthread_create(state_manager_thread, state);
+
+      if (!state->thread)
+         RARCH_WARN("[Rewind]: Failed to start compression thread, compressing on the main thread.\n");
+   }
+#endif
+
    return state;
 
 error:
    if (state_data)
+#ifdef HAVE_MEMMAP
+      memmap_free_large(state_data);
+#else
       free(state_data);
+#endif
    state_manager_free(state);
    free(state);
 
@@ -451,6 +784,10 @@ static bool state_manager_pop(state_manager_t *state, const void **data)
 
    *data                        = NULL;
 
+#ifdef HAVE_THREADS
+   state_manager_wait(state);
+#endif
+
    if (state->thisblock_valid)
    {
       state->thisblock_valid    = false;
@@ -481,6 +818,11 @@ static void state_manager_push_where(state_manager_t *state, void **data)
     * pushed state, or we could end up applying a 'patch' to wrong
     * savestate, and that'd blow up rather quickly. */
 
+#ifdef HAVE_THREADS
+   /* Also makes sure nextblock is no longer being compressed */
+   state_manager_wait(state);
+#endif
+
    if (!state->thisblock_valid)
    {
       const void *ignored;
@@ -499,59 +841,26 @@ static void state_manager_push_where(state_manager_t *state, void **data)
 
 static void state_manager_push_do(state_manager_t *state)
 {
-   uint8_t *swap = NULL;
-
 #if STRICT_BUF_SIZE
    memcpy(state->nextblock, state->debugblock, state->debugsize);
 #endif
 
-   if (state->thisblock_valid)
+#ifdef HAVE_THREADS
+   if (state->thread)
    {
-      const uint8_t *oldb, *newb;
-      uint8_t *compressed;
-      size_t headpos, tailpos, remaining;
-      if (state->capacity < sizeof(size_t) + state->maxcompsize)
-         return;
-
-recheckcapacity:;
-      headpos   = state->head - state->data;
-      tailpos   = state->tail - state->data;
-      remaining = (tailpos + state->capacity -
-            sizeof(size_t) - headpos - 1) % state->capacity + 1;
-
-      if (remaining <= state->maxcompsize)
-      {
-         state->tail = state->data + read_size_t(state->tail);
-         state->entries--;
-         goto recheckcapacity;
-      }
-
-      oldb              = state->thisblock;
-      newb              = state->nextblock;
-      compressed        = state->head + sizeof(size_t);
-
-      compressed       += state_manager_raw_compress(oldb, newb,
-            state->blocksize, compressed);
-
-      if (compressed - state->data + state->maxcompsize > state->capacity)
-      {
-         compressed     = state->data;
-         if (state->tail == state->data + sizeof(size_t))
-            state->tail = state->data + read_size_t(state->tail);
-      }
-      write_size_t(compressed, state->head-state->data);
-      compressed       += sizeof(size_t);
-      write_size_t(state->head, compressed-state->data);
-      state->head       = compressed;
+      /* state_manager_push_where() waited for the previous
+       * push, so the spare block is available */
+      slock_lock(state->lock);
+      state->pendingblock = state->nextblock;
+      state->nextblock    = state->spareblock;
+      state->spareblock   = NULL;
+      scond_signal(state->cond);
+      slock_unlock(state->lock);
+      return;
    }
-   else
-      state->thisblock_valid = true;
-
-   swap                      = state->thisblock;
-   state->thisblock          = state->nextblock;
-   state->nextblock          = swap;
+#endif
 
-   state->entries++;
+   state->nextblock = state_manager_push_block(state, state->nextblock);
 }
 
 #if 0
@@ -572,11 +881,101 @@ static void state_manager_capacity(state_manager_t *state,
 }
 #endif
 
+/* Each stored state carries the frame it was taken at,
+ * right after the serialized data */
+static uint64_t state_manager_block_frame(
+      const struct state_manager_rewind_state *rewind_st,
+      const void *block)
+{
+   uint64_t frame;
+   memcpy(&frame, (const uint8_t*)block + rewind_st->size, sizeof(frame));
+   return frame;
+}
+
+static void state_manager_set_block_frame(
+      const struct state_manager_rewind_state *rewind_st,
+      void *block)
+{
+   memcpy((uint8_t*)block + rewind_st->size,
+         &rewind_st->frame, sizeof(rewind_st->frame));
+}
+
+/* Stores a checkpoint of the current frame. @src is the
+ * state just pushed to the fine-grained history, if any. */
+static void state_manager_push_checkpoint(
+      struct state_manager_rewind_state *rewind_st, const void *src)
+{
+   void *state = NULL;
+
+   state_manager_push_where(rewind_st->checkpoints, &state);
+
+   if (src)
+      memcpy(state, src, rewind_st->size + sizeof(uint64_t));
+   else
+   {
+      content_serialize_state(state, rewind_st->size);
+      state_manager_set_block_frame(rewind_st, state);
+   }
+
+   state_manager_push_do(rewind_st->checkpoints);
+   rewind_st->checkpoint_frame = rewind_st->frame;
+}
+
+/* Steps back to the next checkpoint older than the current
+ * frame. Checkpoints newer than that are left over from
+ * before an earlier rewind, and are dropped. */
+static bool state_manager_pop_checkpoint(
+      struct state_manager_rewind_state *rewind_st, const void **data)
+{
+   /* Each checkpoint is shown for a few frames, or holding
+    * rewind would race through minutes of history per second */
+   if (rewind_st->in_checkpoints && rewind_st->checkpoint_hold)
+   {
+      rewind_st->checkpoint_hold--;
+      *data = rewind_st->checkpoint_buf;
+      return true;
+   }
+
+   while (state_manager_pop(rewind_st->checkpoints, data))
+   {
+      if (state_manager_block_frame(rewind_st, *data) < rewind_st->frame)
+      {
+         rewind_st->in_checkpoints  = true;
+         rewind_st->checkpoint_hold = STATE_MANAGER_CHECKPOINT_HOLD;
+         rewind_st->checkpoint_buf  = *data;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+/* Play resumes from the checkpoint rewound to; it becomes
+ * the newest checkpoint again, the base for the next one. */
+static void state_manager_resume_from_checkpoint(
+      struct state_manager_rewind_state *rewind_st)
+{
+   state_manager_t *state = rewind_st->checkpoints;
+
+   if (!state->thisblock_valid
+         && state->thisblock == rewind_st->checkpoint_buf)
+   {
+      state->thisblock_valid = true;
+      state->entries++;
+   }
+
+   rewind_st->in_checkpoints   = false;
+   rewind_st->checkpoint_buf   = NULL;
+   rewind_st->checkpoint_frame = rewind_st->frame;
+}
+
 void state_manager_event_init(
       struct state_manager_rewind_state *rewind_st,
-      unsigned rewind_buffer_size)
+      unsigned rewind_buffer_size, bool lock_memory,
+      unsigned checkpoint_interval)
 {
    void *state          = NULL;
+   size_t block_size    = 0;
 
    if (!rewind_st || rewind_st->state)
       return;
@@ -600,15 +999,49 @@ void state_manager_event_init(
          msg_hash_to_str(MSG_REWIND_INIT),
          (unsigned)(rewind_buffer_size / 1000000));
 
-   rewind_st->state = state_manager_new(rewind_st->size,
-         rewind_buffer_size);
+   block_size                     = rewind_st->size + sizeof(uint64_t);
+   rewind_st->frame               = 0;
+   rewind_st->checkpoint_frame    = 0;
+   rewind_st->checkpoint_interval = checkpoint_interval;
+   rewind_st->checkpoint_hold     = 0;
+   rewind_st->checkpoint_buf      = NULL;
+   rewind_st->in_checkpoints      = false;
+
+   if (checkpoint_interval)
+   {
+      /* The checkpoints take their share out of the same
+       * budget, leaving the rest for recent history */
+      size_t checkpoint_size = rewind_buffer_size
+         / STATE_MANAGER_CHECKPOINT_SHARE;
+
+      rewind_st->checkpoints = state_manager_new(block_size,
+            checkpoint_size, lock_memory);
+      if (rewind_st->checkpoints)
+      {
+         rewind_buffer_size -= (unsigned)checkpoint_size;
+         RARCH_LOG("[Rewind]: Checkpoint every %u frames, %u MB.\n",
+               checkpoint_interval,
+               (unsigned)(checkpoint_size / 1000000));
+      }
+   }
+
+   rewind_st->state = state_manager_new(block_size,
+         rewind_buffer_size, lock_memory);
 
    if (!rewind_st->state)
+   {
       RARCH_WARN("%s.\n", msg_hash_to_str(MSG_REWIND_INIT_FAILED));
+      state_manager_event_deinit(rewind_st);
+      return;
+   }
 
    state_manager_push_where(rewind_st->state, &state);
 
    content_serialize_state(state, rewind_st->size);
+   state_manager_set_block_frame(rewind_st, state);
+
+   if (rewind_st->checkpoints)
+      state_manager_push_checkpoint(rewind_st, state);
 
    state_manager_push_do(rewind_st->state);
 }
@@ -624,8 +1057,16 @@ void state_manager_event_deinit(
       state_manager_free(rewind_st->state);
       free(rewind_st->state);
    }
-   rewind_st->state = NULL;
-   rewind_st->size  = 0;
+   if (rewind_st->checkpoints)
+   {
+      state_manager_free(rewind_st->checkpoints);
+      free(rewind_st->checkpoints);
+   }
+   rewind_st->state          = NULL;
+   rewind_st->checkpoints    = NULL;
+   rewind_st->checkpoint_buf = NULL;
+   rewind_st->in_checkpoints = false;
+   rewind_st->size           = 0;
 }
 
 /**
@@ -670,8 +1111,35 @@ bool state_manager_check_rewind(
    if (pressed)
    {
       const void *buf    = NULL;
+      bool popped        = false;
+
+      if (!rewind_st->in_checkpoints)
+         popped          = state_manager_pop(rewind_st->state, &buf);
 
-      if (state_manager_pop(rewind_st->state, &buf))
+      if (popped)
+         rewind_st->frame = state_manager_block_frame(rewind_st, buf);
+      /* Past the recent history, carry on through the
+       * checkpoints. A movie needs every frame rewound. */
+      else if (rewind_st->checkpoints
+            && !rarch_ctl(RARCH_CTL_BSV_MOVIE_IS_INITED, NULL))
+      {
+         const void *checkpoint = NULL;
+
+         if (state_manager_pop_checkpoint(rewind_st, &checkpoint))
+         {
+            buf              = checkpoint;
+            popped           = true;
+            rewind_st->frame = state_manager_block_frame(rewind_st, buf);
+         }
+         /* Out of checkpoints; stay on the last one, unless
+          * looking for an older one overwrote it */
+         else if (rewind_st->in_checkpoints)
+            buf              = (state_manager_block_frame(rewind_st,
+                     rewind_st->checkpoint_buf) <= rewind_st->frame)
+               ? rewind_st->checkpoint_buf : NULL;
+      }
+
+      if (popped)
       {
 #ifdef HAVE_NETWORKING
          /* Make sure netplay isn't confused */
@@ -683,7 +1151,8 @@ bool state_manager_check_rewind(
 
          audio_driver_setup_rewind();
 
-         strlcpy(s, msg_hash_to_str(MSG_REWINDING), len);
+         strlcpy(s, msg_hash_to_str(rewind_st->in_checkpoints
+                  ? MSG_REWINDING_CHECKPOINTS : MSG_REWINDING), len);
 
          *time                  = is_paused ? 1 : 30;
          ret                    = true;
@@ -696,7 +1165,8 @@ bool state_manager_check_rewind(
       }
       else
       {
-         content_deserialize_state(buf, rewind_st->size);
+         if (buf)
+            content_deserialize_state(buf, rewind_st->size);
 
 #ifdef HAVE_NETWORKING
          /* Tell netplay we're done */
@@ -715,6 +1185,7 @@ bool state_manager_check_rewind(
    else
    {
       static unsigned cnt      = 0;
+      bool push_checkpoint     = false;
 
 #ifdef HAVE_NETWORKING
       /* Tell netplay we're done */
@@ -722,9 +1193,20 @@ bool state_manager_check_rewind(
          netplay_driver_ctl(RARCH_NETPLAY_CTL_DESYNC_POP, NULL);
 #endif
 
+      if (rewind_st->in_checkpoints)
+         state_manager_resume_from_checkpoint(rewind_st);
+
+      rewind_st->frame++;
+
       cnt = (cnt + 1) % (rewind_granularity ?
             rewind_granularity : 1); /* Avoid possible SIGFPE. */
 
+      /* Also after rewinding to before the last checkpoint */
+      if (rewind_st->checkpoints)
+         push_checkpoint =    rewind_st->frame < rewind_st->checkpoint_frame
+                           || rewind_st->frame >= rewind_st->checkpoint_frame
+                              + rewind_st->checkpoint_interval;
+
       if ((cnt == 0) || rarch_ctl(RARCH_CTL_BSV_MOVIE_IS_INITED, NULL))
       {
          void *state = NULL;
@@ -732,9 +1214,15 @@ bool state_manager_check_rewind(
          state_manager_push_where(rewind_st->state, &state);
 
          content_serialize_state(state, rewind_st->size);
+         state_manager_set_block_frame(rewind_st, state);
+
+         if (push_checkpoint)
+            state_manager_push_checkpoint(rewind_st, state);
 
          state_manager_push_do(rewind_st->state);
       }
+      else if (push_checkpoint)
+         state_manager_push_checkpoint(rewind_st, NULL);
    }
 
    core_set_rewind_callbacks();
@@ -24,6 +24,10 @@
 #include <boolean.h>
 #include <retro_common_api.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 RETRO_BEGIN_DECLS
 
 struct state_manager
@@ -49,6 +53,21 @@ struct state_manager
     * (yes, the math is a bit ugly). */
    size_t maxcompsize;
 
+#ifdef HAVE_THREADS
+   /* Compressing a pushed state into the buffer happens
+    * on this thread, while the main thread serializes the
+    * next state into nextblock. */
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+   /* Handed to the thread for compression, NULL once done */
+   uint8_t *pendingblock;
+   /* Buffer freed by the last compression, becomes
+    * nextblock on the following push */
+   uint8_t *spareblock;
+   bool thread_alive;
+#endif
+
    unsigned entries;
    bool thisblock_valid;
 };
@@ -59,17 +78,43 @@ struct state_manager_rewind_state
 {
    /* Rewind support. */
    state_manager_t *state;
+   /* Tiered rewind: a full state every checkpoint_interval
+    * frames, going back further than 'state' can.
+    * NULL unless enabled. */
+   state_manager_t *checkpoints;
+   /* Checkpoint being shown while rewinding through them */
+   const void *checkpoint_buf;
+   /* Frames run since init, following the loaded state
+    * when rewinding. Every stored state is tagged with it. */
+   uint64_t frame;
+   uint64_t checkpoint_frame;
    size_t size;
+   unsigned checkpoint_interval;
+   unsigned checkpoint_hold;
+   bool in_checkpoints;
    bool frame_is_reversed;
 };
 
 bool state_manager_frame_is_reversed(void);
 
+/* Raw delta codec, also used to send savestates over netplay.
+ * See state_manager.c for the requirements on each buffer. */
+size_t state_manager_raw_maxsize(size_t uncomp);
+
+void *state_manager_raw_alloc(size_t len, uint16_t uniq);
+
+size_t state_manager_raw_compress(const void *src,
+      const void *dst, size_t len, void *patch);
+
+bool state_manager_raw_decompress_checked(const void *patch,
+      size_t patchlen, void *data, size_t datalen);
+
 void state_manager_event_deinit(
       struct state_manager_rewind_state *rewind_st);
 
 void state_manager_event_init(struct state_manager_rewind_state *rewind_st,
-      unsigned rewind_buffer_size);
+      unsigned rewind_buffer_size, bool lock_memory,
+      unsigned checkpoint_interval);
 
 /**
  * check_rewind:
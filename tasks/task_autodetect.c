@@ -25,6 +25,10 @@
 #include <string/stdstring.h>
 #include <file/config_file.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include "../configuration.h"
 #include "../file_path_special.h"
 #include "../list_special.h"
@@ -48,6 +52,40 @@ typedef struct
    bool suppress_notifcations;
 } autoconfig_handle_t;
 
+/* What matching a device against an autoconfig
+ * file needs, so that files only have to be parsed
+ * again when they changed */
+typedef struct
+{
+   char *path;
+   char *device_name;
+   int64_t mtime;
+   int32_t size;
+   uint16_t vid;
+   uint16_t pid;
+} autoconfig_index_entry_t;
+
+/* Index of the autoconfig files in one directory,
+ * in directory listing order */
+typedef struct autoconfig_index
+{
+   struct autoconfig_index *next;
+   char *dir;
+   autoconfig_index_entry_t *entries;
+   size_t size;
+} autoconfig_index_t;
+
+typedef struct
+{
+#ifdef HAVE_THREADS
+   slock_t *lock;
+#endif
+   autoconfig_index_t *indices;
+} autoconfig_index_state_t;
+
+/* TODO/FIXME - global state - perhaps move outside this file */
+static autoconfig_index_state_t autoconfig_index_st;
+
 /*********************/
 /* Utility functions */
 /*********************/
@@ -102,24 +140,13 @@ static void input_autoconfigure_free(retro_task_t *task)
  * > 2: Device name matches
  * > 3: VID+PID match
  * > 5: Both device name and VID+PID match */
-static unsigned input_autoconfigure_get_config_file_affinity(
+static unsigned input_autoconfigure_get_affinity(
       autoconfig_handle_t *autoconfig_handle,
-      config_file_t *config)
+      uint16_t config_vid, uint16_t config_pid,
+      const char *config_device_name)
 {
-   int tmp_int         = 0;
-   uint16_t config_vid = 0;
-   uint16_t config_pid = 0;
    bool pid_match      = false;
    unsigned affinity   = 0;
-   struct config_entry_list 
-      *entry           = NULL;
-
-   /* Parse config file */
-   if (config_get_int(config, "input_vendor_id", &tmp_int))
-      config_vid = (uint16_t)tmp_int;
-
-   if (config_get_int(config, "input_product_id", &tmp_int))
-      config_pid = (uint16_t)tmp_int;
 
    /* > Bliss-Box shenanigans... */
 #ifdef HAVE_BLISSBOX
@@ -144,15 +171,52 @@ static unsigned input_autoconfigure_get_config_file_affinity(
       affinity += 3;
 
    /* Check for matching device name */
-   if (      (entry  = config_get_entry(config, "input_device"))
-         && !string_is_empty(entry->value)
-         &&  string_is_equal(entry->value,
+   if (     !string_is_empty(config_device_name)
+         &&  string_is_equal(config_device_name,
              autoconfig_handle->device_info.name))
       affinity += 2;
 
    return affinity;
 }
 
+/* Reads the values input_autoconfigure_get_affinity()
+ * is given from a config file */
+static void input_autoconfigure_get_config_file_ids(
+      config_file_t *config,
+      uint16_t *vid, uint16_t *pid, const char **device_name)
+{
+   int tmp_int                     = 0;
+   struct config_entry_list *entry = NULL;
+
+   *vid         = 0;
+   *pid         = 0;
+   *device_name = NULL;
+
+   if (config_get_int(config, "input_vendor_id", &tmp_int))
+      *vid = (uint16_t)tmp_int;
+
+   if (config_get_int(config, "input_product_id", &tmp_int))
+      *pid = (uint16_t)tmp_int;
+
+   if ((entry = config_get_entry(config, "input_device")))
+      *device_name = entry->value;
+}
+
+static unsigned input_autoconfigure_get_config_file_affinity(
+      autoconfig_handle_t *autoconfig_handle,
+      config_file_t *config)
+{
+   uint16_t config_vid            = 0;
+   uint16_t config_pid            = 0;
+   const char *config_device_name = NULL;
+
+   input_autoconfigure_get_config_file_ids(config,
+         &config_vid, &config_pid, &config_device_name);
+
+   return input_autoconfigure_get_affinity(autoconfig_handle,
+         config_vid, config_pid, config_device_name);
+}
+
 /* 'Attaches' specified autoconfig file to autoconfig
  * handle, parsing required device info metadata */
 static void input_autoconfigure_set_config_file(
@@ -190,9 +254,180 @@ static void input_autoconfigure_set_config_file(
    autoconfig_handle->device_info.autoconfigured = true;
 }
 
+/********************************/
+/* Autoconfig 'File' Indexing */
+/********************************/
+
+static void input_autoconfigure_index_lock(void)
+{
+#ifdef HAVE_THREADS
+   if (!autoconfig_index_st.lock)
+      autoconfig_index_st.lock = slock_new();
+   slock_lock(autoconfig_index_st.lock);
+#endif
+}
+
+static void input_autoconfigure_index_unlock(void)
+{
+#ifdef HAVE_THREADS
+   slock_unlock(autoconfig_index_st.lock);
+#endif
+}
+
+static void input_autoconfigure_index_entry_free(
+      autoconfig_index_entry_t *entry)
+{
+   if (entry->path)
+      free(entry->path);
+   if (entry->device_name)
+      free(entry->device_name);
+
+   entry->path        = NULL;
+   entry->device_name = NULL;
+}
+
+/* Fills index entry from the autoconfig file at 'path'
+ * > Returns 'false' if the file cannot be read */
+static bool input_autoconfigure_index_entry_init(
+      autoconfig_index_entry_t *entry, const char *path,
+      int32_t size, int64_t mtime)
+{
+   const char *device_name = NULL;
+   config_file_t *config   = config_file_new_from_path_to_string(path);
+
+   if (!config)
+      return false;
+
+   input_autoconfigure_get_config_file_ids(config,
+         &entry->vid, &entry->pid, &device_name);
+
+   entry->path        = strdup(path);
+   entry->device_name = string_is_empty(device_name) ?
+         NULL : strdup(device_name);
+   entry->size        = size;
+   entry->mtime       = mtime;
+
+   config_file_free(config);
+   return true;
+}
+
+/* Brings the index of 'dir' in line with its current
+ * listing, only parsing the files that were added or
+ * modified since the index was last updated
+ * > A file counts as modified when its size or its
+ *   modification time (where available) changed
+ * > Index lock must be held */
+static autoconfig_index_t *input_autoconfigure_index_update(
+      const char *dir, struct string_list *config_file_list)
+{
+   size_t i;
+   size_t num_entries                = 0;
+   size_t next_entry                 = 0;
+   autoconfig_index_entry_t *entries = NULL;
+   autoconfig_index_t *index         = autoconfig_index_st.indices;
+
+   while (index && !string_is_equal(index->dir, dir))
+      index = index->next;
+
+   if (!index)
+   {
+      if (!(index = (autoconfig_index_t*)calloc(1, sizeof(*index))))
+         return NULL;
+
+      index->dir                  = strdup(dir);
+      index->next                 = autoconfig_index_st.indices;
+      autoconfig_index_st.indices = index;
+   }
+
+   if (!(entries = (autoconfig_index_entry_t*)calloc(
+         config_file_list->size, sizeof(*entries))))
+      return NULL;
+
+   for (i = 0; i < config_file_list->size; i++)
+   {
+      size_t j;
+      const char *config_file_path   = config_file_list->elems[i].data;
+      autoconfig_index_entry_t *prev = NULL;
+      int64_t mtime                  = 0;
+      int32_t size;
+
+      if (string_is_empty(config_file_path))
+         continue;
+
+      size = path_get_size(config_file_path);
+      path_get_mtime(config_file_path, &mtime);
+
+      /* Listings hardly ever change order, so look for
+       * the previous entry after the last one found */
+      for (j = 0; j < index->size; j++)
+      {
+         autoconfig_index_entry_t *entry =
+               &index->entries[(next_entry + j) % index->size];
+
+         if (     entry->path
+               && string_is_equal(entry->path, config_file_path))
+         {
+            prev       = entry;
+            next_entry = (next_entry + j + 1) % index->size;
+            break;
+         }
+      }
+
+      if (prev && prev->size == size && prev->mtime == mtime)
+      {
+         /* Unchanged - take over previous entry */
+         entries[num_entries++] = *prev;
+         prev->path             = NULL;
+         prev->device_name      = NULL;
+      }
+      else if (input_autoconfigure_index_entry_init(
+            &entries[num_entries], config_file_path, size, mtime))
+         num_entries++;
+   }
+
+   for (i = 0; i < index->size; i++)
+      input_autoconfigure_index_entry_free(&index->entries[i]);
+   free(index->entries);
+
+   index->entries = entries;
+   index->size    = num_entries;
+
+   return index;
+}
+
+void input_autoconfigure_index_deinit(void)
+{
+   autoconfig_index_t *index = autoconfig_index_st.indices;
+
+   while (index)
+   {
+      size_t i;
+      autoconfig_index_t *next = index->next;
+
+      for (i = 0; i < index->size; i++)
+         input_autoconfigure_index_entry_free(&index->entries[i]);
+
+      free(index->entries);
+      free(index->dir);
+      free(index);
+
+      index = next;
+   }
+
+   autoconfig_index_st.indices = NULL;
+
+#ifdef HAVE_THREADS
+   if (autoconfig_index_st.lock)
+      slock_free(autoconfig_index_st.lock);
+   autoconfig_index_st.lock = NULL;
+#endif
+}
+
 /* Attempts to find an 'external' autoconfig file
  * (in the autoconfig directory) matching the connected
  * input device
+ * > Devices are matched against the directory's
+ *   index, so only the best match is loaded in full
  * > Returns 'true' if successful */
 static bool input_autoconfigure_scan_config_files_external(
       autoconfig_handle_t *autoconfig_handle)
@@ -200,7 +435,10 @@ static bool input_autoconfigure_scan_config_files_external(
    size_t i;
    const char *dir_autoconfig           = autoconfig_handle->dir_autoconfig;
    const char *dir_driver_autoconfig    = autoconfig_handle->dir_driver_autoconfig;
+   const char *config_file_dir          = NULL;
    struct string_list *config_file_list = NULL;
+   autoconfig_index_t *index            = NULL;
+   char *best_config_path               = NULL;
    config_file_t *best_config           = NULL;
    unsigned max_affinity                = 0;
    bool match_found                     = false;
@@ -209,9 +447,12 @@ static bool input_autoconfigure_scan_config_files_external(
     * autoconfig directory */
    if (!string_is_empty(dir_driver_autoconfig) &&
        path_is_directory(dir_driver_autoconfig))
+   {
       config_file_list = dir_list_new_special(
             dir_driver_autoconfig, DIR_LIST_AUTOCONFIG,
             "cfg", false);
+      config_file_dir  = dir_driver_autoconfig;
+   }
 
    if (!config_file_list || (config_file_list->size < 1))
    {
@@ -225,68 +466,55 @@ static bool input_autoconfigure_scan_config_files_external(
 
       if (!string_is_empty(dir_autoconfig) &&
           path_is_directory(dir_autoconfig))
+      {
          config_file_list = dir_list_new_special(
                dir_autoconfig, DIR_LIST_AUTOCONFIG,
                "cfg", false);
+         config_file_dir  = dir_autoconfig;
+      }
    }
 
    if (!config_file_list || (config_file_list->size < 1))
       goto end;
 
-   /* Loop through external config files */
-   for (i = 0; i < config_file_list->size; i++)
-   {
-      const char *config_file_path = config_file_list->elems[i].data;
-      config_file_t *config        = NULL;
-      unsigned affinity            = 0;
-
-      if (string_is_empty(config_file_path))
-         continue;
-
-      /* Load autoconfig file */
-      config = config_file_new_from_path_to_string(config_file_path);
-
-      if (!config)
-         continue;
-
-      /* Check for a match */
-      if (autoconfig_handle && config)
-         affinity = input_autoconfigure_get_config_file_affinity(
-               autoconfig_handle, config);
+   input_autoconfigure_index_lock();
 
-      if (affinity > max_affinity)
+   if ((index = input_autoconfigure_index_update(
+         config_file_dir, config_file_list)))
+   {
+      for (i = 0; i < index->size; i++)
       {
-         if (best_config)
+         autoconfig_index_entry_t *entry = &index->entries[i];
+         unsigned affinity               = input_autoconfigure_get_affinity(
+               autoconfig_handle, entry->vid, entry->pid,
+               entry->device_name);
+
+         if (affinity > max_affinity)
          {
-            config_file_free(best_config);
-            best_config = NULL;
-         }
+            if (best_config_path)
+               free(best_config_path);
 
-         /* 'Cache' config file for later processing */
-         best_config  = config;
-         config       = NULL;
-         max_affinity = affinity;
+            best_config_path = strdup(entry->path);
+            max_affinity     = affinity;
 
-         /* An affinity of 5 is a 'perfect' match,
-          * and means we can return immediately */
-         if (affinity == 5)
-            break;
-      }
-      /* No match - just clean up config file */
-      else
-      {
-         config_file_free(config);
-         config = NULL;
+            /* An affinity of 5 is a 'perfect' match,
+             * and means we can stop searching */
+            if (affinity == 5)
+               break;
+         }
       }
    }
 
-   /* If we reach this point and a config file has
-    * been cached, then we have a match */
-   if (best_config)
+   input_autoconfigure_index_unlock();
+
+   /* If a config file path has been cached,
+    * then we have a match */
+   if (best_config_path &&
+       (best_config = config_file_new_from_path_to_string(
+            best_config_path)))
    {
-      if (autoconfig_handle && best_config)
-         input_autoconfigure_set_config_file(
-               autoconfig_handle, best_config);
+      input_autoconfigure_set_config_file(
+            autoconfig_handle, best_config);
       match_found = true;
    }
 
@@ -297,6 +525,12 @@ end:
       config_file_list = NULL;
    }
 
+   if (best_config_path)
+   {
+      free(best_config_path);
+      best_config_path = NULL;
+   }
+
    return match_found;
 }
 
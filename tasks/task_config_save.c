@@ -0,0 +1,237 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2021 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <boolean.h>
+#include <compat/strl.h>
+#include <file/config_file.h>
+#include <queues/task_queue.h>
+#include <string/stdstring.h>
+#include <features/features_cpu.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#include "tasks_internal.h"
+#include "../msg_hash.h"
+#include "../retroarch.h"
+#include "../verbosity.h"
+
+/* Saves requested within this window of the first
+ * one are written to disk together */
+#define CONFIG_SAVE_DELAY_USEC 500000
+
+/* There is at most one pending config at a time -
+ * a save request for the same path replaces it, one
+ * for another path writes it out first */
+typedef struct
+{
+#ifdef HAVE_THREADS
+   /* Also held for the duration of a write.
+    * Created by task_config_save_init() */
+   slock_t *lock;
+#endif
+   config_file_t *conf;
+   char path[PATH_MAX_LENGTH];
+   /* Whether a task is scheduled to write 'conf' */
+   bool queued;
+} config_save_state_t;
+
+/* TODO/FIXME - global state - perhaps move outside this file */
+static config_save_state_t config_save_st;
+
+static void config_save_lock(void)
+{
+#ifdef HAVE_THREADS
+   slock_lock(config_save_st.lock);
+#endif
+}
+
+static void config_save_unlock(void)
+{
+#ifdef HAVE_THREADS
+   slock_unlock(config_save_st.lock);
+#endif
+}
+
+/* Writes and frees the pending config, if any.
+ * On failure, 's' is set to the message to show.
+ * Lock must be held
+ * Returns false if the write failed */
+static bool config_save_write_pending(char *s, size_t len)
+{
+   bool ret            = true;
+   config_file_t *conf = config_save_st.conf;
+
+   if (!conf)
+      return true;
+
+   config_save_st.conf = NULL;
+
+   if (config_file_write(conf, config_save_st.path, true))
+      RARCH_LOG("[Config]: Saved \"%s\".\n", config_save_st.path);
+   else
+   {
+      snprintf(s, len, "%s \"%s\".",
+            msg_hash_to_str(MSG_FAILED_SAVING_CONFIG_TO),
+            config_save_st.path);
+      RARCH_ERR("[Config]: %s\n", s);
+      ret = false;
+   }
+
+   config_file_free(conf);
+   return ret;
+}
+
+/* Writes the pending config from the calling
+ * (main) thread. Lock must be held */
+static void config_save_write_pending_now(void)
+{
+   char msg[PATH_MAX_LENGTH + 64];
+
+   if (!config_save_write_pending(msg, sizeof(msg)))
+      runloop_msg_queue_push(msg, 1, 180, true, NULL,
+            MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_ERROR);
+}
+
+static void task_config_save_handler(retro_task_t *task)
+{
+   char msg[PATH_MAX_LENGTH + 64];
+
+   config_save_lock();
+   config_save_st.queued = false;
+   if (!config_save_write_pending(msg, sizeof(msg)))
+      task_set_error(task, strdup(msg));
+   config_save_unlock();
+
+   task_set_finished(task, true);
+}
+
+/* Runs on the main thread, unlike the handler */
+static void task_config_save_cb(retro_task_t *task,
+      void *task_data, void *user_data, const char *error)
+{
+   if (!string_is_empty(error))
+      runloop_msg_queue_push(error, 1, 180, true, NULL,
+            MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_ERROR);
+}
+
+void task_config_save_init(void)
+{
+#ifdef HAVE_THREADS
+   if (!config_save_st.lock)
+      config_save_st.lock = slock_new();
+#endif
+}
+
+void task_config_save_deinit(void)
+{
+   char msg[PATH_MAX_LENGTH + 64];
+
+   /* The message queue may be gone already,
+    * a failure is only logged */
+   config_save_lock();
+   config_save_write_pending(msg, sizeof(msg));
+   config_save_unlock();
+
+#ifdef HAVE_THREADS
+   if (config_save_st.lock)
+      slock_free(config_save_st.lock);
+   config_save_st.lock = NULL;
+#endif
+}
+
+void task_push_config_save(config_file_t *conf, const char *path)
+{
+   retro_task_t *task = NULL;
+
+   if (!conf || string_is_empty(path))
+   {
+      config_file_free(conf);
+      return;
+   }
+
+   config_save_lock();
+
+   if (config_save_st.conf)
+   {
+      if (string_is_equal(config_save_st.path, path))
+      {
+         /* Superseded - a task is already scheduled */
+         config_file_free(config_save_st.conf);
+         config_save_st.conf = conf;
+         config_save_unlock();
+         return;
+      }
+
+      config_save_write_pending_now();
+   }
+
+   config_save_st.conf = conf;
+   strlcpy(config_save_st.path, path, sizeof(config_save_st.path));
+
+   if (config_save_st.queued)
+   {
+      config_save_unlock();
+      return;
+   }
+
+   if (!(task = task_init()))
+   {
+      config_save_write_pending_now();
+      config_save_unlock();
+      return;
+   }
+
+   config_save_st.queued = true;
+   config_save_unlock();
+
+   task->type     = TASK_TYPE_NONE;
+   task->handler  = task_config_save_handler;
+   task->callback = task_config_save_cb;
+   task->when     = cpu_features_get_time_usec() + CONFIG_SAVE_DELAY_USEC;
+   task->affinity = TASK_AFFINITY_IO;
+   task->mute     = true;
+
+   task_queue_push(task);
+}
+
+config_file_t *task_config_save_take(const char *path)
+{
+   config_file_t *conf = NULL;
+
+   config_save_lock();
+
+   if (     config_save_st.conf
+         && string_is_equal(config_save_st.path, path))
+   {
+      conf                = config_save_st.conf;
+      config_save_st.conf = NULL;
+   }
+
+   config_save_unlock();
+
+   return conf;
+}
+
+void task_config_save_flush(void)
+{
+   config_save_lock();
+   config_save_write_pending_now();
+   config_save_unlock();
+}
@@ -41,6 +41,17 @@
 #include <uwp/uwp_func.h>
 #endif
 
+#if defined(HAVE_MMAP) && !defined(_WIN32)
+#define HAVE_CONTENT_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <memmap.h>
+#elif defined(_WIN32) && !defined(_XBOX) && !defined(__WINRT__) && defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0500
+#define HAVE_CONTENT_MMAP
+#include <encodings/utf.h>
+#endif
+
 #ifdef HAVE_CONFIG_H
 #include "../config.h"
 #endif
@@ -84,6 +95,7 @@
 #include "../command.h"
 #include "../core_info.h"
 #include "../content.h"
+#include "../content_hash_cache.h"
 #include "../configuration.h"
 #include "../defaults.h"
 #include "../frontend/frontend.h"
@@ -110,6 +122,10 @@ extern bool discord_is_inited;
 
 #define MAX_ARGS 32
 
+/* Uncompressed content files at least this large
+ * are mapped instead of being read into memory */
+#define CONTENT_FILE_MMAP_MIN_SIZE (16 * 1024 * 1024)
+
 typedef struct content_stream content_stream_t;
 typedef struct content_information_ctx content_information_ctx_t;
 
@@ -283,6 +299,107 @@ bool content_file_override_set(
    return true;
 }
 
+#ifdef HAVE_CONTENT_MMAP
+/* Maps content file 'path' copy-on-write, so the
+ * core may write to the buffer without touching the
+ * file. Returns false if the file is smaller than
+ * CONTENT_FILE_MMAP_MIN_SIZE or cannot be mapped,
+ * in which case it should be read as usual */
+static bool content_file_map(const char *path,
+      uint8_t **data, int64_t *data_size)
+{
+   void *ptr = NULL;
+#ifdef _WIN32
+   LARGE_INTEGER len;
+   HANDLE mem;
+   wchar_t *path_wide = utf8_to_utf16_string_alloc(path);
+   HANDLE file        = INVALID_HANDLE_VALUE;
+
+   if (path_wide)
+   {
+      file = CreateFileW(path_wide, GENERIC_READ, FILE_SHARE_READ,
+            NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+      free(path_wide);
+   }
+
+   if (file == INVALID_HANDLE_VALUE)
+      return false;
+
+   if (   !GetFileSizeEx(file, &len)
+       || (len.QuadPart < CONTENT_FILE_MMAP_MIN_SIZE)
+       || ((uint64_t)len.QuadPart > (size_t)-1))
+   {
+      CloseHandle(file);
+      return false;
+   }
+
+   /* The view keeps both the mapping and the
+    * file open until it is unmapped */
+   if ((mem = CreateFileMapping(file, NULL, PAGE_WRITECOPY, 0, 0, NULL)))
+   {
+      ptr = MapViewOfFile(mem, FILE_MAP_COPY, 0, 0, (SIZE_T)len.QuadPart);
+      CloseHandle(mem);
+   }
+   CloseHandle(file);
+
+   if (!ptr)
+      return false;
+
+   *data_size = (int64_t)len.QuadPart;
+#else
+   struct stat st;
+   int fd = open(path, O_RDONLY);
+
+   if (fd < 0)
+      return false;
+
+   if (   (fstat(fd, &st) != 0)
+       || !S_ISREG(st.st_mode)
+       || (st.st_size < CONTENT_FILE_MMAP_MIN_SIZE)
+       || ((uint64_t)st.st_size > (size_t)-1))
+   {
+      close(fd);
+      return false;
+   }
+
+   ptr = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE,
+         MAP_PRIVATE, fd, 0);
+   /* The mapping holds its own reference to the file */
+   close(fd);
+
+   if (ptr == MAP_FAILED)
+      return false;
+
+   *data_size = (int64_t)st.st_size;
+#endif
+
+   *data = (uint8_t*)ptr;
+   return true;
+}
+
+static void content_file_unmap(void *data, size_t data_size)
+{
+#ifdef _WIN32
+   UnmapViewOfFile(data);
+#else
+   munmap(data, data_size);
+#endif
+}
+#endif
+
+static void content_file_free_data(void *data, size_t data_size,
+      bool data_mapped)
+{
+#ifdef HAVE_CONTENT_MMAP
+   if (data_mapped)
+   {
+      content_file_unmap(data, data_size);
+      return;
+   }
+#endif
+   free(data);
+}
+
 /* Frees any content data that is not flagged
  * as 'persistent'. Should be called after
  * content_file_load() */
@@ -301,10 +418,12 @@ static void content_file_list_free_transient_data(
       if (file_info->data &&
           !file_info->persistent_data)
       {
-         free((void*)file_info->data);
+         content_file_free_data(file_info->data,
+               file_info->data_size, file_info->data_mapped);
 
-         file_info->data      = NULL;
-         file_info->data_size = 0;
+         file_info->data        = NULL;
+         file_info->data_size   = 0;
+         file_info->data_mapped = false;
       }
    }
 }
@@ -359,10 +478,12 @@ static void content_file_list_free_entry(
 
    if (file_info->data)
    {
-      free((void*)file_info->data);
+      content_file_free_data(file_info->data,
+            file_info->data_size, file_info->data_mapped);
       file_info->data = NULL;
    }
-   file_info->data_size = 0;
+   file_info->data_size   = 0;
+   file_info->data_mapped = false;
 
    file_info->file_in_archive = false;
    file_info->persistent_data = false;
@@ -500,6 +621,7 @@ static bool content_file_list_set_info(
       const char *path,
       void *data,
       size_t data_size,
+      bool data_mapped,
       bool persistent_data,
       size_t idx)
 {
@@ -550,6 +672,7 @@ static bool content_file_list_set_info(
 
    file_info->data            = data;
    file_info->data_size       = data_size;
+   file_info->data_mapped     = data_mapped;
    file_info->persistent_data = persistent_data;
 
    /* Assign paths
@@ -696,10 +819,15 @@ static bool content_file_list_set_info(
  * @content_path : path of the content file.
  * @data         : buffer into which the content file will be read.
  * @data_size    : size of the resultant content buffer.
+ * @data_mapped  : set if @data is a file mapping (see
+ *                 content_file_map) rather than a malloc'd buffer.
  *
- * Reads the content file into memory. Also performs soft patching
- * (see patch_content function) if soft patching has not been
- * blocked by the user.
+ * Reads the content file into memory. Large uncompressed files
+ * are mapped instead, so only the pages the core touches are
+ * ever read. Also performs soft patching (see patch_content
+ * function) if soft patching has not been blocked by the user;
+ * unless it can be patched in place, a patched file ends up in
+ * a malloc'd buffer, and its mapping is dropped.
  *
  * Returns: true if successful, false on error.
  **/
@@ -711,13 +839,16 @@ static bool content_file_load_into_memory(
       size_t idx,
       enum rarch_content_type first_content_type,
       uint8_t **data,
-      size_t *data_size)
+      size_t *data_size,
+      bool *data_mapped)
 {
    uint8_t *content_data = NULL;
    int64_t content_size  = 0;
+   bool content_mapped   = false;
 
-   *data      = NULL;
-   *data_size = 0;
+   *data        = NULL;
+   *data_size   = 0;
+   *data_mapped = false;
 
    RARCH_LOG("[CONTENT LOAD]: %s: %s\n",
          msg_hash_to_str(MSG_LOADING_CONTENT_FILE), content_path);
@@ -731,6 +862,15 @@ static bool content_file_load_into_memory(
          return false;
    }
    else
+#endif
+#ifdef HAVE_CONTENT_MMAP
+   if (content_file_map(content_path, &content_data, &content_size))
+   {
+      RARCH_LOG("[CONTENT LOAD]: Mapped %u MB of content.\n",
+            (unsigned)(content_size >> 20));
+      content_mapped = true;
+   }
+   else
 #endif
       if (!filestream_read_file(content_path,
             (void**)&content_data, &content_size))
@@ -752,6 +892,12 @@ static bool content_file_load_into_memory(
 #ifdef HAVE_PATCH
          /* Attempt to apply a patch. */
          if (!content_ctx->patch_is_blocked)
+         {
+#ifdef HAVE_CONTENT_MMAP
+            uint8_t *mapped_data = content_mapped ? content_data : NULL;
+            size_t mapped_size   = (size_t)content_size;
+#endif
+
             has_patch = patch_content(
                   content_ctx->is_ips_pref,
                   content_ctx->is_bps_pref,
@@ -760,19 +906,40 @@ static bool content_file_load_into_memory(
                   content_ctx->name_bps,
                   content_ctx->name_ups,
                   (uint8_t**)&content_data,
-                  (void*)&content_size);
+                  (void*)&content_size,
+                  &content_mapped);
+
+#ifdef HAVE_CONTENT_MMAP
+            /* Patches that could not be applied in place
+             * leave the mapping to us */
+            if (mapped_data && !content_mapped)
+               content_file_unmap(mapped_data, mapped_size);
+#endif
+         }
 #endif
          /* If content is compressed or a patch has been
           * applied, must determine CRC value using the
           * actual data buffer, since the content path
           * cannot be used for this purpose...
+          * > Archives store the CRC of each file, so
+          *   unpatched compressed content does not have
+          *   to be hashed again after decompression
           * In all other cases, cache the content path
           * and defer CRC calculation until the value is
           * actually needed */
          if (content_compressed || has_patch)
          {
-            p_content->rom_crc = encoding_crc32(0, content_data,
-                  (size_t)content_size);
+#ifdef HAVE_COMPRESSION
+            if (content_compressed && !has_patch)
+               p_content->rom_crc = file_archive_get_file_crc32(
+                     content_path);
+            else
+#endif
+               p_content->rom_crc = 0;
+
+            if (!p_content->rom_crc)
+               p_content->rom_crc = encoding_crc32(0, content_data,
+                     (size_t)content_size);
             RARCH_LOG("[CONTENT LOAD]: CRC32: 0x%x\n",
                   (unsigned)p_content->rom_crc);
          }
@@ -787,8 +954,9 @@ static bool content_file_load_into_memory(
          p_content->rom_crc = 0;
    }
 
-   *data      = content_data;
-   *data_size = (size_t)content_size;
+   *data        = content_data;
+   *data_size   = (size_t)content_size;
+   *data_mapped = content_mapped;
 
    return true;
 }
@@ -985,6 +1153,7 @@ static bool content_file_load(
       const char *content_path = NULL;
       uint8_t *content_data    = NULL;
       size_t content_size      = 0;
+      bool content_mapped      = false;
       const char *valid_exts   = special ?
             special->roms[i].valid_extensions :
                   content_ctx->valid_extensions;
@@ -1022,7 +1191,7 @@ static bool content_file_load(
             if (!content_file_load_into_memory(
                   content_ctx, p_content, content_path,
                   content_compressed, i, first_content_type,
-                  &content_data, &content_size))
+                  &content_data, &content_size, &content_mapped))
             {
                snprintf(msg, sizeof(msg), "%s \"%s\"\n",
                      msg_hash_to_str(MSG_COULD_NOT_READ_CONTENT_FILE),
@@ -1130,12 +1299,13 @@ static bool content_file_load(
       /* Add current entry to content file list */
       if (!content_file_list_set_info(
             p_content->content_list,
-            content_path, content_data, content_size,
+            content_path, content_data, content_size, content_mapped,
             CONTENT_FILE_ATTR_GET_PERSISTENT(content->elems[i].attr), i))
       {
          RARCH_LOG("[CONTENT LOAD]: Failed to process content file: %s\n", content_path);
          if (content_data)
-            free((void*)content_data);
+            content_file_free_data(content_data, content_size,
+                  content_mapped);
          *error_enum = MSG_FAILED_TO_LOAD_CONTENT;
          return false;
       }
@@ -1509,7 +1679,12 @@ static bool content_load(content_ctx_info_t *info,
 #endif
 
    command_event(CMD_EVENT_HISTORY_INIT, NULL);
-   rarch_favorites_init();
+#ifdef HAVE_MENU
+   /* Favorites are only used by the menu, it loads
+    * them itself when its initialisation is deferred */
+   if (!menu_driver_is_deferred())
+#endif
+      rarch_favorites_init();
    command_event(CMD_EVENT_RESUME, NULL);
    command_event(CMD_EVENT_VIDEO_SET_ASPECT_RATIO, NULL);
 
@@ -1674,6 +1849,21 @@ static void task_push_to_history_list(
 }
 
 #ifdef HAVE_MENU
+/* Whether content that is about to be loaded with @core_path
+ * can go into the running core without reloading it, which
+ * needs that to be the same core and its core info to say
+ * it copes with that. Ask before RARCH_PATH_CORE is set. */
+static bool task_content_can_keep_core(const char *core_path,
+      enum rarch_core_type type)
+{
+   core_info_t *core_info = NULL;
+
+   return type == CORE_TYPE_PLAIN
+      && rarch_ctl(RARCH_CTL_IS_CORE_LOADED, (void*)core_path)
+      && core_info_find(core_path, &core_info)
+      && core_info->supports_warm_switch;
+}
+
 static bool command_event_cmd_exec(
       content_state_t *p_content,
       const char *data,
@@ -1872,6 +2062,8 @@ bool task_push_load_content_from_playlist_from_menu(
    settings_t *settings                       = config_get_ptr();
    rarch_system_info_t *sys_info              = runloop_get_system_info();
    const char *path_dir_system                = settings->paths.directory_system;
+   bool keep_core                             = task_content_can_keep_core(
+         core_path, CORE_TYPE_PLAIN);
 #ifndef HAVE_DYNAMIC
    bool force_core_reload                     = settings->bools.always_reload_core_on_run_content;
 #endif
@@ -1935,6 +2127,9 @@ bool task_push_load_content_from_playlist_from_menu(
       if (!string_is_empty(fullpath))
          path_set(RARCH_PATH_CONTENT, fullpath);
 
+      if (keep_core)
+         rarch_ctl(RARCH_CTL_KEEP_CORE_RESIDENT, NULL);
+
       /* Load content */
       ret = content_load(content_info, p_content);
 
@@ -1953,6 +2148,9 @@ bool task_push_load_content_from_playlist_from_menu(
    path_set(RARCH_PATH_CORE, core_path);
 #ifdef HAVE_DYNAMIC
    command_event(CMD_EVENT_LOAD_CORE, NULL);
+
+   if (keep_core)
+      rarch_ctl(RARCH_CTL_KEEP_CORE_RESIDENT, NULL);
 #endif
 
    /* Load content
@@ -2144,7 +2342,10 @@ bool task_push_load_content_with_new_core_from_menu(
    settings_t *settings                       = config_get_ptr();
    bool check_firmware_before_loading         = settings->bools.check_firmware_before_loading;
    const char *path_dir_system                = settings->paths.directory_system;
-#ifndef HAVE_DYNAMIC
+#ifdef HAVE_DYNAMIC
+   bool keep_core                             = task_content_can_keep_core(
+         core_path, type);
+#else
    bool force_core_reload                     = settings->bools.always_reload_core_on_run_content;
 
    /* Check whether specified core is already loaded
@@ -2201,6 +2402,9 @@ bool task_push_load_content_with_new_core_from_menu(
    /* Load core */
    command_event(CMD_EVENT_LOAD_CORE, NULL);
 
+   if (keep_core)
+      rarch_ctl(RARCH_CTL_KEEP_CORE_RESIDENT, NULL);
+
    /* Load content */
    if (!content_info->environ_get)
       content_info->environ_get = menu_content_environment_get;
@@ -2683,9 +2887,23 @@ uint32_t content_get_crc(void)
    content_state_t *p_content = content_state_get_ptr();
    if (p_content->pending_rom_crc)
    {
+      content_hash_entry_t entry;
+      const char *path             = p_content->pending_rom_crc_path;
+
       p_content->pending_rom_crc   = false;
-      p_content->rom_crc           = file_crc32(0,
-            (const char*)p_content->pending_rom_crc_path);
+
+      if (     content_hash_cache_get(path, &entry)
+            && (entry.flags & CONTENT_HASH_CRC))
+         p_content->rom_crc        = entry.crc;
+      else
+      {
+         p_content->rom_crc        = file_crc32(0, path);
+
+         entry.flags               = CONTENT_HASH_CRC;
+         entry.crc                 = p_content->rom_crc;
+         if (p_content->rom_crc)
+            content_hash_cache_put(path, &entry);
+      }
       RARCH_LOG("[CONTENT LOAD]: CRC32: 0x%x .\n",
             (unsigned)p_content->rom_crc);
    }
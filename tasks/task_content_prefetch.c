@@ -0,0 +1,209 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <file/archive_file.h>
+#include <file/file_path.h>
+#include <lists/string_list.h>
+#include <queues/task_queue.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+
+#include "tasks_internal.h"
+
+/* Files are read this much per handler call, so that
+ * a cancelled prefetch stops quickly */
+#define CONTENT_PREFETCH_CHUNK_SIZE    (256 * 1024)
+
+/* Only the start of larger files gets read, there is
+ * no point pushing a whole disc image into the cache */
+#define CONTENT_PREFETCH_MAX_SIZE      (64 * 1024 * 1024)
+
+typedef struct content_prefetch_handle
+{
+   struct string_list *files;
+   struct string_list *firmware;
+   RFILE *file;
+   uint8_t *buf;
+   size_t file_idx;
+   int64_t file_read;
+} content_prefetch_handle_t;
+
+static void content_prefetch_free(content_prefetch_handle_t *handle)
+{
+   if (!handle)
+      return;
+
+   if (handle->file)
+      filestream_close(handle->file);
+   if (handle->files)
+      string_list_free(handle->files);
+   if (handle->firmware)
+      string_list_free(handle->firmware);
+   if (handle->buf)
+      free(handle->buf);
+   free(handle);
+}
+
+/* Reads the files through the kernel page cache, then
+ * checks the firmware. Nothing read is kept: the point
+ * is that opening the same files again on launch no
+ * longer has to wait for the disk */
+static void task_content_prefetch_handler(retro_task_t *task)
+{
+   size_t i;
+   content_prefetch_handle_t *handle =
+      (content_prefetch_handle_t*)task->state;
+
+   if (!handle || task_get_cancelled(task))
+      goto end;
+
+   if (handle->file_idx < handle->files->size)
+   {
+      int64_t len;
+
+      if (!handle->file)
+      {
+         handle->file      = filestream_open(
+               handle->files->elems[handle->file_idx].data,
+               RETRO_VFS_FILE_ACCESS_READ,
+               RETRO_VFS_FILE_ACCESS_HINT_NONE);
+         handle->file_read = 0;
+
+         if (!handle->file)
+         {
+            handle->file_idx++;
+            return;
+         }
+      }
+
+      len = filestream_read(handle->file, handle->buf,
+            CONTENT_PREFETCH_CHUNK_SIZE);
+
+      if (len > 0)
+         handle->file_read += len;
+
+      if (     len < CONTENT_PREFETCH_CHUNK_SIZE
+            || handle->file_read >= CONTENT_PREFETCH_MAX_SIZE)
+      {
+         filestream_close(handle->file);
+         handle->file = NULL;
+         handle->file_idx++;
+      }
+
+      task_set_progress(task, (int8_t)((handle->file_idx * 100)
+               / (handle->files->size + 1)));
+      return;
+   }
+
+   /* The core looks its firmware up when loading content,
+    * stat it now so the directory entries are cached */
+   for (i = 0; i < handle->firmware->size; i++)
+      path_is_valid(handle->firmware->elems[i].data);
+
+end:
+   task_set_progress(task, 100);
+   task_set_finished(task, true);
+}
+
+static void task_content_prefetch_cleanup(retro_task_t *task)
+{
+   content_prefetch_free((content_prefetch_handle_t*)task->state);
+   task->state = NULL;
+}
+
+static bool task_content_prefetch_finder(retro_task_t *task, void *user_data)
+{
+   /* Cancels every prefetch in the queue, the selection
+    * has moved on */
+   if (task && task->handler == task_content_prefetch_handler)
+      task_set_cancelled(task, true);
+   return false;
+}
+
+void task_content_prefetch_cancel(void)
+{
+   task_finder_data_t find_data;
+
+   find_data.func     = task_content_prefetch_finder;
+   find_data.userdata = NULL;
+
+   task_queue_find(&find_data);
+}
+
+bool task_push_content_prefetch(const char *content_path,
+      const char *core_path, const struct string_list *firmware)
+{
+   union string_list_elem_attr attr;
+   retro_task_t *task                 = NULL;
+   content_prefetch_handle_t *handle  = NULL;
+
+   attr.i = 0;
+
+   task_content_prefetch_cancel();
+
+   if (!(handle = (content_prefetch_handle_t*)
+            calloc(1, sizeof(*handle))))
+      return false;
+
+   handle->files    = string_list_new();
+   handle->firmware = firmware
+      ? string_list_clone(firmware) : string_list_new();
+   handle->buf      = (uint8_t*)malloc(CONTENT_PREFETCH_CHUNK_SIZE);
+
+   if (!handle->files || !handle->firmware || !handle->buf)
+      goto error;
+
+   if (!string_is_empty(content_path))
+   {
+      char archive_path[PATH_MAX_LENGTH];
+      const char *delim = path_get_archive_delim(content_path);
+
+      /* Content inside an archive gets read as part of it */
+      if (delim)
+      {
+         size_t len = (size_t)(delim - content_path) + 1;
+         if (len > sizeof(archive_path))
+            len = sizeof(archive_path);
+         strlcpy(archive_path, content_path, len);
+         content_path = archive_path;
+      }
+
+      string_list_append(handle->files, content_path, attr);
+   }
+
+   if (!string_is_empty(core_path))
+      string_list_append(handle->files, core_path, attr);
+
+   if (handle->files->size == 0 && handle->firmware->size == 0)
+      goto error;
+
+   if (!(task = task_init()))
+      goto error;
+
+   task->state    = handle;
+   task->handler  = task_content_prefetch_handler;
+   task->cleanup  = task_content_prefetch_cleanup;
+   task->mute     = true;
+
+   task_queue_push(task);
+
+   return true;
+
+error:
+   content_prefetch_free(handle);
+   return false;
+}
@@ -115,19 +115,24 @@ enum update_installed_cores_status
    UPDATE_INSTALLED_CORES_END
 };
 
+/* Upper bound of core downloads run at once
+ * when updating installed cores */
+#define UPDATE_INSTALLED_CORES_MAX_DOWNLOADS 8
+
 typedef struct update_installed_cores_handle
 {
    char *path_dir_libretro;
    char *path_dir_core_assets;
    core_updater_list_t* core_list;
    retro_task_t *list_task;
-   retro_task_t *download_task;
+   retro_task_t *download_tasks[UPDATE_INSTALLED_CORES_MAX_DOWNLOADS];
    size_t auto_backup_history_size;
    size_t list_size;
    size_t list_index;
    size_t installed_index;
    unsigned num_updated;
    unsigned num_locked;
+   unsigned download_max;
    enum update_installed_cores_status status;
    bool auto_backup;
 } update_installed_cores_handle_t;
@@ -568,7 +573,10 @@ void cb_http_task_core_updater_download(
    if (!data || !transf)
       goto finish;
 
-   if (!data->data || string_is_empty(transf->path))
+   /* The core was written to disk while it downloaded */
+   if (     data->status < 200
+         || data->status > 299
+         || string_is_empty(transf->path))
       goto finish;
 
    download_handle = (core_updater_download_handle_t*)transf->user_data;
@@ -608,13 +616,6 @@ void cb_http_task_core_updater_download(
    }
 #endif
 
-   /* Write core file to disk */
-   if (!filestream_write_file(transf->path, data->data, data->len))
-   {
-      err = "Write failed.";
-      goto finish;
-   }
-
 #if defined(HAVE_COMPRESSION) && defined(HAVE_ZLIB)
    /* Decompress core file, if required
     * NOTE: If core is compressed and platform
@@ -824,7 +825,7 @@ static void task_core_updater_download_handler(retro_task_t *task)
             transf->user_data = (void*)download_handle;
 
             /* Push HTTP transfer task */
-            download_handle->http_task = (retro_task_t*)task_push_http_transfer_file(
+            download_handle->http_task = (retro_task_t*)task_push_http_transfer_file_to_disk(
                   download_handle->remote_core_path, true, NULL,
                   cb_http_task_core_updater_download, transf);
 
@@ -1157,6 +1158,30 @@ static void free_update_installed_cores_handle(
    update_installed_handle = NULL;
 }
 
+/* Forgets about finished downloads, and returns
+ * the number of downloads still running */
+static unsigned update_installed_cores_poll_downloads(
+      update_installed_cores_handle_t *update_installed_handle)
+{
+   unsigned i;
+   unsigned num_running = 0;
+
+   for (i = 0; i < update_installed_handle->download_max; i++)
+   {
+      retro_task_t *download_task = update_installed_handle->download_tasks[i];
+
+      if (!download_task)
+         continue;
+
+      if (task_get_finished(download_task))
+         update_installed_handle->download_tasks[i] = NULL;
+      else
+         num_running++;
+   }
+
+   return num_running;
+}
+
 static void task_update_installed_cores_handler(retro_task_t *task)
 {
    update_installed_cores_handle_t *update_installed_handle = NULL;
@@ -1223,10 +1248,11 @@ static void task_update_installed_cores_handler(retro_task_t *task)
             bool core_installed                         = false;
 
             /* Check whether we have reached the end
-             * of the list */
+             * of the list - the last downloads may
+             * still be running */
             if (update_installed_handle->list_index >= update_installed_handle->list_size)
             {
-               update_installed_handle->status = UPDATE_INSTALLED_CORES_END;
+               update_installed_handle->status = UPDATE_INSTALLED_CORES_WAIT_DOWNLOAD;
                break;
             }
 
@@ -1276,7 +1302,26 @@ static void task_update_installed_cores_handler(retro_task_t *task)
       case UPDATE_INSTALLED_CORES_UPDATE_CORE:
          {
             const core_updater_list_entry_t *list_entry = NULL;
+            retro_task_t **download_task                = NULL;
             uint32_t local_crc;
+            unsigned i;
+
+            /* Wait for a download slot - downloads mostly
+             * wait on the server, so several of them run
+             * at once */
+            update_installed_cores_poll_downloads(update_installed_handle);
+
+            for (i = 0; i < update_installed_handle->download_max; i++)
+            {
+               if (!update_installed_handle->download_tasks[i])
+               {
+                  download_task = &update_installed_handle->download_tasks[i];
+                  break;
+               }
+            }
+
+            if (!download_task)
+               break;
 
             /* Get list entry
              * > In the event of an error, just return
@@ -1325,7 +1370,7 @@ static void task_update_installed_cores_handler(retro_task_t *task)
 
             /* Existing core is not the most recent version
              * > Request download */
-            update_installed_handle->download_task = (retro_task_t*)
+            *download_task = (retro_task_t*)
                   task_push_core_updater_download(
                         update_installed_handle->core_list,
                         list_entry->remote_filename,
@@ -1335,11 +1380,11 @@ static void task_update_installed_cores_handler(retro_task_t *task)
                         update_installed_handle->path_dir_libretro,
                         update_installed_handle->path_dir_core_assets);
 
-            /* Again, if an error occurred, just return to
-             * UPDATE_INSTALLED_CORES_ITERATE state */
-            if (!update_installed_handle->download_task)
-               update_installed_handle->status = UPDATE_INSTALLED_CORES_ITERATE;
-            else
+            /* Either way, carry on with the next core
+             * while the download runs */
+            update_installed_handle->status = UPDATE_INSTALLED_CORES_ITERATE;
+
+            if (*download_task)
             {
                char task_title[PATH_MAX_LENGTH];
 
@@ -1357,33 +1402,13 @@ static void task_update_installed_cores_handler(retro_task_t *task)
 
                /* Increment 'updated cores' counter */
                update_installed_handle->num_updated++;
-
-               /* Wait for download to complete */
-               update_installed_handle->status = UPDATE_INSTALLED_CORES_WAIT_DOWNLOAD;
             }
          }
          break;
       case UPDATE_INSTALLED_CORES_WAIT_DOWNLOAD:
-         {
-            bool download_complete = false;
-
-            /* > If task is running, check 'is finished'
-             *   status
-             * > If task is NULL, then it is finished
-             *   by definition */
-            if (update_installed_handle->download_task)
-               download_complete = task_get_finished(update_installed_handle->download_task);
-            else
-               download_complete = true;
-
-            /* If download is complete, return to
-             * UPDATE_INSTALLED_CORES_ITERATE state */
-            if (download_complete)
-            {
-               update_installed_handle->download_task = NULL;
-               update_installed_handle->status        = UPDATE_INSTALLED_CORES_ITERATE;
-            }
-         }
+         /* Wait for the last downloads to complete */
+         if (update_installed_cores_poll_downloads(update_installed_handle) == 0)
+            update_installed_handle->status = UPDATE_INSTALLED_CORES_END;
          break;
       case UPDATE_INSTALLED_CORES_END:
          {
@@ -1461,6 +1486,7 @@ static bool task_update_installed_cores_finder(retro_task_t *task, void *user_da
 
 void task_push_update_installed_cores(
       bool auto_backup, size_t auto_backup_history_size,
+      unsigned download_max,
       const char *path_dir_libretro,
       const char *path_dir_core_assets)
 {
@@ -1490,7 +1516,8 @@ void task_push_update_installed_cores(
          NULL : strdup(path_dir_core_assets);
    update_installed_handle->core_list                = core_updater_list_init();
    update_installed_handle->list_task                = NULL;
-   update_installed_handle->download_task            = NULL;
+   update_installed_handle->download_max             = MIN(MAX(download_max, 1),
+         UPDATE_INSTALLED_CORES_MAX_DOWNLOADS);
    update_installed_handle->list_size                = 0;
    update_installed_handle->list_index               = 0;
    update_installed_handle->installed_index          = 0;
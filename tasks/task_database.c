@@ -21,15 +21,22 @@
 #include <retro_miscellaneous.h>
 #include <retro_endianness.h>
 #include <string/stdstring.h>
+#include <array/rbuf.h>
 #include <lists/dir_list.h>
 #include <file/file_path.h>
 #include <encodings/crc32.h>
 #include <streams/file_stream.h>
 #include <streams/chd_stream.h>
 #include <streams/interface_stream.h>
+#include <features/features_cpu.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#include <rthreads/tpool.h>
+#endif
 #include "tasks_internal.h"
 
 #include "../core_info.h"
+#include "../content_hash_cache.h"
 #include "../database_info.h"
 
 #include "../file_path_special.h"
@@ -40,20 +47,56 @@
 #include "../retroarch.h"
 #include "../ui/ui_companion_driver.h"
 #include "../gfx/video_display_server.h"
+#include "../performance_counters.h"
 #endif
 #include "../verbosity.h"
 
-typedef struct database_state_handle
+/* Upper bound on the threads hashing content files.
+ * Scanning is mostly I/O bound, so this is not tied
+ * to the amount of cores */
+#define DATABASE_HASH_MAX_WORKERS 8
+
+#define DATABASE_CRC_BUFFER_SIZE (256 * 1024)
+
+/* Identity of a content file, as computed by
+ * task_database_hash() */
+typedef struct database_hash_result
 {
-   database_info_list_t *info;
-   struct string_list *list;
-   uint8_t *buf;
-   size_t list_index;
-   size_t entry_index;
+   char *serial;
    uint32_t crc;
    uint32_t archive_crc;
-   char archive_name[511];
-   char serial[4096];
+   enum database_type type;
+   bool ready;
+} database_hash_result_t;
+
+typedef struct database_state_rdb
+{
+   /* Opened on first match, written once the
+    * scan ends */
+   playlist_t *playlist;
+   /* Position of the database in 'index' */
+   size_t id;
+} database_state_rdb_t;
+
+typedef struct database_state_handle
+{
+   struct string_list *list;
+   /* Covers every database of the database
+    * directory, even if 'list' was narrowed */
+   database_info_index_t *index;
+   /* One entry per database in 'list' */
+   database_state_rdb_t *rdbs;
+   /* One entry per content file, filled in by
+    * the hashing threads */
+   database_hash_result_t *results;
+#ifdef HAVE_THREADS
+   tpool_t *pool;
+   slock_t *lock;
+   scond_t *result_cond;
+#endif
+   size_t next_hash;
+   unsigned num_workers;
+   bool quit;
 } database_state_handle_t;
 
 typedef struct db_handle
@@ -87,14 +130,6 @@ int detect_psp_game(intfstream_t *fd, char *game_id);
 int detect_gc_game(intfstream_t *fd, char *game_id);
 int detect_serial_ascii_game(intfstream_t *fd, char *game_id);
 
-static const char *database_info_get_current_name(
-      database_state_handle_t *handle)
-{
-   if (!handle || !handle->list)
-      return NULL;
-   return handle->list->elems[handle->list_index].data;
-}
-
 static const char *database_info_get_current_element_name(
       database_info_handle_t *handle)
 {
@@ -311,14 +346,18 @@ static int task_database_chd_get_serial(const char *name, char* serial)
    return result;
 }
 
+/* Computes the CRC of 'size' bytes of file 'name' from 'offset'
+ * (or of the whole file, if 'offset' is 0 and 'size' covers it)
+ * > Data is hashed in chunks, so that disc tracks never
+ *   have to be held in memory */
 static bool intfstream_file_get_crc(const char *name,
       uint64_t offset, size_t size, uint32_t *crc)
 {
-   bool rv;
-   intfstream_t *fd  = intfstream_open_file(name,
+   uint32_t accumulator = 0;
+   uint8_t *buffer      = NULL;
+   int64_t file_size    = -1;
+   intfstream_t *fd     = intfstream_open_file(name,
          RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE);
-   uint8_t *data     = NULL;
-   int64_t file_size = -1;
 
    if (!fd)
       return 0;
@@ -326,47 +365,46 @@ static bool intfstream_file_get_crc(const char *name,
    if (intfstream_seek(fd, 0, SEEK_END) == -1)
       goto error;
 
-   file_size = intfstream_tell(fd);
+   if ((file_size = intfstream_tell(fd)) < 0)
+      goto error;
 
-   if (intfstream_seek(fd, 0, SEEK_SET) == -1)
+   if (offset == 0 && size >= (uint64_t)file_size)
+      size = (size_t)file_size;
+   /* Partial ranges must be complete */
+   else if (offset + size > (uint64_t)file_size)
       goto error;
 
-   if (file_size < 0)
+   if (intfstream_seek(fd, (int64_t)offset, SEEK_SET) == -1)
       goto error;
 
-   if (offset != 0 || size < (uint64_t) file_size)
-   {
-      if (intfstream_seek(fd, (int64_t)offset, SEEK_SET) == -1)
-         goto error;
+   if (!(buffer = (uint8_t*)malloc(DATABASE_CRC_BUFFER_SIZE)))
+      goto error;
 
-      data = (uint8_t*)malloc(size);
+   while (size > 0)
+   {
+      size_t to_read    = (size < DATABASE_CRC_BUFFER_SIZE)
+         ? size : DATABASE_CRC_BUFFER_SIZE;
+      int64_t data_read = intfstream_read(fd, buffer, to_read);
 
-      if (intfstream_read(fd, data, size) != (int64_t) size)
+      if (data_read <= 0)
          goto error;
 
-      intfstream_close(fd);
-      free(fd);
-      fd = intfstream_open_memory(data, RETRO_VFS_FILE_ACCESS_READ,
-            RETRO_VFS_FILE_ACCESS_HINT_NONE, size);
-
-      if (!fd)
-         goto error;
+      accumulator = encoding_crc32(accumulator, buffer, (size_t)data_read);
+      size       -= (size_t)data_read;
    }
 
-   rv = intfstream_get_crc(fd, crc);
+   *crc = accumulator;
+
+   free(buffer);
    intfstream_close(fd);
    free(fd);
-   free(data);
-   return rv;
+   return 1;
 
 error:
-   if (fd)
-   {
-      intfstream_close(fd);
-      free(fd);
-   }
-   if (data)
-      free(data);
+   if (buffer)
+      free(buffer);
+   intfstream_close(fd);
+   free(fd);
    return 0;
 }
 
@@ -455,7 +493,7 @@ static bool task_database_chd_get_crc(const char *name, uint32_t *crc)
 }
 
 static void task_database_cue_prune(database_info_handle_t *db,
-      const char *name)
+      size_t start, const char *name)
 {
    size_t i;
    char path[PATH_MAX_LENGTH];
@@ -469,7 +507,7 @@ static void task_database_cue_prune(database_info_handle_t *db,
 
    while (cue_next_file(fd, name, path, sizeof(path)))
    {
-      for (i = db->list_ptr; i < db->list->size; ++i)
+      for (i = start; i < db->list->size; ++i)
       {
          if (db->list->elems[i].data
                && string_is_equal(path, db->list->elems[i].data))
@@ -485,7 +523,8 @@ static void task_database_cue_prune(database_info_handle_t *db,
    free(fd);
 }
 
-static void gdi_prune(database_info_handle_t *db, const char *name)
+static void gdi_prune(database_info_handle_t *db,
+      size_t start, const char *name)
 {
    size_t i;
    char path[PATH_MAX_LENGTH];
@@ -499,7 +538,7 @@ static void gdi_prune(database_info_handle_t *db, const char *name)
 
    while (gdi_next_file(fd, name, path, sizeof(path)))
    {
-      for (i = db->list_ptr; i < db->list->size; ++i)
+      for (i = start; i < db->list->size; ++i)
       {
          if (db->list->elems[i].data
                && string_is_equal(path, db->list->elems[i].data))
@@ -557,74 +596,413 @@ static enum msg_file_type extension_to_file_type(const char *ext)
    return FILE_TYPE_NONE;
 }
 
-static int task_database_iterate_playlist(
+static int task_database_iterate_playlist_lutro(
+      db_handle_t *_db,
       database_state_handle_t *db_state,
-      database_info_handle_t *db, const char *name)
+      database_info_handle_t *db,
+      const char *path)
 {
-   switch (extension_to_file_type(path_get_extension(name)))
+   char db_playlist_path[PATH_MAX_LENGTH];
+   playlist_t   *playlist  = NULL;
+
+   db_playlist_path[0]     = '\0';
+
+   if (!string_is_empty(_db->playlist_directory))
+      fill_pathname_join(db_playlist_path,
+            _db->playlist_directory,
+            "Lutro.lpl", sizeof(db_playlist_path));
+
+   playlist_config_set_path(&_db->playlist_config, db_playlist_path);
+   playlist = playlist_init(&_db->playlist_config);
+
+   if (!playlist_entry_exists(playlist, path))
+   {
+      struct playlist_entry entry;
+      char game_title[PATH_MAX_LENGTH];
+
+      game_title[0]               = '\0';
+
+      fill_short_pathname_representation_noext(game_title,
+            path, sizeof(game_title));
+
+      /* the push function reads our entry as const, 
+       * so these casts are safe */
+      entry.path                  = (char*)path;
+      entry.label                 = game_title;
+      entry.core_path             = (char*)"DETECT";
+      entry.core_name             = (char*)"DETECT";
+      entry.db_name               = (char*)"Lutro.lpl";
+      entry.crc32                 = (char*)"DETECT";
+      entry.subsystem_ident       = NULL;
+      entry.subsystem_name        = NULL;
+      entry.subsystem_roms        = NULL;
+      entry.runtime_hours         = 0;
+      entry.runtime_minutes       = 0;
+      entry.runtime_seconds       = 0;
+      entry.last_played_year      = 0;
+      entry.last_played_month     = 0;
+      entry.last_played_day       = 0;
+      entry.last_played_hour      = 0;
+      entry.last_played_minute    = 0;
+      entry.last_played_second    = 0;
+
+      playlist_push(playlist, &entry);
+   }
+
+   playlist_write_file(playlist);
+   playlist_free(playlist);
+
+   return 0;
+}
+
+static void task_database_cache_put(const char *name,
+      uint32_t flags, uint32_t crc, const char *serial)
+{
+   content_hash_entry_t entry;
+
+   entry.flags     = flags;
+   entry.crc       = crc;
+   entry.track_crc = crc;
+   if (serial)
+      strlcpy(entry.serial, serial, sizeof(entry.serial));
+   content_hash_cache_put(name, &entry);
+}
+
+/* CRC of the whole of file 'name', from the
+ * content hash cache when possible */
+static bool task_database_file_get_crc(const char *name, uint32_t *crc)
+{
+   content_hash_entry_t entry;
+
+   if (     content_hash_cache_get(name, &entry)
+         && (entry.flags & CONTENT_HASH_CRC))
+   {
+      *crc = entry.crc;
+      return true;
+   }
+
+   if (!intfstream_file_get_crc(name, 0, SIZE_MAX, crc))
+      return false;
+
+   task_database_cache_put(name, CONTENT_HASH_CRC, *crc, NULL);
+   return true;
+}
+
+/* Computes the CRC or serial of content file 'name'
+ * > Called from the hashing threads, and must
+ *   therefore not touch any scan state
+ * > Results are kept in the content hash cache, except
+ *   for CUE and GDI sheets: what they hash depends on
+ *   the track files they list */
+static void task_database_hash(const char *name,
+      database_hash_result_t *result)
+{
+   char serial[4096];
+   content_hash_entry_t cached;
+
+   serial[0]    = '\0';
+   result->type = DATABASE_TYPE_NONE;
+
+   if (path_contains_compressed_file(name))
    {
-      case FILE_TYPE_COMPRESSED:
 #ifdef HAVE_COMPRESSION
-         db->type = DATABASE_TYPE_CRC_LOOKUP;
-         /* first check crc of archive itself */
-         return intfstream_file_get_crc(name,
-               0, SIZE_MAX, &db_state->archive_crc);
-#else
-         break;
+      /* CRC is read from the archive below */
+      result->type = DATABASE_TYPE_CRC_LOOKUP;
 #endif
-      case FILE_TYPE_CUE:
-         task_database_cue_prune(db, name);
-         db_state->serial[0] = '\0';
-         if (task_database_cue_get_serial(name, db_state->serial))
-            db->type = DATABASE_TYPE_SERIAL_LOOKUP;
-         else
-         {
-            db->type = DATABASE_TYPE_CRC_LOOKUP;
-            return task_database_cue_get_crc(name, &db_state->crc);
-         }
-         break;
-      case FILE_TYPE_GDI:
-         gdi_prune(db, name);
-         db_state->serial[0] = '\0';
-         /* There are no serial databases, so don't bother with
-            serials at the moment */
-         if (0 && task_database_gdi_get_serial(name, db_state->serial))
-            db->type = DATABASE_TYPE_SERIAL_LOOKUP;
-         else
-         {
-            db->type = DATABASE_TYPE_CRC_LOOKUP;
-            return task_database_gdi_get_crc(name, &db_state->crc);
-         }
-         break;
-      /* Consider Wii WBFS files similar to ISO files. */
-      case FILE_TYPE_WBFS:
-      case FILE_TYPE_ISO:
-         db_state->serial[0] = '\0';
-         intfstream_file_get_serial(name, 0, SIZE_MAX, db_state->serial);
-         db->type            =  DATABASE_TYPE_SERIAL_LOOKUP;
-         break;
-      case FILE_TYPE_CHD:
-         db_state->serial[0] = '\0';
-         if (task_database_chd_get_serial(name, db_state->serial))
-            db->type         = DATABASE_TYPE_SERIAL_LOOKUP;
-         else
-         {
-            db->type         = DATABASE_TYPE_CRC_LOOKUP;
-            return task_database_chd_get_crc(name, &db_state->crc);
-         }
-         break;
-      case FILE_TYPE_LUTRO:
-         db->type            = DATABASE_TYPE_ITERATE_LUTRO;
-         break;
-      default:
-         db->type            = DATABASE_TYPE_CRC_LOOKUP;
-         return intfstream_file_get_crc(name, 0, SIZE_MAX, &db_state->crc);
+   }
+   else
+   {
+      switch (extension_to_file_type(path_get_extension(name)))
+      {
+         case FILE_TYPE_COMPRESSED:
+#ifdef HAVE_COMPRESSION
+            /* first check crc of archive itself */
+            if (task_database_file_get_crc(name, &result->archive_crc))
+               result->type = DATABASE_TYPE_CRC_LOOKUP;
+#endif
+            break;
+         case FILE_TYPE_CUE:
+            if (task_database_cue_get_serial(name, serial))
+               result->type = DATABASE_TYPE_SERIAL_LOOKUP;
+            else if (task_database_cue_get_crc(name, &result->crc))
+               result->type = DATABASE_TYPE_CRC_LOOKUP;
+            break;
+         case FILE_TYPE_GDI:
+            /* There are no serial databases, so don't bother with
+               serials at the moment */
+            if (0 && task_database_gdi_get_serial(name, serial))
+               result->type = DATABASE_TYPE_SERIAL_LOOKUP;
+            else if (task_database_gdi_get_crc(name, &result->crc))
+               result->type = DATABASE_TYPE_CRC_LOOKUP;
+            break;
+         /* Consider Wii WBFS files similar to ISO files. */
+         case FILE_TYPE_WBFS:
+         case FILE_TYPE_ISO:
+            if (     content_hash_cache_get(name, &cached)
+                  && (cached.flags & CONTENT_HASH_SERIAL))
+               strlcpy(serial, cached.serial, sizeof(serial));
+            else if (intfstream_file_get_serial(name, 0, SIZE_MAX, serial))
+               task_database_cache_put(name, CONTENT_HASH_SERIAL, 0, serial);
+            result->type    = DATABASE_TYPE_SERIAL_LOOKUP;
+            break;
+         case FILE_TYPE_CHD:
+            /* The track CRC is only cached if there is no serial */
+            if (     content_hash_cache_get(name, &cached)
+                  && (cached.flags & (CONTENT_HASH_SERIAL
+                        | CONTENT_HASH_TRACK_CRC)))
+            {
+               if (cached.flags & CONTENT_HASH_SERIAL)
+               {
+                  strlcpy(serial, cached.serial, sizeof(serial));
+                  result->type = DATABASE_TYPE_SERIAL_LOOKUP;
+               }
+               else
+               {
+                  result->crc  = cached.track_crc;
+                  result->type = DATABASE_TYPE_CRC_LOOKUP;
+               }
+            }
+            else if (task_database_chd_get_serial(name, serial))
+            {
+               task_database_cache_put(name, CONTENT_HASH_SERIAL, 0, serial);
+               result->type = DATABASE_TYPE_SERIAL_LOOKUP;
+            }
+            else if (task_database_chd_get_crc(name, &result->crc))
+            {
+               task_database_cache_put(name, CONTENT_HASH_TRACK_CRC,
+                     result->crc, NULL);
+               result->type = DATABASE_TYPE_CRC_LOOKUP;
+            }
+            break;
+         case FILE_TYPE_LUTRO:
+            result->type    = DATABASE_TYPE_ITERATE_LUTRO;
+            break;
+         default:
+            if (task_database_file_get_crc(name, &result->crc))
+               result->type = DATABASE_TYPE_CRC_LOOKUP;
+            break;
+      }
    }
 
-   return 1;
+   /* Archive did not contain a CRC for this entry,
+    * or the file is empty. */
+   if (result->type == DATABASE_TYPE_CRC_LOOKUP && !result->crc)
+      result->crc = file_archive_get_file_crc32(name);
+
+   if (result->type == DATABASE_TYPE_SERIAL_LOOKUP)
+      result->serial = strdup(serial);
 }
 
-static int database_info_list_iterate_end_no_match(
+#ifdef HAVE_THREADS
+/* Pool work item: hashes content files until every
+ * file of the list has been handed out */
+static void task_database_hash_work(void *data)
+{
+   db_handle_t *db                  = (db_handle_t*)data;
+   database_state_handle_t *dbstate = &db->state;
+   struct string_list *list         = db->handle->list;
+
+   perf_trace_set_thread_name("database hash");
+
+   slock_lock(dbstate->lock);
+
+   while (!dbstate->quit && dbstate->next_hash < list->size)
+   {
+      database_hash_result_t result;
+      size_t pos;
+      char *name;
+
+      pos  = dbstate->next_hash++;
+      name = list->elems[pos].data ? strdup(list->elems[pos].data) : NULL;
+      slock_unlock(dbstate->lock);
+
+      memset(&result, 0, sizeof(result));
+      result.type = DATABASE_TYPE_NONE;
+
+      /* Pruned entries are skipped */
+      if (name)
+      {
+         perf_trace_begin("database_hash");
+         task_database_hash(name, &result);
+         perf_trace_end("database_hash");
+         free(name);
+      }
+
+      slock_lock(dbstate->lock);
+      result.ready          = true;
+      dbstate->results[pos] = result;
+      scond_signal(dbstate->result_cond);
+   }
+
+   slock_unlock(dbstate->lock);
+
+   /* Pool threads outlive the work item */
+   perf_trace_thread_exit();
+}
+
+/* Queues one work item per pool thread, for files not
+ * handed out yet. The list grows when archives are
+ * expanded. Called with dbstate->lock held. */
+static void task_database_hash_queue(db_handle_t *db)
+{
+   unsigned i;
+   database_state_handle_t *dbstate = &db->state;
+
+   for (i = 0; i < dbstate->num_workers; i++)
+      tpool_add_work(dbstate->pool, task_database_hash_work, db);
+}
+#endif
+
+static void task_database_hash_init(db_handle_t *db)
+{
+   database_state_handle_t *dbstate = &db->state;
+   size_t size                      = db->handle->list->size;
+#ifdef HAVE_THREADS
+   unsigned num_workers             = cpu_features_get_core_amount();
+
+   if (num_workers < 2)
+      num_workers = 2;
+   if (num_workers > DATABASE_HASH_MAX_WORKERS)
+      num_workers = DATABASE_HASH_MAX_WORKERS;
+#endif
+
+   if (RBUF_TRYFIT(dbstate->results, size))
+   {
+      RBUF_RESIZE(dbstate->results, size);
+      memset(dbstate->results, 0, size * sizeof(*dbstate->results));
+   }
+
+#ifdef HAVE_THREADS
+   dbstate->lock        = slock_new();
+   dbstate->result_cond = scond_new();
+
+   if (!dbstate->lock || !dbstate->result_cond)
+      return;
+
+   if (!(dbstate->pool = tpool_create(num_workers)))
+      return;
+
+   dbstate->num_workers = num_workers;
+
+   slock_lock(dbstate->lock);
+   task_database_hash_queue(db);
+   slock_unlock(dbstate->lock);
+#endif
+}
+
+static void task_database_hash_deinit(database_state_handle_t *dbstate)
+{
+   size_t i;
+#ifdef HAVE_THREADS
+   if (dbstate->pool)
+   {
+      /* Work items still running stop after their
+       * current file, queued ones are dropped */
+      slock_lock(dbstate->lock);
+      dbstate->quit = true;
+      slock_unlock(dbstate->lock);
+
+      tpool_destroy(dbstate->pool);
+      dbstate->pool        = NULL;
+      dbstate->num_workers = 0;
+   }
+
+   if (dbstate->lock)
+      slock_free(dbstate->lock);
+   if (dbstate->result_cond)
+      scond_free(dbstate->result_cond);
+   dbstate->lock        = NULL;
+   dbstate->result_cond = NULL;
+#endif
+
+   for (i = 0; i < RBUF_LEN(dbstate->results); i++)
+      if (dbstate->results[i].serial)
+         free(dbstate->results[i].serial);
+   RBUF_FREE(dbstate->results);
+}
+
+/* Gets the hash result of content file at 'pos'
+ * Returns false if it is not available yet */
+static bool task_database_hash_get(db_handle_t *db, size_t pos,
+      database_hash_result_t *result)
+{
+   database_state_handle_t *dbstate = &db->state;
+   bool ready                       = false;
+
+   if (pos >= RBUF_LEN(dbstate->results))
+      return false;
+
+   /* No threads, hash file now */
+   if (dbstate->num_workers == 0)
+   {
+      memset(result, 0, sizeof(*result));
+      task_database_hash(db->handle->list->elems[pos].data, result);
+      return true;
+   }
+
+#ifdef HAVE_THREADS
+   slock_lock(dbstate->lock);
+
+   /* Wait a little, but return to the task queue
+    * regularly so that the task can be cancelled */
+   if (!dbstate->results[pos].ready)
+      scond_wait_timeout(dbstate->result_cond, dbstate->lock, 10000);
+
+   if ((ready = dbstate->results[pos].ready))
+   {
+      *result                       = dbstate->results[pos];
+      dbstate->results[pos].serial  = NULL;
+   }
+
+   slock_unlock(dbstate->lock);
+#endif
+
+   return ready;
+}
+
+/* Prunes files referenced by cue and gdi files
+ * from the content list, before any are hashed */
+static void task_database_prune(database_info_handle_t *db)
+{
+   size_t i;
+
+   for (i = 0; i < db->list->size; i++)
+   {
+      const char *name = db->list->elems[i].data;
+
+      if (!name)
+         continue;
+
+      switch (extension_to_file_type(path_get_extension(name)))
+      {
+         case FILE_TYPE_CUE:
+            task_database_cue_prune(db, i, name);
+            break;
+         case FILE_TYPE_GDI:
+            gdi_prune(db, i, name);
+            break;
+         default:
+            break;
+      }
+   }
+}
+
+/* Returns the first of 'records' that is in database 'id',
+ * which is also the earliest in that database */
+static const database_info_index_record_t *task_database_find_record(
+      const database_info_index_record_t *records, size_t count, size_t id)
+{
+   size_t i;
+
+   for (i = 0; i < count; i++)
+      if (records[i].rdb == id)
+         return &records[i];
+
+   return NULL;
+}
+
+static void database_info_list_iterate_end_no_match(
+      db_handle_t *_db,
       database_info_handle_t *db,
       database_state_handle_t *db_state,
       const char *path,
@@ -644,8 +1022,14 @@ static int database_info_list_iterate_end_no_match(
       if (archive_list && archive_list->size > 0)
       {
          unsigned i;
+         size_t size;
          size_t path_len  = strlen(path);
 
+#ifdef HAVE_THREADS
+         if (db_state->num_workers > 0)
+            slock_lock(db_state->lock);
+#endif
+
          for (i = 0; i < archive_list->size; i++)
          {
             if (path_len + strlen(archive_list->elems[i].data)
@@ -666,46 +1050,35 @@ static int database_info_list_iterate_end_no_match(
                      archive_list->elems[i].attr);
          }
 
-         string_list_free(archive_list);
-      }
-   }
-
-   db_state->list_index  = 0;
-   db_state->entry_index = 0;
-
-   if (db_state->crc != 0)
-      db_state->crc = 0;
-
-   if (db_state->archive_crc != 0)
-      db_state->archive_crc = 0;
-
-   return 0;
-}
-
-static int database_info_list_iterate_new(database_state_handle_t *db_state,
-      const char *query)
-{
-   const char *new_database = database_info_get_current_name(db_state);
+         /* Hash the new entries as well */
+         size = RBUF_LEN(db_state->results);
+         if (RBUF_TRYFIT(db_state->results, db->list->size))
+         {
+            RBUF_RESIZE(db_state->results, db->list->size);
+            memset(db_state->results + size, 0,
+                  (db->list->size - size) * sizeof(*db_state->results));
+         }
 
-#ifndef RARCH_INTERNAL
-   fprintf(stderr, "Check database [%d/%d] : %s\n",
-         (unsigned)db_state->list_index,
-         (unsigned)db_state->list->size, new_database);
+#ifdef HAVE_THREADS
+         if (db_state->num_workers > 0)
+         {
+            task_database_hash_queue(_db);
+            slock_unlock(db_state->lock);
+         }
 #endif
-   if (db_state->info)
-   {
-      database_info_list_free(db_state->info);
-      free(db_state->info);
+      }
+
+      if (archive_list)
+         string_list_free(archive_list);
    }
-   db_state->info = database_info_list_new(new_database, query);
-   return 0;
 }
 
-static int database_info_list_iterate_found_match(
+static void database_info_list_iterate_found_match(
       db_handle_t *_db,
       database_state_handle_t *db_state,
       database_info_handle_t *db,
-      const char *archive_name
+      size_t rdb_pos,
+      const database_info_index_entry_t *db_info_entry
       )
 {
    /* TODO/FIXME - heap allocations are done here to avoid
@@ -718,13 +1091,11 @@ static int database_info_list_iterate_found_match(
    char* db_playlist_path         = (char*)malloc(str_len);
    char* entry_path_str           = (char*)malloc(str_len);
    char *hash                     = NULL;
-   playlist_t   *playlist         = NULL;
+   playlist_t   *playlist         = db_state->rdbs[rdb_pos].playlist;
    const char         *db_path    =
-      database_info_get_current_name(db_state);
+      db_state->list->elems[rdb_pos].data;
    const char         *entry_path =
       database_info_get_current_element_name(db);
-   database_info_t *db_info_entry =
-      &db_state->info->list[db_state->entry_index];
 
    db_crc[0]                      = '\0';
    db_playlist_path[0]            = '\0';
@@ -740,20 +1111,21 @@ static int database_info_list_iterate_found_match(
       fill_pathname_join(db_playlist_path, _db->playlist_directory,
             db_playlist_base_str, str_len);
 
-   playlist_config_set_path(&_db->playlist_config, db_playlist_path);
-   playlist = playlist_init(&_db->playlist_config);
+   /* Playlists stay open until the scan ends, so
+    * that they are only loaded and written once */
+   if (!playlist)
+   {
+      playlist_config_set_path(&_db->playlist_config, db_playlist_path);
+      playlist = playlist_init(&_db->playlist_config);
+      db_state->rdbs[rdb_pos].playlist = playlist;
+   }
 
    snprintf(db_crc, str_len, "%08X|crc", db_info_entry->crc32);
 
    if (entry_path)
       strlcpy(entry_path_str, entry_path, str_len);
 
-   if (!string_is_empty(archive_name))
-      fill_pathname_join_delim(entry_path_str,
-            entry_path_str, archive_name, '#', str_len);
-
-   if (core_info_database_match_archive_member(
-         db_state->list->elems[db_state->list_index].data) &&
+   if (core_info_database_match_archive_member(db_path) &&
        (hash = strchr(entry_path_str, '#')))
        *hash = '\0';
 
@@ -766,7 +1138,6 @@ static int database_info_list_iterate_found_match(
    RARCH_LOG("Playlist Path: %s\n", db_playlist_path);
    RARCH_LOG("Entry Path: %s\n", entry_path);
    RARCH_LOG("Playlist not NULL: %d\n", playlist != NULL);
-   RARCH_LOG("ZIP entry: %s\n", archive_name);
    RARCH_LOG("entry path str: %s\n", entry_path_str);
 #endif
 #else
@@ -777,11 +1148,10 @@ static int database_info_list_iterate_found_match(
    fprintf(stderr, "Playlist Path: %s\n", db_playlist_path);
    fprintf(stderr, "Entry Path: %s\n", entry_path);
    fprintf(stderr, "Playlist not NULL: %d\n", playlist != NULL);
-   fprintf(stderr, "ZIP entry: %s\n", archive_name);
    fprintf(stderr, "entry path str: %s\n", entry_path_str);
 #endif
 
-   if (!playlist_entry_exists(playlist, entry_path_str))
+   if (playlist && !playlist_entry_exists(playlist, entry_path_str))
    {
       struct playlist_entry entry;
 
@@ -809,320 +1179,179 @@ static int database_info_list_iterate_found_match(
       playlist_push(playlist, &entry);
    }
 
-   playlist_write_file(playlist);
-   playlist_free(playlist);
-
-   database_info_list_free(db_state->info);
-   free(db_state->info);
-
-   db_state->info        = NULL;
-   db_state->crc         = 0;
-   db_state->archive_crc = 0;
-
    /* Move database to start since we are likely to match against it
       again */
-   if (db_state->list_index != 0)
+   if (rdb_pos != 0)
    {
-      struct string_list_elem entry = 
-         db_state->list->elems[db_state->list_index];
+      struct string_list_elem entry = db_state->list->elems[rdb_pos];
+      database_state_rdb_t rdb      = db_state->rdbs[rdb_pos];
       memmove(&db_state->list->elems[1],
               &db_state->list->elems[0],
-              sizeof(entry) * db_state->list_index);
+              sizeof(entry) * rdb_pos);
+      memmove(&db_state->rdbs[1],
+              &db_state->rdbs[0],
+              sizeof(rdb) * rdb_pos);
       db_state->list->elems[0] = entry;
+      db_state->rdbs[0]        = rdb;
    }
 
    free(db_crc);
    free(db_playlist_base_str);
    free(db_playlist_path);
    free(entry_path_str);
-   return 0;
 }
 
-/* End of entries in database info list and didn't find a
- * match, go to the next database. */
-static int database_info_list_iterate_next(
-      database_state_handle_t *db_state
-      )
-{
-   db_state->list_index++;
-   db_state->entry_index = 0;
-
-   database_info_list_free(db_state->info);
-   free(db_state->info);
-   db_state->info        = NULL;
-
-   return 1;
-}
-
-static int task_database_iterate_crc_lookup(
+/* Looks up content file 'name' in all databases */
+static void task_database_match(
       db_handle_t *_db,
       database_state_handle_t *db_state,
       database_info_handle_t *db,
       const char *name,
-      const char *archive_entry,
-      bool path_contains_compressed_file)
+      const database_hash_result_t *result)
 {
-   if (!db_state->list ||
-         (unsigned)db_state->list_index == (unsigned)db_state->list->size)
-      return database_info_list_iterate_end_no_match(db, db_state, name,
-            path_contains_compressed_file);
+   size_t i;
+   const database_info_index_record_t *records         = NULL;
+   const database_info_index_record_t *archive_records = NULL;
+   size_t num_records                 = 0;
+   size_t num_archive_records         = 0;
+   bool path_contains_compressed_file = path_contains_compressed_file(name);
 
-   /* Archive did not contain a CRC for this entry, 
-    * or the file is empty. */
-   if (!db_state->crc)
+   switch (result->type)
    {
-      db_state->crc = file_archive_get_file_crc32(name);
-
-      if (!db_state->crc)
-         return database_info_list_iterate_next(db_state);
+      case DATABASE_TYPE_ITERATE_LUTRO:
+         task_database_iterate_playlist_lutro(_db, db_state, db, name);
+         return;
+      case DATABASE_TYPE_CRC_LOOKUP:
+      case DATABASE_TYPE_SERIAL_LOOKUP:
+         break;
+      default:
+         /* File could not be read */
+         return;
    }
 
-   if (db_state->entry_index == 0)
+   /* All records for this file, which are then
+    * filtered by database */
+   if (result->type == DATABASE_TYPE_CRC_LOOKUP)
    {
-      char query[50];
-
-      query[0] = '\0';
-
-      if (!_db->scan_without_core_match)
+      if (result->crc)
       {
-         /* don't scan files that can't be in this database.
-          *
-          * Could be because of:
-          * - A matching core missing
-          * - Incompatible file extension */
-         if (!core_info_database_supports_content_path(
-               db_state->list->elems[db_state->list_index].data, name))
-            return database_info_list_iterate_next(db_state);
-
-         if (!path_contains_compressed_file)
-         {
-            if (core_info_database_match_archive_member(
-                  db_state->list->elems[db_state->list_index].data))
-               return database_info_list_iterate_next(db_state);
-         }
+         num_records         = database_info_index_find(db_state->index,
+               DATABASE_INDEX_KEY_CRC, result->crc, &records);
+         if (result->archive_crc)
+            num_archive_records = database_info_index_find(
+                  db_state->index, DATABASE_INDEX_KEY_CRC,
+                  result->archive_crc, &archive_records);
       }
-
-      snprintf(query, sizeof(query),
-            "{crc:or(b\"%08X\",b\"%08X\")}",
-            db_state->crc, db_state->archive_crc);
-
-      database_info_list_iterate_new(db_state, query);
    }
+   else if (!string_is_empty(result->serial))
+      num_records            = database_info_index_find(db_state->index,
+            DATABASE_INDEX_KEY_SERIAL,
+            database_info_index_get_serial_key(result->serial), &records);
 
-   if (db_state->info)
+   for (i = 0; (num_records || num_archive_records)
+         && (i < db_state->list->size); i++)
    {
-      database_info_t *db_info_entry =
-         &db_state->info->list[db_state->entry_index];
+      size_t j;
+      database_info_index_entry_t db_info_entry;
+      const database_info_index_record_t *record = NULL;
+      const char *db_path = db_state->list->elems[i].data;
+      size_t id           = db_state->rdbs[i].id;
 
-      if (db_info_entry && db_info_entry->crc32)
+      if (result->type == DATABASE_TYPE_CRC_LOOKUP)
       {
-#if 0
-         RARCH_LOG("CRC32: 0x%08X , entry CRC32: 0x%08X (%s).\n",
-               db_state->crc, db_info_entry->crc32, db_info_entry->name);
-#endif
-         if (db_state->archive_crc == db_info_entry->crc32)
-            return database_info_list_iterate_found_match(
-                  _db,
-                  db_state, db, NULL);
-         if (db_state->crc == db_info_entry->crc32)
-            return database_info_list_iterate_found_match(
-                  _db,
-                  db_state, db, archive_entry);
-      }
-   }
-
-   db_state->entry_index++;
-
-   if (db_state->info)
-   {
-      if (db_state->entry_index >= db_state->info->count)
-         return database_info_list_iterate_next(db_state);
-   }
-
-   /* If we haven't reached the end of the database list yet,
-    * continue iterating. */
-   if (db_state->list_index < db_state->list->size)
-      return 1;
-
-   database_info_list_free(db_state->info);
-
-   if (db_state->info)
-      free(db_state->info);
-
-   return 0;
-}
+         const database_info_index_record_t *crc_record = NULL;
 
-static int task_database_iterate_playlist_lutro(
-      db_handle_t *_db,
-      database_state_handle_t *db_state,
-      database_info_handle_t *db,
-      const char *path)
-{
-   char db_playlist_path[PATH_MAX_LENGTH];
-   playlist_t   *playlist  = NULL;
-
-   db_playlist_path[0]     = '\0';
-
-   if (!string_is_empty(_db->playlist_directory))
-      fill_pathname_join(db_playlist_path,
-            _db->playlist_directory,
-            "Lutro.lpl", sizeof(db_playlist_path));
+         if (!_db->scan_without_core_match)
+         {
+            /* don't scan files that can't be in this database.
+             *
+             * Could be because of:
+             * - A matching core missing
+             * - Incompatible file extension */
+            if (!core_info_database_supports_content_path(db_path, name))
+               continue;
+
+            if (!path_contains_compressed_file)
+            {
+               if (core_info_database_match_archive_member(db_path))
+                  continue;
+            }
+         }
 
-   playlist_config_set_path(&_db->playlist_config, db_playlist_path);
-   playlist = playlist_init(&_db->playlist_config);
+         /* First entry in database order matching either
+          * CRC wins, the archive CRC taking precedence */
+         record     = task_database_find_record(archive_records,
+               num_archive_records, id);
+         crc_record = task_database_find_record(records, num_records, id);
 
-   if (!playlist_entry_exists(playlist, path))
-   {
-      struct playlist_entry entry;
-      char game_title[PATH_MAX_LENGTH];
+         if (!record || (crc_record && crc_record->offset < record->offset))
+            record  = crc_record;
 
-      game_title[0]               = '\0';
+         if (record && database_info_index_read_entry(db_state->index,
+                  record, &db_info_entry))
+         {
+            database_info_list_iterate_found_match(_db, db_state, db,
+                  i, &db_info_entry);
+            database_info_index_entry_free(&db_info_entry);
+            return;
+         }
+      }
+      else
+      {
+         /* Serial keys are hashes, so entries must be checked */
+         for (j = 0; j < num_records; j++)
+         {
+            if (records[j].rdb != id)
+               continue;
 
-      fill_short_pathname_representation_noext(game_title,
-            path, sizeof(game_title));
+            if (!database_info_index_read_entry(db_state->index,
+                     &records[j], &db_info_entry))
+               continue;
 
-      /* the push function reads our entry as const, 
-       * so these casts are safe */
-      entry.path                  = (char*)path;
-      entry.label                 = game_title;
-      entry.core_path             = (char*)"DETECT";
-      entry.core_name             = (char*)"DETECT";
-      entry.db_name               = (char*)"Lutro.lpl";
-      entry.crc32                 = (char*)"DETECT";
-      entry.subsystem_ident       = NULL;
-      entry.subsystem_name        = NULL;
-      entry.subsystem_roms        = NULL;
-      entry.runtime_hours         = 0;
-      entry.runtime_minutes       = 0;
-      entry.runtime_seconds       = 0;
-      entry.last_played_year      = 0;
-      entry.last_played_month     = 0;
-      entry.last_played_day       = 0;
-      entry.last_played_hour      = 0;
-      entry.last_played_minute    = 0;
-      entry.last_played_second    = 0;
+            if (string_is_equal(db_info_entry.serial, result->serial))
+            {
+               database_info_list_iterate_found_match(_db, db_state, db,
+                     i, &db_info_entry);
+               database_info_index_entry_free(&db_info_entry);
+               return;
+            }
 
-      playlist_push(playlist, &entry);
+            database_info_index_entry_free(&db_info_entry);
+         }
+      }
    }
 
-   playlist_write_file(playlist);
-   playlist_free(playlist);
-
-   return 0;
+   database_info_list_iterate_end_no_match(_db, db, db_state, name,
+         path_contains_compressed_file);
 }
 
-static int task_database_iterate_serial_lookup(
-      db_handle_t *_db,
-      database_state_handle_t *db_state,
-      database_info_handle_t *db, const char *name,
-      bool path_contains_compressed_file
-      )
+static void task_database_cleanup_state(
+      database_state_handle_t *db_state)
 {
-   if (
-         !db_state->list ||
-         (unsigned)db_state->list_index == (unsigned)db_state->list->size
-      )
-      return database_info_list_iterate_end_no_match(db, db_state, name,
-            path_contains_compressed_file);
-
-   if (db_state->entry_index == 0)
-   {
-      char query[50];
-      char *serial_buf = bin_to_hex_alloc(
-            (uint8_t*)db_state->serial,
-            strlen(db_state->serial) * sizeof(uint8_t));
-
-      if (!serial_buf)
-         return 1;
-
-      query[0] = '\0';
+   size_t i;
 
-      snprintf(query, sizeof(query), "{'serial': b'%s'}", serial_buf);
-      database_info_list_iterate_new(db_state, query);
+   task_database_hash_deinit(db_state);
 
-      free(serial_buf);
-   }
+   if (!db_state->list)
+      return;
 
-   if (db_state->info)
+   /* Playlists were kept open for the whole scan */
+   for (i = 0; i < db_state->list->size; i++)
    {
-      database_info_t *db_info_entry = &db_state->info->list[
-         db_state->entry_index];
+      database_state_rdb_t *rdb = &db_state->rdbs[i];
 
-      if (db_info_entry && db_info_entry->serial)
+      if (rdb->playlist)
       {
-#if 0
-         RARCH_LOG("serial: %s , entry serial: %s (%s).\n",
-                   db_state->serial, db_info_entry->serial,
-                   db_info_entry->name);
-#endif
-         if (string_is_equal(db_state->serial, db_info_entry->serial))
-            return database_info_list_iterate_found_match(_db,
-                  db_state, db, NULL);
+         playlist_write_file(rdb->playlist);
+         playlist_free(rdb->playlist);
       }
    }
 
-   db_state->entry_index++;
-
-   if (db_state->info)
-   {
-      if (db_state->entry_index >= db_state->info->count)
-         return database_info_list_iterate_next(db_state);
-   }
-
-   /* If we haven't reached the end of the database list yet,
-    * continue iterating. */
-   if (db_state->list_index < db_state->list->size)
-      return 1;
-
-   database_info_list_free(db_state->info);
-   free(db_state->info);
-   return 0;
-}
-
-static int task_database_iterate(
-      db_handle_t *_db,
-      const char *name,
-      database_state_handle_t *db_state,
-      database_info_handle_t *db,
-      bool path_contains_compressed_file)
-{
-   switch (db->type)
-   {
-      case DATABASE_TYPE_ITERATE:
-         return task_database_iterate_playlist(db_state, db, name);
-      case DATABASE_TYPE_ITERATE_ARCHIVE:
-#ifdef HAVE_COMPRESSION
-         return task_database_iterate_crc_lookup(
-               _db, db_state, db, name, db_state->archive_name,
-               path_contains_compressed_file);
-#else
-         return 1;
-#endif
-      case DATABASE_TYPE_ITERATE_LUTRO:
-         return task_database_iterate_playlist_lutro(_db, db_state, db, name);
-      case DATABASE_TYPE_SERIAL_LOOKUP:
-         return task_database_iterate_serial_lookup(_db, db_state, db, name,
-               path_contains_compressed_file);
-      case DATABASE_TYPE_CRC_LOOKUP:
-         return task_database_iterate_crc_lookup(_db, db_state, db, name, NULL,
-               path_contains_compressed_file);
-      case DATABASE_TYPE_NONE:
-      default:
-         break;
-   }
-
-   return 0;
-}
-
-static void task_database_cleanup_state(
-      database_state_handle_t *db_state)
-{
-   if (!db_state)
-      return;
-
-   if (db_state->buf)
-      free(db_state->buf);
-   db_state->buf = NULL;
+   database_info_index_free(db_state->index);
+   db_state->index = NULL;
+   RBUF_FREE(db_state->rdbs);
+   dir_list_free(db_state->list);
+   db_state->list = NULL;
 }
 
 static void task_database_handler(retro_task_t *task)
@@ -1171,6 +1400,8 @@ static void task_database_handler(retro_task_t *task)
       case DATABASE_STATUS_ITERATE_BEGIN:
          if (dbstate && !dbstate->list)
          {
+            size_t i;
+
             if (!string_is_empty(db->content_database_path))
                dbstate->list        = dir_list_new(
                      db->content_database_path,
@@ -1178,11 +1409,35 @@ static void task_database_handler(retro_task_t *task)
                      db->show_hidden_files,
                      false, false);
 
+            if (dbstate->list)
+            {
+               size_t size = dbstate->list->size;
+               char cache_path[PATH_MAX_LENGTH];
+
+               fill_pathname_join(cache_path, db->content_database_path,
+                     FILE_PATH_RDB_INDEX_CACHE, sizeof(cache_path));
+
+               dbstate->index = database_info_index_new(dbstate->list,
+                     cache_path);
+
+               if (RBUF_TRYFIT(dbstate->rdbs, size))
+               {
+                  RBUF_RESIZE(dbstate->rdbs, size);
+                  memset(dbstate->rdbs, 0, size * sizeof(*dbstate->rdbs));
+                  for (i = 0; i < size; i++)
+                     dbstate->rdbs[i].id = i;
+               }
+               else
+               {
+                  dir_list_free(dbstate->list);
+                  dbstate->list = NULL;
+               }
+            }
+
             /* If the scan path matches a database path exactly then
              * save time by only processing that database. */
             if (dbstate->list && db->is_directory)
             {
-               size_t i;
                char *dirname = NULL;
 
                if (!string_is_empty(db->fullpath))
@@ -1211,41 +1466,44 @@ static void task_database_handler(retro_task_t *task)
                               data,
                               dbstate->list->elems[i].attr);
                         dir_list_free(dbstate->list);
-                        dbstate->list = single_list;
+                        dbstate->list        = single_list;
+                        dbstate->rdbs[0].id  = i;
                         break;
                      }
                   }
                }
             }
          }
+
+         /* Remove files referenced by cue/gdi files before
+          * the hashing threads get to them */
+         task_database_prune(dbinfo);
+         task_database_hash_init(db);
          dbinfo->status = DATABASE_STATUS_ITERATE_START;
          break;
       case DATABASE_STATUS_ITERATE_START:
          name                 = database_info_get_current_element_name(dbinfo);
-         task_database_cleanup_state(dbstate);
-         dbstate->list_index  = 0;
-         dbstate->entry_index = 0;
          task_database_iterate_start(task, dbinfo, name);
          break;
       case DATABASE_STATUS_ITERATE:
          {
-            bool path_contains_compressed_file = false;
-            const char *name                   = 
+            database_hash_result_t result;
+            const char *name                   =
                database_info_get_current_element_name(dbinfo);
             if (!name)
                goto task_finished;
 
-            path_contains_compressed_file      = path_contains_compressed_file(name);
-            if (path_contains_compressed_file)
-               if (dbinfo->type == DATABASE_TYPE_ITERATE)
-                  dbinfo->type   = DATABASE_TYPE_ITERATE_ARCHIVE;
+            /* Not hashed yet, try again on the next iteration */
+            if (!task_database_hash_get(db, dbinfo->list_ptr, &result))
+               break;
 
-            if (task_database_iterate(db, name, dbstate, dbinfo,
-                     path_contains_compressed_file) == 0)
-            {
-               dbinfo->status    = DATABASE_STATUS_ITERATE_NEXT;
-               dbinfo->type      = DATABASE_TYPE_ITERATE;
-            }
+            task_database_match(db, dbstate, dbinfo, name, &result);
+
+            if (result.serial)
+               free(result.serial);
+
+            dbinfo->status    = DATABASE_STATUS_ITERATE_NEXT;
+            dbinfo->type      = DATABASE_TYPE_ITERATE;
          }
          break;
       case DATABASE_STATUS_ITERATE_NEXT:
@@ -1286,10 +1544,7 @@ task_finished:
       task_set_finished(task, true);
 
    if (dbstate)
-   {
-      if (dbstate->list)
-         dir_list_free(dbstate->list);
-   }
+      task_database_cleanup_state(dbstate);
 
    if (db)
    {
@@ -1299,8 +1554,6 @@ task_finished:
          free(db->content_database_path);
       if (!string_is_empty(db->fullpath))
          free(db->fullpath);
-      if (db->state.buf)
-         free(db->state.buf);
 
       if (db->handle)
          database_info_free(db->handle);
@@ -1338,6 +1591,7 @@ bool task_push_dbscan(
       goto error;
 
    t->handler                              = task_database_handler;
+   t->priority                             = TASK_PRIORITY_LOW;
    t->state                                = db;
    t->callback                             = cb;
    t->title                                = strdup(msg_hash_to_str(
@@ -81,6 +81,14 @@ typedef struct
 void* task_push_http_transfer_file(const char* url, bool mute, const char* type,
       retro_task_callback_t cb, file_transfer_t* transfer_data);
 
+/* Like task_push_http_transfer_file(), but the body is
+ * written to transfer_data->path as it arrives, instead
+ * of being kept in memory. On success, the callback gets
+ * a NULL data->data, with data->len the size of the file. */
+void* task_push_http_transfer_file_to_disk(const char* url, bool mute,
+      const char* type,
+      retro_task_callback_t cb, file_transfer_t* transfer_data);
+
 RETRO_END_DECLS
 
 #endif
@@ -20,6 +20,7 @@
 #include <compat/strl.h>
 #include <file/file_path.h>
 #include <net/net_compat.h>
+#include <streams/file_stream.h>
 #include <retro_timers.h>
 
 #ifdef RARCH_INTERNAL
@@ -52,6 +53,11 @@ struct http_handle
       struct http_connection_t *handle;
       transfer_cb_t  cb;
    } connection;
+   /* Set when the body goes straight to disk, into
+    * 'file_path' suffixed with '.part' until it is done */
+   char *file_path;
+   RFILE *file;
+   size_t file_len;
    unsigned status;
    bool error;
    char connection_elem[255];
@@ -84,6 +90,79 @@ static int task_http_conn_iterate_transfer_parse(
    return 0;
 }
 
+static void task_http_file_part_path(http_handle_t *http,
+      char *s, size_t len)
+{
+   strlcpy(s, http->file_path, len);
+   strlcat(s, ".part", len);
+}
+
+static bool task_http_file_open(http_handle_t *http)
+{
+   char dir[PATH_MAX_LENGTH];
+   char part_path[PATH_MAX_LENGTH];
+
+   fill_pathname_basedir(dir, http->file_path, sizeof(dir));
+
+   if (!path_is_directory(dir) && !path_mkdir(dir))
+      return false;
+
+   task_http_file_part_path(http, part_path, sizeof(part_path));
+
+   http->file = filestream_open(part_path,
+         RETRO_VFS_FILE_ACCESS_WRITE,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   return (http->file != NULL);
+}
+
+static bool task_http_file_sink(void *data,
+      const uint8_t *buf, size_t len)
+{
+   http_handle_t *http = (http_handle_t*)data;
+
+   if (!http->file && !task_http_file_open(http))
+      return false;
+
+   if (filestream_write(http->file, buf, len) != (int64_t)len)
+      return false;
+
+   http->file_len += len;
+   return true;
+}
+
+/* Moves a completed download into place,
+ * or throws away what there is of it */
+static bool task_http_file_finish(http_handle_t *http, bool success)
+{
+   char part_path[PATH_MAX_LENGTH];
+
+   task_http_file_part_path(http, part_path, sizeof(part_path));
+
+   /* An empty body never reached the sink */
+   if (success && !http->file && !task_http_file_open(http))
+      success = false;
+
+   if (http->file)
+   {
+      if (filestream_close(http->file) != 0)
+         success = false;
+      http->file = NULL;
+   }
+
+   if (success)
+   {
+      if (path_is_valid(http->file_path))
+         filestream_delete(http->file_path);
+      success = (filestream_rename(part_path, http->file_path) == 0);
+   }
+
+   if (!success && path_is_valid(part_path))
+      filestream_delete(part_path);
+
+   return success;
+}
+
 static int cb_http_conn_default(void *data_, size_t len)
 {
    http_handle_t *http = (http_handle_t*)data_;
@@ -104,6 +183,9 @@ static int cb_http_conn_default(void *data_, size_t len)
 
    http->cb     = NULL;
 
+   if (http->file_path)
+      net_http_set_sink(http->handle, task_http_file_sink, http);
+
    return 0;
 }
 
@@ -207,6 +289,23 @@ task_finished:
                task_set_error(task, strdup("Download failed."));
          }
       }
+      else if (http->file_path)
+      {
+         if (tmp)
+            free(tmp);
+
+         if (task_http_file_finish(http, true))
+         {
+            data = (http_transfer_data_t*)malloc(sizeof(*data));
+            data->data   = NULL;
+            data->len    = http->file_len;
+            data->status = net_http_status(http->handle);
+
+            task_set_data(task, data);
+         }
+         else
+            task_set_error(task, strdup("Write failed."));
+      }
       else
       {
          data = (http_transfer_data_t*)malloc(sizeof(*data));
@@ -221,6 +320,13 @@ task_finished:
    } else if (http->error)
       task_set_error(task, strdup("Internal error."));
 
+   /* Whatever is left of a failed download */
+   if (http->file_path)
+   {
+      task_http_file_finish(http, false);
+      free(http->file_path);
+   }
+
    free(http);
 }
 
@@ -278,6 +384,7 @@ static void http_transfer_progress_cb(retro_task_t *task)
 static void* task_push_http_transfer_generic(
       struct http_connection_t *conn,
       const char *url, bool mute, const char *type,
+      const char *file_path,
       retro_task_callback_t cb, void *user_data)
 {
    retro_task_t  *t        = NULL;
@@ -321,9 +428,15 @@ static void* task_push_http_transfer_generic(
    http->connection_url[0]   = '\0';
    http->handle              = NULL;
    http->cb                  = NULL;
+   http->file_path           = NULL;
+   http->file                = NULL;
+   http->file_len            = 0;
    http->status              = 0;
    http->error               = false;
 
+   if (file_path && !(http->file_path = strdup(file_path)))
+      goto error;
+
    if (type)
       strlcpy(http->connection_elem, type, sizeof(http->connection_elem));
 
@@ -336,6 +449,7 @@ static void* task_push_http_transfer_generic(
       goto error;
 
    t->handler              = task_http_transfer_handler;
+   t->affinity             = TASK_AFFINITY_IO;
    t->state                = http;
    t->mute                 = mute;
    t->callback             = cb;
@@ -352,7 +466,11 @@ error:
    if (conn)
       net_http_connection_free(conn);
    if (http)
+   {
+      if (http->file_path)
+         free(http->file_path);
       free(http);
+   }
 
    return NULL;
 }
@@ -366,11 +484,11 @@ void* task_push_http_transfer(const char *url, bool mute,
 
    return task_push_http_transfer_generic(
          net_http_connection_new(url, "GET", NULL),
-         url, mute, type, cb, user_data);
+         url, mute, type, NULL, cb, user_data);
 }
 
-void* task_push_http_transfer_file(const char* url, bool mute,
-      const char* type,
+static void* task_push_http_transfer_file_internal(const char* url,
+      bool mute, const char* type, bool to_disk,
       retro_task_callback_t cb, file_transfer_t* transfer_data)
 {
    const char *s   = NULL;
@@ -382,7 +500,9 @@ void* task_push_http_transfer_file(const char* url, bool mute,
 
    t = (retro_task_t*)task_push_http_transfer_generic(
          net_http_connection_new(url, "GET", NULL),
-         url, mute, type, cb, transfer_data);
+         url, mute, type,
+         (to_disk && transfer_data) ? transfer_data->path : NULL,
+         cb, transfer_data);
 
    if (!t)
       return NULL;
@@ -405,6 +525,22 @@ void* task_push_http_transfer_file(const char* url, bool mute,
    return t;
 }
 
+void* task_push_http_transfer_file(const char* url, bool mute,
+      const char* type,
+      retro_task_callback_t cb, file_transfer_t* transfer_data)
+{
+   return task_push_http_transfer_file_internal(url, mute, type,
+         false, cb, transfer_data);
+}
+
+void* task_push_http_transfer_file_to_disk(const char* url, bool mute,
+      const char* type,
+      retro_task_callback_t cb, file_transfer_t* transfer_data)
+{
+   return task_push_http_transfer_file_internal(url, mute, type,
+         true, cb, transfer_data);
+}
+
 void* task_push_http_transfer_with_user_agent(const char *url, bool mute,
    const char *type, const char* user_agent,
    retro_task_callback_t cb, void *user_data)
@@ -422,7 +558,7 @@ void* task_push_http_transfer_with_user_agent(const char *url, bool mute,
       net_http_connection_set_user_agent(conn, user_agent);
 
    /* assert: task_push_http_transfer_generic will free conn on failure */
-   return task_push_http_transfer_generic(conn, url, mute, type, cb, user_data);
+   return task_push_http_transfer_generic(conn, url, mute, type, NULL, cb, user_data);
 }
 
 void* task_push_http_post_transfer(const char *url,
@@ -433,7 +569,7 @@ void* task_push_http_post_transfer(const char *url,
       return NULL;
    return task_push_http_transfer_generic(
          net_http_connection_new(url, "POST", post_data),
-         url, mute, type, cb, user_data);
+         url, mute, type, NULL, cb, user_data);
 }
 
 void* task_push_http_post_transfer_with_user_agent(const char *url,
@@ -454,7 +590,7 @@ void* task_push_http_post_transfer_with_user_agent(const char *url,
       net_http_connection_set_user_agent(conn, user_agent);
 
    /* assert: task_push_http_transfer_generic will free conn on failure */
-   return task_push_http_transfer_generic(conn, url, mute, type, cb, user_data);
+   return task_push_http_transfer_generic(conn, url, mute, type, NULL, cb, user_data);
 }
 
 task_retriever_info_t *http_task_get_transfer_list(void)
@@ -21,6 +21,7 @@
 #include <file/nbio.h>
 #include <formats/image.h>
 #include <compat/strl.h>
+#include <file/file_path.h>
 #include <string/stdstring.h>
 #include <retro_miscellaneous.h>
 #include <features/features_cpu.h>
@@ -29,6 +30,9 @@
 #include "tasks_internal.h"
 
 #include "../configuration.h"
+#include "../content.h"
+#include "../file_path_special.h"
+#include "../gfx/gfx_thumbnail_pack.h"
 
 enum image_status_enum
 {
@@ -48,6 +52,8 @@ struct nbio_image_handle
    int processing_final_state;
    unsigned frame_duration;
    unsigned upscale_threshold;
+   unsigned max_width;
+   unsigned max_height;
    enum image_type_enum type;
    enum image_status_enum status;
    bool is_blocking;
@@ -272,6 +278,103 @@ static bool upscale_image(
    return true;
 }
 
+/* Upscales 'ti' in place if either dimension is
+ * smaller than 'upscale_threshold' */
+static void task_image_upscale(struct texture_image *ti,
+      unsigned upscale_threshold)
+{
+   if (upscale_threshold > 0)
+   {
+      if (((ti->width > 0) && (ti->height > 0)) &&
+          ((ti->width  < upscale_threshold) ||
+           (ti->height < upscale_threshold)))
+      {
+         unsigned min_size                  = (ti->width < ti->height) ?
+                                                ti->width : ti->height;
+         float scale_factor                 = (float)upscale_threshold /
+                                                (float)min_size;
+         unsigned scale_factor_int          = (unsigned)scale_factor;
+         struct texture_image img_resampled = {
+            NULL,
+            0,
+            0,
+            false
+         };
+
+         if (scale_factor - (float)scale_factor_int > 0.0f)
+            scale_factor_int += 1;
+
+         if (upscale_image(scale_factor_int, ti, &img_resampled))
+         {
+            ti->width  = img_resampled.width;
+            ti->height = img_resampled.height;
+
+            if (ti->pixels)
+               free(ti->pixels);
+            ti->pixels = img_resampled.pixels;
+         }
+      }
+   }
+}
+
+/* Box filters 'ti' in place by the largest integer factor
+ * that keeps it at least 'max_width' x 'max_height', so that
+ * e.g. a 4K wallpaper shown at 1080p is kept at a quarter of
+ * the size. Runs on the task thread, unlike the upload. */
+static void task_image_downscale(struct texture_image *ti,
+      unsigned max_width, unsigned max_height)
+{
+   unsigned x, y, i, j, factor, width, height;
+   uint32_t *pixels, *out;
+
+   if (!max_width || !max_height || !ti->pixels)
+      return;
+
+   factor = MIN(ti->width / max_width, ti->height / max_height);
+   if (factor < 2)
+      return;
+
+   width  = ti->width  / factor;
+   height = ti->height / factor;
+
+   if (!(pixels = (uint32_t*)malloc(width * height * sizeof(uint32_t))))
+      return;
+
+   out = pixels;
+   for (y = 0; y < height; y++)
+   {
+      for (x = 0; x < width; x++)
+      {
+         /* Channel order doesn't matter, each byte is
+          * averaged on its own */
+         uint32_t sum[4] = {0};
+         const uint32_t *src = ti->pixels
+            + (y * factor) * ti->width + x * factor;
+
+         for (j = 0; j < factor; j++, src += ti->width)
+         {
+            for (i = 0; i < factor; i++)
+            {
+               sum[0] += (src[i] >>  0) & 0xff;
+               sum[1] += (src[i] >>  8) & 0xff;
+               sum[2] += (src[i] >> 16) & 0xff;
+               sum[3] += (src[i] >> 24) & 0xff;
+            }
+         }
+
+         *out++ = ((sum[0] / (factor * factor)) <<  0)
+                | ((sum[1] / (factor * factor)) <<  8)
+                | ((sum[2] / (factor * factor)) << 16)
+                | ((sum[3] / (factor * factor)) << 24);
+      }
+   }
+
+   free(ti->pixels);
+   ti->pixels = pixels;
+   ti->width  = width;
+   ti->height = height;
+}
+
 bool task_image_load_handler(retro_task_t *task)
 {
    nbio_handle_t            *nbio  = (nbio_handle_t*)task->state;
@@ -332,39 +435,11 @@ bool task_image_load_handler(retro_task_t *task)
 
       if (img)
       {
-         /* Upscale image, if required */
-         if (image->upscale_threshold > 0)
-         {
-            if (((image->ti.width > 0) && (image->ti.height > 0)) &&
-                ((image->ti.width  < image->upscale_threshold) ||
-                 (image->ti.height < image->upscale_threshold)))
-            {
-               unsigned min_size                  = (image->ti.width < image->ti.height) ?
-                                                      image->ti.width : image->ti.height;
-               float scale_factor                 = (float)image->upscale_threshold /
-                                                      (float)min_size;
-               unsigned scale_factor_int          = (unsigned)scale_factor;
-               struct texture_image img_resampled = {
-                  NULL,
-                  0,
-                  0,
-                  false
-               };
-
-               if (scale_factor - (float)scale_factor_int > 0.0f)
-                  scale_factor_int += 1;
-
-               if (upscale_image(scale_factor_int, &image->ti, &img_resampled))
-               {
-                  image->ti.width  = img_resampled.width;
-                  image->ti.height = img_resampled.height;
-
-                  if (image->ti.pixels)
-                     free(image->ti.pixels);
-                  image->ti.pixels = img_resampled.pixels;
-               }
-            }
-         }
+         /* Downscale image to what is displayed, or
+          * upscale it, if required */
+         task_image_downscale(&image->ti,
+               image->max_width, image->max_height);
+         task_image_upscale(&image->ti, image->upscale_threshold);
 
          img->width         = image->ti.width;
          img->height        = image->ti.height;
@@ -383,6 +458,24 @@ bool task_image_load_handler(retro_task_t *task)
 bool task_push_image_load(const char *fullpath, 
       bool supports_rgba, unsigned upscale_threshold,
       retro_task_callback_t cb, void *user_data)
+{
+   return task_push_image_load_priority(fullpath, supports_rgba,
+         upscale_threshold, 0, 0, TASK_PRIORITY_NORMAL, cb, user_data);
+}
+
+bool task_push_image_load_scaled(const char *fullpath,
+      bool supports_rgba, unsigned max_width, unsigned max_height,
+      retro_task_callback_t cb, void *user_data)
+{
+   return task_push_image_load_priority(fullpath, supports_rgba,
+         0, max_width, max_height, TASK_PRIORITY_NORMAL, cb, user_data);
+}
+
+bool task_push_image_load_priority(const char *fullpath,
+      bool supports_rgba, unsigned upscale_threshold,
+      unsigned max_width, unsigned max_height,
+      enum task_priority priority,
+      retro_task_callback_t cb, void *user_data)
 {
    nbio_handle_t             *nbio   = NULL;
    struct nbio_image_handle   *image = NULL;
@@ -430,6 +523,8 @@ bool task_push_image_load(const char *fullpath,
    image->frame_duration             = 0;
    image->size                       = 0;
    image->upscale_threshold          = upscale_threshold;
+   image->max_width                  = max_width;
+   image->max_height                 = max_height;
    image->handle                     = NULL;
 
    image->ti.width                   = 0;
@@ -464,6 +559,228 @@ bool task_push_image_load(const char *fullpath,
    t->cleanup         = task_image_load_free;
    t->callback        = cb;
    t->user_data       = user_data;
+   /* Image decoding only touches the task's own state,
+    * so several thumbnails can be decoded at once */
+   t->concurrent      = true;
+   t->priority        = priority;
+
+   task_queue_push(t);
+
+   return true;
+}
+
+struct pack_image_handle
+{
+   char *path;
+   gfx_thumbnail_pack_entry_t entry;
+   unsigned upscale_threshold;
+};
+
+static void task_image_load_pack_free(retro_task_t *task)
+{
+   struct pack_image_handle *pack = task
+         ? (struct pack_image_handle*)task->state : NULL;
+
+   if (pack)
+   {
+      if (pack->path)
+         free(pack->path);
+      free(pack);
+   }
+}
+
+static void task_image_load_pack_handler(retro_task_t *task)
+{
+   struct pack_image_handle *pack = (struct pack_image_handle*)task->state;
+
+   if (!task_get_cancelled(task))
+   {
+      struct texture_image *img = (struct texture_image*)
+            malloc(sizeof(struct texture_image));
+
+      if (img)
+      {
+         if (gfx_thumbnail_pack_read(pack->path, &pack->entry, img))
+         {
+            task_image_upscale(img, pack->upscale_threshold);
+            task_set_data(task, img);
+         }
+         else
+            free(img);
+      }
+   }
+
+   task_set_finished(task, true);
+}
+
+bool task_push_image_load_pack(const char *pack_path,
+      const struct gfx_thumbnail_pack_entry *entry,
+      unsigned upscale_threshold,
+      enum task_priority priority,
+      retro_task_callback_t cb, void *user_data)
+{
+   struct pack_image_handle *pack = NULL;
+   retro_task_t                *t = NULL;
+
+   if (string_is_empty(pack_path) || !entry)
+      return false;
+
+   if (!(t = task_init()))
+      return false;
+
+   if (!(pack = (struct pack_image_handle*)malloc(sizeof(*pack))))
+   {
+      free(t);
+      return false;
+   }
+
+   pack->path              = strdup(pack_path);
+   pack->entry             = *entry;
+   pack->upscale_threshold = upscale_threshold;
+
+   t->state                = pack;
+   t->handler              = task_image_load_pack_handler;
+   t->cleanup              = task_image_load_pack_free;
+   t->callback             = cb;
+   t->user_data            = user_data;
+   t->concurrent           = true;
+   t->priority             = priority;
+
+   task_queue_push(t);
+
+   return true;
+}
+
+struct savestate_image_handle
+{
+   char *path;
+   unsigned upscale_threshold;
+   bool supports_rgba;
+};
+
+static void task_image_load_savestate_free(retro_task_t *task)
+{
+   struct savestate_image_handle *state = task
+         ? (struct savestate_image_handle*)task->state : NULL;
+
+   if (state)
+   {
+      if (state->path)
+         free(state->path);
+      free(state);
+   }
+}
+
+/* Reads the thumbnail embedded in the state, falling
+ * back to the screenshot saved next to it */
+static bool task_image_read_savestate(
+      const struct savestate_image_handle *state,
+      struct texture_image *img)
+{
+   content_state_info_t info;
+   char png_path[PATH_MAX_LENGTH];
+
+   img->pixels        = NULL;
+   img->width         = 0;
+   img->height        = 0;
+   img->supports_rgba = state->supports_rgba;
+
+   if (     content_read_state_info(state->path, &info, true)
+         && info.thumbnail)
+   {
+      size_t i;
+      size_t num_pixels = info.thumbnail_width * info.thumbnail_height;
+      uint32_t *dst     = (uint32_t*)malloc(num_pixels * sizeof(uint32_t));
+
+      if (dst)
+      {
+         for (i = 0; i < num_pixels; i++)
+         {
+            uint32_t col = info.thumbnail[i];
+            uint32_t r   = (col >> 11) & 0x1F;
+            uint32_t g   = (col >>  5) & 0x3F;
+            uint32_t b   = (col      ) & 0x1F;
+
+            r            = (r << 3) | (r >> 2);
+            g            = (g << 2) | (g >> 4);
+            b            = (b << 3) | (b >> 2);
+
+            dst[i]       = 0xFF000000 | (r << 16) | (g << 8) | b;
+         }
+
+         img->pixels        = dst;
+         img->width         = info.thumbnail_width;
+         img->height        = info.thumbnail_height;
+         img->supports_rgba = false;
+      }
+
+      free(info.thumbnail);
+      return (dst != NULL);
+   }
+
+   strlcpy(png_path, state->path, sizeof(png_path));
+   strlcat(png_path, FILE_PATH_PNG_EXTENSION, sizeof(png_path));
+
+   if (!path_is_valid(png_path))
+      return false;
+
+   return image_texture_load(img, png_path);
+}
+
+static void task_image_load_savestate_handler(retro_task_t *task)
+{
+   struct savestate_image_handle *state =
+         (struct savestate_image_handle*)task->state;
+
+   if (!task_get_cancelled(task))
+   {
+      struct texture_image *img = (struct texture_image*)
+            malloc(sizeof(struct texture_image));
+
+      if (img)
+      {
+         if (task_image_read_savestate(state, img))
+         {
+            task_image_upscale(img, state->upscale_threshold);
+            task_set_data(task, img);
+         }
+         else
+            free(img);
+      }
+   }
+
+   task_set_finished(task, true);
+}
+
+bool task_push_image_load_savestate(const char *state_path,
+      bool supports_rgba, unsigned upscale_threshold,
+      retro_task_callback_t cb, void *user_data)
+{
+   struct savestate_image_handle *state = NULL;
+   retro_task_t                     *t = NULL;
+
+   if (string_is_empty(state_path))
+      return false;
+
+   if (!(t = task_init()))
+      return false;
+
+   if (!(state = (struct savestate_image_handle*)malloc(sizeof(*state))))
+   {
+      free(t);
+      return false;
+   }
+
+   state->path              = strdup(state_path);
+   state->upscale_threshold = upscale_threshold;
+   state->supports_rgba     = supports_rgba;
+
+   t->state                 = state;
+   t->handler               = task_image_load_savestate_handler;
+   t->cleanup               = task_image_load_savestate_free;
+   t->callback              = cb;
+   t->user_data             = user_data;
+   t->concurrent            = true;
 
    task_queue_push(t);
 
@@ -23,10 +23,16 @@
 #include <boolean.h>
 
 #include <string/stdstring.h>
+#include <array/rbuf.h>
 #include <lists/string_list.h>
 #include <file/file_path.h>
 #include <formats/logiqx_dat.h>
 #include <formats/m3u_file.h>
+#include <features/features_cpu.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#include <rthreads/tpool.h>
+#endif
 
 #include "tasks_internal.h"
 
@@ -35,6 +41,7 @@
 #include "../msg_hash.h"
 #include "../playlist.h"
 #include "../manual_content_scan.h"
+#include "../performance_counters.h"
 
 #ifdef RARCH_INTERNAL
 #ifdef HAVE_MENU
@@ -42,6 +49,15 @@
 #endif
 #endif
 
+/* Upper bound on the threads resolving playlist
+ * entries. Archives have to be opened and DAT files
+ * searched for each content file, which is mostly
+ * I/O bound, so this is not tied to the amount of cores */
+#define MANUAL_SCAN_MAX_WORKERS 8
+
+/* Amount of new entries added to the playlist at once */
+#define MANUAL_SCAN_BATCH_SIZE 1024
+
 enum manual_scan_status
 {
    MANUAL_SCAN_BEGIN = 0,
@@ -50,6 +66,16 @@ enum manual_scan_status
    MANUAL_SCAN_END
 };
 
+/* Playlist entry of a content file, as found by
+ * manual_content_scan_get_playlist_entry() */
+typedef struct manual_scan_result
+{
+   char *path;
+   char *label;
+   bool valid;
+   bool ready;
+} manual_scan_result_t;
+
 typedef struct manual_scan_handle
 {
    manual_content_scan_task_config_t *task_config;
@@ -57,6 +83,19 @@ typedef struct manual_scan_handle
    struct string_list *content_list;
    logiqx_dat_t *dat_file;
    struct string_list *m3u_list;
+   /* One entry per content file, filled in by
+    * the worker threads */
+   manual_scan_result_t *results;
+   /* New entries not yet added to the playlist */
+   struct playlist_entry *pending;
+#ifdef HAVE_THREADS
+   tpool_t *pool;
+   slock_t *lock;
+   scond_t *result_cond;
+#endif
+   size_t next_entry;
+   unsigned num_workers;
+   bool quit;
    playlist_config_t playlist_config; /* size_t alignment */
    size_t list_size;
    size_t list_index;
@@ -64,12 +103,221 @@ typedef struct manual_scan_handle
    enum manual_scan_status status;
 } manual_scan_handle_t;
 
+static void manual_scan_resolve(manual_scan_handle_t *manual_scan,
+      size_t pos, manual_scan_result_t *result)
+{
+   char playlist_content_path[PATH_MAX_LENGTH];
+   char label[PATH_MAX_LENGTH];
+   struct string_list_elem *elem = &manual_scan->content_list->elems[pos];
+
+   result->path  = NULL;
+   result->label = NULL;
+   result->valid = false;
+
+   if (string_is_empty(elem->data))
+      return;
+
+   if (!manual_content_scan_get_playlist_entry(
+         manual_scan->task_config, elem->data, elem->attr.i,
+         manual_scan->dat_file,
+         playlist_content_path, sizeof(playlist_content_path),
+         label, sizeof(label)))
+      return;
+
+   result->path  = strdup(playlist_content_path);
+   result->label = strdup(label);
+   result->valid = result->path && result->label;
+}
+
+#ifdef HAVE_THREADS
+/* Pool work item: resolves entries until every
+ * entry of the content list has been handed out */
+static void manual_scan_worker_work(void *data)
+{
+   manual_scan_handle_t *manual_scan = (manual_scan_handle_t*)data;
+
+   perf_trace_set_thread_name("manual scan");
+
+   slock_lock(manual_scan->lock);
+
+   while (!manual_scan->quit
+         && manual_scan->next_entry < manual_scan->list_size)
+   {
+      manual_scan_result_t result;
+      size_t pos = manual_scan->next_entry++;
+      slock_unlock(manual_scan->lock);
+
+      /* Only reads the task configuration, the
+       * content list and the DAT file, which are
+       * left alone until the workers are gone */
+      perf_trace_begin("manual_scan_resolve");
+      manual_scan_resolve(manual_scan, pos, &result);
+      perf_trace_end("manual_scan_resolve");
+
+      slock_lock(manual_scan->lock);
+      result.ready              = true;
+      manual_scan->results[pos] = result;
+      scond_signal(manual_scan->result_cond);
+   }
+
+   slock_unlock(manual_scan->lock);
+
+   /* Pool threads outlive the work item */
+   perf_trace_thread_exit();
+}
+#endif
+
+/* Starts resolving playlist entries, once the content
+ * list and DAT file are loaded */
+static bool manual_scan_workers_init(manual_scan_handle_t *manual_scan)
+{
+#ifdef HAVE_THREADS
+   unsigned i;
+   tpool_t *pool        = NULL;
+   unsigned num_workers = cpu_features_get_core_amount();
+
+   if (num_workers < 2)
+      num_workers = 2;
+   if (num_workers > MANUAL_SCAN_MAX_WORKERS)
+      num_workers = MANUAL_SCAN_MAX_WORKERS;
+#endif
+
+   if (!(manual_scan->results = (manual_scan_result_t*)calloc(
+         manual_scan->list_size, sizeof(*manual_scan->results))))
+      return false;
+
+#ifdef HAVE_THREADS
+   manual_scan->lock        = slock_new();
+   manual_scan->result_cond = scond_new();
+
+   if (!manual_scan->lock || !manual_scan->result_cond)
+      return true;
+
+   if (!(pool = tpool_create(num_workers)))
+      return true;
+
+   manual_scan->pool        = pool;
+   manual_scan->num_workers = num_workers;
+
+   /* One work item per pool thread */
+   for (i = 0; i < num_workers; i++)
+      tpool_add_work(pool, manual_scan_worker_work, manual_scan);
+#endif
+
+   return true;
+}
+
+static void manual_scan_workers_deinit(manual_scan_handle_t *manual_scan)
+{
+   size_t i;
+#ifdef HAVE_THREADS
+   if (manual_scan->pool)
+   {
+      /* Work items still running stop after their
+       * current entry, queued ones are dropped */
+      slock_lock(manual_scan->lock);
+      manual_scan->quit = true;
+      slock_unlock(manual_scan->lock);
+
+      tpool_destroy(manual_scan->pool);
+      manual_scan->pool        = NULL;
+      manual_scan->num_workers = 0;
+   }
+
+   if (manual_scan->lock)
+      slock_free(manual_scan->lock);
+   if (manual_scan->result_cond)
+      scond_free(manual_scan->result_cond);
+   manual_scan->lock        = NULL;
+   manual_scan->result_cond = NULL;
+#endif
+
+   if (manual_scan->results)
+   {
+      for (i = 0; i < manual_scan->list_size; i++)
+      {
+         if (manual_scan->results[i].path)
+            free(manual_scan->results[i].path);
+         if (manual_scan->results[i].label)
+            free(manual_scan->results[i].label);
+      }
+      free(manual_scan->results);
+      manual_scan->results = NULL;
+   }
+}
+
+/* Gets the playlist entry of content file at 'pos'
+ * > Result strings are owned by the caller
+ * Returns false if it is not available yet */
+static bool manual_scan_result_get(manual_scan_handle_t *manual_scan,
+      size_t pos, manual_scan_result_t *result)
+{
+   bool ready = false;
+
+   /* No threads, resolve entry now */
+   if (manual_scan->num_workers == 0)
+   {
+      manual_scan_resolve(manual_scan, pos, result);
+      return true;
+   }
+
+#ifdef HAVE_THREADS
+   slock_lock(manual_scan->lock);
+
+   /* Wait a little, but return to the task queue
+    * regularly so that the task can be cancelled */
+   if (!manual_scan->results[pos].ready)
+      scond_wait_timeout(manual_scan->result_cond,
+            manual_scan->lock, 10000);
+
+   if ((ready = manual_scan->results[pos].ready))
+   {
+      *result                          = manual_scan->results[pos];
+      manual_scan->results[pos].path   = NULL;
+      manual_scan->results[pos].label  = NULL;
+   }
+
+   slock_unlock(manual_scan->lock);
+#endif
+
+   return ready;
+}
+
+static void manual_scan_pending_free(manual_scan_handle_t *manual_scan)
+{
+   size_t i;
+
+   for (i = 0; i < RBUF_LEN(manual_scan->pending); i++)
+   {
+      free(manual_scan->pending[i].path);
+      free(manual_scan->pending[i].label);
+   }
+   RBUF_CLEAR(manual_scan->pending);
+}
+
+/* Adds all pending entries to the playlist */
+static void manual_scan_pending_flush(manual_scan_handle_t *manual_scan)
+{
+   if (RBUF_LEN(manual_scan->pending) > 0)
+      playlist_push_batch(manual_scan->playlist, manual_scan->pending,
+            RBUF_LEN(manual_scan->pending));
+
+   manual_scan_pending_free(manual_scan);
+}
+
 /* Frees task handle + all constituent objects */
 static void free_manual_content_scan_handle(manual_scan_handle_t *manual_scan)
 {
    if (!manual_scan)
       return;
 
+   /* Workers must be stopped before anything
+    * they read is freed */
+   manual_scan_workers_deinit(manual_scan);
+
+   manual_scan_pending_free(manual_scan);
+   RBUF_FREE(manual_scan->pending);
+
    if (manual_scan->task_config)
    {
       free(manual_scan->task_config);
@@ -230,6 +478,10 @@ static void task_manual_content_scan_handler(retro_task_t *task)
                }
             }
 
+            /* Resolve playlist entries in the background */
+            if (!manual_scan_workers_init(manual_scan))
+               goto task_finished;
+
             /* Open playlist */
             manual_scan->playlist = playlist_init(&manual_scan->playlist_config);
 
@@ -255,10 +507,14 @@ static void task_manual_content_scan_handler(retro_task_t *task)
          break;
       case MANUAL_SCAN_ITERATE_CONTENT:
          {
+            manual_scan_result_t result;
             const char *content_path =
                   manual_scan->content_list->elems[manual_scan->list_index].data;
-            int content_type         =
-                  manual_scan->content_list->elems[manual_scan->list_index].attr.i;
+
+            /* Not resolved yet, try again later */
+            if (!manual_scan_result_get(
+                  manual_scan, manual_scan->list_index, &result))
+               break;
 
             if (!string_is_empty(content_path))
             {
@@ -280,10 +536,26 @@ static void task_manual_content_scan_handler(retro_task_t *task)
                task_set_title(task, strdup(task_title));
                task_set_progress(task, (manual_scan->list_index * 100) / manual_scan->list_size);
 
-               /* Add content to playlist */
-               manual_content_scan_add_content_to_playlist(
-                     manual_scan->task_config, manual_scan->playlist,
-                     content_path, content_type, manual_scan->dat_file);
+               /* Queue content for the playlist, if not
+                * already included */
+               if (     result.valid
+                     && !playlist_entry_exists(
+                        manual_scan->playlist, result.path))
+               {
+                  struct playlist_entry entry;
+
+                  manual_content_scan_init_playlist_entry(
+                        manual_scan->task_config, &entry,
+                        result.path, result.label);
+
+                  if (RBUF_TRYFIT(manual_scan->pending,
+                        RBUF_LEN(manual_scan->pending) + 1))
+                  {
+                     RBUF_PUSH(manual_scan->pending, entry);
+                     result.path  = NULL;
+                     result.label = NULL;
+                  }
+               }
 
                /* If this is an M3U file, add it to the
                 * M3U list for later processing */
@@ -299,10 +571,22 @@ static void task_manual_content_scan_handler(retro_task_t *task)
                }
             }
 
+            if (result.path)
+               free(result.path);
+            if (result.label)
+               free(result.label);
+
+            if (RBUF_LEN(manual_scan->pending) >= MANUAL_SCAN_BATCH_SIZE)
+               manual_scan_pending_flush(manual_scan);
+
             /* Increment content index */
             manual_scan->list_index++;
             if (manual_scan->list_index >= manual_scan->list_size)
             {
+               /* M3U files are checked against the
+                * whole playlist */
+               manual_scan_pending_flush(manual_scan);
+
                /* Check whether we have any M3U files
                 * to process */
                if (manual_scan->m3u_list->size > 0)
@@ -505,6 +789,7 @@ bool task_push_manual_content_scan(
 
    /* > Configure task */
    task->handler                 = task_manual_content_scan_handler;
+   task->priority                = TASK_PRIORITY_LOW;
    task->state                   = manual_scan;
    task->title                   = strdup(task_title);
    task->alternative_look        = true;
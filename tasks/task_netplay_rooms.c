@@ -0,0 +1,83 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <queues/task_queue.h>
+
+#include "tasks_internal.h"
+
+#include "../network/netplay/netplay_discovery.h"
+
+/* Parses the lobby room list off the main thread, large
+ * lists would otherwise stall the menu */
+static void task_netplay_rooms_parse_handler(retro_task_t *task)
+{
+   char *buf                         = (char*)task->state;
+   netplay_rooms_parse_data_t *data  = (netplay_rooms_parse_data_t*)
+      calloc(1, sizeof(*data));
+
+   if (data)
+   {
+      data->count = netplay_rooms_parse_array(buf, &data->rooms);
+      task_set_data(task, data);
+   }
+
+   free(buf);
+   task->state = NULL;
+
+   task_set_progress(task, 100);
+   task_set_finished(task, true);
+}
+
+static void task_netplay_rooms_parse_cleanup(retro_task_t *task)
+{
+   netplay_rooms_parse_data_t *data = (netplay_rooms_parse_data_t*)
+      task_get_data(task);
+
+   if (data)
+   {
+      if (data->rooms)
+         free(data->rooms);
+      free(data);
+   }
+
+   if (task->state)
+      free(task->state);
+}
+
+bool task_push_netplay_rooms_parse(char *buf, retro_task_callback_t cb)
+{
+   retro_task_t *task = NULL;
+
+   if (!buf)
+      return false;
+
+   if (!(task = task_init()))
+   {
+      free(buf);
+      return false;
+   }
+
+   task->state    = buf;
+   task->handler  = task_netplay_rooms_parse_handler;
+   task->callback = cb;
+   task->cleanup  = task_netplay_rooms_parse_cleanup;
+   task->mute     = true;
+
+   task_queue_push(task);
+
+   return true;
+}
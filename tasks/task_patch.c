@@ -20,13 +20,15 @@
 /* TODO/FIXME - turn this into actual task */
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <boolean.h>
+#include <retro_inline.h>
 
 #include <compat/msvc.h>
 #include <file/file_path.h>
-#include <streams/file_stream.h>
+#include <streams/interface_stream.h>
 #include <string/stdstring.h>
 
 #include <encodings/crc32.h>
@@ -36,6 +38,10 @@
 #include "../verbosity.h"
 #include "../configuration.h"
 
+/* Patch files are streamed through a buffer of
+ * this size instead of being read into memory */
+#define PATCH_STREAM_BUFFER_SIZE (64 * 1024)
+
 enum bps_mode
 {
    SOURCE_READ = 0,
@@ -60,62 +66,172 @@ enum patch_error
    PATCH_PATCH_CHECKSUM_INVALID
 };
 
-struct bps_data
+/* Sequential, buffered reader over a patch file.
+ * Reading past the end returns zeros and sets
+ * 'overrun', which invalidates the patch */
+typedef struct patch_stream
 {
-   const uint8_t *modify_data;
-   const uint8_t *source_data;
-   uint8_t *target_data;
-   size_t modify_length;
-   size_t source_length;
-   size_t target_length;
-   size_t modify_offset;
-   size_t source_offset;
-   size_t target_offset;
-   size_t source_relative_offset;
-   size_t target_relative_offset;
-   size_t output_offset;
-   uint32_t modify_checksum;
-   uint32_t source_checksum;
-   uint32_t target_checksum;
-};
+   intfstream_t *fd;
+   uint8_t *buf;
+   uint64_t size;
+   /* File offset of buf[0] */
+   uint64_t buf_offset;
+   size_t pos;
+   size_t len;
+   /* Bytes before buf[crc_pos] are included in 'crc' */
+   size_t crc_pos;
+   uint32_t crc;
+   bool overrun;
+} patch_stream_t;
+
+/* On success, '*target' is either a new buffer or
+ * 'source' itself, if the patch was applied in place */
+typedef enum patch_error (*patch_func_t)(patch_stream_t*,
+      uint8_t*, uint64_t, uint8_t**, uint64_t*);
+
+static bool patch_stream_open(patch_stream_t *patch, const char *path)
+{
+   int64_t size;
+
+   memset(patch, 0, sizeof(*patch));
+
+   if (!(patch->fd = intfstream_open_file(path,
+         RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return false;
+
+   if (   ((size = intfstream_get_size(patch->fd)) < 0)
+       || !(patch->buf = (uint8_t*)malloc(PATCH_STREAM_BUFFER_SIZE)))
+   {
+      intfstream_close(patch->fd);
+      free(patch->fd);
+      return false;
+   }
+
+   patch->size = (uint64_t)size;
+   return true;
+}
 
-struct ups_data
+static void patch_stream_close(patch_stream_t *patch)
 {
-   const uint8_t *patch_data;
-   const uint8_t *source_data;
-   uint8_t *target_data;
-   unsigned patch_length;
-   unsigned source_length;
-   unsigned target_length;
-   unsigned patch_offset;
-   unsigned source_offset;
-   unsigned target_offset;
-   unsigned patch_checksum;
-   unsigned source_checksum;
-   unsigned target_checksum;
-};
+   intfstream_close(patch->fd);
+   free(patch->fd);
+   free(patch->buf);
+}
 
-typedef enum patch_error (*patch_func_t)(const uint8_t*, uint64_t,
-      const uint8_t*, uint64_t, uint8_t**, uint64_t*);
+static void patch_stream_update_crc(patch_stream_t *patch)
+{
+   patch->crc     = encoding_crc32(patch->crc,
+         patch->buf + patch->crc_pos, patch->pos - patch->crc_pos);
+   patch->crc_pos = patch->pos;
+}
 
-static uint8_t bps_read(struct bps_data *bps)
+static bool patch_stream_fill(patch_stream_t *patch)
 {
-   uint8_t data         = bps->modify_data[bps->modify_offset++];
-   bps->modify_checksum = ~(encoding_crc32(
-         ~bps->modify_checksum, &data, 1));
+   int64_t len;
+
+   patch_stream_update_crc(patch);
+
+   patch->buf_offset += patch->len;
+   patch->pos         = 0;
+   patch->crc_pos     = 0;
+   patch->len         = 0;
+
+   if ((len = intfstream_read(patch->fd, patch->buf,
+         PATCH_STREAM_BUFFER_SIZE)) <= 0)
+   {
+      patch->overrun = true;
+      return false;
+   }
+
+   patch->len = (size_t)len;
+   return true;
+}
+
+static INLINE uint8_t patch_stream_getc(patch_stream_t *patch)
+{
+   if (patch->pos == patch->len && !patch_stream_fill(patch))
+      return 0;
+   return patch->buf[patch->pos++];
+}
+
+/* Reads 'len' bytes into 's', or skips them if 's' is NULL */
+static bool patch_stream_read(patch_stream_t *patch,
+      uint8_t *s, uint64_t len)
+{
+   while (len)
+   {
+      size_t chunk;
+
+      if (patch->pos == patch->len && !patch_stream_fill(patch))
+         return false;
+
+      chunk = patch->len - patch->pos;
+      if (chunk > len)
+         chunk = (size_t)len;
+
+      if (s)
+      {
+         memcpy(s, patch->buf + patch->pos, chunk);
+         s += chunk;
+      }
+
+      patch->pos += chunk;
+      len        -= chunk;
+   }
+
+   return true;
+}
+
+static uint32_t patch_stream_read_le32(patch_stream_t *patch)
+{
+   uint32_t data = patch_stream_getc(patch);
+   data         |= (uint32_t)patch_stream_getc(patch) << 8;
+   data         |= (uint32_t)patch_stream_getc(patch) << 16;
+   data         |= (uint32_t)patch_stream_getc(patch) << 24;
    return data;
 }
 
-static uint64_t bps_decode(struct bps_data *bps)
+static INLINE uint64_t patch_stream_tell(const patch_stream_t *patch)
+{
+   return patch->buf_offset + patch->pos;
+}
+
+/* Returns the checksum of all bytes read so far */
+static uint32_t patch_stream_get_crc(patch_stream_t *patch)
+{
+   patch_stream_update_crc(patch);
+   return patch->crc;
+}
+
+static bool patch_stream_rewind(patch_stream_t *patch)
+{
+   patch->buf_offset = 0;
+   patch->pos        = 0;
+   patch->len        = 0;
+   patch->crc_pos    = 0;
+   patch->crc        = 0;
+   patch->overrun    = false;
+
+   return intfstream_seek(patch->fd, 0, SEEK_SET) == 0;
+}
+
+/* Variable-length integer shared by BPS and UPS */
+static uint64_t patch_stream_decode(patch_stream_t *patch)
 {
    uint64_t data = 0, shift = 1;
 
    for (;;)
    {
-      uint8_t x  = bps_read(bps);
+      uint8_t x  = patch_stream_getc(patch);
       data      += (x & 0x7f) * shift;
       if (x & 0x80)
          break;
+      /* Malformed - stop before the shift overflows */
+      if (patch->overrun || shift > ((uint64_t)1 << 56))
+      {
+         patch->overrun = true;
+         break;
+      }
       shift    <<= 7;
       data      += shift;
    }
@@ -123,498 +239,495 @@ static uint64_t bps_decode(struct bps_data *bps)
    return data;
 }
 
-static void bps_write(struct bps_data *bps, uint8_t data)
+static bool patch_stream_check_magic(patch_stream_t *patch,
+      const char *magic)
 {
-   bps->target_data[bps->output_offset++] = data;
-   bps->target_checksum = ~(encoding_crc32(~bps->target_checksum, &data, 1));
+   while (*magic)
+      if (patch_stream_getc(patch) != (uint8_t)*magic++)
+         return false;
+   return true;
 }
 
 static enum patch_error bps_apply_patch(
-      const uint8_t *modify_data, uint64_t modify_length,
-      const uint8_t *source_data, uint64_t source_length,
+      patch_stream_t *patch,
+      uint8_t *source_data, uint64_t source_length,
       uint8_t **target_data, uint64_t *target_length)
 {
-   size_t i;
-   struct bps_data bps;
+   uint8_t *target                 = NULL;
+   enum patch_error err            = PATCH_PATCH_INVALID;
+   uint64_t modify_end             = 0;
+   uint64_t modify_source_size     = 0;
+   uint64_t modify_target_size     = 0;
+   uint64_t modify_markup_size     = 0;
+   uint64_t output_offset          = 0;
+   uint64_t source_offset          = 0;
+   uint64_t target_offset          = 0;
    uint32_t checksum               = 0;
-   size_t modify_source_size       = 0;
-   size_t modify_target_size       = 0;
-   size_t modify_markup_size       = 0;
    uint32_t modify_source_checksum = 0;
    uint32_t modify_target_checksum = 0;
    uint32_t modify_modify_checksum = 0;
 
-   if (modify_length < 19)
+   if (patch->size < 19)
       return PATCH_PATCH_TOO_SMALL;
 
-   bps.modify_data            = modify_data;
-   bps.source_data            = source_data;
-   bps.target_data            = *target_data;
-   bps.modify_length          = modify_length;
-   bps.source_length          = source_length;
-   bps.target_length          = *target_length;
-   bps.modify_offset          = 0;
-   bps.source_offset          = 0;
-   bps.target_offset          = 0;
-   bps.modify_checksum        = ~0;
-   bps.source_checksum        = 0;
-   bps.target_checksum        = ~0;
-   bps.source_relative_offset = 0;
-   bps.target_relative_offset = 0;
-   bps.output_offset          = 0;
-
-   if (  (bps_read(&bps) != 'B') ||
-         (bps_read(&bps) != 'P') ||
-         (bps_read(&bps) != 'S') ||
-         (bps_read(&bps) != '1'))
+   if (!patch_stream_check_magic(patch, "BPS1"))
       return PATCH_PATCH_INVALID_HEADER;
 
-   modify_source_size  = bps_decode(&bps);
-   modify_target_size  = bps_decode(&bps);
-   modify_markup_size  = bps_decode(&bps);
+   modify_source_size  = patch_stream_decode(patch);
+   modify_target_size  = patch_stream_decode(patch);
+   modify_markup_size  = patch_stream_decode(patch);
 
-   for (i = 0; i < modify_markup_size; i++)
-      bps_read(&bps);
+   if (!patch_stream_read(patch, NULL, modify_markup_size))
+      return PATCH_PATCH_INVALID;
 
-   if (modify_source_size > bps.source_length)
+   if (modify_source_size > source_length)
       return PATCH_SOURCE_TOO_SMALL;
 
-   if (modify_target_size > bps.target_length)
-   {
-      uint8_t *prov=(uint8_t*)malloc((size_t)modify_target_size);
-
-      if (!prov)
-         return PATCH_TARGET_ALLOC_FAILED;
+   if (   (modify_target_size > (size_t)-1)
+       || !(target = (uint8_t*)malloc(modify_target_size
+            ? (size_t)modify_target_size : 1)))
+      return PATCH_TARGET_ALLOC_FAILED;
 
-      free(*target_data);
-      bps.target_data   = prov;
-      *target_data      = prov;
-      bps.target_length = modify_target_size;
-   }
+   /* Each action copies a whole run at once; offsets
+    * are validated up front, as the patch is untrusted */
+   modify_end = patch->size - 12;
 
-   while (bps.modify_offset < bps.modify_length - 12)
+   while (patch_stream_tell(patch) < modify_end)
    {
-      size_t length = bps_decode(&bps);
-      unsigned mode = length & 3;
+      uint64_t length = patch_stream_decode(patch);
+      unsigned mode   = length & 3;
 
       length = (length >> 2) + 1;
 
+      if (   patch->overrun
+          || (length > modify_target_size - output_offset))
+         goto error;
+
       switch (mode)
       {
          case SOURCE_READ:
-            while (length--)
-               bps_write(&bps, bps.source_data[bps.output_offset]);
+            if (output_offset + length > source_length)
+               goto error;
+            memcpy(target + output_offset,
+                  source_data + output_offset, (size_t)length);
             break;
 
          case TARGET_READ:
-            while (length--)
-               bps_write(&bps, bps_read(&bps));
+            if (!patch_stream_read(patch,
+                  target + output_offset, length))
+               goto error;
             break;
 
          case SOURCE_COPY:
          case TARGET_COPY:
          {
-            int    offset = (int)bps_decode(&bps);
-            bool negative = offset & 1;
-
-            offset >>= 1;
-
-            if (negative)
-               offset = -offset;
+            uint64_t data   = patch_stream_decode(patch);
+            uint64_t offset = data >> 1;
 
             if (mode == SOURCE_COPY)
             {
-               bps.source_offset += offset;
-               while (length--)
-                  bps_write(&bps, bps.source_data[bps.source_offset++]);
+               if (data & 1)
+               {
+                  if (offset > source_offset)
+                     goto error;
+                  source_offset -= offset;
+               }
+               else
+                  source_offset += offset;
+
+               if (   (source_offset > source_length)
+                   || (length > source_length - source_offset))
+                  goto error;
+
+               memcpy(target + output_offset,
+                     source_data + source_offset, (size_t)length);
+               source_offset += length;
             }
             else
             {
-               bps.target_offset += offset;
-               while (length--)
-                  bps_write(&bps, bps.target_data[bps.target_offset++]);
-               break;
+               size_t i;
+               uint8_t *dst       = target + output_offset;
+               const uint8_t *src = NULL;
+
+               if (data & 1)
+               {
+                  if (offset > target_offset)
+                     goto error;
+                  target_offset -= offset;
+               }
+               else
+                  target_offset += offset;
+
+               /* Only bytes already written may be read; runs
+                * may overlap their own output (RLE), so this
+                * copy has to go forwards a byte at a time */
+               if (target_offset >= output_offset)
+                  goto error;
+
+               src = target + target_offset;
+               for (i = 0; i < (size_t)length; i++)
+                  dst[i] = src[i];
+               target_offset += length;
             }
             break;
          }
       }
+
+      output_offset += length;
    }
 
-   for (i = 0; i < 32; i += 8)
-      modify_source_checksum |= bps_read(&bps) << i;
-   for (i = 0; i < 32; i += 8)
-      modify_target_checksum |= bps_read(&bps) << i;
+   if (output_offset != modify_target_size)
+   {
+      err = PATCH_TARGET_INVALID;
+      goto error;
+   }
 
-   checksum = ~bps.modify_checksum;
-   for (i = 0; i < 32; i += 8)
-      modify_modify_checksum |= bps_read(&bps) << i;
+   modify_source_checksum = patch_stream_read_le32(patch);
+   modify_target_checksum = patch_stream_read_le32(patch);
+   checksum               = patch_stream_get_crc(patch);
+   modify_modify_checksum = patch_stream_read_le32(patch);
 
-   bps.source_checksum = encoding_crc32(0,
-         bps.source_data, bps.source_length);
-   bps.target_checksum = ~bps.target_checksum;
+   if (patch->overrun)
+      goto error;
 
-   if (bps.source_checksum != modify_source_checksum)
-      return PATCH_SOURCE_CHECKSUM_INVALID;
+   if (encoding_crc32(0, source_data, (size_t)source_length)
+         != modify_source_checksum)
+   {
+      err = PATCH_SOURCE_CHECKSUM_INVALID;
+      goto error;
+   }
 
-   if (bps.target_checksum != modify_target_checksum)
-      return PATCH_TARGET_CHECKSUM_INVALID;
+   if (encoding_crc32(0, target, (size_t)modify_target_size)
+         != modify_target_checksum)
+   {
+      err = PATCH_TARGET_CHECKSUM_INVALID;
+      goto error;
+   }
 
    if (checksum != modify_modify_checksum)
-      return PATCH_PATCH_CHECKSUM_INVALID;
+   {
+      err = PATCH_PATCH_CHECKSUM_INVALID;
+      goto error;
+   }
 
+   *target_data   = target;
    *target_length = modify_target_size;
 
    return PATCH_SUCCESS;
-}
 
-static uint8_t ups_patch_read(struct ups_data *data)
-{
-   if (data && data->patch_offset < data->patch_length)
-   {
-      uint8_t n = data->patch_data[data->patch_offset++];
-      data->patch_checksum =
-         ~(encoding_crc32(~data->patch_checksum, &n, 1));
-      return n;
-   }
-   return 0x00;
+error:
+   free(target);
+   return err;
 }
 
-static uint8_t ups_source_read(struct ups_data *data)
+/* Writes source bytes [offset, offset + length) to the
+ * target, clipped to its size; UPS treats the source as
+ * zero-padded to the larger of the two lengths */
+static void ups_copy_source(uint8_t *target, uint64_t target_length,
+      const uint8_t *source, uint64_t source_length,
+      uint64_t offset, uint64_t length)
 {
-   if (data && data->source_offset < data->source_length)
-   {
-      uint8_t n = data->source_data[data->source_offset++];
-      data->source_checksum =
-         ~(encoding_crc32(~data->source_checksum, &n, 1));
-      return n;
-   }
-   return 0x00;
-}
+   uint64_t end = offset + length;
 
-static void ups_target_write(struct ups_data *data, uint8_t n)
-{
+   if (end > target_length)
+      end = target_length;
 
-   if (data && data->target_offset < data->target_length)
+   if (offset < source_length && offset < end)
    {
-      data->target_data[data->target_offset] = n;
-      data->target_checksum =
-         ~(encoding_crc32(~data->target_checksum, &n, 1));
+      uint64_t copy_end = (end < source_length) ? end : source_length;
+      memcpy(target + offset, source + offset, (size_t)(copy_end - offset));
+      offset = copy_end;
    }
 
-   if (data)
-      data->target_offset++;
-}
-
-static uint64_t ups_decode(struct ups_data *data)
-{
-   uint64_t offset = 0, shift = 1;
-
-   for (;;)
-   {
-      uint8_t x = ups_patch_read(data);
-      offset   += (x & 0x7f) * shift;
-
-      if (x & 0x80)
-         break;
-      shift <<= 7;
-      offset += shift;
-   }
-   return offset;
+   if (offset < end)
+      memset(target + offset, 0, (size_t)(end - offset));
 }
 
 static enum patch_error ups_apply_patch(
-      const uint8_t *patchdata, uint64_t patchlength,
-      const uint8_t *sourcedata, uint64_t sourcelength,
-      uint8_t **targetdata, uint64_t *targetlength)
+      patch_stream_t *patch,
+      uint8_t *source_data, uint64_t source_length,
+      uint8_t **target_data, uint64_t *target_length)
 {
-   size_t i;
-   struct ups_data data;
-   unsigned source_read_length;
-   unsigned target_read_length;
+   uint8_t *target                = NULL;
+   enum patch_error err           = PATCH_PATCH_INVALID;
+   uint64_t source_read_length    = 0;
+   uint64_t target_read_length    = 0;
+   uint64_t target_size           = 0;
+   uint64_t max_length            = 0;
+   uint64_t offset                = 0;
+   uint64_t patch_end             = 0;
    uint32_t patch_result_checksum = 0;
    uint32_t patch_read_checksum   = 0;
    uint32_t source_read_checksum  = 0;
    uint32_t target_read_checksum  = 0;
+   uint32_t source_checksum       = 0;
+   uint32_t target_checksum       = 0;
 
-   data.patch_data      = patchdata;
-   data.source_data     = sourcedata;
-   data.target_data     = *targetdata;
-   data.patch_length    = (unsigned)patchlength;
-   data.source_length   = (unsigned)sourcelength;
-   data.target_length   = (unsigned)*targetlength;
-   data.patch_offset    = 0;
-   data.source_offset   = 0;
-   data.target_offset   = 0;
-   data.patch_checksum  = ~0;
-   data.source_checksum = ~0;
-   data.target_checksum = ~0;
-
-   if (data.patch_length < 18)
+   if (patch->size < 18)
       return PATCH_PATCH_INVALID;
 
-   if (
-         (ups_patch_read(&data) != 'U') ||
-         (ups_patch_read(&data) != 'P') ||
-         (ups_patch_read(&data) != 'S') ||
-         (ups_patch_read(&data) != '1')
-      )
+   if (!patch_stream_check_magic(patch, "UPS1"))
       return PATCH_PATCH_INVALID;
 
-   source_read_length = (unsigned)ups_decode(&data);
-   target_read_length = (unsigned)ups_decode(&data);
+   source_read_length = patch_stream_decode(patch);
+   target_read_length = patch_stream_decode(patch);
 
-   if (     (data.source_length != source_read_length)
-         && (data.source_length != target_read_length))
+   if (     (source_length != source_read_length)
+         && (source_length != target_read_length))
       return PATCH_SOURCE_INVALID;
 
-   *targetlength = (data.source_length == source_read_length ?
+   target_size = (source_length == source_read_length ?
          target_read_length : source_read_length);
+   max_length  = (source_length > target_size) ?
+         source_length : target_size;
 
-   if (data.target_length < *targetlength)
-   {
-      uint8_t *prov=(uint8_t*)malloc((size_t)*targetlength);
-      if (!prov)
-         return PATCH_TARGET_ALLOC_FAILED;
-      free(*targetdata);
-      *targetdata      = prov;
-      data.target_data = prov;
-   }
+   if (   (target_size > (size_t)-1)
+       || !(target = (uint8_t*)malloc(target_size
+            ? (size_t)target_size : 1)))
+      return PATCH_TARGET_ALLOC_FAILED;
+
+   patch_end = patch->size - 12;
 
-   data.target_length = (unsigned)*targetlength;
-   
-   while (data.patch_offset < data.patch_length - 12)
+   /* Source and target advance together: each record
+    * copies a run of source bytes, then XORs bytes
+    * up to and including a zero from the patch */
+   while (patch_stream_tell(patch) < patch_end)
    {
-      unsigned length = (unsigned)ups_decode(&data);
-      while (length--)
-         ups_target_write(&data, ups_source_read(&data));
+      uint64_t length = patch_stream_decode(patch);
+
+      if (   patch->overrun
+          || (offset > max_length)
+          || (length > max_length - offset))
+         goto error;
+
+      ups_copy_source(target, target_size, source_data, source_length,
+            offset, length);
+      offset += length;
 
       for (;;)
       {
-         uint8_t patch_xor = ups_patch_read(&data);
-         ups_target_write(&data, patch_xor ^ ups_source_read(&data));
+         uint8_t patch_xor = patch_stream_getc(patch);
+
+         /* The terminator of a run ending on the last
+          * byte lies one past the end */
+         if (patch->overrun || (offset > max_length))
+            goto error;
+
+         if (offset < target_size)
+            target[offset] = patch_xor ^
+                  ((offset < source_length) ? source_data[offset] : 0);
+         offset++;
+
          if (patch_xor == 0)
             break;
       }
    }
 
-   while (data.source_offset < data.source_length)
-      ups_target_write(&data, ups_source_read(&data));
-   while (data.target_offset < data.target_length)
-      ups_target_write(&data, ups_source_read(&data));
-
-   for (i = 0; i < 4; i++)
-      source_read_checksum |= ups_patch_read(&data) << (i * 8);
-   for (i = 0; i < 4; i++)
-      target_read_checksum |= ups_patch_read(&data) << (i * 8);
+   if (offset < max_length)
+      ups_copy_source(target, target_size, source_data, source_length,
+            offset, max_length - offset);
 
-   patch_result_checksum = ~data.patch_checksum;
-   data.source_checksum  = ~data.source_checksum;
-   data.target_checksum  = ~data.target_checksum;
+   source_read_checksum  = patch_stream_read_le32(patch);
+   target_read_checksum  = patch_stream_read_le32(patch);
+   patch_result_checksum = patch_stream_get_crc(patch);
+   patch_read_checksum   = patch_stream_read_le32(patch);
 
-   for (i = 0; i < 4; i++)
-      patch_read_checksum |= ups_patch_read(&data) << (i * 8);
+   if (patch->overrun || (patch_result_checksum != patch_read_checksum))
+      goto error;
 
-   if (patch_result_checksum != patch_read_checksum)
-      return PATCH_PATCH_INVALID;
+   source_checksum = encoding_crc32(0, source_data, (size_t)source_length);
+   target_checksum = encoding_crc32(0, target, (size_t)target_size);
 
-   if (     data.source_checksum == source_read_checksum
-         && data.source_length   == source_read_length)
+   if (     source_checksum == source_read_checksum
+         && source_length   == source_read_length)
    {
-      if (     data.target_checksum == target_read_checksum
-            && data.target_length   == target_read_length)
-         return PATCH_SUCCESS;
-      return PATCH_TARGET_INVALID;
+      if (     target_checksum == target_read_checksum
+            && target_size     == target_read_length)
+         goto success;
+      err = PATCH_TARGET_INVALID;
    }
-   else if (data.source_checksum == target_read_checksum
-         && data.source_length   == target_read_length)
+   else if (source_checksum == target_read_checksum
+         && source_length   == target_read_length)
    {
-      if (     data.target_checksum == source_read_checksum
-            && data.target_length   == source_read_length)
-         return PATCH_SUCCESS;
-      return PATCH_TARGET_INVALID;
+      if (     target_checksum == source_read_checksum
+            && target_size     == source_read_length)
+         goto success;
+      err = PATCH_TARGET_INVALID;
    }
+   else
+      err = PATCH_SOURCE_INVALID;
+
+error:
+   free(target);
+   return err;
 
-   return PATCH_SOURCE_INVALID;
+success:
+   *target_data   = target;
+   *target_length = target_size;
+   return PATCH_SUCCESS;
 }
 
-static enum patch_error ips_alloc_targetdata(
-      const uint8_t *patchdata, uint64_t patchlen,
-      uint64_t sourcelength,
-      uint8_t **targetdata, uint64_t *targetlength)
+static uint32_t ips_read24(patch_stream_t *patch)
 {
-   uint8_t *prov_alloc;
-   uint32_t offset = 5;
-   *targetlength   = sourcelength;
+   uint32_t data = (uint32_t)patch_stream_getc(patch) << 16;
+   data         |= (uint32_t)patch_stream_getc(patch) << 8;
+   data         |= (uint32_t)patch_stream_getc(patch);
+   return data;
+}
+
+static uint32_t ips_read16(patch_stream_t *patch)
+{
+   uint32_t data = (uint32_t)patch_stream_getc(patch) << 8;
+   data         |= (uint32_t)patch_stream_getc(patch);
+   return data;
+}
+
+/* Walks the records of an IPS patch. With 'target'
+ * NULL, only validates them and reports the size the
+ * records extend to in 'min_length', and the size
+ * requested by a truncation record in 'length'.
+ * Otherwise, writes them to 'target' */
+static enum patch_error ips_walk_records(patch_stream_t *patch,
+      uint8_t *target, uint64_t *min_length, uint64_t *length)
+{
+   uint64_t patch_size = patch->size;
+
+   if (!patch_stream_check_magic(patch, "PATCH"))
+      return PATCH_PATCH_INVALID;
 
    for (;;)
    {
       uint32_t address;
-      unsigned length;
+      uint32_t record_length;
+      uint64_t offset = patch_stream_tell(patch);
 
-      if (offset > patchlen - 3)
+      if (offset > patch_size - 3)
          break;
 
-      address  = patchdata[offset++] << 16;
-      address |= patchdata[offset++] << 8;
-      address |= patchdata[offset++] << 0;
+      address = ips_read24(patch);
+      offset += 3;
 
       if (address == 0x454f46) /* EOF */
       {
-         if (offset == patchlen)
-         {
-            prov_alloc     = (uint8_t*)malloc((size_t)*targetlength);
-            if (!prov_alloc)
-               return PATCH_TARGET_ALLOC_FAILED;
-            free(*targetdata);
-            *targetdata    = prov_alloc;
+         if (offset == patch_size)
             return PATCH_SUCCESS;
-         }
-         else if (offset == patchlen - 3)
+
+         if (offset == patch_size - 3)
          {
-            uint32_t size  = patchdata[offset++] << 16;
-            size          |= patchdata[offset++] << 8;
-            size          |= patchdata[offset++] << 0;
-            *targetlength  = size;
-            prov_alloc     = (uint8_t*)malloc((size_t)*targetlength);
-
-            if (!prov_alloc)
-               return PATCH_TARGET_ALLOC_FAILED;
-            free(*targetdata);
-            *targetdata    = prov_alloc;
+            uint32_t size = ips_read24(patch);
+            if (!target)
+               *length = size;
             return PATCH_SUCCESS;
          }
       }
 
-      if (offset > patchlen - 2)
+      if (offset > patch_size - 2)
          break;
 
-      length  = patchdata[offset++] << 8;
-      length |= patchdata[offset++] << 0;
+      record_length = ips_read16(patch);
+      offset       += 2;
 
-      if (length) /* Copy */
+      if (record_length) /* Copy */
       {
-         if (offset > patchlen - length)
+         if (offset > patch_size - record_length)
             break;
 
-         while (length--)
-         {
-            address++;
-            offset++;
-         }
+         if (!patch_stream_read(patch,
+               target ? target + address : NULL, record_length))
+            break;
       }
       else /* RLE */
       {
-         if (offset > patchlen - 3)
+         uint8_t value;
+
+         if (offset > patch_size - 3)
             break;
 
-         length  = patchdata[offset++] << 8;
-         length |= patchdata[offset++] << 0;
+         record_length = ips_read16(patch);
+         value         = patch_stream_getc(patch);
 
-         if (length == 0) /* Illegal */
+         if (record_length == 0) /* Illegal */
             break;
 
-         while (length--)
-            address++;
-
-         offset++;
+         if (target)
+            memset(target + address, value, record_length);
       }
 
-      if (address > *targetlength)
-         *targetlength = address;
+      if (patch->overrun)
+         break;
+
+      if (!target && ((uint64_t)address + record_length > *min_length))
+         *min_length = (uint64_t)address + record_length;
    }
 
    return PATCH_PATCH_INVALID;
 }
 
 static enum patch_error ips_apply_patch(
-      const uint8_t *patchdata, uint64_t patchlen,
-      const uint8_t *sourcedata, uint64_t sourcelength,
-      uint8_t **targetdata, uint64_t *targetlength)
+      patch_stream_t *patch,
+      uint8_t *source_data, uint64_t source_length,
+      uint8_t **target_data, uint64_t *target_length)
 {
-   uint32_t offset = 5;
-   enum patch_error error_patch = PATCH_UNKNOWN;
-   if (  patchlen      < 8   ||
-         patchdata[0] != 'P' ||
-         patchdata[1] != 'A' ||
-         patchdata[2] != 'T' ||
-         patchdata[3] != 'C' ||
-         patchdata[4] != 'H')
-      return PATCH_PATCH_INVALID;
-   
-   if ((error_patch = ips_alloc_targetdata(
-               patchdata, patchlen, sourcelength,
-               targetdata, targetlength)) != PATCH_SUCCESS)
-      return error_patch;
-
-   memcpy(*targetdata, sourcedata, (size_t)sourcelength);
+   enum patch_error err  = PATCH_UNKNOWN;
+   uint64_t min_length   = source_length;
+   uint64_t length       = (uint64_t)-1;
+   uint64_t alloc_length = 0;
+   uint8_t *target       = NULL;
 
-   for (;;)
-   {
-      uint32_t address;
-      unsigned length;
-
-      if (offset > patchlen - 3)
-         break;
-
-      address  = patchdata[offset++] << 16;
-      address |= patchdata[offset++] << 8;
-      address |= patchdata[offset++] << 0;
-
-      if (address == 0x454f46) /* EOF */
-      {
-         if (offset == patchlen)
-            return PATCH_SUCCESS;
-
-         if (offset == patchlen - 3)
-         {
-#if 0
-            uint32_t size  = patchdata[offset++] << 16;
-            size          |= patchdata[offset++] << 8;
-            size          |= patchdata[offset++] << 0;
-#endif
-            return PATCH_SUCCESS;
-         }
-      }
-
-      if (offset > patchlen - 2)
-         break;
+   if (patch->size < 8)
+      return PATCH_PATCH_INVALID;
 
-      length  = patchdata[offset++] << 8;
-      length |= patchdata[offset++] << 0;
+   /* Validate the whole patch before writing
+    * anything, so that it can be applied in place */
+   if ((err = ips_walk_records(patch, NULL,
+         &min_length, &length)) != PATCH_SUCCESS)
+      return err;
 
-      if (length) /* Copy */
-      {
-         if (offset > patchlen - length)
-            break;
+   if (length == (uint64_t)-1)
+      length = min_length;
 
-         while (length--)
-            (*targetdata)[address++] = patchdata[offset++];
-      }
-      else /* RLE */
-      {
-         if (offset > patchlen - 3)
-            break;
+   if (!patch_stream_rewind(patch))
+      return PATCH_PATCH_INVALID;
 
-         length  = patchdata[offset++] << 8;
-         length |= patchdata[offset++] << 0;
+   /* Patches that keep the size of the content
+    * only touch the bytes they modify */
+   if (min_length == source_length && length == source_length)
+      target = source_data;
+   else
+   {
+      alloc_length = (length > min_length) ? length : min_length;
 
-         if (length == 0) /* Illegal */
-            break;
+      if (   (alloc_length > (size_t)-1)
+          || !(target = (uint8_t*)malloc(alloc_length
+               ? (size_t)alloc_length : 1)))
+         return PATCH_TARGET_ALLOC_FAILED;
 
-         while (length--)
-            (*targetdata)[address++] = patchdata[offset];
+      memcpy(target, source_data, (size_t)source_length);
+      if (alloc_length > source_length)
+         memset(target + source_length, 0,
+               (size_t)(alloc_length - source_length));
+   }
 
-         offset++;
-      }
+   if ((err = ips_walk_records(patch, target,
+         &min_length, &length)) != PATCH_SUCCESS)
+   {
+      if (target != source_data)
+         free(target);
+      return err;
    }
 
-   return PATCH_PATCH_INVALID;
+   *target_data   = target;
+   *target_length = length;
+
+   return PATCH_SUCCESS;
 }
 
 static bool apply_patch_content(uint8_t **buf,
-      ssize_t *size, const char *patch_desc, const char *patch_path,
-      patch_func_t func, void *patch_data, int64_t patch_size)
+      ssize_t *size, bool *buf_mapped,
+      const char *patch_desc, const char *patch_path,
+      patch_func_t func)
 {
+   patch_stream_t patch;
    settings_t *settings     = config_get_ptr();
    bool show_notification   = settings ?
          settings->bools.notification_show_patch_applied : false;
@@ -624,13 +737,25 @@ static bool apply_patch_content(uint8_t **buf,
    uint64_t target_size     = 0;
    uint8_t *patched_content = NULL;
 
+   if (!patch_stream_open(&patch, patch_path))
+      return false;
+
    RARCH_LOG("Found %s file in \"%s\", attempting to patch ...\n",
          patch_desc, patch_path);
 
-   if ((err = func((const uint8_t*)patch_data, patch_size, ret_buf,
-         ret_size, &patched_content, &target_size)) == PATCH_SUCCESS)
+   err = func(&patch, ret_buf, ret_size, &patched_content, &target_size);
+   patch_stream_close(&patch);
+
+   if (err == PATCH_SUCCESS)
    {
-      free(ret_buf);
+      /* A mapped source buffer is released by the caller */
+      if (patched_content != ret_buf)
+      {
+         if (*buf_mapped)
+            *buf_mapped = false;
+         else
+            free(ret_buf);
+      }
       *buf  = patched_content;
       *size = target_size;
 
@@ -660,81 +785,36 @@ static bool apply_patch_content(uint8_t **buf,
 }
 
 static bool try_bps_patch(bool allow_bps, const char *name_bps,
-      uint8_t **buf, ssize_t *size)
+      uint8_t **buf, ssize_t *size, bool *buf_mapped)
 {
-   if (     allow_bps 
+   if (     allow_bps
          && !string_is_empty(name_bps)
-         && path_is_valid(name_bps)
-      )
-   {
-      int64_t patch_size;
-      bool ret                 = false;
-      void *patch_data         = NULL;
-
-      if (!filestream_read_file(name_bps, &patch_data, &patch_size))
-         return false;
-
-      if (patch_size >= 0)
-         ret = apply_patch_content(buf, size, "BPS", name_bps,
-               bps_apply_patch, patch_data, patch_size);
-
-      if (patch_data)
-         free(patch_data);
-      return ret;
-   }
-
+         && path_is_valid(name_bps))
+      return apply_patch_content(buf, size, buf_mapped,
+            "BPS", name_bps, bps_apply_patch);
    return false;
 }
 
 static bool try_ups_patch(bool allow_ups, const char *name_ups,
-      uint8_t **buf, ssize_t *size)
+      uint8_t **buf, ssize_t *size, bool *buf_mapped)
 {
    if (     allow_ups
          && !string_is_empty(name_ups)
-         && path_is_valid(name_ups)
-      )
-   {
-      int64_t patch_size;
-      bool ret                 = false;
-      void *patch_data         = NULL;
-
-      if (!filestream_read_file(name_ups, &patch_data, &patch_size))
-         return false;
-
-      if (patch_size >= 0)
-         ret = apply_patch_content(buf, size, "UPS", name_ups,
-               ups_apply_patch, patch_data, patch_size);
-
-      if (patch_data)
-         free(patch_data);
-      return ret;
-   }
+         && path_is_valid(name_ups))
+      return apply_patch_content(buf, size, buf_mapped,
+            "UPS", name_ups, ups_apply_patch);
    return false;
 }
 
 static bool try_ips_patch(bool allow_ips,
-      const char *name_ips, uint8_t **buf, ssize_t *size)
+      const char *name_ips, uint8_t **buf, ssize_t *size,
+      bool *buf_mapped)
 {
-   if (     allow_ips 
+   if (     allow_ips
          && !string_is_empty(name_ips)
-         && path_is_valid(name_ips)
-      )
-   {
-      int64_t patch_size;
-      bool ret                 = false;
-      void *patch_data         = NULL;
-
-      if (!filestream_read_file(name_ips, &patch_data, &patch_size))
-         return false;
-
-      if (patch_size >= 0)
-         ret = apply_patch_content(buf, size, "IPS", name_ips,
-               ips_apply_patch, patch_data, patch_size);
-
-      if (patch_data)
-         free(patch_data);
-      return ret;
-   }
+         && path_is_valid(name_ips))
+      return apply_patch_content(buf, size, buf_mapped,
+            "IPS", name_ips, ips_apply_patch);
    return false;
 }
 
@@ -742,8 +822,14 @@ static bool try_ips_patch(bool allow_ips,
  * patch_content:
  * @buf          : buffer of the content file.
  * @size         : size   of the content file.
+ * @buf_mapped   : whether @buf is a file mapping. IPS patches
+ *                 that keep the content size are applied in
+ *                 place; any other patch writes a new buffer,
+ *                 and a mapped source is then left for the
+ *                 caller to unmap and the flag is cleared.
  *
- * Apply patch to the content file in-memory.
+ * Apply patch to the content file in-memory. Patch files
+ * are streamed, never read into memory whole.
  *
  **/
 bool patch_content(
@@ -754,7 +840,8 @@ bool patch_content(
       const char *name_bps,
       const char *name_ups,
       uint8_t **buf,
-      void *data)
+      void *data,
+      bool *buf_mapped)
 {
    ssize_t *size    = (ssize_t*)data;
    bool allow_ups   = !is_bps_pref && !is_ips_pref;
@@ -772,9 +859,9 @@ bool patch_content(
    }
 
    /* Attempt to apply first (non-indexed) patch */
-   if (     try_ips_patch(allow_ips, name_ips, buf, size)
-         || try_bps_patch(allow_bps, name_bps, buf, size)
-         || try_ups_patch(allow_ups, name_ups, buf, size))
+   if (     try_ips_patch(allow_ips, name_ips, buf, size, buf_mapped)
+         || try_bps_patch(allow_bps, name_bps, buf, size, buf_mapped)
+         || try_ups_patch(allow_ups, name_ups, buf, size, buf_mapped))
    {
       /* A patch has been found. Now attempt to apply
        * any additional 'indexed' patch files */
@@ -821,9 +908,12 @@ bool patch_content(
          name_bps_indexed[name_bps_len] = index_char;
          name_ups_indexed[name_ups_len] = index_char;
 
-         if (     !try_ips_patch(allow_ips, name_ips_indexed, buf, size)
-               && !try_bps_patch(allow_bps, name_bps_indexed, buf, size)
-               && !try_ups_patch(allow_ups, name_ups_indexed, buf, size))
+         if (     !try_ips_patch(allow_ips, name_ips_indexed, buf, size,
+                     buf_mapped)
+               && !try_bps_patch(allow_bps, name_bps_indexed, buf, size,
+                     buf_mapped)
+               && !try_ups_patch(allow_ups, name_ups_indexed, buf, size,
+                     buf_mapped))
             break;
 
          patch_index++;
@@ -23,6 +23,8 @@
 #include <string/stdstring.h>
 #include <file/file_path.h>
 #include <net/net_http.h>
+#include <retro_atomic.h>
+#include <retro_miscellaneous.h>
 #include <streams/file_stream.h>
 
 #include "tasks_internal.h"
@@ -35,7 +37,9 @@
 
 #ifdef RARCH_INTERNAL
 #include "../gfx/gfx_thumbnail_path.h"
+#include "../gfx/gfx_thumbnail_pack.h"
 #ifdef HAVE_MENU
+#include "../gfx/gfx_thumbnail.h"
 #include "../menu/menu_cbs.h"
 #include "../menu/menu_driver.h"
 #endif
@@ -46,9 +50,14 @@ enum pl_thumb_status
    PL_THUMB_BEGIN = 0,
    PL_THUMB_ITERATE_ENTRY,
    PL_THUMB_ITERATE_TYPE,
+   PL_THUMB_PACK_ENTRY,
+   PL_THUMB_PACK_END,
    PL_THUMB_END
 };
 
+/* Number of thumbnail types (boxart, title, screenshot) */
+#define PL_THUMB_NUM_TYPES 3
+
 typedef struct pl_thumb_handle
 {
    char *system;
@@ -56,20 +65,25 @@ typedef struct pl_thumb_handle
    char *dir_thumbnails;
    playlist_t *playlist;
    gfx_thumbnail_path_data_t *thumbnail_path_data;
-   retro_task_t *http_task;
+   gfx_thumbnail_pack_writer_t *pack_writers[PL_THUMB_NUM_TYPES];
 
    playlist_config_t playlist_config; /* size_t alignment */
 
    size_t list_size;
    size_t list_index;
    unsigned type_idx;
+   unsigned download_max;
+
+   /* Transfers whose callback hasn't run yet. Callbacks
+    * run on the main thread, so this is shared with it */
+   retro_atomic_int_t http_tasks_pending;
 
    enum pl_thumb_status status;
 
    bool overwrite;
+   bool pack_enable;
    bool right_thumbnail_exists;
    bool left_thumbnail_exists;
-   bool http_task_complete;
 } pl_thumb_handle_t;
 
 typedef struct pl_entry_id
@@ -83,7 +97,8 @@ typedef struct pl_entry_id
 /*********************/
 
 /* Fetches local and remote paths for current thumbnail
- * of current type */
+ * of current type
+ * > If 'url' is NULL, only the local path is fetched */
 static bool get_thumbnail_paths(
    pl_thumb_handle_t *pl_thumb,
    char *path, size_t path_size,
@@ -149,6 +164,9 @@ static bool get_thumbnail_paths(
    
    if (string_is_empty(path))
       return false;
+
+   if (!url)
+      return true;
    
    raw_url = (char*)malloc(8192 * sizeof(char));
    
@@ -199,7 +217,7 @@ void cb_http_task_download_pl_thumbnail(
    if (!pl_thumb)
       goto finish;
 
-   pl_thumb->http_task_complete = true;
+   retro_atomic_fetch_add(&pl_thumb->http_tasks_pending, -1);
 
    /* Remaining sanity checks... */
    if (!data)
@@ -262,8 +280,9 @@ static void download_pl_thumbnail(pl_thumb_handle_t *pl_thumb)
          if (!transf)
             return; /* If this happens then everything is broken anyway... */
 
-         /* Initialise http task status */
-         pl_thumb->http_task_complete = false;
+         /* Counted before the push, since the callback
+          * may run before the push returns */
+         retro_atomic_fetch_add(&pl_thumb->http_tasks_pending, 1);
 
          transf->enum_idx             = MSG_UNKNOWN;
          transf->path[0]              = '\0';
@@ -274,19 +293,70 @@ static void download_pl_thumbnail(pl_thumb_handle_t *pl_thumb)
          /* Note: We don't actually care if this fails since that
           * just means the file is missing from the server, so it's
           * not something we can handle here... */
-         pl_thumb->http_task = (retro_task_t*)task_push_http_transfer_file(
-               url, true, NULL, cb_http_task_download_pl_thumbnail, transf);
-
-         /* ...if it does fail, however, we can immediately
-          * signal that the task is 'complete' */
-         if (!pl_thumb->http_task)
-            pl_thumb->http_task_complete = true;
+         /* ...if it does fail, however, the callback
+          * never runs, so the transfer is over already */
+         if (!task_push_http_transfer_file(
+               url, true, NULL, cb_http_task_download_pl_thumbnail, transf))
+         {
+            retro_atomic_fetch_add(&pl_thumb->http_tasks_pending, -1);
+            free(transf);
+         }
       }
    }
 }
 
+/* Appends thumbnail of the current type for the current
+ * playlist entry to the thumbnail pack of that type */
+static void pack_pl_thumbnail(pl_thumb_handle_t *pl_thumb)
+{
+   char path[PATH_MAX_LENGTH];
+   char pack_path[PATH_MAX_LENGTH];
+   gfx_thumbnail_pack_writer_t **writer = NULL;
+
+   path[0]      = '\0';
+   pack_path[0] = '\0';
+
+   if (!get_thumbnail_paths(pl_thumb, path, sizeof(path), NULL, 0))
+      return;
+
+   if (!path_is_valid(path))
+      return;
+
+   writer = &pl_thumb->pack_writers[pl_thumb->type_idx - 1];
+
+   /* Every entry of a playlist shares the same
+    * thumbnail directory, so one pack is written
+    * per thumbnail type */
+   if (!*writer)
+   {
+      if (!gfx_thumbnail_pack_get_path(path, pack_path, sizeof(pack_path)))
+         return;
+
+      if (!(*writer = gfx_thumbnail_pack_writer_init(pack_path)))
+         return;
+   }
+
+   gfx_thumbnail_pack_writer_add(*writer, path);
+}
+
+/* Called once every playlist entry has been downloaded */
+static void end_pl_thumbnail_download(pl_thumb_handle_t *pl_thumb)
+{
+   /* Packs include thumbnails from previous downloads,
+    * so start again from the first entry */
+   if (pl_thumb->pack_enable)
+   {
+      pl_thumb->list_index = 0;
+      pl_thumb->status     = PL_THUMB_PACK_ENTRY;
+   }
+   else
+      pl_thumb->status     = PL_THUMB_END;
+}
+
 static void free_pl_thumb_handle(pl_thumb_handle_t *pl_thumb)
 {
+   size_t i;
+
    if (!pl_thumb)
       return;
 
@@ -320,6 +390,13 @@ static void free_pl_thumb_handle(pl_thumb_handle_t *pl_thumb)
       pl_thumb->thumbnail_path_data = NULL;
    }
 
+   /* Discards any unfinished pack */
+   for (i = 0; i < PL_THUMB_NUM_TYPES; i++)
+   {
+      gfx_thumbnail_pack_writer_free(pl_thumb->pack_writers[i]);
+      pl_thumb->pack_writers[i] = NULL;
+   }
+
    free(pl_thumb);
    pl_thumb = NULL;
 }
@@ -340,8 +417,13 @@ static void task_pl_thumbnail_download_handler(retro_task_t *task)
    if (!pl_thumb)
       goto task_finished;
    
+   /* Pending transfers still refer to the handle */
    if (task_get_cancelled(task))
+   {
+      if (retro_atomic_load(&pl_thumb->http_tasks_pending) > 0)
+         return;
       goto task_finished;
+   }
    
    switch (pl_thumb->status)
    {
@@ -399,26 +481,17 @@ static void task_pl_thumbnail_download_handler(retro_task_t *task)
              * the next one */
             pl_thumb->list_index++;
             if (pl_thumb->list_index >= pl_thumb->list_size)
-               pl_thumb->status = PL_THUMB_END;
+               end_pl_thumbnail_download(pl_thumb);
          }
          break;
       case PL_THUMB_ITERATE_TYPE:
-         /* Ensure that we only enqueue one transfer
-          * at a time... */
-
-         /* > If HTTP task is NULL, then it either finished
-          *   or an error occurred - in either case,
-          *   current task is 'complete' */
-         if (!pl_thumb->http_task)
-            pl_thumb->http_task_complete = true;
-
-         /* > Wait for task_push_http_transfer_file()
-          *   callback to trigger */
-         if (!pl_thumb->http_task_complete)
+         /* Keep at most 'download_max' transfers going;
+          * they mostly wait on the server, so running a
+          * few at once hides the per request latency */
+         if (retro_atomic_load(&pl_thumb->http_tasks_pending)
+               >= (int)pl_thumb->download_max)
             break;
 
-         pl_thumb->http_task = NULL;
-
          /* Check whether all thumbnail types have been processed */
          if (pl_thumb->type_idx > 3)
          {
@@ -427,7 +500,7 @@ static void task_pl_thumbnail_download_handler(retro_task_t *task)
             if (pl_thumb->list_index < pl_thumb->list_size)
                pl_thumb->status = PL_THUMB_ITERATE_ENTRY;
             else
-               pl_thumb->status = PL_THUMB_END;
+               end_pl_thumbnail_download(pl_thumb);
             break;
          }
 
@@ -437,8 +510,55 @@ static void task_pl_thumbnail_download_handler(retro_task_t *task)
          /* Increment thumbnail type */
          pl_thumb->type_idx++;
          break;
+      case PL_THUMB_PACK_ENTRY:
+         /* Wait for the last downloads */
+         if (retro_atomic_load(&pl_thumb->http_tasks_pending) > 0)
+            break;
+
+         if (gfx_thumbnail_set_content_playlist(
+                  pl_thumb->thumbnail_path_data, pl_thumb->playlist, pl_thumb->list_index))
+         {
+            const char *label = NULL;
+
+            /* Update progress display */
+            task_free_title(task);
+            if (gfx_thumbnail_get_label(pl_thumb->thumbnail_path_data, &label))
+               task_set_title(task, strdup(label));
+            else
+               task_set_title(task, strdup(""));
+            task_set_progress(task, (pl_thumb->list_index * 100) / pl_thumb->list_size);
+
+            for (pl_thumb->type_idx = 1;
+                  pl_thumb->type_idx <= PL_THUMB_NUM_TYPES;
+                  pl_thumb->type_idx++)
+               pack_pl_thumbnail(pl_thumb);
+         }
+
+         pl_thumb->list_index++;
+         if (pl_thumb->list_index >= pl_thumb->list_size)
+            pl_thumb->status = PL_THUMB_PACK_END;
+         break;
+      case PL_THUMB_PACK_END:
+         {
+            size_t i;
+
+            for (i = 0; i < PL_THUMB_NUM_TYPES; i++)
+            {
+               if (pl_thumb->pack_writers[i])
+                  if (!gfx_thumbnail_pack_writer_finish(
+                           pl_thumb->pack_writers[i]))
+                     RARCH_ERR("[Thumbnails]: Failed to write thumbnail pack for '%s'\n",
+                           pl_thumb->system);
+               pl_thumb->pack_writers[i] = NULL;
+            }
+         }
+
+         pl_thumb->status = PL_THUMB_END;
+         break;
       case PL_THUMB_END:
       default:
+         if (retro_atomic_load(&pl_thumb->http_tasks_pending) > 0)
+            break;
          task_set_progress(task, 100);
          goto task_finished;
    }
@@ -453,6 +573,16 @@ task_finished:
    free_pl_thumb_handle(pl_thumb);
 }
 
+#if defined(RARCH_INTERNAL) && defined(HAVE_MENU)
+static void cb_task_pl_thumbnail_pack_reload(
+      retro_task_t *task, void *task_data,
+      void *user_data, const char *err)
+{
+   /* Thumbnail packs may have been regenerated */
+   gfx_thumbnail_pack_reload();
+}
+#endif
+
 static bool task_pl_thumbnail_finder(retro_task_t *task, void *user_data)
 {
    pl_thumb_handle_t *pl_thumb = NULL;
@@ -476,12 +606,13 @@ bool task_push_pl_thumbnail_download(
       const char *dir_thumbnails)
 {
    task_finder_data_t find_data;
+   settings_t *settings          = config_get_ptr();
    const char *playlist_file     = NULL;
    retro_task_t *task            = task_init();
    pl_thumb_handle_t *pl_thumb   = (pl_thumb_handle_t*)calloc(1, sizeof(pl_thumb_handle_t));
    
    /* Sanity check */
-   if (!playlist_config || !task || !pl_thumb)
+   if (!settings || !playlist_config || !task || !pl_thumb)
       goto error;
    
    if (string_is_empty(system) ||
@@ -524,16 +655,23 @@ bool task_push_pl_thumbnail_download(
    pl_thumb->dir_thumbnails      = strdup(dir_thumbnails);
    pl_thumb->playlist            = NULL;
    pl_thumb->thumbnail_path_data = NULL;
-   pl_thumb->http_task           = NULL;
-   pl_thumb->http_task_complete  = false;
    pl_thumb->list_size           = 0;
    pl_thumb->list_index          = 0;
    pl_thumb->type_idx            = 1;
+   pl_thumb->download_max        = MAX(settings->uints.gfx_thumbnail_download_max, 1);
+   pl_thumb->http_tasks_pending  = 0;
    pl_thumb->overwrite           = false;
+   pl_thumb->pack_enable         = settings->bools.gfx_thumbnail_pack_enable;
    pl_thumb->status              = PL_THUMB_BEGIN;
    
    /* Configure task */
    task->handler                 = task_pl_thumbnail_download_handler;
+#if defined(RARCH_INTERNAL) && defined(HAVE_MENU)
+   if (pl_thumb->pack_enable)
+      task->callback             = cb_task_pl_thumbnail_pack_reload;
+#endif
+   task->priority                = TASK_PRIORITY_LOW;
+   task->affinity                = TASK_AFFINITY_IO;
    task->state                   = pl_thumb;
    task->title                   = strdup(system);
    task->alternative_look        = true;
@@ -668,8 +806,13 @@ static void task_pl_entry_thumbnail_download_handler(retro_task_t *task)
    if (!pl_thumb)
       goto task_finished;
    
+   /* Pending transfers still refer to the handle */
    if (task_get_cancelled(task))
+   {
+      if (retro_atomic_load(&pl_thumb->http_tasks_pending) > 0)
+         return;
       goto task_finished;
+   }
    
    switch (pl_thumb->status)
    {
@@ -707,18 +850,7 @@ static void task_pl_entry_thumbnail_download_handler(retro_task_t *task)
          {
             /* Ensure that we only enqueue one transfer
              * at a time... */
-            
-            /* > If HTTP task is NULL, then it either finished
-             *   or an error occurred - in either case,
-             *   current task is 'complete' */
-            if (!pl_thumb->http_task)
-               pl_thumb->http_task_complete = true;
-            
-            /* > Wait for task_push_http_transfer_file()
-             *   callback to trigger */
-            if (pl_thumb->http_task_complete)
-               pl_thumb->http_task = NULL;
-            else
+            if (retro_atomic_load(&pl_thumb->http_tasks_pending) > 0)
                break;
             
             /* Check whether all thumbnail types have been processed */
@@ -854,16 +986,17 @@ bool task_push_pl_entry_thumbnail_download(
    pl_thumb->dir_thumbnails      = strdup(dir_thumbnails);
    pl_thumb->playlist            = NULL;
    pl_thumb->thumbnail_path_data = thumbnail_path_data;
-   pl_thumb->http_task           = NULL;
-   pl_thumb->http_task_complete  = false;
    pl_thumb->list_size           = playlist_size(playlist);
    pl_thumb->list_index          = idx;
    pl_thumb->type_idx            = 1;
+   pl_thumb->download_max        = 1;
+   pl_thumb->http_tasks_pending  = 0;
    pl_thumb->overwrite           = overwrite;
    pl_thumb->status              = PL_THUMB_BEGIN;
    
    /* Configure task */
    task->handler                 = task_pl_entry_thumbnail_download_handler;
+   task->affinity                = TASK_AFFINITY_IO;
    task->state                   = pl_thumb;
    task->title                   = strdup(system);
    task->alternative_look        = true;
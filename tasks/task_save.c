@@ -24,6 +24,9 @@
 #else
 #include <unistd.h>
 #endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#endif
 #include <errno.h>
 
 #include <compat/strl.h>
@@ -68,7 +71,13 @@
 #define SAVE_STATE_CHUNK 4096
 #endif
 
+/* SRAM is compared against the last autosave
+ * in blocks of this size; only changed blocks
+ * are copied while the core is held up */
+#define AUTOSAVE_BLOCK_SIZE 4096
+
 #define RASTATE_VERSION 1
+#define RASTATE_INFO_BLOCK "META"
 #define RASTATE_MEM_BLOCK "MEM "
 #define RASTATE_CHEEVOS_BLOCK "ACHV"
 #define RASTATE_END_BLOCK "END "
@@ -160,16 +169,149 @@ static struct autosave_st autosave_state;
 static bool save_state_in_background       = false;
 static struct string_list *task_save_files = NULL;
 
+/* Recently saved and loaded states are kept in RAM, so
+ * that loading them again is a straight unserialize.
+ * Only ever touched from the main thread - tasks hand
+ * back to it through their callbacks. */
+#define STATE_CACHE_MAX_SLOTS 10
+
+struct state_cache_slot
+{
+   void *data;
+   size_t size;
+   uint64_t last_used;
+   char path[PATH_MAX_LENGTH];
+   /* A save task for this path is queued or running */
+   bool writing;
+   /* 'data' is newer than the file and still has to
+    * be written out */
+   bool dirty;
+};
+
+static struct state_cache_slot state_cache[STATE_CACHE_MAX_SLOTS];
+static uint64_t state_cache_clock          = 0;
+
+/* Size of the META block, excluding the thumbnail:
+ * timestamp, content CRC, thumbnail width and height,
+ * core name */
+#define RASTATE_INFO_SIZE (8 + 4 + 2 + 2 + 64)
+
 typedef struct rastate_size_info
 {
    size_t total_size;
    size_t coremem_size;
+   /* Zero if the state has no META block */
+   size_t info_size;
+   unsigned thumbnail_width;
+   unsigned thumbnail_height;
 #ifdef HAVE_CHEEVOS
    size_t cheevos_size;
 #endif
 } rastate_size_info_t;
 
 #ifdef HAVE_THREADS
+/* Brings the autosave snapshot up to date with the
+ * core's SRAM, one block at a time - unchanged blocks
+ * are only compared, never copied.
+ * Returns true if any block differed.
+ * Must be called with save->lock held */
+static bool autosave_update_snapshot(autosave_t *save)
+{
+   size_t offset;
+   bool differ           = false;
+   uint8_t *buffer       = (uint8_t*)save->buffer;
+   const uint8_t *retro  = (const uint8_t*)save->retro_buffer;
+
+   for (offset = 0; offset < save->bufsize; offset += AUTOSAVE_BLOCK_SIZE)
+   {
+      size_t len = save->bufsize - offset;
+
+      if (len > AUTOSAVE_BLOCK_SIZE)
+         len = AUTOSAVE_BLOCK_SIZE;
+
+      if (memcmp(buffer + offset, retro + offset, len))
+      {
+         memcpy(buffer + offset, retro + offset, len);
+         differ = true;
+      }
+   }
+
+   return differ;
+}
+
+/* Makes sure the data written to 'path' is on disk
+ * before the file is renamed over the save */
+static bool autosave_sync_file(const char *path)
+{
+#if defined(__unix__) || defined(__APPLE__)
+   int ret;
+   int fd = open(path, O_RDONLY);
+
+   if (fd < 0)
+      return false;
+
+   ret = fsync(fd);
+   close(fd);
+   return ret == 0;
+#else
+   return true;
+#endif
+}
+
+/* Writes the autosave snapshot to a temporary file,
+ * which then replaces the save file - a crash
+ * mid-write can no longer truncate the save */
+static bool autosave_write_file(autosave_t *save)
+{
+   char tmp_path[PATH_MAX_LENGTH];
+   intfstream_t *file = NULL;
+   bool success       = false;
+
+   strlcpy(tmp_path, save->path, sizeof(tmp_path));
+   strlcat(tmp_path, ".tmp", sizeof(tmp_path));
+
+   /* Should probably deal with this more elegantly. */
+   if (save->compress_files)
+      file = intfstream_open_rzip_file(tmp_path,
+            RETRO_VFS_FILE_ACCESS_WRITE);
+   else
+      file = intfstream_open_file(tmp_path,
+            RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   success = intfstream_write(file, save->buffer, save->bufsize)
+         == (int64_t)save->bufsize;
+   intfstream_flush(file);
+   /* rzip streams only write their header on close */
+   if (intfstream_close(file) != 0)
+      success = false;
+   free(file);
+
+   if (!success || !autosave_sync_file(tmp_path))
+   {
+      filestream_delete(tmp_path);
+      return false;
+   }
+
+   if (filestream_rename(tmp_path, save->path) == 0)
+      return true;
+
+#if defined(_WIN32)
+   /* rename() does not replace an existing file here */
+   if (     filestream_delete(save->path) == 0
+         && filestream_rename(tmp_path, save->path) == 0)
+      return true;
+#endif
+
+   /* Keep the complete snapshot around, since the
+    * save itself may be gone at this point */
+   RARCH_ERR("[Autosave]: Failed to move \"%s\" into place.\n",
+         tmp_path);
+   return false;
+}
+
 /**
  * autosave_thread:
  * @data            : pointer to autosave object
@@ -179,37 +321,25 @@ typedef struct rastate_size_info
 static void autosave_thread(void *data)
 {
    autosave_t *save = (autosave_t*)data;
+   bool retry       = false;
 
    while (!save->quit)
    {
       bool differ;
 
       slock_lock(save->lock);
-      differ = string_is_not_equal_fast(save->buffer, save->retro_buffer,
-            save->bufsize);
-      if (differ)
-         memcpy(save->buffer, save->retro_buffer, save->bufsize);
+      differ = autosave_update_snapshot(save);
       slock_unlock(save->lock);
 
-      if (differ)
+      /* The snapshot is only touched by this thread,
+       * so the core keeps running while it is written.
+       * A failed write is tried again on the next pass,
+       * even if the save data has not changed since */
+      if (differ || retry)
       {
-         intfstream_t *file = NULL;
-
-         /* Should probably deal with this more elegantly. */
-         if (save->compress_files)
-            file = intfstream_open_rzip_file(save->path,
-                  RETRO_VFS_FILE_ACCESS_WRITE);
-         else
-            file = intfstream_open_file(save->path,
-                  RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
-
-         if (file)
-         {
-            intfstream_write(file, save->buffer, save->bufsize);
-            intfstream_flush(file);
-            intfstream_close(file);
-            free(file);
-         }
+         retry = !autosave_write_file(save);
+         if (retry)
+            RARCH_WARN("[Autosave]: Failed to write \"%s\".\n", save->path);
       }
 
       slock_lock(save->cond_lock);
@@ -603,7 +733,10 @@ static bool content_get_rastate_size(rastate_size_info_t* size)
    if (!info.size)
       return false;
 
-   size->coremem_size = info.size;
+   size->coremem_size     = info.size;
+   size->info_size        = 0;
+   size->thumbnail_width  = 0;
+   size->thumbnail_height = 0;
    /* 8-byte identifier, 8-byte block header, content, 8-byte terminator */
    size->total_size = 8 + 8 + content_align_size(info.size) + 8;
 
@@ -634,6 +767,154 @@ static void content_write_block_header(unsigned char* output, const char* header
    output[7] = ((size >> 24) & 0xFF);
 }
 
+/* Gets the size of the thumbnail embedded in a save
+ * state: the last frame, shrunk to fit within
+ * CONTENT_STATE_THUMBNAIL_MAX_* without changing
+ * its aspect ratio
+ * > Returns false if there is no software frame */
+static bool content_get_state_thumbnail_size(
+      unsigned *width, unsigned *height)
+{
+   const void *data      = NULL;
+   unsigned frame_width  = 0;
+   unsigned frame_height = 0;
+   size_t pitch          = 0;
+
+   video_driver_cached_frame_get(&data,
+         &frame_width, &frame_height, &pitch);
+
+   if (     !data
+         || (data == RETRO_HW_FRAME_BUFFER_VALID)
+         || (frame_width == 0)
+         || (frame_height == 0))
+      return false;
+
+   if (frame_width * CONTENT_STATE_THUMBNAIL_MAX_HEIGHT >
+         frame_height * CONTENT_STATE_THUMBNAIL_MAX_WIDTH)
+   {
+      *width  = MIN(frame_width, CONTENT_STATE_THUMBNAIL_MAX_WIDTH);
+      *height = (frame_height * *width) / frame_width;
+   }
+   else
+   {
+      *height = MIN(frame_height, CONTENT_STATE_THUMBNAIL_MAX_HEIGHT);
+      *width  = (frame_width * *height) / frame_height;
+   }
+
+   if (*width == 0)
+      *width  = 1;
+   if (*height == 0)
+      *height = 1;
+
+   return true;
+}
+
+/* Adds a META block to 'size'. A thumbnail is only
+ * included if 'with_thumbnail' is true
+ * > Samples the current frame, so must be called
+ *   from the main thread if 'with_thumbnail' is set */
+static void content_get_rastate_info_size(
+      rastate_size_info_t *size, bool with_thumbnail)
+{
+   size->info_size = RASTATE_INFO_SIZE;
+
+   if (with_thumbnail && content_get_state_thumbnail_size(
+            &size->thumbnail_width, &size->thumbnail_height))
+      size->info_size += size->thumbnail_width
+            * size->thumbnail_height * sizeof(uint16_t);
+
+   /* 8-byte block header + content */
+   size->total_size   += 8 + content_align_size(size->info_size);
+}
+
+/* Nearest neighbour downscale of the current frame
+ * into 'output', as little endian RGB565 */
+static void content_write_state_thumbnail(unsigned char *output,
+      unsigned width, unsigned height)
+{
+   unsigned x, y;
+   const void *data                = NULL;
+   unsigned frame_width            = 0;
+   unsigned frame_height           = 0;
+   size_t pitch                    = 0;
+   enum retro_pixel_format format  = video_driver_get_pixel_format();
+
+   video_driver_cached_frame_get(&data,
+         &frame_width, &frame_height, &pitch);
+
+   for (y = 0; y < height; y++)
+   {
+      const uint8_t *row = (const uint8_t*)data
+            + (size_t)((y * frame_height) / height) * pitch;
+
+      for (x = 0; x < width; x++)
+      {
+         unsigned src_x = (x * frame_width) / width;
+         uint16_t pixel;
+
+         switch (format)
+         {
+            case RETRO_PIXEL_FORMAT_XRGB8888:
+               {
+                  uint32_t c = ((const uint32_t*)row)[src_x];
+                  pixel      = ((c >> 8) & 0xF800)
+                             | ((c >> 5) & 0x07E0)
+                             | ((c >> 3) & 0x001F);
+               }
+               break;
+            case RETRO_PIXEL_FORMAT_RGB565:
+               pixel = ((const uint16_t*)row)[src_x];
+               break;
+            case RETRO_PIXEL_FORMAT_0RGB1555:
+            default:
+               {
+                  uint16_t c = ((const uint16_t*)row)[src_x];
+                  pixel      = ((c << 1) & 0xFFC0)
+                             | ((c >> 4) & 0x0020)
+                             | ( c       & 0x001F);
+               }
+               break;
+         }
+
+         *output++ = (unsigned char)(pixel & 0xFF);
+         *output++ = (unsigned char)(pixel >> 8);
+      }
+   }
+}
+
+/* Writes the payload of a META block:
+ * - 8-byte timestamp (seconds since the epoch)
+ * - 4-byte content CRC
+ * - 2-byte thumbnail width, 2-byte thumbnail height
+ * - 64-byte NUL-terminated core name
+ * - thumbnail pixels, little endian RGB565
+ * All values are little endian */
+static void content_write_state_info(unsigned char *output,
+      rastate_size_info_t *size)
+{
+   unsigned i;
+   rarch_system_info_t *system = runloop_get_system_info();
+   uint64_t timestamp          = (uint64_t)(int64_t)time(NULL);
+   uint32_t content_crc        = content_get_crc();
+
+   for (i = 0; i < 8; i++)
+      output[i]      = (unsigned char)((timestamp >> (i * 8)) & 0xFF);
+   for (i = 0; i < 4; i++)
+      output[8 + i]  = (unsigned char)((content_crc >> (i * 8)) & 0xFF);
+   output[12]        = (unsigned char)(size->thumbnail_width & 0xFF);
+   output[13]        = (unsigned char)(size->thumbnail_width >> 8);
+   output[14]        = (unsigned char)(size->thumbnail_height & 0xFF);
+   output[15]        = (unsigned char)(size->thumbnail_height >> 8);
+
+   memset(output + 16, 0, 64);
+   if (system && !string_is_empty(system->info.library_name))
+      strlcpy((char*)output + 16, system->info.library_name, 64);
+
+   if (size->thumbnail_width && size->thumbnail_height)
+      content_write_state_thumbnail(output + RASTATE_INFO_SIZE,
+            size->thumbnail_width, size->thumbnail_height);
+}
+
 static bool content_write_serialized_state(void* buffer, rastate_size_info_t* size)
 {
    retro_ctx_serialize_info_t serial_info;
@@ -644,6 +925,17 @@ static bool content_write_serialized_state(void* buffer, rastate_size_info_t* si
    output[7] = RASTATE_VERSION;
    output += 8;
 
+   /* The META block comes first, so that it can be
+    * read without decoding the rest of the state */
+   if (size->info_size)
+   {
+      content_write_block_header(output, RASTATE_INFO_BLOCK, size->info_size);
+      output += 8;
+
+      content_write_state_info(output, size);
+      output += content_align_size(size->info_size);
+   }
+
    /* important - write the unaligned size - some cores fail if they aren't passed the exact right size. */
    content_write_block_header(output, RASTATE_MEM_BLOCK, size->coremem_size);
    output += 8;
@@ -683,7 +975,11 @@ bool content_serialize_state(void* buffer, size_t buffer_size)
    return content_write_serialized_state(buffer, &size);
 }
 
-static void *content_get_serialized_data(size_t* serial_size)
+/* Serializes the current state into a new buffer
+ * > States written to disk set 'with_info', so that
+ *   they get a META block */
+static void *content_get_serialized_data(size_t* serial_size,
+      bool with_info, bool with_thumbnail)
 {
    void* data;
 
@@ -691,6 +987,9 @@ static void *content_get_serialized_data(size_t* serial_size)
    if (!content_get_rastate_size(&size))
       return NULL;
 
+   if (with_info)
+      content_get_rastate_info_size(&size, with_thumbnail);
+
    /* Ensure buffer is initialised to zero
     * > Prevents inconsistent compressed state file
     *   sizes when core requests a larger buffer
@@ -739,7 +1038,8 @@ static void task_save_handler(retro_task_t *task)
    if (!state->data)
    {
       size_t size = 0;
-      state->data = content_get_serialized_data(&size);
+      /* Not on the main thread - no thumbnail */
+      state->data = content_get_serialized_data(&size, true, false);
       state->size = (ssize_t)size;
    }
 
@@ -817,6 +1117,235 @@ static void task_save_handler(retro_task_t *task)
    }
 }
 
+static bool task_push_save_state(const char *path, void *data,
+      size_t size, bool autosave);
+
+static struct state_cache_slot *state_cache_find(const char *path)
+{
+   unsigned i;
+
+   for (i = 0; i < STATE_CACHE_MAX_SLOTS; i++)
+      if (state_cache[i].data && string_is_equal(state_cache[i].path, path))
+         return &state_cache[i];
+
+   return NULL;
+}
+
+static void state_cache_free_slot(struct state_cache_slot *slot)
+{
+   free(slot->data);
+   memset(slot, 0, sizeof(*slot));
+}
+
+/* Finds the slot for 'path', or a free one - evicting
+ * the least recently used state that is on disk if the
+ * cache is full. Returns NULL if 'limit' is zero or
+ * every state still has to be written out. */
+static struct state_cache_slot *state_cache_get_slot(const char *path,
+      unsigned limit)
+{
+   unsigned i;
+   unsigned used                  = 0;
+   struct state_cache_slot *slot  = state_cache_find(path);
+   struct state_cache_slot *empty = NULL;
+
+   if (slot)
+      return slot;
+
+   if (limit > STATE_CACHE_MAX_SLOTS)
+      limit = STATE_CACHE_MAX_SLOTS;
+
+   for (i = 0; i < STATE_CACHE_MAX_SLOTS; i++)
+   {
+      if (state_cache[i].data)
+         used++;
+      else if (!empty)
+         empty = &state_cache[i];
+   }
+
+   while (used >= limit)
+   {
+      struct state_cache_slot *oldest = NULL;
+
+      for (i = 0; i < STATE_CACHE_MAX_SLOTS; i++)
+      {
+         struct state_cache_slot *cur = &state_cache[i];
+         if (!cur->data || cur->dirty || cur->writing)
+            continue;
+         if (!oldest || cur->last_used < oldest->last_used)
+            oldest = cur;
+      }
+
+      if (!oldest)
+         return NULL;
+
+      state_cache_free_slot(oldest);
+      empty = oldest;
+      used--;
+   }
+
+   if (empty)
+      strlcpy(empty->path, path, sizeof(empty->path));
+   return empty;
+}
+
+/* Drops the least recently used states that are on
+ * disk until no more than 'limit' are left */
+static void state_cache_trim(unsigned limit)
+{
+   for (;;)
+   {
+      unsigned i;
+      unsigned used                   = 0;
+      struct state_cache_slot *oldest = NULL;
+
+      for (i = 0; i < STATE_CACHE_MAX_SLOTS; i++)
+      {
+         struct state_cache_slot *cur = &state_cache[i];
+         if (!cur->data)
+            continue;
+         used++;
+         if (cur->dirty || cur->writing)
+            continue;
+         if (!oldest || cur->last_used < oldest->last_used)
+            oldest = cur;
+      }
+
+      if (used <= limit || !oldest)
+         return;
+
+      state_cache_free_slot(oldest);
+   }
+}
+
+/* Keeps a copy of 'data' as the newest state of 'path'.
+ * This ignores the cache size: loads of a state that is
+ * still to be written are served from here, which keeps
+ * them after the save. state_cache_trim() drops it again
+ * once it is on disk. The slot's buffer is reused when
+ * the size matches, which it does for nearly every core. */
+static struct state_cache_slot *state_cache_store(const char *path,
+      const void *data, size_t size)
+{
+   struct state_cache_slot *slot = state_cache_get_slot(path,
+         STATE_CACHE_MAX_SLOTS);
+
+   if (!slot)
+      return NULL;
+
+   if (slot->size != size || !slot->data)
+   {
+      void *buf = malloc(size);
+
+      if (!buf)
+      {
+         /* An older copy must not outlive this save */
+         state_cache_free_slot(slot);
+         return NULL;
+      }
+
+      free(slot->data);
+      slot->data = buf;
+      slot->size = size;
+   }
+
+   memcpy(slot->data, data, size);
+   slot->last_used = ++state_cache_clock;
+
+   return slot;
+}
+
+/* Takes over 'data', a state just read from 'path' */
+static void state_cache_adopt(const char *path, void *data, size_t size)
+{
+   settings_t *settings          = config_get_ptr();
+   struct state_cache_slot *slot = state_cache_get_slot(path,
+         settings->uints.savestate_cache_slots);
+
+   if (!slot || slot->dirty || slot->writing)
+   {
+      free(data);
+      return;
+   }
+
+   free(slot->data);
+   slot->data      = data;
+   slot->size      = size;
+   slot->last_used = ++state_cache_clock;
+}
+
+static void state_cache_remove(const char *path)
+{
+   struct state_cache_slot *slot = state_cache_find(path);
+
+   if (slot)
+      state_cache_free_slot(slot);
+}
+
+static bool state_cache_is_dirty(void)
+{
+   unsigned i;
+
+   for (i = 0; i < STATE_CACHE_MAX_SLOTS; i++)
+      if (state_cache[i].dirty)
+         return true;
+
+   return false;
+}
+
+/* Queues the write of a state that changed while its
+ * previous write was going on. Blocking tasks run one
+ * at a time, so this is retried as each save finishes;
+ * saves that came in meanwhile only leave the newest
+ * data to be written, once. */
+static void state_cache_flush(void)
+{
+   unsigned i;
+
+   for (i = 0; i < STATE_CACHE_MAX_SLOTS; i++)
+   {
+      struct state_cache_slot *slot = &state_cache[i];
+      void *data                    = NULL;
+
+      if (!slot->dirty || slot->writing)
+         continue;
+
+      if (!(data = malloc(slot->size)))
+         return;
+
+      memcpy(data, slot->data, slot->size);
+
+      /* Muted - the save was reported when it was made */
+      slot->writing = task_push_save_state(slot->path,
+            data, slot->size, true);
+      slot->dirty   = !slot->writing;
+      return;
+   }
+}
+
+static void state_cache_write_done(const char *path)
+{
+   settings_t *settings          = config_get_ptr();
+   struct state_cache_slot *slot = state_cache_find(path);
+
+   if (slot)
+      slot->writing = false;
+
+   state_cache_trim(settings->uints.savestate_cache_slots);
+   state_cache_flush();
+}
+
+static void state_cache_write_failed(const char *path)
+{
+   struct state_cache_slot *slot = state_cache_find(path);
+
+   if (slot)
+   {
+      slot->writing = false;
+      slot->dirty   = true;
+   }
+}
+
 /**
  * task_push_undo_save_state:
  * @path : file path of the save state
@@ -848,6 +1377,8 @@ static bool task_push_undo_save_state(const char *path, void *data, size_t size)
    state->compress_files         = compress_files;
 
    task->type                    = TASK_TYPE_BLOCKING;
+   task->priority                = TASK_PRIORITY_HIGH;
+   task->affinity                = TASK_AFFINITY_IO;
    task->state                   = state;
    task->handler                 = task_save_handler;
    task->callback                = undo_save_state_cb;
@@ -876,6 +1407,8 @@ error:
  **/
 bool content_undo_save_state(void)
 {
+   state_cache_remove(undo_save_buf.path);
+
    return task_push_undo_save_state(undo_save_buf.path,
                              undo_save_buf.data,
                              undo_save_buf.size);
@@ -1120,64 +1653,119 @@ bool content_deserialize_state(const void* serialized_data, size_t serialized_si
    return true;
 }
 
-/**
- * content_load_state_cb:
- * @path      : path that state will be loaded from.
- * Load a state from disk to memory.
- *
- **/
-static void content_load_state_cb(retro_task_t *task,
-      void *task_data,
-      void *user_data, const char *error)
+bool content_read_state_info(const char *path,
+      content_state_info_t *info, bool load_thumbnail)
 {
    unsigned i;
-   bool ret;
-   load_task_data_t *load_data = (load_task_data_t*)task_data;
-   ssize_t size                = load_data->size;
-   unsigned num_blocks         = 0;
-   void *buf                   = load_data->data;
-   struct sram_block *blocks   = NULL;
-   settings_t *settings        = config_get_ptr();
-   bool block_sram_overwrite   = settings->bools.block_sram_overwrite;
+   uint64_t timestamp;
+   size_t block_size;
+   size_t num_pixels;
+   unsigned char header[8 + 8 + RASTATE_INFO_SIZE];
+   intfstream_t *file = NULL;
+   bool ret           = false;
+
+   if (!info)
+      return false;
 
-#ifdef HAVE_CHEEVOS
-   if (rcheevos_hardcore_active())
-      goto error;
+   memset(info, 0, sizeof(*info));
+
+   if (string_is_empty(path))
+      return false;
+
+#if defined(HAVE_ZLIB)
+   /* Only the first chunk of a compressed
+    * state is inflated */
+   file = intfstream_open_rzip_file(path,
+         RETRO_VFS_FILE_ACCESS_READ);
+#else
+   file = intfstream_open_file(path,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
 #endif
 
-   RARCH_LOG("[State]: %s \"%s\", %u %s.\n",
-         msg_hash_to_str(MSG_LOADING_STATE),
-         load_data->path,
-         (unsigned)size,
-         msg_hash_to_str(MSG_BYTES));
+   if (!file)
+      return false;
 
-   if (size < 0 || !buf)
-      goto error;
+   if (intfstream_read(file, header, sizeof(header)) != sizeof(header))
+      goto end;
 
-   /* This means we're backing up the file in memory, 
-    * so content_undo_save_state()
-    * can restore it */
-   if (load_data->load_to_backup_buffer)
+   if (     (memcmp(header, "RASTATE", 7) != 0)
+         || (header[7] != RASTATE_VERSION)
+         || (memcmp(header + 8, RASTATE_INFO_BLOCK, 4) != 0))
+      goto end;
+
+   block_size = (header[15] << 24 | header[14] << 16 | header[13] << 8 | header[12]);
+   timestamp  = 0;
+   for (i = 0; i < 8; i++)
+      timestamp           |= (uint64_t)header[16 + i] << (i * 8);
+
+   info->timestamp         = (int64_t)timestamp;
+   info->content_crc       = (uint32_t)header[24]
+                           | (uint32_t)header[25] << 8
+                           | (uint32_t)header[26] << 16
+                           | (uint32_t)header[27] << 24;
+   info->thumbnail_width   = header[28] | header[29] << 8;
+   info->thumbnail_height  = header[30] | header[31] << 8;
+   strlcpy(info->core_name, (const char*)header + 32,
+         sizeof(info->core_name));
+
+   num_pixels = info->thumbnail_width * info->thumbnail_height;
+
+   /* Ignore thumbnails that are oversized or
+    * do not fit in the block */
+   if (     (info->thumbnail_width  > CONTENT_STATE_THUMBNAIL_MAX_WIDTH)
+         || (info->thumbnail_height > CONTENT_STATE_THUMBNAIL_MAX_HEIGHT)
+         || (block_size < RASTATE_INFO_SIZE + num_pixels * sizeof(uint16_t)))
+      num_pixels = 0;
+
+   if (num_pixels == 0)
    {
-      /* If we were previously backing up a file, let go of it first */
-      if (undo_save_buf.data)
+      info->thumbnail_width  = 0;
+      info->thumbnail_height = 0;
+   }
+
+   ret = true;
+
+   if (load_thumbnail && num_pixels)
+   {
+      unsigned char *pixels = (unsigned char*)malloc(
+            num_pixels * sizeof(uint16_t));
+
+      if (pixels && intfstream_read(file, pixels,
+               num_pixels * sizeof(uint16_t))
+            == (int64_t)(num_pixels * sizeof(uint16_t)))
       {
-         free(undo_save_buf.data);
-         undo_save_buf.data = NULL;
+         /* Convert to native byte order in place */
+         info->thumbnail = (uint16_t*)pixels;
+         for (i = 0; i < num_pixels; i++)
+            info->thumbnail[i] = pixels[i * 2] | pixels[i * 2 + 1] << 8;
       }
+      else
+      {
+         free(pixels);
+         info->thumbnail_width  = 0;
+         info->thumbnail_height = 0;
+      }
+   }
 
-      undo_save_buf.data = malloc(size);
-      if (!undo_save_buf.data)
-         goto error;
+end:
+   intfstream_close(file);
+   free(file);
 
-      memcpy(undo_save_buf.data, buf, size);
-      undo_save_buf.size = size;
-      strlcpy(undo_save_buf.path, load_data->path, sizeof(undo_save_buf.path));
+   return ret;
+}
 
-      free(buf);
-      free(load_data);
-      return;
-   }
+/* Unserializes 'buf', keeping SRAM as it is if
+ * 'block_sram_overwrite' is set. Shared by loads from
+ * file and from the cache. */
+static bool content_load_state_buffer(const void *buf, size_t size)
+{
+   unsigned i;
+   bool ret;
+   unsigned num_blocks         = 0;
+   struct sram_block *blocks   = NULL;
+   settings_t *settings        = config_get_ptr();
+   bool block_sram_overwrite   = settings->bools.block_sram_overwrite;
 
    if (block_sram_overwrite && task_save_files
          && task_save_files->size)
@@ -1254,10 +1842,67 @@ static void content_load_state_cb(retro_task_t *task,
       free(blocks[i].data);
    free(blocks);
 
-   if (!ret)
+   return ret;
+}
+
+/**
+ * content_load_state_cb:
+ * @path      : path that state will be loaded from.
+ * Load a state from disk to memory.
+ *
+ **/
+static void content_load_state_cb(retro_task_t *task,
+      void *task_data,
+      void *user_data, const char *error)
+{
+   load_task_data_t *load_data = (load_task_data_t*)task_data;
+   ssize_t size                = load_data->size;
+   void *buf                   = load_data->data;
+
+#ifdef HAVE_CHEEVOS
+   if (rcheevos_hardcore_active())
+      goto error;
+#endif
+
+   RARCH_LOG("[State]: %s \"%s\", %u %s.\n",
+         msg_hash_to_str(MSG_LOADING_STATE),
+         load_data->path,
+         (unsigned)size,
+         msg_hash_to_str(MSG_BYTES));
+
+   if (size < 0 || !buf)
+      goto error;
+
+   /* This means we're backing up the file in memory, 
+    * so content_undo_save_state()
+    * can restore it */
+   if (load_data->load_to_backup_buffer)
+   {
+      /* If we were previously backing up a file, let go of it first */
+      if (undo_save_buf.data)
+      {
+         free(undo_save_buf.data);
+         undo_save_buf.data = NULL;
+      }
+
+      undo_save_buf.data = malloc(size);
+      if (!undo_save_buf.data)
+         goto error;
+
+      memcpy(undo_save_buf.data, buf, size);
+      undo_save_buf.size = size;
+      strlcpy(undo_save_buf.path, load_data->path, sizeof(undo_save_buf.path));
+
+      free(buf);
+      free(load_data);
+      return;
+   }
+
+   if (!content_load_state_buffer(buf, size))
       goto error;
 
-   free(buf);
+   /* Loading the same slot again is then instant */
+   state_cache_adopt(load_data->path, buf, size);
    free(load_data);
 
    return;
@@ -1292,6 +1937,8 @@ static void save_state_cb(retro_task_t *task,
    free(path);
 #endif
 
+   state_cache_write_done(state->path);
+
    free(state);
 }
 
@@ -1302,8 +1949,11 @@ static void save_state_cb(retro_task_t *task,
  * @size : the total size of the save state
  *
  * Create a new task to save the content state.
+ *
+ * Returns: true if the task was queued. @data is
+ * freed either way.
  **/
-static void task_push_save_state(const char *path, void *data, size_t size, bool autosave)
+static bool task_push_save_state(const char *path, void *data, size_t size, bool autosave)
 {
    retro_task_t       *task        = task_init();
    save_task_state_t *state        = (save_task_state_t*)calloc(1, sizeof(*state));
@@ -1330,6 +1980,8 @@ static void task_push_save_state(const char *path, void *data, size_t size, bool
    state->compress_files         = compress_files;
 
    task->type              = TASK_TYPE_BLOCKING;
+   task->priority          = TASK_PRIORITY_HIGH;
+   task->affinity          = TASK_AFFINITY_IO;
    task->state             = state;
    task->handler           = task_save_handler;
    task->callback          = save_state_cb;
@@ -1345,9 +1997,10 @@ static void task_push_save_state(const char *path, void *data, size_t size, bool
          task_free_title(task);
       free(task);
       free(state);
+      return false;
    }
 
-   return;
+   return true;
 
 error:
    if (data)
@@ -1360,6 +2013,8 @@ error:
          task_free_title(task);
       free(task);
    }
+
+   return false;
 }
 
 /**
@@ -1380,7 +2035,8 @@ static void content_load_and_save_state_cb(retro_task_t *task,
 
    content_load_state_cb(task, task_data, user_data, error);
 
-   task_push_save_state(path, data, size, autosave);
+   if (!task_push_save_state(path, data, size, autosave))
+      state_cache_write_failed(path);
 
    free(path);
 }
@@ -1394,8 +2050,11 @@ static void content_load_and_save_state_cb(retro_task_t *task,
  *
  * Create a new task to load current state first into a backup buffer (for undo)
  * and then save the content state.
+ *
+ * Returns: true if the task was queued. @data is
+ * freed either way.
  **/
-static void task_push_load_and_save_state(const char *path, void *data,
+static bool task_push_load_and_save_state(const char *path, void *data,
       size_t size, bool load_to_backup_buffer, bool autosave)
 {
    retro_task_t      *task     = NULL;
@@ -1410,14 +2069,18 @@ static void task_push_load_and_save_state(const char *path, void *data,
       calloc(1, sizeof(*state));
 
    if (!state)
-      return;
+   {
+      free(data);
+      return false;
+   }
 
    task                        = task_init();
 
    if (!task)
    {
+      free(data);
       free(state);
-      return;
+      return false;
    }
 
 
@@ -1437,6 +2100,8 @@ static void task_push_load_and_save_state(const char *path, void *data,
 
    task->state       = state;
    task->type        = TASK_TYPE_BLOCKING;
+   task->priority    = TASK_PRIORITY_HIGH;
+   task->affinity    = TASK_AFFINITY_IO;
    task->handler     = task_load_handler;
    task->callback    = content_load_and_save_state_cb;
    task->title       = strdup(msg_hash_to_str(MSG_LOADING_STATE));
@@ -1451,7 +2116,10 @@ static void task_push_load_and_save_state(const char *path, void *data,
          task_free_title(task);
       free(task);
       free(state);
+      return false;
    }
+
+   return true;
 }
 
 /**
@@ -1465,7 +2133,9 @@ static void task_push_load_and_save_state(const char *path, void *data,
 bool content_save_state(const char *path, bool save_to_disk, bool autosave)
 {
    retro_ctx_size_info_t info;
-   void *data  = NULL;
+   void *data                      = NULL;
+   settings_t *settings            = config_get_ptr();
+   bool savestate_thumbnail_enable = settings->bools.savestate_thumbnail_enable;
    size_t serial_size;
 
    core_serialize_size(&info);
@@ -1476,7 +2146,8 @@ bool content_save_state(const char *path, bool save_to_disk, bool autosave)
 
    if (!save_state_in_background)
    {
-      data = content_get_serialized_data(&serial_size);
+      data = content_get_serialized_data(&serial_size,
+            save_to_disk, save_to_disk && savestate_thumbnail_enable);
 
       if (!data)
       {
@@ -1495,7 +2166,64 @@ bool content_save_state(const char *path, bool save_to_disk, bool autosave)
 
    if (save_to_disk)
    {
-      if (path_is_valid(path) && !autosave)
+      struct state_cache_slot *slot = NULL;
+      bool undo_from_cache          = false;
+      bool queued                   = false;
+
+      state_cache_flush();
+
+      if (!data)
+         state_cache_remove(path);
+      else
+      {
+         /* What the file holds before it is overwritten is
+          * still in the cache - no need to read it back in
+          * for undo_save_state() */
+         if (!autosave && (slot = state_cache_find(path)))
+         {
+            void *undo_data = malloc(slot->size);
+
+            if (undo_data)
+            {
+               memcpy(undo_data, slot->data, slot->size);
+               free(undo_save_buf.data);
+               undo_save_buf.data = undo_data;
+               undo_save_buf.size = slot->size;
+               strlcpy(undo_save_buf.path, path, sizeof(undo_save_buf.path));
+               undo_from_cache    = true;
+            }
+         }
+
+         slot = state_cache_store(path, data, serial_size);
+      }
+
+      if (slot && (slot->writing || slot->dirty))
+      {
+         /* The last save of this path hasn't been written
+          * yet - it is written once more when done, with
+          * whatever is newest by then */
+         char msg[128];
+
+         slot->dirty = true;
+         free(data);
+
+         if (!autosave)
+         {
+            if (settings->ints.state_slot < 0)
+               strlcpy(msg, msg_hash_to_str(MSG_SAVED_STATE_TO_SLOT_AUTO),
+                     sizeof(msg));
+            else
+               snprintf(msg, sizeof(msg),
+                     msg_hash_to_str(MSG_SAVED_STATE_TO_SLOT),
+                     settings->ints.state_slot);
+            runloop_msg_queue_push(msg, 2, 180, true, NULL,
+                  MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+         }
+
+         return true;
+      }
+
+      if (!undo_from_cache && path_is_valid(path) && !autosave)
       {
          /* Before overwriting the savestate file, load it into a buffer
          to allow undo_save_state() to work */
@@ -1503,15 +2231,24 @@ bool content_save_state(const char *path, bool save_to_disk, bool autosave)
          RARCH_LOG("[State]: %s ...\n",
                msg_hash_to_str(MSG_FILE_ALREADY_EXISTS_SAVING_TO_BACKUP_BUFFER));
 
-         task_push_load_and_save_state(path, data, serial_size, true, autosave);
+         queued = task_push_load_and_save_state(path, data,
+               serial_size, true, autosave);
       }
       else
-         task_push_save_state(path, data, serial_size, autosave);
+         queued = task_push_save_state(path, data, serial_size, autosave);
+
+      /* If another blocking task is in the way, the
+       * cached state is written once it is done */
+      if (slot)
+      {
+         slot->writing = queued;
+         slot->dirty   = !queued;
+      }
    }
    else
    {
       if (!data)
-         data = content_get_serialized_data(&serial_size);
+         data = content_get_serialized_data(&serial_size, false, false);
 
       if (!data)
       {
@@ -1530,15 +2267,9 @@ bool content_save_state(const char *path, bool save_to_disk, bool autosave)
          undo_load_buf.data = NULL;
       }
 
-      undo_load_buf.data = malloc(serial_size);
-      if (!undo_load_buf.data)
-      {
-         free(data);
-         return false;
-      }
-
-      memcpy(undo_load_buf.data, data, serial_size);
-      free(data);
+      /* Hand the buffer over, rather than keeping
+       * a copy of it */
+      undo_load_buf.data = data;
       undo_load_buf.size = serial_size;
       strlcpy(undo_load_buf.path, path, sizeof(undo_load_buf.path));
    }
@@ -1551,13 +2282,15 @@ static bool task_save_state_finder(retro_task_t *task, void *user_data)
    if (!task)
       return false;
 
-   if (task->handler == task_save_handler)
+   if (     task->handler  == task_save_handler
+         || task->callback == content_load_and_save_state_cb)
       return true;
 
    return false;
 }
 
-/* Returns true if a save state task is in progress */
+/* Returns true if a save state task is in progress,
+ * or a cached state is still to be written */
 static bool content_save_state_in_progress(void* data)
 {
    task_finder_data_t find_data;
@@ -1568,14 +2301,60 @@ static bool content_save_state_in_progress(void* data)
    if (task_queue_find(&find_data))
       return true;
 
-   return false;
+   state_cache_flush();
+
+   return state_cache_is_dirty();
 }
 
 void content_wait_for_save_state_task(void)
 {
+   state_cache_flush();
    task_queue_wait(content_save_state_in_progress, NULL);
 }
 
+/* Loads a state kept in RAM straight away, without
+ * going through the task queue */
+static bool content_load_state_from_cache(struct state_cache_slot *slot,
+      int state_slot, bool autoload)
+{
+   char msg[PATH_MAX_LENGTH + 128];
+
+   RARCH_LOG("[State]: %s \"%s\", %u %s (RAM).\n",
+         msg_hash_to_str(MSG_LOADING_STATE),
+         slot->path,
+         (unsigned)slot->size,
+         msg_hash_to_str(MSG_BYTES));
+
+   if (!content_load_state_buffer(slot->data, slot->size))
+   {
+      RARCH_ERR("[State]: %s \"%s\".\n",
+            msg_hash_to_str(MSG_FAILED_TO_LOAD_STATE),
+            slot->path);
+      runloop_msg_queue_push(msg_hash_to_str(MSG_FAILED_TO_LOAD_STATE),
+            2, 180, true, NULL,
+            MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_ERROR);
+      return false;
+   }
+
+   if (autoload)
+      snprintf(msg, sizeof(msg), "%s \"%s\" %s.",
+            msg_hash_to_str(MSG_AUTOLOADING_SAVESTATE_FROM),
+            slot->path,
+            msg_hash_to_str(MSG_SUCCEEDED));
+   else if (state_slot < 0)
+      strlcpy(msg, msg_hash_to_str(MSG_LOADED_STATE_FROM_SLOT_AUTO),
+            sizeof(msg));
+   else
+      snprintf(msg, sizeof(msg),
+            msg_hash_to_str(MSG_LOADED_STATE_FROM_SLOT),
+            state_slot);
+
+   runloop_msg_queue_push(msg, 2, 180, true, NULL,
+         MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+
+   return true;
+}
+
 /**
  * content_load_state:
  * @path      : path that state will be loaded from.
@@ -1589,8 +2368,8 @@ void content_wait_for_save_state_task(void)
 bool content_load_state(const char *path,
       bool load_to_backup_buffer, bool autoload)
 {
-   retro_task_t       *task     = task_init();
-   save_task_state_t *state     = (save_task_state_t*)calloc(1, sizeof(*state));
+   retro_task_t       *task     = NULL;
+   save_task_state_t *state     = NULL;
    settings_t *settings         = config_get_ptr();
    int state_slot               = settings->ints.state_slot;
 #if defined(HAVE_ZLIB)
@@ -1598,6 +2377,27 @@ bool content_load_state(const char *path,
 #else
    bool compress_files          = false;
 #endif
+   bool use_cache               = !load_to_backup_buffer;
+
+#ifdef HAVE_CHEEVOS
+   /* Leave refusing the load to the task */
+   if (rcheevos_hardcore_active())
+      use_cache                 = false;
+#endif
+
+   if (use_cache)
+   {
+      struct state_cache_slot *slot = state_cache_find(path);
+
+      if (slot)
+      {
+         slot->last_used = ++state_cache_clock;
+         return content_load_state_from_cache(slot, state_slot, autoload);
+      }
+   }
+
+   task                         = task_init();
+   state                        = (save_task_state_t*)calloc(1, sizeof(*state));
 
    if (!task || !state)
       goto error;
@@ -1611,12 +2411,22 @@ bool content_load_state(const char *path,
    state->compress_files        = compress_files;
 
    task->type                   = TASK_TYPE_BLOCKING;
+   task->priority               = TASK_PRIORITY_HIGH;
+   task->affinity               = TASK_AFFINITY_IO;
    task->state                  = state;
    task->handler                = task_load_handler;
    task->callback               = content_load_state_cb;
    task->title                  = strdup(msg_hash_to_str(MSG_LOADING_STATE));
 
-   task_queue_push(task);
+   /* A save that isn't cached blocks the queue while it is
+    * written - it came first, so wait for it rather than
+    * dropping the load */
+   if (!task_queue_push(task))
+   {
+      content_wait_for_save_state_task();
+      if (!task_queue_push(task))
+         goto error;
+   }
 
    return true;
 
@@ -1624,14 +2434,27 @@ error:
    if (state)
       free(state);
    if (task)
+   {
+      if (task->title)
+         task_free_title(task);
       free(task);
+   }
 
    return false;
 }
 
+void content_forget_state(const char *path)
+{
+   state_cache_remove(path);
+}
+
 bool content_rename_state(const char *origin, const char *dest)
 {
    int ret = 0;
+
+   state_cache_remove(origin);
+   state_cache_remove(dest);
+
    if (filestream_exists(dest))
       filestream_delete(dest);
 
@@ -1651,6 +2474,15 @@ bool content_rename_state(const char *origin, const char *dest)
 */
 bool content_reset_savestate_backups(void)
 {
+   unsigned i;
+
+   /* Cached states not yet on disk are written first */
+   if (state_cache_is_dirty())
+      content_wait_for_save_state_task();
+
+   for (i = 0; i < STATE_CACHE_MAX_SLOTS; i++)
+      state_cache_free_slot(&state_cache[i]);
+
    if (undo_save_buf.data)
    {
       free(undo_save_buf.data);
@@ -80,6 +80,7 @@ struct screenshot_task_state
    bool is_paused;
    bool history_list_enable;
    bool widgets_ready;
+   bool fast_compression;
 };
 
 static bool screenshot_dump_direct(screenshot_task_state_t *state)
@@ -105,12 +106,13 @@ static bool screenshot_dump_direct(screenshot_task_state_t *state)
 
    scaler_ctx_gen_reset(&state->scaler);
 
-   ret = rpng_save_image_bgr24(
+   ret = rpng_save_image_bgr24_level(
          state->filename,
          state->out_buffer,
          state->width,
          state->height,
-         state->width * 3
+         state->width * 3,
+         state->fast_compression ? 1 : 9
          );
 
    free(state->out_buffer);
@@ -292,6 +294,7 @@ static bool screenshot_dump(
 #endif
    state->silence                = savestate;
    state->history_list_enable    = settings->bools.history_list_enable;
+   state->fast_compression       = settings->bools.screenshot_fast_compression;
    state->pixel_format_type      = pixel_format_type;
 
    if (!fullpath)
@@ -398,6 +401,7 @@ static bool screenshot_dump(
       retro_task_t *task = task_init();
 
       task->type        = TASK_TYPE_BLOCKING;
+      task->priority    = TASK_PRIORITY_HIGH;
       task->state       = state;
       task->handler     = task_screenshot_handler;
       task->mute        = savestate;
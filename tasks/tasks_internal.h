@@ -22,7 +22,9 @@
 #include <retro_common_api.h>
 #include <retro_miscellaneous.h>
 
+#include <lists/string_list.h>
 #include <queues/task_queue.h>
+#include <file/config_file.h>
 
 #ifdef HAVE_CONFIG_H
 #include "../config.h"
@@ -82,6 +84,17 @@ bool task_push_wifi_connect(retro_task_callback_t cb, void*);
 
 bool task_push_netplay_lan_scan(retro_task_callback_t cb);
 
+typedef struct netplay_rooms_parse_data
+{
+   struct netplay_room *rooms;
+   int count;
+} netplay_rooms_parse_data_t;
+
+/* Takes ownership of buf, the lobby room list as
+ * received. The callback gets a netplay_rooms_parse_data_t,
+ * and may take its rooms (setting them to NULL) */
+bool task_push_netplay_rooms_parse(char *buf, retro_task_callback_t cb);
+
 bool task_push_netplay_crc_scan(uint32_t crc, char* name,
       const char *hostname, const char *corename, const char* subsystem);
 
@@ -101,6 +114,7 @@ void *task_push_core_updater_download(
       const char *path_dir_core_assets);
 void task_push_update_installed_cores(
       bool auto_backup, size_t auto_backup_history_size,
+      unsigned download_max,
       const char *path_dir_libretro,
       const char *path_dir_core_assets);
 #if defined(ANDROID)
@@ -149,6 +163,24 @@ bool task_push_core_restore(const char *backup_path,
       const char *dir_libretro,
       bool *core_loaded);
 
+/* Creates the lock guarding the pending config. Must
+ * be called before any of the functions below */
+void task_config_save_init(void);
+/* Writes any pending config and frees the lock */
+void task_config_save_deinit(void);
+/* Writes 'conf' to 'path' from a task, shortly after
+ * the first request, so that saves issued in quick
+ * succession only touch the disk once. A failed
+ * write is reported on screen by the task.
+ * > Takes ownership of 'conf' */
+void task_push_config_save(config_file_t *conf, const char *path);
+/* Returns the config for 'path' still waiting to be
+ * written, if any. The caller takes ownership, and
+ * the scheduled write is cancelled */
+config_file_t *task_config_save_take(const char *path);
+/* Writes any pending config right away */
+void task_config_save_flush(void);
+
 bool task_push_pl_manager_reset_cores(const playlist_config_t *playlist_config);
 bool task_push_pl_manager_clean_playlist(const playlist_config_t *playlist_config);
 
@@ -156,6 +188,42 @@ bool task_push_image_load(const char *fullpath,
       bool supports_rgba, unsigned upscale_threshold,
       retro_task_callback_t cb, void *userdata);
 
+/* Same as task_push_image_load(), but images larger than
+ * 'max_width' x 'max_height' are scaled down while decoding,
+ * never below that size. Meant for wallpapers, where the
+ * size of the screen is all that is ever shown */
+bool task_push_image_load_scaled(const char *fullpath,
+      bool supports_rgba, unsigned max_width, unsigned max_height,
+      retro_task_callback_t cb, void *userdata);
+
+/* Same as task_push_image_load(), with the priority
+ * of the task on the threaded task queue and the size
+ * limit of task_push_image_load_scaled() (0 for none) */
+bool task_push_image_load_priority(const char *fullpath,
+      bool supports_rgba, unsigned upscale_threshold,
+      unsigned max_width, unsigned max_height,
+      enum task_priority priority,
+      retro_task_callback_t cb, void *userdata);
+
+struct gfx_thumbnail_pack_entry;
+
+/* Loads a pre-decoded image from a thumbnail pack
+ * (see gfx_thumbnail_pack.h). Callback receives the
+ * same struct texture_image as task_push_image_load() */
+bool task_push_image_load_pack(const char *pack_path,
+      const struct gfx_thumbnail_pack_entry *entry,
+      unsigned upscale_threshold,
+      enum task_priority priority,
+      retro_task_callback_t cb, void *userdata);
+
+/* Loads the thumbnail of the save state at 'state_path':
+ * the one embedded in the state if it has one, otherwise
+ * the screenshot saved next to it. Callback receives the
+ * same struct texture_image as task_push_image_load() */
+bool task_push_image_load_savestate(const char *state_path,
+      bool supports_rgba, unsigned upscale_threshold,
+      retro_task_callback_t cb, void *userdata);
+
 #ifdef HAVE_LIBRETRODB
 bool task_push_dbscan(
       const char *playlist_directory,
@@ -169,6 +237,13 @@ bool task_push_manual_content_scan(
       const playlist_config_t *playlist_config,
       const char *playlist_directory);
 
+/* Reads the content and core through the page cache
+ * and checks the firmware paths, ahead of a likely
+ * launch. Replaces any prefetch still running */
+bool task_push_content_prefetch(const char *content_path,
+      const char *core_path, const struct string_list *firmware);
+void task_content_prefetch_cancel(void);
+
 #ifdef HAVE_OVERLAY
 bool task_push_overlay_load_default(
       retro_task_callback_t cb,
@@ -189,7 +264,8 @@ bool patch_content(
       const char *name_bps,
       const char *name_ups,
       uint8_t **buf,
-      void *data);
+      void *data,
+      bool *buf_mapped);
 
 bool task_check_decompress(const char *source_file);
 
@@ -234,6 +310,9 @@ void input_autoconfigure_connect(
       unsigned pid);
 bool input_autoconfigure_disconnect(
       unsigned port, const char *name);
+/* Frees the index of autoconfig files kept
+ * between device connections */
+void input_autoconfigure_index_deinit(void);
 
 void set_save_state_in_background(bool state);
 
@@ -62,6 +62,7 @@
 #include <compat/fopen_utf8.h>
 #include <time/rtime.h>
 #include <retro_miscellaneous.h>
+#include <retro_atomic.h>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -73,6 +74,17 @@
 
 #include "verbosity.h"
 
+/* When logging to a file, messages are formatted straight
+ * into a ring and written out by a background thread, so
+ * callers never wait on disk I/O */
+#if defined(HAVE_THREADS) && !defined(IS_SALAMANDER) && !defined(HAVE_LOGGER) && RETRO_ATOMIC_LOCK_FREE
+#define HAVE_VERBOSITY_ASYNC
+#include <rthreads/rthreads.h>
+#ifndef va_copy
+#define va_copy(dst, src) ((dst) = (src))
+#endif
+#endif
+
 #ifdef HAVE_QT
 #include "ui/ui_companion_driver.h"
 #endif
@@ -83,6 +95,24 @@
 #define DEFAULT_FRONTEND_LOG_LEVEL 1
 #endif
 
+#ifdef HAVE_VERBOSITY_ASYNC
+/* Must be a power of two */
+#define VERBOSITY_ASYNC_SLOTS     256
+/* Longer messages are written out directly */
+#define VERBOSITY_ASYNC_SLOT_SIZE 512
+/* How long the writer sleeps when nothing is queued */
+#define VERBOSITY_ASYNC_TIMEOUT_USEC 50000
+
+typedef struct verbosity_async_slot
+{
+   /* Equals the queue position once the slot can be
+    * claimed, and position + 1 once it holds a message */
+   retro_atomic_int_t seq;
+   unsigned len;
+   char msg[VERBOSITY_ASYNC_SLOT_SIZE];
+} verbosity_async_slot_t;
+#endif
+
 #if defined(IS_SALAMANDER)
 #define FILE_PATH_PROGRAM_NAME "RetroArch Salamander"
 #else
@@ -98,6 +128,23 @@ typedef struct verbosity_state
     * will write to this file. */
    FILE *fp;
    void *buf;
+#ifdef HAVE_VERBOSITY_ASYNC
+   verbosity_async_slot_t *slots;
+   sthread_t *thread;
+   slock_t *lock;
+   /* Signalled when messages are queued */
+   scond_t *cond;
+   /* Broadcast whenever the writer caught up */
+   scond_t *flushed;
+   /* Next position to claim, any thread */
+   retro_atomic_int_t write_pos;
+   /* Next position to write out, writer thread only */
+   retro_atomic_int_t read_pos;
+   retro_atomic_int_t async;
+   /* Threads currently inside verbosity_async_push() */
+   retro_atomic_int_t pushers;
+   bool quit;
+#endif
 
    char override_path[PATH_MAX_LENGTH];
    bool verbosity;
@@ -164,6 +211,228 @@ bool *verbosity_get_ptr(void)
    return &g_verbosity->verbosity;
 }
 
+#ifdef HAVE_VERBOSITY_ASYNC
+static bool verbosity_async_pending(verbosity_state_t *g_verbosity)
+{
+   int pos = retro_atomic_load(&g_verbosity->read_pos);
+   return retro_atomic_load(&g_verbosity->slots[
+         (unsigned)pos & (VERBOSITY_ASYNC_SLOTS - 1)].seq) == pos + 1;
+}
+
+/* Writes out everything queued so far, in order */
+static void verbosity_async_drain(verbosity_state_t *g_verbosity)
+{
+   bool wrote = false;
+   int pos    = retro_atomic_load(&g_verbosity->read_pos);
+
+   for (;;)
+   {
+      verbosity_async_slot_t *slot = &g_verbosity->slots[
+         (unsigned)pos & (VERBOSITY_ASYNC_SLOTS - 1)];
+
+      if (retro_atomic_load(&slot->seq) != pos + 1)
+         break;
+
+      fwrite(slot->msg, 1, slot->len, g_verbosity->fp);
+      wrote = true;
+
+      /* Hand the slot back for the next lap around the ring */
+      retro_atomic_store(&slot->seq, pos + VERBOSITY_ASYNC_SLOTS);
+      retro_atomic_store(&g_verbosity->read_pos, ++pos);
+   }
+
+   if (wrote)
+      fflush(g_verbosity->fp);
+}
+
+static void verbosity_async_thread(void *data)
+{
+   verbosity_state_t *g_verbosity = (verbosity_state_t*)data;
+
+   slock_lock(g_verbosity->lock);
+
+   while (!g_verbosity->quit)
+   {
+      slock_unlock(g_verbosity->lock);
+      verbosity_async_drain(g_verbosity);
+      slock_lock(g_verbosity->lock);
+
+      scond_broadcast(g_verbosity->flushed);
+
+      /* A message may have come in while draining */
+      if (     !g_verbosity->quit
+            && !verbosity_async_pending(g_verbosity))
+         scond_wait_timeout(g_verbosity->cond, g_verbosity->lock,
+               VERBOSITY_ASYNC_TIMEOUT_USEC);
+   }
+
+   slock_unlock(g_verbosity->lock);
+
+   verbosity_async_drain(g_verbosity);
+}
+
+/* Waits until the writer went past 'pos', giving up after
+ * one writer timeout in case it is stuck on the disk */
+static void verbosity_async_wait(verbosity_state_t *g_verbosity, int pos)
+{
+   slock_lock(g_verbosity->lock);
+   scond_signal(g_verbosity->cond);
+   while ((int)((unsigned)retro_atomic_load(&g_verbosity->read_pos)
+            - (unsigned)pos) <= 0)
+   {
+      if (!scond_wait_timeout(g_verbosity->flushed, g_verbosity->lock,
+            VERBOSITY_ASYNC_TIMEOUT_USEC))
+         break;
+   }
+   slock_unlock(g_verbosity->lock);
+}
+
+static bool verbosity_async_queue(verbosity_state_t *g_verbosity,
+      const char *tag, const char *fmt, va_list ap)
+{
+   int len;
+   int pos;
+   va_list ap_copy;
+   bool too_long;
+   verbosity_async_slot_t *slot = NULL;
+
+   pos = retro_atomic_load(&g_verbosity->write_pos);
+
+   for (;;)
+   {
+      int diff;
+
+      slot = &g_verbosity->slots[(unsigned)pos & (VERBOSITY_ASYNC_SLOTS - 1)];
+      diff = (int)((unsigned)retro_atomic_load(&slot->seq) - (unsigned)pos);
+
+      if (diff == 0)
+      {
+         if (retro_atomic_cas(&g_verbosity->write_pos, pos, pos + 1))
+            break;
+      }
+      else if (diff < 0) /* Ring is full - rather wait than drop messages */
+         verbosity_async_wait(g_verbosity,
+               pos - VERBOSITY_ASYNC_SLOTS);
+
+      pos = retro_atomic_load(&g_verbosity->write_pos);
+   }
+
+   len = snprintf(slot->msg, sizeof(slot->msg), "%s ", tag);
+   if (len < 0 || len >= (int)sizeof(slot->msg))
+      len = 0;
+
+   va_copy(ap_copy, ap);
+   {
+      int ret  = vsnprintf(slot->msg + len,
+            sizeof(slot->msg) - len, fmt, ap_copy);
+      too_long = ret < 0 || ret >= (int)sizeof(slot->msg) - len;
+      len     += too_long ? 0 : ret;
+   }
+   va_end(ap_copy);
+
+   /* The slot is left empty for a message that doesn't fit,
+    * which is written out in full once the writer went past
+    * it instead, so that it still lands in order */
+   slot->len = too_long ? 0 : (unsigned)len;
+   retro_atomic_store(&slot->seq, pos + 1);
+
+   if (too_long)
+   {
+      verbosity_async_wait(g_verbosity, pos);
+      fprintf(g_verbosity->fp, "%s ", tag);
+      vfprintf(g_verbosity->fp, fmt, ap);
+      fflush(g_verbosity->fp);
+   }
+   /* Errors are often the last thing logged before a crash,
+    * so don't return before they made it to the file */
+   else if (string_is_equal(tag, FILE_PATH_LOG_ERROR))
+      verbosity_async_wait(g_verbosity, pos);
+   else
+      scond_signal(g_verbosity->cond);
+
+   return true;
+}
+
+/* Queues one message, returns false if the writer
+ * isn't running and the caller has to write it itself */
+static bool verbosity_async_push(verbosity_state_t *g_verbosity,
+      const char *tag, const char *fmt, va_list ap)
+{
+   bool queued;
+
+   /* Counted before checking whether the writer runs, so that
+    * verbosity_async_deinit() can wait for every slot claimed
+    * here to be filled in */
+   retro_atomic_fetch_add(&g_verbosity->pushers, 1);
+   queued = retro_atomic_load(&g_verbosity->async)
+         && verbosity_async_queue(g_verbosity, tag, fmt, ap);
+   retro_atomic_fetch_add(&g_verbosity->pushers, -1);
+
+   return queued;
+}
+
+/* The ring, lock and conditions are kept around once created,
+ * since another thread may still be in the middle of queueing
+ * a message when the log file gets switched - only the writer
+ * is stopped and restarted */
+static void verbosity_async_init(verbosity_state_t *g_verbosity)
+{
+   unsigned i;
+
+   if (!g_verbosity->slots)
+   {
+      if (!(g_verbosity->slots = (verbosity_async_slot_t*)calloc(
+                  VERBOSITY_ASYNC_SLOTS, sizeof(*g_verbosity->slots))))
+         return;
+
+      for (i = 0; i < VERBOSITY_ASYNC_SLOTS; i++)
+         retro_atomic_store(&g_verbosity->slots[i].seq, (int)i);
+      retro_atomic_store(&g_verbosity->write_pos, 0);
+      retro_atomic_store(&g_verbosity->read_pos, 0);
+
+      g_verbosity->lock    = slock_new();
+      g_verbosity->cond    = scond_new();
+      g_verbosity->flushed = scond_new();
+   }
+
+   if (!g_verbosity->lock || !g_verbosity->cond || !g_verbosity->flushed)
+      return;
+
+   g_verbosity->quit   = false;
+   g_verbosity->thread = sthread_create(verbosity_async_thread,
+         g_verbosity);
+
+   if (g_verbosity->thread)
+      retro_atomic_store(&g_verbosity->async, 1);
+}
+
+/* Stops the writer once it wrote out everything queued */
+static void verbosity_async_deinit(verbosity_state_t *g_verbosity)
+{
+   if (!g_verbosity->thread)
+      return;
+
+   retro_atomic_store(&g_verbosity->async, 0);
+
+   slock_lock(g_verbosity->lock);
+   /* Threads that got past the check above may still be filling
+    * in a slot, the writer has to see those before the file is
+    * closed - it broadcasts 'flushed' after each pass */
+   while (retro_atomic_load(&g_verbosity->pushers) > 0)
+   {
+      scond_signal(g_verbosity->cond);
+      scond_wait_timeout(g_verbosity->flushed, g_verbosity->lock,
+            VERBOSITY_ASYNC_TIMEOUT_USEC);
+   }
+   g_verbosity->quit = true;
+   scond_signal(g_verbosity->cond);
+   slock_unlock(g_verbosity->lock);
+
+   sthread_join(g_verbosity->thread);
+   g_verbosity->thread = NULL;
+}
+#endif
+
 void retro_main_log_file_init(const char *path, bool append)
 {
    FILE *tmp                      = NULL;
@@ -193,12 +462,20 @@ void retro_main_log_file_init(const char *path, bool append)
    /* TODO: this is only useful for a few platforms, find which and add ifdef */
    g_verbosity->buf         = calloc(1, 0x4000);
    setvbuf(g_verbosity->fp, (char*)g_verbosity->buf, _IOFBF, 0x4000);
+
+#ifdef HAVE_VERBOSITY_ASYNC
+   verbosity_async_init(g_verbosity);
+#endif
 }
 
 void retro_main_log_file_deinit(void)
 {
    verbosity_state_t *g_verbosity = &main_verbosity_st;
 
+#ifdef HAVE_VERBOSITY_ASYNC
+   verbosity_async_deinit(g_verbosity);
+#endif
+
    if (g_verbosity->fp && g_verbosity->initialized)
    {
       fclose(g_verbosity->fp);
@@ -299,6 +576,10 @@ void RARCH_LOG_V(const char *tag, const char *fmt, va_list ap)
    OutputDebugStringA(buffer);
 #endif
 #else
+#ifdef HAVE_VERBOSITY_ASYNC
+   if (verbosity_async_push(g_verbosity, tag_v, fmt, ap))
+      return;
+#endif
 #if defined(HAVE_LIBNX)
    mutexLock(&g_verbosity->mtx);
 #endif